@@ -17,21 +17,31 @@
 #include <folly/Benchmark.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstring>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <folly/FileUtil.h>
 #include <folly/MapUtil.h>
 #include <folly/String.h>
+#include <folly/chrono/Hardware.h>
+#include <folly/detail/BenchmarkStats.h>
+#include <folly/detail/PerfCounters.h>
 #include <folly/detail/PerfScoped.h>
 #include <folly/json/json.h>
+#include <folly/stats/TDigest.h>
+#include <folly/portability/PThread.h>
+#include <folly/portability/Sched.h>
+#include <folly/system/HardwareConcurrency.h>
 
 // This needs to be at the end because some versions end up including
 // Windows.h without defining NOMINMAX, which breaks uses
@@ -62,6 +72,23 @@ FOLLY_GFLAGS_DEFINE_string(
     " to be available on the system. Example: --bm_perf_args=\"record -g\"");
 #endif
 
+#if FOLLY_PERF_COUNTERS_ARE_SUPPORTED
+FOLLY_GFLAGS_DEFINE_bool(
+    bm_pmu,
+    false,
+    "Count the cycles, instructions, last level cache misses and branch "
+    "misses of each benchmark with perf_event_open, in an extra run after "
+    "the timing, and print them per iteration along with the IPC. With "
+    "--json, each benchmark maps to an object of its time and counts.");
+#endif
+
+FOLLY_GFLAGS_DEFINE_bool(
+    bm_latency,
+    false,
+    "Measure the latency of each operation of the benchmarks that use "
+    "folly::BenchmarkLatency, in an extra run after the timing, and print "
+    "their median, 99th and 99.9th percentiles and maximum.");
+
 FOLLY_GFLAGS_DEFINE_bool(
     bm_profile, false, "Run benchmarks with constant number of iterations");
 
@@ -116,11 +143,37 @@ FOLLY_GFLAGS_DEFINE_uint32(
     1000,
     "Maximum number of trials (iterations) executed for each benchmark.");
 
+FOLLY_GFLAGS_DEFINE_uint32(
+    bm_repetitions,
+    1,
+    "Measure each benchmark this many times, each within --bm_max_secs, and "
+    "report the mean once the outliers are rejected, with its 95% "
+    "confidence interval. --bm_json_verbose keeps the repetitions, for "
+    "BenchmarkCompare to test the significance of the changes.");
+
+FOLLY_GFLAGS_DEFINE_double(
+    bm_regression_alpha,
+    0.01,
+    "The p-value below which a change of the time of a benchmark between "
+    "two runs with --bm_repetitions is significant.");
+
+FOLLY_GFLAGS_DEFINE_double(
+    bm_regression_threshold,
+    0.02,
+    "The smallest relative slowdown of a benchmark that is a regression, "
+    "however significant.");
+
 FOLLY_GFLAGS_DEFINE_bool(
     bm_list,
     false,
     "Print out list of all benchmark test names without running them.");
 
+FOLLY_GFLAGS_DEFINE_bool(
+    bm_mt_pin,
+    false,
+    "Pin each thread of the BENCHMARK_MT benchmarks to a CPU, in the order "
+    "of the CPUs the process may run on. Only supported on Linux.");
+
 namespace folly {
 namespace detail {
 
@@ -129,6 +182,119 @@ BenchmarkingState<std::chrono::high_resolution_clock>& globalBenchmarkState() {
   return state;
 }
 
+namespace {
+
+// The CPUs the process may run on, or none where threads can't be pinned.
+std::vector<unsigned> benchmarkCpus() {
+  std::vector<unsigned> cpus;
+#if defined(__linux__) && !FOLLY_MOBILE
+  cpu_set_t cpuSet;
+  if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpuSet)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+void pinCurrentThread(unsigned cpu) {
+#if defined(__linux__) && !FOLLY_MOBILE
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+  if (int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+      err != 0) {
+    LOG(WARNING) << "--bm_mt_pin: pthread_setaffinity_np failed with " << err;
+  }
+#else
+  (void)cpu;
+#endif
+}
+
+} // namespace
+
+std::chrono::high_resolution_clock::duration runBenchmarkOnThreads(
+    unsigned threads,
+    unsigned iters,
+    const std::function<void(unsigned, unsigned)>& body) {
+  using Clock = std::chrono::high_resolution_clock;
+  auto const cpus = FLAGS_bm_mt_pin ? benchmarkCpus() : std::vector<unsigned>{};
+  std::atomic<unsigned> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<Clock::time_point> ends(threads);
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      if (!cpus.empty()) {
+        pinCurrentThread(cpus[t % cpus.size()]);
+      }
+      ready.fetch_add(1, std::memory_order_acq_rel);
+      // Yields rather than blocks, so that the threads start within a few
+      // nanoseconds of each other, even when they outnumber the CPUs.
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      body(iters, t);
+      ends[t] = Clock::now();
+    });
+  }
+  while (ready.load(std::memory_order_acquire) < threads) {
+    std::this_thread::yield();
+  }
+  auto const start = Clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return *std::max_element(ends.begin(), ends.end()) - start;
+}
+
+std::vector<unsigned> benchmarkThreadCounts(unsigned maxThreads) {
+  if (maxThreads == 0) {
+    maxThreads = std::max(1u, hardware_concurrency());
+  }
+  std::vector<unsigned> counts;
+  for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+    counts.push_back(threads);
+  }
+  counts.push_back(maxThreads);
+  return counts;
+}
+
+void addBenchmarkMT(
+    const char* file,
+    StringPiece name,
+    unsigned maxThreads,
+    std::function<void(unsigned, unsigned)> body) {
+  bool first = true;
+  for (auto threads : benchmarkThreadCounts(maxThreads)) {
+    auto execute = [threads, body](unsigned int iters) {
+      auto const duration = runBenchmarkOnThreads(threads, iters, body);
+      auto const ns = std::max<int64_t>(
+          1,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+              .count());
+      UserCounters counters;
+      counters["threads"] = threads;
+      counters["total/s"] = UserMetric(
+          static_cast<int64_t>(1e9 * threads * iters / ns),
+          UserMetric::Type::METRIC);
+      return TimeIterData{duration, iters, std::move(counters)};
+    };
+    addBenchmarkImpl(
+        file,
+        to<std::string>(first ? "" : "%", name, "(", threads, "t)"),
+        BenchmarkFun(std::move(execute)),
+        true);
+    first = false;
+  }
+}
+
 } // namespace detail
 
 using BenchmarkFun = std::function<detail::TimeIterData(unsigned int)>;
@@ -339,6 +505,171 @@ static std::pair<double, UserCounters> runProfilingGetNSPerIteration(
   return std::make_pair(nsecIter, std::move(timeIterData.userCounters));
 }
 
+static bool repetitionsRequested() {
+  return FLAGS_bm_repetitions > 1 && !FLAGS_bm_profile;
+}
+
+static bool perfCountersRequested() {
+#if FOLLY_PERF_COUNTERS_ARE_SUPPORTED
+  return FLAGS_bm_pmu;
+#else
+  return false;
+#endif
+}
+
+// Runs the benchmark for about as long as a trial of the timing, with the
+// hardware counters of the thread enabled outside of its suspensions.
+static std::optional<detail::PerfCounterValues> runBenchmarkGetPerfCounters(
+    const BenchmarkFun& fun, const double nsPerIter) {
+  static detail::PerfCounters counters;
+  if (!counters.supported()) {
+    return std::nullopt;
+  }
+
+  const double minNanoseconds =
+      std::max(100000., 1000. * double(FLAGS_bm_min_usec));
+  const double iters = std::clamp(
+      minNanoseconds / std::max(nsPerIter, 1.),
+      double(FLAGS_bm_min_iters),
+      double(FLAGS_bm_max_iters));
+
+  static int suspensions = 0;
+  detail::BenchmarkSuspenderBase::suspendHook = [](bool suspended) {
+    if (suspended ? suspensions++ == 0 : --suspensions == 0) {
+      suspended ? counters.pause() : counters.resume();
+    }
+  };
+  SCOPE_EXIT {
+    detail::BenchmarkSuspenderBase::suspendHook = nullptr;
+  };
+
+  counters.start();
+  auto timeIterData = fun(static_cast<unsigned int>(iters));
+  auto values = counters.stop();
+  values /= std::max(timeIterData.niter, 1u);
+  return values;
+}
+
+namespace {
+
+// Enough centroids for the 99.9th percentile.
+constexpr size_t kLatencyDigestSize = 1000;
+
+// The latencies of the benchmark being measured, in nanoseconds.
+struct LatencyDigest {
+  std::mutex mutex;
+  TDigest digest{kLatencyDigestSize};
+  std::vector<double> buffer;
+
+  void mergeBuffer() {
+    if (!buffer.empty()) {
+      digest = digest.merge(range(buffer));
+      buffer.clear();
+    }
+  }
+};
+
+std::atomic<bool> latencyActive{false};
+
+LatencyDigest& latencyDigest() {
+  static LatencyDigest latencies;
+  return latencies;
+}
+
+// The rate of hardware_timestamp, measured against the steady clock.
+double nsPerTick() {
+  static const double ratio = [] {
+    using Clock = std::chrono::steady_clock;
+    auto const start = Clock::now();
+    auto const startTicks = hardware_timestamp();
+    auto elapsed = Clock::duration{};
+    while ((elapsed = Clock::now() - start) < std::chrono::milliseconds(10)) {
+    }
+    auto const ticks = hardware_timestamp() - startTicks;
+    auto const ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return ticks == 0 ? 1. : double(ns) / double(ticks);
+  }();
+  return ratio;
+}
+
+// The ticks of measuring an empty operation, which are taken off the
+// latencies: the median, as the measurement may be interrupted.
+std::uint64_t overheadTicks() {
+  static const std::uint64_t overhead = [] {
+    std::vector<std::uint64_t> ticks(1000);
+    for (auto& t : ticks) {
+      auto const start = hardware_timestamp_measurement_start();
+      t = hardware_timestamp_measurement_stop() - start;
+    }
+    std::nth_element(ticks.begin(), ticks.begin() + 500, ticks.end());
+    return ticks[500];
+  }();
+  return overhead;
+}
+
+} // namespace
+
+namespace detail {
+
+bool benchmarkLatencyActive() noexcept {
+  return latencyActive.load(std::memory_order_relaxed);
+}
+
+void addBenchmarkLatencies(const std::uint64_t* ticks, std::size_t count) {
+  auto const scale = nsPerTick();
+  auto const overhead = overheadTicks();
+  auto& latencies = latencyDigest();
+  std::lock_guard guard(latencies.mutex);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const t = ticks[i] > overhead ? ticks[i] - overhead : 0;
+    latencies.buffer.push_back(double(t) * scale);
+  }
+  if (latencies.buffer.size() >= TDigest::kDefaultBufferSize) {
+    latencies.mergeBuffer();
+  }
+}
+
+} // namespace detail
+
+static bool latencyRequested() {
+  return FLAGS_bm_latency;
+}
+
+// Runs the benchmark for about 100ms, long enough for a few thousand
+// latencies of the slower operations, with BenchmarkLatency measuring.
+static std::optional<detail::BenchmarkLatencies> runBenchmarkGetLatencies(
+    const BenchmarkFun& fun, const double nsPerIter) {
+  const double iters = std::clamp(
+      1e8 / std::max(nsPerIter, 1.),
+      double(FLAGS_bm_min_iters),
+      double(FLAGS_bm_max_iters));
+  // Calibrated before the measurements.
+  nsPerTick();
+  overheadTicks();
+
+  auto& latencies = latencyDigest();
+  latencies.digest = TDigest(kLatencyDigestSize);
+  latencies.buffer.clear();
+  latencyActive.store(true, std::memory_order_relaxed);
+  fun(static_cast<unsigned int>(iters));
+  latencyActive.store(false, std::memory_order_relaxed);
+
+  std::lock_guard guard(latencies.mutex);
+  latencies.mergeBuffer();
+  auto& digest = latencies.digest;
+  if (digest.empty()) {
+    return std::nullopt;
+  }
+  detail::BenchmarkLatencies result;
+  result.count = digest.count();
+  result.p50 = digest.estimateQuantile(0.5);
+  result.p99 = digest.estimateQuantile(0.99);
+  result.p999 = digest.estimateQuantile(0.999);
+  result.max = digest.max();
+  return result;
+}
+
 struct ScaleInfo {
   double boundary;
   const char* suffix;
@@ -406,6 +737,76 @@ static string metricReadable(double n, unsigned int decimals) {
 
 namespace {
 
+struct PerfCounterColumn {
+  std::string_view name;
+  double (*value)(const detail::PerfCounterValues&);
+};
+
+constexpr PerfCounterColumn kPerfCounterColumns[] = {
+    {"cycles", [](const detail::PerfCounterValues& v) { return v.cycles; }},
+    {"instrs",
+     [](const detail::PerfCounterValues& v) { return v.instructions; }},
+    {"IPC", [](const detail::PerfCounterValues& v) { return v.ipc(); }},
+    {"LLC-miss",
+     [](const detail::PerfCounterValues& v) { return v.llcMisses; }},
+    {"br-miss",
+     [](const detail::PerfCounterValues& v) { return v.branchMisses; }},
+};
+
+// Fits the values, like "123.45K".
+constexpr int kPerfCounterWidth = 8;
+
+int perfCounterWidth(const PerfCounterColumn& column) {
+  return std::max(int(column.name.size()), kPerfCounterWidth);
+}
+
+// The confidence interval of the mean of the repetitions, like "+/-1.23%".
+constexpr std::string_view kConfidenceHeader = "+/-95%";
+constexpr int kConfidenceWidth = 8;
+
+size_t confidenceColumnLength() {
+  return repetitionsRequested() ? 2 + kConfidenceWidth : 0;
+}
+
+string readableConfidence(const detail::BenchmarkResult& result) {
+  auto stats = detail::sampleStats(result.samples);
+  if (std::isnan(stats.ci95) || stats.mean == 0) {
+    return "NaN";
+  }
+  return stringPrintf("+/-%.2f%%", 100 * stats.ci95 / stats.mean);
+}
+
+struct LatencyColumn {
+  std::string_view name;
+  double detail::BenchmarkLatencies::*value;
+};
+
+constexpr LatencyColumn kLatencyColumns[] = {
+    {"p50", &detail::BenchmarkLatencies::p50},
+    {"p99", &detail::BenchmarkLatencies::p99},
+    {"p99.9", &detail::BenchmarkLatencies::p999},
+    {"max", &detail::BenchmarkLatencies::max},
+};
+
+// As wide as time/iter.
+constexpr int kLatencyWidth = 9;
+
+size_t latencyColumnsLength() {
+  return latencyRequested() ? std::size(kLatencyColumns) * (2 + kLatencyWidth)
+                            : 0;
+}
+
+size_t perfCounterColumnsLength() {
+  if (!perfCountersRequested()) {
+    return 0;
+  }
+  size_t length = 0;
+  for (auto& column : kPerfCounterColumns) {
+    length += 2 + perfCounterWidth(column);
+  }
+  return length;
+}
+
 constexpr std::string_view kUnitHeaders = "relative  time/iter   iters/s";
 constexpr std::string_view kUnitHeadersPadding = "     ";
 void printHeaderContents(std::string_view file) {
@@ -441,13 +842,18 @@ void printSeparator(char pad, unsigned int columns) {
 
 class BenchmarkResultsPrinter {
  public:
-  BenchmarkResultsPrinter() : columns_(FLAGS_bm_result_width_chars) {}
+  BenchmarkResultsPrinter()
+      : namesLength_(
+            perfCounterColumnsLength() + confidenceColumnLength() +
+            latencyColumnsLength()),
+        columns_(FLAGS_bm_result_width_chars + namesLength_) {}
   explicit BenchmarkResultsPrinter(std::set<std::string> counterNames)
       : counterNames_(std::move(counterNames)),
         namesLength_{std::accumulate(
             counterNames_.begin(),
             counterNames_.end(),
-            size_t{0},
+            perfCounterColumnsLength() + confidenceColumnLength() +
+                latencyColumnsLength(),
             [](size_t acc, auto&& name) { return acc + 2 + name.length(); })},
         columns_(FLAGS_bm_result_width_chars + namesLength_) {}
 
@@ -456,9 +862,34 @@ class BenchmarkResultsPrinter {
   void header(std::string_view file) {
     separator('=');
     printDefaultHeaderContents(file, columns_);
+    if (repetitionsRequested()) {
+      printf(
+          "  %*.*s",
+          kConfidenceWidth,
+          int(kConfidenceHeader.size()),
+          kConfidenceHeader.data());
+    }
+    if (latencyRequested()) {
+      for (auto& column : kLatencyColumns) {
+        printf(
+            "  %*.*s",
+            kLatencyWidth,
+            int(column.name.size()),
+            column.name.data());
+      }
+    }
     for (auto const& name : counterNames_) {
       printf("  %s", name.c_str());
     }
+    if (perfCountersRequested()) {
+      for (auto& column : kPerfCounterColumns) {
+        printf(
+            "  %*.*s",
+            perfCounterWidth(column),
+            int(column.name.size()),
+            column.name.data());
+      }
+    }
     printf("\n");
     separator('=');
   }
@@ -519,6 +950,20 @@ class BenchmarkResultsPrinter {
             readableTime(secPerIter, 2).c_str(),
             metricReadable(itersPerSec, 2).c_str());
       }
+      if (repetitionsRequested()) {
+        printf("  %*s", kConfidenceWidth, readableConfidence(datum).c_str());
+      }
+      if (latencyRequested()) {
+        for (auto& column : kLatencyColumns) {
+          printf(
+              "  %*s",
+              kLatencyWidth,
+              !datum.latencies                   ? "NaN"
+                  : (*datum.latencies).*column.value == 0 ? "0"
+                  : readableTime((*datum.latencies).*column.value / 1E9, 2)
+                        .c_str());
+        }
+      }
       for (auto const& name : counterNames_) {
         if (auto ptr = folly::get_ptr(datum.counters, name)) {
           switch (ptr->type) {
@@ -542,6 +987,18 @@ class BenchmarkResultsPrinter {
           printf("  %*s", int(name.length()), "NaN");
         }
       }
+      if (perfCountersRequested()) {
+        for (auto& column : kPerfCounterColumns) {
+          auto value = datum.perfCounters
+              ? column.value(*datum.perfCounters)
+              : detail::PerfCounterValues::kNaN;
+          // metricReadable would print 0 in yocto units.
+          printf(
+              "  %*s",
+              perfCounterWidth(column),
+              value == 0 ? "0" : metricReadable(value, 2).c_str());
+        }
+      }
       printf("\n");
     }
   }
@@ -559,11 +1016,37 @@ class BenchmarkResultsPrinter {
 };
 } // namespace
 
+// The counts which are known, as JSON can't represent NaN.
+static dynamic perfCountersToDynamic(const detail::PerfCounterValues& values) {
+  dynamic obj = dynamic::object;
+  for (auto& column : kPerfCounterColumns) {
+    auto value = column.value(values);
+    if (!std::isnan(value)) {
+      obj[column.name] = value;
+    }
+  }
+  return obj;
+}
+
 static void printBenchmarkResultsAsJson(
     const vector<detail::BenchmarkResult>& data) {
   dynamic d = dynamic::object;
   for (auto& datum : data) {
-    d[datum.name] = datum.timeInNs * 1000.;
+    if (datum.perfCounters || datum.latencies) {
+      dynamic obj = datum.perfCounters
+          ? perfCountersToDynamic(*datum.perfCounters)
+          : dynamic::object;
+      obj["time"] = datum.timeInNs * 1000.;
+      // In the unit of the time.
+      if (datum.latencies) {
+        for (auto& column : kLatencyColumns) {
+          obj[column.name] = (*datum.latencies).*column.value * 1000.;
+        }
+      }
+      d[datum.name] = std::move(obj);
+    } else {
+      d[datum.name] = datum.timeInNs * 1000.;
+    }
   }
 
   printf("%s\n", toPrettyJson(d).c_str());
@@ -573,19 +1056,40 @@ void benchmarkResultsToDynamic(
     const vector<detail::BenchmarkResult>& data, dynamic& out) {
   out = dynamic::array;
   for (auto& datum : data) {
-    if (!datum.counters.empty()) {
-      dynamic obj = dynamic::object;
-      for (auto& counter : datum.counters) {
-        dynamic counterInfo = dynamic::object;
-        counterInfo["value"] = counter.second.value;
-        counterInfo["type"] = static_cast<int>(counter.second.type);
-        obj[counter.first] = counterInfo;
+    dynamic counters = dynamic::object;
+    for (auto& counter : datum.counters) {
+      dynamic counterInfo = dynamic::object;
+      counterInfo["value"] = counter.second.value;
+      counterInfo["type"] = static_cast<int>(counter.second.type);
+      counters[counter.first] = counterInfo;
+    }
+    dynamic samples = dynamic::array;
+    for (auto sample : datum.samples) {
+      samples.push_back(sample);
+    }
+    dynamic latencies = dynamic::object;
+    if (datum.latencies) {
+      latencies["count"] = datum.latencies->count;
+      for (auto& column : kLatencyColumns) {
+        latencies[column.name] = (*datum.latencies).*column.value;
       }
-      out.push_back(
-          dynamic::array(datum.file, datum.name, datum.timeInNs, obj));
-    } else {
-      out.push_back(dynamic::array(datum.file, datum.name, datum.timeInNs));
     }
+    // The optional parts follow the time, up to the last one that isn't
+    // empty, the others being empty placeholders.
+    dynamic parts = dynamic::array(
+        std::move(counters),
+        datum.perfCounters ? perfCountersToDynamic(*datum.perfCounters)
+                           : dynamic::object,
+        std::move(samples),
+        std::move(latencies));
+    while (!parts.empty() && parts[parts.size() - 1].empty()) {
+      parts.resize(parts.size() - 1);
+    }
+    dynamic entry = dynamic::array(datum.file, datum.name, datum.timeInNs);
+    for (auto& part : parts) {
+      entry.push_back(std::move(part));
+    }
+    out.push_back(std::move(entry));
   }
 }
 
@@ -597,6 +1101,19 @@ void benchmarkResultsFromDynamic(
          datum[1].asString(),
          datum[2].asDouble(),
          UserCounters{}});
+    if (datum.size() > 5) {
+      for (auto& sample : datum[5]) {
+        results.back().samples.push_back(sample.asDouble());
+      }
+    }
+    if (datum.size() > 6) {
+      detail::BenchmarkLatencies latencies;
+      latencies.count = datum[6]["count"].asDouble();
+      for (auto& column : kLatencyColumns) {
+        latencies.*column.value = datum[6][column.name].asDouble();
+      }
+      results.back().latencies = latencies;
+    }
   }
 }
 
@@ -605,13 +1122,40 @@ static pair<StringPiece, StringPiece> resultKey(
   return pair<StringPiece, StringPiece>(result.file, result.name);
 }
 
+namespace {
+
+// How test differs from base, if they were both repeated.
+struct Significance {
+  double pValue = detail::SampleStats::kNaN;
+  bool regression = false;
+  bool improvement = false;
+};
+
+Significance testSignificance(
+    const detail::BenchmarkResult& base, const detail::BenchmarkResult& test) {
+  Significance result;
+  auto const baseStats = detail::sampleStats(base.samples);
+  auto const testStats = detail::sampleStats(test.samples);
+  result.pValue = detail::welchTTest(baseStats, testStats);
+  if (!(result.pValue < FLAGS_bm_regression_alpha)) {
+    return result;
+  }
+  auto const change = testStats.mean / baseStats.mean - 1;
+  result.regression = change > FLAGS_bm_regression_threshold;
+  result.improvement = change < -FLAGS_bm_regression_threshold;
+  return result;
+}
+
+} // namespace
+
 void printResultComparison(
     const vector<detail::BenchmarkResult>& base,
     const vector<detail::BenchmarkResult>& test) {
-  map<pair<StringPiece, StringPiece>, double> baselines;
+  map<pair<StringPiece, StringPiece>, const detail::BenchmarkResult*>
+      baselines;
 
   for (auto& baseResult : base) {
-    baselines[resultKey(baseResult)] = baseResult.timeInNs;
+    baselines[resultKey(baseResult)] = &baseResult;
   }
 
   // Width available
@@ -627,8 +1171,7 @@ void printResultComparison(
   string lastFile;
 
   for (auto& datum : test) {
-    folly::Optional<double> baseline =
-        folly::get_optional(baselines, resultKey(datum));
+    auto baseline = folly::get_default(baselines, resultKey(datum), nullptr);
     auto file = datum.file;
     if (file != lastFile) {
       // New file starting
@@ -660,19 +1203,47 @@ void printResultComparison(
           metricReadable(itersPerSec, 2).c_str());
     } else {
       // Print with baseline
-      auto rel = *baseline / nsPerIter * 100.0;
+      auto rel = baseline->timeInNs / nsPerIter * 100.0;
       printf(
-          "%*s %7.2f%%  %9s  %7s\n",
+          "%*s %7.2f%%  %9s  %7s",
           static_cast<int>(s.size()),
           s.c_str(),
           rel,
           readableTime(secPerIter, 2).c_str(),
           metricReadable(itersPerSec, 2).c_str());
+      auto significance = testSignificance(*baseline, datum);
+      if (!std::isnan(significance.pValue)) {
+        printf(
+            "  p=%.3f%s",
+            significance.pValue,
+            significance.regression        ? "  REGRESSION"
+                : significance.improvement ? "  improvement"
+                                           : "");
+      }
+      printf("\n");
     }
   }
   printSeparator('=', columns);
 }
 
+std::vector<std::string> findBenchmarkRegressions(
+    const vector<detail::BenchmarkResult>& base,
+    const vector<detail::BenchmarkResult>& test) {
+  map<pair<StringPiece, StringPiece>, const detail::BenchmarkResult*>
+      baselines;
+  for (auto& baseResult : base) {
+    baselines[resultKey(baseResult)] = &baseResult;
+  }
+  std::vector<std::string> regressions;
+  for (auto& datum : test) {
+    auto baseline = folly::get_default(baselines, resultKey(datum), nullptr);
+    if (baseline && testSignificance(*baseline, datum).regression) {
+      regressions.push_back(datum.name);
+    }
+  }
+  return regressions;
+}
+
 void checkRunMode() {
   if (folly::kIsDebug || folly::kIsSanitize) {
     std::cerr << "WARNING: Benchmark running "
@@ -818,24 +1389,45 @@ runBenchmarksWithPrinterImpl(
     const detail::BenchmarkRegistration& bm = *toRun.benchmarks[i];
     bool shoudDrawLineAfter = shouldDrawLineTracker();
 
-    if (FLAGS_bm_profile) {
-      elapsed = runProfilingGetNSPerIteration(bm.func, globalBaseline.first);
-    } else {
-      elapsed = FLAGS_bm_estimate_time
+    auto measure = [&] {
+      if (FLAGS_bm_profile) {
+        return runProfilingGetNSPerIteration(bm.func, globalBaseline.first);
+      }
+      return FLAGS_bm_estimate_time
           ? runBenchmarkGetNSPerIterationEstimate(bm.func, globalBaseline.first)
           : runBenchmarkGetNSPerIteration(bm.func, globalBaseline.first);
+    };
+    elapsed = measure();
+    std::vector<double> samples;
+    if (repetitionsRequested()) {
+      samples.push_back(elapsed.first);
+      while (samples.size() < FLAGS_bm_repetitions) {
+        samples.push_back(measure().first);
+      }
+      elapsed.first = detail::sampleStats(samples).mean;
     }
 
     // if customized user counters is used, it cannot print the result in real
     // time as it needs to run all cases first to know the complete set of
     // counters have been used, then the header can be printed out properly
+    detail::BenchmarkResult result{
+        bm.file, bm.name, elapsed.first, elapsed.second};
+    result.samples = std::move(samples);
+    if (perfCountersRequested()) {
+      result.perfCounters =
+          runBenchmarkGetPerfCounters(bm.func, elapsed.first);
+    }
+    if (latencyRequested()) {
+      result.latencies = runBenchmarkGetLatencies(bm.func, elapsed.first);
+    }
+
     if (printer != nullptr) {
-      printer->print({{bm.file, bm.name, elapsed.first, elapsed.second}});
+      printer->print({result});
       if (shoudDrawLineAfter) {
         printer->separator('-');
       }
     }
-    results.push_back({bm.file, bm.name, elapsed.first, elapsed.second});
+    results.push_back(std::move(result));
 
     // get all counter names
     for (auto const& kv : elapsed.second) {
@@ -887,6 +1479,7 @@ bool operator==(const BenchmarkResult& x, const BenchmarkResult& y) {
 std::chrono::high_resolution_clock::duration BenchmarkSuspenderBase::timeSpent;
 std::chrono::high_resolution_clock::duration
     BenchmarkSuspenderBase::suspenderOverhead;
+void (*BenchmarkSuspenderBase::suspendHook)(bool) = nullptr;
 
 void BenchmarkingStateBase::addBenchmarkImpl(
     const char* file, StringPiece name, BenchmarkFun fun, bool useCounter) {
@@ -17,24 +17,31 @@
 #pragma once
 
 #include <folly/BenchmarkUtil.h>
+#include <folly/Likely.h>
 #include <folly/Portability.h>
 #include <folly/Preprocessor.h> // for FB_ANONYMOUS_VARIABLE
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Traits.h>
+#include <folly/chrono/Hardware.h>
+#include <folly/detail/PerfCounters.h>
 #include <folly/functional/Invoke.h>
 #include <folly/lang/Hint.h>
 #include <folly/portability/GFlags.h>
 
 #include <cassert>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <limits>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/function_types/function_arity.hpp>
 #include <glog/logging.h>
@@ -97,11 +104,28 @@ struct BenchmarkRegistration {
   bool useCounter = false;
 };
 
+// The distribution of the latencies of the operations of a benchmark, in
+// nanoseconds, with --bm_latency.
+struct BenchmarkLatencies {
+  double count = 0;
+  double p50 = 0;
+  double p99 = 0;
+  double p999 = 0;
+  double max = 0;
+};
+
 struct BenchmarkResult {
   std::string file;
   std::string name;
   double timeInNs;
   UserCounters counters;
+  // Per iteration, with --bm_pmu.
+  std::optional<PerfCounterValues> perfCounters{};
+  // The time per iteration of each repetition, with --bm_repetitions, of
+  // which timeInNs is the mean once the outliers are rejected.
+  std::vector<double> samples{};
+  // With --bm_latency, for the benchmarks that use BenchmarkLatency.
+  std::optional<BenchmarkLatencies> latencies{};
 
   friend std::ostream& operator<<(std::ostream&, const BenchmarkResult&);
 
@@ -117,6 +141,18 @@ struct BenchmarkSuspenderBase {
    */
   static std::chrono::high_resolution_clock::duration timeSpent;
   static std::chrono::high_resolution_clock::duration suspenderOverhead;
+
+  /**
+   * If set, called with true when a suspension starts and with false when
+   * it ends. --bm_pmu uses it to pause the hardware counters.
+   */
+  static void (*suspendHook)(bool suspended);
+
+  static void notifySuspendHook(bool suspended) {
+    if (FOLLY_UNLIKELY(suspendHook != nullptr)) {
+      suspendHook(suspended);
+    }
+  }
 };
 
 template <typename Clock>
@@ -127,7 +163,10 @@ struct BenchmarkSuspender : BenchmarkSuspenderBase {
   struct DismissedTag {};
   static inline constexpr DismissedTag Dismissed{};
 
-  BenchmarkSuspender() : start(Clock::now()) {}
+  BenchmarkSuspender() {
+    notifySuspendHook(true);
+    start = Clock::now();
+  }
 
   explicit BenchmarkSuspender(DismissedTag) : start(TimePoint{}) {}
 
@@ -161,6 +200,7 @@ struct BenchmarkSuspender : BenchmarkSuspenderBase {
 
   void rehire() {
     assert(start == TimePoint{});
+    notifySuspendHook(true);
     start = Clock::now();
   }
 
@@ -184,6 +224,7 @@ struct BenchmarkSuspender : BenchmarkSuspenderBase {
     auto end = Clock::now();
     timeSpent += (end - start) + suspenderOverhead;
     start = end;
+    notifySuspendHook(false);
   }
 
   TimePoint start;
@@ -317,6 +358,33 @@ inline void addBenchmarkImpl(
   globalBenchmarkState().addBenchmarkImpl(file, name, std::move(f), useCounter);
 }
 
+/**
+ * Runs body(iters, thread) on each of threads threads, which start together
+ * once all of them are up, and returns the time from their start to the end
+ * of the last one. With --bm_mt_pin, thread i runs on the i-th CPU the
+ * process may run on.
+ */
+std::chrono::high_resolution_clock::duration runBenchmarkOnThreads(
+    unsigned threads,
+    unsigned iters,
+    const std::function<void(unsigned, unsigned)>& body);
+
+/**
+ * The thread counts of the scaling curve of BENCHMARK_MT: the powers of 2
+ * below maxThreads, then maxThreads. 0 stands for the hardware concurrency.
+ */
+std::vector<unsigned> benchmarkThreadCounts(unsigned maxThreads);
+
+/**
+ * Adds the benchmarks of BENCHMARK_MT: name(1t) as a baseline, then
+ * name(2t), name(4t)... relative to it.
+ */
+void addBenchmarkMT(
+    const char* file,
+    StringPiece name,
+    unsigned maxThreads,
+    std::function<void(unsigned, unsigned)> body);
+
 } // namespace detail
 
 /**
@@ -328,6 +396,77 @@ struct BenchmarkSuspender
   using Impl::Impl;
 };
 
+namespace detail {
+
+// Whether --bm_latency is measuring the latencies of the benchmark.
+bool benchmarkLatencyActive() noexcept;
+
+// Adds the latencies, in ticks of hardware_timestamp.
+void addBenchmarkLatencies(const std::uint64_t* ticks, std::size_t count);
+
+} // namespace detail
+
+/**
+ * Measures the latency of each operation of a benchmark, for --bm_latency,
+ * which reports their median, 99th and 99.9th percentiles and maximum, which
+ * the time per iteration hides. Example:
+ *
+ * BENCHMARK(batonPostWait, iters) {
+ *   folly::Baton<> baton;
+ *   folly::BenchmarkLatency latency;
+ *   for (unsigned int i = 0; i < iters; ++i) {
+ *     latency.measure([&] {
+ *       baton.post();
+ *       baton.wait();
+ *     });
+ *     baton.reset();
+ *   }
+ * }
+ *
+ * --bm_latency measures them in an extra run after the timing, so that the
+ * time per iteration doesn't include the cost of the measurement, which is
+ * that of two reads of the timestamp counter. Otherwise measure() just
+ * calls the operation. The latencies are recorded in batches, added to a
+ * TDigest between the operations. So a BenchmarkLatency may be used on
+ * each thread of a BENCHMARK_MT.
+ */
+class BenchmarkLatency {
+ public:
+  BenchmarkLatency() noexcept : active_(detail::benchmarkLatencyActive()) {}
+  ~BenchmarkLatency() { flush(); }
+
+  BenchmarkLatency(const BenchmarkLatency&) = delete;
+  BenchmarkLatency& operator=(const BenchmarkLatency&) = delete;
+
+  template <typename F>
+  FOLLY_ALWAYS_INLINE void measure(F&& op) {
+    if (FOLLY_LIKELY(!active_)) {
+      static_cast<F&&>(op)();
+      return;
+    }
+    auto const start = hardware_timestamp_measurement_start();
+    static_cast<F&&>(op)();
+    ticks_[size_++] = hardware_timestamp_measurement_stop() - start;
+    if (FOLLY_UNLIKELY(size_ == kBatch)) {
+      flush();
+    }
+  }
+
+ private:
+  static constexpr std::size_t kBatch = 256;
+
+  void flush() {
+    if (size_ != 0) {
+      detail::addBenchmarkLatencies(ticks_, size_);
+      size_ = 0;
+    }
+  }
+
+  bool const active_;
+  std::size_t size_ = 0;
+  std::uint64_t ticks_[kBatch];
+};
+
 /**
  * Adds a benchmark. Usually not called directly but instead through
  * the macro BENCHMARK defined below.
@@ -356,6 +495,17 @@ void printResultComparison(
     const std::vector<detail::BenchmarkResult>& base,
     const std::vector<detail::BenchmarkResult>& test);
 
+/**
+ * The names of the benchmarks of test that are significantly slower than in
+ * base: by more than --bm_regression_threshold, with a p-value of Welch's
+ * t-test on their repetitions below --bm_regression_alpha. So only the
+ * benchmarks run with --bm_repetitions in both can regress, as a single
+ * time can't tell noise from a change.
+ */
+std::vector<std::string> findBenchmarkRegressions(
+    const std::vector<detail::BenchmarkResult>& base,
+    const std::vector<detail::BenchmarkResult>& test);
+
 } // namespace folly
 
 /**
@@ -647,6 +797,51 @@ void printResultComparison(
     return name(iters, ##__VA_ARGS__);                                     \
   }
 
+/**
+ * Introduces a multi-threaded benchmark, run on 1, 2, 4... threads up to the
+ * hardware concurrency, which is the scaling curve of the body. The first
+ * argument is the name of the benchmark, the second the number of
+ * iterations each thread does, and the third the index of the thread, in
+ * [0, threads). The threads start together, after a barrier, and the time
+ * is from their start to the end of the last one. Example:
+ *
+ * BENCHMARK_MT(atomicIncrement, iters, thread) {
+ *   for (unsigned int i = 0; i < iters; ++i) {
+ *     counter.fetch_add(1, std::memory_order_relaxed);
+ *   }
+ * }
+ *
+ * prints:
+ *
+ * atomicIncrement(1t)                    5.12ns  195.31M
+ * atomicIncrement(2t)     23.61%        21.68ns   46.12M
+ * ...
+ *
+ * The time and iters/s are per thread, and the relative column is the
+ * efficiency of the scaling: 100% for threads which don't slow each other
+ * down. The counters add the number of threads, and the throughput of all
+ * of them in total/s, which --bm_json_verbose outputs along with the time.
+ * --bm_mt_pin pins each thread to a CPU.
+ *
+ * The threads call the body concurrently, so it can't use
+ * BENCHMARK_SUSPEND, whose time isn't per thread.
+ */
+#define BENCHMARK_MT(name, iters, thread) \
+  BENCHMARK_MT_UP_TO(name, 0, iters, thread)
+
+/**
+ * Same as BENCHMARK_MT, up to maxThreads threads instead of the hardware
+ * concurrency.
+ */
+#define BENCHMARK_MT_UP_TO(name, maxThreads, iters, thread)                  \
+  static void name(unsigned, unsigned);                                      \
+  [[maybe_unused]] static bool FB_ANONYMOUS_VARIABLE(follyBenchmarkUnused) = \
+      (::folly::detail::addBenchmarkMT(                                      \
+           __FILE__, FOLLY_PP_STRINGIZE(name), maxThreads, name),            \
+       true);                                                                \
+  static void name(                                                          \
+      [[maybe_unused]] unsigned iters, [[maybe_unused]] unsigned thread)
+
 /**
  * Draws a line of dashes.
  */
@@ -205,6 +205,18 @@
 #define FOLLY_EXPORT
 #endif
 
+/**
+ * Macro for marking thread_local variables as using the initial-exec TLS
+ * model: an access is a load at a fixed offset from the thread pointer, even
+ * from a shared library. Such a library takes static TLS space, which is
+ * scarce if it is dlopen()ed after startup.
+ */
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define FOLLY_TLS_INITIAL_EXEC __attribute__((__tls_model__("initial-exec")))
+#else
+#define FOLLY_TLS_INITIAL_EXEC
+#endif
+
 // noinline
 #ifdef _MSC_VER
 #define FOLLY_NOINLINE __declspec(noinline)
@@ -21,6 +21,7 @@
 
 #include <folly/functional/Invoke.h>
 #include <folly/synchronization/DelayedInit.h>
+#include <folly/synchronization/DelayedInitPtr.h>
 
 namespace folly {
 
@@ -37,9 +38,14 @@ namespace folly {
  *     type is also not copyable or moveable.
  *
  * Otherwise, all design considerations from `folly::Lazy` are reflected here.
+ *
+ * The value is kept in a `folly::DelayedInit` by default; `concurrent_lazy_ptr`
+ * keeps it in a `folly::DelayedInitPtr` instead.
  */
 
-template <class Ctor>
+template <
+    class Ctor,
+    class Storage = folly::DelayedInit<invoke_result_t<Ctor>>>
 struct ConcurrentLazy {
   using result_type = invoke_result_t<Ctor>;
 
@@ -62,7 +68,7 @@ struct ConcurrentLazy {
   result_type& operator()() { return value_.try_emplace_with(std::ref(ctor_)); }
 
  private:
-  mutable folly::DelayedInit<result_type> value_;
+  mutable Storage value_;
   mutable Ctor ctor_;
 };
 
@@ -71,4 +77,15 @@ ConcurrentLazy<remove_cvref_t<Func>> concurrent_lazy(Func&& func) {
   return ConcurrentLazy<remove_cvref_t<Func>>(static_cast<Func&&>(func));
 }
 
+template <class Func>
+ConcurrentLazy<
+    remove_cvref_t<Func>,
+    folly::DelayedInitPtr<invoke_result_t<remove_cvref_t<Func>>>>
+concurrent_lazy_ptr(Func&& func) {
+  return ConcurrentLazy<
+      remove_cvref_t<Func>,
+      folly::DelayedInitPtr<invoke_result_t<remove_cvref_t<Func>>>>(
+      static_cast<Func&&>(func));
+}
+
 } // namespace folly
@@ -109,6 +109,18 @@ class SkipListNode {
     return node;
   }
 
+  // Prefetches the next node, and the one a layer up for taller nodes, so
+  // that iterating overlaps the cache misses of the nodes ahead with the use
+  // of the current one.
+  void prefetchNext() const {
+#if FOLLY_HAS_BUILTIN(__builtin_prefetch)
+    __builtin_prefetch(skip_[0].load(std::memory_order_relaxed));
+    if (height_ > 1) {
+      __builtin_prefetch(skip_[1].load(std::memory_order_relaxed));
+    }
+#endif
+  }
+
   void setSkip(uint8_t h, SkipListNode* next) {
     DCHECK_LT(h, height_);
     skip_[h].store(next, std::memory_order_release);
@@ -17,8 +17,10 @@
 #include <folly/Conv.h>
 
 #include <array>
+#include <cstring>
 #include <istream>
 
+#include <folly/lang/Bits.h>
 #include <folly/lang/SafeAssert.h>
 
 #include <fast_float/fast_float.h>
@@ -28,6 +30,38 @@ namespace detail {
 
 namespace {
 
+/**
+ * SWAR (SIMD within a register) helpers, which process eight characters
+ * at once in a 64-bit word, loaded so that the first character is in the
+ * least significant byte.
+ */
+inline uint64_t loadEightChars(const char* p) {
+  uint64_t chunk;
+  std::memcpy(&chunk, p, sizeof(chunk));
+  return Endian::little(chunk);
+}
+
+// Whether all the bytes are in ['0', '9']: their high nibble is 3, and it
+// stays 3 when 6 is added to them.
+inline bool isEightDigits(uint64_t chunk) {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+          (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+      0x3333333333333333;
+}
+
+// The value of eight digits, which are combined in pairs, then in groups
+// of four, then eight, with three multiplications.
+inline uint32_t parseEightDigits(uint64_t chunk) {
+  constexpr uint64_t kMask = 0x000000FF000000FF;
+  constexpr uint64_t kMul1 = 100 + (1000000ULL << 32);
+  constexpr uint64_t kMul2 = 1 + (10000ULL << 32);
+  chunk -= 0x3030303030303030;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & kMask) * kMul1) + (((chunk >> 16) & kMask) * kMul2)) >>
+      32;
+  return static_cast<uint32_t>(chunk);
+}
+
 /**
  * Finds the first non-digit in a string. The number of digits
  * searched depends on the precision of the Tgt integral. Assumes the
@@ -38,10 +72,14 @@ namespace {
  *     if (b >= e || !isdigit(*b)) return b;
  *   }
  *
- *  Complete unrolling marks bottom-line (i.e. entire conversion)
- *  improvements of 20%.
+ * The digits are checked eight at a time first.
  */
 inline const char* findFirstNonDigit(const char* b, const char* e) {
+  for (; e - b >= 8; b += 8) {
+    if (!isEightDigits(loadEightChars(b))) {
+      break;
+    }
+  }
   for (; b < e; ++b) {
     auto const c = static_cast<unsigned>(*b) - '0';
     if (c >= 10) {
@@ -516,6 +554,18 @@ inline Expected<Tgt, ConversionCode> digits_to(
 
   UT result = 0;
 
+  // Only the types of 32 bits or more can have 8 digits left after the
+  // overflow check above.
+  if constexpr (sizeof(UT) >= sizeof(uint32_t)) {
+    for (; e - b >= 8; b += 8) {
+      auto const chunk = loadEightChars(b);
+      if (!isEightDigits(chunk)) {
+        goto outOfRange;
+      }
+      result = UT(result * UT(100000000) + parseEightDigits(chunk));
+    }
+  }
+
   for (; e - b >= 4; b += 4) {
     result *= UT(10000);
     const int32_t r0 = shift1000[static_cast<size_t>(b[0])];
@@ -36,6 +36,12 @@ void Executor::addWithPriority(Func, int8_t /* priority */) {
       "addWithPriority() is not implemented for this Executor");
 }
 
+void Executor::addBatch(span<Func> funcs) {
+  for (auto& func : funcs) {
+    add(std::move(func));
+  }
+}
+
 bool Executor::keepAliveAcquire() noexcept {
   return false;
 }
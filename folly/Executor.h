@@ -24,6 +24,7 @@
 #include <folly/Optional.h>
 #include <folly/Range.h>
 #include <folly/Utility.h>
+#include <folly/container/span.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
@@ -63,6 +64,12 @@ class Executor {
   /// This is up to the implementation to enforce
   virtual void addWithPriority(Func, int8_t priority);
 
+  /// Enqueue a batch of functions, moving them out of the span. This is
+  /// equivalent to calling add() on each of them in order, which is what the
+  /// default implementation does, but implementations may amortize the cost
+  /// of enqueueing and waking up workers over the whole batch.
+  virtual void addBatch(span<Func> funcs);
+
   virtual uint8_t getNumPriorities() const { return 1; }
 
   static constexpr int8_t LO_PRI = SCHAR_MIN;
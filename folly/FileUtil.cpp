@@ -16,7 +16,9 @@
 
 #include <folly/FileUtil.h>
 
+#include <atomic>
 #include <cerrno>
+#include <chrono>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -30,6 +32,12 @@
 #include <folly/portability/SysFile.h>
 #include <folly/portability/SysStat.h>
 
+#if defined(__linux__) && defined(O_TMPFILE)
+#define FOLLY_DETAIL_FILE_UTIL_O_TMPFILE 1
+#else
+#define FOLLY_DETAIL_FILE_UTIL_O_TMPFILE 0
+#endif
+
 namespace folly {
 namespace {
 iovec getIOVecFor(ByteRange);
@@ -235,68 +243,212 @@ void throwIfWriteFileAtomicFailed(
   }
 }
 
-// We write the data to a temporary file name first, then atomically rename
-// it into place.
+// We write the data to a temporary file first, then atomically rename it
+// into place.
 //
 // If SyncType::WITH_SYNC is used, this ensures that the file contents will
 // always be valid, even if we crash or are killed partway through writing out
 // data.
-int writeFileAtomicNoThrowImpl(
-    StringPiece filename,
-    iovec* iov,
-    int count,
-    const WriteFileAtomicOptions& options) {
-  // create a null-terminated version of the filename
-  auto filePathString = std::string{filename};
-  auto temporaryFilePathString = fileutil_detail::getTemporaryFilePathString(
-      filePathString, options.temporaryDirectory);
-
-  auto tmpFD = mkstemp(const_cast<char*>(temporaryFilePathString.data()));
-  if (tmpFD == -1) {
-    return errno;
+//
+// Where O_TMPFILE is supported, the temporary file has no name until it is
+// complete, so that a crash doesn't leave it behind, and is linked directly in
+// place if there's no file to replace.
+class AtomicWrite {
+ public:
+  AtomicWrite() = default;
+  AtomicWrite(const AtomicWrite&) = delete;
+  AtomicWrite& operator=(const AtomicWrite&) = delete;
+
+  ~AtomicWrite() {
+    if (fd_ != -1) {
+      fileops::close(fd_);
+    }
+    if (linked_ && !committed_) {
+      unlink(tmpPath_.c_str());
+    }
   }
-  bool success = false;
-  SCOPE_EXIT {
-    if (tmpFD != -1) {
-      fileops::close(tmpFD);
+
+  int open(StringPiece filename, const WriteFileAtomicOptions& options) {
+    path_ = std::string{filename};
+    tmpPath_ = fileutil_detail::getTemporaryFilePathString(
+        path_, options.temporaryDirectory);
+#if FOLLY_DETAIL_FILE_UTIL_O_TMPFILE
+    if (canLinkAnonymousFiles()) {
+      auto const slash = tmpPath_.rfind('/');
+      auto const dir = slash == std::string::npos
+          ? std::string{"."}
+          : tmpPath_.substr(0, slash + 1);
+      fd_ = openNoInt(
+          dir.c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, options.permissions);
+      if (fd_ != -1) {
+        return 0;
+      }
     }
-    if (!success) {
-      unlink(temporaryFilePathString.c_str());
+#endif
+    fd_ = mkstemp(const_cast<char*>(tmpPath_.data()));
+    if (fd_ == -1) {
+      return errno;
     }
-  };
+    linked_ = true;
+    return 0;
+  }
 
-  auto rc = writevFull(tmpFD, iov, count);
-  if (rc == -1) {
-    return errno;
+  int write(iovec* iov, int count, mode_t permissions) {
+    if (writevFull(fd_, iov, count) == -1 || fchmod(fd_, permissions) == -1) {
+      return errno;
+    }
+    return 0;
   }
 
-  rc = fchmod(tmpFD, options.permissions);
-  if (rc == -1) {
-    return errno;
+  // Starts writing the data back to storage, for a sync() to wait for.
+  void startSync() {
+#ifdef __linux__
+    sync_file_range(fd_, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
   }
 
   // To guarantee atomicity across power failues on POSIX file systems,
   // the temporary file must be explicitly sync'ed before the rename.
-  if (options.syncType == SyncType::WITH_SYNC) {
-    rc = fsyncNoInt(tmpFD);
+  int sync() { return fsyncNoInt(fd_) == -1 ? errno : 0; }
+
+  int commit() {
+#if FOLLY_DETAIL_FILE_UTIL_O_TMPFILE
+    if (!linked_) {
+      auto const fdPath = "/proc/self/fd/" + std::to_string(fd_);
+      if (linkat(
+              AT_FDCWD,
+              fdPath.c_str(),
+              AT_FDCWD,
+              path_.c_str(),
+              AT_SYMLINK_FOLLOW) == 0) {
+        committed_ = true;
+        return 0;
+      }
+      if (errno != EEXIST) {
+        return errno;
+      }
+      // There's a file to replace: name the temporary file to rename it.
+      if (auto const rc = linkTemporaryFile(fdPath)) {
+        return rc;
+      }
+    }
+#endif
+
+    // Close the file before renaming to make sure all data has
+    // been successfully written.
+    auto rc = fileops::close(fd_);
+    fd_ = -1;
     if (rc == -1) {
       return errno;
     }
+
+    rc = rename(tmpPath_.c_str(), path_.c_str());
+    if (rc == -1) {
+      return errno;
+    }
+    committed_ = true;
+    return 0;
   }
 
-  // Close the file before renaming to make sure all data has
-  // been successfully written.
-  rc = fileops::close(tmpFD);
-  tmpFD = -1;
-  if (rc == -1) {
-    return errno;
+ private:
+#if FOLLY_DETAIL_FILE_UTIL_O_TMPFILE
+  static bool canLinkAnonymousFiles() {
+    static const bool can = access("/proc/self/fd", X_OK) == 0;
+    return can;
   }
 
-  rc = rename(temporaryFilePathString.c_str(), filePathString.c_str());
-  if (rc == -1) {
-    return errno;
+  // Links the file under tmpPath_, with its XXXXXX replaced as by mkstemp().
+  int linkTemporaryFile(const std::string& fdPath) {
+    static constexpr StringPiece kChars =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    static std::atomic<uint64_t> counter{0};
+    auto const suffix = tmpPath_.size() - 6;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      auto const now = std::chrono::steady_clock::now().time_since_epoch();
+      auto n = (uint64_t(getpid()) << 32) ^ uint64_t(now.count()) ^
+          (counter.fetch_add(1) * 0x9e3779b97f4a7c15ull);
+      for (size_t i = suffix; i < tmpPath_.size(); ++i, n /= kChars.size()) {
+        tmpPath_[i] = kChars[n % kChars.size()];
+      }
+      if (linkat(
+              AT_FDCWD,
+              fdPath.c_str(),
+              AT_FDCWD,
+              tmpPath_.c_str(),
+              AT_SYMLINK_FOLLOW) == 0) {
+        linked_ = true;
+        return 0;
+      }
+      if (errno != EEXIST) {
+        return errno;
+      }
+    }
+    return EEXIST;
+  }
+#endif
+
+  std::string path_;
+  std::string tmpPath_;
+  int fd_ = -1;
+  // Whether the temporary file has a name, tmpPath_.
+  bool linked_ = false;
+  bool committed_ = false;
+};
+
+int writeFileAtomicNoThrowImpl(
+    StringPiece filename,
+    iovec* iov,
+    int count,
+    const WriteFileAtomicOptions& options) {
+  AtomicWrite write;
+  if (auto const rc = write.open(filename, options)) {
+    return rc;
+  }
+  if (auto const rc = write.write(iov, count, options.permissions)) {
+    return rc;
+  }
+  if (options.syncType == SyncType::WITH_SYNC) {
+    if (auto const rc = write.sync()) {
+      return rc;
+    }
+  }
+  return write.commit();
+}
+
+int writeFilesAtomicNoThrowImpl(
+    Range<const std::pair<StringPiece, ByteRange>*> files,
+    const WriteFileAtomicOptions& options,
+    StringPiece& failed) {
+  std::vector<AtomicWrite> writes(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    failed = files[i].first;
+    auto iov = getIOVecFor(files[i].second);
+    if (auto const rc = writes[i].open(files[i].first, options)) {
+      return rc;
+    }
+    if (auto const rc = writes[i].write(&iov, 1, options.permissions)) {
+      return rc;
+    }
+  }
+  if (options.syncType == SyncType::WITH_SYNC) {
+    // Overlap the writebacks of all the files, rather than waiting for each
+    // in turn.
+    for (auto& write : writes) {
+      write.startSync();
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+      failed = files[i].first;
+      if (auto const rc = writes[i].sync()) {
+        return rc;
+      }
+    }
+  }
+  for (size_t i = 0; i < files.size(); ++i) {
+    failed = files[i].first;
+    if (auto const rc = writes[i].commit()) {
+      return rc;
+    }
   }
-  success = true;
   return 0;
 }
 } // namespace
@@ -367,6 +519,22 @@ void writeFileAtomic(
   throwIfWriteFileAtomicFailed(__func__, filename, rc);
 }
 
+int writeFilesAtomicNoThrow(
+    Range<const std::pair<StringPiece, ByteRange>*> files,
+    const WriteFileAtomicOptions& options) {
+  StringPiece failed;
+  return writeFilesAtomicNoThrowImpl(files, options, failed);
+}
+
+void writeFilesAtomic(
+    Range<const std::pair<StringPiece, ByteRange>*> files,
+    const WriteFileAtomicOptions& options) {
+  StringPiece failed;
+  auto rc = writeFilesAtomicNoThrowImpl(files, options, failed);
+
+  throwIfWriteFileAtomicFailed(__func__, failed, rc);
+}
+
 namespace {
 iovec getIOVecFor(ByteRange byteRange) {
   iovec iov;
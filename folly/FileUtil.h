@@ -21,6 +21,8 @@
 
 #include <cassert>
 #include <limits>
+#include <string>
+#include <utility>
 
 #include <folly/Portability.h>
 #include <folly/Range.h>
@@ -327,6 +329,24 @@ int writeFileAtomicNoThrow(
 int writeFileAtomicNoThrow(
     StringPiece filePath, StringPiece data, const WriteFileAtomicOptions&);
 
+/**
+ * Writes several files as writeFileAtomic() does, each of them atomically but
+ * not all of them as one. None is replaced unless all of them were written
+ * (and synced), so that a failure replaces at most the files before the one
+ * which failed to be renamed.
+ *
+ * With SyncType::WITH_SYNC, the writeback of all the files is started before
+ * waiting for any, so that the syncs overlap rather than each taking its own
+ * round trip to storage.
+ */
+void writeFilesAtomic(
+    Range<const std::pair<StringPiece, ByteRange>*> files,
+    const WriteFileAtomicOptions& options = WriteFileAtomicOptions());
+
+int writeFilesAtomicNoThrow(
+    Range<const std::pair<StringPiece, ByteRange>*> files,
+    const WriteFileAtomicOptions& options = WriteFileAtomicOptions());
+
 #endif // !_WIN32
 
 } // namespace folly
@@ -19,9 +19,21 @@
 #include <folly/Portability.h>
 #include <folly/Utility.h>
 #include <folly/detail/FingerprintPolynomial.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
 
+#include <algorithm>
+#include <stdexcept>
 #include <utility>
 
+#if FOLLY_X64 && defined(__PCLMUL__)
+#include <immintrin.h>
+#define FOLLY_FINGERPRINT_CLMUL_X64 1
+#elif FOLLY_AARCH64 && (FOLLY_ARM_FEATURE_AES || FOLLY_ARM_FEATURE_CRYPTO)
+#include <arm_neon.h>
+#define FOLLY_FINGERPRINT_CLMUL_PMULL 1
+#endif
+
 namespace folly {
 namespace detail {
 
@@ -131,5 +143,168 @@ const poly_table<96> FingerprintTable<96>::table = poly_table_95;
 template <>
 const poly_table<128> FingerprintTable<128>::table = poly_table_127;
 
+namespace {
+
+// Carry-less product of a and b, as {high, low} 64-bit halves.
+inline std::pair<uint64_t, uint64_t> clmul(uint64_t a, uint64_t b) {
+#if defined(FOLLY_FINGERPRINT_CLMUL_X64)
+  auto const r = _mm_clmulepi64_si128(
+      _mm_cvtsi64_si128(int64_t(a)), _mm_cvtsi64_si128(int64_t(b)), 0x00);
+  return {
+      uint64_t(_mm_cvtsi128_si64(_mm_srli_si128(r, 8))),
+      uint64_t(_mm_cvtsi128_si64(r))};
+#elif defined(FOLLY_FINGERPRINT_CLMUL_PMULL)
+  auto const r = vmull_p64(a, b);
+  return {uint64_t(r >> 64), uint64_t(r)};
+#else
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+  for (int i = 0; i < 64; i++) {
+    auto const mask = uint64_t(0) - ((b >> i) & 1);
+    lo ^= (a << i) & mask;
+    hi ^= i == 0 ? 0 : (a >> (64 - i)) & mask;
+  }
+  return {hi, lo};
+#endif
+}
+
+// The 64 bits of the big-endian words w starting at bit pos.
+inline uint64_t bitsAt(const uint64_t* w, int pos) {
+  auto const shift = pos % 64;
+  auto const i = pos / 64;
+  return shift == 0 ? w[i] : (w[i] << shift) | (w[i + 1] >> (64 - shift));
+}
+
+} // namespace
+
 } // namespace detail
+
+template <int BITS>
+void Fingerprint<BITS>::mulMod(
+    const uint64_t* a, const uint64_t* b, uint64_t* out) {
+  // Multiply with carry-less multiplications, word by word. Both operands are
+  // left-aligned, so the product A(X) * B(X), of degree at most 2*BITS-2,
+  // sits in the top 2*BITS bits of r: A * B = H * X^BITS + L.
+  uint64_t r[2 * size() + 1] = {};
+  for (int i = 0; i < size(); i++) {
+    for (int j = 0; j < size(); j++) {
+      auto const [hi, lo] = detail::clmul(a[i], b[j]);
+      r[i + j] ^= hi;
+      r[i + j + 1] ^= lo;
+    }
+  }
+  // Then reduce with the Broder tables: starting from H, which is already
+  // reduced, updating with the bits of L computes H * X^BITS + L mod P.
+  Fingerprint fp;
+  for (int i = 0; i < size(); i++) {
+    fp.fp_[i] = r[i];
+  }
+  if (BITS % 64 != 0) {
+    fp.fp_[size() - 1] &= ~uint64_t(0) << (64 - BITS % 64);
+  }
+  int pos = BITS;
+  for (; pos + 64 <= 2 * BITS; pos += 64) {
+    fp.update64(detail::bitsAt(r, pos));
+  }
+  if (pos < 2 * BITS) {
+    fp.update32(uint32_t(detail::bitsAt(r, pos) >> 32));
+  }
+  fp.write(out);
+}
+
+template <int BITS>
+void Fingerprint<BITS>::xPowMod(uint64_t k, uint64_t* out) {
+  // Square and multiply, from the most significant bit of k.
+  constexpr int kLowBit = 64 * size() - BITS;
+  uint64_t x[size()] = {};
+  x[size() - 1] = uint64_t(2) << kLowBit;
+  for (int i = 0; i < size(); i++) {
+    out[i] = 0;
+  }
+  out[size() - 1] = uint64_t(1) << kLowBit;
+  for (int bit = findLastSet(k); bit > 0; bit--) {
+    mulMod(out, out, out);
+    if ((k >> (bit - 1)) & 1) {
+      mulMod(out, x, out);
+    }
+  }
+}
+
+template class Fingerprint<64>;
+template class Fingerprint<96>;
+template class Fingerprint<128>;
+
+namespace detail {
+namespace {
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+constexpr std::array<uint64_t, 256> make_gear_table() {
+  std::array<uint64_t, 256> table{};
+  uint64_t state = 0x46617374434443; // "FastCDC"
+  for (auto& entry : table) {
+    entry = splitmix64(state);
+  }
+  return table;
+}
+
+// DO NOT CHANGE, as that would move every chunk boundary (see FastCdcChunker).
+FOLLY_STORAGE_CONSTEXPR auto const gear_table = make_gear_table();
+
+// A mask of the bits most significant bits.
+constexpr uint64_t highMask(unsigned bits) {
+  return bits == 0 ? 0 : ~uint64_t(0) << (64 - std::min(bits, 64u));
+}
+
+} // namespace
+} // namespace detail
+
+FastCdcChunker::FastCdcChunker(const Options& options)
+    : minSize_(options.minSize),
+      avgSize_(options.avgSize),
+      maxSize_(options.maxSize) {
+  if (minSize_ == 0 || minSize_ > avgSize_ || avgSize_ > maxSize_) {
+    throw_exception<std::invalid_argument>(
+        "FastCdcChunker: sizes must satisfy 0 < min <= avg <= max");
+  }
+  // A boundary is found with probability 1/avgSize at each byte with a mask
+  // of log2(avgSize) bits. Normalization level 2: two more bits below
+  // avgSize, two fewer above.
+  unsigned const bits = findLastSet(avgSize_) - 1;
+  avgSize_ = size_t(1) << bits;
+  avgSize_ = std::max(avgSize_, minSize_);
+  maskSmall_ = detail::highMask(bits + 2);
+  maskLarge_ = detail::highMask(bits > 2 ? bits - 2 : 1);
+}
+
+size_t FastCdcChunker::cut(ByteRange data) const {
+  auto const size = data.size();
+  if (size <= minSize_) {
+    return size;
+  }
+  auto const limit = std::min(size, maxSize_);
+  auto const normal = std::min(limit, avgSize_);
+  auto const bytes = data.data();
+  uint64_t hash = 0;
+  size_t i = minSize_;
+  for (; i < normal; i++) {
+    hash = (hash << 1) + detail::gear_table[bytes[i]];
+    if (!(hash & maskSmall_)) {
+      return i + 1;
+    }
+  }
+  for (; i < limit; i++) {
+    hash = (hash << 1) + detail::gear_table[bytes[i]];
+    if (!(hash & maskLarge_)) {
+      return i + 1;
+    }
+  }
+  return limit;
+}
+
 } // namespace folly
@@ -30,6 +30,9 @@
  *
  * The precomputed tables are in Fingerprint.cpp.
  *
+ * RollingFingerprint fingerprints a sliding window, and FastCdcChunker splits
+ * data into content-defined chunks for deduplication.
+ *
  * Benchmarked on 10/13/2009 on a 2.5GHz quad-core Xeon L5420,
  * - Fingerprint<64>::update64() takes about 12ns
  * - Fingerprint<96>::update64() takes about 30ns
@@ -42,7 +45,9 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <folly/Range.h>
 
@@ -92,9 +97,8 @@ FOLLY_DECLARE_FINGERPRINT_TABLES(128);
 /**
  * Compute the Rabin fingerprint.
  *
- * TODO(tudorb): Extend this to allow removing values from the computed
- * fingerprint (so we can fingerprint a sliding window, as in the Rabin-Karp
- * string matching algorithm)
+ * To fingerprint a sliding window, as in the Rabin-Karp string matching
+ * algorithm, see RollingFingerprint below.
  *
  * update* methods return *this, so you can chain them together:
  * Fingerprint<96>().update8(x).update(str).update64(val).write(output);
@@ -145,6 +149,23 @@ class Fingerprint {
     return *this;
   }
 
+  /**
+   * Extend this fingerprint of some data A to the fingerprint of A followed
+   * by B, given the fingerprint of B and the length of B in bytes. B is not
+   * rehashed, so the pieces of a large input can be fingerprinted
+   * independently (in parallel, or cached) and combined afterwards.
+   */
+  Fingerprint& combine(const Fingerprint& suffix, uint64_t suffixBytes) {
+    // fp(A) = S * X^(8*|A|) + A mod P, where S = X^(BITS-1) is the starting
+    // value, so fp(AB) = (fp(A) + S) * X^(8*|B|) + fp(B) mod P.
+    uint64_t shift[size()];
+    xPowMod(8 * suffixBytes, shift);
+    fp_[0] ^= 1ULL << 63;
+    mulMod(fp_, shift, fp_);
+    xortab(suffix.fp_);
+    return *this;
+  }
+
   /**
    * Return the number of uint64s needed to hold the fingerprint value.
    */
@@ -165,13 +186,28 @@ class Fingerprint {
   }
 
  private:
+  template <int>
+  friend class RollingFingerprint;
+
   // XOR the fingerprint with a value from one of the tables.
   void xortab(std::array<uint64_t, detail::poly_size(BITS)> const& tab) {
+    xortab(tab.data());
+  }
+
+  void xortab(const uint64_t* tab) {
     for (int i = 0; i < size(); i++) {
       fp_[i] ^= tab[i];
     }
   }
 
+  // Arithmetic modulo the fingerprint polynomial P(X), on values in the
+  // representation of write(). Defined in Fingerprint.cpp.
+  //
+  // out = a * b mod P. out may alias a or b.
+  static void mulMod(const uint64_t* a, const uint64_t* b, uint64_t* out);
+  // out = X^k mod P.
+  static void xPowMod(uint64_t k, uint64_t* out);
+
   // Helper functions: shift the fingerprint value left by 8/32/64 bits,
   // return the "out" value (the bits that were shifted out), and add "v"
   // in the bits on the right.
@@ -182,6 +218,142 @@ class Fingerprint {
   uint64_t fp_[detail::poly_size(BITS)];
 };
 
+/**
+ * Compute the Rabin fingerprint of a sliding window of the last window()
+ * bytes of a stream.
+ *
+ * Feed the first window() bytes with update8(), then slide the window one
+ * byte at a time with roll(), which adds a byte and removes the byte that
+ * leaves the window. Once window() bytes have been fed, write() produces the
+ * same value as Fingerprint<BITS>().update(<the last window() bytes>).
+ *
+ * Construction precomputes a table of 256 entries for the window size, so
+ * reuse the object (through reset()) rather than constructing one per window.
+ */
+template <int BITS>
+class RollingFingerprint {
+ public:
+  explicit RollingFingerprint(size_t window);
+
+  size_t window() const { return window_; }
+
+  RollingFingerprint& update8(uint8_t in) {
+    fp_.update8(in);
+    return *this;
+  }
+
+  // out must be the byte that was fed window() bytes before in.
+  RollingFingerprint& roll(uint8_t out, uint8_t in) {
+    fp_.update8(in);
+    fp_.xortab(outTable_[out]);
+    return *this;
+  }
+
+  // Start over with an empty window.
+  void reset() { fp_ = Fingerprint<BITS>(); }
+
+  void write(uint64_t* out) const { fp_.write(out); }
+
+ private:
+  size_t window_;
+  Fingerprint<BITS> fp_;
+  // outTable_[b] is what roll() removes when b leaves the window.
+  std::vector<std::array<uint64_t, detail::poly_size(BITS)>> outTable_;
+};
+
+template <int BITS>
+RollingFingerprint<BITS>::RollingFingerprint(size_t window)
+    : window_(window), outTable_(256) {
+  // Let the window hold bytes w_0..w_(n-1) and S = X^(BITS-1) be the starting
+  // value of Fingerprint. After update8(in), the fingerprint is
+  //   S * X^(8n+8) + w_0 * X^(8n) + ... + in   (mod P)
+  // and the fingerprint of w_1..w_(n-1),in is that plus
+  //   (S * X^8 + S + w_0) * X^(8n)             (mod P)
+  using FP = Fingerprint<BITS>;
+  uint64_t shift[FP::size()];
+  FP::xPowMod(8 * uint64_t(window), shift);
+  FP start;
+  start.update8(0);
+  start.fp_[0] ^= 1ULL << 63;
+  // The bit of X^0 in the least significant word.
+  constexpr int kLowBit = 64 * FP::size() - BITS;
+  uint64_t term[FP::size()];
+  for (int b = 0; b < 256; b++) {
+    start.write(term);
+    term[FP::size() - 1] ^= uint64_t(b) << kLowBit;
+    FP::mulMod(term, shift, outTable_[b].data());
+  }
+}
+
+/**
+ * Split data into content-defined chunks with the FastCDC algorithm, as
+ * described in
+ * Wen Xia et al. (2016)
+ *   FastCDC: a Fast and Efficient Content-Defined Chunking Approach for
+ *   Data Deduplication
+ *
+ * Chunk boundaries depend only on the bytes around them, so an insertion or
+ * deletion in the data only changes the chunks around it, and the chunks
+ * elsewhere can be deduplicated against earlier versions.
+ *
+ * The rolling hash is the gear hash h = (h << 1) + gear[byte], which needs
+ * one shift, one add and one table lookup per byte; bit k of h depends on the
+ * last k + 1 bytes, so boundaries are tested on the high bits. No boundary is
+ * tested before minSize, and below avgSize the test is stricter than above it
+ * (normalized chunking), which narrows the distribution of chunk sizes around
+ * avgSize.
+ *
+ * Chunk boundaries are part of the data format of anything that stores
+ * chunks, so the gear table in Fingerprint.cpp must never change.
+ */
+class FastCdcChunker {
+ public:
+  struct Options {
+    size_t minSize = 2 << 10;
+    // Rounded down to a power of two.
+    size_t avgSize = 8 << 10;
+    size_t maxSize = 64 << 10;
+  };
+
+  FastCdcChunker() : FastCdcChunker(Options()) {}
+
+  // Throws std::invalid_argument unless 0 < minSize <= avgSize <= maxSize.
+  explicit FastCdcChunker(const Options& options);
+
+  size_t minSize() const { return minSize_; }
+  size_t avgSize() const { return avgSize_; }
+  size_t maxSize() const { return maxSize_; }
+
+  /**
+   * Return the length of the first chunk of data, which is data.size() if
+   * data ends before a boundary.
+   *
+   * When chunking a stream, pass at least maxSize() bytes unless at the end
+   * of the stream: otherwise, a returned length of data.size() may not be a
+   * boundary.
+   */
+  size_t cut(ByteRange data) const;
+
+  /**
+   * Call fn(ByteRange chunk) for each chunk of data, in order.
+   */
+  template <class Fn>
+  void forEachChunk(ByteRange data, Fn&& fn) const {
+    while (!data.empty()) {
+      auto const len = cut(data);
+      fn(data.subpiece(0, len));
+      data.advance(len);
+    }
+  }
+
+ private:
+  size_t minSize_;
+  size_t avgSize_;
+  size_t maxSize_;
+  uint64_t maskSmall_;
+  uint64_t maskLarge_;
+};
+
 // Convenience functions
 
 /**
@@ -286,4 +458,9 @@ inline uint64_t Fingerprint<128>::shlor64(uint64_t v) {
   return out;
 }
 
+// mulMod and xPowMod are defined in Fingerprint.cpp.
+extern template class Fingerprint<64>;
+extern template class Fingerprint<96>;
+extern template class Fingerprint<128>;
+
 } // namespace folly
@@ -14,17 +14,110 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 
-#if !defined(__AVX2__) && !(defined(__linux__) && defined(__aarch64__))
+#include <folly/CPortability.h>
+#include <folly/FollyMemcpy.h>
+#include <folly/Portability.h>
+#include <folly/portability/Unistd.h>
+#include <folly/system/CpuDispatch.h>
+
 namespace folly {
 
-extern "C" void* __folly_memcpy(void* dst, const void* src, std::size_t size) {
-  if (size == 0)
+#if defined(__AVX2__) || (defined(__linux__) && defined(__aarch64__))
+
+// __folly_memcpy is defined by memcpy.S, or by memcpy_select_aarch64.cpp.
+
+#else
+
+namespace {
+
+void* memcpy_generic(void* dst, const void* src, std::size_t size) {
+  if (size == 0) {
     return dst;
+  }
   return std::memmove(dst, src, size);
 }
 
-} // namespace folly
+} // namespace
+
+#if FOLLY_X64 && defined(__ELF__)
+
+// memcpy.S defines the AVX2 implementation. This isn't a replacement for
+// memcpy, even with FOLLY_MEMCPY_IS_MEMCPY, since it calls memmove.
+extern "C" void* __folly_memcpy_avx2(
+    void* dst, const void* src, std::size_t size);
 
+namespace {
+
+decltype(&__folly_memcpy) select_memcpy(const CpuFeatures& cpu) {
+  return cpu.cpuId.avx2() ? __folly_memcpy_avx2 : memcpy_generic;
+}
+
+} // namespace
+
+FOLLY_CPU_DISPATCH(
+    __folly_memcpy,
+    select_memcpy,
+    (void* dst, const void* src, std::size_t size),
+    (dst, src, size));
+
+#else
+
+extern "C" void* __folly_memcpy(void* dst, const void* src, std::size_t size) {
+  return memcpy_generic(dst, src, size);
+}
+
+#endif
+
+#endif
+
+// Read by memcpy.S, which needs them hidden to address them relative to rip.
+extern "C" {
+FOLLY_ATTR_VISIBILITY_HIDDEN std::atomic<std::size_t>
+    __folly_memcpy_rep_movsb_threshold{1024};
+FOLLY_ATTR_VISIBILITY_HIDDEN std::atomic<std::size_t>
+    __folly_memcpy_non_temporal_threshold{SIZE_MAX};
+}
+
+MemcpyTunables getMemcpyTunables() noexcept {
+  return {
+      __folly_memcpy_rep_movsb_threshold.load(std::memory_order_relaxed),
+      __folly_memcpy_non_temporal_threshold.load(std::memory_order_relaxed),
+  };
+}
+
+void setMemcpyTunables(const MemcpyTunables& tunables) noexcept {
+  __folly_memcpy_rep_movsb_threshold.store(
+      tunables.repMovsbThreshold, std::memory_order_relaxed);
+  __folly_memcpy_non_temporal_threshold.store(
+      tunables.nonTemporalThreshold, std::memory_order_relaxed);
+}
+
+namespace {
+
+struct MemcpyCalibration {
+  MemcpyCalibration() noexcept {
+    long size = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size <= 0) {
+      size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
 #endif
+    if (size > 0) {
+      auto tunables = getMemcpyTunables();
+      tunables.nonTemporalThreshold = std::size_t(size) / 4 * 3;
+      setMemcpyTunables(tunables);
+    }
+  }
+};
+
+// Before the other static initializers, which may copy large buffers.
+FOLLY_STATIC_CTOR_PRIORITY_MAX MemcpyCalibration memcpyCalibration;
+
+} // namespace
+
+} // namespace folly
@@ -20,4 +20,26 @@ namespace folly {
 
 extern "C" void* __folly_memcpy(void* dst, const void* src, std::size_t size);
 
+/**
+ * The sizes at which the x86-64 __folly_memcpy changes strategy, for copies
+ * of more than 256 bytes. They have no effect on the other implementations.
+ *
+ * The non-temporal threshold is set at startup to 3/4 of the size of the
+ * last-level cache, as read by sysconf, so that copies which would evict
+ * most of it bypass it instead. It stays SIZE_MAX, which disables the
+ * non-temporal stores, where the size is unknown.
+ */
+struct MemcpyTunables {
+  /// Copies of at least this many bytes use rep movsb.
+  std::size_t repMovsbThreshold;
+  /// Copies of at least this many bytes, between buffers which don't
+  /// overlap, use non-temporal stores. Takes precedence over rep movsb.
+  std::size_t nonTemporalThreshold;
+};
+
+MemcpyTunables getMemcpyTunables() noexcept;
+
+/// Takes effect for the calls which start after it returns.
+void setMemcpyTunables(const MemcpyTunables& tunables) noexcept;
+
 } // namespace folly
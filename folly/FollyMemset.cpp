@@ -14,16 +14,69 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 
-#if !defined(__AVX2__) && !(defined(__linux__) && defined(__aarch64__))
+#include <folly/CPortability.h>
+#include <folly/FollyMemset.h>
+#include <folly/Portability.h>
+#include <folly/portability/Unistd.h>
 
 namespace folly {
 
+#if !defined(__AVX2__) && !(defined(__linux__) && defined(__aarch64__))
+
 extern "C" void* __folly_memset(void* dest, int ch, std::size_t count) {
   return std::memset(dest, ch, count);
 }
 
-} // namespace folly
+#endif
+
+// Read by memset.S, which needs them hidden to address them relative to rip.
+extern "C" {
+FOLLY_ATTR_VISIBILITY_HIDDEN std::atomic<std::size_t>
+    __folly_memset_rep_stosq_threshold{4096};
+FOLLY_ATTR_VISIBILITY_HIDDEN std::atomic<std::size_t>
+    __folly_memset_non_temporal_threshold{SIZE_MAX};
+}
+
+MemsetTunables getMemsetTunables() noexcept {
+  return {
+      __folly_memset_rep_stosq_threshold.load(std::memory_order_relaxed),
+      __folly_memset_non_temporal_threshold.load(std::memory_order_relaxed),
+  };
+}
+
+void setMemsetTunables(const MemsetTunables& tunables) noexcept {
+  __folly_memset_rep_stosq_threshold.store(
+      tunables.repStosqThreshold, std::memory_order_relaxed);
+  __folly_memset_non_temporal_threshold.store(
+      tunables.nonTemporalThreshold, std::memory_order_relaxed);
+}
+
+namespace {
 
+struct MemsetCalibration {
+  MemsetCalibration() noexcept {
+    long size = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size <= 0) {
+      size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
 #endif
+    if (size > 0) {
+      auto tunables = getMemsetTunables();
+      tunables.nonTemporalThreshold = std::size_t(size) / 4 * 3;
+      setMemsetTunables(tunables);
+    }
+  }
+};
+
+// Before the other static initializers, which may clear large buffers.
+FOLLY_STATIC_CTOR_PRIORITY_MAX MemsetCalibration memsetCalibration;
+
+} // namespace
+
+} // namespace folly
@@ -22,4 +22,25 @@ namespace folly {
 
 extern "C" void* __folly_memset(void* dest, int ch, std::size_t count);
 
+/**
+ * The sizes at which the x86-64 __folly_memset changes strategy, for fills
+ * of more than 176 bytes. They have no effect on the other implementations.
+ *
+ * The non-temporal threshold is set at startup to 3/4 of the size of the
+ * last-level cache, as read by sysconf, and stays SIZE_MAX, which disables
+ * the non-temporal stores, where the size is unknown.
+ */
+struct MemsetTunables {
+  /// Fills of at least this many bytes use rep stosq.
+  std::size_t repStosqThreshold;
+  /// Fills of at least this many bytes use non-temporal stores. Takes
+  /// precedence over rep stosq.
+  std::size_t nonTemporalThreshold;
+};
+
+MemsetTunables getMemsetTunables() noexcept;
+
+/// Takes effect for the calls which start after it returns.
+void setMemsetTunables(const MemsetTunables& tunables) noexcept;
+
 } // namespace folly
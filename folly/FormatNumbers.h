@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Bulk formatting of numbers, e.g. for CSV files or metrics exports.
+//
+// formatNumbers writes a sequence of integers or floating point values,
+// separated by a delimiter, into a caller-provided buffer:
+//
+//   std::vector<int64_t> values = ...;
+//   std::vector<char> buf(formatNumbersSizeMax<int64_t>(values.size(), 1));
+//   char* end =
+//       formatNumbers(buf.data(), buf.data() + buf.size(), values, ",");
+//
+// appendNumbers appends them to a std::string, or to an io::Appender or
+// io::QueueAppender, growing it as needed.
+//
+// The output of each value is the same as the output of folly::to<std::string>:
+// integers in decimal, and floating point values in their shortest
+// representation which round-trips. The buffer is sized once for all the
+// values, and the digits are written directly into it, without the
+// intermediate buffer and string append of toAppend.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+#include <double-conversion/double-conversion.h>
+
+#include <folly/Conv.h>
+#include <folly/Range.h>
+#include <folly/lang/ToAscii.h>
+#include <folly/memory/UninitializedMemoryHacks.h>
+
+namespace folly {
+
+namespace detail {
+
+template <typename T, typename = void>
+struct format_numbers_writer;
+
+template <typename T>
+struct format_numbers_writer<
+    T,
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+  static_assert(sizeof(T) <= sizeof(uint64_t), "128-bit integers");
+
+  static constexpr size_t size_max =
+      to_ascii_size_max_decimal<std::make_unsigned_t<T>> +
+      std::is_signed_v<T>;
+
+  FOLLY_ALWAYS_INLINE char* operator()(char* out, T value) const {
+    if constexpr (std::is_signed_v<T>) {
+      // The sign is always written, and skipped for the positive values.
+      *out = '-';
+      out += value < 0;
+      auto const uvalue = value < 0
+          ? ~static_cast<uint64_t>(value) + 1
+          : static_cast<uint64_t>(value);
+      return out + to_ascii_decimal(out, out + size_max, uvalue);
+    } else {
+      return out + to_ascii_decimal(out, out + size_max, value);
+    }
+  }
+};
+
+template <typename T>
+struct format_numbers_writer<
+    T,
+    std::enable_if_t<std::is_floating_point_v<T>>> {
+  // The longest output is 25 characters, e.g. -0.0000012345678901234567,
+  // and the builder writes a terminator after it.
+  static constexpr size_t size_max = 32;
+
+  // The same configuration as toAppend, for the same output.
+  double_conversion::DoubleToStringConverter conv{
+      double_conversion::DoubleToStringConverter::NO_FLAGS,
+      "Infinity",
+      "NaN",
+      'E',
+      kConvMaxDecimalInShortestLow,
+      kConvMaxDecimalInShortestHigh,
+      6, // max leading padding zeros
+      1}; // max trailing padding zeros
+
+  FOLLY_ALWAYS_INLINE char* operator()(char* out, T value) const {
+    double_conversion::StringBuilder builder(out, int(size_max));
+    conv.ToShortest(value, &builder);
+    return out + builder.position();
+  }
+};
+
+template <typename Values>
+using format_numbers_value_t = std::remove_cv_t<
+    std::remove_pointer_t<decltype(std::data(std::declval<Values const&>()))>>;
+
+} // namespace detail
+
+//  formatNumbersSizeMax
+//
+//  The size of a buffer which is large enough to hold count values of type T,
+//  separated by delimiters of delimSize characters.
+template <typename T>
+constexpr size_t formatNumbersSizeMax(size_t count, size_t delimSize) {
+  constexpr size_t sizeMax = detail::format_numbers_writer<T>::size_max;
+  return count == 0 ? 0 : count * sizeMax + (count - 1) * delimSize;
+}
+
+//  formatNumbers
+//
+//  Writes the values of a contiguous container of integers or floating point
+//  values, e.g. a std::vector or a span, separated by delim, into the buffer
+//  [outb, oute), and returns the end of the output.
+//
+//  Does *not* append a null terminator. Assumes that the buffer holds at least
+//  formatNumbersSizeMax<T>(size, delim.size()) characters; the output is
+//  usually much shorter than that.
+template <typename Values>
+char* formatNumbers(
+    char* outb, char const* oute, Values const& values, StringPiece delim) {
+  using T = detail::format_numbers_value_t<Values>;
+  auto const data = std::data(values);
+  auto const size = std::size(values);
+  assert(size_t(oute - outb) >= formatNumbersSizeMax<T>(size, delim.size()));
+  (void)oute;
+  if (size == 0) {
+    return outb;
+  }
+  detail::format_numbers_writer<T> const write;
+  char* out = write(outb, data[0]);
+  for (size_t i = 1; i < size; ++i) {
+    std::memcpy(out, delim.data(), delim.size());
+    out = write(out + delim.size(), data[i]);
+  }
+  return out;
+}
+
+//  appendNumbers
+//
+//  Appends the values of a contiguous container of integers or floating point
+//  values, separated by delim, to a std::string.
+template <typename Values>
+void appendNumbers(std::string& out, Values const& values, StringPiece delim) {
+  using T = detail::format_numbers_value_t<Values>;
+  auto const oldSize = out.size();
+  auto const sizeMax = formatNumbersSizeMax<T>(std::size(values), delim.size());
+  resizeWithoutInitialization(out, oldSize + sizeMax);
+  char* const outb = &out[oldSize];
+  char* const oute = formatNumbers(outb, outb + sizeMax, values, delim);
+  out.resize(oldSize + size_t(oute - outb));
+}
+
+//  appendNumbers
+//
+//  Appends the values of a contiguous container of integers or floating point
+//  values, separated by delim, to an io::Appender or an io::QueueAppender.
+//  The room for each value is ensured before it is written, so the output may
+//  span several buffers, but each value is contiguous.
+template <typename Appender, typename Values>
+void appendNumbers(
+    Appender& appender, Values const& values, StringPiece delim) {
+  using T = detail::format_numbers_value_t<Values>;
+  auto const data = std::data(values);
+  auto const size = std::size(values);
+  detail::format_numbers_writer<T> const write;
+  for (size_t i = 0; i < size; ++i) {
+    size_t const delimSize = i == 0 ? 0 : delim.size();
+    appender.ensure(delimSize + detail::format_numbers_writer<T>::size_max);
+    auto const outb = reinterpret_cast<char*>(appender.writableData());
+    std::memcpy(outb, delim.data(), delimSize);
+    appender.append(size_t(write(outb + delimSize, data[i]) - outb));
+  }
+}
+
+} // namespace folly
@@ -217,32 +217,50 @@
 
 namespace folly {
 
-template <typename FunctionType>
+/**
+ * The default size of the buffer in which `folly::Function` stores callables
+ * without allocating.
+ */
+inline constexpr std::size_t kFunctionInlineSize = 6 * sizeof(void*);
+
+template <typename FunctionType, std::size_t InlineSize = kFunctionInlineSize>
 class Function;
 
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const> constCastFunction(
-    Function<ReturnType(Args...)>&&) noexcept;
+/**
+ * A `folly::Function` storing callables of up to `InlineSize` bytes without
+ * allocating, e.g. for the tasks of an executor whose lambdas typically
+ * capture more than the default allows. A function converts without
+ * allocating to one with a larger or equal inline size.
+ */
+template <typename FunctionType, std::size_t InlineSize>
+using BasicFunction = Function<FunctionType, InlineSize>;
 
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const noexcept> constCastFunction(
-    Function<ReturnType(Args...) noexcept>&&) noexcept;
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const, InlineSize> constCastFunction(
+    Function<ReturnType(Args...), InlineSize>&&) noexcept;
+
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const noexcept, InlineSize> constCastFunction(
+    Function<ReturnType(Args...) noexcept, InlineSize>&&) noexcept;
 
 namespace detail {
 namespace function {
 
 enum class Op { MOVE, NUKE, HEAP };
 
+// The storage of a Function. The type-erased operations only see its address,
+// so that they do not depend on its size: the callable, or the pointer to it
+// when it is on the heap, is always at the start.
+template <std::size_t Size>
 union Data {
-  struct BigTrivialLayout {
-    void* big;
-    std::size_t size;
-    std::size_t align;
-  };
+  void* big;
+  std::aligned_storage_t<Size> tiny;
+};
 
+struct BigTrivialLayout {
   void* big;
-  BigTrivialLayout bigt;
-  std::aligned_storage<6 * sizeof(void*)>::type tiny;
+  std::size_t size;
+  std::size_t align;
 };
 
 struct CoerceTag {};
@@ -292,15 +310,15 @@ template <typename T>
 using CallArg = conditional_t<is_register_pass_v<T>, T, T&&>;
 #endif
 
-template <typename F, bool Nx, typename R, typename... A>
+template <typename F, std::size_t N, bool Nx, typename R, typename... A>
 class FunctionTraitsSharedProxy {
-  std::shared_ptr<Function<F>> sp_;
+  std::shared_ptr<Function<F, N>> sp_;
 
  public:
   explicit FunctionTraitsSharedProxy(std::nullptr_t) noexcept {}
-  explicit FunctionTraitsSharedProxy(Function<F>&& func)
-      : sp_(func ? std::make_shared<Function<F>>(std::move(func))
-                 : std::shared_ptr<Function<F>>()) {}
+  explicit FunctionTraitsSharedProxy(Function<F, N>&& func)
+      : sp_(func ? std::make_shared<Function<F, N>>(std::move(func))
+                 : std::shared_ptr<Function<F, N>>()) {}
   R operator()(A... args) const noexcept(Nx) {
     if (!sp_) {
       throw_exception<std::bad_function_call>();
@@ -335,8 +353,8 @@ template <
     bool Nx,
     typename ReturnType,
     typename... Args>
-ReturnType call_(Args... args, Data& p) noexcept(Nx) {
-  auto& fn = *static_cast<Fun*>(Small ? &p.tiny : p.big);
+ReturnType call_(Args... args, void* p) noexcept(Nx) {
+  auto& fn = *static_cast<Fun*>(Small ? p : *static_cast<void**>(p));
   if constexpr (std::is_void<ReturnType>::value) {
     fn(static_cast<Args&&>(args)...);
   } else {
@@ -344,12 +362,12 @@ ReturnType call_(Args... args, Data& p) noexcept(Nx) {
   }
 }
 
-template <typename FunctionType>
+template <typename FunctionType, std::size_t N>
 struct FunctionTraits;
 
-template <typename ReturnType, typename... Args>
-struct FunctionTraits<ReturnType(Args...)> {
-  using Call = ReturnType (*)(CallArg<Args>..., Data&);
+template <typename ReturnType, typename... Args, std::size_t N>
+struct FunctionTraits<ReturnType(Args...), N> {
+  using Call = ReturnType (*)(CallArg<Args>..., void*);
   using ConstSignature = ReturnType(Args...) const;
   using NonConstSignature = ReturnType(Args...);
   using OtherSignature = ConstSignature;
@@ -361,22 +379,26 @@ struct FunctionTraits<ReturnType(Args...)> {
   static constexpr Call call =
       call_<Fun, Small, false, ReturnType, CallArg<Args>...>;
 
-  static ReturnType uninitCall(CallArg<Args>..., Data&) {
+  static ReturnType uninitCall(CallArg<Args>..., void*) {
     throw_exception<std::bad_function_call>();
   }
 
   ReturnType operator()(Args... args) {
-    auto& fn = *static_cast<Function<NonConstSignature>*>(this);
-    return fn.call_(static_cast<Args&&>(args)..., fn.data_);
+    auto& fn = *static_cast<Function<NonConstSignature, N>*>(this);
+    return fn.call_(static_cast<Args&&>(args)..., &fn.data_);
   }
 
-  using SharedProxy =
-      FunctionTraitsSharedProxy<NonConstSignature, false, ReturnType, Args...>;
+  using SharedProxy = FunctionTraitsSharedProxy<
+      NonConstSignature,
+      N,
+      false,
+      ReturnType,
+      Args...>;
 };
 
-template <typename ReturnType, typename... Args>
-struct FunctionTraits<ReturnType(Args...) const> {
-  using Call = ReturnType (*)(CallArg<Args>..., Data&);
+template <typename ReturnType, typename... Args, std::size_t N>
+struct FunctionTraits<ReturnType(Args...) const, N> {
+  using Call = ReturnType (*)(CallArg<Args>..., void*);
   using ConstSignature = ReturnType(Args...) const;
   using NonConstSignature = ReturnType(Args...);
   using OtherSignature = NonConstSignature;
@@ -388,22 +410,26 @@ struct FunctionTraits<ReturnType(Args...) const> {
   static constexpr Call call =
       call_<const Fun, Small, false, ReturnType, CallArg<Args>...>;
 
-  static ReturnType uninitCall(CallArg<Args>..., Data&) {
+  static ReturnType uninitCall(CallArg<Args>..., void*) {
     throw_exception<std::bad_function_call>();
   }
 
   ReturnType operator()(Args... args) const {
-    auto& fn = *static_cast<const Function<ConstSignature>*>(this);
-    return fn.call_(static_cast<Args&&>(args)..., fn.data_);
+    auto& fn = *static_cast<const Function<ConstSignature, N>*>(this);
+    return fn.call_(static_cast<Args&&>(args)..., &fn.data_);
   }
 
-  using SharedProxy =
-      FunctionTraitsSharedProxy<ConstSignature, false, ReturnType, Args...>;
+  using SharedProxy = FunctionTraitsSharedProxy<
+      ConstSignature,
+      N,
+      false,
+      ReturnType,
+      Args...>;
 };
 
-template <typename ReturnType, typename... Args>
-struct FunctionTraits<ReturnType(Args...) noexcept> {
-  using Call = ReturnType (*)(CallArg<Args>..., Data&) noexcept;
+template <typename ReturnType, typename... Args, std::size_t N>
+struct FunctionTraits<ReturnType(Args...) noexcept, N> {
+  using Call = ReturnType (*)(CallArg<Args>..., void*) noexcept;
   using ConstSignature = ReturnType(Args...) const noexcept;
   using NonConstSignature = ReturnType(Args...) noexcept;
   using OtherSignature = ConstSignature;
@@ -418,22 +444,26 @@ struct FunctionTraits<ReturnType(Args...) noexcept> {
   static constexpr Call call =
       call_<Fun, Small, true, ReturnType, CallArg<Args>...>;
 
-  static ReturnType uninitCall(CallArg<Args>..., Data&) noexcept {
+  static ReturnType uninitCall(CallArg<Args>..., void*) noexcept {
     terminate_with<std::bad_function_call>();
   }
 
   ReturnType operator()(Args... args) noexcept {
-    auto& fn = *static_cast<Function<NonConstSignature>*>(this);
-    return fn.call_(static_cast<Args&&>(args)..., fn.data_);
+    auto& fn = *static_cast<Function<NonConstSignature, N>*>(this);
+    return fn.call_(static_cast<Args&&>(args)..., &fn.data_);
   }
 
-  using SharedProxy =
-      FunctionTraitsSharedProxy<NonConstSignature, true, ReturnType, Args...>;
+  using SharedProxy = FunctionTraitsSharedProxy<
+      NonConstSignature,
+      N,
+      true,
+      ReturnType,
+      Args...>;
 };
 
-template <typename ReturnType, typename... Args>
-struct FunctionTraits<ReturnType(Args...) const noexcept> {
-  using Call = ReturnType (*)(CallArg<Args>..., Data&) noexcept;
+template <typename ReturnType, typename... Args, std::size_t N>
+struct FunctionTraits<ReturnType(Args...) const noexcept, N> {
+  using Call = ReturnType (*)(CallArg<Args>..., void*) noexcept;
   using ConstSignature = ReturnType(Args...) const noexcept;
   using NonConstSignature = ReturnType(Args...) noexcept;
   using OtherSignature = NonConstSignature;
@@ -448,17 +478,21 @@ struct FunctionTraits<ReturnType(Args...) const noexcept> {
   static constexpr Call call =
       call_<const Fun, Small, true, ReturnType, CallArg<Args>...>;
 
-  static ReturnType uninitCall(CallArg<Args>..., Data&) noexcept {
+  static ReturnType uninitCall(CallArg<Args>..., void*) noexcept {
     terminate_with<std::bad_function_call>();
   }
 
   ReturnType operator()(Args... args) const noexcept {
-    auto& fn = *static_cast<const Function<ConstSignature>*>(this);
-    return fn.call_(static_cast<Args&&>(args)..., fn.data_);
+    auto& fn = *static_cast<const Function<ConstSignature, N>*>(this);
+    return fn.call_(static_cast<Args&&>(args)..., &fn.data_);
   }
 
-  using SharedProxy =
-      FunctionTraitsSharedProxy<ConstSignature, true, ReturnType, Args...>;
+  using SharedProxy = FunctionTraitsSharedProxy<
+      ConstSignature,
+      N,
+      true,
+      ReturnType,
+      Args...>;
 };
 
 // These are control functions. They type-erase the operations of move-
@@ -474,16 +508,16 @@ struct FunctionTraits<ReturnType(Args...) const noexcept> {
 // copies sizeof(Data) bytes rather than only copying sizeof(Fun) bytes, but
 // then for small function types it would be likely to cross cache lines without
 // need. But it is only necessary to handle those sizes which are multiples of
-// the alignof(Data), and to round up other sizes.
+// the pointer size, and to round up other sizes.
 struct DispatchSmallTrivial {
   static constexpr bool is_in_situ = true;
   static constexpr bool is_trivial = true;
 
   template <std::size_t Size>
-  static std::size_t exec_(Op o, Data* src, Data* dst) noexcept {
+  static std::size_t exec_(Op o, void* src, void* dst) noexcept {
     switch (o) {
       case Op::MOVE:
-        std::memcpy(static_cast<void*>(dst), static_cast<void*>(src), Size);
+        std::memcpy(dst, src, Size);
         break;
       case Op::NUKE:
         break;
@@ -494,7 +528,7 @@ struct DispatchSmallTrivial {
     }
     return 0U;
   }
-  template <std::size_t size, std::size_t adjust = alignof(Data) - 1>
+  template <std::size_t size, std::size_t adjust = sizeof(void*) - 1>
   static constexpr std::size_t size_ = (size + adjust) & ~adjust;
   template <typename Fun>
   static constexpr auto exec = exec_<size_<sizeof(Fun)>>;
@@ -512,41 +546,41 @@ struct DispatchBigTrivial {
   }
 
   template <bool IsAlignLarge>
-  static std::size_t exec_(Op o, Data* src, Data* dst) noexcept {
+  static std::size_t exec_(Op o, void* src, void* dst) noexcept {
+    auto& from = *static_cast<BigTrivialLayout*>(src);
     switch (o) {
       case Op::MOVE:
-        dst->bigt = src->bigt;
-        src->bigt = {};
+        ::new (dst) BigTrivialLayout(from);
+        from = {};
         break;
       case Op::NUKE:
         IsAlignLarge
             ? operator_delete(
-                  src->big, src->bigt.size, std::align_val_t(src->bigt.align))
-            : operator_delete(src->big, src->bigt.size);
+                  from.big, from.size, std::align_val_t(from.align))
+            : operator_delete(from.big, from.size);
         break;
       case Op::HEAP:
         break;
       default: /* unexpected */
         abort();
     }
-    return src->bigt.size;
+    return from.size;
   }
   template <typename T>
   static constexpr auto exec = exec_<is_align_large(alignof(T))>;
 
   FOLLY_ALWAYS_INLINE static void ctor(
-      Data& data,
+      void* data,
       void const* fun,
       std::size_t size,
       std::size_t align) noexcept {
     // cannot use type-specific new since type-specific new is overrideable
     // in concert with type-specific delete
-    data.bigt.big = is_align_large(align)
+    void* const big = is_align_large(align)
         ? operator_new(size, std::align_val_t(align))
         : operator_new(size);
-    data.bigt.size = size;
-    data.bigt.align = align;
-    std::memcpy(data.bigt.big, fun, size);
+    ::new (data) BigTrivialLayout{big, size, align};
+    std::memcpy(big, fun, size);
   }
 };
 
@@ -555,14 +589,13 @@ struct DispatchSmall {
   static constexpr bool is_trivial = false;
 
   template <typename Fun>
-  static std::size_t exec(Op o, Data* src, Data* dst) noexcept {
+  static std::size_t exec(Op o, void* src, void* dst) noexcept {
     switch (o) {
       case Op::MOVE:
-        ::new (static_cast<void*>(&dst->tiny)) Fun(static_cast<Fun&&>(
-            *static_cast<Fun*>(static_cast<void*>(&src->tiny))));
+        ::new (dst) Fun(static_cast<Fun&&>(*static_cast<Fun*>(src)));
         [[fallthrough]];
       case Op::NUKE:
-        static_cast<Fun*>(static_cast<void*>(&src->tiny))->~Fun();
+        static_cast<Fun*>(src)->~Fun();
         break;
       case Op::HEAP:
         break;
@@ -578,14 +611,15 @@ struct DispatchBig {
   static constexpr bool is_trivial = false;
 
   template <typename Fun>
-  static std::size_t exec(Op o, Data* src, Data* dst) noexcept {
+  static std::size_t exec(Op o, void* src, void* dst) noexcept {
+    auto& from = *static_cast<void**>(src);
     switch (o) {
       case Op::MOVE:
-        dst->big = src->big;
-        src->big = nullptr;
+        *static_cast<void**>(dst) = from;
+        from = nullptr;
         break;
       case Op::NUKE:
-        delete static_cast<Fun*>(src->big);
+        delete static_cast<Fun*>(from);
         break;
       case Op::HEAP:
         break;
@@ -609,8 +643,9 @@ struct Dispatch<false, false> : DispatchBig {};
 
 template <
     typename Fun,
-    bool InSituSize = sizeof(Fun) <= sizeof(Data),
-    bool InSituAlign = alignof(Fun) <= alignof(Data),
+    std::size_t Size = kFunctionInlineSize,
+    bool InSituSize = sizeof(Fun) <= Size,
+    bool InSituAlign = alignof(Fun) <= alignof(Data<Size>),
     bool InSituNoexcept = noexcept(Fun(FOLLY_DECLVAL(Fun)))>
 using DispatchOf = Dispatch<
     InSituSize && InSituAlign && InSituNoexcept,
@@ -619,24 +654,38 @@ using DispatchOf = Dispatch<
 // This cannot be done inseide `Function` class, because the word
 // `Function` there refers to the instantion and not the template.
 template <typename T>
-constexpr bool is_instantiation_of_folly_function_v =
-    is_instantiation_of_v<Function, T>;
+constexpr bool is_instantiation_of_folly_function_v = false;
+template <typename FunctionType, std::size_t InlineSize>
+constexpr bool
+    is_instantiation_of_folly_function_v<Function<FunctionType, InlineSize>> =
+        true;
 
 } // namespace function
 } // namespace detail
 
-template <typename FunctionType>
-class Function final : private detail::function::FunctionTraits<FunctionType> {
+template <typename FunctionType, std::size_t InlineSize>
+class Function final
+    : private detail::function::FunctionTraits<FunctionType, InlineSize> {
+  static_assert(
+      InlineSize % sizeof(void*) == 0,
+      "the inline size of a Function must be a multiple of the pointer size");
+  static_assert(
+      InlineSize >= sizeof(detail::function::BigTrivialLayout),
+      "the inline size of a Function must fit three pointers");
+
   // These utility types are defined outside of the template to reduce
   // the number of instantiations, and then imported in the class
   // namespace for convenience.
-  using Data = detail::function::Data;
+  using Data = detail::function::Data<InlineSize>;
   using Op = detail::function::Op;
   using CoerceTag = detail::function::CoerceTag;
 
-  using Traits = detail::function::FunctionTraits<FunctionType>;
+  template <typename Fun>
+  using DispatchOf = detail::function::DispatchOf<Fun, InlineSize>;
+
+  using Traits = detail::function::FunctionTraits<FunctionType, InlineSize>;
   using Call = typename Traits::Call;
-  using Exec = std::size_t (*)(Op, Data*, Data*) noexcept;
+  using Exec = std::size_t (*)(Op, void*, void*) noexcept;
 
   // The `data_` member is mutable to allow `constCastFunction` to work without
   // invoking undefined behavior. Const-correctness is only violated when
@@ -646,7 +695,7 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   Call call_{&Traits::uninitCall};
   Exec exec_{nullptr};
 
-  std::size_t exec(Op o, Data* src, Data* dst) const {
+  std::size_t exec(Op o, void* src, void* dst) const {
     if (!exec_) {
       return 0U;
     }
@@ -654,13 +703,26 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   }
 
   friend Traits;
-  friend Function<typename Traits::ConstSignature> folly::constCastFunction<>(
-      Function<typename Traits::NonConstSignature>&&) noexcept;
-  friend class Function<typename Traits::OtherSignature>;
+  friend Function<typename Traits::ConstSignature, InlineSize>
+  folly::constCastFunction<>(
+      Function<typename Traits::NonConstSignature, InlineSize>&&) noexcept;
+  template <typename, std::size_t>
+  friend class Function;
+
+  // Whether the callable of a `Function<Signature, N>` can be moved as is into
+  // this one: the call and exec functions do not depend on the inline size,
+  // and anything stored inline in the smaller buffer fits in the larger one.
+  template <typename Signature, std::size_t N>
+  static constexpr bool IsAdoptable = N <= InlineSize &&
+      (std::is_same<Signature, FunctionType>::value ||
+       std::is_same<Signature, typename Traits::OtherSignature>::value);
 
-  template <typename Signature>
-  Function(Function<Signature>&& fun, CoerceTag) {
-    using Fun = Function<Signature>;
+  template <
+      typename Signature,
+      std::size_t N,
+      std::enable_if_t<!IsAdoptable<Signature, N>, int> = 0>
+  Function(Function<Signature, N>&& fun, CoerceTag) {
+    using Fun = Function<Signature, N>;
     if (fun) {
       data_.big = new Fun(static_cast<Fun&&>(fun));
       call_ = Traits::template call<Fun, false>;
@@ -668,7 +730,11 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
     }
   }
 
-  Function(Function<typename Traits::OtherSignature>&& that, CoerceTag) noexcept
+  template <
+      typename Signature,
+      std::size_t N,
+      std::enable_if_t<IsAdoptable<Signature, N>, int> = 0>
+  Function(Function<Signature, N>&& that, CoerceTag) noexcept
       : call_(that.call_), exec_(that.exec_) {
     that.call_ = &Traits::uninitCall;
     that.exec_ = nullptr;
@@ -735,8 +801,8 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
           !detail::function::is_instantiation_of_folly_function_v<Fun>>,
       typename = typename Traits::template IfSafeResult<Fun>>
   /* implicit */ constexpr Function(Fun fun) noexcept(
-      detail::function::DispatchOf<Fun>::is_in_situ) {
-    using Dispatch = detail::function::DispatchOf<Fun>;
+      DispatchOf<Fun>::is_in_situ) {
+    using Dispatch = DispatchOf<Fun>;
     if constexpr (detail::function::IsNullptrCompatible<Fun>) {
       if (detail::function::isEmptyFunction(fun)) {
         return;
@@ -749,7 +815,7 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
       }
     } else {
       if constexpr (Dispatch::is_trivial) {
-        Dispatch::ctor(data_, &fun, sizeof(Fun), alignof(Fun));
+        Dispatch::ctor(&data_, &fun, sizeof(Fun), alignof(Fun));
       } else {
         data_.big = new Fun(static_cast<Fun&&>(fun));
       }
@@ -759,7 +825,7 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   }
 
   /**
-   * For move-constructing from a `folly::Function<X(Ys...) [const?]>`.
+   * For move-constructing from a `folly::Function<X(Ys...) [const?], N>`.
    *
    * For a `Function` with a `const` function type, the object must be
    * callable from a `const`-reference, i.e. implement `operator() const`.
@@ -767,14 +833,19 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
    * be called from a non-const reference, which means that it will execute
    * a non-const `operator()` if it is defined, and falls back to
    * `operator() const` otherwise.
+   *
+   * The callable is moved as is, without allocating, when the signatures only
+   * differ in constness and `N` is not larger than the inline size of this
+   * `Function`. Otherwise the whole `that` is moved onto the heap.
    */
   template <
       typename Signature,
-      typename Fun = Function<Signature>,
+      std::size_t N,
+      typename Fun = Function<Signature, N>,
       // prevent gcc from making this a better match than move-ctor
       typename = std::enable_if_t<!std::is_same<Function, Fun>::value>,
       typename = typename Traits::template IfSafeResult<Fun>>
-  Function(Function<Signature>&& that) noexcept(
+  Function(Function<Signature, N>&& that) noexcept(
       noexcept(Function(std::move(that), CoerceTag{})))
       : Function(std::move(that), CoerceTag{}) {}
 
@@ -855,13 +926,15 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   }
 
   /**
-   * For assigning from a `Function<X(Ys..) [const?]>`.
+   * For assigning from a `Function<X(Ys..) [const?], N>`.
    */
   template <
       typename Signature,
+      std::size_t N,
       typename...,
-      typename = typename Traits::template IfSafeResult<Function<Signature>>>
-  Function& operator=(Function<Signature>&& that) noexcept(
+      typename =
+          typename Traits::template IfSafeResult<Function<Signature, N>>>
+  Function& operator=(Function<Signature, N>&& that) noexcept(
       noexcept(Function(std::move(that)))) {
     return (*this = Function(std::move(that)));
   }
@@ -928,28 +1001,34 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   }
 };
 
-template <typename FunctionType>
-void swap(Function<FunctionType>& lhs, Function<FunctionType>& rhs) noexcept {
+template <typename FunctionType, std::size_t InlineSize>
+void swap(
+    Function<FunctionType, InlineSize>& lhs,
+    Function<FunctionType, InlineSize>& rhs) noexcept {
   lhs.swap(rhs);
 }
 
-template <typename FunctionType>
-bool operator==(const Function<FunctionType>& fn, std::nullptr_t) {
+template <typename FunctionType, std::size_t InlineSize>
+bool operator==(
+    const Function<FunctionType, InlineSize>& fn, std::nullptr_t) {
   return !fn;
 }
 
-template <typename FunctionType>
-bool operator==(std::nullptr_t, const Function<FunctionType>& fn) {
+template <typename FunctionType, std::size_t InlineSize>
+bool operator==(
+    std::nullptr_t, const Function<FunctionType, InlineSize>& fn) {
   return !fn;
 }
 
-template <typename FunctionType>
-bool operator!=(const Function<FunctionType>& fn, std::nullptr_t) {
+template <typename FunctionType, std::size_t InlineSize>
+bool operator!=(
+    const Function<FunctionType, InlineSize>& fn, std::nullptr_t) {
   return !(fn == nullptr);
 }
 
-template <typename FunctionType>
-bool operator!=(std::nullptr_t, const Function<FunctionType>& fn) {
+template <typename FunctionType, std::size_t InlineSize>
+bool operator!=(
+    std::nullptr_t, const Function<FunctionType, InlineSize>& fn) {
   return !(nullptr == fn);
 }
 
@@ -976,29 +1055,29 @@ bool operator!=(std::nullptr_t, const Function<FunctionType>& fn) {
  *
  * @param that a non-const folly::Function.
  */
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const> constCastFunction(
-    Function<ReturnType(Args...)>&& that) noexcept {
-  return Function<ReturnType(Args...) const>{
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const, InlineSize> constCastFunction(
+    Function<ReturnType(Args...), InlineSize>&& that) noexcept {
+  return Function<ReturnType(Args...) const, InlineSize>{
       std::move(that), detail::function::CoerceTag{}};
 }
 
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const> constCastFunction(
-    Function<ReturnType(Args...) const>&& that) noexcept {
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const, InlineSize> constCastFunction(
+    Function<ReturnType(Args...) const, InlineSize>&& that) noexcept {
   return std::move(that);
 }
 
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const noexcept> constCastFunction(
-    Function<ReturnType(Args...) noexcept>&& that) noexcept {
-  return Function<ReturnType(Args...) const noexcept>{
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const noexcept, InlineSize> constCastFunction(
+    Function<ReturnType(Args...) noexcept, InlineSize>&& that) noexcept {
+  return Function<ReturnType(Args...) const noexcept, InlineSize>{
       std::move(that), detail::function::CoerceTag{}};
 }
 
-template <typename ReturnType, typename... Args>
-Function<ReturnType(Args...) const noexcept> constCastFunction(
-    Function<ReturnType(Args...) const noexcept>&& that) noexcept {
+template <typename ReturnType, typename... Args, std::size_t InlineSize>
+Function<ReturnType(Args...) const noexcept, InlineSize> constCastFunction(
+    Function<ReturnType(Args...) const noexcept, InlineSize>&& that) noexcept {
   return std::move(that);
 }
 
@@ -38,14 +38,17 @@ size_t hash_value(const IPAddress& addr) {
   return addr.hash();
 }
 ostream& operator<<(ostream& os, const IPAddress& addr) {
-  os << addr.str();
+  char buffer[IPAddress::kMaxStrSize];
+  os.write(buffer, addr.toBuffer(buffer));
   return os;
 }
 void toAppend(IPAddress addr, string* result) {
-  result->append(addr.str());
+  char buffer[IPAddress::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 void toAppend(IPAddress addr, fbstring* result) {
-  result->append(addr.str());
+  char buffer[IPAddress::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 
 bool IPAddress::validate(StringPiece ip) noexcept {
@@ -88,6 +88,10 @@ class IPAddress {
       return IPAddress();
     }
     std::string str() const { return ""; }
+    size_t toBuffer(char* out) const noexcept {
+      (void)out;
+      return 0;
+    }
     std::string toFullyQualified() const { return ""; }
     void toFullyQualifiedAppend(std::string& out) const {
       (void)out;
@@ -105,6 +109,11 @@ class IPAddress {
   }
 
  public:
+  /**
+   * Max size of the string written by toBuffer()
+   */
+  static constexpr size_t kMaxStrSize = IPAddressV6::kMaxStrSize;
+
   /**
    * Returns true if the input string can be parsed as an IP address.
    */
@@ -540,6 +549,15 @@ class IPAddress {
     return pick([&](auto& _) { return _.str(); });
   }
 
+  /**
+   * Writes the same string as str() to out, which must have room for
+   * kMaxStrSize characters, and returns its length. No null terminator is
+   * written, and nothing is allocated.
+   */
+  size_t toBuffer(char* out) const noexcept {
+    return pick([&](auto& _) { return _.toBuffer(out); });
+  }
+
   /**
    * Return the fully qualified string representation of the address.
    *
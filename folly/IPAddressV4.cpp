@@ -37,14 +37,17 @@ size_t hash_value(const IPAddressV4& addr) {
   return addr.hash();
 }
 ostream& operator<<(ostream& os, const IPAddressV4& addr) {
-  os << addr.str();
+  char buffer[IPAddressV4::kMaxStrSize];
+  os.write(buffer, addr.toBuffer(buffer));
   return os;
 }
 void toAppend(IPAddressV4 addr, string* result) {
-  result->append(addr.str());
+  char buffer[IPAddressV4::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 void toAppend(IPAddressV4 addr, fbstring* result) {
-  result->append(addr.str());
+  char buffer[IPAddressV4::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 
 bool IPAddressV4::validate(StringPiece ip) noexcept {
@@ -66,13 +69,12 @@ IPAddressV4 IPAddressV4::fromLongHBO(uint32_t src) {
 
 // static public
 uint32_t IPAddressV4::toLong(StringPiece ip) {
-  auto str = ip.str();
-  in_addr addr;
-  if (inet_pton(AF_INET, str.c_str(), &addr) != 1) {
+  auto maybeIp = tryFromString(ip);
+  if (maybeIp.hasError()) {
     throw IPAddressFormatException(
         fmt::format("Can't convert invalid IP '{}' to long", ip));
   }
-  return addr.s_addr;
+  return maybeIp->toLong();
 }
 
 // static public
@@ -98,11 +100,11 @@ IPAddressV4::IPAddressV4(StringPiece addr) : addr_() {
 
 Expected<IPAddressV4, IPAddressFormatError> IPAddressV4::tryFromString(
     StringPiece str) noexcept {
-  struct in_addr inAddr;
-  if (inet_pton(AF_INET, str.str().c_str(), &inAddr) != 1) {
+  ByteArray4 bytes;
+  if (!detail::fastIpv4FromBuffer(str.data(), str.size(), bytes.data())) {
     return makeUnexpected(IPAddressFormatError::INVALID_IP);
   }
-  return IPAddressV4(inAddr);
+  return IPAddressV4(bytes);
 }
 
 // in_addr constructor
@@ -258,6 +260,11 @@ string IPAddressV4::str() const {
   return detail::fastIpv4ToString(addr_.inAddr_);
 }
 
+// public
+size_t IPAddressV4::toBuffer(char* out) const noexcept {
+  return detail::fastIpV4ToBufferUnsafe(addr_.inAddr_, out);
+}
+
 // public
 void IPAddressV4::toFullyQualifiedAppend(std::string& out) const {
   detail::fastIpv4AppendToString(addr_.inAddr_, out);
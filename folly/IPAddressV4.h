@@ -61,6 +61,11 @@ class IPAddressV4 {
   static constexpr size_t kMaxToFullyQualifiedSize =
       4 /*words*/ * 3 /*max chars per word*/ + 3 /*separators*/;
 
+  /**
+   * Max size of the string written by toBuffer()
+   */
+  static constexpr size_t kMaxStrSize = kMaxToFullyQualifiedSize;
+
   /**
    * Returns true if the input string can be parsed as an IP address.
    */
@@ -291,12 +296,17 @@ class IPAddressV4 {
   /**
    * Provides a string representation of address.
    *
-   * @throws if IPAddressFormatException on `inet_ntop` error.
-   *
    * The string representation is calculated on demand.
    */
   std::string str() const;
 
+  /**
+   * Writes the same string as str() to out, which must have room for
+   * kMaxStrSize characters, and returns its length. No null terminator is
+   * written, and nothing is allocated.
+   */
+  size_t toBuffer(char* out) const noexcept;
+
   /**
    * Create the inverse arpa representation of the IP address.
    *
@@ -17,6 +17,7 @@
 #include <folly/IPAddressV6.h>
 
 #include <algorithm>
+#include <limits>
 #include <ostream>
 #include <string>
 
@@ -25,9 +26,9 @@
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/MacAddress.h>
-#include <folly/ScopeGuard.h>
 #include <folly/String.h>
 #include <folly/detail/IPAddressSource.h>
+#include <folly/lang/ToAscii.h>
 
 #ifdef _WIN32
 // Because of the massive pain that is libnl, this can't go into the socket
@@ -56,16 +57,56 @@ size_t hash_value(const IPAddressV6& addr) {
   return addr.hash();
 }
 ostream& operator<<(ostream& os, const IPAddressV6& addr) {
-  os << addr.str();
+  char buffer[IPAddressV6::kMaxStrSize];
+  os.write(buffer, addr.toBuffer(buffer));
   return os;
 }
 void toAppend(IPAddressV6 addr, string* result) {
-  result->append(addr.str());
+  char buffer[IPAddressV6::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 void toAppend(IPAddressV6 addr, fbstring* result) {
-  result->append(addr.str());
+  char buffer[IPAddressV6::kMaxStrSize];
+  result->append(buffer, addr.toBuffer(buffer));
 }
 
+namespace {
+
+// Resolves the scope id after the % of an address the way getaddrinfo does:
+// interface names are only looked up for link-local addresses, and any scope
+// id may be a decimal number.
+Optional<uint32_t> tryParseScopeId(const uint8_t* bytes, StringPiece scope) {
+  if (scope.empty()) {
+    return none;
+  }
+  bool const linkLocal = (bytes[0] == 0xfe && (bytes[1] & 0xc0) == 0x80) ||
+      (bytes[0] == 0xff && (bytes[1] & 0x0f) == 0x02);
+  if (linkLocal && scope.size() < IFNAMSIZ) {
+    char name[IFNAMSIZ];
+    std::memcpy(name, scope.data(), scope.size());
+    name[scope.size()] = '\0';
+    auto errsv = errno;
+    auto index = if_nametoindex(name);
+    errno = errsv;
+    if (index != 0) {
+      return uint32_t(index);
+    }
+  }
+  uint64_t number = 0;
+  for (char c : scope) {
+    if (unsigned(c - '0') >= 10) {
+      return none;
+    }
+    number = number * 10 + unsigned(c - '0');
+    if (number > std::numeric_limits<uint32_t>::max()) {
+      return none;
+    }
+  }
+  return uint32_t(number);
+}
+
+} // namespace
+
 bool IPAddressV6::validate(StringPiece ip) noexcept {
   return tryFromString(ip).hasValue();
 }
@@ -85,36 +126,31 @@ IPAddressV6::IPAddressV6(StringPiece addr) {
 
 Expected<IPAddressV6, IPAddressFormatError> IPAddressV6::tryFromString(
     StringPiece str) noexcept {
-  constexpr size_t kMaxSize = 45;
-
   // Allow addresses surrounded in brackets
   if (str.size() < 2) {
     return makeUnexpected(IPAddressFormatError::INVALID_IP);
   }
 
   auto ip = str.front() == '[' && str.back() == ']'
-      ? str.subpiece(1, std::min(str.size() - 2, kMaxSize))
-      : str.subpiece(0, std::min(str.size(), kMaxSize));
-
-  std::array<char, kMaxSize + 1> ipBuffer;
-  std::copy(ip.begin(), ip.end(), ipBuffer.begin());
-  ipBuffer[ip.size()] = '\0';
-
-  struct addrinfo* result;
-  struct addrinfo hints;
-  memset(&hints, 0, sizeof(hints));
-  hints.ai_family = AF_INET6;
-  hints.ai_socktype = SOCK_STREAM;
-  hints.ai_flags = AI_NUMERICHOST;
-  if (::getaddrinfo(ipBuffer.data(), nullptr, &hints, &result) == 0) {
-    SCOPE_EXIT {
-      ::freeaddrinfo(result);
-    };
-    const struct sockaddr_in6* sa =
-        reinterpret_cast<struct sockaddr_in6*>(result->ai_addr);
-    return IPAddressV6(*sa);
+      ? str.subpiece(1, str.size() - 2)
+      : str;
+
+  auto const percent = ip.find('%');
+  auto const addr = ip.subpiece(0, percent);
+  ByteArray16 bytes;
+  if (!detail::fastIpv6FromBuffer(addr.data(), addr.size(), bytes.data())) {
+    return makeUnexpected(IPAddressFormatError::INVALID_IP);
   }
-  return makeUnexpected(IPAddressFormatError::INVALID_IP);
+
+  IPAddressV6 result(bytes);
+  if (percent != StringPiece::npos) {
+    auto scope = tryParseScopeId(bytes.data(), ip.subpiece(percent + 1));
+    if (!scope) {
+      return makeUnexpected(IPAddressFormatError::INVALID_IP);
+    }
+    result.setScopeId(uint16_t(*scope));
+  }
+  return result;
 }
 
 // in6_addr constructor
@@ -443,30 +479,36 @@ IPAddressV6 IPAddressV6::mask(size_t numBits) const {
 
 // public
 string IPAddressV6::str() const {
-  char buffer[INET6_ADDRSTRLEN + IFNAMSIZ + 1];
+  char buffer[kMaxStrSize];
+  return string(buffer, toBuffer(buffer));
+}
 
-  if (!inet_ntop(AF_INET6, toAddr().s6_addr, buffer, INET6_ADDRSTRLEN)) {
-    throw IPAddressFormatException(fmt::format(
-        "Invalid address with hex '{}' with error {}",
-        detail::Bytes::toHex(bytes(), 16),
-        errnoStr(errno)));
-  }
+// public
+size_t IPAddressV6::toBuffer(char* out) const noexcept {
+  // The formatting may clobber a few characters past the address.
+  char buffer[INET6_ADDRSTRLEN];
+  auto len = detail::fastIpv6ToCompressedBufferUnsafe(addr_.in6Addr_, buffer);
+  std::memcpy(out, buffer, len);
 
   auto scopeId = getScopeId();
   if (scopeId != 0) {
-    auto len = strlen(buffer);
-    buffer[len] = '%';
+    out[len++] = '%';
 
+    char name[IFNAMSIZ];
     auto errsv = errno;
-    if (!if_indextoname(scopeId, buffer + len + 1)) {
+    auto nameLen = if_indextoname(scopeId, name) ? std::strlen(name) : 0;
+    if (nameLen != 0 && nameLen <= kMaxStrSize - len) {
+      std::memcpy(out + len, name, nameLen);
+      len += nameLen;
+    } else {
       // if we can't map the if because eg. it no longer exists,
       // append the if index instead
-      snprintf(buffer + len + 1, IFNAMSIZ, "%u", scopeId);
+      len += to_ascii_decimal(out + len, out + kMaxStrSize, scopeId);
     }
     errno = errsv;
   }
 
-  return string(buffer);
+  return len;
 }
 
 // public
@@ -99,6 +99,12 @@ class IPAddressV6 {
   static constexpr size_t kToFullyQualifiedSize =
       8 /*words*/ * 4 /*hex chars per word*/ + 7 /*separators*/;
 
+  /**
+   * Max size of the string written by toBuffer()
+   */
+  static constexpr size_t kMaxStrSize =
+      45 /*IPv4-mapped address*/ + 1 /*%*/ + 15 /*interface name*/;
+
   /**
    * Return true if the input string can be parsed as an IPv6 addres
    */
@@ -437,12 +443,18 @@ class IPAddressV6 {
   /**
    * Provides a string representation of address.
    *
-   * Throws an IPAddressFormatException on `inet_ntop` error.
-   *
-   * The string representation is calculated on demand.
+   * This is the format of inet_ntop, with the scope id, if any, appended after
+   * a %. The string representation is calculated on demand.
    */
   std::string str() const;
 
+  /**
+   * Writes the same string as str() to out, which must have room for
+   * kMaxStrSize characters, and returns its length. No null terminator is
+   * written, and nothing is allocated.
+   */
+  size_t toBuffer(char* out) const noexcept;
+
   /**
    * Returns the version of the IP Address.
    *
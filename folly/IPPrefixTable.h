@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Longest prefix match tables for IP addresses.
+ *
+ * IPPrefixTable<T> maps CIDR networks to values of type T, and looks up the
+ * value of the longest network containing an address:
+ *
+ *   IPPrefixTable<std::string> table;
+ *   table.insert(IPAddress::createNetwork("10.0.0.0/8"), "private");
+ *   table.insert(IPAddress::createNetwork("10.1.0.0/16"), "lab");
+ *   *table.lookup(IPAddressV4("10.1.2.3")); // "lab"
+ *   *table.lookup(IPAddressV4("10.2.3.4")); // "private"
+ *   table.lookup(IPAddressV4("11.0.0.1")); // nullptr
+ *
+ * Each address family is a multibit trie, with a 16 bit root level and 8 bit
+ * levels below it. Networks are expanded to the end of their level, and each
+ * slot holds the value of the longest network covering it, so a lookup is one
+ * load per level of the longest network on its path: at most 3 for IPv4, and
+ * 7 for IPv6 networks up to /64. The root level of a family takes 512KB, and
+ * the levels below it a 2KB node per distinct 16, 24, ... bit prefix of the
+ * networks longer than that.
+ *
+ * Inserting a network only touches the slots it covers, but erasing one
+ * rebuilds the table. The batch lookups prefetch the root slots of the
+ * addresses a few lookups ahead.
+ *
+ * IPPrefixTable isn't thread-safe for writes. ConcurrentIPPrefixTable<T>
+ * publishes tables to readers with RCU: lookups don't take locks, and
+ * updates modify a copy of the table which replaces it.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <folly/CPortability.h>
+#include <folly/IPAddress.h>
+#include <folly/Range.h>
+#include <folly/synchronization/Rcu.h>
+
+namespace folly {
+
+namespace detail {
+
+/**
+ * Multibit trie over keys of Bytes bytes: the root level is indexed by the
+ * first 2 bytes of the key, and each level below it by the next byte.
+ *
+ * Each slot holds a value, 0 for none, and the length of the prefix it comes
+ * from. A prefix is expanded to all the slots of the level where it ends, and
+ * copied down to the levels below them unless a longer prefix covers them, so
+ * a lookup returns the value of the last slot on its path.
+ */
+template <size_t Bytes>
+class IPPrefixTrie {
+ public:
+  static_assert(Bytes >= 2, "the root level takes 2 bytes");
+
+  using Key = std::array<uint8_t, Bytes>;
+
+  void insert(const Key& key, uint8_t len, uint32_t value) {
+    if (slots_.empty()) {
+      slots_.resize(kRootSlots);
+      lens_.resize(kRootSlots);
+    }
+    size_t const level = len <= 16 ? 0 : (len - 16 + 7) / 8;
+    size_t node = 0;
+    size_t index = (size_t(key[0]) << 8) | key[1];
+    for (size_t i = 0; i < level; ++i) {
+      node = child(node + index);
+      index = key[i + 2];
+    }
+    size_t const span = size_t(1) << (16 + 8 * level - len);
+    index &= ~(span - 1);
+    for (size_t i = index; i < index + span; ++i) {
+      assign(node + i, len, value);
+    }
+  }
+
+  uint32_t lookup(const uint8_t* key) const {
+    if (slots_.empty()) {
+      return 0;
+    }
+    auto const slots = slots_.data();
+    Slot slot = slots[(size_t(key[0]) << 8) | key[1]];
+    for (size_t i = 2; slot.child != 0; ++i) {
+      slot = slots[slot.child + key[i]];
+    }
+    return slot.value;
+  }
+
+  /**
+   * Look up the keys getKey(0), ..., getKey(n - 1) into out, prefetching the
+   * root slots of the keys a few lookups ahead.
+   */
+  template <typename GetKey>
+  void lookup(size_t n, GetKey getKey, uint32_t* out) const {
+    if (slots_.empty()) {
+      std::fill(out, out + n, 0);
+      return;
+    }
+    constexpr size_t kAhead = 8;
+    auto const slots = slots_.data();
+    auto root = [&](size_t i) {
+      auto const key = getKey(i);
+      return slots + ((size_t(key[0]) << 8) | key[1]);
+    };
+    for (size_t i = 0; i < std::min(kAhead, n); ++i) {
+      prefetch(root(i));
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (i + kAhead < n) {
+        prefetch(root(i + kAhead));
+      }
+      out[i] = lookup(getKey(i));
+    }
+  }
+
+  void clear() {
+    slots_.clear();
+    lens_.clear();
+  }
+
+ private:
+  static constexpr size_t kRootSlots = size_t(1) << 16;
+  static constexpr size_t kNodeSlots = size_t(1) << 8;
+
+  struct Slot {
+    uint32_t value;
+    // Offset of the node of the next level, 0 for none since the root level
+    // is at offset 0.
+    uint32_t child;
+  };
+
+  static void prefetch(const void* p) {
+#if FOLLY_HAS_BUILTIN(__builtin_prefetch)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+  }
+
+  // The offset of the child node of a slot, created from the slot if needed.
+  size_t child(size_t slot) {
+    if (slots_[slot].child == 0) {
+      auto const offset = slots_.size();
+      slots_.resize(offset + kNodeSlots, Slot{slots_[slot].value, 0});
+      lens_.resize(offset + kNodeSlots, lens_[slot]);
+      slots_[slot].child = uint32_t(offset);
+    }
+    return slots_[slot].child;
+  }
+
+  void assign(size_t slot, uint8_t len, uint32_t value) {
+    if (lens_[slot] > len) {
+      // A longer prefix covers this slot and its children.
+      return;
+    }
+    slots_[slot].value = value;
+    lens_[slot] = len;
+    if (auto const node = slots_[slot].child) {
+      for (size_t i = 0; i < kNodeSlots; ++i) {
+        assign(node + i, len, value);
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  // Kept apart from the slots, since lookups don't need them.
+  std::vector<uint8_t> lens_;
+};
+
+} // namespace detail
+
+template <typename T>
+class IPPrefixTable {
+ public:
+  using value_type = T;
+
+  /**
+   * Map a network to a value, replacing the value of the network if it was
+   * already in the table. The host bits of the address are ignored.
+   *
+   * Returns whether the network is new. Throws IPAddressFormatException if
+   * the prefix length is longer than the address, and
+   * InvalidAddressFamilyException if the address is empty.
+   */
+  bool insert(const CIDRNetwork& network, T value) {
+    auto const& [addr, len] = network;
+    return addr.isV4() ? insert(addr.asV4(), len, std::move(value))
+                       : insert(addr.asV6(), len, std::move(value));
+  }
+  bool insert(const IPAddressV4& addr, uint8_t len, T value) {
+    return insertInto(v4_, addr.mask(len).toByteArray(), len, std::move(value));
+  }
+  bool insert(const IPAddressV6& addr, uint8_t len, T value) {
+    return insertInto(v6_, addr.mask(len).toByteArray(), len, std::move(value));
+  }
+
+  /**
+   * Remove a network from the table, which is rebuilt. Returns whether the
+   * network was in the table.
+   */
+  bool erase(const CIDRNetwork& network) {
+    auto const& [addr, len] = network;
+    return addr.isV4() ? erase(addr.asV4(), len) : erase(addr.asV6(), len);
+  }
+  bool erase(const IPAddressV4& addr, uint8_t len) {
+    return eraseFrom(v4_, addr.mask(len).toByteArray(), len);
+  }
+  bool erase(const IPAddressV6& addr, uint8_t len) {
+    return eraseFrom(v6_, addr.mask(len).toByteArray(), len);
+  }
+
+  /**
+   * The value of the longest network containing an address, or nullptr if
+   * there is none. IPv4 addresses are only looked up among IPv4 networks,
+   * and IPv6 addresses, including IPv4-mapped ones, among IPv6 networks.
+   */
+  const T* lookup(const IPAddress& addr) const {
+    return addr.isV4() ? lookup(addr.asV4())
+        : addr.isV6()  ? lookup(addr.asV6())
+                       : nullptr;
+  }
+  const T* lookup(const IPAddressV4& addr) const {
+    return get(v4_.trie.lookup(addr.bytes()));
+  }
+  const T* lookup(const IPAddressV6& addr) const {
+    return get(v6_.trie.lookup(addr.bytes()));
+  }
+
+  /**
+   * Look up each address of addrs into the same position of out, which must
+   * be at least as large.
+   */
+  void lookup(Range<const IPAddressV4*> addrs, const T** out) const {
+    lookupInto(v4_, addrs, out);
+  }
+  void lookup(Range<const IPAddressV6*> addrs, const T** out) const {
+    lookupInto(v6_, addrs, out);
+  }
+
+  /**
+   * The number of networks in the table.
+   */
+  size_t size() const { return v4_.networks.size() + v6_.networks.size(); }
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    v4_ = {};
+    v6_ = {};
+    values_.clear();
+  }
+
+ private:
+  template <size_t Bytes>
+  struct Family {
+    using Key = typename detail::IPPrefixTrie<Bytes>::Key;
+
+    detail::IPPrefixTrie<Bytes> trie;
+    // Index into values_ of each network.
+    std::map<std::pair<Key, uint8_t>, uint32_t> networks;
+  };
+
+  template <typename F>
+  bool insertInto(
+      F& family, const typename F::Key& key, uint8_t len, T value) {
+    auto [it, inserted] = family.networks.emplace(
+        std::make_pair(key, len), uint32_t(values_.size()));
+    if (!inserted) {
+      values_[it->second] = std::move(value);
+      return false;
+    }
+    values_.push_back(std::move(value));
+    family.trie.insert(key, len, it->second + 1);
+    return true;
+  }
+
+  template <typename F>
+  bool eraseFrom(F& family, const typename F::Key& key, uint8_t len) {
+    auto it = family.networks.find(std::make_pair(key, len));
+    if (it == family.networks.end()) {
+      return false;
+    }
+    family.networks.erase(it);
+    rebuild();
+    return true;
+  }
+
+  // Rebuild the tries and compact values_ after an erase.
+  void rebuild() {
+    std::vector<T> values;
+    values.reserve(size());
+    auto rebuildFamily = [&](auto& family) {
+      family.trie.clear();
+      for (auto& [network, index] : family.networks) {
+        values.push_back(std::move(values_[index]));
+        index = uint32_t(values.size() - 1);
+        family.trie.insert(network.first, network.second, index + 1);
+      }
+    };
+    rebuildFamily(v4_);
+    rebuildFamily(v6_);
+    values_ = std::move(values);
+  }
+
+  template <typename F, typename Addr>
+  void lookupInto(
+      const F& family, Range<const Addr*> addrs, const T** out) const {
+    constexpr size_t kChunk = 64;
+    uint32_t indices[kChunk];
+    while (!addrs.empty()) {
+      auto const n = std::min(kChunk, addrs.size());
+      family.trie.lookup(
+          n, [&](size_t i) { return addrs[i].bytes(); }, indices);
+      for (size_t i = 0; i < n; ++i) {
+        out[i] = get(indices[i]);
+      }
+      addrs.advance(n);
+      out += n;
+    }
+  }
+
+  const T* get(uint32_t index) const {
+    return index == 0 ? nullptr : &values_[index - 1];
+  }
+
+  Family<4> v4_;
+  Family<16> v6_;
+  std::vector<T> values_;
+};
+
+/**
+ * An IPPrefixTable for concurrent readers.
+ *
+ * Readers look up the current table inside an RCU read-side critical
+ * section, without locks. Writers are serialized: update() copies the table,
+ * modifies the copy and publishes it, and the replaced table is freed once
+ * the readers which may use it are done. An update costs a copy of the
+ * table, so batch changes into one update(), or build a table and publish it
+ * with set().
+ */
+template <typename T>
+class ConcurrentIPPrefixTable {
+ public:
+  ConcurrentIPPrefixTable() : table_(new IPPrefixTable<T>()) {}
+
+  explicit ConcurrentIPPrefixTable(IPPrefixTable<T> table)
+      : table_(new IPPrefixTable<T>(std::move(table))) {}
+
+  ConcurrentIPPrefixTable(const ConcurrentIPPrefixTable&) = delete;
+  ConcurrentIPPrefixTable& operator=(const ConcurrentIPPrefixTable&) = delete;
+
+  ~ConcurrentIPPrefixTable() { delete table_.load(std::memory_order_relaxed); }
+
+  /**
+   * A copy of the value of the longest network containing addr, see
+   * IPPrefixTable::lookup().
+   */
+  template <typename Addr>
+  std::optional<T> lookup(const Addr& addr) const {
+    return withTable([&](const IPPrefixTable<T>& table) {
+      auto value = table.lookup(addr);
+      return value ? std::optional<T>(*value) : std::nullopt;
+    });
+  }
+
+  /**
+   * Call f with the current table, which it must not keep a reference to, or
+   * to its values, after it returns. f must not call update() or set().
+   */
+  template <typename F>
+  decltype(auto) withTable(F&& f) const {
+    std::scoped_lock<rcu_domain> guard(rcu_default_domain());
+    return std::forward<F>(f)(
+        std::as_const(*table_.load(std::memory_order_acquire)));
+  }
+
+  /**
+   * Call f with a copy of the current table, and publish it.
+   */
+  template <typename F>
+  void update(F&& f) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto table = std::make_unique<IPPrefixTable<T>>(
+        *table_.load(std::memory_order_relaxed));
+    std::forward<F>(f)(*table);
+    publish(std::move(table));
+  }
+
+  /**
+   * Publish a new table.
+   */
+  void set(IPPrefixTable<T> table) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish(std::make_unique<IPPrefixTable<T>>(std::move(table)));
+  }
+
+ private:
+  void publish(std::unique_ptr<IPPrefixTable<T>> table) {
+    rcu_retire(table_.exchange(table.release(), std::memory_order_acq_rel));
+  }
+
+  std::atomic<IPPrefixTable<T>*> table_;
+  std::mutex mutex_;
+};
+
+} // namespace folly
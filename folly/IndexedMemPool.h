@@ -20,10 +20,13 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <limits>
 #include <type_traits>
 
 #include <folly/Portability.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/lang/Bits.h>
 #include <folly/portability/SysMman.h>
 #include <folly/portability/Unistd.h>
 #include <folly/synchronization/AtomicStruct.h>
@@ -144,12 +147,19 @@ using IndexedMemPoolTraitsEagerRecycle = IndexedMemPoolTraits<T, true, true>;
 /// global free list.  This allows items to be efficiently recirculated
 /// from consumers to producers.  AccessSpreader is used to access the
 /// local lists, so there is no performance advantage to having more
-/// local lists than L1 caches.
+/// local lists than L1 caches.  The local lists are per-CPU stripes
+/// rather than per-thread caches, so the number of elements they can hold
+/// does not grow with the number of threads.
 ///
-/// The pool mmap-s the entire necessary address space when the pool is
-/// constructed, but delays element construction.  This means that only
-/// elements that are actually returned to the caller get paged into the
-/// process's resident set (RSS).
+/// The pool mmap-s its slots in segments, as indices are first handed
+/// out, and delays element construction.  The first segment spans about
+/// 64KiB and each later one doubles the number of slots, so there are
+/// only a few segments, and a capacity sized for the peak (or the default
+/// one, bounded only by the index space) costs nothing until it is used.
+/// Segments are only unmapped when the pool is destroyed, which keeps
+/// recycled elements readable.  A segment's pages are first touched by
+/// the threads that allocate from it, so under the default first-touch
+/// memory policy they are placed on the NUMA node of those threads.
 template <
     typename T,
     uint32_t NumLocalLists_ = 32,
@@ -191,27 +201,15 @@ struct IndexedMemPool {
   }
 
   /// Constructs a pool that can allocate at least _capacity_ elements,
-  /// even if all the local lists are full
-  explicit IndexedMemPool(uint32_t capacity)
+  /// even if all the local lists are full.  Memory is only mapped as the
+  /// pool grows, so by default the capacity is bounded by the index space.
+  explicit IndexedMemPool(
+      uint32_t capacity = std::numeric_limits<uint32_t>::max())
       : actualCapacity_(maxIndexForCapacity(capacity)),
         size_(0),
         globalHead_(TaggedPtr{}) {
-    const size_t needed = sizeof(Slot) * (actualCapacity_ + 1);
-    size_t pagesize = size_t(sysconf(_SC_PAGESIZE));
-    mmapLength_ = ((needed - 1) & ~(pagesize - 1)) + pagesize;
-    assert(needed <= mmapLength_ && mmapLength_ < needed + pagesize);
-    assert((mmapLength_ % pagesize) == 0);
-
-    slots_ = static_cast<Slot*>(mmap(
-        nullptr,
-        mmapLength_,
-        PROT_READ | PROT_WRITE,
-        MAP_PRIVATE | MAP_ANONYMOUS,
-        -1,
-        0));
-    if (slots_ == MAP_FAILED) {
-      assert(errno == ENOMEM);
-      throw std::bad_alloc();
+    for (auto& segment : segments_) {
+      segment.store(nullptr, std::memory_order_relaxed);
     }
   }
 
@@ -219,11 +217,16 @@ struct IndexedMemPool {
   ~IndexedMemPool() {
     using A = Atom<uint32_t>;
     for (uint32_t i = maxAllocatedIndex(); i > 0; --i) {
-      Traits::cleanup(slots_[i].elemPtr());
-      slots_[i].localNext.~A();
-      slots_[i].globalNext.~A();
+      Slot& s = slot(i);
+      Traits::cleanup(s.elemPtr());
+      s.localNext.~A();
+      s.globalNext.~A();
+    }
+    for (uint32_t seg = 0; seg < kMaxSegments; ++seg) {
+      if (auto slots = segments_[seg].load(std::memory_order_relaxed)) {
+        munmap(slots, segmentMapLength(seg));
+      }
     }
-    munmap(slots_, mmapLength_);
   }
 
   /// Returns a lower bound on the number of elements that may be
@@ -291,7 +294,17 @@ struct IndexedMemPool {
 
     auto slot = reinterpret_cast<const Slot*>(
         reinterpret_cast<const char*>(elem) - offsetof(Slot, elemStorage));
-    auto rv = uint32_t(slot - slots_);
+    auto addr = reinterpret_cast<uintptr_t>(slot);
+    uint32_t rv = 0;
+    for (uint32_t seg = 0; seg < kMaxSegments; ++seg) {
+      auto slots = segments_[seg].load(std::memory_order_acquire);
+      auto begin = reinterpret_cast<uintptr_t>(slots);
+      if (slots && begin <= addr &&
+          addr < begin + sizeof(Slot) * segmentLength(seg)) {
+        rv = segmentBase(seg) + uint32_t(slot - slots);
+        break;
+      }
+    }
 
     // this assert also tests that rv is in range
     assert(elem == &(*this)[rv]);
@@ -362,16 +375,24 @@ struct IndexedMemPool {
     LocalList() : head(TaggedPtr{}) {}
   };
 
-  ////////// fields
+  /// Segment 0 holds the slots 0..2^kFirstSegmentBits-1 and segment n > 0
+  /// holds the slots 2^(kFirstSegmentBits+n-1)..2^(kFirstSegmentBits+n)-1,
+  /// so that finding the segment of an index is a single bit scan.
+  static constexpr uint32_t firstSegmentBits() {
+    uint32_t bits = 0;
+    while (bits < 16 && (sizeof(Slot) << (bits + 1)) <= (64 << 10)) {
+      ++bits;
+    }
+    return bits;
+  }
+  static constexpr uint32_t kFirstSegmentBits = firstSegmentBits();
+  static constexpr uint32_t kMaxSegments = 33 - kFirstSegmentBits;
 
-  /// the number of bytes allocated from mmap, which is a multiple of
-  /// the page size of the machine
-  size_t mmapLength_;
+  ////////// fields
 
   /// the actual number of slots that we will allocate, to guarantee
   /// that we will satisfy the capacity requested at construction time.
-  /// They will be numbered 1..actualCapacity_ (note the 1-based counting),
-  /// and occupy slots_[1..actualCapacity_].
+  /// They will be numbered 1..actualCapacity_ (note the 1-based counting).
   uint32_t actualCapacity_;
 
   /// this records the number of slots that have actually been constructed.
@@ -380,9 +401,11 @@ struct IndexedMemPool {
   /// size_)
   Atom<uint32_t> size_;
 
-  /// raw storage, only 1..min(size_,actualCapacity_) (inclusive) are
-  /// actually constructed.  Note that slots_[0] is not constructed or used
-  alignas(hardware_destructive_interference_size) Slot* slots_;
+  /// raw storage, mapped as the pool grows.  Only slots
+  /// 1..min(size_,actualCapacity_) (inclusive) are actually constructed.
+  /// Note that slot 0 is not constructed or used
+  alignas(hardware_destructive_interference_size) Atom<Slot*> segments_
+      [kMaxSegments];
 
   /// use AccessSpreader to find your list.  We use stripes instead of
   /// thread-local to avoid the need to grow or shrink on thread start
@@ -403,9 +426,65 @@ struct IndexedMemPool {
     return idx;
   }
 
-  Slot& slot(uint32_t idx) { return slots_[slotIndex(idx)]; }
+  static uint32_t segmentOf(uint32_t idx) {
+    return findLastSet(idx >> kFirstSegmentBits);
+  }
 
-  const Slot& slot(uint32_t idx) const { return slots_[slotIndex(idx)]; }
+  static uint32_t segmentBase(uint32_t seg) {
+    return seg == 0 ? 0 : uint32_t(1) << (kFirstSegmentBits + seg - 1);
+  }
+
+  /// the number of slots in a segment, the last one being cut short at
+  /// actualCapacity_
+  uint32_t segmentLength(uint32_t seg) const {
+    uint64_t length = uint64_t(1) << (kFirstSegmentBits + seg - (seg != 0));
+    return uint32_t(std::min(
+        length, uint64_t(actualCapacity_) + 1 - segmentBase(seg)));
+  }
+
+  size_t segmentMapLength(uint32_t seg) const {
+    size_t needed = sizeof(Slot) * segmentLength(seg);
+    size_t pagesize = size_t(sysconf(_SC_PAGESIZE));
+    return ((needed - 1) & ~(pagesize - 1)) + pagesize;
+  }
+
+  Slot& slot(uint32_t idx) {
+    auto seg = segmentOf(slotIndex(idx));
+    auto slots = segments_[seg].load(std::memory_order_acquire);
+    return slots[idx - segmentBase(seg)];
+  }
+
+  const Slot& slot(uint32_t idx) const {
+    auto seg = segmentOf(slotIndex(idx));
+    auto slots = segments_[seg].load(std::memory_order_acquire);
+    return slots[idx - segmentBase(seg)];
+  }
+
+  // maps the segment of a newly claimed index, if no other thread did
+  void ensureSegment(uint32_t idx) {
+    auto seg = segmentOf(idx);
+    if (segments_[seg].load(std::memory_order_acquire)) {
+      return;
+    }
+    auto length = segmentMapLength(seg);
+    auto slots = static_cast<Slot*>(mmap(
+        nullptr,
+        length,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0));
+    if (slots == MAP_FAILED) {
+      assert(errno == ENOMEM);
+      throw std::bad_alloc();
+    }
+    Slot* expected = nullptr;
+    if (!segments_[seg].compare_exchange_strong(
+            expected, slots, std::memory_order_acq_rel)) {
+      // another thread mapped it first
+      munmap(slots, length);
+    }
+  }
 
   // localHead references a full list chained by localNext.  s should
   // reference slot(localHead), it is passed as a micro-optimization
@@ -488,6 +567,7 @@ struct IndexedMemPool {
           // allocation failed
           return 0;
         }
+        ensureSegment(idx);
         Slot& s = slot(idx);
         // Atom is enforced above to be nothrow-default-constructible
         // As an optimization, use default-initialization (no parens) rather
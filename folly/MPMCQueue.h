@@ -20,6 +20,7 @@
 #include <atomic>
 #include <cassert>
 #include <cstring>
+#include <iterator>
 #include <limits>
 #include <type_traits>
 
@@ -91,6 +92,14 @@ class MPMCQueueBase;
 /// In particular, if you can declare FOLLY_ASSUME_FBVECTOR_COMPATIBLE
 /// then your type can be put in MPMCQueue.
 ///
+/// BATCHES: blockingWriteBatch, writeBatch, blockingReadBatch and readBatch
+/// move a group of elements with a single update of the ticket dispenser,
+/// instead of one contended atomic operation per element. Each element is
+/// still published through the turn sequencer of its own slot, so consumers
+/// may start on the first elements of a batch before the last are written.
+/// Dynamic queues, whose tickets can span expansions, fall back to single
+/// element operations.
+///
 /// If you have a pool of N queue consumers that you want to shut down
 /// after the queue has drained, one way is to enqueue N sentinel values
 /// to the queue.  If the producer doesn't know how many consumers there
@@ -1029,6 +1038,82 @@ class MPMCQueueBase<Derived<T, Atom, Dynamic, Allocator>> {
     }
   }
 
+  /// Enqueues the elements constructed from each of [first, last), in
+  /// order, blocking until space is available for each. Pass move iterators
+  /// to enqueue via move. The range may exceed the capacity, in which case
+  /// the later elements wait for the earlier ones to be dequeued.
+  template <typename Iter>
+  void blockingWriteBatch(Iter first, Iter last) noexcept {
+    if constexpr (Dynamic) {
+      for (; first != last; ++first) {
+        static_cast<DerivedType*>(this)->blockingWrite(*first);
+      }
+    } else {
+      auto ticket = pushTicket_.fetch_add(std::distance(first, last));
+      for (; first != last; ++first, ++ticket) {
+        enqueueWithTicketBase(ticket, slots_, capacity_, stride_, *first);
+      }
+    }
+  }
+
+  /// Enqueues as many elements of [first, last), from the front, as can be
+  /// enqueued with no blocking, and returns how many it enqueued. Like
+  /// write, this returns 0 if the slot of the next write is still being
+  /// dequeued, even if the queue is not full.
+  template <typename Iter>
+  size_t writeBatch(Iter first, Iter last) noexcept {
+    if constexpr (Dynamic) {
+      size_t count = 0;
+      for (; first != last && write(*first); ++first) {
+        ++count;
+      }
+      return count;
+    } else {
+      uint64_t ticket;
+      auto count = tryObtainReadyPushTickets(
+          ticket, static_cast<size_t>(std::distance(first, last)));
+      for (size_t i = 0; i < count; ++i, ++first) {
+        enqueueWithTicketBase(ticket + i, slots_, capacity_, stride_, *first);
+      }
+      return count;
+    }
+  }
+
+  /// Moves n dequeued elements onto elems[0, n), in order, blocking until
+  /// each is available.
+  void blockingReadBatch(T* elems, size_t n) noexcept {
+    if constexpr (Dynamic) {
+      for (size_t i = 0; i < n; ++i) {
+        blockingRead(elems[i]);
+      }
+    } else {
+      assert(capacity_ != 0);
+      auto ticket = popTicket_.fetch_add(n);
+      for (size_t i = 0; i < n; ++i) {
+        dequeueWithTicketBase(ticket + i, slots_, capacity_, stride_, elems[i]);
+      }
+    }
+  }
+
+  /// Moves up to n elements that can be dequeued with no blocking onto
+  /// elems, in order, and returns how many it dequeued.
+  size_t readBatch(T* elems, size_t n) noexcept {
+    if constexpr (Dynamic) {
+      size_t count = 0;
+      while (count < n && read(elems[count])) {
+        ++count;
+      }
+      return count;
+    } else {
+      uint64_t ticket;
+      auto count = tryObtainReadyPopTickets(ticket, n);
+      for (size_t i = 0; i < count; ++i) {
+        dequeueWithTicketBase(ticket + i, slots_, capacity_, stride_, elems[i]);
+      }
+      return count;
+    }
+  }
+
  protected:
   enum {
     /// Once every kAdaptationFreq we will spin longer, to try to estimate
@@ -1261,6 +1346,62 @@ class MPMCQueueBase<Derived<T, Atom, Dynamic, Allocator>> {
     }
   }
 
+  /// Tries to obtain up to n consecutive push tickets, starting at ticket,
+  /// for which SingleElementQueue::enqueue won't block, and returns how many
+  /// it obtained. Only used by non-dynamic queues.
+  size_t tryObtainReadyPushTickets(uint64_t& ticket, size_t n) noexcept {
+    if (n == 0) {
+      return 0;
+    }
+    ticket = pushTicket_.load(std::memory_order_acquire); // A
+    while (true) {
+      // Once the turn of a slot has arrived it stays until we enqueue, so
+      // the whole range is bracketed by A (or prev B) and the CAS.
+      size_t ready = 0;
+      while (ready < n &&
+             slots_[idx(ticket + ready, capacity_, stride_)].mayEnqueue(
+                 turn(ticket + ready, capacity_))) {
+        ++ready;
+      }
+      if (ready == 0) {
+        auto prev = ticket;
+        ticket = pushTicket_.load(std::memory_order_acquire); // B
+        if (prev == ticket) {
+          return 0;
+        }
+      } else if (pushTicket_.compare_exchange_strong(ticket, ticket + ready)) {
+        return ready;
+      }
+    }
+  }
+
+  /// Tries to obtain up to n consecutive pop tickets, starting at ticket,
+  /// for which SingleElementQueue::dequeue won't block, and returns how many
+  /// it obtained. Only used by non-dynamic queues.
+  size_t tryObtainReadyPopTickets(uint64_t& ticket, size_t n) noexcept {
+    if (n == 0) {
+      return 0;
+    }
+    ticket = popTicket_.load(std::memory_order_acquire);
+    while (true) {
+      size_t ready = 0;
+      while (ready < n &&
+             slots_[idx(ticket + ready, capacity_, stride_)].mayDequeue(
+                 turn(ticket + ready, capacity_))) {
+        ++ready;
+      }
+      if (ready == 0) {
+        auto prev = ticket;
+        ticket = popTicket_.load(std::memory_order_acquire);
+        if (prev == ticket) {
+          return 0;
+        }
+      } else if (popTicket_.compare_exchange_strong(ticket, ticket + ready)) {
+        return ready;
+      }
+    }
+  }
+
   /// Tries until when to obtain a pop ticket for which
   /// SingleElementQueue::dequeue won't block.  Returns true on success, false
   /// on failure.
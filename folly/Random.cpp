@@ -16,7 +16,10 @@
 
 #include <folly/Random.h>
 
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <iterator>
 #include <mutex>
 #include <random>
 
@@ -27,6 +30,7 @@
 #include <folly/portability/Config.h>
 #include <folly/portability/SysTime.h>
 #include <folly/portability/Unistd.h>
+#include <folly/random/xoshiro256pp.h>
 #include <folly/synchronization/RelaxedAtomic.h>
 
 #include <glog/logging.h>
@@ -182,4 +186,50 @@ ThreadLocalPRNG::result_type ThreadLocalPRNG::operator()() {
   using Single = SingletonThreadLocal<Wrapper, RandomTag>;
   return Single::get().object();
 }
+
+namespace {
+
+xoshiro256pp_64& bulkGenerator() {
+  struct Wrapper {
+    xoshiro256pp_64 object{Random::secureRand64()};
+  };
+  using Single = SingletonThreadLocal<Wrapper, RandomTag>;
+  return Single::get().object;
+}
+
+} // namespace
+
+void Random::fill(span<uint32_t> out) {
+  // Each output of the generator gives two values.
+  auto& rng = bulkGenerator();
+  uint64_t buffer[64];
+  while (!out.empty()) {
+    auto const n = std::min(out.size(), 2 * std::size(buffer));
+    rng.fill(buffer, (n + 1) / 2);
+    std::memcpy(out.data(), buffer, n * sizeof(uint32_t));
+    out = out.subspan(n);
+  }
+}
+
+void Random::fill(span<uint64_t> out) {
+  bulkGenerator().fill(out.data(), out.size());
+}
+
+void Random::fill(span<uint32_t> out, uint32_t max) {
+  if (max == 0) {
+    std::fill(out.begin(), out.end(), 0u);
+    return;
+  }
+  fill(out);
+  auto& rng = bulkGenerator();
+  auto const next = [&] { return uint32_t(rng()); };
+  for (auto& value : out) {
+    value = detail::randomBounded(value, max, next);
+  }
+}
+
+void Random::fill(span<uint64_t> out, uint64_t max) {
+  fill(out, max, bulkGenerator());
+}
+
 } // namespace folly
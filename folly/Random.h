@@ -21,6 +21,7 @@
 #pragma once
 #define FOLLY_RANDOM_H_
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <random>
@@ -28,6 +29,7 @@
 
 #include <folly/Portability.h>
 #include <folly/Traits.h>
+#include <folly/container/span.h>
 #include <folly/functional/Invoke.h>
 #include <folly/lang/Bits.h>
 
@@ -45,6 +47,46 @@ using DefaultGenerator = __gnu_cxx::sfmt19937;
 using DefaultGenerator = std::mt19937;
 #endif
 
+// The high half of x * y, and its low half in low.
+FOLLY_ALWAYS_INLINE uint32_t
+randomMulHigh(uint32_t x, uint32_t y, uint32_t& low) {
+  auto const m = uint64_t(x) * y;
+  low = uint32_t(m);
+  return uint32_t(m >> 32);
+}
+FOLLY_ALWAYS_INLINE uint64_t
+randomMulHigh(uint64_t x, uint64_t y, uint64_t& low) {
+#if FOLLY_HAVE_INT128_T
+  auto const m = static_cast<unsigned __int128>(x) * y;
+  low = uint64_t(m);
+  return uint64_t(m >> 64);
+#else
+  uint64_t const xl = uint32_t(x), xh = x >> 32;
+  uint64_t const yl = uint32_t(y), yh = y >> 32;
+  auto const ll = xl * yl, lh = xl * yh, hl = xh * yl, hh = xh * yh;
+  auto const mid = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+  low = (mid << 32) | uint32_t(ll);
+  return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// Lemire's nearly divisionless reduction of the random x to [0, max), for
+// max > 0 (https://arxiv.org/abs/1805.10941): the high half of x * max is
+// uniform unless its low half is below 2^N % max, which is only computed when
+// the low half is below max, and then draws more values from next.
+template <class UInt, class Next>
+FOLLY_ALWAYS_INLINE UInt randomBounded(UInt x, UInt max, Next&& next) {
+  UInt low;
+  auto high = randomMulHigh(x, max, low);
+  if (FOLLY_UNLIKELY(low < max)) {
+    auto const threshold = UInt(-max) % max;
+    while (low < threshold) {
+      high = randomMulHigh(UInt(next()), max, low);
+    }
+  }
+  return high;
+}
+
 } // namespace detail
 
 /**
@@ -88,6 +130,10 @@ class Random {
     }
   };
 
+  template <class RNG, class T>
+  using detect_fill = decltype(std::declval<RNG&>().fill(
+      std::declval<T*>(), std::declval<size_t>()));
+
   // Whether RNG output is surjective and uniform when truncated to ResultType.
   template <class RNG, class ResultType>
   static constexpr bool UniformRNG =
@@ -417,6 +463,87 @@ class Random {
     }
     return std::uniform_real_distribution<double>(min, max)(rng);
   }
+
+  /**
+   * Fills out with random values, from a generator per thread which produces
+   * them by blocks of SIMD lanes (see folly/random/xoshiro256pp.h) rather than
+   * one call per value.
+   */
+  static void fill(span<uint32_t> out);
+  static void fill(span<uint64_t> out);
+
+  /**
+   * Fills out with random values given a specific RNG, by blocks if it has a
+   * fill(result_type*, size_t) member as xoshiro256pp does.
+   */
+  template <class RNG, class /* EnableIf */ = ValidRNG<RNG>>
+  static void fill(span<uint32_t> out, RNG&& rng) {
+    fillImpl(out, rng);
+  }
+  template <class RNG, class /* EnableIf */ = ValidRNG<RNG>>
+  static void fill(span<uint64_t> out, RNG&& rng) {
+    fillImpl(out, rng);
+  }
+
+  /**
+   * Fills out with random values in [0, max). If max == 0, fills it with 0.
+   *
+   * Uses Lemire's nearly divisionless method: a multiply per value, and a
+   * division only for the values which may be biased, 1 in 2^32 / max.
+   */
+  static void fill(span<uint32_t> out, uint32_t max);
+  static void fill(span<uint64_t> out, uint64_t max);
+
+  /**
+   * Fills out with random values in [0, max) given a specific RNG. If
+   * max == 0, fills it with 0.
+   */
+  template <class RNG, class /* EnableIf */ = ValidRNG<RNG>>
+  static void fill(span<uint32_t> out, uint32_t max, RNG&& rng) {
+    fillBoundedImpl(out, max, rng);
+  }
+  template <class RNG, class /* EnableIf */ = ValidRNG<RNG>>
+  static void fill(span<uint64_t> out, uint64_t max, RNG&& rng) {
+    fillBoundedImpl(out, max, rng);
+  }
+
+ private:
+  template <class T, class RNG>
+  static void fillImpl(span<T> out, RNG& rng) {
+    using Result = typename std::decay_t<RNG>::result_type;
+    if constexpr (
+        is_detected_v<detect_fill, std::decay_t<RNG>, T> &&
+        std::is_same<Result, T>::value) {
+      rng.fill(out.data(), out.size());
+    } else {
+      for (auto& value : out) {
+        if constexpr (sizeof(T) == 4) {
+          value = rand32(rng);
+        } else {
+          value = rand64(rng);
+        }
+      }
+    }
+  }
+
+  template <class T, class RNG>
+  static void fillBoundedImpl(span<T> out, T max, RNG& rng) {
+    if (max == 0) {
+      std::fill(out.begin(), out.end(), T(0));
+      return;
+    }
+    fillImpl(out, rng);
+    auto const next = [&]() -> T {
+      if constexpr (sizeof(T) == 4) {
+        return rand32(rng);
+      } else {
+        return rand64(rng);
+      }
+    };
+    for (auto& value : out) {
+      value = detail::randomBounded<T>(value, max, next);
+    }
+  }
 };
 
 /*
@@ -89,6 +89,8 @@ struct IsSomeString<std::basic_string<char, std::char_traits<char>, Alloc>>
 template <class Iter>
 class Range;
 
+struct AsciiCaseInsensitive;
+
 /**
  * Finds the first occurrence of needle in haystack. The algorithm is on
  * average faster than O(haystack.size() * needle.size()) but not as fast
@@ -191,6 +193,12 @@ template <typename Iter>
 constexpr bool range_is_byte_type_v_ =
     is_detected_v<range_is_byte_type_d_, Iter>;
 
+// The comparisons of char ranges with AsciiCaseInsensitive are vectorized.
+template <typename Iter, typename Comp>
+constexpr bool range_is_ascii_case_insensitive_v_ =
+    std::is_convertible_v<Iter, char const*> &&
+    std::is_same_v<std::decay_t<Comp>, AsciiCaseInsensitive>;
+
 struct range_traits_char_ {
   template <typename Value>
   using apply = std::char_traits<Value>;
@@ -1000,6 +1008,10 @@ class Range {
       return false;
     }
     auto const trunc = subpiece(0, other.size());
+    if constexpr (detail::range_is_ascii_case_insensitive_v_<Iter, Comp>) {
+      return detail::ascii_case_insensitive_equal_simd(
+          trunc.begin(), other.begin(), other.size());
+    }
     return std::equal(
         trunc.begin(), trunc.end(), other.begin(), std::forward<Comp>(eq));
   }
@@ -1031,14 +1043,24 @@ class Range {
       return false;
     }
     auto const trunc = subpiece(size() - other.size());
+    if constexpr (detail::range_is_ascii_case_insensitive_v_<Iter, Comp>) {
+      return detail::ascii_case_insensitive_equal_simd(
+          trunc.begin(), other.begin(), other.size());
+    }
     return std::equal(
         trunc.begin(), trunc.end(), other.begin(), std::forward<Comp>(eq));
   }
 
   template <class Comp>
   bool equals(const const_range_type& other, Comp&& eq) const {
-    return size() == other.size() &&
-        std::equal(begin(), end(), other.begin(), std::forward<Comp>(eq));
+    if (size() != other.size()) {
+      return false;
+    }
+    if constexpr (detail::range_is_ascii_case_insensitive_v_<Iter, Comp>) {
+      return detail::ascii_case_insensitive_equal_simd(
+          begin(), other.begin(), size());
+    }
+    return std::equal(begin(), end(), other.begin(), std::forward<Comp>(eq));
   }
 
   bool ends_with(const_range_type other) const noexcept {
@@ -1495,6 +1517,11 @@ std::enable_if_t<detail::ComparableAsStringPiece<T, U>::value, bool> operator>=(
  */
 template <class Iter, class Comp>
 size_t qfind(const Range<Iter>& haystack, const Range<Iter>& needle, Comp eq) {
+  if constexpr (detail::range_is_ascii_case_insensitive_v_<Iter, Comp>) {
+    return detail::qfind_ascii_case_insensitive_simd(
+        detail::StringPieceLite(haystack.begin(), haystack.end()),
+        detail::StringPieceLite(needle.begin(), needle.end()));
+  }
   // Don't use std::search, use a Boyer-Moore-like trick by comparing
   // the last characters first
   auto const nsize = needle.size();
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <folly/TokenBucket.h>
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/span.h>
+#include <folly/hash/Hash.h>
+
+namespace folly {
+
+/**
+ * Token buckets of many tenants, which all have the same rate and burst size,
+ * by tenant id.
+ *
+ *   ShardedTokenBucketMap<uint64_t> limiter(1000, 100);
+ *   if (!limiter.consume(tenantId, 1)) {
+ *     return reject();
+ *   }
+ *
+ * The buckets are kept in F14 maps, in shards which each have a reader-writer
+ * lock: consuming from an existing bucket only takes a shared lock, and then
+ * is as for TokenBucket, a CAS on the bucket. The bucket of a tenant is
+ * created full on its first use, and the full buckets are evicted in a sweep
+ * once a shard grew enough since the last one: a full bucket behaves as no
+ * bucket does, so the eviction is invisible but for the memory.
+ *
+ * If Options::localCacheTokens is set, the buckets on which the CAS turns out
+ * contended cache tokens per core: a core takes localCacheTokens from the
+ * bucket at once and consumes them locally. The tokens cached by the cores
+ * aren't available to the others, so that a tenant may get up to
+ * localCacheTokens times its cores fewer tokens for a while, but never more.
+ */
+template <
+    typename Key,
+    typename Policy = TokenBucketPolicyDefault,
+    typename Hasher = f14::DefaultHasher<Key>,
+    typename KeyEqual = f14::DefaultKeyEqual<Key>>
+class BasicShardedTokenBucketMap {
+  using Storage = TokenBucketStorage<Policy>;
+
+ public:
+  struct Options {
+    Options() {}
+
+    size_t shards = 64;
+    // The tokens a core takes from a contended bucket at once, or 0 not to
+    // cache tokens per core.
+    double localCacheTokens = 0;
+    // The buckets a shard may grow by before sweeping the full ones.
+    size_t sweepThreshold = 1024;
+  };
+
+  /**
+   * @param genRate Number of tokens to generate per second, per tenant.
+   * @param burstSize Maximum burst size, per tenant. Must be greater than 0.
+   */
+  BasicShardedTokenBucketMap(
+      double genRate, double burstSize, Options options = Options())
+      : rate_(genRate),
+        burstSize_(burstSize),
+        options_(options),
+        numShards_(std::max<size_t>(options.shards, 1)),
+        shards_(std::make_unique<Shard[]>(numShards_)) {
+    assert(rate_ > 0);
+    assert(burstSize_ > 0);
+    for (size_t i = 0; i < numShards_; ++i) {
+      shards_[i].sweepAt = options_.sweepThreshold;
+    }
+  }
+
+  BasicShardedTokenBucketMap(const BasicShardedTokenBucketMap&) = delete;
+  BasicShardedTokenBucketMap& operator=(const BasicShardedTokenBucketMap&) =
+      delete;
+
+  /**
+   * Returns the current time in seconds since Epoch.
+   */
+  static double defaultClockNow() noexcept {
+    return BasicTokenBucket<Policy>::defaultClockNow();
+  }
+
+  /**
+   * Attempts to consume some number of tokens of a tenant. Tokens are only
+   * consumed if enough are available.
+   *
+   * Thread-safe.
+   *
+   * @return True if the tokens were consumed, false otherwise.
+   */
+  bool consume(
+      const Key& tenant,
+      double toConsume,
+      double nowInSeconds = defaultClockNow()) {
+    return withBucket(tenant, nowInSeconds, [&](Bucket& bucket) {
+      return consumeImpl(bucket, toConsume, nowInSeconds);
+    });
+  }
+
+  /**
+   * Similar to consume, but always consumes some number of tokens. If the
+   * bucket contains enough tokens - consumes toConsume tokens. Otherwise the
+   * bucket is drained.
+   *
+   * Thread-safe.
+   *
+   * @return Number of tokens that were actually consumed.
+   */
+  double consumeOrDrain(
+      const Key& tenant,
+      double toConsume,
+      double nowInSeconds = defaultClockNow()) {
+    return withBucket(tenant, nowInSeconds, [&](Bucket& bucket) {
+      return bucket.storage.consume(
+          rate_, burstSize_, nowInSeconds, [toConsume](double available) {
+            return std::min(available, toConsume);
+          });
+    });
+  }
+
+  /**
+   * Attempts to consume the tokens of several tenants, as consume() of each,
+   * but locking each shard once. granted[i] is whether requests[i] was.
+   *
+   * Thread-safe.
+   *
+   * @return The number of requests granted.
+   */
+  size_t consume(
+      span<const std::pair<Key, double>> requests,
+      span<bool> granted,
+      double nowInSeconds = defaultClockNow()) {
+    assert(granted.size() >= requests.size());
+    std::vector<std::pair<size_t, size_t>> order(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      order[i] = {shardIndex(requests[i].first), i};
+    }
+    std::sort(order.begin(), order.end());
+
+    size_t count = 0;
+    std::vector<size_t> missing;
+    for (auto begin = order.begin(); begin != order.end();) {
+      auto& shard = shards_[begin->first];
+      auto const end = std::find_if(begin, order.end(), [&](const auto& o) {
+        return o.first != begin->first;
+      });
+      missing.clear();
+      {
+        std::shared_lock<SharedMutex> lock(shard.mutex);
+        for (auto it = begin; it != end; ++it) {
+          auto const& [tenant, toConsume] = requests[it->second];
+          auto const bucket = shard.buckets.find(tenant);
+          if (bucket == shard.buckets.end()) {
+            missing.push_back(it->second);
+            continue;
+          }
+          granted[it->second] =
+              consumeImpl(bucket->second, toConsume, nowInSeconds);
+          count += granted[it->second];
+        }
+      }
+      if (!missing.empty()) {
+        std::unique_lock<SharedMutex> lock(shard.mutex);
+        for (auto const i : missing) {
+          auto const& [tenant, toConsume] = requests[i];
+          granted[i] = consumeImpl(
+              insert(shard, tenant, nowInSeconds), toConsume, nowInSeconds);
+          count += granted[i];
+        }
+      }
+      begin = end;
+    }
+    return count;
+  }
+
+  /**
+   * Returns extra tokens back to the bucket of a tenant.
+   *
+   * Thread-safe.
+   */
+  void returnTokens(
+      const Key& tenant,
+      double tokensToReturn,
+      double nowInSeconds = defaultClockNow()) {
+    withBucket(tenant, nowInSeconds, [&](Bucket& bucket) {
+      bucket.storage.returnTokens(tokensToReturn, rate_);
+    });
+  }
+
+  /**
+   * Returns the number of tokens currently available to a tenant, not
+   * counting those cached by the cores.
+   *
+   * Thread-safe (but returned value may immediately be outdated).
+   */
+  double available(
+      const Key& tenant, double nowInSeconds = defaultClockNow()) const {
+    auto const& shard = shardFor(tenant);
+    std::shared_lock<SharedMutex> lock(shard.mutex);
+    auto const it = shard.buckets.find(tenant);
+    if (it == shard.buckets.end()) {
+      return burstSize_;
+    }
+    return std::max(
+        0.0, it->second.storage.balance(rate_, burstSize_, nowInSeconds));
+  }
+
+  /**
+   * Evicts the full buckets of all the shards, and returns how many.
+   *
+   * Thread-safe.
+   */
+  size_t evictIdle(double nowInSeconds = defaultClockNow()) {
+    size_t evicted = 0;
+    for (size_t i = 0; i < numShards_; ++i) {
+      std::unique_lock<SharedMutex> lock(shards_[i].mutex);
+      evicted += sweep(shards_[i], nowInSeconds);
+    }
+    return evicted;
+  }
+
+  /**
+   * The number of buckets held.
+   *
+   * Thread-safe (but returned value may immediately be outdated).
+   */
+  size_t size() const {
+    size_t size = 0;
+    for (size_t i = 0; i < numShards_; ++i) {
+      std::shared_lock<SharedMutex> lock(shards_[i].mutex);
+      size += shards_[i].buckets.size();
+    }
+    return size;
+  }
+
+  double rate() const noexcept { return rate_; }
+
+  double burst() const noexcept { return burstSize_; }
+
+ private:
+  // The consumes which found the CAS of a bucket contended before it caches
+  // tokens per core.
+  static constexpr uint32_t kContendedConsumes = 16;
+
+  struct Stripes {
+    struct alignas(hardware_destructive_interference_size) Slot {
+      std::atomic<double> tokens{0};
+    };
+
+    Stripes()
+        : size(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 64)),
+          slots(std::make_unique<Slot[]>(size)) {}
+
+    const size_t size;
+    const std::unique_ptr<Slot[]> slots;
+  };
+
+  struct Bucket {
+    explicit Bucket(double zeroTime) noexcept : storage(zeroTime) {}
+
+    ~Bucket() { delete stripes.load(std::memory_order_acquire); }
+
+    Storage storage;
+    std::atomic<Stripes*> stripes{nullptr};
+    std::atomic<uint32_t> contended{0};
+  };
+
+  struct alignas(hardware_destructive_interference_size) Shard {
+    mutable SharedMutex mutex;
+    F14NodeMap<Key, Bucket, Hasher, KeyEqual> buckets;
+    size_t sweepAt = 0;
+  };
+
+  size_t shardIndex(const Key& tenant) const {
+    return size_t(hash::twang_mix64(uint64_t(Hasher{}(tenant))) % numShards_);
+  }
+
+  Shard& shardFor(const Key& tenant) { return shards_[shardIndex(tenant)]; }
+
+  const Shard& shardFor(const Key& tenant) const {
+    return shards_[shardIndex(tenant)];
+  }
+
+  template <typename F>
+  decltype(auto) withBucket(const Key& tenant, double nowInSeconds, F&& f) {
+    auto& shard = shardFor(tenant);
+    {
+      std::shared_lock<SharedMutex> lock(shard.mutex);
+      auto const it = shard.buckets.find(tenant);
+      if (it != shard.buckets.end()) {
+        return f(it->second);
+      }
+    }
+    std::unique_lock<SharedMutex> lock(shard.mutex);
+    return f(insert(shard, tenant, nowInSeconds));
+  }
+
+  // Under the exclusive lock of the shard.
+  Bucket& insert(Shard& shard, const Key& tenant, double nowInSeconds) {
+    auto it = shard.buckets.find(tenant);
+    if (it != shard.buckets.end()) {
+      return it->second;
+    }
+    if (shard.buckets.size() >= shard.sweepAt) {
+      sweep(shard, nowInSeconds);
+    }
+    // Full, as if the tenant had been idle forever.
+    return shard.buckets
+        .try_emplace(tenant, nowInSeconds - burstSize_ / rate_)
+        .first->second;
+  }
+
+  // Under the exclusive lock of the shard.
+  size_t sweep(Shard& shard, double nowInSeconds) {
+    auto const evicted =
+        erase_if(shard.buckets, [&](const auto& entry) {
+          return entry.second.storage.balance(
+                     rate_, burstSize_, nowInSeconds) >= burstSize_;
+        });
+    shard.sweepAt = shard.buckets.size() + options_.sweepThreshold;
+    return evicted;
+  }
+
+  bool consumeImpl(Bucket& bucket, double toConsume, double nowInSeconds) {
+    if (auto const stripes = bucket.stripes.load(std::memory_order_acquire)) {
+      return consumeLocal(bucket, *stripes, toConsume, nowInSeconds);
+    }
+    size_t attempts = 0;
+    auto const consumed = bucket.storage.consume(
+        rate_, burstSize_, nowInSeconds, [&](double available) {
+          ++attempts;
+          return available < toConsume ? 0.0 : toConsume;
+        });
+    if (attempts > 1 && options_.localCacheTokens > 0 &&
+        bucket.contended.fetch_add(1, std::memory_order_relaxed) + 1 ==
+            kContendedConsumes) {
+      bucket.stripes.store(new Stripes(), std::memory_order_release);
+    }
+    return consumed == toConsume;
+  }
+
+  bool consumeLocal(
+      Bucket& bucket, Stripes& stripes, double toConsume, double nowInSeconds) {
+    auto& tokens =
+        stripes.slots[AccessSpreader<>::cachedCurrent(stripes.size)].tokens;
+    auto cached = tokens.load(std::memory_order_relaxed);
+    while (cached >= toConsume) {
+      if (tokens.compare_exchange_weak(
+              cached, cached - toConsume, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    // Take a batch of tokens for the core along with these, or just these if
+    // there aren't enough.
+    auto const batch = toConsume + options_.localCacheTokens;
+    auto const consumed = bucket.storage.consume(
+        rate_, burstSize_, nowInSeconds, [&](double available) {
+          return available >= batch ? batch
+              : available >= toConsume ? toConsume
+                                       : 0.0;
+        });
+    if (consumed > toConsume) {
+      cached = tokens.load(std::memory_order_relaxed);
+      while (!tokens.compare_exchange_weak(
+          cached,
+          cached + (consumed - toConsume),
+          std::memory_order_relaxed)) {
+      }
+    }
+    return consumed >= toConsume;
+  }
+
+  const double rate_;
+  const double burstSize_;
+  const Options options_;
+  const size_t numShards_;
+  const std::unique_ptr<Shard[]> shards_;
+};
+
+template <typename Key>
+using ShardedTokenBucketMap = BasicShardedTokenBucketMap<Key>;
+
+} // namespace folly
@@ -239,6 +239,7 @@ void SingletonHolder<T>::createInstance() {
       std::this_thread::get_id()) {
     detail::singletonWarnCreateCircularDependencyAndAbort(type());
   }
+  SingletonCreationScope::observe(vault_, type());
 
   std::lock_guard entry_lock(mutex_);
   if (state_.load(std::memory_order_acquire) == SingletonHolderState::Living) {
@@ -295,7 +296,10 @@ void SingletonHolder<T>::createInstance() {
 
   // Can't use make_shared -- no support for a custom deleter, sadly.
   std::shared_ptr<T> instance(
-      create_(),
+      [&] {
+        SingletonCreationScope scope(vault_, type());
+        return create_();
+      }(),
       [destroy_baton, print_destructor_stack_trace, type = type()](T*) mutable {
         destroy_baton->post();
         if (print_destructor_stack_trace->load()) {
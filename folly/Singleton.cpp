@@ -26,6 +26,8 @@
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <exception>
 #include <string>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
@@ -183,6 +185,42 @@ void singletonPrintDestructionStackTrace(const TypeDescriptor& type) {
       type.name());
 }
 
+namespace {
+thread_local SingletonCreationScope* currentCreationScope = nullptr;
+} // namespace
+
+SingletonCreationScope::SingletonCreationScope(
+    SingletonVault& vault, const TypeDescriptor& type)
+    : vault_(vault),
+      type_(type),
+      parent_(currentCreationScope),
+      uncaughtExceptions_(std::uncaught_exceptions()),
+      start_(std::chrono::steady_clock::now()) {
+  currentCreationScope = this;
+}
+
+SingletonCreationScope::~SingletonCreationScope() {
+  currentCreationScope = parent_;
+  if (std::uncaught_exceptions() != uncaughtExceptions_) {
+    return;
+  }
+  auto const duration = std::chrono::steady_clock::now() - start_;
+  if (parent_ != nullptr) {
+    parent_->nested_ += duration;
+  }
+  auto& time = (*vault_.creationTimes_.wlock())[type_];
+  time.duration = duration;
+  time.selfDuration = duration - nested_;
+}
+
+void SingletonCreationScope::observe(
+    SingletonVault& vault, const TypeDescriptor& type) {
+  auto const scope = currentCreationScope;
+  if (scope != nullptr && &scope->vault_ == &vault && !(scope->type_ == type)) {
+    vault.addDependency(scope->type_, type);
+  }
+}
+
 } // namespace detail
 
 namespace {
@@ -292,6 +330,25 @@ void SingletonVault::addEagerInitOnReenableSingleton(
   eagerInitOnReenableSingletons->insert(entry);
 }
 
+void SingletonVault::addDependency(
+    const detail::TypeDescriptor& type,
+    const detail::TypeDescriptor& dependency) {
+  {
+    auto dependencies = dependencies_.rlock();
+    auto it = dependencies->find(type);
+    if (it != dependencies->end() &&
+        std::find(it->second.begin(), it->second.end(), dependency) !=
+            it->second.end()) {
+      return;
+    }
+  }
+  auto& typeDependencies = (*dependencies_.wlock())[type];
+  if (std::find(typeDependencies.begin(), typeDependencies.end(), dependency) ==
+      typeDependencies.end()) {
+    typeDependencies.push_back(dependency);
+  }
+}
+
 void SingletonVault::registrationComplete() {
   scheduleDestroyInstances();
 
@@ -331,6 +388,59 @@ void SingletonVault::doEagerInit() {
   }
 }
 
+namespace {
+
+// The singletons which doEagerInitVia() initializes, with the dependencies of
+// each among them.
+struct EagerInitGraph {
+  struct Node {
+    explicit Node(detail::SingletonHolderBase* s) : singleton(s) {}
+
+    detail::SingletonHolderBase* const singleton;
+    std::vector<size_t> dependents;
+    // The dependencies not initialized yet.
+    std::atomic<size_t> pending{0};
+  };
+
+  EagerInitGraph(Executor& e, folly::Baton<>* d) : exe(e), done(d) {}
+
+  Executor& exe;
+  folly::Baton<>* const done;
+  std::deque<Node> nodes;
+  std::atomic<size_t> remaining{0};
+};
+
+void scheduleEagerInit(std::shared_ptr<EagerInitGraph> graph, size_t index) {
+  // graph is retained by shared_ptr, and will be alive until last lambda is
+  // done.  The baton is provided by the caller, and expected to remain
+  // present (if it's non-nullptr).  The SingletonHolderBase pointers are alive
+  // as long as SingletonVault is not being destroyed.
+  auto& exe = graph->exe;
+  exe.add([graph = std::move(graph), index] {
+    auto& node = graph->nodes[index];
+    // schedule the dependents and notify if requested, whether
+    // initialization was successful, was skipped (already initialized), or
+    // exception thrown.
+    SCOPE_EXIT {
+      for (auto dependent : node.dependents) {
+        if (--graph->nodes[dependent].pending == 0) {
+          scheduleEagerInit(graph, dependent);
+        }
+      }
+      if (--graph->remaining == 0 && graph->done != nullptr) {
+        graph->done->post();
+      }
+    };
+    // if initialization is in progress in another thread, don't try to init
+    // here.  Otherwise the current thread will block on 'createInstance'.
+    if (!node.singleton->creationStarted()) {
+      node.singleton->createInstance();
+    }
+  });
+}
+
+} // namespace
+
 void SingletonVault::doEagerInitVia(Executor& exe, folly::Baton<>* done) {
   {
     auto state = state_.rlock();
@@ -340,32 +450,117 @@ void SingletonVault::doEagerInitVia(Executor& exe, folly::Baton<>* done) {
     }
   }
 
-  auto eagerInitSingletons = eagerInitSingletons_.rlock();
-  auto countdown =
-      std::make_shared<std::atomic<size_t>>(eagerInitSingletons->size());
-  for (auto* single : *eagerInitSingletons) {
-    // countdown is retained by shared_ptr, and will be alive until last lambda
-    // is done.  notifyBaton is provided by the caller, and expected to remain
-    // present (if it's non-nullptr).  singletonSet can go out of scope but
-    // its values, which are SingletonHolderBase pointers, are alive as long as
-    // SingletonVault is not being destroyed.
-    exe.add([=] {
-      // decrement counter and notify if requested, whether initialization
-      // was successful, was skipped (already initialized), or exception thrown.
-      SCOPE_EXIT {
-        if (--(*countdown) == 0) {
-          if (done != nullptr) {
-            done->post();
-          }
+  auto graph = std::make_shared<EagerInitGraph>(exe, done);
+  auto& nodes = graph->nodes;
+  {
+    auto eagerInitSingletons = eagerInitSingletons_.rlock();
+    auto singletons = singletons_.rlock();
+    auto dependencies = dependencies_.rlock();
+
+    // The eager singletons, and the registered ones they depend on.
+    std::unordered_map<detail::SingletonHolderBase*, size_t> indices;
+    std::vector<detail::SingletonHolderBase*> toVisit(
+        eagerInitSingletons->begin(), eagerInitSingletons->end());
+    std::vector<std::vector<size_t>> nodeDependencies;
+    while (!toVisit.empty()) {
+      auto single = toVisit.back();
+      toVisit.pop_back();
+      if (!indices.emplace(single, nodes.size()).second) {
+        continue;
+      }
+      nodes.emplace_back(single);
+      auto it = dependencies->find(single->type());
+      if (it == dependencies->end()) {
+        continue;
+      }
+      for (const auto& dependency : it->second) {
+        auto registered = singletons->find(dependency);
+        if (registered != singletons->end()) {
+          toVisit.push_back(registered->second);
+        }
+      }
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      auto it = dependencies->find(nodes[i].singleton->type());
+      if (it == dependencies->end()) {
+        continue;
+      }
+      for (const auto& dependency : it->second) {
+        auto registered = singletons->find(dependency);
+        if (registered == singletons->end()) {
+          continue;
+        }
+        auto j = indices.at(registered->second);
+        if (j != i) {
+          nodes[j].dependents.push_back(i);
+          ++nodes[i].pending;
+        }
+      }
+    }
+  }
+
+  // Check that all of them can be scheduled before scheduling any.
+  std::vector<size_t> ready;
+  std::vector<size_t> pending(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    pending[i] = nodes[i].pending.load(std::memory_order_relaxed);
+    if (pending[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  auto roots = ready;
+  for (size_t next = 0; next < ready.size(); ++next) {
+    for (auto dependent : nodes[ready[next]].dependents) {
+      if (--pending[dependent] == 0) {
+        ready.push_back(dependent);
+      }
+    }
+  }
+  if (ready.size() != nodes.size()) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (pending[i] != 0) {
+        throw_exception<std::logic_error>(
+            "Singleton " + nodes[i].singleton->type().name() +
+            " depends on a cycle of singletons");
+      }
+    }
+  }
+
+  graph->remaining = nodes.size();
+  if (nodes.empty()) {
+    if (done != nullptr) {
+      done->post();
+    }
+    return;
+  }
+  for (auto i : roots) {
+    scheduleEagerInit(graph, i);
+  }
+}
+
+std::vector<SingletonVault::CreationStats> SingletonVault::creationStats()
+    const {
+  std::vector<CreationStats> stats;
+  {
+    auto creationTimes = creationTimes_.rlock();
+    auto dependencies = dependencies_.rlock();
+    for (const auto& [type, time] : *creationTimes) {
+      auto& stat = stats.emplace_back();
+      stat.name = type.name();
+      stat.duration = time.duration;
+      stat.selfDuration = time.selfDuration;
+      auto it = dependencies->find(type);
+      if (it != dependencies->end()) {
+        for (const auto& dependency : it->second) {
+          stat.dependencies.push_back(dependency.name());
         }
-      };
-      // if initialization is in progress in another thread, don't try to init
-      // here.  Otherwise the current thread will block on 'createInstance'.
-      if (!single->creationStarted()) {
-        single->createInstance();
       }
-    });
+    }
   }
+  std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) {
+    return a.duration > b.duration;
+  });
+  return stats;
 }
 
 void SingletonVault::destroyInstances() {
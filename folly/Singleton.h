@@ -154,6 +154,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <list>
@@ -292,6 +293,31 @@ struct SingletonVaultState {
   bool isDisabled() const { return state == Type::Quiescing; }
 };
 
+// Observes the creation of a singleton by the calling thread: times its
+// create function, and records the singletons it creates in turn as its
+// dependencies.
+class SingletonCreationScope {
+ public:
+  SingletonCreationScope(SingletonVault& vault, const TypeDescriptor& type);
+  ~SingletonCreationScope();
+
+  SingletonCreationScope(const SingletonCreationScope&) = delete;
+  SingletonCreationScope& operator=(const SingletonCreationScope&) = delete;
+
+  // Records type as a dependency of the singleton being created by the
+  // calling thread, if any.
+  static void observe(SingletonVault& vault, const TypeDescriptor& type);
+
+ private:
+  SingletonVault& vault_;
+  const TypeDescriptor type_;
+  SingletonCreationScope* const parent_;
+  const int uncaughtExceptions_;
+  const std::chrono::steady_clock::time_point start_;
+  // The time spent creating other singletons.
+  std::chrono::nanoseconds nested_{0};
+};
+
 // This interface is used by SingletonVault to interact with SingletonHolders.
 // Having a non-template interface allows SingletonVault to keep a list of all
 // SingletonHolders.
@@ -455,6 +481,15 @@ class SingletonVault {
 
   void addEagerInitOnReenableSingleton(detail::SingletonHolderBase* entry);
 
+  /**
+   * Called by `Singleton<T>.dependsOn<U>()` to declare that the create
+   * function of type uses the singleton of dependency, so that
+   * `doEagerInitVia` creates the latter first.
+   */
+  void addDependency(
+      const detail::TypeDescriptor& type,
+      const detail::TypeDescriptor& dependency);
+
   // Mark registration is complete; no more singletons can be
   // registered at this point.
   void registrationComplete();
@@ -472,6 +507,14 @@ class SingletonVault {
    * If baton ptr is not null, its `post` method is called after all
    * early initialization has completed.
    *
+   * The singletons are initialized in parallel, along the graph of their
+   * dependencies: each one, and each registered singleton an eager one
+   * depends on, is scheduled once the singletons it depends on are built, so
+   * that the threads of the executor don't block on one another. The
+   * dependencies are those declared with `Singleton<T>.dependsOn<U>()`, and
+   * those observed as the create functions ran, as creationStats() reports.
+   * Throws std::logic_error if the declared dependencies have a cycle.
+   *
    * If exceptions are thrown during initialization, this method will still
    * `post` the baton to indicate completion.  The exception will not propagate
    * and future attempts to `try_get` or `get_weak` the failed singleton will
@@ -505,6 +548,25 @@ class SingletonVault {
     return singletons_.rlock()->size();
   }
 
+  struct CreationStats {
+    std::string name;
+    // The time spent in the create function, including the other singletons
+    // it created.
+    std::chrono::nanoseconds duration{};
+    // The same, less the time spent creating the other singletons.
+    std::chrono::nanoseconds selfDuration{};
+    // The singletons it depends on, declared or observed.
+    std::vector<std::string> dependencies;
+  };
+
+  /**
+   * The times taken by the create functions of the singletons built so far,
+   * the slowest first: e.g. to find what holds up a startup which calls
+   * doEagerInit[Via](). A singleton built more than once reports its last
+   * creation.
+   */
+  std::vector<CreationStats> creationStats() const;
+
   /**
    * Flips to true if eager initialization was used, and has completed.
    * Never set to true if "doEagerInit()" or "doEagerInitVia" never called.
@@ -568,6 +630,7 @@ class SingletonVault {
  private:
   template <typename T>
   friend struct detail::SingletonHolder;
+  friend class detail::SingletonCreationScope;
 
   // This method only matters if registrationComplete() is never called.
   // Otherwise destroyInstances is scheduled to be executed atexit.
@@ -602,6 +665,26 @@ class SingletonVault {
       std::unordered_set<detail::SingletonHolderBase*>,
       SharedMutexSuppressTSAN>
       eagerInitOnReenableSingletons_;
+  // Declared with Singleton<T>.dependsOn<U>(), and observed as the create
+  // functions create other singletons.
+  Synchronized<
+      std::unordered_map<
+          detail::TypeDescriptor,
+          std::vector<detail::TypeDescriptor>,
+          detail::TypeDescriptorHasher>,
+      SharedMutexSuppressTSAN>
+      dependencies_;
+  struct CreationTime {
+    std::chrono::nanoseconds duration{};
+    std::chrono::nanoseconds selfDuration{};
+  };
+  Synchronized<
+      std::unordered_map<
+          detail::TypeDescriptor,
+          CreationTime,
+          detail::TypeDescriptorHasher>,
+      SharedMutexSuppressTSAN>
+      creationTimes_;
   Synchronized<std::vector<detail::TypeDescriptor>, SharedMutexSuppressTSAN>
       creationOrder_;
   Synchronized<
@@ -778,6 +861,23 @@ class Singleton {
     return *this;
   }
 
+  /**
+   * Declare that the create function uses the singleton of Dependency (and
+   * DependencyTag), so that doEagerInitVia() builds that one first, rather
+   * than have a thread of its executor wait for it.
+   *
+   * Use like:
+   *   auto gFooInstance =
+   *       Singleton<Foo>(...).shouldEagerInit().dependsOn<Bar>();
+   */
+  template <typename Dependency, typename DependencyTag = detail::DefaultTag>
+  Singleton& dependsOn() {
+    auto vault = SingletonVault::singleton<VaultTag>();
+    vault->addDependency(
+        getEntry().type(), {typeid(Dependency), typeid(DependencyTag)});
+    return *this;
+  }
+
   /**
    * Inject a mock singleton, for testing.
    *
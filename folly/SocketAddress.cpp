@@ -20,6 +20,7 @@
 
 #include <folly/SocketAddress.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstdio>
@@ -29,12 +30,12 @@
 #include <system_error>
 #include <type_traits>
 
-#include <boost/functional/hash.hpp>
-
 #include <fmt/core.h>
 
 #include <folly/Exception.h>
 #include <folly/hash/Hash.h>
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/lang/ToAscii.h>
 #include <folly/net/NetOps.h>
 #include <folly/net/NetworkSocket.h>
 
@@ -433,9 +434,13 @@ bool SocketAddress::isFamilyInet() const {
 }
 
 void SocketAddress::getAddressStr(char* buf, size_t buflen) const {
-  auto ret = getAddressStr();
-  size_t len = std::min(buflen - 1, ret.size());
-  memcpy(buf, ret.data(), len);
+  if (!isFamilyInet()) {
+    throw std::invalid_argument("Can't get address str for non ip address");
+  }
+  char str[IPAddress::kMaxStrSize];
+  size_t len =
+      std::min(buflen - 1, std::get<IPAddr>(storage_).ip.toBuffer(str));
+  memcpy(buf, str, len);
   buf[len] = '\0';
 }
 
@@ -543,63 +548,84 @@ uint32_t SocketAddress::getVsockCID() const {
 #endif
 
 std::string SocketAddress::describe() const {
+  char buf[kMaxDescribeSize];
+  return std::string(buf, describeTo(buf));
+}
+
+size_t SocketAddress::describeTo(char* out) const {
+  static_assert(
+      kMaxDescribeSize >= sizeof(sockaddr_un::sun_path) &&
+          kMaxDescribeSize >= IPAddress::kMaxStrSize + sizeof("[]:65535"),
+      "Not enough room for the description of all addresses");
+  auto copy = [out](StringPiece str) {
+    memcpy(out, str.data(), str.size());
+    return str.size();
+  };
   if (holdsUnix()) {
     const auto& unixAddr = std::get<ExternalUnixAddr>(storage_);
     if (unixAddr.pathLength() == 0) {
-      return "<anonymous unix address>";
+      return copy("<anonymous unix address>");
     }
 
     if (unixAddr.addr->sun_path[0] == '\0') {
       // Linux supports an abstract namespace for unix socket addresses
-      return "<abstract unix address>";
+      return copy("<abstract unix address>");
     }
 
-    return std::string(
+    return copy(StringPiece(
         unixAddr.addr->sun_path,
-        strnlen(unixAddr.addr->sun_path, size_t(unixAddr.pathLength())));
+        strnlen(unixAddr.addr->sun_path, size_t(unixAddr.pathLength()))));
   }
+  // Returns the length of the string written by snprintf, without the null
+  // terminator, which is outside of the description if it was truncated.
+  auto truncated = [](int len) {
+    return std::min(size_t(std::max(len, 0)), kMaxDescribeSize - 1);
+  };
   switch (getFamily()) {
     case AF_UNSPEC:
-      return "<uninitialized address>";
-    case AF_INET: {
-      char buf[NI_MAXHOST + 16];
-      getAddressStr(buf, sizeof(buf));
-      size_t iplen = strlen(buf);
-      snprintf(buf + iplen, sizeof(buf) - iplen, ":%" PRIu16, getPort());
-      return buf;
-    }
+      return copy("<uninitialized address>");
+    case AF_INET:
     case AF_INET6: {
-      char buf[NI_MAXHOST + 18];
-      buf[0] = '[';
-      getAddressStr(buf + 1, sizeof(buf) - 1);
-      size_t iplen = strlen(buf);
-      snprintf(buf + iplen, sizeof(buf) - iplen, "]:%" PRIu16, getPort());
-      return buf;
+      const auto& ipAddr = std::get<IPAddr>(storage_);
+      bool v6 = getFamily() == AF_INET6;
+      size_t len = 0;
+      if (v6) {
+        out[len++] = '[';
+      }
+      len += ipAddr.ip.toBuffer(out + len);
+      if (v6) {
+        out[len++] = ']';
+      }
+      out[len++] = ':';
+      len += to_ascii_decimal(out + len, out + kMaxDescribeSize, ipAddr.port);
+      return len;
     }
 #if FOLLY_HAVE_VSOCK
     case AF_VSOCK: {
-      char buf[32];
       const auto& vsockAddr = std::get<VsockAddr>(storage_);
       auto* maybeName = vsockAddr.getMappedName();
       if (maybeName) {
-        snprintf(
-            buf, sizeof(buf), "[%s:%" PRIu32 "]", maybeName, vsockAddr.port);
-      } else {
-        snprintf(
-            buf,
-            sizeof(buf),
-            "[%" PRIu32 ":%" PRIu32 "]",
-            vsockAddr.cid,
-            vsockAddr.port);
+        return truncated(snprintf(
+            out,
+            kMaxDescribeSize,
+            "[%s:%" PRIu32 "]",
+            maybeName,
+            vsockAddr.port));
       }
-      return buf;
+      return truncated(snprintf(
+          out,
+          kMaxDescribeSize,
+          "[%" PRIu32 ":%" PRIu32 "]",
+          vsockAddr.cid,
+          vsockAddr.port));
     }
 #endif
-    default: {
-      char buf[64];
-      snprintf(buf, sizeof(buf), "<unknown address family %d>", getFamily());
-      return buf;
-    }
+    default:
+      return truncated(snprintf(
+          out,
+          kMaxDescribeSize,
+          "<unknown address family %d>",
+          getFamily()));
   }
 }
 
@@ -671,45 +697,48 @@ bool SocketAddress::prefixMatch(
 }
 
 size_t SocketAddress::hash() const {
-  size_t seed = folly::hash::twang_mix64(getFamily());
+  // Keys are mixed with hash_128_to_64(), so that the result avalanches and
+  // F14 maps can use it as is.
+  const uint64_t family = uint64_t(getFamily());
 
   if (holdsUnix()) {
     const auto& unixAddr = std::get<ExternalUnixAddr>(storage_);
-    enum { kUnixPathMax = sizeof(unixAddr.addr->sun_path) };
-    const char* path = unixAddr.addr->sun_path;
-    auto pathLength = unixAddr.pathLength();
-    // TODO: this probably could be made more efficient
-    for (off_t n = 0; n < pathLength; ++n) {
-      boost::hash_combine(seed, folly::hash::twang_mix64(uint64_t(path[n])));
-    }
+    return hash::hash_128_to_64(
+        family,
+        hash::SpookyHashV2::Hash64(
+            unixAddr.addr->sun_path, size_t(unixAddr.pathLength()), 0));
   }
 
-  switch ((int)getFamily()) {
-    case AF_INET:
+  switch (getFamily()) {
+    case AF_INET: {
+      const auto& ipAddr = std::get<IPAddr>(storage_);
+      return hash::hash_128_to_64(
+          family << 16 | ipAddr.port, ipAddr.ip.asV4().toLong());
+    }
     case AF_INET6: {
-      boost::hash_combine(seed, std::get<IPAddr>(storage_).port);
-      boost::hash_combine(seed, std::get<IPAddr>(storage_).ip.hash());
-      break;
+      const auto& ipAddr = std::get<IPAddr>(storage_);
+      const auto& v6 = ipAddr.ip.asV6();
+      uint64_t high;
+      uint64_t low;
+      memcpy(&high, v6.bytes(), sizeof(high));
+      memcpy(&low, v6.bytes() + sizeof(high), sizeof(low));
+      return hash::hash_128_to_64(
+          hash::hash_128_to_64(high, low),
+          (uint64_t(v6.getScopeId()) << 32) | family << 16 | ipAddr.port);
     }
 #if FOLLY_HAVE_VSOCK
     case AF_VSOCK: {
-      boost::hash_combine(seed, std::get<VsockAddr>(storage_).port);
-      boost::hash_combine(seed, std::get<VsockAddr>(storage_).cid);
-      break;
+      const auto& vsockAddr = std::get<VsockAddr>(storage_);
+      return hash::hash_128_to_64(
+          family << 32 | vsockAddr.port, vsockAddr.cid);
     }
 #endif
-    case AF_UNIX:
-      // Already handled above
-      break;
     case AF_UNSPEC:
-      boost::hash_combine(seed, std::get<IPAddr>(storage_).ip.hash());
-      break;
+      return hash::twang_mix64(family);
     default:
       throw_exception<std::invalid_argument>(
           "SocketAddress: unsupported address family for comparison");
   }
-
-  return seed;
 }
 
 struct addrinfo* SocketAddress::getAddrInfo(
@@ -905,7 +934,8 @@ size_t hash_value(const SocketAddress& address) {
 }
 
 std::ostream& operator<<(std::ostream& os, const SocketAddress& addr) {
-  os << addr.describe();
+  char buf[SocketAddress::kMaxDescribeSize];
+  os.write(buf, std::streamsize(addr.describeTo(buf)));
   return os;
 }
 
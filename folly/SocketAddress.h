@@ -674,6 +674,21 @@ class SocketAddress {
    */
   std::string describe() const;
 
+  /**
+   * Max size of the string written by describeTo().
+   */
+  static constexpr size_t kMaxDescribeSize = 128;
+
+  /**
+   * Writes the string returned by describe() into the buffer, which must
+   * have room for kMaxDescribeSize characters, without allocating memory.
+   * No null terminator is written.
+   *
+   * @param out Char buffer to write the string representation into
+   * @return Length of the string
+   */
+  size_t describeTo(char* out) const;
+
   bool operator==(const SocketAddress& other) const;
   bool operator!=(const SocketAddress& other) const {
     return !(*this == other);
@@ -701,6 +716,9 @@ class SocketAddress {
   /**
    * Compuate a hash of a SocketAddress.
    *
+   * The hash is cheap for IPv4 and IPv6 addresses, and avalanching, so that
+   * F14 maps keyed by SocketAddress use it without mixing it again.
+   *
    * @return Hash for this SocketAddress
    */
   size_t hash() const;
@@ -826,3 +844,10 @@ struct hash<folly::SocketAddress> {
   }
 };
 } // namespace std
+
+namespace folly {
+
+template <typename K>
+struct IsAvalanchingHasher<std::hash<SocketAddress>, K> : std::true_type {};
+
+} // namespace folly
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/StreamVByte.h>
+
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+#include <folly/Likely.h>
+#include <folly/Portability.h>
+#include <folly/container/Array.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+#if FOLLY_SSE_PREREQ(4, 1)
+#include <smmintrin.h>
+#elif FOLLY_NEON && FOLLY_AARCH64
+#include <arm_neon.h>
+#endif
+
+namespace folly {
+
+namespace {
+
+enum class Transform { None, Delta, ZigZag, DeltaZigZag };
+
+constexpr bool isDelta(Transform t) {
+  return t == Transform::Delta || t == Transform::DeltaZigZag;
+}
+
+constexpr bool isZigZag(Transform t) {
+  return t == Transform::ZigZag || t == Transform::DeltaZigZag;
+}
+
+// Bytes taken by a value with the given length code.
+template <typename T>
+constexpr size_t codeLength(size_t code) {
+  return sizeof(T) == 4 ? code + 1 : size_t(1) << code;
+}
+
+// The bits of a value with the given length code.
+template <typename T>
+constexpr T lengthMask(size_t code) {
+  return T(~T(0)) >> (8 * (sizeof(T) - codeLength<T>(code)));
+}
+
+template <typename T>
+FOLLY_ALWAYS_INLINE size_t lengthCode(T x) {
+  // The largest value that fits in codeLength<T>(2) bytes.
+  constexpr T kMax2 = sizeof(T) == 4 ? 0xffffff : 0xffffffff;
+  return size_t(x > 0xff) + size_t(x > 0xffff) + size_t(x > kMax2);
+}
+
+template <Transform kTransform, typename T>
+FOLLY_ALWAYS_INLINE T forward(T x, T& prev) {
+  if constexpr (isDelta(kTransform)) {
+    T delta = x - prev;
+    prev = x;
+    x = delta;
+  }
+  if constexpr (isZigZag(kTransform)) {
+    constexpr int kShift = std::numeric_limits<T>::digits - 1;
+    x = (x << 1) ^ T(std::make_signed_t<T>(x) >> kShift);
+  }
+  return x;
+}
+
+template <Transform kTransform, typename T>
+FOLLY_ALWAYS_INLINE T inverse(T x, T& prev) {
+  if constexpr (isZigZag(kTransform)) {
+    x = (x >> 1) ^ (T(0) - (x & 1));
+  }
+  if constexpr (isDelta(kTransform)) {
+    x += prev;
+    prev = x;
+  }
+  return x;
+}
+
+[[noreturn]] void throwTruncated() {
+  throw_exception<std::invalid_argument>("StreamVByte: truncated input");
+}
+
+#if FOLLY_SSE_PREREQ(4, 1) || (FOLLY_NEON && FOLLY_AARCH64)
+
+// Byte shuffles between the data bytes of 4 32-bit values with the lengths
+// in a control byte and the 16 bytes of the values. 0xff clears the byte on
+// both platforms.
+template <bool kEncode>
+struct ShuffleMask32MakeItem {
+  constexpr std::array<uint8_t, 16> operator()(size_t control) const {
+    std::array<uint8_t, 16> mask{};
+    for (auto& byte : mask) {
+      byte = 0xff;
+    }
+    size_t offset = 0;
+    for (size_t j = 0; j < 4; ++j) {
+      size_t length = codeLength<uint32_t>((control >> (2 * j)) & 3);
+      for (size_t k = 0; k < length; ++k) {
+        if (kEncode) {
+          mask[offset + k] = uint8_t(4 * j + k);
+        } else {
+          mask[4 * j + k] = uint8_t(offset + k);
+        }
+      }
+      offset += length;
+    }
+    return mask;
+  }
+};
+
+// Same for 2 64-bit values, with the 4 bits of their length codes.
+struct ShuffleMask64MakeItem {
+  constexpr std::array<uint8_t, 16> operator()(size_t codes) const {
+    std::array<uint8_t, 16> mask{};
+    for (auto& byte : mask) {
+      byte = 0xff;
+    }
+    size_t offset = 0;
+    for (size_t j = 0; j < 2; ++j) {
+      size_t length = codeLength<uint64_t>((codes >> (2 * j)) & 3);
+      for (size_t k = 0; k < length; ++k) {
+        mask[8 * j + k] = uint8_t(offset + k);
+      }
+      offset += length;
+    }
+    return mask;
+  }
+};
+
+template <typename T, size_t kValues>
+struct LengthMakeItem {
+  constexpr uint8_t operator()(size_t codes) const {
+    size_t length = 0;
+    for (size_t j = 0; j < kValues; ++j) {
+      length += codeLength<T>((codes >> (2 * j)) & 3);
+    }
+    return uint8_t(length);
+  }
+};
+
+alignas(16) constexpr auto kEncodeMasks32 =
+    make_array_with<256>(ShuffleMask32MakeItem<true>{});
+alignas(16) constexpr auto kDecodeMasks32 =
+    make_array_with<256>(ShuffleMask32MakeItem<false>{});
+constexpr auto kLengths32 = make_array_with<256>(LengthMakeItem<uint32_t, 4>{});
+alignas(16) constexpr auto kDecodeMasks64 =
+    make_array_with<16>(ShuffleMask64MakeItem{});
+constexpr auto kLengths64 = make_array_with<16>(LengthMakeItem<uint64_t, 2>{});
+
+#endif
+
+#if FOLLY_SSE_PREREQ(4, 1)
+
+FOLLY_ALWAYS_INLINE __m128i greater32(__m128i x, uint32_t bound) {
+  auto next = _mm_set1_epi32(int(bound + 1));
+  return _mm_cmpeq_epi32(_mm_max_epu32(x, next), x);
+}
+
+// Each of these processes as many groups of 4 values as the input allows
+// and returns the number of values processed, advancing data and prev.
+template <Transform kTransform>
+size_t encodeSimd(
+    const uint32_t* in,
+    size_t count,
+    uint8_t* control,
+    uint8_t*& data,
+    uint32_t& prev) {
+  auto prevVec = _mm_set1_epi32(int(prev));
+  const auto codeShifts = _mm_setr_epi32(1, 1 << 2, 1 << 4, 1 << 6);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    if constexpr (isDelta(kTransform)) {
+      auto delta = _mm_sub_epi32(x, _mm_alignr_epi8(x, prevVec, 12));
+      prevVec = x;
+      x = delta;
+    }
+    if constexpr (isZigZag(kTransform)) {
+      x = _mm_xor_si128(_mm_slli_epi32(x, 1), _mm_srai_epi32(x, 31));
+    }
+    // Each comparison is -1 in the lanes that need one more byte.
+    auto codes = _mm_sub_epi32(
+        _mm_setzero_si128(),
+        _mm_add_epi32(
+            _mm_add_epi32(greater32(x, 0xff), greater32(x, 0xffff)),
+            greater32(x, 0xffffff)));
+    codes = _mm_mullo_epi32(codes, codeShifts);
+    codes = _mm_or_si128(codes, _mm_srli_si128(codes, 8));
+    codes = _mm_or_si128(codes, _mm_srli_si128(codes, 4));
+    auto c = uint8_t(_mm_cvtsi128_si32(codes));
+    control[i / 4] = c;
+    auto mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(kEncodeMasks32[c].data()));
+    // Stays within maxEncodedSize(), as data is at most 4 bytes per value
+    // past the control bytes.
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(x, mask));
+    data += kLengths32[c];
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = in[i - 1];
+  }
+  return i;
+}
+
+template <Transform kTransform>
+size_t decodeSimd(
+    const uint8_t* control,
+    const uint8_t*& data,
+    const uint8_t* end,
+    size_t count,
+    uint32_t* out,
+    uint32_t& prev) {
+  auto prevVec = _mm_set1_epi32(int(prev));
+  size_t i = 0;
+  for (; i + 4 <= count && end - data >= 16; i += 4) {
+    auto c = control[i / 4];
+    auto mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(kDecodeMasks32[c].data()));
+    auto x = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), mask);
+    data += kLengths32[c];
+    if constexpr (isZigZag(kTransform)) {
+      auto sign = _mm_and_si128(x, _mm_set1_epi32(1));
+      x = _mm_xor_si128(
+          _mm_srli_epi32(x, 1), _mm_sub_epi32(_mm_setzero_si128(), sign));
+    }
+    if constexpr (isDelta(kTransform)) {
+      x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+      x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+      x = _mm_add_epi32(x, prevVec);
+      prevVec = _mm_shuffle_epi32(x, 0xff);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = out[i - 1];
+  }
+  return i;
+}
+
+template <Transform kTransform>
+size_t decodeSimd(
+    const uint8_t* control,
+    const uint8_t*& data,
+    const uint8_t* end,
+    size_t count,
+    uint64_t* out,
+    uint64_t& prev) {
+  auto prevVec = _mm_set1_epi64x(int64_t(prev));
+  size_t i = 0;
+  // Two shuffles of 2 values each per control byte.
+  for (; i + 2 <= count && end - data >= 16; i += 2) {
+    auto codes = (control[i / 4] >> (2 * (i % 4))) & 0xf;
+    auto mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(kDecodeMasks64[codes].data()));
+    auto x = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), mask);
+    data += kLengths64[codes];
+    if constexpr (isZigZag(kTransform)) {
+      auto sign = _mm_and_si128(x, _mm_set1_epi64x(1));
+      x = _mm_xor_si128(
+          _mm_srli_epi64(x, 1), _mm_sub_epi64(_mm_setzero_si128(), sign));
+    }
+    if constexpr (isDelta(kTransform)) {
+      x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+      x = _mm_add_epi64(x, prevVec);
+      prevVec = _mm_unpackhi_epi64(x, x);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = out[i - 1];
+  }
+  return i;
+}
+
+#elif FOLLY_NEON && FOLLY_AARCH64
+
+template <Transform kTransform>
+size_t encodeSimd(
+    const uint32_t* in,
+    size_t count,
+    uint8_t* control,
+    uint8_t*& data,
+    uint32_t& prev) {
+  auto prevVec = vdupq_n_u32(prev);
+  const int32_t kCodeShifts[] = {0, 2, 4, 6};
+  const auto codeShifts = vld1q_s32(kCodeShifts);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto x = vld1q_u32(in + i);
+    if constexpr (isDelta(kTransform)) {
+      auto delta = vsubq_u32(x, vextq_u32(prevVec, x, 3));
+      prevVec = x;
+      x = delta;
+    }
+    if constexpr (isZigZag(kTransform)) {
+      auto sign =
+          vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(x), 31));
+      x = veorq_u32(vshlq_n_u32(x, 1), sign);
+    }
+    // Each comparison is all ones in the lanes that need one more byte.
+    auto codes = vsubq_u32(
+        vdupq_n_u32(0),
+        vaddq_u32(
+            vaddq_u32(
+                vcgtq_u32(x, vdupq_n_u32(0xff)),
+                vcgtq_u32(x, vdupq_n_u32(0xffff))),
+            vcgtq_u32(x, vdupq_n_u32(0xffffff))));
+    auto c = uint8_t(vaddvq_u32(vshlq_u32(codes, codeShifts)));
+    control[i / 4] = c;
+    // Stays within maxEncodedSize(), as data is at most 4 bytes per value
+    // past the control bytes.
+    auto mask = vld1q_u8(kEncodeMasks32[c].data());
+    vst1q_u8(data, vqtbl1q_u8(vreinterpretq_u8_u32(x), mask));
+    data += kLengths32[c];
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = in[i - 1];
+  }
+  return i;
+}
+
+template <Transform kTransform>
+size_t decodeSimd(
+    const uint8_t* control,
+    const uint8_t*& data,
+    const uint8_t* end,
+    size_t count,
+    uint32_t* out,
+    uint32_t& prev) {
+  auto prevVec = vdupq_n_u32(prev);
+  const auto zero = vdupq_n_u32(0);
+  size_t i = 0;
+  for (; i + 4 <= count && end - data >= 16; i += 4) {
+    auto c = control[i / 4];
+    auto x = vreinterpretq_u32_u8(
+        vqtbl1q_u8(vld1q_u8(data), vld1q_u8(kDecodeMasks32[c].data())));
+    data += kLengths32[c];
+    if constexpr (isZigZag(kTransform)) {
+      auto sign = vsubq_u32(zero, vandq_u32(x, vdupq_n_u32(1)));
+      x = veorq_u32(vshrq_n_u32(x, 1), sign);
+    }
+    if constexpr (isDelta(kTransform)) {
+      x = vaddq_u32(x, vextq_u32(zero, x, 3));
+      x = vaddq_u32(x, vextq_u32(zero, x, 2));
+      x = vaddq_u32(x, prevVec);
+      prevVec = vdupq_laneq_u32(x, 3);
+    }
+    vst1q_u32(out + i, x);
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = out[i - 1];
+  }
+  return i;
+}
+
+template <Transform kTransform>
+size_t decodeSimd(
+    const uint8_t* control,
+    const uint8_t*& data,
+    const uint8_t* end,
+    size_t count,
+    uint64_t* out,
+    uint64_t& prev) {
+  auto prevVec = vdupq_n_u64(prev);
+  const auto zero = vdupq_n_u64(0);
+  size_t i = 0;
+  // Two shuffles of 2 values each per control byte.
+  for (; i + 2 <= count && end - data >= 16; i += 2) {
+    auto codes = (control[i / 4] >> (2 * (i % 4))) & 0xf;
+    auto x = vreinterpretq_u64_u8(
+        vqtbl1q_u8(vld1q_u8(data), vld1q_u8(kDecodeMasks64[codes].data())));
+    data += kLengths64[codes];
+    if constexpr (isZigZag(kTransform)) {
+      auto sign = vsubq_u64(zero, vandq_u64(x, vdupq_n_u64(1)));
+      x = veorq_u64(vshrq_n_u64(x, 1), sign);
+    }
+    if constexpr (isDelta(kTransform)) {
+      x = vaddq_u64(x, vextq_u64(zero, x, 1));
+      x = vaddq_u64(x, prevVec);
+      prevVec = vdupq_laneq_u64(x, 1);
+    }
+    vst1q_u64(out + i, x);
+  }
+  if (isDelta(kTransform) && i > 0) {
+    prev = out[i - 1];
+  }
+  return i;
+}
+
+#endif
+
+template <typename T, Transform kTransform>
+size_t encodeImpl(const T* in, size_t count, uint8_t* out, T prev) {
+  uint8_t* control = out;
+  uint8_t* data = out + StreamVByte<T>::controlSize(count);
+  size_t i = 0;
+#if FOLLY_SSE_PREREQ(4, 1) || (FOLLY_NEON && FOLLY_AARCH64)
+  if constexpr (std::is_same<T, uint32_t>::value) {
+    i = encodeSimd<kTransform>(in, count, control, data, prev);
+  }
+#endif
+  // Stays within maxEncodedSize(), as data is at most sizeof(T) bytes per
+  // value past the control bytes.
+  for (; i + 4 <= count; i += 4) {
+    uint8_t c = 0;
+    FOLLY_PRAGMA_UNROLL_N(4)
+    for (size_t j = 0; j < 4; ++j) {
+      T x = forward<kTransform>(in[i + j], prev);
+      auto code = lengthCode(x);
+      c |= uint8_t(code << (2 * j));
+      storeUnaligned(data, Endian::little(x));
+      data += codeLength<T>(code);
+    }
+    control[i / 4] = c;
+  }
+  if (i < count) {
+    control[i / 4] = 0;
+  }
+  for (; i < count; ++i) {
+    T x = forward<kTransform>(in[i], prev);
+    auto code = lengthCode(x);
+    control[i / 4] |= uint8_t(code << (2 * (i % 4)));
+    storeUnaligned(data, Endian::little(x));
+    data += codeLength<T>(code);
+  }
+  return size_t(data - out);
+}
+
+template <typename T, Transform kTransform>
+size_t decodeImpl(ByteRange in, size_t count, T* out, T prev) {
+  auto controlSize = StreamVByte<T>::controlSize(count);
+  if (FOLLY_UNLIKELY(in.size() < controlSize)) {
+    throwTruncated();
+  }
+  const uint8_t* control = in.data();
+  const uint8_t* data = control + controlSize;
+  const uint8_t* end = in.end();
+  size_t i = 0;
+#if FOLLY_SSE_PREREQ(4, 1) || (FOLLY_NEON && FOLLY_AARCH64)
+  i = decodeSimd<kTransform>(control, data, end, count, out, prev);
+#endif
+  // Whole groups, while they cannot run past the end.
+  for (; i + 4 <= count && size_t(end - data) >= 4 * sizeof(T); i += 4) {
+    auto c = control[i / 4];
+    FOLLY_PRAGMA_UNROLL_N(4)
+    for (size_t j = 0; j < 4; ++j) {
+      auto code = (c >> (2 * j)) & 3;
+      T x = Endian::little(loadUnaligned<T>(data)) & lengthMask<T>(code);
+      data += codeLength<T>(code);
+      out[i + j] = inverse<kTransform>(x, prev);
+    }
+  }
+  for (; i < count; ++i) {
+    auto code = (control[i / 4] >> (2 * (i % 4))) & 3;
+    auto length = codeLength<T>(code);
+    auto available = size_t(end - data);
+    T x = 0;
+    if (available >= sizeof(T)) {
+      x = Endian::little(loadUnaligned<T>(data)) & lengthMask<T>(code);
+    } else if (FOLLY_LIKELY(available >= length)) {
+      for (size_t k = 0; k < length; ++k) {
+        x |= T(data[k]) << (8 * k);
+      }
+    } else {
+      throwTruncated();
+    }
+    data += length;
+    out[i] = inverse<kTransform>(x, prev);
+  }
+  return size_t(data - in.data());
+}
+
+} // namespace
+
+template <typename T>
+size_t StreamVByte<T>::encodedSize(const T* in, size_t count) {
+  size_t size = controlSize(count);
+  for (size_t i = 0; i < count; ++i) {
+    size += codeLength<T>(lengthCode(in[i]));
+  }
+  return size;
+}
+
+template <typename T>
+size_t StreamVByte<T>::encode(const T* in, size_t count, uint8_t* out) {
+  return encodeImpl<T, Transform::None>(in, count, out, 0);
+}
+
+template <typename T>
+size_t StreamVByte<T>::encodeDelta(
+    const T* in, size_t count, uint8_t* out, T initial) {
+  return encodeImpl<T, Transform::Delta>(in, count, out, initial);
+}
+
+template <typename T>
+size_t StreamVByte<T>::encodeZigZag(
+    const signed_type* in, size_t count, uint8_t* out) {
+  return encodeImpl<T, Transform::ZigZag>(
+      reinterpret_cast<const T*>(in), count, out, 0);
+}
+
+template <typename T>
+size_t StreamVByte<T>::encodeDeltaZigZag(
+    const signed_type* in, size_t count, uint8_t* out, signed_type initial) {
+  return encodeImpl<T, Transform::DeltaZigZag>(
+      reinterpret_cast<const T*>(in), count, out, T(initial));
+}
+
+template <typename T>
+size_t StreamVByte<T>::decode(ByteRange in, size_t count, T* out) {
+  return decodeImpl<T, Transform::None>(in, count, out, 0);
+}
+
+template <typename T>
+size_t StreamVByte<T>::decodeDelta(
+    ByteRange in, size_t count, T* out, T initial) {
+  return decodeImpl<T, Transform::Delta>(in, count, out, initial);
+}
+
+template <typename T>
+size_t StreamVByte<T>::decodeZigZag(
+    ByteRange in, size_t count, signed_type* out) {
+  return decodeImpl<T, Transform::ZigZag>(
+      in, count, reinterpret_cast<T*>(out), 0);
+}
+
+template <typename T>
+size_t StreamVByte<T>::decodeDeltaZigZag(
+    ByteRange in, size_t count, signed_type* out, signed_type initial) {
+  return decodeImpl<T, Transform::DeltaZigZag>(
+      in, count, reinterpret_cast<T*>(out), T(initial));
+}
+
+template class StreamVByte<uint32_t>;
+template class StreamVByte<uint64_t>;
+
+} // namespace folly
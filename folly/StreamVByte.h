@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <folly/Range.h>
+
+namespace folly {
+
+/**
+ * StreamVByte encoding of arrays of 32-bit or 64-bit integers.
+ *
+ * Reference: https://arxiv.org/abs/1709.08990
+ *
+ * Like GroupVarint, each value is stored in as few bytes as its magnitude
+ * needs, with a 2-bit length code, four codes to a control byte. Unlike
+ * GroupVarint, all control bytes come first, followed by all data bytes:
+ *
+ *   [controlSize(count) control bytes][data bytes]
+ *
+ * so finding the next group of values does not depend on decoding the
+ * previous one, and with SSE4.1 or AArch64 NEON both encode and decode
+ * handle four 32-bit values per byte shuffle. The number of values is not
+ * part of the encoding; callers store it next to the data.
+ *
+ * The length codes 0..3 stand for 1..4 bytes for StreamVByte<uint32_t>, and
+ * for 1, 2, 4 or 8 bytes for StreamVByte<uint64_t>. The 64-bit decoder is
+ * vectorized as well; the 64-bit encoder is scalar.
+ *
+ * The Delta variants store each value minus the previous one (the first one
+ * minus initial), which keeps sorted sequences such as posting lists small.
+ * The ZigZag variants store signed values with small magnitudes in few
+ * bytes, and the DeltaZigZag ones store zigzagged differences, for series
+ * that go up and down such as timestamps and gauges. Arithmetic wraps around,
+ * so any input round-trips.
+ *
+ *   std::vector<uint8_t> buf(StreamVByte<uint32_t>::maxEncodedSize(n));
+ *   buf.resize(StreamVByte<uint32_t>::encodeDelta(docIds, n, buf.data()));
+ *   ...
+ *   StreamVByte<uint32_t>::decodeDelta(ByteRange(buf), n, docIds);
+ */
+template <typename T>
+class StreamVByte {
+  static_assert(
+      std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value,
+      "StreamVByte encodes uint32_t or uint64_t");
+
+ public:
+  using type = T;
+  using signed_type = std::make_signed_t<T>;
+
+  /**
+   * Number of control bytes for count values.
+   */
+  static constexpr size_t controlSize(size_t count) { return (count + 3) / 4; }
+
+  /**
+   * Size of the buffer that encoding count values needs. The encoders may
+   * write anywhere in it, even past the size they return.
+   */
+  static constexpr size_t maxEncodedSize(size_t count) {
+    return controlSize(count) + count * sizeof(T);
+  }
+
+  /**
+   * Exact number of bytes that encode(in, count, out) returns.
+   */
+  static size_t encodedSize(const T* in, size_t count);
+
+  /**
+   * Encode count values into out, which must have maxEncodedSize(count)
+   * bytes, and return the number of bytes used.
+   */
+  static size_t encode(const T* in, size_t count, uint8_t* out);
+  static size_t encodeDelta(
+      const T* in, size_t count, uint8_t* out, T initial = 0);
+  static size_t encodeZigZag(const signed_type* in, size_t count, uint8_t* out);
+  static size_t encodeDeltaZigZag(
+      const signed_type* in,
+      size_t count,
+      uint8_t* out,
+      signed_type initial = 0);
+
+  /**
+   * Decode count values from the beginning of in, and return the number of
+   * bytes consumed. Never reads past the end of in.
+   *
+   * @throws std::invalid_argument if in is shorter than the encoding of count
+   * values.
+   */
+  static size_t decode(ByteRange in, size_t count, T* out);
+  static size_t decodeDelta(ByteRange in, size_t count, T* out, T initial = 0);
+  static size_t decodeZigZag(ByteRange in, size_t count, signed_type* out);
+  static size_t decodeDeltaZigZag(
+      ByteRange in, size_t count, signed_type* out, signed_type initial = 0);
+};
+
+extern template class StreamVByte<uint32_t>;
+extern template class StreamVByte<uint64_t>;
+
+using StreamVByte32 = StreamVByte<uint32_t>;
+using StreamVByte64 = StreamVByte<uint64_t>;
+
+} // namespace folly
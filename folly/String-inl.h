@@ -16,10 +16,12 @@
 
 #pragma once
 
+#include <cstring>
 #include <iterator>
 #include <stdexcept>
 
 #include <folly/CppAttributes.h>
+#include <folly/codec/hex.h>
 #include <folly/container/Reserve.h>
 
 #ifndef FOLLY_STRING_H_
@@ -81,6 +83,17 @@ extern const std::array<char, 256> cUnescapeTable;
 
 // Map from the character code to the hex value, or 16 if invalid hex char.
 extern const std::array<unsigned char, 256> hexTable;
+
+// Whether the characters of a string are contiguous bytes, which hexlify and
+// unhexlify convert in bulk.
+template <class String, class = void>
+constexpr bool hex_string_is_contiguous_v = false;
+template <class String>
+constexpr bool hex_string_is_contiguous_v<
+    String,
+    std::void_t<decltype(std::data(std::declval<String&>()))>> =
+    std::is_pointer_v<decltype(std::data(std::declval<String&>()))> &&
+    sizeof(*std::data(std::declval<String&>())) == 1;
 } // namespace detail
 
 template <class String>
@@ -267,11 +280,26 @@ inline size_t delimSize(char) {
 inline size_t delimSize(StringPiece s) {
   return s.size();
 }
-inline bool atDelim(const char* s, char c) {
-  return *s == c;
+inline size_t delimSize(AnyCharOf) {
+  return 1;
+}
+
+// Returns the position of the first delimiter in sp at or after pos, or
+// sp.size() if there is none. An empty delimiter is never found.
+inline size_t findDelim(StringPiece sp, size_t pos, char c) {
+  auto const p = static_cast<const char*>(
+      pos < sp.size() ? std::memchr(sp.data() + pos, c, sp.size() - pos)
+                      : nullptr);
+  return p ? size_t(p - sp.data()) : sp.size();
+}
+inline size_t findDelim(StringPiece sp, size_t pos, StringPiece delim) {
+  if (delim.size() <= 1) {
+    return delim.empty() ? sp.size() : findDelim(sp, pos, delim.front());
+  }
+  return simdFindString(sp, pos, delim);
 }
-inline bool atDelim(const char* s, StringPiece sp) {
-  return !std::memcmp(s, sp.start(), sp.size());
+inline size_t findDelim(StringPiece sp, size_t pos, AnyCharOf delim) {
+  return simdFindFirstOf(sp, pos, delim.chars());
 }
 
 // These are used to short-circuit internalSplit() in the case of
@@ -284,6 +312,10 @@ inline char delimFront(StringPiece s) {
   assert(!s.empty() && s.start() != nullptr);
   return *s.start();
 }
+inline char delimFront(AnyCharOf) {
+  // This one exists only for compile-time; it should never be called.
+  std::abort();
+}
 
 template <class OutStringT, class DelimT, class OutputIterator>
 void internalSplit(
@@ -326,7 +358,6 @@ void internalSplit(
     DelimT delim, StringPiece sp, OutputIterator out, bool ignoreEmpty) {
   assert(sp.empty() || sp.start() != nullptr);
 
-  const char* s = sp.start();
   const size_t strSize = sp.size();
   const size_t dSize = delimSize(delim);
 
@@ -343,21 +374,14 @@ void internalSplit(
   }
 
   size_t tokenStartPos = 0;
-  size_t tokenSize = 0;
-  for (size_t i = 0; i <= strSize - dSize; ++i) {
-    if (atDelim(&s[i], delim)) {
-      if (!ignoreEmpty || tokenSize > 0) {
-        *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, tokenSize));
-      }
-
-      tokenStartPos = i + dSize;
-      tokenSize = 0;
-      i += dSize - 1;
-    } else {
-      ++tokenSize;
+  for (size_t i = findDelim(sp, 0, delim); i != strSize;
+       i = findDelim(sp, tokenStartPos, delim)) {
+    if (!ignoreEmpty || i > tokenStartPos) {
+      *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, i - tokenStartPos));
     }
+    tokenStartPos = i + dSize;
   }
-  tokenSize = strSize - tokenStartPos;
+  size_t tokenSize = strSize - tokenStartPos;
   if (!ignoreEmpty || tokenSize > 0) {
     *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, tokenSize));
   }
@@ -370,6 +394,19 @@ StringPiece prepareDelim(const String& s) {
 inline char prepareDelim(char c) {
   return c;
 }
+inline AnyCharOf prepareDelim(AnyCharOf delim) {
+  return delim;
+}
+
+// Returns the position of the first delimiter in input, or npos.
+template <class Delim>
+size_t splitFixedFind(StringPiece input, const Delim& delimiter) {
+  return input.find(delimiter);
+}
+inline size_t splitFixedFind(StringPiece input, AnyCharOf delimiter) {
+  size_t pos = findDelim(input, 0, delimiter);
+  return pos == input.size() ? std::string::npos : pos;
+}
 
 template <class OutputType>
 void toOrIgnore(StringPiece input, OutputType& output) {
@@ -380,7 +417,8 @@ inline void toOrIgnore(StringPiece, decltype(std::ignore)&) {}
 
 template <bool exact, class Delim, class OutputType>
 bool splitFixed(const Delim& delimiter, StringPiece input, OutputType& output) {
-  if (exact && FOLLY_UNLIKELY(std::string::npos != input.find(delimiter))) {
+  if (exact &&
+      FOLLY_UNLIKELY(std::string::npos != splitFixedFind(input, delimiter))) {
     return false;
   }
   toOrIgnore(input, output);
@@ -393,7 +431,7 @@ bool splitFixed(
     StringPiece input,
     OutputType& outHead,
     OutputTypes&... outTail) {
-  size_t cut = input.find(delimiter);
+  size_t cut = splitFixedFind(input, delimiter);
   if (FOLLY_UNLIKELY(cut == std::string::npos)) {
     return false;
   }
@@ -452,6 +490,33 @@ split(const Delim& delimiter, StringPiece input, OutputTypes&... outputs) {
       detail::prepareDelim(delimiter), input, outputs...);
 }
 
+template <class Delim>
+auto splitLazy(const Delim& delimiter, StringPiece input, bool ignoreEmpty) {
+  using DelimT = decltype(detail::prepareDelim(delimiter));
+  return detail::SplitLazyRange<DelimT>(
+      detail::prepareDelim(delimiter), input, ignoreEmpty);
+}
+
+namespace detail {
+
+template <class Delim>
+void SplitLazyRange<Delim>::iterator::advance() {
+  const StringPiece input = range_->input_;
+  while (next_ != kEnd) {
+    start_ = next_;
+    const size_t pos = findDelim(input, start_, range_->delim_);
+    token_ = input.subpiece(start_, pos - start_);
+    next_ = pos == input.size() ? kEnd : pos + delimSize(range_->delim_);
+    if (!range_->ignoreEmpty_ || !token_.empty()) {
+      return;
+    }
+  }
+  start_ = kEnd;
+  token_ = StringPiece();
+}
+
+} // namespace detail
+
 namespace detail {
 
 /*
@@ -618,6 +683,15 @@ bool hexlify(
   static char hexValues[] = "0123456789abcdef";
   auto j = output.size();
   output.resize(2 * input.size() + output.size());
+  if constexpr (
+      detail::hex_string_is_contiguous_v<const InputString> &&
+      detail::hex_string_is_contiguous_v<OutputString>) {
+    hex_encode(
+        reinterpret_cast<char*>(std::data(output)) + j,
+        std::data(input),
+        input.size());
+    return true;
+  }
   for (size_t i = 0; i < input.size(); ++i) {
     int ch = input[i];
     output[j++] = hexValues[(ch >> 4) & 0xf];
@@ -632,6 +706,14 @@ bool unhexlify(const InputString& input, OutputString& output) {
     return false;
   }
   output.resize(input.size() / 2);
+  if constexpr (
+      detail::hex_string_is_contiguous_v<const InputString> &&
+      detail::hex_string_is_contiguous_v<OutputString>) {
+    return hex_decode(
+        std::data(output),
+        reinterpret_cast<const char*>(std::data(input)),
+        output.size());
+  }
   int j = 0;
 
   for (size_t i = 0; i < input.size(); i += 2) {
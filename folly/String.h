@@ -441,6 +441,25 @@ class small_vector;
 template <typename T, typename Allocator>
 class fbvector;
 
+/**
+ * A delimiter for split(), splitTo() and splitLazy() which matches any one of
+ * a set of characters, e.g. whitespace:
+ *
+ *   std::vector<folly::StringPiece> words;
+ *   folly::split(folly::AnyCharOf(" \t"), line, words, true);
+ *
+ * The characters are not copied, and must outlive the split.
+ */
+class AnyCharOf {
+ public:
+  explicit AnyCharOf(StringPiece chars) noexcept : chars_(chars) {}
+
+  StringPiece chars() const noexcept { return chars_; }
+
+ private:
+  StringPiece chars_;
+};
+
 namespace detail {
 
 // We don't use SimdSplitByCharIsDefinedFor because
@@ -596,6 +615,94 @@ typename std::enable_if<
     bool>::type
 split(const Delim& delimiter, StringPiece input, OutputTypes&... outputs);
 
+namespace detail {
+
+template <class Delim>
+class SplitLazyRange {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = StringPiece;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const StringPiece*;
+    using reference = const StringPiece&;
+
+    iterator() = default;
+
+    reference operator*() const { return token_; }
+    pointer operator->() const { return &token_; }
+
+    iterator& operator++() {
+      advance();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto copy = *this;
+      advance();
+      return copy;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.range_ == b.range_ && a.start_ == b.start_;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class SplitLazyRange;
+
+    // The position of the token after the last one.
+    static constexpr size_t kEnd = size_t(-1);
+
+    explicit iterator(const SplitLazyRange* range) : range_(range), next_(0) {
+      advance();
+    }
+    iterator(const SplitLazyRange* range, size_t start)
+        : range_(range), start_(start) {}
+
+    void advance();
+
+    const SplitLazyRange* range_{nullptr};
+    // The positions of the current token, and of the next one.
+    size_t start_{kEnd};
+    size_t next_{kEnd};
+    StringPiece token_;
+  };
+
+  SplitLazyRange(Delim delim, StringPiece input, bool ignoreEmpty)
+      : delim_(delim), input_(input), ignoreEmpty_(ignoreEmpty) {}
+
+  iterator begin() const { return iterator(this); }
+  iterator end() const { return iterator(this, iterator::kEnd); }
+
+ private:
+  Delim delim_;
+  StringPiece input_;
+  bool ignoreEmpty_;
+};
+
+} // namespace detail
+
+/**
+ * Split a string into tokens lazily: returns a range of StringPiece tokens,
+ * which finds the next delimiter when it is iterated, without materializing
+ * a container.
+ *
+ * The delimiter is a char, a string, or AnyCharOf. The tokens are the same as
+ * the ones of split() to a container of StringPiece; the range refers to the
+ * input, which must outlive it.
+ *
+ *   auto const delim = folly::AnyCharOf(" \t");
+ *   for (folly::StringPiece word : folly::splitLazy(delim, line, true)) {
+ *     ...
+ *   }
+ */
+template <class Delim>
+auto splitLazy(
+    const Delim& delimiter, StringPiece input, bool ignoreEmpty = false);
+
 /**
  * Join list of tokens.
  *
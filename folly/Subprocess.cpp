@@ -28,8 +28,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <system_error>
 #include <thread>
+#include <unordered_map>
 
 #include <boost/container/flat_set.hpp>
 #include <boost/range/adaptors.hpp>
@@ -45,6 +49,7 @@
 #include <folly/portability/Fcntl.h>
 #include <folly/portability/Sockets.h>
 #include <folly/portability/Stdlib.h>
+#include <folly/portability/SysStat.h>
 #include <folly/portability/SysSyscall.h>
 #include <folly/portability/Unistd.h>
 #include <folly/system/AtFork.h>
@@ -245,6 +250,8 @@ struct Subprocess::SpawnRawArgs {
   char const* const* argv{};
   char const* const* envv{};
   char const* executable{};
+  // The executable as found on the PATH by the parent, for usePath().
+  char const* resolvedExecutable{};
   ChildErrorInfo* err{};
   sigset_t oldSignals{};
 
@@ -593,6 +600,58 @@ void Subprocess::spawn(
   pipesGuard.dismiss();
 }
 
+namespace {
+
+// The executables which usePath() found, by their name and the PATH they were
+// found on, so that repeated spawns don't each search the PATH in the child.
+// The child falls back to execvp() if the executable isn't there anymore.
+std::shared_ptr<const std::string> resolveExecutable(const char* name) {
+  static constexpr size_t kMaxEntries = 1024;
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<const std::string>>
+      cache;
+
+  auto const path = ::getenv("PATH");
+  if (path == nullptr || *name == '\0' || std::strchr(name, '/')) {
+    return nullptr;
+  }
+  auto key = std::string(name) + '\0' + path;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+
+  std::vector<StringPiece> dirs;
+  split(':', path, dirs);
+  std::shared_ptr<const std::string> resolved;
+  for (auto const& dir : dirs) {
+    // Relative entries depend on the working directory of the child.
+    if (!dir.startsWith('/')) {
+      return nullptr;
+    }
+    auto candidate = to<std::string>(dir, dir.endsWith('/') ? "" : "/", name);
+    struct stat st;
+    if (::stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+        ::access(candidate.c_str(), X_OK) == 0) {
+      resolved = std::make_shared<const std::string>(std::move(candidate));
+      break;
+    }
+  }
+  if (resolved) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cache.size() >= kMaxEntries) {
+      cache.clear();
+    }
+    cache.emplace(std::move(key), resolved);
+  }
+  return resolved;
+}
+
+} // namespace
+
 void Subprocess::spawnInternal(
     std::unique_ptr<const char*[]> argv,
     const char* executable,
@@ -686,11 +745,18 @@ void Subprocess::spawnInternal(
     CHECK_EQ(r, 0) << "pthread_sigmask: " << errnoStr(r); // shouldn't fail
   };
 
+  std::shared_ptr<const std::string> resolvedExecutable;
+  if (options.usePath_) {
+    resolvedExecutable = resolveExecutable(executable);
+  }
+
   SpawnRawArgs::Scratch scratch{options};
   SpawnRawArgs args{scratch, options};
   args.argv = argv.get();
   args.envv = env ? envHolder.get() : environ;
   args.executable = executable;
+  args.resolvedExecutable =
+      resolvedExecutable ? resolvedExecutable->c_str() : nullptr;
   args.err = err;
   args.oldSignals = options.sigmask_.value_or(oldSignals);
 
@@ -802,6 +868,29 @@ int Subprocess::prepareChildDoLinuxCGroup(SpawnRawArgs const& args) {
 // handler.
 FOLLY_DETAIL_SUBPROCESS_RAW
 void Subprocess::closeInheritedFds(const SpawnRawArgs& args) {
+#if defined(__linux__) && defined(SYS_close_range)
+  {
+    // close_range() (Linux >= 5.9) closes the gaps between the fds to keep,
+    // without listing the open ones. If it isn't supported, the first call
+    // fails and closes nothing.
+    unsigned first = 3;
+    bool closed = true;
+    for (auto const& action : args.fdActions) {
+      auto const fd = unsigned(action.first);
+      if (fd < first) {
+        continue;
+      }
+      if (fd > first && syscall(SYS_close_range, first, fd - 1, 0) != 0) {
+        closed = false;
+        break;
+      }
+      first = fd + 1;
+    }
+    if (closed && syscall(SYS_close_range, first, ~0u, 0) == 0) {
+      return;
+    }
+  }
+#endif
 #if defined(__linux__)
   int dirfd = detail::subprocess_libc::open("/proc/self/fd", O_RDONLY);
   if (dirfd != -1) {
@@ -1020,6 +1109,9 @@ int Subprocess::runChild(SpawnRawArgs const& args) {
   auto envv = const_cast<char* const*>(args.envv);
   // Now, finally, exec.
   if (args.usePath) {
+    if (args.resolvedExecutable) {
+      ::execve(args.resolvedExecutable, argv, envv);
+    }
     ::execvp(args.executable, argv);
   } else {
     ::execve(args.executable, argv, envv);
@@ -29,9 +29,10 @@
  * which holds
  * a lock *that blocks all creation and destruction of managed
  * objects managed by the ThreadLocal. The accessor can be used
- * as an iterable container. Note: for now, the accessor also happens to hold
- * other per tag global locks and hence calls to accessAllThreads() are
- * serialized at tag level.
+ * as an iterable container. It doesn't hold the per tag global lock, so that
+ * the threads may start, use other ThreadLocal objects of the tag, and grow
+ * their arrays of elements while it is held. In strict mode, the calls to
+ * accessAllThreads() are serialized at tag level.
  *
  * accessAllThreads() can race with destruction of thread-local elements. We
  * provide a strict mode which is dangerous because it requires the access lock
@@ -44,6 +45,9 @@
  * There are two classes here - ThreadLocal and ThreadLocalPtr.  ThreadLocalPtr
  * has semantics similar to boost::thread_specific_ptr. ThreadLocal is a thin
  * wrapper around ThreadLocalPtr that manages allocation automatically.
+ *
+ * A few instances which are accessed on hot paths may be constructed with
+ * thread_local_hot: see ThreadLocalPtr.
  */
 
 #pragma once
@@ -64,6 +68,15 @@ namespace folly {
 template <class T, class Tag, class AccessMode>
 class ThreadLocalPtr;
 
+/**
+ * Requests a static TLS slot for a ThreadLocal or ThreadLocalPtr: see
+ * ThreadLocalPtr.
+ */
+struct thread_local_hot_t {
+  explicit thread_local_hot_t() = default;
+};
+inline constexpr thread_local_hot_t thread_local_hot{};
+
 template <class T, class Tag = void, class AccessMode = void>
 class ThreadLocal {
  public:
@@ -73,6 +86,13 @@ class ThreadLocal {
   explicit ThreadLocal(F&& constructor)
       : constructor_(std::forward<F>(constructor)) {}
 
+  explicit ThreadLocal(thread_local_hot_t) noexcept
+      : tlp_(thread_local_hot), constructor_([]() { return T(); }) {}
+
+  template <typename F, std::enable_if_t<is_invocable_r_v<T, F>, int> = 0>
+  ThreadLocal(thread_local_hot_t, F&& constructor)
+      : tlp_(thread_local_hot), constructor_(std::forward<F>(constructor)) {}
+
   ThreadLocal(ThreadLocal&& that) noexcept
       : tlp_{std::move(that.tlp_)},
         constructor_{std::exchange(that.constructor_, {})} {}
@@ -98,6 +118,9 @@ class ThreadLocal {
 
   void reset(T* newPtr = nullptr) { tlp_.reset(newPtr); }
 
+  // Whether it got a static TLS slot: see ThreadLocalPtr.
+  bool hot() const noexcept { return tlp_.hot(); }
+
   typedef typename ThreadLocalPtr<T, Tag, AccessMode>::Accessor Accessor;
   Accessor accessAllThreads() const { return tlp_.accessAllThreads(); }
 
@@ -140,6 +163,15 @@ class ThreadLocal {
  *       pthread_setspecific()/pthread_getspecific() for the per-thread
  *       storage.  Windows (MSVC and GCC) does support the same semantics
  *       with __declspec(thread)
+ *
+ * An instance constructed with thread_local_hot takes one of the
+ * threadlocal_detail::HotSlots::kCount static TLS slots, if any is left, in
+ * which each thread caches its element: then get() is a direct load from a
+ * fixed offset of the thread pointer and a key check, rather than a lookup
+ * through the ElementWrapper array of the thread with a capacity check. When
+ * no slot is left, or on the platforms which don't use __thread, it behaves
+ * as any other instance. Its elements are the same as with any other
+ * instance, so accessAllThreads() and reset() work as usual.
  */
 
 template <class T, class Tag = void, class AccessMode = void>
@@ -152,22 +184,35 @@ class ThreadLocalPtr {
  public:
   constexpr ThreadLocalPtr() noexcept : id_() {}
 
-  ThreadLocalPtr(ThreadLocalPtr&& other) noexcept : id_(std::move(other.id_)) {}
+  explicit ThreadLocalPtr(thread_local_hot_t) noexcept
+      : id_(), hotKey_(threadlocal_detail::HotSlots::acquire()) {}
+
+  ThreadLocalPtr(ThreadLocalPtr&& other) noexcept
+      : id_(std::move(other.id_)), hotKey_(std::exchange(other.hotKey_, 0)) {}
 
   ThreadLocalPtr& operator=(ThreadLocalPtr&& other) noexcept {
     assert(this != &other);
     destroy(); // user-provided dtors invoked within here must not throw
     id_ = std::move(other.id_);
+    hotKey_ = std::exchange(other.hotKey_, 0);
     return *this;
   }
 
   ~ThreadLocalPtr() { destroy(); }
 
   T* get() const {
+    if (hotKey_ != 0) {
+      auto const& slot = threadlocal_detail::HotSlots::slot(hotKey_);
+      return FOLLY_LIKELY(slot.key == hotKey_) ? static_cast<T*>(slot.ptr)
+                                               : getHotSlow();
+    }
     threadlocal_detail::ElementWrapper& w = StaticMeta::get(&id_);
     return static_cast<T*>(w.ptr);
   }
 
+  // Whether it got a static TLS slot: see thread_local_hot.
+  bool hot() const noexcept { return hotKey_ != 0; }
+
   T* operator->() const { return get(); }
 
   T& operator*() const { return *get(); }
@@ -178,7 +223,9 @@ class ThreadLocalPtr {
     auto id = id_.getOrInvalid();
     // Only valid index into the elements array
     DCHECK_NE(id, threadlocal_detail::kEntryIDInvalid);
-    return static_cast<T*>(te->releaseElement(id));
+    auto const ptr = static_cast<T*>(te->releaseElement(id));
+    invalidateHot();
+    return ptr;
   }
 
   void reset(T* newPtr = nullptr) {
@@ -189,6 +236,7 @@ class ThreadLocalPtr {
     // Only valid index into the elements array
     DCHECK_NE(id, threadlocal_detail::kEntryIDInvalid);
     te->resetElement(newPtr, id);
+    invalidateHot();
     guard.dismiss();
   }
 
@@ -244,6 +292,7 @@ class ThreadLocalPtr {
     // Only valid index into the elements array
     DCHECK_NE(id, threadlocal_detail::kEntryIDInvalid);
     te->resetElement(newPtr, deleter, id);
+    invalidateHot();
     guard.dismiss();
   }
 
@@ -251,8 +300,9 @@ class ThreadLocalPtr {
     reset(newPtr.get(), threadlocal_detail::SharedPtrDeleter{newPtr});
   }
 
-  // Holds a global lock for iteration through all thread local child objects.
-  // Can be used as an iterable container.
+  // Holds the lock of the set of threads of the instance, and in strict mode
+  // a per tag global lock, for iteration through all thread local child
+  // objects. Can be used as an iterable container.
   // Use accessAllThreads() to obtain one.
   class Accessor {
     friend class ThreadLocalPtr<T, Tag, AccessMode>;
@@ -261,7 +311,9 @@ class ThreadLocalPtr {
         threadlocal_detail::StaticMeta<Tag, AccessMode>::instance();
     std::unique_lock<SharedMutex> accessAllThreadsLock_;
     std::shared_lock<SharedMutex> forkHandlerLock_;
-    std::unique_lock<std::mutex> lock_;
+    // Whether it reads the elements of the threads, which it does without the
+    // meta lock: see StaticMetaBase::addElementsReader().
+    bool reading_ = false;
     uint32_t id_ = 0;
 
     // Prevent the entry set from changing while we are iterating over it.
@@ -297,13 +349,13 @@ class ThreadLocalPtr {
         }
       }
 
-      const T& dereference() const {
-        return *static_cast<T*>((*iter_)->elements[accessor_->id_].ptr);
+      threadlocal_detail::ElementWrapper& element() const {
+        return (*iter_)->loadElements()[accessor_->id_];
       }
 
-      T& dereference() {
-        return *static_cast<T*>((*iter_)->elements[accessor_->id_].ptr);
-      }
+      const T& dereference() const { return *static_cast<T*>(element().ptr); }
+
+      T& dereference() { return *static_cast<T*>(element().ptr); }
 
       bool equal(const Iterator& other) const {
         return (accessor_->id_ == other.accessor_->id_ && iter_ == other.iter_);
@@ -325,7 +377,7 @@ class ThreadLocalPtr {
       // we just need to check the ptr since it can be set to nullptr
       // even if the entry is part of the list
       bool valid() const {
-        return (iter_ != vec_.end() && (*iter_)->elements[accessor_->id_].ptr);
+        return (iter_ != vec_.end() && element().ptr);
       }
 
       void incrementToValid() {
@@ -399,7 +451,7 @@ class ThreadLocalPtr {
         : meta_(other.meta_),
           accessAllThreadsLock_(std::move(other.accessAllThreadsLock_)),
           forkHandlerLock_(std::move(other.forkHandlerLock_)),
-          lock_(std::move(other.lock_)),
+          reading_(std::exchange(other.reading_, false)),
           id_(std::exchange(other.id_, 0)) {
       wlockedThreadEntrySet_ = std::move(other.wlockedThreadEntrySet_);
     }
@@ -412,11 +464,11 @@ class ThreadLocalPtr {
       // which is impossible, which leaves only one possible scenario --
       // *this is empty.  Assert it.
       assert(&meta_ == &other.meta_);
-      assert(lock_);
+      assert(reading_);
       using std::swap;
       swap(accessAllThreadsLock_, other.accessAllThreadsLock_);
       swap(forkHandlerLock_, other.forkHandlerLock_);
-      swap(lock_, other.lock_);
+      swap(reading_, other.reading_);
       swap(id_, other.id_);
       wlockedThreadEntrySet_.unlock();
       swap(wlockedThreadEntrySet_, other.wlockedThreadEntrySet_);
@@ -428,19 +480,26 @@ class ThreadLocalPtr {
     explicit Accessor(uint32_t id)
         : accessAllThreadsLock_(meta_.accessAllThreadsLock_, std::defer_lock),
           forkHandlerLock_(meta_.forkHandlerLock_, std::defer_lock),
-          lock_(meta_.lock_, std::defer_lock),
           id_(id) {
       forkHandlerLock_.lock();
-      accessAllThreadsLock_.lock();
+      // In strict mode, the accessors don't run between the removal of an
+      // exiting thread from the sets and the disposal of its elements. The
+      // lock of the set of the id is enough otherwise.
+      if (meta_.strict_) {
+        accessAllThreadsLock_.lock();
+      }
       wlockedThreadEntrySet_ = meta_.allId2ThreadEntrySets_[id_].wlock();
-      lock_.lock();
+      meta_.addElementsReader();
+      reading_ = true;
     }
 
     void release() {
-      if (lock_) {
-        lock_.unlock();
-        DCHECK(accessAllThreadsLock_);
-        accessAllThreadsLock_.unlock();
+      if (reading_) {
+        reading_ = false;
+        meta_.removeElementsReader();
+        if (accessAllThreadsLock_) {
+          accessAllThreadsLock_.unlock();
+        }
         DCHECK(forkHandlerLock_);
         forkHandlerLock_.unlock();
         id_ = 0;
@@ -449,7 +508,8 @@ class ThreadLocalPtr {
   };
 
   // accessor allows a client to iterate through all thread local child
-  // elements of this ThreadLocal instance.  Holds a global lock for each <Tag>
+  // elements of this ThreadLocal instance.  In strict mode, holds a global lock
+  // for each <Tag>
   Accessor accessAllThreads() const {
     static_assert(
         AccessAllThreadsEnabled::value,
@@ -458,7 +518,25 @@ class ThreadLocalPtr {
   }
 
  private:
+  FOLLY_NOINLINE T* getHotSlow() const {
+    auto const ptr = static_cast<T*>(StaticMeta::get(&id_).ptr);
+    // The elements of an exiting thread may be disposed of at any time.
+    if (!StaticMeta::dying()) {
+      threadlocal_detail::HotSlots::slot(hotKey_) = {hotKey_, ptr};
+    }
+    return ptr;
+  }
+
+  void invalidateHot() noexcept {
+    if (hotKey_ != 0) {
+      threadlocal_detail::HotSlots::invalidate(hotKey_);
+    }
+  }
+
   void destroy() noexcept {
+    if (hotKey_ != 0) {
+      threadlocal_detail::HotSlots::release(std::exchange(hotKey_, 0));
+    }
     auto const val = id_.value.load(std::memory_order_relaxed);
     if (val == threadlocal_detail::kEntryIDInvalid) {
       return;
@@ -476,6 +554,8 @@ class ThreadLocalPtr {
   }
 
   mutable typename StaticMeta::EntryID id_;
+  // The key of the static TLS slot of a hot instance, or 0.
+  uint64_t hotKey_ = 0;
 };
 
 } // namespace folly
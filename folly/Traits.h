@@ -1016,6 +1016,7 @@ bool greater_than(LHS const lhs) {
 #ifndef _MSC_VER
 FOLLY_ASSUME_FBVECTOR_COMPATIBLE_2(std::unique_ptr)
 FOLLY_ASSUME_FBVECTOR_COMPATIBLE_1(std::shared_ptr)
+FOLLY_ASSUME_FBVECTOR_COMPATIBLE_1(std::allocator)
 #endif
 
 namespace folly {
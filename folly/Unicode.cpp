@@ -16,9 +16,22 @@
 
 #include <folly/Unicode.h>
 
+#include <algorithm>
+#include <cstring>
 #include <initializer_list>
 
 #include <folly/Conv.h>
+#include <folly/Portability.h>
+#include <folly/lang/Bits.h>
+#include <folly/memory/UninitializedMemoryHacks.h>
+
+#if FOLLY_X64 && FOLLY_SSE_PREREQ(2, 0)
+#include <immintrin.h>
+#endif
+
+#if FOLLY_AARCH64
+#include <arm_neon.h>
+#endif
 
 namespace folly {
 
@@ -198,4 +211,681 @@ char32_t utf8ToCodePoint(
   throw std::runtime_error("folly::utf8ToCodePoint encoding length maxed out");
 }
 
+namespace {
+
+// The length of the well-formed sequence at p, which must be before e,
+// following the table of well-formed byte sequences in section 3.9 of the
+// Unicode Standard, or 0 if it is ill-formed.
+std::size_t utf8SequenceLength(const unsigned char* p, const unsigned char* e) {
+  unsigned char c = *p;
+  if (c < 0x80) {
+    return 1;
+  }
+  // Number of continuation bytes, and range of the first one.
+  std::size_t n;
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xbf;
+  if (c >= 0xc2 && c <= 0xdf) {
+    n = 1;
+  } else if (c >= 0xe0 && c <= 0xef) {
+    n = 2;
+    lo = c == 0xe0 ? 0xa0 : lo; // overlong
+    hi = c == 0xed ? 0x9f : hi; // surrogates
+  } else if (c >= 0xf0 && c <= 0xf4) {
+    n = 3;
+    lo = c == 0xf0 ? 0x90 : lo; // overlong
+    hi = c == 0xf4 ? 0x8f : hi; // above U+10FFFF
+  } else {
+    return 0;
+  }
+  if (std::size_t(e - p) <= n || p[1] < lo || p[1] > hi) {
+    return 0;
+  }
+  for (std::size_t i = 2; i <= n; ++i) {
+    if ((p[i] & 0xc0) != 0x80) {
+      return 0;
+    }
+  }
+  return n + 1;
+}
+
+// The code point of a well-formed sequence of n bytes.
+char32_t decodeUtf8Sequence(const unsigned char* p, std::size_t n) {
+  switch (n) {
+    case 1:
+      return p[0];
+    case 2:
+      return (char32_t(p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+    case 3:
+      return (char32_t(p[0] & 0x0f) << 12) | (char32_t(p[1] & 0x3f) << 6) |
+          (p[2] & 0x3f);
+    default:
+      return (char32_t(p[0] & 0x07) << 18) | (char32_t(p[1] & 0x3f) << 12) |
+          (char32_t(p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+  }
+}
+
+bool isValidUtf8Scalar(const unsigned char* p, const unsigned char* e) {
+  while (p < e) {
+    // Skip ASCII a word at a time.
+    while (e - p >= 8 && !(loadUnaligned<uint64_t>(p) & 0x8080808080808080)) {
+      p += 8;
+    }
+    if (p == e) {
+      break;
+    }
+    std::size_t n = utf8SequenceLength(p, e);
+    if (n == 0) {
+      return false;
+    }
+    p += n;
+  }
+  return true;
+}
+
+#if FOLLY_X64 && FOLLY_SSE_PREREQ(4, 2) || FOLLY_AARCH64
+
+#if FOLLY_X64
+
+struct Utf8SimdOps {
+  using reg_t = __m128i;
+
+  static reg_t load(const unsigned char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const reg_t*>(p));
+  }
+  static reg_t broadcast(unsigned char c) { return _mm_set1_epi8(char(c)); }
+  static reg_t lookup(reg_t table, reg_t index) {
+    return _mm_shuffle_epi8(table, index);
+  }
+  static reg_t highNibbles(reg_t x) {
+    return _mm_and_si128(_mm_srli_epi16(x, 4), broadcast(0x0f));
+  }
+  static reg_t lowNibbles(reg_t x) { return _mm_and_si128(x, broadcast(0x0f)); }
+  static reg_t bitAnd(reg_t x, reg_t y) { return _mm_and_si128(x, y); }
+  static reg_t bitOr(reg_t x, reg_t y) { return _mm_or_si128(x, y); }
+  static reg_t bitXor(reg_t x, reg_t y) { return _mm_xor_si128(x, y); }
+  static reg_t subSaturate(reg_t x, reg_t y) { return _mm_subs_epu8(x, y); }
+  // The bytes of cur shifted by N, with the last N bytes of prev in front.
+  template <int N>
+  static reg_t prev(reg_t cur, reg_t prev) {
+    return _mm_alignr_epi8(cur, prev, 16 - N);
+  }
+  static bool isAscii(reg_t x) { return _mm_movemask_epi8(x) == 0; }
+  static bool any(reg_t x) { return !_mm_testz_si128(x, x); }
+};
+
+#else
+
+struct Utf8SimdOps {
+  using reg_t = uint8x16_t;
+
+  static reg_t load(const unsigned char* p) { return vld1q_u8(p); }
+  static reg_t broadcast(unsigned char c) { return vdupq_n_u8(c); }
+  static reg_t lookup(reg_t table, reg_t index) {
+    return vqtbl1q_u8(table, index);
+  }
+  static reg_t highNibbles(reg_t x) { return vshrq_n_u8(x, 4); }
+  static reg_t lowNibbles(reg_t x) { return vandq_u8(x, broadcast(0x0f)); }
+  static reg_t bitAnd(reg_t x, reg_t y) { return vandq_u8(x, y); }
+  static reg_t bitOr(reg_t x, reg_t y) { return vorrq_u8(x, y); }
+  static reg_t bitXor(reg_t x, reg_t y) { return veorq_u8(x, y); }
+  static reg_t subSaturate(reg_t x, reg_t y) { return vqsubq_u8(x, y); }
+  template <int N>
+  static reg_t prev(reg_t cur, reg_t prev) {
+    return vextq_u8(prev, cur, 16 - N);
+  }
+  static bool isAscii(reg_t x) { return vmaxvq_u8(x) < 0x80; }
+  static bool any(reg_t x) { return vmaxvq_u8(x) != 0; }
+};
+
+#endif
+
+// Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per
+// Byte" (2021). Every error is detected by looking at pairs of consecutive
+// bytes: three table lookups, indexed by the high and the low nibble of the
+// first byte and by the high nibble of the second, each give the set of
+// errors that the pair may be part of, and the pair is invalid if all three
+// agree on one. Only the requirement for the third and fourth bytes of a
+// sequence to be continuations is checked separately.
+class Utf8SimdValidator {
+ public:
+  using Ops = Utf8SimdOps;
+  using reg_t = Ops::reg_t;
+
+  Utf8SimdValidator()
+      : prev_(Ops::broadcast(0)),
+        error_(Ops::broadcast(0)),
+        prevIncomplete_(Ops::broadcast(0)) {}
+
+  void check(reg_t input) {
+    if (Ops::isAscii(input)) {
+      // A sequence can't end with an ASCII byte.
+      error_ = Ops::bitOr(error_, prevIncomplete_);
+    } else {
+      auto prev1 = Ops::prev<1>(input, prev_);
+      auto special = Ops::bitAnd(
+          Ops::bitAnd(
+              Ops::lookup(table(kByte1High), Ops::highNibbles(prev1)),
+              Ops::lookup(table(kByte1Low), Ops::lowNibbles(prev1))),
+          Ops::lookup(table(kByte2High), Ops::highNibbles(input)));
+      // The bytes 2 and 3 positions after a 4 byte lead, and 2 positions
+      // after a 3 byte lead, must be continuations, in which case the lookups
+      // above flagged them with kTwoConts. This is the only error that
+      // doesn't show in a pair of bytes, and the only valid case of that
+      // flag, so flip it there.
+      auto must23 = Ops::bitAnd(
+          Ops::bitOr(
+              Ops::subSaturate(
+                  Ops::prev<2>(input, prev_), Ops::broadcast(0xe0 - 0x80)),
+              Ops::subSaturate(
+                  Ops::prev<3>(input, prev_), Ops::broadcast(0xf0 - 0x80))),
+          Ops::broadcast(0x80));
+      error_ = Ops::bitOr(error_, Ops::bitXor(must23, special));
+      // Nonzero where a lead byte is too close to the end of the block for
+      // its sequence to be complete.
+      prevIncomplete_ = Ops::subSaturate(input, table(kIncomplete));
+    }
+    prev_ = input;
+  }
+
+  bool finish() {
+    // Flushes an incomplete sequence at the end of the input.
+    check(Ops::broadcast(0));
+    return !Ops::any(error_);
+  }
+
+ private:
+  using table_t = unsigned char[16];
+
+  static reg_t table(const table_t& t) { return Ops::load(t); }
+
+  static constexpr unsigned char kTooShort = 1 << 0; // lead, then no cont.
+  static constexpr unsigned char kTooLong = 1 << 1; // ASCII, then cont.
+  static constexpr unsigned char kOverlong3 = 1 << 2; // e0 80..9f
+  static constexpr unsigned char kTooLarge = 1 << 3; // f4 90..bf, f5..ff
+  static constexpr unsigned char kSurrogate = 1 << 4; // ed a0..bf
+  static constexpr unsigned char kOverlong2 = 1 << 5; // c0..c1
+  static constexpr unsigned char kTooLarge1000 = 1 << 6; // f5..ff 80..8f
+  static constexpr unsigned char kOverlong4 = 1 << 6; // f0 80..8f
+  static constexpr unsigned char kTwoConts = 1 << 7; // cont., then cont.
+  // Errors that only depend on the high nibble of the first byte.
+  static constexpr unsigned char kCarry = kTooShort | kTooLong | kTwoConts;
+
+  static constexpr table_t kByte1High = {
+      // 0xxx: ASCII
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      kTooLong,
+      // 10xx: continuation
+      kTwoConts,
+      kTwoConts,
+      kTwoConts,
+      kTwoConts,
+      // 1100
+      kTooShort | kOverlong2,
+      // 1101
+      kTooShort,
+      // 1110
+      kTooShort | kOverlong3 | kSurrogate,
+      // 1111
+      kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+  };
+  static constexpr table_t kByte1Low = {
+      // xxxx0000
+      kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+      // xxxx0001
+      kCarry | kOverlong2,
+      // xxxx001x
+      kCarry,
+      kCarry,
+      // xxxx0100
+      kCarry | kTooLarge,
+      // xxxx0101, xxxx011x
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // xxxx1xxx
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // xxxx1101
+      kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+  };
+  static constexpr table_t kByte2High = {
+      // 0xxx: ASCII
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      // 1000
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+          kOverlong4,
+      // 1001
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+      // 101x
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      // 11xx: lead
+      kTooShort,
+      kTooShort,
+      kTooShort,
+      kTooShort,
+  };
+  // Largest value of each byte of a block for which the sequence it's part
+  // of can end within the block.
+  static constexpr table_t kIncomplete = {
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xff,
+      0xf0 - 1,
+      0xe0 - 1,
+      0xc0 - 1,
+  };
+
+  reg_t prev_;
+  reg_t error_;
+  reg_t prevIncomplete_;
+};
+
+bool isValidUtf8Simd(const unsigned char* p, const unsigned char* e) {
+  constexpr std::size_t kBlock = sizeof(Utf8SimdValidator::reg_t);
+  Utf8SimdValidator validator;
+  for (; std::size_t(e - p) >= kBlock; p += kBlock) {
+    validator.check(Utf8SimdValidator::Ops::load(p));
+  }
+  if (p != e) {
+    unsigned char buf[kBlock] = {};
+    std::memcpy(buf, p, e - p);
+    validator.check(Utf8SimdValidator::Ops::load(buf));
+  }
+  return validator.finish();
+}
+
+#endif
+
+} // namespace
+
+bool isValidUtf8(std::string_view s) {
+  auto p = reinterpret_cast<const unsigned char*>(s.data());
+  auto e = p + s.size();
+#if FOLLY_X64 && FOLLY_SSE_PREREQ(4, 2) || FOLLY_AARCH64
+  if (s.size() >= sizeof(Utf8SimdValidator::reg_t)) {
+    return isValidUtf8Simd(p, e);
+  }
+#endif
+  return isValidUtf8Scalar(p, e);
+}
+
+namespace {
+
+// Text is mostly ASCII, which is transcoded a block of 16 code units at a
+// time. The functions which transcode a block return the length of its ASCII
+// prefix, which is all that's valid in the output; they may write the whole
+// block, so the output must have room for it.
+constexpr std::size_t kAsciiBlock = 16;
+
+#if FOLLY_X64 && FOLLY_SSE_PREREQ(2, 0)
+
+__m128i loadBlock(const void* p) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+void storeBlock(void* p, __m128i x) {
+  _mm_storeu_si128(static_cast<__m128i*>(p), x);
+}
+
+// The index of the first non-ASCII code unit, given a mask with the bits of
+// the non-ASCII ones set.
+std::size_t asciiPrefix(unsigned mask) {
+  return findFirstSet(mask | (1u << kAsciiBlock)) - 1;
+}
+
+bool isAsciiBlock(const unsigned char* p) {
+  return _mm_movemask_epi8(loadBlock(p)) == 0;
+}
+
+std::size_t countCodePointsBlock(const unsigned char* p) {
+  // The continuation bytes are the ones below -0x40 as signed bytes.
+  auto x = _mm_cmpgt_epi8(loadBlock(p), _mm_set1_epi8(-0x41));
+  return popcount(unsigned(_mm_movemask_epi8(x)));
+}
+
+std::size_t widenAsciiBlock(const unsigned char* p, char16_t* out) {
+  auto x = loadBlock(p);
+  auto zero = _mm_setzero_si128();
+  storeBlock(out, _mm_unpacklo_epi8(x, zero));
+  storeBlock(out + 8, _mm_unpackhi_epi8(x, zero));
+  return asciiPrefix(unsigned(_mm_movemask_epi8(x)));
+}
+
+std::size_t widenAsciiBlock(const unsigned char* p, char32_t* out) {
+  auto x = loadBlock(p);
+  auto zero = _mm_setzero_si128();
+  auto lo = _mm_unpacklo_epi8(x, zero);
+  auto hi = _mm_unpackhi_epi8(x, zero);
+  storeBlock(out, _mm_unpacklo_epi16(lo, zero));
+  storeBlock(out + 4, _mm_unpackhi_epi16(lo, zero));
+  storeBlock(out + 8, _mm_unpacklo_epi16(hi, zero));
+  storeBlock(out + 12, _mm_unpackhi_epi16(hi, zero));
+  return asciiPrefix(unsigned(_mm_movemask_epi8(x)));
+}
+
+std::size_t narrowAsciiBlock(const char16_t* p, char* out) {
+  auto zero = _mm_setzero_si128();
+  auto high = _mm_set1_epi16(-0x80);
+  auto a = loadBlock(p);
+  auto b = loadBlock(p + 8);
+  storeBlock(out, _mm_packus_epi16(a, b));
+  // Packed to one byte per code unit, all ones where it's ASCII.
+  auto ascii = _mm_packs_epi16(
+      _mm_cmpeq_epi16(_mm_and_si128(a, high), zero),
+      _mm_cmpeq_epi16(_mm_and_si128(b, high), zero));
+  return asciiPrefix(~unsigned(_mm_movemask_epi8(ascii)));
+}
+
+std::size_t narrowAsciiBlock(const char32_t* p, char* out) {
+  auto zero = _mm_setzero_si128();
+  auto high = _mm_set1_epi32(-0x80);
+  auto a = loadBlock(p);
+  auto b = loadBlock(p + 4);
+  auto c = loadBlock(p + 8);
+  auto d = loadBlock(p + 12);
+  storeBlock(
+      out, _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  auto isAscii = [&](__m128i x) {
+    return _mm_cmpeq_epi32(_mm_and_si128(x, high), zero);
+  };
+  auto ascii = _mm_packs_epi16(
+      _mm_packs_epi32(isAscii(a), isAscii(b)),
+      _mm_packs_epi32(isAscii(c), isAscii(d)));
+  return asciiPrefix(~unsigned(_mm_movemask_epi8(ascii)));
+}
+
+#elif FOLLY_AARCH64
+
+// The index of the first non-ASCII code unit, given a mask with all ones in
+// the bytes of the non-ASCII ones.
+std::size_t asciiPrefix(uint8x16_t mask) {
+  // Narrowed to 4 bits per byte.
+  uint64_t bits = vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(mask), 4)), 0);
+  return bits ? (findFirstSet(bits) - 1) / 4 : kAsciiBlock;
+}
+
+bool isAsciiBlock(const unsigned char* p) {
+  return vmaxvq_u8(vld1q_u8(p)) < 0x80;
+}
+
+std::size_t countCodePointsBlock(const unsigned char* p) {
+  // The continuation bytes are the ones below -0x40 as signed bytes.
+  auto x = vcgtq_s8(vreinterpretq_s8_u8(vld1q_u8(p)), vdupq_n_s8(-0x41));
+  return vaddvq_u8(vandq_u8(x, vdupq_n_u8(1)));
+}
+
+std::size_t widenAsciiBlock(const unsigned char* p, char16_t* out) {
+  auto x = vld1q_u8(p);
+  auto o = reinterpret_cast<uint16_t*>(out);
+  vst1q_u16(o, vmovl_u8(vget_low_u8(x)));
+  vst1q_u16(o + 8, vmovl_u8(vget_high_u8(x)));
+  return asciiPrefix(vcgeq_u8(x, vdupq_n_u8(0x80)));
+}
+
+std::size_t widenAsciiBlock(const unsigned char* p, char32_t* out) {
+  auto x = vld1q_u8(p);
+  auto lo = vmovl_u8(vget_low_u8(x));
+  auto hi = vmovl_u8(vget_high_u8(x));
+  auto o = reinterpret_cast<uint32_t*>(out);
+  vst1q_u32(o, vmovl_u16(vget_low_u16(lo)));
+  vst1q_u32(o + 4, vmovl_u16(vget_high_u16(lo)));
+  vst1q_u32(o + 8, vmovl_u16(vget_low_u16(hi)));
+  vst1q_u32(o + 12, vmovl_u16(vget_high_u16(hi)));
+  return asciiPrefix(vcgeq_u8(x, vdupq_n_u8(0x80)));
+}
+
+std::size_t narrowAsciiBlock(const char16_t* p, char* out) {
+  auto i = reinterpret_cast<const uint16_t*>(p);
+  auto a = vld1q_u16(i);
+  auto b = vld1q_u16(i + 8);
+  vst1q_u8(
+      reinterpret_cast<uint8_t*>(out),
+      vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+  auto high = vdupq_n_u16(0x80);
+  return asciiPrefix(vcombine_u8(
+      vmovn_u16(vcgeq_u16(a, high)), vmovn_u16(vcgeq_u16(b, high))));
+}
+
+std::size_t narrowAsciiBlock(const char32_t* p, char* out) {
+  auto i = reinterpret_cast<const uint32_t*>(p);
+  auto a = vld1q_u32(i);
+  auto b = vld1q_u32(i + 4);
+  auto c = vld1q_u32(i + 8);
+  auto d = vld1q_u32(i + 12);
+  auto narrow = [](uint32x4_t w, uint32x4_t x, uint32x4_t y, uint32x4_t z) {
+    return vcombine_u8(
+        vmovn_u16(vcombine_u16(vmovn_u32(w), vmovn_u32(x))),
+        vmovn_u16(vcombine_u16(vmovn_u32(y), vmovn_u32(z))));
+  };
+  vst1q_u8(reinterpret_cast<uint8_t*>(out), narrow(a, b, c, d));
+  auto high = vdupq_n_u32(0x80);
+  return asciiPrefix(narrow(
+      vcgeq_u32(a, high),
+      vcgeq_u32(b, high),
+      vcgeq_u32(c, high),
+      vcgeq_u32(d, high)));
+}
+
+#else
+
+bool isAsciiBlock(const unsigned char* p) {
+  return !((loadUnaligned<uint64_t>(p) | loadUnaligned<uint64_t>(p + 8)) &
+           0x8080808080808080);
+}
+
+std::size_t countCodePointsBlock(const unsigned char* p) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < kAsciiBlock; ++i) {
+    count += (p[i] & 0xc0) != 0x80;
+  }
+  return count;
+}
+
+template <typename In, typename Out>
+std::size_t transcodeAsciiBlock(const In* p, Out* out) {
+  std::size_t n = 0;
+  while (n < kAsciiBlock && p[n] < 0x80) {
+    out[n] = Out(p[n]);
+    ++n;
+  }
+  return n;
+}
+
+template <typename Char>
+std::size_t widenAsciiBlock(const unsigned char* p, Char* out) {
+  return transcodeAsciiBlock(p, out);
+}
+
+template <typename Char>
+std::size_t narrowAsciiBlock(const Char* p, char* out) {
+  return transcodeAsciiBlock(p, out);
+}
+
+#endif
+
+[[noreturn]] void throwInvalidInput(
+    const char* function, const char* what, std::size_t offset) {
+  throw_exception<unicode_error>(
+      to<std::string>("folly::", function, ": ", what, " at offset ", offset));
+}
+
+char* writeUtf8(char32_t cp, char* out) {
+  codePointToUtf8Impl(cp, [&](std::initializer_list<char> data) {
+    out = std::copy(data.begin(), data.end(), out);
+  });
+  return out;
+}
+
+template <typename Char>
+std::basic_string<Char> utf8ToUtfN(std::string_view s, const char* function) {
+  auto const b = reinterpret_cast<const unsigned char*>(s.data());
+  auto const e = b + s.size();
+  // Every code unit of the output takes at least one byte of the input.
+  std::basic_string<Char> result(s.size(), Char(0));
+  Char* out = result.data();
+  auto p = b;
+  while (p != e) {
+    if (std::size_t(e - p) >= kAsciiBlock) {
+      // Advancing by a constant when the whole block is ASCII keeps the
+      // loads of the next blocks independent of this one.
+      std::size_t n = widenAsciiBlock(p, out);
+      if (n == kAsciiBlock) {
+        p += kAsciiBlock;
+        out += kAsciiBlock;
+        continue;
+      }
+      p += n;
+      out += n;
+    }
+    std::size_t n = utf8SequenceLength(p, e);
+    if (n == 0) {
+      throwInvalidInput(function, "invalid UTF-8", std::size_t(p - b));
+    }
+    char32_t cp = decodeUtf8Sequence(p, n);
+    p += n;
+    if constexpr (sizeof(Char) == 2) {
+      if (cp > 0xffff) {
+        cp -= 0x10000;
+        *out++ = Char(0xd800 + (cp >> 10));
+        *out++ = Char(0xdc00 + (cp & 0x3ff));
+        continue;
+      }
+    }
+    *out++ = Char(cp);
+  }
+  result.resize(std::size_t(out - result.data()));
+  return result;
+}
+
+} // namespace
+
+bool isAscii(std::string_view s) {
+  auto p = reinterpret_cast<const unsigned char*>(s.data());
+  auto e = p + s.size();
+  for (; std::size_t(e - p) >= kAsciiBlock; p += kAsciiBlock) {
+    if (!isAsciiBlock(p)) {
+      return false;
+    }
+  }
+  return std::all_of(p, e, [](unsigned char c) { return c < 0x80; });
+}
+
+std::size_t countUtf8CodePoints(std::string_view s) {
+  auto p = reinterpret_cast<const unsigned char*>(s.data());
+  auto e = p + s.size();
+  std::size_t count = 0;
+  for (; std::size_t(e - p) >= kAsciiBlock; p += kAsciiBlock) {
+    count += countCodePointsBlock(p);
+  }
+  return count + std::size_t(std::count_if(p, e, [](unsigned char c) {
+           return (c & 0xc0) != 0x80;
+         }));
+}
+
+std::u16string utf8ToUtf16(std::string_view s) {
+  return utf8ToUtfN<char16_t>(s, "utf8ToUtf16");
+}
+
+std::u32string utf8ToUtf32(std::string_view s) {
+  return utf8ToUtfN<char32_t>(s, "utf8ToUtf32");
+}
+
+std::string utf16ToUtf8(std::u16string_view s) {
+  auto const b = s.data();
+  auto const e = b + s.size();
+  // A code unit takes at most 3 bytes, and a surrogate pair 4.
+  std::string result;
+  resizeWithoutInitialization(result, s.size() * 3);
+  char* out = result.data();
+  auto p = b;
+  while (p != e) {
+    if (std::size_t(e - p) >= kAsciiBlock) {
+      // Advancing by a constant when the whole block is ASCII keeps the
+      // loads of the next blocks independent of this one.
+      std::size_t n = narrowAsciiBlock(p, out);
+      if (n == kAsciiBlock) {
+        p += kAsciiBlock;
+        out += kAsciiBlock;
+        continue;
+      }
+      p += n;
+      out += n;
+    }
+    char32_t cp = *p++;
+    if (!utf16_code_unit_is_bmp(char16_t(cp))) {
+      if (!utf16_code_unit_is_high_surrogate(char16_t(cp)) || p == e ||
+          !utf16_code_unit_is_low_surrogate(*p)) {
+        throwInvalidInput(
+            "utf16ToUtf8", "unpaired surrogate", std::size_t(p - 1 - b));
+      }
+      cp = 0x10000 + ((cp & 0x3ff) << 10) + (*p++ & 0x3ff);
+    }
+    out = writeUtf8(cp, out);
+  }
+  result.resize(std::size_t(out - result.data()));
+  return result;
+}
+
+std::string utf32ToUtf8(std::u32string_view s) {
+  auto const b = s.data();
+  auto const e = b + s.size();
+  std::string result;
+  resizeWithoutInitialization(result, s.size() * 4);
+  char* out = result.data();
+  auto p = b;
+  while (p != e) {
+    if (std::size_t(e - p) >= kAsciiBlock) {
+      // Advancing by a constant when the whole block is ASCII keeps the
+      // loads of the next blocks independent of this one.
+      std::size_t n = narrowAsciiBlock(p, out);
+      if (n == kAsciiBlock) {
+        p += kAsciiBlock;
+        out += kAsciiBlock;
+        continue;
+      }
+      p += n;
+      out += n;
+    }
+    char32_t cp = *p;
+    if (cp > 0x10ffff || (cp >= 0xd800 && cp < 0xe000)) {
+      throwInvalidInput(
+          "utf32ToUtf8", "invalid code point", std::size_t(p - b));
+    }
+    out = writeUtf8(cp, out);
+    ++p;
+  }
+  result.resize(std::size_t(out - result.data()));
+  return result;
+}
+
 } // namespace folly
@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <folly/lang/Exception.h>
 
@@ -89,6 +91,45 @@ void appendCodePointToUtf8(char32_t cp, std::string& out);
 char32_t utf8ToCodePoint(
     const unsigned char*& p, const unsigned char* const e, bool skipOnError);
 
+/*
+ * Check that a byte sequence is valid UTF-8, i.e. that utf8ToCodePoint()
+ * would decode all of it without error: no truncated, overlong or 5-6 byte
+ * sequences, no surrogates and no code points above U+10FFFF.
+ *
+ * With SSE4.2 or on aarch64, this checks 16 bytes at a time without
+ * branching on the contents, using the lookup algorithm of Keiser and Lemire,
+ * "Validating UTF-8 In Less Than One Instruction Per Byte" (2021).
+ */
+bool isValidUtf8(std::string_view s);
+
+/*
+ * Check that a byte sequence is ASCII, i.e. that no byte has the high bit
+ * set.
+ */
+bool isAscii(std::string_view s);
+
+/*
+ * Count the code points of a UTF-8 string, i.e. the bytes which aren't
+ * continuation bytes (10xxxxxx). The input isn't validated: the count of an
+ * invalid string is that of its non-continuation bytes.
+ */
+std::size_t countUtf8CodePoints(std::string_view s);
+
+/*
+ * Transcode a whole string between UTF-8 and UTF-16 or UTF-32.
+ *
+ * The input is validated, and unicode_error is thrown, with the offset of the
+ * offending code unit, for ill-formed UTF-8 (see isValidUtf8()), unpaired
+ * surrogates in UTF-16, and surrogates or values above U+10FFFF in UTF-32.
+ *
+ * Runs of ASCII are transcoded 16 code units at a time with SSE2 or NEON,
+ * the other code points one at a time.
+ */
+std::u16string utf8ToUtf16(std::string_view s);
+std::u32string utf8ToUtf32(std::string_view s);
+std::string utf16ToUtf8(std::u16string_view s);
+std::string utf32ToUtf8(std::u32string_view s);
+
 //////////////////////////////////////////////////////////////////////
 
 } // namespace folly
@@ -52,6 +52,35 @@ inline UriTuple as_tuple(const folly::Uri& k) {
 
 } // namespace uri_detail
 
+inline UriView::QueryParams UriView::queryParams() const {
+  return QueryParams(query_);
+}
+
+inline void UriView::QueryParamIterator::next() {
+  // Parameters are separated by '&'; those with an empty name or more than
+  // one '=' are skipped.
+  while (!rest_.empty()) {
+    auto amp = rest_.find('&');
+    auto param = rest_.subpiece(0, amp);
+    rest_.advance(amp == StringPiece::npos ? rest_.size() : amp + 1);
+    auto eq = param.find('=');
+    if (eq == 0 || param.empty()) {
+      continue;
+    }
+    if (eq == StringPiece::npos) {
+      param_ = {param, StringPiece(param.end(), param.end())};
+      return;
+    }
+    auto value = param.subpiece(eq + 1);
+    if (value.find('=') != StringPiece::npos) {
+      continue;
+    }
+    param_ = {param.subpiece(0, eq), value};
+    return;
+  }
+  param_ = {};
+}
+
 template <class String>
 String Uri::toString() const {
   String str;
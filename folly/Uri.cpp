@@ -17,112 +17,179 @@
 #include <folly/Uri.h>
 
 #include <algorithm>
-#include <cctype>
-
-#include <boost/regex.hpp>
 
 namespace folly {
 
 namespace {
 
-std::string submatch(const boost::cmatch& m, int idx) {
-  const auto& sub = m[idx];
-  return std::string(sub.first, sub.second);
+[[noreturn]] void throwUriFormatError(UriFormatError error, StringPiece str) {
+  switch (error) {
+    case UriFormatError::INVALID_URI_AUTHORITY:
+      throw std::invalid_argument(
+          to<std::string>("invalid URI authority: ", str));
+    case UriFormatError::INVALID_URI_PORT:
+      throw std::invalid_argument(to<std::string>("invalid URI port: ", str));
+    case UriFormatError::INVALID_URI:
+    default:
+      throw std::invalid_argument(to<std::string>("invalid URI: ", str));
+  }
 }
 
-} // namespace
+bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
 
-// private default contructor
-Uri::Uri() : hasAuthority_(false), port_(0) {}
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
 
-// public string constructor
-Uri::Uri(StringPiece str) : hasAuthority_(false), port_(0) {
+bool isSchemeChar(char c) {
+  return isAlpha(c) || isDigit(c) || c == '+' || c == '.' || c == '-';
+}
+
+// Split "host[:port]", where host is an IP-literal in square brackets (e.g.
+// "[::1]") or a run of characters other than '[' and ':', and port is a run
+// of digits, possibly empty.
+bool splitHostAndPort(StringPiece str, StringPiece& host, StringPiece& port) {
+  size_t hostSize;
+  if (!str.empty() && str.front() == '[') {
+    hostSize = str.find(']');
+    if (hostSize == StringPiece::npos) {
+      return false;
+    }
+    ++hostSize;
+  } else {
+    hostSize = std::min(str.find_first_of("[:"), str.size());
+  }
+  host = str.subpiece(0, hostSize);
+  str.advance(hostSize);
+  if (str.empty()) {
+    port = str;
+    return true;
+  }
+  if (str.front() != ':' ||
+      !std::all_of(str.begin() + 1, str.end(), isDigit)) {
+    return false;
+  }
+  port = str.subpiece(1);
+  return true;
+}
+
+} // namespace
+
+UriView::UriView(StringPiece str) {
   auto maybeUri = tryFromString(str);
   if (maybeUri.hasError()) {
-    switch (maybeUri.error()) {
-      case UriFormatError::INVALID_URI_AUTHORITY:
-        throw std::invalid_argument(
-            to<std::string>("invalid URI authority: ", str));
-      case UriFormatError::INVALID_URI_PORT:
-        throw std::invalid_argument(to<std::string>("invalid URI port: ", str));
-      case UriFormatError::INVALID_URI:
-      default:
-        throw std::invalid_argument(to<std::string>("invalid URI: ", str));
-    }
+    throwUriFormatError(maybeUri.error(), str);
   }
   *this = maybeUri.value();
 }
 
-Expected<Uri, UriFormatError> Uri::tryFromString(StringPiece str) noexcept {
-  Uri result;
-
-  static const boost::regex uriRegex(
-      "([a-zA-Z][a-zA-Z0-9+.-]*):" // scheme:
-      "([^?#]*)" // authority and path
-      "(?:\\?([^#]*))?" // ?query
-      "(?:#(.*))?"); // #fragment
-  static const boost::regex authorityAndPathRegex("//([^/]*)(/.*)?");
-
-  boost::cmatch match;
-  if (FOLLY_UNLIKELY(
-          !boost::regex_match(str.begin(), str.end(), match, uriRegex))) {
+Expected<UriView, UriFormatError> UriView::tryFromString(
+    StringPiece str) noexcept {
+  UriView result;
+
+  // scheme:
+  if (str.empty() || !isAlpha(str.front())) {
+    return makeUnexpected(UriFormatError::INVALID_URI);
+  }
+  size_t schemeSize = 1;
+  while (schemeSize < str.size() && isSchemeChar(str[schemeSize])) {
+    ++schemeSize;
+  }
+  if (schemeSize == str.size() || str[schemeSize] != ':') {
     return makeUnexpected(UriFormatError::INVALID_URI);
   }
+  result.scheme_ = str.subpiece(0, schemeSize);
+  str.advance(schemeSize + 1);
+
+  // authority and path, then ?query and #fragment
+  auto authorityAndPath = str.subpiece(0, str.find_first_of("?#"));
+  str.advance(authorityAndPath.size());
+  if (str.removePrefix('?')) {
+    result.query_ = str.subpiece(0, str.find('#'));
+    str.advance(result.query_.size());
+  }
+  if (str.startsWith('#')) {
+    result.fragment_ = str.subpiece(1);
+  }
 
-  result.scheme_ = submatch(match, 1);
-  std::transform(
-      result.scheme_.begin(),
-      result.scheme_.end(),
-      result.scheme_.begin(),
-      ::tolower);
-
-  StringPiece authorityAndPath(match[2].first, match[2].second);
-  boost::cmatch authorityAndPathMatch;
-  if (!boost::regex_match(
-          authorityAndPath.begin(),
-          authorityAndPath.end(),
-          authorityAndPathMatch,
-          authorityAndPathRegex)) {
+  if (!authorityAndPath.removePrefix("//")) {
     // Does not start with //, doesn't have authority
-    result.hasAuthority_ = false;
-    result.path_ = authorityAndPath.str();
-  } else {
-    static const boost::regex authorityRegex(
-        "(?:([^@:]*)(?::([^@]*))?@)?" // username, password
-        "(\\[[^\\]]*\\]|[^\\[:]*)" // host (IP-literal (e.g. '['+IPv6+']',
-                                   // dotted-IPv4, or named host)
-        "(?::(\\d*))?"); // port
-
-    const auto authority = authorityAndPathMatch[1];
-    boost::cmatch authorityMatch;
-    if (!boost::regex_match(
-            authority.first,
-            authority.second,
-            authorityMatch,
-            authorityRegex)) {
-      return makeUnexpected(UriFormatError::INVALID_URI_AUTHORITY);
+    result.path_ = authorityAndPath;
+    return result;
+  }
+  auto authority = authorityAndPath.subpiece(0, authorityAndPath.find('/'));
+  result.path_ = authorityAndPath.subpiece(authority.size());
+  result.hasAuthority_ = true;
+
+  // [username[:password]@]host[:port], where the user information ends at
+  // the first '@', unless the rest isn't a host and port: then there is no
+  // user information, and the host may contain '@'.
+  StringPiece port;
+  auto at = authority.find('@');
+  if (at != StringPiece::npos &&
+      splitHostAndPort(authority.subpiece(at + 1), result.host_, port)) {
+    auto userInfo = authority.subpiece(0, at);
+    auto colon = userInfo.find(':');
+    result.username_ = userInfo.subpiece(0, colon);
+    if (colon != StringPiece::npos) {
+      result.password_ = userInfo.subpiece(colon + 1);
     }
-
-    StringPiece port(authorityMatch[4].first, authorityMatch[4].second);
-    if (!port.empty()) {
-      try {
-        result.port_ = to<uint16_t>(port);
-      } catch (ConversionError const&) {
-        return makeUnexpected(UriFormatError::INVALID_URI_PORT);
-      }
+  } else if (!splitHostAndPort(authority, result.host_, port)) {
+    return makeUnexpected(UriFormatError::INVALID_URI_AUTHORITY);
+  }
+  if (!port.empty()) {
+    auto maybePort = tryTo<uint16_t>(port);
+    if (maybePort.hasError()) {
+      return makeUnexpected(UriFormatError::INVALID_URI_PORT);
     }
+    result.port_ = maybePort.value();
+  }
+
+  return result;
+}
 
-    result.hasAuthority_ = true;
-    result.username_ = submatch(authorityMatch, 1);
-    result.password_ = submatch(authorityMatch, 2);
-    result.host_ = submatch(authorityMatch, 3);
-    result.path_ = submatch(authorityAndPathMatch, 2);
+StringPiece UriView::hostname() const {
+  if (!host_.empty() && host_[0] == '[') {
+    // If it starts with '[', then it ends with ']', this is ensured by the
+    // parser
+    return host_.subpiece(1, host_.size() - 2);
   }
+  return host_;
+}
 
-  result.query_ = submatch(match, 3);
-  result.fragment_ = submatch(match, 4);
+// private default contructor
+Uri::Uri() : hasAuthority_(false), port_(0) {}
 
-  return result;
+// public string constructor
+Uri::Uri(StringPiece str) : hasAuthority_(false), port_(0) {
+  auto maybeUri = tryFromString(str);
+  if (maybeUri.hasError()) {
+    throwUriFormatError(maybeUri.error(), str);
+  }
+  *this = maybeUri.value();
+}
+
+Uri::Uri(const UriView& view)
+    : scheme_(view.scheme().str()),
+      username_(view.username().str()),
+      password_(view.password().str()),
+      host_(view.host().str()),
+      hasAuthority_(view.hasAuthority()),
+      port_(view.port()),
+      path_(view.path().str()),
+      query_(view.query().str()),
+      fragment_(view.fragment().str()) {
+  toLowerAscii(scheme_.data(), scheme_.size());
+}
+
+Expected<Uri, UriFormatError> Uri::tryFromString(StringPiece str) noexcept {
+  auto maybeView = UriView::tryFromString(str);
+  if (FOLLY_UNLIKELY(maybeView.hasError())) {
+    return makeUnexpected(maybeView.error());
+  }
+  return Uri(maybeView.value());
 }
 
 std::string Uri::authority() const {
@@ -163,25 +230,8 @@ std::string Uri::hostname() const {
 
 const std::vector<std::pair<std::string, std::string>>& Uri::getQueryParams() {
   if (!query_.empty() && queryParams_.empty()) {
-    // Parse query string
-    static const boost::regex queryParamRegex(
-        "(^|&)" /*start of query or start of parameter "&"*/
-        "([^=&]*)=?" /*parameter name and "=" if value is expected*/
-        "([^=&]*)" /*parameter value*/
-        "(?=(&|$))" /*forward reference, next should be end of query or
-                      start of next parameter*/);
-    const boost::cregex_iterator paramBeginItr(
-        query_.data(), query_.data() + query_.size(), queryParamRegex);
-    boost::cregex_iterator paramEndItr;
-    for (auto itr = paramBeginItr; itr != paramEndItr; ++itr) {
-      if (itr->length(2) == 0) {
-        // key is empty, ignore it
-        continue;
-      }
-      queryParams_.emplace_back(
-          std::string((*itr)[2].first, (*itr)[2].second), // parameter name
-          std::string((*itr)[3].first, (*itr)[3].second) // parameter value
-      );
+    for (const auto& [name, value] : UriView::QueryParams(query_)) {
+      queryParams_.emplace_back(name.str(), value.str());
     }
   }
   return queryParams_;
@@ -17,7 +17,10 @@
 #pragma once
 #define FOLLY_URI_H_
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <folly/Expected.h>
@@ -33,6 +36,144 @@ enum class UriFormatError {
   INVALID_URI_PORT,
 };
 
+/**
+ * Non-owning view of a URI.
+ *
+ * UriView breaks a URI down into the same parts as Uri, but they are
+ * StringPieces into the parsed string, which must outlive the view. Parsing
+ * doesn't allocate: the string is scanned once, without backtracking, so
+ * prefer UriView over Uri when the parts are only inspected.
+ *
+ * Unlike Uri, the scheme is returned as written, not lower-cased. As with
+ * Uri, the parts are NOT percent-decoded.
+ */
+class UriView {
+ public:
+  class QueryParamIterator;
+  class QueryParams;
+
+  /**
+   * Parse a UriView from a string.  Same as tryFromString except it throws
+   * a std::invalid_argument if there's an error.
+   */
+  explicit UriView(StringPiece str);
+
+  /**
+   * Parse a UriView from a string.
+   *
+   * On failure, returns UriFormatError.
+   */
+  static Expected<UriView, UriFormatError> tryFromString(
+      StringPiece str) noexcept;
+
+  StringPiece scheme() const { return scheme_; }
+  StringPiece username() const { return username_; }
+  StringPiece password() const { return password_; }
+  /**
+   * Get host part of URI. If host is an IPv6 address, square brackets will be
+   * returned, for example: "[::1]".
+   */
+  StringPiece host() const { return host_; }
+  /**
+   * Same as host(), without the square brackets around an IPv6 address.
+   */
+  StringPiece hostname() const;
+  uint16_t port() const { return port_; }
+  StringPiece path() const { return path_; }
+  StringPiece query() const { return query_; }
+  StringPiece fragment() const { return fragment_; }
+
+  /**
+   * Whether the URI has an authority, i.e. the scheme is followed by "//".
+   */
+  bool hasAuthority() const { return hasAuthority_; }
+
+  /**
+   * Get query parameters as key-value pairs, parsed lazily as the returned
+   * range is iterated. The parameters are the same as
+   * Uri::getQueryParams() returns.
+   */
+  QueryParams queryParams() const;
+
+ private:
+  UriView() = default;
+
+  StringPiece scheme_;
+  StringPiece username_;
+  StringPiece password_;
+  StringPiece host_;
+  bool hasAuthority_{false};
+  uint16_t port_{0};
+  StringPiece path_;
+  StringPiece query_;
+  StringPiece fragment_;
+};
+
+/**
+ * Forward iterator over the parameters of a query string, see
+ * Uri::getQueryParams() for which ones are valid. Each parameter is a pair of
+ * StringPieces into the query string: its name and its value.
+ */
+class UriView::QueryParamIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<StringPiece, StringPiece>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+
+  /**
+   * The end iterator.
+   */
+  QueryParamIterator() = default;
+
+  explicit QueryParamIterator(StringPiece query) : rest_(query) { next(); }
+
+  reference operator*() const { return param_; }
+  pointer operator->() const { return &param_; }
+
+  QueryParamIterator& operator++() {
+    next();
+    return *this;
+  }
+  QueryParamIterator operator++(int) {
+    auto it = *this;
+    next();
+    return it;
+  }
+
+  // Each parameter starts at a different offset of the query string, and the
+  // end iterator has no parameter.
+  friend bool operator==(
+      const QueryParamIterator& a, const QueryParamIterator& b) {
+    return a.param_.first.data() == b.param_.first.data();
+  }
+  friend bool operator!=(
+      const QueryParamIterator& a, const QueryParamIterator& b) {
+    return !(a == b);
+  }
+
+ private:
+  void next();
+
+  StringPiece rest_;
+  value_type param_;
+};
+
+/**
+ * Range of the parameters of a query string.
+ */
+class UriView::QueryParams {
+ public:
+  explicit QueryParams(StringPiece query) : query_(query) {}
+
+  QueryParamIterator begin() const { return QueryParamIterator(query_); }
+  QueryParamIterator end() const { return QueryParamIterator(); }
+
+ private:
+  StringPiece query_;
+};
+
 /**
  * Class representing a URI.
  *
@@ -57,6 +198,11 @@ class Uri {
    */
   explicit Uri(StringPiece str);
 
+  /**
+   * Copy the parts of a UriView, lower-casing the scheme.
+   */
+  explicit Uri(const UriView& view);
+
   /**
    * Parse a Uri from a string.
    *
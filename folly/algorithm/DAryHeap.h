@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/Likely.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Builtin.h>
+
+namespace folly {
+
+namespace detail {
+
+// 1 if comp is < on integers, -1 if it is >, and 0 otherwise.
+template <typename T, typename Compare>
+constexpr int dAryHeapIntegerOrder() {
+  if constexpr (!std::is_integral_v<T> || std::is_same_v<T, bool>) {
+    return 0;
+  } else if constexpr (
+      std::is_same_v<Compare, std::less<T>> ||
+      std::is_same_v<Compare, std::less<>>) {
+    return 1;
+  } else if constexpr (
+      std::is_same_v<Compare, std::greater<T>> ||
+      std::is_same_v<Compare, std::greater<>>) {
+    return -1;
+  } else {
+    return 0;
+  }
+}
+
+// The index of the first of the N values at c that no other one precedes,
+// by a tournament without branches to mispredict.
+template <std::size_t N, typename T, typename Compare>
+std::size_t dAryHeapBestOf(const T* c, Compare& comp) {
+  if constexpr (N == 1) {
+    return 0;
+  } else {
+    constexpr std::size_t kHalf = N / 2;
+    auto const a = dAryHeapBestOf<kHalf>(c, comp);
+    auto const b = kHalf + dAryHeapBestOf<N - kHalf>(c + kHalf, comp);
+    return FOLLY_BUILTIN_UNPREDICTABLE(comp(c[a], c[b])) ? b : a;
+  }
+}
+
+// Same, for integers: the extremum is a vectorizable reduction, and its
+// index the first bit of a vectorizable comparison mask.
+template <std::size_t N, typename T, int Order>
+std::size_t dAryHeapBestOfIntegers(const T* c) {
+  T best = c[0];
+  for (std::size_t i = 1; i < N; ++i) {
+    best = Order > 0 ? (c[i] > best ? c[i] : best)
+                     : (c[i] < best ? c[i] : best);
+  }
+  uint64_t mask = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    mask |= uint64_t(c[i] == best) << i;
+  }
+  return findFirstSet(mask) - 1;
+}
+
+} // namespace detail
+
+/**
+ * A priority queue like std::priority_queue, stored as a d-ary heap: each
+ * node has D children, which are contiguous. So the heap is log2(D) times
+ * shallower than a binary heap, and the children of a node usually share a
+ * cache line, which makes pop() faster for D = 4 or 8, at the cost of more
+ * comparisons per level. For integers ordered by std::less or
+ * std::greater, the best of the children is found by loops which the
+ * compiler vectorizes.
+ *
+ * Like std::priority_queue, top() is the largest element for Compare =
+ * std::less. replace_top() and the bulk push_range() and pop_n() suit
+ * k-way merges and timer queues.
+ */
+template <
+    typename T,
+    std::size_t D = 4,
+    typename Compare = std::less<T>,
+    typename Container = std::vector<T>>
+class DAryHeap {
+  static_assert(D >= 2 && D <= 64, "DAryHeap supports 2 to 64 children");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using container_type = Container;
+  using value_compare = Compare;
+  using const_reference = const T&;
+
+  static constexpr std::size_t kArity = D;
+
+  DAryHeap() = default;
+  explicit DAryHeap(const Compare& comp) : comp_(comp) {}
+
+  template <typename InputIt>
+  DAryHeap(InputIt first, InputIt last, const Compare& comp = Compare())
+      : c_(first, last), comp_(comp) {
+    heapify();
+  }
+
+  bool empty() const noexcept { return c_.empty(); }
+  size_type size() const noexcept { return c_.size(); }
+  void reserve(size_type n) { c_.reserve(n); }
+  void clear() noexcept { c_.clear(); }
+
+  /// The elements, in heap order.
+  const Container& container() const noexcept { return c_; }
+
+  const_reference top() const {
+    assert(!empty());
+    return c_.front();
+  }
+
+  void push(const T& value) {
+    c_.push_back(value);
+    siftUp(c_.size() - 1);
+  }
+  void push(T&& value) {
+    c_.push_back(std::move(value));
+    siftUp(c_.size() - 1);
+  }
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    c_.emplace_back(std::forward<Args>(args)...);
+    siftUp(c_.size() - 1);
+  }
+
+  /// Pushes the elements of [first, last), rebuilding the heap in linear
+  /// time when they outnumber the elements already in it.
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last) {
+    auto const before = c_.size();
+    c_.insert(c_.end(), first, last);
+    if (c_.size() - before > before) {
+      heapify();
+    } else {
+      for (auto i = before; i < c_.size(); ++i) {
+        siftUp(i);
+      }
+    }
+  }
+
+  void pop() {
+    assert(!empty());
+    if (c_.size() > 1) {
+      c_.front() = std::move(c_.back());
+      c_.pop_back();
+      siftDown(0);
+    } else {
+      c_.pop_back();
+    }
+  }
+
+  /// Removes the top and returns it.
+  T pop_top() {
+    assert(!empty());
+    T value = std::move(c_.front());
+    pop();
+    return value;
+  }
+
+  /// Moves the top n elements to out, in order, and returns the end of the
+  /// output.
+  template <typename OutputIt>
+  OutputIt pop_n(size_type n, OutputIt out) {
+    assert(n <= size());
+    for (; n > 0; --n) {
+      *out++ = std::move(c_.front());
+      pop();
+    }
+    return out;
+  }
+
+  /// Same as pop() then push(value), in a single pass down the heap. A
+  /// k-way merge replaces the top with the next element of its input.
+  void replace_top(T value) {
+    assert(!empty());
+    c_.front() = std::move(value);
+    siftDown(0);
+  }
+
+  void swap(DAryHeap& other) noexcept(
+      std::is_nothrow_swappable_v<Container> &&
+      std::is_nothrow_swappable_v<Compare>) {
+    using std::swap;
+    swap(c_, other.c_);
+    swap(comp_, other.comp_);
+  }
+  friend void swap(DAryHeap& a, DAryHeap& b) noexcept(noexcept(a.swap(b))) {
+    a.swap(b);
+  }
+
+ private:
+  static constexpr int kIntegerOrder =
+      detail::dAryHeapIntegerOrder<T, Compare>();
+
+  // The child in [first, min(first + D, size)) that goes up.
+  std::size_t bestChild(std::size_t first, std::size_t size) {
+    if (FOLLY_LIKELY(first + D <= size)) {
+      if constexpr (kIntegerOrder != 0) {
+        return first +
+            detail::dAryHeapBestOfIntegers<D, T, kIntegerOrder>(&c_[first]);
+      } else {
+        return first + detail::dAryHeapBestOf<D>(&c_[first], comp_);
+      }
+    }
+    auto best = first;
+    for (auto i = first + 1; i < size; ++i) {
+      if (comp_(c_[best], c_[i])) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  void siftUp(std::size_t i) {
+    T value = std::move(c_[i]);
+    while (i > 0) {
+      auto const parent = (i - 1) / D;
+      if (!comp_(c_[parent], value)) {
+        break;
+      }
+      c_[i] = std::move(c_[parent]);
+      i = parent;
+    }
+    c_[i] = std::move(value);
+  }
+
+  void siftDown(std::size_t i) {
+    auto const size = c_.size();
+    T value = std::move(c_[i]);
+    std::size_t first;
+    while ((first = D * i + 1) < size) {
+      auto const child = bestChild(first, size);
+      if (!comp_(value, c_[child])) {
+        break;
+      }
+      c_[i] = std::move(c_[child]);
+      i = child;
+    }
+    c_[i] = std::move(value);
+  }
+
+  void heapify() {
+    if (c_.size() <= 1) {
+      return;
+    }
+    for (auto i = (c_.size() - 2) / D + 1; i-- > 0;) {
+      siftDown(i);
+    }
+  }
+
+  Container c_;
+  Compare comp_;
+};
+
+} // namespace folly
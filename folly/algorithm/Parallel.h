@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/system/HardwareConcurrency.h>
+
+/**
+ * Parallel versions of std::for_each, std::sort and std::partition, which
+ * split the work into tasks that run on the given executor, such as a
+ * CPUThreadPoolExecutor.
+ *
+ * The calling thread takes part in the work, and blocks until all of it is
+ * done. So the executor may be saturated, or be the one the caller runs
+ * on: the caller then does the work itself. Inputs too small to be worth
+ * splitting are processed on the calling thread, without the executor.
+ *
+ * If f, comp or pred throws, the work that hasn't started is skipped and
+ * the first exception is rethrown once the rest is done, leaving the
+ * range in an unspecified order.
+ */
+
+namespace folly {
+
+namespace detail {
+
+// Below this many elements, sorting or partitioning isn't worth a task.
+constexpr std::size_t kParallelMinChunkSize = 1 << 13;
+
+// Calls f(i) for each i in [0, n), on the executor and the calling thread.
+template <typename F>
+void parallelInvoke(Executor& executor, std::size_t n, F& f) {
+  if (n <= 1) {
+    if (n == 1) {
+      f(std::size_t(0));
+    }
+    return;
+  }
+
+  // The tasks may outlive the call, but only use f after claiming an index,
+  // which they can't once all the work is done.
+  struct State {
+    std::size_t const n;
+    F* const f;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::exception_ptr exception;
+    Baton<> baton;
+
+    State(std::size_t count, F* func) : n(count), f(func) {}
+
+    void run() {
+      std::size_t i;
+      while ((i = next.fetch_add(1, std::memory_order_relaxed)) < n) {
+        if (!failed.load(std::memory_order_relaxed)) {
+          try {
+            (*f)(i);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!exception) {
+              exception = std::current_exception();
+            }
+            failed.store(true, std::memory_order_relaxed);
+          }
+        }
+        if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == n) {
+          baton.post();
+        }
+      }
+    }
+  };
+
+  auto state = std::make_shared<State>(n, &f);
+  auto const tasks = std::min<std::size_t>(n, hardware_concurrency()) - 1;
+  for (std::size_t t = 0; t < tasks; ++t) {
+    try {
+      executor.add([state] { state->run(); });
+    } catch (...) {
+      // The caller does the work of the tasks that couldn't be added.
+      break;
+    }
+  }
+  state->run();
+  state->baton.wait();
+  if (state->exception) {
+    std::rethrow_exception(state->exception);
+  }
+}
+
+// Splits [0, n) into count chunks of at least minChunkSize elements, or one,
+// of which chunk c is [bound(c), bound(c + 1)).
+struct ParallelChunks {
+  std::size_t n;
+  std::size_t count;
+
+  ParallelChunks(std::size_t size, std::size_t minChunkSize)
+      : n(size),
+        count(std::max<std::size_t>(
+            1,
+            std::min<std::size_t>(
+                size / minChunkSize, 4 * hardware_concurrency()))) {}
+
+  std::size_t bound(std::size_t chunk) const { return n * chunk / count; }
+};
+
+} // namespace detail
+
+/// Calls f on each element of [first, last), in no particular order.
+template <typename RandomIt, typename F>
+void parallel_for_each(
+    Executor::KeepAlive<> executor, RandomIt first, RandomIt last, F f) {
+  detail::ParallelChunks chunks(std::size_t(last - first), 1);
+  auto task = [&](std::size_t c) {
+    std::for_each(first + chunks.bound(c), first + chunks.bound(c + 1), f);
+  };
+  detail::parallelInvoke(*executor, chunks.count, task);
+}
+
+/**
+ * Sorts [first, last) like std::sort: the chunks of the range are sorted in
+ * parallel, then merged pairwise, each round of merges in parallel.
+ */
+template <typename RandomIt, typename Compare>
+void parallel_sort(
+    Executor::KeepAlive<> executor,
+    RandomIt first,
+    RandomIt last,
+    Compare comp) {
+  detail::ParallelChunks chunks(
+      std::size_t(last - first), detail::kParallelMinChunkSize);
+  auto bound = [&](std::size_t c) {
+    return first + chunks.bound(std::min(c, chunks.count));
+  };
+  auto sort = [&](std::size_t c) { std::sort(bound(c), bound(c + 1), comp); };
+  detail::parallelInvoke(*executor, chunks.count, sort);
+  for (std::size_t width = 1; width < chunks.count; width *= 2) {
+    auto merge = [&](std::size_t pair) {
+      auto const lo = 2 * width * pair;
+      std::inplace_merge(
+          bound(lo), bound(lo + width), bound(lo + 2 * width), comp);
+    };
+    auto const pairs = (chunks.count + 2 * width - 1) / (2 * width);
+    detail::parallelInvoke(*executor, pairs, merge);
+  }
+}
+
+template <typename RandomIt>
+void parallel_sort(
+    Executor::KeepAlive<> executor, RandomIt first, RandomIt last) {
+  parallel_sort(std::move(executor), first, last, std::less<>{});
+}
+
+/**
+ * Reorders [first, last) like std::partition, so that the elements for which
+ * pred is true come first, and returns the end of them. The chunks of the
+ * range are partitioned in parallel, then the misplaced elements swapped in
+ * parallel.
+ */
+template <typename RandomIt, typename Predicate>
+RandomIt parallel_partition(
+    Executor::KeepAlive<> executor,
+    RandomIt first,
+    RandomIt last,
+    Predicate pred) {
+  detail::ParallelChunks chunks(
+      std::size_t(last - first), detail::kParallelMinChunkSize);
+  if (chunks.count == 1) {
+    return std::partition(first, last, pred);
+  }
+
+  std::vector<std::size_t> trues(chunks.count);
+  auto partition = [&](std::size_t c) {
+    auto begin = first + chunks.bound(c);
+    trues[c] = std::partition(begin, first + chunks.bound(c + 1), pred) - begin;
+  };
+  detail::parallelInvoke(*executor, chunks.count, partition);
+
+  std::size_t split = 0;
+  for (auto t : trues) {
+    split += t;
+  }
+  // The false elements before split and the true ones after it, which are
+  // equally many, form a range at the end and the start of the chunks.
+  struct Misplaced {
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    // The number of elements before each range.
+    std::vector<std::size_t> offsets;
+    std::size_t size = 0;
+
+    void add(std::size_t begin, std::size_t end) {
+      if (begin < end) {
+        ranges.emplace_back(begin, end);
+        offsets.push_back(size);
+        size += end - begin;
+      }
+    }
+
+    // The range of the k-th element, and its position.
+    std::pair<std::size_t, std::size_t> find(std::size_t k) const {
+      auto r = std::upper_bound(offsets.begin(), offsets.end(), k) -
+          offsets.begin() - 1;
+      return {r, ranges[r].first + (k - offsets[r])};
+    }
+  };
+  Misplaced falses;
+  Misplaced truesAfter;
+  for (std::size_t c = 0; c < chunks.count; ++c) {
+    auto const begin = chunks.bound(c);
+    auto const middle = begin + trues[c];
+    falses.add(middle, std::min(chunks.bound(c + 1), split));
+    truesAfter.add(std::max(begin, split), middle);
+  }
+
+  detail::ParallelChunks swaps(falses.size, detail::kParallelMinChunkSize);
+  auto swap = [&](std::size_t s) {
+    auto k = swaps.bound(s);
+    auto const end = swaps.bound(s + 1);
+    if (k == end) {
+      return;
+    }
+    auto [i, from] = falses.find(k);
+    auto [j, to] = truesAfter.find(k);
+    while (true) {
+      auto const count = std::min(
+          {end - k,
+           falses.ranges[i].second - from,
+           truesAfter.ranges[j].second - to});
+      std::swap_ranges(first + from, first + from + count, first + to);
+      k += count;
+      if (k == end) {
+        break;
+      }
+      from += count;
+      to += count;
+      if (from == falses.ranges[i].second) {
+        from = falses.ranges[++i].first;
+      }
+      if (to == truesAfter.ranges[j].second) {
+        to = truesAfter.ranges[++j].first;
+      }
+    }
+  };
+  detail::parallelInvoke(*executor, falses.size == 0 ? 0 : swaps.count, swap);
+  return first + split;
+}
+
+} // namespace folly
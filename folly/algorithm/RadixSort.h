@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/Traits.h>
+
+namespace folly {
+
+namespace detail {
+
+// Below this many elements, comparison sorting is faster.
+constexpr std::size_t kRadixSortMinSize = 256;
+
+// Maps a key to an unsigned integer of the same order: signed integers get
+// their sign bit flipped, and floating-point numbers their sign bit if
+// positive, or all their bits if negative (http://stereopsis.com/radix.html).
+template <typename T>
+auto radixKey(T value) noexcept {
+  using U = uint_bits_t<sizeof(T) * 8>;
+  constexpr U kSignBit = U(1) << (sizeof(T) * 8 - 1);
+  U bits;
+  std::memcpy(&bits, &value, sizeof(T));
+  if constexpr (std::is_floating_point_v<T>) {
+    return U(bits ^ (U(-(bits >> (sizeof(T) * 8 - 1))) | kSignBit));
+  } else if constexpr (std::is_signed_v<T>) {
+    return U(bits ^ kSignBit);
+  } else {
+    return bits;
+  }
+}
+
+} // namespace detail
+
+/**
+ * Sorts the integers or floating-point numbers in the contiguous range
+ * [first, last) with a least-significant-digit radix sort, in O(n) time and
+ * with an O(n) buffer: each pass scatters the values by one of their bytes,
+ * and passes over bytes that all the values share are skipped.
+ *
+ * Floating-point numbers are sorted by their bits: -0.0 comes before 0.0,
+ * and NaNs come first or last depending on their sign bit.
+ */
+template <typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  static_assert(
+      std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+          sizeof(T) <= sizeof(uint64_t),
+      "radix_sort only sorts integers and floating-point numbers of up to "
+      "64 bits");
+  constexpr std::size_t kBytes = sizeof(T);
+
+  auto const n = std::size_t(last - first);
+  if (n < detail::kRadixSortMinSize) {
+    std::sort(first, last, [](T a, T b) {
+      return detail::radixKey(a) < detail::radixKey(b);
+    });
+    return;
+  }
+
+  // The counts of each value of each byte, from one pass over the values.
+  std::vector<std::array<std::size_t, 256>> counts(kBytes);
+  T* const data = std::addressof(*first);
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const key = detail::radixKey(data[i]);
+    for (std::size_t b = 0; b < kBytes; ++b) {
+      ++counts[b][(key >> (8 * b)) & 0xff];
+    }
+  }
+
+  std::unique_ptr<T[]> buffer(new T[n]);
+  T* in = data;
+  T* out = buffer.get();
+  for (std::size_t b = 0; b < kBytes; ++b) {
+    auto& offsets = counts[b];
+    if (offsets[(detail::radixKey(in[0]) >> (8 * b)) & 0xff] == n) {
+      continue;
+    }
+    std::size_t offset = 0;
+    for (auto& count : offsets) {
+      offset += std::exchange(count, offset);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      out[offsets[(detail::radixKey(in[i]) >> (8 * b)) & 0xff]++] = in[i];
+    }
+    std::swap(in, out);
+  }
+  if (in != data) {
+    std::copy(in, in + n, data);
+  }
+}
+
+} // namespace folly
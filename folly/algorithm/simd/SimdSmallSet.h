@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+
+#include <folly/CPortability.h>
+#include <folly/algorithm/simd/Ignore.h>
+#include <folly/algorithm/simd/detail/SimdPlatform.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+namespace detail {
+
+template <typename T>
+using simd_small_set_scalar_t = std::make_unsigned_t<T>;
+
+// Platform is a template parameter, so that the code for the platform isn't
+// compiled when there is none.
+template <typename Platform>
+constexpr std::size_t simdSmallSetCardinal() {
+  if constexpr (std::is_same_v<Platform, void>) {
+    return 1;
+  } else {
+    return Platform::kCardinal;
+  }
+}
+
+// Whether x is in the n slots, n being a multiple of the cardinal.
+template <typename Platform, typename Scalar>
+FOLLY_ALWAYS_INLINE bool simdSmallSetContains(
+    const Scalar* slots, std::size_t n, Scalar x) {
+  if constexpr (std::is_same_v<Platform, void>) {
+    bool found = false;
+    for (std::size_t i = 0; i < n; ++i) {
+      found |= slots[i] == x;
+    }
+    return found;
+  } else {
+    auto equal = [&](std::size_t i) {
+      return Platform::equal(
+          Platform::loadu(slots + i, simd::ignore_none{}), x);
+    };
+    auto found = equal(0);
+    for (std::size_t i = Platform::kCardinal; i < n; i += Platform::kCardinal) {
+      found = Platform::logical_or(found, equal(i));
+    }
+    return Platform::any(found, simd::ignore_none{});
+  }
+}
+
+} // namespace detail
+
+/*
+ * # folly::SimdSmallSet
+ *
+ * A set of at most N integers in a fixed array, for the sets of a few
+ * dozen ids or flags checked on hot paths, where a hash set costs a hash
+ * and a cache miss.
+ *
+ * contains() compares the value with every slot of the array, a SIMD
+ * register at a time, without branching on the size: the unused slots
+ * hold copies of the first element, which can't give a false positive.
+ * So a SimdSmallSet<uint16_t, 32> is searched with 4 SSE or NEON, or 2
+ * AVX2, comparisons.
+ *
+ * Example:
+ *   folly::SimdSmallSet<uint16_t, 32> allowed{3, 17, 42};
+ *   allowed.insert(7);
+ *   if (allowed.contains(permission)) { ... }
+ *
+ * Supported types: 8, 16, 32 and 64 bit integers.
+ */
+template <typename T, std::size_t N>
+class SimdSmallSet {
+  static_assert(
+      std::is_integral_v<T> && !std::is_same_v<T, bool>,
+      "SimdSmallSet only holds integers");
+  static_assert(N > 0, "SimdSmallSet needs a capacity");
+
+  using scalar_t = detail::simd_small_set_scalar_t<T>;
+  using Platform = simd::detail::SimdPlatform<scalar_t>;
+  static constexpr std::size_t kCardinal =
+      detail::simdSmallSetCardinal<Platform>();
+  // The capacity, rounded up to whole registers.
+  static constexpr std::size_t kSlots =
+      (N + kCardinal - 1) / kCardinal * kCardinal;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using const_iterator = const T*;
+  using iterator = const_iterator;
+
+  SimdSmallSet() = default;
+
+  /// @throws std::length_error if there are more than N distinct values.
+  SimdSmallSet(std::initializer_list<T> values) {
+    for (auto value : values) {
+      insert(value);
+    }
+  }
+
+  static constexpr size_type capacity() noexcept { return N; }
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  bool full() const noexcept { return size_ == N; }
+
+  /// The values, in no particular order.
+  const_iterator begin() const noexcept { return data_.data(); }
+  const_iterator end() const noexcept { return data_.data() + size_; }
+
+  bool contains(T value) const noexcept {
+    if (size_ == 0) {
+      return false;
+    }
+    return detail::simdSmallSetContains<Platform>(
+        reinterpret_cast<const scalar_t*>(data_.data()),
+        kSlots,
+        static_cast<scalar_t>(value));
+  }
+
+  /// Returns false if value was already in the set.
+  ///
+  /// @throws std::length_error if the set is full.
+  bool insert(T value) {
+    if (contains(value)) {
+      return false;
+    }
+    if (size_ == N) {
+      throw_exception<std::length_error>("SimdSmallSet is full");
+    }
+    insertNew(value);
+    return true;
+  }
+
+  /// Returns false if value wasn't in the set.
+  bool erase(T value) noexcept {
+    if (!contains(value)) {
+      return false;
+    }
+    std::size_t i = 0;
+    while (data_[i] != value) {
+      ++i;
+    }
+    data_[i] = data_[--size_];
+    // The first element may have changed.
+    for (std::size_t j = size_; j < kSlots; ++j) {
+      data_[j] = data_[0];
+    }
+    return true;
+  }
+
+  void clear() noexcept { size_ = 0; }
+
+  /// The values that are also in other.
+  SimdSmallSet intersect(const SimdSmallSet& other) const noexcept {
+    SimdSmallSet result;
+    for (auto value : *this) {
+      if (other.contains(value)) {
+        result.insertNew(value);
+      }
+    }
+    return result;
+  }
+
+  /// Whether any value is also in other.
+  bool intersects(const SimdSmallSet& other) const noexcept {
+    for (auto value : *this) {
+      if (other.contains(value)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  friend bool operator==(
+      const SimdSmallSet& a, const SimdSmallSet& b) noexcept {
+    return a.size_ == b.size_ && a.intersect(b).size_ == a.size_;
+  }
+  friend bool operator!=(
+      const SimdSmallSet& a, const SimdSmallSet& b) noexcept {
+    return !(a == b);
+  }
+
+ private:
+  // Inserts a value known to be absent, into a set known not to be full.
+  void insertNew(T value) noexcept {
+    if (size_ == 0) {
+      data_.fill(value);
+    } else {
+      data_[size_] = value;
+    }
+    ++size_;
+  }
+
+  alignas(kCardinal * sizeof(T)) std::array<T, kSlots> data_{};
+  std::size_t size_ = 0;
+};
+
+} // namespace folly
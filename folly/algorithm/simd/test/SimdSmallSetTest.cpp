@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/algorithm/simd/SimdSmallSet.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+template <typename Set>
+class SimdSmallSetTest : public testing::Test {};
+
+using Sets = testing::Types<
+    SimdSmallSet<uint8_t, 5>,
+    SimdSmallSet<int8_t, 64>,
+    SimdSmallSet<uint16_t, 32>,
+    SimdSmallSet<int16_t, 9>,
+    SimdSmallSet<uint32_t, 16>,
+    SimdSmallSet<int32_t, 1>,
+    SimdSmallSet<uint64_t, 7>,
+    SimdSmallSet<int64_t, 8>>;
+TYPED_TEST_SUITE(SimdSmallSetTest, Sets);
+
+} // namespace
+
+TYPED_TEST(SimdSmallSetTest, matchesStdSet) {
+  using T = typename TypeParam::value_type;
+  std::mt19937 rng(42);
+  TypeParam set;
+  std::set<T> expected;
+  for (int i = 0; i < 10000; ++i) {
+    // Includes 0 and negative values, as the unused slots are 0 initially.
+    auto const value = T(int(rng() % 64) - 16);
+    if (rng() % 2 == 0 && expected.size() < TypeParam::capacity()) {
+      EXPECT_EQ(expected.insert(value).second, set.insert(value));
+    } else {
+      EXPECT_EQ(expected.erase(value) == 1, set.erase(value));
+    }
+    ASSERT_EQ(expected.size(), set.size());
+    for (int v = -16; v < 48; ++v) {
+      ASSERT_EQ(expected.count(T(v)) == 1, set.contains(T(v))) << v;
+    }
+  }
+  std::vector<T> values(set.begin(), set.end());
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(std::vector<T>(expected.begin(), expected.end()), values);
+}
+
+TYPED_TEST(SimdSmallSetTest, full) {
+  using T = typename TypeParam::value_type;
+  TypeParam set;
+  for (std::size_t i = 0; i < TypeParam::capacity(); ++i) {
+    EXPECT_TRUE(set.insert(T(i + 1)));
+  }
+  EXPECT_TRUE(set.full());
+  EXPECT_FALSE(set.insert(T(1)));
+  EXPECT_THROW(set.insert(T(0)), std::length_error);
+  EXPECT_FALSE(set.contains(T(0)));
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(T(1)));
+}
+
+TEST(SimdSmallSet, intersect) {
+  SimdSmallSet<uint16_t, 32> a{1, 2, 3, 500, 1000};
+  SimdSmallSet<uint16_t, 32> b{3, 4, 1000, 7};
+  auto both = a.intersect(b);
+  EXPECT_EQ((SimdSmallSet<uint16_t, 32>{1000, 3}), both);
+  EXPECT_TRUE(a.intersects(b));
+  EXPECT_FALSE(a.intersects(SimdSmallSet<uint16_t, 32>{4, 5}));
+  EXPECT_TRUE(a.intersect({}).empty());
+  EXPECT_NE(a, b);
+  EXPECT_THROW((SimdSmallSet<uint16_t, 2>{1, 2, 3}), std::length_error);
+}
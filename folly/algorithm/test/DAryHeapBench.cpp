@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/algorithm/DAryHeap.h>
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+namespace {
+
+constexpr std::size_t kSize = 1 << 20;
+
+const std::vector<uint32_t>& input() {
+  static auto const values = [] {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> v(kSize);
+    for (auto& x : v) {
+      x = rng();
+    }
+    return v;
+  }();
+  return values;
+}
+
+// Fills the queue, then drains it, as a heap sort.
+template <typename Queue>
+void pushPop(std::size_t iters) {
+  auto const& values = input();
+  for (std::size_t i = 0; i < iters; ++i) {
+    Queue queue;
+    for (auto v : values) {
+      queue.push(v);
+    }
+    uint64_t sum = 0;
+    while (!queue.empty()) {
+      sum += queue.top();
+      queue.pop();
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+// Replaces the top of a full queue, as a k-way merge does.
+template <typename Queue, typename Replace>
+void replaceTop(std::size_t iters, Replace replace) {
+  folly::BenchmarkSuspender suspender;
+  auto const& values = input();
+  Queue queue;
+  for (std::size_t i = 0; i < 4096; ++i) {
+    queue.push(values[i]);
+  }
+  suspender.dismiss();
+  for (std::size_t i = 0; i < iters; ++i) {
+    replace(queue, values[i % kSize]);
+  }
+  folly::doNotOptimizeAway(queue.top());
+}
+
+using PriorityQueue = std::priority_queue<uint32_t>;
+
+} // namespace
+
+BENCHMARK(PushPopPriorityQueue, iters) {
+  pushPop<PriorityQueue>(iters);
+}
+
+BENCHMARK_RELATIVE(PushPopBinaryHeap, iters) {
+  pushPop<folly::DAryHeap<uint32_t, 2>>(iters);
+}
+
+BENCHMARK_RELATIVE(PushPop4AryHeap, iters) {
+  pushPop<folly::DAryHeap<uint32_t, 4>>(iters);
+}
+
+BENCHMARK_RELATIVE(PushPop8AryHeap, iters) {
+  pushPop<folly::DAryHeap<uint32_t, 8>>(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ReplaceTopPriorityQueue, iters) {
+  replaceTop<PriorityQueue>(iters, [](auto& queue, uint32_t value) {
+    queue.pop();
+    queue.push(value);
+  });
+}
+
+BENCHMARK_RELATIVE(ReplaceTop4AryHeap, iters) {
+  replaceTop<folly::DAryHeap<uint32_t, 4>>(
+      iters, [](auto& heap, uint32_t value) { heap.replace_top(value); });
+}
+
+BENCHMARK_RELATIVE(ReplaceTop8AryHeap, iters) {
+  replaceTop<folly::DAryHeap<uint32_t, 8>>(
+      iters, [](auto& heap, uint32_t value) { heap.replace_top(value); });
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/algorithm/DAryHeap.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// Checks the heap property against every parent.
+template <typename Heap, typename Compare>
+bool isHeap(const Heap& heap, Compare comp) {
+  auto const& c = heap.container();
+  for (std::size_t i = 1; i < c.size(); ++i) {
+    if (comp(c[(i - 1) / Heap::kArity], c[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Heap>
+class DAryHeapTest : public testing::Test {};
+
+using Heaps = testing::Types<
+    DAryHeap<int, 2>,
+    DAryHeap<int, 4>,
+    DAryHeap<int, 8>,
+    DAryHeap<int, 3, std::greater<>>,
+    DAryHeap<uint8_t, 16>,
+    DAryHeap<double, 4>,
+    DAryHeap<int64_t, 8, std::greater<int64_t>>>;
+TYPED_TEST_SUITE(DAryHeapTest, Heaps);
+
+} // namespace
+
+TYPED_TEST(DAryHeapTest, matchesPriorityQueue) {
+  using T = typename TypeParam::value_type;
+  using Compare = typename TypeParam::value_compare;
+  std::mt19937 rng(42);
+  TypeParam heap;
+  std::priority_queue<T, std::vector<T>, Compare> expected;
+  for (int i = 0; i < 10000; ++i) {
+    if (rng() % 3 != 0 || expected.empty()) {
+      auto const value = T(rng() % 1000);
+      heap.push(value);
+      expected.push(value);
+    } else if (rng() % 2 == 0) {
+      EXPECT_EQ(expected.top(), heap.pop_top());
+      expected.pop();
+    } else {
+      auto const value = T(rng() % 1000);
+      heap.replace_top(value);
+      expected.pop();
+      expected.push(value);
+    }
+    ASSERT_EQ(expected.size(), heap.size());
+    ASSERT_EQ(expected.top(), heap.top());
+  }
+  EXPECT_TRUE(isHeap(heap, Compare()));
+  while (!heap.empty()) {
+    EXPECT_EQ(expected.top(), heap.top());
+    heap.pop();
+    expected.pop();
+  }
+}
+
+TYPED_TEST(DAryHeapTest, bulk) {
+  using T = typename TypeParam::value_type;
+  using Compare = typename TypeParam::value_compare;
+  std::mt19937 rng(7);
+  std::vector<T> values(1000);
+  for (auto& v : values) {
+    v = T(rng() % 100);
+  }
+
+  TypeParam heap(values.begin(), values.begin() + 10);
+  EXPECT_TRUE(isHeap(heap, Compare()));
+  // Rebuilds the heap.
+  heap.push_range(values.begin() + 10, values.begin() + 500);
+  EXPECT_TRUE(isHeap(heap, Compare()));
+  // Sifts up each element.
+  heap.push_range(values.begin() + 500, values.end());
+  EXPECT_TRUE(isHeap(heap, Compare()));
+
+  std::sort(values.begin(), values.end(), [](const T& a, const T& b) {
+    return Compare()(b, a);
+  });
+  std::vector<T> popped;
+  heap.pop_n(100, std::back_inserter(popped));
+  EXPECT_EQ(900, heap.size());
+  heap.pop_n(900, std::back_inserter(popped));
+  EXPECT_TRUE(heap.empty());
+  EXPECT_EQ(values, popped);
+}
+
+TEST(DAryHeap, moveOnly) {
+  auto comp = [](const auto& a, const auto& b) { return *a > *b; };
+  DAryHeap<std::unique_ptr<std::string>, 4, decltype(comp)> heap(comp);
+  for (auto s : {"d", "b", "a", "c", "e"}) {
+    heap.emplace(std::make_unique<std::string>(s));
+  }
+  std::string order;
+  while (!heap.empty()) {
+    order += *heap.pop_top();
+  }
+  EXPECT_EQ("abcde", order);
+}
+
+TEST(DAryHeap, kWayMerge) {
+  std::vector<std::vector<int>> inputs = {{1, 4, 7}, {2, 5, 8}, {0, 3, 6, 9}};
+  struct Cursor {
+    int value;
+    std::size_t input;
+    std::size_t index;
+  };
+  auto comp = [](const Cursor& a, const Cursor& b) {
+    return a.value > b.value;
+  };
+  DAryHeap<Cursor, 4, decltype(comp)> heap(comp);
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    heap.push({inputs[i][0], i, 0});
+  }
+  std::vector<int> merged;
+  while (!heap.empty()) {
+    auto const top = heap.top();
+    merged.push_back(top.value);
+    auto const& input = inputs[top.input];
+    if (top.index + 1 < input.size()) {
+      heap.replace_top({input[top.index + 1], top.input, top.index + 1});
+    } else {
+      heap.pop();
+    }
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), merged);
+}
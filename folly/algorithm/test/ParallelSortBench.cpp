@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/algorithm/Parallel.h>
+#include <folly/algorithm/RadixSort.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/init/Init.h>
+
+namespace {
+
+constexpr std::size_t kSize = 1 << 22;
+
+const std::vector<uint64_t>& input() {
+  static auto const values = [] {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> v(kSize);
+    for (auto& x : v) {
+      x = rng();
+    }
+    return v;
+  }();
+  return values;
+}
+
+folly::CPUThreadPoolExecutor& executor() {
+  static folly::CPUThreadPoolExecutor e(8);
+  return e;
+}
+
+template <typename Sort>
+void run(std::size_t iters, Sort sort) {
+  for (std::size_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    auto values = input();
+    suspender.dismiss();
+    sort(values);
+    folly::doNotOptimizeAway(values[kSize / 2]);
+  }
+}
+
+} // namespace
+
+BENCHMARK(StdSort, iters) {
+  run(iters, [](auto& v) { std::sort(v.begin(), v.end()); });
+}
+
+BENCHMARK_RELATIVE(ParallelSort, iters) {
+  run(iters, [](auto& v) {
+    folly::parallel_sort(&executor(), v.begin(), v.end());
+  });
+}
+
+BENCHMARK_RELATIVE(RadixSort, iters) {
+  run(iters, [](auto& v) { folly::radix_sort(v.begin(), v.end()); });
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(StdPartition, iters) {
+  run(iters, [](auto& v) {
+    std::partition(v.begin(), v.end(), [](uint64_t x) { return x & 1; });
+  });
+}
+
+BENCHMARK_RELATIVE(ParallelPartition, iters) {
+  run(iters, [](auto& v) {
+    folly::parallel_partition(
+        &executor(), v.begin(), v.end(), [](uint64_t x) { return x & 1; });
+  });
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
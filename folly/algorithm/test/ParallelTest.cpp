@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/algorithm/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+std::vector<int> randomInts(std::size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> dist(-1000, 1000);
+  std::vector<int> values(n);
+  for (auto& v : values) {
+    v = dist(rng);
+  }
+  return values;
+}
+
+} // namespace
+
+TEST(Parallel, forEach) {
+  CPUThreadPoolExecutor executor(4);
+  for (std::size_t n : {0, 1, 7, 100000}) {
+    std::vector<std::atomic<int>> calls(n);
+    std::vector<std::size_t> indices(n);
+    std::iota(indices.begin(), indices.end(), 0);
+    parallel_for_each(&executor, indices.begin(), indices.end(), [&](auto i) {
+      ++calls[i];
+    });
+    EXPECT_TRUE(std::all_of(calls.begin(), calls.end(), [](auto& c) {
+      return c == 1;
+    }));
+  }
+}
+
+TEST(Parallel, sort) {
+  CPUThreadPoolExecutor executor(4);
+  for (std::size_t n : {0, 1, 1000, 100000, 1000003}) {
+    auto values = randomInts(n, uint32_t(n));
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    parallel_sort(&executor, values.begin(), values.end());
+    EXPECT_EQ(expected, values) << n;
+
+    parallel_sort(&executor, values.begin(), values.end(), std::greater<>());
+    EXPECT_TRUE(std::is_sorted(values.rbegin(), values.rend())) << n;
+  }
+
+  std::vector<std::string> strings;
+  for (int i = 100000; i > 0; --i) {
+    strings.push_back(std::to_string(i));
+  }
+  parallel_sort(&executor, strings.begin(), strings.end());
+  EXPECT_TRUE(std::is_sorted(strings.begin(), strings.end()));
+}
+
+TEST(Parallel, partition) {
+  CPUThreadPoolExecutor executor(4);
+  for (std::size_t n : {0, 10, 100000, 1000003}) {
+    for (int threshold : {-2000, -500, 0, 900, 2000}) {
+      auto values = randomInts(n, uint32_t(n));
+      auto sorted = values;
+      std::sort(sorted.begin(), sorted.end());
+      auto pred = [&](int v) { return v < threshold; };
+      auto split =
+          parallel_partition(&executor, values.begin(), values.end(), pred);
+      EXPECT_TRUE(std::all_of(values.begin(), split, pred));
+      EXPECT_TRUE(std::none_of(split, values.end(), pred));
+      std::sort(values.begin(), values.end());
+      EXPECT_EQ(sorted, values);
+    }
+  }
+}
+
+TEST(Parallel, callerDoesTheWork) {
+  // The tasks never run, but the caller completes the work.
+  ManualExecutor executor;
+  auto values = randomInts(100000, 1);
+  auto expected = values;
+  std::sort(expected.begin(), expected.end());
+  parallel_sort(&executor, values.begin(), values.end());
+  EXPECT_EQ(expected, values);
+  executor.drain();
+
+  parallel_sort(&InlineExecutor::instance(), values.begin(), values.end());
+  EXPECT_EQ(expected, values);
+}
+
+TEST(Parallel, exceptions) {
+  CPUThreadPoolExecutor executor(4);
+  std::vector<int> values(100000);
+  std::iota(values.begin(), values.end(), 0);
+  EXPECT_THROW(
+      parallel_for_each(
+          &executor,
+          values.begin(),
+          values.end(),
+          [](int v) {
+            if (v == 5000) {
+              throw std::runtime_error("5000");
+            }
+          }),
+      std::runtime_error);
+  EXPECT_THROW(
+      parallel_sort(
+          &executor,
+          values.begin(),
+          values.end(),
+          [](int, int) -> bool { throw std::logic_error("comp"); }),
+      std::logic_error);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/algorithm/RadixSort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+template <typename T>
+std::vector<T> randomValues(std::size_t n) {
+  std::mt19937_64 rng(n);
+  std::vector<T> values(n);
+  for (auto& v : values) {
+    if constexpr (std::is_floating_point_v<T>) {
+      v = std::uniform_real_distribution<T>(-1e6, 1e6)(rng);
+    } else {
+      v = T(rng());
+    }
+  }
+  return values;
+}
+
+template <typename T>
+class RadixSortTest : public testing::Test {};
+
+using Types = testing::
+    Types<uint8_t, int8_t, uint16_t, int32_t, uint32_t, int64_t, float, double>;
+TYPED_TEST_SUITE(RadixSortTest, Types);
+
+} // namespace
+
+TYPED_TEST(RadixSortTest, matchesSort) {
+  for (std::size_t n : {0, 1, 100, 255, 256, 1000, 100000}) {
+    auto values = randomValues<TypeParam>(n);
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    radix_sort(values.begin(), values.end());
+    EXPECT_EQ(expected, values) << n;
+  }
+}
+
+TYPED_TEST(RadixSortTest, extremes) {
+  using Limits = std::numeric_limits<TypeParam>;
+  std::vector<TypeParam> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(Limits::max());
+    values.push_back(Limits::lowest());
+    values.push_back(TypeParam(0));
+    values.push_back(TypeParam(i % 100));
+  }
+  auto expected = values;
+  std::sort(expected.begin(), expected.end());
+  radix_sort(values.begin(), values.end());
+  EXPECT_EQ(expected, values);
+}
+
+TEST(RadixSort, floatingPointOrder) {
+  std::vector<double> values(1000, 1.0);
+  values[10] = std::numeric_limits<double>::infinity();
+  values[20] = -std::numeric_limits<double>::infinity();
+  values[30] = 0.0;
+  values[40] = -0.0;
+  values[50] = -std::numeric_limits<double>::denorm_min();
+  radix_sort(values.begin(), values.end());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), values[0]);
+  EXPECT_EQ(-std::numeric_limits<double>::denorm_min(), values[1]);
+  EXPECT_TRUE(std::signbit(values[2]));
+  EXPECT_EQ(0.0, values[2]);
+  EXPECT_FALSE(std::signbit(values[3]));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), values.back());
+}
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <folly/channels/Channel-fwd.h>
+#include <folly/coro/Task.h>
 #include <folly/experimental/channels/detail/ChannelBridge.h>
 
 namespace folly {
@@ -33,6 +34,17 @@ namespace channels {
  *   auto [receiver, sender] = Channel<T>::create();
  *   sender.write(val1);
  *   auto val2 = co_await receiver.next();
+ *
+ * A channel is unbounded: values written faster than the receiver consumes
+ * them accumulate in it. A bounded channel caps the values waiting for the
+ * receiver, and applies a BoundedChannelPolicy to those written beyond:
+ *
+ *   auto [receiver, sender] = Channel<T>::createBounded(
+ *       100, BoundedChannelPolicy::Block);
+ *   co_await sender.writeAsync(val1); // Waits while 100 values are waiting.
+ *
+ * Its receiver is a regular receiver, which transform, MergeChannel,
+ * MultiplexChannel and the other consumers take as is.
  */
 template <typename TValue>
 class Channel {
@@ -49,6 +61,21 @@ class Channel {
         Receiver<TValue>(std::move(receiverBridge)),
         Sender<TValue>(std::move(senderBridge)));
   }
+
+  /**
+   * Creates a new channel which holds at most capacity values waiting for the
+   * receiver, besides those it is processing. See BoundedChannelPolicy for
+   * what happens to the values written beyond.
+   */
+  static std::pair<Receiver<TValue>, Sender<TValue>> createBounded(
+      size_t capacity, BoundedChannelPolicy policy) {
+    auto senderBridge =
+        detail::ChannelBridge<TValue>::createBounded(capacity, policy);
+    auto receiverBridge = senderBridge->copy();
+    return std::make_pair(
+        Receiver<TValue>(std::move(receiverBridge)),
+        Sender<TValue>(std::move(senderBridge)));
+  }
 };
 
 /**
@@ -96,6 +123,17 @@ class Sender {
     }
   }
 
+  /**
+   * Writes a value into the pipe. For a bounded channel with the Block policy,
+   * this first waits until the channel has room for it.
+   */
+  folly::coro::Task<void> writeAsync(TValue element) {
+    while (auto baton = bridge_->senderCapacityBaton()) {
+      co_await *baton;
+    }
+    write(std::move(element));
+  }
+
   /**
    * Closes the pipe without an exception.
    */
@@ -132,6 +170,11 @@ class Sender {
     return false;
   }
 
+  /**
+   * Returns the queue-depth metrics of the channel.
+   */
+  BoundedChannelStats stats() { return bridge_->stats(); }
+
  private:
   friend detail::ChannelBridgePtr<TValue>& detail::senderGetBridge<>(
       Sender<TValue>&);
@@ -284,22 +284,26 @@ class FanoutChannelProcessor
    */
   std::optional<CloseResult> processValues(
       WLockedStatePtr& state, ReceiverQueue<ValueType> values) {
+    // The values available are written to the output senders as a batch, so
+    // that each output sender is visited once for all of them.
+    std::vector<ValueType> batch;
+    auto const numSubscribers = state->fanoutSender.numSubscribers();
     while (!values.empty()) {
       auto inputResult = std::move(values.front());
       values.pop();
       if (inputResult.hasValue()) {
-        // We have received a normal value from the input receiver. Write it to
-        // all output senders.
-        state->context.update(
-            inputResult.value(), state->fanoutSender.numSubscribers());
-        state->fanoutSender.write(std::move(inputResult.value()));
+        // We have received a normal value from the input receiver.
+        state->context.update(inputResult.value(), numSubscribers);
+        batch.push_back(std::move(inputResult.value()));
       } else {
         // The input receiver was closed.
+        state->fanoutSender.writeBatch(std::move(batch));
         return inputResult.hasException()
             ? CloseResult(std::move(inputResult.exception()))
             : CloseResult();
       }
     }
+    state->fanoutSender.writeBatch(std::move(batch));
     return std::nullopt;
   }
 
@@ -40,6 +40,21 @@ struct NoContext {
  * computes a set of initial values. These initial values will only be sent to
  * the new receiver.
  *
+ * The values available from the input receiver are written to the output
+ * receivers in batches, each output receiver getting a copy of each value. To
+ * fan out large values, use a FanoutChannel<std::shared_ptr<const T>> so that
+ * the copies only bump a reference count. To spread the fan out to many output
+ * receivers over several executors, fan out to a FanoutChannel per executor,
+ * and subscribe the output receivers to those:
+ *
+ *   auto fanoutChannel = createFanoutChannel(getReceiver(), getExecutor());
+ *   std::vector<FanoutChannel<int>> shards;
+ *   for (auto& executor : shardExecutors) {
+ *     shards.push_back(
+ *         createFanoutChannel(fanoutChannel.subscribe(), executor));
+ *   }
+ *   auto receiver = shards[subscriberId % shards.size()].subscribe();
+ *
  * FanoutChannel allows specifying an optional context object. If specified, the
  * context object must have a void update function:
  *
@@ -51,8 +51,33 @@ class FanoutSenderProcessor : public IChannelCallback {
   template <typename U = ValueType>
   void write(U&& element) {
     auto state = state_.wlock();
+    auto remaining = state->senders_.size();
     for (auto* sender : state->senders_) {
-      sender->senderPush(element);
+      if (--remaining == 0) {
+        // The last sender can take the value.
+        sender->senderPush(std::forward<U>(element));
+      } else {
+        sender->senderPush(element);
+      }
+    }
+  }
+
+  /**
+   * Sends the given values, in order, to all corresponding receivers.
+   */
+  void writeBatch(std::vector<ValueType>& values) {
+    auto state = state_.wlock();
+    auto remaining = state->senders_.size();
+    for (auto* sender : state->senders_) {
+      if (--remaining == 0) {
+        for (auto&& value : values) {
+          sender->senderPush(std::move(value));
+        }
+      } else {
+        for (const auto& value : values) {
+          sender->senderPush(value);
+        }
+      }
     }
   }
 
@@ -281,6 +306,23 @@ void FanoutSender<ValueType>::write(U&& element) {
   }
 }
 
+template <typename ValueType>
+void FanoutSender<ValueType>::writeBatch(std::vector<ValueType> values) {
+  clearSendersWithClosedReceivers();
+  if (!anySubscribersImpl()) {
+    // There are currently no output receivers to write to.
+    return;
+  } else if (!hasProcessor()) {
+    // There is exactly one output receiver. Write the values to that receiver.
+    auto* sender = getSingleSender();
+    for (auto&& value : values) {
+      sender->senderPush(std::move(value));
+    }
+  } else {
+    getProcessor()->writeBatch(values);
+  }
+}
+
 template <typename ValueType>
 void FanoutSender<ValueType>::close(exception_wrapper ex) && {
   clearSendersWithClosedReceivers();
@@ -40,6 +40,11 @@ class FanoutSenderProcessor;
  * Memory used by closed receivers is reclaimed lazily (when iterating over
  * receivers).
  *
+ * Each receiver gets its own copy of each value, but the last one, which the
+ * value is moved to. To fan out large values to many receivers, use a
+ * FanoutSender<std::shared_ptr<const T>>, so that the copies only bump a
+ * reference count.
+ *
  * Example:
  *
  *  FanoutSender<int> fanoutSender;
@@ -84,6 +89,13 @@ class FanoutSender {
   template <typename U = ValueType>
   void write(U&& element);
 
+  /**
+   * Sends the given values, in order, to all corresponding receivers. Unlike
+   * writing them one by one, this goes over the receivers once for all of the
+   * values.
+   */
+  void writeBatch(std::vector<ValueType> values);
+
   /**
    * Closes the fanout sender.
    */
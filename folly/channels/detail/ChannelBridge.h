@@ -16,11 +16,49 @@
 
 #pragma once
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <folly/Likely.h>
 #include <folly/Try.h>
+#include <folly/coro/Baton.h>
 #include <folly/experimental/channels/detail/AtomicQueue.h>
 
 namespace folly {
 namespace channels {
+
+/**
+ * What a bounded channel does with a value written while it holds as many
+ * values waiting for the receiver as its capacity. See
+ * Channel<T>::createBounded.
+ */
+enum class BoundedChannelPolicy {
+  // The value is queued anyway by write(), while writeAsync() waits for the
+  // receiver to take the values waiting first.
+  Block,
+  // The value is dropped.
+  DropNewest,
+  // The oldest value waiting is dropped.
+  DropOldest,
+  // The values waiting are dropped, so that the receiver skips to the latest
+  // value. With a capacity of 1, the receiver only sees the latest value.
+  Conflate,
+};
+
+/**
+ * The queue-depth metrics of a channel. All of them are 0 for an unbounded
+ * channel.
+ */
+struct BoundedChannelStats {
+  size_t capacity{0};
+  // The values waiting for the receiver, besides those it is processing.
+  size_t depth{0};
+  size_t maxDepth{0};
+  size_t dropped{0};
+};
+
 namespace detail {
 
 class ChannelBridgeBase {};
@@ -49,6 +87,13 @@ class ChannelBridge : public ChannelBridgeBase {
 
   static Ptr create() { return Ptr(new ChannelBridge<TValue>()); }
 
+  static Ptr createBounded(size_t capacity, BoundedChannelPolicy policy) {
+    auto bridge = create();
+    bridge->bounded_ =
+        std::make_unique<Bounded>(std::max<size_t>(capacity, 1), policy);
+    return bridge;
+  }
+
   Ptr copy() {
     auto refCount = refCount_.fetch_add(1, std::memory_order_relaxed);
     DCHECK(refCount > 0);
@@ -59,9 +104,23 @@ class ChannelBridge : public ChannelBridgeBase {
 
   template <typename U = TValue>
   void senderPush(U&& value) {
-    receiverQueue_.push(
-        Try<TValue>(std::forward<U>(value)),
-        static_cast<ChannelBridgeBase*>(this));
+    receiverPush(Try<TValue>(std::forward<U>(value)));
+  }
+
+  // Returns a baton to wait on before pushing, if this is a full bounded
+  // channel with the Block policy.
+  coro::Baton* senderCapacityBaton() {
+    if (bounded_ == nullptr ||
+        bounded_->policy != BoundedChannelPolicy::Block) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(bounded_->mutex);
+    if (bounded_->cancelled || bounded_->receiverWaiting ||
+        bounded_->pending.size() < bounded_->capacity) {
+      return nullptr;
+    }
+    bounded_->capacityBaton.reset();
+    return &bounded_->capacityBaton;
   }
 
   bool senderWait(IChannelCallback* callback) {
@@ -72,15 +131,14 @@ class ChannelBridge : public ChannelBridgeBase {
 
   void senderClose() {
     if (!isSenderClosed()) {
-      receiverQueue_.push(Try<TValue>(), static_cast<ChannelBridgeBase*>(this));
+      receiverPush(Try<TValue>());
       senderQueue_.close(static_cast<ChannelBridgeBase*>(this));
     }
   }
 
   void senderClose(exception_wrapper ex) {
     if (!isSenderClosed()) {
-      receiverQueue_.push(
-          Try<TValue>(std::move(ex)), static_cast<ChannelBridgeBase*>(this));
+      receiverPush(Try<TValue>(std::move(ex)));
       senderQueue_.close(static_cast<ChannelBridgeBase*>(this));
     }
   }
@@ -95,6 +153,14 @@ class ChannelBridge : public ChannelBridgeBase {
 
   void receiverCancel() {
     if (!isReceiverCancelled()) {
+      if (FOLLY_UNLIKELY(bounded_ != nullptr)) {
+        {
+          std::lock_guard<std::mutex> lock(bounded_->mutex);
+          bounded_->cancelled = true;
+          bounded_->pending.clear();
+        }
+        bounded_->capacityBaton.post();
+      }
       senderQueue_.push(Unit(), static_cast<ChannelBridgeBase*>(this));
       receiverQueue_.close(static_cast<ChannelBridgeBase*>(this));
     }
@@ -103,7 +169,16 @@ class ChannelBridge : public ChannelBridgeBase {
   bool isReceiverCancelled() { return receiverQueue_.isClosed(); }
 
   bool receiverWait(IChannelCallback* callback) {
-    return receiverQueue_.wait(callback, static_cast<ChannelBridgeBase*>(this));
+    if (FOLLY_UNLIKELY(bounded_ != nullptr) && boundedReceiverFlush()) {
+      return false;
+    }
+    auto waiting =
+        receiverQueue_.wait(callback, static_cast<ChannelBridgeBase*>(this));
+    if (FOLLY_UNLIKELY(bounded_ != nullptr) && !waiting) {
+      std::lock_guard<std::mutex> lock(bounded_->mutex);
+      bounded_->receiverWaiting = false;
+    }
+    return waiting;
   }
 
   IChannelCallback* cancelReceiverWait() {
@@ -114,7 +189,102 @@ class ChannelBridge : public ChannelBridgeBase {
     return receiverQueue_.getMessages(static_cast<ChannelBridgeBase*>(this));
   }
 
+  // May be called from any thread
+
+  BoundedChannelStats stats() {
+    BoundedChannelStats stats;
+    if (bounded_ != nullptr) {
+      std::lock_guard<std::mutex> lock(bounded_->mutex);
+      stats.capacity = bounded_->capacity;
+      stats.depth = bounded_->pending.size();
+      stats.maxDepth = bounded_->maxDepth;
+      stats.dropped = bounded_->dropped;
+    }
+    return stats;
+  }
+
  private:
+  // A bounded channel holds the values written while the receiver is busy in
+  // pending, where the policy applies, and hands them over to the receiver
+  // queue once the receiver waits for more. A value written while the receiver
+  // waits goes to the receiver queue directly.
+  struct Bounded {
+    Bounded(size_t capacity_, BoundedChannelPolicy policy_)
+        : capacity(capacity_), policy(policy_) {}
+
+    const size_t capacity;
+    const BoundedChannelPolicy policy;
+    std::mutex mutex;
+    std::deque<Try<TValue>> pending;
+    bool receiverWaiting{false};
+    bool cancelled{false};
+    size_t maxDepth{0};
+    size_t dropped{0};
+    coro::Baton capacityBaton;
+  };
+
+  void receiverPush(Try<TValue> value) {
+    if (FOLLY_UNLIKELY(bounded_ != nullptr)) {
+      std::lock_guard<std::mutex> lock(bounded_->mutex);
+      if (bounded_->cancelled) {
+        return;
+      }
+      if (!std::exchange(bounded_->receiverWaiting, false)) {
+        boundedEnqueue(std::move(value));
+        return;
+      }
+    }
+    receiverQueue_.push(
+        std::move(value), static_cast<ChannelBridgeBase*>(this));
+  }
+
+  // Called with the lock of bounded_ held.
+  void boundedEnqueue(Try<TValue> value) {
+    auto& pending = bounded_->pending;
+    // The close of the channel is never dropped.
+    if (pending.size() >= bounded_->capacity && value.hasValue()) {
+      switch (bounded_->policy) {
+        case BoundedChannelPolicy::Block:
+          break;
+        case BoundedChannelPolicy::DropNewest:
+          ++bounded_->dropped;
+          return;
+        case BoundedChannelPolicy::DropOldest:
+          pending.pop_front();
+          ++bounded_->dropped;
+          break;
+        case BoundedChannelPolicy::Conflate:
+          bounded_->dropped += pending.size();
+          pending.clear();
+          break;
+      }
+    }
+    pending.push_back(std::move(value));
+    bounded_->maxDepth = std::max(bounded_->maxDepth, pending.size());
+  }
+
+  // Hands the pending values over to the receiver queue. Returns false, and
+  // marks the receiver as waiting, if there were none.
+  bool boundedReceiverFlush() {
+    std::deque<Try<TValue>> pending;
+    {
+      std::lock_guard<std::mutex> lock(bounded_->mutex);
+      pending.swap(bounded_->pending);
+      bounded_->receiverWaiting = pending.empty();
+    }
+    if (pending.empty()) {
+      return false;
+    }
+    for (auto& value : pending) {
+      receiverQueue_.push(
+          std::move(value), static_cast<ChannelBridgeBase*>(this));
+    }
+    if (bounded_->policy == BoundedChannelPolicy::Block) {
+      bounded_->capacityBaton.post();
+    }
+    return true;
+  }
+
   using ReceiverAtomicQueue = typename folly::channels::detail::
       AtomicQueue<IChannelCallback, Try<TValue>>;
 
@@ -130,6 +300,7 @@ class ChannelBridge : public ChannelBridgeBase {
   ReceiverAtomicQueue receiverQueue_;
   SenderAtomicQueue senderQueue_;
   std::atomic<int8_t> refCount_{1};
+  std::unique_ptr<Bounded> bounded_;
 };
 
 template <typename TValue>
@@ -15,6 +15,9 @@
  */
 
 #include <folly/channels/Channel.h>
+
+#include <stdexcept>
+
 #include <folly/channels/test/ChannelTestUtil.h>
 #include <folly/coro/BlockingWait.h>
 #include <folly/executors/ManualExecutor.h>
@@ -254,6 +257,92 @@ TEST(Channel, CancelNextWithoutClose) {
   EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 2);
 }
 
+TEST(Channel, Bounded_DropNewest) {
+  auto [receiver, sender] =
+      Channel<int>::createBounded(2, BoundedChannelPolicy::DropNewest);
+  for (int i = 1; i <= 4; ++i) {
+    sender.write(i);
+  }
+  auto stats = sender.stats();
+  EXPECT_EQ(stats.capacity, 2);
+  EXPECT_EQ(stats.depth, 2);
+  EXPECT_EQ(stats.maxDepth, 2);
+  EXPECT_EQ(stats.dropped, 2);
+
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 1);
+  EXPECT_EQ(sender.stats().depth, 0);
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 2);
+
+  // The receiver waits, so the next value goes to it directly.
+  sender.write(5);
+  std::move(sender).close();
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 5);
+  EXPECT_FALSE(folly::coro::blockingWait(receiver.next()).has_value());
+}
+
+TEST(Channel, Bounded_DropOldest) {
+  auto [receiver, sender] =
+      Channel<int>::createBounded(2, BoundedChannelPolicy::DropOldest);
+  for (int i = 1; i <= 4; ++i) {
+    sender.write(i);
+  }
+  std::move(sender).close();
+
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 3);
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 4);
+  EXPECT_FALSE(folly::coro::blockingWait(receiver.next()).has_value());
+}
+
+TEST(Channel, Bounded_Conflate) {
+  auto [receiver, sender] =
+      Channel<int>::createBounded(1, BoundedChannelPolicy::Conflate);
+  for (int i = 1; i <= 4; ++i) {
+    sender.write(i);
+  }
+  EXPECT_EQ(sender.stats().dropped, 3);
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 4);
+
+  sender.write(5);
+  sender.write(6);
+  std::move(sender).close(std::runtime_error("Error"));
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 6);
+  EXPECT_THROW(
+      folly::coro::blockingWait(receiver.next()), std::runtime_error);
+}
+
+TEST(Channel, Bounded_Block) {
+  folly::ManualExecutor executor;
+  auto [receiver, sender] =
+      Channel<int>::createBounded(2, BoundedChannelPolicy::Block);
+
+  int written = 0;
+  auto writeTask = folly::coro::co_invoke(
+                       [&, &sender_2 = sender]() -> folly::coro::Task<void> {
+                         for (int i = 1; i <= 5; ++i) {
+                           co_await sender_2.writeAsync(i);
+                           ++written;
+                         }
+                       })
+                       .scheduleOn(&executor)
+                       .start();
+  executor.drain();
+  EXPECT_EQ(written, 2);
+  EXPECT_EQ(sender.stats().depth, 2);
+
+  // Taking the values waiting lets the writer continue.
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 1);
+  executor.drain();
+  EXPECT_EQ(written, 4);
+  EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 2);
+
+  // Cancelling the receiver releases the writer.
+  std::move(receiver).cancel();
+  executor.drain();
+  EXPECT_EQ(written, 5);
+  folly::coro::blockingWait(std::move(writeTask));
+  EXPECT_TRUE(sender.isReceiverCancelled());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Channel_Coro_WithTry,
     ChannelFixture,
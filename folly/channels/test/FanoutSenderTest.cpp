@@ -17,6 +17,7 @@
 #include <folly/channels/ConsumeChannel.h>
 #include <folly/channels/FanoutSender.h>
 #include <folly/channels/test/ChannelTestUtil.h>
+#include <folly/coro/BlockingWait.h>
 #include <folly/executors/ManualExecutor.h>
 #include <folly/executors/SerialExecutor.h>
 #include <folly/portability/GMock.h>
@@ -95,6 +96,65 @@ TEST_F(FanoutSenderFixture, WriteValue_FanoutBroadcastsValues) {
   executor_.drain();
 }
 
+TEST_F(FanoutSenderFixture, WriteBatch_FanoutBroadcastsValuesInOrder) {
+  auto fanoutSender = FanoutSender<int>();
+
+  fanoutSender.writeBatch({-1, -2});
+
+  auto [handle1, callback1] = processValues(fanoutSender.subscribe());
+
+  {
+    InSequence sequence;
+    EXPECT_CALL(*callback1, onValue(0));
+    EXPECT_CALL(*callback1, onValue(1));
+  }
+
+  fanoutSender.writeBatch({0, 1});
+  executor_.drain();
+
+  auto [handle2, callback2] = processValues(fanoutSender.subscribe());
+
+  {
+    InSequence sequence;
+    EXPECT_CALL(*callback1, onValue(2));
+    EXPECT_CALL(*callback1, onValue(3));
+    EXPECT_CALL(*callback1, onValue(4));
+  }
+  {
+    InSequence sequence;
+    EXPECT_CALL(*callback2, onValue(2));
+    EXPECT_CALL(*callback2, onValue(3));
+    EXPECT_CALL(*callback2, onValue(4));
+  }
+
+  fanoutSender.writeBatch({2, 3});
+  fanoutSender.writeBatch({});
+  fanoutSender.write(4);
+  executor_.drain();
+
+  EXPECT_CALL(*callback1, onClosed());
+  EXPECT_CALL(*callback2, onClosed());
+
+  std::move(fanoutSender).close();
+  executor_.drain();
+}
+
+TEST_F(FanoutSenderFixture, WriteSharedValue_ReceiversShareIt) {
+  auto fanoutSender = FanoutSender<std::shared_ptr<const std::string>>();
+  auto receiver1 = fanoutSender.subscribe();
+  auto receiver2 = fanoutSender.subscribe();
+
+  auto value = std::make_shared<const std::string>("value");
+  fanoutSender.write(value);
+
+  auto value1 = folly::coro::blockingWait(receiver1.next());
+  auto value2 = folly::coro::blockingWait(receiver2.next());
+  ASSERT_TRUE(value1.has_value());
+  ASSERT_TRUE(value2.has_value());
+  EXPECT_EQ(value1->get(), value.get());
+  EXPECT_EQ(value2->get(), value.get());
+}
+
 TEST_F(FanoutSenderFixture, InputThrows_AllOutputReceiversGetException) {
   auto fanoutSender = FanoutSender<int>();
 
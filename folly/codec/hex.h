@@ -17,12 +17,18 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string_view>
 
+#include <folly/Portability.h>
 #include <folly/lang/Align.h>
 #include <folly/lang/Assume.h>
 
+#if FOLLY_SSE_PREREQ(2, 0)
+#include <emmintrin.h>
+#endif
+
 namespace folly {
 
 /// hex_alphabet_lower
@@ -157,4 +163,107 @@ constexpr uint8_t hex_decode_digit(char const h) {
       : hex_decode_digit_flavor_x86_64(h);
 }
 
+namespace detail {
+
+#if FOLLY_SSE_PREREQ(2, 0)
+
+//  SSE2 is the baseline of x86_64, so there is no runtime dispatch: wider
+//  registers would not make a difference next to the loads and stores.
+
+FOLLY_ALWAYS_INLINE __m128i hex_encode_nibbles_sse2(__m128i const n) {
+  auto const letter = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+  auto const offset = _mm_and_si128(letter, _mm_set1_epi8('a' - '0' - 10));
+  return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), offset);
+}
+
+//  There are no unsigned comparisons: the offsets of the digits from '0' and
+//  'a' are compared as signed bytes, which wrap around for the other bytes.
+FOLLY_ALWAYS_INLINE __m128i
+hex_decode_digits_sse2(__m128i const h, __m128i& valid) {
+  auto const d = _mm_sub_epi8(h, _mm_set1_epi8('0'));
+  auto const l = _mm_or_si128(h, _mm_set1_epi8(0x20));
+  auto const a = _mm_sub_epi8(l, _mm_set1_epi8('a'));
+  auto const is_d = _mm_and_si128(
+      _mm_cmpgt_epi8(d, _mm_set1_epi8(-1)),
+      _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+  auto const is_a = _mm_and_si128(
+      _mm_cmpgt_epi8(a, _mm_set1_epi8(-1)),
+      _mm_cmplt_epi8(a, _mm_set1_epi8(6)));
+  valid = _mm_and_si128(valid, _mm_or_si128(is_d, is_a));
+  return _mm_or_si128(
+      _mm_and_si128(is_d, d),
+      _mm_and_si128(is_a, _mm_add_epi8(a, _mm_set1_epi8(10))));
+}
+
+//  Each pair of digits is a 16-bit lane, with the high nibble in its low byte.
+FOLLY_ALWAYS_INLINE __m128i hex_pack_nibbles_sse2(__m128i const v) {
+  auto const hi = _mm_and_si128(v, _mm_set1_epi16(0xff));
+  return _mm_or_si128(_mm_slli_epi16(hi, 4), _mm_srli_epi16(v, 8));
+}
+
+#endif
+
+} // namespace detail
+
+/// hex_encode
+///
+/// Writes the 2 * size digits, in the lower hex alphabet, of the size bytes at
+/// in to out.
+inline void hex_encode(
+    char* const out, void const* const in, std::size_t const size) noexcept {
+  auto const bytes = static_cast<unsigned char const*>(in);
+  std::size_t i = 0;
+#if FOLLY_SSE_PREREQ(2, 0)
+  auto const mask = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= size; i += 16) {
+    auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + i));
+    auto const hi = detail::hex_encode_nibbles_sse2(
+        _mm_and_si128(_mm_srli_epi16(b, 4), mask));
+    auto const lo = detail::hex_encode_nibbles_sse2(_mm_and_si128(b, mask));
+    auto const o = reinterpret_cast<__m128i*>(out + 2 * i);
+    _mm_storeu_si128(o, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(o + 1, _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+  for (; i < size; ++i) {
+    out[2 * i] = hex_alphabet_lower[bytes[i] >> 4];
+    out[2 * i + 1] = hex_alphabet_lower[bytes[i] & 0xf];
+  }
+}
+
+/// hex_decode
+///
+/// Reads the 2 * size digits at in, in the lower or upper hex alphabets, and
+/// writes the size decoded bytes to out.
+///
+/// Returns false if any of the characters is not a digit, in which case the
+/// contents of out are unspecified.
+inline bool hex_decode(
+    void* const out, char const* const in, std::size_t const size) noexcept {
+  auto const bytes = static_cast<unsigned char*>(out);
+  std::size_t i = 0;
+  bool valid = true;
+#if FOLLY_SSE_PREREQ(2, 0)
+  auto valid_v = _mm_set1_epi8(-1);
+  for (; i + 16 <= size; i += 16) {
+    auto const h = reinterpret_cast<__m128i const*>(in + 2 * i);
+    auto const a = detail::hex_pack_nibbles_sse2(
+        detail::hex_decode_digits_sse2(_mm_loadu_si128(h), valid_v));
+    auto const b = detail::hex_pack_nibbles_sse2(
+        detail::hex_decode_digits_sse2(_mm_loadu_si128(h + 1), valid_v));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(bytes + i), _mm_packus_epi16(a, b));
+  }
+  valid = _mm_movemask_epi8(valid_v) == 0xffff;
+#endif
+  uint8_t invalid = 0;
+  for (; i < size; ++i) {
+    auto const hi = hex_decode_digit(in[2 * i]);
+    auto const lo = hex_decode_digit(in[2 * i + 1]);
+    invalid |= hi | lo;
+    bytes[i] = uint8_t(hi << 4 | lo);
+  }
+  return valid && hex_decoded_digit_is_valid(invalid);
+}
+
 } // namespace folly
@@ -16,6 +16,8 @@
 
 #include <folly/codec/hex.h>
 
+#include <string>
+
 #include <folly/Likely.h>
 #include <folly/lang/Keep.h>
 #include <folly/portability/GMock.h>
@@ -113,6 +115,16 @@ check_folly_hex_decode_digit_flavor_x86_64_or_sink_split(char h) {
   return folly::hex_decode_digit_raw_flavor_x86_64(h);
 }
 
+extern "C" FOLLY_KEEP void check_folly_hex_encode(
+    char* out, void const* in, size_t size) {
+  folly::hex_encode(out, in, size);
+}
+
+extern "C" FOLLY_KEEP bool check_folly_hex_decode(
+    void* out, char const* in, size_t size) {
+  return folly::hex_decode(out, in, size);
+}
+
 struct HexTest : testing::Test {};
 
 TEST_F(HexTest, hex_decode_digit_lower_all) {
@@ -150,3 +162,47 @@ TEST_F(HexTest, hex_decode_digit_full) {
     EXPECT_EQ(h, folly::hex_decode_digit_flavor_x86_64(c));
   }
 }
+
+TEST_F(HexTest, hex_encode_decode) {
+  // Every byte value, in every position of the vectorized blocks and of the
+  // tail, for every size around the block size.
+  for (size_t size = 0; size < 50; ++size) {
+    for (size_t v = 0; v < 256; ++v) {
+      std::string bytes(size, '\0');
+      for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>(v + i * 37);
+      }
+      std::string expected;
+      for (auto const c : bytes) {
+        expected += folly::hex_alphabet_lower[uint8_t(c) >> 4];
+        expected += folly::hex_alphabet_lower[uint8_t(c) & 0xf];
+      }
+      std::string hex(2 * size, '\0');
+      folly::hex_encode(hex.data(), bytes.data(), size);
+      EXPECT_EQ(expected, hex);
+
+      std::string decoded(size, '\0');
+      EXPECT_TRUE(folly::hex_decode(decoded.data(), hex.data(), size));
+      EXPECT_EQ(bytes, decoded);
+    }
+  }
+
+  std::string decoded(8, '\0');
+  EXPECT_TRUE(folly::hex_decode(decoded.data(), "DEADbeef0123aBcD", 8));
+  EXPECT_EQ("\xde\xad\xbe\xef\x01\x23\xab\xcd"sv, decoded);
+}
+
+TEST_F(HexTest, hex_decode_invalid) {
+  // Each character, in each position of 40 digits.
+  for (size_t pos = 0; pos < 40; ++pos) {
+    for (size_t i = 0; i < 256; ++i) {
+      std::string hex(40, 'a');
+      hex[pos] = static_cast<char>(i);
+      std::string decoded(20, '\0');
+      EXPECT_EQ(
+          folly::hex_is_digit_table(hex[pos]),
+          folly::hex_decode(decoded.data(), hex.data(), 20))
+          << pos << " " << i;
+    }
+  }
+}
@@ -59,6 +59,7 @@
 #include <folly/ScopeGuard.h>
 #include <folly/Utility.h>
 #include <folly/Varint.h>
+#include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/Utils.h>
 #include <folly/io/Cursor.h>
 #include <folly/lang/Bits.h>
@@ -718,15 +719,17 @@ class LZ4FrameCodec final : public Codec {
   std::unique_ptr<IOBuf> doUncompress(
       const IOBuf* data, Optional<uint64_t> uncompressedLength) override;
 
+  int level_;
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
   // Reset the dctx_ if it is dirty or null.
   void resetDCtx();
 
-  int level_;
 #if FOLLY_USE_LZ4_FAST_RESET
   LZ4F_compressionContext_t cctx_{nullptr};
 #endif
   LZ4F_decompressionContext_t dctx_{nullptr};
   bool dirty_{false};
+#endif
 };
 
 /* static */ std::unique_ptr<Codec> LZ4FrameCodec::create(
@@ -760,6 +763,7 @@ size_t lz4FrameThrowOnError(size_t code) {
   return code;
 }
 
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
 void LZ4FrameCodec::resetDCtx() {
   if (dctx_ && !dirty_) {
     return;
@@ -770,6 +774,7 @@ void LZ4FrameCodec::resetDCtx() {
   lz4FrameThrowOnError(LZ4F_createDecompressionContext(&dctx_, 100));
   dirty_ = false;
 }
+#endif
 
 int lz4fConvertLevel(int level) {
   switch (level) {
@@ -788,6 +793,7 @@ LZ4FrameCodec::LZ4FrameCodec(int level, CodecType type)
 }
 
 LZ4FrameCodec::~LZ4FrameCodec() {
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
   if (dctx_) {
     LZ4F_freeDecompressionContext(dctx_);
   }
@@ -796,6 +802,7 @@ LZ4FrameCodec::~LZ4FrameCodec() {
     LZ4F_freeCompressionContext(cctx_);
   }
 #endif
+#endif
 }
 
 std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
@@ -807,9 +814,17 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
   }
 
 #if FOLLY_USE_LZ4_FAST_RESET
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+  // Codecs are often created per request, so the contexts are shared by all
+  // of them instead.
+  auto const cctxRef = contexts::getLZ4F_CCtx();
+  auto const cctx = cctxRef.get();
+#else
   if (!cctx_) {
     lz4FrameThrowOnError(LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION));
   }
+  auto const cctx = cctx_;
+#endif
 #endif
 
   // Set preferences
@@ -822,7 +837,7 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
   const size_t written = lz4FrameThrowOnError(
 #if FOLLY_USE_LZ4_FAST_RESET
       LZ4F_compressFrame_usingCDict(
-          cctx_,
+          cctx,
           buf->writableTail(),
           buf->tailroom(),
           data->data(),
@@ -844,8 +859,16 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
 
 std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
     const IOBuf* data, Optional<uint64_t> uncompressedLength) {
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+  // The pool resets the dctx when it is returned, even if an error left the
+  // frame unfinished.
+  auto const dctxRef = contexts::getLZ4F_DCtx();
+  auto const dctx = dctxRef.get();
+#else
   // Reset the dctx if any errors have occurred
   resetDCtx();
+  auto const dctx = dctx_;
+#endif
   // Coalesce the data
   ByteRange in = *data->begin();
   IOBuf clone;
@@ -873,9 +896,11 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
         4 * std::max<uint64_t>(blockSize, in.size());
     growthSize = std::min(guessUncompressedLen, growthSize);
   }
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
   // Once LZ4_decompress() is called, the dctx_ cannot be reused until it
   // returns 0
   dirty_ = true;
+#endif
   // Decompress until the frame is over
   size_t code = 0;
   do {
@@ -886,7 +911,7 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
     // Decompress
     size_t inSize = in.size();
     code = lz4FrameThrowOnError(
-        LZ4F_decompress(dctx_, out, &outSize, in.data(), &inSize, &options));
+        LZ4F_decompress(dctx, out, &outSize, in.data(), &inSize, &options));
     if (in.empty() && outSize == 0 && code != 0) {
       // We passed no input, no output was produced, and the frame isn't over
       // No more forward progress is possible
@@ -895,8 +920,10 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
     in.uncheckedAdvance(inSize);
     queue.postallocate(outSize);
   } while (code != 0);
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
   // At this point the decompression context can be reused
   dirty_ = false;
+#endif
   if (uncompressedLength && queue.chainLength() != *uncompressedLength) {
     throw std::runtime_error("LZ4Frame error: Invalid uncompressedLength");
   }
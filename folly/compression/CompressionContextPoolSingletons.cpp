@@ -18,6 +18,9 @@
 
 #include <stdlib.h>
 
+#include <new>
+#include <stdexcept>
+
 #include <folly/Portability.h>
 #include <folly/memory/Malloc.h>
 
@@ -145,6 +148,187 @@ size_t get_zstd_dctx_created_count() {
 
 #endif // FOLLY_HAVE_LIBZSTD
 
+#if FOLLY_HAVE_LIBZ
+namespace {
+// zlib's default, deflateInit() uses it as well.
+constexpr int kZlibMemLevel = 8;
+
+Zlib_Deflate_Pool zlib_deflate_pool_singleton{Zlib_Deflate_Creator{15}};
+Zlib_Deflate_Pool gzip_deflate_pool_singleton{Zlib_Deflate_Creator{31}};
+Zlib_Deflate_Pool raw_deflate_pool_singleton{Zlib_Deflate_Creator{-15}};
+Zlib_Inflate_Pool zlib_inflate_pool_singleton;
+
+Zlib_Deflate_Pool* find_zlib_deflate_pool(int windowBits) {
+  switch (windowBits) {
+    case 15:
+      return &zlib_deflate_pool_singleton;
+    case 31:
+      return &gzip_deflate_pool_singleton;
+    case -15:
+      return &raw_deflate_pool_singleton;
+    default:
+      return nullptr;
+  }
+}
+
+} // anonymous namespace
+
+z_stream* Zlib_Deflate_Creator::operator()() const noexcept {
+  auto stream = new (std::nothrow) z_stream{};
+  if (stream != nullptr &&
+      deflateInit2(
+          stream,
+          Z_DEFAULT_COMPRESSION,
+          Z_DEFLATED,
+          windowBits,
+          kZlibMemLevel,
+          Z_DEFAULT_STRATEGY) != Z_OK) {
+    delete stream;
+    return nullptr;
+  }
+  return stream;
+}
+
+z_stream* Zlib_Inflate_Creator::operator()() const noexcept {
+  auto stream = new (std::nothrow) z_stream{};
+  if (stream != nullptr && inflateInit2(stream, MAX_WBITS) != Z_OK) {
+    delete stream;
+    return nullptr;
+  }
+  return stream;
+}
+
+void Zlib_Deflate_Deleter::operator()(z_stream* stream) const noexcept {
+  deflateEnd(stream);
+  delete stream;
+}
+
+void Zlib_Inflate_Deleter::operator()(z_stream* stream) const noexcept {
+  inflateEnd(stream);
+  delete stream;
+}
+
+void Zlib_Deflate_Resetter::operator()(z_stream* stream) const noexcept {
+  int const rc = deflateReset(stream);
+  assert(rc == Z_OK); // Only fails for invalid streams
+  (void)rc;
+}
+
+void Zlib_Inflate_Resetter::operator()(z_stream* stream) const noexcept {
+  int const rc = inflateReset(stream);
+  assert(rc == Z_OK); // Only fails for invalid streams
+  (void)rc;
+}
+
+Zlib_Deflate_Pool::Ref getZlib_Deflate(int windowBits) {
+  return zlib_deflate_pool(windowBits).get();
+}
+
+Zlib_Inflate_Pool::Ref getZlib_Inflate() {
+  return zlib_inflate_pool_singleton.get();
+}
+
+Zlib_Deflate_Pool::Ref getNULL_Zlib_Deflate() {
+  return zlib_deflate_pool_singleton.getNull();
+}
+
+Zlib_Inflate_Pool::Ref getNULL_Zlib_Inflate() {
+  return zlib_inflate_pool_singleton.getNull();
+}
+
+Zlib_Deflate_Pool& zlib_deflate_pool(int windowBits) {
+  auto pool = find_zlib_deflate_pool(windowBits);
+  if (pool == nullptr) {
+    throw std::invalid_argument("No pooled deflate streams for windowBits");
+  }
+  return *pool;
+}
+
+Zlib_Inflate_Pool& zlib_inflate_pool() {
+  return zlib_inflate_pool_singleton;
+}
+
+size_t get_zlib_deflate_created_count() {
+  return zlib_deflate_pool_singleton.created_count() +
+      gzip_deflate_pool_singleton.created_count() +
+      raw_deflate_pool_singleton.created_count();
+}
+
+size_t get_zlib_inflate_created_count() {
+  return zlib_inflate_pool_singleton.created_count();
+}
+
+#endif // FOLLY_HAVE_LIBZ
+
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+namespace {
+LZ4F_CCtx_Pool lz4f_cctx_pool_singleton;
+LZ4F_DCtx_Pool lz4f_dctx_pool_singleton;
+} // anonymous namespace
+
+LZ4F_cctx* LZ4F_CCtx_Creator::operator()() const noexcept {
+  LZ4F_cctx* ctx = nullptr;
+  if (LZ4F_isError(LZ4F_createCompressionContext(&ctx, LZ4F_VERSION))) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+LZ4F_dctx* LZ4F_DCtx_Creator::operator()() const noexcept {
+  LZ4F_dctx* ctx = nullptr;
+  if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION))) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+void LZ4F_CCtx_Deleter::operator()(LZ4F_cctx* ctx) const noexcept {
+  LZ4F_freeCompressionContext(ctx);
+}
+
+void LZ4F_DCtx_Deleter::operator()(LZ4F_dctx* ctx) const noexcept {
+  LZ4F_freeDecompressionContext(ctx);
+}
+
+void LZ4F_DCtx_Resetter::operator()(LZ4F_dctx* ctx) const noexcept {
+  // Also discards a frame that was left unfinished.
+  LZ4F_resetDecompressionContext(ctx);
+}
+
+LZ4F_CCtx_Pool::Ref getLZ4F_CCtx() {
+  return lz4f_cctx_pool_singleton.get();
+}
+
+LZ4F_DCtx_Pool::Ref getLZ4F_DCtx() {
+  return lz4f_dctx_pool_singleton.get();
+}
+
+LZ4F_CCtx_Pool::Ref getNULL_LZ4F_CCtx() {
+  return lz4f_cctx_pool_singleton.getNull();
+}
+
+LZ4F_DCtx_Pool::Ref getNULL_LZ4F_DCtx() {
+  return lz4f_dctx_pool_singleton.getNull();
+}
+
+LZ4F_CCtx_Pool& lz4f_cctx_pool() {
+  return lz4f_cctx_pool_singleton;
+}
+
+LZ4F_DCtx_Pool& lz4f_dctx_pool() {
+  return lz4f_dctx_pool_singleton;
+}
+
+size_t get_lz4f_cctx_created_count() {
+  return lz4f_cctx_pool_singleton.created_count();
+}
+
+size_t get_lz4f_dctx_created_count() {
+  return lz4f_dctx_pool_singleton.created_count();
+}
+
+#endif // FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
 } // namespace contexts
 } // namespace compression
 } // namespace folly
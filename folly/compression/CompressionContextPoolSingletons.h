@@ -22,6 +22,17 @@
 #include <zstd.h>
 #endif
 
+#if FOLLY_HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#if FOLLY_HAVE_LIBLZ4
+#include <lz4.h>
+#if LZ4_VERSION_NUMBER >= 10900
+#include <lz4frame.h>
+#endif
+#endif
+
 #include <folly/compression/CompressionCoreLocalContextPool.h>
 
 // When this header is present, folly/compression/Compression.h defines
@@ -97,6 +108,148 @@ size_t get_zstd_dctx_created_count();
 
 #endif // FOLLY_HAVE_LIBZSTD
 
+#if FOLLY_HAVE_LIBZ
+
+// Additional feature test macro for zlib singletons.
+#define FOLLY_COMPRESSION_HAS_ZLIB_CONTEXT_POOL_SINGLETONS
+
+// The deflate streams are initialized with the default memLevel, and with
+// windowBits, which selects both the window size and the format.
+struct Zlib_Deflate_Creator {
+  int windowBits;
+  z_stream* operator()() const noexcept;
+};
+
+struct Zlib_Inflate_Creator {
+  z_stream* operator()() const noexcept;
+};
+
+struct Zlib_Deflate_Deleter {
+  void operator()(z_stream* stream) const noexcept;
+};
+
+struct Zlib_Inflate_Deleter {
+  void operator()(z_stream* stream) const noexcept;
+};
+
+struct Zlib_Deflate_Resetter {
+  void operator()(z_stream* stream) const noexcept;
+};
+
+struct Zlib_Inflate_Resetter {
+  void operator()(z_stream* stream) const noexcept;
+};
+
+using Zlib_Deflate_Pool = CompressionCoreLocalContextPool<
+    z_stream,
+    Zlib_Deflate_Creator,
+    Zlib_Deflate_Deleter,
+    Zlib_Deflate_Resetter,
+    4>;
+using Zlib_Inflate_Pool = CompressionCoreLocalContextPool<
+    z_stream,
+    Zlib_Inflate_Creator,
+    Zlib_Inflate_Deleter,
+    Zlib_Inflate_Resetter,
+    16>;
+
+/**
+ * Returns a clean deflate stream for windowBits 15 (zlib), 31 (gzip) or -15
+ * (raw), with the default memLevel. The level and strategy are those of the
+ * previous user, so set them with deflateParams().
+ *
+ * @throws std::invalid_argument for any other windowBits.
+ */
+Zlib_Deflate_Pool::Ref getZlib_Deflate(int windowBits);
+
+/**
+ * Returns a clean inflate stream. Select the format and window size with
+ * inflateReset2().
+ */
+Zlib_Inflate_Pool::Ref getZlib_Inflate();
+
+Zlib_Deflate_Pool::Ref getNULL_Zlib_Deflate();
+
+Zlib_Inflate_Pool::Ref getNULL_Zlib_Inflate();
+
+Zlib_Deflate_Pool& zlib_deflate_pool(int windowBits);
+
+Zlib_Inflate_Pool& zlib_inflate_pool();
+
+size_t get_zlib_deflate_created_count();
+
+size_t get_zlib_inflate_created_count();
+
+#endif // FOLLY_HAVE_LIBZ
+
+#if FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10900
+
+// Additional feature test macro for LZ4 frame singletons.
+#define FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
+struct LZ4F_CCtx_Creator {
+  LZ4F_cctx* operator()() const noexcept;
+};
+
+struct LZ4F_DCtx_Creator {
+  LZ4F_dctx* operator()() const noexcept;
+};
+
+struct LZ4F_CCtx_Deleter {
+  void operator()(LZ4F_cctx* ctx) const noexcept;
+};
+
+struct LZ4F_DCtx_Deleter {
+  void operator()(LZ4F_dctx* ctx) const noexcept;
+};
+
+// LZ4F_compressBegin() and LZ4F_compressFrame_usingCDict() start from scratch,
+// so there is nothing to reset.
+struct LZ4F_CCtx_Resetter {
+  void operator()(LZ4F_cctx*) const noexcept {}
+};
+
+struct LZ4F_DCtx_Resetter {
+  void operator()(LZ4F_dctx* ctx) const noexcept;
+};
+
+using LZ4F_CCtx_Pool = CompressionCoreLocalContextPool<
+    LZ4F_cctx,
+    LZ4F_CCtx_Creator,
+    LZ4F_CCtx_Deleter,
+    LZ4F_CCtx_Resetter,
+    4>;
+using LZ4F_DCtx_Pool = CompressionCoreLocalContextPool<
+    LZ4F_dctx,
+    LZ4F_DCtx_Creator,
+    LZ4F_DCtx_Deleter,
+    LZ4F_DCtx_Resetter,
+    16>;
+
+/**
+ * Returns a LZ4F_cctx.
+ */
+LZ4F_CCtx_Pool::Ref getLZ4F_CCtx();
+
+/**
+ * Returns a clean LZ4F_dctx.
+ */
+LZ4F_DCtx_Pool::Ref getLZ4F_DCtx();
+
+LZ4F_CCtx_Pool::Ref getNULL_LZ4F_CCtx();
+
+LZ4F_DCtx_Pool::Ref getNULL_LZ4F_DCtx();
+
+LZ4F_CCtx_Pool& lz4f_cctx_pool();
+
+LZ4F_DCtx_Pool& lz4f_dctx_pool();
+
+size_t get_lz4f_cctx_created_count();
+
+size_t get_lz4f_dctx_created_count();
+
+#endif // FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10900
+
 } // namespace contexts
 } // namespace compression
 } // namespace folly
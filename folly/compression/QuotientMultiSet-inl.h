@@ -249,6 +249,39 @@ auto QuotientMultiSet<Instructions>::equalRange(uint64_t key) const
   return range;
 }
 
+template <class Instructions>
+void QuotientMultiSet<Instructions>::equalRange(
+    Range<const uint64_t*> keys, SlotRange* out) const {
+  // Enough lookups in flight to cover the memory latency.
+  constexpr size_t kLookahead = 8;
+  const size_t numKeys = keys.size();
+  for (size_t i = 0; i < std::min(numKeys, kLookahead); ++i) {
+    prefetchBlock(keys[i]);
+  }
+  for (size_t i = 0; i < numKeys; ++i) {
+    if (i + kLookahead < numKeys) {
+      prefetchBlock(keys[i + kLookahead]);
+    }
+    out[i] = equalRange(keys[i]);
+  }
+}
+
+template <class Instructions>
+void QuotientMultiSet<Instructions>::prefetchBlock(uint64_t key) const {
+  if (key > maxKey_) {
+    return;
+  }
+  const auto quotient =
+      qms_detail::getQuotientAndRemainder(key, divisor_, fraction_).first;
+  const size_t blockIndex = quotient / kBlockSize;
+  if (blockIndex < numBlocks_) {
+    // The block header and the first remainders.
+    const auto* block = reinterpret_cast<const char*>(getBlock(blockIndex));
+    __builtin_prefetch(block);
+    __builtin_prefetch(block + 64);
+  }
+}
+
 template <class Instructions>
 auto QuotientMultiSet<Instructions>::findRunend(
     uint64_t occupiedRank,
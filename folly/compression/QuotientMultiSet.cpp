@@ -16,7 +16,10 @@
 
 #include <folly/compression/QuotientMultiSet.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <thread>
 
 #include <folly/Math.h>
 
@@ -107,7 +110,7 @@ void QuotientMultiSetBuilder::setBlockPayload(uint64_t payload) {
 }
 
 void QuotientMultiSetBuilder::closePreviousRun() {
-  if (FOLLY_UNLIKELY(nextSlot_ == 0)) {
+  if (FOLLY_UNLIKELY(numKeys_ == 0)) {
     return;
   }
 
@@ -170,13 +173,182 @@ void QuotientMultiSetBuilder::close(IOBufQueue& buff) {
   // 64-bits at any position without bounds-checking.
   static_assert(sizeof(Metadata) > 7, "getRemainder() is not safe");
   auto metadata = reinterpret_cast<Metadata*>(calloc(1, sizeof(Metadata)));
+  writeMetadata(metadata);
+  buff.append(IOBuf::takeOwnership(metadata, sizeof(Metadata)));
+}
+
+void QuotientMultiSetBuilder::writeMetadata(Metadata* metadata) const {
   metadata->numBlocks = numBlocks_;
   metadata->numKeys = numKeys_;
   metadata->divisor = divisor_;
   metadata->keyBits = keyBits_;
   metadata->remainderBits = remainderBits_;
   VLOG(2) << "Metadata: " << metadata->debugString();
-  buff.append(IOBuf::takeOwnership(metadata, sizeof(Metadata)));
+}
+
+size_t QuotientMultiSetBuilder::blockIndex(uint64_t key) const {
+  FOLLY_SAFE_CHECK(key <= maxKey_, "Invalid key");
+  return qms_detail::getQuotientAndRemainder(key, divisor_, fraction_).first /
+      kBlockSize;
+}
+
+void QuotientMultiSetBuilder::startAt(size_t firstBlock, size_t firstSlot) {
+  DCHECK_EQ(numKeys_, 0);
+  DCHECK_LE(firstBlock * kBlockSize, firstSlot);
+  numBlocks_ = firstBlock;
+  nextSlot_ = firstSlot;
+}
+
+size_t QuotientMultiSetBuilder::endSlot(
+    Range<const uint64_t*> keys, size_t firstSlot) const {
+  // Mirrors the slot assignment of insert(): a run starts at the next free
+  // slot, or at the start of the block of its quotient if that is later.
+  size_t slot = firstSlot;
+  uint64_t prevQuotient = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto quotient =
+        qms_detail::getQuotientAndRemainder(keys[i], divisor_, fraction_)
+            .first;
+    if (i == 0 || quotient != prevQuotient) {
+      slot = std::max<size_t>(slot, quotient / kBlockSize * kBlockSize);
+      prevQuotient = quotient;
+    }
+    ++slot;
+  }
+  return slot;
+}
+
+void QuotientMultiSetBuilder::moveReadyBlocks(
+    char* data, size_t endBlock, std::vector<BlockWithState>& spill) {
+  while (!blocks_.empty() && blocks_.front().ready) {
+    auto& front = blocks_.front();
+    if (front.index < endBlock) {
+      memcpy(data + front.index * blockSize_, front.block.get(), blockSize_);
+    } else {
+      spill.push_back(std::move(front));
+    }
+    blocks_.pop_front();
+  }
+  readyBlocks_ = 0;
+}
+
+void QuotientMultiSetBuilder::build(
+    Range<const uint64_t*> keys,
+    size_t keyBits,
+    size_t numThreads,
+    IOBufQueue& buff,
+    double loadFactor) {
+  QuotientMultiSetBuilder builder(keyBits, keys.size(), loadFactor);
+
+  // Small sets are not worth the threads.
+  constexpr size_t kMinKeysPerPart = 1 << 16;
+  numThreads = std::min(numThreads, keys.size() / kMinKeysPerPart);
+  if (numThreads <= 1) {
+    for (auto key : keys) {
+      builder.insert(key);
+    }
+    builder.close(buff);
+    return;
+  }
+
+  struct Part {
+    Range<const uint64_t*> keys;
+    size_t firstBlock = 0;
+    size_t firstSlot = 0;
+    size_t endSlot = 0;
+    // Blocks written by this part that belong to the next part.
+    std::vector<BlockWithState> spill;
+  };
+
+  // Split the keys evenly, moving each split back to the first key of its
+  // block so that every block's occupieds are set by a single part.
+  std::vector<Part> parts;
+  const uint64_t* begin = keys.begin();
+  for (size_t i = 1; i <= numThreads; ++i) {
+    const uint64_t* end = keys.begin() + keys.size() * i / numThreads;
+    if (i < numThreads) {
+      const auto splitBlock = builder.blockIndex(*end);
+      end = std::partition_point(begin, end, [&](uint64_t key) {
+        return builder.blockIndex(key) < splitBlock;
+      });
+    }
+    if (end == begin) {
+      continue;
+    }
+    FOLLY_SAFE_CHECK(
+        parts.empty() || *(begin - 1) <= *begin,
+        "Keys need to be inserted in nondecreasing order");
+    auto& part = parts.emplace_back();
+    part.keys = Range<const uint64_t*>(begin, end);
+    part.firstBlock = builder.blockIndex(*begin);
+    begin = end;
+  }
+
+  auto forEachPart = [&](auto func) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < parts.size(); ++i) {
+      threads.emplace_back([&, i] { func(i); });
+    }
+    func(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+
+  // A part's end slot is max(firstSlot + number of keys, end slot when
+  // starting at its first block), so the end slots computed in parallel
+  // give each part's first slot in a single sequential pass.
+  forEachPart([&](size_t i) {
+    auto& part = parts[i];
+    part.endSlot = builder.endSlot(part.keys, part.firstBlock * kBlockSize);
+  });
+  size_t slot = 0;
+  for (auto& part : parts) {
+    part.firstSlot = std::max(slot, part.firstBlock * kBlockSize);
+    slot = std::max(part.firstSlot + part.keys.size(), part.endSlot);
+    part.endSlot = slot;
+  }
+  builder.numBlocks_ = divCeil(slot, kBlockSize);
+  builder.numKeys_ = keys.size();
+
+  // Zero-filled, as the blocks of the serial builder are.
+  const size_t dataSize = builder.numBlocks_ * builder.blockSize_;
+  auto data = reinterpret_cast<char*>(calloc(dataSize + sizeof(Metadata), 1));
+
+  forEachPart([&](size_t i) {
+    auto& part = parts[i];
+    const size_t endBlock = i + 1 < parts.size() ? parts[i + 1].firstBlock
+                                                 : builder.numBlocks_;
+    QuotientMultiSetBuilder partBuilder(keyBits, keys.size(), loadFactor);
+    partBuilder.startAt(part.firstBlock, part.firstSlot);
+    for (auto key : part.keys) {
+      partBuilder.insert(key);
+      if (partBuilder.readyBlocks_ > 0) {
+        partBuilder.moveReadyBlocks(data, endBlock, part.spill);
+      }
+    }
+    partBuilder.closePreviousRun();
+    for (auto& block : partBuilder.blocks_) {
+      block.ready = true;
+    }
+    partBuilder.moveReadyBlocks(data, endBlock, part.spill);
+    DCHECK_EQ(partBuilder.nextSlot_, part.endSlot);
+  });
+
+  // Parts write disjoint bits of the blocks they share.
+  for (auto& part : parts) {
+    for (auto& block : part.spill) {
+      auto dst =
+          reinterpret_cast<uint64_t*>(data + block.index * builder.blockSize_);
+      auto src = reinterpret_cast<const uint64_t*>(block.block.get());
+      for (size_t i = 0; i < builder.blockSize_ / sizeof(uint64_t); ++i) {
+        dst[i] |= src[i];
+      }
+    }
+  }
+
+  builder.writeMetadata(reinterpret_cast<Metadata*>(data + dataSize));
+  buff.append(IOBuf::takeOwnership(data, dataSize + sizeof(Metadata)));
 }
 
 } // namespace folly
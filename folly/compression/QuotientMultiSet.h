@@ -18,6 +18,7 @@
 
 #include <deque>
 #include <utility>
+#include <vector>
 
 #include <folly/Portability.h>
 #include <folly/Range.h>
@@ -133,6 +134,12 @@ class QuotientMultiSet final {
   // Get the position range for the given key.
   SlotRange equalRange(uint64_t key) const;
 
+  // Get the position ranges for the given keys into out, which must have
+  // room for keys.size() ranges. The blocks of the next few keys are
+  // prefetched while looking up each key, so that the cache misses of
+  // independent lookups overlap.
+  void equalRange(Range<const uint64_t*> keys, SlotRange* out) const;
+
   // Get payload of given block.
   uint64_t getBlockPayload(uint64_t blockIndex) const;
 
@@ -150,6 +157,9 @@ class QuotientMultiSet final {
     return Block::get(data_ + blockIndex * blockSize_);
   }
 
+  // Prefetch the block the given key maps to.
+  FOLLY_ALWAYS_INLINE void prefetchBlock(uint64_t key) const;
+
   FOLLY_ALWAYS_INLINE std::pair<uint64_t, const Block*> findRunend(
       uint64_t occupiedRank, uint64_t startPos) const;
 
@@ -273,6 +283,22 @@ class QuotientMultiSetBuilder final {
 
   size_t numReadyBlocks() { return readyBlocks_; }
 
+  // Build the set of the given non-decreasing keys on up to numThreads
+  // threads and append it to buff. The result is the same as inserting the
+  // keys one by one and never setting a block payload: payloads are zero.
+  //
+  // The keys are split at block boundaries into one part per thread. A first
+  // pass over each part finds the slot its runs end at; with those, the slot
+  // each part starts at is known, and the parts are built independently and
+  // concatenated. A part's last runs can spill into the first blocks of the
+  // next part, so those blocks are merged.
+  static void build(
+      Range<const uint64_t*> keys,
+      size_t keyBits,
+      size_t numThreads,
+      IOBufQueue& buff,
+      double loadFactor = kDefaultMaxLoadFactor);
+
  private:
   using BlockPtr = QuotientMultiSet<>::BlockPtr;
 
@@ -294,6 +320,24 @@ class QuotientMultiSetBuilder final {
   // Move ready blocks to given IOBufQueue.
   void moveReadyBlocks(IOBufQueue& buff);
 
+  // Copy ready blocks to their place in the table at data, or move them to
+  // spill if they are at or after endBlock.
+  void moveReadyBlocks(
+      char* data, size_t endBlock, std::vector<BlockWithState>& spill);
+
+  // Start building the part of a table whose first block is firstBlock and
+  // whose first run starts at slot firstSlot.
+  void startAt(size_t firstBlock, size_t firstSlot);
+
+  // Slot after the last of the given keys if the first run starts no earlier
+  // than firstSlot.
+  size_t endSlot(Range<const uint64_t*> keys, size_t firstSlot) const;
+
+  // Index of the block the given key maps to.
+  size_t blockIndex(uint64_t key) const;
+
+  void writeMetadata(Metadata* metadata) const;
+
   // Get block for given block index.
   BlockWithState& getBlock(uint64_t blockIndex) {
     CHECK_GE(blockIndex, blocks_.front().index);
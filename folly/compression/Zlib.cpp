@@ -23,6 +23,7 @@
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/compression/Compression.h>
+#include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/Utils.h>
 #include <folly/io/Cursor.h>
 
@@ -101,11 +102,22 @@ class ZlibStreamCodec final : public StreamCodec {
 
   void resetDeflateStream();
   void resetInflateStream();
+  bool canPoolDeflateStream() const;
+  z_stream* deflateStream();
+  z_stream* inflateStream() { return inflateStream_.get(); }
+  void releaseStreams();
 
   Options options_;
 
+  // Streams with the default memLevel and windowSize come from a core-local
+  // pool, and go back to it as soon as the stream ends, so that codecs that
+  // are created per request do not allocate and initialize a new one each
+  // time. Other deflate streams are owned by the codec.
+  contexts::Zlib_Deflate_Pool::Ref pooledDeflateStream_{
+      contexts::getNULL_Zlib_Deflate()};
   Optional<z_stream> deflateStream_{};
-  Optional<z_stream> inflateStream_{};
+  contexts::Zlib_Inflate_Pool::Ref inflateStream_{
+      contexts::getNULL_Zlib_Inflate()};
   int level_;
   bool needReset_{true};
 };
@@ -244,17 +256,55 @@ ZlibStreamCodec::~ZlibStreamCodec() {
     deflateEnd(deflateStream_.get_pointer());
     deflateStream_.reset();
   }
-  if (inflateStream_) {
-    inflateEnd(inflateStream_.get_pointer());
-    inflateStream_.reset();
-  }
 }
 
 void ZlibStreamCodec::doResetStream() {
   needReset_ = true;
+  releaseStreams();
+}
+
+void ZlibStreamCodec::releaseStreams() {
+  pooledDeflateStream_.reset();
+  inflateStream_.reset();
+}
+
+bool ZlibStreamCodec::canPoolDeflateStream() const {
+  // Older versions of deflateParams() try to flush a reset stream when the
+  // parameters change.
+#if ZLIB_VERNUM >= 0x12c0
+  return options_.memLevel == 8 && options_.windowSize == 15;
+#else
+  return false;
+#endif
+}
+
+z_stream* ZlibStreamCodec::deflateStream() {
+  return pooledDeflateStream_ ? pooledDeflateStream_.get()
+                              : deflateStream_.get_pointer();
 }
 
 void ZlibStreamCodec::resetDeflateStream() {
+  // The automatic header detection format is only for inflation.
+  // Use zlib for deflation if the format is auto.
+  int const windowBits = getWindowBits(
+      options_.format == Options::Format::AUTO
+          ? Options::Format::ZLIB
+          : options_.format,
+      options_.windowSize);
+
+  if (canPoolDeflateStream()) {
+    if (!pooledDeflateStream_) {
+      pooledDeflateStream_ = contexts::getZlib_Deflate(windowBits);
+    }
+    int const rc = deflateParams(
+        pooledDeflateStream_.get(), level_, options_.strategy);
+    if (rc != Z_OK) {
+      pooledDeflateStream_.reset();
+      throw std::runtime_error(
+          to<std::string>("ZlibStreamCodec: deflateParams error: ", rc));
+    }
+    return;
+  }
   if (deflateStream_) {
     int const rc = deflateReset(deflateStream_.get_pointer());
     if (rc != Z_OK) {
@@ -266,14 +316,6 @@ void ZlibStreamCodec::resetDeflateStream() {
   }
   deflateStream_ = z_stream{};
 
-  // The automatic header detection format is only for inflation.
-  // Use zlib for deflation if the format is auto.
-  int const windowBits = getWindowBits(
-      options_.format == Options::Format::AUTO
-          ? Options::Format::ZLIB
-          : options_.format,
-      options_.windowSize);
-
   int const rc = deflateInit2(
       deflateStream_.get_pointer(),
       level_,
@@ -289,23 +331,18 @@ void ZlibStreamCodec::resetDeflateStream() {
 }
 
 void ZlibStreamCodec::resetInflateStream() {
-  if (inflateStream_) {
-    int const rc = inflateReset(inflateStream_.get_pointer());
-    if (rc != Z_OK) {
-      inflateStream_.reset();
-      throw std::runtime_error(
-          to<std::string>("ZlibStreamCodec: inflateReset error: ", rc));
-    }
-    return;
+  if (!inflateStream_) {
+    inflateStream_ = contexts::getZlib_Inflate();
   }
-  inflateStream_ = z_stream{};
-  int const rc = inflateInit2(
-      inflateStream_.get_pointer(),
+  // Pooled streams are reset already, this only selects the format and
+  // window size.
+  int const rc = inflateReset2(
+      inflateStream_.get(),
       getWindowBits(options_.format, options_.windowSize));
   if (rc != Z_OK) {
     inflateStream_.reset();
     throw std::runtime_error(
-        to<std::string>("ZlibStreamCodec: inflateInit error: ", rc));
+        to<std::string>("ZlibStreamCodec: inflateReset error: ", rc));
   }
 }
 
@@ -336,7 +373,7 @@ int zlibThrowOnError(int rc) {
 bool ZlibStreamCodec::doCompressStream(
     ByteRange& input, MutableByteRange& output, StreamCodec::FlushOp flush) {
   // Zlib uses uint32_t for sizes, so we can't compress more than 4GB at a time
-  return detail::chunkedStream(
+  bool const done = detail::chunkedStream(
       detail::kDefaultChunkSizeFor32BitSizes,
       input,
       output,
@@ -346,42 +383,47 @@ bool ZlibStreamCodec::doCompressStream(
           resetDeflateStream();
           needReset_ = false;
         }
-        DCHECK(deflateStream_.has_value());
+        auto const stream = deflateStream();
+        DCHECK(stream != nullptr);
         // zlib will return Z_STREAM_ERROR if output.data() is null.
         if (output.data() == nullptr) {
           return false;
         }
-        deflateStream_->next_in = const_cast<uint8_t*>(input.data());
-        deflateStream_->avail_in = to_narrow(input.size());
-        deflateStream_->next_out = output.data();
-        deflateStream_->avail_out = to_narrow(output.size());
-        DCHECK_EQ(deflateStream_->avail_in, input.size());
-        DCHECK_EQ(deflateStream_->avail_out, output.size());
+        stream->next_in = const_cast<uint8_t*>(input.data());
+        stream->avail_in = to_narrow(input.size());
+        stream->next_out = output.data();
+        stream->avail_out = to_narrow(output.size());
+        DCHECK_EQ(stream->avail_in, input.size());
+        DCHECK_EQ(stream->avail_out, output.size());
         SCOPE_EXIT {
-          input.uncheckedAdvance(input.size() - deflateStream_->avail_in);
-          output.uncheckedAdvance(output.size() - deflateStream_->avail_out);
+          input.uncheckedAdvance(input.size() - stream->avail_in);
+          output.uncheckedAdvance(output.size() - stream->avail_out);
         };
         int const rc = zlibThrowOnError(
-            deflate(deflateStream_.get_pointer(), zlibTranslateFlush(flush)));
+            deflate(stream, zlibTranslateFlush(flush)));
         switch (flush) {
           case StreamCodec::FlushOp::NONE:
             return false;
           case StreamCodec::FlushOp::FLUSH:
-            return deflateStream_->avail_in == 0 &&
-                deflateStream_->avail_out != 0;
+            return stream->avail_in == 0 && stream->avail_out != 0;
           case StreamCodec::FlushOp::END:
             return rc == Z_STREAM_END;
           default:
             throw std::invalid_argument("ZlibStreamCodec: Invalid flush");
         }
       });
+  if (done && flush == StreamCodec::FlushOp::END) {
+    // The stream must be reset before it is used again.
+    releaseStreams();
+  }
+  return done;
 }
 
 bool ZlibStreamCodec::doUncompressStream(
     ByteRange& input, MutableByteRange& output, StreamCodec::FlushOp flush) {
   // Zlib uses uint32_t for sizes, so we can't uncompress more than 4GB at a
   // time.
-  return detail::chunkedStream(
+  bool const done = detail::chunkedStream(
       detail::kDefaultChunkSizeFor32BitSizes,
       input,
       output,
@@ -391,25 +433,30 @@ bool ZlibStreamCodec::doUncompressStream(
           resetInflateStream();
           needReset_ = false;
         }
-        DCHECK(inflateStream_.has_value());
+        auto const stream = inflateStream();
+        DCHECK(stream != nullptr);
         // zlib will return Z_STREAM_ERROR if output.data() is null.
         if (output.data() == nullptr) {
           return false;
         }
-        inflateStream_->next_in = const_cast<uint8_t*>(input.data());
-        inflateStream_->avail_in = to_narrow(input.size());
-        inflateStream_->next_out = output.data();
-        inflateStream_->avail_out = to_narrow(output.size());
-        DCHECK_EQ(inflateStream_->avail_in, input.size());
-        DCHECK_EQ(inflateStream_->avail_out, output.size());
+        stream->next_in = const_cast<uint8_t*>(input.data());
+        stream->avail_in = to_narrow(input.size());
+        stream->next_out = output.data();
+        stream->avail_out = to_narrow(output.size());
+        DCHECK_EQ(stream->avail_in, input.size());
+        DCHECK_EQ(stream->avail_out, output.size());
         SCOPE_EXIT {
-          input.advance(input.size() - inflateStream_->avail_in);
-          output.advance(output.size() - inflateStream_->avail_out);
+          input.advance(input.size() - stream->avail_in);
+          output.advance(output.size() - stream->avail_out);
         };
         int const rc = zlibThrowOnError(
-            inflate(inflateStream_.get_pointer(), zlibTranslateFlush(flush)));
+            inflate(stream, zlibTranslateFlush(flush)));
         return rc == Z_STREAM_END;
       });
+  if (done) {
+    releaseStreams();
+  }
+  return done;
 }
 
 } // namespace
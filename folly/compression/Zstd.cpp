@@ -20,7 +20,9 @@
 
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
+#include <zdict.h>
 #include <zstd.h>
 
 #include <folly/Conv.h>
@@ -89,11 +91,16 @@ class ZSTDStreamCodec final : public StreamCodec {
       StreamCodec::FlushOp flushOp) override;
 
   void resetCCtx();
-  void resetDCtx();
+  void resetDCtx(ByteRange input);
 
   Options options_;
+  // Digested once, so that compressing small inputs doesn't pay for it.
+  ZSTD_CDict const* cdict_{nullptr};
   ZSTD_CCtx_Pool::Ref cctx_{getNULL_ZSTD_CCtx()};
   ZSTD_DCtx_Pool::Ref dctx_{getNULL_ZSTD_DCtx()};
+  // Keeps the dictionary that dctx_ references alive when it comes from the
+  // cache rather than from options_.
+  std::shared_ptr<Dictionary const> dctxDictionary_;
 };
 
 constexpr uint32_t kZSTDMagicLE = 0xFD2FB528;
@@ -115,7 +122,11 @@ CodecType codecType(Options const& options) {
 
 ZSTDStreamCodec::ZSTDStreamCodec(Options options)
     : StreamCodec(codecType(options), options.level()),
-      options_(std::move(options)) {}
+      options_(std::move(options)) {
+  if (options_.dictionary()) {
+    cdict_ = options_.dictionary()->cdict(options_.level());
+  }
+}
 
 bool ZSTDStreamCodec::doNeedsUncompressedLength() const {
   return false;
@@ -144,6 +155,7 @@ Optional<uint64_t> ZSTDStreamCodec::doGetUncompressedLength(
 void ZSTDStreamCodec::doResetStream() {
   cctx_.reset(nullptr);
   dctx_.reset(nullptr);
+  dctxDictionary_.reset();
 }
 
 void ZSTDStreamCodec::resetCCtx() {
@@ -152,6 +164,9 @@ void ZSTDStreamCodec::resetCCtx() {
   DCHECK(cctx_ != nullptr);
   zstdThrowIfError(
       ZSTD_CCtx_setParametersUsingCCtxParams(cctx_.get(), options_.params()));
+  if (cdict_ != nullptr) {
+    zstdThrowIfError(ZSTD_CCtx_refCDict(cctx_.get(), cdict_));
+  }
   zstdThrowIfError(ZSTD_CCtx_setPledgedSrcSize(
       cctx_.get(), uncompressedLength().value_or(ZSTD_CONTENTSIZE_UNKNOWN)));
 }
@@ -185,7 +200,7 @@ bool ZSTDStreamCodec::doCompressStream(
   }
 }
 
-void ZSTDStreamCodec::resetDCtx() {
+void ZSTDStreamCodec::resetDCtx(ByteRange input) {
   DCHECK(dctx_ == nullptr);
   dctx_ = getZSTD_DCtx(); // Gives us a clean context
   DCHECK(dctx_ != nullptr);
@@ -193,12 +208,24 @@ void ZSTDStreamCodec::resetDCtx() {
     zstdThrowIfError(
         ZSTD_DCtx_setMaxWindowSize(dctx_.get(), options_.maxWindowSize()));
   }
+  auto dictionary = options_.dictionary().get();
+  // Returns 0 if the frame header isn't in input.
+  auto const id = ZSTD_getDictID_fromFrame(input.data(), input.size());
+  if (id != 0 && (dictionary == nullptr || dictionary->id() != id)) {
+    dctxDictionary_ = getDictionary(id);
+    if (dctxDictionary_ != nullptr) {
+      dictionary = dctxDictionary_.get();
+    }
+  }
+  if (dictionary != nullptr) {
+    zstdThrowIfError(ZSTD_DCtx_refDDict(dctx_.get(), dictionary->ddict()));
+  }
 }
 
 bool ZSTDStreamCodec::doUncompressStream(
     ByteRange& input, MutableByteRange& output, StreamCodec::FlushOp) {
   if (dctx_ == nullptr) {
-    resetDCtx();
+    resetDCtx(input);
   }
   ZSTD_inBuffer in = {input.data(), input.size(), 0};
   ZSTD_outBuffer out = {output.data(), output.size(), 0};
@@ -215,8 +242,92 @@ bool ZSTDStreamCodec::doUncompressStream(
   return rc == 0;
 }
 
+struct DictionaryCache {
+  std::mutex mutex;
+  std::unordered_map<uint32_t, std::shared_ptr<Dictionary const>> map;
+};
+
+DictionaryCache& dictionaryCache() {
+  static auto& cache = *new DictionaryCache();
+  return cache;
+}
+
 } // namespace
 
+Dictionary::Dictionary(std::string data)
+    : data_(std::move(data)),
+      id_(ZSTD_getDictID_fromDict(data_.data(), data_.size())),
+      ddict_(ZSTD_createDDict_byReference(data_.data(), data_.size())) {
+  if (ddict_ == nullptr) {
+    throw std::runtime_error("ZSTD: failed to create the DDict");
+  }
+}
+
+ZSTD_CDict const* Dictionary::cdict(int level) const {
+  std::lock_guard<std::mutex> lock(cdictsMutex_);
+  for (auto const& entry : cdicts_) {
+    if (entry.first == level) {
+      return entry.second.get();
+    }
+  }
+  CDictPtr cdict(
+      ZSTD_createCDict_byReference(data_.data(), data_.size(), level));
+  if (cdict == nullptr) {
+    throw std::runtime_error("ZSTD: failed to create the CDict");
+  }
+  cdicts_.emplace_back(level, std::move(cdict));
+  return cdicts_.back().second.get();
+}
+
+/* static */ void Dictionary::freeCDict(ZSTD_CDict* cdict) {
+  ZSTD_freeCDict(cdict);
+}
+
+/* static */ void Dictionary::freeDDict(ZSTD_DDict* ddict) {
+  ZSTD_freeDDict(ddict);
+}
+
+std::string trainDictionary(
+    std::vector<ByteRange> const& samples, size_t maxSize) {
+  std::string buffer;
+  std::vector<size_t> sizes;
+  sizes.reserve(samples.size());
+  for (auto const& sample : samples) {
+    buffer.append(reinterpret_cast<char const*>(sample.data()), sample.size());
+    sizes.push_back(sample.size());
+  }
+  std::string dictionary(maxSize, '\0');
+  size_t const rc = ZDICT_trainFromBuffer(
+      &dictionary[0],
+      dictionary.size(),
+      buffer.data(),
+      sizes.data(),
+      to_narrow(sizes.size()));
+  if (ZDICT_isError(rc)) {
+    throw std::runtime_error(to<std::string>(
+        "ZSTD: dictionary training failed: ", ZDICT_getErrorName(rc)));
+  }
+  dictionary.resize(rc);
+  return dictionary;
+}
+
+void addDictionary(std::shared_ptr<Dictionary const> dictionary) {
+  if (dictionary == nullptr || dictionary->id() == 0) {
+    throw std::invalid_argument("ZSTD: only dictionaries with ids are cached");
+  }
+  auto& cache = dictionaryCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto const id = dictionary->id();
+  cache.map[id] = std::move(dictionary);
+}
+
+std::shared_ptr<Dictionary const> getDictionary(uint32_t id) {
+  auto& cache = dictionaryCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto it = cache.map.find(id);
+  return it == cache.map.end() ? nullptr : it->second;
+}
+
 Options::Options(int level) : params_(ZSTD_createCCtxParams()), level_(level) {
   if (params_ == nullptr) {
     throw std::bad_alloc{};
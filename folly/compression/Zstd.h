@@ -18,8 +18,16 @@
 
 #include <memory.h>
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <folly/Memory.h>
 #include <folly/Portability.h>
+#include <folly/Range.h>
 #include <folly/compression/Compression.h>
 
 #if FOLLY_HAVE_LIBZSTD
@@ -33,6 +41,83 @@ namespace folly {
 namespace compression {
 namespace zstd {
 
+/**
+ * A zstd dictionary, digested once and shared by all the codecs that use it.
+ *
+ * Dictionaries help the most with small inputs, such as RPC payloads of a
+ * few hundred bytes, that have little redundancy of their own but a lot in
+ * common with each other. Train one with trainDictionary() on samples of
+ * such inputs, ship it to both sides, and pass it to Options::setDictionary().
+ * Data compressed with a dictionary can only be uncompressed with the same
+ * dictionary.
+ */
+class Dictionary {
+ public:
+  /**
+   * Digest `data`, either a dictionary made by trainDictionary() (or the zstd
+   * CLI), or any content, which is then used as a raw dictionary.
+   *
+   * @throws std::runtime_error if zstd fails to digest the dictionary.
+   */
+  explicit Dictionary(std::string data);
+
+  /// The dictionary id, which is written to the frames it compresses, or 0
+  /// for raw dictionaries.
+  uint32_t id() const { return id_; }
+
+  /// The dictionary content.
+  ByteRange data() const { return StringPiece(data_); }
+
+  /// The dictionary digested for decompression.
+  ZSTD_DDict const* ddict() const { return ddict_.get(); }
+
+  /**
+   * The dictionary digested for compression at `level`, which is the level
+   * frames are compressed with. Digested the first time each level is
+   * requested.
+   */
+  ZSTD_CDict const* cdict(int level) const;
+
+ private:
+  static void freeCDict(ZSTD_CDict* cdict);
+  static void freeDDict(ZSTD_DDict* ddict);
+  using CDictPtr = std::unique_ptr<
+      ZSTD_CDict,
+      folly::static_function_deleter<ZSTD_CDict, &freeCDict>>;
+
+  std::string data_;
+  uint32_t id_;
+  std::unique_ptr<
+      ZSTD_DDict,
+      folly::static_function_deleter<ZSTD_DDict, &freeDDict>>
+      ddict_;
+  mutable std::mutex cdictsMutex_;
+  mutable std::vector<std::pair<int, CDictPtr>> cdicts_;
+};
+
+/**
+ * Train a dictionary of at most `maxSize` bytes on `samples`. A few thousand
+ * samples and a maxSize of 16-128KB are typical; training needs about 100
+ * times more sample bytes than maxSize to work well.
+ *
+ * @throws std::runtime_error if training fails, e.g. there are too few
+ * samples.
+ */
+std::string trainDictionary(
+    std::vector<ByteRange> const& samples, size_t maxSize);
+
+/**
+ * Add `dictionary` to the process-wide cache, replacing the dictionary with
+ * the same id. Codecs uncompress frames that need a dictionary other than the
+ * one in their Options with the cached dictionary of that id.
+ *
+ * @throws std::invalid_argument for raw dictionaries, which have no id.
+ */
+void addDictionary(std::shared_ptr<Dictionary const> dictionary);
+
+/// Get the dictionary with the given id from the process-wide cache, or null.
+std::shared_ptr<Dictionary const> getDictionary(uint32_t id);
+
 /**
  * Interface for zstd-specific codec initialization.
  */
@@ -61,6 +146,15 @@ class Options {
     maxWindowSize_ = maxWindowSize;
   }
 
+  /**
+   * Compress and uncompress with `dictionary`. Compression uses the
+   * dictionary digested for level(), whose compression parameters may take
+   * precedence over some of those set with set().
+   */
+  void setDictionary(std::shared_ptr<Dictionary const> dictionary) {
+    dictionary_ = std::move(dictionary);
+  }
+
   /// Get a reference to the ZSTD_CCtx_params.
   ZSTD_CCtx_params const* params() const { return params_.get(); }
 
@@ -70,6 +164,11 @@ class Options {
   /// Get the maximum window size.
   size_t maxWindowSize() const { return maxWindowSize_; }
 
+  /// Get the dictionary, or null if there is none.
+  std::shared_ptr<Dictionary const> const& dictionary() const {
+    return dictionary_;
+  }
+
  private:
   static void freeCCtxParams(ZSTD_CCtx_params* params);
   std::unique_ptr<
@@ -77,6 +176,7 @@ class Options {
       folly::static_function_deleter<ZSTD_CCtx_params, &freeCCtxParams>>
       params_;
   size_t maxWindowSize_{0};
+  std::shared_ptr<Dictionary const> dictionary_;
   int level_;
 };
 
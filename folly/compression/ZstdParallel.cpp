@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/ZstdParallel.h>
+
+#if FOLLY_HAVE_LIBZSTD
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/compression/CompressionContextPoolSingletons.h>
+#include <folly/io/Cursor.h>
+#include <folly/synchronization/Latch.h>
+
+namespace folly {
+namespace compression {
+namespace zstd {
+namespace {
+
+// The zstd seekable format: the seek table is a skippable frame with this
+// magic, holding an entry per frame followed by the footer.
+constexpr uint32_t kSeekTableMagic = 0x184D2A5E;
+constexpr uint32_t kSeekableMagic = 0x8F92EAB1;
+constexpr size_t kSkippableHeaderSize = 8;
+constexpr size_t kFooterSize = 9;
+constexpr size_t kEntrySize = 8;
+constexpr size_t kChecksumSize = 4;
+constexpr uint8_t kChecksumFlag = 0x80;
+constexpr uint8_t kReservedBits = 0x7C;
+// Keeps the compressed size of each frame in the 32 bits of its entry.
+constexpr size_t kMaxFrameSize = size_t(1) << 30;
+
+size_t zstdThrowIfError(size_t rc) {
+  if (!ZSTD_isError(rc)) {
+    return rc;
+  }
+  throw std::runtime_error(
+      to<std::string>("ZSTD returned an error: ", ZSTD_getErrorName(rc)));
+}
+
+// Calls f(i) for i in [0, n) on executor, and waits for all of them. Rethrows
+// the first exception.
+template <typename F>
+void forEachParallel(Executor& executor, size_t n, F f) {
+  std::vector<std::exception_ptr> errors(n);
+  Latch latch(static_cast<ptrdiff_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    try {
+      executor.add([&, i] {
+        try {
+          f(i);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+        latch.count_down();
+      });
+    } catch (...) {
+      // The tasks that were added still refer to the locals.
+      latch.count_down(static_cast<ptrdiff_t>(n - i));
+      latch.wait();
+      throw;
+    }
+  }
+  latch.wait();
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+std::unique_ptr<IOBuf> compressFrame(
+    std::vector<ByteRange> const& pieces,
+    Options const& options,
+    ZSTD_CDict const* cdict) {
+  size_t size = 0;
+  for (auto piece : pieces) {
+    size += piece.size();
+  }
+  auto out = IOBuf::create(ZSTD_compressBound(size));
+  auto cctx = contexts::getZSTD_CCtx();
+  zstdThrowIfError(
+      ZSTD_CCtx_setParametersUsingCCtxParams(cctx.get(), options.params()));
+  if (cdict != nullptr) {
+    zstdThrowIfError(ZSTD_CCtx_refCDict(cctx.get(), cdict));
+  }
+  zstdThrowIfError(ZSTD_CCtx_setPledgedSrcSize(cctx.get(), size));
+
+  ZSTD_outBuffer output = {out->writableTail(), out->tailroom(), 0};
+  size_t i = 0;
+  do {
+    // An empty frame has no pieces.
+    auto const piece = i < pieces.size() ? pieces[i] : ByteRange();
+    bool const last = i + 1 >= pieces.size();
+    ZSTD_inBuffer input = {piece.data(), piece.size(), 0};
+    size_t rc;
+    // The output never fills up, so this only loops until all the input is
+    // consumed, or the frame is over.
+    do {
+      rc = zstdThrowIfError(ZSTD_compressStream2(
+          cctx.get(), &output, &input, last ? ZSTD_e_end : ZSTD_e_continue));
+    } while (last ? rc != 0 : input.pos != input.size);
+  } while (++i < pieces.size());
+  out->append(output.pos);
+  return out;
+}
+
+// The dictionary to uncompress the frame at `src` with, if any. Frames
+// compressed with raw dictionaries don't name them.
+Dictionary const* frameDictionary(
+    ByteRange src,
+    std::shared_ptr<Dictionary const> const& dictionary,
+    std::shared_ptr<Dictionary const>& cached) {
+  auto const id = ZSTD_getDictID_fromFrame(src.data(), src.size());
+  if (id == 0 || (dictionary != nullptr && dictionary->id() == id)) {
+    return dictionary.get();
+  }
+  // zstd reports the mismatch if there is none.
+  cached = getDictionary(id);
+  return cached.get();
+}
+
+} // namespace
+
+std::unique_ptr<IOBuf> compressParallel(
+    IOBuf const& data,
+    Options const& options,
+    Executor& executor,
+    size_t frameSize) {
+  if (frameSize == 0 || frameSize > kMaxFrameSize) {
+    throw std::invalid_argument(
+        to<std::string>("ZSTD: invalid frame size: ", frameSize));
+  }
+
+  // Split the chain into frames of frameSize bytes, each made of the ranges
+  // of the IOBufs that it spans. Empty inputs get an empty frame.
+  std::vector<std::vector<ByteRange>> frames(1);
+  size_t frameLength = 0;
+  for (auto range : data) {
+    while (!range.empty()) {
+      if (frameLength == frameSize) {
+        frames.emplace_back();
+        frameLength = 0;
+      }
+      auto const n = std::min(range.size(), frameSize - frameLength);
+      frames.back().push_back(range.subpiece(0, n));
+      range.advance(n);
+      frameLength += n;
+    }
+  }
+
+  auto const cdict = options.dictionary()
+      ? options.dictionary()->cdict(options.level())
+      : nullptr;
+  std::vector<std::unique_ptr<IOBuf>> compressed(frames.size());
+  forEachParallel(executor, frames.size(), [&](size_t i) {
+    compressed[i] = compressFrame(frames[i], options, cdict);
+  });
+
+  size_t const tableSize = frames.size() * kEntrySize + kFooterSize;
+  auto table = IOBuf::create(kSkippableHeaderSize + tableSize);
+  io::Appender appender(table.get(), 0);
+  appender.writeLE<uint32_t>(kSeekTableMagic);
+  appender.writeLE<uint32_t>(to_narrow(tableSize));
+  for (size_t i = 0; i < frames.size(); ++i) {
+    size_t uncompressedSize = 0;
+    for (auto piece : frames[i]) {
+      uncompressedSize += piece.size();
+    }
+    appender.writeLE<uint32_t>(to_narrow(compressed[i]->length()));
+    appender.writeLE<uint32_t>(to_narrow(uncompressedSize));
+  }
+  appender.writeLE<uint32_t>(to_narrow(frames.size()));
+  appender.writeLE<uint8_t>(0); // No checksums
+  appender.writeLE<uint32_t>(kSeekableMagic);
+
+  auto out = std::move(compressed[0]);
+  for (size_t i = 1; i < compressed.size(); ++i) {
+    out->appendToChain(std::move(compressed[i]));
+  }
+  out->appendToChain(std::move(table));
+  return out;
+}
+
+std::unique_ptr<IOBuf> uncompressParallel(
+    IOBuf const& data,
+    Executor& executor,
+    std::shared_ptr<Dictionary const> dictionary) {
+  auto const length = data.computeChainDataLength();
+  if (length < kSkippableHeaderSize + kFooterSize) {
+    throw std::invalid_argument("ZSTD: no seek table");
+  }
+  io::Cursor footer(&data);
+  footer.skip(length - kFooterSize);
+  size_t const numFrames = footer.readLE<uint32_t>();
+  auto const descriptor = footer.read<uint8_t>();
+  if (footer.readLE<uint32_t>() != kSeekableMagic ||
+      (descriptor & kReservedBits) != 0) {
+    throw std::invalid_argument("ZSTD: no seek table");
+  }
+  size_t const entrySize =
+      kEntrySize + ((descriptor & kChecksumFlag) ? kChecksumSize : 0);
+  size_t const tableSize = numFrames * entrySize + kFooterSize;
+  if (length - kSkippableHeaderSize < tableSize) {
+    throw std::invalid_argument("ZSTD: invalid seek table");
+  }
+  size_t const framesLength = length - kSkippableHeaderSize - tableSize;
+  io::Cursor table(&data);
+  table.skip(framesLength);
+  if (table.readLE<uint32_t>() != kSeekTableMagic ||
+      table.readLE<uint32_t>() != tableSize) {
+    throw std::invalid_argument("ZSTD: invalid seek table");
+  }
+
+  // Offsets of each frame in data and in the output, and the total sizes at
+  // the end.
+  std::vector<size_t> offsets(numFrames + 1);
+  std::vector<size_t> outOffsets(numFrames + 1);
+  for (size_t i = 0; i < numFrames; ++i) {
+    offsets[i + 1] = offsets[i] + table.readLE<uint32_t>();
+    outOffsets[i + 1] = outOffsets[i] + table.readLE<uint32_t>();
+    table.skip(entrySize - kEntrySize);
+  }
+  if (offsets[numFrames] != framesLength) {
+    throw std::invalid_argument("ZSTD: invalid seek table");
+  }
+
+  auto out = IOBuf::create(outOffsets[numFrames]);
+  out->append(outOffsets[numFrames]);
+  forEachParallel(executor, numFrames, [&](size_t i) {
+    size_t const size = offsets[i + 1] - offsets[i];
+    io::Cursor cursor(&data);
+    cursor.skip(offsets[i]);
+    IOBuf coalesced;
+    ByteRange src = cursor.peekBytes();
+    if (src.size() >= size) {
+      src = src.subpiece(0, size);
+    } else {
+      // The frame spans several IOBufs.
+      cursor.clone(coalesced, size);
+      src = coalesced.coalesce();
+    }
+
+    auto dctx = contexts::getZSTD_DCtx();
+    std::shared_ptr<Dictionary const> cached;
+    if (auto frameDict = frameDictionary(src, dictionary, cached)) {
+      zstdThrowIfError(ZSTD_DCtx_refDDict(dctx.get(), frameDict->ddict()));
+    }
+    size_t const outSize = outOffsets[i + 1] - outOffsets[i];
+    size_t const rc = zstdThrowIfError(ZSTD_decompressDCtx(
+        dctx.get(),
+        out->writableData() + outOffsets[i],
+        outSize,
+        src.data(),
+        src.size()));
+    if (rc != outSize) {
+      throw std::runtime_error("ZSTD: frame size doesn't match the seek table");
+    }
+  });
+  return out;
+}
+
+} // namespace zstd
+} // namespace compression
+} // namespace folly
+
+#endif
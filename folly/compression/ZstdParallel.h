@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <folly/Executor.h>
+#include <folly/compression/Zstd.h>
+#include <folly/io/IOBuf.h>
+
+#if FOLLY_HAVE_LIBZSTD
+
+namespace folly {
+namespace compression {
+namespace zstd {
+
+/**
+ * Parallel compression of large inputs, such as snapshots of hundreds of MB,
+ * which the zstd Codec compresses serially on the calling thread.
+ *
+ * The input is split into independent frames of frameSize bytes, which are
+ * compressed on the executor, and followed by a seek table in the zstd
+ * seekable format (contrib/seekable_format in the zstd repository):
+ *
+ *   [frame 0]...[frame n - 1][skippable frame: sizes of each frame]
+ *
+ * so uncompressParallel() can uncompress the frames on an executor as well,
+ * and readers can find the frame that holds a given offset. Any zstd decoder
+ * that accepts concatenated frames, like the zstd CLI, also reads it. The
+ * folly Codec does not, since it stops at the end of the first frame.
+ *
+ * Each frame compresses less well than the whole input would, since it can't
+ * refer to the data of other frames; frames of a few MB lose little.
+ */
+constexpr size_t kDefaultParallelFrameSize = size_t(4) << 20;
+
+/**
+ * Compress data as described above, with the parameters and dictionary in
+ * options. Blocks until all the frames are compressed.
+ *
+ * @throws std::invalid_argument if frameSize is 0 or more than 1GB.
+ */
+std::unique_ptr<IOBuf> compressParallel(
+    IOBuf const& data,
+    Options const& options,
+    Executor& executor,
+    size_t frameSize = kDefaultParallelFrameSize);
+
+/**
+ * Uncompress the output of compressParallel() into a single buffer,
+ * uncompressing the frames on executor. Frames compressed with a dictionary
+ * use `dictionary` if its id matches, or else the cached dictionary of their
+ * id (see addDictionary()). Blocks until all the frames are uncompressed.
+ *
+ * @throws std::invalid_argument if data doesn't end with a valid seek table.
+ * @throws std::runtime_error if a frame is corrupted.
+ */
+std::unique_ptr<IOBuf> uncompressParallel(
+    IOBuf const& data,
+    Executor& executor,
+    std::shared_ptr<Dictionary const> dictionary = nullptr);
+
+} // namespace zstd
+} // namespace compression
+} // namespace folly
+
+#endif
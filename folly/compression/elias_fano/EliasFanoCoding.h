@@ -441,6 +441,42 @@ class UpperBitsReader
     return setValue(inner);
   }
 
+  // Equivalent to calling next() n times and calling f(i, value()) after
+  // the i-th call. Requires 0 < n and position() + n < size().
+  template <class F>
+  FOLLY_ALWAYS_INLINE void nextBatch(SizeType n, F&& f) {
+    DCHECK_GT(n, 0);
+    DCHECK_LT(addT(position(), n), size());
+
+    // Work on copies so that the state stays in registers across the calls.
+    auto block = block_;
+    auto outer = outer_;
+    auto position = position_;
+    ValueType value = 0;
+    for (SizeType i = 0; i < n;) {
+      while (FOLLY_UNLIKELY(block == 0)) {
+        outer += sizeof(block_t);
+        block = loadUnaligned<block_t>(start_ + outer);
+      }
+      // All the 1-bits of the block that are needed, without checking i.
+      const SizeType m = std::min<SizeType>(
+          static_cast<SizeType>(Instructions::popcount(block)), n - i);
+      const auto base = 8 * outer - position - 1;
+      for (SizeType j = 0; j < m; ++j) {
+        size_t inner = Instructions::ctz(block);
+        block = Instructions::blsr(block);
+        value = static_cast<ValueType>(base + inner - j);
+        f(i + j, value);
+      }
+      i += m;
+      position += m;
+    }
+    block_ = block;
+    outer_ = outer;
+    position_ = position;
+    value_ = value;
+  }
+
   FOLLY_ALWAYS_INLINE bool skip(SizeType n) {
     DCHECK_GT(n, 0);
     if (!kUnchecked && FOLLY_UNLIKELY(addT(position_, n) >= size())) {
@@ -712,6 +748,38 @@ class EliasFanoReader {
     return false;
   }
 
+  /**
+   * Reads up to n of the elements following the current position into out and
+   * returns how many were read. Same as calling next() n times and collecting
+   * value() while it returns true, but the bounds are checked once and the
+   * state of the reader stays in registers for the whole batch. If fewer than
+   * n elements remain, the reader ends up past the end of the list like next()
+   * would.
+   */
+  size_t nextBatch(ValueType* out, size_t n) {
+    const SizeType begin = detail::addT(position(), 1);
+    const size_t count =
+        begin < size() ? std::min<size_t>(n, size() - begin) : 0;
+    if (count > 0) {
+      const size_t numLowerBits = numLowerBits_;
+      assume(numLowerBits < sizeof(ValueType) * 8);
+      upper_.nextBatch(
+          static_cast<SizeType>(count), [&](size_t i, ValueType upper) {
+            // Same as readLowerPart(begin + i).
+            const size_t pos = (begin + i) * numLowerBits;
+            const uint64_t ptrv = loadUnaligned<uint64_t>(lower_ + pos / 8);
+            out[i] = static_cast<ValueType>(
+                         Instructions::bextr(ptrv, pos % 8, numLowerBits)) |
+                (upper << numLowerBits);
+          });
+      setValue(out[count - 1]);
+    }
+    if (count < n) {
+      upper_.next();
+    }
+    return count;
+  }
+
   /**
    * Advances by n elements. n = 0 is allowed and has no effect. Returns false
    * if the end of the list is reached. position() + n must be representable by
@@ -886,5 +954,88 @@ class EliasFanoReader {
   const uint8_t numLowerBits_;
 };
 
+/**
+ * Writes the values that occur in both lists to out in increasing order, and
+ * returns their number. A value that occurs several times in both lists is
+ * written as many times as it occurs in the list where it is less frequent.
+ * out must have room for a.size() values. Both readers must be newly
+ * constructed or reset(), and are left at unspecified positions.
+ *
+ * a is decoded in batches with nextBatch(). If b is much longer, it skips to
+ * each value of a with skipTo(); otherwise it is decoded in batches too and
+ * the two are merged without branches on the comparisons, skipping ahead
+ * whenever a batch of b is exhausted. Either way a should be the shorter
+ * list.
+ */
+template <class ReaderA, class ReaderB>
+size_t intersect(ReaderA& a, ReaderB& b, typename ReaderA::ValueType* out) {
+  constexpr size_t kBatchSize = 64;
+  // Beyond this ratio of sizes, skipTo() is cheaper than decoding b.
+  constexpr size_t kSkipRatio = 2;
+  DCHECK(!a.valid() && a.position() != a.size());
+  DCHECK(!b.valid() && b.position() != b.size());
+  typename ReaderA::ValueType batchA[kBatchSize];
+  size_t count = 0;
+
+  if (size_t(b.size()) >= kSkipRatio * a.size()) {
+    size_t n;
+    while ((n = a.nextBatch(batchA, kBatchSize)) > 0) {
+      for (size_t i = 0; i < n; ++i) {
+        const auto x = batchA[i];
+        if ((!b.valid() || b.value() < x) && !b.skipTo(x)) {
+          return count;
+        }
+        if (b.value() == x) {
+          out[count++] = x;
+          if (!b.next()) {
+            return count;
+          }
+        }
+      }
+    }
+    return count;
+  }
+
+  typename ReaderB::ValueType batchB[kBatchSize];
+  size_t sizeA = 0;
+  size_t sizeB = 0;
+  size_t i = 0;
+  size_t j = 0;
+  bool doneB = false;
+  while (true) {
+    if (i == sizeA) {
+      if ((sizeA = a.nextBatch(batchA, kBatchSize)) == 0) {
+        break;
+      }
+      i = 0;
+    }
+    if (j == sizeB) {
+      if (doneB) {
+        break;
+      }
+      // The values of b read so far are all <= batchA[i].
+      size_t k = 0;
+      if (!b.valid() || b.value() < batchA[i]) {
+        if (!b.skipTo(batchA[i])) {
+          break;
+        }
+        batchB[k++] = b.value();
+      }
+      sizeB = k + b.nextBatch(batchB + k, kBatchSize - k);
+      doneB = sizeB < kBatchSize;
+      j = 0;
+    }
+    while (i < sizeA && j < sizeB) {
+      const auto x = batchA[i];
+      const auto y = batchB[j];
+      out[count] = x;
+      count += x == y;
+      i += x <= y;
+      j += y <= x;
+    }
+  }
+  return count;
+}
+
 } // namespace compression
 } // namespace folly
@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <numeric>
 #include <random>
@@ -39,6 +40,38 @@ uint8_t slowDefaultNumLowerBits(size_t upperBound, size_t size) {
   return uint8_t(folly::findLastSet(upperBound / size) - 1);
 }
 
+template <class Reader, class List>
+void testNextBatch(const std::vector<uint64_t>& data, const List& list) {
+  for (size_t batchSize : {1, 3, 64, 1000}) {
+    SCOPED_TRACE(batchSize);
+    Reader reader(list);
+    std::vector<typename Reader::ValueType> batch(batchSize);
+    size_t i = 0;
+    while (true) {
+      auto n = reader.nextBatch(batch.data(), batchSize);
+      ASSERT_EQ(std::min(batchSize, data.size() - i), n);
+      for (size_t j = 0; j < n; ++j) {
+        ASSERT_EQ(data[i + j], batch[j]) << i + j;
+      }
+      i += n;
+      if (n < batchSize) {
+        break;
+      }
+      ASSERT_EQ(i - 1, reader.position());
+      ASSERT_EQ(data[i - 1], reader.value());
+      // Batches and single steps can be mixed.
+      if (i < data.size()) {
+        ASSERT_TRUE(reader.next());
+        ASSERT_EQ(data[i], reader.value());
+        ++i;
+      }
+    }
+    EXPECT_EQ(data.size(), i);
+    EXPECT_FALSE(reader.valid());
+    EXPECT_EQ(0, reader.nextBatch(batch.data(), batchSize));
+  }
+}
+
 } // namespace
 
 TEST(EliasFanoCoding, defaultNumLowerBits) {
@@ -207,6 +240,56 @@ TEST_F(EliasFanoCodingTest, SkipForwardPointersDense) {
   doTestDenseAll<128, 128>();
 }
 
+TEST_F(EliasFanoCodingTest, NextBatch) {
+  using Encoder = EliasFanoEncoder<uint32_t, uint32_t, 128, 128>;
+  using Reader = EliasFanoReader<Encoder, instructions::Default>;
+  for (auto data :
+       {std::vector<uint64_t>{0},
+        generateRandomList(100 * 1000, 10 * 1000 * 1000),
+        generateRandomList(
+            100 * 1000, 10 * 1000 * 1000, /* withDuplicates */ true),
+        generateSeqList(1, 100000, 100),
+        std::vector<uint64_t>{0, 1, std::numeric_limits<uint32_t>::max()}}) {
+    auto list = Encoder::encode(data.begin(), data.end());
+    testNextBatch<Reader>(data, list);
+    list.free();
+  }
+}
+
+TEST_F(EliasFanoCodingTest, Intersect) {
+  using Encoder = EliasFanoEncoder<uint32_t, uint32_t, 128, 128>;
+  using Reader = EliasFanoReader<Encoder, instructions::Default>;
+  auto check = [](const std::vector<uint64_t>& a,
+                  const std::vector<uint64_t>& b) {
+    std::vector<uint64_t> expected;
+    std::set_intersection(
+        a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    auto listA = Encoder::encode(a.begin(), a.end());
+    auto listB = Encoder::encode(b.begin(), b.end());
+    Reader readerA(listA);
+    Reader readerB(listB);
+    std::vector<uint32_t> out(a.size());
+    out.resize(intersect(readerA, readerB, out.data()));
+    EXPECT_EQ(expected, std::vector<uint64_t>(out.begin(), out.end()));
+    listA.free();
+    listB.free();
+  };
+
+  std::mt19937 gen;
+  auto dense = generateRandomList(100 * 1000, 1000 * 1000, gen);
+  auto sparse = generateRandomList(1000, 1000 * 1000, gen);
+  auto duplicates = generateRandomList(
+      10 * 1000, 1000 * 1000, gen, /* withDuplicates */ true);
+  check(sparse, dense);
+  check(dense, sparse);
+  check(dense, dense);
+  check(duplicates, dense);
+  check(dense, duplicates);
+  check(duplicates, duplicates);
+  check(sparse, {0});
+  check({1000 * 1000}, sparse);
+}
+
 TEST_F(EliasFanoCodingTest, BugLargeGapInUpperBits) { // t16274876
   typedef EliasFanoEncoder<uint32_t, uint32_t, 2, 2> Encoder;
   typedef EliasFanoReader<Encoder, instructions::Default> Reader;
@@ -245,11 +328,16 @@ std::vector<std::pair<size_t, size_t>> numLowerBitsInput;
 
 typename Encoder::MutableCompressedList list;
 
+std::vector<uint64_t> sparseData;
+typename Encoder::MutableCompressedList sparseList;
+
 void init() {
   std::mt19937 gen;
 
   data = generateRandomList(100 * 1000, 10 * 1000 * 1000, gen);
   list = Encoder::encode(data.begin(), data.end());
+  sparseData = generateRandomList(10 * 1000, 10 * 1000 * 1000, gen);
+  sparseList = Encoder::encode(sparseData.begin(), sparseData.end());
 
   order.resize(data.size());
   std::iota(order.begin(), order.end(), size_t());
@@ -268,6 +356,7 @@ void init() {
 
 void free() {
   list.free();
+  sparseList.free();
 }
 
 } // namespace bm
@@ -279,6 +368,26 @@ BENCHMARK(Next, iters) {
   });
 }
 
+BENCHMARK_RELATIVE(NextBatch, iters) {
+  dispatchInstructions([&](auto instructions) {
+    EliasFanoReader<bm::Encoder, decltype(instructions)> reader(bm::list);
+    uint32_t batch[64];
+    size_t size = 0;
+    size_t i = 0;
+    while (iters--) {
+      if (FOLLY_UNLIKELY(i == size)) {
+        size = reader.nextBatch(batch, 64);
+        i = 0;
+        if (size == 0) {
+          reader.reset();
+          continue;
+        }
+      }
+      folly::doNotOptimizeAway(batch[i++]);
+    }
+  });
+}
+
 size_t Skip_ForwardQ128(size_t iters, size_t logAvgSkip) {
   dispatchInstructions([&](auto instructions) {
     bmSkip<EliasFanoReader<bm::Encoder, decltype(instructions)>>(
@@ -329,6 +438,38 @@ BENCHMARK(JumpTo_SkipQ128, iters) {
 
 BENCHMARK_DRAW_LINE();
 
+BENCHMARK(Intersect_SkipTo, iters) {
+  dispatchInstructions([&](auto instructions) {
+    using Reader = EliasFanoReader<bm::Encoder, decltype(instructions)>;
+    while (iters--) {
+      Reader a(bm::sparseList);
+      Reader b(bm::list);
+      size_t count = 0;
+      while (a.next()) {
+        if ((!b.valid() || b.value() < a.value()) && !b.skipTo(a.value())) {
+          break;
+        }
+        count += b.value() == a.value();
+      }
+      folly::doNotOptimizeAway(count);
+    }
+  });
+}
+
+BENCHMARK_RELATIVE(Intersect, iters) {
+  dispatchInstructions([&](auto instructions) {
+    using Reader = EliasFanoReader<bm::Encoder, decltype(instructions)>;
+    std::vector<uint32_t> out(bm::sparseData.size());
+    while (iters--) {
+      Reader a(bm::sparseList);
+      Reader b(bm::list);
+      folly::doNotOptimizeAway(intersect(a, b, out.data()));
+    }
+  });
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK(Encode_10) {
   auto list = bm::Encoder::encode(
       bm::encodeSmallData.begin(), bm::encodeSmallData.end());
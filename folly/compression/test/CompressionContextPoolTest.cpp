@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <stdexcept>
 #include <thread>
 
 #include <folly/portability/GTest.h>
@@ -345,5 +346,54 @@ TEST(CompressionContextPoolSingletonsTest, testSingletonsNull) {
 
 #endif // FOLLY_COMPRESSION_HAS_ZSTD_CONTEXT_POOL_SINGLETONS
 
+#ifdef FOLLY_COMPRESSION_HAS_ZLIB_CONTEXT_POOL_SINGLETONS
+
+TEST(CompressionContextPoolSingletonsTest, testZlibSingletons) {
+  EXPECT_NE(contexts::getZlib_Deflate(15), nullptr);
+  EXPECT_NE(contexts::getZlib_Deflate(31), nullptr);
+  EXPECT_NE(contexts::getZlib_Deflate(-15), nullptr);
+  EXPECT_NE(contexts::getZlib_Inflate(), nullptr);
+  EXPECT_THROW(contexts::getZlib_Deflate(9), std::invalid_argument);
+}
+
+TEST(CompressionContextPoolSingletonsTest, testZlibSingletonsNull) {
+  EXPECT_EQ(contexts::getNULL_Zlib_Deflate(), nullptr);
+  EXPECT_EQ(contexts::getNULL_Zlib_Inflate(), nullptr);
+}
+
+TEST(CompressionContextPoolSingletonsTest, testZlibSingletonsReset) {
+  z_stream* stream;
+  {
+    auto ref = contexts::getZlib_Deflate(15);
+    stream = ref.get();
+    uint8_t in[] = "abc";
+    uint8_t out[64];
+    stream->next_in = in;
+    stream->avail_in = sizeof(in);
+    stream->next_out = out;
+    stream->avail_out = sizeof(out);
+    EXPECT_EQ(Z_STREAM_END, deflate(stream, Z_FINISH));
+  }
+  auto ref = contexts::getZlib_Deflate(15);
+  EXPECT_EQ(ref.get(), stream);
+  EXPECT_EQ(ref->total_in, 0);
+}
+
+#endif // FOLLY_COMPRESSION_HAS_ZLIB_CONTEXT_POOL_SINGLETONS
+
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
+TEST(CompressionContextPoolSingletonsTest, testLZ4FSingletons) {
+  EXPECT_NE(contexts::getLZ4F_CCtx(), nullptr);
+  EXPECT_NE(contexts::getLZ4F_DCtx(), nullptr);
+}
+
+TEST(CompressionContextPoolSingletonsTest, testLZ4FSingletonsNull) {
+  EXPECT_EQ(contexts::getNULL_LZ4F_CCtx(), nullptr);
+  EXPECT_EQ(contexts::getNULL_LZ4F_DCtx(), nullptr);
+}
+
+#endif // FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
 } // namespace compression
 } // namespace folly
@@ -38,6 +38,7 @@
 #endif
 
 #if FOLLY_HAVE_LIBZ
+#include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/Zlib.h>
 
 namespace zlib = folly::compression::zlib;
@@ -1528,6 +1529,98 @@ TEST(ZstdTest, NegativeLevels) {
   EXPECT_EQ(original, uncompressed);
 }
 
+namespace {
+// Small messages with a lot in common, like RPC payloads.
+std::vector<std::string> dictionarySamples(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::string> samples;
+  for (size_t i = 0; i < count; ++i) {
+    samples.push_back(
+        "{\"request_id\": " + std::to_string(rng()) +
+        ", \"user\": {\"name\": \"user" + std::to_string(rng() % 1000) +
+        "\", \"locale\": \"en_US\"}, \"method\": \"getTimeline\", " +
+        "\"params\": {\"limit\": " + std::to_string(rng() % 100) +
+        ", \"include_replies\": " + (rng() % 2 ? "true" : "false") +
+        ", \"cursor\": \"" + std::to_string(rng()) + "\"}}");
+  }
+  return samples;
+}
+
+std::shared_ptr<zstd::Dictionary const> trainedDictionary() {
+  auto const samples = dictionarySamples(2000, 1);
+  std::vector<ByteRange> ranges(samples.begin(), samples.end());
+  return std::make_shared<zstd::Dictionary>(
+      zstd::trainDictionary(ranges, 4096));
+}
+} // namespace
+
+TEST(ZstdTest, Dictionary) {
+  auto const dictionary = trainedDictionary();
+  EXPECT_NE(0, dictionary->id());
+  EXPECT_LE(dictionary->data().size(), 4096);
+  EXPECT_EQ(dictionary->cdict(3), dictionary->cdict(3));
+  EXPECT_NE(dictionary->cdict(3), dictionary->cdict(19));
+
+  auto makeOptions = [&](int level) {
+    zstd::Options options(level);
+    options.setDictionary(dictionary);
+    return options;
+  };
+  size_t withDictionary = 0;
+  size_t withoutDictionary = 0;
+  for (auto const& sample : dictionarySamples(100, 2)) {
+    for (int level : {1, 3, 19}) {
+      auto const codec = zstd::getCodec(makeOptions(level));
+      auto const compressed = codec->compress(sample);
+      EXPECT_EQ(sample, codec->uncompress(compressed));
+      EXPECT_EQ(
+          sample, zstd::getStreamCodec(makeOptions(1))->uncompress(compressed));
+      withDictionary += compressed.size();
+      withoutDictionary +=
+          zstd::getCodec(zstd::Options(level))->compress(sample).size();
+    }
+  }
+  EXPECT_LT(withDictionary * 2, withoutDictionary);
+
+  auto const stream = zstd::getStreamCodec(makeOptions(3));
+  auto const sample = dictionarySamples(1, 3)[0];
+  auto const compressed = stream->compress(sample);
+  EXPECT_EQ(sample, stream->uncompress(compressed));
+  EXPECT_EQ(
+      dictionary->id(),
+      ZSTD_getDictID_fromFrame(compressed.data(), compressed.size()));
+  EXPECT_THROW(
+      getCodec(CodecType::ZSTD)->uncompress(compressed), std::runtime_error);
+}
+
+TEST(ZstdTest, DictionaryCache) {
+  auto const dictionary = trainedDictionary();
+  zstd::Options options(3);
+  options.setDictionary(dictionary);
+  auto const sample = dictionarySamples(1, 4)[0];
+  auto const compressed = zstd::getCodec(std::move(options))->compress(sample);
+
+  EXPECT_EQ(nullptr, zstd::getDictionary(dictionary->id()));
+  zstd::addDictionary(dictionary);
+  EXPECT_EQ(dictionary, zstd::getDictionary(dictionary->id()));
+  // Frames name their dictionary, so codecs without one find it.
+  EXPECT_EQ(sample, getCodec(CodecType::ZSTD)->uncompress(compressed));
+  EXPECT_EQ(sample, getStreamCodec(CodecType::ZSTD)->uncompress(compressed));
+
+  auto const raw = std::make_shared<zstd::Dictionary>(sample);
+  EXPECT_EQ(0, raw->id());
+  EXPECT_THROW(zstd::addDictionary(raw), std::invalid_argument);
+  EXPECT_THROW(zstd::addDictionary(nullptr), std::invalid_argument);
+
+  // Raw dictionaries work through Options.
+  zstd::Options rawOptions(3);
+  rawOptions.setDictionary(raw);
+  auto const rawCodec = zstd::getCodec(std::move(rawOptions));
+  auto const rawCompressed = rawCodec->compress(sample);
+  EXPECT_LT(rawCompressed.size(), 20);
+  EXPECT_EQ(sample, rawCodec->uncompress(rawCompressed));
+}
+
 #endif
 
 #if FOLLY_HAVE_LIBZ
@@ -1635,6 +1728,39 @@ INSTANTIATE_TEST_SUITE_P(
         testing::Values(
             Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED)));
 
+#ifdef FOLLY_COMPRESSION_HAS_ZLIB_CONTEXT_POOL_SINGLETONS
+
+TEST(ZlibTest, PooledStreams) {
+  size_t const uncompressedLength = (size_t)1 << 16;
+  auto const original = std::string(
+      reinterpret_cast<const char*>(
+          randomDataHolder.data(uncompressedLength).data()),
+      uncompressedLength);
+  auto roundTrip = [&](CodecType type, int level) {
+    auto codec = getStreamCodec(type, level);
+    auto compressed = codec->compress(original);
+    EXPECT_EQ(original, getStreamCodec(type)->uncompress(compressed));
+    return compressed;
+  };
+  for (auto type : {CodecType::ZLIB, CodecType::GZIP}) {
+    auto const fastest = roundTrip(type, COMPRESSION_LEVEL_FASTEST);
+    auto const best = roundTrip(type, COMPRESSION_LEVEL_BEST);
+    EXPECT_NE(fastest, best);
+
+    auto const deflateCount = contexts::get_zlib_deflate_created_count();
+    auto const inflateCount = contexts::get_zlib_inflate_created_count();
+    for (int i = 0; i < 10; ++i) {
+      // The level of a pooled stream does not leak into the next codec.
+      EXPECT_EQ(fastest, roundTrip(type, COMPRESSION_LEVEL_FASTEST));
+      EXPECT_EQ(best, roundTrip(type, COMPRESSION_LEVEL_BEST));
+    }
+    EXPECT_EQ(deflateCount, contexts::get_zlib_deflate_created_count());
+    EXPECT_EQ(inflateCount, contexts::get_zlib_inflate_created_count());
+  }
+}
+
+#endif // FOLLY_COMPRESSION_HAS_ZLIB_CONTEXT_POOL_SINGLETONS
+
 #endif // FOLLY_HAVE_LIBZ
 
 } // namespace test
@@ -37,6 +37,8 @@ DEFINE_uint64(
     100000000,
     "The number of elements inserted into quotient multiset");
 DEFINE_double(load_factor, 0.95, "Load factor of the multiset");
+DEFINE_uint64(
+    build_threads, 8, "The number of threads used by the parallel builder");
 
 #if FOLLY_QUOTIENT_MULTI_SET_SUPPORTED
 
@@ -181,6 +183,19 @@ size_t benchmarkRandomSerialized(const Lookup& lookup) {
   return benchmarkSerializedOnResultBits(lookup, /* hitRate */ 0);
 }
 
+template <class Reader>
+size_t benchmarkBatch(const Reader& reader, double hitRate) {
+  auto keys = makeLookupKeys(kRunsPerIteration, hitRate);
+  std::vector<typename Reader::SlotRange> ranges;
+  {
+    folly::BenchmarkSuspender guard;
+    ranges.resize(keys.size());
+  }
+  reader.equalRange(folly::range(keys), ranges.data());
+  folly::doNotOptimizeAway(ranges.data());
+  return kRunsPerIteration;
+}
+
 template <class Lookup>
 size_t benchmarkHitsSmallWorkingSet(const Lookup& lookup) {
   // Loop over a small set of keys so that after the first iteration
@@ -279,6 +294,53 @@ BENCHMARK_MULTI(QuotientMultiSetGetRandomSerialized) {
   return ret;
 }
 
+BENCHMARK_MULTI(QuotientMultiSetGetHitsBatch) {
+  size_t ret = 0;
+  folly::compression::dispatchInstructions([&](auto instructions) {
+    auto reader = folly::QuotientMultiSet<decltype(instructions)>(qmsData);
+    ret = benchmarkBatch(reader, /* hitRate */ 1);
+  });
+  return ret;
+}
+
+BENCHMARK_MULTI(QuotientMultiSetGetRandomBatch) {
+  size_t ret = 0;
+  folly::compression::dispatchInstructions([&](auto instructions) {
+    auto reader = folly::QuotientMultiSet<decltype(instructions)>(qmsData);
+    ret = benchmarkBatch(reader, /* hitRate */ 0);
+  });
+  return ret;
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_MULTI(QuotientMultiSetBuild) {
+  folly::QuotientMultiSetBuilder builder(
+      FLAGS_key_bits, uniform.size(), FLAGS_load_factor);
+  folly::IOBufQueue buff;
+  for (auto key : uniform) {
+    builder.insert(key);
+    if (builder.numReadyBlocks() >= 1) {
+      builder.flush(buff);
+    }
+  }
+  builder.close(buff);
+  folly::doNotOptimizeAway(buff.front());
+  return uniform.size();
+}
+
+BENCHMARK_RELATIVE_MULTI(QuotientMultiSetBuildParallel) {
+  folly::IOBufQueue buff;
+  folly::QuotientMultiSetBuilder::build(
+      folly::range(uniform),
+      FLAGS_key_bits,
+      FLAGS_build_threads,
+      buff,
+      FLAGS_load_factor);
+  folly::doNotOptimizeAway(buff.front());
+  return uniform.size();
+}
+
 BENCHMARK_DRAW_LINE();
 
 BENCHMARK_MULTI(F14MapHits) {
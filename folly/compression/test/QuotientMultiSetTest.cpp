@@ -17,6 +17,7 @@
 #include <folly/compression/QuotientMultiSet.h>
 
 #include <random>
+#include <string>
 
 #include <folly/Format.h>
 #include <folly/Random.h>
@@ -130,6 +131,29 @@ class QuotientMultiSetTest : public ::testing::Test {
     }
   }
 
+  // Build with the parallel builder and check that the result is the same as
+  // inserting the keys one by one.
+  void buildParallelAndValidate(
+      std::vector<uint64_t>& keys, uint64_t keyBits, double loadFactor) {
+    std::sort(keys.begin(), keys.end());
+    folly::QuotientMultiSetBuilder builder(keyBits, keys.size(), loadFactor);
+    folly::IOBufQueue expected;
+    for (auto key : keys) {
+      builder.insert(key);
+    }
+    builder.close(expected);
+
+    for (size_t numThreads : {1, 2, 3, 8}) {
+      SCOPED_TRACE(folly::sformat("Threads: {}", numThreads));
+      folly::IOBufQueue buff;
+      folly::QuotientMultiSetBuilder::build(
+          folly::range(keys), keyBits, numThreads, buff, loadFactor);
+      EXPECT_EQ(
+          expected.front()->to<std::string>(),
+          buff.front()->to<std::string>());
+    }
+  }
+
   std::mt19937 rng;
 };
 
@@ -291,4 +315,76 @@ TEST_F(QuotientMultiSetTest, RunendRightBeforeFirstOccupiedRunend) {
   buildAndValidate(keys, 8, 0.95);
 }
 
+TEST_F(QuotientMultiSetTest, ParallelBuild) {
+  constexpr size_t kNumElements = 1 << 19;
+  for (uint64_t keyBits : {24, 32, 64}) {
+    SCOPED_TRACE(folly::sformat("Key bits: {}", keyBits));
+    std::vector<uint64_t> keys;
+    for (size_t idx = 0; idx < kNumElements; idx++) {
+      keys.push_back(
+          folly::Random::rand64(rng) & folly::qms_detail::maxValue(keyBits));
+    }
+    buildParallelAndValidate(keys, keyBits, 0.95);
+  }
+}
+
+TEST_F(QuotientMultiSetTest, ParallelBuildOverflow) {
+  // Runs overflow into later blocks all the way to the end, so every part
+  // starts after the block of its first key.
+  constexpr uint64_t kNumElements = 1 << 18;
+  std::vector<uint64_t> keys;
+  for (uint64_t idx = 0; idx < kNumElements; idx++) {
+    keys.insert(keys.end(), 3, idx);
+  }
+  buildParallelAndValidate(keys, 18, 0.95);
+}
+
+TEST_F(QuotientMultiSetTest, ParallelBuildRunAcrossBlocks) {
+  std::vector<uint64_t> keys;
+  for (uint64_t idx = 0; idx < (1 << 12); idx++) {
+    uint64_t key = folly::Random::rand32(rng);
+    for (uint64_t k = 0; k < 137; k++) {
+      keys.push_back(key + k / 3);
+    }
+  }
+  buildParallelAndValidate(keys, 32, 1.0);
+}
+
+TEST_F(QuotientMultiSetTest, ParallelBuildSmall) {
+  std::vector<uint64_t> keys = {100, 1000, 1 << 14, 10 << 14, 0, 10};
+  buildParallelAndValidate(keys, 32, 0.95);
+  keys.clear();
+  buildParallelAndValidate(keys, 32, 0.95);
+}
+
+TEST_F(QuotientMultiSetTest, BatchEqualRange) {
+  std::vector<uint64_t> keys;
+  for (size_t idx = 0; idx < (1 << 14); idx++) {
+    keys.push_back(folly::Random::rand32(rng) >> 8);
+  }
+  std::sort(keys.begin(), keys.end());
+  folly::IOBufQueue buff;
+  folly::QuotientMultiSetBuilder::build(folly::range(keys), 24, 1, buff);
+  auto spBuf = buff.move();
+  folly::QuotientMultiSet<> reader(folly::StringPiece(spBuf->coalesce()));
+
+  // Hits, misses, and keys out of range.
+  std::vector<uint64_t> lookups;
+  for (size_t idx = 0; idx < 1000; idx++) {
+    lookups.push_back(keys[folly::Random::rand32(keys.size(), rng)]);
+    lookups.push_back(folly::Random::rand32(rng) >> 8);
+    lookups.push_back(folly::Random::rand64(rng) | (uint64_t(1) << 24));
+  }
+  std::vector<folly::QuotientMultiSet<>::SlotRange> ranges(lookups.size());
+  reader.equalRange(folly::range(lookups), ranges.data());
+  for (size_t idx = 0; idx < lookups.size(); idx++) {
+    auto expected = reader.equalRange(lookups[idx]);
+    EXPECT_EQ(bool(expected), bool(ranges[idx])) << lookups[idx];
+    if (expected) {
+      EXPECT_EQ(expected.begin, ranges[idx].begin) << lookups[idx];
+      EXPECT_EQ(expected.end, ranges[idx].end) << lookups[idx];
+    }
+  }
+}
+
 #endif // FOLLY_QUOTIENT_MULTI_SET_SUPPORTED
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/compression/ZstdParallel.h>
+
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+#if FOLLY_HAVE_LIBZSTD
+
+using namespace folly;
+using namespace folly::compression;
+
+namespace {
+
+// Runs each task on its own thread.
+class ThreadExecutor : public Executor {
+ public:
+  ~ThreadExecutor() override {
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void add(Func func) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.emplace_back(std::move(func));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::thread> threads_;
+};
+
+class RejectingExecutor : public Executor {
+ public:
+  void add(Func func) override {
+    if (added_++ == 2) {
+      throw std::runtime_error("rejected");
+    }
+    func();
+  }
+
+ private:
+  size_t added_{0};
+};
+
+std::string makeData(size_t size) {
+  std::mt19937 rng(size);
+  std::string data;
+  data.reserve(size);
+  // Compressible, but not trivially.
+  while (data.size() < size) {
+    data += std::to_string(rng() % 1000);
+    data += ' ';
+  }
+  data.resize(size);
+  return data;
+}
+
+// Splits data into a chain of IOBufs of `size` bytes.
+std::unique_ptr<IOBuf> makeChain(std::string const& data, size_t size) {
+  auto chain = IOBuf::create(0);
+  for (size_t i = 0; i < data.size(); i += size) {
+    chain->appendToChain(
+        IOBuf::copyBuffer(data.data() + i, std::min(size, data.size() - i)));
+  }
+  return chain;
+}
+
+std::string toString(IOBuf const& buf) {
+  return buf.cloneCoalescedAsValue().moveToFbString().toStdString();
+}
+
+} // namespace
+
+TEST(ZstdParallelTest, RoundTrip) {
+  ThreadExecutor executor;
+  zstd::Options options(3);
+  for (size_t size : {0, 1, 1000, 100000, 1000000}) {
+    for (size_t frameSize : {1000, 65536, 1 << 20}) {
+      SCOPED_TRACE(size);
+      SCOPED_TRACE(frameSize);
+      auto const data = makeData(size);
+      for (size_t chunk : {size_t(777), data.size() + 1}) {
+        auto const input = makeChain(data, chunk);
+        auto compressed =
+            zstd::compressParallel(*input, options, executor, frameSize);
+        auto const numFrames =
+            std::max<size_t>(1, (size + frameSize - 1) / frameSize);
+        EXPECT_EQ(numFrames + 1, compressed->countChainElements());
+        EXPECT_EQ(
+            data, toString(*zstd::uncompressParallel(*compressed, executor)));
+
+        // Also readable as plain zstd frames.
+        compressed->coalesce();
+        std::string serial(size, '\0');
+        EXPECT_EQ(
+            size,
+            ZSTD_decompress(
+                &serial[0],
+                serial.size(),
+                compressed->data(),
+                compressed->length()));
+        EXPECT_EQ(data, serial);
+
+        // Uncompress from a fragmented chain.
+        auto const fragmented = makeChain(toString(*compressed), 333);
+        EXPECT_EQ(
+            data, toString(*zstd::uncompressParallel(*fragmented, executor)));
+      }
+    }
+  }
+}
+
+TEST(ZstdParallelTest, Dictionary) {
+  ThreadExecutor executor;
+  auto const data = makeData(100000);
+  auto dictionary = std::make_shared<zstd::Dictionary>(makeData(10000));
+  zstd::Options options(3);
+  options.setDictionary(dictionary);
+  auto const compressed = zstd::compressParallel(
+      *IOBuf::copyBuffer(data), options, executor, 10000);
+  EXPECT_EQ(
+      data,
+      toString(*zstd::uncompressParallel(*compressed, executor, dictionary)));
+
+  // Trained dictionaries are found by id.
+  std::vector<std::string> samples;
+  for (size_t i = 0; i < 1000; ++i) {
+    samples.push_back(makeData(100 + i % 100));
+  }
+  std::vector<ByteRange> ranges(samples.begin(), samples.end());
+  auto trained =
+      std::make_shared<zstd::Dictionary>(zstd::trainDictionary(ranges, 4096));
+  options.setDictionary(trained);
+  auto const trainedCompressed = zstd::compressParallel(
+      *IOBuf::copyBuffer(data), options, executor, 10000);
+  EXPECT_THROW(
+      zstd::uncompressParallel(*trainedCompressed, executor),
+      std::runtime_error);
+  zstd::addDictionary(trained);
+  EXPECT_EQ(
+      data, toString(*zstd::uncompressParallel(*trainedCompressed, executor)));
+}
+
+TEST(ZstdParallelTest, Errors) {
+  ThreadExecutor executor;
+  zstd::Options options(1);
+  options.set(ZSTD_c_checksumFlag, 1);
+  auto const data = makeData(10000);
+  auto const input = IOBuf::copyBuffer(data);
+  EXPECT_THROW(
+      zstd::compressParallel(*input, options, executor, 0),
+      std::invalid_argument);
+  EXPECT_THROW(
+      zstd::compressParallel(*input, options, executor, size_t(1) << 31),
+      std::invalid_argument);
+
+  // Not the output of compressParallel().
+  auto const serial = zstd::getCodec(zstd::Options(1))->compress(input.get());
+  EXPECT_THROW(
+      zstd::uncompressParallel(*serial, executor), std::invalid_argument);
+  EXPECT_THROW(
+      zstd::uncompressParallel(*IOBuf::create(0), executor),
+      std::invalid_argument);
+
+  auto compressed = zstd::compressParallel(*input, options, executor, 1000);
+  compressed->coalesce();
+  auto const good = toString(*compressed);
+  // Corrupt the sizes in the seek table.
+  auto bad = good;
+  bad[bad.size() - 9 - 4] ^= 1;
+  EXPECT_THROW(
+      zstd::uncompressParallel(*IOBuf::copyBuffer(bad), executor),
+      std::runtime_error);
+  bad = good;
+  bad[bad.size() - 9 - 8] ^= 1;
+  EXPECT_THROW(
+      zstd::uncompressParallel(*IOBuf::copyBuffer(bad), executor),
+      std::invalid_argument);
+  // Corrupt a frame.
+  bad = good;
+  bad[20] ^= 0xff;
+  EXPECT_THROW(
+      zstd::uncompressParallel(*IOBuf::copyBuffer(bad), executor),
+      std::runtime_error);
+
+  RejectingExecutor rejecting;
+  EXPECT_THROW(
+      zstd::compressParallel(*input, options, rejecting, 1000),
+      std::runtime_error);
+}
+
+#endif
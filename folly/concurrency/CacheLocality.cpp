@@ -332,6 +332,17 @@ CacheLocality CacheLocality::readFromProcCpuinfo() {
   return readFromProcCpuinfoLines(lines);
 }
 
+std::vector<std::vector<size_t>> CacheLocality::cpusByStripe(
+    size_t numStripes) const {
+  numStripes = std::max(size_t{1}, numStripes);
+  std::vector<std::vector<size_t>> result(numStripes);
+  for (size_t cpu = 0; cpu < numCpus; ++cpu) {
+    // Same transform as AccessSpreaderBase::initialize.
+    result[(localityIndexByCpu[cpu] * numStripes) / numCpus].push_back(cpu);
+  }
+  return result;
+}
+
 CacheLocality CacheLocality::uniform(size_t numCpus) {
   // One cache shared by all cpus.
   std::vector<std::vector<size_t>> equivClassesByCpu(numCpus, {0});
@@ -81,6 +81,19 @@ struct CacheLocality {
   /// signifies that cpus with the same identifier share a cache at that level.
   std::vector<std::vector<size_t>> equivClassesByCpu;
 
+  /// Returns the number of last-level caches, which on most multi-socket
+  /// systems is also the number of NUMA nodes. Always at least 1.
+  size_t numLastLevelCaches() const {
+    return numCachesByLevel.empty() ? 1 : numCachesByLevel.back();
+  }
+
+  /// Partitions the cpus into numStripes groups the same way
+  /// AccessSpreader<>::current(numStripes) does, so that a thread bound to
+  /// the cpus in cpusByStripe(n)[i] observes AccessSpreader stripe i.
+  /// With numStripes == numLastLevelCaches() each group holds the cpus that
+  /// share one last-level cache.
+  std::vector<std::vector<size_t>> cpusByStripe(size_t numStripes) const;
+
   /// Returns the best CacheLocality information available for the current
   /// system, cached for fast access.  This will be loaded from sysfs if
   /// possible, otherwise it will be correct in the number of CPUs but
@@ -18,12 +18,16 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <utility>
 
 #include <folly/CppAttributes.h>
+#include <folly/Likely.h>
 #include <folly/Portability.h>
 #include <folly/Unit.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/lang/Align.h>
 #include <folly/synchronization/Hazptr.h>
 
 namespace folly {
@@ -84,6 +88,97 @@ bool isDefault(const std::shared_ptr<T>& p) {
   return p == nullptr && p.use_count() == 0;
 }
 
+/**
+ * The control block of CoreRefCountedPtr: the object and a reference count
+ * split into one counter per core.
+ *
+ * While the block is published by an AtomicCoreRefCountedPtr, which holds a
+ * large bias on the global count, references are only counted in the counter
+ * of the current core, and a reference may be dropped on a different core than
+ * it was taken on. Only the sum across the cores is meaningful. When the block
+ * is unpublished, each core counter is sealed, its count is moved to the
+ * global count, and the bias is dropped. From then on, references are counted
+ * in the global count, and the block is retired when it drops to zero.
+ *
+ * Core counters count in units of kUnit, so that the kSealed bit survives
+ * increments and decrements; whoever increments or decrements a sealed core
+ * counter learns it from the result, and goes to the global count instead.
+ */
+template <class T>
+class CoreRefCountedBlock : public hazptr_obj_base<CoreRefCountedBlock<T>> {
+ public:
+  template <class... Args>
+  explicit CoreRefCountedBlock(size_t numSlots, Args&&... args)
+      : numSlots_(numSlots),
+        slots_(new Slot[numSlots]),
+        value_(std::forward<Args>(args)...) {}
+
+  T* get() noexcept { return &value_; }
+
+  // Takes a reference, the caller must already hold one.
+  void incref() noexcept {
+    if (FOLLY_UNLIKELY(localCount().fetch_add(kUnit) & kSealed)) {
+      global_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Takes a reference unless the block is unpublished and the last reference
+  // is already gone. The caller must protect the block with a hazard pointer.
+  bool tryIncref() noexcept {
+    if (FOLLY_LIKELY(!(localCount().fetch_add(kUnit) & kSealed))) {
+      return true;
+    }
+    auto count = global_.load(std::memory_order_relaxed);
+    do {
+      if (count == 0) {
+        return false;
+      }
+    } while (!global_.compare_exchange_weak(count, count + 1));
+    return true;
+  }
+
+  void decref() noexcept {
+    if (FOLLY_LIKELY(!(localCount().fetch_sub(kUnit) & kSealed))) {
+      return;
+    }
+    if (global_.fetch_sub(1) == 1) {
+      this->retire();
+    }
+  }
+
+  // Drops the reference of the publisher, once no new references can be
+  // taken through it.
+  void unpublish() noexcept {
+    int64_t sum = 0;
+    for (size_t i = 0; i < numSlots_; ++i) {
+      sum += slots_[i].count.fetch_or(kSealed) / kUnit;
+    }
+    if (global_.fetch_add(sum - kBias) == kBias - sum) {
+      this->retire();
+    }
+  }
+
+ private:
+  static constexpr int64_t kSealed = 1;
+  static constexpr int64_t kUnit = 2;
+  // Larger than any number of references, so that the global count, which
+  // may go negative while the block is being unpublished, stays positive.
+  static constexpr int64_t kBias = int64_t(1) << 60;
+
+  struct alignas(hardware_destructive_interference_size) Slot {
+    std::atomic<int64_t> count{0};
+  };
+
+  std::atomic<int64_t>& localCount() noexcept {
+    return slots_[AccessSpreader<>::cachedCurrent(numSlots_)].count;
+  }
+
+  const size_t numSlots_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<int64_t> global_{kBias};
+  T value_;
+};
+
 } // namespace core_cached_shared_ptr_detail
 
 /**
@@ -229,4 +324,141 @@ class AtomicCoreCachedSharedPtr {
   std::atomic<Slots*> slots_{nullptr};
 };
 
+/**
+ * A reference counted pointer to an object published by an
+ * AtomicCoreRefCountedPtr, for read-mostly objects such as configuration
+ * snapshots.
+ *
+ * Unlike the shared_ptrs handed out by CoreCachedSharedPtr, which alias a
+ * control block per core, all references share a single control block with one
+ * counter per core. Copying and destroying a CoreRefCountedPtr increments or
+ * decrements the counter of the current core, even if the reference was taken
+ * on another core, so these stay core-local as threads migrate. Once the
+ * object is replaced, references fall back to a single shared count, which
+ * the last of them drops.
+ *
+ * Like shared_ptr, a single CoreRefCountedPtr must not be modified
+ * concurrently, while distinct copies may.
+ */
+template <class T>
+class CoreRefCountedPtr {
+  using Block = core_cached_shared_ptr_detail::CoreRefCountedBlock<T>;
+
+ public:
+  CoreRefCountedPtr() = default;
+
+  CoreRefCountedPtr(const CoreRefCountedPtr& other) noexcept
+      : block_(other.block_) {
+    if (block_) {
+      block_->incref();
+    }
+  }
+
+  CoreRefCountedPtr(CoreRefCountedPtr&& other) noexcept
+      : block_(std::exchange(other.block_, nullptr)) {}
+
+  CoreRefCountedPtr& operator=(const CoreRefCountedPtr& other) noexcept {
+    CoreRefCountedPtr(other).swap(*this);
+    return *this;
+  }
+
+  CoreRefCountedPtr& operator=(CoreRefCountedPtr&& other) noexcept {
+    CoreRefCountedPtr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~CoreRefCountedPtr() { reset(); }
+
+  void reset() noexcept {
+    if (auto block = std::exchange(block_, nullptr)) {
+      block->decref();
+    }
+  }
+
+  void swap(CoreRefCountedPtr& other) noexcept {
+    std::swap(block_, other.block_);
+  }
+
+  T* get() const noexcept { return block_ ? block_->get() : nullptr; }
+  T& operator*() const noexcept { return *get(); }
+  T* operator->() const noexcept { return get(); }
+  explicit operator bool() const noexcept { return block_ != nullptr; }
+
+ private:
+  template <class, size_t>
+  friend class AtomicCoreRefCountedPtr;
+
+  // Adopts a reference.
+  explicit CoreRefCountedPtr(Block* block) noexcept : block_(block) {}
+
+  Block* block_{nullptr};
+};
+
+/**
+ * Publishes an object to many readers, each getting a CoreRefCountedPtr to
+ * it, and atomically replaces it.
+ *
+ * All methods are threadsafe. get() protects the current object with a hazard
+ * pointer for just long enough to take a core-local reference, and does not
+ * write to any cache line shared with other cores. Replacing the object costs
+ * a pass over the per-core counters of the old one, after which references to
+ * it are counted in a shared count until they are all gone.
+ *
+ *   folly::AtomicCoreRefCountedPtr<Config> config;
+ *   config.emplace(loadConfig());
+ *
+ *   // Readers
+ *   auto snapshot = config.get();
+ *   use(snapshot->timeout);
+ */
+template <class T, size_t kMaxSlots = kCoreCachedSharedPtrDefaultMaxSlots>
+class AtomicCoreRefCountedPtr {
+  using SlotsConfig = core_cached_shared_ptr_detail::SlotsConfig<kMaxSlots>;
+  using Block = core_cached_shared_ptr_detail::CoreRefCountedBlock<T>;
+
+ public:
+  AtomicCoreRefCountedPtr() = default;
+  AtomicCoreRefCountedPtr(const AtomicCoreRefCountedPtr&) = delete;
+  AtomicCoreRefCountedPtr& operator=(const AtomicCoreRefCountedPtr&) = delete;
+
+  ~AtomicCoreRefCountedPtr() { reset(); }
+
+  /** Replaces the object with one constructed from args. */
+  template <class... Args>
+  void emplace(Args&&... args) {
+    SlotsConfig::initialize();
+    publish(new Block(SlotsConfig::num(), std::forward<Args>(args)...));
+  }
+
+  /** Removes the object, outstanding references keep it alive. */
+  void reset() noexcept { publish(nullptr); }
+
+  CoreRefCountedPtr<T> get() const noexcept {
+    // Avoid the hazptr cost if empty.
+    if (block_.load(std::memory_order_relaxed) == nullptr) {
+      return {};
+    }
+    folly::hazptr_local<1> hazptr;
+    while (true) {
+      auto block = hazptr[0].protect(block_);
+      if (block == nullptr) {
+        return {};
+      }
+      if (block->tryIncref()) {
+        return CoreRefCountedPtr<T>(block);
+      }
+      // Lost the race with a replacement, which already unpublished block.
+    }
+  }
+
+ private:
+  void publish(Block* block) noexcept {
+    if (auto old = block_.exchange(block, std::memory_order_acq_rel)) {
+      old->unpublish();
+    }
+  }
+
+  std::atomic<Block*> block_{nullptr};
+};
+
 } // namespace folly
@@ -0,0 +1,691 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ResizableAtomicHashMap --
+ *
+ * A concurrent open-addressed hash map from integers to integers, meant for
+ * things like counters keyed by id.  Unlike AtomicHashMap, it does not need
+ * its capacity to be guessed upfront: it lives in a single table that is
+ * replaced by a larger or smaller one as entries come and go, and erase
+ * reclaims space.
+ *
+ * Usage:
+ *
+ *   ResizableAtomicHashMap<int64_t, int64_t> counters;
+ *   counters.fetch_add(id, 1);
+ *   if (auto n = counters.find(id)) { ... *n ... }
+ *   counters.erase(id);
+ *
+ * Implementation and Performance Details:
+ *   Each cell holds an atomic key and an atomic value.  A key is claimed
+ *   once and stays in its cell for the lifetime of the table; erase turns
+ *   the value into a tombstone, which a later insert of the same key may
+ *   fill again.  Tombstones still count towards the load of the table.
+ *
+ *   When the claimed cells reach maxLoadFactor, or the live entries drop
+ *   below minLoadFactor, a new table sized for twice the live entries is
+ *   allocated and the cells are migrated into it in chunks.  The migration
+ *   is cooperative and incremental: every operation that finds it in
+ *   progress copies a chunk before doing its own work, and the last chunk
+ *   makes the new table current.  Tombstones are not copied.
+ *
+ *   A migrated cell has its value replaced by a "moved" marker, and empty
+ *   cells have their key replaced by a "moved" key, so that nothing can be
+ *   written to the old table behind the migration.  Operations that meet
+ *   either marker continue in the new table.  Old tables are reclaimed
+ *   through hazard pointers.
+ *
+ *   find() is lock-free, and so are updates of present values and erase.
+ *   Inserts are not: a migration waits for the inserts in flight before
+ *   sizing the new table, and inserts wait for it to be allocated.  An
+ *   insert that would fill a tombstone of a table being migrated also waits
+ *   for another thread that is copying the chunk of that cell.
+ *
+ * Restrictions:
+ *   - KeyT and ValueT must be integral types.
+ *   - Two key values and two mapped values are reserved (see Config), and
+ *     may not be inserted.
+ *   - Inserting a new key increments a shared counter, so this is tuned for
+ *     workloads that update existing keys much more often than they add
+ *     new ones.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+#include <folly/synchronization/AsymmetricThreadFence.h>
+#include <folly/synchronization/Hazptr.h>
+
+namespace folly {
+
+template <
+    typename KeyT,
+    typename ValueT,
+    typename HashFcn = folly::hasher<KeyT>>
+class ResizableAtomicHashMap {
+  static_assert(std::is_integral_v<KeyT>, "KeyT must be integral");
+  static_assert(std::is_integral_v<ValueT>, "ValueT must be integral");
+
+ public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using hasher = HashFcn;
+  using size_type = std::size_t;
+
+  struct Config {
+    /// Reserved keys: cells that were never claimed, and never-claimed
+    /// cells of a table that has been migrated.
+    KeyT emptyKey = KeyT(-1);
+    KeyT movedKey = KeyT(-2);
+    /// Reserved values: absent or erased entries, and entries of a table
+    /// that have been migrated.
+    ValueT absentValue = std::is_signed_v<ValueT>
+        ? std::numeric_limits<ValueT>::min()
+        : std::numeric_limits<ValueT>::max();
+    ValueT movedValue = std::is_signed_v<ValueT>
+        ? std::numeric_limits<ValueT>::min() + 1
+        : std::numeric_limits<ValueT>::max() - 1;
+    /// Claimed cells, tombstones included, over which the table is
+    /// migrated.
+    double maxLoadFactor = 0.75;
+    /// Live entries under which the table is migrated to a smaller one.
+    double minLoadFactor = 0.125;
+    /// The capacity of the table never goes below this.
+    size_t minCapacity = 16;
+  };
+
+  explicit ResizableAtomicHashMap(size_t initialCapacity = 0)
+      : ResizableAtomicHashMap(initialCapacity, Config()) {}
+
+  ResizableAtomicHashMap(size_t initialCapacity, const Config& config)
+      : config_(config) {
+    DCHECK_NE(config_.emptyKey, config_.movedKey);
+    DCHECK_NE(config_.absentValue, config_.movedValue);
+    DCHECK(config_.maxLoadFactor > 0 && config_.maxLoadFactor < 1);
+    auto capacity = capacityFor(initialCapacity);
+    table_.store(new Table(capacity, 0, config_), std::memory_order_release);
+    capacity_.store(capacity, std::memory_order_relaxed);
+  }
+
+  ResizableAtomicHashMap(const ResizableAtomicHashMap&) = delete;
+  ResizableAtomicHashMap& operator=(const ResizableAtomicHashMap&) = delete;
+
+  ~ResizableAtomicHashMap() {
+    auto t = table_.load(std::memory_order_acquire);
+    auto n = t->next.load(std::memory_order_acquire);
+    if (n != nullptr && n != pending()) {
+      delete n;
+    }
+    delete t;
+  }
+
+  /// Returns the value of key, if it is present.
+  std::optional<ValueT> find(KeyT key) const {
+    checkKey(key);
+    auto const hash = HashFcn()(key);
+    auto h = make_hazard_pointer_array<2>();
+    while (true) {
+      auto t = h[0].protect(table_);
+      ValueT value;
+      auto step = findIn(t, key, hash, value);
+      if (step == Step::kNext) {
+        auto n = protectNext(h[1], t);
+        if (n == nullptr) {
+          continue;
+        }
+        step = findIn(n, key, hash, value);
+      }
+      if (step == Step::kDone) {
+        return value == config_.absentValue ? std::nullopt
+                                            : std::optional<ValueT>(value);
+      }
+    }
+  }
+
+  bool contains(KeyT key) const { return find(key).has_value(); }
+
+  /// Inserts key with value if key is absent.  Returns whether it did.
+  bool insert(KeyT key, ValueT value) {
+    checkValue(value);
+    return !update(key, [&](bool present, ValueT cur) {
+              return present ? cur : value;
+            }).first;
+  }
+
+  /// Sets key to value.  Returns whether key was absent.
+  bool insert_or_assign(KeyT key, ValueT value) {
+    checkValue(value);
+    return !update(key, [&](bool, ValueT) { return value; }).first;
+  }
+
+  /// Adds delta to the value of key, inserting delta if key is absent.
+  /// Returns the value before the addition (0 if key was absent).
+  ValueT fetch_add(KeyT key, ValueT delta) {
+    auto [present, old] = update(key, [&](bool present, ValueT cur) {
+      auto value = ValueT((present ? cur : ValueT(0)) + delta);
+      checkValue(value);
+      return value;
+    });
+    return present ? old : ValueT(0);
+  }
+
+  /// Erases key.  Returns whether it was present.
+  bool erase(KeyT key) {
+    return update(key, [&](bool, ValueT) { return config_.absentValue; })
+        .first;
+  }
+
+  /// The number of entries.  Exact when the map is quiescent.
+  size_t size() const {
+    return size_t(std::max<int64_t>(size_.load(std::memory_order_acquire), 0));
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// The number of cells of the current table.
+  size_t capacity() const { return capacity_.load(std::memory_order_acquire); }
+
+  const Config& config() const { return config_; }
+
+ private:
+  struct Cell {
+    std::atomic<KeyT> key;
+    std::atomic<ValueT> value;
+  };
+
+  static constexpr size_t kChunkShift = 8;
+  static constexpr size_t kChunkSize = size_t(1) << kChunkShift;
+
+  enum ChunkState : uint8_t { kChunkFree, kChunkClaimed, kChunkDone };
+
+  struct Table : hazptr_obj_base<Table> {
+    Table(size_t capacity, size_t reserve, const Config& config)
+        : mask(capacity - 1),
+          maxUsed(size_t(double(capacity) * config.maxLoadFactor)),
+          numChunks((capacity + kChunkSize - 1) >> kChunkShift),
+          cells(new Cell[capacity]),
+          chunks(new std::atomic<uint8_t>[numChunks]),
+          reserve(reserve) {
+      for (size_t i = 0; i < capacity; ++i) {
+        cells[i].key.store(config.emptyKey, std::memory_order_relaxed);
+        cells[i].value.store(config.absentValue, std::memory_order_relaxed);
+      }
+      for (size_t i = 0; i < numChunks; ++i) {
+        chunks[i].store(kChunkFree, std::memory_order_relaxed);
+      }
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    const size_t mask;
+    const size_t maxUsed;
+    const size_t numChunks;
+    const std::unique_ptr<Cell[]> cells;
+    const std::unique_ptr<std::atomic<uint8_t>[]> chunks;
+
+    /// The table that this one is being migrated to, or pending() while
+    /// it is being sized.
+    std::atomic<Table*> next{nullptr};
+    /// Claimed cells.  A table that is being migrated into keeps room for
+    /// the entries it will receive, which are counted in reserve.
+    std::atomic<size_t> used{0};
+    std::atomic<size_t> reserve;
+    std::atomic<size_t> chunkHint{0};
+    std::atomic<size_t> chunksDone{0};
+    /// Threads that may be turning an absent value into a present one.
+    /// Migrations wait for it to drain before sizing the next table, so
+    /// that the entries to copy are known.
+    alignas(hardware_destructive_interference_size) std::atomic<size_t>
+        inserters{0};
+  };
+
+  enum class Step { kDone, kNext, kRestart };
+
+  static Table* pending() {
+    return reinterpret_cast<Table*>(uintptr_t(alignof(Table)));
+  }
+
+  void checkKey(KeyT key) const {
+    DCHECK_NE(key, config_.emptyKey);
+    DCHECK_NE(key, config_.movedKey);
+  }
+
+  void checkValue(ValueT value) const {
+    DCHECK_NE(value, config_.absentValue);
+    DCHECK_NE(value, config_.movedValue);
+  }
+
+  size_t maxUsedFor(size_t capacity) const {
+    return size_t(double(capacity) * config_.maxLoadFactor);
+  }
+
+  /// The smallest capacity at which size entries fill at most half of the
+  /// allowed load.
+  size_t capacityFor(size_t size) const {
+    size_t capacity = 1;
+    while (capacity < config_.minCapacity) {
+      capacity <<= 1;
+    }
+    while (2 * size >= maxUsedFor(capacity)) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  /// Protects the table that t is being migrated to.  Returns nullptr if t
+  /// is no longer current, in which case the operation starts over.
+  Table* protectNext(hazptr_holder<>& h, Table* t) const {
+    auto n = waitForNext(t);
+    h.reset_protection(n);
+    folly::asymmetric_thread_fence_light(std::memory_order_seq_cst);
+    // n can only be retired after it has replaced t.
+    if (table_.load(std::memory_order_acquire) != t) {
+      h.reset_protection();
+      return nullptr;
+    }
+    return n;
+  }
+
+  Step findIn(Table* t, KeyT key, size_t hash, ValueT& value) const {
+    auto n = t->next.load(std::memory_order_acquire);
+    if (n != nullptr && n != pending()) {
+      helpMigrate(t, n);
+    }
+    for (size_t i = 0, idx = hash & t->mask; i <= t->mask;
+         ++i, idx = (idx + 1) & t->mask) {
+      auto& cell = t->cells[idx];
+      auto k = cell.key.load(std::memory_order_acquire);
+      if (k == key) {
+        value = cell.value.load(std::memory_order_acquire);
+        return value == config_.movedValue ? Step::kNext : Step::kDone;
+      }
+      if (k == config_.movedKey) {
+        break;
+      }
+      if (k == config_.emptyKey) {
+        value = config_.absentValue;
+        return Step::kDone;
+      }
+    }
+    // key is not in t.  While the next table is being sized, nothing has
+    // been written to it yet.
+    value = config_.absentValue;
+    n = t->next.load(std::memory_order_acquire);
+    return n != nullptr && n != pending() ? Step::kNext : Step::kDone;
+  }
+
+  /// Applies f(present, current), which returns the new value of key, or
+  /// absentValue to erase it.  Returns whether key was present and its
+  /// previous value.
+  template <typename F>
+  std::pair<bool, ValueT> update(KeyT key, F f) {
+    checkKey(key);
+    auto const hash = HashFcn()(key);
+    auto h = make_hazard_pointer_array<2>();
+    std::pair<bool, ValueT> result;
+    while (true) {
+      auto t = h[0].protect(table_);
+      auto step = updateIn(t, key, hash, f, result);
+      if (step == Step::kNext) {
+        auto n = protectNext(h[1], t);
+        if (n == nullptr) {
+          continue;
+        }
+        step = updateIn(n, key, hash, f, result);
+      }
+      if (step == Step::kDone) {
+        return result;
+      }
+    }
+  }
+
+  template <typename F>
+  Step updateIn(
+      Table* t,
+      KeyT key,
+      size_t hash,
+      F& f,
+      std::pair<bool, ValueT>& result) {
+    auto n = t->next.load(std::memory_order_acquire);
+    if (n != nullptr && n != pending()) {
+      helpMigrate(t, n);
+    }
+    size_t i = 0;
+    size_t idx = hash & t->mask;
+    while (true) {
+      // Find the cell of key, or the first cell that was never claimed.
+      KeyT k = config_.emptyKey;
+      for (; i <= t->mask; ++i, idx = (idx + 1) & t->mask) {
+        k = t->cells[idx].key.load(std::memory_order_acquire);
+        if (k == key || k == config_.emptyKey) {
+          break;
+        }
+        if (k == config_.movedKey) {
+          return Step::kNext;
+        }
+      }
+      if (i > t->mask) {
+        // Every cell is claimed by another key.
+        if (t->next.load(std::memory_order_acquire)) {
+          return Step::kNext;
+        }
+        grow(t);
+        return Step::kRestart;
+      }
+      auto& cell = t->cells[idx];
+      if (k == key) {
+        return updateCell(t, idx, f, result);
+      }
+
+      // key is not in t.
+      auto value = f(false, config_.absentValue);
+      if (value == config_.absentValue) {
+        result = {false, config_.absentValue};
+        return Step::kDone;
+      }
+      if (t->next.load(std::memory_order_acquire)) {
+        // Keep key from being inserted behind the migration.
+        if (cell.key.compare_exchange_strong(
+                k, config_.movedKey, std::memory_order_acq_rel)) {
+          return Step::kNext;
+        }
+        continue; // k was claimed in the meantime; look at it again
+      }
+      auto guard = enterInsert(t);
+      if (!guard) {
+        continue; // a migration started; look at the cell again
+      }
+      size_t limit = t->maxUsed - t->reserve.load(std::memory_order_acquire);
+      if (t->used.fetch_add(1, std::memory_order_relaxed) >= limit) {
+        t->used.fetch_sub(1, std::memory_order_relaxed);
+        guard.reset();
+        grow(t);
+        return Step::kRestart;
+      }
+      for (; i <= t->mask; ++i, idx = (idx + 1) & t->mask) {
+        auto& c = t->cells[idx];
+        k = c.key.load(std::memory_order_acquire);
+        if (k == config_.emptyKey &&
+            c.key.compare_exchange_strong(
+                k, key, std::memory_order_acq_rel)) {
+          auto expected = config_.absentValue;
+          if (c.value.compare_exchange_strong(
+                  expected, value, std::memory_order_acq_rel)) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+            result = {false, config_.absentValue};
+            return Step::kDone;
+          }
+          // Another insert of key filled the cell first.
+          guard.reset();
+          return updateCell(t, idx, f, result);
+        }
+        if (k == key || k == config_.movedKey) {
+          // Either another insert of key claimed the cell first, or a
+          // migration is being sized and the cell was frozen for it.
+          t->used.fetch_sub(1, std::memory_order_relaxed);
+          guard.reset();
+          return k == key ? updateCell(t, idx, f, result) : Step::kNext;
+        }
+      }
+      t->used.fetch_sub(1, std::memory_order_relaxed);
+      return Step::kRestart;
+    }
+  }
+
+  template <typename F>
+  Step updateCell(
+      Table* t, size_t idx, F& f, std::pair<bool, ValueT>& result) {
+    auto& cell = t->cells[idx];
+    auto v = cell.value.load(std::memory_order_acquire);
+    while (true) {
+      if (v == config_.movedValue) {
+        return Step::kNext;
+      }
+      bool present = v != config_.absentValue;
+      auto value = f(present, v);
+      if (value == v) {
+        result = {present, v};
+        return Step::kDone;
+      }
+      if (present) {
+        if (cell.value.compare_exchange_weak(
+                v, value, std::memory_order_acq_rel)) {
+          if (value == config_.absentValue) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            maybeShrink(t);
+          }
+          result = {true, v};
+          return Step::kDone;
+        }
+        continue;
+      }
+      // Filling a tombstone is an insert, which must not race with the
+      // sizing of a migration, nor land behind it.
+      auto guard = enterInsert(t);
+      if (!guard) {
+        moveCell(t, idx);
+        return Step::kNext;
+      }
+      if (cell.value.compare_exchange_strong(
+              v, value, std::memory_order_acq_rel)) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+        result = {false, config_.absentValue};
+        return Step::kDone;
+      }
+    }
+  }
+
+  struct InsertGuard {
+    std::atomic<size_t>* inserters = nullptr;
+
+    explicit operator bool() const { return inserters != nullptr; }
+
+    void reset() {
+      if (inserters) {
+        inserters->fetch_sub(1, std::memory_order_release);
+        inserters = nullptr;
+      }
+    }
+
+    InsertGuard() = default;
+    explicit InsertGuard(std::atomic<size_t>* i) : inserters(i) {}
+    InsertGuard(InsertGuard&& other) noexcept
+        : inserters(std::exchange(other.inserters, nullptr)) {}
+    InsertGuard& operator=(InsertGuard&&) = delete;
+    ~InsertGuard() { reset(); }
+  };
+
+  /// Registers an insert into t, unless t is being migrated.
+  static InsertGuard enterInsert(Table* t) {
+    t->inserters.fetch_add(1, std::memory_order_seq_cst);
+    if (t->next.load(std::memory_order_seq_cst) != nullptr) {
+      t->inserters.fetch_sub(1, std::memory_order_release);
+      return {};
+    }
+    return InsertGuard(&t->inserters);
+  }
+
+  static Table* waitForNext(Table* t) {
+    auto n = t->next.load(std::memory_order_acquire);
+    while (n == pending()) {
+      std::this_thread::yield();
+      n = t->next.load(std::memory_order_acquire);
+    }
+    return n;
+  }
+
+  void maybeShrink(Table* t) {
+    auto capacity = t->capacity();
+    if (capacity > config_.minCapacity &&
+        double(size()) < double(capacity) * config_.minLoadFactor &&
+        capacityFor(size()) < capacity) {
+      startMigration(t);
+    }
+  }
+
+  /// Makes room in a full table: starts migrating it if it is current, or
+  /// waits a bit for the migration into it to finish otherwise.
+  void grow(Table* t) {
+    if (table_.load(std::memory_order_acquire) == t) {
+      startMigration(t);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  /// Starts migrating t, if it is the current table and is not already
+  /// being migrated.
+  void startMigration(Table* t) {
+    if (table_.load(std::memory_order_acquire) != t) {
+      return;
+    }
+    Table* expected = nullptr;
+    if (!t->next.compare_exchange_strong(
+            expected, pending(), std::memory_order_seq_cst)) {
+      return;
+    }
+    while (t->inserters.load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+    // No entry can be added to t any more, so this bounds the entries
+    // that will be copied.
+    auto live =
+        size_t(std::max<int64_t>(size_.load(std::memory_order_seq_cst), 0));
+    Table* n;
+    try {
+      n = new Table(capacityFor(live), live, config_);
+    } catch (...) {
+      t->next.store(nullptr, std::memory_order_release);
+      throw;
+    }
+    t->next.store(n, std::memory_order_release);
+  }
+
+  /// Migrates a chunk of t that no one has claimed yet, if any.
+  void helpMigrate(Table* t, Table* n) const {
+    if (t->chunkHint.load(std::memory_order_relaxed) >= t->numChunks) {
+      return;
+    }
+    auto chunk = t->chunkHint.fetch_add(1, std::memory_order_relaxed);
+    if (chunk < t->numChunks && claimChunk(t, chunk)) {
+      migrateChunk(t, n, chunk);
+    }
+  }
+
+  static bool claimChunk(Table* t, size_t chunk) {
+    uint8_t expected = kChunkFree;
+    return t->chunks[chunk].compare_exchange_strong(
+        expected, kChunkClaimed, std::memory_order_acq_rel);
+  }
+
+  /// Waits until the cell at idx has been migrated, migrating its chunk if
+  /// no one else is.
+  void moveCell(Table* t, size_t idx) const {
+    auto n = waitForNext(t);
+    auto chunk = idx >> kChunkShift;
+    if (claimChunk(t, chunk)) {
+      migrateChunk(t, n, chunk);
+      return;
+    }
+    auto& value = t->cells[idx].value;
+    while (value.load(std::memory_order_acquire) != config_.movedValue) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// Copies the live entries of a claimed chunk of t into n, and makes n
+  /// the current table once every chunk has been copied.
+  void migrateChunk(Table* t, Table* n, size_t chunk) const {
+    auto end = std::min((chunk + 1) << kChunkShift, t->capacity());
+    for (auto idx = chunk << kChunkShift; idx < end; ++idx) {
+      auto& cell = t->cells[idx];
+      auto k = cell.key.load(std::memory_order_acquire);
+      if (k == config_.emptyKey &&
+          cell.key.compare_exchange_strong(
+              k, config_.movedKey, std::memory_order_acq_rel)) {
+        continue;
+      }
+      if (k == config_.movedKey) {
+        continue;
+      }
+      // Only this thread writes the copy until the value is marked as
+      // moved, after which everyone uses the copy.
+      Cell* copy = nullptr;
+      auto v = cell.value.load(std::memory_order_acquire);
+      do {
+        if (v != config_.absentValue || copy) {
+          if (!copy) {
+            copy = &claimForCopy(n, k);
+          }
+          copy->value.store(v, std::memory_order_release);
+        }
+      } while (!cell.value.compare_exchange_weak(
+          v, config_.movedValue, std::memory_order_acq_rel));
+    }
+    t->chunks[chunk].store(kChunkDone, std::memory_order_release);
+    if (t->chunksDone.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        t->numChunks) {
+      n->reserve.store(0, std::memory_order_release);
+      capacity_.store(n->capacity(), std::memory_order_release);
+      auto expected = t;
+      if (table_.compare_exchange_strong(
+              expected, n, std::memory_order_acq_rel)) {
+        t->retire();
+      }
+    }
+  }
+
+  /// The cell of key in n, which cannot be full: its reserve keeps room
+  /// for every entry of the table it is being migrated from.
+  Cell& claimForCopy(Table* n, KeyT key) const {
+    for (size_t idx = HashFcn()(key) & n->mask;; idx = (idx + 1) & n->mask) {
+      auto& cell = n->cells[idx];
+      auto k = cell.key.load(std::memory_order_acquire);
+      if (k == config_.emptyKey &&
+          cell.key.compare_exchange_strong(
+              k, key, std::memory_order_acq_rel)) {
+        n->used.fetch_add(1, std::memory_order_relaxed);
+        return cell;
+      }
+      if (k == key) {
+        return cell;
+      }
+    }
+  }
+
+  const Config config_;
+  mutable std::atomic<Table*> table_{nullptr};
+  mutable std::atomic<size_t> capacity_{0};
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> size_{
+      0};
+};
+
+} // namespace folly
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/StringInterner.h>
+
+#include <cstring>
+#include <new>
+#include <ostream>
+
+#include <folly/Indestructible.h>
+
+namespace folly {
+
+namespace {
+
+constexpr std::size_t kMinCapacity = 64;
+
+std::size_t hashString(StringPiece s) noexcept {
+  return hasher<std::string_view>{}(std::string_view(s.data(), s.size()));
+}
+
+} // namespace
+
+std::size_t InternedString::emptyHash() noexcept {
+  static const std::size_t hash = hashString("");
+  return hash;
+}
+
+std::ostream& operator<<(std::ostream& os, InternedString s) {
+  return os << s.view();
+}
+
+StringInterner::Table::Table(std::size_t capacity)
+    : mask(capacity - 1),
+      slots(std::make_unique<std::atomic<const Entry*>[]>(capacity)) {
+  for (std::size_t i = 0; i < capacity; ++i) {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+StringInterner::StringInterner()
+    : arena_(
+          SysArena::kDefaultMinBlockSize,
+          SysArena::kNoSizeLimit,
+          alignof(Entry)) {
+  tables_.push_back(std::make_unique<Table>(kMinCapacity));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+StringInterner::~StringInterner() = default;
+
+const StringInterner::Entry* StringInterner::find(
+    const Table& table, StringPiece s, std::size_t hash) noexcept {
+  for (std::size_t i = hash;; ++i) {
+    auto entry = table.slots[i & table.mask].load(std::memory_order_acquire);
+    if (!entry) {
+      return nullptr;
+    }
+    if (entry->hash == hash && entry->size == s.size() &&
+        std::memcmp(entry->chars(), s.data(), s.size()) == 0) {
+      return entry;
+    }
+  }
+}
+
+void StringInterner::insert(Table& table, const Entry* entry) noexcept {
+  for (std::size_t i = entry->hash;; ++i) {
+    auto& slot = table.slots[i & table.mask];
+    if (!slot.load(std::memory_order_relaxed)) {
+      slot.store(entry, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+InternedString StringInterner::intern(StringPiece s) {
+  if (s.empty()) {
+    return InternedString();
+  }
+  auto const hash = hashString(s);
+  if (auto entry = find(*table_.load(std::memory_order_acquire), s, hash)) {
+    return InternedString(entry);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto table = table_.load(std::memory_order_relaxed);
+  if (auto entry = find(*table, s, hash)) {
+    return InternedString(entry);
+  }
+
+  // Keep the table at most half full, so that the probe sequences are short.
+  auto const size = size_.load(std::memory_order_relaxed);
+  if (2 * (size + 1) > table->mask + 1) {
+    auto next = std::make_unique<Table>(2 * (table->mask + 1));
+    for (std::size_t i = 0; i <= table->mask; ++i) {
+      if (auto entry = table->slots[i].load(std::memory_order_relaxed)) {
+        insert(*next, entry);
+      }
+    }
+    table = next.get();
+    tables_.push_back(std::move(next));
+    table_.store(table, std::memory_order_release);
+  }
+
+  auto storage = static_cast<char*>(
+      arena_.allocate(sizeof(Entry) + s.size() + 1));
+  auto entry = new (storage) Entry{hash, s.size()};
+  auto chars = storage + sizeof(Entry);
+  std::memcpy(chars, s.data(), s.size());
+  chars[s.size()] = '\0';
+  insert(*table, entry);
+  size_.store(size + 1, std::memory_order_relaxed);
+  return InternedString(entry);
+}
+
+Optional<InternedString> StringInterner::find(StringPiece s) const noexcept {
+  if (s.empty()) {
+    return InternedString();
+  }
+  auto const table = table_.load(std::memory_order_acquire);
+  if (auto entry = find(*table, s, hashString(s))) {
+    return InternedString(entry);
+  }
+  return none;
+}
+
+std::size_t StringInterner::totalSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t size = arena_.totalSize();
+  for (auto const& table : tables_) {
+    size += (table->mask + 1) * sizeof(std::atomic<const Entry*>);
+  }
+  return size;
+}
+
+StringInterner& StringInterner::instance() {
+  static Indestructible<StringInterner> interner;
+  return *interner;
+}
+
+} // namespace folly
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/hash/Hash.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+
+class StringInterner;
+
+/**
+ * A handle to a string interned by a StringInterner: a single pointer to the
+ * characters, their size and their hash, which stay valid as long as the
+ * interner.
+ *
+ * All the InternedStrings of an interner that are equal point to the same
+ * characters, so comparing them is comparing pointers, and hashing them
+ * returns the precomputed hash. std::hash<InternedString> is marked as
+ * avalanching, so F14 containers use the hash as is.
+ *
+ * InternedStrings from different interners must not be compared.
+ *
+ * Unlike most string types, InternedString doesn't convert implicitly to
+ * StringPiece: that would make the F14 containers hash the characters again
+ * for heterogeneous lookups. Look up the InternedString with
+ * StringInterner::find() first instead.
+ */
+class InternedString {
+ public:
+  /// The empty string, which is equal to the empty string of any interner.
+  InternedString() noexcept = default;
+
+  const char* data() const noexcept {
+    return entry_ ? entry_->chars() : "";
+  }
+  /// The characters are always null-terminated.
+  const char* c_str() const noexcept { return data(); }
+  std::size_t size() const noexcept { return entry_ ? entry_->size : 0; }
+  bool empty() const noexcept { return !entry_; }
+
+  std::string_view view() const noexcept { return {data(), size()}; }
+  StringPiece piece() const noexcept { return {data(), size()}; }
+  std::string str() const { return std::string(data(), size()); }
+
+  /// The hasher<std::string_view> hash of the string, computed once.
+  std::size_t hash() const noexcept {
+    return entry_ ? entry_->hash : emptyHash();
+  }
+
+  friend bool operator==(InternedString lhs, InternedString rhs) noexcept {
+    return lhs.entry_ == rhs.entry_;
+  }
+  friend bool operator!=(InternedString lhs, InternedString rhs) noexcept {
+    return lhs.entry_ != rhs.entry_;
+  }
+  /// Lexicographic order, as for std::string.
+  friend bool operator<(InternedString lhs, InternedString rhs) noexcept {
+    return lhs.entry_ != rhs.entry_ && lhs.view() < rhs.view();
+  }
+  friend bool operator>(InternedString lhs, InternedString rhs) noexcept {
+    return rhs < lhs;
+  }
+  friend bool operator<=(InternedString lhs, InternedString rhs) noexcept {
+    return !(rhs < lhs);
+  }
+  friend bool operator>=(InternedString lhs, InternedString rhs) noexcept {
+    return !(lhs < rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, InternedString s);
+
+ private:
+  friend class StringInterner;
+
+  // Followed by the null-terminated characters.
+  struct Entry {
+    std::size_t hash;
+    std::size_t size;
+
+    const char* chars() const noexcept {
+      return reinterpret_cast<const char*>(this + 1);
+    }
+  };
+
+  explicit InternedString(const Entry* entry) noexcept : entry_(entry) {}
+
+  static std::size_t emptyHash() noexcept;
+
+  const Entry* entry_ = nullptr;
+};
+
+/**
+ * A thread-safe set of interned strings, for deduplicating strings that are
+ * seen over and over by many threads, such as metric names or header keys.
+ *
+ * Lookups are lock-free: they probe an open-addressing table of pointers to
+ * the interned strings, which the writers only ever fill in. Interning a new
+ * string takes a mutex, copies the string to an arena along with its hash,
+ * and publishes it in the table. When the table gets too full it is replaced
+ * by a larger copy, and the old one is kept alive for the readers that may
+ * still be probing it until the interner is destroyed, which adds up to less
+ * than the size of the current table.
+ *
+ * Interned strings are never removed.
+ */
+class StringInterner {
+ public:
+  StringInterner();
+  ~StringInterner();
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  /// Returns the interned copy of s, interning it first if needed.
+  InternedString intern(StringPiece s);
+
+  /// Returns the interned copy of s, or none if it wasn't interned.
+  Optional<InternedString> find(StringPiece s) const noexcept;
+
+  /// The number of interned strings, which excludes the empty string.
+  std::size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  /// The memory used by the interned strings and by the tables.
+  std::size_t totalSize() const;
+
+  /// A process-wide interner, which is never destroyed.
+  static StringInterner& instance();
+
+ private:
+  using Entry = InternedString::Entry;
+
+  struct Table {
+    explicit Table(std::size_t capacity);
+
+    std::size_t mask;
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+  };
+
+  static const Entry* find(
+      const Table& table, StringPiece s, std::size_t hash) noexcept;
+  static void insert(Table& table, const Entry* entry) noexcept;
+
+  std::atomic<Table*> table_;
+  std::atomic<std::size_t> size_{0};
+
+  // Guards everything below, and the writes to the table.
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Table>> tables_;
+  SysArena arena_;
+};
+
+} // namespace folly
+
+namespace std {
+
+template <>
+struct hash<folly::InternedString> {
+  using folly_is_avalanching = std::true_type;
+
+  size_t operator()(folly::InternedString s) const noexcept {
+    return s.hash();
+  }
+};
+
+} // namespace std
@@ -16,16 +16,20 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <iterator>
 #include <memory>
 
 #include <glog/logging.h>
 
 #include <folly/ConstexprMath.h>
+#include <folly/Indestructible.h>
 #include <folly/Optional.h>
 #include <folly/Traits.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/container/span.h>
 #include <folly/lang/Align.h>
 #include <folly/synchronization/Hazptr.h>
 #include <folly/synchronization/SaturatingSemaphore.h>
@@ -79,6 +83,10 @@ namespace folly {
 ///     void enqueue(const T&);
 ///     void enqueue(T&&);
 ///         Adds an element to the end of the queue.
+///     void enqueue_bulk(Iter first, Iter last);
+///         Adds the elements constructed from each of [first, last)
+///         to the end of the queue, in order. Pass move iterators to
+///         enqueue via move.
 ///
 ///   Consumer operations:
 ///     void dequeue(T&);
@@ -93,6 +101,10 @@ namespace folly {
 ///     folly::Optional<T> try_dequeue_until(time_point& deadline);
 ///         Tries to extract an element from the front of the queue
 ///         if available until the specified deadline.
+///     size_t try_dequeue_bulk(span<T>);
+///         Moves as many elements as available, up to the size of the
+///         span, from the front of the queue onto the span. Returns the
+///         number of elements extracted.
 ///     bool try_dequeue_for(T&, duration&);
 ///     folly::Optional<T> try_dequeue_for(duration&);
 ///         Tries to extract an element from the front of the queue if
@@ -137,6 +149,9 @@ namespace folly {
 ///   a fixed size of 2^LgSegmentSize entries. Each segment is used
 ///   exactly once.
 /// - Each entry is composed of a futex and a single element.
+/// - Bulk operations claim a range of tickets with a single
+///   fetch_add (or compare_exchange, for multiple consumers), and then
+///   fill or drain the entries of the range one by one.
 /// - Each segment's array of entries is strided to avoid false sharing.
 ///   I.e., to reduce any cacheline contention that might be induced by
 ///   concurrent mutations to the queue that might happen to affect
@@ -177,6 +192,14 @@ namespace folly {
 ///   of a chain of removed segments.
 /// - The template parameter LgAlign can be used to reduce memory usage
 ///   at the cost of increased chance of false sharing.
+/// - Reclaimed segments are kept, up to kSegmentPoolSize of them per
+///   instantiation of UnboundedQueue, for reuse by the next segment
+///   allocation of any queue of the same type. A queue in steady state
+///   reclaims a segment for each segment it allocates, so SPSC queues,
+///   which reclaim segments as soon as they are drained, do not
+///   allocate in steady state. Other variants reclaim segments through
+///   hazard pointers, in batches, so they allocate when a batch exceeds
+///   the pool.
 ///
 /// Performance considerations:
 /// - All operations take constant time, excluding the costs of
@@ -191,6 +214,8 @@ namespace folly {
 /// - MP adds a fetch_add to the critical path of each producer operation.
 /// - MC adds a fetch_add or compare_exchange to the critical path of
 ///   each consumer operation.
+/// - enqueue_bulk and try_dequeue_bulk pay for these once per batch
+///   rather than once per element.
 /// - The possibility of consumers blocking, even if they never do,
 ///   adds a compare_exchange to the critical path of each producer
 ///   operation.
@@ -235,6 +260,7 @@ class UnboundedQueue {
   static constexpr size_t Stride = SPSC || (LgSegmentSize <= 1) ? 1 : 27;
   static constexpr size_t SegmentSize = 1u << LgSegmentSize;
   static constexpr size_t Align = 1u << LgAlign;
+  static constexpr size_t kSegmentPoolSize = 16;
 
   static_assert(
       std::is_nothrow_destructible<T>::value, "T must be nothrow_destructible");
@@ -267,7 +293,7 @@ class UnboundedQueue {
 
   /** constructor */
   UnboundedQueue()
-      : c_(new Segment(0)), p_(c_.head.load(std::memory_order_relaxed)) {}
+      : c_(newSegment(0)), p_(c_.head.load(std::memory_order_relaxed)) {}
 
   /** destructor */
   ~UnboundedQueue() {
@@ -280,6 +306,12 @@ class UnboundedQueue {
 
   FOLLY_ALWAYS_INLINE void enqueue(T&& arg) { enqueueImpl(std::move(arg)); }
 
+  /** enqueue_bulk */
+  template <typename Iter>
+  void enqueue_bulk(Iter first, Iter last) {
+    enqueueBulkImpl(first, static_cast<Ticket>(std::distance(first, last)));
+  }
+
   /** dequeue */
   FOLLY_ALWAYS_INLINE void dequeue(T& item) noexcept { item = dequeueImpl(); }
 
@@ -344,6 +376,11 @@ class UnboundedQueue {
     return tryDequeueUntil(std::chrono::steady_clock::now() + duration);
   }
 
+  /** try_dequeue_bulk */
+  size_t try_dequeue_bulk(span<T> items) noexcept {
+    return tryDequeueBulkImpl(items);
+  }
+
   /** try_peek */
   FOLLY_ALWAYS_INLINE const T* try_peek() noexcept {
     static_assert(SingleConsumer, "not single-consumer");
@@ -400,6 +437,45 @@ class UnboundedQueue {
     }
   }
 
+  /** enqueueBulkImpl */
+  template <typename Iter>
+  void enqueueBulkImpl(Iter first, Ticket n) {
+    if (n == 0) {
+      return;
+    }
+    if (SPSC) {
+      Segment* s = tail();
+      enqueueBulkCommon(s, first, n);
+    } else {
+      hazptr_holder<Atom> hptr = make_hazard_pointer<Atom>();
+      Segment* s = hptr.protect(p_.tail);
+      enqueueBulkCommon(s, first, n);
+    }
+  }
+
+  /** enqueueBulkCommon */
+  template <typename Iter>
+  void enqueueBulkCommon(Segment* s, Iter first, Ticket n) {
+    Ticket t = fetchAddProducerTicket(n);
+    for (Ticket end = t + n; t < end; ++t, ++first) {
+      s = findSegment(s, t);
+      DCHECK_GE(t, s->minTicket());
+      Entry& e = s->entry(index(t));
+      e.putItem(*first);
+      if (responsibleForAlloc(t)) {
+        allocNextSegment(s);
+      }
+      if (responsibleForAdvance(t)) {
+        // The SPSC consumer may reclaim s as soon as the tail moves past it.
+        Segment* next = s->nextSegment();
+        advanceTail(s);
+        if (SPSC) {
+          s = next;
+        }
+      }
+    }
+  }
+
   /** dequeueImpl */
   FOLLY_ALWAYS_INLINE T dequeueImpl() noexcept {
     if (SPSC) {
@@ -496,6 +572,72 @@ class UnboundedQueue {
     }
   }
 
+  /** tryDequeueBulkImpl */
+  size_t tryDequeueBulkImpl(span<T> items) noexcept {
+    if (items.empty()) {
+      return 0;
+    }
+    if (SingleConsumer) {
+      Segment* s = head();
+      Ticket t = consumerTicket();
+      auto n = availableTickets(t, items.size());
+      if (n == 0) {
+        return 0;
+      }
+      setConsumerTicket(t + n);
+      takeItems(s, t, items.first(n));
+      return n;
+    } else {
+      // Using hazptr_holder instead of hazptr_local because it is
+      //  possible to call ~T() and it may happen to use hazard pointers.
+      hazptr_holder<Atom> hptr = make_hazard_pointer<Atom>();
+      Segment* s = hptr.protect(c_.head);
+      while (true) {
+        Ticket t = consumerTicket();
+        auto n = availableTickets(t, items.size());
+        if (n == 0) {
+          return 0;
+        }
+        if (c_.ticket.compare_exchange_weak(
+                t,
+                t + n,
+                std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+          takeItems(s, t, items.first(n));
+          return n;
+        }
+      }
+    }
+  }
+
+  /** availableTickets */
+  FOLLY_ALWAYS_INLINE size_t availableTickets(Ticket t, size_t max) noexcept {
+    // Like try_dequeue, count tickets of enqueues that are still in
+    // progress, takeItems waits for them.
+    Ticket p = producerTicket();
+    return p > t ? static_cast<size_t>(std::min<Ticket>(p - t, max)) : 0;
+  }
+
+  /** takeItems */
+  void takeItems(Segment* s, Ticket t, span<T> items) noexcept {
+    for (auto& item : items) {
+      if (!SingleConsumer) {
+        s = findSegment(s, t);
+      }
+      DCHECK_GE(t, s->minTicket());
+      DCHECK_LT(t, s->minTicket() + SegmentSize);
+      item = s->entry(index(t)).takeItem();
+      if (responsibleForAdvance(t)) {
+        advanceHead(s);
+        if (SingleConsumer) {
+          // advanceHead reclaimed s.
+          s = head();
+        }
+      }
+      ++t;
+    }
+  }
+
   /** tryDequeueWaitElem */
   template <typename Clock, typename Duration>
   FOLLY_ALWAYS_INLINE bool tryDequeueWaitElem(
@@ -564,17 +706,27 @@ class UnboundedQueue {
   /** allocNextSegment */
   Segment* allocNextSegment(Segment* s) {
     auto t = s->minTicket() + SegmentSize;
-    Segment* next = new Segment(t);
+    Segment* next = newSegment(t);
     next->set_cohort_no_tag(&c_.cohort); // defined in hazptr_obj
     next->acquire_ref_safe(); // defined in hazptr_obj_base_linked
     if (!s->casNextSegment(next)) {
-      delete next;
+      segmentPool().put(next);
       next = s->nextSegment();
     }
     DCHECK(next);
     return next;
   }
 
+  /** newSegment */
+  static Segment* newSegment(Ticket t) {
+    Segment* s = segmentPool().get();
+    if (s) {
+      s->~Segment();
+      return new (s) Segment(t);
+    }
+    return new Segment(t);
+  }
+
   /** advanceTail */
   void advanceTail(Segment* s) noexcept {
     if (SPSC) {
@@ -645,7 +797,7 @@ class UnboundedQueue {
   /** reclaimSegment */
   void reclaimSegment(Segment* s) noexcept {
     if (SPSC) {
-      delete s;
+      segmentPool().put(s);
     } else {
       s->retire(); // defined in hazptr_obj_base_linked
     }
@@ -748,12 +900,16 @@ class UnboundedQueue {
   }
 
   FOLLY_ALWAYS_INLINE Ticket fetchIncrementProducerTicket() noexcept {
+    return fetchAddProducerTicket(1);
+  }
+
+  FOLLY_ALWAYS_INLINE Ticket fetchAddProducerTicket(Ticket n) noexcept {
     if (SingleProducer) {
       Ticket oldval = producerTicket();
-      setProducerTicket(oldval + 1);
+      setProducerTicket(oldval + n);
       return oldval;
     } else { // MP
-      return p_.ticket.fetch_add(1, std::memory_order_acq_rel);
+      return p_.ticket.fetch_add(n, std::memory_order_acq_rel);
     }
   }
 
@@ -804,10 +960,69 @@ class UnboundedQueue {
     }
   }; // Entry
 
+  /**
+   *  SegmentPool
+   *
+   *  Keeps reclaimed segments for reuse. Segments retired through hazard
+   *  pointers may be reclaimed after their queue is destroyed, so the pool
+   *  is shared by all queues of the same type and never destroyed. Each
+   *  side takes a slot with a single atomic operation.
+   */
+  class SegmentPool {
+    Atom<Segment*> segments_[kSegmentPoolSize];
+
+   public:
+    SegmentPool() noexcept {
+      for (auto& slot : segments_) {
+        slot.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    /* Returns a segment to be destroyed and reconstructed, or nullptr. */
+    Segment* get() noexcept {
+      for (auto& slot : segments_) {
+        if (slot.load(std::memory_order_relaxed)) {
+          Segment* s = slot.exchange(nullptr, std::memory_order_acquire);
+          if (s) {
+            return s;
+          }
+        }
+      }
+      return nullptr;
+    }
+
+    /* Keeps the segment if there is room, deletes it otherwise. */
+    void put(Segment* s) noexcept {
+      for (auto& slot : segments_) {
+        Segment* expected = nullptr;
+        if (!slot.load(std::memory_order_relaxed) &&
+            slot.compare_exchange_strong(
+                expected,
+                s,
+                std::memory_order_release,
+                std::memory_order_relaxed)) {
+          return;
+        }
+      }
+      delete s;
+    }
+  }; // SegmentPool
+
+  static SegmentPool& segmentPool() noexcept {
+    static Indestructible<SegmentPool> pool;
+    return *pool;
+  }
+
+  /* Used by hazptr to reclaim segments. */
+  struct SegmentDeleter {
+    void operator()(Segment* s) const noexcept { segmentPool().put(s); }
+  };
+
   /**
    *  Segment
    */
-  class Segment : public hazptr_obj_base_linked<Segment, Atom> {
+  class Segment
+      : public hazptr_obj_base_linked<Segment, Atom, SegmentDeleter> {
     Atom<Segment*> next_{nullptr};
     const Ticket min_;
     alignas(Align) Entry b_[SegmentSize];
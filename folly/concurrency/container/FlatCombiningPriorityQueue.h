@@ -16,20 +16,51 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <type_traits>
+#include <vector>
 
 #include <glog/logging.h>
 
 #include <folly/Optional.h>
+#include <folly/Traits.h>
+#include <folly/container/span.h>
 #include <folly/detail/Futex.h>
 #include <folly/synchronization/FlatCombining.h>
 
 namespace folly {
 
+namespace detail {
+
+/// Combining request of FlatCombiningPriorityQueue push and pop operations
+template <typename T>
+struct FlatCombiningPriorityQueueReq {
+  enum class Op { kPush, kPop };
+  Op op;
+  const T* pushVal;
+  T* popVal;
+  bool res;
+  bool wake;
+};
+
+template <typename PriorityQueue, typename = void>
+struct flat_combining_pq_compare {
+  using type = void;
+};
+template <typename PriorityQueue>
+struct flat_combining_pq_compare<
+    PriorityQueue,
+    void_t<typename PriorityQueue::value_compare>> {
+  using type = typename PriorityQueue::value_compare;
+};
+
+} // namespace detail
+
 /// Thread-safe priority queue based on flat combining. If the
 /// constructor parameter maxSize is greater than 0 (default = 0),
 /// then the queue is bounded. This template provides blocking,
@@ -49,6 +80,12 @@ namespace folly {
 /// requested by other threads. For more details see the comments for
 /// FlatCombining.
 ///
+/// Concurrent push() and pop() operations are combined as a batch. If
+/// PriorityQueue has a stateless value_compare, as std::priority_queue
+/// with the default comparator does, a pop() is served directly from a
+/// concurrent push() of an item that would be at the top of the
+/// queue, without the push and pop of the underlying PriorityQueue.
+///
 /// Usage examples:
 /// @code
 ///   FlatCombiningPriorityQueue<int> pq(1);
@@ -81,9 +118,18 @@ class FlatCombiningPriorityQueue
     : public folly::FlatCombining<
           FlatCombiningPriorityQueue<T, PriorityQueue, Mutex, Atom>,
           Mutex,
-          Atom> {
+          Atom,
+          detail::FlatCombiningPriorityQueueReq<T>> {
   using FCPQ = FlatCombiningPriorityQueue<T, PriorityQueue, Mutex, Atom>;
-  using FC = folly::FlatCombining<FCPQ, Mutex, Atom>;
+  using Req = detail::FlatCombiningPriorityQueueReq<T>;
+  using FC = folly::FlatCombining<FCPQ, Mutex, Atom, Req>;
+  using Rec = typename FC::Rec;
+  using Compare =
+      typename detail::flat_combining_pq_compare<PriorityQueue>::type;
+  friend FC;
+
+  static constexpr bool kCanEliminate = std::is_empty<Compare>::value &&
+      std::is_default_constructible<Compare>::value;
 
  public:
   template <
@@ -247,6 +293,10 @@ class FlatCombiningPriorityQueue
   PriorityQueue pq_;
   detail::Futex<Atom> empty_{};
   detail::Futex<Atom> full_{};
+  // The push and pop requests of the current combining batch, only accessed
+  // by the combiner
+  std::vector<Rec*> pushes_;
+  std::vector<Rec*> pops_;
 
   bool isTrue(detail::Futex<Atom>& futex) {
     return futex.load(std::memory_order_relaxed) != 0;
@@ -265,6 +315,114 @@ class FlatCombiningPriorityQueue
     }
   }
 
+  void pushOp(const T& val, bool& res, bool& wake) {
+    if (maxSize_ > 0 && pq_.size() == maxSize_) {
+      setFutex(full_, 1);
+      res = false;
+      return;
+    }
+    DCHECK(maxSize_ == 0 || pq_.size() < maxSize_);
+    try {
+      pq_.push(val);
+      wake = futexSignal(empty_);
+      res = true;
+      return;
+    } catch (const std::bad_alloc&) {
+      setFutex(full_, 1);
+      res = false;
+      return;
+    }
+  }
+
+  void popOp(T& val, bool& res, bool& wake) {
+    res = !pq_.empty();
+    if (res) {
+      val = pq_.top();
+      pq_.pop();
+      wake = futexSignal(full_);
+    } else {
+      setFutex(empty_, 1);
+    }
+  }
+
+  // Whether a pop() can take the given item of a concurrent push() instead of
+  // the top of the queue, linearizing the pop() right after the push()
+  bool canEliminate(const T& val) {
+    if constexpr (kCanEliminate) {
+      return (maxSize_ == 0 || pq_.size() < maxSize_) &&
+          (pq_.empty() || !Compare()(val, pq_.top()));
+    } else {
+      return false;
+    }
+  }
+
+  // custom combined op processing - overrides FlatCombining::combinedOp(Req&)
+  void combinedOp(Req& req) {
+    if (req.op == Req::Op::kPush) {
+      pushOp(*req.pushVal, req.res, req.wake);
+    } else {
+      popOp(*req.popVal, req.res, req.wake);
+    }
+  }
+
+  // overrides FlatCombining::combineBatch(). The operations in the batch are
+  // concurrent, so they can be applied in any order.  Pushes are sorted from
+  // the highest priority, and each pop takes either the next of them or the
+  // top of the queue, whichever is higher.  Only the remaining pushes touch
+  // the queue
+  void combineBatch(span<Rec* const> batch) {
+    pushes_.clear();
+    pops_.clear();
+    for (auto rec : batch) {
+      if (rec->getFn()) {
+        this->processReq(*rec);
+      } else if (rec->getReq().op == Req::Op::kPush) {
+        pushes_.push_back(rec);
+      } else {
+        pops_.push_back(rec);
+      }
+    }
+
+    size_t eliminated = 0;
+    if constexpr (kCanEliminate) {
+      if (!pops_.empty() && pushes_.size() > 1) {
+        std::sort(pushes_.begin(), pushes_.end(), [](Rec* a, Rec* b) {
+          return Compare()(*b->getReq().pushVal, *a->getReq().pushVal);
+        });
+      }
+    } else {
+      // Without elimination, pushes first give the pops a chance to succeed
+      for (auto rec : pushes_) {
+        auto& req = rec->getReq();
+        pushOp(*req.pushVal, req.res, req.wake);
+        this->completeReq(*rec);
+      }
+      pushes_.clear();
+    }
+
+    for (auto rec : pops_) {
+      auto& req = rec->getReq();
+      if (eliminated < pushes_.size() &&
+          canEliminate(*pushes_[eliminated]->getReq().pushVal)) {
+        auto& push = pushes_[eliminated++]->getReq();
+        *req.popVal = *push.pushVal;
+        req.res = push.res = true;
+        req.wake = push.wake = false;
+      } else {
+        popOp(*req.popVal, req.res, req.wake);
+      }
+      this->completeReq(*rec);
+    }
+
+    for (size_t i = 0; i < pushes_.size(); ++i) {
+      if (i >= eliminated) {
+        auto& req = pushes_[i]->getReq();
+        pushOp(*req.pushVal, req.res, req.wake);
+      }
+      this->completeReq(*pushes_[i]);
+    }
+  }
+
   template <typename Clock, typename Duration>
   bool try_push_impl(
       const T& val, const std::chrono::time_point<Clock, Duration>& when);
@@ -294,25 +452,16 @@ FlatCombiningPriorityQueue<T, PriorityQueue, Mutex, Atom>::try_push_impl(
     bool res;
     bool wake;
 
-    auto fn = [&] {
-      if (maxSize_ > 0 && pq_.size() == maxSize_) {
-        setFutex(full_, 1);
-        res = false;
-        return;
-      }
-      DCHECK(maxSize_ == 0 || pq_.size() < maxSize_);
-      try {
-        pq_.push(val);
-        wake = futexSignal(empty_);
-        res = true;
-        return;
-      } catch (const std::bad_alloc&) {
-        setFutex(full_, 1);
-        res = false;
-        return;
-      }
+    auto fn = [&] { pushOp(val, res, wake); };
+    auto fill = [&](Req& req) {
+      req.op = Req::Op::kPush;
+      req.pushVal = &val;
     };
-    this->requestFC(fn);
+    auto result = [&](Req& req) {
+      res = req.res;
+      wake = req.wake;
+    };
+    this->requestFC(fn, fill, result);
 
     if (res) {
       if (wake) {
@@ -351,17 +500,16 @@ FlatCombiningPriorityQueue<T, PriorityQueue, Mutex, Atom>::try_pop_impl(
     bool res;
     bool wake;
 
-    auto fn = [&] {
-      res = !pq_.empty();
-      if (res) {
-        val = pq_.top();
-        pq_.pop();
-        wake = futexSignal(full_);
-      } else {
-        setFutex(empty_, 1);
-      }
+    auto fn = [&] { popOp(val, res, wake); };
+    auto fill = [&](Req& req) {
+      req.op = Req::Op::kPop;
+      req.popVal = &val;
     };
-    this->requestFC(fn);
+    auto result = [&](Req& req) {
+      res = req.res;
+      wake = req.wake;
+    };
+    this->requestFC(fn, fill, result);
 
     if (res) {
       if (wake) {
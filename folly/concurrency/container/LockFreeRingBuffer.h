@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <memory>
@@ -159,6 +160,33 @@ class LockFreeRingBuffer {
     return slots_[idx(cursor.ticket)].waitAndTryRead(dest, turn(cursor.ticket));
   }
 
+  /// Read up to count consecutive values, starting at the cursor, into
+  /// dest[0..count). Stops at the first write that has not occurred yet or
+  /// has been overwritten, and moves the cursor past the values read.
+  /// Returns the number of values read, all of which are consistent. A
+  /// reader that finds the first value overwritten is lagging behind, and
+  /// may restart from currentTail().
+  template <typename V>
+  size_t tryReadBatch(V* dest, size_t count, Cursor& cursor) const noexcept {
+    uint64_t head = ticket_.load();
+    if (cursor.ticket >= head) {
+      return 0;
+    }
+    count = std::min<uint64_t>(count, head - cursor.ticket);
+    uint32_t index = idx(cursor.ticket);
+    uint32_t slotTurn = turn(cursor.ticket);
+    size_t read = 0;
+    while (read < count && slots_[index].tryRead(dest[read], slotTurn)) {
+      ++read;
+      if (++index == capacity_) {
+        index = 0;
+        ++slotTurn;
+      }
+    }
+    cursor.moveForward(read);
+    return read;
+  }
+
   /// Returns a Cursor pointing to the first write that has not occurred yet.
   Cursor currentHead() const noexcept { return Cursor(ticket_.load()); }
 
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <folly/Random.h>
+#include <folly/SpinLock.h>
+#include <folly/container/span.h>
+#include <folly/lang/Align.h>
+
+/// ------ MultiQueue ------
+// A relaxed concurrent priority queue following the MultiQueue design
+// (MultiQueues: Simple Relaxed Concurrent Priority Queues, by Hamza
+// Rihani, Peter Sanders and Roman Dementiev, SPAA 2015).
+//
+/// --- Design ---
+// The queue is made of c*p sequential binary heaps, each behind a spin lock
+// that is only ever try-locked: an operation that finds a heap locked moves
+// on to another one instead of waiting.
+// - push() inserts into one heap.
+// - pop() looks at the cached top priorities of two heaps, and pops from the
+//   one whose top comes first. With c*p heaps for p threads, the popped
+//   element is among the O(c*p) first ones with high probability.
+// - Each thread sticks to the same heaps for a few operations before it
+//   draws new ones at random, which keeps them in its cache (stickiness).
+//   Finding a heap locked or empty ends the streak early.
+// - pushBatch() and tryPopBatch() move several elements under one lock.
+//
+// Elements with the same priority in the same heap come out in FIFO order;
+// across heaps there is no such guarantee.
+//
+/// --- Interface ---
+//  void push(Priority priority, T value)
+//  void pushBatch(Priority priority, span<T> values)
+//  std::optional<T> tryPop()
+//  size_t tryPopBatch(T* out, size_t max)
+//  size_t size()
+//  bool empty()
+
+namespace folly {
+
+template <
+    typename T,
+    typename Priority = int64_t,
+    typename Compare = std::less<Priority>>
+class MultiQueue {
+  static_assert(
+      std::atomic<Priority>::is_always_lock_free,
+      "The top priority of each heap is cached in an atomic");
+
+ public:
+  /// Number of consecutive operations a thread performs on the same heaps.
+  static constexpr uint32_t kStickiness = 8;
+
+  /// Builds c heaps per hardware thread when numQueues is 0.
+  explicit MultiQueue(size_t numQueues = 0, size_t c = 2)
+      : numQueues_(
+            numQueues ? numQueues
+                      : std::max<size_t>(
+                            2,
+                            c *
+                                std::max(
+                                    1u, std::thread::hardware_concurrency()))),
+        heaps_(std::make_unique<Heap[]>(numQueues_)) {}
+
+  MultiQueue(const MultiQueue&) = delete;
+  MultiQueue& operator=(const MultiQueue&) = delete;
+
+  size_t numQueues() const { return numQueues_; }
+
+  /// Elements are popped highest priority first, as ordered by Compare.
+  void push(Priority priority, T value) {
+    auto& heap = lockForPush();
+    heap.push(priority, std::move(value));
+    heap.lock.unlock();
+  }
+
+  /// Pushes all values, moving them out of the span, with one lock.
+  void pushBatch(Priority priority, span<T> values) {
+    if (values.empty()) {
+      return;
+    }
+    auto& heap = lockForPush();
+    for (auto& value : values) {
+      heap.push(priority, std::move(value));
+    }
+    heap.lock.unlock();
+  }
+
+  /// Pops an element among the first ones. Returns none only if every heap
+  /// was seen empty.
+  std::optional<T> tryPop() {
+    std::optional<T> value;
+    tryPopImpl([&](Heap& heap) {
+      value.emplace(heap.pop());
+      return size_t(1);
+    });
+    return value;
+  }
+
+  /// Pops up to max elements, from the top of a single heap, into out.
+  /// Returns the number of elements popped, 0 only if every heap was seen
+  /// empty.
+  size_t tryPopBatch(T* out, size_t max) {
+    if (max == 0) {
+      return 0;
+    }
+    return tryPopImpl([&](Heap& heap) {
+      size_t n = 0;
+      while (n < max && !heap.entries.empty()) {
+        out[n++] = heap.pop();
+      }
+      return n;
+    });
+  }
+
+  size_t size() const {
+    size_t n = 0;
+    for (size_t i = 0; i < numQueues_; ++i) {
+      n += heaps_[i].size.load(std::memory_order_relaxed);
+    }
+    return n;
+  }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  struct Entry {
+    Priority priority;
+    uint64_t seq;
+    T value;
+  };
+
+  // Whether a comes out after b: lower priority, or same priority and
+  // pushed later.
+  struct EntryLess {
+    bool operator()(const Entry& a, const Entry& b) const {
+      Compare less;
+      if (less(a.priority, b.priority)) {
+        return true;
+      }
+      if (less(b.priority, a.priority)) {
+        return false;
+      }
+      return a.seq > b.seq;
+    }
+  };
+
+  struct alignas(hardware_destructive_interference_size) Heap {
+    SpinLock lock;
+    // Written under the lock, read without it to pick a heap.
+    std::atomic<size_t> size{0};
+    std::atomic<Priority> top{};
+    std::vector<Entry> entries;
+    uint64_t seq{0};
+
+    void push(Priority priority, T value) {
+      entries.push_back(Entry{priority, seq++, std::move(value)});
+      std::push_heap(entries.begin(), entries.end(), EntryLess());
+      publish();
+    }
+
+    T pop() {
+      std::pop_heap(entries.begin(), entries.end(), EntryLess());
+      T value = std::move(entries.back().value);
+      entries.pop_back();
+      publish();
+      return value;
+    }
+
+    void publish() {
+      if (!entries.empty()) {
+        top.store(entries.front().priority, std::memory_order_relaxed);
+      }
+      size.store(entries.size(), std::memory_order_release);
+    }
+  };
+
+  struct Sticky {
+    uint32_t push = 0;
+    uint32_t pushUses = 0;
+    uint32_t pop[2] = {0, 0};
+    uint32_t popUses = 0;
+  };
+
+  static Sticky& sticky() {
+    static thread_local Sticky sticky;
+    return sticky;
+  }
+
+  size_t randomQueue() const { return folly::Random::rand32(numQueues_); }
+
+  Heap& lockForPush() {
+    auto& s = sticky();
+    while (true) {
+      if (s.pushUses == 0) {
+        s.push = randomQueue();
+        s.pushUses = kStickiness;
+      }
+      auto& heap = heaps_[s.push % numQueues_];
+      if (heap.lock.try_lock()) {
+        --s.pushUses;
+        return heap;
+      }
+      s.pushUses = 0;
+    }
+  }
+
+  // Whether a has an element that comes out before the top of b.
+  static bool before(const Heap& a, const Heap& b) {
+    if (a.size.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    if (b.size.load(std::memory_order_acquire) == 0) {
+      return true;
+    }
+    return !Compare()(
+        a.top.load(std::memory_order_relaxed),
+        b.top.load(std::memory_order_relaxed));
+  }
+
+  template <typename PopFn>
+  size_t tryPopImpl(PopFn popFn) {
+    auto& s = sticky();
+    // Two-choice attempts before falling back to a full scan.
+    for (size_t attempt = 0; attempt < 2 * numQueues_; ++attempt) {
+      if (s.popUses == 0) {
+        s.pop[0] = randomQueue();
+        s.pop[1] = randomQueue();
+        s.popUses = kStickiness;
+      }
+      auto& a = heaps_[s.pop[0] % numQueues_];
+      auto& b = heaps_[s.pop[1] % numQueues_];
+      auto& heap = before(b, a) ? b : a;
+      if (heap.size.load(std::memory_order_acquire) == 0) {
+        s.popUses = 0;
+        if (attempt >= 2) {
+          break;
+        }
+        continue;
+      }
+      if (auto n = tryPopFrom(heap, popFn)) {
+        --s.popUses;
+        return n;
+      }
+      s.popUses = 0;
+    }
+    // The heaps drawn were empty or busy: look at all of them.
+    while (true) {
+      bool sawElements = false;
+      for (size_t i = 0; i < numQueues_; ++i) {
+        auto& heap = heaps_[i];
+        if (heap.size.load(std::memory_order_acquire) == 0) {
+          continue;
+        }
+        sawElements = true;
+        if (auto n = tryPopFrom(heap, popFn)) {
+          return n;
+        }
+      }
+      if (!sawElements) {
+        return 0;
+      }
+    }
+  }
+
+  template <typename PopFn>
+  static size_t tryPopFrom(Heap& heap, PopFn& popFn) {
+    std::unique_lock<SpinLock> lock(heap.lock, std::try_to_lock);
+    if (!lock.owns_lock() || heap.entries.empty()) {
+      return 0;
+    }
+    return popFn(heap);
+  }
+
+  const size_t numQueues_;
+  const std::unique_ptr<Heap[]> heaps_;
+};
+
+} // namespace folly
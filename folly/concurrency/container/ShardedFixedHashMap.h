@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/concurrency/container/SingleWriterFixedHashMap.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+
+#include <glog/logging.h>
+
+namespace folly {
+
+/// ShardedFixedHashMap:
+///
+/// Multi-writer counterpart of SingleWriterFixedHashMap. Keys are spread
+/// over a power-of-two number of shards, each a SingleWriterFixedHashMap
+/// whose writers are serialized by a mutex of its own. Writers of
+/// different shards do not contend, and readers never take the mutexes:
+/// lookup and iteration are as concurrent as in SingleWriterFixedHashMap.
+///
+/// Since no caller could check for room without racing the other writers,
+/// insert() does it itself, and fails when the shard of the key has no
+/// empty slot left. Each shard gets an equal part of the capacity. As in
+/// SingleWriterFixedHashMap, tombstones keep their slot, so a map with many
+/// distinct keys coming and going must be replaced by a fresh copy from
+/// time to time.
+///
+/// Iteration visits the shards in turn. It sees each key at most once,
+/// but since the shards are not snapshotted together, it is not atomic
+/// with respect to writers.
+///
+template <typename Key, typename Value>
+class ShardedFixedHashMap {
+  using Map = SingleWriterFixedHashMap<Key, Value>;
+
+  struct alignas(hardware_destructive_interference_size) Shard {
+    explicit Shard(size_t capacity) : map(capacity) {}
+
+    std::mutex mutex;
+    Map map;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t shift_;
+
+ public:
+  class Iterator;
+
+  /// Splits at least capacity slots over shards shards, both rounded up to
+  /// powers of two.
+  explicit ShardedFixedHashMap(size_t capacity, size_t shards = 16)
+      : shift_(64 - folly::findLastSet(folly::nextPowTwo(shards) - 1)) {
+    shards = folly::nextPowTwo(shards);
+    auto perShard = (capacity + shards - 1) / shards;
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(perShard));
+    }
+  }
+
+  /// Copies o into fresh shards of at least capacity slots in total, which
+  /// drops its tombstones. o must not be mutated concurrently.
+  ShardedFixedHashMap(size_t capacity, const ShardedFixedHashMap& o)
+      : ShardedFixedHashMap(capacity, o.numShards()) {
+    for (size_t i = 0; i < numShards(); ++i) {
+      auto& map = shards_[i]->map;
+      for (auto it = o.shards_[i]->map.begin(); it != o.shards_[i]->map.end();
+           ++it) {
+        CHECK(map.available() > 0) << "No available slots";
+        map.insert(it.key(), it.value());
+      }
+    }
+  }
+
+  FOLLY_ALWAYS_INLINE Iterator begin() const { return Iterator(*this, 0); }
+
+  FOLLY_ALWAYS_INLINE Iterator end() const {
+    return Iterator(*this, numShards());
+  }
+
+  size_t numShards() const { return shards_.size(); }
+
+  size_t capacity() const { return numShards() * shards_[0]->map.capacity(); }
+
+  /* data-race-free, but not a snapshot of all shards at once */
+  size_t size() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+      size += shard->map.size();
+    }
+    return size;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// Returns true if the key was inserted, false if it was already present
+  /// or its shard has no room for it.
+  bool insert(Key key, Value value) {
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.map.available() == 0) {
+      return false;
+    }
+    return shard.map.insert(key, value);
+  }
+
+  bool erase(Key key) {
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.erase(key);
+  }
+
+  FOLLY_ALWAYS_INLINE Iterator find(Key key) const {
+    auto index = shardIndex(key);
+    auto& map = shards_[index]->map;
+    auto it = map.find(key);
+    return it == map.end() ? end() : Iterator(*this, index, it);
+  }
+
+  FOLLY_ALWAYS_INLINE bool contains(Key key) const {
+    return shards_[shardIndex(key)]->map.contains(key);
+  }
+
+ private:
+  FOLLY_ALWAYS_INLINE size_t shardIndex(Key key) const {
+    // SingleWriterFixedHashMap indexes by the low bits of std::hash, which
+    // is often the identity, so pick the shard from the top bits of a mix.
+    if (numShards() == 1) {
+      return 0;
+    }
+    auto h = folly::hash::twang_mix64(uint64_t(std::hash<Key>()(key)));
+    return size_t(h >> shift_);
+  }
+
+  Shard& shardOf(Key key) { return *shards_[shardIndex(key)]; }
+
+ public:
+  /// Iterator
+  class Iterator {
+    const ShardedFixedHashMap* map_;
+    size_t shard_;
+    typename Map::Iterator it_;
+
+   public:
+    FOLLY_ALWAYS_INLINE Key key() const { return it_.key(); }
+
+    FOLLY_ALWAYS_INLINE Value value() const { return it_.value(); }
+
+    FOLLY_ALWAYS_INLINE Iterator& operator++() {
+      DCHECK_LT(shard_, map_->numShards());
+      ++it_;
+      next();
+      return *this;
+    }
+
+    FOLLY_ALWAYS_INLINE bool operator==(const Iterator& o) const {
+      DCHECK_EQ(map_, o.map_);
+      return shard_ == o.shard_ &&
+          (shard_ == map_->numShards() || it_ == o.it_);
+    }
+
+    FOLLY_ALWAYS_INLINE bool operator!=(const Iterator& o) const {
+      return !(*this == o);
+    }
+
+   private:
+    friend class ShardedFixedHashMap;
+
+    Iterator(const ShardedFixedHashMap& m, size_t shard)
+        : Iterator(
+              m,
+              shard,
+              shard < m.numShards() ? m.shards_[shard]->map.begin()
+                                    : m.shards_.back()->map.end()) {
+      next();
+    }
+
+    Iterator(
+        const ShardedFixedHashMap& m, size_t shard, typename Map::Iterator it)
+        : map_(&m), shard_(shard), it_(it) {}
+
+    FOLLY_ALWAYS_INLINE void next() {
+      while (shard_ < map_->numShards() &&
+             it_ == map_->shards_[shard_]->map.end()) {
+        if (++shard_ < map_->numShards()) {
+          it_ = map_->shards_[shard_]->map.begin();
+        }
+      }
+    }
+  }; // Iterator
+}; // ShardedFixedHashMap
+
+} // namespace folly
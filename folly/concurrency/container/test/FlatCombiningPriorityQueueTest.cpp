@@ -16,6 +16,7 @@
 
 #include <folly/concurrency/container/FlatCombiningPriorityQueue.h>
 
+#include <algorithm>
 #include <condition_variable>
 #include <iomanip>
 #include <mutex>
@@ -272,6 +273,43 @@ TEST(FCPriQueue, pushPop) {
   }
 }
 
+TEST(FCPriQueue, batchPushPop) {
+  // Concurrent pushes and pops are combined in batches, where pops may be
+  // served directly from concurrent pushes. Every item must still be popped
+  // exactly once.
+  constexpr int kThreads = 8;
+  constexpr int kOps = 10000;
+  for (bool dedicated : {true, false}) {
+    FCPQ pq(0, dedicated);
+    std::vector<std::vector<int>> popped(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < kOps; ++i) {
+          pq.push(t * kOps + i);
+          int v;
+          pq.pop(v);
+          popped[t].push_back(v);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    EXPECT_TRUE(pq.empty());
+
+    std::vector<int> all;
+    for (auto& p : popped) {
+      all.insert(all.end(), p.begin(), p.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(kThreads * kOps, all.size());
+    for (int i = 0; i < kThreads * kOps; ++i) {
+      EXPECT_EQ(i, all[i]);
+    }
+  }
+}
+
 enum Exp {
   NoFC,
   FCNonBlock,
@@ -66,6 +66,41 @@ TEST(LockFreeRingBuffer, writeReadSequentiallyBackward) {
   }
 }
 
+TEST(LockFreeRingBuffer, readBatch) {
+  const int capacity = 8;
+  LockFreeRingBuffer<int> rb(capacity);
+  int dest[2 * capacity] = {};
+
+  auto cur = rb.currentHead();
+  EXPECT_EQ(0, rb.tryReadBatch(dest, capacity, cur));
+
+  for (int i = 0; i < 5; i++) {
+    rb.write(i);
+  }
+  // Reads stop at the head.
+  EXPECT_EQ(5, rb.tryReadBatch(dest, 2 * capacity, cur));
+  EXPECT_EQ(rb.currentHead(), cur);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(i, dest[i]);
+  }
+
+  for (int i = 5; i < 13; i++) {
+    rb.write(i);
+  }
+  // Writes 0..4 have been overwritten.
+  auto lagging = LockFreeRingBuffer<int>::Cursor(0);
+  EXPECT_EQ(0, rb.tryReadBatch(dest, capacity, lagging));
+  EXPECT_EQ(LockFreeRingBuffer<int>::Cursor(0), lagging);
+
+  // Batches wrap around the end of the buffer.
+  cur = rb.currentTail();
+  EXPECT_EQ(3, rb.tryReadBatch(dest, 3, cur));
+  EXPECT_EQ(5, rb.tryReadBatch(dest + 3, capacity, cur));
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_EQ(i + 5, dest[i]);
+  }
+}
+
 TEST(LockFreeRingBuffer, readsCanBlock) {
   // Start a reader thread, confirm that reading can block
   std::atomic<bool> readerHasRun(false);
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/container/MultiQueue.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(MultiQueue, singleQueueIsExact) {
+  MultiQueue<std::string, int> q(1);
+  EXPECT_EQ(1, q.numQueues());
+  EXPECT_TRUE(q.empty());
+  EXPECT_FALSE(q.tryPop().has_value());
+  q.push(1, "b");
+  q.push(3, "a");
+  q.push(1, "c");
+  q.push(-5, "d");
+  EXPECT_EQ(4, q.size());
+  // Highest priority first, FIFO within a priority.
+  EXPECT_EQ("a", q.tryPop().value());
+  EXPECT_EQ("b", q.tryPop().value());
+  EXPECT_EQ("c", q.tryPop().value());
+  EXPECT_EQ("d", q.tryPop().value());
+  EXPECT_FALSE(q.tryPop().has_value());
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(MultiQueue, compare) {
+  MultiQueue<int, int, std::greater<int>> q(1);
+  for (int i : {5, 2, 8, 1}) {
+    q.push(i, i);
+  }
+  for (int i : {1, 2, 5, 8}) {
+    EXPECT_EQ(i, q.tryPop().value());
+  }
+}
+
+TEST(MultiQueue, batch) {
+  MultiQueue<int> q(4);
+  std::vector<int> in = {1, 2, 3, 4, 5};
+  q.pushBatch(7, in);
+  q.pushBatch(7, {});
+  EXPECT_EQ(5, q.size());
+  // The batch went to a single heap, in order.
+  int out[8];
+  EXPECT_EQ(5, q.tryPopBatch(out, 8));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i + 1, out[i]);
+  }
+  EXPECT_EQ(0, q.tryPopBatch(out, 8));
+  EXPECT_EQ(0, q.tryPopBatch(out, 0));
+}
+
+TEST(MultiQueue, manyQueuesFindEverything) {
+  MultiQueue<int> q(64);
+  constexpr int kN = 1000;
+  for (int i = 0; i < kN; ++i) {
+    q.push(i % 10, i);
+  }
+  EXPECT_EQ(kN, q.size());
+  std::vector<bool> seen(kN);
+  for (int i = 0; i < kN; ++i) {
+    auto v = q.tryPop();
+    ASSERT_TRUE(v.has_value());
+    EXPECT_FALSE(seen[*v]);
+    seen[*v] = true;
+  }
+  EXPECT_FALSE(q.tryPop().has_value());
+}
+
+TEST(MultiQueue, relaxedOrder) {
+  // Popped priorities are mostly decreasing: two-choice keeps the rank error
+  // small even though each pop only looks at two heaps.
+  MultiQueue<int> q(8);
+  constexpr int kN = 10000;
+  for (int i = 0; i < kN; ++i) {
+    q.push((i * 7919) % kN, (i * 7919) % kN);
+  }
+  int64_t rankError = 0;
+  int expected = kN - 1;
+  while (auto v = q.tryPop()) {
+    rankError += std::abs(*v - expected--);
+  }
+  EXPECT_EQ(-1, expected);
+  EXPECT_LT(rankError / kN, 100);
+}
+
+TEST(MultiQueue, concurrentPushPop) {
+  constexpr int kThreads = 8;
+  constexpr int kPerThread = 20000;
+  MultiQueue<int> q(16);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      int64_t local = 0;
+      for (int i = 0; i < kPerThread; ++i) {
+        q.push(i % 100, 1);
+        if (i % 2 == t % 2) {
+          if (auto v = q.tryPop()) {
+            local += *v;
+            ++popped;
+          }
+        }
+      }
+      sum += local;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (auto v = q.tryPop()) {
+    sum += *v;
+    ++popped;
+  }
+  EXPECT_EQ(kThreads * kPerThread, sum.load());
+  EXPECT_EQ(kThreads * kPerThread, popped.load());
+  EXPECT_TRUE(q.empty());
+}
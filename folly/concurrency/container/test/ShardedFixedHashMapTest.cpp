@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/container/ShardedFixedHashMap.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using SFHM = folly::ShardedFixedHashMap<int, int>;
+
+TEST(ShardedFixedHashMap, basic) {
+  SFHM m(64, 4);
+  EXPECT_EQ(4, m.numShards());
+  EXPECT_EQ(64, m.capacity());
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.end(), m.begin());
+  EXPECT_EQ(m.end(), m.find(1));
+
+  EXPECT_TRUE(m.insert(1, 10));
+  EXPECT_FALSE(m.insert(1, 11));
+  EXPECT_TRUE(m.insert(2, 20));
+  EXPECT_EQ(2, m.size());
+  EXPECT_TRUE(m.contains(1));
+  auto it = m.find(1);
+  ASSERT_NE(m.end(), it);
+  EXPECT_EQ(1, it.key());
+  EXPECT_EQ(10, it.value());
+
+  EXPECT_TRUE(m.erase(1));
+  EXPECT_FALSE(m.erase(1));
+  EXPECT_FALSE(m.contains(1));
+  EXPECT_EQ(1, m.size());
+  EXPECT_TRUE(m.insert(1, 12));
+  EXPECT_EQ(12, m.find(1).value());
+}
+
+TEST(ShardedFixedHashMap, iterator) {
+  SFHM m(256, 8);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(m.insert(i, i * 3));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    ASSERT_TRUE(m.erase(i));
+  }
+  std::set<int> keys;
+  for (auto it = m.begin(); it != m.end(); ++it) {
+    EXPECT_EQ(it.key() * 3, it.value());
+    EXPECT_TRUE(keys.insert(it.key()).second);
+  }
+  EXPECT_EQ(50, keys.size());
+  EXPECT_EQ(1, *keys.begin());
+}
+
+TEST(ShardedFixedHashMap, full) {
+  SFHM m(4, 1);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(m.insert(i, i));
+  }
+  // Full shards reject new keys rather than fail.
+  EXPECT_FALSE(m.insert(4, 4));
+  EXPECT_TRUE(m.erase(0));
+  EXPECT_FALSE(m.insert(4, 4));
+
+  // Copying drops the tombstones.
+  SFHM copy(8, m);
+  EXPECT_EQ(3, copy.size());
+  EXPECT_TRUE(copy.insert(4, 4));
+  EXPECT_TRUE(copy.insert(0, 0));
+  EXPECT_EQ(5, copy.size());
+}
+
+TEST(ShardedFixedHashMap, concurrentWriters) {
+  constexpr int kThreads = 8;
+  constexpr int kKeys = 1000;
+  SFHM m(2 * kThreads * kKeys);
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done.load()) {
+      for (auto it = m.begin(); it != m.end(); ++it) {
+        ASSERT_EQ(it.key(), it.value());
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kThreads; ++t) {
+    writers.emplace_back([&, t] {
+      for (int i = 0; i < kKeys; ++i) {
+        int key = t * kKeys + i;
+        ASSERT_TRUE(m.insert(key, key));
+        ASSERT_TRUE(m.contains(key));
+        if (i % 2) {
+          ASSERT_TRUE(m.erase(key));
+        }
+      }
+    });
+  }
+  for (auto& w : writers) {
+    w.join();
+  }
+  done.store(true);
+  reader.join();
+  EXPECT_EQ(kThreads * kKeys / 2, m.size());
+}
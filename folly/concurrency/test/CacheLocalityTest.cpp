@@ -325,6 +325,28 @@ TEST(CacheLocality, FakeSysfs) {
   EXPECT_EQ(expectedLocalityIndexByCpu, parsed.localityIndexByCpu);
 }
 
+TEST(CacheLocality, CpusByStripe) {
+  auto parsed = CacheLocality::readFromSysfsTree([](std::string name) {
+    auto iter = fakeSysfsTree.find(name);
+    return iter == fakeSysfsTree.end() ? std::string() : iter->second;
+  });
+
+  EXPECT_EQ(2, parsed.numLastLevelCaches());
+  auto byStripe = parsed.cpusByStripe(parsed.numLastLevelCaches());
+  ASSERT_EQ(2, byStripe.size());
+  // Each stripe is one of the two last-level caches.
+  std::vector<size_t> expected0 = {
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 17, 18, 19, 20, 21, 22, 23};
+  std::vector<size_t> expected1 = {
+      9, 10, 11, 12, 13, 14, 15, 16, 24, 25, 26, 27, 28, 29, 30, 31};
+  EXPECT_EQ(expected0, byStripe[0]);
+  EXPECT_EQ(expected1, byStripe[1]);
+
+  auto single = parsed.cpusByStripe(1);
+  ASSERT_EQ(1, single.size());
+  EXPECT_EQ(32, single[0].size());
+}
+
 static const std::vector<std::string> fakeProcCpuinfo = {
     "processor	: 0",
     "vendor_id	: GenuineIntel",
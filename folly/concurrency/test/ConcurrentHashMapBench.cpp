@@ -16,8 +16,10 @@
 
 #include <folly/concurrency/ConcurrentHashMap.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <string>
 #include <thread>
 
 #include <folly/BenchmarkUtil.h>
@@ -86,13 +88,14 @@ uint64_t runBench(const std::string& name, int ops, const RepFunc& repFn) {
   return res;
 }
 
+template <typename Map>
 uint64_t bench_ctor_dtor(
     const int nthr, const int size, const std::string& name) {
   int ops = FLAGS_ops;
   auto repFn = [&] {
     auto fn = [&](int) {
       for (int i = 0; i < ops; ++i) {
-        folly::ConcurrentHashMap<int, int> m;
+        Map m;
         for (int j = 0; j < size; ++j) {
           folly::doNotOptimizeAway(m.insert(j, j));
         }
@@ -104,10 +107,11 @@ uint64_t bench_ctor_dtor(
   return runBench(name, ops, repFn);
 }
 
+template <typename Map>
 uint64_t bench_find(
     const int nthr, const bool sameItem, const std::string& name) {
   int ops = FLAGS_ops;
-  folly::ConcurrentHashMap<int, int> m;
+  Map m;
   for (int j = 0; j < FLAGS_size; ++j) {
     m.insert(j, j);
   }
@@ -130,10 +134,11 @@ uint64_t bench_find(
   return runBench(name, ops, repFn);
 }
 
+template <typename Map>
 uint64_t bench_iter(const int nthr, int size, const std::string& name) {
   int reps = size == 0 ? 1000000 : size < 1000000 ? 1000000 / size : 1;
   int ops = size == 0 ? reps : size * reps;
-  folly::ConcurrentHashMap<int, int> m;
+  Map m;
   for (int j = 0; j < size; ++j) {
     m.insert(j, j);
   }
@@ -150,9 +155,10 @@ uint64_t bench_iter(const int nthr, int size, const std::string& name) {
   return runBench(name, ops, repFn);
 }
 
+template <typename Map>
 uint64_t bench_begin(const int nthr, int size, const std::string& name) {
   int ops = FLAGS_ops;
-  folly::ConcurrentHashMap<int, int> m;
+  Map m;
   for (int j = 0; j < size; ++j) {
     m.insert(j, j);
   }
@@ -168,9 +174,10 @@ uint64_t bench_begin(const int nthr, int size, const std::string& name) {
   return runBench(name, ops, repFn);
 }
 
+template <typename Map>
 uint64_t bench_empty(const int nthr, int size, const std::string& name) {
   int ops = FLAGS_ops;
-  folly::ConcurrentHashMap<int, int> m;
+  Map m;
   for (int j = 0; j < size; ++j) {
     m.insert(j, j);
   }
@@ -186,9 +193,10 @@ uint64_t bench_empty(const int nthr, int size, const std::string& name) {
   return runBench(name, ops, repFn);
 }
 
+template <typename Map>
 uint64_t bench_size(const int nthr, int size, const std::string& name) {
   int ops = FLAGS_ops;
-  folly::ConcurrentHashMap<int, int> m;
+  Map m;
   for (int j = 0; j < size; ++j) {
     m.insert(j, j);
   }
@@ -204,12 +212,55 @@ uint64_t bench_size(const int nthr, int size, const std::string& name) {
   return runBench(name, ops, repFn);
 }
 
+// All threads operate on random keys of a map prefilled with 1M items. An
+// update is either an insert_or_assign() of an existing key or an erase
+// followed by a re-insert.
+template <typename Map>
+uint64_t bench_mixed(
+    const int nthr, const int findPercent, const std::string& name) {
+  int ops = FLAGS_ops;
+  constexpr int kSize = 1000 * 1000;
+  Map m;
+  for (int j = 0; j < kSize; ++j) {
+    m.insert(j, j);
+  }
+  auto repFn = [&] {
+    auto fn = [&](int tid) {
+      uint32_t x = 2463534242u + tid;
+      for (int i = 0; i < ops; ++i) {
+        // xorshift32
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        int key = static_cast<int>(x % kSize);
+        if (static_cast<int>((x >> 8) % 100) < findPercent) {
+          folly::doNotOptimizeAway(m.find(key));
+        } else if (i & 1) {
+          m.insert_or_assign(key, i);
+        } else {
+          m.erase(key);
+          m.insert(key, i);
+        }
+      }
+    };
+    auto endfn = [&] {};
+    return run_once(nthr, fn, endfn);
+  };
+  return runBench(name, ops, repFn);
+}
+
 void dottedLine() {
   std::cout << ".............................................................."
             << std::endl;
 }
 
-void benches() {
+template <typename Map>
+void benches(const std::string& label) {
+  auto name = [&](const std::string& test) {
+    std::string res = label + " " + test;
+    res.resize(std::max(res.size(), size_t(33)), ' ');
+    return res;
+  };
   std::cout << "=============================================================="
             << std::endl;
   std::cout << "Test name                         Max time  Avg time  Min time"
@@ -217,46 +268,52 @@ void benches() {
   for (int nthr : {1, 10}) {
     std::cout << "========================= " << std::setw(2) << nthr
               << " threads" << " =========================" << std::endl;
-    bench_ctor_dtor(nthr, 0, "CHM ctor/dtor -- empty          ");
-    bench_ctor_dtor(nthr, 1, "CHM ctor/dtor -- 1 item         ");
+    bench_ctor_dtor<Map>(nthr, 0, name("ctor/dtor -- empty"));
+    bench_ctor_dtor<Map>(nthr, 1, name("ctor/dtor -- 1 item"));
+    dottedLine();
+    bench_find<Map>(nthr, false, name("find() -- 10M items"));
+    bench_find<Map>(nthr, true, name("find() -- 1 of 10M items"));
     dottedLine();
-    bench_find(nthr, false, "CHM find() -- 10M items         ");
-    bench_find(nthr, true, "CHM find() -- 1 of 10M items    ");
+    bench_begin<Map>(nthr, 0, name("begin() -- empty"));
+    bench_begin<Map>(nthr, 1, name("begin() -- 1 item"));
+    bench_begin<Map>(nthr, 10000, name("begin() -- 10K items"));
+    bench_begin<Map>(nthr, 10000000, name("begin() -- 10M items"));
     dottedLine();
-    bench_begin(nthr, 0, "CHM begin() -- empty            ");
-    bench_begin(nthr, 1, "CHM begin() -- 1 item           ");
-    bench_begin(nthr, 10000, "CHM begin() -- 10K items        ");
-    bench_begin(nthr, 10000000, "CHM begin() -- 10M items        ");
+    bench_iter<Map>(nthr, 0, name("iterate -- empty"));
+    bench_iter<Map>(nthr, 1, name("iterate -- 1 item"));
+    bench_iter<Map>(nthr, 10, name("iterate -- 10 items"));
+    bench_iter<Map>(nthr, 100, name("iterate -- 100 items"));
+    bench_iter<Map>(nthr, 1000, name("iterate -- 1K items"));
+    bench_iter<Map>(nthr, 10000, name("iterate -- 10K items"));
+    bench_iter<Map>(nthr, 100000, name("iterate -- 100K items"));
+    bench_iter<Map>(nthr, 1000000, name("iterate -- 1M items"));
+    bench_iter<Map>(nthr, 10000000, name("iterate -- 10M items"));
     dottedLine();
-    bench_iter(nthr, 0, "CHM iterate -- empty            ");
-    bench_iter(nthr, 1, "CHM iterate -- 1 item           ");
-    bench_iter(nthr, 10, "CHM iterate -- 10 items         ");
-    bench_iter(nthr, 100, "CHM iterate -- 100 items        ");
-    bench_iter(nthr, 1000, "CHM iterate -- 1K items         ");
-    bench_iter(nthr, 10000, "CHM iterate -- 10K items        ");
-    bench_iter(nthr, 100000, "CHM iterate -- 100K items       ");
-    bench_iter(nthr, 1000000, "CHM iterate -- 1M items         ");
-    bench_iter(nthr, 10000000, "CHM iterate -- 10M items        ");
+    bench_empty<Map>(nthr, 0, name("empty() -- empty"));
+    bench_empty<Map>(nthr, 1, name("empty() -- 1 item"));
+    bench_empty<Map>(nthr, 10000, name("empty() -- 10K items"));
+    bench_empty<Map>(nthr, 10000000, name("empty() -- 10M items"));
     dottedLine();
-    bench_empty(nthr, 0, "CHM empty() -- empty            ");
-    bench_empty(nthr, 1, "CHM empty() -- 1 item           ");
-    bench_empty(nthr, 10000, "CHM empty() -- 10K items        ");
-    bench_empty(nthr, 10000000, "CHM empty() -- 10M items        ");
+    bench_size<Map>(nthr, 0, name("size() -- empty"));
+    bench_size<Map>(nthr, 1, name("size() -- 1 item"));
+    bench_size<Map>(nthr, 10, name("size() -- 10 items"));
+    bench_size<Map>(nthr, 100, name("size() -- 100 items"));
+    bench_size<Map>(nthr, 1000, name("size() -- 1K items"));
+    bench_size<Map>(nthr, 10000, name("size() -- 10K items"));
+    bench_size<Map>(nthr, 100000, name("size() -- 100K items"));
+    bench_size<Map>(nthr, 1000000, name("size() -- 1M items"));
+    bench_size<Map>(nthr, 10000000, name("size() -- 10M items"));
     dottedLine();
-    bench_size(nthr, 0, "CHM size() -- empty             ");
-    bench_size(nthr, 1, "CHM size() -- 1 item            ");
-    bench_size(nthr, 10, "CHM size() -- 10 items          ");
-    bench_size(nthr, 100, "CHM size() -- 100 items         ");
-    bench_size(nthr, 1000, "CHM size() -- 1K items          ");
-    bench_size(nthr, 10000, "CHM size() -- 10K items         ");
-    bench_size(nthr, 100000, "CHM size() -- 100K items        ");
-    bench_size(nthr, 1000000, "CHM size() -- 1M items          ");
-    bench_size(nthr, 10000000, "CHM size() -- 10M items         ");
+    bench_mixed<Map>(nthr, 90, name("90% find, 10% update -- 1M"));
+    bench_mixed<Map>(nthr, 50, name("50% find, 50% update -- 1M"));
   }
   std::cout << "=============================================================="
             << std::endl;
 }
 
-int main() {
-  benches();
+int main(int argc, char** argv) {
+  folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // Compare the bucket-chained segments with the F14-chunk (SIMD) ones.
+  benches<folly::ConcurrentHashMap<int, int>>("CHM");
+  benches<folly::ConcurrentHashMapSIMD<int, int>>("CHMSIMD");
 }
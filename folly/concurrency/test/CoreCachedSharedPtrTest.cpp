@@ -125,6 +125,97 @@ TEST(CoreCachedSharedPtr, AtomicCoreCachedSharedPtr) {
 
 namespace {
 
+struct Counted {
+  static std::atomic<int> alive;
+  explicit Counted(size_t v) : value(v) { ++alive; }
+  ~Counted() { --alive; }
+  size_t value;
+};
+std::atomic<int> Counted::alive{0};
+
+} // namespace
+
+TEST(CoreCachedSharedPtr, AtomicCoreRefCountedPtr) {
+  {
+    folly::AtomicCoreRefCountedPtr<Counted> p;
+    EXPECT_FALSE(p.get());
+    p.emplace(1);
+    EXPECT_EQ(Counted::alive, 1);
+
+    auto r1 = p.get();
+    ASSERT_TRUE(r1);
+    EXPECT_EQ(r1->value, 1);
+    auto r2 = r1;
+    folly::CoreRefCountedPtr<Counted> r3;
+    // References taken and dropped on other cores.
+    parallelRun([&](size_t) {
+      auto r = p.get();
+      EXPECT_EQ(r.get(), r1.get());
+      auto copy = r;
+    });
+    std::thread([&] { r3 = std::move(r2); }).join();
+    EXPECT_FALSE(r2);
+    EXPECT_EQ((*r3).value, 1);
+
+    // The replaced object lives as long as its references.
+    p.emplace(2);
+    EXPECT_EQ(Counted::alive, 2);
+    EXPECT_EQ(p.get()->value, 2);
+    r1.reset();
+    EXPECT_EQ(Counted::alive, 2);
+    auto r4 = r3;
+    std::thread([&] { r3.reset(); }).join();
+    EXPECT_EQ(Counted::alive, 2);
+    r4 = p.get();
+    folly::hazptr_cleanup();
+    EXPECT_EQ(Counted::alive, 1);
+
+    p.reset();
+    EXPECT_FALSE(p.get());
+    EXPECT_EQ(r4->value, 2);
+    r4.reset();
+  }
+  folly::hazptr_cleanup();
+  EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(CoreCachedSharedPtr, AtomicCoreRefCountedPtrStress) {
+  constexpr size_t kIters = 2000;
+  {
+    // One writer thread, all other readers, verify consistency.
+    std::atomic<size_t> largestValueObserved{0};
+    folly::AtomicCoreRefCountedPtr<Counted> p;
+    p.emplace(0);
+    parallelRun([&](size_t t) {
+      if (t == 0) {
+        for (size_t i = 0; i < kIters; ++i) {
+          p.emplace(i + 1);
+        }
+      } else {
+        // Keep a few references around across replacements.
+        std::vector<folly::CoreRefCountedPtr<Counted>> refs(4);
+        for (size_t i = 0;; ++i) {
+          auto exp = largestValueObserved.load();
+          auto ref = p.get();
+          auto value = ref->value;
+          EXPECT_GE(value, exp);
+          refs[i % refs.size()] = std::move(ref);
+          while (value > exp &&
+                 !largestValueObserved.compare_exchange_weak(exp, value)) {
+          }
+          if (exp == kIters) {
+            break;
+          }
+        }
+      }
+    });
+  }
+  folly::hazptr_cleanup();
+  EXPECT_EQ(Counted::alive, 0);
+}
+
+namespace {
+
 template <class Holder>
 void testAliasingCornerCases() {
   {
@@ -244,6 +335,19 @@ size_t benchmarkAtomicCoreCachedSharedPtrAcquire(size_t numThreads) {
   return benchmarkParallelRun([&] { return p.get(); }, numThreads);
 }
 
+size_t benchmarkAtomicCoreRefCountedPtrAcquire(size_t numThreads) {
+  folly::AtomicCoreRefCountedPtr<int> p;
+  p.emplace(1);
+  return benchmarkParallelRun([&] { return p.get(); }, numThreads);
+}
+
+size_t benchmarkCoreRefCountedPtrCopy(size_t numThreads) {
+  folly::AtomicCoreRefCountedPtr<int> p;
+  p.emplace(1);
+  auto ref = p.get();
+  return benchmarkParallelRun([&] { return ref; }, numThreads);
+}
+
 size_t benchmarkReadMostlySharedPtrAcquire(size_t numThreads) {
   folly::ReadMostlyMainPtr<int> p{std::make_shared<int>(1)};
   return benchmarkParallelRun([&] { return p.getShared(); }, numThreads);
@@ -285,6 +389,12 @@ size_t benchmarkThreadCachedSynchronizedAcquire(size_t numThreads) {
   BENCHMARK_MULTI(AtomicCoreCachedSharedPtrAcquire_##THREADS##Threads) { \
     return benchmarkAtomicCoreCachedSharedPtrAcquire(THREADS);           \
   }                                                                      \
+  BENCHMARK_MULTI(AtomicCoreRefCountedPtrAcquire_##THREADS##Threads) {   \
+    return benchmarkAtomicCoreRefCountedPtrAcquire(THREADS);             \
+  }                                                                      \
+  BENCHMARK_MULTI(CoreRefCountedPtrCopy_##THREADS##Threads) {            \
+    return benchmarkCoreRefCountedPtrCopy(THREADS);                      \
+  }                                                                      \
   BENCHMARK_MULTI(ReadMostlySharedPtrAcquire_##THREADS##Threads) {       \
     return benchmarkReadMostlySharedPtrAcquire(THREADS);                 \
   }                                                                      \
@@ -319,6 +429,11 @@ BENCHMARK_MULTI(AtomicCoreCachedSharedPtrSingleThreadReset) {
   return benchmarkParallelRun([&] { p.reset(std::make_shared<int>(1)); }, 1);
 }
 
+BENCHMARK_MULTI(AtomicCoreRefCountedPtrSingleThreadEmplace) {
+  folly::AtomicCoreRefCountedPtr<int> p;
+  return benchmarkParallelRun([&] { p.emplace(1); }, 1);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/ResizableAtomicHashMap.h>
+
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+using Map = ResizableAtomicHashMap<int64_t, int64_t>;
+
+namespace {
+
+// Migrations advance a chunk per operation; lookups finish any that is
+// still in progress.
+void settle(const Map& map) {
+  for (int i = 0; i < 1000; ++i) {
+    map.find(0);
+  }
+}
+
+} // namespace
+
+TEST(ResizableAtomicHashMap, Basic) {
+  Map map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.find(1).has_value());
+
+  EXPECT_TRUE(map.insert(1, 10));
+  EXPECT_FALSE(map.insert(1, 11));
+  EXPECT_EQ(10, map.find(1).value());
+  EXPECT_FALSE(map.insert_or_assign(1, 12));
+  EXPECT_EQ(12, map.find(1).value());
+  EXPECT_TRUE(map.insert_or_assign(2, 20));
+  EXPECT_EQ(2, map.size());
+
+  EXPECT_EQ(12, map.fetch_add(1, 3));
+  EXPECT_EQ(0, map.fetch_add(3, 5));
+  EXPECT_EQ(15, map.find(1).value());
+  EXPECT_EQ(5, map.find(3).value());
+  EXPECT_EQ(3, map.size());
+
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_FALSE(map.erase(1));
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_EQ(2, map.size());
+
+  // An erased key can be inserted again.
+  EXPECT_TRUE(map.insert(1, 7));
+  EXPECT_EQ(7, map.find(1).value());
+}
+
+TEST(ResizableAtomicHashMap, GrowAndShrink) {
+  Map map;
+  auto const initial = map.capacity();
+  constexpr int64_t kN = 100000;
+  for (int64_t i = 0; i < kN; ++i) {
+    ASSERT_TRUE(map.insert(i, i * 2));
+  }
+  EXPECT_EQ(kN, map.size());
+  EXPECT_GE(map.capacity(), kN);
+  for (int64_t i = 0; i < kN; ++i) {
+    ASSERT_EQ(i * 2, map.find(i).value());
+  }
+
+  for (int64_t i = 0; i < kN - 10; ++i) {
+    ASSERT_TRUE(map.erase(i));
+  }
+  EXPECT_EQ(10, map.size());
+  settle(map);
+  EXPECT_LE(map.capacity(), 4 * initial);
+  for (int64_t i = kN - 10; i < kN; ++i) {
+    EXPECT_EQ(i * 2, map.find(i).value());
+  }
+  EXPECT_FALSE(map.contains(0));
+}
+
+TEST(ResizableAtomicHashMap, TombstonesAreReclaimed) {
+  Map map;
+  auto const capacity = map.capacity();
+  // Churning through distinct keys fills the table with tombstones, which
+  // migrations clean up without growing it.
+  for (int64_t i = 0; i < 100000; ++i) {
+    ASSERT_TRUE(map.insert(i, i));
+    ASSERT_TRUE(map.erase(i));
+  }
+  EXPECT_TRUE(map.empty());
+  settle(map);
+  EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(ResizableAtomicHashMap, Config) {
+  using SmallMap = ResizableAtomicHashMap<uint32_t, uint16_t>;
+  SmallMap::Config config;
+  config.emptyKey = 0;
+  config.movedKey = 1;
+  config.minCapacity = 4;
+  SmallMap map(1000, config);
+  EXPECT_GE(map.capacity(), 2000);
+  EXPECT_TRUE(map.insert(uint32_t(-1), 0));
+  EXPECT_EQ(0, map.find(uint32_t(-1)).value());
+  EXPECT_EQ(0, map.fetch_add(2, 65534 - 1));
+  EXPECT_EQ(65533, map.find(2).value());
+}
+
+TEST(ResizableAtomicHashMap, ConcurrentCounters) {
+  Map map;
+  constexpr int kThreads = 8;
+  constexpr int64_t kKeys = 20000;
+  constexpr int kRounds = 3;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int r = 0; r < kRounds; ++r) {
+        for (int64_t i = 0; i < kKeys; ++i) {
+          map.fetch_add((i * 7 + t) % kKeys, 1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(kKeys, map.size());
+  int64_t total = 0;
+  for (int64_t i = 0; i < kKeys; ++i) {
+    total += map.find(i).value();
+  }
+  EXPECT_EQ(kThreads * kRounds * kKeys, total);
+}
+
+TEST(ResizableAtomicHashMap, ConcurrentChurn) {
+  Map map;
+  constexpr int kThreads = 8;
+  constexpr int64_t kKeys = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Each thread owns its keys, so it knows what must be there.
+      int64_t base = t * kKeys;
+      for (int r = 0; r < 10; ++r) {
+        for (int64_t i = 0; i < kKeys; ++i) {
+          ASSERT_TRUE(map.insert(base + i, r));
+        }
+        for (int64_t i = 0; i < kKeys; ++i) {
+          ASSERT_EQ(r, map.find(base + i).value());
+        }
+        for (int64_t i = r % 2; i < kKeys; ++i) {
+          ASSERT_TRUE(map.erase(base + i));
+        }
+        if (r % 2) {
+          ASSERT_TRUE(map.erase(base));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(map.empty());
+  settle(map);
+  EXPECT_EQ(Map().capacity(), map.capacity());
+}
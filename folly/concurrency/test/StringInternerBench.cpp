@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/StringInterner.h>
+
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/container/F14Map.h>
+#include <folly/init/Init.h>
+
+using namespace folly;
+
+namespace {
+
+// 10K metric-like names, and containers that hold them all.
+struct Data {
+  Data() {
+    for (int i = 0; i < 10000; ++i) {
+      names.push_back(
+          "service.endpoint." + std::to_string(i * 7919) + ".latency");
+      concurrentMap.insert(names.back(), 1);
+      stringMap[names.back()] = 1;
+      interned.push_back(interner.intern(names.back()));
+      internedMap[interned.back()] = 1;
+    }
+  }
+
+  std::vector<std::string> names;
+  ConcurrentHashMap<std::string, int> concurrentMap;
+  F14FastMap<std::string, int> stringMap;
+  StringInterner interner;
+  std::vector<InternedString> interned;
+  F14FastMap<InternedString, int> internedMap;
+};
+
+Data& data() {
+  static Data data;
+  return data;
+}
+
+} // namespace
+
+BENCHMARK(concurrent_hash_map_dedup, iters) {
+  auto& d = data();
+  for (size_t i = 0; i < iters; ++i) {
+    auto it = d.concurrentMap.find(d.names[i % d.names.size()]);
+    doNotOptimizeAway(it->first.data());
+  }
+}
+
+BENCHMARK_RELATIVE(string_interner_intern, iters) {
+  auto& d = data();
+  for (size_t i = 0; i < iters; ++i) {
+    auto s = d.interner.intern(d.names[i % d.names.size()]);
+    doNotOptimizeAway(s.data());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(f14_find_string_key, iters) {
+  auto& d = data();
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(d.stringMap.find(d.names[i % d.names.size()])->second);
+  }
+}
+
+BENCHMARK_RELATIVE(f14_find_interned_key, iters) {
+  auto& d = data();
+  for (size_t i = 0; i < iters; ++i) {
+    auto key = d.interned[i % d.interned.size()];
+    doNotOptimizeAway(d.internedMap.find(key)->second);
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  data();
+  runBenchmarks();
+  return 0;
+}
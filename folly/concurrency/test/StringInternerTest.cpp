@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/StringInterner.h>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(StringInterner, Basic) {
+  StringInterner interner;
+  EXPECT_EQ(0, interner.size());
+
+  auto a = interner.intern("metric.name");
+  auto b = interner.intern(std::string("metric.name"));
+  auto c = interner.intern("metric.other");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.data(), b.data());
+  EXPECT_NE(a, c);
+  EXPECT_EQ("metric.name", a.view());
+  EXPECT_EQ(11, a.size());
+  EXPECT_EQ('\0', a.c_str()[a.size()]);
+  EXPECT_EQ(2, interner.size());
+  EXPECT_LT(a, c);
+  EXPECT_FALSE(c < a);
+  EXPECT_FALSE(a < b);
+
+  EXPECT_EQ(a, interner.find("metric.name"));
+  EXPECT_EQ(none, interner.find("metric.missing"));
+
+  EXPECT_EQ(InternedString(), interner.intern(""));
+  EXPECT_EQ(InternedString(), interner.find(""));
+  EXPECT_TRUE(InternedString().empty());
+  EXPECT_STREQ("", InternedString().c_str());
+  EXPECT_EQ(2, interner.size());
+
+  EXPECT_EQ(hasher<std::string_view>{}("metric.name"), a.hash());
+  EXPECT_EQ(hasher<std::string_view>{}(""), InternedString().hash());
+  EXPECT_GT(interner.totalSize(), 0);
+}
+
+TEST(StringInterner, Grow) {
+  StringInterner interner;
+  std::vector<InternedString> strings;
+  for (int i = 0; i < 10000; ++i) {
+    strings.push_back(interner.intern(std::to_string(i)));
+  }
+  EXPECT_EQ(10000, interner.size());
+  for (int i = 0; i < 10000; ++i) {
+    auto s = std::to_string(i);
+    EXPECT_EQ(strings[i], interner.intern(s));
+    EXPECT_EQ(s, strings[i].view());
+  }
+  EXPECT_EQ(10000, interner.size());
+}
+
+TEST(StringInterner, F14) {
+  StringInterner interner;
+  F14FastMap<InternedString, int> map;
+  map[interner.intern("a")] = 1;
+  map[interner.intern("b")] = 2;
+  EXPECT_EQ(1, map.at(interner.intern("a")));
+  EXPECT_EQ(2, map.at(*interner.find("b")));
+  EXPECT_EQ(0, map.count(interner.intern("c")));
+}
+
+TEST(StringInterner, Concurrent) {
+  StringInterner interner;
+  constexpr int kThreads = 8;
+  constexpr int kStrings = 20000;
+  std::vector<std::vector<InternedString>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Each thread interns the same strings, in a different order.
+      for (int i = 0; i < kStrings; ++i) {
+        auto const j = (i * (2 * t + 1)) % kStrings;
+        auto s = interner.intern("string." + std::to_string(j));
+        EXPECT_EQ("string." + std::to_string(j), s.view());
+        results[t].push_back(s);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(kStrings, interner.size());
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kStrings; ++i) {
+      auto const j = (i * (2 * t + 1)) % kStrings;
+      EXPECT_EQ(results[0][j], results[t][i]);
+    }
+  }
+}
+
+TEST(StringInterner, Instance) {
+  auto a = StringInterner::instance().intern("instance.test");
+  EXPECT_EQ(a, StringInterner::instance().intern("instance.test"));
+}
@@ -27,7 +27,9 @@
 
 #include <atomic>
 #include <iomanip>
+#include <numeric>
 #include <thread>
+#include <vector>
 
 DEFINE_bool(bench, false, "run benchmark");
 DEFINE_int32(reps, 10, "number of reps");
@@ -241,6 +243,45 @@ TEST(UnboundedQueue, cleanupOnDestruction) {
   EXPECT_EQ(count, num);
 }
 
+template <template <typename, bool> class Q, bool MayBlock>
+void bulk_test() {
+  Q<int, MayBlock> q;
+  std::vector<int> v(1000);
+  ASSERT_EQ(q.try_dequeue_bulk(folly::span<int>(v)), 0);
+
+  // Spans several segments.
+  std::vector<int> src(1000);
+  std::iota(src.begin(), src.end(), 0);
+  q.enqueue_bulk(src.begin(), src.begin());
+  ASSERT_TRUE(q.empty());
+  q.enqueue_bulk(src.begin(), src.begin() + 600);
+  q.enqueue(600);
+  q.enqueue_bulk(src.begin() + 601, src.end());
+  ASSERT_EQ(q.size(), 1000);
+
+  int x = -1;
+  ASSERT_TRUE(q.try_dequeue(x));
+  ASSERT_EQ(x, 0);
+  ASSERT_EQ(q.try_dequeue_bulk(folly::span<int>(v.data(), 700)), 700);
+  ASSERT_EQ(q.try_dequeue_bulk(folly::span<int>(v.data() + 700, 300)), 299);
+  ASSERT_TRUE(q.empty());
+  for (int i = 0; i < 999; ++i) {
+    ASSERT_EQ(v[i], i + 1);
+  }
+  ASSERT_EQ(q.try_dequeue_bulk(folly::span<int>(v)), 0);
+}
+
+TEST(UnboundedQueue, bulk) {
+  bulk_test<USPSC, false>();
+  bulk_test<UMPSC, false>();
+  bulk_test<USPMC, false>();
+  bulk_test<UMPMC, false>();
+  bulk_test<USPSC, true>();
+  bulk_test<UMPSC, true>();
+  bulk_test<USPMC, true>();
+  bulk_test<UMPMC, true>();
+}
+
 template <typename ProdFunc, typename ConsFunc, typename EndFunc>
 inline uint64_t run_once(
     int nprod,
@@ -396,6 +437,67 @@ TEST(UnboundedQueue, enqDeq) {
   enq_deq_test<false, false, true>(10, 10);
 }
 
+template <bool SingleProducer, bool SingleConsumer, bool MayBlock>
+void bulk_enq_deq_test(const int nprod, const int ncons) {
+  int ops = 10000;
+  constexpr int kBatch = 24;
+  folly::UnboundedQueue<int, SingleProducer, SingleConsumer, MayBlock, 4> q;
+  std::atomic<uint64_t> sum(0);
+  std::atomic<int> dequeued(0);
+
+  auto prod = [&](int tid) {
+    std::vector<int> batch;
+    for (int i = tid; i < ops; i += nprod) {
+      batch.push_back(i);
+      if (batch.size() == kBatch) {
+        q.enqueue_bulk(batch.begin(), batch.end());
+        batch.clear();
+      }
+    }
+    q.enqueue_bulk(batch.begin(), batch.end());
+  };
+
+  auto cons = [&](int) {
+    std::vector<int> batch(kBatch);
+    uint64_t mysum = 0;
+    int last = -1;
+    while (dequeued.load() < ops) {
+      auto n = q.try_dequeue_bulk(folly::span<int>(batch));
+      for (size_t i = 0; i < n; ++i) {
+        if (nprod == 1 && ncons == 1) {
+          ASSERT_EQ(batch[i], last + 1);
+        }
+        last = batch[i];
+        mysum += batch[i];
+      }
+      dequeued.fetch_add(n);
+    }
+    sum.fetch_add(mysum);
+  };
+
+  auto endfn = [&] {
+    uint64_t expected = (ops) * (ops - 1) / 2;
+    uint64_t actual = sum.load();
+    ASSERT_EQ(expected, actual);
+  };
+  run_once(nprod, ncons, prod, cons, endfn);
+}
+
+TEST(UnboundedQueue, bulkEnqDeq) {
+  /* SPSC */
+  bulk_enq_deq_test<true, true, false>(1, 1);
+  bulk_enq_deq_test<true, true, true>(1, 1);
+  /* MPSC */
+  bulk_enq_deq_test<false, true, false>(4, 1);
+  bulk_enq_deq_test<false, true, true>(4, 1);
+  /* SPMC */
+  bulk_enq_deq_test<true, false, false>(1, 4);
+  bulk_enq_deq_test<true, false, true>(1, 4);
+  /* MPMC */
+  bulk_enq_deq_test<false, false, false>(4, 4);
+  bulk_enq_deq_test<false, false, true>(4, 4);
+}
+
 template <typename RepFunc>
 uint64_t runBench(const std::string& name, uint64_t ops, const RepFunc& repFn) {
   uint64_t reps = FLAGS_reps;
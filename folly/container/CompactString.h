@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <folly/Optional.h>
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/container/F14Set.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Exception.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+
+/* # CompactString
+ *
+ * An immutable 16-byte string handle, meant for storing a large number of
+ * mostly short strings, such as the keys of hash maps.
+ *
+ * Strings of up to kMaxInlineSize (15) characters are stored inline.
+ * Longer strings are stored as a pointer and a size, and their characters
+ * live in memory that the CompactString doesn't own: usually an arena, or
+ * a CompactStringPool, which also deduplicates them.
+ *
+ * This makes CompactString trivially copyable and destructible, half the
+ * size of std::string and fbstring, and never allocating on its own.
+ *
+ * A CompactString converts implicitly to StringPiece, so it can be looked
+ * up in F14 containers by StringPiece, std::string or std::string_view
+ * without constructing one:
+ *
+ *   CompactStringPool pool;
+ *   F14FastMap<CompactString, int> map;
+ *   map[pool.intern("some.rather.long.metric.name")] = 1;
+ *   map.find("some.rather.long.metric.name"); // heterogeneous lookup
+ *
+ * Strings that fit inline are always stored inline, so that equality of
+ * two inline strings is a 16-byte comparison.
+ */
+class CompactString {
+ public:
+  using value_type = char;
+  using size_type = std::size_t;
+  using const_iterator = const char*;
+  using iterator = const_iterator;
+
+  static constexpr std::size_t kMaxInlineSize = 15;
+
+  CompactString() noexcept {
+    std::memset(bytes_, 0, sizeof(bytes_));
+    bytes_[kMaxInlineSize] = char(kMaxInlineSize);
+  }
+
+  /// Copies s: inline if it fits, and otherwise into
+  /// arena.allocate(s.size()), so the arena must outlive the CompactString
+  /// and all its copies. Any type with a SysArena-like allocate works.
+  ///
+  /// @throws std::length_error if s has more than 2^32 - 1 characters.
+  template <typename Arena>
+  CompactString(StringPiece s, Arena& arena) : CompactString() {
+    if (fitsInline(s.size())) {
+      setInline(s);
+    } else {
+      auto data = static_cast<char*>(arena.allocate(s.size()));
+      std::memcpy(data, s.data(), s.size());
+      setExternal(data, s.size());
+    }
+  }
+
+  /// Creates a CompactString that copies s if it fits inline, and otherwise
+  /// refers to the characters of s, which must then outlive the CompactString
+  /// and all its copies.
+  ///
+  /// @throws std::length_error if s has more than 2^32 - 1 characters.
+  static CompactString unowned(StringPiece s) {
+    CompactString result;
+    if (fitsInline(s.size())) {
+      result.setInline(s);
+    } else {
+      result.setExternal(s.data(), s.size());
+    }
+    return result;
+  }
+
+  static constexpr bool fitsInline(std::size_t size) noexcept {
+    return size <= kMaxInlineSize;
+  }
+
+  bool isInline() const noexcept { return tag() <= kMaxInlineSize; }
+
+  const char* data() const noexcept {
+    if (isInline()) {
+      return bytes_;
+    }
+    const char* data;
+    std::memcpy(&data, bytes_, sizeof(data));
+    return data;
+  }
+
+  std::size_t size() const noexcept {
+    if (isInline()) {
+      return kMaxInlineSize - tag();
+    }
+    uint32_t size;
+    std::memcpy(&size, bytes_ + kSizeOffset, sizeof(size));
+    return size;
+  }
+
+  bool empty() const noexcept { return tag() == kMaxInlineSize; }
+
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator end() const noexcept { return data() + size(); }
+
+  char operator[](std::size_t i) const noexcept { return data()[i]; }
+
+  std::string_view view() const noexcept { return {data(), size()}; }
+  std::string str() const { return std::string(data(), size()); }
+
+  /* implicit */ operator StringPiece() const noexcept {
+    return StringPiece(data(), size());
+  }
+
+  friend bool operator==(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    if (lhs.isInline() || rhs.isInline()) {
+      // The padding of inline strings is zeroed, and an inline string can't
+      // be equal to an external one.
+      return std::memcmp(lhs.bytes_, rhs.bytes_, sizeof(lhs.bytes_)) == 0;
+    }
+    auto const size = lhs.size();
+    auto const data = lhs.data();
+    auto const rhsData = rhs.data();
+    return size == rhs.size() &&
+        (data == rhsData || std::memcmp(data, rhsData, size) == 0);
+  }
+  friend bool operator!=(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+  friend bool operator<(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    return lhs.view() < rhs.view();
+  }
+  friend bool operator>(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    return rhs < lhs;
+  }
+  friend bool operator<=(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    return !(rhs < lhs);
+  }
+  friend bool operator>=(
+      const CompactString& lhs, const CompactString& rhs) noexcept {
+    return !(lhs < rhs);
+  }
+
+  friend bool operator==(const CompactString& lhs, StringPiece rhs) noexcept {
+    return StringPiece(lhs) == rhs;
+  }
+  friend bool operator==(StringPiece lhs, const CompactString& rhs) noexcept {
+    return lhs == StringPiece(rhs);
+  }
+  friend bool operator!=(const CompactString& lhs, StringPiece rhs) noexcept {
+    return !(lhs == rhs);
+  }
+  friend bool operator!=(StringPiece lhs, const CompactString& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const CompactString& s) {
+    return os << s.view();
+  }
+
+ private:
+  // The last byte is kMaxInlineSize - size for inline strings, which makes
+  // it the null terminator of a full one, and kExternal otherwise.
+  static constexpr uint8_t kExternal = 0x80;
+  static constexpr std::size_t kSizeOffset = 8;
+
+  uint8_t tag() const noexcept { return uint8_t(bytes_[kMaxInlineSize]); }
+
+  void setInline(StringPiece s) noexcept {
+    std::memcpy(bytes_, s.data(), s.size());
+    bytes_[kMaxInlineSize] = char(kMaxInlineSize - s.size());
+  }
+
+  void setExternal(const char* data, std::size_t size) {
+    if (size > std::numeric_limits<uint32_t>::max()) {
+      throw_exception<std::length_error>("CompactString too long");
+    }
+    auto const size32 = uint32_t(size);
+    std::memcpy(bytes_, &data, sizeof(data));
+    std::memcpy(bytes_ + kSizeOffset, &size32, sizeof(size32));
+    bytes_[kMaxInlineSize] = char(kExternal);
+  }
+
+  alignas(8) char bytes_[16];
+};
+
+static_assert(sizeof(CompactString) == 16);
+
+/* # CompactStringPool
+ *
+ * Interns strings as CompactStrings: strings that don't fit inline are
+ * copied once into an arena, and interning an equal string again returns
+ * the same characters. The CompactStrings remain valid until the pool is
+ * destroyed or cleared.
+ *
+ * Not thread-safe.
+ */
+class CompactStringPool {
+ public:
+  CompactStringPool()
+      : arena_(
+            SysArena::kDefaultMinBlockSize,
+            SysArena::kNoSizeLimit,
+            /* maxAlign = */ 1) {}
+
+  CompactStringPool(const CompactStringPool&) = delete;
+  CompactStringPool& operator=(const CompactStringPool&) = delete;
+
+  CompactString intern(StringPiece s) {
+    if (CompactString::fitsInline(s.size())) {
+      return CompactString::unowned(s);
+    }
+    auto it = strings_.find(s);
+    if (it != strings_.end()) {
+      return *it;
+    }
+    CompactString result(s, arena_);
+    strings_.insert(result);
+    return result;
+  }
+
+  /// Returns the interned copy of s, or none if s doesn't fit inline and
+  /// wasn't interned.
+  Optional<CompactString> find(StringPiece s) const {
+    if (CompactString::fitsInline(s.size())) {
+      return CompactString::unowned(s);
+    }
+    auto it = strings_.find(s);
+    if (it == strings_.end()) {
+      return none;
+    }
+    return *it;
+  }
+
+  /// The number of distinct strings stored in the arena, which excludes the
+  /// ones that fit inline.
+  std::size_t size() const noexcept { return strings_.size(); }
+
+  /// The memory used by the pool, including the index of its strings.
+  std::size_t totalSize() const noexcept {
+    return arena_.totalSize() + strings_.getAllocatedMemorySize();
+  }
+
+  /// Invalidates all the CompactStrings returned by the pool.
+  void clear() {
+    strings_.clear();
+    arena_.clear();
+  }
+
+ private:
+  SysArena arena_;
+  F14FastSet<CompactString> strings_;
+};
+
+} // namespace folly
+
+namespace std {
+
+template <>
+struct hash<folly::CompactString> {
+  using folly_is_avalanching = std::true_type;
+
+  size_t operator()(const folly::CompactString& s) const noexcept {
+    return folly::hash::stdCompatibleHash(folly::StringPiece(s));
+  }
+};
+
+} // namespace std
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include <folly/Optional.h>
+#include <folly/SharedMutex.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+/**
+ * A thread-safe evicting cache, sharded by key hash.
+ *
+ * Each shard is an EvictingCacheMap guarded by its own reader-writer lock, so
+ * operations on keys in different shards never contend. Lookups only take the
+ * shard lock in shared mode: instead of moving the entry to the front of the
+ * LRU list, which requires exclusive access, get() sets a per-entry reference
+ * bit. Eviction then works like CLOCK (second chance): an entry at the back of
+ * the list whose reference bit is set is moved to the front with the bit
+ * cleared instead of being evicted. Frequently read entries therefore stay in
+ * the cache, while reads scale like reads of an unsynchronized map.
+ *
+ * Capacity is divided evenly among the shards, so with a skewed key
+ * distribution a hot shard may evict while others are below capacity. A
+ * maxSize of 0 disables automatic eviction, as for EvictingCacheMap.
+ *
+ * Values are returned by copy, since references into a shard would not be
+ * protected by its lock. For values that are expensive to copy use e.g.
+ * std::shared_ptr<const V> as TValue.
+ *
+ * Hit, miss and eviction counts are kept per shard and summed by getStats().
+ */
+template <
+    class TKey,
+    class TValue,
+    class THash = HeterogeneousAccessHash<TKey>,
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class Mutex = SharedMutex>
+class ConcurrentEvictingCacheMap {
+ public:
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using hasher = THash;
+  using PruneHookCall = std::function<void(TKey, TValue&&)>;
+
+  struct Stats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t evictions{0};
+  };
+
+  static constexpr std::size_t kDefaultNumShards = 16;
+
+  /**
+   * @param maxSize maximum total number of entries, divided evenly among the
+   *     shards; 0 means unlimited.
+   * @param numShards number of shards, rounded up to a power of two.
+   * @param pruneHook if set, invoked on every evicted entry while the lock of
+   *     its shard is held. It is not invoked on erase() nor on destruction.
+   */
+  explicit ConcurrentEvictingCacheMap(
+      std::size_t maxSize,
+      std::size_t numShards = kDefaultNumShards,
+      PruneHookCall pruneHook = nullptr,
+      const THash& keyHash = THash(),
+      const TKeyEqual& keyEqual = TKeyEqual())
+      : numShards_(nextPowTwo(numShards == 0 ? std::size_t(1) : numShards)),
+        maxSizePerShard_(
+            maxSize == 0 ? 0 : (maxSize + numShards_ - 1) / numShards_),
+        pruneHook_(std::move(pruneHook)),
+        keyHash_(keyHash),
+        shards_(std::make_unique<Shard[]>(numShards_)) {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      // Eviction is done by makeRoom(), not by the map itself.
+      shards_[i].map.emplace(0, 1, keyHash, keyEqual);
+    }
+  }
+
+  ConcurrentEvictingCacheMap(const ConcurrentEvictingCacheMap&) = delete;
+  ConcurrentEvictingCacheMap& operator=(const ConcurrentEvictingCacheMap&) =
+      delete;
+
+  /**
+   * Returns a copy of the value for key if present, and marks the entry as
+   * recently used. Only takes the shard lock in shared mode.
+   */
+  Optional<TValue> get(const TKey& key) { return getImpl(key, true); }
+
+  /// Like get(), but does not affect the eviction order.
+  Optional<TValue> getWithoutPromotion(const TKey& key) {
+    return getImpl(key, false);
+  }
+
+  /// Returns true if key is present, without affecting the eviction order.
+  bool exists(const TKey& key) const {
+    auto& shard = shardFor(key);
+    std::shared_lock lock(shard.mutex);
+    return shard.map->exists(key);
+  }
+
+  /**
+   * Sets the value for key, inserting it if it is not present, and marks the
+   * entry as recently used. May evict entries of the same shard.
+   */
+  void set(const TKey& key, TValue value) {
+    auto& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.map->findWithoutPromotion(key);
+    if (it != shard.map->end()) {
+      it->second.value = std::move(value);
+      it->second.markReferenced();
+      return;
+    }
+    makeRoom(shard);
+    shard.map->insert(key, Entry(std::move(value)));
+  }
+
+  /**
+   * Inserts key with value if key is not present. Returns true if the value
+   * was inserted. May evict entries of the same shard.
+   */
+  bool insert(const TKey& key, TValue value) {
+    auto& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    if (shard.map->exists(key)) {
+      return false;
+    }
+    makeRoom(shard);
+    shard.map->insert(key, Entry(std::move(value)));
+    return true;
+  }
+
+  /// Erases key if present. Returns true if an entry was erased.
+  bool erase(const TKey& key) {
+    auto& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    return shard.map->erase(key);
+  }
+
+  /// Removes all entries, without invoking the prune hook.
+  void clear() {
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::unique_lock lock(shards_[i].mutex);
+      shards_[i].map->clear();
+    }
+  }
+
+  /// Total number of entries. Not a consistent snapshot across shards.
+  std::size_t size() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      std::shared_lock lock(shards_[i].mutex);
+      n += shards_[i].map->size();
+    }
+    return n;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  std::size_t numShards() const { return numShards_; }
+
+  std::size_t getMaxSize() const { return maxSizePerShard_ * numShards_; }
+
+  /// Sum of the per-shard counters. Not a consistent snapshot across shards.
+  Stats getStats() const {
+    Stats stats;
+    for (std::size_t i = 0; i < numShards_; ++i) {
+      auto& shard = shards_[i];
+      stats.hits += shard.hits.load(std::memory_order_relaxed);
+      stats.misses += shard.misses.load(std::memory_order_relaxed);
+      stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    explicit Entry(TValue&& v) : value(std::move(v)) {}
+    Entry(Entry&& that) noexcept(
+        std::is_nothrow_move_constructible<TValue>::value)
+        : value(std::move(that.value)),
+          referenced(that.referenced.load(std::memory_order_relaxed)) {}
+    Entry& operator=(Entry&& that) noexcept(
+        std::is_nothrow_move_assignable<TValue>::value) {
+      value = std::move(that.value);
+      referenced.store(
+          that.referenced.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      return *this;
+    }
+
+    // Called under a shared lock; avoid dirtying the cache line if the bit is
+    // already set.
+    void markReferenced() const {
+      if (!referenced.load(std::memory_order_relaxed)) {
+        referenced.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    TValue value;
+    mutable std::atomic<bool> referenced{false};
+  };
+
+  using Map = EvictingCacheMap<TKey, Entry, THash, TKeyEqual>;
+
+  struct alignas(hardware_destructive_interference_size) Shard {
+    mutable Mutex mutex;
+    // Optional only to allow constructing the array of shards up front.
+    Optional<Map> map;
+    std::atomic<std::size_t> hits{0};
+    std::atomic<std::size_t> misses{0};
+    std::atomic<std::size_t> evictions{0};
+  };
+
+  Shard& shardFor(const TKey& key) const {
+    // EvictingCacheMap indexes by the same hash, so remix it to pick shards.
+    auto h = hash::twang_mix64(static_cast<uint64_t>(keyHash_(key)));
+    return shards_[(h >> 32) & (numShards_ - 1)];
+  }
+
+  Optional<TValue> getImpl(const TKey& key, bool promote) {
+    auto& shard = shardFor(key);
+    std::shared_lock lock(shard.mutex);
+    const Map& map = *shard.map;
+    auto it = map.findWithoutPromotion(key);
+    if (it == map.end()) {
+      shard.misses.fetch_add(1, std::memory_order_relaxed);
+      return none;
+    }
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    if (promote) {
+      it->second.markReferenced();
+    }
+    return it->second.value;
+  }
+
+  // Must hold the shard lock exclusively. Evicts from the back of the list
+  // until there is room for one more entry, giving entries that were read
+  // since they last got there a second chance. This runs before inserting, so
+  // that the new entry, which is not referenced yet, isn't a candidate.
+  void makeRoom(Shard& shard) {
+    auto& map = *shard.map;
+    if (maxSizePerShard_ == 0) {
+      return;
+    }
+    // Every rotation clears a reference bit, so this terminates after at
+    // most size() rotations.
+    while (map.size() >= maxSizePerShard_) {
+      auto it = map.rbegin();
+      if (it->second.referenced.load(std::memory_order_relaxed)) {
+        it->second.referenced.store(false, std::memory_order_relaxed);
+        map.find(it->first);
+        continue;
+      }
+      auto pos = map.findWithoutPromotion(it->first);
+      if (pruneHook_) {
+        map.erase(pos, [&](TKey k, Entry&& e) {
+          pruneHook_(std::move(k), std::move(e.value));
+        });
+      } else {
+        map.erase(pos);
+      }
+      shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  const std::size_t numShards_;
+  const std::size_t maxSizePerShard_;
+  const PruneHookCall pruneHook_;
+  const THash keyHash_;
+  const std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace folly
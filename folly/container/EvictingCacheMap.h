@@ -17,18 +17,476 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <utility>
+#include <vector>
 
 #include <boost/intrusive/list.hpp>
 #include <boost/iterator/iterator_adaptor.hpp>
 
+#include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 #include <folly/container/HeterogeneousAccess.h>
+#include <folly/lang/Bits.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
 
+/**
+ * Eviction policies for EvictingCacheMap.
+ *
+ * A policy is a class with a nested NodeBase, which every entry node derives
+ * from to hold per-entry policy state, and a nested class template Impl<Node>
+ * that owns the eviction order. EvictingCacheMap notifies the Impl when an
+ * entry is inserted, promoted by a lookup and erased, and asks it for the next
+ * victim when it needs to evict. Iteration order is always LRU order,
+ * whatever the policy.
+ */
+
+/**
+ * Evicts the least recently used entry. This is the default, and is handled
+ * directly by EvictingCacheMap at no extra cost.
+ */
+struct EvictingCacheMapLruPolicy {
+  struct NodeBase {};
+
+  template <class Node>
+  class Impl {
+   public:
+    static constexpr bool kEvictsLeastRecentlyUsed = true;
+
+    explicit Impl(std::size_t) {}
+
+    void setMaxSize(std::size_t) {}
+    void onInsert(Node&, std::size_t) {}
+    void onAccess(Node&) {}
+    void onErase(Node&) {}
+  };
+};
+
+namespace detail {
+
+struct EvictingCacheMapPolicyTag {};
+
+// Policy lists use normal_link: nodes are always unlinked from them before
+// being destroyed, except when the whole map is destroyed or moved over, in
+// which case the lists are reset without touching the nodes.
+using EvictingCacheMapPolicyHook = boost::intrusive::list_base_hook<
+    boost::intrusive::tag<EvictingCacheMapPolicyTag>,
+    boost::intrusive::link_mode<boost::intrusive::normal_link>>;
+
+template <class Node>
+using EvictingCacheMapPolicyList = boost::intrusive::
+    list<Node, boost::intrusive::base_hook<EvictingCacheMapPolicyHook>>;
+
+/**
+ * Count-min sketch estimating how often each key hash was seen, using four
+ * rows of saturating 4-bit counters (stored one per byte). After 10 increments
+ * per entry of capacity all counters are halved, so that the estimates follow
+ * changes in popularity.
+ */
+class EvictingCacheMapFrequencySketch {
+ public:
+  static constexpr uint8_t kMaxCount = 15;
+
+  explicit EvictingCacheMapFrequencySketch(std::size_t capacity) {
+    resize(capacity);
+  }
+
+  /// Resets all counters if the capacity needs a table of a different size.
+  void resize(std::size_t capacity) {
+    std::size_t width = nextPowTwo(std::max<std::size_t>(capacity, 16));
+    sampleSize_ = 10 * std::max<std::size_t>(capacity, 16);
+    if (width == table_.size() / kDepth) {
+      return;
+    }
+    table_.assign(width * kDepth, 0);
+    shift_ = 64 - findLastSet(width - 1);
+    additions_ = 0;
+  }
+
+  void increment(std::size_t hash) {
+    bool added = false;
+    for (std::size_t i = 0; i < kDepth; ++i) {
+      auto& counter = table_[slot(hash, i)];
+      if (counter < kMaxCount) {
+        ++counter;
+        added = true;
+      }
+    }
+    if (added && ++additions_ >= sampleSize_) {
+      age();
+    }
+  }
+
+  uint8_t estimate(std::size_t hash) const {
+    uint8_t count = kMaxCount;
+    for (std::size_t i = 0; i < kDepth; ++i) {
+      count = std::min(count, table_[slot(hash, i)]);
+    }
+    return count;
+  }
+
+  void swap(EvictingCacheMapFrequencySketch& that) noexcept {
+    std::swap(table_, that.table_);
+    std::swap(shift_, that.shift_);
+    std::swap(sampleSize_, that.sampleSize_);
+    std::swap(additions_, that.additions_);
+  }
+
+ private:
+  static constexpr std::size_t kDepth = 4;
+
+  // Multiplicative hashing with a different odd multiplier per row, so that
+  // keys colliding in one row are unlikely to collide in the others. The top
+  // bits are used, which are well mixed even if the key hash isn't.
+  std::size_t slot(std::size_t hash, std::size_t row) const {
+    static constexpr uint64_t kSeeds[kDepth] = {
+        0x9e3779b97f4a7c15,
+        0xc2b2ae3d27d4eb4f,
+        0x165667b19e3779f9,
+        0xd6e8feb86659fd93,
+    };
+    auto h = (static_cast<uint64_t>(hash) + row) * kSeeds[row];
+    auto width = table_.size() / kDepth;
+    return row * width + static_cast<std::size_t>(h >> shift_);
+  }
+
+  void age() {
+    for (auto& counter : table_) {
+      counter >>= 1;
+    }
+    additions_ /= 2;
+  }
+
+  std::vector<uint8_t> table_;
+  unsigned shift_{0};
+  std::size_t sampleSize_{0};
+  std::size_t additions_{0};
+};
+
+} // namespace detail
+
+/**
+ * W-TinyLFU (Einziger, Friedman and Manes, "TinyLFU: A Highly Efficient Cache
+ * Admission Policy", 2017).
+ *
+ * New entries go to a small LRU window (1% of the capacity). An entry leaving
+ * the window is admitted to the main region only if it has been accessed more
+ * often, according to a frequency sketch, than the entry the main region
+ * would evict; otherwise the window entry itself is evicted. The main region
+ * is a segmented LRU: entries start on probation and are moved to a protected
+ * segment (80% of the main region) when accessed again.
+ *
+ * This keeps frequently used entries in the cache through scans and other
+ * bursts of one-time accesses, which would flush an LRU cache, while the
+ * window still lets recency-biased workloads perform like LRU.
+ */
+struct EvictingCacheMapTinyLfuPolicy {
+  struct NodeBase : detail::EvictingCacheMapPolicyHook {
+    std::size_t policyHash{0};
+    uint8_t policySegment{0};
+  };
+
+  template <class Node>
+  class Impl {
+   public:
+    static constexpr bool kEvictsLeastRecentlyUsed = false;
+
+    explicit Impl(std::size_t maxSize) : sketch_(maxSize) {
+      setMaxSize(maxSize);
+    }
+
+    Impl(Impl&& that) : sketch_(0) { swap(that); }
+
+    Impl& operator=(Impl&& that) {
+      clear();
+      swap(that);
+      return *this;
+    }
+
+    void setMaxSize(std::size_t maxSize) {
+      maxSize_ = maxSize;
+      windowCapacity_ = std::max<std::size_t>(1, maxSize / 100);
+      auto mainCapacity =
+          maxSize > windowCapacity_ ? maxSize - windowCapacity_ : 0;
+      protectedCapacity_ = mainCapacity * 8 / 10;
+      sketch_.resize(maxSize);
+    }
+
+    void onInsert(Node& node, std::size_t hash) {
+      node.policyHash = hash;
+      node.policySegment = kWindow;
+      window_.push_front(node);
+      sketch_.increment(hash);
+      // While the map is not full, entries leaving the window are admitted
+      // without competing; once it is full, evict() makes them compete.
+      if (window_.size() > windowCapacity_ &&
+          (maxSize_ == 0 || size() <= maxSize_)) {
+        Node& candidate = window_.back();
+        window_.pop_back();
+        candidate.policySegment = kProbation;
+        probation_.push_front(candidate);
+      }
+    }
+
+    void onAccess(Node& node) {
+      sketch_.increment(node.policyHash);
+      auto& list = listOf(node);
+      list.erase(list.iterator_to(node));
+      switch (node.policySegment) {
+        case kWindow:
+          window_.push_front(node);
+          break;
+        case kProtected:
+          protected_.push_front(node);
+          break;
+        default:
+          node.policySegment = kProtected;
+          protected_.push_front(node);
+          if (protected_.size() > protectedCapacity_) {
+            demoteProtected();
+          }
+          break;
+      }
+    }
+
+    void onErase(Node& node) {
+      auto& list = listOf(node);
+      list.erase(list.iterator_to(node));
+    }
+
+    /// Unlinks and returns the entry to evict. Must not be called if empty.
+    Node* evict() {
+      assert(size() > 0);
+      if (probation_.empty() && !protected_.empty()) {
+        demoteProtected();
+      }
+      if (probation_.empty()) {
+        return popBack(window_);
+      }
+      if (window_.size() <= windowCapacity_) {
+        return popBack(probation_);
+      }
+      Node& candidate = window_.back();
+      Node& victim = probation_.back();
+      window_.pop_back();
+      if (sketch_.estimate(candidate.policyHash) >
+          sketch_.estimate(victim.policyHash)) {
+        probation_.pop_back();
+        candidate.policySegment = kProbation;
+        probation_.push_front(candidate);
+        return &victim;
+      }
+      return &candidate;
+    }
+
+   private:
+    using List = detail::EvictingCacheMapPolicyList<Node>;
+
+    enum : uint8_t { kWindow, kProbation, kProtected };
+
+    std::size_t size() const {
+      return window_.size() + probation_.size() + protected_.size();
+    }
+
+    List& listOf(const Node& node) {
+      switch (node.policySegment) {
+        case kWindow:
+          return window_;
+        case kProbation:
+          return probation_;
+        default:
+          return protected_;
+      }
+    }
+
+    void demoteProtected() {
+      Node& node = protected_.back();
+      protected_.pop_back();
+      node.policySegment = kProbation;
+      probation_.push_front(node);
+    }
+
+    static Node* popBack(List& list) {
+      Node* node = &list.back();
+      list.pop_back();
+      return node;
+    }
+
+    void clear() {
+      window_.clear();
+      probation_.clear();
+      protected_.clear();
+    }
+
+    void swap(Impl& that) {
+      window_.swap(that.window_);
+      probation_.swap(that.probation_);
+      protected_.swap(that.protected_);
+      sketch_.swap(that.sketch_);
+      std::swap(maxSize_, that.maxSize_);
+      std::swap(windowCapacity_, that.windowCapacity_);
+      std::swap(protectedCapacity_, that.protectedCapacity_);
+    }
+
+    List window_;
+    List probation_;
+    List protected_;
+    detail::EvictingCacheMapFrequencySketch sketch_;
+    std::size_t maxSize_{0};
+    std::size_t windowCapacity_{1};
+    std::size_t protectedCapacity_{0};
+  };
+};
+
+/**
+ * S3-FIFO (Yang et al., "FIFO Queues are All You Need for Cache Eviction",
+ * SOSP 2023).
+ *
+ * New entries go to a small FIFO queue (10% of the capacity). Entries reaching
+ * the end of that queue move to the main FIFO queue if they were accessed
+ * while in it, and are evicted otherwise, leaving their key hash in a ghost
+ * queue. Entries whose hash is still in the ghost queue when they are
+ * inserted again go directly to the main queue. Entries reaching the end of
+ * the main queue are reinserted if they were accessed, up to 3 times per
+ * access, and evicted otherwise.
+ *
+ * Most one-hit wonders are thus evicted quickly from the small queue, without
+ * disturbing the main queue. Lookups only bump a counter, without reordering
+ * anything.
+ */
+struct EvictingCacheMapS3FifoPolicy {
+  struct NodeBase : detail::EvictingCacheMapPolicyHook {
+    std::size_t policyHash{0};
+    uint8_t policyFreq{0};
+    bool policyInMain{false};
+  };
+
+  template <class Node>
+  class Impl {
+   public:
+    static constexpr bool kEvictsLeastRecentlyUsed = false;
+
+    explicit Impl(std::size_t maxSize) { setMaxSize(maxSize); }
+
+    Impl(Impl&& that) { swap(that); }
+
+    Impl& operator=(Impl&& that) {
+      small_.clear();
+      main_.clear();
+      swap(that);
+      return *this;
+    }
+
+    void setMaxSize(std::size_t maxSize) {
+      smallCapacity_ = std::max<std::size_t>(1, maxSize / 10);
+      ghostCapacity_ = std::max<std::size_t>(1, maxSize);
+      while (ghost_.size() > ghostCapacity_) {
+        popGhost();
+      }
+    }
+
+    void onInsert(Node& node, std::size_t hash) {
+      node.policyHash = hash;
+      node.policyFreq = 0;
+      auto it = ghostSeq_.find(hash);
+      node.policyInMain = it != ghostSeq_.end();
+      if (node.policyInMain) {
+        ghostSeq_.erase(it);
+        main_.push_front(node);
+      } else {
+        small_.push_front(node);
+      }
+    }
+
+    void onAccess(Node& node) {
+      if (node.policyFreq < kMaxFreq) {
+        ++node.policyFreq;
+      }
+    }
+
+    void onErase(Node& node) {
+      auto& list = node.policyInMain ? main_ : small_;
+      list.erase(list.iterator_to(node));
+    }
+
+    /// Unlinks and returns the entry to evict. Must not be called if empty.
+    Node* evict() {
+      assert(!small_.empty() || !main_.empty());
+      while (true) {
+        if (!small_.empty() &&
+            (small_.size() > smallCapacity_ || main_.empty())) {
+          Node& node = small_.back();
+          small_.pop_back();
+          if (node.policyFreq > 0) {
+            node.policyFreq = 0;
+            node.policyInMain = true;
+            main_.push_front(node);
+            continue;
+          }
+          pushGhost(node.policyHash);
+          return &node;
+        }
+        Node& node = main_.back();
+        main_.pop_back();
+        if (node.policyFreq > 0) {
+          --node.policyFreq;
+          main_.push_front(node);
+          continue;
+        }
+        return &node;
+      }
+    }
+
+   private:
+    using List = detail::EvictingCacheMapPolicyList<Node>;
+
+    static constexpr uint8_t kMaxFreq = 3;
+
+    // A hash may be queued several times; only its latest entry, whose
+    // sequence number is in ghostSeq_, counts.
+    void pushGhost(std::size_t hash) {
+      if (ghost_.size() >= ghostCapacity_) {
+        popGhost();
+      }
+      ghost_.emplace_back(hash, ++ghostClock_);
+      ghostSeq_[hash] = ghostClock_;
+    }
+
+    void popGhost() {
+      auto [hash, seq] = ghost_.front();
+      ghost_.pop_front();
+      auto it = ghostSeq_.find(hash);
+      if (it != ghostSeq_.end() && it->second == seq) {
+        ghostSeq_.erase(it);
+      }
+    }
+
+    void swap(Impl& that) {
+      small_.swap(that.small_);
+      main_.swap(that.main_);
+      ghost_.swap(that.ghost_);
+      ghostSeq_.swap(that.ghostSeq_);
+      std::swap(ghostClock_, that.ghostClock_);
+      std::swap(smallCapacity_, that.smallCapacity_);
+      std::swap(ghostCapacity_, that.ghostCapacity_);
+    }
+
+    List small_;
+    List main_;
+    std::deque<std::pair<std::size_t, uint64_t>> ghost_;
+    F14FastMap<std::size_t, uint64_t> ghostSeq_;
+    uint64_t ghostClock_{0};
+    std::size_t smallCapacity_{1};
+    std::size_t ghostCapacity_{1};
+  };
+};
+
 /**
  * A general purpose LRU evicting cache designed to support constant time
  * set/get/insert/erase ops. The only required configuration parameter is the
@@ -57,12 +515,22 @@ namespace folly {
  *
  * NOTE: Previous versions of this structure used a hash table size that was
  * fixed at creation time, but that limitation is no longer present.
+ *
+ * Which entries are evicted is determined by TPolicy. With the default,
+ * EvictingCacheMapLruPolicy, it is the least recently used ones as described
+ * above. EvictingCacheMapTinyLfuPolicy and EvictingCacheMapS3FifoPolicy are
+ * scan resistant, i.e. a burst of one-time accesses doesn't flush frequently
+ * used entries, at the cost of some extra memory per entry and of computing
+ * the key hash on insert. Iteration and rbegin() remain in LRU order with any
+ * policy, but the back of the list is then not necessarily the next entry to
+ * be evicted.
  */
 template <
     class TKey,
     class TValue,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TPolicy = EvictingCacheMapLruPolicy>
 class EvictingCacheMap {
  private:
   // typedefs for brevity
@@ -168,7 +636,8 @@ class EvictingCacheMap {
         keyEqual_(keyEqual),
         index_(maxSize + /*transient*/ 1, keyHash_, keyEqual_),
         maxSize_(maxSize),
-        clearSize_(clearSize) {}
+        clearSize_(clearSize),
+        policy_(maxSize) {}
 
   EvictingCacheMap(const EvictingCacheMap&) = delete;
   EvictingCacheMap& operator=(const EvictingCacheMap&) = delete;
@@ -188,6 +657,7 @@ class EvictingCacheMap {
    * @param pruneHook eviction callback to use INSTEAD OF the configured one
    */
   void setMaxSize(size_t maxSize, PruneHookCall pruneHook = nullptr) {
+    policy_.setMaxSize(maxSize);
     if (maxSize != 0 && maxSize < size()) {
       // Prune the excess elements with our new constraints.
       prune(std::max(size() - maxSize, clearSize_), pruneHook);
@@ -465,8 +935,8 @@ class EvictingCacheMap {
   PruneHookCall getPruneHook() { return pruneHook_; }
 
   /**
-   * Prune the minimum of pruneSize and size() from the back of the LRU.
-   * Will throw if pruneHook throws.
+   * Prune the minimum of pruneSize and size() from the back of the LRU, or in
+   * the order chosen by TPolicy. Will throw if pruneHook throws.
    * @param pruneSize minimum number of elements to prune
    * @param pruneHook eviction callback to use INSTEAD OF the configured one
    */
@@ -474,7 +944,12 @@ class EvictingCacheMap {
     auto& ph = (nullptr == pruneHook) ? pruneHook_ : pruneHook;
 
     for (std::size_t i = 0; i < pruneSize && !lru_.empty(); i++) {
-      auto* node = &(*lru_.rbegin());
+      Node* node;
+      if constexpr (PolicyImpl::kEvictsLeastRecentlyUsed) {
+        node = &(*lru_.rbegin());
+      } else {
+        node = policy_.evict();
+      }
       std::unique_ptr<Node> node_owner(node);
 
       lru_.erase(lru_.iterator_to(*node));
@@ -515,7 +990,8 @@ class EvictingCacheMap {
  private:
   struct Node
       : public boost::intrusive::list_base_hook<
-            boost::intrusive::link_mode<boost::intrusive::safe_link>> {
+            boost::intrusive::link_mode<boost::intrusive::safe_link>>,
+        public TPolicy::NodeBase {
     template <typename K>
     Node(const K& key, TValue&& value) : pr(key, std::move(value)) {}
 
@@ -527,6 +1003,7 @@ class EvictingCacheMap {
     TPair pr;
   };
   using NodePtr = Node*;
+  using PolicyImpl = typename TPolicy::template Impl<Node>;
 
   // NOTE: deriving from boost::intrusive::list is likely discouraged. This is
   // simply an alternative to an ugly explicit move operator for
@@ -631,6 +1108,7 @@ class EvictingCacheMap {
       return self.end();
     }
     self.lru_.splice(self.lru_.begin(), self.lru_, self.lru_.iterator_to(*ptr));
+    self.policy_.onAccess(*ptr);
     return self_iterator_t<Self>(self.lru_.iterator_to(*ptr));
   }
 
@@ -656,6 +1134,7 @@ class EvictingCacheMap {
       typename NodeList::const_iterator base_iter,
       PruneHookCall eraseHook) {
     std::unique_ptr<Node> node_owner(ptr);
+    policy_.onErase(*ptr);
     index_.erase(ptr);
     auto next_base_iter = lru_.erase(base_iter);
     if (eraseHook) {
@@ -683,11 +1162,13 @@ class EvictingCacheMap {
       ptr->pr.second = std::move(value);
       if (promote) {
         lru_.splice(lru_.begin(), lru_, lru_.iterator_to(*ptr));
+        policy_.onAccess(*ptr);
       }
     } else {
       auto node = new Node(key, std::move(value));
       index_.insert(node);
       lru_.push_front(*node);
+      policyInsert(*node);
 
       // no evictions if maxSize_ is 0 i.e. unlimited capacity
       if (maxSize_ > 0 && size() > maxSize_) {
@@ -718,6 +1199,7 @@ class EvictingCacheMap {
 
     // Complete insertion
     lru_.push_front(*nodeOwner.release());
+    policyInsert(*node);
 
     // no evictions if maxSize_ is 0 i.e. unlimited capacity
     if (maxSize_ > 0 && size() > maxSize_) {
@@ -727,6 +1209,14 @@ class EvictingCacheMap {
     return std::pair<iterator, bool>(lru_.iterator_to(*node), true);
   }
 
+  void policyInsert(Node& node) {
+    if constexpr (PolicyImpl::kEvictsLeastRecentlyUsed) {
+      policy_.onInsert(node, 0);
+    } else {
+      policy_.onInsert(node, keyHash_(node.pr.first));
+    }
+  }
+
   template <typename K>
   Node* findInIndex(const K& key) const {
     auto it = index_.find(key);
@@ -744,6 +1234,7 @@ class EvictingCacheMap {
   NodeList lru_;
   std::size_t maxSize_;
   std::size_t clearSize_;
+  PolicyImpl policy_;
 };
 
 } // namespace folly
@@ -111,6 +111,14 @@ class F14BasicMap {
   using iterator = typename Policy::Iter;
   using const_iterator = typename Policy::ConstIter;
 
+  // The table only points to chunks that it allocated, or to a static empty
+  // chunk, so it can be relocated with memcpy as long as its hasher, key
+  // equality and allocator can.
+  using IsRelocatable = std::bool_constant<
+      folly::IsRelocatable<hasher>::value &&
+      folly::IsRelocatable<key_equal>::value &&
+      folly::IsRelocatable<allocator_type>::value>;
+
  private:
   using ItemIter = typename Policy::ItemIter;
 
@@ -872,6 +880,42 @@ class F14BasicMap {
     return table_.makeConstIter(table_.find(token, key));
   }
 
+  /**
+   * @overloadbrief Look up many keys at once.
+   * @methodset Lookup
+   *
+   * findMany(first, last, out) writes find(key) for every key in [first,
+   * last) to out, in order, and returns the end of the written range. The
+   * keys must be key_type or, if the hasher and key_equal are transparent,
+   * any type accepted by find().
+   *
+   * When the map is not in the local CPU cache this is much faster than a
+   * loop of find() calls, because it applies the prehash() / prefetch()
+   * pipelining described above to blocks of keys, overlapping the cache
+   * misses of independent lookups.
+   *
+   *   std::vector<map_type::const_iterator> found(keys.size());
+   *   map.findMany(keys.begin(), keys.end(), found.begin());
+   */
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) {
+    table_.findMany(first, last, [&](auto iter) {
+      *out = table_.makeIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
+  /// @copydoc findMany
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    table_.findMany(first, last, [&](auto iter) {
+      *out = table_.makeConstIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
   /**
    * @overloadbrief Checks if the container contains an element with the
    * specific key.
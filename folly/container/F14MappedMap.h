@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * F14MappedMap
+ *
+ * A read-only hash map whose serialized form is the F14 chunk layout itself
+ * (tags, overflow counts and packed items), so that it can be queried in place
+ * from a file mapped with MemoryMapping. Opening a table of hundreds of
+ * millions of entries costs an mmap() and a header check instead of a rebuild,
+ * and pages are faulted in lazily as lookups touch them.
+ *
+ *   // Offline, or whenever the data changes.
+ *   folly::writeFile(
+ *       folly::F14MappedMap<uint64_t, uint32_t>::serialize(
+ *           entries.begin(), entries.end()),
+ *       path);
+ *
+ *   // At startup.
+ *   folly::F14MappedMap<uint64_t, uint32_t> map{folly::MemoryMapping{path}};
+ *   if (auto item = map.find(key)) {
+ *     use(item->second);
+ *   }
+ *
+ * Keys and mapped values must be trivially copyable, and the hasher must be
+ * stateless and compute the same hash in the writer and in the readers (for
+ * example folly::hasher or std::hash of integers, but not one that hashes
+ * pointers). The format is native endian and specific to the item layout and
+ * to the F14 hash mixing of the build; readers reject tables written with a
+ * different one.
+ *
+ * Lookups probe exactly like F14ValueMap: one vector compare of the 14 tags
+ * of a chunk, and usually a single chunk.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/Likely.h>
+#include <folly/Range.h>
+#include <folly/container/detail/F14Table.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+#include <folly/system/MemoryMapping.h>
+
+#if FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
+
+namespace folly {
+
+namespace f14 {
+namespace detail {
+
+struct F14MappedHeader {
+  static constexpr uint64_t kMagic = 0x3176504d34314646; // "FF14MPv1"
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t magic;
+  uint32_t version;
+  // Identifies the splitHashImpl variant used to compute tags and indexes.
+  uint32_t hashMode;
+  uint32_t itemSize;
+  uint32_t itemAlign;
+  uint32_t chunkSize;
+  uint32_t chunkCapacity;
+  uint64_t chunkCount;
+  uint64_t size;
+  uint8_t reserved[16];
+};
+static_assert(sizeof(F14MappedHeader) == 64);
+static_assert(sizeof(F14MappedHeader) % kRequiredVectorAlignment == 0);
+
+} // namespace detail
+} // namespace f14
+
+template <
+    typename Key,
+    typename Mapped,
+    typename Hasher = f14::DefaultHasher<Key>,
+    typename KeyEqual = f14::DefaultKeyEqual<Key>>
+class F14MappedMap {
+  static_assert(
+      std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Mapped>,
+      "F14MappedMap items are stored as raw bytes");
+  static_assert(
+      std::is_empty_v<Hasher> && std::is_empty_v<KeyEqual>,
+      "F14MappedMap requires a stateless hasher and key_equal");
+
+ public:
+  using key_type = Key;
+  using mapped_type = Mapped;
+  using value_type = std::pair<Key, Mapped>;
+  using size_type = std::size_t;
+  using hasher = Hasher;
+  using key_equal = KeyEqual;
+
+ private:
+  using Chunk = f14::detail::F14Chunk<value_type>;
+  using Header = f14::detail::F14MappedHeader;
+  using HashPair = std::pair<std::size_t, std::size_t>;
+
+ public:
+  /**
+   * Builds the serialized table of the entries in [first, last), which must
+   * be a forward range of pairs of key and mapped value. Like insert(), the
+   * first of several entries with equal keys wins.
+   */
+  template <typename ForwardIt>
+  static std::string serialize(ForwardIt first, ForwardIt last) {
+    auto const count = static_cast<std::size_t>(std::distance(first, last));
+    std::size_t chunkCount = nextPowTwo(std::max<std::size_t>(
+        1, (count + Chunk::kDesiredCapacity - 1) / Chunk::kDesiredCapacity));
+    std::size_t const chunkMask = chunkCount - 1;
+
+    // Value initialization zeroes tags, overflow counts and unused items, so
+    // equal inputs serialize to equal bytes.
+    std::vector<Chunk> chunks(chunkCount);
+    std::size_t size = 0;
+    for (; first != last; ++first) {
+      auto const& key = first->first;
+      auto hp = splitHash(Hasher{}(key));
+      if (findIn(chunks.data(), chunkMask, hp, key) != nullptr) {
+        continue;
+      }
+      std::size_t index = hp.first;
+      Chunk* chunk = &chunks[index & chunkMask];
+      auto empty = chunk->firstEmpty();
+      while (!empty.hasIndex()) {
+        chunk->incrOutboundOverflowCount();
+        index += probeDelta(hp);
+        chunk = &chunks[index & chunkMask];
+        empty = chunk->firstEmpty();
+      }
+      auto i = empty.index();
+      new (chunk->itemAddr(i)) value_type(key, first->second);
+      chunk->setTag(i, hp.second);
+      ++size;
+    }
+
+    Header header{};
+    header.magic = Header::kMagic;
+    header.version = Header::kVersion;
+    header.hashMode = hashMode();
+    header.itemSize = sizeof(value_type);
+    header.itemAlign = alignof(value_type);
+    header.chunkSize = sizeof(Chunk);
+    header.chunkCapacity = Chunk::kCapacity;
+    header.chunkCount = chunkCount;
+    header.size = size;
+
+    std::string out;
+    out.reserve(sizeof(Header) + chunkCount * sizeof(Chunk));
+    out.append(reinterpret_cast<char const*>(&header), sizeof(Header));
+    out.append(
+        reinterpret_cast<char const*>(chunks.data()),
+        chunkCount * sizeof(Chunk));
+    return out;
+  }
+
+  /**
+   * Views a serialized table. data must stay valid and unchanged for the
+   * lifetime of the map, and be aligned to 16 bytes, as mappings and heap
+   * allocations are. Throws std::invalid_argument if data is not a table of
+   * this type.
+   */
+  explicit F14MappedMap(ByteRange data) { attach(data); }
+
+  /// Views the table in mapping, which the map keeps alive.
+  explicit F14MappedMap(MemoryMapping mapping) : mapping_(std::move(mapping)) {
+    attach(mapping_->range());
+  }
+
+  F14MappedMap(F14MappedMap&&) = default;
+  F14MappedMap& operator=(F14MappedMap&&) = default;
+
+  std::size_t size() const noexcept { return size_; }
+
+  bool empty() const noexcept { return size_ == 0; }
+
+  /// Returns the item with the given key, or nullptr if there is none.
+  value_type const* find(Key const& key) const {
+    return findIn(chunks_, chunkMask_, splitHash(Hasher{}(key)), key);
+  }
+
+  bool contains(Key const& key) const { return find(key) != nullptr; }
+
+  std::size_t count(Key const& key) const { return contains(key) ? 1 : 0; }
+
+  Mapped const& at(Key const& key) const {
+    auto item = find(key);
+    if (item == nullptr) {
+      throw_exception<std::out_of_range>("at() did not find key");
+    }
+    return item->second;
+  }
+
+  /// Calls f with every item, in chunk order.
+  template <typename F>
+  void forEach(F f) const {
+    for (std::size_t c = 0; c <= chunkMask_; ++c) {
+      auto iter = chunks_[c].occupiedIter();
+      while (iter.hasNext()) {
+        f(chunks_[c].citem(iter.next()));
+      }
+    }
+  }
+
+ private:
+  static constexpr uint32_t hashMode() {
+    if (IsAvalanchingHasher<Hasher, Key>::value) {
+      return f14::detail::ShouldAssume32BitHash<Hasher>::value ? 1 : 2;
+    }
+    return FOLLY_F14_CRC_INTRINSIC_AVAILABLE ? 3 : 4;
+  }
+
+  static HashPair splitHash(std::size_t hash) {
+    return f14::detail::splitHashImpl<Hasher, Key>(hash);
+  }
+
+  static std::size_t probeDelta(HashPair hp) { return 2 * hp.second + 1; }
+
+  static auto loadNeedleV(std::size_t needle) {
+#if FOLLY_NEON
+    return vdupq_n_u8(static_cast<uint8_t>(needle));
+#elif FOLLY_SSE >= 2
+    return _mm_set1_epi8(static_cast<uint8_t>(needle));
+#else
+    return needle;
+#endif
+  }
+
+  // Same probe sequence as F14Table::findImpl.
+  static value_type const* findIn(
+      Chunk const* chunks, std::size_t chunkMask, HashPair hp, Key const& key) {
+#if FOLLY_ARM_FEATURE_NEON_SVE_BRIDGE
+    svbool_t pred = svwhilelt_b8_u32(0, Chunk::kCapacity);
+#endif
+    std::size_t index = hp.first;
+    auto needleV = loadNeedleV(hp.second);
+    for (std::size_t tries = 0; tries <= chunkMask; ++tries) {
+      Chunk const* chunk = chunks + (index & chunkMask);
+#if FOLLY_ARM_FEATURE_NEON_SVE_BRIDGE
+      auto hits = chunk->tagMatchIter(needleV, pred);
+#else
+      auto hits = chunk->tagMatchIter(needleV);
+#endif
+      while (hits.hasNext()) {
+        auto& item = chunk->citem(hits.next());
+        if (FOLLY_LIKELY(KeyEqual{}(key, item.first))) {
+          return &item;
+        }
+      }
+      if (FOLLY_LIKELY(chunk->outboundOverflowCount() == 0)) {
+        break;
+      }
+      index += probeDelta(hp);
+    }
+    return nullptr;
+  }
+
+  void attach(ByteRange data) {
+    if (data.size() < sizeof(Header) ||
+        reinterpret_cast<uintptr_t>(data.data()) %
+                f14::detail::kRequiredVectorAlignment !=
+            0) {
+      throw_exception<std::invalid_argument>(
+          "F14MappedMap: truncated or misaligned table");
+    }
+    Header header;
+    std::memcpy(&header, data.data(), sizeof(Header));
+    if (header.magic != Header::kMagic || header.version != Header::kVersion) {
+      throw_exception<std::invalid_argument>(
+          "F14MappedMap: not a table or unsupported version");
+    }
+    if (header.hashMode != hashMode() ||
+        header.itemSize != sizeof(value_type) ||
+        header.itemAlign != alignof(value_type) ||
+        header.chunkSize != sizeof(Chunk) ||
+        header.chunkCapacity != Chunk::kCapacity) {
+      throw_exception<std::invalid_argument>(
+          "F14MappedMap: table was written with a different layout");
+    }
+    if (header.chunkCount == 0 ||
+        (header.chunkCount & (header.chunkCount - 1)) != 0 ||
+        header.chunkCount * sizeof(Chunk) != data.size() - sizeof(Header)) {
+      throw_exception<std::invalid_argument>(
+          "F14MappedMap: chunk count does not match the table size");
+    }
+    chunks_ = reinterpret_cast<Chunk const*>(data.data() + sizeof(Header));
+    chunkMask_ = static_cast<std::size_t>(header.chunkCount - 1);
+    size_ = static_cast<std::size_t>(header.size);
+  }
+
+  std::optional<MemoryMapping> mapping_;
+  Chunk const* chunks_{nullptr};
+  std::size_t chunkMask_{0};
+  std::size_t size_{0};
+};
+
+} // namespace folly
+
+#endif // FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
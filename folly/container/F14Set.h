@@ -33,6 +33,7 @@
 #include <tuple>
 
 #include <folly/Portability.h>
+#include <folly/Traits.h>
 #include <folly/container/View.h>
 #include <folly/lang/SafeAssert.h>
 
@@ -105,6 +106,14 @@ class F14BasicSet {
   using iterator = typename Policy::Iter;
   using const_iterator = iterator;
 
+  // The table only points to chunks that it allocated, or to a static empty
+  // chunk, so it can be relocated with memcpy as long as its hasher, key
+  // equality and allocator can.
+  using IsRelocatable = std::bool_constant<
+      folly::IsRelocatable<hasher>::value &&
+      folly::IsRelocatable<key_equal>::value &&
+      folly::IsRelocatable<allocator_type>::value>;
+
  private:
   using ItemIter = typename Policy::ItemIter;
 
@@ -601,6 +610,25 @@ class F14BasicSet {
     return table_.makeIter(table_.find(token, key));
   }
 
+  /**
+   * @overloadbrief Look up many keys at once.
+   * @methodset Lookup
+   *
+   * findMany(first, last, out) writes find(key) for every key in [first,
+   * last) to out, in order, and returns the end of the written range. When
+   * the set is not in the local CPU cache this is much faster than a loop of
+   * find() calls, because it applies prehash() / prefetch() pipelining to
+   * blocks of keys, overlapping the cache misses of independent lookups.
+   */
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    table_.findMany(first, last, [&](auto iter) {
+      *out = table_.makeIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
   /**
    * @overloadbrief Checks if the container contains an element with the
    * specific key.
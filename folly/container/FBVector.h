@@ -39,6 +39,7 @@
 #include <folly/Likely.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Traits.h>
+#include <folly/container/Access.h>
 #include <folly/lang/CheckedMath.h>
 #include <folly/lang/Exception.h>
 #include <folly/lang/Hint.h>
@@ -1126,6 +1127,23 @@ class fbvector {
     }
   }
 
+  // Like C++23's std::vector::append_range. The storage grows at most once
+  //  when the size of the range can be computed up front, and relocatable
+  //  elements are then moved to the new storage with a single memcpy. The
+  //  range must not refer to the elements of the vector.
+  template <class Range>
+  void append_range(Range&& range) {
+    auto first = access::begin(range);
+    auto last = access::end(range);
+    if constexpr (std::is_same<decltype(first), decltype(last)>::value) {
+      insert(cend(), first, last);
+    } else {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    }
+  }
+
   void pop_back() {
     assert(!empty());
     --impl_.e_;
@@ -66,6 +66,14 @@ void RegexMatchCache::repair() noexcept {
   regexVector_.clear();
 }
 
+RegexMatchCache::RegexObject const& RegexMatchCache::compile(
+    RegexToMatchEntry& entry, std::string_view const regex) {
+  if (!entry.object) {
+    entry.object = std::make_shared<RegexObject const>(regex);
+  }
+  return *entry.object;
+}
+
 RegexMatchCache::KeyMap::~KeyMap() = default;
 
 void RegexMatchCache::InspectView::print(std::ostream& o) const {
@@ -438,7 +446,7 @@ void RegexMatchCache::prepareToFindMatches(regex_key_and_view const& regex) {
       guard.dismiss();
       return;
     }
-    RegexObject robject{regex};
+    auto const& robject = compile(rtmentry, regex);
     for (auto& [string, mtrentry] : cacheMatchToRegex_) {
       if (robject(*string)) {
         rtmentry.matches.insert(string);
@@ -456,7 +464,7 @@ void RegexMatchCache::prepareToFindMatches(regex_key_and_view const& regex) {
     auto const strings = std::move(sqriter->second.strings);
     CHECK(!strings.empty());
     stringQueueReverse_.erase(sqriter);
-    RegexObject robject{regex};
+    auto const& robject = compile(rtmentry, regex);
     for (auto const string : strings) {
       auto const sqfiter = stringQueueForward_.find(string);
       CHECK(sqfiter != stringQueueForward_.end());
@@ -478,6 +486,80 @@ void RegexMatchCache::prepareToFindMatches(regex_key_and_view const& regex) {
   guard.dismiss();
 }
 
+bool RegexMatchCache::coalesceStrings(KeyMap const& keys, size_t const limit) {
+  return coalesceStrings(keys, limit, [](auto const n, auto const task) {
+    for (size_t i = 0; i < n; ++i) {
+      task(i);
+    }
+  });
+}
+
+bool RegexMatchCache::coalesceStrings(
+    KeyMap const& keys, size_t const limit, ParallelFor const parallel) {
+  struct Item {
+    string_pointer string{};
+    std::vector<size_t> queued;
+    std::vector<size_t> matched;
+  };
+
+  auto guard = makeGuard(std::bind(&RegexMatchCache::repair, this));
+
+  //  choose strings from string-queue-forward, compiling their regexes
+  std::vector<Item> items;
+  folly::F14FastMap<size_t, RegexObject const*> objects;
+  for (auto const& [string, sqfentry] : stringQueueForward_) {
+    if (items.size() == limit) {
+      break;
+    }
+    auto& item = items.emplace_back();
+    item.string = string;
+    for (auto const regexi : sqfentry.regexes.as_index_set_view()) {
+      item.queued.push_back(regexi);
+      auto const [iter, inserted] = objects.try_emplace(regexi);
+      if (inserted) {
+        auto const regexp = regexVector_.value_at_index(regexi);
+        auto& rtmentry = cacheRegexToMatch_.at(*regexp);
+        iter->second = rtmentry.object
+            ? rtmentry.object.get()
+            : &compile(rtmentry, keys.lookup(*regexp));
+      }
+    }
+  }
+
+  //  evaluate each string against all of its queued regexes
+  parallel(items.size(), [&](size_t const i) {
+    auto& item = items[i];
+    for (auto const regexi : item.queued) {
+      if ((*objects.at(regexi))(*item.string)) {
+        item.matched.push_back(regexi);
+      }
+    }
+  });
+
+  //  move the results from the string-queues into the caches
+  for (auto const& item : items) {
+    stringQueueForward_.erase(item.string);
+    for (auto const regexi : item.queued) {
+      auto const regexp = regexVector_.value_at_index(regexi);
+      auto const sqriter = stringQueueReverse_.find(regexp);
+      CHECK(sqriter != stringQueueReverse_.end());
+      sqriter->second.strings.erase(item.string);
+      if (sqriter->second.strings.empty()) {
+        stringQueueReverse_.erase(sqriter);
+      }
+    }
+    auto& mtrentry = cacheMatchToRegex_.at(item.string);
+    for (auto const regexi : item.matched) {
+      auto const regexp = regexVector_.value_at_index(regexi);
+      cacheRegexToMatch_.at(*regexp).matches.insert(item.string);
+      mtrentry.regexes.set_value(regexi, true);
+    }
+  }
+
+  guard.dismiss();
+  return stringQueueForward_.empty();
+}
+
 RegexMatchCache::FindMatchesUnsafeResult RegexMatchCache::findMatchesUnsafe(
     regex_key const& regex, time_point const now) const {
   if (kIsDebug && !isReadyToFindMatches(regex)) {
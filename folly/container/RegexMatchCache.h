@@ -20,6 +20,7 @@
 #include <cassert>
 #include <chrono>
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -533,6 +534,10 @@ class RegexMatchCache {
   struct RegexToMatchEntry : MoveOnly {
     mutable std::atomic<time_point> accessed_at{};
 
+    /// The compiled regex. Compiled on first use and kept, so that each regex
+    /// is compiled at most once while it is in the cache.
+    std::shared_ptr<RegexObject const> object;
+
     folly::F14VectorSet<string_pointer> matches;
   };
 
@@ -597,6 +602,9 @@ class RegexMatchCache {
 
   void repair() noexcept;
 
+  static RegexObject const& compile(
+      RegexToMatchEntry& entry, std::string_view regex);
+
  public:
   class KeyMap {
    public:
@@ -663,6 +671,13 @@ class RegexMatchCache {
     auto end() const noexcept { return matches_.end(); }
   };
 
+  /// ParallelFor
+  ///
+  /// Called with a count of tasks n and a function task, and must call task(i)
+  /// exactly once for each i in [0, n) before returning, in any order and on
+  /// any threads. Exceptions thrown by task must be propagated.
+  using ParallelFor = FunctionRef<void(size_t, FunctionRef<void(size_t)>)>;
+
   RegexMatchCache() noexcept;
   ~RegexMatchCache();
 
@@ -693,6 +708,24 @@ class RegexMatchCache {
   std::vector<string_pointer> findMatches(
       regex_key const& regex, time_point now) const;
 
+  /// coalesceStrings
+  ///
+  /// Coalesces up to limit strings from the string-queue, evaluating each
+  /// string against all of the regexes for which it is queued at once, and
+  /// returns whether the string-queue is then empty. Later lookups of those
+  /// regexes then need no regex-match operations for those strings.
+  ///
+  /// A bounded limit makes the work incremental, for example for a background
+  /// task which coalesces newly-added strings a slice at a time under an
+  /// exclusive lock. Regexes are compiled at most once, looked up in keys when
+  /// they were added by key only.
+  ///
+  /// The regex-match operations are read-only and are spread over the tasks
+  /// given to parallel, one task per string; the cache is updated afterwards
+  /// on the calling thread.
+  bool coalesceStrings(KeyMap const& keys, size_t limit);
+  bool coalesceStrings(KeyMap const& keys, size_t limit, ParallelFor parallel);
+
   bool hasItemsToPurge(time_point expiry) const noexcept;
 
   void clear();
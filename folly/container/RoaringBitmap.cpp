@@ -0,0 +1,1095 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/RoaringBitmap.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <folly/Portability.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+namespace {
+
+using Container = detail::RoaringContainer;
+using Run = detail::RoaringRun;
+using Type = Container::Type;
+
+constexpr uint32_t kMaxArraySize = Container::kMaxArraySize;
+constexpr uint32_t kBitmapWords = Container::kBitmapWords;
+constexpr uint32_t kContainerValues = 1 << 16;
+
+// From the Roaring format specification.
+constexpr uint32_t kSerialCookieNoRuns = 12346;
+constexpr uint32_t kSerialCookie = 12347;
+constexpr std::size_t kNoOffsetThreshold = 4;
+
+bool testBit(const std::vector<uint64_t>& words, uint32_t i) {
+  return (words[i / 64] >> (i % 64)) & 1;
+}
+
+// Sets the bits first, ..., last.
+void setBits(std::vector<uint64_t>& words, uint32_t first, uint32_t last) {
+  auto const firstWord = first / 64;
+  auto const lastWord = last / 64;
+  auto const firstMask = ~uint64_t(0) << (first % 64);
+  auto const lastMask = ~uint64_t(0) >> (63 - last % 64);
+  if (firstWord == lastWord) {
+    words[firstWord] |= firstMask & lastMask;
+    return;
+  }
+  words[firstWord] |= firstMask;
+  std::fill(words.begin() + firstWord + 1, words.begin() + lastWord, ~0ull);
+  words[lastWord] |= lastMask;
+}
+
+// The first set bit at or after from, or kContainerValues.
+uint32_t nextSetBit(const std::vector<uint64_t>& words, uint32_t from) {
+  if (from >= kContainerValues) {
+    return kContainerValues;
+  }
+  auto w = from / 64;
+  auto word = words[w] & (~uint64_t(0) << (from % 64));
+  while (word == 0) {
+    if (++w == kBitmapWords) {
+      return kContainerValues;
+    }
+    word = words[w];
+  }
+  return w * 64 + findFirstSet(word) - 1;
+}
+
+uint32_t countBits(const std::vector<uint64_t>& words) {
+  uint32_t count = 0;
+  for (auto word : words) {
+    count += popcount(word);
+  }
+  return count;
+}
+
+Container makeArray(std::vector<uint16_t> values) {
+  Container c;
+  c.type = Type::Array;
+  c.cardinality = uint32_t(values.size());
+  c.array = std::move(values);
+  return c;
+}
+
+Container makeBitmap(std::vector<uint64_t> words, uint32_t cardinality) {
+  Container c;
+  c.type = Type::Bitmap;
+  c.cardinality = cardinality;
+  c.bitmap = std::move(words);
+  return c;
+}
+
+Container makeRuns(std::vector<Run> runs) {
+  Container c;
+  c.type = Type::Run;
+  for (auto const& run : runs) {
+    c.cardinality += run.length + 1;
+  }
+  c.runs = std::move(runs);
+  return c;
+}
+
+template <typename F>
+void forEachLow(const Container& c, F f) {
+  switch (c.type) {
+    case Type::Array:
+      for (auto low : c.array) {
+        f(low);
+      }
+      break;
+    case Type::Bitmap:
+      for (uint32_t w = 0; w < kBitmapWords; ++w) {
+        for (auto word = c.bitmap[w]; word != 0; word &= word - 1) {
+          f(uint16_t(w * 64 + findFirstSet(word) - 1));
+        }
+      }
+      break;
+    case Type::Run:
+      for (auto const& run : c.runs) {
+        for (uint32_t low = run.start; low <= run.end(); ++low) {
+          f(uint16_t(low));
+        }
+      }
+      break;
+  }
+}
+
+std::vector<uint64_t> toWords(const Container& c) {
+  if (c.type == Type::Bitmap) {
+    return c.bitmap;
+  }
+  std::vector<uint64_t> words(kBitmapWords);
+  if (c.type == Type::Run) {
+    for (auto const& run : c.runs) {
+      setBits(words, run.start, run.end());
+    }
+  } else {
+    for (auto low : c.array) {
+      words[low / 64] |= uint64_t(1) << (low % 64);
+    }
+  }
+  return words;
+}
+
+std::vector<uint16_t> toArray(const Container& c) {
+  if (c.type == Type::Array) {
+    return c.array;
+  }
+  std::vector<uint16_t> values;
+  values.reserve(c.cardinality);
+  forEachLow(c, [&](uint16_t low) { values.push_back(low); });
+  return values;
+}
+
+std::vector<Run> toRuns(const Container& c) {
+  if (c.type == Type::Run) {
+    return c.runs;
+  }
+  std::vector<Run> runs;
+  forEachLow(c, [&](uint16_t low) {
+    if (!runs.empty() && runs.back().end() + 1 == low) {
+      ++runs.back().length;
+    } else {
+      runs.push_back({low, 0});
+    }
+  });
+  return runs;
+}
+
+uint32_t countRuns(const Container& c) {
+  switch (c.type) {
+    case Type::Array: {
+      uint32_t count = 1;
+      for (std::size_t i = 1; i < c.array.size(); ++i) {
+        count += c.array[i] != c.array[i - 1] + 1;
+      }
+      return count;
+    }
+    case Type::Bitmap: {
+      // A run starts at each set bit whose predecessor is clear.
+      uint32_t count = 0;
+      uint64_t carry = 0;
+      for (auto word : c.bitmap) {
+        count += popcount(word & ~((word << 1) | carry));
+        carry = word >> 63;
+      }
+      return count;
+    }
+    case Type::Run:
+      return uint32_t(c.runs.size());
+  }
+  return 0;
+}
+
+std::size_t serializedContainerSize(const Container& c) {
+  switch (c.type) {
+    case Type::Array:
+      return c.array.size() * sizeof(uint16_t);
+    case Type::Bitmap:
+      return kBitmapWords * sizeof(uint64_t);
+    case Type::Run:
+      return sizeof(uint16_t) + c.runs.size() * 2 * sizeof(uint16_t);
+  }
+  return 0;
+}
+
+// Turns an array or bitmap container into the type that fits its
+// cardinality, or a run container into an array or bitmap one.
+void normalize(Container& c) {
+  if (c.type != Type::Bitmap && c.cardinality > kMaxArraySize) {
+    c.bitmap = toWords(c);
+    c.array = {};
+    c.runs = {};
+    c.type = Type::Bitmap;
+  } else if (c.type != Type::Array && c.cardinality <= kMaxArraySize) {
+    c.array = toArray(c);
+    c.bitmap = {};
+    c.runs = {};
+    c.type = Type::Array;
+  }
+}
+
+Container materialize(const Container& c) {
+  return c.cardinality <= kMaxArraySize
+      ? makeArray(toArray(c))
+      : makeBitmap(toWords(c), c.cardinality);
+}
+
+std::vector<Run>::const_iterator findRun(
+    const std::vector<Run>& runs, uint16_t low) {
+  auto next = std::upper_bound(
+      runs.begin(), runs.end(), low, [](uint16_t value, const Run& run) {
+        return value < run.start;
+      });
+  if (next == runs.begin() || low > (next - 1)->end()) {
+    return runs.end();
+  }
+  return next - 1;
+}
+
+bool containerContains(const Container& c, uint16_t low) {
+  switch (c.type) {
+    case Type::Array:
+      return std::binary_search(c.array.begin(), c.array.end(), low);
+    case Type::Bitmap:
+      return testBit(c.bitmap, low);
+    case Type::Run:
+      return findRun(c.runs, low) != c.runs.end();
+  }
+  return false;
+}
+
+bool containerInsert(Container& c, uint16_t low) {
+  switch (c.type) {
+    case Type::Array: {
+      auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+      if (it != c.array.end() && *it == low) {
+        return false;
+      }
+      if (c.array.size() < kMaxArraySize) {
+        c.array.insert(it, low);
+        ++c.cardinality;
+        return true;
+      }
+      ++c.cardinality;
+      c.bitmap = toWords(c);
+      c.array = {};
+      c.type = Type::Bitmap;
+      c.bitmap[low / 64] |= uint64_t(1) << (low % 64);
+      return true;
+    }
+    case Type::Bitmap: {
+      auto& word = c.bitmap[low / 64];
+      auto const bit = uint64_t(1) << (low % 64);
+      if (word & bit) {
+        return false;
+      }
+      word |= bit;
+      ++c.cardinality;
+      return true;
+    }
+    case Type::Run: {
+      auto& runs = c.runs;
+      auto next = std::upper_bound(
+          runs.begin(), runs.end(), low, [](uint16_t value, const Run& run) {
+            return value < run.start;
+          });
+      bool const joinsNext = next != runs.end() && next->start == low + 1;
+      if (next != runs.begin()) {
+        auto prev = next - 1;
+        if (low <= prev->end()) {
+          return false;
+        }
+        if (low == prev->end() + 1) {
+          ++prev->length;
+          if (joinsNext) {
+            prev->length += next->length + 1;
+            runs.erase(next);
+          }
+          ++c.cardinality;
+          return true;
+        }
+      }
+      if (joinsNext) {
+        next->start = low;
+        ++next->length;
+      } else {
+        runs.insert(next, Run{low, 0});
+      }
+      ++c.cardinality;
+      // Don't let isolated values make the runs larger than the
+      // alternative.
+      auto const other =
+          std::min(c.cardinality * sizeof(uint16_t), std::size_t(8192));
+      if (serializedContainerSize(c) > 2 * other) {
+        normalize(c);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool containerErase(Container& c, uint16_t low) {
+  switch (c.type) {
+    case Type::Array: {
+      auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+      if (it == c.array.end() || *it != low) {
+        return false;
+      }
+      c.array.erase(it);
+      --c.cardinality;
+      return true;
+    }
+    case Type::Bitmap: {
+      auto& word = c.bitmap[low / 64];
+      auto const bit = uint64_t(1) << (low % 64);
+      if (!(word & bit)) {
+        return false;
+      }
+      word &= ~bit;
+      --c.cardinality;
+      normalize(c);
+      return true;
+    }
+    case Type::Run: {
+      auto found = findRun(c.runs, low);
+      if (found == c.runs.end()) {
+        return false;
+      }
+      auto it = c.runs.begin() + (found - c.runs.cbegin());
+      if (it->length == 0) {
+        c.runs.erase(it);
+      } else if (low == it->start) {
+        ++it->start;
+        --it->length;
+      } else if (low == it->end()) {
+        --it->length;
+      } else {
+        Run right{uint16_t(low + 1), uint16_t(it->end() - low - 1)};
+        it->length = uint16_t(low - it->start - 1);
+        c.runs.insert(it + 1, right);
+      }
+      --c.cardinality;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename WordOp>
+Container bitmapOp(
+    const std::vector<uint64_t>& a,
+    const std::vector<uint64_t>& b,
+    WordOp op) {
+  std::vector<uint64_t> words(kBitmapWords);
+  // Kept apart from the popcount, so that the compiler vectorizes it.
+  for (uint32_t i = 0; i < kBitmapWords; ++i) {
+    words[i] = op(a[i], b[i]);
+  }
+  auto const cardinality = countBits(words);
+  auto c = makeBitmap(std::move(words), cardinality);
+  normalize(c);
+  return c;
+}
+
+
+Container arrayOp(
+    const std::vector<uint16_t>& a,
+    const std::vector<uint16_t>& b,
+    detail::RoaringOp op) {
+  std::vector<uint16_t> values;
+  auto out = std::back_inserter(values);
+  switch (op) {
+    case detail::RoaringOp::Or:
+      values.reserve(a.size() + b.size());
+      std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+      break;
+    case detail::RoaringOp::And:
+      values.reserve(std::min(a.size(), b.size()));
+      std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+      break;
+    case detail::RoaringOp::AndNot:
+      values.reserve(a.size());
+      std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+      break;
+    case detail::RoaringOp::Xor:
+      values.reserve(a.size() + b.size());
+      std::set_symmetric_difference(
+          a.begin(), a.end(), b.begin(), b.end(), out);
+      break;
+  }
+  auto c = makeArray(std::move(values));
+  normalize(c);
+  return c;
+}
+
+// Combines an array container with a bitmap one, on either side.
+Container mixedOp(
+    const Container& array,
+    const Container& bitmap,
+    detail::RoaringOp op,
+    bool arrayIsLhs) {
+  auto filter = [&](bool keep) {
+    std::vector<uint16_t> values;
+    for (auto low : array.array) {
+      if (testBit(bitmap.bitmap, low) == keep) {
+        values.push_back(low);
+      }
+    }
+    return makeArray(std::move(values));
+  };
+  if (op == detail::RoaringOp::And) {
+    return filter(true);
+  }
+  if (op == detail::RoaringOp::AndNot && arrayIsLhs) {
+    return filter(false);
+  }
+  auto words = bitmap.bitmap;
+  auto cardinality = bitmap.cardinality;
+  for (auto low : array.array) {
+    auto& word = words[low / 64];
+    auto const bit = uint64_t(1) << (low % 64);
+    bool const set = word & bit;
+    if (op == detail::RoaringOp::Or) {
+      word |= bit;
+      cardinality += !set;
+    } else if (op == detail::RoaringOp::Xor) {
+      word ^= bit;
+      cardinality += set ? -1 : 1;
+    } else {
+      word &= ~bit;
+      cardinality -= set;
+    }
+  }
+  auto c = makeBitmap(std::move(words), cardinality);
+  normalize(c);
+  return c;
+}
+
+// The union of run containers, which stays one.
+Container unionRuns(const Container& a, const Container& b) {
+  std::vector<Run> runs;
+  runs.reserve(a.runs.size() + b.runs.size());
+  auto add = [&](const Run& run) {
+    if (runs.empty() || run.start > runs.back().end() + 1) {
+      runs.push_back(run);
+    } else if (run.end() > runs.back().end()) {
+      runs.back().length = uint16_t(run.end() - runs.back().start);
+    }
+  };
+  auto i = a.runs.begin();
+  auto j = b.runs.begin();
+  while (i != a.runs.end() || j != b.runs.end()) {
+    if (j == b.runs.end() || (i != a.runs.end() && i->start < j->start)) {
+      add(*i++);
+    } else {
+      add(*j++);
+    }
+  }
+  return makeRuns(std::move(runs));
+}
+
+Container combineContainers(
+    const Container& a, const Container& b, detail::RoaringOp op) {
+  if (op == detail::RoaringOp::Or && a.type == Type::Run &&
+      b.type == Type::Run) {
+    return unionRuns(a, b);
+  }
+  if (a.type == Type::Run) {
+    return combineContainers(materialize(a), b, op);
+  }
+  if (b.type == Type::Run) {
+    return combineContainers(a, materialize(b), op);
+  }
+  if (a.type == Type::Array && b.type == Type::Array) {
+    return arrayOp(a.array, b.array, op);
+  }
+  if (a.type == Type::Array) {
+    return mixedOp(a, b, op, true);
+  }
+  if (b.type == Type::Array) {
+    return mixedOp(b, a, op, false);
+  }
+  switch (op) {
+    case detail::RoaringOp::Or:
+      return bitmapOp(a.bitmap, b.bitmap, [](auto x, auto y) { return x | y; });
+    case detail::RoaringOp::And:
+      return bitmapOp(a.bitmap, b.bitmap, [](auto x, auto y) { return x & y; });
+    case detail::RoaringOp::AndNot:
+      return bitmapOp(
+          a.bitmap, b.bitmap, [](auto x, auto y) { return x & ~y; });
+    case detail::RoaringOp::Xor:
+      return bitmapOp(a.bitmap, b.bitmap, [](auto x, auto y) { return x ^ y; });
+  }
+  return {};
+}
+
+uint64_t containerIntersectionSize(const Container& a, const Container& b) {
+  if (a.type == Type::Run) {
+    return containerIntersectionSize(materialize(a), b);
+  }
+  if (b.type == Type::Run) {
+    return containerIntersectionSize(a, materialize(b));
+  }
+  uint64_t count = 0;
+  if (a.type == Type::Bitmap && b.type == Type::Bitmap) {
+    for (uint32_t i = 0; i < kBitmapWords; ++i) {
+      count += popcount(a.bitmap[i] & b.bitmap[i]);
+    }
+  } else if (a.type == Type::Bitmap || b.type == Type::Bitmap) {
+    auto const& array = a.type == Type::Array ? a.array : b.array;
+    auto const& words = a.type == Type::Array ? b.bitmap : a.bitmap;
+    for (auto low : array) {
+      count += testBit(words, low);
+    }
+  } else {
+    auto i = a.array.begin();
+    auto j = b.array.begin();
+    while (i != a.array.end() && j != b.array.end()) {
+      if (*i < *j) {
+        ++i;
+      } else if (*j < *i) {
+        ++j;
+      } else {
+        ++count;
+        ++i;
+        ++j;
+      }
+    }
+  }
+  return count;
+}
+
+bool containerEquals(const Container& a, const Container& b) {
+  if (a.cardinality != b.cardinality) {
+    return false;
+  }
+  if (a.type != b.type) {
+    return toWords(a) == toWords(b);
+  }
+  switch (a.type) {
+    case Type::Array:
+      return a.array == b.array;
+    case Type::Bitmap:
+      return a.bitmap == b.bitmap;
+    case Type::Run:
+      return std::equal(
+          a.runs.begin(),
+          a.runs.end(),
+          b.runs.begin(),
+          b.runs.end(),
+          [](const Run& x, const Run& y) {
+            return x.start == y.start && x.length == y.length;
+          });
+  }
+  return false;
+}
+
+template <typename T>
+void writeValues(io::Appender& out, const std::vector<T>& values) {
+  if constexpr (kIsLittleEndian) {
+    out.push(
+        reinterpret_cast<const uint8_t*>(values.data()),
+        values.size() * sizeof(T));
+  } else {
+    for (auto value : values) {
+      out.writeLE(value);
+    }
+  }
+}
+
+template <typename T>
+void readValues(io::Cursor& cursor, std::vector<T>& values) {
+  if constexpr (kIsLittleEndian) {
+    cursor.pull(values.data(), values.size() * sizeof(T));
+  } else {
+    for (auto& value : values) {
+      value = cursor.readLE<T>();
+    }
+  }
+}
+
+[[noreturn]] void throwInvalid(const char* what) {
+  throw_exception<std::invalid_argument>(what);
+}
+
+} // namespace
+
+RoaringBitmap::RoaringBitmap(std::initializer_list<uint32_t> values) {
+  for (auto value : values) {
+    insert(value);
+  }
+}
+
+bool RoaringBitmap::insert(uint32_t value) {
+  auto const key = uint16_t(value >> 16);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  auto const i = std::size_t(it - keys_.begin());
+  if (it != keys_.end() && *it == key) {
+    return containerInsert(containers_[i], uint16_t(value));
+  }
+  keys_.insert(it, key);
+  containers_.insert(containers_.begin() + i, makeArray({uint16_t(value)}));
+  return true;
+}
+
+void RoaringBitmap::insertMany(Range<const uint32_t*> values) {
+  std::size_t i = 0;
+  for (auto value : values) {
+    auto const key = uint16_t(value >> 16);
+    // Sorted values mostly hit the same container as the previous one.
+    if (i < keys_.size() && keys_[i] == key) {
+      containerInsert(containers_[i], uint16_t(value));
+    } else {
+      insert(value);
+      i = std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+    }
+  }
+}
+
+void RoaringBitmap::insertRange(uint64_t begin, uint64_t end) {
+  if (end > (uint64_t(1) << 32)) {
+    throwInvalid("RoaringBitmap::insertRange: end is out of range");
+  }
+  if (begin >= end) {
+    return;
+  }
+  auto const firstKey = uint32_t(begin >> 16);
+  auto const lastKey = uint32_t((end - 1) >> 16);
+  for (auto key = firstKey; key <= lastKey; ++key) {
+    uint16_t const first = key == firstKey ? uint16_t(begin) : 0;
+    uint16_t const last = key == lastKey ? uint16_t(end - 1) : 0xffff;
+    auto runs = makeRuns({Run{first, uint16_t(last - first)}});
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), uint16_t(key));
+    auto const i = std::size_t(it - keys_.begin());
+    if (it == keys_.end() || *it != key) {
+      keys_.insert(it, uint16_t(key));
+      containers_.insert(containers_.begin() + i, std::move(runs));
+    } else if (runs.cardinality == kContainerValues) {
+      containers_[i] = std::move(runs);
+    } else {
+      containers_[i] =
+          combineContainers(containers_[i], runs, detail::RoaringOp::Or);
+    }
+  }
+}
+
+bool RoaringBitmap::erase(uint32_t value) {
+  auto const key = uint16_t(value >> 16);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key) {
+    return false;
+  }
+  auto const i = std::size_t(it - keys_.begin());
+  if (!containerErase(containers_[i], uint16_t(value))) {
+    return false;
+  }
+  if (containers_[i].cardinality == 0) {
+    keys_.erase(it);
+    containers_.erase(containers_.begin() + i);
+  }
+  return true;
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+  auto const key = uint16_t(value >> 16);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  return it != keys_.end() && *it == key &&
+      containerContains(containers_[it - keys_.begin()], uint16_t(value));
+}
+
+uint64_t RoaringBitmap::size() const noexcept {
+  uint64_t size = 0;
+  for (auto const& c : containers_) {
+    size += c.cardinality;
+  }
+  return size;
+}
+
+void RoaringBitmap::clear() noexcept {
+  keys_.clear();
+  containers_.clear();
+}
+
+uint32_t RoaringBitmap::front() const {
+  assert(!empty());
+  auto const& c = containers_.front();
+  auto const high = uint32_t(keys_.front()) << 16;
+  switch (c.type) {
+    case Type::Array:
+      return high | c.array.front();
+    case Type::Bitmap:
+      return high | nextSetBit(c.bitmap, 0);
+    case Type::Run:
+      return high | c.runs.front().start;
+  }
+  return 0;
+}
+
+uint32_t RoaringBitmap::back() const {
+  assert(!empty());
+  auto const& c = containers_.back();
+  auto const high = uint32_t(keys_.back()) << 16;
+  switch (c.type) {
+    case Type::Array:
+      return high | c.array.back();
+    case Type::Bitmap:
+      for (auto w = kBitmapWords; w-- > 0;) {
+        if (c.bitmap[w] != 0) {
+          return high | (w * 64 + findLastSet(c.bitmap[w]) - 1);
+        }
+      }
+      break;
+    case Type::Run:
+      return high | c.runs.back().end();
+  }
+  return 0;
+}
+
+bool RoaringBitmap::runOptimize() {
+  bool hasRuns = false;
+  for (auto& c : containers_) {
+    auto const runsSize =
+        sizeof(uint16_t) + countRuns(c) * 2 * sizeof(uint16_t);
+    auto const otherSize = c.cardinality <= kMaxArraySize
+        ? c.cardinality * sizeof(uint16_t)
+        : kBitmapWords * sizeof(uint64_t);
+    if (runsSize < otherSize) {
+      if (c.type != Type::Run) {
+        c = makeRuns(toRuns(c));
+      }
+      hasRuns = true;
+    } else if (c.type == Type::Run) {
+      c = materialize(c);
+    }
+  }
+  return hasRuns;
+}
+
+std::size_t RoaringBitmap::getAllocatedMemorySize() const noexcept {
+  auto size = keys_.capacity() * sizeof(uint16_t) +
+      containers_.capacity() * sizeof(Container);
+  for (auto const& c : containers_) {
+    size += c.array.capacity() * sizeof(uint16_t) +
+        c.bitmap.capacity() * sizeof(uint64_t) +
+        c.runs.capacity() * sizeof(Run);
+  }
+  return size;
+}
+
+RoaringBitmap RoaringBitmap::combine(
+    RoaringBitmap&& lhs, const RoaringBitmap& rhs, Op op) {
+  // lhs and rhs may be the same set, whose containers are then only
+  // combined, never moved.
+  bool const keepLhs = op != Op::And;
+  bool const keepRhs = op == Op::Or || op == Op::Xor;
+  RoaringBitmap result;
+  auto const capacity = lhs.keys_.size() + (keepRhs ? rhs.keys_.size() : 0);
+  result.keys_.reserve(capacity);
+  result.containers_.reserve(capacity);
+  auto add = [&](uint16_t key, Container&& c) {
+    result.keys_.push_back(key);
+    result.containers_.push_back(std::move(c));
+  };
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < lhs.keys_.size() && j < rhs.keys_.size()) {
+    auto const a = lhs.keys_[i];
+    auto const b = rhs.keys_[j];
+    if (a < b) {
+      if (keepLhs) {
+        add(a, std::move(lhs.containers_[i]));
+      }
+      ++i;
+    } else if (b < a) {
+      if (keepRhs) {
+        add(b, Container(rhs.containers_[j]));
+      }
+      ++j;
+    } else {
+      auto c = combineContainers(lhs.containers_[i], rhs.containers_[j], op);
+      if (c.cardinality != 0) {
+        add(a, std::move(c));
+      }
+      ++i;
+      ++j;
+    }
+  }
+  for (; keepLhs && i < lhs.keys_.size(); ++i) {
+    add(lhs.keys_[i], std::move(lhs.containers_[i]));
+  }
+  for (; keepRhs && j < rhs.keys_.size(); ++j) {
+    add(rhs.keys_[j], Container(rhs.containers_[j]));
+  }
+  return result;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+  return *this = combine(std::move(*this), other, Op::Or);
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+  return *this = combine(std::move(*this), other, Op::And);
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+  return *this = combine(std::move(*this), other, Op::AndNot);
+}
+
+RoaringBitmap& RoaringBitmap::operator^=(const RoaringBitmap& other) {
+  return *this = combine(std::move(*this), other, Op::Xor);
+}
+
+uint64_t RoaringBitmap::intersectionSize(
+    const RoaringBitmap& a, const RoaringBitmap& b) {
+  uint64_t size = 0;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < a.keys_.size() && j < b.keys_.size()) {
+    if (a.keys_[i] < b.keys_[j]) {
+      ++i;
+    } else if (b.keys_[j] < a.keys_[i]) {
+      ++j;
+    } else {
+      size += containerIntersectionSize(a.containers_[i], b.containers_[j]);
+      ++i;
+      ++j;
+    }
+  }
+  return size;
+}
+
+bool operator==(const RoaringBitmap& a, const RoaringBitmap& b) {
+  return a.keys_ == b.keys_ &&
+      std::equal(
+             a.containers_.begin(),
+             a.containers_.end(),
+             b.containers_.begin(),
+             containerEquals);
+}
+
+RoaringBitmap::const_iterator RoaringBitmap::begin() const {
+  const_iterator it(this, 0);
+  it.seekContainer();
+  return it;
+}
+
+RoaringBitmap::const_iterator RoaringBitmap::end() const {
+  return const_iterator(this, keys_.size());
+}
+
+void RoaringBitmap::const_iterator::seekContainer() {
+  index_ = 0;
+  if (container_ >= set_->keys_.size()) {
+    container_ = set_->keys_.size();
+    value_ = 0;
+    return;
+  }
+  auto const& c = set_->containers_[container_];
+  auto const high = uint32_t(set_->keys_[container_]) << 16;
+  switch (c.type) {
+    case Type::Array:
+      value_ = high | c.array.front();
+      break;
+    case Type::Bitmap:
+      value_ = high | nextSetBit(c.bitmap, 0);
+      break;
+    case Type::Run:
+      value_ = high | c.runs.front().start;
+      break;
+  }
+}
+
+void RoaringBitmap::const_iterator::increment() {
+  auto const& c = set_->containers_[container_];
+  auto const high = value_ & 0xffff0000;
+  auto const low = value_ & 0xffff;
+  switch (c.type) {
+    case Type::Array:
+      if (++index_ < c.array.size()) {
+        value_ = high | c.array[index_];
+        return;
+      }
+      break;
+    case Type::Bitmap:
+      if (auto next = nextSetBit(c.bitmap, low + 1); next < kContainerValues) {
+        value_ = high | next;
+        return;
+      }
+      break;
+    case Type::Run:
+      if (low < c.runs[index_].end()) {
+        ++value_;
+        return;
+      }
+      if (++index_ < c.runs.size()) {
+        value_ = high | c.runs[index_].start;
+        return;
+      }
+      break;
+  }
+  ++container_;
+  seekContainer();
+}
+
+std::size_t RoaringBitmap::serializedSize() const {
+  auto const n = keys_.size();
+  bool const hasRuns = std::any_of(
+      containers_.begin(), containers_.end(), [](const Container& c) {
+        return c.type == Type::Run;
+      });
+  std::size_t size = hasRuns ? sizeof(uint32_t) + (n + 7) / 8 : 8;
+  size += n * 2 * sizeof(uint16_t);
+  if (!hasRuns || n >= kNoOffsetThreshold) {
+    size += n * sizeof(uint32_t);
+  }
+  for (auto const& c : containers_) {
+    size += serializedContainerSize(c);
+  }
+  return size;
+}
+
+std::unique_ptr<IOBuf> RoaringBitmap::serialize() const {
+  auto buf = IOBuf::create(serializedSize());
+  io::Appender out(buf.get(), 0);
+  serialize(out);
+  return buf;
+}
+
+void RoaringBitmap::serialize(io::Appender& out) const {
+  auto const n = keys_.size();
+  bool const hasRuns = std::any_of(
+      containers_.begin(), containers_.end(), [](const Container& c) {
+        return c.type == Type::Run;
+      });
+  std::size_t offset;
+  if (hasRuns) {
+    out.writeLE<uint32_t>(kSerialCookie | (uint32_t(n - 1) << 16));
+    std::vector<uint8_t> isRun((n + 7) / 8);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (containers_[i].type == Type::Run) {
+        isRun[i / 8] |= 1 << (i % 8);
+      }
+    }
+    writeValues(out, isRun);
+    offset = sizeof(uint32_t) + isRun.size() + n * 2 * sizeof(uint16_t);
+  } else {
+    out.writeLE<uint32_t>(kSerialCookieNoRuns);
+    out.writeLE<uint32_t>(uint32_t(n));
+    offset = 8 + n * 2 * sizeof(uint16_t);
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    out.writeLE<uint16_t>(keys_[i]);
+    out.writeLE<uint16_t>(uint16_t(containers_[i].cardinality - 1));
+  }
+  if (!hasRuns || n >= kNoOffsetThreshold) {
+    offset += n * sizeof(uint32_t);
+    for (auto const& c : containers_) {
+      out.writeLE<uint32_t>(uint32_t(offset));
+      offset += serializedContainerSize(c);
+    }
+  }
+  for (auto const& c : containers_) {
+    switch (c.type) {
+      case Type::Array:
+        writeValues(out, c.array);
+        break;
+      case Type::Bitmap:
+        writeValues(out, c.bitmap);
+        break;
+      case Type::Run:
+        out.writeLE<uint16_t>(uint16_t(c.runs.size()));
+        for (auto const& run : c.runs) {
+          out.writeLE<uint16_t>(run.start);
+          out.writeLE<uint16_t>(run.length);
+        }
+        break;
+    }
+  }
+}
+
+RoaringBitmap RoaringBitmap::deserialize(io::Cursor& cursor) {
+  auto const cookie = cursor.readLE<uint32_t>();
+  std::size_t n;
+  std::vector<uint8_t> isRun;
+  if ((cookie & 0xffff) == kSerialCookie) {
+    n = (cookie >> 16) + 1;
+    isRun.resize((n + 7) / 8);
+    readValues(cursor, isRun);
+  } else if (cookie == kSerialCookieNoRuns) {
+    n = cursor.readLE<uint32_t>();
+    if (n > kContainerValues) {
+      throwInvalid("RoaringBitmap: too many containers");
+    }
+  } else {
+    throwInvalid("RoaringBitmap: unknown cookie");
+  }
+
+  RoaringBitmap result;
+  result.keys_.resize(n);
+  result.containers_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    result.keys_[i] = cursor.readLE<uint16_t>();
+    result.containers_[i].cardinality = cursor.readLE<uint16_t>() + 1;
+    if (i > 0 && result.keys_[i] <= result.keys_[i - 1]) {
+      throwInvalid("RoaringBitmap: keys are not increasing");
+    }
+  }
+  if (isRun.empty() || n >= kNoOffsetThreshold) {
+    cursor.skip(n * sizeof(uint32_t));
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    auto& c = result.containers_[i];
+    auto const cardinality = c.cardinality;
+    if (!isRun.empty() && (isRun[i / 8] >> (i % 8)) & 1) {
+      c.type = Type::Run;
+      c.cardinality = 0;
+      auto const count = cursor.readLE<uint16_t>();
+      c.runs.reserve(count);
+      for (uint16_t j = 0; j < count; ++j) {
+        Run run;
+        run.start = cursor.readLE<uint16_t>();
+        run.length = cursor.readLE<uint16_t>();
+        if (run.end() >= kContainerValues) {
+          throwInvalid("RoaringBitmap: run is out of range");
+        }
+        c.cardinality += run.length + 1;
+        if (c.runs.empty() || run.start > c.runs.back().end() + 1) {
+          c.runs.push_back(run);
+        } else if (run.start == c.runs.back().end() + 1) {
+          // Touching runs are valid, but ours don't.
+          c.runs.back().length += run.length + 1;
+        } else {
+          throwInvalid("RoaringBitmap: runs are not increasing");
+        }
+      }
+    } else if (cardinality > kMaxArraySize) {
+      c.type = Type::Bitmap;
+      c.bitmap.resize(kBitmapWords);
+      readValues(cursor, c.bitmap);
+      c.cardinality = countBits(c.bitmap);
+    } else {
+      c.type = Type::Array;
+      c.array.resize(cardinality);
+      readValues(cursor, c.array);
+      if (std::adjacent_find(
+              c.array.begin(), c.array.end(), std::greater_equal<>()) !=
+          c.array.end()) {
+        throwInvalid("RoaringBitmap: array is not increasing");
+      }
+    }
+    if (c.cardinality != cardinality) {
+      throwInvalid("RoaringBitmap: wrong cardinality");
+    }
+  }
+  return result;
+}
+
+RoaringBitmap RoaringBitmap::deserialize(ByteRange bytes) {
+  IOBuf buf(IOBuf::WRAP_BUFFER, bytes);
+  io::Cursor cursor(&buf);
+  return deserialize(cursor);
+}
+
+} // namespace folly
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+namespace detail {
+
+// The values start, ..., start + length.
+struct RoaringRun {
+  uint16_t start;
+  uint16_t length;
+
+  uint32_t end() const noexcept { return uint32_t(start) + length; }
+};
+
+// The low 16 bits of the values of a RoaringBitmap that share their high 16
+// bits. Only the vector of the container's type is used.
+struct RoaringContainer {
+  enum class Type : uint8_t { Array, Bitmap, Run };
+
+  static constexpr uint32_t kMaxArraySize = 4096;
+  static constexpr uint32_t kBitmapWords = 1024;
+
+  Type type = Type::Array;
+  // Never 0, as empty containers are removed.
+  uint32_t cardinality = 0;
+  // Sorted values, at most kMaxArraySize.
+  std::vector<uint16_t> array;
+  // kBitmapWords words, for more than kMaxArraySize values.
+  std::vector<uint64_t> bitmap;
+  // Sorted runs, which neither overlap nor touch.
+  std::vector<RoaringRun> runs;
+};
+
+enum class RoaringOp { Or, And, AndNot, Xor };
+
+} // namespace detail
+
+/**
+ * A compressed set of 32-bit integers, in the format of Roaring bitmaps
+ * (https://roaringbitmap.org): the values are split by their high 16 bits
+ * into containers, which store their low 16 bits as
+ *
+ *  - a sorted array, for at most 4096 values;
+ *  - a 2^16-bit bitmap, for more values;
+ *  - a list of runs of consecutive values, when that is smaller, after
+ *    runOptimize() or insertRange().
+ *
+ * So sparse sets take 2 bytes per value, dense ones 1 bit per value, and
+ * runs 4 bytes per run, while lookups and set operations stay fast: the
+ * bitmaps are combined 64 bits at a time by loops that the compiler
+ * vectorizes, and sorted arrays are merged.
+ *
+ * serialize() writes the portable format of the Roaring specification
+ * (https://github.com/RoaringBitmap/RoaringFormatSpec), which the Roaring
+ * implementations in other languages read and write as well.
+ *
+ * Not thread-safe.
+ */
+class RoaringBitmap {
+ public:
+  using value_type = uint32_t;
+  using size_type = uint64_t;
+  class const_iterator;
+  using iterator = const_iterator;
+
+  RoaringBitmap() = default;
+  RoaringBitmap(std::initializer_list<uint32_t> values);
+
+  /// Returns false if value was already in the set.
+  bool insert(uint32_t value);
+  /// Inserts values, which are best sorted.
+  void insertMany(Range<const uint32_t*> values);
+  /// Inserts the values in [begin, end), as runs.
+  void insertRange(uint64_t begin, uint64_t end);
+
+  /// Returns false if value wasn't in the set.
+  bool erase(uint32_t value);
+
+  bool contains(uint32_t value) const;
+
+  /// The number of values, in O(number of containers).
+  uint64_t size() const noexcept;
+  bool empty() const noexcept { return keys_.empty(); }
+  void clear() noexcept;
+
+  /// The smallest and largest values, which must exist.
+  uint32_t front() const;
+  uint32_t back() const;
+
+  /// Converts the containers to runs where that is smaller. Returns whether
+  /// any container is now made of runs.
+  bool runOptimize();
+
+  /// The memory allocated by the set.
+  std::size_t getAllocatedMemorySize() const noexcept;
+
+  RoaringBitmap& operator|=(const RoaringBitmap& other);
+  RoaringBitmap& operator&=(const RoaringBitmap& other);
+  /// Removes the values of other.
+  RoaringBitmap& operator-=(const RoaringBitmap& other);
+  RoaringBitmap& operator^=(const RoaringBitmap& other);
+
+  friend RoaringBitmap operator|(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs |= rhs;
+  }
+  friend RoaringBitmap operator&(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs &= rhs;
+  }
+  friend RoaringBitmap operator-(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs -= rhs;
+  }
+  friend RoaringBitmap operator^(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs ^= rhs;
+  }
+
+  /// The size of a & b, without computing it.
+  static uint64_t intersectionSize(
+      const RoaringBitmap& a, const RoaringBitmap& b);
+
+  friend bool operator==(const RoaringBitmap& a, const RoaringBitmap& b);
+  friend bool operator!=(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return !(a == b);
+  }
+
+  /// Iterates over the values in increasing order.
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /// Calls f(value) for each value in increasing order, which is faster
+  /// than iterating.
+  template <typename F>
+  void forEach(F&& f) const;
+
+  /// The size of the serialization of the set.
+  std::size_t serializedSize() const;
+  /// Serializes the set in the portable Roaring format.
+  std::unique_ptr<IOBuf> serialize() const;
+  /// Appends the serialization to out.
+  void serialize(io::Appender& out) const;
+
+  /// Reads a set in the portable Roaring format.
+  ///
+  /// @throws std::invalid_argument if the serialization is invalid, and
+  ///     std::out_of_range if it is truncated.
+  static RoaringBitmap deserialize(io::Cursor& cursor);
+  static RoaringBitmap deserialize(ByteRange bytes);
+
+ private:
+  using Container = detail::RoaringContainer;
+
+  using Op = detail::RoaringOp;
+
+  static RoaringBitmap combine(
+      RoaringBitmap&& lhs, const RoaringBitmap& rhs, Op op);
+
+  // The high 16 bits of the values of each container, sorted.
+  std::vector<uint16_t> keys_;
+  std::vector<Container> containers_;
+};
+
+class RoaringBitmap::const_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = uint32_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = uint32_t;
+  using pointer = void;
+
+  const_iterator() = default;
+
+  uint32_t operator*() const noexcept { return value_; }
+
+  const_iterator& operator++() {
+    increment();
+    return *this;
+  }
+  const_iterator operator++(int) {
+    auto copy = *this;
+    increment();
+    return copy;
+  }
+
+  friend bool operator==(const_iterator a, const_iterator b) noexcept {
+    return a.container_ == b.container_ && a.value_ == b.value_;
+  }
+  friend bool operator!=(const_iterator a, const_iterator b) noexcept {
+    return !(a == b);
+  }
+
+ private:
+  friend class RoaringBitmap;
+
+  const_iterator(const RoaringBitmap* set, std::size_t container) noexcept
+      : set_(set), container_(container) {}
+
+  // Points to the first value of container_, or to the end.
+  void seekContainer();
+  void increment();
+
+  const RoaringBitmap* set_ = nullptr;
+  std::size_t container_ = 0;
+  // The index of the value in the array, or of the run.
+  uint32_t index_ = 0;
+  uint32_t value_ = 0;
+};
+
+template <typename F>
+void RoaringBitmap::forEach(F&& f) const {
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    auto const high = uint32_t(keys_[i]) << 16;
+    auto const& c = containers_[i];
+    switch (c.type) {
+      case Container::Type::Array:
+        for (auto low : c.array) {
+          f(high | low);
+        }
+        break;
+      case Container::Type::Bitmap:
+        for (uint32_t w = 0; w < Container::kBitmapWords; ++w) {
+          for (auto word = c.bitmap[w]; word != 0; word &= word - 1) {
+            f(high | (w * 64 + findFirstSet(word) - 1));
+          }
+        }
+        break;
+      case Container::Type::Run:
+        for (auto const& run : c.runs) {
+          for (uint32_t low = run.start; low <= run.end(); ++low) {
+            f(high | low);
+          }
+        }
+        break;
+    }
+  }
+}
+
+} // namespace folly
@@ -606,6 +606,22 @@ class F14BasicMap : public std::unordered_map<K, M, H, E, A> {
     return find(key);
   }
 
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
   bool contains(F14HashToken const&, key_type const& key) const {
     return contains(key);
   }
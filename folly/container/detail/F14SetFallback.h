@@ -439,6 +439,14 @@ class F14BasicSet
     return find(key);
   }
 
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt findMany(ForwardIt first, ForwardIt last, OutputIt out) const {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
   bool contains(F14HashToken const&, key_type const& key) const {
     return find(key) != this->end();
   }
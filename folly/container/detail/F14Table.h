@@ -1779,6 +1779,28 @@ class F14Table : public Policy {
     return findImpl(static_cast<HashPair>(token), key, Prefetch::DISABLED);
   }
 
+  // Looks up every key in [first, last), calling func(ItemIter) with the
+  // results in order. This is prehash()/prefetch()/find() pipelining applied
+  // to a block of keys at a time: all keys of a block are hashed and their
+  // first chunks prefetched before any of them is probed, so that the cache
+  // misses of independent lookups overlap instead of serializing.
+  template <typename ForwardIt, typename F>
+  void findMany(ForwardIt first, ForwardIt last, F&& func) const {
+    constexpr std::size_t kBlockSize = 16;
+    HashPair hps[kBlockSize];
+    while (first != last) {
+      auto blockFirst = first;
+      std::size_t n = 0;
+      for (; n < kBlockSize && first != last; ++n, ++first) {
+        hps[n] = computeHash(*first);
+        prefetchAddr(chunks_ + moduloByChunkCount(hps[n].first));
+      }
+      for (std::size_t i = 0; i < n; ++i, ++blockFirst) {
+        func(findImpl(hps[i], *blockFirst, Prefetch::DISABLED));
+      }
+    }
+  }
+
   // Searches for a key using a key predicate that is a refinement
   // of key equality.  func(k) should return true only if k is equal
   // to key according to key_eq(), but is allowed to apply additional
@@ -45,7 +45,7 @@
  *              index    0   1   2   3   4   5   6   7   8   9
  *       vector[index]  60, 30, 80, 10, 50, 70, 90,  0, 20, 40
  * Lookup elements in sorted vector containers relies on binary search,
- * std::lower_bound. While in heap containers, lookup operation has two
+ * std::lower_bound. While in heap containers, lookup operation has three
  * benefits:
  *
  * 1. Cache locality, the container is traversed sequentially instead of binary
@@ -54,6 +54,9 @@
  * penalty while using heap lookup search the branch can be avoided by using
  * cmov instruction. We observerd look up operations are up to 2X faster than
  * sorted_vector_map.
+ * 3. The nodes a search may visit a few levels down are contiguous, so they
+ * are prefetched while the levels above are compared. Lookups in containers
+ * larger than the cache then overlap their cache misses.
  *
  * However, Insertion/deletion operations are much slower. If insertions and
  * deletions are rare operations for your use case then heap containers might
@@ -100,6 +103,7 @@
 #include <folly/Utility.h>
 #include <folly/container/Iterator.h>
 #include <folly/functional/Invoke.h>
+#include <folly/lang/Align.h>
 #include <folly/lang/Exception.h>
 #include <folly/memory/MemoryResource.h>
 #include <folly/portability/Builtins.h>
@@ -466,11 +470,43 @@ size_type erase(size_type offset, Container& cont) {
   return offset;
 }
 
+// Prefetches the descendants of offset a few levels down, so that they are in
+// cache by the time the search gets there. The 2^levels descendants are
+// contiguous, from offset (offset + 1) * 2^levels - 1 on, and levels is picked
+// so that they span at most two cache lines. These are not aligned, so fetch
+// both ends.
+template <typename Container, typename size_type>
+FOLLY_ALWAYS_INLINE void prefetchDescendants(
+    Container& cont, size_type offset, size_type size) {
+#if FOLLY_HAS_BUILTIN(__builtin_prefetch)
+  constexpr std::size_t kSize = sizeof(typename Container::value_type);
+  constexpr std::size_t kLines = 2 * hardware_constructive_interference_size;
+  constexpr std::size_t kLevels = kSize * 16 <= kLines ? 4
+      : kSize * 8 <= kLines                             ? 3
+      : kSize * 4 <= kLines                             ? 2
+                                                        : 1;
+  std::size_t first = ((std::size_t(offset) + 1) << kLevels) - 1;
+  std::size_t last = first + (std::size_t(1) << kLevels) - 1;
+  if (last < size) {
+    __builtin_prefetch(&cont[first]);
+    __builtin_prefetch(&cont[last]);
+  } else if (first < size) {
+    __builtin_prefetch(&cont[first]);
+  }
+#else
+  (void)cont;
+  (void)offset;
+  (void)size;
+#endif
+}
+
 // Search lower bound in a container sorted in heap order.
 // To speed up lower_bound for small containers, peel four iterations and use
 // reverse compare to exit quickly.
-// The branch inside the loop is converted to a cmov by the compiler. cmov are
-// more efficient when the branch is unpredictable.
+// The loop below is branchless, as the comparisons are unpredictable, and
+// prefetches the levels it will visit next. Either alone is slower for large
+// containers: the mispredicted branches at least fetch half of the next nodes
+// speculatively.
 template <typename Compare, typename RCompare, typename Container>
 typename Container::size_type lower_bound(
     Container& cont, Compare cmp, RCompare reverseCmp) {
@@ -518,13 +554,11 @@ typename Container::size_type lower_bound(
             last = offset;
             offset = 2 * offset + 1;
           }
-          for (; offset < size; offset++) {
-            if (cmp(cont[offset])) {
-              offset = 2 * offset + 1;
-            } else {
-              last = offset;
-              offset = 2 * offset;
-            }
+          while (offset < size) {
+            prefetchDescendants(cont, offset, size);
+            bool less = cmp(cont[offset]);
+            last = less ? last : offset;
+            offset = 2 * offset + 1 + size_type(less);
           }
         }
       }
@@ -538,13 +572,12 @@ typename Container::size_type upper_bound(Container& cont, Compare cmp) {
   using size_type = typename Container::size_type;
   auto size = cont.size();
   auto last = size;
-  for (size_type offset = 0; offset < size; offset++) {
-    if (!cmp(cont[offset])) {
-      offset = 2 * offset + 1;
-    } else {
-      last = offset;
-      offset = 2 * offset;
-    }
+  size_type offset = 0;
+  while (offset < size) {
+    prefetchDescendants(cont, offset, size);
+    bool greater = cmp(cont[offset]);
+    last = greater ? offset : last;
+    offset = 2 * offset + 2 - size_type(greater);
   }
   return last;
 }
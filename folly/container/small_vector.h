@@ -39,6 +39,7 @@
 #include <folly/Portability.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Traits.h>
+#include <folly/container/Access.h>
 #include <folly/functional/Invoke.h>
 #include <folly/hash/Hash.h>
 #include <folly/lang/Align.h>
@@ -335,10 +336,12 @@ struct IntegralSizePolicy<SizeType, true, AlwaysUseHeap>
  public:
   /*
    * Move a range to a range of uninitialized memory.  Assumes the
-   * ranges don't overlap.
+   * ranges don't overlap.  Relocatable types are relocated with a
+   * memcpy instead, so the caller must only destroy the source range
+   * if !IsRelocatable<T>.
    */
   template <class T>
-  typename std::enable_if<!std::is_trivially_copyable_v<T>>::type
+  typename std::enable_if<!IsRelocatable<T>::value>::type
   moveToUninitialized(T* first, T* last, T* out) {
     std::size_t idx = 0;
     {
@@ -357,11 +360,12 @@ struct IntegralSizePolicy<SizeType, true, AlwaysUseHeap>
     }
   }
 
-  // Specialization for trivially copyable types.
+  // Specialization for relocatable types, which include the trivially
+  // copyable ones.
   template <class T>
-  typename std::enable_if<std::is_trivially_copyable_v<T>>::type
+  typename std::enable_if<IsRelocatable<T>::value>::type
   moveToUninitialized(T* first, T* last, T* out) {
-    std::memmove(
+    std::memcpy(
         static_cast<void*>(out),
         static_cast<void const*>(first),
         (last - first) * sizeof *first);
@@ -895,6 +899,37 @@ class small_vector
 
   void push_back(value_type const& t) { emplace_back(t); }
 
+  /*
+   * Appends the elements of range, like C++23's std::vector::append_range.
+   * When the size of the range can be computed up front, the storage grows
+   * at most once, and if constructing an element throws the elements of
+   * the vector are left unchanged. range must not refer to the elements of
+   * the vector.
+   */
+  template <class Range>
+  void append_range(Range&& range) {
+    auto first = access::begin(range);
+    auto last = access::end(range);
+    using It = decltype(first);
+    using categ = typename std::iterator_traits<It>::iterator_category;
+    if constexpr (
+        std::is_same<It, decltype(last)>::value &&
+        std::is_base_of<std::forward_iterator_tag, categ>::value) {
+      auto const n = size_type(std::distance(first, last));
+      auto const currentSize = size();
+      makeSize(currentSize + n);
+      detail::populateMemForward(data() + currentSize, n, [&](void* p) {
+        new (p) value_type(*first);
+        ++first;
+      });
+      this->incrementSize(n);
+    } else {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    }
+  }
+
   void pop_back() {
     // ideally this would be implemented in terms of erase(end() - 1) to reuse
     // the higher-level abstraction, but neither Clang or GCC are able to
@@ -1299,7 +1334,9 @@ class small_vector
       rollback.dismiss();
     }
     annotate_object_leaked(newh);
-    std::destroy(begin(), end());
+    if constexpr (!IsRelocatable<value_type>::value) {
+      std::destroy(begin(), end());
+    }
     freeHeap();
     // Store shifted pointer if capacity is heapified
     u.pdata_.heap_ = newp;
@@ -1493,6 +1530,11 @@ struct is_small_vector<small_vector<Value, N, Policy>> : std::true_type {};
 template <typename T>
 inline constexpr bool is_small_vector_v = is_small_vector<T>::value;
 
+// Neither the inline storage nor the heap pointer depend on the address of the
+// small_vector.
+template <class T, size_t M, class P>
+struct IsRelocatable<small_vector<T, M, P>> : IsRelocatable<T> {};
+
 } // namespace folly
 
 FOLLY_POP_WARNING
@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <folly/Portability.h>
+#include <folly/ScopeGuard.h>
+#include <folly/Traits.h>
+#include <folly/container/span.h>
+#include <folly/lang/Exception.h>
+#include <folly/lang/New.h>
+
+namespace folly {
+
+/* # soa_vector
+ *
+ * A vector of records stored as a structure of arrays: each field of the
+ * records is stored in its own array, so that loops over a few fields of
+ * many records access memory with a unit stride, and can be vectorized.
+ *
+ *   soa_vector<float, float, uint32_t> points; // x, y, id
+ *   points.emplace_back(1.f, 2.f, 42);
+ *   for (auto& x : points.field<0>()) {
+ *     x *= 2;
+ *   }
+ *
+ * The fields are accessed as spans with field<I>(), which works with the
+ * algorithms that take ranges, like the ones in folly/algorithm/simd. All the
+ * arrays live in a single allocation, and each one is aligned to kAlignment
+ * bytes, so a kernel can use aligned vector loads.
+ *
+ * Records are accessed through proxy references, which are tuples of
+ * references to the fields, like std::vector<bool> does with bits:
+ *
+ *   auto [x, y, id] = points[0]; // references
+ *   points[1] = std::make_tuple(3.f, 4.f, 43);
+ *
+ * So the iterators aren't true random access iterators, and the algorithms
+ * that swap elements, like std::sort, don't work on them.
+ *
+ * Bulk appends take one span per field, and grow the storage at most once:
+ *
+ *   points.append(xs, ys, ids);
+ *
+ * The fields must be nothrow move constructible. On growth, relocatable
+ * fields (per folly::IsRelocatable) are moved with a memcpy per array.
+ */
+template <typename... Ts>
+class soa_vector {
+  static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one field");
+  static_assert(
+      (std::is_nothrow_move_constructible_v<Ts> && ...),
+      "soa_vector fields must be nothrow move constructible");
+  static_assert(
+      ((std::is_object_v<Ts> && !std::is_const_v<Ts>) && ...),
+      "soa_vector fields must be non-const objects");
+
+  template <bool Const>
+  class iterator_base;
+
+ public:
+  using value_type = std::tuple<Ts...>;
+  using reference = std::tuple<Ts&...>;
+  using const_reference = std::tuple<Ts const&...>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using iterator = iterator_base<false>;
+  using const_iterator = iterator_base<true>;
+
+  template <std::size_t I>
+  using field_type = std::tuple_element_t<I, value_type>;
+
+  static constexpr std::size_t kFields = sizeof...(Ts);
+
+  /// The alignment of each array: a cache line, which is also the size of
+  /// the widest vector registers.
+  static constexpr std::size_t kAlignment =
+      std::max({std::size_t(64), alignof(Ts)...});
+
+  soa_vector() noexcept = default;
+
+  /// n value-initialized records.
+  explicit soa_vector(size_type n) : soa_vector() { resize(n); }
+
+  soa_vector(std::initializer_list<value_type> records) : soa_vector() {
+    reserve(records.size());
+    for (auto const& record : records) {
+      push_back(record);
+    }
+  }
+
+  // Delegating to the default constructor makes the destructor free the
+  // storage if a copy throws.
+  soa_vector(soa_vector const& other) : soa_vector() {
+    reserve(other.size_);
+    copyBack(ConstData(other.data_), other.size_);
+  }
+
+  soa_vector(soa_vector&& other) noexcept
+      : data_(std::exchange(other.data_, {})),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)) {}
+
+  soa_vector& operator=(soa_vector const& other) {
+    if (this != &other) {
+      soa_vector(other).swap(*this);
+    }
+    return *this;
+  }
+
+  soa_vector& operator=(soa_vector&& other) noexcept {
+    soa_vector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~soa_vector() {
+    clear();
+    deallocate(data_, capacity_);
+  }
+
+  void swap(soa_vector& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+  friend void swap(soa_vector& a, soa_vector& b) noexcept { a.swap(b); }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_type capacity() const noexcept { return capacity_; }
+
+  static constexpr size_type max_size() noexcept {
+    return (std::numeric_limits<difference_type>::max() -
+            kFields * kAlignment) /
+        (sizeof(Ts) + ...);
+  }
+
+  void reserve(size_type n) {
+    if (n > capacity_) {
+      reallocate(n);
+    }
+  }
+
+  void shrink_to_fit() {
+    if (size_ == 0) {
+      deallocate(std::exchange(data_, {}), std::exchange(capacity_, 0));
+    } else if (size_ < capacity_) {
+      reallocate(size_);
+    }
+  }
+
+  void clear() noexcept {
+    forEachField([&](auto i) {
+      std::destroy_n(std::get<i>(data_), size_);
+    });
+    size_ = 0;
+  }
+
+  /// Grows with value-initialized records, or shrinks.
+  void resize(size_type n) {
+    if (n <= size_) {
+      forEachField([&](auto i) {
+        std::destroy(std::get<i>(data_) + n, std::get<i>(data_) + size_);
+      });
+      size_ = n;
+      return;
+    }
+    grow(n);
+    std::size_t done = 0;
+    auto rollback = makeGuard([&] { destroyNewFields(done, n); });
+    forEachField([&](auto i) {
+      std::uninitialized_value_construct(
+          std::get<i>(data_) + size_, std::get<i>(data_) + n);
+      ++done;
+    });
+    rollback.dismiss();
+    size_ = n;
+  }
+
+  /// Appends a record, constructing each field from one argument. The
+  /// arguments may refer to the records of the vector.
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    static_assert(
+        sizeof...(Args) == kFields, "emplace_back takes one arg per field");
+    if (size_ == capacity_) {
+      // Construct the new record before moving the others, which the
+      // arguments may refer to.
+      auto const newCapacity = nextCapacity(size_ + 1);
+      auto const newData = allocate(newCapacity);
+      auto rollback = makeGuard([&] { deallocate(newData, newCapacity); });
+      constructAt(newData, size_, std::forward<Args>(args)...);
+      rollback.dismiss();
+      relocate(newData, newCapacity);
+    } else {
+      constructAt(data_, size_, std::forward<Args>(args)...);
+    }
+    return (*this)[size_++];
+  }
+
+  void push_back(value_type const& record) {
+    std::apply(
+        [&](auto const&... fields) { emplace_back(fields...); }, record);
+  }
+  void push_back(value_type&& record) {
+    std::apply(
+        [&](auto&&... fields) { emplace_back(std::move(fields)...); },
+        record);
+  }
+
+  /// Appends columns.size() records, copying the fields of the records from
+  /// one span per field, which must all have the same size and must not
+  /// refer to the records of the vector. Grows the storage at most once.
+  ///
+  /// @throws std::invalid_argument if the spans have different sizes.
+  void append(span<Ts const>... columns) {
+    auto const n = std::get<0>(std::forward_as_tuple(columns...)).size();
+    if (((columns.size() != n) || ...)) {
+      throw_exception<std::invalid_argument>(
+          "soa_vector::append: columns of different sizes");
+    }
+    grow(size_ + n);
+    copyBack(ConstData(columns.data()...), n);
+  }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    --size_;
+    forEachField([&](auto i) { std::destroy_at(std::get<i>(data_) + size_); });
+  }
+
+  reference operator[](size_type i) noexcept {
+    assert(i < size_);
+    return std::apply(
+        [&](auto*... fields) { return reference(fields[i]...); }, data_);
+  }
+  const_reference operator[](size_type i) const noexcept {
+    assert(i < size_);
+    return std::apply(
+        [&](auto*... fields) { return const_reference(fields[i]...); },
+        data_);
+  }
+
+  reference at(size_type i) {
+    checkIndex(i);
+    return (*this)[i];
+  }
+  const_reference at(size_type i) const {
+    checkIndex(i);
+    return (*this)[i];
+  }
+
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[size_ - 1]; }
+  const_reference back() const noexcept { return (*this)[size_ - 1]; }
+
+  /// The array of the I-th field of the records.
+  template <std::size_t I>
+  span<field_type<I>> field() noexcept {
+    return {std::get<I>(data_), size_};
+  }
+  template <std::size_t I>
+  span<field_type<I> const> field() const noexcept {
+    return {std::get<I>(data_), size_};
+  }
+
+  /// The array of the I-th field of the records, aligned to kAlignment.
+  /// Null if the capacity is zero.
+  template <std::size_t I>
+  field_type<I>* data() noexcept {
+    return std::get<I>(data_);
+  }
+  template <std::size_t I>
+  field_type<I> const* data() const noexcept {
+    return std::get<I>(data_);
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size_}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size_}; }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  friend bool operator==(soa_vector const& a, soa_vector const& b) {
+    if (a.size_ != b.size_) {
+      return false;
+    }
+    bool equal = true;
+    forEachField([&](auto i) {
+      equal = equal &&
+          std::equal(
+                  std::get<i>(a.data_),
+                  std::get<i>(a.data_) + a.size_,
+                  std::get<i>(b.data_));
+    });
+    return equal;
+  }
+  friend bool operator!=(soa_vector const& a, soa_vector const& b) {
+    return !(a == b);
+  }
+
+ private:
+  using Data = std::tuple<Ts*...>;
+  using ConstData = std::tuple<Ts const*...>;
+
+  template <typename F>
+  static void forEachField(F&& f) {
+    forEachFieldImpl(f, std::index_sequence_for<Ts...>{});
+  }
+  template <typename F, std::size_t... I>
+  static void forEachFieldImpl(F& f, std::index_sequence<I...>) {
+    (f(index_constant<I>{}), ...);
+  }
+
+  static constexpr std::size_t alignUp(std::size_t n) noexcept {
+    return (n + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  static std::size_t allocationSize(size_type capacity) noexcept {
+    return (alignUp(capacity * sizeof(Ts)) + ...);
+  }
+
+  static Data allocate(size_type capacity) {
+    auto p = static_cast<char*>(operator_new(
+        allocationSize(capacity), std::align_val_t{kAlignment}));
+    Data data;
+    forEachField([&](auto i) {
+      std::get<i>(data) = reinterpret_cast<field_type<i>*>(p);
+      p += alignUp(capacity * sizeof(field_type<i>));
+    });
+    return data;
+  }
+
+  static void deallocate(Data data, size_type capacity) noexcept {
+    if (capacity != 0) {
+      operator_delete(
+          std::get<0>(data),
+          allocationSize(capacity),
+          std::align_val_t{kAlignment});
+    }
+  }
+
+  size_type nextCapacity(size_type n) const {
+    if (n > max_size()) {
+      throw_exception<std::length_error>("soa_vector: max_size exceeded");
+    }
+    auto const doubled = capacity_ <= max_size() / 2 ? 2 * capacity_ : n;
+    return std::max({n, doubled, size_type(8)});
+  }
+
+  // Makes room for n records, growing geometrically.
+  void grow(size_type n) {
+    if (n > capacity_) {
+      reallocate(nextCapacity(n));
+    }
+  }
+
+  void reallocate(size_type capacity) {
+    if (capacity > max_size()) {
+      throw_exception<std::length_error>("soa_vector: max_size exceeded");
+    }
+    relocate(allocate(capacity), capacity);
+  }
+
+  // Moves the records to newData, and frees the old arrays.
+  void relocate(Data newData, size_type newCapacity) noexcept {
+    forEachField([&](auto i) {
+      using T = field_type<i>;
+      auto const from = std::get<i>(data_);
+      auto const to = std::get<i>(newData);
+      if constexpr (IsRelocatable<T>::value) {
+        if (size_ != 0) {
+          std::memcpy(
+              static_cast<void*>(to),
+              static_cast<void const*>(from),
+              size_ * sizeof(T));
+        }
+      } else {
+        std::uninitialized_move_n(from, size_, to);
+        std::destroy_n(from, size_);
+      }
+    });
+    deallocate(std::exchange(data_, newData), capacity_);
+    capacity_ = newCapacity;
+  }
+
+  template <typename... Args>
+  static void constructAt(Data const& data, size_type pos, Args&&... args) {
+    constructAtImpl(
+        data,
+        pos,
+        std::index_sequence_for<Ts...>{},
+        std::forward<Args>(args)...);
+  }
+  template <std::size_t... I, typename... Args>
+  static void constructAtImpl(
+      Data const& data,
+      size_type pos,
+      std::index_sequence<I...>,
+      Args&&... args) {
+    std::size_t done = 0;
+    auto rollback = makeGuard([&] {
+      ((I < done ? std::destroy_at(std::get<I>(data) + pos) : void()), ...);
+    });
+    ((::new (static_cast<void*>(std::get<I>(data) + pos))
+          field_type<I>(std::forward<Args>(args)),
+      ++done),
+     ...);
+    rollback.dismiss();
+  }
+
+  // Copies n records from the arrays of from to the back, which must have
+  // room for them.
+  void copyBack(ConstData const& from, size_type n) {
+    std::size_t done = 0;
+    auto rollback = makeGuard([&] { destroyNewFields(done, size_ + n); });
+    forEachField([&](auto i) {
+      std::uninitialized_copy_n(
+          std::get<i>(from), n, std::get<i>(data_) + size_);
+      ++done;
+    });
+    rollback.dismiss();
+    size_ += n;
+  }
+
+  // Destroys the records in [size_, end) of the first `done` fields.
+  void destroyNewFields(std::size_t done, size_type end) noexcept {
+    forEachField([&](auto i) {
+      if (i < done) {
+        std::destroy(std::get<i>(data_) + size_, std::get<i>(data_) + end);
+      }
+    });
+  }
+
+  void checkIndex(size_type i) const {
+    if (i >= size_) {
+      throw_exception<std::out_of_range>("soa_vector: index out of range");
+    }
+  }
+
+  Data data_{};
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+};
+
+template <typename... Ts>
+template <bool Const>
+class soa_vector<Ts...>::iterator_base {
+  using Vector = conditional_t<Const, soa_vector const, soa_vector>;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = soa_vector::value_type;
+  using difference_type = std::ptrdiff_t;
+  using reference =
+      conditional_t<Const, soa_vector::const_reference, soa_vector::reference>;
+  using pointer = void;
+
+  iterator_base() = default;
+
+  template <bool C = Const, typename = std::enable_if_t<C>>
+  /* implicit */ iterator_base(iterator_base<false> other) noexcept
+      : vector_(other.vector_), index_(other.index_) {}
+
+  reference operator*() const noexcept { return (*vector_)[index_]; }
+  reference operator[](difference_type n) const noexcept {
+    return (*vector_)[index_ + n];
+  }
+
+  iterator_base& operator++() noexcept {
+    ++index_;
+    return *this;
+  }
+  iterator_base operator++(int) noexcept {
+    auto copy = *this;
+    ++index_;
+    return copy;
+  }
+  iterator_base& operator--() noexcept {
+    --index_;
+    return *this;
+  }
+  iterator_base operator--(int) noexcept {
+    auto copy = *this;
+    --index_;
+    return copy;
+  }
+  iterator_base& operator+=(difference_type n) noexcept {
+    index_ += n;
+    return *this;
+  }
+  iterator_base& operator-=(difference_type n) noexcept {
+    index_ -= n;
+    return *this;
+  }
+
+  friend iterator_base operator+(
+      iterator_base it, difference_type n) noexcept {
+    return it += n;
+  }
+  friend iterator_base operator+(
+      difference_type n, iterator_base it) noexcept {
+    return it += n;
+  }
+  friend iterator_base operator-(
+      iterator_base it, difference_type n) noexcept {
+    return it -= n;
+  }
+  friend difference_type operator-(iterator_base a, iterator_base b) noexcept {
+    return difference_type(a.index_) - difference_type(b.index_);
+  }
+
+  friend bool operator==(iterator_base a, iterator_base b) noexcept {
+    return a.index_ == b.index_;
+  }
+  friend bool operator!=(iterator_base a, iterator_base b) noexcept {
+    return a.index_ != b.index_;
+  }
+  friend bool operator<(iterator_base a, iterator_base b) noexcept {
+    return a.index_ < b.index_;
+  }
+  friend bool operator>(iterator_base a, iterator_base b) noexcept {
+    return a.index_ > b.index_;
+  }
+  friend bool operator<=(iterator_base a, iterator_base b) noexcept {
+    return a.index_ <= b.index_;
+  }
+  friend bool operator>=(iterator_base a, iterator_base b) noexcept {
+    return a.index_ >= b.index_;
+  }
+
+ private:
+  friend class soa_vector;
+  friend class iterator_base<true>;
+
+  iterator_base(Vector* vector, size_type index) noexcept
+      : vector_(vector), index_(index) {}
+
+  Vector* vector_ = nullptr;
+  size_type index_ = 0;
+};
+
+} // namespace folly
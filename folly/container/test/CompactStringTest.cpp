@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/CompactString.h>
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include <folly/container/F14Map.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+static_assert(std::is_trivially_copyable_v<CompactString>);
+static_assert(std::is_trivially_destructible_v<CompactString>);
+
+TEST(CompactString, Inline) {
+  CompactString empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(empty.isInline());
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ("", empty.view());
+
+  SysArena arena;
+  for (size_t size = 0; size <= CompactString::kMaxInlineSize; ++size) {
+    std::string str(size, 'a' + size);
+    CompactString s(str, arena);
+    EXPECT_TRUE(s.isInline());
+    EXPECT_EQ(size, s.size());
+    EXPECT_EQ(size == 0, s.empty());
+    EXPECT_EQ(str, s.str());
+    EXPECT_EQ(s, CompactString::unowned(str));
+    EXPECT_EQ(s, str);
+  }
+  EXPECT_EQ(0, arena.bytesUsed());
+}
+
+TEST(CompactString, External) {
+  SysArena arena;
+  std::string str(100, 'x');
+  CompactString s(str, arena);
+  EXPECT_FALSE(s.isInline());
+  EXPECT_FALSE(s.empty());
+  EXPECT_EQ(100, s.size());
+  EXPECT_NE(str.data(), s.data());
+  EXPECT_EQ(str, s.view());
+
+  auto unowned = CompactString::unowned(str);
+  EXPECT_FALSE(unowned.isInline());
+  EXPECT_EQ(str.data(), unowned.data());
+  EXPECT_EQ(s, unowned);
+
+  CompactString inlined("0123456789abcde", arena);
+  CompactString external("0123456789abcdef", arena);
+  EXPECT_TRUE(inlined.isInline());
+  EXPECT_FALSE(external.isInline());
+  EXPECT_NE(inlined, external);
+  EXPECT_LT(inlined, external);
+  EXPECT_EQ('f', external[15]);
+  EXPECT_EQ("0123456789abcdef", external);
+  EXPECT_NE(CompactString::unowned("0123456789abcdeg"), external);
+
+  std::ostringstream os;
+  os << external;
+  EXPECT_EQ("0123456789abcdef", os.str());
+}
+
+TEST(CompactString, F14) {
+  CompactStringPool pool;
+  F14FastMap<CompactString, int> map;
+  map[pool.intern("short")] = 1;
+  map[pool.intern("a.much.longer.metric.name")] = 2;
+  EXPECT_EQ(1, map.at(pool.intern("short")));
+  EXPECT_EQ(2, map.at(pool.intern("a.much.longer.metric.name")));
+
+  // Heterogeneous lookups
+  EXPECT_EQ(1, map.find(StringPiece("short"))->second);
+  EXPECT_EQ(2, map.find(std::string("a.much.longer.metric.name"))->second);
+  EXPECT_EQ(map.end(), map.find(std::string_view("a.much.longer.metric")));
+
+  EXPECT_EQ(
+      std::hash<CompactString>{}(pool.intern("a.much.longer.metric.name")),
+      HeterogeneousAccessHash<std::string>{}("a.much.longer.metric.name"));
+}
+
+TEST(CompactStringPool, Intern) {
+  CompactStringPool pool;
+  auto a = pool.intern("a.much.longer.metric.name");
+  auto b = pool.intern(std::string("a.much.longer.metric.name"));
+  EXPECT_EQ(a.data(), b.data());
+  EXPECT_EQ(1, pool.size());
+  EXPECT_EQ(a.data(), pool.find("a.much.longer.metric.name")->data());
+  EXPECT_FALSE(pool.find("another.much.longer.name").has_value());
+
+  auto c = pool.intern("short");
+  EXPECT_TRUE(c.isInline());
+  EXPECT_EQ(c, pool.find("short"));
+  EXPECT_EQ(1, pool.size());
+  EXPECT_GT(pool.totalSize(), 0);
+
+  pool.clear();
+  EXPECT_EQ(0, pool.size());
+  EXPECT_FALSE(pool.find("a.much.longer.metric.name").has_value());
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/ConcurrentEvictingCacheMap.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(ConcurrentEvictingCacheMap, Basic) {
+  ConcurrentEvictingCacheMap<int, std::string> map(100);
+  EXPECT_EQ(16, map.numShards());
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.get(1).has_value());
+
+  map.set(1, "one");
+  EXPECT_TRUE(map.exists(1));
+  EXPECT_EQ("one", map.get(1).value());
+  EXPECT_EQ("one", map.getWithoutPromotion(1).value());
+
+  EXPECT_FALSE(map.insert(1, "uno"));
+  EXPECT_EQ("one", map.get(1).value());
+  map.set(1, "uno");
+  EXPECT_EQ("uno", map.get(1).value());
+
+  EXPECT_TRUE(map.insert(2, "two"));
+  EXPECT_EQ(2, map.size());
+  EXPECT_TRUE(map.erase(2));
+  EXPECT_FALSE(map.erase(2));
+  EXPECT_FALSE(map.exists(2));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+
+  auto stats = map.getStats();
+  EXPECT_EQ(4, stats.hits);
+  EXPECT_EQ(1, stats.misses);
+  EXPECT_EQ(0, stats.evictions);
+}
+
+TEST(ConcurrentEvictingCacheMap, EvictsLeastRecentlyInserted) {
+  std::vector<int> evicted;
+  ConcurrentEvictingCacheMap<int, int> map(
+      3, 1, [&](int key, int&&) { evicted.push_back(key); });
+  for (int i = 0; i < 5; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_EQ(3, map.size());
+  EXPECT_EQ((std::vector<int>{0, 1}), evicted);
+  EXPECT_EQ(2, map.getStats().evictions);
+}
+
+TEST(ConcurrentEvictingCacheMap, SecondChance) {
+  std::vector<int> evicted;
+  ConcurrentEvictingCacheMap<int, int> map(
+      3, 1, [&](int key, int&&) { evicted.push_back(key); });
+  map.set(0, 0);
+  map.set(1, 1);
+  map.set(2, 2);
+  // 0 is the oldest, but was read since it was inserted.
+  EXPECT_TRUE(map.get(0).has_value());
+  map.set(3, 3);
+  EXPECT_EQ((std::vector<int>{1}), evicted);
+  EXPECT_TRUE(map.exists(0));
+  // Reads without promotion don't protect from eviction.
+  EXPECT_TRUE(map.getWithoutPromotion(2).has_value());
+  map.set(4, 4);
+  EXPECT_EQ((std::vector<int>{1, 2}), evicted);
+  // The second chance has been used up.
+  map.set(5, 5);
+  EXPECT_EQ((std::vector<int>{1, 2, 0}), evicted);
+}
+
+TEST(ConcurrentEvictingCacheMap, AllReferenced) {
+  ConcurrentEvictingCacheMap<int, int> map(3, 1);
+  for (int i = 0; i < 3; ++i) {
+    map.set(i, i);
+    map.get(i);
+  }
+  // Every entry gets a second chance, then the oldest one goes.
+  map.set(3, 3);
+  EXPECT_EQ(3, map.size());
+  EXPECT_FALSE(map.exists(0));
+}
+
+TEST(ConcurrentEvictingCacheMap, Unlimited) {
+  ConcurrentEvictingCacheMap<int, int> map(0, 4);
+  for (int i = 0; i < 1000; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_EQ(1000, map.size());
+  EXPECT_EQ(0, map.getStats().evictions);
+}
+
+TEST(ConcurrentEvictingCacheMap, Sharded) {
+  ConcurrentEvictingCacheMap<int, int> map(64, 5);
+  EXPECT_EQ(8, map.numShards());
+  EXPECT_EQ(64, map.getMaxSize());
+  for (int i = 0; i < 1000; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_LE(map.size(), 64);
+  EXPECT_EQ(1000 - map.size(), map.getStats().evictions);
+}
+
+TEST(ConcurrentEvictingCacheMap, Concurrent) {
+  constexpr int kThreads = 8;
+  constexpr int kOps = 10000;
+  constexpr int kKeys = 512;
+  ConcurrentEvictingCacheMap<int, int> map(256);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kOps; ++i) {
+        int key = (i * 7 + t) % kKeys;
+        if (auto v = map.get(key)) {
+          EXPECT_EQ(key, *v);
+        } else {
+          map.insert(key, key);
+        }
+        if (i % 100 == 0) {
+          map.erase(key);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_LE(map.size(), 256);
+  auto stats = map.getStats();
+  EXPECT_EQ(kThreads * kOps, stats.hits + stats.misses);
+}
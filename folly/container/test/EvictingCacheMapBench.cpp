@@ -16,6 +16,11 @@
 
 #include <folly/container/EvictingCacheMap.h>
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
 #include <folly/Benchmark.h>
 
 using namespace folly;
@@ -60,6 +65,86 @@ void insertCache(uint32_t n, size_t numElts) {
 
 // Increment by factor of 4 * golden ratio to vary distance between
 // powers of 2
+// A trace of lookups of keys following a Zipf distribution, interrupted by
+// scans of keys that are never seen again, as e.g. a batch job or a crawler
+// would cause. Each key is looked up, and inserted on a miss.
+const std::vector<uint64_t>& trace() {
+  static const auto trace = [] {
+    constexpr size_t kKeys = 100000;
+    constexpr size_t kLength = 1000000;
+    constexpr size_t kScanEvery = 100000;
+    constexpr size_t kScanLength = 20000;
+    constexpr double kSkew = 0.9;
+    std::vector<double> cdf(kKeys);
+    double sum = 0;
+    for (size_t i = 0; i < kKeys; ++i) {
+      sum += 1 / std::pow(double(i + 1), kSkew);
+      cdf[i] = sum;
+    }
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<uint64_t> keys;
+    keys.reserve(kLength);
+    size_t scanned = 0;
+    while (keys.size() < kLength) {
+      if (keys.size() % kScanEvery == kScanEvery - kScanLength) {
+        for (size_t i = 0; i < kScanLength; ++i) {
+          keys.push_back(key(kKeys + scanned++));
+        }
+        continue;
+      }
+      auto pos = std::lower_bound(cdf.begin(), cdf.end(), dist(rng));
+      keys.push_back(key(pos - cdf.begin()));
+    }
+    return keys;
+  }();
+  return trace;
+}
+
+// Replays the trace against a cache holding 5% of the Zipf keys, reporting
+// the hit ratio (in permille) of the last replay.
+template <typename Policy>
+void replayTrace(UserCounters& counters, uint32_t n) {
+  BenchmarkSuspender suspender;
+  const auto& keys = trace();
+  size_t hits = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    EvictingCacheMap<
+        uint64_t,
+        size_t,
+        HeterogeneousAccessHash<uint64_t>,
+        HeterogeneousAccessEqualTo<uint64_t>,
+        Policy>
+        m(5000);
+    hits = 0;
+    suspender.dismiss();
+    for (size_t j = 0; j < keys.size(); ++j) {
+      if (m.find(keys[j]) != m.end()) {
+        ++hits;
+      } else {
+        m.insert(keys[j], j);
+      }
+    }
+    suspender.rehire();
+  }
+  counters["hit_permille"] = int64_t(hits * 1000 / keys.size());
+  counters["lookups"] = int64_t(keys.size());
+}
+
+BENCHMARK_COUNTERS(traceLru, counters, n) {
+  replayTrace<EvictingCacheMapLruPolicy>(counters, n);
+}
+
+BENCHMARK_COUNTERS(traceTinyLfu, counters, n) {
+  replayTrace<EvictingCacheMapTinyLfuPolicy>(counters, n);
+}
+
+BENCHMARK_COUNTERS(traceS3Fifo, counters, n) {
+  replayTrace<EvictingCacheMapS3FifoPolicy>(counters, n);
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK_PARAM(scanCache, 1000)
 BENCHMARK_PARAM(scanCache, 6472)
 BENCHMARK_PARAM(scanCache, 41889)
@@ -17,6 +17,8 @@
 #include <folly/container/EvictingCacheMap.h>
 
 #include <set>
+#include <string>
+#include <vector>
 
 #include <folly/portability/GTest.h>
 
@@ -840,3 +842,163 @@ TEST(EvictingCacheMap, PiecewiseConstructTest) {
   EXPECT_TRUE(inserted);
   EXPECT_EQ(iter->second, "test");
 }
+
+template <typename Policy>
+class EvictingCacheMapPolicyTest : public ::testing::Test {};
+
+using EvictingCacheMapPolicies = ::testing::Types<
+    EvictingCacheMapLruPolicy,
+    EvictingCacheMapTinyLfuPolicy,
+    EvictingCacheMapS3FifoPolicy>;
+TYPED_TEST_SUITE(EvictingCacheMapPolicyTest, EvictingCacheMapPolicies);
+
+template <typename Policy>
+using PolicyMap = EvictingCacheMap<
+    int,
+    int,
+    HeterogeneousAccessHash<int>,
+    HeterogeneousAccessEqualTo<int>,
+    Policy>;
+
+TYPED_TEST(EvictingCacheMapPolicyTest, Basic) {
+  std::size_t pruned = 0;
+  PolicyMap<TypeParam> map(100);
+  map.setPruneHook([&](int key, int&& value) {
+    EXPECT_EQ(key, value);
+    ++pruned;
+  });
+  for (int i = 0; i < 1000; ++i) {
+    map.set(i, i);
+    EXPECT_LE(map.size(), 100);
+    if (i % 3 == 0) {
+      map.find(i / 2);
+    }
+    if (i % 7 == 0) {
+      map.erase(i / 3);
+    }
+  }
+  EXPECT_EQ(100, map.size());
+  std::size_t count = 0;
+  for (auto& [key, value] : map) {
+    EXPECT_EQ(key, value);
+    EXPECT_TRUE(map.exists(key));
+    ++count;
+  }
+  EXPECT_EQ(100, count);
+
+  map.setMaxSize(10);
+  EXPECT_EQ(10, map.size());
+  map.prune(3);
+  EXPECT_EQ(7, map.size());
+
+  auto moved = std::move(map);
+  EXPECT_EQ(7, moved.size());
+  for (int i = 1000; i < 1020; ++i) {
+    moved.insert(i, i);
+  }
+  EXPECT_EQ(10, moved.size());
+  auto before = pruned;
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(before + 10, pruned);
+}
+
+TYPED_TEST(EvictingCacheMapPolicyTest, MoveAssign) {
+  PolicyMap<TypeParam> a(10);
+  PolicyMap<TypeParam> b(20);
+  for (int i = 0; i < 30; ++i) {
+    a.set(i, i);
+    b.set(i, i);
+  }
+  a = std::move(b);
+  EXPECT_EQ(20, a.size());
+  EXPECT_EQ(20, a.getMaxSize());
+  for (int i = 30; i < 60; ++i) {
+    a.set(i, i);
+    a.find(i - 1);
+  }
+  EXPECT_EQ(20, a.size());
+}
+
+// A few hot keys, accessed repeatedly, followed by a long scan of keys that
+// are each accessed only once.
+template <typename Map>
+std::size_t hotKeysSurvivingScan() {
+  Map map(100);
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 50; ++i) {
+      if (map.find(i) == map.end()) {
+        map.set(i, i);
+      }
+    }
+  }
+  for (int i = 1000; i < 1500; ++i) {
+    map.set(i, i);
+  }
+  std::size_t survivors = 0;
+  for (int i = 0; i < 50; ++i) {
+    survivors += map.exists(i);
+  }
+  return survivors;
+}
+
+TEST(EvictingCacheMap, ScanResistance) {
+  EXPECT_EQ(0, hotKeysSurvivingScan<PolicyMap<EvictingCacheMapLruPolicy>>());
+  // The hot key that is in the TinyLFU window when the scan starts has to
+  // compete with the other hot keys, and may lose.
+  EXPECT_GE(
+      hotKeysSurvivingScan<PolicyMap<EvictingCacheMapTinyLfuPolicy>>(), 49);
+  EXPECT_EQ(
+      50, hotKeysSurvivingScan<PolicyMap<EvictingCacheMapS3FifoPolicy>>());
+}
+
+TEST(EvictingCacheMap, TinyLfuAdmission) {
+  std::vector<int> pruned;
+  PolicyMap<EvictingCacheMapTinyLfuPolicy> map(3);
+  map.setPruneHook([&](int key, int&&) { pruned.push_back(key); });
+  map.set(1, 1);
+  map.set(2, 2);
+  map.set(3, 3);
+  map.find(1);
+  map.find(2);
+  map.find(3);
+  // New keys are less popular than everything in the main region, so they
+  // are rejected, however recent.
+  map.set(4, 4);
+  map.set(5, 5);
+  EXPECT_EQ((std::vector<int>{3, 4}), pruned);
+  EXPECT_TRUE(map.exists(5));
+  // Until they have been seen often enough.
+  map.set(4, 4);
+  map.find(4);
+  map.find(4);
+  map.set(6, 6);
+  EXPECT_EQ(3, map.size());
+  EXPECT_TRUE(map.exists(4));
+}
+
+TEST(EvictingCacheMap, S3FifoGhost) {
+  std::vector<int> pruned;
+  PolicyMap<EvictingCacheMapS3FifoPolicy> map(10);
+  map.setPruneHook([&](int key, int&&) { pruned.push_back(key); });
+  for (int i = 0; i < 10; ++i) {
+    map.set(i, i);
+  }
+  // 0..8 were never accessed, so they leave through the small queue.
+  map.find(9);
+  for (int i = 10; i < 19; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8}), pruned);
+  // 9 was moved to the main queue instead.
+  EXPECT_TRUE(map.exists(9));
+  // 0 is remembered by the ghost queue, so it goes straight to the main
+  // queue and outlives the more recent entries of the small queue.
+  map.set(0, 0);
+  pruned.clear();
+  for (int i = 19; i < 30; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_TRUE(map.exists(0));
+  EXPECT_TRUE(map.exists(9));
+}
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <iterator>
+#include <numeric>
 #include <random>
 #include <string>
 #include <type_traits>
@@ -927,6 +929,63 @@ TEST(F14FastMap, prehash) {
   runPrehash<F14FastMap<std::string, std::string>>();
 }
 
+template <typename T>
+void runFindMany() {
+  T h;
+  // Large enough to span several blocks of keys with a partial last block.
+  for (int i = 0; i < 100; i += 2) {
+    h.emplace(i, i * 10);
+  }
+  std::vector<int> keys(100);
+  std::iota(keys.begin(), keys.end(), 0);
+
+  std::vector<typename T::iterator> found(keys.size());
+  auto end = h.findMany(keys.begin(), keys.end(), found.begin());
+  EXPECT_TRUE(end == found.end());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(found[i] == h.find(i));
+    if (i % 2 == 0) {
+      ASSERT_TRUE(found[i] != h.end());
+      EXPECT_EQ(i * 10, found[i]->second);
+      found[i]->second++;
+    }
+  }
+  EXPECT_EQ(1, h.at(0));
+
+  std::vector<typename T::const_iterator> cfound;
+  std::as_const(h).findMany(
+      keys.begin(), keys.end(), std::back_inserter(cfound));
+  ASSERT_EQ(keys.size(), cfound.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(cfound[i] == std::as_const(h).find(i));
+  }
+
+  T empty;
+  std::vector<typename T::iterator> none(keys.size());
+  empty.findMany(keys.begin(), keys.end(), none.begin());
+  for (auto& it : none) {
+    EXPECT_TRUE(it == empty.end());
+  }
+  EXPECT_TRUE(
+      h.findMany(keys.begin(), keys.begin(), found.begin()) == found.begin());
+}
+
+TEST(F14ValueMap, findMany) {
+  runFindMany<F14ValueMap<int, int>>();
+}
+
+TEST(F14NodeMap, findMany) {
+  runFindMany<F14NodeMap<int, int>>();
+}
+
+TEST(F14VectorMap, findMany) {
+  runFindMany<F14VectorMap<int, int>>();
+}
+
+TEST(F14FastMap, findMany) {
+  runFindMany<F14FastMap<int, int>>();
+}
+
 TEST(F14ValueMap, random) {
   runRandom<F14ValueMap<
       uint64_t,
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/F14MappedMap.h>
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <folly/FileUtil.h>
+#include <folly/portability/GTest.h>
+#include <folly/testing/TestUtil.h>
+
+#if FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
+
+using namespace folly;
+
+namespace {
+ByteRange bytes(std::string const& s) {
+  return ByteRange(StringPiece(s));
+}
+} // namespace
+
+TEST(F14MappedMap, Empty) {
+  std::vector<std::pair<int, int>> entries;
+  auto data = F14MappedMap<int, int>::serialize(entries.begin(), entries.end());
+  F14MappedMap<int, int> map{bytes(data)};
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0, map.size());
+  EXPECT_EQ(nullptr, map.find(0));
+  EXPECT_THROW(map.at(0), std::out_of_range);
+}
+
+TEST(F14MappedMap, Lookup) {
+  std::vector<std::pair<uint64_t, uint32_t>> entries;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    entries.emplace_back(i * 3, static_cast<uint32_t>(i));
+  }
+  auto data = F14MappedMap<uint64_t, uint32_t>::serialize(
+      entries.begin(), entries.end());
+  F14MappedMap<uint64_t, uint32_t> map{bytes(data)};
+  EXPECT_EQ(entries.size(), map.size());
+  for (uint64_t i = 0; i < 300000; ++i) {
+    auto item = map.find(i);
+    if (i % 3 == 0) {
+      ASSERT_NE(nullptr, item);
+      EXPECT_EQ(i, item->first);
+      EXPECT_EQ(i / 3, item->second);
+    } else {
+      EXPECT_EQ(nullptr, item);
+    }
+  }
+
+  uint64_t sum = 0;
+  size_t count = 0;
+  map.forEach([&](auto const& item) {
+    sum += item.second;
+    ++count;
+  });
+  EXPECT_EQ(entries.size(), count);
+  EXPECT_EQ(99999ull * 100000 / 2, sum);
+}
+
+TEST(F14MappedMap, FirstDuplicateWins) {
+  std::vector<std::pair<int, int>> entries{{1, 10}, {2, 20}, {1, 30}};
+  auto data = F14MappedMap<int, int>::serialize(entries.begin(), entries.end());
+  F14MappedMap<int, int> map{bytes(data)};
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(10, map.at(1));
+  EXPECT_EQ(20, map.at(2));
+  EXPECT_EQ(1, map.count(2));
+  EXPECT_EQ(0, map.count(3));
+}
+
+TEST(F14MappedMap, SmallItems) {
+  // 4 byte items use 12 slot chunks.
+  std::map<uint16_t, uint16_t> entries;
+  for (uint16_t i = 0; i < 1000; ++i) {
+    entries[i] = i + 1;
+  }
+  auto data = F14MappedMap<uint16_t, uint16_t>::serialize(
+      entries.begin(), entries.end());
+  F14MappedMap<uint16_t, uint16_t> map{bytes(data)};
+  for (uint16_t i = 0; i < 2000; ++i) {
+    EXPECT_EQ(i < 1000, map.contains(i));
+  }
+  EXPECT_EQ(1000, map.at(999));
+}
+
+TEST(F14MappedMap, MemoryMapping) {
+  std::vector<std::pair<uint32_t, double>> entries;
+  for (uint32_t i = 0; i < 5000; ++i) {
+    entries.emplace_back(i, i * 0.5);
+  }
+  test::TemporaryFile file;
+  ASSERT_TRUE(writeFile(
+      F14MappedMap<uint32_t, double>::serialize(entries.begin(), entries.end()),
+      file.path().c_str()));
+
+  F14MappedMap<uint32_t, double> map{MemoryMapping{file.path().c_str()}};
+  auto moved = std::move(map);
+  EXPECT_EQ(entries.size(), moved.size());
+  for (auto const& [key, value] : entries) {
+    EXPECT_EQ(value, moved.at(key));
+  }
+  EXPECT_FALSE(moved.contains(5000));
+}
+
+TEST(F14MappedMap, RejectsMismatchedTables) {
+  std::vector<std::pair<int, int>> entries{{1, 1}, {2, 2}};
+  auto data = F14MappedMap<int, int>::serialize(entries.begin(), entries.end());
+
+  // Different item layout.
+  EXPECT_THROW(
+      (F14MappedMap<int64_t, int>{bytes(data)}), std::invalid_argument);
+  // Truncated.
+  EXPECT_THROW(
+      (F14MappedMap<int, int>{bytes(data.substr(0, data.size() - 16))}),
+      std::invalid_argument);
+  EXPECT_THROW(
+      (F14MappedMap<int, int>{bytes(data.substr(0, 8))}),
+      std::invalid_argument);
+  // Not a table.
+  std::string garbage(data.size(), 'x');
+  EXPECT_THROW(
+      (F14MappedMap<int, int>{bytes(garbage)}), std::invalid_argument);
+}
+
+#endif // FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
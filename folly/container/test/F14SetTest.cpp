@@ -26,6 +26,7 @@ FOLLY_GNU_DISABLE_WARNING("-Wdeprecated-declarations")
 // clang-format on
 
 #include <chrono>
+#include <iterator>
 #include <numeric>
 #include <random>
 #include <string>
@@ -717,6 +718,39 @@ TEST(F14FastSet, simple) {
   runSimple<F14FastSet<std::string>>();
 }
 
+template <typename S>
+void runFindMany() {
+  S h;
+  for (int i = 0; i < 100; i += 2) {
+    h.insert(i);
+  }
+  std::vector<int> keys(100);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::vector<typename S::const_iterator> found;
+  h.findMany(keys.begin(), keys.end(), std::back_inserter(found));
+  ASSERT_EQ(keys.size(), found.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(found[i] == h.find(i));
+    EXPECT_EQ(i % 2 == 0, found[i] != h.end());
+  }
+}
+
+TEST(F14ValueSet, findMany) {
+  runFindMany<F14ValueSet<int>>();
+}
+
+TEST(F14NodeSet, findMany) {
+  runFindMany<F14NodeSet<int>>();
+}
+
+TEST(F14VectorSet, findMany) {
+  runFindMany<F14VectorSet<int>>();
+}
+
+TEST(F14FastSet, findMany) {
+  runFindMany<F14FastSet<int>>();
+}
+
 #if FOLLY_HAS_MEMORY_RESOURCE
 TEST(F14ValueSet, pmrSimple) {
   runSimple<pmr::F14ValueSet<std::string>>();
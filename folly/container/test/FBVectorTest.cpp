@@ -20,10 +20,14 @@
 #include <map>
 #include <memory>
 #include <numeric>
+#include <sstream>
 
 #include <folly/FBString.h>
 #include <folly/Random.h>
+#include <folly/Range.h>
 #include <folly/Traits.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <folly/container/Foreach.h>
 #include <folly/portability/GTest.h>
 #include <folly/test/FBVectorTestUtil.h>
@@ -324,3 +328,52 @@ TEST(FBVector, zeroInit) {
   EXPECT_EQ(vec[8].mp_, nullptr);
 }
 #endif
+
+TEST(FBVector, appendRange) {
+  folly::fbvector<fbstring> vec = {"a"};
+  std::vector<fbstring> strings = {"b", "c", "d"};
+  vec.append_range(strings);
+  EXPECT_EQ((folly::fbvector<fbstring>{"a", "b", "c", "d"}), vec);
+
+  std::list<fbstring> list = {"e", "f"};
+  vec.append_range(list);
+  EXPECT_EQ(6, vec.size());
+  EXPECT_EQ("f", vec.back());
+
+  std::istringstream in("1 2 3");
+  folly::fbvector<int> ints = {0};
+  ints.append_range(folly::range(
+      std::istream_iterator<int>(in), std::istream_iterator<int>()));
+  EXPECT_EQ((folly::fbvector<int>{0, 1, 2, 3}), ints);
+
+  // Appending a large range to a full vector allocates once.
+  folly::fbvector<int> big(100);
+  big.shrink_to_fit();
+  std::vector<int> more(1000, 7);
+  auto const before = big.data();
+  big.append_range(more);
+  EXPECT_NE(before, big.data());
+  EXPECT_EQ(1100, big.size());
+  EXPECT_EQ(7, big.back());
+}
+
+#if FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
+TEST(FBVector, relocatableF14) {
+  static_assert(folly::IsRelocatable<folly::F14FastMap<int, fbstring>>::value);
+  static_assert(folly::IsRelocatable<folly::F14NodeSet<std::string>>::value);
+
+  folly::fbvector<folly::F14FastMap<int, fbstring>> maps;
+  for (int i = 0; i < 100; ++i) {
+    maps.emplace_back();
+    for (int j = 0; j < i % 10; ++j) {
+      maps.back()[j] = fbstring(30, char('a' + j));
+    }
+  }
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i % 10, maps[i].size());
+    for (int j = 0; j < i % 10; ++j) {
+      EXPECT_EQ(fbstring(30, char('a' + j)), maps[i].at(j));
+    }
+  }
+}
+#endif
@@ -21,6 +21,7 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <thread>
 
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -551,6 +552,90 @@ TEST_F(RegexMatchCacheTest, add_regex_add_string) {
   checkConsistency(cache);
 }
 
+TEST_F(RegexMatchCacheTest, coalesce_strings) {
+  auto const foo = "foo"s;
+  auto const bar = "bar"s;
+  auto const cat = "cat"s;
+  constexpr auto xFooOrBar = "foo|bar"sv;
+  constexpr auto xCat = "c.t"sv;
+  RegexMatchCache cache;
+
+  EXPECT_TRUE(cache.coalesceStrings(keys, 1));
+
+  keys.add(RegexMatchCacheKeyAndView(xFooOrBar));
+  cache.addRegex(RegexMatchCacheKey(xFooOrBar));
+  keys.add(RegexMatchCacheKeyAndView(xCat));
+  cache.addRegex(RegexMatchCacheKey(xCat));
+  cache.addString(&foo);
+  cache.addString(&bar);
+  cache.addString(&cat);
+  checkConsistency(cache);
+  EXPECT_FALSE(cache.isReadyToFindMatches(RegexMatchCacheKey(xFooOrBar)));
+  EXPECT_FALSE(cache.isReadyToFindMatches(RegexMatchCacheKey(xCat)));
+
+  EXPECT_FALSE(cache.coalesceStrings(keys, 0));
+  EXPECT_FALSE(cache.coalesceStrings(keys, 2));
+  checkConsistency(cache);
+  EXPECT_TRUE(cache.coalesceStrings(keys, 2));
+  checkConsistency(cache);
+
+  auto const now = time_point() + 5s;
+  EXPECT_TRUE(cache.isReadyToFindMatches(RegexMatchCacheKey(xFooOrBar)));
+  EXPECT_TRUE(cache.isReadyToFindMatches(RegexMatchCacheKey(xCat)));
+  EXPECT_THAT(
+      cache.findMatches(RegexMatchCacheKey(xFooOrBar), now),
+      testing::UnorderedElementsAre(&foo, &bar));
+  EXPECT_THAT(
+      cache.findMatches(RegexMatchCacheKey(xCat), now),
+      testing::UnorderedElementsAre(&cat));
+}
+
+TEST_F(RegexMatchCacheTest, coalesce_strings_parallel) {
+  constexpr size_t nthreads = 4;
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < 200; ++i) {
+    strings.push_back(fmt::format("s{}", i));
+  }
+  std::vector<std::string> regexes;
+  for (size_t i = 0; i < 10; ++i) {
+    regexes.push_back(fmt::format("s.*{}", i));
+  }
+  RegexMatchCache cache;
+  for (auto const& regex : regexes) {
+    keys.add(RegexMatchCacheKeyAndView(regex));
+    cache.addRegex(RegexMatchCacheKey(regex));
+  }
+  for (auto const& string : strings) {
+    cache.addString(&string);
+  }
+
+  auto const parallel = [&](size_t const n, auto const task) {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = t; i < n; i += nthreads) {
+          task(i);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+  while (!cache.coalesceStrings(keys, 64, parallel)) {
+    checkConsistency(cache);
+  }
+  checkConsistency(cache);
+
+  for (auto const& regex : regexes) {
+    auto const key = RegexMatchCacheKey(regex);
+    ASSERT_TRUE(cache.isReadyToFindMatches(key));
+    EXPECT_THAT(
+        cache.findMatches(key, time_point()),
+        testing::UnorderedElementsAreArray(cache.findMatchesUncached(regex)));
+  }
+}
+
 TEST_F(RegexMatchCacheTest, combinatorics) {
   constexpr size_t opt = folly::kIsOptimize;
   constexpr size_t san = folly::kIsSanitize;
@@ -609,8 +694,10 @@ TEST_F(RegexMatchCacheTest, combinatorics) {
       } else if (what < 10) {
         auto const str = rand_string();
         cache.eraseString(str);
+      } else if (what < 12) {
+        cache.coalesceStrings(keys, rng() % 4);
       }
-      if (what < 10) {
+      if (what < 12) {
         auto const report = getConsistencyReport(cache);
         ASSERT_TRUE(report.consistent()) << inspect(cache) << report;
       }
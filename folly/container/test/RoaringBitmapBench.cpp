@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/RoaringBitmap.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+namespace {
+
+constexpr uint32_t kUniverse = 1 << 24;
+
+// Sorted values with the given density in [0, kUniverse).
+std::vector<uint32_t> makeValues(double density, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution dist(density);
+  std::vector<uint32_t> values;
+  for (uint32_t i = 0; i < kUniverse; ++i) {
+    if (dist(rng)) {
+      values.push_back(i);
+    }
+  }
+  return values;
+}
+
+struct Data {
+  explicit Data(double density)
+      : a(makeValues(density, 1)), b(makeValues(density, 2)) {
+    x.insertMany(folly::range(a));
+    y.insertMany(folly::range(b));
+  }
+
+  std::vector<uint32_t> a;
+  std::vector<uint32_t> b;
+  folly::RoaringBitmap x;
+  folly::RoaringBitmap y;
+};
+
+Data& sparse() {
+  static Data d(0.01);
+  return d;
+}
+
+Data& dense() {
+  static Data d(0.3);
+  return d;
+}
+
+void intersectVectors(const Data& d, size_t iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    std::vector<uint32_t> out;
+    auto it = std::back_inserter(out);
+    std::set_intersection(d.a.begin(), d.a.end(), d.b.begin(), d.b.end(), it);
+    folly::doNotOptimizeAway(out.size());
+  }
+}
+
+void intersectBitmaps(const Data& d, size_t iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway((d.x & d.y).size());
+  }
+}
+
+} // namespace
+
+BENCHMARK(IntersectSparseVectors, iters) {
+  intersectVectors(sparse(), iters);
+}
+
+BENCHMARK_RELATIVE(IntersectSparseBitmaps, iters) {
+  intersectBitmaps(sparse(), iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(IntersectDenseVectors, iters) {
+  intersectVectors(dense(), iters);
+}
+
+BENCHMARK_RELATIVE(IntersectDenseBitmaps, iters) {
+  intersectBitmaps(dense(), iters);
+}
+
+BENCHMARK_RELATIVE(IntersectionSizeDenseBitmaps, iters) {
+  auto const& d = dense();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(folly::RoaringBitmap::intersectionSize(d.x, d.y));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(UnionDenseBitmaps, iters) {
+  auto const& d = dense();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway((d.x | d.y).size());
+  }
+}
+
+BENCHMARK(IterateDenseBitmap, iters) {
+  auto const& d = dense();
+  for (size_t i = 0; i < iters; ++i) {
+    uint64_t sum = 0;
+    for (auto value : d.x) {
+      sum += value;
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_RELATIVE(ForEachDenseBitmap, iters) {
+  auto const& d = dense();
+  for (size_t i = 0; i < iters; ++i) {
+    uint64_t sum = 0;
+    d.x.forEach([&](uint32_t value) { sum += value; });
+    folly::doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(SerializeDenseBitmap, iters) {
+  auto const& d = dense();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(d.x.serialize());
+  }
+}
+
+BENCHMARK(DeserializeDenseBitmap, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto const buf = dense().x.serialize();
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(
+        folly::RoaringBitmap::deserialize(buf->coalesce()).size());
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
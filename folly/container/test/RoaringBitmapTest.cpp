@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/RoaringBitmap.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+std::vector<uint32_t> toVector(const RoaringBitmap& set) {
+  return std::vector<uint32_t>(set.begin(), set.end());
+}
+
+std::vector<uint32_t> toVector(const std::set<uint32_t>& set) {
+  return std::vector<uint32_t>(set.begin(), set.end());
+}
+
+// Mixes sparse, dense and consecutive values over a few containers.
+std::set<uint32_t> makeRandomSet(std::mt19937& rng) {
+  std::set<uint32_t> set;
+  for (uint32_t key = 0; key < 6; ++key) {
+    auto const high = (key * 3) << 16;
+    switch (rng() % 4) {
+      case 0:
+        for (int i = 0; i < 100; ++i) {
+          set.insert(high | (rng() & 0xffff));
+        }
+        break;
+      case 1:
+        for (int i = 0; i < 10000; ++i) {
+          set.insert(high | (rng() & 0xffff));
+        }
+        break;
+      case 2: {
+        auto const start = rng() & 0x7fff;
+        for (uint32_t i = 0; i < 20000; ++i) {
+          set.insert(high | (start + i));
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return set;
+}
+
+RoaringBitmap makeBitmap(const std::set<uint32_t>& values, bool runs) {
+  RoaringBitmap set;
+  for (auto value : values) {
+    set.insert(value);
+  }
+  if (runs) {
+    set.runOptimize();
+  }
+  return set;
+}
+
+template <typename Op>
+std::set<uint32_t> apply(
+    const std::set<uint32_t>& a, const std::set<uint32_t>& b, Op op) {
+  std::set<uint32_t> result;
+  auto out = std::inserter(result, result.end());
+  op(a.begin(), a.end(), b.begin(), b.end(), out);
+  return result;
+}
+
+} // namespace
+
+TEST(RoaringBitmap, basic) {
+  RoaringBitmap set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(0, set.size());
+  EXPECT_EQ(set.begin(), set.end());
+
+  EXPECT_TRUE(set.insert(5));
+  EXPECT_FALSE(set.insert(5));
+  EXPECT_TRUE(set.insert(0xffffffff));
+  EXPECT_TRUE(set.insert(1 << 20));
+  EXPECT_EQ(3, set.size());
+  EXPECT_TRUE(set.contains(5));
+  EXPECT_TRUE(set.contains(0xffffffff));
+  EXPECT_FALSE(set.contains(6));
+  EXPECT_EQ(5, set.front());
+  EXPECT_EQ(0xffffffff, set.back());
+  EXPECT_EQ((std::vector<uint32_t>{5, 1 << 20, 0xffffffff}), toVector(set));
+
+  EXPECT_TRUE(set.erase(1 << 20));
+  EXPECT_FALSE(set.erase(1 << 20));
+  EXPECT_EQ((RoaringBitmap{5, 0xffffffff}), set);
+  set.clear();
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(RoaringBitmap, containerConversions) {
+  RoaringBitmap set;
+  std::vector<uint32_t> values;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    values.push_back(i * 3);
+  }
+  set.insertMany(range(values));
+  EXPECT_EQ(10000, set.size());
+  EXPECT_EQ(values, toVector(set));
+  // A bitmap.
+  EXPECT_LT(set.getAllocatedMemorySize(), 20000);
+  EXPECT_FALSE(set.runOptimize());
+
+  for (uint32_t i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(set.erase(i * 3));
+  }
+  EXPECT_EQ(5000, set.size());
+  for (uint32_t i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i % 2 == 1, set.contains(i * 3)) << i;
+  }
+  for (uint32_t i = 0; i < 10000; i += 4) {
+    EXPECT_TRUE(set.erase(i * 3 + 3));
+  }
+  // Back to an array.
+  EXPECT_EQ(2500, set.size());
+  EXPECT_EQ(2500, std::distance(set.begin(), set.end()));
+}
+
+TEST(RoaringBitmap, runs) {
+  RoaringBitmap set;
+  set.insertRange(10, 3 << 16);
+  set.insertRange(5, 7);
+  EXPECT_EQ(2 + (3 << 16) - 10, set.size());
+  EXPECT_EQ(5, set.front());
+  EXPECT_EQ((3 << 16) - 1, set.back());
+  EXPECT_FALSE(set.contains(7));
+  EXPECT_TRUE(set.contains(10));
+  EXPECT_TRUE(set.contains(1 << 16));
+  // Three run containers.
+  EXPECT_LT(set.getAllocatedMemorySize(), 1000);
+
+  EXPECT_TRUE(set.erase(100));
+  EXPECT_TRUE(set.erase(10));
+  EXPECT_TRUE(set.erase((3 << 16) - 1));
+  EXPECT_FALSE(set.erase(100));
+  EXPECT_TRUE(set.insert(7));
+  EXPECT_TRUE(set.insert(8));
+  EXPECT_TRUE(set.insert(9));
+  EXPECT_TRUE(set.insert(10));
+  EXPECT_FALSE(set.contains(100));
+  EXPECT_EQ(2 + (3 << 16) - 10 + 4 - 3, set.size());
+  EXPECT_EQ(set.size(), toVector(set).size());
+  auto values = toVector(set);
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+  EXPECT_EQ(5, values[0]);
+  EXPECT_EQ(99, values[94]);
+  EXPECT_EQ(101, values[95]);
+
+  set.insertRange(0, uint64_t(1) << 32);
+  EXPECT_EQ(uint64_t(1) << 32, set.size());
+  EXPECT_EQ(0xffffffff, set.back());
+  EXPECT_THROW(
+      set.insertRange(0, (uint64_t(1) << 32) + 1), std::invalid_argument);
+
+  RoaringBitmap converted;
+  for (uint32_t i = 0; i < 50000; ++i) {
+    converted.insert(i);
+  }
+  auto const before = converted.getAllocatedMemorySize();
+  EXPECT_TRUE(converted.runOptimize());
+  EXPECT_LT(converted.getAllocatedMemorySize(), before);
+  RoaringBitmap expected;
+  expected.insertRange(0, 50000);
+  EXPECT_EQ(expected, converted);
+}
+
+TEST(RoaringBitmap, setOperations) {
+  std::mt19937 rng(42);
+  for (int iter = 0; iter < 20; ++iter) {
+    auto const a = makeRandomSet(rng);
+    auto const b = makeRandomSet(rng);
+    auto const x = makeBitmap(a, iter % 2);
+    auto const y = makeBitmap(b, iter % 3 == 0);
+    EXPECT_EQ(a.size(), x.size());
+    EXPECT_EQ(toVector(a), toVector(x));
+
+    auto check = [&](const RoaringBitmap& actual,
+                     const std::set<uint32_t>& expected) {
+      EXPECT_EQ(expected.size(), actual.size());
+      EXPECT_EQ(toVector(expected), toVector(actual));
+      EXPECT_EQ(makeBitmap(expected, false), actual);
+    };
+    check(x | y, apply(a, b, [](auto... args) {
+            return std::set_union(args...);
+          }));
+    check(x & y, apply(a, b, [](auto... args) {
+            return std::set_intersection(args...);
+          }));
+    check(x - y, apply(a, b, [](auto... args) {
+            return std::set_difference(args...);
+          }));
+    check(x ^ y, apply(a, b, [](auto... args) {
+            return std::set_symmetric_difference(args...);
+          }));
+    EXPECT_EQ((x & y).size(), RoaringBitmap::intersectionSize(x, y));
+  }
+}
+
+TEST(RoaringBitmap, selfOperations) {
+  RoaringBitmap set{1, 2, 3, 1 << 20};
+  auto const copy = set;
+  set |= set;
+  EXPECT_EQ(copy, set);
+  set &= set;
+  EXPECT_EQ(copy, set);
+  set ^= set;
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(RoaringBitmap, forEach) {
+  RoaringBitmap set;
+  set.insertRange(100, 200);
+  for (uint32_t i = 0; i < 5000; ++i) {
+    set.insert((1 << 16) + i * 7);
+  }
+  set.insert(1 << 30);
+  std::vector<uint32_t> values;
+  set.forEach([&](uint32_t value) { values.push_back(value); });
+  EXPECT_EQ(toVector(set), values);
+}
+
+TEST(RoaringBitmap, serializeFormat) {
+  // From the format specification: the cookie 12346, the number of
+  // containers, a key and cardinality - 1, an offset, and the values.
+  std::vector<uint8_t> const noRuns = {
+      0x3a, 0x30, 0, 0, 1, 0, 0, 0, 0, 0, 2, 0, 16, 0, 0, 0, 1, 0, 2, 0, 3, 0};
+  RoaringBitmap set{1, 2, 3};
+  EXPECT_EQ(noRuns.size(), set.serializedSize());
+  auto buf = set.serialize();
+  EXPECT_EQ(noRuns, std::vector<uint8_t>(buf->data(), buf->tail()));
+  EXPECT_EQ(set, RoaringBitmap::deserialize(range(noRuns)));
+
+  // The cookie 12347 with the number of containers - 1, the bitset of the
+  // run containers, a key and cardinality - 1, and the runs.
+  std::vector<uint8_t> const runs = {
+      0x3b, 0x30, 0, 0, 1, 0, 0, 99, 0, 1, 0, 0, 0, 99, 0};
+  set.clear();
+  set.insertRange(0, 100);
+  EXPECT_EQ(runs.size(), set.serializedSize());
+  buf = set.serialize();
+  EXPECT_EQ(runs, std::vector<uint8_t>(buf->data(), buf->tail()));
+  EXPECT_EQ(set, RoaringBitmap::deserialize(range(runs)));
+}
+
+TEST(RoaringBitmap, serializeRoundTrip) {
+  std::mt19937 rng(7);
+  for (int iter = 0; iter < 10; ++iter) {
+    auto const set = makeBitmap(makeRandomSet(rng), iter % 2);
+    auto buf = set.serialize();
+    EXPECT_EQ(set.serializedSize(), buf->computeChainDataLength());
+    auto copy = RoaringBitmap::deserialize(buf->coalesce());
+    EXPECT_EQ(set, copy);
+    EXPECT_EQ(toVector(set), toVector(copy));
+  }
+
+  // Appending to a chain, and reading from it.
+  IOBuf chain;
+  io::Appender out(&chain, 100);
+  RoaringBitmap{1, 2}.serialize(out);
+  RoaringBitmap{3}.serialize(out);
+  io::Cursor cursor(&chain);
+  EXPECT_EQ((RoaringBitmap{1, 2}), RoaringBitmap::deserialize(cursor));
+  EXPECT_EQ((RoaringBitmap{3}), RoaringBitmap::deserialize(cursor));
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
+TEST(RoaringBitmap, deserializeInvalid) {
+  std::vector<uint8_t> bytes = {
+      0x3a, 0x30, 0, 0, 1, 0, 0, 0, 0, 0, 2, 0, 16, 0, 0, 0, 1, 0, 2, 0, 3, 0};
+  // Truncated.
+  EXPECT_THROW(
+      RoaringBitmap::deserialize(range(bytes).subpiece(0, 20)),
+      std::out_of_range);
+  // Unsorted array.
+  auto unsorted = bytes;
+  unsorted[18] = 1;
+  EXPECT_THROW(
+      RoaringBitmap::deserialize(range(unsorted)), std::invalid_argument);
+  // Unknown cookie.
+  auto cookie = bytes;
+  cookie[0] = 0;
+  EXPECT_THROW(
+      RoaringBitmap::deserialize(range(cookie)), std::invalid_argument);
+  // Overlapping runs.
+  std::vector<uint8_t> const runs = {
+      0x3b, 0x30, 0, 0, 1, 0, 0, 9, 0, 2, 0, 0, 0, 4, 0, 3, 0, 4, 0};
+  EXPECT_THROW(RoaringBitmap::deserialize(range(runs)), std::invalid_argument);
+}
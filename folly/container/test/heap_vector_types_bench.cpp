@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares lookups in heap_vector_map (eytzinger order) and
+// sorted_vector_map (binary search) with random keys, half of them present,
+// from containers that fit in L1 to ones much larger than the LLC.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/container/heap_vector_types.h>
+#include <folly/init/Init.h>
+#include <folly/sorted_vector_types.h>
+
+using namespace folly;
+
+namespace {
+
+constexpr size_t kLookups = 1 << 16;
+
+template <typename Map>
+Map makeMap(size_t size) {
+  std::vector<typename Map::value_type> values;
+  values.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    values.emplace_back(2 * i, i);
+  }
+  return Map(sorted_unique, std::move(values));
+}
+
+std::vector<uint64_t> makeKeys(size_t size) {
+  std::vector<uint64_t> keys(kLookups);
+  for (auto& key : keys) {
+    key = Random::rand64(2 * size);
+  }
+  return keys;
+}
+
+template <typename Map, typename Lookup>
+void runLookups(size_t iters, size_t size, Lookup lookup) {
+  Map map;
+  std::vector<uint64_t> keys;
+  BENCHMARK_SUSPEND {
+    map = makeMap<Map>(size);
+    keys = makeKeys(size);
+  }
+  size_t found = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    found += lookup(map, keys[i % kLookups]);
+  }
+  doNotOptimizeAway(found);
+}
+
+template <typename Map>
+void find(size_t iters, size_t size) {
+  runLookups<Map>(iters, size, [](Map const& map, uint64_t key) {
+    return map.find(key) != map.end();
+  });
+}
+
+template <typename Map>
+void lowerBound(size_t iters, size_t size) {
+  runLookups<Map>(iters, size, [](Map const& map, uint64_t key) {
+    return map.lower_bound(key) != map.end();
+  });
+}
+
+void sortedFind(size_t iters, size_t size) {
+  find<sorted_vector_map<uint64_t, uint64_t>>(iters, size);
+}
+
+void heapFind(size_t iters, size_t size) {
+  find<heap_vector_map<uint64_t, uint64_t>>(iters, size);
+}
+
+void sortedFind32(size_t iters, size_t size) {
+  find<sorted_vector_map<uint32_t, uint32_t>>(iters, size);
+}
+
+void heapFind32(size_t iters, size_t size) {
+  find<heap_vector_map<uint32_t, uint32_t>>(iters, size);
+}
+
+void sortedLowerBound(size_t iters, size_t size) {
+  lowerBound<sorted_vector_map<uint64_t, uint64_t>>(iters, size);
+}
+
+void heapLowerBound(size_t iters, size_t size) {
+  lowerBound<heap_vector_map<uint64_t, uint64_t>>(iters, size);
+}
+
+} // namespace
+
+#define BENCH_SIZE(size)                         \
+  BENCHMARK_PARAM(sortedFind, size)              \
+  BENCHMARK_RELATIVE_PARAM(heapFind, size)       \
+  BENCHMARK_PARAM(sortedFind32, size)            \
+  BENCHMARK_RELATIVE_PARAM(heapFind32, size)     \
+  BENCHMARK_PARAM(sortedLowerBound, size)        \
+  BENCHMARK_RELATIVE_PARAM(heapLowerBound, size) \
+  BENCHMARK_DRAW_LINE();
+
+BENCH_SIZE(1000)
+BENCH_SIZE(100000)
+BENCH_SIZE(1000000)
+BENCH_SIZE(10000000)
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  runBenchmarks();
+  return 0;
+}
@@ -19,6 +19,7 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <list>
 #include <memory>
 #include <numeric>
 #include <sstream>
@@ -30,6 +31,7 @@
 #include <fmt/format.h>
 
 #include <folly/Conv.h>
+#include <folly/Range.h>
 #include <folly/Traits.h>
 #include <folly/container/Iterator.h>
 #include <folly/portability/GTest.h>
@@ -1596,3 +1598,95 @@ TEST(smallVector, comparisons) {
   EXPECT_EQ(vec2 <=> vec1, std::strong_ordering::greater);
 #endif
 }
+
+namespace {
+// Counts the moves and destructions, which relocation must not do.
+struct RelocatableCounter {
+  using IsRelocatable = std::true_type;
+
+  static int moves;
+  static int destructions;
+
+  explicit RelocatableCounter(int v) : value(std::make_unique<int>(v)) {}
+  RelocatableCounter(RelocatableCounter&& other) noexcept
+      : value(std::move(other.value)) {
+    ++moves;
+  }
+  RelocatableCounter& operator=(RelocatableCounter&& other) noexcept {
+    value = std::move(other.value);
+    ++moves;
+    return *this;
+  }
+  ~RelocatableCounter() { ++destructions; }
+
+  std::unique_ptr<int> value;
+};
+
+int RelocatableCounter::moves = 0;
+int RelocatableCounter::destructions = 0;
+} // namespace
+
+TEST(smallVector, growthRelocates) {
+  static_assert(!std::is_trivially_copyable_v<RelocatableCounter>);
+  RelocatableCounter::moves = 0;
+  RelocatableCounter::destructions = 0;
+  {
+    small_vector<RelocatableCounter, 2> vec;
+    for (int i = 0; i < 100; ++i) {
+      vec.emplace_back(i);
+    }
+    vec.reserve(1000);
+    EXPECT_EQ(0, RelocatableCounter::moves);
+    EXPECT_EQ(0, RelocatableCounter::destructions);
+    vec.emplace(vec.begin() + 50, -1);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(i, *vec[i < 50 ? i : i + 1].value);
+    }
+    EXPECT_EQ(-1, *vec[50].value);
+  }
+  // Only the insertion in the middle moves elements, through a temporary.
+  EXPECT_EQ(1 + 101, RelocatableCounter::destructions);
+  EXPECT_EQ(51, RelocatableCounter::moves);
+
+  using Strings = small_vector<std::string, 1>;
+  static_assert(folly::IsRelocatable<small_vector<int, 2>>::value);
+  small_vector<Strings, 1> nested;
+  for (int i = 0; i < 100; ++i) {
+    nested.push_back(Strings(i % 3, std::string(30, 'a' + i % 26)));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(Strings(i % 3, std::string(30, 'a' + i % 26)), nested[i]);
+  }
+}
+
+TEST(smallVector, appendRange) {
+  small_vector<std::string, 2> vec = {"a"};
+  std::vector<std::string> strings = {"b", "c", "d"};
+  vec.append_range(strings);
+  EXPECT_EQ((small_vector<std::string, 2>{"a", "b", "c", "d"}), vec);
+  auto const capacity = vec.capacity();
+  vec.append_range(std::vector<std::string>{});
+  EXPECT_EQ(capacity, vec.capacity());
+
+  std::list<std::string> list = {"e", "f"};
+  vec.append_range(list);
+  EXPECT_EQ(6, vec.size());
+  EXPECT_EQ("f", vec.back());
+
+  std::istringstream in("1 2 3");
+  small_vector<int, 2> ints;
+  ints.append_range(folly::range(
+      std::istream_iterator<int>(in), std::istream_iterator<int>()));
+  EXPECT_EQ((small_vector<int, 2>{1, 2, 3}), ints);
+
+  small_vector<int, 4, policy_in_situ_only<true>> inSitu = {1, 2, 3};
+  EXPECT_THROW(inSitu.append_range(std::vector<int>{4, 5}), std::length_error);
+  EXPECT_EQ(3, inSitu.size());
+
+  std::array<MaybeThrowOnCopy, 3> arr = {
+      MaybeThrowOnCopy{false}, MaybeThrowOnCopy{true}, MaybeThrowOnCopy{false}};
+  small_vector<MaybeThrowOnCopy, 1> throwing;
+  throwing.emplace_back(false);
+  EXPECT_THROW(throwing.append_range(arr), std::runtime_error);
+  EXPECT_EQ(1, throwing.size());
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/soa_vector.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+namespace {
+
+// A record of a typical scoring kernel, of which the loops only read a few
+// fields.
+struct Record {
+  float score;
+  float weight;
+  uint64_t id;
+  uint32_t flags;
+  uint32_t count;
+};
+
+using Records = folly::soa_vector<float, float, uint64_t, uint32_t, uint32_t>;
+
+constexpr size_t kSize = 1 << 16;
+
+struct Data {
+  Data() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist;
+    for (size_t i = 0; i < kSize; ++i) {
+      Record r{dist(rng), dist(rng), rng(), uint32_t(rng()), 0};
+      aos.push_back(r);
+      soa.emplace_back(r.score, r.weight, r.id, r.flags, r.count);
+    }
+  }
+
+  std::vector<Record> aos;
+  Records soa;
+};
+
+Data& data() {
+  static Data d;
+  return d;
+}
+
+float weightedSumAos(std::vector<Record> const& records) {
+  float sum = 0;
+  for (auto const& r : records) {
+    sum += r.score * r.weight;
+  }
+  return sum;
+}
+
+float weightedSumSoa(Records const& records) {
+  auto scores = records.field<0>();
+  auto weights = records.field<1>();
+  float sum = 0;
+  for (size_t i = 0; i < scores.size(); ++i) {
+    sum += scores[i] * weights[i];
+  }
+  return sum;
+}
+
+void scaleAos(std::vector<Record>& records, float factor) {
+  for (auto& r : records) {
+    r.score *= factor;
+  }
+}
+
+void scaleSoa(Records& records, float factor) {
+  for (auto& score : records.field<0>()) {
+    score *= factor;
+  }
+}
+
+} // namespace
+
+BENCHMARK(WeightedSumAos, iters) {
+  auto const& records = data().aos;
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(weightedSumAos(records));
+  }
+}
+
+BENCHMARK_RELATIVE(WeightedSumSoa, iters) {
+  auto const& records = data().soa;
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(weightedSumSoa(records));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ScaleAos, iters) {
+  auto& records = data().aos;
+  for (size_t i = 0; i < iters; ++i) {
+    scaleAos(records, i % 2 ? 2.f : 0.5f);
+    folly::doNotOptimizeAway(records[0].score);
+  }
+}
+
+BENCHMARK_RELATIVE(ScaleSoa, iters) {
+  auto& records = data().soa;
+  for (size_t i = 0; i < iters; ++i) {
+    scaleSoa(records, i % 2 ? 2.f : 0.5f);
+    folly::doNotOptimizeAway(records.data<0>()[0]);
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(PushBackAos, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    std::vector<Record> records;
+    for (uint32_t j = 0; j < 1000; ++j) {
+      records.push_back({1.f, 2.f, j, j, j});
+    }
+    folly::doNotOptimizeAway(records.data());
+  }
+}
+
+BENCHMARK_RELATIVE(PushBackSoa, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    Records records;
+    for (uint32_t j = 0; j < 1000; ++j) {
+      records.emplace_back(1.f, 2.f, j, j, j);
+    }
+    folly::doNotOptimizeAway(records.data<0>());
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
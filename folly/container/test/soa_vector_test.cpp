@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/soa_vector.h>
+
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/algorithm/simd/Contains.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+template <std::size_t I, typename V>
+bool isAligned(V const& v) {
+  return reinterpret_cast<std::uintptr_t>(v.template data<I>()) %
+      V::kAlignment ==
+      0;
+}
+
+// Not relocatable, and throws when copied from a negative value.
+struct Tracked {
+  static int live;
+
+  explicit Tracked(int v) : value(v), self(this) { ++live; }
+  Tracked(Tracked const& other) : value(other.value), self(this) {
+    if (other.value < 0) {
+      throw std::runtime_error("negative");
+    }
+    ++live;
+  }
+  Tracked(Tracked&& other) noexcept : value(other.value), self(this) {
+    ++live;
+  }
+  ~Tracked() {
+    EXPECT_EQ(this, self);
+    --live;
+  }
+
+  friend bool operator==(Tracked const& a, Tracked const& b) {
+    return a.value == b.value;
+  }
+
+  int value;
+  Tracked* self;
+};
+
+int Tracked::live = 0;
+
+} // namespace
+
+TEST(soa_vector, basic) {
+  soa_vector<float, std::string, uint8_t> v;
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(0, v.capacity());
+  EXPECT_EQ(nullptr, v.data<0>());
+
+  for (int i = 0; i < 100; ++i) {
+    auto ref = v.emplace_back(i * 0.5f, std::to_string(i), uint8_t(i));
+    EXPECT_EQ(std::to_string(i), std::get<1>(ref));
+  }
+  EXPECT_EQ(100, v.size());
+  EXPECT_GE(v.capacity(), 100);
+  for (int i = 0; i < 100; ++i) {
+    auto [f, s, b] = v[i];
+    EXPECT_EQ(i * 0.5f, f);
+    EXPECT_EQ(std::to_string(i), s);
+    EXPECT_EQ(uint8_t(i), b);
+  }
+  EXPECT_TRUE(isAligned<0>(v));
+  EXPECT_TRUE(isAligned<1>(v));
+  EXPECT_TRUE(isAligned<2>(v));
+
+  EXPECT_EQ("0", std::get<1>(v.front()));
+  EXPECT_EQ("99", std::get<1>(v.back()));
+  EXPECT_EQ("42", std::get<1>(v.at(42)));
+  EXPECT_THROW(v.at(100), std::out_of_range);
+
+  v.pop_back();
+  EXPECT_EQ(99, v.size());
+  v.resize(10);
+  EXPECT_EQ(10, v.size());
+  v.resize(12);
+  EXPECT_EQ(std::make_tuple(0.f, std::string(), uint8_t(0)), v[11]);
+  v.shrink_to_fit();
+  EXPECT_EQ(12, v.capacity());
+  v.clear();
+  EXPECT_TRUE(v.empty());
+  v.shrink_to_fit();
+  EXPECT_EQ(0, v.capacity());
+}
+
+TEST(soa_vector, proxyReferences) {
+  soa_vector<int, std::string> v = {{1, "a"}, {2, "b"}};
+  v[0] = std::make_tuple(3, "c");
+  std::get<1>(v[1]) += "d";
+  auto [i, s] = v[1];
+  i = 4;
+  EXPECT_EQ((soa_vector<int, std::string>{{3, "c"}, {4, "bd"}}), v);
+
+  std::tuple<int, std::string> value = v[0];
+  EXPECT_EQ(std::make_tuple(3, std::string("c")), value);
+
+  std::vector<std::tuple<int, std::string>> records(v.begin(), v.end());
+  EXPECT_EQ(2, records.size());
+  EXPECT_EQ("bd", std::get<1>(records[1]));
+
+  auto const& cv = v;
+  EXPECT_EQ(2, cv.end() - cv.begin());
+  soa_vector<int, std::string>::const_iterator it = v.begin();
+  EXPECT_EQ(3, std::get<0>(*it));
+  EXPECT_EQ(4, std::get<0>(it[1]));
+  EXPECT_EQ(cv.end(), it + 2);
+  int sum = 0;
+  for (auto [n, str] : v) {
+    sum += n;
+  }
+  EXPECT_EQ(7, sum);
+}
+
+TEST(soa_vector, fields) {
+  soa_vector<int64_t, double> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.emplace_back(i, i * 2.0);
+  }
+  for (auto& x : v.field<1>()) {
+    x += 1;
+  }
+  auto ints = v.field<0>();
+  EXPECT_EQ(999 * 1000 / 2, std::accumulate(ints.begin(), ints.end(), 0));
+  auto const& cv = v;
+  auto doubles = cv.field<1>();
+  EXPECT_EQ(1000, doubles.size());
+  EXPECT_EQ(3.0, doubles[1]);
+}
+
+TEST(soa_vector, simd) {
+  soa_vector<uint32_t, uint8_t> v;
+  for (uint32_t i = 0; i < 300; ++i) {
+    v.emplace_back(i * 3, uint8_t(i % 200));
+  }
+  EXPECT_TRUE(simd::contains(v.field<0>(), 597u));
+  EXPECT_FALSE(simd::contains(v.field<0>(), 598u));
+  EXPECT_TRUE(simd::contains(v.field<1>(), uint8_t(199)));
+  EXPECT_FALSE(simd::contains(v.field<1>(), uint8_t(200)));
+}
+
+TEST(soa_vector, append) {
+  soa_vector<int, std::string> v;
+  v.emplace_back(0, "zero");
+  std::vector<int> ints = {1, 2, 3};
+  std::vector<std::string> strings = {"one", "two", "three"};
+  v.append(ints, strings);
+  EXPECT_EQ(4, v.size());
+  EXPECT_EQ(std::make_tuple(3, std::string("three")), v[3]);
+
+  auto const capacity = v.capacity();
+  v.append({}, {});
+  EXPECT_EQ(4, v.size());
+  EXPECT_EQ(capacity, v.capacity());
+
+  strings.pop_back();
+  EXPECT_THROW(v.append(ints, strings), std::invalid_argument);
+  EXPECT_EQ(4, v.size());
+
+  // Grows geometrically.
+  soa_vector<int, std::string> w;
+  int reallocations = 0;
+  for (int i = 0; i < 1000; ++i) {
+    auto const before = w.data<0>();
+    w.append(ints, {strings.data(), 3});
+    reallocations += before != w.data<0>();
+  }
+  EXPECT_EQ(3000, w.size());
+  EXPECT_LT(reallocations, 20);
+}
+
+TEST(soa_vector, growthMovesNonRelocatable) {
+  static_assert(!IsRelocatable<Tracked>::value);
+  {
+    soa_vector<Tracked, int> v;
+    for (int i = 0; i < 100; ++i) {
+      v.emplace_back(Tracked(i), i);
+    }
+    EXPECT_EQ(100, Tracked::live);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(i, std::get<0>(v[i]).value);
+      EXPECT_EQ(&std::get<0>(v[i]), std::get<0>(v[i]).self);
+    }
+    v.reserve(1000);
+    v.shrink_to_fit();
+    EXPECT_EQ(100, Tracked::live);
+  }
+  EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(soa_vector, exceptionSafety) {
+  {
+    soa_vector<Tracked, Tracked> v;
+    v.emplace_back(Tracked(1), Tracked(2));
+    Tracked good(3);
+    Tracked bad(-1);
+    // The second field throws, so the first one is destroyed.
+    EXPECT_THROW(v.emplace_back(good, bad), std::runtime_error);
+    EXPECT_EQ(1, v.size());
+    EXPECT_EQ(4, Tracked::live);
+    // Also when growing.
+    v.shrink_to_fit();
+    EXPECT_THROW(v.emplace_back(good, bad), std::runtime_error);
+    EXPECT_EQ(1, v.size());
+    EXPECT_EQ(1, v.capacity());
+    EXPECT_EQ(4, Tracked::live);
+
+    std::vector<Tracked> firsts;
+    firsts.emplace_back(4);
+    firsts.emplace_back(5);
+    std::vector<Tracked> seconds;
+    seconds.emplace_back(6);
+    seconds.emplace_back(-1);
+    EXPECT_THROW(v.append(firsts, seconds), std::runtime_error);
+    EXPECT_EQ(1, v.size());
+    EXPECT_EQ(8, Tracked::live);
+
+    v.emplace_back(Tracked(7), Tracked(-2));
+    using Vector = soa_vector<Tracked, Tracked>;
+    EXPECT_THROW(Vector{v}, std::runtime_error);
+    EXPECT_EQ(10, Tracked::live);
+  }
+  EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(soa_vector, emplaceBackAliasing) {
+  soa_vector<std::string, int> v;
+  v.emplace_back(std::string(100, 'a'), 1);
+  v.shrink_to_fit();
+  for (int i = 0; i < 10; ++i) {
+    // Arguments referring to the vector survive the growth.
+    v.emplace_back(std::get<0>(v.back()), std::get<1>(v.back()) + 1);
+  }
+  EXPECT_EQ(11, v.size());
+  EXPECT_EQ(std::string(100, 'a'), std::get<0>(v.back()));
+  EXPECT_EQ(11, std::get<1>(v.back()));
+}
+
+TEST(soa_vector, copyAndMove) {
+  soa_vector<int, std::string> v = {{1, "a"}, {2, "b"}, {3, "c"}};
+  auto copy = v;
+  EXPECT_EQ(v, copy);
+  std::get<1>(copy[0]) = "z";
+  EXPECT_NE(v, copy);
+
+  auto moved = std::move(copy);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(0, copy.capacity());
+  EXPECT_EQ("z", std::get<1>(moved[0]));
+
+  copy = moved;
+  EXPECT_EQ(moved, copy);
+  copy = std::move(v);
+  EXPECT_EQ("a", std::get<1>(copy[0]));
+
+  swap(copy, moved);
+  EXPECT_EQ("z", std::get<1>(copy[0]));
+  EXPECT_EQ("a", std::get<1>(moved[0]));
+
+  soa_vector<int, std::string> sized(5);
+  EXPECT_EQ(5, sized.size());
+  EXPECT_EQ(std::make_tuple(0, std::string()), sized[4]);
+}
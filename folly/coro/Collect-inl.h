@@ -70,8 +70,19 @@ std::vector<RTask> collectMakeInnerTaskVec(InputRange& awaitables, Make& make) {
   return tasks;
 }
 
+// Variadic collect functions of up to kMaxInlineCollectSize awaitables keep
+// the frames of their BarrierTasks in their own frame, so that starting the
+// tasks doesn't allocate. Most of these frames are well under 256 bytes.
+constexpr std::size_t kMaxInlineCollectSize = 8;
+constexpr std::size_t kInlineBarrierTaskFrameSize = 256;
+
+template <std::size_t N>
+using CollectBarrierTaskArena = InlineBarrierTaskArena<
+    N <= kMaxInlineCollectSize ? N * kInlineBarrierTaskFrameSize : 0>;
+
 template <typename SemiAwaitable, typename Result>
 BarrierTask makeCollectAllTryTask(
+    BarrierTaskArena&,
     Executor::KeepAlive<> executor,
     const CancellationToken& cancelToken,
     SemiAwaitable&& awaitable,
@@ -109,8 +120,10 @@ auto collectAllTryImpl(
 
     std::tuple<collect_all_try_component_t<SemiAwaitables>...> results;
 
+    CollectBarrierTaskArena<sizeof...(SemiAwaitables)> arena;
     folly::coro::detail::BarrierTask tasks[sizeof...(SemiAwaitables)] = {
         makeCollectAllTryTask(
+            arena,
             executor.get_alias(),
             cancelToken,
             static_cast<SemiAwaitables&&>(awaitables),
@@ -163,7 +176,9 @@ auto collectAllImpl(
 
     exception_wrapper firstException;
 
-    auto makeTask = [&](auto&& awaitable, auto& result) -> BarrierTask {
+    auto makeTask = [&](BarrierTaskArena&,
+                        auto&& awaitable,
+                        auto& result) -> BarrierTask {
       using await_result = semi_await_result_t<decltype(awaitable)>;
       try {
         if constexpr (std::is_void_v<await_result>) {
@@ -188,8 +203,10 @@ auto collectAllImpl(
 
     std::tuple<collect_all_try_component_t<SemiAwaitables>...> results;
 
+    CollectBarrierTaskArena<sizeof...(SemiAwaitables)> arena;
     folly::coro::detail::BarrierTask tasks[sizeof...(SemiAwaitables)] = {
         makeTask(
+            arena,
             static_cast<SemiAwaitables&&>(awaitables),
             std::get<Indices>(results))...,
     };
@@ -310,6 +327,7 @@ auto collectAnyImpl(
     -> folly::coro::Task<std::pair<
         std::size_t,
         folly::Try<collect_any_component_t<SemiAwaitables...>>>> {
+  const Executor::KeepAlive<> executor = co_await co_current_executor;
   const CancellationToken& parentCancelToken =
       co_await co_current_cancellation_token;
   const CancellationSource cancelSource;
@@ -319,19 +337,49 @@ auto collectAnyImpl(
   std::pair<std::size_t, folly::Try<collect_any_component_t<SemiAwaitables...>>>
       firstCompletion;
   firstCompletion.first = size_t(-1);
-  co_await folly::coro::collectAll(folly::coro::co_withCancellation(
-      cancelToken,
-      folly::coro::co_invoke(
-          [&, aw = static_cast<SemiAwaitables&&>(awaitables)]() mutable
-          -> folly::coro::Task<void> {
-            auto result = co_await folly::coro::co_awaitTry(
-                static_cast<SemiAwaitables&&>(aw));
-            if (!cancelSource.requestCancellation()) {
-              // This is first entity to request cancellation.
-              firstCompletion.first = Indices;
-              firstCompletion.second = std::move(result);
-            }
-          }))...);
+
+  // Await each awaitable in a BarrierTask, rather than in a Task passed to
+  // collectAll(), so that its frame comes from the arena.
+  auto makeTask = [&](BarrierTaskArena&,
+                      auto&& awaitable,
+                      std::size_t index) -> BarrierTask {
+    auto result = co_await co_viaIfAsync(
+        executor.get_alias(),
+        co_withCancellation(
+            cancelToken,
+            co_awaitTry(static_cast<decltype(awaitable)>(awaitable))));
+    if (!cancelSource.requestCancellation()) {
+      // This is first entity to request cancellation.
+      firstCompletion.first = index;
+      firstCompletion.second = std::move(result);
+    }
+  };
+
+  CollectBarrierTaskArena<sizeof...(SemiAwaitables)> arena;
+  folly::coro::detail::BarrierTask tasks[sizeof...(SemiAwaitables)] = {
+      makeTask(arena, static_cast<SemiAwaitables&&>(awaitables), Indices)...,
+  };
+
+  folly::coro::detail::Barrier barrier{sizeof...(SemiAwaitables) + 1};
+
+  // Save the initial context and restore it after starting each task
+  // as the task may have modified the context before suspending and we
+  // want to make sure the next task is started with the same initial
+  // context.
+  const auto context = RequestContext::saveContext();
+
+  auto& asyncFrame = co_await detail::co_current_async_stack_frame;
+
+  // Use std::initializer_list to ensure that the sub-tasks are launched
+  // in the order they appear in the parameter pack.
+  (void)std::initializer_list<int>{(
+      tasks[Indices].start(&barrier, asyncFrame),
+      RequestContext::setContext(context),
+      0)...};
+
+  // Wait for all of the sub-tasks to finish execution. The sub-tasks have
+  // already transitioned to the right executor through co_viaIfAsync().
+  co_await UnsafeResumeInlineSemiAwaitable{barrier.arriveAndWait()};
 
   co_return firstCompletion;
 }
@@ -99,6 +99,9 @@ class MoveRange {
 // point. This means that awaiting multiple sub-tasks that all complete
 // synchronously will still execute them sequentially on the current thread.
 //
+// With up to 8 input awaitables, the coroutines awaiting them are allocated
+// as part of the collectAll() coroutine, rather than each on the heap.
+//
 // If any of the input operations complete with an exception then it will
 // request cancellation of any outstanding tasks and the whole collectAll()
 // operation will complete with an exception once all of the operations
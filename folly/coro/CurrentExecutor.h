@@ -22,6 +22,7 @@
 #include <folly/coro/Coroutine.h>
 #include <folly/coro/ViaIfAsync.h>
 #include <folly/coro/WithAsyncStack.h>
+#include <folly/executors/TimeSlice.h>
 #include <folly/io/async/Request.h>
 
 #if FOLLY_HAS_COROUTINES
@@ -59,15 +60,20 @@ namespace detail {
 class co_reschedule_on_current_executor_ {
   class AwaiterBase {
    public:
-    explicit AwaiterBase(folly::Executor::KeepAlive<> executor) noexcept
-        : executor_(std::move(executor)) {}
+    explicit AwaiterBase(
+        folly::Executor::KeepAlive<> executor, bool onlyIfShouldYield) noexcept
+        : executor_(std::move(executor)),
+          onlyIfShouldYield_(onlyIfShouldYield) {}
 
-    bool await_ready() noexcept { return false; }
+    bool await_ready() noexcept {
+      return onlyIfShouldYield_ && !folly::shouldYield();
+    }
 
     void await_resume() noexcept {}
 
    protected:
     folly::Executor::KeepAlive<> executor_;
+    bool onlyIfShouldYield_;
   };
 
  public:
@@ -112,14 +118,24 @@ class co_reschedule_on_current_executor_ {
 
     friend StackAwareAwaiter tag_invoke(
         cpo_t<co_withAsyncStack>, Awaiter awaiter) {
-      return StackAwareAwaiter{std::move(awaiter.executor_)};
+      return StackAwareAwaiter{
+          std::move(awaiter.executor_), awaiter.onlyIfShouldYield_};
     }
   };
 
   friend Awaiter co_viaIfAsync(
       folly::Executor::KeepAlive<> executor,
       co_reschedule_on_current_executor_) {
-    return Awaiter{std::move(executor)};
+    return Awaiter{std::move(executor), /* onlyIfShouldYield */ false};
+  }
+};
+
+class co_reschedule_if_should_yield_ {
+ public:
+  friend co_reschedule_on_current_executor_::Awaiter co_viaIfAsync(
+      folly::Executor::KeepAlive<> executor, co_reschedule_if_should_yield_) {
+    return co_reschedule_on_current_executor_::Awaiter{
+        std::move(executor), /* onlyIfShouldYield */ true};
   }
 };
 
@@ -148,6 +164,22 @@ using co_reschedule_on_current_executor_t =
 inline constexpr co_reschedule_on_current_executor_t
     co_reschedule_on_current_executor;
 
+using co_reschedule_if_should_yield_t = detail::co_reschedule_if_should_yield_;
+
+// Same as co_reschedule_on_current_executor, but only reschedules when the
+// time slice granted by the executor has expired, see folly::shouldYield() in
+// folly/executors/TimeSlice.h. Otherwise the coroutine continues without
+// suspending.
+//
+// Example:
+//   folly::coro::Task<void> doCpuIntensiveWork() {
+//     for (int i = 0; i < 1'000'000; ++i) {
+//       co_await folly::coro::co_reschedule_if_should_yield;
+//       doSomeWork(i);
+//     }
+//   }
+inline constexpr co_reschedule_if_should_yield_t co_reschedule_if_should_yield;
+
 namespace detail {
 struct co_current_cancellation_token_ {
   enum class secret_ { token_ };
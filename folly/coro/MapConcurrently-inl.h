@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+#include <memory>
+
+#include <folly/CancellationToken.h>
+#include <folly/Executor.h>
+#include <folly/ScopeGuard.h>
+#include <folly/coro/Baton.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/Merge.h>
+#include <folly/coro/Mutex.h>
+#include <folly/coro/Task.h>
+#include <folly/coro/ViaIfAsync.h>
+#include <folly/coro/WithCancellation.h>
+#include <folly/coro/detail/Barrier.h>
+#include <folly/coro/detail/BarrierTask.h>
+#include <folly/coro/detail/CurrentAsyncFrame.h>
+#include <folly/coro/detail/Helpers.h>
+#include <folly/io/async/Request.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+namespace detail {
+
+// Works like mergeImpl(): worker tasks publish their results to the output
+// stream one at a time, through a CallbackRecord, and wait for the consumer
+// to take each before going on. There are 'maxConcurrency' workers, each of
+// which pulls a value from the source, transforms it, and publishes the
+// result, so there are never more than 'maxConcurrency' values in flight.
+template <
+    bool Ordered,
+    typename Result,
+    typename TransformFn,
+    typename Reference,
+    typename Value>
+AsyncGenerator<Result&&> mapConcurrentlyImpl(
+    AsyncGenerator<Reference, Value> source,
+    TransformFn transformFn,
+    std::size_t maxConcurrency) {
+  static_assert(
+      !std::is_void_v<Result>, "transformFn must produce a value to yield");
+  assert(maxConcurrency > 0);
+
+  struct SharedState {
+    SharedState(
+        folly::Executor::KeepAlive<> executor_,
+        AsyncGenerator<Reference, Value>&& source_,
+        TransformFn&& transformFn_,
+        std::size_t numTurns_)
+        : executor(std::move(executor_)),
+          source(std::move(source_)),
+          transformFn(std::move(transformFn_)),
+          turns(numTurns_ > 0 ? new coro::Baton[numTurns_] : nullptr),
+          numTurns(numTurns_) {}
+
+    void cancel() noexcept {
+      cancelSource.requestCancellation();
+      // Wake up the workers waiting for their turn, so that they notice.
+      for (std::size_t i = 0; i < numTurns; ++i) {
+        turns[i].post();
+      }
+    }
+
+    const folly::Executor::KeepAlive<> executor;
+    const folly::CancellationSource cancelSource;
+
+    // Guarded by sourceMutex.
+    coro::Mutex sourceMutex;
+    AsyncGenerator<Reference, Value> source;
+    TransformFn transformFn;
+    bool sourceDone{false};
+    std::size_t nextIndex{0};
+
+    // Only used when Ordered: the worker transforming the i-th value waits
+    // for turns[i % numTurns] before publishing its result. At most numTurns
+    // values are in flight, so no two of them wait for the same baton.
+    const std::unique_ptr<coro::Baton[]> turns;
+    const std::size_t numTurns;
+
+    coro::Mutex mutex;
+    coro::Baton recordPublished;
+    coro::Baton recordConsumed;
+    coro::Baton allTasksCompleted;
+    detail::CallbackRecord<Result> record;
+  };
+
+  auto makeConsumerTask = [](std::shared_ptr<SharedState> state,
+                             std::size_t numWorkers) -> Task<void> {
+    auto makeWorkerTask =
+        [](std::shared_ptr<SharedState> state_) -> detail::DetachedBarrierTask {
+      exception_wrapper ex;
+      auto cancelToken = state_->cancelSource.getToken();
+      try {
+        while (true) {
+          auto sourceLock = co_await co_viaIfAsync(
+              state_->executor.get_alias(),
+              state_->sourceMutex.co_scoped_lock());
+          if (state_->sourceDone || cancelToken.isCancellationRequested()) {
+            break;
+          }
+          auto item = co_await co_viaIfAsync(
+              state_->executor.get_alias(),
+              co_withCancellation(cancelToken, state_->source.next()));
+          if (!item) {
+            state_->sourceDone = true;
+            break;
+          }
+          const std::size_t index = state_->nextIndex++;
+          // The awaitable may refer to the value, which must then outlive it.
+          Value value(*std::move(item));
+          auto awaitable = invoke(state_->transformFn, std::move(value));
+          sourceLock.unlock();
+
+          Result result = co_await co_viaIfAsync(
+              state_->executor.get_alias(),
+              co_withCancellation(cancelToken, std::move(awaitable)));
+
+          if constexpr (Ordered) {
+            auto& turn = state_->turns[index % state_->numTurns];
+            co_await co_viaIfAsync(state_->executor.get_alias(), turn);
+            turn.reset();
+          }
+
+          {
+            auto lock = co_await co_viaIfAsync(
+                state_->executor.get_alias(), state_->mutex.co_scoped_lock());
+
+            if (cancelToken.isCancellationRequested()) {
+              // Consumer has detached and doesn't want any more values.
+              // Discard this value.
+              break;
+            }
+
+            // Publish the value.
+            state_->record = detail::CallbackRecord<Result>{
+                detail::callback_record_value, std::move(result)};
+            state_->recordPublished.post();
+
+            // Wait until the consumer is finished with it.
+            co_await co_viaIfAsync(
+                state_->executor.get_alias(), state_->recordConsumed);
+            state_->recordConsumed.reset();
+
+            // Clear the result before releasing the lock.
+            state_->record = {};
+          }
+
+          if constexpr (Ordered) {
+            state_->turns[(index + 1) % state_->numTurns].post();
+          }
+        }
+      } catch (...) {
+        ex = exception_wrapper{current_exception()};
+      }
+
+      if (ex) {
+        state_->cancel();
+
+        auto lock = co_await co_viaIfAsync(
+            state_->executor.get_alias(), state_->mutex.co_scoped_lock());
+        if (!state_->record.hasError()) {
+          state_->record = detail::CallbackRecord<Result>{
+              detail::callback_record_error, std::move(ex)};
+          state_->recordPublished.post();
+        }
+      }
+    };
+
+    detail::Barrier barrier{1};
+
+    auto& asyncFrame = co_await detail::co_current_async_stack_frame;
+
+    // Save the initial context and restore it after starting each task
+    // as the task may have modified the context before suspending and we
+    // want to make sure the next task is started with the same initial
+    // context.
+    const auto context = RequestContext::saveContext();
+
+    for (std::size_t i = 0; i < numWorkers; ++i) {
+      makeWorkerTask(state).start(&barrier, asyncFrame);
+      RequestContext::setContext(context);
+    }
+
+    // Wait for all worker tasks to finish consuming the source.
+    co_await detail::UnsafeResumeInlineSemiAwaitable{barrier.arriveAndWait()};
+
+    // Guaranteed there are no more concurrent producers trying to acquire
+    // the mutex here.
+    if (!state->record.hasError()) {
+      // Stream not yet been terminated with an error.
+      // Terminate the stream with the 'end()' signal.
+      assert(!state->record.hasValue());
+      state->record =
+          detail::CallbackRecord<Result>{detail::callback_record_none};
+      state->recordPublished.post();
+    }
+  };
+
+  const folly::Executor::KeepAlive<> executor = co_await co_current_executor;
+  auto state = std::make_shared<SharedState>(
+      executor,
+      std::move(source),
+      std::move(transformFn),
+      Ordered ? maxConcurrency : 0);
+  if constexpr (Ordered) {
+    state->turns[0].post();
+  }
+
+  SCOPE_EXIT {
+    state->cancel();
+    // Make sure we resume the worker thread so that it has a chance to notice
+    // that cancellation has been requested.
+    state->recordConsumed.post();
+  };
+
+  makeConsumerTask(state, maxConcurrency)
+      .scheduleOn(executor)
+      .start(
+          [state](auto&&) { state->allTasksCompleted.post(); },
+          state->cancelSource.getToken());
+
+  // Consume the results published by the workers.
+  while (true) {
+    if (!state->recordPublished.ready()) {
+      folly::CancellationCallback cb{
+          co_await co_current_cancellation_token, [&] { state->cancel(); }};
+      co_await state->recordPublished;
+    }
+    state->recordPublished.reset();
+
+    if (state->record.hasValue()) {
+      // next value
+      co_yield std::move(state->record).value();
+      state->recordConsumed.post();
+    } else {
+      // We're closing the output stream. In the spirit of structured
+      // concurrency, let's make sure to not leave any background tasks behind.
+      co_await state->allTasksCompleted;
+
+      if (state->record.hasError()) {
+        std::move(state->record).error().throw_exception();
+      } else {
+        // none
+        assert(state->record.hasNone());
+        break;
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+template <
+    typename TransformFn,
+    typename Reference,
+    typename Value,
+    typename Result>
+AsyncGenerator<Result&&> mapConcurrently(
+    AsyncGenerator<Reference, Value> source,
+    TransformFn transformFn,
+    std::size_t maxConcurrency) {
+  return detail::mapConcurrentlyImpl<true, Result>(
+      std::move(source), std::move(transformFn), maxConcurrency);
+}
+
+template <
+    typename TransformFn,
+    typename Reference,
+    typename Value,
+    typename Result>
+AsyncGenerator<Result&&> mapConcurrentlyUnordered(
+    AsyncGenerator<Reference, Value> source,
+    TransformFn transformFn,
+    std::size_t maxConcurrency) {
+  return detail::mapConcurrentlyImpl<false, Result>(
+      std::move(source), std::move(transformFn), maxConcurrency);
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
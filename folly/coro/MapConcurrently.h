@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include <folly/coro/AsyncGenerator.h>
+#include <folly/coro/Coroutine.h>
+#include <folly/coro/Traits.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+namespace detail {
+template <typename TransformFn, typename Value>
+using map_concurrently_result_t = remove_cvref_t<
+    semi_await_result_t<invoke_result_t<TransformFn&, Value&&>>>;
+}
+
+// Transform the values from an input stream with an asynchronous function,
+// running up to 'maxConcurrency' transforms at a time.
+//
+// 'transformFn' is invoked with each Value (as an rvalue) and returns a
+// SemiAwaitable, e.g. a Task, that produces the transformed value. Values are
+// pulled from 'source' only when fewer than 'maxConcurrency' transforms are
+// in flight or waiting for the consumer, so a slow consumer slows down the
+// source instead of buffering without bound.
+//
+// mapConcurrently() yields the results in the order of the input values: a
+// result that is ready early waits for the earlier ones, and keeps its slot
+// meanwhile. mapConcurrentlyUnordered() yields them as they complete.
+//
+// The source and the transforms are awaited on the executor of the coroutine
+// consuming the output stream, so use a multi-threaded executor to run
+// transforms in parallel.
+//
+// On exception or cancellation, cancels the source and the transforms in
+// flight, discards any remaining values, and produces an exception (if the
+// source or a transform produced an exception) or end-of-stream (if next()
+// call was cancelled). As with merge(), if the output stream is destroyed
+// early, the transforms in flight are cancelled and detached.
+//
+// Example:
+//   AsyncGenerator<Request&&> requests();
+//   Task<Response> handle(Request request);
+//
+//   auto responses = mapConcurrently(requests(), handle, 16);
+//   while (auto response = co_await responses.next()) {
+//     ...
+//   }
+template <
+    typename TransformFn,
+    typename Reference,
+    typename Value,
+    typename Result = detail::map_concurrently_result_t<TransformFn, Value>>
+AsyncGenerator<Result&&> mapConcurrently(
+    AsyncGenerator<Reference, Value> source,
+    TransformFn transformFn,
+    std::size_t maxConcurrency);
+
+template <
+    typename TransformFn,
+    typename Reference,
+    typename Value,
+    typename Result = detail::map_concurrently_result_t<TransformFn, Value>>
+AsyncGenerator<Result&&> mapConcurrentlyUnordered(
+    AsyncGenerator<Reference, Value> source,
+    TransformFn transformFn,
+    std::size_t maxConcurrency);
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
+
+#include <folly/coro/MapConcurrently-inl.h>
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/coro/TaskWrapper.h>
+#include <folly/coro/detail/FramePool.h>
+
+#if FOLLY_HAS_IMMOVABLE_COROUTINES
+
+/// `PooledTask<T>` quacks like `Task<T>`, but recycles its coroutine frame
+/// through a per-thread pool (`detail/FramePool.h`) instead of allocating it
+/// with malloc.
+///
+/// Use it for small coroutines that are created at a high rate, e.g. the
+/// leaves of a wide fan-out, where allocating frames dominates. Frames can be
+/// freed on any thread, but each goes back to the pool of the thread that
+/// created the coroutine, so pools work best when coroutines are created and
+/// completed on the same threads, like the threads of an executor.
+///
+/// Only the frames of `PooledTask` coroutines are pooled: the `Task`s that
+/// they await allocate their own frames as usual.
+
+namespace folly::coro {
+
+template <typename T = void>
+class PooledTask;
+
+template <typename T = void>
+class PooledTaskWithExecutor;
+
+namespace detail {
+template <typename T>
+struct PooledTaskWithExecutorCfg : DoesNotWrapAwaitable {
+  using InnerTaskWithExecutorT = TaskWithExecutor<T>;
+  using WrapperTaskT = PooledTask<T>;
+};
+template <typename T>
+using PooledTaskWithExecutorBase = TaskWithExecutorWrapperCrtp<
+    PooledTaskWithExecutor<T>,
+    detail::PooledTaskWithExecutorCfg<T>>;
+} // namespace detail
+
+template <typename T>
+class FOLLY_NODISCARD PooledTaskWithExecutor final
+    : public detail::PooledTaskWithExecutorBase<T> {
+ protected:
+  using detail::PooledTaskWithExecutorBase<T>::PooledTaskWithExecutorBase;
+};
+
+namespace detail {
+template <typename T>
+class PooledTaskPromise final
+    : public TaskPromiseWrapper<T, PooledTask<T>, TaskPromise<T>> {
+ public:
+  static void* operator new(std::size_t size) {
+    return FramePool::allocate(size);
+  }
+  static void operator delete(void* ptr, std::size_t size) {
+    FramePool::deallocate(ptr, size);
+  }
+};
+template <typename T>
+struct PooledTaskCfg : DoesNotWrapAwaitable {
+  using ValueT = T;
+  using InnerTaskT = Task<T>;
+  using TaskWithExecutorT = PooledTaskWithExecutor<T>;
+  using PromiseT = PooledTaskPromise<T>;
+};
+template <typename T>
+using PooledTaskBase =
+    TaskWrapperCrtp<PooledTask<T>, detail::PooledTaskCfg<T>>;
+} // namespace detail
+
+template <typename T>
+class FOLLY_CORO_TASK_ATTRS PooledTask final
+    : public detail::PooledTaskBase<T> {
+ protected:
+  using detail::PooledTaskBase<T>::PooledTaskBase;
+};
+
+} // namespace folly::coro
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <folly/TokenBucket.h>
+#include <folly/coro/Coroutine.h>
+#include <folly/coro/Sleep.h>
+#include <folly/coro/Task.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+/// Token-bucket rate limiter for coroutines.
+///
+/// Tokens are generated at 'rate' per second, up to 'burstSize'. co_wait()
+/// reserves its tokens up front by borrowing from the bucket and then sleeps
+/// until the debt is paid, so callers are admitted in the order in which they
+/// called co_wait() and nothing but the bucket's atomic is touched when
+/// tokens are available.
+///
+/// For example:
+///   folly::coro::RateLimiter limiter{/* rate */ 100, /* burstSize */ 10};
+///
+///   folly::coro::Task<> sendRequest() {
+///     co_await limiter.co_wait();
+///     ...
+///   }
+class RateLimiter {
+ public:
+  RateLimiter(double rate, double burstSize) noexcept
+      : bucket_(rate, burstSize) {}
+
+  RateLimiter(const RateLimiter&) = delete;
+  RateLimiter& operator=(const RateLimiter&) = delete;
+
+  /// Take tokens if they are available right now.
+  bool try_wait(double tokens = 1) { return bucket_.consume(tokens); }
+
+  /// Take tokens, waiting until the bucket has generated them.
+  ///
+  /// Throws std::invalid_argument if more tokens than burstSize are
+  /// requested, as those could never be granted at once. If cancellation is
+  /// requested while waiting, the reserved tokens are returned to the bucket
+  /// and folly::OperationCancelled is thrown.
+  Task<void> co_wait(double tokens = 1, Timekeeper* tk = nullptr) {
+    auto waitSeconds = bucket_.consumeWithBorrowNonBlocking(tokens);
+    if (!waitSeconds) {
+      co_yield co_error(std::invalid_argument(
+          "RateLimiter::co_wait: tokens exceeds burst size"));
+    }
+    if (*waitSeconds <= 0) {
+      co_return;
+    }
+    auto result = co_await co_awaitTry(sleep(
+        std::chrono::duration_cast<HighResDuration>(
+            std::chrono::duration<double>(*waitSeconds)),
+        tk));
+    if (result.hasException()) {
+      bucket_.returnTokens(tokens);
+      co_yield co_error(std::move(result.exception()));
+    }
+  }
+
+  /// Tokens currently available, negative while waiters hold a debt.
+  double balance() const noexcept { return bucket_.balance(); }
+
+  double rate() const noexcept { return bucket_.rate(); }
+  double burstSize() const noexcept { return bucket_.burst(); }
+
+ private:
+  TokenBucket bucket_;
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
@@ -82,7 +82,7 @@ co_result(result<T>) -> co_result<T>;
 class co_cancelled_t final {
  public:
   /* implicit */ operator co_error() const {
-    return co_error(OperationCancelled{});
+    return co_error(static_exception_ptr<OperationCancelled>());
   }
 };
 
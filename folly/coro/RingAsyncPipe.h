@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/ExceptionWrapper.h>
+#include <folly/MPMCQueue.h>
+#include <folly/coro/Baton.h>
+#include <folly/coro/Coroutine.h>
+#include <folly/coro/Task.h>
+#include <folly/fibers/Semaphore.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+// Bounded, multi-producer single-consumer variant of AsyncPipe backed by a
+// fixed-size ring. Elements are stored in place, so writing and reading
+// allocate nothing per element, and the reader consumes everything that is
+// ready with a single resumption.
+//
+// Usage:
+//   auto [reader, pipe] = RingAsyncPipe<T>::create(/* capacity */ 1024);
+//   pipe.try_write(std::move(val1));
+//   co_await pipe.write(std::move(val2));
+//   auto vals = co_await reader.readBatch(/* maxItems */ 64);
+//
+// readBatch() suspends until at least one element is available and returns
+// up to maxItems elements in write order. Once the pipe is closed and
+// drained it returns an empty vector, or throws the exception passed to
+// close(). It supports cancellation while suspended.
+//
+// write() only suspends when the ring is full, and try_write() never
+// suspends; both return false once the reader has been destroyed or the
+// pipe closed. write() and try_write() are thread-safe, close() must be
+// sequenced after all writes. T must be nothrow move constructible and
+// default constructible.
+template <typename T>
+class RingAsyncPipe {
+  struct State {
+    explicit State(size_t capacity) : ring(capacity), space(capacity) {}
+
+    // Wake the reader if it is (about to be) suspended. The fence pairs with
+    // the one in Reader::readBatch, so either the reader sees the element or
+    // we see its waiting flag.
+    void notifyReader() noexcept {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (readerWaiting.load(std::memory_order_relaxed) &&
+          readerWaiting.exchange(false, std::memory_order_acq_rel)) {
+        readerBaton.post();
+      }
+    }
+
+    folly::MPMCQueue<T> ring;
+    folly::fibers::Semaphore space;
+    folly::coro::Baton readerBaton;
+    std::atomic<bool> readerWaiting{false};
+    std::atomic<bool> readerGone{false};
+    std::atomic<bool> closed{false};
+    folly::exception_wrapper closeError;
+  };
+
+ public:
+  class Reader {
+   public:
+    Reader(Reader&&) noexcept = default;
+    Reader& operator=(Reader&& other) noexcept {
+      if (this != &other) {
+        release();
+        state_ = std::move(other.state_);
+      }
+      return *this;
+    }
+    ~Reader() { release(); }
+
+    folly::coro::Task<std::vector<T>> readBatch(size_t maxItems) {
+      DCHECK_GT(maxItems, 0);
+      auto& state = *state_;
+      std::vector<T> batch;
+      while (true) {
+        // Read closed before draining, so elements written before close()
+        // are never dropped.
+        bool closed = state.closed.load(std::memory_order_acquire);
+        batch.resize(maxItems);
+        auto count = state.ring.readBatch(batch.data(), maxItems);
+        batch.resize(count);
+        if (count > 0) {
+          for (size_t i = 0; i < count; ++i) {
+            state.space.signal();
+          }
+          co_return batch;
+        }
+        if (closed) {
+          if (state.closeError) {
+            co_yield co_error(state.closeError);
+          }
+          co_return batch;
+        }
+
+        const auto& ct = co_await co_current_cancellation_token;
+        if (ct.isCancellationRequested()) {
+          co_yield co_cancelled;
+        }
+        state.readerBaton.reset();
+        state.readerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!state.ring.isEmpty() ||
+            state.closed.load(std::memory_order_acquire)) {
+          state.readerWaiting.store(false, std::memory_order_relaxed);
+          continue;
+        }
+        {
+          CancellationCallback cb(ct, [&] { state.readerBaton.post(); });
+          co_await state.readerBaton;
+        }
+        state.readerWaiting.store(false, std::memory_order_relaxed);
+      }
+    }
+
+   private:
+    friend class RingAsyncPipe;
+    explicit Reader(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    void release() {
+      if (state_) {
+        state_->readerGone.store(true, std::memory_order_release);
+        // Wakes one blocked writer, which passes the token on to the next.
+        state_->space.signal();
+        state_.reset();
+      }
+    }
+
+    std::shared_ptr<State> state_;
+  };
+
+  RingAsyncPipe(RingAsyncPipe&&) noexcept = default;
+  RingAsyncPipe& operator=(RingAsyncPipe&& other) noexcept {
+    if (this != &other) {
+      std::move(*this).close();
+      state_ = std::move(other.state_);
+    }
+    return *this;
+  }
+  ~RingAsyncPipe() { std::move(*this).close(); }
+
+  static std::pair<Reader, RingAsyncPipe> create(size_t capacity) {
+    auto state = std::make_shared<State>(capacity);
+    return {Reader(state), RingAsyncPipe(state)};
+  }
+
+  template <typename U = T>
+  folly::coro::Task<bool> write(U&& val) {
+    if (!state_) {
+      co_return false;
+    }
+    auto& state = *state_;
+    if (!state.space.try_wait()) {
+      co_await state.space.co_wait();
+    }
+    if (state.readerGone.load(std::memory_order_acquire)) {
+      state.space.signal();
+      co_return false;
+    }
+    state.ring.blockingWrite(std::forward<U>(val));
+    state.notifyReader();
+    co_return true;
+  }
+
+  template <typename U = T>
+  bool try_write(U&& val) {
+    if (!state_) {
+      return false;
+    }
+    auto& state = *state_;
+    if (state.readerGone.load(std::memory_order_acquire) ||
+        !state.space.try_wait()) {
+      return false;
+    }
+    // Tokens bound the number of unread elements by the ring capacity, so
+    // this never waits for space.
+    state.ring.blockingWrite(std::forward<U>(val));
+    state.notifyReader();
+    return true;
+  }
+
+  void close(folly::exception_wrapper ew) && {
+    if (state_) {
+      state_->closeError = std::move(ew);
+      state_->closed.store(true, std::memory_order_release);
+      state_->notifyReader();
+      state_.reset();
+    }
+  }
+
+  void close() && { std::move(*this).close(folly::exception_wrapper()); }
+
+ private:
+  explicit RingAsyncPipe(std::shared_ptr<State> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<State> state_;
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
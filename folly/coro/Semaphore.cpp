@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/coro/Semaphore.h>
+
+#include <folly/CancellationToken.h>
+
+#include <cassert>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+Semaphore::Semaphore(int64_t tokens) noexcept : state_(tokens) {
+  assert(tokens >= 0 && tokens < kWaitersFlag);
+}
+
+Semaphore::~Semaphore() {
+  // Check there are no coroutines waiting for tokens.
+  assert(waitList_.rlock()->empty());
+}
+
+bool Semaphore::try_wait(int64_t tokens) noexcept {
+  assert(tokens > 0);
+  auto state = state_.load(std::memory_order_relaxed);
+  do {
+    if ((state & kWaitersFlag) || state < tokens) {
+      return false;
+    }
+  } while (!state_.compare_exchange_weak(
+      state,
+      state - tokens,
+      std::memory_order_acquire,
+      std::memory_order_relaxed));
+  return true;
+}
+
+Task<void> Semaphore::co_wait(int64_t tokens) {
+  if (try_wait(tokens)) {
+    co_return;
+  }
+  Waiter waiter{tokens};
+  if (!waitSlow(waiter)) {
+    co_return;
+  }
+  {
+    const auto& ct = co_await co_current_cancellation_token;
+    CancellationCallback cb{ct, [&] { cancelWait(waiter); }};
+    co_await waiter.baton;
+  }
+  if (waiter.cancelled) {
+    co_yield co_cancelled;
+  }
+}
+
+void Semaphore::cancelWait(Waiter& waiter) noexcept {
+  WaiterList ready;
+  {
+    auto waitList = waitList_.wlock();
+    if (!waiter.hook.is_linked()) {
+      // Already granted its tokens by signal().
+      return;
+    }
+    waiter.cancelled = true;
+    waitList->erase(waitList->iterator_to(waiter));
+    // Waiters that were queued behind it may fit now.
+    dispatchLocked(*waitList, ready);
+  }
+  resumeWaiters(ready);
+  waiter.baton.post();
+}
+
+void Semaphore::signal(int64_t tokens) {
+  assert(tokens > 0);
+  auto state = state_.load(std::memory_order_relaxed);
+  while (!(state & kWaitersFlag)) {
+    if (state_.compare_exchange_weak(
+            state,
+            state + tokens,
+            std::memory_order_release,
+            std::memory_order_relaxed)) {
+      return;
+    }
+  }
+
+  WaiterList ready;
+  {
+    auto waitList = waitList_.wlock();
+    state_.fetch_add(tokens, std::memory_order_relaxed);
+    dispatchLocked(*waitList, ready);
+  }
+  resumeWaiters(ready);
+}
+
+int64_t Semaphore::getAvailableTokens() const noexcept {
+  return state_.load(std::memory_order_relaxed) & ~kWaitersFlag;
+}
+
+bool Semaphore::waitSlow(Waiter& waiter) {
+  auto waitList = waitList_.wlock();
+  auto state = state_.load(std::memory_order_relaxed);
+  while (true) {
+    if (!(state & kWaitersFlag) && state >= waiter.tokens) {
+      if (state_.compare_exchange_weak(
+              state,
+              state - waiter.tokens,
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        return false;
+      }
+    } else if (
+        (state & kWaitersFlag) ||
+        state_.compare_exchange_weak(
+            state,
+            state | kWaitersFlag,
+            std::memory_order_relaxed,
+            std::memory_order_relaxed)) {
+      waitList->push_back(waiter);
+      return true;
+    }
+  }
+}
+
+void Semaphore::dispatchLocked(
+    WaiterList& waitList, WaiterList& ready) noexcept {
+  auto state = state_.load(std::memory_order_relaxed);
+  if (!(state & kWaitersFlag)) {
+    // The list was drained before we locked it, and try_wait() and signal()
+    // may be updating the tokens concurrently again.
+    assert(waitList.empty());
+    return;
+  }
+  // kWaitersFlag is set, so nobody else changes the tokens concurrently.
+  auto tokens = state & ~kWaitersFlag;
+  while (!waitList.empty() && waitList.front().tokens <= tokens) {
+    auto& waiter = waitList.front();
+    tokens -= waiter.tokens;
+    waitList.pop_front();
+    ready.push_back(waiter);
+  }
+  state_.store(
+      waitList.empty() ? tokens : tokens | kWaitersFlag,
+      std::memory_order_release);
+}
+
+void Semaphore::resumeWaiters(WaiterList& ready) noexcept {
+  while (!ready.empty()) {
+    auto& waiter = ready.front();
+    ready.pop_front();
+    waiter.baton.post();
+  }
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
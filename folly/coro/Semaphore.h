@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/IntrusiveList.h>
+#include <folly/Synchronized.h>
+#include <folly/coro/Baton.h>
+#include <folly/coro/Coroutine.h>
+#include <folly/coro/Task.h>
+
+#include <atomic>
+#include <cstdint>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+/// A counting semaphore that can be acquired asynchronously using 'co_await'.
+///
+/// Each acquisition takes a number of tokens (1 by default) and waits until
+/// that many tokens are available. Waiters are served in FIFO order: a waiter
+/// needing many tokens is not starved by later waiters needing few, which
+/// queue behind it even if there would be enough tokens for them.
+///
+/// try_wait() and signal() only touch a single atomic word while no coroutine
+/// is waiting; the waiter list is locked only once somebody has to suspend.
+///
+/// For example:
+///   folly::coro::Semaphore sem{10};
+///
+///   folly::coro::Task<> limitedWork(int64_t cost) {
+///     co_await sem.co_wait(cost);
+///     SCOPE_EXIT { sem.signal(cost); };
+///     ...
+///   }
+class Semaphore {
+ public:
+  explicit Semaphore(int64_t tokens) noexcept;
+
+  Semaphore(const Semaphore&) = delete;
+  Semaphore(Semaphore&&) = delete;
+  Semaphore& operator=(const Semaphore&) = delete;
+  Semaphore& operator=(Semaphore&&) = delete;
+
+  ~Semaphore();
+
+  /// Take tokens without waiting.
+  ///
+  /// Returns false if there are not enough tokens available, or if other
+  /// coroutines are already waiting for tokens.
+  bool try_wait(int64_t tokens = 1) noexcept;
+
+  /// Wait until the requested number of tokens is available and take them.
+  ///
+  /// Completes without suspending if the tokens can be taken immediately.
+  /// Throws folly::OperationCancelled, without taking any tokens, if
+  /// cancellation is requested on the awaiting coroutine's CancellationToken
+  /// while it waits.
+  Task<void> co_wait(int64_t tokens = 1);
+
+  /// Return tokens to the semaphore, resuming as many waiters (in FIFO order)
+  /// as the available tokens can satisfy.
+  void signal(int64_t tokens = 1);
+
+  /// Number of tokens currently available. Only a snapshot.
+  int64_t getAvailableTokens() const noexcept;
+
+ private:
+  struct Waiter {
+    explicit Waiter(int64_t tokens) noexcept : tokens(tokens) {}
+
+    const int64_t tokens;
+    bool cancelled{false};
+    Baton baton;
+    folly::SafeIntrusiveListHook hook;
+  };
+  using WaiterList = folly::SafeIntrusiveList<Waiter, &Waiter::hook>;
+
+  // Set in state_ while waitList_ is non-empty. While it is set, the token
+  // count only changes with waitList_ locked.
+  static constexpr int64_t kWaitersFlag = int64_t(1) << 62;
+
+  // Enqueue the waiter unless the tokens could be taken. Returns true if the
+  // caller has to wait on waiter.baton.
+  bool waitSlow(Waiter& waiter);
+
+  // Hand tokens to the waiters at the front of the list that they satisfy,
+  // unlinking them into 'ready'. Clears kWaitersFlag once the list is empty.
+  void dispatchLocked(WaiterList& waitList, WaiterList& ready) noexcept;
+
+  // Dequeue a waiter whose wait was cancelled, unless it already got its
+  // tokens.
+  void cancelWait(Waiter& waiter) noexcept;
+
+  static void resumeWaiters(WaiterList& ready) noexcept;
+
+  // Token count, possibly with kWaitersFlag set.
+  std::atomic<int64_t> state_;
+  folly::Synchronized<WaiterList> waitList_;
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
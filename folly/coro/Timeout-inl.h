@@ -48,7 +48,8 @@ typename detail::timeout_task_<SemiAwaitable, void>::type timeoutImpl(
           if (result.hasException()) {
             impl.timeoutResult = std::move(result.exception());
           } else {
-            impl.timeoutResult = folly::make_exception_wrapper<FutureTimeout>();
+            impl.timeoutResult = exception_wrapper{
+                folly::static_exception_ptr<FutureTimeout>()};
           }
           impl.baton.post();
         }
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/coro/WorkStealingExecutor.h>
+
+#include <thread>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/lang/Align.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+namespace {
+
+struct FuncNode {
+  explicit FuncNode(Func f) : func(std::move(f)) {}
+
+  Func func;
+  FuncNode* next{nullptr};
+};
+
+// Coroutine frames are at least pointer-aligned, so the low bit tells them
+// apart from nodes.
+constexpr std::uintptr_t kFuncTag = 1;
+
+constexpr size_t kMaxFreeNodes = 1024;
+
+} // namespace
+
+// A worker thread and its deque. The deque is the bounded version of the
+// Chase-Lev deque (see "Correct and Efficient Work-Stealing for Weak Memory
+// Models", Lê et al.): the worker pushes and pops at the bottom, and other
+// workers steal from the top.
+class WorkStealingExecutor::Worker {
+ public:
+  explicit Worker(WorkStealingExecutor& executor)
+      : executor_(&executor), buffer_(new std::atomic<Item>[kCapacity]) {}
+
+  ~Worker() {
+    while (freeNodes_ != nullptr) {
+      delete std::exchange(freeNodes_, freeNodes_->next);
+    }
+  }
+
+  WorkStealingExecutor* executor() const { return executor_; }
+
+  // Returns false if the deque is full. Only called by the worker.
+  bool push(Item item) {
+    auto const b = bottom_.load(std::memory_order_relaxed);
+    auto const t = top_.load(std::memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(kCapacity)) {
+      return false;
+    }
+    buffer_[b & kMask].store(item, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Only called by the worker.
+  bool pop(Item& item) {
+    auto const b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    item = buffer_[b & kMask].load(std::memory_order_relaxed);
+    if (t < b) {
+      return true;
+    }
+    // The last item, which a thief may be taking as well.
+    bool const won = top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Called by other workers. Also fails if another thread took the top item
+  // first.
+  bool steal(Item& item) {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return false;
+    }
+    item = buffer_[t & kMask].load(std::memory_order_relaxed);
+    return top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return bottom_.load(std::memory_order_acquire) <=
+        top_.load(std::memory_order_acquire);
+  }
+
+  // The node cache is only used by the worker.
+  FuncNode* allocateNode(Func func) {
+    if (freeNodes_ == nullptr) {
+      return new FuncNode(std::move(func));
+    }
+    auto node = std::exchange(freeNodes_, freeNodes_->next);
+    --numFreeNodes_;
+    node->func = std::move(func);
+    return node;
+  }
+
+  void recycleNode(FuncNode* node) {
+    if (numFreeNodes_ == kMaxFreeNodes) {
+      delete node;
+      return;
+    }
+    node->next = std::exchange(freeNodes_, node);
+    ++numFreeNodes_;
+  }
+
+  std::thread thread;
+  // Where to start looking for work to steal.
+  size_t victim{0};
+
+ private:
+  static constexpr size_t kCapacity = 4096;
+  static constexpr size_t kMask = kCapacity - 1;
+
+  WorkStealingExecutor* const executor_;
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> top_{0};
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> bottom_{
+      0};
+  std::unique_ptr<std::atomic<Item>[]> buffer_;
+
+  FuncNode* freeNodes_{nullptr};
+  size_t numFreeNodes_{0};
+};
+
+thread_local WorkStealingExecutor::Worker*
+    WorkStealingExecutor::currentWorker_ = nullptr;
+
+WorkStealingExecutor::WorkStealingExecutor(
+    size_t numThreads, std::shared_ptr<ThreadFactory> threadFactory) {
+  CHECK_GT(numThreads, 0u);
+  if (!threadFactory) {
+    threadFactory = std::make_shared<NamedThreadFactory>("WorkStealing");
+  }
+  for (size_t i = 0; i < numThreads; ++i) {
+    workers_.push_back(std::make_unique<Worker>(*this));
+    workers_.back()->victim = i + 1;
+  }
+  // Start the threads once all the deques exist, since they steal from each
+  // other.
+  for (auto& worker : workers_) {
+    worker->thread =
+        threadFactory->newThread([this, w = worker.get()] { run(*w); });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  joinKeepAlive();
+  stopping_.store(true, std::memory_order_release);
+  {
+    std::lock_guard lock(sleepMutex_);
+    sleepCv_.notify_all();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+  DCHECK(injected_.empty());
+}
+
+void WorkStealingExecutor::add(Func func) {
+  auto worker = currentWorker_;
+  auto node = worker != nullptr && worker->executor() == this
+      ? worker->allocateNode(std::move(func))
+      : new FuncNode(std::move(func));
+  addItem(reinterpret_cast<Item>(node) | kFuncTag);
+}
+
+void WorkStealingExecutor::addCoroutine(coroutine_handle<> handle) {
+  DCHECK(handle);
+  addItem(reinterpret_cast<Item>(handle.address()));
+}
+
+void WorkStealingExecutor::addItem(Item item) {
+  auto worker = currentWorker_;
+  if (worker == nullptr || worker->executor() != this || !worker->push(item)) {
+    injected_.enqueue(item);
+  }
+  notify();
+}
+
+void WorkStealingExecutor::notify() {
+  // Pairs with the fetch_add() in run(): either the sleeping worker sees the
+  // new item, or this sees it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (numSleeping_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard lock(sleepMutex_);
+    sleepCv_.notify_one();
+  }
+}
+
+bool WorkStealingExecutor::tryGetItem(Worker& worker, Item& item) {
+  if (worker.pop(item) || injected_.try_dequeue(item)) {
+    return true;
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    auto& victim = *workers_[worker.victim++ % workers_.size()];
+    if (&victim != &worker && victim.steal(item)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingExecutor::runItem(Worker& worker, Item item) {
+  if (item & kFuncTag) {
+    auto node = reinterpret_cast<FuncNode*>(item & ~kFuncTag);
+    invokeCatchingExns(
+        "WorkStealingExecutor: func", std::exchange(node->func, {}));
+    worker.recycleNode(node);
+  } else {
+    coroutine_handle<>::from_address(reinterpret_cast<void*>(item)).resume();
+  }
+}
+
+bool WorkStealingExecutor::hasWork() const {
+  if (!injected_.empty()) {
+    return true;
+  }
+  for (auto& worker : workers_) {
+    if (!worker->empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingExecutor::run(Worker& worker) {
+  currentWorker_ = &worker;
+  Item item;
+  while (true) {
+    if (tryGetItem(worker, item)) {
+      runItem(worker, item);
+      continue;
+    }
+    std::unique_lock lock(sleepMutex_);
+    numSleeping_.fetch_add(1, std::memory_order_seq_cst);
+    if (!hasWork()) {
+      if (stopping_.load(std::memory_order_acquire)) {
+        numSleeping_.fetch_sub(1, std::memory_order_relaxed);
+        break;
+      }
+      sleepCv_.wait(lock);
+    }
+    numSleeping_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  currentWorker_ = nullptr;
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/DefaultKeepAliveExecutor.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/coro/Coroutine.h>
+#include <folly/executors/thread_factory/ThreadFactory.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+/**
+ * An executor for running many short-lived coroutines, e.g. the tasks of a
+ * wide collectAll(), on a fixed set of threads.
+ *
+ * Each thread has its own deque: work added from one of the threads goes to
+ * the bottom of its deque, and the thread takes its next work from there, so
+ * the continuation that a coroutine just scheduled runs next, on the same
+ * thread, while its frame is still in cache. Idle threads steal from the top
+ * of the other deques. Work added from other threads goes to a shared queue.
+ *
+ * The deques hold coroutine handles added with addCoroutine() as is, and the
+ * functions added with add() in nodes that each thread recycles, so neither
+ * allocates in steady state. Use it as any other executor, e.g. with
+ * co_withExecutor().
+ *
+ * The destructor waits for all the keep-alives to be released, and runs the
+ * work that is left.
+ */
+class WorkStealingExecutor final : public DefaultKeepAliveExecutor {
+ public:
+  explicit WorkStealingExecutor(
+      size_t numThreads,
+      std::shared_ptr<ThreadFactory> threadFactory = nullptr);
+  ~WorkStealingExecutor() override;
+
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+  void add(Func func) override;
+
+  /**
+   * Resumes the coroutine on one of the threads. Unlike add(), this doesn't
+   * restore a RequestContext, nor the async stack: it is meant for awaitables
+   * that manage those themselves.
+   */
+  void addCoroutine(coroutine_handle<> handle);
+
+  size_t numThreads() const { return workers_.size(); }
+
+ private:
+  class Worker;
+
+  // A coroutine address, or a tagged pointer to a node holding a Func.
+  using Item = std::uintptr_t;
+
+  void addItem(Item item);
+  bool tryGetItem(Worker& worker, Item& item);
+  void runItem(Worker& worker, Item item);
+  bool hasWork() const;
+  void notify();
+  void run(Worker& worker);
+
+  static thread_local Worker* currentWorker_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  UMPMCQueue<Item, /* MayBlock */ false> injected_;
+
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCv_;
+  std::atomic<size_t> numSleeping_{0};
+  std::atomic<bool> stopping_{false};
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
@@ -22,6 +22,8 @@
 #include <folly/coro/detail/Malloc.h>
 
 #include <cassert>
+#include <cstddef>
+#include <new>
 #include <utility>
 
 #if FOLLY_HAS_COROUTINES
@@ -30,9 +32,59 @@ namespace folly {
 namespace coro {
 namespace detail {
 
+// Storage for the frames of a fixed number of BarrierTasks, meant to be a
+// local variable of the coroutine that awaits them: frames are then part of
+// that coroutine's frame instead of being allocated one by one. Frames that
+// don't fit go to the heap. The arena must outlive the tasks.
+class BarrierTaskArena {
+ public:
+  BarrierTaskArena(const BarrierTaskArena&) = delete;
+  BarrierTaskArena& operator=(const BarrierTaskArena&) = delete;
+
+  // Returns nullptr if there isn't enough room left.
+  void* allocate(std::size_t size) noexcept {
+    size = (size + kAlign - 1) & ~(kAlign - 1);
+    if (static_cast<std::size_t>(end_ - next_) < size) {
+      return nullptr;
+    }
+    return std::exchange(next_, next_ + size);
+  }
+
+ protected:
+  static constexpr std::size_t kAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  BarrierTaskArena(std::byte* begin, std::byte* end) noexcept
+      : next_(begin), end_(end) {}
+
+ private:
+  std::byte* next_;
+  std::byte* end_;
+};
+
+template <std::size_t Size>
+class InlineBarrierTaskArena : public BarrierTaskArena {
+ public:
+  InlineBarrierTaskArena() noexcept
+      : BarrierTaskArena(storage_, storage_ + Size) {}
+
+ private:
+  alignas(kAlign) std::byte storage_[Size];
+};
+
+template <>
+class InlineBarrierTaskArena<0> : public BarrierTaskArena {
+ public:
+  InlineBarrierTaskArena() noexcept : BarrierTaskArena(nullptr, nullptr) {}
+};
+
 class BarrierTask {
  public:
   class promise_type {
+    // Precedes the frame, to tell apart frames that came from an arena.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameHeader {
+      bool inArena;
+    };
+
     struct FinalAwaiter {
       bool await_ready() noexcept { return false; }
 
@@ -48,11 +100,28 @@ class BarrierTask {
 
    public:
     static void* operator new(std::size_t size) {
-      return ::folly_coro_async_malloc(size);
+      return allocateFrame(nullptr, size);
+    }
+
+    // The frames of coroutines that take a BarrierTaskArena as their first
+    // parameter, or as the first one after the lambda, come from the arena.
+    template <typename... Args>
+    static void* operator new(
+        std::size_t size, BarrierTaskArena& arena, Args&...) {
+      return allocateFrame(&arena, size);
+    }
+
+    template <typename Lambda, typename... Args>
+    static void* operator new(
+        std::size_t size, Lambda&, BarrierTaskArena& arena, Args&...) {
+      return allocateFrame(&arena, size);
     }
 
     static void operator delete(void* ptr, std::size_t size) {
-      ::folly_coro_async_free(ptr, size);
+      auto header = static_cast<FrameHeader*>(ptr) - 1;
+      if (!header->inArena) {
+        ::folly_coro_async_free(header, sizeof(FrameHeader) + size);
+      }
     }
 
     BarrierTask get_return_object() noexcept {
@@ -81,6 +150,15 @@ class BarrierTask {
     folly::AsyncStackFrame& getAsyncFrame() noexcept { return asyncFrame_; }
 
    private:
+    static void* allocateFrame(BarrierTaskArena* arena, std::size_t size) {
+      void* p = arena ? arena->allocate(sizeof(FrameHeader) + size) : nullptr;
+      bool const inArena = p != nullptr;
+      if (!inArena) {
+        p = ::folly_coro_async_malloc(sizeof(FrameHeader) + size);
+      }
+      return new (p) FrameHeader{inArena} + 1;
+    }
+
     folly::AsyncStackFrame asyncFrame_;
     Barrier* barrier_ = nullptr;
   };
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/coro/detail/FramePool.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include <folly/Likely.h>
+#include <folly/coro/detail/Malloc.h>
+
+namespace folly {
+namespace coro {
+namespace detail {
+
+namespace {
+
+constexpr std::size_t kClassSize = 64;
+constexpr std::size_t kNumClasses =
+    FramePool::kMaxPooledFrameSize / kClassSize;
+// Bounds the memory that a thread keeps after a burst of allocations.
+constexpr std::uint32_t kMaxCachedPerClass = 256;
+
+class ThreadCache;
+
+// Precedes each pooled frame. The size keeps frames aligned like operator
+// new does.
+struct alignas(16) BlockHeader {
+  // nullptr if the frame was allocated while its thread was exiting.
+  ThreadCache* owner;
+  std::uint32_t sizeClass;
+};
+
+// Frames in the free lists link through their first bytes.
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+constexpr std::size_t sizeClass(std::size_t size) {
+  return size == 0 ? 0 : (size - 1) / kClassSize;
+}
+
+constexpr std::size_t blockSize(std::size_t cls) {
+  return sizeof(BlockHeader) + (cls + 1) * kClassSize;
+}
+
+FreeBlock* toFreeBlock(BlockHeader* block) {
+  return reinterpret_cast<FreeBlock*>(block + 1);
+}
+
+BlockHeader* toBlockHeader(FreeBlock* node) {
+  return reinterpret_cast<BlockHeader*>(node) - 1;
+}
+
+void* allocateBlock(ThreadCache* owner, std::size_t cls) {
+  auto block = static_cast<BlockHeader*>(
+      ::folly_coro_async_malloc(blockSize(cls)));
+  block->owner = owner;
+  block->sizeClass = static_cast<std::uint32_t>(cls);
+  return block + 1;
+}
+
+void freeBlock(BlockHeader* block) {
+  ::folly_coro_async_free(block, blockSize(block->sizeClass));
+}
+
+// Marks the remote free list of a thread that exited.
+FreeBlock kClosed;
+
+// The frames allocated by a thread. Only that thread uses the free lists;
+// other threads push the frames that they free on remote_.
+//
+// The cache outlives its thread until all of its frames are freed: at exit,
+// the thread adds the number of frames still out to orphaned_, and the
+// frees that find remote_ closed subtract one, so whichever brings it to 0
+// deletes the cache.
+class ThreadCache {
+ public:
+  void* allocate(std::size_t cls) {
+    auto& head = free_[cls];
+    if (FOLLY_UNLIKELY(head == nullptr) &&
+        remote_.load(std::memory_order_relaxed) != nullptr) {
+      drainRemote();
+    }
+    ++live_;
+    if (head != nullptr) {
+      auto node = std::exchange(head, head->next);
+      --count_[cls];
+      return node;
+    }
+    return allocateBlock(this, cls);
+  }
+
+  void deallocateLocal(BlockHeader* block) {
+    --live_;
+    cache(block);
+  }
+
+  void deallocateRemote(BlockHeader* block) {
+    auto node = toFreeBlock(block);
+    auto head = remote_.load(std::memory_order_relaxed);
+    do {
+      if (head == &kClosed) {
+        freeBlock(block);
+        if (orphaned_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          delete this;
+        }
+        return;
+      }
+      node->next = head;
+    } while (!remote_.compare_exchange_weak(
+        head, node, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  // Called when the thread exits.
+  void close() {
+    auto node = remote_.exchange(&kClosed, std::memory_order_acquire);
+    while (node != nullptr) {
+      --live_;
+      freeBlock(toBlockHeader(std::exchange(node, node->next)));
+    }
+    for (auto head : free_) {
+      while (head != nullptr) {
+        freeBlock(toBlockHeader(std::exchange(head, head->next)));
+      }
+    }
+    auto const outstanding = static_cast<std::int64_t>(live_);
+    if (orphaned_.fetch_add(outstanding, std::memory_order_acq_rel) +
+            outstanding ==
+        0) {
+      delete this;
+    }
+  }
+
+ private:
+  void cache(BlockHeader* block) {
+    auto const cls = block->sizeClass;
+    if (count_[cls] == kMaxCachedPerClass) {
+      freeBlock(block);
+      return;
+    }
+    auto node = toFreeBlock(block);
+    node->next = free_[cls];
+    free_[cls] = node;
+    ++count_[cls];
+  }
+
+  void drainRemote() {
+    auto node = remote_.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+      --live_;
+      cache(toBlockHeader(std::exchange(node, node->next)));
+    }
+  }
+
+  std::array<FreeBlock*, kNumClasses> free_{};
+  std::array<std::uint32_t, kNumClasses> count_{};
+  // The frames allocated from this cache that it hasn't got back yet.
+  std::size_t live_{0};
+  std::atomic<FreeBlock*> remote_{nullptr};
+  std::atomic<std::int64_t> orphaned_{0};
+};
+
+// Trivially destructible, so still usable while thread_local objects are
+// destroyed, unlike the holder.
+thread_local ThreadCache* tlCache = nullptr;
+thread_local bool tlExited = false;
+
+struct ThreadCacheHolder {
+  ~ThreadCacheHolder() {
+    tlExited = true;
+    if (auto cache = std::exchange(tlCache, nullptr)) {
+      cache->close();
+    }
+  }
+};
+
+FOLLY_NOINLINE ThreadCache* createThreadCache() {
+  if (tlExited) {
+    return nullptr;
+  }
+  static thread_local ThreadCacheHolder holder;
+  (void)holder;
+  return tlCache = new ThreadCache();
+}
+
+} // namespace
+
+void* FramePool::allocate(std::size_t size) {
+  if (FOLLY_UNLIKELY(size > kMaxPooledFrameSize)) {
+    return ::folly_coro_async_malloc(size);
+  }
+  auto const cls = sizeClass(size);
+  auto cache = tlCache;
+  if (FOLLY_UNLIKELY(cache == nullptr)) {
+    cache = createThreadCache();
+    if (cache == nullptr) {
+      return allocateBlock(nullptr, cls);
+    }
+  }
+  return cache->allocate(cls);
+}
+
+void FramePool::deallocate(void* ptr, std::size_t size) noexcept {
+  if (FOLLY_UNLIKELY(size > kMaxPooledFrameSize)) {
+    ::folly_coro_async_free(ptr, size);
+    return;
+  }
+  auto block = static_cast<BlockHeader*>(ptr) - 1;
+  auto owner = block->owner;
+  if (FOLLY_UNLIKELY(owner == nullptr)) {
+    freeBlock(block);
+  } else if (FOLLY_LIKELY(owner == tlCache)) {
+    owner->deallocateLocal(block);
+  } else {
+    owner->deallocateRemote(block);
+  }
+}
+
+} // namespace detail
+} // namespace coro
+} // namespace folly
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace folly {
+namespace coro {
+namespace detail {
+
+// Recycles coroutine frames in per-thread free lists, one per size class, so
+// that programs which create many small, short-lived coroutines don't spend
+// most of their time in malloc and free.
+//
+// Promise types opt in by forwarding their operator new and operator delete
+// here, see PooledTask. Frames may be freed on any thread: they go back to
+// the thread that allocated them, which picks them up on its next cache
+// miss. Frames larger than kMaxPooledFrameSize go straight to
+// folly_coro_async_malloc.
+class FramePool {
+ public:
+  static constexpr std::size_t kMaxPooledFrameSize = 2048;
+
+  static void* allocate(std::size_t size);
+  static void deallocate(void* ptr, std::size_t size) noexcept;
+};
+
+} // namespace detail
+} // namespace coro
+} // namespace folly
@@ -122,6 +122,45 @@ BENCHMARK(collectAllBaton100, iters) {
   }
 }
 
+folly::coro::Task<void> co_noop() {
+  co_return;
+}
+
+// Fixed-arity collectAll()/collectAny() don't allocate for their own
+// per-child bookkeeping.
+BENCHMARK(collectAllCoroVariadic2, iters) {
+  folly::coro::blockingWait([&]() -> folly::coro::Task<void> {
+    for (size_t i = 0; i < iters; ++i) {
+      co_await folly::coro::collectAll(co_noop(), co_noop());
+    }
+  }());
+}
+
+BENCHMARK(collectAllCoroVariadic8, iters) {
+  folly::coro::blockingWait([&]() -> folly::coro::Task<void> {
+    for (size_t i = 0; i < iters; ++i) {
+      co_await folly::coro::collectAll(
+          co_noop(),
+          co_noop(),
+          co_noop(),
+          co_noop(),
+          co_noop(),
+          co_noop(),
+          co_noop(),
+          co_noop());
+    }
+  }());
+}
+
+BENCHMARK(collectAnyCoroVariadic4, iters) {
+  folly::coro::blockingWait([&]() -> folly::coro::Task<void> {
+    for (size_t i = 0; i < iters; ++i) {
+      co_await folly::coro::collectAny(
+          co_noop(), co_noop(), co_noop(), co_noop());
+    }
+  }());
+}
+
 int main(int argc, char** argv) {
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
   folly::runBenchmarks();
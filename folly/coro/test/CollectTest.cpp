@@ -30,6 +30,7 @@
 #include <folly/io/async/Request.h>
 #include <folly/portability/GTest.h>
 
+#include <array>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -403,6 +404,43 @@ TEST_F(CollectAllTest, TaskWithExecutorUsage) {
   }());
 }
 
+namespace {
+// Makes the frame of the task awaiting it too large for collectAll()'s
+// inline storage.
+struct LargeAwaitable {
+  bool await_ready() noexcept { return true; }
+  void await_suspend(folly::coro::coroutine_handle<>) noexcept {}
+  int await_resume() noexcept { return data.back(); }
+
+  std::array<int, 256> data{};
+};
+} // namespace
+
+TEST_F(CollectAllTest, ManyTasksAndLargeFrames) {
+  folly::coro::blockingWait([]() -> folly::coro::Task<void> {
+    auto task = [](int i) -> folly::coro::Task<int> { co_return i; };
+    auto results = co_await folly::coro::collectAll(
+        task(1),
+        task(2),
+        task(3),
+        task(4),
+        task(5),
+        task(6),
+        task(7),
+        task(8),
+        task(9));
+    EXPECT_EQ(9, std::get<8>(results));
+
+    LargeAwaitable large;
+    large.data.back() = 42;
+    auto [a, b, c] =
+        co_await folly::coro::collectAll(task(1), large, LargeAwaitable{});
+    EXPECT_EQ(1, a);
+    EXPECT_EQ(42, b);
+    EXPECT_EQ(0, c);
+  }());
+}
+
 class CollectAllTryTest : public testing::Test {};
 
 TEST_F(CollectAllTryTest, WithNoArgs) {
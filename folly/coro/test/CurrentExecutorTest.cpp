@@ -21,6 +21,8 @@
 #include <folly/coro/CurrentExecutor.h>
 #include <folly/coro/Invoke.h>
 #include <folly/coro/Task.h>
+#include <folly/executors/ManualExecutor.h>
+#include <folly/executors/TimeSlice.h>
 
 #include <folly/portability/GTest.h>
 
@@ -55,4 +57,32 @@ TEST_F(CoRescheduleOnCurrentExecutorTest, example) {
   }
 }
 
+TEST_F(CoRescheduleOnCurrentExecutorTest, ifShouldYield) {
+  folly::ManualExecutor executor;
+  int step = 0;
+  auto future = folly::coro::co_invoke([&]() -> folly::coro::Task<void> {
+                  step = 1;
+                  co_await folly::coro::co_reschedule_if_should_yield;
+                  step = 2;
+                  co_await folly::coro::co_reschedule_if_should_yield;
+                  step = 3;
+                })
+                    .scheduleOn(&executor)
+                    .start();
+
+  {
+    // The time slice has expired, so the coroutine reschedules.
+    folly::TimeSliceGuard guard{std::chrono::nanoseconds(1)};
+    while (!folly::shouldYield()) {
+    }
+    EXPECT_EQ(1, executor.run());
+    EXPECT_EQ(1, step);
+  }
+
+  // Without a time slice, it runs to completion.
+  EXPECT_EQ(1, executor.run());
+  EXPECT_EQ(3, step);
+  EXPECT_TRUE(future.isReady());
+}
+
 #endif
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/Portability.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/coro/AsyncGenerator.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/MapConcurrently.h>
+#include <folly/coro/Task.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <folly/portability/GTest.h>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace folly::coro;
+
+namespace {
+
+AsyncGenerator<int> range(int count, std::atomic<int>* pulled = nullptr) {
+  for (int i = 0; i < count; ++i) {
+    if (pulled) {
+      ++*pulled;
+    }
+    co_yield i;
+  }
+}
+
+// Tracks how many transforms run at a time.
+struct Concurrency {
+  void enter() {
+    auto n = ++current;
+    auto m = max.load();
+    while (n > m && !max.compare_exchange_weak(m, n)) {
+    }
+  }
+  void exit() { --current; }
+
+  std::atomic<int> current{0};
+  std::atomic<int> max{0};
+};
+
+} // namespace
+
+class MapConcurrentlyTest : public testing::Test {};
+
+TEST_F(MapConcurrentlyTest, Ordered) {
+  folly::CPUThreadPoolExecutor executor(4);
+  Concurrency concurrency;
+  auto results = blockingWait(
+      [&]() -> Task<std::vector<int>> {
+        auto generator = mapConcurrently(
+            range(100),
+            [&](int i) -> Task<int> {
+              concurrency.enter();
+              // Later values tend to finish first.
+              for (int j = 0; j < 100 - i; ++j) {
+                co_await co_reschedule_on_current_executor;
+              }
+              concurrency.exit();
+              co_return i * 2;
+            },
+            8);
+        std::vector<int> values;
+        while (auto item = co_await generator.next()) {
+          values.push_back(*item);
+        }
+        co_return values;
+      }()
+                    .scheduleOn(&executor));
+  ASSERT_EQ(100, results.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i * 2, results[i]);
+  }
+  EXPECT_LE(concurrency.max.load(), 8);
+}
+
+TEST_F(MapConcurrentlyTest, Unordered) {
+  folly::CPUThreadPoolExecutor executor(4);
+  Concurrency concurrency;
+  auto results = blockingWait(
+      [&]() -> Task<std::vector<int>> {
+        auto generator = mapConcurrentlyUnordered(
+            range(100),
+            [&](int i) -> Task<int> {
+              concurrency.enter();
+              for (int j = 0; j < 100 - i; ++j) {
+                co_await co_reschedule_on_current_executor;
+              }
+              concurrency.exit();
+              co_return i * 2;
+            },
+            8);
+        std::vector<int> values;
+        while (auto item = co_await generator.next()) {
+          values.push_back(*item);
+        }
+        co_return values;
+      }()
+                    .scheduleOn(&executor));
+  ASSERT_EQ(100, results.size());
+  std::sort(results.begin(), results.end());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i * 2, results[i]);
+  }
+  EXPECT_LE(concurrency.max.load(), 8);
+}
+
+TEST_F(MapConcurrentlyTest, Backpressure) {
+  blockingWait([]() -> Task<void> {
+    std::atomic<int> pulled{0};
+    auto generator = mapConcurrently(
+        range(1000, &pulled),
+        [](int i) -> Task<int> {
+          co_await co_reschedule_on_current_executor;
+          co_return i;
+        },
+        4);
+    for (int i = 0; i < 10; ++i) {
+      auto item = co_await generator.next();
+      EXPECT_EQ(i, *item);
+      for (int j = 0; j < 10; ++j) {
+        co_await co_reschedule_on_current_executor;
+      }
+      // The consumer is slow: at most 4 more values were pulled.
+      EXPECT_LE(pulled.load(), i + 1 + 4);
+    }
+  }());
+}
+
+TEST_F(MapConcurrentlyTest, TransformError) {
+  blockingWait([]() -> Task<void> {
+    auto generator = mapConcurrently(
+        range(100),
+        [](int i) -> Task<int> {
+          if (i == 5) {
+            throw std::runtime_error("5");
+          }
+          co_return i;
+        },
+        4);
+    int count = 0;
+    EXPECT_THROW(
+        while (co_await generator.next()) { ++count; }, std::runtime_error);
+    EXPECT_LE(count, 5);
+  }());
+}
+
+TEST_F(MapConcurrentlyTest, SourceError) {
+  blockingWait([]() -> Task<void> {
+    auto generator = mapConcurrentlyUnordered(
+        []() -> AsyncGenerator<int> {
+          co_yield 1;
+          throw std::runtime_error("source");
+        }(),
+        [](int i) -> Task<int> { co_return i; },
+        4);
+    EXPECT_THROW(
+        while (co_await generator.next()) {}, std::runtime_error);
+  }());
+}
+
+TEST_F(MapConcurrentlyTest, TruncateStream) {
+  folly::CPUThreadPoolExecutor executor(4);
+  blockingWait(
+      [&]() -> Task<void> {
+        auto generator = mapConcurrently(
+            range(1000),
+            [](int i) -> Task<int> {
+              co_await co_reschedule_on_current_executor;
+              co_return i;
+            },
+            4);
+        auto item = co_await generator.next();
+        EXPECT_EQ(0, *item);
+      }()
+                   .scheduleOn(&executor));
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/coro/PooledTask.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/GtestHelpers.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+
+using folly::coro::detail::FramePool;
+
+TEST(FramePoolTest, reusesFrames) {
+  void* p = FramePool::allocate(100);
+  FramePool::deallocate(p, 100);
+  // Same size class.
+  void* q = FramePool::allocate(120);
+  EXPECT_EQ(p, q);
+  FramePool::deallocate(q, 120);
+
+  void* large = FramePool::allocate(FramePool::kMaxPooledFrameSize + 1);
+  FramePool::deallocate(large, FramePool::kMaxPooledFrameSize + 1);
+}
+
+TEST(FramePoolTest, crossThreadFree) {
+  std::vector<void*> frames;
+  for (size_t i = 0; i < 1000; ++i) {
+    frames.push_back(FramePool::allocate(64 + i % 512));
+  }
+  std::thread([&] {
+    for (size_t i = 0; i < frames.size(); ++i) {
+      FramePool::deallocate(frames[i], 64 + i % 512);
+    }
+  }).join();
+  // The frames come back on the next misses.
+  auto p = FramePool::allocate(64);
+  FramePool::deallocate(p, 64);
+}
+
+TEST(FramePoolTest, freeAfterThreadExit) {
+  std::vector<void*> frames;
+  std::thread([&] {
+    for (size_t i = 0; i < 100; ++i) {
+      frames.push_back(FramePool::allocate(200));
+    }
+    FramePool::deallocate(FramePool::allocate(200), 200);
+  }).join();
+  for (auto p : frames) {
+    FramePool::deallocate(p, 200);
+  }
+}
+
+#if FOLLY_HAS_IMMOVABLE_COROUTINES
+
+namespace {
+
+folly::coro::PooledTask<int> sum(int depth) {
+  if (depth == 0) {
+    co_return 1;
+  }
+  co_return co_await sum(depth - 1) + co_await sum(depth - 1);
+}
+
+folly::coro::PooledTask<void> fail() {
+  throw std::runtime_error("fail");
+  co_return;
+}
+
+} // namespace
+
+CO_TEST(PooledTaskTest, basics) {
+  EXPECT_EQ(1024, co_await sum(10));
+  EXPECT_THROW(co_await fail(), std::runtime_error);
+  EXPECT_EQ(
+      42, co_await []() -> folly::coro::PooledTask<int> {
+        co_return co_await []() -> folly::coro::Task<int> { co_return 42; }();
+      }());
+}
+
+TEST(PooledTaskTest, executor) {
+  // Frames are created on this thread and freed on the pool's threads.
+  folly::CPUThreadPoolExecutor executor(4);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(
+        32,
+        folly::coro::blockingWait(
+            co_withExecutor(folly::getKeepAliveToken(executor), sum(5))));
+  }
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/Portability.h>
+
+#include <folly/CancellationToken.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/RateLimiter.h>
+#include <folly/coro/Task.h>
+#include <folly/coro/WithCancellation.h>
+#include <folly/executors/GlobalExecutor.h>
+
+#include <folly/portability/GTest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace folly::coro;
+
+TEST(RateLimiterTest, TryWait) {
+  RateLimiter limiter{/* rate */ 0.001, /* burstSize */ 2};
+  EXPECT_TRUE(limiter.try_wait());
+  EXPECT_TRUE(limiter.try_wait());
+  EXPECT_FALSE(limiter.try_wait());
+}
+
+TEST(RateLimiterTest, WaitPacesCallers) {
+  RateLimiter limiter{/* rate */ 200, /* burstSize */ 1};
+  auto start = std::chrono::steady_clock::now();
+  blockingWait([&]() -> Task<void> {
+    for (int i = 0; i < 11; ++i) {
+      co_await limiter.co_wait();
+    }
+  }());
+  // The first token is available up front, the other ten take 5ms each.
+  EXPECT_GE(
+      std::chrono::steady_clock::now() - start, std::chrono::milliseconds(45));
+}
+
+TEST(RateLimiterTest, WaitMoreThanBurst) {
+  RateLimiter limiter{/* rate */ 1, /* burstSize */ 2};
+  EXPECT_THROW(blockingWait(limiter.co_wait(3)), std::invalid_argument);
+  EXPECT_TRUE(limiter.try_wait(2));
+}
+
+TEST(RateLimiterTest, CancelReturnsTokens) {
+  RateLimiter limiter{/* rate */ 0.001, /* burstSize */ 1};
+  EXPECT_TRUE(limiter.try_wait());
+  folly::CancellationSource cancelSource;
+  auto fut = co_withCancellation(cancelSource.getToken(), limiter.co_wait())
+                 .scheduleOn(folly::getGlobalCPUExecutor())
+                 .start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(fut.isReady());
+  EXPECT_LT(limiter.balance(), -0.5);
+
+  cancelSource.requestCancellation();
+  EXPECT_THROW(std::move(fut).get(), folly::OperationCancelled);
+  EXPECT_GT(limiter.balance(), -0.5);
+}
+
+#endif
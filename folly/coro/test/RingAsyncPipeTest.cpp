@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/Portability.h>
+
+#include <folly/CancellationToken.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/RingAsyncPipe.h>
+#include <folly/coro/Task.h>
+#include <folly/coro/WithCancellation.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+
+#include <folly/portability/GTest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace folly::coro;
+
+TEST(RingAsyncPipeTest, ReadBatch) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(16);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(pipe.try_write(i));
+  }
+  blockingWait([&]() -> Task<void> {
+    auto batch = co_await reader.readBatch(4);
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), batch);
+    batch = co_await reader.readBatch(100);
+    EXPECT_EQ((std::vector<int>{4, 5, 6, 7, 8, 9}), batch);
+  }());
+}
+
+TEST(RingAsyncPipeTest, TryWriteFull) {
+  auto [reader, pipe] = RingAsyncPipe<std::string>::create(2);
+  EXPECT_TRUE(pipe.try_write("a"));
+  EXPECT_TRUE(pipe.try_write("b"));
+  EXPECT_FALSE(pipe.try_write("c"));
+  blockingWait([&]() -> Task<void> {
+    auto batch = co_await reader.readBatch(1);
+    EXPECT_EQ(std::vector<std::string>{"a"}, batch);
+  }());
+  EXPECT_TRUE(pipe.try_write("c"));
+}
+
+TEST(RingAsyncPipeTest, Close) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(4);
+  EXPECT_TRUE(pipe.try_write(1));
+  std::move(pipe).close();
+  EXPECT_FALSE(pipe.try_write(2));
+  blockingWait([&]() -> Task<void> {
+    auto batch = co_await reader.readBatch(4);
+    EXPECT_EQ(std::vector<int>{1}, batch);
+    batch = co_await reader.readBatch(4);
+    EXPECT_TRUE(batch.empty());
+  }());
+}
+
+TEST(RingAsyncPipeTest, CloseWithError) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(4);
+  EXPECT_TRUE(pipe.try_write(1));
+  std::move(pipe).close(std::runtime_error("error"));
+  blockingWait([&]() -> Task<void> {
+    auto batch = co_await reader.readBatch(4);
+    EXPECT_EQ(std::vector<int>{1}, batch);
+    EXPECT_THROW(co_await reader.readBatch(4), std::runtime_error);
+  }());
+}
+
+TEST(RingAsyncPipeTest, ReaderWaitsForWrite) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(4);
+  folly::ManualExecutor ex;
+  auto fut = reader.readBatch(4).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(fut.isReady());
+
+  EXPECT_TRUE(pipe.try_write(1));
+  EXPECT_TRUE(pipe.try_write(2));
+  ex.drain();
+  ASSERT_TRUE(fut.isReady());
+  EXPECT_EQ((std::vector<int>{1, 2}), std::move(fut).get());
+}
+
+TEST(RingAsyncPipeTest, WriterWaitsForSpace) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(1);
+  folly::ManualExecutor ex;
+  EXPECT_TRUE(pipe.try_write(1));
+  auto fut = pipe.write(2).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(fut.isReady());
+
+  auto batch = blockingWait(reader.readBatch(4));
+  EXPECT_EQ(std::vector<int>{1}, batch);
+  ex.drain();
+  ASSERT_TRUE(fut.isReady());
+  EXPECT_TRUE(std::move(fut).get());
+  batch = blockingWait(reader.readBatch(4));
+  EXPECT_EQ(std::vector<int>{2}, batch);
+}
+
+TEST(RingAsyncPipeTest, ReaderDestroyedWakesWriters) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(1);
+  folly::ManualExecutor ex;
+  EXPECT_TRUE(pipe.try_write(1));
+  auto fut1 = pipe.write(2).scheduleOn(&ex).start();
+  auto fut2 = pipe.write(3).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(fut1.isReady());
+  EXPECT_FALSE(fut2.isReady());
+
+  { auto gone = std::move(reader); }
+  ex.drain();
+  ASSERT_TRUE(fut1.isReady());
+  ASSERT_TRUE(fut2.isReady());
+  EXPECT_FALSE(std::move(fut1).get());
+  EXPECT_FALSE(std::move(fut2).get());
+  EXPECT_FALSE(pipe.try_write(4));
+}
+
+TEST(RingAsyncPipeTest, CancelRead) {
+  auto [reader, pipe] = RingAsyncPipe<int>::create(4);
+  folly::ManualExecutor ex;
+  folly::CancellationSource cancelSource;
+  auto fut = co_withCancellation(cancelSource.getToken(), reader.readBatch(4))
+                 .scheduleOn(&ex)
+                 .start();
+  ex.drain();
+  EXPECT_FALSE(fut.isReady());
+
+  cancelSource.requestCancellation();
+  ex.drain();
+  ASSERT_TRUE(fut.isReady());
+  EXPECT_THROW(std::move(fut).get(), folly::OperationCancelled);
+
+  EXPECT_TRUE(pipe.try_write(1));
+  EXPECT_EQ(std::vector<int>{1}, blockingWait(reader.readBatch(4)));
+}
+
+TEST(RingAsyncPipeTest, MultipleProducers) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 10000;
+  auto [reader, pipe] = RingAsyncPipe<int>::create(64);
+  folly::CPUThreadPoolExecutor ex(kProducers);
+
+  auto produce = [](RingAsyncPipe<int>& pipe, int p) -> Task<void> {
+    for (int i = 0; i < kPerProducer; ++i) {
+      EXPECT_TRUE(co_await pipe.write(p * kPerProducer + i));
+    }
+  };
+  std::vector<folly::SemiFuture<folly::Unit>> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.push_back(produce(pipe, p).scheduleOn(&ex).start());
+  }
+
+  std::vector<int> lastSeen(kProducers, -1);
+  size_t total = 0;
+  size_t batches = 0;
+  blockingWait([&]() -> Task<void> {
+    while (total < kProducers * kPerProducer) {
+      auto batch = co_await reader.readBatch(32);
+      EXPECT_FALSE(batch.empty());
+      EXPECT_LE(batch.size(), 32);
+      ++batches;
+      for (auto v : batch) {
+        // Elements of each producer arrive in write order.
+        auto p = v / kPerProducer;
+        EXPECT_GT(v % kPerProducer, lastSeen[p]);
+        lastSeen[p] = v % kPerProducer;
+        ++total;
+      }
+    }
+  }());
+  for (auto& f : producers) {
+    std::move(f).get();
+  }
+  EXPECT_EQ(kProducers * kPerProducer, total);
+  EXPECT_LE(batches, total);
+}
+
+#endif
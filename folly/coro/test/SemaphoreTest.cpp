@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/Portability.h>
+
+#include <folly/CancellationToken.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Semaphore.h>
+#include <folly/coro/Task.h>
+#include <folly/coro/WithCancellation.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+
+#include <folly/portability/GTest.h>
+
+#include <atomic>
+#include <vector>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace folly::coro;
+
+TEST(SemaphoreTest, TryWait) {
+  Semaphore sem{3};
+  EXPECT_TRUE(sem.try_wait(2));
+  EXPECT_FALSE(sem.try_wait(2));
+  EXPECT_TRUE(sem.try_wait());
+  EXPECT_EQ(0, sem.getAvailableTokens());
+  sem.signal(3);
+  EXPECT_EQ(3, sem.getAvailableTokens());
+}
+
+TEST(SemaphoreTest, WaitDoesNotSuspendWhenAvailable) {
+  Semaphore sem{2};
+  blockingWait(sem.co_wait(2));
+  EXPECT_EQ(0, sem.getAvailableTokens());
+}
+
+TEST(SemaphoreTest, WeightedFifo) {
+  Semaphore sem{0};
+  folly::ManualExecutor ex;
+  std::vector<int> order;
+  auto waitFor = [&](int id, int64_t tokens) -> Task<void> {
+    co_await sem.co_wait(tokens);
+    order.push_back(id);
+  };
+
+  auto big = waitFor(1, 3).scheduleOn(&ex).start();
+  ex.drain();
+  auto small = waitFor(2, 1).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_TRUE(order.empty());
+
+  // The second waiter fits, but must not overtake the first one.
+  sem.signal(2);
+  ex.drain();
+  EXPECT_TRUE(order.empty());
+  // Queued waiters also block try_wait().
+  EXPECT_FALSE(sem.try_wait());
+
+  sem.signal(2);
+  ex.drain();
+  EXPECT_EQ((std::vector<int>{1, 2}), order);
+  EXPECT_EQ(0, sem.getAvailableTokens());
+  std::move(big).get();
+  std::move(small).get();
+
+  EXPECT_FALSE(sem.try_wait());
+  sem.signal();
+  EXPECT_TRUE(sem.try_wait());
+}
+
+TEST(SemaphoreTest, CancelUnblocksNextWaiter) {
+  Semaphore sem{1};
+  folly::ManualExecutor ex;
+  folly::CancellationSource cancelSource;
+
+  auto big = co_withCancellation(cancelSource.getToken(), sem.co_wait(2))
+                 .scheduleOn(&ex)
+                 .start();
+  auto small = sem.co_wait(1).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(big.isReady());
+  EXPECT_FALSE(small.isReady());
+
+  cancelSource.requestCancellation();
+  ex.drain();
+  ASSERT_TRUE(big.isReady());
+  EXPECT_THROW(std::move(big).get(), folly::OperationCancelled);
+  ASSERT_TRUE(small.isReady());
+  std::move(small).get();
+  EXPECT_EQ(0, sem.getAvailableTokens());
+
+  // No waiters are left, so the fast path is usable again.
+  sem.signal();
+  EXPECT_TRUE(sem.try_wait());
+}
+
+TEST(SemaphoreTest, ConcurrentWaiters) {
+  constexpr int64_t kTokens = 4;
+  constexpr int kTasks = 64;
+  constexpr int kIterations = 200;
+  Semaphore sem{kTokens};
+  folly::CPUThreadPoolExecutor ex(4);
+  std::atomic<int64_t> inUse{0};
+  std::atomic<int64_t> maxInUse{0};
+
+  auto worker = [&](int64_t tokens) -> Task<void> {
+    for (int i = 0; i < kIterations; ++i) {
+      co_await sem.co_wait(tokens);
+      auto now = inUse.fetch_add(tokens) + tokens;
+      auto max = maxInUse.load();
+      while (now > max && !maxInUse.compare_exchange_weak(max, now)) {
+      }
+      inUse.fetch_sub(tokens);
+      sem.signal(tokens);
+    }
+  };
+  std::vector<folly::SemiFuture<folly::Unit>> tasks;
+  for (int i = 0; i < kTasks; ++i) {
+    tasks.push_back(worker(1 + i % kTokens).scheduleOn(&ex).start());
+  }
+  for (auto& task : tasks) {
+    std::move(task).get();
+  }
+  EXPECT_LE(maxInUse.load(), kTokens);
+  EXPECT_EQ(kTokens, sem.getAvailableTokens());
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <folly/coro/BlockingWait.h>
 #include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/PooledTask.h>
 #include <folly/coro/Task.h>
 
 #include <memory>
@@ -158,6 +159,39 @@ BENCHMARK(NestedCallsWithCancellation10, iters) {
   benchNestedCallsWithCancellation(10, iters / 10);
 }
 
+#if FOLLY_HAS_IMMOVABLE_COROUTINES
+
+// A binary tree of small coroutines, as in a recursive fan-out, to compare
+// allocating their frames with malloc and with the frame pool.
+template <typename TaskT>
+static TaskT fanOut(size_t depth) {
+  if (depth > 0) {
+    co_await fanOut<TaskT>(depth - 1);
+    co_await fanOut<TaskT>(depth - 1);
+  }
+  co_return;
+}
+
+template <typename TaskT>
+static void benchFanOut(size_t iters) {
+  constexpr size_t kDepth = 10;
+  folly::coro::blockingWait([iters]() -> folly::coro::Task<void> {
+    for (size_t i = 0; i < iters; i += (2 << kDepth) - 1) {
+      co_await fanOut<TaskT>(kDepth);
+    }
+  }());
+}
+
+BENCHMARK(FanOutTask, iters) {
+  benchFanOut<folly::coro::Task<void>>(iters);
+}
+
+BENCHMARK_RELATIVE(FanOutPooledTask, iters) {
+  benchFanOut<folly::coro::PooledTask<void>>(iters);
+}
+
+#endif // FOLLY_HAS_IMMOVABLE_COROUTINES
+
 #endif // FOLLY_HAS_COROUTINES
 
 int main(int argc, char** argv) {
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/coro/WorkStealingExecutor.h>
+
+#include <atomic>
+#include <vector>
+
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/Task.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+#if FOLLY_HAS_COROUTINES
+
+using folly::coro::WorkStealingExecutor;
+
+TEST(WorkStealingExecutorTest, add) {
+  std::atomic<int> count{0};
+  {
+    WorkStealingExecutor executor(4);
+    // Functions added from the workers go to their deques.
+    for (int i = 0; i < 100; ++i) {
+      executor.add([&] {
+        for (int j = 0; j < 100; ++j) {
+          executor.add([&] { ++count; });
+        }
+      });
+    }
+  }
+  EXPECT_EQ(10000, count.load());
+}
+
+TEST(WorkStealingExecutorTest, stealing) {
+  // A function that blocks its worker, and the work that it added, which the
+  // other worker has to steal.
+  WorkStealingExecutor executor(2);
+  folly::Baton<> stolen;
+  folly::Baton<> done;
+  executor.add([&] {
+    executor.add([&] { stolen.post(); });
+    stolen.wait();
+    done.post();
+  });
+  done.wait();
+}
+
+namespace {
+
+// Resumes the awaiting coroutine on the executor with addCoroutine().
+struct ResumeOn {
+  WorkStealingExecutor& executor;
+
+  bool await_ready() noexcept { return false; }
+  void await_suspend(folly::coro::coroutine_handle<> h) {
+    executor.addCoroutine(h);
+  }
+  void await_resume() noexcept {}
+};
+
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() noexcept { return {}; }
+    folly::coro::suspend_never initial_suspend() noexcept { return {}; }
+    folly::coro::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+Detached resumeOn(
+    WorkStealingExecutor& executor,
+    std::atomic<int>& count,
+    folly::Baton<>& done) {
+  co_await ResumeOn{executor};
+  if (++count == 1000) {
+    done.post();
+  }
+}
+
+} // namespace
+
+TEST(WorkStealingExecutorTest, addCoroutine) {
+  WorkStealingExecutor executor(4);
+  std::atomic<int> count{0};
+  folly::Baton<> done;
+  for (int i = 0; i < 1000; ++i) {
+    resumeOn(executor, count, done);
+  }
+  done.wait();
+}
+
+TEST(WorkStealingExecutorTest, collectAll) {
+  WorkStealingExecutor executor(4);
+  auto leaf = [](int i) -> folly::coro::Task<int> {
+    co_await folly::coro::co_reschedule_on_current_executor;
+    co_return i;
+  };
+  auto fanOut = [&]() -> folly::coro::Task<int> {
+    std::vector<folly::coro::Task<int>> tasks;
+    for (int i = 0; i < 10000; ++i) {
+      tasks.push_back(leaf(i));
+    }
+    auto results = co_await folly::coro::collectAllRange(std::move(tasks));
+    int sum = 0;
+    for (auto result : results) {
+      sum += result;
+    }
+    co_return sum;
+  };
+  EXPECT_EQ(
+      49995000,
+      folly::coro::blockingWait(
+          co_withExecutor(folly::getKeepAliveToken(executor), fanOut())));
+}
+
+#endif
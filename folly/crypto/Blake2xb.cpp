@@ -15,10 +15,17 @@
  */
 
 #include <array>
+#include <cstring>
 
+#include <folly/CpuId.h>
+#include <folly/Portability.h>
 #include <folly/crypto/Blake2xb.h>
 #include <folly/lang/Bits.h>
 
+#if FOLLY_X64
+#include <immintrin.h>
+#endif
+
 namespace folly {
 namespace crypto {
 
@@ -87,6 +94,116 @@ void initStateFromParams(
     sodium_memzero(block.data(), block.size()); // erase key from stack
   }
 }
+
+#if FOLLY_X64
+
+// The output of BLAKE2x is made of independent BLAKE2b hashes of h0, one per
+// 64-byte block, which only differ in the node offset of their parameters.
+// Each takes a single compression, since h0 fits in one block, so this runs
+// four of them at once, one per 64-bit lane.
+
+constexpr std::array<std::array<uint8_t, 16>, 10> kBlake2bSigma = {{
+    {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}},
+    {{14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}},
+    {{11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4}},
+    {{7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8}},
+    {{9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13}},
+    {{2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9}},
+    {{12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11}},
+    {{13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10}},
+    {{6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5}},
+    {{10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0}},
+}};
+
+template <int N>
+FOLLY_TARGET_ATTRIBUTE("avx2")
+FOLLY_ALWAYS_INLINE __m256i rotr64(__m256i x) {
+  return _mm256_or_si256(_mm256_srli_epi64(x, N), _mm256_slli_epi64(x, 64 - N));
+}
+
+FOLLY_TARGET_ATTRIBUTE("avx2")
+FOLLY_ALWAYS_INLINE void g(
+    __m256i& a, __m256i& b, __m256i& c, __m256i& d, __m256i x, __m256i y) {
+  a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);
+  d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a), _MM_SHUFFLE(2, 3, 0, 1));
+  c = _mm256_add_epi64(c, d);
+  b = rotr64<24>(_mm256_xor_si256(b, c));
+  a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);
+  d = rotr64<16>(_mm256_xor_si256(d, a));
+  c = _mm256_add_epi64(c, d);
+  b = rotr64<63>(_mm256_xor_si256(b, c));
+}
+
+/**
+ * Computes the 4 full output blocks starting at nodeOffset into out, given
+ * the parameters of the output blocks with a node offset of 0.
+ */
+FOLLY_TARGET_ATTRIBUTE("avx2")
+void expandBlocksAvx2(
+    const detail::Blake2xbParam& param,
+    const std::array<uint8_t, crypto_generichash_blake2b_BYTES_MAX>& h0,
+    uint32_t nodeOffset,
+    uint8_t* out) {
+  std::array<uint64_t, 8> p;
+  std::memcpy(p.data(), &param, sizeof(p));
+  __m256i h[8];
+  for (size_t i = 0; i < 8; ++i) {
+    h[i] = _mm256_set1_epi64x(
+        static_cast<int64_t>(kBlake2bIV[i] ^ Endian::little(p[i])));
+  }
+  // The node offset is in the low half of the second parameter word.
+  h[1] = _mm256_xor_si256(
+      h[1],
+      _mm256_set_epi64x(
+          nodeOffset + 3, nodeOffset + 2, nodeOffset + 1, nodeOffset));
+
+  // h0 is the first half of the only message block, the rest is 0.
+  __m256i m[16];
+  for (size_t i = 0; i < 8; ++i) {
+    uint64_t word;
+    std::memcpy(&word, h0.data() + 8 * i, sizeof(word));
+    m[i] = _mm256_set1_epi64x(static_cast<int64_t>(Endian::little(word)));
+  }
+  for (size_t i = 8; i < 16; ++i) {
+    m[i] = _mm256_setzero_si256();
+  }
+
+  __m256i v[16];
+  for (size_t i = 0; i < 8; ++i) {
+    v[i] = h[i];
+    v[i + 8] = _mm256_set1_epi64x(static_cast<int64_t>(kBlake2bIV[i]));
+  }
+  // The message is 64 bytes long, and is the last block.
+  v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi64x(h0.size()));
+  v[14] = _mm256_xor_si256(v[14], _mm256_set1_epi64x(-1));
+
+  for (size_t round = 0; round < 12; ++round) {
+    const auto& s = kBlake2bSigma[round % 10];
+    g(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+    g(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+    g(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+    g(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+    g(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+    g(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+    g(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+    g(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+  }
+
+  // Lane k of word i is word i of output block k. x86 is little-endian, as
+  // the output is.
+  for (size_t i = 0; i < 8; ++i) {
+    alignas(32) std::array<uint64_t, 4> words;
+    _mm256_store_si256(
+        reinterpret_cast<__m256i*>(words.data()),
+        _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8])));
+    for (size_t k = 0; k < 4; ++k) {
+      std::memcpy(out + 64 * k + 8 * i, &words[k], sizeof(uint64_t));
+    }
+  }
+}
+
+#endif // FOLLY_X64
+
 } // namespace
 
 Blake2xb::Blake2xb()
@@ -182,6 +299,22 @@ void Blake2xb::finish(MutableByteRange out) {
   param_.innerLength = crypto_generichash_blake2b_BYTES_MAX;
   size_t pos = 0;
   size_t remaining = out.size();
+#if FOLLY_X64
+  static const bool kHasAvx2 = CpuId().avx2();
+  if (kHasAvx2) {
+    constexpr size_t kBlocksSize = 4 * crypto_generichash_blake2b_BYTES_MAX;
+    param_.nodeOffset = 0;
+    param_.digestLength = crypto_generichash_blake2b_BYTES_MAX;
+    for (; remaining >= kBlocksSize;
+         pos += kBlocksSize, remaining -= kBlocksSize) {
+      expandBlocksAvx2(
+          param_,
+          h0,
+          static_cast<uint32_t>(pos / crypto_generichash_blake2b_BYTES_MAX),
+          out.data() + pos);
+    }
+  }
+#endif
   while (remaining > 0) {
     param_.nodeOffset = Endian::little(
         static_cast<uint32_t>(pos / crypto_generichash_blake2b_BYTES_MAX));
@@ -343,11 +343,7 @@ void LtHash<B, N>::hashObject(
     Args&&... moreRanges) {
   CHECK_EQ(getChecksumSizeBytes(), out.size());
   Blake2xb digest;
-  if (key_.has_value()) {
-    digest.init(out.size(), folly::range(*key_));
-  } else {
-    digest.init(out.size());
-  }
+  initDigest(digest);
   updateDigest(digest, firstRange, std::forward<Args>(moreRanges)...);
   digest.finish(out);
   if /* constexpr */ (detail::Bits<B>::needsPadding()) {
@@ -356,6 +352,15 @@ void LtHash<B, N>::hashObject(
   }
 }
 
+template <std::size_t B, std::size_t N>
+void LtHash<B, N>::initDigest(Blake2xb& digest) {
+  if (key_.has_value()) {
+    digest.init(getChecksumSizeBytes(), folly::range(*key_));
+  } else {
+    digest.init(getChecksumSizeBytes());
+  }
+}
+
 template <std::size_t B, std::size_t N>
 template <typename... Args>
 void LtHash<B, N>::updateDigest(
@@ -403,6 +408,46 @@ LtHash<B, N>& LtHash<B, N>::removeObject(
   return *this;
 }
 
+template <std::size_t B, std::size_t N>
+template <typename Op>
+void LtHash<B, N>::updateObjects(
+    folly::Range<const folly::ByteRange*> objects, Op op) {
+  using H = std::array<unsigned char, getChecksumSizeBytes()>;
+  alignas(detail::kCacheLineSize) H h;
+  Blake2xb initialDigest;
+  initDigest(initialDigest);
+  for (auto object : objects) {
+    // The digest state is plain data, so copying it is the same as
+    // initializing a new one.
+    Blake2xb digest = initialDigest;
+    digest.update(object);
+    digest.finish({h.data(), h.size()});
+    if /* constexpr */ (detail::Bits<B>::needsPadding()) {
+      detail::MathOperation<detail::MathEngine::AUTO>::clearPaddingBits(
+          detail::Bits<B>::kDataMask(), {h.data(), h.size()});
+    }
+    op(detail::Bits<B>::kDataMask(),
+       B,
+       folly::ByteRange{checksum_.data(), checksum_.length()},
+       folly::ByteRange{h.data(), h.size()},
+       folly::MutableByteRange{checksum_.writableData(), checksum_.length()});
+  }
+}
+
+template <std::size_t B, std::size_t N>
+LtHash<B, N>& LtHash<B, N>::addObjects(
+    folly::Range<const folly::ByteRange*> objects) {
+  updateObjects(objects, detail::MathOperation<detail::MathEngine::AUTO>::add);
+  return *this;
+}
+
+template <std::size_t B, std::size_t N>
+LtHash<B, N>& LtHash<B, N>::removeObjects(
+    folly::Range<const folly::ByteRange*> objects) {
+  updateObjects(objects, detail::MathOperation<detail::MathEngine::AUTO>::sub);
+  return *this;
+}
+
 /* static */
 template <std::size_t B, std::size_t N>
 constexpr size_t LtHash<B, N>::getChecksumSizeBytes() {
@@ -17,6 +17,7 @@
 #include <folly/crypto/LtHash.h>
 
 #include <folly/CpuId.h>
+#include <folly/detail/TrapOnAvx512.h>
 
 #ifdef __SSE2__
 #include <emmintrin.h>
@@ -75,6 +76,22 @@ bool MathOperation<MathEngine::AVX2>::isAvailable() {
   return kIsAvailable;
 }
 
+// static
+template <>
+bool MathOperation<MathEngine::AVX512>::isAvailable() {
+  static const bool kIsAvailable = CpuId().avx512f() && CpuId().avx512bw() &&
+      !folly::detail::hasTrapOnAvx512() &&
+      MathOperation<MathEngine::AVX512>::isImplemented();
+  return kIsAvailable;
+}
+
+// static
+template <>
+bool MathOperation<MathEngine::NEON>::isAvailable() {
+  // NEON is part of the ARM64 baseline.
+  return MathOperation<MathEngine::NEON>::isImplemented();
+}
+
 // static
 template <>
 bool MathOperation<MathEngine::AUTO>::isAvailable() {
@@ -99,12 +116,18 @@ void MathOperation<MathEngine::AUTO>::add(
   // at the fastest available implementation the first time this function is
   // called.
   static auto implementation = []() {
-    if (MathOperation<MathEngine::AVX2>::isAvailable()) {
+    if (MathOperation<MathEngine::AVX512>::isAvailable()) {
+      LOG(INFO) << "Selected AVX512 MathEngine for add() operation";
+      return MathOperation<MathEngine::AVX512>::add;
+    } else if (MathOperation<MathEngine::AVX2>::isAvailable()) {
       LOG(INFO) << "Selected AVX2 MathEngine for add() operation";
       return MathOperation<MathEngine::AVX2>::add;
     } else if (MathOperation<MathEngine::SSE2>::isAvailable()) {
       LOG(INFO) << "Selected SSE2 MathEngine for add() operation";
       return MathOperation<MathEngine::SSE2>::add;
+    } else if (MathOperation<MathEngine::NEON>::isAvailable()) {
+      LOG(INFO) << "Selected NEON MathEngine for add() operation";
+      return MathOperation<MathEngine::NEON>::add;
     } else {
       LOG(INFO) << "Selected SIMPLE MathEngine for add() operation";
       return MathOperation<MathEngine::SIMPLE>::add;
@@ -125,12 +148,18 @@ void MathOperation<MathEngine::AUTO>::sub(
   // at the fastest available implementation the first time this function is
   // called.
   static auto implementation = []() {
-    if (MathOperation<MathEngine::AVX2>::isAvailable()) {
+    if (MathOperation<MathEngine::AVX512>::isAvailable()) {
+      LOG(INFO) << "Selected AVX512 MathEngine for sub() operation";
+      return MathOperation<MathEngine::AVX512>::sub;
+    } else if (MathOperation<MathEngine::AVX2>::isAvailable()) {
       LOG(INFO) << "Selected AVX2 MathEngine for sub() operation";
       return MathOperation<MathEngine::AVX2>::sub;
     } else if (MathOperation<MathEngine::SSE2>::isAvailable()) {
       LOG(INFO) << "Selected SSE2 MathEngine for sub() operation";
       return MathOperation<MathEngine::SSE2>::sub;
+    } else if (MathOperation<MathEngine::NEON>::isAvailable()) {
+      LOG(INFO) << "Selected NEON MathEngine for sub() operation";
+      return MathOperation<MathEngine::NEON>::sub;
     } else {
       LOG(INFO) << "Selected SIMPLE MathEngine for sub() operation";
       return MathOperation<MathEngine::SIMPLE>::sub;
@@ -147,12 +176,19 @@ void MathOperation<MathEngine::AUTO>::clearPaddingBits(
   // at the fastest available implementation the first time this function is
   // called.
   static auto implementation = []() {
-    if (MathOperation<MathEngine::AVX2>::isAvailable()) {
+    if (MathOperation<MathEngine::AVX512>::isAvailable()) {
+      LOG(INFO)
+          << "Selected AVX512 MathEngine for clearPaddingBits() operation";
+      return MathOperation<MathEngine::AVX512>::clearPaddingBits;
+    } else if (MathOperation<MathEngine::AVX2>::isAvailable()) {
       LOG(INFO) << "Selected AVX2 MathEngine for clearPaddingBits() operation";
       return MathOperation<MathEngine::AVX2>::clearPaddingBits;
     } else if (MathOperation<MathEngine::SSE2>::isAvailable()) {
       LOG(INFO) << "Selected SSE2 MathEngine for clearPaddingBits() operation";
       return MathOperation<MathEngine::SSE2>::clearPaddingBits;
+    } else if (MathOperation<MathEngine::NEON>::isAvailable()) {
+      LOG(INFO) << "Selected NEON MathEngine for clearPaddingBits() operation";
+      return MathOperation<MathEngine::NEON>::clearPaddingBits;
     } else {
       LOG(INFO)
           << "Selected SIMPLE MathEngine for clearPaddingBits() operation";
@@ -170,12 +206,19 @@ bool MathOperation<MathEngine::AUTO>::checkPaddingBits(
   // at the fastest available implementation the first time this function is
   // called.
   static auto implementation = []() {
-    if (MathOperation<MathEngine::AVX2>::isAvailable()) {
+    if (MathOperation<MathEngine::AVX512>::isAvailable()) {
+      LOG(INFO)
+          << "Selected AVX512 MathEngine for checkPaddingBits() operation";
+      return MathOperation<MathEngine::AVX512>::checkPaddingBits;
+    } else if (MathOperation<MathEngine::AVX2>::isAvailable()) {
       LOG(INFO) << "Selected AVX2 MathEngine for checkPaddingBits() operation";
       return MathOperation<MathEngine::AVX2>::checkPaddingBits;
     } else if (MathOperation<MathEngine::SSE2>::isAvailable()) {
       LOG(INFO) << "Selected SSE2 MathEngine for checkPaddingBits() operation";
       return MathOperation<MathEngine::SSE2>::checkPaddingBits;
+    } else if (MathOperation<MathEngine::NEON>::isAvailable()) {
+      LOG(INFO) << "Selected NEON MathEngine for checkPaddingBits() operation";
+      return MathOperation<MathEngine::NEON>::checkPaddingBits;
     } else {
       LOG(INFO)
           << "Selected SIMPLE MathEngine for checkPaddingBits() operation";
@@ -152,6 +152,18 @@ class LtHash {
   template <typename... Args>
   LtHash<B, N>& removeObject(folly::ByteRange firstRange, Args&&... moreRanges);
 
+  /**
+   * Batch versions of addObject() and removeObject(), which are equivalent
+   * to calling them on each of the objects in turn.
+   *
+   * These set up the Blake2xb digest, which with a key costs a compression
+   * of the key block, once for the whole batch instead of once per object.
+   * Most of the cost of hashing an object is expanding it to the N bytes of
+   * the checksum, which Blake2xb does several blocks at a time with AVX2.
+   */
+  LtHash<B, N>& addObjects(folly::Range<const folly::ByteRange*> objects);
+  LtHash<B, N>& removeObjects(folly::Range<const folly::ByteRange*> objects);
+
   /**
    * Because the addObject() operation in LtHash is commutative and transitive,
    * it's possible to break down a large LtHash computation (i.e. adding 100k
@@ -279,6 +291,11 @@ class LtHash {
       folly::ByteRange firstRange,
       Args&&... moreRanges);
 
+  void initDigest(Blake2xb& digest);
+
+  template <typename Op>
+  void updateObjects(folly::Range<const folly::ByteRange*> objects, Op op);
+
   template <typename... Args>
   void updateDigest(
       Blake2xb& digest, folly::ByteRange range, Args&&... moreRanges);
@@ -40,14 +40,19 @@ static_assert(
 /**
  * Defines available math engines that we can use to perform element-wise
  * modular addition or subtraction of element vectors.
- * - AUTO: pick the best available, from best to worst: AVX2, SSE2, SIMPLE
+ * - AUTO: pick the best available, from best to worst: AVX512, AVX2, SSE2,
+ *   NEON, SIMPLE
  * - SIMPLE: perform addition/subtraction using uint64_t values
  * - SSE2: perform addition/subtraction using 128-bit __m128i values.
  *   Intel only, requires SSE2 instruction support.
  * - AVX2: perform addition/subtraction using 256-bit __m256i values.
  *   Intel only, requires AVX2 instruction support.
+ * - AVX512: perform addition/subtraction using 512-bit __m512i values.
+ *   Intel only, requires AVX512F and AVX512BW instruction support.
+ * - NEON: perform addition/subtraction using 128-bit uint64x2_t values.
+ *   ARM64 only.
  */
-enum class MathEngine { AUTO, SIMPLE, SSE2, AVX2 };
+enum class MathEngine { AUTO, SIMPLE, SSE2, AVX2, AVX512, NEON };
 
 /**
  * This actually implements the bulk addition/subtraction operations.
@@ -141,6 +146,8 @@ FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::AUTO);
 FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::SIMPLE);
 FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::SSE2);
 FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::AVX2);
+FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::AVX512);
+FORWARD_DECLARE_EXTERN_TEMPLATE(MathEngine::NEON);
 
 #undef FORWARD_DECLARE_EXTERN_TEMPLATE
 
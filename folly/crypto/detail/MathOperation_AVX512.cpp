@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Implementation of the MathOperation<MathEngine::AVX512> template
+// specializations.
+#include <folly/crypto/detail/LtHashInternal.h>
+
+#include <glog/logging.h>
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#include <immintrin.h>
+#endif // __AVX512F__ && __AVX512BW__
+
+namespace folly {
+namespace crypto {
+namespace detail {
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+
+// A __m512i is exactly one cache line, so unlike the SSE2 and AVX2 engines,
+// there is no need to gather the results of a cache line before storing them
+// when out is the same as b1 or b2.
+static_assert(
+    kCacheLineSize == sizeof(__m512i),
+    "kCacheLineSize must be sizeof(__m512i)");
+
+// static
+template <>
+bool MathOperation<MathEngine::AVX512>::isImplemented() {
+  return true;
+}
+
+// static
+template <>
+void MathOperation<MathEngine::AVX512>::add(
+    uint64_t dataMask,
+    size_t bitsPerElement,
+    ByteRange b1,
+    ByteRange b2,
+    MutableByteRange out) {
+  DCHECK_EQ(b1.size(), b2.size());
+  DCHECK_EQ(b1.size(), out.size());
+  DCHECK_EQ(0, b1.size() % kCacheLineSize);
+
+  // Note: AVX512 is Intel x86_64 only which is little-endian, so we don't
+  // need the Endian::little() conversions when loading or storing data.
+  if (bitsPerElement == 16 || bitsPerElement == 32) {
+    for (size_t pos = 0; pos < b1.size(); pos += kCacheLineSize) {
+      __m512i v1 = _mm512_load_si512(b1.data() + pos);
+      __m512i v2 = _mm512_load_si512(b2.data() + pos);
+      if (bitsPerElement == 16) {
+        _mm512_store_si512(out.data() + pos, _mm512_add_epi16(v1, v2));
+      } else { // bitsPerElement == 32
+        _mm512_store_si512(out.data() + pos, _mm512_add_epi32(v1, v2));
+      }
+    }
+  } else {
+    __m512i mask = _mm512_set1_epi64(dataMask);
+    for (size_t pos = 0; pos < b1.size(); pos += kCacheLineSize) {
+      __m512i v1 = _mm512_load_si512(b1.data() + pos);
+      __m512i v2 = _mm512_load_si512(b2.data() + pos);
+      _mm512_store_si512(
+          out.data() + pos, _mm512_and_si512(_mm512_add_epi64(v1, v2), mask));
+    }
+  }
+}
+
+// static
+template <>
+void MathOperation<MathEngine::AVX512>::sub(
+    uint64_t dataMask,
+    size_t bitsPerElement,
+    ByteRange b1,
+    ByteRange b2,
+    MutableByteRange out) {
+  DCHECK_EQ(b1.size(), b2.size());
+  DCHECK_EQ(b1.size(), out.size());
+  DCHECK_EQ(0, b1.size() % kCacheLineSize);
+
+  // Note: AVX512 is Intel x86_64 only which is little-endian, so we don't
+  // need the Endian::little() conversions when loading or storing data.
+  if (bitsPerElement == 16 || bitsPerElement == 32) {
+    for (size_t pos = 0; pos < b1.size(); pos += kCacheLineSize) {
+      __m512i v1 = _mm512_load_si512(b1.data() + pos);
+      __m512i v2 = _mm512_load_si512(b2.data() + pos);
+      if (bitsPerElement == 16) {
+        _mm512_store_si512(out.data() + pos, _mm512_sub_epi16(v1, v2));
+      } else { // bitsPerElement == 32
+        _mm512_store_si512(out.data() + pos, _mm512_sub_epi32(v1, v2));
+      }
+    }
+  } else {
+    __m512i mask = _mm512_set1_epi64(dataMask);
+    __m512i paddingMask = _mm512_set1_epi64(~dataMask);
+    for (size_t pos = 0; pos < b1.size(); pos += kCacheLineSize) {
+      __m512i v1 = _mm512_load_si512(b1.data() + pos);
+      __m512i v2 = _mm512_load_si512(b2.data() + pos);
+      __m512i negV2 =
+          _mm512_and_si512(_mm512_sub_epi64(paddingMask, v2), mask);
+      _mm512_store_si512(
+          out.data() + pos,
+          _mm512_and_si512(_mm512_add_epi64(v1, negV2), mask));
+    }
+  }
+}
+
+template <>
+void MathOperation<MathEngine::AVX512>::clearPaddingBits(
+    uint64_t dataMask, MutableByteRange buf) {
+  if (dataMask == 0xffffffffffffffffULL) {
+    return;
+  }
+  DCHECK_EQ(0, buf.size() % kCacheLineSize);
+  __m512i mask = _mm512_set1_epi64(dataMask);
+  for (size_t pos = 0; pos < buf.size(); pos += kCacheLineSize) {
+    _mm512_store_si512(
+        buf.data() + pos,
+        _mm512_and_si512(_mm512_load_si512(buf.data() + pos), mask));
+  }
+}
+
+template <>
+bool MathOperation<MathEngine::AVX512>::checkPaddingBits(
+    uint64_t dataMask, ByteRange buf) {
+  if (dataMask == 0xffffffffffffffffULL) {
+    return true;
+  }
+  DCHECK_EQ(0, buf.size() % kCacheLineSize);
+  __m512i paddingMask = _mm512_set1_epi64(~dataMask);
+  // Accumulate the padding bits of the whole buffer, so that the time taken
+  // doesn't depend on where the first non-0 padding bit is.
+  __m512i paddingBits = _mm512_setzero_si512();
+  for (size_t pos = 0; pos < buf.size(); pos += kCacheLineSize) {
+    paddingBits = _mm512_or_si512(
+        paddingBits,
+        _mm512_and_si512(_mm512_load_si512(buf.data() + pos), paddingMask));
+  }
+  return _mm512_test_epi64_mask(paddingBits, paddingBits) == 0;
+}
+
+#else // !(__AVX512F__ && __AVX512BW__)
+
+// static
+template <>
+bool MathOperation<MathEngine::AVX512>::isImplemented() {
+  return false;
+}
+
+// static
+template <>
+void MathOperation<MathEngine::AVX512>::add(
+    uint64_t /* dataMask */,
+    size_t bitsPerElement,
+    ByteRange /* b1 */,
+    ByteRange /* b2 */,
+    MutableByteRange /* out */) {
+  if (bitsPerElement != 0) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::AVX512>::"
+               << "add() called";
+  }
+}
+
+// static
+template <>
+void MathOperation<MathEngine::AVX512>::sub(
+    uint64_t /* dataMask */,
+    size_t bitsPerElement,
+    ByteRange /* b1 */,
+    ByteRange /* b2 */,
+    MutableByteRange /* out */) {
+  if (bitsPerElement != 0) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::AVX512>::"
+               << "sub() called";
+  }
+}
+
+template <>
+void MathOperation<MathEngine::AVX512>::clearPaddingBits(
+    uint64_t /* dataMask */, MutableByteRange buf) {
+  if (buf.data() != nullptr) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::AVX512>::"
+               << "clearPaddingBits() called";
+  }
+}
+
+template <>
+bool MathOperation<MathEngine::AVX512>::checkPaddingBits(
+    uint64_t /* dataMask */, ByteRange buf) {
+  if (buf.data() != nullptr) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::AVX512>::"
+               << "checkPaddingBits() called";
+  }
+  return false;
+}
+
+#endif // __AVX512F__ && __AVX512BW__
+
+template struct MathOperation<MathEngine::AVX512>;
+
+} // namespace detail
+} // namespace crypto
+} // namespace folly
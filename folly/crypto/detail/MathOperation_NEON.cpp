@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Implementation of the MathOperation<MathEngine::NEON> template
+// specializations.
+#include <folly/crypto/detail/LtHashInternal.h>
+
+#include <glog/logging.h>
+
+#include <folly/Portability.h>
+
+// The checksum is stored as little-endian uint64_t values, which NEON loads
+// as is only on little-endian ARM64.
+#if FOLLY_AARCH64 && FOLLY_NEON && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define FOLLY_DETAIL_LT_HASH_NEON 1
+#else
+#define FOLLY_DETAIL_LT_HASH_NEON 0
+#endif
+
+#if FOLLY_DETAIL_LT_HASH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace folly {
+namespace crypto {
+namespace detail {
+
+#if FOLLY_DETAIL_LT_HASH_NEON
+
+static_assert(
+    kCacheLineSize % sizeof(uint64x2_t) == 0,
+    "kCacheLineSize must be a multiple of sizeof(uint64x2_t)");
+
+// static
+template <>
+bool MathOperation<MathEngine::NEON>::isImplemented() {
+  return true;
+}
+
+// static
+template <>
+void MathOperation<MathEngine::NEON>::add(
+    uint64_t dataMask,
+    size_t bitsPerElement,
+    ByteRange b1,
+    ByteRange b2,
+    MutableByteRange out) {
+  DCHECK_EQ(b1.size(), b2.size());
+  DCHECK_EQ(b1.size(), out.size());
+  DCHECK_EQ(0, b1.size() % kCacheLineSize);
+
+  // Each 16-byte vector is loaded before it is stored, so out may be the same
+  // as b1 or b2.
+  if (bitsPerElement == 16) {
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint16x8_t)) {
+      uint16x8_t v1 = vld1q_u16(reinterpret_cast<const uint16_t*>(&b1[pos]));
+      uint16x8_t v2 = vld1q_u16(reinterpret_cast<const uint16_t*>(&b2[pos]));
+      vst1q_u16(reinterpret_cast<uint16_t*>(&out[pos]), vaddq_u16(v1, v2));
+    }
+  } else if (bitsPerElement == 32) {
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint32x4_t)) {
+      uint32x4_t v1 = vld1q_u32(reinterpret_cast<const uint32_t*>(&b1[pos]));
+      uint32x4_t v2 = vld1q_u32(reinterpret_cast<const uint32_t*>(&b2[pos]));
+      vst1q_u32(reinterpret_cast<uint32_t*>(&out[pos]), vaddq_u32(v1, v2));
+    }
+  } else {
+    uint64x2_t mask = vdupq_n_u64(dataMask);
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint64x2_t)) {
+      uint64x2_t v1 = vld1q_u64(reinterpret_cast<const uint64_t*>(&b1[pos]));
+      uint64x2_t v2 = vld1q_u64(reinterpret_cast<const uint64_t*>(&b2[pos]));
+      vst1q_u64(
+          reinterpret_cast<uint64_t*>(&out[pos]),
+          vandq_u64(vaddq_u64(v1, v2), mask));
+    }
+  }
+}
+
+// static
+template <>
+void MathOperation<MathEngine::NEON>::sub(
+    uint64_t dataMask,
+    size_t bitsPerElement,
+    ByteRange b1,
+    ByteRange b2,
+    MutableByteRange out) {
+  DCHECK_EQ(b1.size(), b2.size());
+  DCHECK_EQ(b1.size(), out.size());
+  DCHECK_EQ(0, b1.size() % kCacheLineSize);
+
+  if (bitsPerElement == 16) {
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint16x8_t)) {
+      uint16x8_t v1 = vld1q_u16(reinterpret_cast<const uint16_t*>(&b1[pos]));
+      uint16x8_t v2 = vld1q_u16(reinterpret_cast<const uint16_t*>(&b2[pos]));
+      vst1q_u16(reinterpret_cast<uint16_t*>(&out[pos]), vsubq_u16(v1, v2));
+    }
+  } else if (bitsPerElement == 32) {
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint32x4_t)) {
+      uint32x4_t v1 = vld1q_u32(reinterpret_cast<const uint32_t*>(&b1[pos]));
+      uint32x4_t v2 = vld1q_u32(reinterpret_cast<const uint32_t*>(&b2[pos]));
+      vst1q_u32(reinterpret_cast<uint32_t*>(&out[pos]), vsubq_u32(v1, v2));
+    }
+  } else {
+    uint64x2_t mask = vdupq_n_u64(dataMask);
+    uint64x2_t paddingMask = vdupq_n_u64(~dataMask);
+    for (size_t pos = 0; pos < b1.size(); pos += sizeof(uint64x2_t)) {
+      uint64x2_t v1 = vld1q_u64(reinterpret_cast<const uint64_t*>(&b1[pos]));
+      uint64x2_t v2 = vld1q_u64(reinterpret_cast<const uint64_t*>(&b2[pos]));
+      uint64x2_t negV2 = vandq_u64(vsubq_u64(paddingMask, v2), mask);
+      vst1q_u64(
+          reinterpret_cast<uint64_t*>(&out[pos]),
+          vandq_u64(vaddq_u64(v1, negV2), mask));
+    }
+  }
+}
+
+template <>
+void MathOperation<MathEngine::NEON>::clearPaddingBits(
+    uint64_t dataMask, MutableByteRange buf) {
+  if (dataMask == 0xffffffffffffffffULL) {
+    return;
+  }
+  DCHECK_EQ(0, buf.size() % kCacheLineSize);
+  uint64x2_t mask = vdupq_n_u64(dataMask);
+  for (size_t pos = 0; pos < buf.size(); pos += sizeof(uint64x2_t)) {
+    auto p = reinterpret_cast<uint64_t*>(&buf[pos]);
+    vst1q_u64(p, vandq_u64(vld1q_u64(p), mask));
+  }
+}
+
+template <>
+bool MathOperation<MathEngine::NEON>::checkPaddingBits(
+    uint64_t dataMask, ByteRange buf) {
+  if (dataMask == 0xffffffffffffffffULL) {
+    return true;
+  }
+  DCHECK_EQ(0, buf.size() % sizeof(uint64x2_t));
+  uint64x2_t paddingMask = vdupq_n_u64(~dataMask);
+  // Accumulate the padding bits of the whole buffer, so that the time taken
+  // doesn't depend on where the first non-0 padding bit is.
+  uint64x2_t paddingBits = vdupq_n_u64(0);
+  for (size_t pos = 0; pos < buf.size(); pos += sizeof(uint64x2_t)) {
+    uint64x2_t val = vld1q_u64(reinterpret_cast<const uint64_t*>(&buf[pos]));
+    paddingBits = vorrq_u64(paddingBits, vandq_u64(val, paddingMask));
+  }
+  return (vgetq_lane_u64(paddingBits, 0) | vgetq_lane_u64(paddingBits, 1)) ==
+      0;
+}
+
+#else // !FOLLY_DETAIL_LT_HASH_NEON
+
+// static
+template <>
+bool MathOperation<MathEngine::NEON>::isImplemented() {
+  return false;
+}
+
+// static
+template <>
+void MathOperation<MathEngine::NEON>::add(
+    uint64_t /* dataMask */,
+    size_t bitsPerElement,
+    ByteRange /* b1 */,
+    ByteRange /* b2 */,
+    MutableByteRange /* out */) {
+  if (bitsPerElement != 0) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::NEON>::"
+               << "add() called";
+  }
+}
+
+// static
+template <>
+void MathOperation<MathEngine::NEON>::sub(
+    uint64_t /* dataMask */,
+    size_t bitsPerElement,
+    ByteRange /* b1 */,
+    ByteRange /* b2 */,
+    MutableByteRange /* out */) {
+  if (bitsPerElement != 0) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::NEON>::"
+               << "sub() called";
+  }
+}
+
+template <>
+void MathOperation<MathEngine::NEON>::clearPaddingBits(
+    uint64_t /* dataMask */, MutableByteRange buf) {
+  if (buf.data() != nullptr) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::NEON>::"
+               << "clearPaddingBits() called";
+  }
+}
+
+template <>
+bool MathOperation<MathEngine::NEON>::checkPaddingBits(
+    uint64_t /* dataMask */, ByteRange buf) {
+  if (buf.data() != nullptr) { // hack to defeat [[noreturn]] compiler warning
+    LOG(FATAL) << "Unimplemented function MathOperation<MathEngine::NEON>::"
+               << "checkPaddingBits() called";
+  }
+  return false;
+}
+
+#endif // FOLLY_DETAIL_LT_HASH_NEON
+
+#undef FOLLY_DETAIL_LT_HASH_NEON
+
+template struct MathOperation<MathEngine::NEON>;
+
+} // namespace detail
+} // namespace crypto
+} // namespace folly
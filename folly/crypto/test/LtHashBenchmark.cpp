@@ -125,6 +125,28 @@ BENCHMARK_RELATIVE(subtractChecksumFor100KObjects_B32_N1024) {
   }
 }
 
+BENCHMARK(addObjectFor100KKeyedObjects_B16_N1024) {
+  LtHash<16, 1024> ltHash;
+  ltHash.setKey(folly::StringPiece("0123456789abcdef"));
+  for (auto i = 0; i < 100000; ++i) {
+    const folly::IOBuf& obj = *(kObjects[i % kObjects.size()]);
+    ltHash.addObject({obj.data(), obj.length()});
+  }
+}
+
+BENCHMARK_RELATIVE(addObjectsFor100KKeyedObjects_B16_N1024) {
+  LtHash<16, 1024> ltHash;
+  std::vector<folly::ByteRange> objects;
+  BENCHMARK_SUSPEND {
+    ltHash.setKey(folly::StringPiece("0123456789abcdef"));
+    for (auto i = 0; i < 100000; ++i) {
+      const folly::IOBuf& obj = *(kObjects[i % kObjects.size()]);
+      objects.push_back({obj.data(), obj.length()});
+    }
+  }
+  ltHash.addObjects(folly::range(objects));
+}
+
 int main(int argc, char** argv) {
   folly::Init init(&argc, &argv);
 
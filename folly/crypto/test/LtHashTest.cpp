@@ -17,9 +17,11 @@
 #include <folly/crypto/LtHash.h>
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <sodium.h>
@@ -374,6 +376,39 @@ TYPED_TEST(LtHashTest, addAndremoveObjectRandom) {
   EXPECT_EQ(TestFixture::kEmptyHash(), h);
 }
 
+TYPED_TEST(LtHashTest, addAndRemoveObjects) {
+  std::vector<std::unique_ptr<folly::IOBuf>> objects;
+  std::vector<folly::ByteRange> ranges;
+  for (size_t i = 0; i < 100; i++) {
+    objects.push_back(makeRandomData(folly::Random::rand32() % 1024));
+    ranges.push_back({objects[i]->data(), objects[i]->length()});
+  }
+  for (bool keyed : {false, true}) {
+    std::string key = "0123456789abcdef";
+    TypeParam h1;
+    TypeParam h2;
+    if (keyed) {
+      h1.setKey(folly::range(key));
+      h2.setKey(folly::range(key));
+    }
+    for (auto range : ranges) {
+      h1.addObject(range);
+    }
+    h2.addObjects(folly::range(ranges));
+    EXPECT_EQ(h1, h2);
+
+    h2.removeObjects(folly::range(ranges).subpiece(0, 50));
+    for (auto range : folly::range(ranges).subpiece(50)) {
+      h2.removeObject(range);
+    }
+    TypeParam empty;
+    if (keyed) {
+      empty.setKey(folly::range(key));
+    }
+    EXPECT_EQ(empty, h2);
+  }
+}
+
 TYPED_TEST(LtHashTest, setChecksum) {
   TypeParam h1;
   h1.addObject(folly::range(this->obj1_));
@@ -707,6 +742,71 @@ TYPED_TEST(LtHashTest, addObjectWithKnownValue) {
   }
 }
 
+// Checks that every available MathEngine computes the same results as the
+// SIMPLE one.
+template <detail::MathEngine E>
+void testMathEngine(uint64_t dataMask, size_t bitsPerElement) {
+  using Simple = detail::MathOperation<detail::MathEngine::SIMPLE>;
+  using Engine = detail::MathOperation<E>;
+  if (!Engine::isAvailable()) {
+    return;
+  }
+  constexpr size_t kSize = 32 * detail::kCacheLineSize;
+  auto b1 = detail::allocateCacheAlignedIOBuf(kSize);
+  auto b2 = detail::allocateCacheAlignedIOBuf(kSize);
+  auto expected = detail::allocateCacheAlignedIOBuf(kSize);
+  auto actual = detail::allocateCacheAlignedIOBuf(kSize);
+  for (auto* buf : {&b1, &b2, &expected, &actual}) {
+    buf->append(kSize);
+  }
+  randombytes_buf(b1.writableData(), kSize);
+  randombytes_buf(b2.writableData(), kSize);
+
+  auto r1 = folly::ByteRange{b1.data(), kSize};
+  auto r2 = folly::ByteRange{b2.data(), kSize};
+  auto expectedRange = folly::MutableByteRange{expected.writableData(), kSize};
+  auto actualRange = folly::MutableByteRange{actual.writableData(), kSize};
+  EXPECT_EQ(
+      Simple::checkPaddingBits(dataMask, r1),
+      Engine::checkPaddingBits(dataMask, r1));
+  Simple::clearPaddingBits(dataMask, {b1.writableData(), kSize});
+  Simple::clearPaddingBits(dataMask, {b2.writableData(), kSize});
+  EXPECT_TRUE(Engine::checkPaddingBits(dataMask, r1));
+
+  Simple::add(dataMask, bitsPerElement, r1, r2, expectedRange);
+  Engine::add(dataMask, bitsPerElement, r1, r2, actualRange);
+  EXPECT_TRUE(folly::IOBufEqualTo()(expected, actual));
+  Simple::sub(dataMask, bitsPerElement, r1, r2, expectedRange);
+  Engine::sub(dataMask, bitsPerElement, r1, r2, actualRange);
+  EXPECT_TRUE(folly::IOBufEqualTo()(expected, actual));
+
+  // In place, as LtHash does.
+  std::memcpy(actual.writableData(), b1.data(), kSize);
+  Engine::add(dataMask, bitsPerElement, actualRange, r2, actualRange);
+  Engine::sub(dataMask, bitsPerElement, actualRange, r2, actualRange);
+  EXPECT_TRUE(folly::IOBufEqualTo()(b1, actual));
+
+  randombytes_buf(actual.writableData(), kSize);
+  std::memcpy(expected.writableData(), actual.data(), kSize);
+  Simple::clearPaddingBits(dataMask, expectedRange);
+  Engine::clearPaddingBits(dataMask, actualRange);
+  EXPECT_TRUE(folly::IOBufEqualTo()(expected, actual));
+}
+
+TEST(LtHashMathEngineTest, matchesSimple) {
+  const std::pair<size_t, uint64_t> params[] = {
+      {16, detail::Bits<16>::kDataMask()},
+      {20, detail::Bits<20>::kDataMask()},
+      {32, detail::Bits<32>::kDataMask()},
+  };
+  for (auto [bits, dataMask] : params) {
+    testMathEngine<detail::MathEngine::SSE2>(dataMask, bits);
+    testMathEngine<detail::MathEngine::AVX2>(dataMask, bits);
+    testMathEngine<detail::MathEngine::AVX512>(dataMask, bits);
+    testMathEngine<detail::MathEngine::NEON>(dataMask, bits);
+  }
+}
+
 TYPED_TEST(LtHashTest, setKeyTooShort) {
   TypeParam h1;
   std::string shortKey = "0123456789abcde";
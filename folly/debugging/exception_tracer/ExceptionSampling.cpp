@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/debugging/exception_tracer/ExceptionSampling.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace folly::exception_tracer {
+
+namespace {
+
+std::atomic<uint32_t> sampleRate{1};
+
+// An open addressing table of the types thrown, which are never removed, so
+// that a type is counted by a compare-and-swap the first time it is thrown
+// and a fetch_add afterwards. Types are hashed and compared by name, as the
+// same type may have a different std::type_info in each shared library.
+constexpr size_t kTableSize = 1024;
+constexpr size_t kMaxProbes = 16;
+
+struct Slot {
+  std::atomic<const std::type_info*> type{nullptr};
+  std::atomic<uint64_t> count{0};
+};
+
+std::array<Slot, kTableSize> table;
+Slot overflow;
+
+Slot& findSlot(const std::type_info* type) noexcept {
+  if (!type) {
+    return overflow;
+  }
+  auto const hash = type->hash_code();
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    auto& slot = table[(hash + i) % kTableSize];
+    auto current = slot.type.load(std::memory_order_acquire);
+    if (!current &&
+        slot.type.compare_exchange_strong(
+            current, type, std::memory_order_acq_rel)) {
+      return slot;
+    }
+    // Either already set, or set by the thread we raced with.
+    if (*current == *type) {
+      return slot;
+    }
+  }
+  return overflow;
+}
+
+} // namespace
+
+void setExceptionTraceSampleRate(uint32_t rate) {
+  sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+uint32_t getExceptionTraceSampleRate() {
+  return sampleRate.load(std::memory_order_relaxed);
+}
+
+std::vector<ExceptionTypeCount> getExceptionTypeCounts() {
+  std::vector<ExceptionTypeCount> result;
+  for (auto& slot : table) {
+    auto const type = slot.type.load(std::memory_order_acquire);
+    auto const count = slot.count.load(std::memory_order_relaxed);
+    // A type is set before its first count.
+    if (type && count > 0) {
+      result.push_back({type, count});
+    }
+  }
+  if (auto const count = overflow.count.load(std::memory_order_relaxed)) {
+    result.push_back({nullptr, count});
+  }
+
+  std::sort(result.begin(), result.end(), [](auto& lhs, auto& rhs) {
+    return lhs.count > rhs.count;
+  });
+  return result;
+}
+
+namespace detail {
+
+bool countThrowAndSample(const std::type_info* type) noexcept {
+  auto const n = findSlot(type).count.fetch_add(1, std::memory_order_relaxed);
+  auto const rate = sampleRate.load(std::memory_order_relaxed);
+  return rate != 0 && n % rate == 0;
+}
+
+} // namespace detail
+
+} // namespace folly::exception_tracer
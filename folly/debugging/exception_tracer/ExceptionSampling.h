@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <typeinfo>
+#include <vector>
+
+namespace folly::exception_tracer {
+
+/**
+ * Capture the stack trace of only one in every rate throws of each exception
+ * type: 1 (the default) captures all of them, 0 none. The first throw of a
+ * type is always captured unless rate is 0.
+ *
+ * Applies to smart_exception_stack_trace_hooks, so that the smart exception
+ * tracer can stay enabled through exception storms; the exceptions that were
+ * not sampled have an empty trace.
+ */
+void setExceptionTraceSampleRate(uint32_t rate);
+uint32_t getExceptionTraceSampleRate();
+
+struct ExceptionTypeCount {
+  // Null for the throws of the types that did not fit in the table.
+  const std::type_info* type;
+  uint64_t count;
+};
+
+/**
+ * The number of exceptions of each type thrown since the start of the
+ * program, most thrown first, as counted by smart_exception_stack_trace_hooks.
+ * Counting is lock-free and does not allocate, and so is always on, even when
+ * no stack trace is captured. Unlike getExceptionStatistics(), reading the
+ * counts does not reset them.
+ */
+std::vector<ExceptionTypeCount> getExceptionTypeCounts();
+
+namespace detail {
+
+/**
+ * Count a throw of type, and return whether to capture its stack trace.
+ */
+bool countThrowAndSample(const std::type_info* type) noexcept;
+
+} // namespace detail
+
+} // namespace folly::exception_tracer
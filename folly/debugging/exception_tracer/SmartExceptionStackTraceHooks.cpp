@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <folly/debugging/exception_tracer/ExceptionSampling.h>
 #include <folly/debugging/exception_tracer/ExceptionTracerLib.h>
 #include <folly/debugging/exception_tracer/SmartExceptionTracerSingleton.h>
 #include <folly/experimental/symbolizer/Symbolizer.h>
@@ -43,9 +44,14 @@ void metaDeleter(void* ex) noexcept {
 
 // This callback runs when an exception is thrown so we can grab the stack
 // trace. To manage the lifetime of the stack trace we override the deleter with
-// our own wrapper.
+// our own wrapper. Throws that are not sampled (see ExceptionSampling.h) are
+// only counted, and have no stack trace.
 void throwCallback(
-    void* ex, std::type_info*, void (**deleter)(void*)) noexcept {
+    void* ex, std::type_info* type, void (**deleter)(void*)) noexcept {
+  if (!detail::countThrowAndSample(type)) {
+    return;
+  }
+
   // Make this code reentrant safe in case we throw an exception while
   // handling an exception. Thread local variables are zero initialized.
   static thread_local bool handlingThrow;
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/debugging/exception_tracer/ExceptionSampling.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <folly/ScopeGuard.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly::exception_tracer;
+
+namespace {
+
+// Each test counts throws of types of its own, as the counts are global.
+template <int>
+struct Tag {};
+
+uint64_t countOf(const std::type_info& type) {
+  auto counts = getExceptionTypeCounts();
+  auto it = std::find_if(counts.begin(), counts.end(), [&](auto& count) {
+    return count.type && *count.type == type;
+  });
+  return it == counts.end() ? 0 : it->count;
+}
+
+} // namespace
+
+TEST(ExceptionSampling, countsByType) {
+  EXPECT_EQ(0, countOf(typeid(Tag<0>)));
+  for (int i = 0; i < 3; ++i) {
+    detail::countThrowAndSample(&typeid(Tag<0>));
+  }
+  detail::countThrowAndSample(&typeid(Tag<1>));
+  EXPECT_EQ(3, countOf(typeid(Tag<0>)));
+  EXPECT_EQ(1, countOf(typeid(Tag<1>)));
+
+  auto counts = getExceptionTypeCounts();
+  EXPECT_TRUE(std::is_sorted(
+      counts.begin(), counts.end(), [](auto& lhs, auto& rhs) {
+        return lhs.count > rhs.count;
+      }));
+}
+
+TEST(ExceptionSampling, sampleRate) {
+  EXPECT_EQ(1, getExceptionTraceSampleRate());
+  SCOPE_EXIT {
+    setExceptionTraceSampleRate(1);
+  };
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(detail::countThrowAndSample(&typeid(Tag<2>)));
+  }
+
+  setExceptionTraceSampleRate(4);
+  std::vector<bool> sampled;
+  for (int i = 0; i < 8; ++i) {
+    sampled.push_back(detail::countThrowAndSample(&typeid(Tag<3>)));
+  }
+  EXPECT_EQ(
+      (std::vector<bool>{true, false, false, false, true, false, false, false}),
+      sampled);
+
+  setExceptionTraceSampleRate(0);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(detail::countThrowAndSample(&typeid(Tag<4>)));
+  }
+  EXPECT_EQ(3, countOf(typeid(Tag<4>)));
+}
+
+TEST(ExceptionSampling, unknownType) {
+  auto overflow = [] {
+    auto counts = getExceptionTypeCounts();
+    auto it = std::find_if(counts.begin(), counts.end(), [](auto& count) {
+      return !count.type;
+    });
+    return it == counts.end() ? 0 : it->count;
+  };
+  auto const before = overflow();
+  detail::countThrowAndSample(nullptr);
+  EXPECT_EQ(before + 1, overflow());
+}
+
+TEST(ExceptionSampling, concurrentThreads) {
+  constexpr int kThreads = 8;
+  constexpr int kThrows = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([] {
+      for (int j = 0; j < kThrows; ++j) {
+        detail::countThrowAndSample(&typeid(Tag<5>));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(kThreads * kThrows, countOf(typeid(Tag<5>)));
+}
@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <folly/ScopeGuard.h>
 #include <folly/coro/BlockingWait.h>
 #include <folly/coro/Task.h>
+#include <folly/debugging/exception_tracer/ExceptionSampling.h>
 #include <folly/debugging/exception_tracer/SmartExceptionTracer.h>
 #include <folly/portability/GTest.h>
 
@@ -57,6 +59,28 @@ TEST(SmartExceptionTracer, StdException) {
   }
 }
 
+TEST(SmartExceptionTracer, SampledTraces) {
+  // Of a type of its own, so that this test counts all its throws.
+  struct SampledException : std::exception {};
+
+  setExceptionTraceSampleRate(3);
+  SCOPE_EXIT {
+    setExceptionTraceSampleRate(1);
+  };
+  for (int i = 0; i < 6; ++i) {
+    SCOPED_TRACE(i);
+    auto ew = folly::try_and_catch([] { throw SampledException(); });
+    EXPECT_EQ(i % 3 == 0, !getTrace(ew).frames.empty());
+  }
+
+  auto counts = getExceptionTypeCounts();
+  auto it = std::find_if(counts.begin(), counts.end(), [](auto& count) {
+    return count.type && *count.type == typeid(SampledException);
+  });
+  ASSERT_NE(counts.end(), it);
+  EXPECT_EQ(6, it->count);
+}
+
 TEST(SmartExceptionTracer, EmptyExceptionWrapper) {
   auto ew = folly::exception_wrapper();
   auto info = getTrace(ew);
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/debugging/symbolizer/AsyncStackSampler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <dirent.h>
+
+#include <fmt/format.h>
+
+#include <folly/Conv.h>
+#include <folly/Demangle.h>
+#include <folly/Exception.h>
+#include <folly/String.h>
+#include <folly/debugging/symbolizer/StackTrace.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/SysSyscall.h>
+#include <folly/portability/Unistd.h>
+#include <folly/system/ThreadId.h>
+
+namespace folly {
+namespace symbolizer {
+
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
+
+namespace detail {
+
+// The samples of the signal handlers, in slots which each goes from free, to
+// written by a handler, to ready, to read and freed by the sampler thread.
+struct AsyncStackSamplerBuffer {
+  static constexpr size_t kMaxFrames = AsyncStackSampler::kMaxFrames;
+
+  enum : uint32_t { kFree, kWriting, kReady };
+
+  struct Slot {
+    std::atomic<uint32_t> state{kFree};
+    uint32_t size = 0;
+    uintptr_t frames[kMaxFrames];
+  };
+
+  explicit AsyncStackSamplerBuffer(size_t size)
+      : slots(std::max<size_t>(size, 1)) {}
+
+  // Async-signal-safe.
+  void record(const void* context) {
+    auto const index = next.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots[index % slots.size()];
+    auto expected = uint32_t(kFree);
+    if (!slot.state.compare_exchange_strong(
+            expected, kWriting, std::memory_order_acquire)) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    auto const size =
+        getStackTraceFromSignalContextSafe(context, slot.frames, kMaxFrames);
+    if (size <= 0) {
+      slot.state.store(kFree, std::memory_order_release);
+      return;
+    }
+    slot.size = uint32_t(size);
+    slot.state.store(kReady, std::memory_order_release);
+  }
+
+  std::vector<Slot> slots;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> dropped{0};
+};
+
+} // namespace detail
+
+namespace {
+
+using Buffer = detail::AsyncStackSamplerBuffer;
+
+// The buffer of the running sampler, if any, and the handlers running, which
+// stop() waits for before reading it for the last time.
+std::atomic<Buffer*> gBuffer{nullptr};
+std::atomic<size_t> gHandlersRunning{0};
+// The signals which sampleHandler handles.
+std::atomic<uint64_t> gInstalledSignals{0};
+
+void sampleHandler(int, siginfo_t*, void* context) {
+  auto const savedErrno = errno;
+  gHandlersRunning.fetch_add(1);
+  if (auto const buffer = gBuffer.load()) {
+    buffer->record(context);
+  }
+  gHandlersRunning.fetch_sub(1);
+  errno = savedErrno;
+}
+
+// Sends the signal to the threads of the process but the calling one.
+void signalThreads(int signal) {
+  auto const pid = getpid();
+  auto const self = getOSThreadID();
+  auto const dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return;
+  }
+  while (auto const entry = readdir(dir)) {
+    char* end;
+    auto const tid = std::strtoull(entry->d_name, &end, 10);
+    if (end == entry->d_name || *end != '\0' || tid == self) {
+      continue;
+    }
+    syscall(SYS_tgkill, pid, pid_t(tid), signal);
+  }
+  closedir(dir);
+}
+
+} // namespace
+
+AsyncStackSampler::AsyncStackSampler(Options options)
+    : options_(options),
+      buffer_(std::make_unique<Buffer>(options.bufferSize)) {}
+
+AsyncStackSampler::~AsyncStackSampler() {
+  stop();
+}
+
+void AsyncStackSampler::start() {
+  if (thread_.joinable()) {
+    throw_exception<std::logic_error>("AsyncStackSampler is already running");
+  }
+  Buffer* expected = nullptr;
+  if (!gBuffer.compare_exchange_strong(expected, buffer_.get())) {
+    throw_exception<std::logic_error>("another AsyncStackSampler is running");
+  }
+
+  // Installed once, and left installed: see the class comment.
+  auto const bit = uint64_t(1) << (options_.signal % 64);
+  if (!(gInstalledSignals.fetch_or(bit) & bit)) {
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sampleHandler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(options_.signal, &sa, nullptr) != 0) {
+      gInstalledSignals.fetch_and(~bit);
+      gBuffer.store(nullptr);
+      throwSystemError("AsyncStackSampler: sigaction");
+    }
+  }
+
+  stopping_ = false;
+  thread_ = std::thread([this] { run(); });
+}
+
+void AsyncStackSampler::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  stopped_.notify_one();
+  thread_.join();
+
+  gBuffer.store(nullptr);
+  while (gHandlersRunning.load() != 0) {
+    std::this_thread::yield();
+  }
+  drain();
+}
+
+void AsyncStackSampler::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_.wait_for(
+      lock, options_.period, [&] { return stopping_; })) {
+    lock.unlock();
+    signalThreads(options_.signal);
+    drain();
+    lock.lock();
+  }
+}
+
+void AsyncStackSampler::drain() {
+  std::vector<uintptr_t> stack;
+  for (auto& slot : buffer_->slots) {
+    if (slot.state.load(std::memory_order_acquire) != Buffer::kReady) {
+      continue;
+    }
+    stack.assign(slot.frames, slot.frames + slot.size);
+    slot.state.store(Buffer::kFree, std::memory_order_release);
+    // Return addresses are those after the calls, which may be in the next
+    // function or line. The first address is the interrupted instruction.
+    for (size_t i = 1; i < stack.size(); ++i) {
+      --stack[i];
+    }
+    ++(*stacks_.wlock())[stack];
+  }
+}
+
+size_t AsyncStackSampler::samples() const {
+  size_t samples = 0;
+  for (auto const& [stack, count] : *stacks_.rlock()) {
+    samples += count;
+  }
+  return samples;
+}
+
+size_t AsyncStackSampler::dropped() const {
+  return buffer_->dropped.load(std::memory_order_relaxed);
+}
+
+std::vector<std::pair<std::vector<uintptr_t>, size_t>>
+AsyncStackSampler::stacks() const {
+  auto const stacks = stacks_.rlock();
+  return {stacks->begin(), stacks->end()};
+}
+
+std::string AsyncStackSampler::folded() const {
+  auto const stacks = this->stacks();
+  std::vector<uintptr_t> addresses;
+  for (auto const& [stack, count] : stacks) {
+    addresses.insert(addresses.end(), stack.begin(), stack.end());
+  }
+  // A symbol cache, so that the .debug_aranges index is built.
+  Symbolizer symbolizer(nullptr, LocationInfoMode::FULL_WITH_INLINE, 1);
+  auto const batch = symbolizer.symbolizeBatch(folly::range(addresses));
+
+  std::vector<std::string> lines;
+  std::vector<std::string> names;
+  size_t next = 0;
+  for (auto const& [stack, count] : stacks) {
+    names.clear();
+    for (size_t i = 0; i < stack.size(); ++i, ++next) {
+      for (auto const& frame : batch[next]) {
+        names.push_back(
+            frame.found && frame.name
+                ? demangle(frame.name).toStdString()
+                : fmt::format("{:#x}", stack[i]));
+      }
+    }
+    std::reverse(names.begin(), names.end());
+    lines.push_back(join(';', names) + ' ' + folly::to<std::string>(count));
+  }
+  std::sort(lines.begin(), lines.end());
+  std::string folded;
+  for (auto const& line : lines) {
+    folded += line;
+    folded += '\n';
+  }
+  return folded;
+}
+
+#endif // FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
+
+} // namespace symbolizer
+} // namespace folly
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <folly/Synchronized.h>
+#include <folly/container/F14Map.h>
+#include <folly/debugging/symbolizer/Symbolizer.h>
+#include <folly/hash/Hash.h>
+
+namespace folly {
+namespace symbolizer {
+
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
+
+namespace detail {
+struct AsyncStackSamplerBuffer;
+} // namespace detail
+
+/**
+ * A sampling profiler of the threads of the process which sees through
+ * coroutines. Where a thread runs an async operation, its stacks have the
+ * frames of the coroutines awaiting it in place of those of the executor loop
+ * that resumed it, as getAsyncStackTraceSafe() gives them: in a coroutine
+ * heavy service, native stacks mostly show executor loops.
+ *
+ * Every period, a thread of the sampler sends a signal to each other thread
+ * of the process. The async-signal-safe handler records the stack of the code
+ * it interrupted into a fixed buffer (see
+ * getStackTraceFromSignalContextSafe()), which the sampler thread drains into
+ * a count of each distinct stack. folded() gives them symbolized, in the
+ * format of flame graph tools:
+ *
+ *   AsyncStackSampler sampler;
+ *   sampler.start();
+ *   runWorkload();
+ *   sampler.stop();
+ *   writeFile(sampler.folded(), "profile.folded");
+ *
+ * Sampling is by wall time: the threads that wait are sampled as often as
+ * those that run. Caveats, as for any profiler by signals:
+ *  - The threads blocking the signal aren't sampled.
+ *  - The handler is installed with SA_RESTART, but some system calls, such
+ *    as epoll_wait(), fail with EINTR when interrupted all the same.
+ *  - The native frames are found by their frame pointers, so the callers of
+ *    leaf functions and of code built without them may be missing.
+ *  - The handler is process wide, so a single sampler runs at a time. It
+ *    stays installed after stop(), so that a signal still in flight is
+ *    ignored rather than kill the process.
+ */
+class AsyncStackSampler {
+ public:
+  static constexpr size_t kMaxFrames = 128;
+
+  struct Options {
+    // The time between two samples of each thread.
+    std::chrono::microseconds period{std::chrono::milliseconds(10)};
+    int signal = SIGPROF;
+    // The samples held between two drains of the buffer. Those taken while
+    // it is full are dropped.
+    size_t bufferSize = 256;
+  };
+
+  AsyncStackSampler() : AsyncStackSampler(Options()) {}
+  explicit AsyncStackSampler(Options options);
+  ~AsyncStackSampler();
+
+  AsyncStackSampler(const AsyncStackSampler&) = delete;
+  AsyncStackSampler& operator=(const AsyncStackSampler&) = delete;
+
+  /**
+   * Starts sampling. The stacks sampled before, if it was stopped, are kept.
+   *
+   * @throws std::logic_error if a sampler is already running.
+   */
+  void start();
+
+  /**
+   * Stops sampling, once the samples already taken are counted. Does
+   * nothing if it isn't running.
+   */
+  void stop();
+
+  // The samples counted so far.
+  size_t samples() const;
+  // The samples dropped because the buffer was full.
+  size_t dropped() const;
+
+  /**
+   * The distinct stacks sampled so far, leaf first, and their counts. The
+   * return addresses point to the calls, as those of getStackTrace() do.
+   */
+  std::vector<std::pair<std::vector<uintptr_t>, size_t>> stacks() const;
+
+  /**
+   * The stacks sampled so far, symbolized with their inlined frames, one
+   * per line, root first, followed by its count:
+   *
+   *   main;folly::EventBase::loopBody;handleRequest;lookup 42
+   */
+  std::string folded() const;
+
+ private:
+  struct StackHash {
+    size_t operator()(const std::vector<uintptr_t>& stack) const {
+      return hash::hash_range(stack.begin(), stack.end());
+    }
+  };
+
+  void run();
+  void drain();
+
+  const Options options_;
+  const std::unique_ptr<detail::AsyncStackSamplerBuffer> buffer_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable stopped_;
+  bool stopping_ = false;
+
+  folly::Synchronized<F14FastMap<std::vector<uintptr_t>, size_t, StackHash>>
+      stacks_;
+};
+
+#endif // FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
+
+} // namespace symbolizer
+} // namespace folly
@@ -16,11 +16,14 @@
 
 #include <folly/debugging/symbolizer/Dwarf.h>
 
+#include <algorithm>
 #include <array>
 #include <type_traits>
 
+#include <folly/MapUtil.h>
 #include <folly/Optional.h>
 #include <folly/debugging/symbolizer/DwarfImpl.h>
+#include <folly/debugging/symbolizer/DwarfLineNumberVM.h>
 #include <folly/debugging/symbolizer/DwarfSection.h>
 #include <folly/lang/SafeAssert.h>
 #include <folly/portability/Config.h>
@@ -32,8 +35,14 @@
 namespace folly {
 namespace symbolizer {
 
-Dwarf::Dwarf(ElfCacheBase* elfCache, const ElfFile* elf)
+Dwarf::Dwarf(
+    ElfCacheBase* elfCache,
+    const ElfFile* elf,
+    const DwarfArangesIndex* arangesIndex,
+    const DwarfLineIndex* lineIndex)
     : elfCache_(elfCache),
+      arangesIndex_(arangesIndex),
+      lineIndex_(lineIndex),
       defaultDebugSections_{
           .elf = elf,
           .debugCuIndex = getElfSection(elf, ".debug_cu_index"),
@@ -66,11 +75,12 @@ Dwarf::Dwarf(ElfCacheBase* elfCache, const ElfFile* elf)
 namespace {
 
 /**
- * Find @address in .debug_aranges and return the offset in
- * .debug_info for compilation unit to which this address belongs.
+ * Call fn(start, length, offset) for each address range in .debug_aranges,
+ * offset being that in .debug_info of the compilation unit of the range,
+ * until fn returns true. Returns whether fn did.
  */
-bool findDebugInfoOffset(
-    uintptr_t address, StringPiece aranges, uint64_t& offset) {
+template <typename F>
+bool forEachArange(StringPiece aranges, F&& fn) {
   DwarfSection section(aranges);
   folly::StringPiece chunk;
   while (section.next(chunk)) {
@@ -80,7 +90,7 @@ bool findDebugInfoOffset(
       return false;
     }
 
-    offset = readOffset(chunk, section.is64Bit());
+    uint64_t offset = readOffset(chunk, section.is64Bit());
     auto addressSize = read<uint8_t>(chunk);
     if (addressSize != sizeof(uintptr_t)) {
       FOLLY_SAFE_DFATAL("invalid address size: ", addressSize);
@@ -121,8 +131,7 @@ bool findDebugInfoOffset(
         break;
       }
 
-      // Is our address in this range?
-      if (address >= start && address < start + length) {
+      if (fn(start, length, offset)) {
         return true;
       }
     }
@@ -130,8 +139,70 @@ bool findDebugInfoOffset(
   return false;
 }
 
+/**
+ * Find @address in .debug_aranges and return the offset in
+ * .debug_info for compilation unit to which this address belongs.
+ */
+bool findDebugInfoOffset(
+    uintptr_t address, StringPiece aranges, uint64_t& offset) {
+  return forEachArange(
+      aranges, [&](uintptr_t start, uintptr_t length, uint64_t unitOffset) {
+        // Is our address in this range?
+        if (address >= start && address < start + length) {
+          offset = unitOffset;
+          return true;
+        }
+        return false;
+      });
+}
+
 } // namespace
 
+DwarfArangesIndex::DwarfArangesIndex(const ElfFile* elf) {
+  auto const aranges = getElfSection(elf, ".debug_aranges");
+  forEachArange(
+      aranges, [&](uintptr_t start, uintptr_t length, uint64_t offset) {
+        if (length != 0) {
+          ranges_.push_back({start, start + length, offset, 0});
+        }
+        return false;
+      });
+  std::sort(ranges_.begin(), ranges_.end(), [](auto& a, auto& b) {
+    return a.start < b.start;
+  });
+  uintptr_t maxEnd = 0;
+  for (auto& range : ranges_) {
+    maxEnd = std::max(maxEnd, range.end);
+    range.maxEnd = maxEnd;
+  }
+}
+
+bool DwarfArangesIndex::findDebugInfoOffset(
+    uintptr_t address, uint64_t& offset) const {
+  auto it = std::upper_bound(
+      ranges_.begin(), ranges_.end(), address, [](uintptr_t a, auto& range) {
+        return a < range.start;
+      });
+  // The ranges rarely overlap, but when they do the one containing address
+  // may start before the last one starting at or below it.
+  while (it != ranges_.begin() && (--it)->maxEnd > address) {
+    if (address < it->end) {
+      offset = it->offset;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::shared_ptr<const DwarfLineTable> DwarfLineIndex::getTable(
+    uint64_t offset, folly::FunctionRef<DwarfLineTable()> build) const {
+  if (auto table = folly::get_default(*tables_.rlock(), offset)) {
+    return table;
+  }
+  auto table = std::make_shared<const DwarfLineTable>(build());
+  return tables_.wlock()->try_emplace(offset, std::move(table)).first->second;
+}
+
 bool Dwarf::findAddress(
     uintptr_t address,
     LocationInfoMode mode,
@@ -151,8 +222,10 @@ bool Dwarf::findAddress(
     // Fast path: find the right .debug_info entry by looking up the
     // address in .debug_aranges.
     uint64_t offset = 0;
-    if (findDebugInfoOffset(
-            address, defaultDebugSections_.debugAranges, offset)) {
+    if (arangesIndex_
+            ? arangesIndex_->findDebugInfoOffset(address, offset)
+            : findDebugInfoOffset(
+                  address, defaultDebugSections_.debugAranges, offset)) {
       // Read compilation unit header from .debug_info
       auto unit = getCompilationUnits(
           elfCache_,
@@ -163,7 +236,7 @@ bool Dwarf::findAddress(
           unit.mainCompilationUnit.unitType != DW_UT_skeleton) {
         return false;
       }
-      DwarfImpl impl(elfCache_, unit, mode);
+      DwarfImpl impl(elfCache_, unit, mode, lineIndex_);
       return impl.findLocation(
           address,
           frame,
@@ -199,7 +272,7 @@ bool Dwarf::findAddress(
         unit.mainCompilationUnit.unitType != DW_UT_skeleton) {
       continue;
     }
-    DwarfImpl impl(elfCache_, unit, mode);
+    DwarfImpl impl(elfCache_, unit, mode, lineIndex_);
     if (impl.findLocation(
             address,
             frame,
@@ -18,8 +18,14 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include <folly/Function.h>
 #include <folly/Range.h>
+#include <folly/Synchronized.h>
 #include <folly/debugging/symbolizer/DwarfUtil.h>
 #include <folly/experimental/symbolizer/Elf.h>
 #include <folly/experimental/symbolizer/ElfCache.h>
@@ -30,6 +36,66 @@ namespace symbolizer {
 
 #if FOLLY_HAVE_DWARF && FOLLY_HAVE_ELF
 
+/**
+ * The address ranges of .debug_aranges, sorted, so that finding the
+ * compilation unit of an address is a binary search rather than a parse of
+ * the whole section. Built once per ELF file, by the symbolizers that may
+ * allocate (see Symbolizer), and passed to Dwarf.
+ */
+class DwarfArangesIndex {
+ public:
+  explicit DwarfArangesIndex(const ElfFile* elf);
+
+  /**
+   * Find the offset in .debug_info of the compilation unit to which address
+   * belongs.
+   */
+  bool findDebugInfoOffset(uintptr_t address, uint64_t& offset) const;
+
+  size_t size() const { return ranges_.size(); }
+
+ private:
+  struct Arange {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t offset;
+    // The greatest end of this and the preceding ranges.
+    uintptr_t maxEnd;
+  };
+
+  std::vector<Arange> ranges_;
+};
+
+class DwarfLineTable;
+
+/**
+ * The line tables (see DwarfLineTable) of the compilation units of an ELF
+ * file, by offset of their line number program in .debug_line, each built
+ * the first time an address of its compilation unit is looked up. Owned, like
+ * DwarfArangesIndex, by the symbolizers that may allocate, and passed to
+ * Dwarf.
+ */
+class DwarfLineIndex {
+ public:
+  explicit DwarfLineIndex(const ElfFile* elf) : elf_(elf) {}
+
+  const ElfFile* elf() const { return elf_; }
+
+  /**
+   * The table of the line number program at offset, from build if there is
+   * none yet. build runs without a lock held; if two threads race, the
+   * table of the first one to finish is kept.
+   */
+  std::shared_ptr<const DwarfLineTable> getTable(
+      uint64_t offset, folly::FunctionRef<DwarfLineTable()> build) const;
+
+ private:
+  const ElfFile* elf_;
+  mutable folly::Synchronized<
+      std::unordered_map<uint64_t, std::shared_ptr<const DwarfLineTable>>>
+      tables_;
+};
+
 /**
  * DWARF record parser.
  *
@@ -60,8 +126,15 @@ class Dwarf {
    * be live for as long as the passed-in ElfFile is live.
    */
  public:
-  /** Create a DWARF parser around an ELF file. */
-  Dwarf(ElfCacheBase* elfCache, const ElfFile* elf);
+  /**
+   * Create a DWARF parser around an ELF file. arangesIndex and lineIndex, if
+   * any, must be those of elf. Lookups through lineIndex allocate.
+   */
+  Dwarf(
+      ElfCacheBase* elfCache,
+      const ElfFile* elf,
+      const DwarfArangesIndex* arangesIndex = nullptr,
+      const DwarfLineIndex* lineIndex = nullptr);
 
   /**
    * Find the file and line number information corresponding to address.
@@ -78,6 +151,8 @@ class Dwarf {
 
  private:
   ElfCacheBase* elfCache_;
+  const DwarfArangesIndex* arangesIndex_;
+  const DwarfLineIndex* lineIndex_;
   DebugSections defaultDebugSections_;
 };
 
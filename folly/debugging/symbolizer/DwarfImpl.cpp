@@ -21,6 +21,7 @@
 #include <type_traits>
 
 #include <folly/Optional.h>
+#include <folly/debugging/symbolizer/Dwarf.h>
 #include <folly/debugging/symbolizer/DwarfUtil.h>
 #include <folly/lang/SafeAssert.h>
 #include <folly/portability/Config.h>
@@ -46,8 +47,11 @@ struct CallLocation {
 };
 
 DwarfImpl::DwarfImpl(
-    ElfCacheBase* elfCache, CompilationUnits& cu, LocationInfoMode mode)
-    : elfCache_(elfCache), cu_(cu), mode_(mode) {}
+    ElfCacheBase* elfCache,
+    CompilationUnits& cu,
+    LocationInfoMode mode,
+    const DwarfLineIndex* lineIndex)
+    : elfCache_(elfCache), cu_(cu), mode_(mode), lineIndex_(lineIndex) {}
 
 /**
  * Find the @locationInfo for @address in the compilation unit @cu_.
@@ -185,9 +189,17 @@ bool DwarfImpl::findLocation(
   DwarfLineNumberVM lineVM(
       lineSection, compilationDirectory, mainCu.debugSections);
 
-  // Execute line number VM program to find file and line
-  frame.location.hasFileAndLine =
-      lineVM.findAddress(address, frame.location.file, frame.location.line);
+  // Look file and line up in the line table of the program, if indexed,
+  // otherwise execute the program until it reaches address.
+  if (lineIndex_ && lineIndex_->elf() == mainCu.debugSections.elf) {
+    auto table = lineIndex_->getTable(
+        *lineOffset, [&] { return lineVM.buildTable(); });
+    frame.location.hasFileAndLine = lineVM.findAddress(
+        *table, address, frame.location.file, frame.location.line);
+  } else {
+    frame.location.hasFileAndLine =
+        lineVM.findAddress(address, frame.location.file, frame.location.line);
+  }
   if (!frame.location.hasFileAndLine) {
     return false;
   }
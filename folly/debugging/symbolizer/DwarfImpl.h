@@ -35,11 +35,19 @@ namespace symbolizer {
 #if FOLLY_HAVE_DWARF && FOLLY_HAVE_ELF
 
 struct CallLocation;
+class DwarfLineIndex;
 
 class DwarfImpl {
  public:
+  /**
+   * lineIndex, if any, is used to find the line of addresses of the
+   * compilation units in the ELF file it indexes.
+   */
   explicit DwarfImpl(
-      ElfCacheBase* elfCache, CompilationUnits& cu, LocationInfoMode mode);
+      ElfCacheBase* elfCache,
+      CompilationUnits& cu,
+      LocationInfoMode mode,
+      const DwarfLineIndex* lineIndex = nullptr);
 
   /**
    * Find the @locationInfo for @address in the compilation unit @cu.
@@ -123,6 +131,7 @@ class DwarfImpl {
   ElfCacheBase* elfCache_;
   CompilationUnits& cu_;
   const LocationInfoMode mode_;
+  const DwarfLineIndex* lineIndex_;
 };
 
 #endif
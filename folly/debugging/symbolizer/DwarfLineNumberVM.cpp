@@ -16,6 +16,8 @@
 
 #include <folly/debugging/symbolizer/DwarfLineNumberVM.h>
 
+#include <algorithm>
+
 #include <folly/Optional.h>
 #include <folly/debugging/symbolizer/DwarfSection.h>
 
@@ -24,6 +26,35 @@
 namespace folly {
 namespace symbolizer {
 
+DwarfLineTable::DwarfLineTable(std::vector<Row> rows)
+    : rows_(std::move(rows)) {
+  std::sort(rows_.begin(), rows_.end(), [](auto& a, auto& b) {
+    return a.start < b.start;
+  });
+  uintptr_t maxEnd = 0;
+  for (auto& row : rows_) {
+    maxEnd = std::max(maxEnd, row.end);
+    row.maxEnd = maxEnd;
+  }
+}
+
+const DwarfLineTable::Row* DwarfLineTable::find(uintptr_t address) const {
+  auto it = std::upper_bound(
+      rows_.begin(), rows_.end(), address, [](uintptr_t a, auto& row) {
+        return a < row.start;
+      });
+  // Rows of a sequence do not overlap, but sequences may (e.g. those of
+  // functions discarded by the linker all start at 0). Look at all the rows
+  // that may contain address for the one of the first sequence.
+  const Row* found = nullptr;
+  while (it != rows_.begin() && (--it)->maxEnd > address) {
+    if (address < it->end && (!found || it->sequence < found->sequence)) {
+      found = &*it;
+    }
+  }
+  return found;
+}
+
 DwarfLineNumberVM::DwarfLineNumberVM(
     folly::StringPiece data,
     folly::StringPiece compilationDirectory,
@@ -712,6 +743,66 @@ bool DwarfLineNumberVM::findAddress(
   return false;
 }
 
+DwarfLineTable DwarfLineNumberVM::buildTable() {
+  std::vector<DwarfLineTable::Row> rows;
+  if (!initializationSuccess_) {
+    return DwarfLineTable(std::move(rows));
+  }
+  folly::StringPiece program = data_;
+
+  // Each row covers the addresses up to the next one of its sequence, the
+  // last one being the past-the-end entry of DW_LNE_end_sequence; see
+  // findAddress(). A row at the same address as the next one is superseded
+  // by it.
+  reset();
+  uint64_t sequence = 0;
+  bool inSequence = false;
+  uint64_t prevAddress = 0;
+  uint64_t prevFile = 0;
+  uint64_t prevLine = 0;
+  while (!program.empty()) {
+    bool seqEnd = !next(program);
+
+    if (inSequence && address_ > prevAddress) {
+      rows.push_back({prevAddress, address_, prevFile, prevLine, sequence, 0});
+    }
+
+    if (seqEnd) {
+      ++sequence;
+      inSequence = false;
+      reset();
+      continue;
+    }
+    inSequence = true;
+    prevAddress = address_;
+    prevFile = file_;
+    prevLine = line_;
+  }
+
+  return DwarfLineTable(std::move(rows));
+}
+
+bool DwarfLineNumberVM::findAddress(
+    const DwarfLineTable& table,
+    uintptr_t target,
+    Path& file,
+    uint64_t& line) const {
+  if (!initializationSuccess_) {
+    return false;
+  }
+  auto row = table.find(target);
+  if (!row) {
+    return false;
+  }
+  // See findAddress() for file 0.
+  if (version_ <= 4 && row->file == 0) {
+    return false;
+  }
+  file = getFullFileName(row->file);
+  line = row->line;
+  return true;
+}
+
 } // namespace symbolizer
 } // namespace folly
 
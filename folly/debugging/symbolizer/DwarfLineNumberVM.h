@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <folly/Range.h>
 #include <folly/debugging/symbolizer/DwarfUtil.h>
 #include <folly/experimental/symbolizer/SymbolizedFrame.h>
@@ -25,6 +28,38 @@ namespace symbolizer {
 
 #if FOLLY_HAVE_DWARF && FOLLY_HAVE_ELF
 
+/**
+ * The rows of a line number program as address ranges, sorted, so that the
+ * row of an address is a binary search rather than an execution of the
+ * program from the start. Built by DwarfLineNumberVM::buildTable().
+ */
+class DwarfLineTable {
+ public:
+  struct Row {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t file;
+    uint64_t line;
+    // The index of the sequence of the row in the program.
+    uint64_t sequence;
+    // The greatest end of this and the preceding rows.
+    uintptr_t maxEnd;
+  };
+
+  explicit DwarfLineTable(std::vector<Row> rows);
+
+  /**
+   * Find the row whose range contains address. As when executing the
+   * program, if sequences overlap, the first one containing address wins.
+   */
+  const Row* find(uintptr_t address) const;
+
+  size_t size() const { return rows_.size(); }
+
+ private:
+  std::vector<Row> rows_;
+};
+
 class DwarfLineNumberVM {
  public:
   DwarfLineNumberVM(
@@ -34,6 +69,22 @@ class DwarfLineNumberVM {
 
   bool findAddress(uintptr_t target, Path& file, uint64_t& line);
 
+  /**
+   * Same as findAddress(), but look the address up in table, which must
+   * have been built from this program.
+   */
+  bool findAddress(
+      const DwarfLineTable& table,
+      uintptr_t target,
+      Path& file,
+      uint64_t& line) const;
+
+  /**
+   * Execute the whole program and return its rows. Allocates, unlike the
+   * rest of this class.
+   */
+  DwarfLineTable buildTable();
+
   /** Gets full file name at given index including directory. */
   Path getFullFileName(uint64_t index) const;
 
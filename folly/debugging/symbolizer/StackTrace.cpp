@@ -34,6 +34,10 @@
 #include <execinfo.h>
 #endif
 
+#if defined(__linux__)
+#include <ucontext.h>
+#endif
+
 namespace folly {
 namespace symbolizer {
 
@@ -293,27 +297,23 @@ WalkAsyncStackResult walkAsyncStack(
   }
   return result;
 }
-} // namespace
 
-ssize_t getAsyncStackTraceSafe(uintptr_t* addresses, size_t maxAddresses) {
+// Walks the normal stack from normalStackFrame, switching to the async stack
+// frames of asyncStackRoot, if any, at the normal frame that holds it, and so
+// on down the chain of roots.
+size_t walkStacks(
+    uintptr_t* addresses,
+    size_t maxAddresses,
+    StackFrame* normalStackFrame,
+    const AsyncStackRoot* asyncStackRoot) {
   size_t numFrames = 0;
-  const auto* asyncStackRoot = tryGetCurrentAsyncStackRoot();
-  if (asyncStackRoot == nullptr) {
-    // No async operation in progress. Return empty stack
-    return numFrames;
-  }
-
-  // Start by walking the normal stack until we get to the frame right before
-  // the frame that holds the async root.
-  auto* normalStackFrame =
-      reinterpret_cast<StackFrame*>(FOLLY_ASYNC_STACK_FRAME_POINTER());
-  auto* normalStackFrameStop =
-      reinterpret_cast<StackFrame*>(asyncStackRoot->getStackFramePointer());
-  if (numFrames < maxAddresses) {
-    addresses[numFrames++] =
-        reinterpret_cast<std::uintptr_t>(FOLLY_ASYNC_STACK_RETURN_ADDRESS());
+  StackFrame* normalStackFrameStop = nullptr;
+  AsyncStackFrame* asyncStackFrame = nullptr;
+  if (asyncStackRoot != nullptr) {
+    normalStackFrameStop =
+        reinterpret_cast<StackFrame*>(asyncStackRoot->getStackFramePointer());
+    asyncStackFrame = asyncStackRoot->getTopFrame();
   }
-  auto* asyncStackFrame = asyncStackRoot->getTopFrame();
 
   while (numFrames < maxAddresses &&
          (normalStackFrame != nullptr || asyncStackFrame != nullptr)) {
@@ -332,6 +332,66 @@ ssize_t getAsyncStackTraceSafe(uintptr_t* addresses, size_t maxAddresses) {
   }
   return numFrames;
 }
+} // namespace
+
+ssize_t getAsyncStackTraceSafe(uintptr_t* addresses, size_t maxAddresses) {
+  size_t numFrames = 0;
+  const auto* asyncStackRoot = tryGetCurrentAsyncStackRoot();
+  if (asyncStackRoot == nullptr) {
+    // No async operation in progress. Return empty stack
+    return numFrames;
+  }
+
+  // Start by walking the normal stack until we get to the frame right before
+  // the frame that holds the async root.
+  auto* normalStackFrame =
+      reinterpret_cast<StackFrame*>(FOLLY_ASYNC_STACK_FRAME_POINTER());
+  if (numFrames < maxAddresses) {
+    addresses[numFrames++] =
+        reinterpret_cast<std::uintptr_t>(FOLLY_ASYNC_STACK_RETURN_ADDRESS());
+  }
+  return numFrames +
+      walkStacks(
+             addresses + numFrames,
+             maxAddresses - numFrames,
+             normalStackFrame,
+             asyncStackRoot);
+}
+
+ssize_t getStackTraceFromSignalContextSafe(
+    [[maybe_unused]] const void* context,
+    [[maybe_unused]] uintptr_t* addresses,
+    [[maybe_unused]] size_t maxAddresses) {
+#if defined(__linux__) && (FOLLY_X64 || FOLLY_AARCH64)
+  auto const& mcontext = static_cast<const ucontext_t*>(context)->uc_mcontext;
+#if FOLLY_X64
+  auto const pc = uintptr_t(mcontext.gregs[REG_RIP]);
+  auto const sp = uintptr_t(mcontext.gregs[REG_RSP]);
+  auto const fp = uintptr_t(mcontext.gregs[REG_RBP]);
+#else
+  auto const pc = uintptr_t(mcontext.pc);
+  auto const sp = uintptr_t(mcontext.sp);
+  auto const fp = uintptr_t(mcontext.regs[29]);
+#endif
+  if (maxAddresses == 0) {
+    return 0;
+  }
+  addresses[0] = pc;
+  // The interrupted code may use the frame pointer register for something
+  // else: only follow it if it points into the stack.
+  auto* normalStackFrame = fp >= sp && fp % alignof(StackFrame) == 0
+      ? reinterpret_cast<StackFrame*>(fp)
+      : nullptr;
+  return 1 +
+      walkStacks(
+             addresses + 1,
+             maxAddresses - 1,
+             normalStackFrame,
+             tryGetCurrentAsyncStackRoot());
+#else
+  return -1;
+#endif
+}
 
 } // namespace symbolizer
 } // namespace folly
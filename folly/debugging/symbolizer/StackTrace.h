@@ -80,5 +80,26 @@ ssize_t getStackTraceHeap(uintptr_t* addresses, size_t maxAddresses);
  */
 ssize_t getAsyncStackTraceSafe(uintptr_t* addresses, size_t maxAddresses);
 
+/**
+ * Get the stack trace of the code that a signal interrupted into addresses,
+ * which has room for at least maxAddresses frames, given the ucontext_t that
+ * a SA_SIGINFO handler gets as its third argument. For sampling profilers.
+ *
+ * The first address is that of the interrupted instruction, the next ones
+ * return addresses. The frames are found by following the frame pointers and,
+ * while an async operation is in progress, include its async frames as
+ * getAsyncStackTraceSafe() does. So the caller of an interrupted leaf
+ * function, which needn't set up a frame, and the callers of code built
+ * without frame pointers may be missing.
+ *
+ * Returns the number of frames written in the array.
+ * Returns -1 on failure, or if the platform isn't supported (only Linux on
+ * x86_64 and aarch64 are).
+ *
+ * Async-signal-safe.
+ */
+ssize_t getStackTraceFromSignalContextSafe(
+    const void* context, uintptr_t* addresses, size_t maxAddresses);
+
 } // namespace symbolizer
 } // namespace folly
@@ -20,6 +20,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <numeric>
+#include <unordered_map>
 
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
@@ -32,6 +34,7 @@
 #include <folly/experimental/symbolizer/Elf.h>
 #include <folly/experimental/symbolizer/ElfCache.h>
 #include <folly/experimental/symbolizer/LineReader.h>
+#include <folly/hash/Hash.h>
 #include <folly/lang/SafeAssert.h>
 #include <folly/lang/ToAscii.h>
 #include <folly/memory/SanitizeAddress.h>
@@ -178,6 +181,8 @@ void setSymbolizedFrame(
     const std::shared_ptr<ElfFile>& file,
     uintptr_t address,
     LocationInfoMode mode,
+    const DwarfArangesIndex* arangesIndex,
+    const DwarfLineIndex* lineIndex,
     folly::Range<SymbolizedFrame*> extraInlineFrames = {}) {
   frame.clear();
   frame.found = true;
@@ -191,7 +196,7 @@ void setSymbolizedFrame(
   }
 #endif
 
-  Dwarf(elfCache, file.get())
+  Dwarf(elfCache, file.get(), arangesIndex, lineIndex)
       .findAddress(address, mode, frame, extraInlineFrames);
 }
 
@@ -203,11 +208,50 @@ using CachedSymbolizedFrames =
 
 using UnsyncSymbolCache = EvictingCacheMap<uintptr_t, CachedSymbolizedFrames>;
 
+// The number of frames filled in, from the start.
+size_t countFrames(folly::Range<const SymbolizedFrame*> frames) {
+  return std::distance(
+      frames.begin(),
+      std::find_if(frames.begin(), frames.end(), [](auto& frame) {
+        return !frame.found;
+      }));
+}
+
 } // namespace
 
-struct Symbolizer::SymbolCache : public Synchronized<UnsyncSymbolCache> {
-  using Super = Synchronized<UnsyncSymbolCache>;
-  using Super::Super;
+// The symbol cache is sharded by address: EvictingCacheMap moves what it
+// finds to the front of its eviction list, so even lookups take the lock
+// exclusively, and the threads of a service symbolizing their stacks at once
+// would all wait on a single one.
+//
+// It also holds the .debug_aranges and line table indexes of each ELF file, so
+// that the symbolizers that may allocate find compilation units and lines by a
+// binary search.
+struct Symbolizer::SymbolCache {
+  static constexpr size_t kShards = 16;
+
+  explicit SymbolCache(size_t capacity) {
+    // Rounded up, so that a small cache still holds something in each shard.
+    auto const shardCapacity = (capacity + kShards - 1) / kShards;
+    for (auto& shard : shards) {
+      shard = std::make_unique<Synchronized<UnsyncSymbolCache>>(
+          UnsyncSymbolCache{shardCapacity});
+    }
+  }
+
+  Synchronized<UnsyncSymbolCache>& shard(uintptr_t addr) {
+    return *shards[hash::twang_mix64(addr) % kShards];
+  }
+
+  std::array<std::unique_ptr<Synchronized<UnsyncSymbolCache>>, kShards> shards;
+
+  struct IndexedFile {
+    // Keeps the file, and so its address, alive.
+    std::shared_ptr<ElfFile> file;
+    std::unique_ptr<DwarfArangesIndex> arangesIndex;
+    std::unique_ptr<DwarfLineIndex> lineIndex;
+  };
+  Synchronized<std::unordered_map<const ElfFile*, IndexedFile>> files;
 };
 
 bool Symbolizer::isAvailable() {
@@ -223,14 +267,41 @@ Symbolizer::Symbolizer(
       mode_(mode),
       exePath_(std::move(exePath)) {
   if (symbolCacheSize > 0) {
-    symbolCache_ =
-        std::make_unique<SymbolCache>(UnsyncSymbolCache{symbolCacheSize});
+    symbolCache_ = std::make_unique<SymbolCache>(symbolCacheSize);
   }
 }
 
 // Needs complete type for SymbolCache
 Symbolizer::~Symbolizer() {}
 
+Symbolizer::DwarfIndexes Symbolizer::dwarfIndexes(
+    const std::shared_ptr<ElfFile>& file) {
+  if (!symbolCache_) {
+    return {};
+  }
+  auto const indexes = [](const SymbolCache::IndexedFile& indexed) {
+    return DwarfIndexes{indexed.arangesIndex.get(), indexed.lineIndex.get()};
+  };
+  {
+    auto files = symbolCache_->files.rlock();
+    auto const it = files->find(file.get());
+    if (it != files->end()) {
+      return indexes(it->second);
+    }
+  }
+  // Built outside of the lock; a thread losing the race drops its own. The
+  // line tables themselves are built as their compilation units are used.
+  auto index = std::make_unique<DwarfArangesIndex>(file.get());
+  auto files = symbolCache_->files.wlock();
+  auto const it = files->try_emplace(
+      file.get(),
+      SymbolCache::IndexedFile{
+          file,
+          std::move(index),
+          std::make_unique<DwarfLineIndex>(file.get())});
+  return indexes(it.first->second);
+}
+
 size_t Symbolizer::symbolize(
     folly::Range<const uintptr_t*> addrs,
     folly::Range<SymbolizedFrame*> frames) {
@@ -274,15 +345,6 @@ size_t Symbolizer::symbolize(
     frames[i].addr = addrs[i];
   }
 
-  // Find out how many frames were filled in.
-  auto countFrames = [](folly::Range<SymbolizedFrame*> framesRange) {
-    return std::distance(
-        framesRange.begin(),
-        std::find_if(framesRange.begin(), framesRange.end(), [&](auto frame) {
-          return !frame.found;
-        }));
-  };
-
   for (auto lmap = dbg->r_map; lmap != nullptr && remaining != 0;
        lmap = lmap->l_next) {
     // The empty string is used in place of the filename for the link_map
@@ -295,6 +357,7 @@ size_t Symbolizer::symbolize(
     if (!elfFile) {
       continue;
     }
+    auto const indexes = dwarfIndexes(elfFile);
 
     for (size_t i = 0; i < addrCount && remaining != 0; ++i) {
       auto& frame = frames[i];
@@ -306,7 +369,7 @@ size_t Symbolizer::symbolize(
       if (symbolCache_) {
         // Need a write lock, because EvictingCacheMap brings found item to
         // front of eviction list.
-        auto lockedSymbolCache = symbolCache_->wlock();
+        auto lockedSymbolCache = symbolCache_->shard(addr).wlock();
 
         auto const iter = lockedSymbolCache->find(addr);
         if (iter != lockedSymbolCache->end()) {
@@ -348,7 +411,14 @@ size_t Symbolizer::symbolize(
               frames.begin() + addrCount,
               frames.begin() + addrCount + maxInline);
           setSymbolizedFrame(
-              cache_, frame, elfFile, adjusted, mode_, inlineFrameRange);
+              cache_,
+              frame,
+              elfFile,
+              adjusted,
+              mode_,
+              indexes.aranges,
+              indexes.lines,
+              inlineFrameRange);
 
           numInlined = countFrames(inlineFrameRange);
           // Rotate inline frames right before its caller frame.
@@ -358,7 +428,14 @@ size_t Symbolizer::symbolize(
               frames.begin() + addrCount + numInlined);
           addrCount += numInlined;
         } else {
-          setSymbolizedFrame(cache_, frame, elfFile, adjusted, mode_);
+          setSymbolizedFrame(
+              cache_,
+              frame,
+              elfFile,
+              adjusted,
+              mode_,
+              indexes.aranges,
+              indexes.lines);
         }
         --remaining;
         if (symbolCache_) {
@@ -369,7 +446,7 @@ size_t Symbolizer::symbolize(
               frames.begin() + i,
               frames.begin() + i + std::min(numInlined + 1, cacheFrames.size()),
               cacheFrames.begin());
-          symbolCache_->wlock()->set(addr, cacheFrames);
+          symbolCache_->shard(addr).wlock()->set(addr, cacheFrames);
         }
         // Skip over the newly added inlined items.
         i += numInlined;
@@ -380,6 +457,125 @@ size_t Symbolizer::symbolize(
   return addrCount;
 }
 
+SymbolizedBatch Symbolizer::symbolizeBatch(
+    folly::Range<const uintptr_t*> addrs) {
+  SymbolizedBatch batch;
+  batch.spans_.resize(addrs.size());
+
+  // The positions of the addresses, by address, each distinct address
+  // starting a run.
+  std::vector<size_t> order(addrs.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return addrs[a] < addrs[b];
+  });
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (i == 0 || addrs[order[i]] != addrs[order[i - 1]]) {
+      pending.push_back(i);
+    }
+  }
+
+  // Copies the frames of the run of order starting at i to the batch.
+  auto emit = [&](size_t i, folly::Range<const SymbolizedFrame*> frames) {
+    auto const begin = batch.frames_.size();
+    batch.frames_.insert(batch.frames_.end(), frames.begin(), frames.end());
+    auto const addr = addrs[order[i]];
+    for (; i < order.size() && addrs[order[i]] == addr; ++i) {
+      batch.spans_[order[i]] = {begin, batch.frames_.size()};
+    }
+  };
+
+  if (symbolCache_) {
+    auto const isCached = [&](size_t i) {
+      auto const addr = addrs[order[i]];
+      auto cache = symbolCache_->shard(addr).wlock();
+      auto const it = cache->find(addr);
+      if (it == cache->end()) {
+        return false;
+      }
+      auto const& frames = it->second;
+      auto const count = countFrames(folly::range(frames));
+      emit(i, folly::range(frames.data(), frames.data() + count));
+      return true;
+    };
+    pending.erase(
+        std::remove_if(pending.begin(), pending.end(), isCached),
+        pending.end());
+  }
+
+  auto const dbg = detail::get_r_debug();
+  char selfPath[PATH_MAX + 8];
+  ssize_t selfSize = readlink(exePath_.c_str(), selfPath, PATH_MAX + 1);
+  if (dbg != nullptr && dbg->r_version == 1 && selfSize != -1) {
+    selfPath[selfSize] = '\0';
+    for (auto lmap = dbg->r_map; lmap != nullptr && !pending.empty();
+         lmap = lmap->l_next) {
+      // See symbolize() for the empty name.
+      auto const objPath = lmap->l_name[0] != '\0' ? lmap->l_name : selfPath;
+      auto const elfFile = cache_->getFile(objPath);
+      if (!elfFile) {
+        continue;
+      }
+      auto const indexes = dwarfIndexes(elfFile);
+
+      // The addresses of the file, in increasing order.
+      auto const symbolized = [&](size_t i) {
+        auto const addr = addrs[order[i]];
+        auto const adjusted = addr - reinterpret_cast<uintptr_t>(lmap->l_addr);
+        if (!elfFile->getSectionContainingAddress(adjusted)) {
+          return false;
+        }
+        // As in symbolize(): the inlined calls, then the function.
+        CachedSymbolizedFrames frames;
+        size_t numInlined = 0;
+        if (mode_ == LocationInfoMode::FULL_WITH_INLINE) {
+          folly::Range<SymbolizedFrame*> inlineFrames(
+              frames.begin() + 1, frames.end());
+          setSymbolizedFrame(
+              cache_,
+              frames[0],
+              elfFile,
+              adjusted,
+              mode_,
+              indexes.aranges,
+              indexes.lines,
+              inlineFrames);
+          numInlined = countFrames(inlineFrames);
+          std::rotate(
+              frames.begin(),
+              frames.begin() + 1,
+              frames.begin() + 1 + numInlined);
+        } else {
+          setSymbolizedFrame(
+              cache_,
+              frames[0],
+              elfFile,
+              adjusted,
+              mode_,
+              indexes.aranges,
+              indexes.lines);
+        }
+        emit(i, folly::range(frames.data(), frames.data() + numInlined + 1));
+        if (symbolCache_) {
+          symbolCache_->shard(addr).wlock()->set(addr, frames);
+        }
+        return true;
+      };
+      pending.erase(
+          std::remove_if(pending.begin(), pending.end(), symbolized),
+          pending.end());
+    }
+  }
+
+  SymbolizedFrame notFound;
+  for (auto i : pending) {
+    notFound.addr = addrs[order[i]];
+    emit(i, folly::range(&notFound, &notFound + 1));
+  }
+  return batch;
+}
+
 FastStackTracePrinter::FastStackTracePrinter(
     std::unique_ptr<SymbolizePrinter> printer, size_t symbolCacheSize)
     : printer_(std::move(printer)),
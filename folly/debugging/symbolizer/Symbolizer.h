@@ -20,6 +20,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <folly/FBString.h>
 #include <folly/Optional.h>
@@ -93,6 +95,34 @@ inline bool getAsyncStackTraceSafe(FrameArray<N>& fa) {
 
 #if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
 
+/**
+ * The frames of the addresses given to Symbolizer::symbolizeBatch(), in the
+ * order of the addresses.
+ */
+class SymbolizedBatch {
+ public:
+  size_t size() const { return spans_.size(); }
+
+  /**
+   * The frames of the i-th address: in FULL_WITH_INLINE mode, the inlined
+   * calls followed by the function, as symbolize() orders them, otherwise
+   * the function. A single frame, not found, if the address couldn't be
+   * symbolized.
+   */
+  folly::Range<const SymbolizedFrame*> operator[](size_t i) const {
+    return {frames_.data() + spans_[i].first,
+            frames_.data() + spans_[i].second};
+  }
+
+ private:
+  friend class Symbolizer;
+
+  std::vector<SymbolizedFrame> frames_;
+  // The [begin, end) of the frames of each address, shared by the copies
+  // of an address.
+  std::vector<std::pair<size_t, size_t>> spans_;
+};
+
 class Symbolizer {
  public:
   static constexpr auto kDefaultLocationInfoMode = LocationInfoMode::FAST;
@@ -149,7 +179,23 @@ class Symbolizer {
     return frame.found;
   }
 
+  /**
+   * Symbolize many addresses at once, such as those of all the samples of
+   * a profile. Each distinct address is symbolized once, and those of an
+   * object file in increasing order, so that its debug info is read front
+   * to back rather than once per stack. Allocates.
+   */
+  SymbolizedBatch symbolizeBatch(folly::Range<const uintptr_t*> addrs);
+
  private:
+  // The .debug_aranges and line table indexes of file, built on first use,
+  // or null if this symbolizer has no symbol cache, and so mustn't allocate.
+  struct DwarfIndexes {
+    const DwarfArangesIndex* aranges = nullptr;
+    const DwarfLineIndex* lines = nullptr;
+  };
+  DwarfIndexes dwarfIndexes(const std::shared_ptr<ElfFile>& file);
+
   ElfCacheBase* const cache_;
   const LocationInfoMode mode_;
   const std::string exePath_;
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/debugging/symbolizer/AsyncStackSampler.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Task.h>
+#include <folly/lang/Hint.h>
+#include <folly/portability/GTest.h>
+#include <folly/test/TestUtils.h>
+
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
+
+using namespace folly::symbolizer;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::atomic<bool> gStop{false};
+
+FOLLY_NOINLINE void work() {
+  folly::compiler_must_not_elide(0);
+}
+
+// Not a leaf function, which may not have a frame: see
+// getStackTraceFromSignalContextSafe().
+FOLLY_NOINLINE void spin() {
+  while (!gStop.load(std::memory_order_relaxed)) {
+    work();
+  }
+}
+
+FOLLY_NOINLINE void spinCaller() {
+  spin();
+  folly::compiler_must_not_elide(0); // prevent tail-call above
+}
+
+// Samples the process while run() runs on another thread, and returns the
+// folded stacks.
+template <typename F>
+std::string sampleWhile(F run) {
+  AsyncStackSampler sampler({1ms, SIGPROF, 256});
+  gStop = false;
+  std::thread thread(run);
+  sampler.start();
+  auto const deadline = std::chrono::steady_clock::now() + 10s;
+  while (sampler.samples() < 50 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  sampler.stop();
+  gStop = true;
+  thread.join();
+  EXPECT_GE(sampler.samples(), 50);
+  return sampler.folded();
+}
+
+} // namespace
+
+TEST(AsyncStackSampler, Native) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  auto const folded = sampleWhile(spinCaller);
+  EXPECT_NE(std::string::npos, folded.find("::spinCaller();")) << folded;
+  EXPECT_NE(std::string::npos, folded.find("::spin()")) << folded;
+  // Each line ends with its count.
+  EXPECT_EQ('\n', folded.back());
+  auto const lastLine = folded.substr(folded.rfind('\n', folded.size() - 2));
+  EXPECT_GT(std::stoul(lastLine.substr(lastLine.rfind(' ') + 1)), 0);
+}
+
+#if FOLLY_HAS_COROUTINES
+
+namespace {
+
+FOLLY_NOINLINE folly::coro::Task<void> co_spinner() {
+  spinCaller();
+  co_return;
+}
+
+FOLLY_NOINLINE folly::coro::Task<void> co_awaiter() {
+  co_await co_spinner();
+}
+
+} // namespace
+
+TEST(AsyncStackSampler, Coroutines) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  // co_awaiter isn't on the native stack of co_spinner, which the executor
+  // resumed: it comes from the async stack.
+  auto const folded =
+      sampleWhile([] { folly::coro::blockingWait(co_awaiter()); });
+  auto const awaiter = folded.find("co_awaiter");
+  ASSERT_NE(std::string::npos, awaiter) << folded;
+  auto const spinner = folded.find("co_spinner", awaiter);
+  ASSERT_NE(std::string::npos, spinner) << folded;
+  EXPECT_LT(spinner, folded.find("::spinCaller();", spinner));
+}
+
+#endif // FOLLY_HAS_COROUTINES
+
+TEST(AsyncStackSampler, OneAtATime) {
+  AsyncStackSampler sampler;
+  sampler.start();
+  AsyncStackSampler other;
+  EXPECT_THROW(other.start(), std::logic_error);
+  EXPECT_THROW(sampler.start(), std::logic_error);
+  sampler.stop();
+  other.start();
+  other.stop();
+  // Restarts, keeping the samples.
+  sampler.start();
+  sampler.stop();
+}
+
+#endif // FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && defined(__linux__)
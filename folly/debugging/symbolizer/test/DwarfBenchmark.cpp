@@ -38,7 +38,7 @@ FOLLY_NOINLINE void lexicalBlockBar() try {
   folly::assume_unreachable();
 }
 
-void run(LocationInfoMode mode, size_t n) {
+void run(LocationInfoMode mode, size_t n, bool indexed = false) {
   folly::BenchmarkSuspender suspender;
   Symbolizer symbolizer(nullptr, LocationInfoMode::FULL_WITH_INLINE, 0);
   FrameArray<100> frames;
@@ -52,7 +52,13 @@ void run(LocationInfoMode mode, size_t n) {
 
   ElfCache cache;
   ElfFile elf("/proc/self/exe");
-  Dwarf dwarf(&cache, &elf);
+  DwarfArangesIndex arangesIndex(&elf);
+  DwarfLineIndex lineIndex(&elf);
+  Dwarf dwarf(
+      &cache,
+      &elf,
+      indexed ? &arangesIndex : nullptr,
+      indexed ? &lineIndex : nullptr);
   auto inlineFrames = std::array<SymbolizedFrame, 10>();
   suspender.dismiss();
 
@@ -78,6 +84,10 @@ BENCHMARK(DwarfFindAddressFullWithInline, n) {
   run(folly::symbolizer::LocationInfoMode::FULL_WITH_INLINE, n);
 }
 
+BENCHMARK(DwarfFindAddressFullIndexed, n) {
+  run(folly::symbolizer::LocationInfoMode::FULL, n, true);
+}
+
 #endif // FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
 
 int main(int argc, char* argv[]) {
@@ -17,6 +17,7 @@
 #include <folly/experimental/symbolizer/Symbolizer.h>
 
 #include <signal.h>
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 
@@ -25,6 +26,7 @@
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/debugging/symbolizer/DwarfLineNumberVM.h>
 #include <folly/debugging/symbolizer/detail/Debug.h>
 #include <folly/debugging/symbolizer/test/SymbolizerTestUtils.h>
 #include <folly/experimental/symbolizer/ElfCache.h>
@@ -598,6 +600,157 @@ TEST(Dwarf, FindParameterNames) {
   ASSERT_EQ("b", names[1]);
 }
 
+TEST(Dwarf, ArangesIndex) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  ElfCache elfCache;
+
+  auto address = reinterpret_cast<uintptr_t>(functionWithTwoParameters);
+  Symbolizer symbolizer;
+  SymbolizedFrame frame;
+  ASSERT_TRUE(symbolizer.symbolize(address, frame));
+
+  DwarfArangesIndex index(frame.file.get());
+  SymbolizedFrame indexed = frame;
+  SymbolizedFrame scanned = frame;
+  EXPECT_EQ(
+      Dwarf(&elfCache, frame.file.get())
+          .findAddress(frame.addr, LocationInfoMode::FULL, scanned),
+      Dwarf(&elfCache, frame.file.get(), &index)
+          .findAddress(frame.addr, LocationInfoMode::FULL, indexed));
+  EXPECT_EQ(scanned.location.line, indexed.location.line);
+  EXPECT_EQ(
+      scanned.location.file.toString(), indexed.location.file.toString());
+  EXPECT_GT(indexed.location.line, 0);
+  EXPECT_GT(index.size(), 0);
+}
+
+TEST(Dwarf, LineIndex) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  ElfCache elfCache;
+
+  auto address = reinterpret_cast<uintptr_t>(functionWithTwoParameters);
+  Symbolizer symbolizer;
+  SymbolizedFrame frame;
+  ASSERT_TRUE(symbolizer.symbolize(address, frame));
+
+  DwarfLineIndex index(frame.file.get());
+  // Every instruction of the function, each time but the first from a table
+  // that is already built.
+  for (uintptr_t offset = 0; offset < 64; ++offset) {
+    SCOPED_TRACE(offset);
+    SymbolizedFrame indexed = frame;
+    SymbolizedFrame executed = frame;
+    EXPECT_EQ(
+        Dwarf(&elfCache, frame.file.get())
+            .findAddress(frame.addr + offset, LocationInfoMode::FULL, executed),
+        Dwarf(&elfCache, frame.file.get(), nullptr, &index)
+            .findAddress(frame.addr + offset, LocationInfoMode::FULL, indexed));
+    EXPECT_EQ(executed.location.line, indexed.location.line);
+    EXPECT_EQ(
+        executed.location.file.toString(), indexed.location.file.toString());
+  }
+}
+
+TEST(Dwarf, LineTableOverlappingSequences) {
+  // The rows of two sequences, the second of which overlaps the first, as
+  // those of functions discarded by the linker do.
+  DwarfLineTable table({
+      {0x100, 0x110, 1, 10, 0, 0},
+      {0x110, 0x130, 1, 11, 0, 0},
+      {0x0, 0x120, 2, 20, 1, 0},
+      {0x200, 0x210, 1, 30, 2, 0},
+  });
+  EXPECT_EQ(4, table.size());
+
+  auto line = [&](uintptr_t address) -> uint64_t {
+    auto row = table.find(address);
+    return row ? row->line : 0;
+  };
+  EXPECT_EQ(20, line(0x0));
+  EXPECT_EQ(10, line(0x100));
+  EXPECT_EQ(10, line(0x10f));
+  EXPECT_EQ(11, line(0x110));
+  EXPECT_EQ(11, line(0x12f));
+  EXPECT_EQ(0, line(0x130));
+  EXPECT_EQ(0, line(0x1ff));
+  EXPECT_EQ(30, line(0x200));
+  EXPECT_EQ(0, line(0x210));
+}
+
+TEST(SymbolizerTest, SymbolizeBatch) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  // Unsorted, repeated, and an address of no object.
+  std::vector<uintptr_t> addrs = {
+      reinterpret_cast<uintptr_t>(functionWithTwoParameters),
+      reinterpret_cast<uintptr_t>(call_B_A_lfind),
+      reinterpret_cast<uintptr_t>(foo),
+      reinterpret_cast<uintptr_t>(call_B_A_lfind),
+      1,
+  };
+
+  for (size_t cacheSize : {0, 100}) {
+    SCOPED_TRACE(cacheSize);
+    Symbolizer symbolizer(nullptr, LocationInfoMode::FULL, cacheSize);
+    // Twice, for the cache.
+    for (int run = 0; run < 2; ++run) {
+      auto batch = symbolizer.symbolizeBatch(folly::range(addrs));
+      ASSERT_EQ(addrs.size(), batch.size());
+      for (size_t i = 0; i < addrs.size(); ++i) {
+        SymbolizedFrame expected;
+        Symbolizer(LocationInfoMode::FULL).symbolize(addrs[i], expected);
+        ASSERT_EQ(1, batch[i].size());
+        EXPECT_EQ(expected.found, batch[i][0].found);
+        EXPECT_EQ(expected.addr, batch[i][0].addr);
+        if (expected.found) {
+          EXPECT_STREQ(expected.name, batch[i][0].name);
+          EXPECT_EQ(expected.location.line, batch[i][0].location.line);
+        }
+      }
+      EXPECT_TRUE(batch[0][0].found);
+      EXPECT_EQ(batch[1].begin(), batch[3].begin());
+      EXPECT_FALSE(batch[4][0].found);
+    }
+  }
+}
+
+TEST(SymbolizerTest, SymbolizeBatchInline) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  FrameArray<100> frames;
+  gComparatorGetStackTraceArg = &frames;
+  gComparatorGetStackTrace =
+      reinterpret_function_cast<bool(void*)>(getStackTrace<100>);
+  call_inlineB_inlineA_lfind();
+  std::vector<uintptr_t> addrs(
+      frames.addresses,
+      frames.addresses + std::min<size_t>(frames.frameCount, 4));
+
+  Symbolizer reference(nullptr, LocationInfoMode::FULL_WITH_INLINE, 0);
+  reference.symbolize(frames);
+  SCOPED_TRACE_FRAMES(frames);
+
+  Symbolizer symbolizer(nullptr, LocationInfoMode::FULL_WITH_INLINE, 100);
+  // Twice, for the cache.
+  for (int run = 0; run < 2; ++run) {
+    auto batch = symbolizer.symbolizeBatch(folly::range(addrs));
+    // The frames of the addresses are those symbolize() gives, in order.
+    size_t expected = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      for (auto& frame : batch[i]) {
+        ASSERT_LT(expected, frames.frameCount);
+        EXPECT_STREQ(frames.frames[expected].name, frame.name);
+        EXPECT_EQ(
+            frames.frames[expected].location.line, frame.location.line);
+        ++expected;
+      }
+    }
+    EXPECT_GT(expected, addrs.size());
+  }
+}
+
 #undef SCOPED_TRACE_FRAMES
 
 } // namespace test
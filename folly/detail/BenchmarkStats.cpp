@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/BenchmarkStats.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace folly {
+namespace detail {
+
+namespace {
+
+// The quantile q of the sorted samples, interpolated linearly.
+double quantile(const std::vector<double>& sorted, double q) {
+  auto const pos = q * double(sorted.size() - 1);
+  auto const lo = std::size_t(pos);
+  auto const hi = std::min(lo + 1, sorted.size() - 1);
+  return sorted[lo] + (pos - double(lo)) * (sorted[hi] - sorted[lo]);
+}
+
+// The continued fraction of the regularized incomplete beta function, by the
+// modified Lentz method.
+double betaContinuedFraction(double a, double b, double x) {
+  constexpr int kMaxIterations = 300;
+  constexpr double kEpsilon = 1e-15;
+  constexpr double kTiny = 1e-300;
+
+  double c = 1;
+  double d = 1 - (a + b) * x / (a + 1);
+  d = 1 / (std::fabs(d) < kTiny ? kTiny : d);
+  double h = d;
+  for (int m = 1; m <= kMaxIterations; ++m) {
+    for (int odd = 0; odd < 2; ++odd) {
+      double const num = odd
+          ? -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))
+          : m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+      d = 1 + num * d;
+      d = 1 / (std::fabs(d) < kTiny ? kTiny : d);
+      c = 1 + num / c;
+      c = std::fabs(c) < kTiny ? kTiny : c;
+      h *= d * c;
+      if (odd && std::fabs(d * c - 1) < kEpsilon) {
+        return h;
+      }
+    }
+  }
+  return h;
+}
+
+// The regularized incomplete beta function I_x(a, b).
+double incompleteBeta(double a, double b, double x) {
+  if (x <= 0) {
+    return 0;
+  }
+  if (x >= 1) {
+    return 1;
+  }
+  double const front = std::exp(
+      std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+      a * std::log(x) + b * std::log1p(-x));
+  // The continued fraction converges quickly below the mean of the
+  // distribution, and the symmetry of I gives the rest.
+  if (x < (a + 1) / (a + b + 2)) {
+    return front * betaContinuedFraction(a, b, x) / a;
+  }
+  return 1 - front * betaContinuedFraction(b, a, 1 - x) / b;
+}
+
+} // namespace
+
+std::vector<double> rejectOutliers(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  if (samples.size() < 4) {
+    return samples;
+  }
+  auto const q1 = quantile(samples, 0.25);
+  auto const q3 = quantile(samples, 0.75);
+  auto const lo = q1 - 1.5 * (q3 - q1);
+  auto const hi = q3 + 1.5 * (q3 - q1);
+  samples.erase(
+      std::upper_bound(samples.begin(), samples.end(), hi), samples.end());
+  samples.erase(
+      samples.begin(),
+      std::lower_bound(samples.begin(), samples.end(), lo));
+  return samples;
+}
+
+SampleStats sampleStats(const std::vector<double>& samples) {
+  SampleStats stats;
+  auto const kept = rejectOutliers(samples);
+  stats.count = kept.size();
+  stats.outliers = samples.size() - kept.size();
+  if (kept.empty()) {
+    return stats;
+  }
+  double sum = 0;
+  for (auto sample : kept) {
+    sum += sample;
+  }
+  stats.mean = sum / double(kept.size());
+  if (kept.size() < 2) {
+    return stats;
+  }
+  double squares = 0;
+  for (auto sample : kept) {
+    squares += (sample - stats.mean) * (sample - stats.mean);
+  }
+  auto const n = double(kept.size());
+  stats.stddev = std::sqrt(squares / (n - 1));
+  stats.ci95 = studentTQuantile(0.975, n - 1) * stats.stddev / std::sqrt(n);
+  return stats;
+}
+
+double welchTTest(const SampleStats& a, const SampleStats& b) {
+  if (a.count < 2 || b.count < 2) {
+    return SampleStats::kNaN;
+  }
+  auto const va = a.stddev * a.stddev / double(a.count);
+  auto const vb = b.stddev * b.stddev / double(b.count);
+  if (va + vb == 0) {
+    return a.mean == b.mean ? 1 : 0;
+  }
+  auto const t = (a.mean - b.mean) / std::sqrt(va + vb);
+  // The Welch-Satterthwaite degrees of freedom.
+  auto const df = (va + vb) * (va + vb) /
+      (va * va / double(a.count - 1) + vb * vb / double(b.count - 1));
+  return 2 * studentTCdf(-std::fabs(t), df);
+}
+
+double studentTCdf(double t, double df) {
+  auto const tail = 0.5 * incompleteBeta(df / 2, 0.5, df / (df + t * t));
+  return t < 0 ? tail : 1 - tail;
+}
+
+double studentTQuantile(double p, double df) {
+  if (p <= 0 || p >= 1) {
+    return p <= 0 ? -HUGE_VAL : HUGE_VAL;
+  }
+  // The CDF is increasing: bisect, after finding a bracket.
+  double lo = -1;
+  double hi = 1;
+  while (studentTCdf(lo, df) > p) {
+    lo *= 2;
+  }
+  while (studentTCdf(hi, df) < p) {
+    hi *= 2;
+  }
+  for (int i = 0; i < 100 && hi - lo > 1e-12 * std::max(1., std::fabs(lo));
+       ++i) {
+    auto const mid = (lo + hi) / 2;
+    (studentTCdf(mid, df) < p ? lo : hi) = mid;
+  }
+  return (lo + hi) / 2;
+}
+
+} // namespace detail
+} // namespace folly
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace folly {
+namespace detail {
+
+/*
+ * The statistics of the repeated measurements of a benchmark, for
+ * folly::benchmark's --bm_repetitions and the comparison of two runs.
+ */
+struct SampleStats {
+  static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+  // The samples left after the outliers are rejected.
+  std::size_t count = 0;
+  std::size_t outliers = 0;
+  double mean = kNaN;
+  double stddev = kNaN;
+  // Half the width of the 95% confidence interval of the mean, NaN for
+  // fewer than 2 samples.
+  double ci95 = kNaN;
+};
+
+/*
+ * The samples within Tukey's fences, [q1 - 1.5 * iqr, q3 + 1.5 * iqr],
+ * sorted. The outliers of a benchmark are the runs that a context switch,
+ * an interrupt or frequency scaling slowed down.
+ */
+std::vector<double> rejectOutliers(std::vector<double> samples);
+
+/*
+ * The statistics of the samples, once the outliers are rejected.
+ */
+SampleStats sampleStats(const std::vector<double>& samples);
+
+/*
+ * The two-sided p-value of Welch's t-test that the means of a and b are
+ * equal, which doesn't assume that their variances are: the probability
+ * that the means differ this much by chance. NaN if either has fewer than
+ * 2 samples.
+ */
+double welchTTest(const SampleStats& a, const SampleStats& b);
+
+/*
+ * The cumulative distribution function of Student's t distribution with
+ * df degrees of freedom, and its inverse.
+ */
+double studentTCdf(double t, double df);
+double studentTQuantile(double p, double df);
+
+} // namespace detail
+} // namespace folly
@@ -27,7 +27,9 @@
 #include <glog/logging.h>
 
 #include <fmt/core.h>
+#include <folly/codec/hex.h>
 #include <folly/detail/IPAddress.h>
+#include <folly/lang/Bits.h>
 
 // BSDish platforms don't provide standard access to s6_addr16
 #ifndef s6_addr16
@@ -217,21 +219,50 @@ inline void writeIntegerString(IntegralType val, char** buffer) {
   *buffer = buf;
 }
 
-inline size_t fastIpV4ToBufferUnsafe(const in_addr& inAddr, char* str) {
-  const uint8_t* octets = reinterpret_cast<const uint8_t*>(&inAddr.s_addr);
-  char* buf = str;
+// The decimal digits of each octet, followed by their count.
+struct Ipv4OctetDigits {
+  char digits[3];
+  uint8_t size;
+};
+
+constexpr std::array<Ipv4OctetDigits, 256> makeIpv4OctetDigits() {
+  std::array<Ipv4OctetDigits, 256> table{};
+  for (size_t i = 0; i < table.size(); ++i) {
+    auto& entry = table[i];
+    if (i >= 100) {
+      entry.digits[entry.size++] = char('0' + i / 100);
+    }
+    if (i >= 10) {
+      entry.digits[entry.size++] = char('0' + i / 10 % 10);
+    }
+    entry.digits[entry.size++] = char('0' + i % 10);
+  }
+  return table;
+}
 
-  writeIntegerString<uint8_t, 3>(octets[0], &buf);
-  *(buf++) = '.';
-  writeIntegerString<uint8_t, 3>(octets[1], &buf);
-  *(buf++) = '.';
-  writeIntegerString<uint8_t, 3>(octets[2], &buf);
-  *(buf++) = '.';
-  writeIntegerString<uint8_t, 3>(octets[3], &buf);
+inline constexpr std::array<Ipv4OctetDigits, 256> kIpv4OctetDigits =
+    makeIpv4OctetDigits();
 
+// Writes the dotted decimal form of the 4 bytes at octets, which needs at most
+// 15 characters, and returns its length.
+inline size_t fastIpv4BytesToBufferUnsafe(const uint8_t* octets, char* str) {
+  char* buf = str;
+  for (size_t i = 0; i < 4; ++i) {
+    auto const& entry = kIpv4OctetDigits[octets[i]];
+    std::memcpy(buf, entry.digits, 3);
+    buf += entry.size;
+    if (i != 3) {
+      *(buf++) = '.';
+    }
+  }
   return buf - str;
 }
 
+inline size_t fastIpV4ToBufferUnsafe(const in_addr& inAddr, char* str) {
+  return fastIpv4BytesToBufferUnsafe(
+      reinterpret_cast<const uint8_t*>(&inAddr.s_addr), str);
+}
+
 inline std::string fastIpv4ToString(const in_addr& inAddr) {
   char str[sizeof("255.255.255.255")];
   return std::string(str, fastIpV4ToBufferUnsafe(inAddr, str));
@@ -243,20 +274,13 @@ inline void fastIpv4AppendToString(const in_addr& inAddr, std::string& out) {
 }
 
 inline size_t fastIpv6ToBufferUnsafe(const in6_addr& in6Addr, char* str) {
-#ifdef _MSC_VER
-  const uint16_t* bytes = reinterpret_cast<const uint16_t*>(&in6Addr.u.Word);
-#else
-  const uint16_t* bytes = reinterpret_cast<const uint16_t*>(&in6Addr.s6_addr16);
-#endif
+  // The 32 digits are written at once, and then spread into 8 groups.
+  char hex[32];
+  hex_encode(hex, in6Addr.s6_addr, 16);
   char* buf = str;
-
   for (int i = 0; i < 8; ++i) {
-    writeIntegerString<
-        uint16_t,
-        4, // at most 4 hex digits per ushort
-        16, // base 16 (hex)
-        true>(htons(bytes[i]), &buf);
-
+    std::memcpy(buf, hex + 4 * i, 4);
+    buf += 4;
     if (i != 7) {
       *(buf++) = ':';
     }
@@ -274,5 +298,165 @@ inline void fastIpv6AppendToString(const in6_addr& in6Addr, std::string& out) {
   char str[sizeof("2001:0db8:0000:0000:0000:ff00:0042:8329")];
   out.append(str, fastIpv6ToBufferUnsafe(in6Addr, str));
 }
+
+// Writes the canonical text form of an IPv6 address, as inet_ntop does: the
+// groups without their leading zeros, the first of the longest runs of two or
+// more zero groups replaced with "::", and the last 32 bits of IPv4-compatible
+// and IPv4-mapped addresses in dotted decimal form.
+//
+// Up to 3 characters past the returned length may be clobbered, which still
+// fits in INET6_ADDRSTRLEN characters.
+inline size_t fastIpv6ToCompressedBufferUnsafe(
+    const in6_addr& in6Addr, char* str) {
+  const uint8_t* bytes = in6Addr.s6_addr;
+  char hex[32 + 3];
+  hex_encode(hex, bytes, 16);
+
+  int zerosBegin = -1;
+  int zerosSize = 0;
+  for (int i = 0; i < 8;) {
+    if (bytes[2 * i] | bytes[2 * i + 1]) {
+      ++i;
+      continue;
+    }
+    int j = i + 1;
+    while (j < 8 && !(bytes[2 * j] | bytes[2 * j + 1])) {
+      ++j;
+    }
+    if (j - i > zerosSize && j - i >= 2) {
+      zerosBegin = i;
+      zerosSize = j - i;
+    }
+    i = j;
+  }
+
+  char* buf = str;
+  for (int i = 0; i < 8; ++i) {
+    if (i == zerosBegin) {
+      *(buf++) = ':';
+      i += zerosSize - 1;
+      if (i == 7) {
+        *(buf++) = ':';
+      }
+      continue;
+    }
+    if (i != 0) {
+      *(buf++) = ':';
+    }
+    if (i == 6 && zerosBegin == 0 &&
+        (zerosSize == 6 ||
+         (zerosSize == 5 && bytes[10] == 0xff && bytes[11] == 0xff))) {
+      buf += fastIpv4BytesToBufferUnsafe(bytes + 12, buf);
+      break;
+    }
+    // Copy the 4 digits of the group, and skip over its leading zeros.
+    uint16_t const group = uint16_t(bytes[2 * i] << 8 | bytes[2 * i + 1]);
+    size_t const skip = group ? findLastSet(group) : 1;
+    size_t const digits = (skip + 3) / 4;
+    std::memcpy(buf, hex + 4 * i + 4 - digits, 4);
+    buf += digits;
+  }
+  return buf - str;
+}
+
+// Parses the dotted decimal form of an IPv4 address, with the same rules as
+// inet_pton: exactly 4 decimal octets of at most 255, without leading zeros.
+inline bool fastIpv4FromBuffer(const char* str, size_t len, uint8_t* out) {
+  if (len < 7 || len > 15) {
+    return false;
+  }
+  const char* const end = str + len;
+  for (size_t i = 0; i < 4; ++i) {
+    if (i != 0 && (str == end || *(str++) != '.')) {
+      return false;
+    }
+    unsigned value = 0;
+    const char* const begin = str;
+    while (str != end && str - begin < 3 && unsigned(*str - '0') < 10) {
+      value = value * 10 + unsigned(*(str++) - '0');
+    }
+    if (str == begin || value > 255 || (*begin == '0' && str - begin > 1)) {
+      return false;
+    }
+    out[i] = uint8_t(value);
+  }
+  return str == end;
+}
+
+// Parses the text form of an IPv6 address, without a scope id, with the same
+// rules as inet_pton: 8 groups of 1 to 4 hex digits, where one run of one or
+// more zero groups may be replaced with "::", and the last 2 groups may be
+// written as an IPv4 address.
+inline bool fastIpv6FromBuffer(const char* str, size_t len, uint8_t* out) {
+  // "0000:0000:0000:0000:0000:ffff:255.255.255.255"
+  if (len < 2 || len > 45) {
+    return false;
+  }
+  const char* const end = str + len;
+  std::memset(out, 0, 16);
+  int groups = 0;
+  int zerosBegin = -1;
+  if (str[0] == ':') {
+    if (str[1] != ':') {
+      return false;
+    }
+    ++str;
+  }
+  while (str != end) {
+    if (*str == ':') {
+      // Only the "::" can get here, and only once.
+      if (zerosBegin != -1) {
+        return false;
+      }
+      zerosBegin = groups;
+      if (++str == end) {
+        break;
+      }
+      continue;
+    }
+    const char* const begin = str;
+    unsigned group = 0;
+    while (str != end && str - begin < 4) {
+      auto const digit = hex_decode_digit(*str);
+      if (!hex_decoded_digit_is_valid(digit)) {
+        break;
+      }
+      group = group << 4 | digit;
+      ++str;
+    }
+    if (str != end && *str == '.') {
+      if (groups > 6 ||
+          !fastIpv4FromBuffer(begin, end - begin, out + 2 * groups)) {
+        return false;
+      }
+      groups += 2;
+      str = end;
+      break;
+    }
+    if (str == begin || groups == 8) {
+      return false;
+    }
+    out[2 * groups] = uint8_t(group >> 8);
+    out[2 * groups + 1] = uint8_t(group);
+    ++groups;
+    if (str == end) {
+      break;
+    }
+    if (*(str++) != ':' || str == end) {
+      return false;
+    }
+  }
+  if (zerosBegin == -1) {
+    return groups == 8;
+  }
+  if (groups == 8) {
+    return false;
+  }
+  // Move the groups after the "::" to the end.
+  auto const tail = 2 * (groups - zerosBegin);
+  std::memmove(out + 16 - tail, out + 2 * zerosBegin, tail);
+  std::memset(out + 2 * zerosBegin, 0, 16 - tail - 2 * zerosBegin);
+  return true;
+}
 } // namespace detail
 } // namespace folly
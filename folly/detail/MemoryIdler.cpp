@@ -39,6 +39,14 @@ FOLLY_GFLAGS_DEFINE_bool(
     false,
     "if enabled, folly memory-idler purges jemalloc arenas on thread idle");
 
+FOLLY_GFLAGS_DEFINE_bool(
+    folly_memory_idler_decay_arenas,
+    false,
+    "if enabled, and folly_memory_idler_purge_arenas is not, folly "
+    "memory-idler lets jemalloc purge the dirty pages of the thread's arena "
+    "that are past their decay time on thread idle, rather than all of them, "
+    "which breaks up fewer huge pages");
+
 FOLLY_GFLAGS_DEFINE_bool(
     folly_memory_idler_madvise_stacks,
     true,
@@ -80,7 +88,8 @@ void MemoryIdler::flushLocalMallocCaches() {
   // Not using mallctlCall as this will fail if tcache is disabled.
   mallctl("thread.tcache.flush", nullptr, nullptr, nullptr, 0);
 
-  if (FLAGS_folly_memory_idler_purge_arenas) {
+  if (FLAGS_folly_memory_idler_purge_arenas ||
+      FLAGS_folly_memory_idler_decay_arenas) {
     try {
       // By default jemalloc has 4 arenas per cpu, and then assigns each
       // thread to one of those arenas.  This means that in any service
@@ -92,15 +101,22 @@ void MemoryIdler::flushLocalMallocCaches() {
       // purging the arenas is counter-productive.  We use the heuristic
       // that if narenas <= 2 * num_cpus then we shouldn't do anything here,
       // which detects when the narenas has been reduced from the default
+      //
+      // Decaying rather than purging only returns the dirty pages that have
+      // been unused for the configured dirty_decay_ms, so that the arena
+      // keeps the extents, and the huge pages backing them, that it is still
+      // likely to reuse.
       unsigned narenas;
       unsigned arenaForCurrent;
       size_t mib[3];
       size_t miblen = 3;
+      auto cmd = FLAGS_folly_memory_idler_purge_arenas ? "arena.0.purge"
+                                                       : "arena.0.decay";
 
       mallctlRead("opt.narenas", &narenas);
       mallctlRead("thread.arena", &arenaForCurrent);
       if (narenas > 2 * CacheLocality::system().numCpus &&
-          mallctlnametomib("arena.0.purge", mib, &miblen) == 0) {
+          mallctlnametomib(cmd, mib, &miblen) == 0) {
         mib[1] = static_cast<size_t>(arenaForCurrent);
         mallctlbymib(mib, miblen, nullptr, nullptr, nullptr, 0);
       }
@@ -232,10 +248,39 @@ void MemoryIdler::unmapUnusedStack(size_t retain) {
   }
 }
 
+void MemoryIdler::unmapUnusedStack(
+    void* stackLimit, void* stackPointer, size_t retain) {
+  if (!FLAGS_folly_memory_idler_madvise_stacks) {
+    return;
+  }
+
+  // The stack may not start on a page boundary, e.g. if it was malloc()ed:
+  // only discard the pages that are entirely part of it.
+  auto limit = (reinterpret_cast<uintptr_t>(stackLimit) + pageSize() - 1) &
+      ~(pageSize() - 1);
+  auto sp = reinterpret_cast<uintptr_t>(stackPointer);
+  if (sp < limit || sp - limit <= retain) {
+    return;
+  }
+
+  auto end = (sp - retain) & ~(pageSize() - 1);
+  if (end <= limit) {
+    return;
+  }
+
+  if (madvise((void*)limit, end - limit, MADV_DONTNEED) != 0) {
+    PLOG_IF(WARNING, kIsDebug && errno == EINVAL) << "madvise failed";
+    assert(errno == EAGAIN || errno == ENOMEM || errno == EINVAL);
+  }
+}
+
 #else
 
 void MemoryIdler::unmapUnusedStack(size_t /* retain */) {}
 
+void MemoryIdler::unmapUnusedStack(
+    void* /* stackLimit */, void* /* stackPointer */, size_t /* retain */) {}
+
 #endif
 
 } // namespace detail
@@ -58,6 +58,15 @@ struct MemoryIdler {
   /// faults will occur during the next retain bytes of stack allocation
   static void unmapUnusedStack(size_t retain = kDefaultStackToRetain);
 
+  /// Same for a stack that is not the one of the calling thread, e.g. the
+  /// stack of a suspended fiber: discards the pages between stackLimit, its
+  /// lowest address, and retain bytes below stackPointer. The caller must
+  /// ensure that nothing below stackPointer is in use.
+  static void unmapUnusedStack(
+      void* stackLimit,
+      void* stackPointer,
+      size_t retain = kDefaultStackToRetain);
+
   /// The system-wide default for the amount of time a blocking
   /// thread should wait before reclaiming idle memory.  Set this to
   /// Duration::max() to never wait.  The default value is 5 seconds.
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/PerfCounters.h>
+
+#if FOLLY_PERF_COUNTERS_ARE_SUPPORTED
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace folly {
+namespace detail {
+
+#if FOLLY_PERF_COUNTERS_ARE_SUPPORTED
+
+namespace {
+
+struct PerfEvent {
+  std::uint64_t config;
+  double PerfCounterValues::* member;
+};
+
+constexpr PerfEvent kPerfEvents[] = {
+    {PERF_COUNT_HW_CPU_CYCLES, &PerfCounterValues::cycles},
+    {PERF_COUNT_HW_INSTRUCTIONS, &PerfCounterValues::instructions},
+    {PERF_COUNT_HW_CACHE_MISSES, &PerfCounterValues::llcMisses},
+    {PERF_COUNT_HW_BRANCH_MISSES, &PerfCounterValues::branchMisses},
+};
+
+int openPerfEvent(std::uint64_t config, int groupFd) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = groupFd < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+  // The first event which can be opened leads the group.
+  for (auto& event : kPerfEvents) {
+    int fd = openPerfEvent(event.config, leader_);
+    if (fd < 0) {
+      continue;
+    }
+    if (leader_ < 0) {
+      leader_ = fd;
+    }
+    fds_[size_] = fd;
+    members_[size_] = event.member;
+    ++size_;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (std::size_t i = 0; i < size_; ++i) {
+    close(fds_[i]);
+  }
+}
+
+void PerfCounters::start() {
+  if (supported()) {
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    resume();
+  }
+}
+
+void PerfCounters::pause() {
+  if (supported()) {
+    ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+void PerfCounters::resume() {
+  if (supported()) {
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+PerfCounterValues PerfCounters::stop() {
+  PerfCounterValues values;
+  if (!supported()) {
+    return values;
+  }
+  pause();
+  // nr, time_enabled, time_running, then the value of each event.
+  std::uint64_t data[3 + kEvents];
+  auto bytes = read(leader_, data, sizeof(data));
+  if (bytes < ssize_t(3 * sizeof(std::uint64_t)) || data[0] != size_ ||
+      data[2] == 0) {
+    return values;
+  }
+  // The events were only counted for time_running out of time_enabled.
+  double scale = double(data[1]) / double(data[2]);
+  for (std::size_t i = 0; i < size_; ++i) {
+    values.*members_[i] = double(data[3 + i]) * scale;
+  }
+  return values;
+}
+
+#else
+
+PerfCounters::PerfCounters() = default;
+PerfCounters::~PerfCounters() = default;
+void PerfCounters::start() {}
+void PerfCounters::pause() {}
+void PerfCounters::resume() {}
+PerfCounterValues PerfCounters::stop() {
+  return {};
+}
+
+#endif
+
+} // namespace detail
+} // namespace folly
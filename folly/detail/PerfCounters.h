@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace folly {
+namespace detail {
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#define FOLLY_PERF_COUNTERS_ARE_SUPPORTED 1
+#else
+#define FOLLY_PERF_COUNTERS_ARE_SUPPORTED 0
+#endif
+
+/*
+ * Counts of hardware events, NaN for the events the CPU or the kernel
+ * doesn't count.
+ */
+struct PerfCounterValues {
+  static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+  double cycles = kNaN;
+  double instructions = kNaN;
+  double llcMisses = kNaN;
+  double branchMisses = kNaN;
+
+  double ipc() const { return instructions / cycles; }
+
+  PerfCounterValues& operator/=(double n) {
+    cycles /= n;
+    instructions /= n;
+    llcMisses /= n;
+    branchMisses /= n;
+    return *this;
+  }
+};
+
+/*
+ * A folly::benchmark helper for counting the cycles, instructions, last
+ * level cache misses and branch misses of the calling thread, in user
+ * space, with perf_event_open. The events are a group, so that they are
+ * counted over the same time, and scaled if the kernel multiplexes them
+ * with other groups.
+ *
+ * Only available on linux, and where perf_event_paranoid allows it.
+ */
+class PerfCounters {
+ public:
+  // Opens the counters, disabled.
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // Whether any event can be counted.
+  bool supported() const { return leader_ >= 0; }
+
+  // Resets the counters, and enables them.
+  void start();
+
+  // Disables and enables the counters, without resetting them.
+  void pause();
+  void resume();
+
+  // Disables the counters, and returns their counts since start().
+  PerfCounterValues stop();
+
+ private:
+  static constexpr std::size_t kEvents = 4;
+
+  int leader_ = -1;
+  int fds_[kEvents] = {-1, -1, -1, -1};
+  // The events which could be opened, in the order of the group.
+  double PerfCounterValues::* members_[kEvents] = {};
+  std::size_t size_ = 0;
+};
+
+} // namespace detail
+} // namespace folly
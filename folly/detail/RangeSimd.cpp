@@ -16,23 +16,237 @@
 
 #include <folly/detail/RangeSimd.h>
 
+#include <cstdint>
+#include <cstring>
+#include <string>
+
 #include <folly/Portability.h>
 
 #include <folly/detail/RangeSse42.h>
 #include <folly/external/nvidia/detail/RangeSve2.h>
+#include <folly/lang/Bits.h>
+#include <folly/system/CpuDispatch.h>
+
+#if FOLLY_SSE_PREREQ(2, 0)
+#include <emmintrin.h>
+#elif FOLLY_NEON
+#include <arm_neon.h>
+#endif
 
 namespace folly {
 namespace detail {
 
+#if FOLLY_ARM_FEATURE_SVE2
+
 size_t qfind_first_byte_of_simd(
     const StringPieceLite haystack, const StringPieceLite needles) {
-#if FOLLY_ARM_FEATURE_SVE2
   return qfind_first_byte_of_sve2(haystack, needles);
+}
+
 #elif FOLLY_SSE_PREREQ(4, 2)
+
+size_t qfind_first_byte_of_simd(
+    const StringPieceLite haystack, const StringPieceLite needles) {
   return qfind_first_byte_of_sse42(haystack, needles);
+}
+
+#elif FOLLY_X64
+
+namespace {
+
+size_t qfind_first_byte_of_generic(
+    const StringPieceLite haystack, const StringPieceLite needles) {
+  return qfind_first_byte_of_nosimd(haystack, needles);
+}
+
+// SSE4.2 isn't enabled at compile time, so the CPU is checked.
+decltype(&qfind_first_byte_of_simd) select_qfind_first_byte_of(
+    const CpuFeatures& cpu) {
+  return cpu.cpuId.sse42() ? qfind_first_byte_of_sse42
+                           : qfind_first_byte_of_generic;
+}
+
+} // namespace
+
+FOLLY_CPU_DISPATCH(
+    qfind_first_byte_of_simd,
+    select_qfind_first_byte_of,
+    (const StringPieceLite haystack, const StringPieceLite needles),
+    (haystack, needles));
+
 #else
+
+size_t qfind_first_byte_of_simd(
+    const StringPieceLite haystack, const StringPieceLite needles) {
   return qfind_first_byte_of_nosimd(haystack, needles);
+}
+
+#endif
+
+namespace {
+
+// The ASCII letters are compared in lower case, which only differs from the
+// upper case by the 0x20 bit. The other characters, including the bytes which
+// aren't ASCII, are compared as they are.
+
+FOLLY_ALWAYS_INLINE char ascii_fold(char c) {
+  return static_cast<char>(
+      c | (static_cast<unsigned char>(c - 'A') < 26 ? 0x20 : 0));
+}
+
+// Folds 8 characters at a time. The high bit of each byte is cleared, so that
+// the additions don't carry into the next byte, and the bytes which had it set
+// aren't letters.
+FOLLY_ALWAYS_INLINE uint64_t ascii_fold_word(uint64_t x) {
+  constexpr uint64_t kOnes = 0x0101010101010101;
+  uint64_t const low = x & (0x7f * kOnes);
+  uint64_t const geA = low + (0x80 - 'A') * kOnes;
+  uint64_t const gtZ = low + (0x80 - 'Z' - 1) * kOnes;
+  uint64_t const upper = geA & ~gtZ & ~x & (0x80 * kOnes);
+  return x | (upper >> 2);
+}
+
+FOLLY_ALWAYS_INLINE uint64_t load_word(const char* p) {
+  uint64_t x;
+  std::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+#if FOLLY_SSE_PREREQ(2, 0)
+
+#define FOLLY_RANGE_SIMD_CASE_FOLD 1
+
+struct CaseFoldSimd {
+  using reg_t = __m128i;
+  using mask_t = uint32_t;
+  static constexpr size_t kCardinal = 16;
+  static constexpr size_t kBitsPerElement = 1;
+  static constexpr mask_t kAllSet = 0xffff;
+
+  static reg_t loadu(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static reg_t splat(char c) { return _mm_set1_epi8(c); }
+  // There are no unsigned comparisons: 'A'..'Z' are moved to the bottom of
+  // the signed range, where a single signed comparison finds them.
+  static reg_t fold(reg_t x) {
+    reg_t const shifted = _mm_add_epi8(x, _mm_set1_epi8(char(0x80 - 'A')));
+    reg_t const upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+  }
+  static mask_t equal(reg_t x, reg_t y) {
+    return static_cast<mask_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+  }
+};
+
+#elif FOLLY_NEON
+
+#define FOLLY_RANGE_SIMD_CASE_FOLD 1
+
+struct CaseFoldSimd {
+  using reg_t = uint8x16_t;
+  using mask_t = uint64_t;
+  static constexpr size_t kCardinal = 16;
+  static constexpr size_t kBitsPerElement = 4;
+  static constexpr mask_t kAllSet = ~mask_t(0);
+
+  static reg_t loadu(const char* p) {
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+  }
+  static reg_t splat(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+  static reg_t fold(reg_t x) {
+    uint8x16_t const upper =
+        vcltq_u8(vsubq_u8(x, vdupq_n_u8('A')), vdupq_n_u8(26));
+    return vorrq_u8(x, vandq_u8(upper, vdupq_n_u8(0x20)));
+  }
+  // There is no movemask: the comparison is narrowed to 4 bits per element.
+  static mask_t equal(reg_t x, reg_t y) {
+    uint8x8_t const narrowed =
+        vshrn_n_u16(vreinterpretq_u16_u8(vceqq_u8(x, y)), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+  }
+};
+
+#else
+
+#define FOLLY_RANGE_SIMD_CASE_FOLD 0
+
+#endif
+
+} // namespace
+
+bool ascii_case_insensitive_equal_simd(
+    const char* lhs, const char* rhs, size_t n) {
+  size_t i = 0;
+#if FOLLY_RANGE_SIMD_CASE_FOLD
+  using Simd = CaseFoldSimd;
+  for (; i + Simd::kCardinal <= n; i += Simd::kCardinal) {
+    auto const x = Simd::fold(Simd::loadu(lhs + i));
+    auto const y = Simd::fold(Simd::loadu(rhs + i));
+    if (Simd::equal(x, y) != Simd::kAllSet) {
+      return false;
+    }
+  }
+#endif
+  for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+    if (ascii_fold_word(load_word(lhs + i)) !=
+        ascii_fold_word(load_word(rhs + i))) {
+      return false;
+    }
+  }
+  for (; i < n; ++i) {
+    if (ascii_fold(lhs[i]) != ascii_fold(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t qfind_ascii_case_insensitive_simd(
+    const StringPieceLite haystack, const StringPieceLite needle) {
+  size_t const n = needle.size();
+  if (n == 0) {
+    return 0;
+  }
+  if (n > haystack.size()) {
+    return std::string::npos;
+  }
+  const char* const h = haystack.data();
+  const char* const ndl = needle.data();
+  // The positions [0, end) are candidates.
+  size_t const end = haystack.size() - n + 1;
+  char const first = ascii_fold(ndl[0]);
+  char const last = ascii_fold(ndl[n - 1]);
+  size_t pos = 0;
+#if FOLLY_RANGE_SIMD_CASE_FOLD
+  // Compares the first and the last character of the needle with a register
+  // of candidate positions each, and only compares the whole needle at the
+  // positions where both match.
+  using Simd = CaseFoldSimd;
+  auto const firsts = Simd::splat(first);
+  auto const lasts = Simd::splat(last);
+  constexpr typename Simd::mask_t kElementBits =
+      (typename Simd::mask_t(1) << Simd::kBitsPerElement) - 1;
+  for (; pos + Simd::kCardinal <= end; pos += Simd::kCardinal) {
+    auto mask =
+        Simd::equal(Simd::fold(Simd::loadu(h + pos)), firsts) &
+        Simd::equal(Simd::fold(Simd::loadu(h + pos + n - 1)), lasts);
+    while (mask) {
+      size_t const offset = (findFirstSet(mask) - 1) / Simd::kBitsPerElement;
+      if (ascii_case_insensitive_equal_simd(h + pos + offset, ndl, n)) {
+        return pos + offset;
+      }
+      mask &= ~(kElementBits << (offset * Simd::kBitsPerElement));
+    }
+  }
 #endif
+  for (; pos < end; ++pos) {
+    if (ascii_fold(h[pos]) == first && ascii_fold(h[pos + n - 1]) == last &&
+        ascii_case_insensitive_equal_simd(h + pos, ndl, n)) {
+      return pos;
+    }
+  }
+  return std::string::npos;
 }
 
 } // namespace detail
@@ -26,5 +26,15 @@ namespace detail {
 size_t qfind_first_byte_of_simd(
     const StringPieceLite haystack, const StringPieceLite needles);
 
+// Whether the n characters at lhs and rhs are equal, ignoring the case of the
+// ASCII letters, as with AsciiCaseInsensitive.
+bool ascii_case_insensitive_equal_simd(
+    const char* lhs, const char* rhs, size_t n);
+
+// Returns the position of the first occurrence of needle in haystack,
+// ignoring the case of the ASCII letters, or std::string::npos.
+size_t qfind_ascii_case_insensitive_simd(
+    const StringPieceLite haystack, const StringPieceLite needle);
+
 } // namespace detail
 } // namespace folly
@@ -21,11 +21,10 @@
 #include <folly/Portability.h>
 
 //  Essentially, two versions of this file: one with an SSE42 implementation
-//  and one with a fallback implementation. We determine which version to use by
-//  testing for the presence of the required headers.
-//
-//  TODO: Maybe this should be done by the build system....
-#if !FOLLY_SSE_PREREQ(4, 2)
+//  and one with a fallback implementation. The SSE42 implementation is built
+//  for all x86-64 targets, with the target attribute where SSE42 isn't enabled,
+//  and qfind_first_byte_of_simd only calls it on CPUs which support it.
+#if !FOLLY_SSE_PREREQ(4, 2) && !FOLLY_X64
 namespace folly {
 namespace detail {
 size_t qfind_first_byte_of_sse42(
@@ -68,6 +67,7 @@ static inline size_t nextAlignedIndex(const char* arr) {
 }
 
 // helper method for case where needles.size() <= 16
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
 size_t qfind_first_byte_of_needles16(
     const StringPieceLite haystack, const StringPieceLite needles) {
   assert(haystack.size() > 0u);
@@ -112,6 +112,7 @@ size_t qfind_first_byte_of_needles16(
 // If !HAYSTACK_ALIGNED, then caller must ensure that it is safe to load the
 // block.
 template <bool HAYSTACK_ALIGNED>
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
 size_t scanHaystackBlock(
     const StringPieceLite haystack,
     const StringPieceLite needles,
@@ -159,6 +160,7 @@ size_t scanHaystackBlock(
 size_t qfind_first_byte_of_sse42(
     const StringPieceLite haystack, const StringPieceLite needles);
 
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
 size_t qfind_first_byte_of_sse42(
     const StringPieceLite haystack, const StringPieceLite needles) {
   if (FOLLY_UNLIKELY(needles.empty() || haystack.empty())) {
@@ -19,11 +19,29 @@
 
 #include <folly/FBString.h>
 #include <folly/FBVector.h>
+#include <folly/algorithm/simd/find_first_of.h>
 #include <folly/small_vector.h>
 
 namespace folly {
 namespace detail {
 
+std::size_t simdFindString(
+    folly::StringPiece what, std::size_t pos, folly::StringPiece delim) {
+  return PlatformSimdFindString<simd::detail::SimdPlatform<std::uint8_t>>{}(
+      what, pos, delim);
+}
+
+std::size_t simdFindFirstOf(
+    folly::StringPiece what, std::size_t pos, folly::StringPiece chars) {
+  // The default finders need no precomputation, which would not pay off for
+  // the short tokens of a split.
+  using finder = simd::composite_finder_first_of<
+      simd::default_vector_finder_first_of,
+      simd::default_scalar_finder_first_of>;
+  return finder{span<char const>(chars.data(), chars.size())}(
+      span<char const>(what.data(), what.size()), pos);
+}
+
 template <typename Container>
 void SimdSplitByCharImpl<Container>::keepEmpty(
     char sep, folly::StringPiece what, Container& res) {
@@ -42,6 +42,16 @@ using PredeclareFbString = basic_fbstring<
     std::allocator<char>,
     fbstring_core<char>>;
 
+// Returns the position of the first occurrence of delim, of at least 2
+// characters, in what at or after pos, or what.size() if there is none.
+std::size_t simdFindString(
+    folly::StringPiece what, std::size_t pos, folly::StringPiece delim);
+
+// Returns the position of the first character of what at or after pos which
+// is one of chars, or what.size() if there is none.
+std::size_t simdFindFirstOf(
+    folly::StringPiece what, std::size_t pos, folly::StringPiece chars);
+
 template <typename Container>
 struct SimdSplitByCharImpl {
   static void keepEmpty(char sep, folly::StringPiece what, Container& res);
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstring>
+
 #include <folly/Portability.h>
 #include <folly/Range.h>
 #include <folly/algorithm/simd/Ignore.h>
@@ -145,5 +147,68 @@ struct PlatformSimdSplitByChar<void, ignoreEmpty> {
   }
 };
 
+// Finds the first occurrence of a delimiter of at least 2 characters in
+// what, starting at pos. Returns what.size() if there is none.
+FOLLY_ALWAYS_INLINE std::size_t findStringScalar(
+    folly::StringPiece what, std::size_t pos, folly::StringPiece delim) {
+  const std::size_t n = delim.size();
+  for (; pos + n <= what.size(); ++pos) {
+    if (what[pos] == delim.front() &&
+        std::memcmp(what.data() + pos + 1, delim.data() + 1, n - 1) == 0) {
+      return pos;
+    }
+  }
+  return what.size();
+}
+
+// Compares the first and the last character of the delimiter with a register
+// of candidate positions each, and only compares the whole delimiter at the
+// positions where both match.
+template <typename Platform>
+struct PlatformSimdFindString {
+  using reg_t = typename Platform::reg_t;
+
+  FOLLY_ALWAYS_INLINE std::size_t operator()(
+      folly::StringPiece what,
+      std::size_t pos,
+      folly::StringPiece delim) const {
+    const std::uint8_t* f = reinterpret_cast<const std::uint8_t*>(what.data());
+    const std::size_t n = delim.size();
+    const auto first = static_cast<std::uint8_t>(delim.front());
+    const auto last = static_cast<std::uint8_t>(delim.back());
+
+    while (pos + n - 1 + Platform::kCardinal <= what.size()) {
+      reg_t firsts = Platform::loadu(f + pos, simd::ignore_none{});
+      reg_t lasts = Platform::loadu(f + pos + n - 1, simd::ignore_none{});
+      auto [firstBits, bitsPerElement] =
+          simd::movemask<std::uint8_t>(Platform::equal(firsts, first));
+      auto mmaskBits = firstBits &
+          simd::movemask<std::uint8_t>(Platform::equal(lasts, last)).first;
+      while (mmaskBits) {
+        auto counted = folly::findFirstSet(mmaskBits) - 1;
+        auto firstSet = counted / bitsPerElement;
+        const std::uint8_t* candidate = f + pos + firstSet;
+        if (std::memcmp(candidate + 1, delim.data() + 1, n - 2) == 0) {
+          return pos + firstSet;
+        }
+        mmaskBits = clear_n_least_significant_bits(
+            mmaskBits, (firstSet + 1) * bitsPerElement);
+      }
+      pos += Platform::kCardinal;
+    }
+    return findStringScalar(what, pos, delim);
+  }
+};
+
+template <>
+struct PlatformSimdFindString<void> {
+  FOLLY_ALWAYS_INLINE std::size_t operator()(
+      folly::StringPiece what,
+      std::size_t pos,
+      folly::StringPiece delim) const {
+    return findStringScalar(what, pos, delim);
+  }
+};
+
 } // namespace detail
 } // namespace folly
@@ -24,6 +24,7 @@
 #include <folly/ConstexprMath.h>
 #include <folly/Utility.h>
 #include <folly/detail/thread_local_globals.h>
+#include <folly/lang/Bits.h>
 #include <folly/lang/Hint.h>
 #include <folly/memory/SanitizeLeak.h>
 #include <folly/synchronization/CallOnce.h>
@@ -57,6 +58,44 @@ uintptr_t ElementWrapper::castForgetAlign(DeleterFunType* f) noexcept {
   return reinterpret_cast<uintptr_t>(q);
 }
 
+namespace {
+
+// The slots taken, as a bitmask, and the last generation of keys.
+std::atomic<uint32_t> gHotSlotsUsed{0};
+std::atomic<uint64_t> gHotSlotsGeneration{0};
+static_assert(HotSlots::kCount <= 32);
+
+} // namespace
+
+uint64_t HotSlots::acquire() noexcept {
+  if (!StaticMetaBase::kUseThreadLocal) {
+    return 0;
+  }
+  auto used = gHotSlotsUsed.load(std::memory_order_relaxed);
+  size_t index;
+  do {
+    auto const free = ~used & ((uint64_t(1) << kCount) - 1);
+    if (free == 0) {
+      return 0;
+    }
+    index = findFirstSet(free) - 1;
+  } while (!gHotSlotsUsed.compare_exchange_weak(
+      used, used | (uint32_t(1) << index), std::memory_order_relaxed));
+  auto const generation = gHotSlotsGeneration.fetch_add(1) + 1;
+  return generation * kCount + index;
+}
+
+void HotSlots::release(uint64_t key) noexcept {
+  gHotSlotsUsed.fetch_and(
+      ~(uint32_t(1) << (key % kCount)), std::memory_order_relaxed);
+}
+
+void HotSlots::clearThread() noexcept {
+  for (size_t i = 0; i < kCount; ++i) {
+    slot(i).key = 0;
+  }
+}
+
 bool ThreadEntrySet::basicSanity() const {
   if constexpr (!kIsDebug) {
     return true;
@@ -146,6 +185,9 @@ bool StaticMetaBase::dying() {
 
 void StaticMetaBase::onThreadExit(void* ptr) {
   folly::detail::thread_is_dying_mark();
+  // The elements are about to be disposed of, and the hot instances don't
+  // cache them from now on.
+  HotSlots::clearThread();
   auto threadEntry = static_cast<ThreadEntry*>(ptr);
 
   {
@@ -435,6 +477,7 @@ void StaticMetaBase::reserve(EntryID* id) {
 
   size_t newCapacity;
   ElementWrapper* reallocated = reallocate(threadEntry, idval, newCapacity);
+  std::vector<ElementWrapper*> retired;
 
   // Success, update the entry
   {
@@ -453,7 +496,16 @@ void StaticMetaBase::reserve(EntryID* id) {
             threadEntry->elements,
             sizeof(*reallocated) * prevCapacity);
       }
-      std::swap(reallocated, threadEntry->elements);
+      // Accessors may still be reading the previous array: see
+      // addElementsReader().
+      auto const previous = threadEntry->elements;
+      make_atomic_ref(threadEntry->elements).store(reallocated);
+      reallocated = previous;
+      if (reallocated && meta.elementsReaders_.load() != 0) {
+        meta.retiredElements_.push_back(std::exchange(reallocated, nullptr));
+        meta.hasRetiredElements_.store(true);
+        retired = meta.takeRetiredElements();
+      }
     }
 
     threadEntry->setElementsCapacity(newCapacity);
@@ -461,13 +513,43 @@ void StaticMetaBase::reserve(EntryID* id) {
 
   meta.totalElementWrappers_ += (newCapacity - prevCapacity);
   free(reallocated);
+  for (auto elements : retired) {
+    free(elements);
+  }
+}
+
+void StaticMetaBase::removeElementsReader() {
+  if (elementsReaders_.fetch_sub(1) != 1 || !hasRetiredElements_.load()) {
+    return;
+  }
+  std::vector<ElementWrapper*> retired;
+  {
+    std::lock_guard g(lock_);
+    retired = takeRetiredElements();
+  }
+  for (auto elements : retired) {
+    free(elements);
+  }
+}
+
+std::vector<ElementWrapper*> StaticMetaBase::takeRetiredElements() {
+  if (elementsReaders_.load() != 0) {
+    return {};
+  }
+  hasRetiredElements_.store(false);
+  return std::exchange(retiredElements_, {});
 }
 
 FOLLY_NOINLINE void StaticMetaBase::ensureThreadEntryIsInSet(
     ThreadEntry* te,
+    uint32_t id,
     SynchronizedThreadEntrySet& set,
     SynchronizedThreadEntrySet::RLockedPtr& rlock) {
   rlock.unlock();
+  auto pos = std::lower_bound(te->setIds.begin(), te->setIds.end(), id);
+  if (pos == te->setIds.end() || *pos != id) {
+    te->setIds.insert(pos, id);
+  }
   auto wlock = set.wlock();
   wlock->insert(te);
   rlock = wlock.moveFromWriteToRead();
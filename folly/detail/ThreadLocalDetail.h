@@ -44,6 +44,7 @@
 #include <folly/lang/Exception.h>
 #include <folly/memory/Malloc.h>
 #include <folly/portability/PThread.h>
+#include <folly/synchronization/AtomicRef.h>
 #include <folly/synchronization/MicroSpinLock.h>
 #include <folly/synchronization/RelaxedAtomic.h>
 #include <folly/system/AtFork.h>
@@ -202,6 +203,42 @@ struct ElementWrapper {
   uintptr_t deleter;
 };
 
+/**
+ * The static TLS slots of the hot ThreadLocalPtr instances: see
+ * thread_local_hot. Each hot instance owns a slot, under a key unique to the
+ * instance, and each thread caches its element of the instance in the slot
+ * along with the key. A cached element is valid while its key is that of the
+ * owner of the slot, so the keys of the other threads need not be cleared
+ * when the slot changes hands.
+ */
+struct HotSlots {
+  static constexpr size_t kCount = 16;
+
+  struct Slot {
+    uint64_t key;
+    void* ptr;
+  };
+
+  // A key, of which key % kCount is the slot, or 0 if all of them are taken.
+  static uint64_t acquire() noexcept;
+  static void release(uint64_t key) noexcept;
+
+  FOLLY_EXPORT FOLLY_ALWAYS_INLINE static Slot& slot(uint64_t key) noexcept {
+    FOLLY_TLS_INITIAL_EXEC static thread_local Slot slots[kCount];
+    return slots[key % kCount];
+  }
+
+  FOLLY_ALWAYS_INLINE static void invalidate(uint64_t key) noexcept {
+    auto& slot = HotSlots::slot(key);
+    if (slot.key == key) {
+      slot.key = 0;
+    }
+  }
+
+  // Forgets the elements cached by the calling thread, which is exiting.
+  static void clearThread() noexcept;
+};
+
 struct StaticMetaBase;
 struct ThreadEntryList;
 
@@ -209,7 +246,7 @@ struct ThreadEntryList;
  * Per-thread entry.  Each thread using a StaticMeta object has one.
  * This is written from the owning thread only (under the lock), read
  * from the owning thread (no lock necessary), and read from other threads
- * (under the lock).
+ * (under the lock, or by the accessors through loadElements()).
  */
 struct ThreadEntry {
   ElementWrapper* elements{nullptr};
@@ -220,6 +257,16 @@ struct ThreadEntry {
   bool removed_{false};
   uint64_t tid_os{};
   aligned_storage_for_t<std::thread::id> tid_data{};
+  // The ids of the sets of StaticMetaBase::allId2ThreadEntrySets_ which the
+  // thread added itself to, sorted. Only the thread writes it, and it may
+  // list sets the thread was since removed from, by destroy() or a fork.
+  std::vector<uint32_t> setIds;
+
+  // The elements, as the accessors of the other threads read them: see
+  // StaticMetaBase::addElementsReader().
+  ElementWrapper* loadElements() noexcept {
+    return make_atomic_ref(elements).load();
+  }
 
   size_t getElementsCapacity() const noexcept {
     return elementsCapacity.load(std::memory_order_relaxed);
@@ -469,6 +516,20 @@ struct StaticMetaBase {
 
   ElementWrapper& getElement(EntryID* ent);
 
+  /*
+   * The accessors read the elements of the other threads without lock_, so
+   * the arrays which reserve() replaces while an accessor is around are
+   * retired, and freed once the last accessor is gone. An accessor adds
+   * itself as a reader before it loads any array.
+   */
+  void addElementsReader() noexcept { elementsReaders_.fetch_add(1); }
+
+  void removeElementsReader();
+
+  // The retired arrays which may be freed, as no accessor is around. Must be
+  // called with lock_ held.
+  std::vector<ElementWrapper*> takeRetiredElements();
+
   using SynchronizedThreadEntrySet = folly::Synchronized<ThreadEntrySet>;
 
   /*
@@ -496,6 +557,7 @@ struct StaticMetaBase {
    */
   FOLLY_NOINLINE void ensureThreadEntryIsInSet(
       ThreadEntry* te,
+      uint32_t id,
       SynchronizedThreadEntrySet& set,
       SynchronizedThreadEntrySet::RLockedPtr& rlock);
 
@@ -503,17 +565,19 @@ struct StaticMetaBase {
    * Remove a ThreadEntry* from the map of allId2ThreadEntrySets_
    * for all slot @id's in ThreadEntry::elements that are
    * used. This is essentially clearing out a ThreadEntry entirely
-   * from the allId2ThreadEntrySets_.
+   * from the allId2ThreadEntrySets_. Only the sets listed in
+   * ThreadEntry::setIds are locked, so that an exiting thread doesn't wait
+   * for the accessors of the ids it never used.
    */
   FOLLY_ALWAYS_INLINE void removeThreadEntryFromAllInMap(ThreadEntry* te) {
-    for (const auto ptr : getThreadEntrySetsPtrSpan()) {
-      auto& set = *ptr;
-      set.wlock()->erase(te);
+    for (const auto id : te->setIds) {
+      allId2ThreadEntrySets_[id].wlock()->erase(te);
     }
   }
 
   /*
-   * Check if ThreadEntry* is present in the map for all slots of @ids.
+   * Check if ThreadEntry* is present in the map for all slots of @ids. The
+   * entry may only be in the sets listed in ThreadEntry::setIds.
    */
   FOLLY_ALWAYS_INLINE bool isThreadEntryRemovedFromAllInMap(
       ThreadEntry* te, bool needForkLock) {
@@ -521,9 +585,8 @@ struct StaticMetaBase {
     if (needForkLock) {
       rlocked.lock();
     }
-    for (const auto ptr : getThreadEntrySetsPtrSpan()) {
-      auto& set = *ptr;
-      if (set.rlock()->contains(te)) {
+    for (const auto id : te->setIds) {
+      if (allId2ThreadEntrySets_[id].rlock()->contains(te)) {
         return false;
       }
     }
@@ -566,6 +629,10 @@ struct StaticMetaBase {
   // can be sparse when there are lots of thread local variables under the same
   // tag.
   relaxed_atomic_int64_t totalElementWrappers_{0};
+  // See addElementsReader(). The retired arrays are guarded by lock_.
+  std::atomic<size_t> elementsReaders_{0};
+  std::atomic<bool> hasRetiredElements_{false};
+  std::vector<ElementWrapper*> retiredElements_;
   // This is a map of all thread entries mapped to index i with active
   // elements[i];
   folly::atomic_grow_array<SynchronizedThreadEntrySet> allId2ThreadEntrySets_;
@@ -576,6 +643,9 @@ struct StaticMetaBase {
   // per thread entry set lock implicit in SynchronizedThreadEntrySet and
   // meta lock (lock_)
   //
+  // The accessors hold the per thread entry set lock of their id, and the
+  // access all threads lock only in strict mode.
+  //
   // If multiple locks need to be acquired in a call path, the above is also
   // the order in which they should be acquired. Additionally, if per
   // ThreadEntrySet locks are the only ones that are acquired in a path, it
@@ -598,7 +668,7 @@ void ThreadEntry::resetElement(Ptr p, uint32_t id) {
   auto& set = meta->allId2ThreadEntrySets_[id];
   auto rlock = set.rlock();
   if (p != nullptr && !removed_ && !rlock->contains(this)) {
-    meta->ensureThreadEntryIsInSet(this, set, rlock);
+    meta->ensureThreadEntryIsInSet(this, id, set, rlock);
   }
   cleanupElement(id);
   elements[id].set(p);
@@ -614,7 +684,7 @@ void ThreadEntry::resetElement(Ptr p, Deleter& d, uint32_t id) {
   auto& set = meta->allId2ThreadEntrySets_[id];
   auto rlock = set.rlock();
   if (p != nullptr && !removed_ && !rlock->contains(this)) {
-    meta->ensureThreadEntryIsInSet(this, set, rlock);
+    meta->ensureThreadEntryIsInSet(this, id, set, rlock);
   }
   cleanupElement(id);
   elements[id].set(p, d);
@@ -14,27 +14,86 @@
  * limitations under the License.
  */
 
-#include <folly/CpuId.h>
 #include <folly/Portability.h>
 #include <folly/detail/base64_detail/Base64Api.h>
 #include <folly/detail/base64_detail/Base64SWAR.h>
+#include <folly/detail/base64_detail/Base64_AVX2.h>
 #include <folly/detail/base64_detail/Base64_SSE4_2.h>
+#include <folly/system/CpuDispatch.h>
 
 namespace folly::detail::base64_detail {
-Base64RuntimeImpl base64EncodeSelectImplementation() {
+
+namespace {
+
+decltype(&base64EncodeRuntime) selectBase64Encode(
+    [[maybe_unused]] const CpuFeatures& cpu) {
+#if FOLLY_X64
+  if (cpu.cpuId.avx2()) {
+    return base64Encode_AVX2;
+  }
+#endif
 #if FOLLY_SSE_PREREQ(4, 2)
-  if (folly::CpuId().sse42()) {
-    return {
-        base64Encode_SSE4_2,
-        base64URLEncode_SSE4_2,
-        base64Decode_SSE4_2,
-        base64URLDecodeSWAR};
+  if (cpu.cpuId.sse42()) {
+    return base64Encode_SSE4_2;
   }
 #endif
-  return {
-      base64EncodeScalar,
-      base64URLEncodeScalar,
-      base64DecodeSWAR,
-      base64URLDecodeSWAR};
+  return base64EncodeScalar;
 }
+
+decltype(&base64URLEncodeRuntime) selectBase64URLEncode(
+    [[maybe_unused]] const CpuFeatures& cpu) {
+#if FOLLY_X64
+  if (cpu.cpuId.avx2()) {
+    return base64URLEncode_AVX2;
+  }
+#endif
+#if FOLLY_SSE_PREREQ(4, 2)
+  if (cpu.cpuId.sse42()) {
+    return base64URLEncode_SSE4_2;
+  }
+#endif
+  return base64URLEncodeScalar;
+}
+
+decltype(&base64DecodeRuntime) selectBase64Decode(
+    [[maybe_unused]] const CpuFeatures& cpu) {
+#if FOLLY_X64
+  if (cpu.cpuId.avx2()) {
+    return base64Decode_AVX2;
+  }
+#endif
+#if FOLLY_SSE_PREREQ(4, 2)
+  if (cpu.cpuId.sse42()) {
+    return base64Decode_SSE4_2;
+  }
+#endif
+  return base64DecodeSWAR;
+}
+
+} // namespace
+
+FOLLY_CPU_DISPATCH(
+    base64EncodeRuntime,
+    selectBase64Encode,
+    (const char* f, const char* l, char* o),
+    (f, l, o));
+
+FOLLY_CPU_DISPATCH(
+    base64URLEncodeRuntime,
+    selectBase64URLEncode,
+    (const char* f, const char* l, char* o),
+    (f, l, o));
+
+FOLLY_CPU_DISPATCH(
+    base64DecodeRuntime,
+    selectBase64Decode,
+    (const char* f, const char* l, char* o),
+    (f, l, o));
+
+// There is no SIMD implementation of the URL decoding.
+Base64DecodeResult base64URLDecodeRuntime(
+    const char* f, const char* l, char* o) noexcept {
+  return base64URLDecodeSWAR(f, l, o);
+}
+
 } // namespace folly::detail::base64_detail
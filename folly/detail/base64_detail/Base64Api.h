@@ -24,28 +24,10 @@
 
 namespace folly::detail::base64_detail {
 
-struct Base64RuntimeImpl {
-  using Encode = char* (*)(const char*, const char*, char*) noexcept;
-  using Decode =
-      Base64DecodeResult (*)(const char*, const char*, char*) noexcept;
+// The *Runtime functions call the fastest implementation which the CPU
+// supports.
 
-  Encode encode;
-  Encode encodeURL;
-  Decode decode;
-  Decode decodeURL;
-};
-
-Base64RuntimeImpl base64EncodeSelectImplementation();
-
-inline const auto& base64RuntimeImpl() {
-  static const auto r = base64EncodeSelectImplementation();
-  return r;
-}
-
-inline char* base64EncodeRuntime(
-    const char* f, const char* l, char* o) noexcept {
-  return base64RuntimeImpl().encode(f, l, o);
-}
+char* base64EncodeRuntime(const char* f, const char* l, char* o) noexcept;
 
 inline constexpr char* base64Encode(
     const char* f, const char* l, char* o) noexcept {
@@ -56,10 +38,7 @@ inline constexpr char* base64Encode(
   }
 }
 
-inline char* base64URLEncodeRuntime(
-    const char* f, const char* l, char* o) noexcept {
-  return base64RuntimeImpl().encodeURL(f, l, o);
-}
+char* base64URLEncodeRuntime(const char* f, const char* l, char* o) noexcept;
 
 inline constexpr char* base64URLEncode(
     const char* f, const char* l, char* o) noexcept {
@@ -70,10 +49,8 @@ inline constexpr char* base64URLEncode(
   }
 }
 
-inline Base64DecodeResult base64DecodeRuntime(
-    const char* f, const char* l, char* o) noexcept {
-  return base64RuntimeImpl().decode(f, l, o);
-}
+Base64DecodeResult base64DecodeRuntime(
+    const char* f, const char* l, char* o) noexcept;
 
 inline constexpr Base64DecodeResult base64Decode(
     const char* f, const char* l, char* o) noexcept {
@@ -84,10 +61,8 @@ inline constexpr Base64DecodeResult base64Decode(
   }
 }
 
-inline Base64DecodeResult base64URLDecodeRuntime(
-    const char* f, const char* l, char* o) noexcept {
-  return base64RuntimeImpl().decodeURL(f, l, o);
-}
+Base64DecodeResult base64URLDecodeRuntime(
+    const char* f, const char* l, char* o) noexcept;
 
 inline constexpr Base64DecodeResult base64URLDecode(
     const char* f, const char* l, char* o) noexcept {
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <folly/Portability.h>
+#include <folly/detail/base64_detail/Base64HiddenConstants.h>
+
+#if FOLLY_X64
+#include <immintrin.h>
+
+namespace folly::detail::base64_detail {
+
+/*
+ *  The same algorithms as Base64_SSE4_2_Platform, on two 16 byte lanes.
+ *
+ *  The byte shuffles don't cross lanes, so the 24 input bytes of an encode
+ *  are first spread to 12 bytes per lane, and the 12 output bytes of each
+ *  lane of a decode are gathered at the end.
+ *
+ *  Only include this header in files compiled with -mavx2.
+ */
+
+struct Base64_AVX2_Platform {
+  using reg_t = __m256i;
+  static constexpr std::size_t kRegisterSize = 32;
+
+  static reg_t broadcast(const void* table) {
+    return _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+  }
+
+  // Encode ------------------------------
+
+  static reg_t encodeToIndexes(reg_t in) {
+    // 12 bytes per lane: ____,LKJI,HGFE,DCBA
+    in = _mm256_permutevar8x32_epi32(
+        in, _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0));
+
+    // LKJI,HGFE,DCBA => KLJK,GIGH,EFDE,BCAB
+    // clang-format off
+    in = _mm256_shuffle_epi8(in, _mm256_set_epi8(
+      10, 11, 9,  10,
+      7,   8,  6,  7,
+      4,   5,  3,  4,
+      1,   2,  0,  1,
+      10, 11, 9,  10,
+      7,   8,  6,  7,
+      4,   5,  3,  4,
+      1,   2,  0,  1
+    ));
+    // clang-format on
+
+    const reg_t t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const reg_t t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const reg_t t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const reg_t t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+
+    return _mm256_or_si256(t1, t3);
+  }
+
+  static reg_t lookupByIndex(reg_t in, std::int8_t const* offsetTablePtr) {
+    const reg_t offsetTable = broadcast(offsetTablePtr);
+
+    // 0-51 become 0, 52 and bigger map to 1 and bigger
+    const reg_t reduceTooMuch = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+
+    // 0 when should map to A-Z, otherwise -1.
+    const reg_t biggerThan25 = _mm256_cmpgt_epi8(in, _mm256_set1_epi8(25));
+
+    const reg_t offsetLookup = _mm256_sub_epi8(reduceTooMuch, biggerThan25);
+
+    return _mm256_add_epi8(in, _mm256_shuffle_epi8(offsetTable, offsetLookup));
+  }
+
+  // Decode ------------------------------------------------------------
+
+  static reg_t separatePlusAndSlash(reg_t reg) {
+    const reg_t leThanPlus = _mm256_cmpgt_epi8(_mm256_set1_epi8('+' + 1), reg);
+    const reg_t plusAndBelowOffset =
+        _mm256_and_si256(leThanPlus, _mm256_set1_epi8(0x0f));
+    return _mm256_subs_epi8(reg, plusAndBelowOffset);
+  }
+
+  static reg_t initError() { return _mm256_set1_epi8(char(0xff)); }
+
+  static bool hasErrors(reg_t errorAccumulator) {
+    return _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(errorAccumulator, _mm256_setzero_si256()));
+  }
+
+  static reg_t decodeErrorDetection(reg_t reg, reg_t higherNibbles) {
+    // clang-format off
+    const std::int8_t s1_7 = static_cast<std::int8_t>(1 << 7);
+    const reg_t pows2 = _mm256_set_epi8(
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        s1_7,   1 << 6, 1 << 5, 1 << 4,
+        1 << 3, 1 << 2, 1 << 1, 1 << 0,
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        s1_7,   1 << 6, 1 << 5, 1 << 4,
+        1 << 3, 1 << 2, 1 << 1, 1 << 0);
+    // clang-format on
+
+    reg_t higherNibbleBit = _mm256_shuffle_epi8(pows2, higherNibbles);
+    reg_t legalHigherNibblesBits = _mm256_shuffle_epi8(
+        broadcast(constants::kValidHighByLowNibble.data()), reg);
+
+    return _mm256_and_si256(higherNibbleBit, legalHigherNibblesBits);
+  }
+
+  static reg_t decodeComputeIndexes(reg_t reg, reg_t higherNibbles) {
+    reg_t offset = _mm256_shuffle_epi8(
+        broadcast(constants::kOffsetByHighNibbleDecodeTable.data()),
+        higherNibbles);
+    return _mm256_add_epi8(offset, reg);
+  }
+
+  static reg_t decodeToIndex(reg_t reg, reg_t& errorAccumulator) {
+    reg = separatePlusAndSlash(reg);
+
+    reg_t higherNibbles =
+        _mm256_and_si256(_mm256_srli_epi32(reg, 4), _mm256_set1_epi8(0x0f));
+
+    errorAccumulator = _mm256_min_epu8(
+        decodeErrorDetection(reg, higherNibbles), errorAccumulator);
+
+    return decodeComputeIndexes(reg, higherNibbles);
+  }
+
+  static reg_t packIndexesToBytes(reg_t reg) {
+    reg_t cccddd_aaabbb =
+        _mm256_maddubs_epi16(reg, _mm256_set1_epi16(0x01'40));
+    reg_t aaabbbcccddd =
+        _mm256_madd_epi16(cccddd_aaabbb, _mm256_set1_epi32(0x1'1000));
+
+    // clang-format off
+    reg_t packed = _mm256_shuffle_epi8(aaabbbcccddd, _mm256_set_epi8(
+      -1, -1, -1, -1,
+      12, 13, 14,
+      8,  9,  10,
+      4,   5,  6,
+      0,   1,  2,
+      -1, -1, -1, -1,
+      12, 13, 14,
+      8,  9,  10,
+      4,   5,  6,
+      0,   1,  2
+    ));
+    // clang-format on
+
+    // 12 bytes per lane => 24 bytes, the last 8 are zeros.
+    return _mm256_permutevar8x32_epi32(
+        packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+  }
+
+  static reg_t loadu(const void* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const reg_t*>(ptr));
+  }
+
+  static void storeu(void* ptr, reg_t reg) {
+    _mm256_storeu_si256(reinterpret_cast<reg_t*>(ptr), reg);
+  }
+};
+
+} // namespace folly::detail::base64_detail
+
+#endif // FOLLY_X64
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/BenchmarkStats.h>
+
+#include <cmath>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly::detail;
+
+TEST(BenchmarkStats, StudentT) {
+  EXPECT_DOUBLE_EQ(0.5, studentTCdf(0, 5));
+  // The values of the tables.
+  EXPECT_NEAR(12.706, studentTQuantile(0.975, 1), 1e-3);
+  EXPECT_NEAR(2.571, studentTQuantile(0.975, 5), 1e-3);
+  EXPECT_NEAR(2.228, studentTQuantile(0.975, 10), 1e-3);
+  EXPECT_NEAR(1.984, studentTQuantile(0.975, 100), 1e-3);
+  EXPECT_NEAR(-2.228, studentTQuantile(0.025, 10), 1e-3);
+  EXPECT_NEAR(0.975, studentTCdf(2.228139, 10), 1e-6);
+  EXPECT_NEAR(0.025, studentTCdf(-2.228139, 10), 1e-6);
+}
+
+TEST(BenchmarkStats, RejectOutliers) {
+  EXPECT_EQ(
+      std::vector<double>({10, 10, 11, 11, 12}),
+      rejectOutliers({11, 10, 100, 12, 11, 10}));
+  EXPECT_EQ(
+      std::vector<double>({10, 11, 12, 13}), rejectOutliers({13, 12, 11, 10}));
+  // Too few to tell.
+  EXPECT_EQ(
+      std::vector<double>({1, 100, 1000}), rejectOutliers({1000, 1, 100}));
+  EXPECT_TRUE(rejectOutliers({}).empty());
+}
+
+TEST(BenchmarkStats, SampleStats) {
+  auto stats = sampleStats({4, 5, 6, 5, 4, 6, 5, 5});
+  EXPECT_EQ(8, stats.count);
+  EXPECT_EQ(0, stats.outliers);
+  EXPECT_DOUBLE_EQ(5, stats.mean);
+  EXPECT_DOUBLE_EQ(std::sqrt(4. / 7), stats.stddev);
+  EXPECT_NEAR(2.3646 * std::sqrt(4. / 7) / std::sqrt(8.), stats.ci95, 1e-4);
+
+  stats = sampleStats({10, 10, 11, 11, 12, 100});
+  EXPECT_EQ(5, stats.count);
+  EXPECT_EQ(1, stats.outliers);
+  EXPECT_DOUBLE_EQ(10.8, stats.mean);
+
+  stats = sampleStats({3});
+  EXPECT_EQ(1, stats.count);
+  EXPECT_DOUBLE_EQ(3, stats.mean);
+  EXPECT_TRUE(std::isnan(stats.ci95));
+
+  EXPECT_EQ(0, sampleStats({}).count);
+}
+
+TEST(BenchmarkStats, WelchTTest) {
+  auto a = sampleStats({10.0, 10.2, 9.9, 10.1, 10.0, 9.8, 10.1});
+  auto b = sampleStats({11.0, 11.2, 10.9, 11.1, 11.0, 10.8, 11.1});
+  EXPECT_LT(welchTTest(a, b), 1e-6);
+  EXPECT_DOUBLE_EQ(welchTTest(a, b), welchTTest(b, a));
+  EXPECT_DOUBLE_EQ(1, welchTTest(a, a));
+
+  // The noise hides the difference.
+  auto c = sampleStats({8.0, 12.0, 9.0, 11.5, 10.5, 9.5, 10.8});
+  EXPECT_GT(welchTTest(a, c), 0.1);
+
+  // A reference value: t = -2.0, df = 18.
+  SampleStats x{10, 0, 1.0, 1.0, 0};
+  SampleStats y{10, 0, 1.894427, 1.0, 0};
+  EXPECT_NEAR(0.0608, welchTTest(x, y), 1e-3);
+
+  EXPECT_TRUE(std::isnan(welchTTest(sampleStats({1}), a)));
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/PerfCounters.h>
+
+#include <cmath>
+
+#include <folly/BenchmarkUtil.h>
+#include <folly/portability/GTest.h>
+
+namespace folly {
+namespace detail {
+
+namespace {
+
+void spin(int n) {
+  for (int i = 0; i < n; ++i) {
+    doNotOptimizeAway(i);
+  }
+}
+
+} // namespace
+
+TEST(PerfCountersTest, Count) {
+  PerfCounters counters;
+  if (!counters.supported()) {
+    GTEST_SKIP() << "perf_event_open doesn't count hardware events here";
+  }
+  counters.start();
+  spin(1000000);
+  auto values = counters.stop();
+  // The events which can't be counted are NaN, and fail the comparisons.
+  EXPECT_TRUE(std::isnan(values.instructions) || values.instructions > 1e6);
+  EXPECT_TRUE(std::isnan(values.cycles) || values.cycles > 0);
+}
+
+TEST(PerfCountersTest, Pause) {
+  PerfCounters counters;
+  if (!counters.supported()) {
+    GTEST_SKIP() << "perf_event_open doesn't count hardware events here";
+  }
+  counters.start();
+  spin(1000);
+  counters.pause();
+  spin(10000000);
+  counters.resume();
+  spin(1000);
+  auto values = counters.stop();
+  EXPECT_TRUE(std::isnan(values.instructions) || values.instructions < 1e7);
+
+  // start() resets the counts.
+  counters.start();
+  auto restarted = counters.stop();
+  EXPECT_TRUE(
+      std::isnan(restarted.instructions) || restarted.instructions < 1e6);
+}
+
+TEST(PerfCountersTest, Values) {
+  PerfCounterValues values;
+  EXPECT_TRUE(std::isnan(values.cycles));
+  EXPECT_TRUE(std::isnan(values.ipc()));
+  values.cycles = 200;
+  values.instructions = 500;
+  values /= 100;
+  EXPECT_EQ(2, values.cycles);
+  EXPECT_EQ(2.5, values.ipc());
+}
+
+} // namespace detail
+} // namespace folly
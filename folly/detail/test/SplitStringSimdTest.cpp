@@ -23,7 +23,9 @@
 #include <folly/portability/GTest.h>
 #include <folly/small_vector.h>
 
+#include <array>
 #include <random>
+#include <string>
 
 namespace folly {
 namespace detail {
@@ -238,5 +240,41 @@ TEST(SplitStringSimd, ByCharTestDifferentOffsets) {
   }
 }
 
+TEST(SplitStringSimd, FindStringDifferentOffsets) {
+  alignas(32) std::array<char, 100> buf;
+
+  // Few characters, for many partial and full matches of the delimiters.
+  std::mt19937 gen;
+  std::uniform_int_distribution<> dis(0, 2);
+  for (auto& c : buf) {
+    c = "ab:"[dis(gen)];
+  }
+
+  for (folly::StringPiece delim : {"::", ":a:", "ab:a", "a:b:a:b:a:b:a:b:a"}) {
+    for (auto f = buf.begin(); f != buf.end(); ++f) {
+      folly::StringPiece what(f, buf.end());
+      for (std::size_t pos = 0; pos <= what.size(); pos += 7) {
+        ASSERT_EQ(
+            findStringScalar(what, pos, delim),
+            simdFindString(what, pos, delim))
+            << what << " : " << pos << " : " << delim;
+      }
+    }
+  }
+}
+
+TEST(SplitStringSimd, FindFirstOf) {
+  std::string s(100, 'a');
+  s[37] = ' ';
+  s[80] = '\t';
+  EXPECT_EQ(37, simdFindFirstOf(s, 0, " \t"));
+  EXPECT_EQ(37, simdFindFirstOf(s, 37, " \t"));
+  EXPECT_EQ(80, simdFindFirstOf(s, 38, " \t"));
+  EXPECT_EQ(100, simdFindFirstOf(s, 81, " \t"));
+  EXPECT_EQ(100, simdFindFirstOf(s, 100, " \t"));
+  EXPECT_EQ(80, simdFindFirstOf(s, 0, "\t"));
+  EXPECT_EQ(100, simdFindFirstOf(s, 0, ""));
+}
+
 } // namespace detail
 } // namespace folly
@@ -21,9 +21,13 @@
 #include <folly/Memory.h>
 #include <folly/Optional.h>
 #include <folly/executors/QueueObserver.h>
+#include <folly/executors/TimeSlice.h>
+#include <folly/executors/task_queue/MultiQueueBlockingQueue.h>
+#include <folly/executors/task_queue/NumaAwareBlockingQueue.h>
 #include <folly/executors/task_queue/PriorityLifoSemMPMCQueue.h>
 #include <folly/executors/task_queue/PriorityUnboundedBlockingQueue.h>
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
+#include <folly/executors/task_queue/WorkStealingBlockingQueue.h>
 #include <folly/portability/GFlags.h>
 #include <folly/synchronization/ThrottledLifoSem.h>
 
@@ -98,6 +102,33 @@ CPUThreadPoolExecutor::CPUTask::CPUTask()
       numPriorities, opts);
 }
 
+/* static */ auto CPUThreadPoolExecutor::makeWorkStealingQueue()
+    -> std::unique_ptr<BlockingQueue<CPUTask>> {
+  if (FLAGS_folly_cputhreadpoolexecutor_use_throttled_lifo_sem) {
+    return std::make_unique<
+        WorkStealingBlockingQueue<CPUTask, ThrottledLifoSem>>();
+  }
+  return std::make_unique<WorkStealingBlockingQueue<CPUTask, LifoSem>>();
+}
+
+/* static */ auto CPUThreadPoolExecutor::makeNumaAwareQueue()
+    -> std::unique_ptr<BlockingQueue<CPUTask>> {
+  if (FLAGS_folly_cputhreadpoolexecutor_use_throttled_lifo_sem) {
+    return std::make_unique<
+        NumaAwareBlockingQueue<CPUTask, ThrottledLifoSem>>();
+  }
+  return std::make_unique<NumaAwareBlockingQueue<CPUTask, LifoSem>>();
+}
+
+/* static */ auto CPUThreadPoolExecutor::makeMultiQueuePriorityQueue()
+    -> std::unique_ptr<BlockingQueue<CPUTask>> {
+  if (FLAGS_folly_cputhreadpoolexecutor_use_throttled_lifo_sem) {
+    return std::make_unique<
+        MultiQueueBlockingQueue<CPUTask, ThrottledLifoSem>>();
+  }
+  return std::make_unique<MultiQueueBlockingQueue<CPUTask, LifoSem>>();
+}
+
 CPUThreadPoolExecutor::CPUThreadPoolExecutor(
     size_t numThreads,
     std::unique_ptr<BlockingQueue<CPUTask>> taskQueue,
@@ -118,7 +149,8 @@ CPUThreadPoolExecutor::CPUThreadPoolExecutor(
     : ThreadPoolExecutor(
           numThreads.first, numThreads.second, std::move(threadFactory)),
       taskQueue_(std::move(taskQueue)),
-      prohibitBlockingOnThreadPools_{opt.blocking} {
+      prohibitBlockingOnThreadPools_{opt.blocking},
+      timeSlice_{opt.timeSlice} {
   setNumThreads(numThreads.first);
   if (numThreads.second == 0) {
     minThreads_.store(1, std::memory_order_relaxed);
@@ -281,6 +313,51 @@ void CPUThreadPoolExecutor::addImpl(
   }
 }
 
+void CPUThreadPoolExecutor::addBatch(span<Func> funcs) {
+  std::vector<CPUTask> tasks;
+  tasks.reserve(funcs.size());
+  auto queueObserver = getQueueObserver(0);
+  for (auto& func : funcs) {
+    if (!func) {
+      // Reserve empty funcs as poison by logging the error inline.
+      invokeCatchingExns("ThreadPoolExecutor: func", std::move(func));
+      continue;
+    }
+    tasks.emplace_back(
+        std::move(func), std::chrono::milliseconds(0), nullptr, int8_t(0));
+    auto& task = tasks.back();
+    if (queueObserver) {
+      task.queueObserverPayload_ =
+          queueObserver->onEnqueued(task.context_.get());
+    }
+    registerTaskEnqueue(task);
+  }
+  if (tasks.empty()) {
+    return;
+  }
+
+  // See addImpl() for why a KeepAlive is needed.
+  bool mayNeedToAddThreads = minThreads_.load(std::memory_order_relaxed) == 0 ||
+      activeThreads_.load(std::memory_order_relaxed) <
+          maxThreads_.load(std::memory_order_relaxed);
+  folly::Executor::KeepAlive<> ka = mayNeedToAddThreads
+      ? getKeepAliveToken(this)
+      : folly::Executor::KeepAlive<>{};
+
+  auto result = taskQueue_->addBatch(span<CPUTask>(tasks));
+
+  if (mayNeedToAddThreads && !result.reusedThread) {
+    // Start up to one thread per task, stopping as soon as the pool is full.
+    ensureActiveThreads();
+    for (size_t i = 1; i < tasks.size() &&
+         activeThreads_.load(std::memory_order_relaxed) <
+             maxThreads_.load(std::memory_order_relaxed);
+         ++i) {
+      ensureActiveThreads();
+    }
+  }
+}
+
 uint8_t CPUThreadPoolExecutor::getNumPriorities() const {
   return taskQueue_->getNumPriorities();
 }
@@ -361,7 +438,10 @@ void CPUThreadPoolExecutor::threadRun(ThreadPtr thread) {
     if (auto queueObserver = getQueueObserver(task->priority())) {
       queueObserver->onDequeued(task->queueObserverPayload_);
     }
-    runTask(thread, std::move(task.value()));
+    {
+      TimeSliceGuard timeSliceGuard{timeSlice_};
+      runTask(thread, std::move(task.value()));
+    }
 
     if (FOLLY_UNLIKELY(threadsToStop_ > 0 && !isJoin_)) {
       std::unique_lock w{threadListLock_};
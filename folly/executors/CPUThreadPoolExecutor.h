@@ -83,7 +83,16 @@ class CPUThreadPoolExecutor
       return *this;
     }
 
+    // Runs each task under a TimeSliceGuard, so that long running tasks which
+    // poll folly::shouldYield() give up the thread after timeSlice. Zero, the
+    // default, disables time slicing.
+    Options& setTimeSlice(std::chrono::nanoseconds t) {
+      timeSlice = t;
+      return *this;
+    }
+
     Blocking blocking;
+    std::chrono::nanoseconds timeSlice{0};
   };
 
   // These function return unbounded blocking queues with the default semaphore.
@@ -103,6 +112,28 @@ class CPUThreadPoolExecutor
   makeThrottledLifoSemPriorityQueue(
       int8_t numPriorities, std::chrono::nanoseconds wakeUpInterval = {});
 
+  // Returns an unbounded work-stealing queue with the default semaphore.
+  // Tasks added from a worker thread are pushed onto that worker's local
+  // deque, other tasks go to a shared queue, and idle workers steal from each
+  // other. This avoids contention on a single queue when tasks spawn
+  // subtasks. Priorities are not supported.
+  static std::unique_ptr<BlockingQueue<CPUTask>> makeWorkStealingQueue();
+
+  // Returns an unbounded queue with one shard per NUMA node and the default
+  // semaphore. Tasks are queued on the node of the caller and workers prefer
+  // tasks from their own node, only taking remote tasks when the local shard
+  // is empty. Use together with a NumaThreadFactory so workers are pinned to
+  // their node. Priorities are not supported.
+  static std::unique_ptr<BlockingQueue<CPUTask>> makeNumaAwareQueue();
+
+  // Returns an unbounded priority queue with the default semaphore, where
+  // each of the 255 priorities is a level of its own. Tasks are spread over
+  // a MultiQueue of per-thread heaps, so the order in which they are taken
+  // is only approximately by priority, but adding and taking tasks scales
+  // with the number of threads and does not depend on the number of levels.
+  // LO_PRI tasks alone are kept in FIFO order, after all others.
+  static std::unique_ptr<BlockingQueue<CPUTask>> makeMultiQueuePriorityQueue();
+
   CPUThreadPoolExecutor(
       size_t numThreads,
       std::unique_ptr<BlockingQueue<CPUTask>> taskQueue,
@@ -160,6 +191,11 @@ class CPUThreadPoolExecutor
       std::chrono::milliseconds expiration,
       Func expireCallback = nullptr);
 
+  /// Enqueues all functions at the default priority with a single call into
+  /// the task queue, so that queues which support it can wake up as many
+  /// workers as needed at once instead of once per task.
+  void addBatch(span<Func> funcs) override;
+
   size_t getTaskQueueSize() const;
 
   uint8_t getNumPriorities() const override;
@@ -213,6 +249,7 @@ class CPUThreadPoolExecutor
       createQueueObserverFactory()};
   std::atomic<ssize_t> threadsToStop_{0};
   Options::Blocking prohibitBlockingOnThreadPools_ = Options::Blocking::allow;
+  std::chrono::nanoseconds timeSlice_{0};
 };
 
 } // namespace folly
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/CodelExecutor.h>
+
+#include <mutex>
+#include <shared_mutex>
+
+using namespace std::chrono;
+
+namespace folly {
+
+namespace {
+
+Codel makeCodel(const std::optional<Codel::Options>& options) {
+  return options ? Codel(*options) : Codel();
+}
+
+} // namespace
+
+CodelExecutor::CodelExecutor(Executor::KeepAlive<> executor, Options options)
+    : options_(std::move(options)),
+      executor_(std::move(executor)),
+      codel_(makeCodel(options_.codelOptions)) {
+  if (options_.policy == Policy::Deprioritize) {
+    lowPriorityExecutor_ = std::make_unique<MeteredExecutor>(executor_);
+  }
+}
+
+CodelExecutor::~CodelExecutor() {
+  joinKeepAlive();
+}
+
+void CodelExecutor::add(Func func) {
+  auto now = steady_clock::now();
+  bool shedNow = overloaded(now);
+  if (shedNow && options_.policy == Policy::Reject) {
+    shed(func);
+    return;
+  }
+
+  auto task = [this,
+               ka = getKeepAliveToken(this),
+               func = std::move(func),
+               enqueued = now]() mutable {
+    auto delay = steady_clock::now() - enqueued;
+    if (codel_.overloaded(delay) && options_.policy == Policy::Reject) {
+      shed(func);
+      return;
+    }
+    func();
+  };
+  if (shedNow) {
+    shed(func);
+    lowPriorityExecutor_->add(std::move(task));
+  } else {
+    executor_->add(std::move(task));
+  }
+}
+
+bool CodelExecutor::overloaded(steady_clock::time_point now) {
+  // The minimum delay is of the tasks dequeued since the start of the interval
+  // ending at getIntervalTime(), or since the previous one if there is no task
+  // dequeued in between to reset it. After that it is stale.
+  auto options = codel_.getOptions();
+  return codel_.getMinDelay() > options.targetDelay() &&
+      now <= codel_.getIntervalTime() + options.interval();
+}
+
+void CodelExecutor::shed(Func& func) {
+  numShed_.fetch_add(1, std::memory_order_relaxed);
+  if (!hasObservers_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto id = reinterpret_cast<uintptr_t>(&func);
+  std::shared_lock<SharedMutex> g(observersMutex_);
+  for (auto& observer : observers_) {
+    observer.shed(id, ExecutionObserver::CallbackType::Codel);
+  }
+}
+
+void CodelExecutor::addExecutionObserver(ExecutionObserver* observer) {
+  std::unique_lock<SharedMutex> g(observersMutex_);
+  observers_.push_back(*observer);
+  hasObservers_.store(true, std::memory_order_relaxed);
+}
+
+void CodelExecutor::removeExecutionObserver(ExecutionObserver* observer) {
+  std::unique_lock<SharedMutex> g(observersMutex_);
+  observers_.erase(observers_.iterator_to(*observer));
+  hasObservers_.store(!observers_.empty(), std::memory_order_relaxed);
+}
+
+} // namespace folly
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include <folly/DefaultKeepAliveExecutor.h>
+#include <folly/SharedMutex.h>
+#include <folly/executors/Codel.h>
+#include <folly/executors/ExecutionObserver.h>
+#include <folly/executors/MeteredExecutor.h>
+
+namespace folly {
+
+/**
+ * Adds load shedding to an existing executor, based on the queueing delay of
+ * its tasks: the time from add() to the start of their execution.
+ *
+ * The delays are fed to a Codel. While the minimum delay of the current codel
+ * interval exceeds the target delay, the executor is overloaded, and the tasks
+ * added are shed according to the policy:
+ *  - Reject drops them. Additionally, as Codel suggests, the queued tasks which
+ *    codel finds overloaded when they are dequeued are dropped.
+ *  - Deprioritize adds them to a MeteredExecutor on top of the wrapped
+ *    executor, so that they yield to the tasks added when not overloaded. This
+ *    works for any executor, including the ones without priorities such as
+ *    IOThreadPoolExecutor.
+ *
+ * Dropping a task destroys its function without calling it, so for example a
+ * continuation of a Future then completes with a BrokenPromise.
+ *
+ * Once the queue is drained no more delays are observed, so the overloaded
+ * state ends at most two codel intervals after the last task dequeued.
+ *
+ * The number of tasks shed is available from getNumShed(), and each one is
+ * reported to the execution observers added with addExecutionObserver().
+ *
+ * auto pool = std::make_unique<IOThreadPoolExecutor>(numThreads);
+ * CodelExecutor executor(getKeepAliveToken(pool.get()));
+ * executor.add([] { handleRequest(); });
+ */
+class CodelExecutor : public DefaultKeepAliveExecutor {
+ public:
+  enum class Policy {
+    Reject,
+    Deprioritize,
+  };
+
+  struct Options {
+    Options() {}
+    // The interval and target delay of the codel, by default from the
+    // codel_interval and codel_target_delay flags.
+    std::optional<Codel::Options> codelOptions;
+    Policy policy{Policy::Reject};
+  };
+
+  explicit CodelExecutor(
+      Executor::KeepAlive<> executor, Options options = Options());
+  ~CodelExecutor() override;
+
+  void add(Func func) override;
+
+  /**
+   * Whether the tasks added now are shed.
+   */
+  bool overloaded() { return overloaded(std::chrono::steady_clock::now()); }
+
+  uint64_t getNumShed() const {
+    return numShed_.load(std::memory_order_relaxed);
+  }
+
+  Codel& getCodel() { return codel_; }
+
+  /**
+   * The shed() callback of the observers is called for every task shed, with
+   * the CallbackType Codel, from the thread which added the task or the thread
+   * of the wrapped executor which dequeued it. Observers must be removed
+   * before they are destroyed.
+   */
+  void addExecutionObserver(ExecutionObserver* observer);
+  void removeExecutionObserver(ExecutionObserver* observer);
+
+ private:
+  bool overloaded(std::chrono::steady_clock::time_point now);
+  void shed(Func& func);
+
+  const Options options_;
+  const Executor::KeepAlive<> executor_;
+  Codel codel_;
+  // Only with Policy::Deprioritize.
+  std::unique_ptr<MeteredExecutor> lowPriorityExecutor_;
+
+  std::atomic<uint64_t> numShed_{0};
+  std::atomic<bool> hasObservers_{false};
+  SharedMutex observersMutex_;
+  ExecutionObserver::List observers_;
+};
+
+} // namespace folly
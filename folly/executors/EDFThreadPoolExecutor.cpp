@@ -22,9 +22,9 @@
 #include <chrono>
 #include <cstddef>
 #include <exception>
+#include <iterator>
 #include <limits>
 #include <memory>
-#include <queue>
 #include <utility>
 #include <vector>
 
@@ -61,13 +61,20 @@ class EDFThreadPoolExecutor::Task {
   // Cannot be set in the ctor because known only after acquiring the lock.
   void setEnqueueOrder(uint64_t enqueueOrder) { enqueueOrder_ = enqueueOrder; }
 
-  int next() {
-    if (isDone()) {
-      return -1;
+  // Requires the exclusive lock of the bucket, and that the task is not done.
+  int next() { return iter_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Claims an iteration if it is not the last one, with the shared lock of the
+  // bucket at least.
+  bool tryNextNotLast(int& iter) {
+    iter = iter_.load(std::memory_order_relaxed);
+    while (iter < total_ - 1) {
+      if (iter_.compare_exchange_weak(
+              iter, iter + 1, std::memory_order_relaxed)) {
+        return true;
+      }
     }
-
-    int result = iter_.fetch_add(1, std::memory_order_relaxed);
-    return result < total_ ? result : -1;
+    return false;
   }
 
   void run(int i) {
@@ -113,7 +120,8 @@ class EDFThreadPoolExecutor::TaskQueue {
       }
     };
 
-    std::priority_queue<TaskPtr, std::vector<TaskPtr>, Compare> tasks;
+    // A heap, to move the tasks out of it.
+    std::vector<TaskPtr> tasks;
     std::atomic<bool> empty{true};
     uint64_t enqueued = 0;
   };
@@ -129,7 +137,9 @@ class EDFThreadPoolExecutor::TaskQueue {
     {
       std::unique_lock guard(bucket.mutex);
       task->setEnqueueOrder(bucket.enqueued++);
-      bucket.tasks.push(std::move(task));
+      bucket.tasks.push_back(std::move(task));
+      std::push_heap(
+          bucket.tasks.begin(), bucket.tasks.end(), Bucket::Compare());
       bucket.empty.store(bucket.tasks.empty(), std::memory_order_relaxed);
     }
 
@@ -145,7 +155,9 @@ class EDFThreadPoolExecutor::TaskQueue {
         curDeadline, deadline, std::memory_order_relaxed));
   }
 
-  TaskPtr pop() {
+  // Claims an iteration of the task with the earliest deadline, and removes
+  // the task from the queue with its last iteration.
+  TaskPtr pop(int& iter) {
     bool needDeadlineUpdate = false;
     for (;;) {
       if (numItems_.load(std::memory_order_seq_cst) == 0) {
@@ -168,36 +180,45 @@ class EDFThreadPoolExecutor::TaskQueue {
       }
 
       {
-        // Fast path. Take bucket reader lock.
+        // Fast path for the tasks with several iterations left, which workers
+        // can claim concurrently. Take bucket reader lock.
         std::shared_lock guard(bucket.mutex);
         if (bucket.tasks.empty()) {
           continue;
         }
-        const auto& task = bucket.tasks.top();
-        if (!task->isDone() && task->getDeadline() == curDeadline) {
-          return task;
-        }
-        // If the task is finished already, fall through to remove it.
-      }
-
-      {
-        // Take the writer lock to clean up the finished task.
-        std::unique_lock guard(bucket.mutex);
-        if (bucket.tasks.empty()) {
+        const auto& task = bucket.tasks.front();
+        if (task->getDeadline() != curDeadline) {
+          // The earliest deadline is in another bucket.
+          needDeadlineUpdate = true;
           continue;
         }
-        const auto& task = bucket.tasks.top();
-        if (task->isDone()) {
-          // Current task finished. Remove from the queue.
-          bucket.tasks.pop();
-          bucket.empty.store(bucket.tasks.empty(), std::memory_order_relaxed);
-          numItems_.fetch_sub(1, std::memory_order_seq_cst);
+        if (task->tryNextNotLast(iter)) {
+          return task;
         }
       }
 
-      // We may have finished processing the current task / bucket. Going back
-      // to the beginning of the loop to find the next bucket.
-      needDeadlineUpdate = true;
+      // Take the writer lock to claim the last iteration and remove the task
+      // at once, so that the next pop does not need to clean up.
+      std::unique_lock guard(bucket.mutex);
+      if (bucket.tasks.empty()) {
+        continue;
+      }
+      auto& task = bucket.tasks.front();
+      if (task->getDeadline() != curDeadline) {
+        needDeadlineUpdate = true;
+        continue;
+      }
+      iter = task->next();
+      if (!task->isDone()) {
+        return task;
+      }
+      std::pop_heap(
+          bucket.tasks.begin(), bucket.tasks.end(), Bucket::Compare());
+      auto result = std::move(bucket.tasks.back());
+      bucket.tasks.pop_back();
+      bucket.empty.store(bucket.tasks.empty(), std::memory_order_relaxed);
+      numItems_.fetch_sub(1, std::memory_order_seq_cst);
+      return result;
     }
   }
 
@@ -232,7 +253,7 @@ class EDFThreadPoolExecutor::TaskQueue {
         continue;
       }
 
-      const auto& task = bucket.tasks.top();
+      const auto& task = bucket.tasks.front();
       auto deadline = task->getDeadline();
 
       if (deadline < earliestDeadline) {
@@ -335,6 +356,12 @@ void EDFThreadPoolExecutor::add(std::vector<Func> fs, uint64_t deadline) {
   }
 }
 
+void EDFThreadPoolExecutor::addBatch(span<Func> fs) {
+  std::vector<Func> funcs(
+      std::make_move_iterator(fs.begin()), std::make_move_iterator(fs.end()));
+  add(std::move(funcs), kLatestDeadline);
+}
+
 size_t EDFThreadPoolExecutor::getTaskQueueSize() const {
   return taskQueue_->size();
 }
@@ -346,7 +373,8 @@ void EDFThreadPoolExecutor::threadRun(ThreadPtr thread) {
 
   thread->startupBaton.post();
   for (;;) {
-    auto task = take();
+    int iter;
+    auto task = take(iter);
 
     // Handle thread stopping
     if (FOLLY_UNLIKELY(!task)) {
@@ -360,12 +388,6 @@ void EDFThreadPoolExecutor::threadRun(ThreadPtr thread) {
       return;
     }
 
-    int iter = task->next();
-    if (FOLLY_UNLIKELY(iter < 0)) {
-      // This task is already finished
-      continue;
-    }
-
     thread->idle.store(false, std::memory_order_relaxed);
     auto startTime = std::chrono::steady_clock::now();
     ProcessedTaskInfo taskInfo;
@@ -383,10 +405,19 @@ void EDFThreadPoolExecutor::threadRun(ThreadPtr thread) {
       observer.taskDequeued(taskInfo);
     });
 
+    const bool accountCpuTime = isTaskCpuTimeAccountingEnabled();
+    const auto cpuStartTime =
+        accountCpuTime ? threadCpuTime() : std::chrono::nanoseconds{0};
+    // Keeps the context alive to look up its task class.
+    auto context = accountCpuTime ? task->context_ : nullptr;
     invokeCatchingExns("EDFThreadPoolExecutor: func", [&] {
       std::exchange(task, {})->run(iter);
     });
     taskInfo.runTime = std::chrono::steady_clock::now() - startTime;
+    if (accountCpuTime) {
+      taskInfo.cpuTime = threadCpuTime() - cpuStartTime;
+      accountTaskCpuTime(*thread, context.get(), taskInfo.cpuTime);
+    }
 
     FOLLY_SDT(
         folly,
@@ -433,12 +464,13 @@ bool EDFThreadPoolExecutor::shouldStop() {
   }
 }
 
-std::shared_ptr<EDFThreadPoolExecutor::Task> EDFThreadPoolExecutor::take() {
+std::shared_ptr<EDFThreadPoolExecutor::Task> EDFThreadPoolExecutor::take(
+    int& iter) {
   if (FOLLY_UNLIKELY(shouldStop())) {
     return nullptr;
   }
 
-  if (auto task = taskQueue_->pop()) {
+  if (auto task = taskQueue_->pop(iter)) {
     return task;
   }
 
@@ -458,9 +490,7 @@ std::shared_ptr<EDFThreadPoolExecutor::Task> EDFThreadPoolExecutor::take() {
       return nullptr;
     }
 
-    if (auto task = taskQueue_->pop()) {
-      // It's possible to return a finished task here, in which case
-      // the worker will call this function again.
+    if (auto task = taskQueue_->pop(iter)) {
       return task;
     }
 
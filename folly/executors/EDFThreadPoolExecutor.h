@@ -84,6 +84,8 @@ class EDFThreadPoolExecutor
   void add(Func f) override;
   void add(Func f, std::size_t total, uint64_t deadline) override;
   void add(std::vector<Func> fs, uint64_t deadline) override;
+  // Adds the batch as a single task with the latest deadline.
+  void addBatch(span<Func> fs) override;
 
   size_t getTaskQueueSize() const;
 
@@ -94,7 +96,8 @@ class EDFThreadPoolExecutor
 
  private:
   bool shouldStop();
-  std::shared_ptr<Task> take();
+  // Returns the task with the iteration to run, or null if the thread stops.
+  std::shared_ptr<Task> take(int& iter);
 
   void fillTaskInfo(const Task& task, TaskInfo& info);
   void registerTaskEnqueue(const Task& task);
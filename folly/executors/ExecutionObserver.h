@@ -38,6 +38,8 @@ class ExecutionObserver
     NotificationQueue,
     // Owned by FiberManager.
     Fiber,
+    // Owned by CodelExecutor.
+    Codel,
   };
   // Constant time size = false to support auto_unlink behavior, options are
   // mutually exclusive
@@ -60,6 +62,15 @@ class ExecutionObserver
    * @param id Unique id for the task which stopped.
    */
   virtual void stopped(uintptr_t id, CallbackType callbackType) noexcept = 0;
+
+  /**
+   * Called when a task is shed to reduce overload, that is dropped or delayed
+   * in favor of other tasks. A dropped task is never started.
+   *
+   * @param id Unique id for the task which was shed.
+   */
+  virtual void shed(
+      uintptr_t /* id */, CallbackType /* callbackType */) noexcept {}
 };
 
 class ExecutionObserverScopeGuard {
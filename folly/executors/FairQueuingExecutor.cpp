@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/FairQueuingExecutor.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <glog/logging.h>
+
+using namespace std::chrono;
+
+namespace folly {
+
+void FairQueuingExecutor::Tenant::add(Func func) {
+  parent_.enqueue(*this, std::move(func));
+}
+
+size_t FairQueuingExecutor::Tenant::pendingTasks() const {
+  std::lock_guard lock(parent_.mutex_);
+  return queue_.size();
+}
+
+FairQueuingExecutor::FairQueuingExecutor(
+    Executor::KeepAlive<> executor, Options options)
+    : options_(std::move(options)), executor_(std::move(executor)) {
+  CHECK_GE(options_.maxInQueue, 1);
+  CHECK_GT(options_.quantum.count(), 0);
+  tenants_.push_back(std::unique_ptr<Tenant>(new Tenant(*this, 1)));
+  defaultTenant_ = tenants_.back().get();
+}
+
+FairQueuingExecutor::FairQueuingExecutor(
+    std::unique_ptr<Executor> executor, Options options)
+    : FairQueuingExecutor(getKeepAliveToken(*executor), std::move(options)) {
+  ownedExecutor_ = std::move(executor);
+}
+
+FairQueuingExecutor::~FairQueuingExecutor() {
+  // No tenant can add tasks anymore once its tokens are released, and the
+  // workers hold tokens to this executor until the queues are drained.
+  for (auto& tenant : tenants_) {
+    tenant->join();
+  }
+  joinKeepAlive();
+}
+
+auto FairQueuingExecutor::addTenant(uint32_t weight)
+    -> Executor::KeepAlive<Tenant> {
+  CHECK_GE(weight, 1);
+  std::lock_guard lock(mutex_);
+  tenants_.push_back(std::unique_ptr<Tenant>(new Tenant(*this, weight)));
+  return getKeepAliveToken(tenants_.back().get());
+}
+
+void FairQueuingExecutor::add(Func func) {
+  enqueue(*defaultTenant_, std::move(func));
+}
+
+size_t FairQueuingExecutor::pendingTasks() const {
+  std::lock_guard lock(mutex_);
+  return pending_;
+}
+
+void FairQueuingExecutor::enqueue(Tenant& tenant, Func func) {
+  Tenant::Task task{std::move(func), RequestContext::saveContext()};
+  bool shouldScheduleWorker = false;
+  {
+    std::lock_guard lock(mutex_);
+    tenant.queue_.push_back(std::move(task));
+    if (!tenant.active_) {
+      tenant.active_ = true;
+      active_.push_back(&tenant);
+    }
+    ++pending_;
+    if (inQueue_ < options_.maxInQueue) {
+      ++inQueue_;
+      shouldScheduleWorker = true;
+    }
+  }
+  if (shouldScheduleWorker) {
+    scheduleWorker();
+  }
+}
+
+// mutex_ is locked
+FairQueuingExecutor::Tenant& FairQueuingExecutor::pick(Tenant::Task& task) {
+  while (true) {
+    DCHECK(!active_.empty());
+    auto& tenant = *active_.front();
+    tenant.deficit_ +=
+        tenant.correction_.exchange(0, std::memory_order_relaxed);
+    if (!tenant.visited_) {
+      tenant.visited_ = true;
+      tenant.deficit_ += options_.quantum.count() * tenant.weight_;
+    }
+    if (tenant.deficit_ <= 0) {
+      // Out of credit for this visit, on to the next tenant.
+      tenant.visited_ = false;
+      active_.pop_front();
+      active_.push_back(&tenant);
+      continue;
+    }
+
+    task = std::move(tenant.queue_.front());
+    tenant.queue_.pop_front();
+    tenant.deficit_ -= tenant.estimate_.load(std::memory_order_relaxed);
+    if (tenant.queue_.empty()) {
+      active_.pop_front();
+      tenant.active_ = false;
+      tenant.visited_ = false;
+      tenant.deficit_ = std::min<int64_t>(tenant.deficit_, 0);
+    }
+    return tenant;
+  }
+}
+
+void FairQueuingExecutor::worker() {
+  Tenant::Task task;
+  Tenant* tenant;
+  bool shouldRescheduleWorker;
+  {
+    std::lock_guard lock(mutex_);
+    DCHECK_GT(pending_, 0);
+    tenant = &pick(task);
+    // More work to do than workers in queue, re-schedule the worker without
+    // changing the in-queue count.
+    shouldRescheduleWorker = pending_ > inQueue_;
+    --pending_;
+    if (!shouldRescheduleWorker) {
+      --inQueue_;
+    }
+  }
+  if (shouldRescheduleWorker) {
+    scheduleWorker();
+  }
+
+  auto estimate = tenant->estimate_.load(std::memory_order_relaxed);
+  auto start = steady_clock::now();
+  {
+    RequestContextScopeGuard rctxGuard{std::move(task.rctx)};
+    invokeCatchingExns("FairQueuingExecutor", std::exchange(task.func, {}));
+  }
+  int64_t runTime =
+      duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  tenant->runTime_.fetch_add(runTime, std::memory_order_relaxed);
+  tenant->correction_.fetch_add(estimate - runTime, std::memory_order_relaxed);
+  // Tasks of the same tenant running concurrently may lose an update, which
+  // is fine for an average.
+  tenant->estimate_.store(
+      estimate + (runTime - estimate) / 8, std::memory_order_relaxed);
+}
+
+void FairQueuingExecutor::scheduleWorker() {
+  RequestContextScopeGuard rctxGuard{nullptr};
+  executor_->add([self = getKeepAliveToken(this)] { self->worker(); });
+}
+
+} // namespace folly
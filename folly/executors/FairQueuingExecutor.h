@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/DefaultKeepAliveExecutor.h>
+#include <folly/io/async/Request.h>
+
+namespace folly {
+
+/**
+ * Shares an existing executor between tenants, in proportion to their
+ * weights, with deficit round robin.
+ *
+ * Each tenant is an executor of its own, with its own queue. Like
+ * MeteredExecutor, only a limited number of tasks, maxInQueue, are in the
+ * wrapped executor at any time; each time one of them runs, it picks the
+ * next task to run:
+ *  - The tenants with queued tasks are visited in turn. Each visit credits
+ *    the tenant with quantum * weight of run time, and it may run tasks as
+ *    long as its credit is positive.
+ *  - The cost of a task is its run time. It is charged at dispatch from an
+ *    estimate, the moving average of the run times of the tenant, and
+ *    corrected once it has run, so that any overrun is paid on the next
+ *    visits.
+ *  - A tenant whose queue empties loses its remaining credit, but keeps its
+ *    debt.
+ *
+ * Under overload each tenant with a backlog thus gets a share of the run
+ * time proportional to its weight, whatever the number and cost of the
+ * tasks of the others, while idle tenants leave their share to the rest.
+ * Unlike strict priorities, e.g. ExecutorWithPriority, no tenant starves.
+ *
+ * auto pool = std::make_unique<CPUThreadPoolExecutor>(numThreads);
+ * FairQueuingExecutor::Options options;
+ * options.maxInQueue = numThreads;
+ * FairQueuingExecutor executor(getKeepAliveToken(pool.get()), options);
+ * auto batch = executor.addTenant(1);
+ * auto interactive = executor.addTenant(4);
+ * interactive->add([] { handleRequest(); });
+ *
+ * add() on the FairQueuingExecutor itself goes to a default tenant of weight
+ * 1.
+ */
+class FairQueuingExecutor : public DefaultKeepAliveExecutor {
+ public:
+  struct Options {
+    Options() {}
+    // Maximum number of tasks allowed in the wrapped executor's queue at any
+    // given time. This must be >= 1.
+    uint32_t maxInQueue = 1;
+    // Run time credited to a tenant of weight 1 on each visit. Visits are
+    // cheap, but a tenant whose tasks run much longer than its quantum needs
+    // several of them before each task.
+    std::chrono::nanoseconds quantum = std::chrono::milliseconds(1);
+  };
+
+  class Tenant : public DefaultKeepAliveExecutor {
+   public:
+    void add(Func func) override;
+
+    uint32_t weight() const { return weight_; }
+
+    size_t pendingTasks() const;
+
+    /**
+     * Total run time of the tasks of the tenant.
+     */
+    std::chrono::nanoseconds runTime() const {
+      return std::chrono::nanoseconds(
+          runTime_.load(std::memory_order_relaxed));
+    }
+
+   private:
+    friend class FairQueuingExecutor;
+
+    struct Task {
+      Func func;
+      std::shared_ptr<RequestContext> rctx;
+    };
+
+    Tenant(FairQueuingExecutor& parent, uint32_t weight)
+        : parent_(parent), weight_(weight) {}
+
+    void join() { joinKeepAlive(); }
+
+    FairQueuingExecutor& parent_;
+    const uint32_t weight_;
+    std::atomic<int64_t> runTime_{0};
+    // Moving average of the run time of the tasks, in nanoseconds.
+    std::atomic<int64_t> estimate_{0};
+    // Difference between the estimated and the actual run time of the tasks
+    // that ran since the last visit, added to the deficit on the next one.
+    std::atomic<int64_t> correction_{0};
+
+    // Protected by the mutex of the parent.
+    std::deque<Task> queue_;
+    bool active_ = false;
+    bool visited_ = false;
+    int64_t deficit_ = 0;
+  };
+
+  explicit FairQueuingExecutor(
+      Executor::KeepAlive<> executor, Options options = Options());
+  explicit FairQueuingExecutor(
+      std::unique_ptr<Executor> executor, Options options = Options());
+  ~FairQueuingExecutor() override;
+
+  /**
+   * Adds a tenant with the given weight, which must be >= 1. The tenant is
+   * destroyed with the FairQueuingExecutor, which waits for its
+   * KeepAlive tokens to be released first.
+   */
+  Executor::KeepAlive<Tenant> addTenant(uint32_t weight);
+
+  void add(Func func) override;
+
+  size_t pendingTasks() const;
+
+ private:
+  void enqueue(Tenant& tenant, Func func);
+  Tenant& pick(Tenant::Task& task);
+  void worker();
+  void scheduleWorker();
+
+  const Options options_;
+  std::unique_ptr<Executor> ownedExecutor_;
+  const Executor::KeepAlive<> executor_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Tenant>> tenants_;
+  Tenant* defaultTenant_;
+  // Tenants with queued tasks, in visiting order.
+  std::deque<Tenant*> active_;
+  size_t pending_ = 0;
+  uint32_t inQueue_ = 0;
+};
+
+} // namespace folly
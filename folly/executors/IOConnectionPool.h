@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/executors/IOObjectCache.h>
+#include <folly/io/async/EventBase.h>
+
+namespace folly {
+
+/*
+ * IOConnectionPool keeps connections, or any object bound to an EventBase and
+ * to a key such as a server address, for the EventBases of the global
+ * IOExecutor. Like IOObjectCache, which it is built on, it has one pool per
+ * pair of EventBase and calling thread; each pool keeps at most
+ * maxPerEventBase connections, and closes the least recently used ones
+ * beyond that, by dropping its reference to them.
+ *
+ * warmup() opens connections to a set of keys on all the EventBases at once,
+ * so that the first requests of each thread do not pay for connecting:
+ *
+ *   IOConnectionPool<SocketAddress, Client> pool(
+ *       [](EventBase* evb, const SocketAddress& address) {
+ *         return Client::connect(evb, address);
+ *       },
+ *       64);
+ *   pool.warmup(serverAddresses);
+ *   ...
+ *   pool.get(address)->send(request);
+ *
+ * If a validator is set, connections it rejects are replaced on get(), e.g.
+ * once the server closed them.
+ */
+template <class Key, class T>
+class IOConnectionPool {
+ public:
+  typedef std::function<std::shared_ptr<T>(folly::EventBase*, const Key&)>
+      TFactory;
+  typedef std::function<bool(const T&)> TValidator;
+
+  IOConnectionPool(
+      TFactory factory, size_t maxPerEventBase, TValidator validator = nullptr)
+      : factory_(std::move(factory)),
+        validator_(std::move(validator)),
+        maxPerEventBase_(maxPerEventBase),
+        pools_([this](folly::EventBase* evb) {
+          return std::make_shared<Pool>(*this, evb);
+        }) {
+    CHECK(factory_);
+    CHECK_GT(maxPerEventBase_, 0);
+  }
+
+  IOConnectionPool(const IOConnectionPool&) = delete;
+  IOConnectionPool& operator=(const IOConnectionPool&) = delete;
+
+  std::shared_ptr<T> get(const Key& key) { return pools_.get()->get(key); }
+
+  /**
+   * Connects to the given keys on all the EventBases of the global
+   * IOExecutor, for the calling thread. See IOObjectCache::warmup().
+   */
+  void warmup(const std::vector<Key>& keys) {
+    pools_.warmup(prepare(keys));
+  }
+
+  void warmup(
+      const std::vector<Executor::KeepAlive<EventBase>>& evbs,
+      const std::vector<Key>& keys) {
+    pools_.warmup(evbs, prepare(keys));
+  }
+
+ private:
+  class Pool {
+   public:
+    Pool(const IOConnectionPool& parent, folly::EventBase* evb)
+        : parent_(parent), evb_(evb), connections_(parent.maxPerEventBase_) {}
+
+    std::shared_ptr<T> get(const Key& key) {
+      auto it = connections_.find(key);
+      if (it != connections_.end() &&
+          (!parent_.validator_ || parent_.validator_(*it->second))) {
+        return it->second;
+      }
+      auto connection = parent_.factory_(evb_, key);
+      connections_.set(key, connection);
+      return connection;
+    }
+
+   private:
+    const IOConnectionPool& parent_;
+    folly::EventBase* const evb_;
+    EvictingCacheMap<Key, std::shared_ptr<T>> connections_;
+  };
+
+  static typename IOObjectCache<Pool>::TPrepare prepare(
+      const std::vector<Key>& keys) {
+    return [&keys](folly::EventBase*, Pool& pool) {
+      for (const auto& key : keys) {
+        pool.get(key);
+      }
+    };
+  }
+
+  const TFactory factory_;
+  const TValidator validator_;
+  const size_t maxPerEventBase_;
+  IOObjectCache<Pool> pools_;
+};
+
+} // namespace folly
@@ -17,10 +17,14 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
+#include <folly/ExceptionWrapper.h>
 #include <folly/ThreadLocal.h>
 #include <folly/executors/GlobalExecutor.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/synchronization/Latch.h>
 
 namespace folly {
 
@@ -39,11 +43,16 @@ namespace folly {
  * clients that are only ever called from within other threads without the
  * calling thread needing to know anything about the IO threads that the clients
  * will do their work on.
+ *
+ * The first get() for each pair creates the object, which may be costly (e.g.
+ * connecting a client). warmup() creates them ahead of time for the calling
+ * thread, on all the EventBases at once.
  */
 template <class T>
 class IOObjectCache {
  public:
   typedef std::function<std::shared_ptr<T>(folly::EventBase*)> TFactory;
+  typedef std::function<void(folly::EventBase*, T&)> TPrepare;
 
   IOObjectCache() = default;
   explicit IOObjectCache(TFactory factory) : factory_(std::move(factory)) {}
@@ -60,6 +69,70 @@ class IOObjectCache {
     return it->second;
   }
 
+  /**
+   * Creates the objects of the calling thread for the given EventBases, so
+   * that get() finds them. The factory runs on the thread of each EventBase,
+   * in parallel across EventBases. If set, prepare then runs on each object,
+   * whether it was just created or not, on the same thread.
+   *
+   * Blocks until all EventBases are done, then rethrows the first exception
+   * thrown by the factory or prepare, if any.
+   */
+  void warmup(
+      const std::vector<Executor::KeepAlive<EventBase>>& evbs,
+      TPrepare prepare = nullptr) {
+    CHECK(factory_);
+    auto& cache = *cache_;
+    std::vector<std::shared_ptr<T>> objects(evbs.size());
+    std::vector<exception_wrapper> errors(evbs.size());
+    Latch done(static_cast<ptrdiff_t>(evbs.size()));
+    for (size_t i = 0; i < evbs.size(); ++i) {
+      auto eb = evbs[i].get();
+      auto it = cache.find(eb);
+      if (it != cache.end()) {
+        objects[i] = it->second;
+      }
+      auto work = [&, i, eb] {
+        errors[i] = try_and_catch([&] {
+          if (!objects[i]) {
+            objects[i] = factory_(eb);
+          }
+          if (prepare) {
+            prepare(eb, *objects[i]);
+          }
+        });
+        done.count_down();
+      };
+      if (eb->isInEventBaseThread()) {
+        work();
+      } else {
+        eb->runInEventBaseThread(std::move(work));
+      }
+    }
+    done.wait();
+    for (size_t i = 0; i < evbs.size(); ++i) {
+      if (objects[i]) {
+        cache.emplace(evbs[i].get(), std::move(objects[i]));
+      }
+    }
+    for (auto& error : errors) {
+      if (error) {
+        error.throw_exception();
+      }
+    }
+  }
+
+  /**
+   * Warms up all the EventBases of the global IO executor, which get() picks
+   * from. It must be an IOThreadPoolExecutorBase.
+   */
+  void warmup(TPrepare prepare = nullptr) {
+    auto executor = getUnsafeMutableGlobalIOExecutor();
+    auto pool = dynamic_cast<IOThreadPoolExecutorBase*>(executor.get());
+    CHECK(pool) << "IOObjectCache::warmup() needs an IOThreadPoolExecutorBase";
+    warmup(pool->getAllEventBases(), std::move(prepare));
+  }
+
   void setFactory(TFactory factory) { factory_ = std::move(factory); }
 
  private:
@@ -16,9 +16,13 @@
 
 #include <folly/executors/IOThreadPoolExecutor.h>
 
+#include <limits>
+#include <vector>
+
 #include <glog/logging.h>
 
-#include <folly/detail/MemoryIdler.h>
+#include <folly/executors/thread_factory/NumaThreadFactory.h>
+#include <folly/io/async/EventBaseMemoryIdler.h>
 #include <folly/portability/GFlags.h>
 
 FOLLY_GFLAGS_DEFINE_bool(
@@ -28,60 +32,6 @@ FOLLY_GFLAGS_DEFINE_bool(
 
 namespace folly {
 
-namespace {
-
-using folly::detail::MemoryIdler;
-
-/* Class that will free jemalloc caches and madvise the stack away
- * if the event loop is unused for some period of time
- */
-class MemoryIdlerTimeout : public AsyncTimeout, public EventBase::LoopCallback {
- public:
-  explicit MemoryIdlerTimeout(EventBase* b) : AsyncTimeout(b), base_(b) {}
-
-  void timeoutExpired() noexcept override {
-    idled_ = true;
-    timerRunning_ = false;
-  }
-
-  void runLoopCallback() noexcept override {
-    if (idled_) {
-      if (num_ == 0) {
-        MemoryIdler::flushLocalMallocCaches();
-        MemoryIdler::unmapUnusedStack(MemoryIdler::kDefaultStackToRetain);
-      }
-
-      idled_ = false;
-      num_ = 0;
-    } else {
-      if (!timerRunning_) {
-        timerRunning_ = true;
-        std::chrono::steady_clock::duration idleTimeout =
-            MemoryIdler::defaultIdleTimeout.load(std::memory_order_acquire);
-
-        idleTimeout = MemoryIdler::getVariationTimeout(idleTimeout);
-
-        scheduleTimeout(static_cast<uint32_t>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(idleTimeout)
-                .count()));
-      } else {
-        num_++;
-      }
-    }
-
-    // reschedule this callback for the next event loop.
-    base_->runBeforeLoop(this);
-  }
-
- private:
-  EventBase* base_;
-  bool idled_{false};
-  bool timerRunning_{false};
-  size_t num_{0};
-};
-
-} // namespace
-
 // IOThreadPoolExecutorBase
 EventBase* IOThreadPoolExecutor::getEventBase(
     ThreadPoolExecutor::ThreadHandle* h) {
@@ -94,6 +44,18 @@ EventBase* IOThreadPoolExecutor::getEventBase(
   return nullptr;
 }
 
+namespace {
+
+std::shared_ptr<ThreadFactory> maybeMakeNumaThreadFactory(
+    std::shared_ptr<ThreadFactory> threadFactory, bool numaAware) {
+  if (numaAware && NumaThreadFactory::systemNumNodes() > 1) {
+    return std::make_shared<NumaThreadFactory>(std::move(threadFactory));
+  }
+  return threadFactory;
+}
+
+} // namespace
+
 // IOThreadPoolExecutor
 IOThreadPoolExecutor::IOThreadPoolExecutor(
     size_t numThreads,
@@ -114,8 +76,14 @@ IOThreadPoolExecutor::IOThreadPoolExecutor(
     EventBaseManager* ebm,
     Options options)
     : IOThreadPoolExecutorBase(
-          maxThreads, minThreads, std::move(threadFactory)),
+          maxThreads,
+          minThreads,
+          maybeMakeNumaThreadFactory(
+              std::move(threadFactory), options.numaAware)),
       isWaitForAll_(options.waitForAll),
+      numNumaNodes_(
+          options.numaAware ? NumaThreadFactory::systemNumNodes() : 1),
+      numaSpillThreshold_(options.numaSpillThreshold),
       nextThread_(0),
       eventBaseManager_(ebm) {
   setNumThreads(maxThreads);
@@ -154,6 +122,34 @@ void IOThreadPoolExecutor::add(
   ioThread->eventBase->runInEventBaseThread(std::move(wrappedFunc));
 }
 
+void IOThreadPoolExecutor::addBatch(span<Func> funcs) {
+  if (funcs.empty()) {
+    return;
+  }
+  ensureActiveThreads();
+  std::shared_lock r{threadListLock_};
+  if (threadList_.get().empty()) {
+    throw std::runtime_error("No threads available");
+  }
+  auto ioThread = pickThread();
+
+  std::vector<Task> tasks;
+  tasks.reserve(funcs.size());
+  for (auto& func : funcs) {
+    tasks.emplace_back(std::move(func), std::chrono::milliseconds(0), nullptr);
+    registerTaskEnqueue(tasks.back());
+  }
+  auto wrappedFunc = [this, ioThread, tasks = std::move(tasks)]() mutable {
+    for (auto& task : tasks) {
+      runTask(ioThread, std::move(task));
+      ioThread->pendingTasks--;
+    }
+  };
+
+  ioThread->pendingTasks += funcs.size();
+  ioThread->eventBase->runInEventBaseThread(std::move(wrappedFunc));
+}
+
 std::shared_ptr<IOThreadPoolExecutor::IOThread>
 IOThreadPoolExecutor::pickThread() {
   auto& me = *thisThread_;
@@ -177,10 +173,39 @@ IOThreadPoolExecutor::pickThread() {
     // the second case, `!me` so we'll crash anyway.
     return me;
   }
+  if (numNumaNodes_ > 1) {
+    return pickThreadOnLocalNode();
+  }
   auto thread = ths[nextThread_++ % n];
   return std::static_pointer_cast<IOThread>(thread);
 }
 
+// threadListLock_ is readlocked, and the thread list is not empty.
+std::shared_ptr<IOThreadPoolExecutor::IOThread>
+IOThreadPoolExecutor::pickThreadOnLocalNode() {
+  auto& ths = threadList_.get();
+  auto n = ths.size();
+  auto node = NumaThreadFactory::currentNode(numNumaNodes_);
+  // Round-robin over the threads of the local node, as long as they are not
+  // backlogged; otherwise spill over to the least loaded thread overall.
+  size_t start = nextThread_++;
+  size_t leastLoaded = start % n;
+  size_t leastLoadedPending = std::numeric_limits<size_t>::max();
+  for (size_t i = 0; i < n; ++i) {
+    auto idx = (start + i) % n;
+    auto& thread = static_cast<IOThread&>(*ths[idx]);
+    size_t pending = thread.pendingTasks.load(std::memory_order_relaxed);
+    if (thread.numaNode == node && pending <= numaSpillThreshold_) {
+      return std::static_pointer_cast<IOThread>(ths[idx]);
+    }
+    if (pending < leastLoadedPending) {
+      leastLoaded = idx;
+      leastLoadedPending = pending;
+    }
+  }
+  return std::static_pointer_cast<IOThread>(ths[leastLoaded]);
+}
+
 EventBase* IOThreadPoolExecutor::getEventBase() {
   ensureActiveThreads();
   std::shared_lock r{threadListLock_};
@@ -217,6 +242,10 @@ void IOThreadPoolExecutor::threadRun(ThreadPtr thread) {
   const auto& ioThread = *thisThread_ =
       std::static_pointer_cast<IOThread>(thread);
   ioThread->eventBase = eventBaseManager_->getEventBase();
+  if (numNumaNodes_ > 1) {
+    // The NumaThreadFactory has already pinned this thread to its node.
+    ioThread->numaNode = NumaThreadFactory::currentNode(numNumaNodes_);
+  }
 
   auto tid = folly::getOSThreadID();
   if (threadIdCollector_) {
@@ -228,8 +257,7 @@ void IOThreadPoolExecutor::threadRun(ThreadPtr thread) {
     }
   };
 
-  auto idler = std::make_unique<MemoryIdlerTimeout>(ioThread->eventBase);
-  ioThread->eventBase->runBeforeLoop(idler.get());
+  auto idler = std::make_unique<EventBaseMemoryIdler>(*ioThread->eventBase);
 
   ioThread->eventBase->runInEventBaseThread([thread] {
     thread->startupBaton.post();
@@ -81,7 +81,11 @@ class IOThreadPoolExecutorBase
 class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
  public:
   struct Options {
-    Options() : waitForAll(false), enableThreadIdCollection(false) {}
+    Options()
+        : waitForAll(false),
+          enableThreadIdCollection(false),
+          numaAware(false),
+          numaSpillThreshold(kDefaultNumaSpillThreshold) {}
 
     Options& setWaitForAll(bool b) {
       this->waitForAll = b;
@@ -91,9 +95,26 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       this->enableThreadIdCollection = b;
       return *this;
     }
+    // Partition the threads across NUMA nodes: threads are pinned to a node
+    // with a NumaThreadFactory, and add() and getEventBase() called from
+    // outside the pool prefer a thread on the caller's node, spilling over to
+    // the least loaded thread of any node only when every local thread has
+    // more than numaSpillThreshold pending tasks.
+    Options& setNumaAware(bool b) {
+      this->numaAware = b;
+      return *this;
+    }
+    Options& setNumaSpillThreshold(size_t n) {
+      this->numaSpillThreshold = n;
+      return *this;
+    }
+
+    static constexpr size_t kDefaultNumaSpillThreshold = 64;
 
     bool waitForAll;
     bool enableThreadIdCollection;
+    bool numaAware;
+    size_t numaSpillThreshold;
   };
 
   explicit IOThreadPoolExecutor(
@@ -119,6 +140,10 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       std::chrono::milliseconds expiration,
       Func expireCallback = nullptr) override;
 
+  /// All functions of a batch are scheduled on the same EventBase with a
+  /// single callback, and run in order.
+  void addBatch(span<Func> funcs) override;
+
   folly::EventBase* getEventBase() override;
 
   // Ensures that the maximum number of active threads is running and returns
@@ -139,6 +164,7 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
   struct alignas(Thread) IOThread : public Thread {
     std::atomic<bool> shouldRun{true};
     std::atomic<size_t> pendingTasks{0};
+    relaxed_atomic<size_t> numaNode{0};
     folly::EventBase* eventBase{nullptr};
     std::mutex eventBaseShutdownMutex_;
   };
@@ -151,10 +177,13 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
  private:
   ThreadPtr makeThread() override;
   std::shared_ptr<IOThread> pickThread();
+  std::shared_ptr<IOThread> pickThreadOnLocalNode();
   void threadRun(ThreadPtr thread) override;
   void stopThreads(size_t n) override;
   size_t getPendingTaskCountImpl() const override final;
   const bool isWaitForAll_; // whether to wait till event base loop exits
+  const size_t numNumaNodes_; // 1 unless Options::numaAware
+  const size_t numaSpillThreshold_;
   relaxed_atomic<size_t> nextThread_;
   folly::ThreadLocal<std::shared_ptr<IOThread>> thisThread_;
   folly::EventBaseManager* eventBaseManager_;
@@ -100,6 +100,20 @@ void SerialExecutorImpl<Queue>::addWithPriority(Func func, int8_t priority) {
   }
 }
 
+template <template <typename> typename Queue>
+void SerialExecutorImpl<Queue>::addBatch(span<Func> funcs) {
+  if (funcs.empty()) {
+    return;
+  }
+  auto ctx = RequestContext::saveContext();
+  for (auto& func : funcs) {
+    queue_.enqueue(Task{std::move(func), ctx});
+  }
+  if (scheduled_.fetch_add(funcs.size(), std::memory_order_acq_rel) == 0) {
+    parent_->add(Worker{getKeepAliveToken(this)});
+  }
+}
+
 template <template <typename> typename Queue>
 bool SerialExecutorImpl<Queue>::scheduleTask(Func&& func) {
   queue_.enqueue(Task{std::move(func), RequestContext::saveContext()});
@@ -183,8 +197,10 @@ class NoopMutex {
  *
  * Producers are internally synchronized using a mutex, while the consumer
  * relies entirely on external synchronization.
+ *
+ * The first segment, of SegmentSize tasks, is stored inline.
  */
-template <class Task, class Mutex>
+template <class Task, class Mutex, size_t SegmentSize>
 class SerialExecutorMPSCQueue {
   static_assert(std::is_nothrow_move_constructible_v<Task>);
 
@@ -240,7 +256,8 @@ class SerialExecutorMPSCQueue {
   }
 
  private:
-  static constexpr size_t kSegmentSize = 16;
+  static constexpr size_t kSegmentSize = SegmentSize;
+  static_assert(kSegmentSize > 0);
 
   struct Segment {
     // Neither writeIdx or readIdx need to be atomic since each is exclusively
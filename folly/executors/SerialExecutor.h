@@ -95,6 +95,12 @@ class SerialExecutorImpl : public SerializedExecutor {
    */
   void add(Func func) override;
 
+  /**
+   * Add all tasks for sequential execution, in order, submitting at most one
+   * task to the parent executor for the whole batch.
+   */
+  void addBatch(span<Func> funcs) override;
+
   /**
    * Add one task for execution in the parent executor, and use the given
    * priority for one task submission to parent executor.
@@ -147,7 +153,10 @@ struct SerialExecutorWithUnboundedQueue {
 
 class NoopMutex;
 
-template <class Task, class Mutex = folly::DistributedMutex>
+template <
+    class Task,
+    class Mutex = folly::DistributedMutex,
+    size_t SegmentSize = 16>
 class SerialExecutorMPSCQueue;
 
 template <typename Task>
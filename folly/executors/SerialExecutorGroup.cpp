@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/SerialExecutorGroup.h>
+
+#include <utility>
+
+#include <glog/logging.h>
+
+using namespace std::chrono;
+
+namespace folly {
+
+// Callable draining the ready strands of a group when called.
+class SerialExecutorGroup::Drainer {
+ public:
+  explicit Drainer(std::shared_ptr<SerialExecutorGroup> group) noexcept
+      : group_(std::move(group)) {}
+
+  Drainer(Drainer&& other) noexcept : group_(std::move(other.group_)) {}
+
+  Drainer(const Drainer&) = delete;
+  Drainer& operator=(const Drainer&) = delete;
+  Drainer& operator=(Drainer&&) = delete;
+
+  ~Drainer() {
+    if (group_) {
+      // The parent executor dropped us: drop the tasks we were to run, as
+      // SerialExecutor does.
+      group_->discard();
+    }
+  }
+
+  void operator()() { std::exchange(group_, {})->drain(); }
+
+ private:
+  std::shared_ptr<SerialExecutorGroup> group_;
+};
+
+std::shared_ptr<SerialExecutorGroup> SerialExecutorGroup::create(
+    Executor::KeepAlive<> parent, Options options) {
+  return std::make_shared<SerialExecutorGroup>(
+      PrivateTag{}, std::move(parent), std::move(options));
+}
+
+SerialExecutorGroup::SerialExecutorGroup(
+    PrivateTag, Executor::KeepAlive<> parent, Options options)
+    : options_(std::move(options)), parent_(std::move(parent)) {
+  CHECK_GE(options_.maxDrainers, 1);
+  CHECK_GE(options_.maxBatch, 1);
+}
+
+Executor::KeepAlive<SerializedExecutor> SerialExecutorGroup::createStrand() {
+  return Strand::create(shared_from_this());
+}
+
+size_t SerialExecutorGroup::readyStrands() const {
+  std::lock_guard lock(mutex_);
+  return ready_.size();
+}
+
+void SerialExecutorGroup::ready(Executor::KeepAlive<Strand> strand) {
+  bool shouldScheduleDrainer = false;
+  {
+    std::lock_guard lock(mutex_);
+    ready_.push_back(std::move(strand));
+    if (drainers_ < options_.maxDrainers) {
+      ++drainers_;
+      shouldScheduleDrainer = true;
+    }
+  }
+  if (shouldScheduleDrainer) {
+    RequestContextScopeGuard ctxGuard{nullptr};
+    parent_->add(Drainer{shared_from_this()});
+  }
+}
+
+void SerialExecutorGroup::drain() {
+  auto deadline = steady_clock::now() + options_.drainBudget;
+  while (true) {
+    Executor::KeepAlive<Strand> strand;
+    {
+      std::lock_guard lock(mutex_);
+      if (ready_.empty()) {
+        --drainers_;
+        return;
+      }
+      strand = std::move(ready_.front());
+      ready_.pop_front();
+    }
+    if (strand->run(deadline)) {
+      // Back of the line, behind the strands which were waiting.
+      std::lock_guard lock(mutex_);
+      ready_.push_back(std::move(strand));
+    }
+    if (steady_clock::now() >= deadline) {
+      break;
+    }
+  }
+
+  // Out of budget: yield to the other tasks of the parent executor, keeping
+  // our drainer slot.
+  {
+    std::lock_guard lock(mutex_);
+    if (ready_.empty()) {
+      --drainers_;
+      return;
+    }
+  }
+  RequestContextScopeGuard ctxGuard{nullptr};
+  parent_->add(Drainer{shared_from_this()});
+}
+
+void SerialExecutorGroup::discard() {
+  while (true) {
+    Executor::KeepAlive<Strand> strand;
+    {
+      std::lock_guard lock(mutex_);
+      if (ready_.empty()) {
+        --drainers_;
+        return;
+      }
+      strand = std::move(ready_.front());
+      ready_.pop_front();
+    }
+    strand->discard();
+  }
+}
+
+Executor::KeepAlive<SerialExecutorGroup::Strand>
+SerialExecutorGroup::Strand::create(
+    std::shared_ptr<SerialExecutorGroup> group) {
+  return makeKeepAlive<Strand>(new Strand(std::move(group)));
+}
+
+SerialExecutorGroup::Strand::~Strand() {
+  DCHECK(!keepAliveCounter_);
+}
+
+bool SerialExecutorGroup::Strand::keepAliveAcquire() noexcept {
+  auto keepAliveCounter =
+      keepAliveCounter_.fetch_add(1, std::memory_order_relaxed);
+  DCHECK(keepAliveCounter > 0);
+  return true;
+}
+
+void SerialExecutorGroup::Strand::keepAliveRelease() noexcept {
+  auto keepAliveCounter =
+      keepAliveCounter_.fetch_sub(1, std::memory_order_acq_rel);
+  DCHECK(keepAliveCounter > 0);
+  if (keepAliveCounter == 1) {
+    delete this;
+  }
+}
+
+void SerialExecutorGroup::Strand::add(Func func) {
+  queue_.enqueue(Task{std::move(func), RequestContext::saveContext()});
+  // If this thread is the first to mark the queue as non-empty, make the
+  // strand ready.
+  if (scheduled_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+    group_->ready(getKeepAliveToken(this));
+  }
+}
+
+bool SerialExecutorGroup::Strand::run(steady_clock::time_point deadline) {
+  std::size_t queueSize = scheduled_.load(std::memory_order_acquire);
+  DCHECK_NE(queueSize, 0);
+
+  std::size_t processed = 0;
+  uint32_t batch = 0;
+  RequestContextSaverScopeGuard ctxGuard;
+  while (true) {
+    Task task;
+    queue_.dequeue(task);
+    RequestContext::setContext(std::move(task.ctx));
+    invokeCatchingExns(
+        "SerialExecutorGroup: func", std::exchange(task.func, {}));
+
+    ++processed;
+    bool yield = ++batch == group_->options_.maxBatch ||
+        steady_clock::now() >= deadline;
+    if (processed == queueSize || yield) {
+      // NOTE: scheduled_ must be decremented after the tasks have been
+      // processed, or add() may concurrently make the strand ready again.
+      queueSize = scheduled_.fetch_sub(processed, std::memory_order_acq_rel) -
+          processed;
+      if (queueSize == 0) {
+        // Queue is now empty. The next add() makes the strand ready again.
+        return false;
+      }
+      if (yield) {
+        return true;
+      }
+      processed = 0;
+    }
+  }
+}
+
+void SerialExecutorGroup::Strand::discard() {
+  auto queueSize = scheduled_.load(std::memory_order_acquire);
+  RequestContextSaverScopeGuard ctxGuard;
+  while (queueSize != 0) {
+    Task task;
+    queue_.dequeue(task);
+    RequestContext::setContext(std::move(task.ctx));
+    task.func = {};
+    queueSize = scheduled_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+}
+
+} // namespace folly
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <folly/executors/GlobalExecutor.h>
+#include <folly/executors/SerialExecutor.h>
+#include <folly/executors/SerializedExecutor.h>
+#include <folly/io/async/Request.h>
+#include <folly/synchronization/DistributedMutex.h>
+
+namespace folly {
+
+/**
+ * @class SerialExecutorGroup
+ *
+ * @brief Many serial executors (strands) sharing the scheduling on their
+ *     parent executor
+ *
+ * Each strand created by the group executes its tasks strictly
+ * non-concurrently and in the order they were added, like a SerialExecutor.
+ * Unlike SerialExecutors, strands do not add a task to the parent executor
+ * whenever they become non-empty: they are put on the ready list of the
+ * group, which is drained by at most maxDrainers tasks in the parent
+ * executor. Each drainer takes ready strands in turn, running up to
+ * maxBatch tasks of each, until the list is empty or its time budget is
+ * spent. It then adds itself back to the parent if there is more work, so
+ * that long backlogs still yield to the other tasks of the parent.
+ *
+ * This suits workloads with very many short-lived strands, e.g. one per
+ * session, where the parent executor would otherwise see one task per burst
+ * of every strand. Strands are also small: they keep the first few tasks
+ * inline, as SmallSerialExecutor does, and share the parent KeepAlive of
+ * the group.
+ *
+ * Strands hold a reference to the group, which is destroyed when the last
+ * strand is. As with SerialExecutor, tasks added to a strand are executed
+ * even if the strand is released, as long as the parent executor is
+ * executing tasks.
+ *
+ * auto group = SerialExecutorGroup::create(getGlobalCPUExecutor());
+ * auto strand = group->createStrand();
+ * strand->add([] { handleMessage(); });
+ */
+class SerialExecutorGroup
+    : public std::enable_shared_from_this<SerialExecutorGroup> {
+ public:
+  struct Options {
+    Options() {}
+    // Maximum number of drainers in the parent executor at any time, i.e.
+    // maximum number of strands of the group running concurrently.
+    uint32_t maxDrainers = 1;
+    // Time after which a drainer adds itself back to the parent executor.
+    std::chrono::microseconds drainBudget = std::chrono::milliseconds(1);
+    // Maximum number of tasks of a strand run in a row, before the next
+    // ready strand gets its turn.
+    uint32_t maxBatch = 32;
+  };
+
+  class Strand;
+
+  static std::shared_ptr<SerialExecutorGroup> create(
+      Executor::KeepAlive<> parent = getGlobalCPUExecutor(),
+      Options options = Options());
+
+  Executor::KeepAlive<SerializedExecutor> createStrand();
+
+  /**
+   * Number of strands with tasks queued and not running.
+   */
+  size_t readyStrands() const;
+
+ private:
+  struct PrivateTag {};
+  class Drainer;
+
+ public:
+  // Public to allow construction using std::make_shared() but a logically
+  // private constructor.
+  SerialExecutorGroup(
+      PrivateTag, Executor::KeepAlive<> parent, Options options);
+
+ private:
+  void ready(Executor::KeepAlive<Strand> strand);
+  void drain();
+  void discard();
+
+  const Options options_;
+  const Executor::KeepAlive<> parent_;
+
+  mutable std::mutex mutex_;
+  std::deque<Executor::KeepAlive<Strand>> ready_;
+  uint32_t drainers_ = 0;
+};
+
+class SerialExecutorGroup::Strand final : public SerializedExecutor {
+ public:
+  void add(Func func) override;
+
+ protected:
+  bool keepAliveAcquire() noexcept override;
+  void keepAliveRelease() noexcept override;
+
+ private:
+  friend class SerialExecutorGroup;
+
+  struct Task {
+    Func func;
+    std::shared_ptr<RequestContext> ctx;
+  };
+
+  static Executor::KeepAlive<Strand> create(
+      std::shared_ptr<SerialExecutorGroup> group);
+
+  explicit Strand(std::shared_ptr<SerialExecutorGroup> group)
+      : group_(std::move(group)) {}
+  ~Strand() override;
+
+  // Runs tasks until the queue is empty, maxBatch tasks have run or the
+  // deadline has passed. Returns whether tasks are left.
+  bool run(std::chrono::steady_clock::time_point deadline);
+  // Destroys the queued tasks without running them.
+  void discard();
+
+  const std::shared_ptr<SerialExecutorGroup> group_;
+  std::atomic<std::size_t> scheduled_{0};
+  std::atomic<ssize_t> keepAliveCounter_{1};
+  detail::SerialExecutorMPSCQueue<Task, DistributedMutex, 4> queue_;
+};
+
+} // namespace folly
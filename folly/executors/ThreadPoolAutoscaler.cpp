@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/ThreadPoolAutoscaler.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glog/logging.h>
+
+namespace folly {
+
+class ThreadPoolAutoscaler::StatsObserver
+    : public ThreadPoolExecutor::TaskObserver {
+ public:
+  explicit StatsObserver(std::shared_ptr<Stats> stats)
+      : stats_(std::move(stats)) {}
+
+  void taskDequeued(
+      const ThreadPoolExecutor::DequeuedTaskInfo& info) noexcept override {
+    uint64_t delay = std::max<int64_t>(info.waitTime.count(), 0);
+    auto& maxDelay = stats_->maxQueueDelayNs;
+    // Read first, most tasks do not raise the maximum.
+    auto cur = maxDelay.load(std::memory_order_relaxed);
+    while (cur < delay &&
+           !maxDelay.compare_exchange_weak(
+               cur, delay, std::memory_order_relaxed)) {
+    }
+  }
+
+  void taskProcessed(
+      const ThreadPoolExecutor::ProcessedTaskInfo& info) noexcept override {
+    stats_->busyNs.fetch_add(
+        std::max<int64_t>(info.runTime.count(), 0), std::memory_order_relaxed);
+  }
+
+ private:
+  const std::shared_ptr<Stats> stats_;
+};
+
+ThreadPoolAutoscaler::ThreadPoolAutoscaler(
+    ThreadPoolExecutor& executor, Options opts)
+    : executor_(executor),
+      opts_([&] {
+        if (opts.maxThreads == 0) {
+          opts.maxThreads = executor.numThreads();
+        }
+        CHECK_GE(opts.maxThreads, opts.minThreads);
+        CHECK_GT(opts.growthFactor, 1.0);
+        CHECK_GT(opts.idleUtilization, 0.0);
+        return opts;
+      }()),
+      stats_(std::make_shared<Stats>()),
+      lastUpdate_(std::chrono::steady_clock::now()) {
+  executor_.addTaskObserver(std::make_unique<StatsObserver>(stats_));
+  scheduler_.setThreadName("TPAutoscaler");
+  scheduler_.addFunction(
+      [this] { update(); }, opts_.interval, "ThreadPoolAutoscaler");
+}
+
+ThreadPoolAutoscaler::~ThreadPoolAutoscaler() {
+  stop();
+}
+
+void ThreadPoolAutoscaler::start() {
+  scheduler_.start();
+}
+
+void ThreadPoolAutoscaler::stop() {
+  scheduler_.shutdown();
+}
+
+std::size_t ThreadPoolAutoscaler::update() {
+  auto now = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration<double, std::nano>(now - lastUpdate_);
+  lastUpdate_ = now;
+  auto queueDelay = std::chrono::nanoseconds(
+      stats_->maxQueueDelayNs.exchange(0, std::memory_order_relaxed));
+  auto busy = std::chrono::duration<double, std::nano>(
+      stats_->busyNs.exchange(0, std::memory_order_relaxed));
+
+  const auto numThreads = executor_.numThreads();
+  auto next = std::clamp(numThreads, opts_.minThreads, opts_.maxThreads);
+  double busyThreads = elapsed.count() > 0 ? busy / elapsed : 0.0;
+  double utilization = numThreads > 0 ? busyThreads / numThreads : 1.0;
+
+  if (queueDelay > opts_.targetQueueDelay) {
+    idleIntervals_ = 0;
+    auto grown = static_cast<std::size_t>(
+        std::ceil(static_cast<double>(next) * opts_.growthFactor));
+    next = std::min(std::max(grown, next + 1), opts_.maxThreads);
+  } else if (
+      queueDelay <= opts_.targetQueueDelay / 2 &&
+      utilization < opts_.idleUtilization) {
+    if (++idleIntervals_ >= opts_.shrinkAfterIdleIntervals) {
+      idleIntervals_ = 0;
+      auto needed = static_cast<std::size_t>(
+          std::ceil(busyThreads / opts_.idleUtilization));
+      next = std::max({needed, next / 2, opts_.minThreads});
+    }
+  } else {
+    idleIntervals_ = 0;
+  }
+
+  if (next != numThreads) {
+    VLOG(1) << "ThreadPoolAutoscaler: " << executor_.getName() << " from "
+            << numThreads << " to " << next << " threads, queue delay "
+            << queueDelay.count() << "ns, utilization " << utilization;
+    executor_.setNumThreads(next);
+  }
+  return next;
+}
+
+} // namespace folly
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <folly/executors/FunctionScheduler.h>
+#include <folly/executors/ThreadPoolExecutor.h>
+
+namespace folly {
+
+/**
+ * Grows and shrinks the number of threads of a thread pool, typically a
+ * CPUThreadPoolExecutor, based on the queueing delay of its tasks and on the
+ * utilization of its threads.
+ *
+ * Every interval the autoscaler looks at the tasks dequeued and run during the
+ * interval:
+ *  - If the longest time a task spent queued exceeds the target delay, the
+ *    pool is short of threads, and it grows by growthFactor.
+ *  - If the longest queueing delay is below half the target, and the threads
+ *    were busy less than the idle utilization, the interval is idle. After
+ *    shrinkAfterIdleIntervals idle intervals in a row, the pool shrinks to the
+ *    number of threads that would have been busy at the idle utilization, and
+ *    at most by half.
+ * Between the two thresholds nothing changes, so the pool does not oscillate.
+ * The number of threads always stays within [minThreads, maxThreads].
+ *
+ * The measurements come from a task observer, which costs a few atomic
+ * operations per task.
+ *
+ * The autoscaler must be destroyed before the executor.
+ *
+ * CPUThreadPoolExecutor pool(maxThreads);
+ * ThreadPoolAutoscaler::Options opts;
+ * opts.minThreads = 4;
+ * ThreadPoolAutoscaler autoscaler(pool, opts);
+ * autoscaler.start();
+ */
+class ThreadPoolAutoscaler {
+ public:
+  struct Options {
+    std::size_t minThreads = 1;
+    // 0 means the number of threads of the executor on construction.
+    std::size_t maxThreads = 0;
+    std::chrono::milliseconds targetQueueDelay{10};
+    std::chrono::milliseconds interval{100};
+    double idleUtilization = 0.5;
+    std::size_t shrinkAfterIdleIntervals = 10;
+    double growthFactor = 1.5;
+  };
+
+  explicit ThreadPoolAutoscaler(ThreadPoolExecutor& executor, Options opts);
+  explicit ThreadPoolAutoscaler(ThreadPoolExecutor& executor)
+      : ThreadPoolAutoscaler(executor, Options{}) {}
+
+  ~ThreadPoolAutoscaler();
+
+  // Runs update() every interval, in a thread of its own.
+  void start();
+  void stop();
+
+  // Resizes the pool according to the tasks observed since the previous
+  // update, and returns the new number of threads.
+  std::size_t update();
+
+ private:
+  struct Stats {
+    std::atomic<uint64_t> maxQueueDelayNs{0};
+    std::atomic<uint64_t> busyNs{0};
+  };
+  class StatsObserver;
+
+  ThreadPoolExecutor& executor_;
+  const Options opts_;
+  // Shared with the observer, which is owned by the executor.
+  const std::shared_ptr<Stats> stats_;
+  std::chrono::steady_clock::time_point lastUpdate_;
+  std::size_t idleIntervals_{0};
+  FunctionScheduler scheduler_;
+};
+
+} // namespace folly
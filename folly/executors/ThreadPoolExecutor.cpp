@@ -21,11 +21,32 @@
 #include <folly/concurrency/ProcessLocalUniqueId.h>
 #include <folly/executors/GlobalThreadPoolList.h>
 #include <folly/portability/PThread.h>
+#include <folly/portability/Time.h>
 #include <folly/synchronization/AsymmetricThreadFence.h>
 #include <folly/tracing/StaticTracepoint.h>
+#include <folly/tracing/TraceRecorder.h>
 
 namespace folly {
 
+/* static */ StringPiece RequestTaskClass::get(const RequestContext* ctx) {
+  if (!ctx) {
+    return {};
+  }
+  auto data =
+      dynamic_cast<const RequestTaskClass*>(ctx->getContextData(token()));
+  if (!data) {
+    return {};
+  }
+  return data->taskClass_;
+}
+
+/* static */ void RequestTaskClass::set(std::string taskClass) {
+  RequestContext::get()->setContextData(
+      token(),
+      std::unique_ptr<RequestTaskClass>(
+          new RequestTaskClass(std::move(taskClass))));
+}
+
 using SyncVecThreadPoolExecutors =
     folly::Synchronized<std::vector<ThreadPoolExecutor*>>;
 
@@ -127,7 +148,11 @@ void ThreadPoolExecutor::runTask(const ThreadPtr& thread, Task&& task) {
       taskInfo.taskId);
   forEachTaskObserver([&](auto& observer) { observer.taskDequeued(taskInfo); });
 
+  const bool accountCpuTime = isTaskCpuTimeAccountingEnabled();
+  const auto cpuStartTime =
+      accountCpuTime ? threadCpuTime() : std::chrono::nanoseconds{0};
   {
+    TraceSection trace("ThreadPoolExecutor::runTask", "executor");
     folly::RequestContextScopeGuard rctx(task.context_);
     if (task.expiration_ != nullptr &&
         taskInfo.waitTime >= task.expiration_->expiration) {
@@ -149,6 +174,10 @@ void ThreadPoolExecutor::runTask(const ThreadPtr& thread, Task&& task) {
   if (!taskInfo.expired) {
     taskInfo.runTime = std::chrono::steady_clock::now() - startTime;
   }
+  if (accountCpuTime) {
+    taskInfo.cpuTime = threadCpuTime() - cpuStartTime;
+    accountTaskCpuTime(*thread, task.context_.get(), taskInfo.cpuTime);
+  }
 
   // Times in this USDT use granularity of std::chrono::steady_clock::duration,
   // which is platform dependent. On Facebook servers, the granularity is
@@ -173,6 +202,27 @@ void ThreadPoolExecutor::runTask(const ThreadPtr& thread, Task&& task) {
       std::chrono::steady_clock::now(), std::memory_order_relaxed);
 }
 
+/* static */ std::chrono::nanoseconds ThreadPoolExecutor::threadCpuTime() {
+  timespec tp{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp);
+  return std::chrono::nanoseconds(tp.tv_nsec) +
+      std::chrono::seconds(tp.tv_sec);
+}
+
+/* static */ void ThreadPoolExecutor::accountTaskCpuTime(
+    Thread& thread,
+    const RequestContext* ctx,
+    std::chrono::nanoseconds cpuTime) {
+  auto taskClass = RequestTaskClass::get(ctx);
+  auto stats = thread.taskClassStats.wlock();
+  auto it = stats->find(taskClass);
+  if (it == stats->end()) {
+    it = stats->emplace(taskClass.str(), TaskClassStats{}).first;
+  }
+  ++it->second.taskCount;
+  it->second.cpuTime += cpuTime;
+}
+
 void ThreadPoolExecutor::add(Func, std::chrono::milliseconds, Func) {
   throw std::runtime_error(
       "add() with expiration is not implemented for this Executor");
@@ -24,7 +24,10 @@
 
 #include <folly/DefaultKeepAliveExecutor.h>
 #include <folly/Memory.h>
+#include <folly/Range.h>
 #include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+#include <folly/container/F14Map.h>
 #include <folly/executors/GlobalThreadPoolList.h>
 #include <folly/executors/task_queue/LifoSemMPMCQueue.h>
 #include <folly/executors/thread_factory/NamedThreadFactory.h>
@@ -35,6 +38,30 @@
 
 namespace folly {
 
+// Sets and retrieves the task class of a request via RequestContext, which
+// ThreadPoolExecutor uses as the key of per-task CPU time accounting. See
+// ThreadPoolExecutor::setTaskCpuTimeAccounting().
+class RequestTaskClass : public RequestData {
+ public:
+  // Returns the empty string if the context has no task class.
+  static StringPiece get(const RequestContext* ctx = RequestContext::get());
+
+  static void set(std::string taskClass);
+
+  bool hasCallback() override { return false; }
+
+ private:
+  FOLLY_EXPORT static RequestToken const& token() {
+    static RequestToken const token(kContextDataName);
+    return token;
+  }
+
+  explicit RequestTaskClass(std::string taskClass)
+      : taskClass_(std::move(taskClass)) {}
+  std::string taskClass_;
+  static constexpr const char* kContextDataName{"folly::RequestTaskClass"};
+};
+
 /* Base class for implementing threadpool based executors.
  *
  * Dynamic thread behavior:
@@ -143,6 +170,33 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
     return threadList_.getUsedCpuTime();
   }
 
+  struct TaskClassStats {
+    uint64_t taskCount = 0;
+    std::chrono::nanoseconds cpuTime{0};
+  };
+  using TaskClassStatsMap = F14FastMap<std::string, TaskClassStats>;
+
+  /**
+   * When enabled, the CPU time of each task is measured with the CPU clock of
+   * the thread and added to the stats of its task class, as set with
+   * RequestTaskClass in the RequestContext of the task. Tasks without a class
+   * are accounted under the empty string. The stats are kept per thread, so
+   * accounting costs two reads of the thread CPU clock and an uncontended lock
+   * per task. Disabled by default.
+   */
+  void setTaskCpuTimeAccounting(bool enabled) {
+    taskCpuTimeAccounting_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the stats of each task class, including those accounted by threads
+   * that are no longer alive.
+   */
+  TaskClassStatsMap getTaskClassStats() const {
+    std::shared_lock r{threadListLock_};
+    return threadList_.getTaskClassStats();
+  }
+
   /**
    * Base class for threads created with ThreadPoolExecutor.
    * Some subclasses have methods that operate on these
@@ -185,6 +239,8 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
   struct ProcessedTaskInfo : DequeuedTaskInfo {
     bool expired = false;
     std::chrono::nanoseconds runTime{0};
+    // Only measured with task CPU time accounting enabled.
+    std::chrono::nanoseconds cpuTime{0};
   };
 
   class TaskObserver {
@@ -241,6 +297,8 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
     std::atomic<bool> idle;
     folly::AtomicStruct<std::chrono::steady_clock::time_point> lastActiveTime;
     folly::Baton<> startupBaton;
+    // Only read outside of the thread by getTaskClassStats().
+    folly::Synchronized<TaskClassStatsMap> taskClassStats;
   };
 
   using ThreadPtr = std::shared_ptr<Thread>;
@@ -284,6 +342,18 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
 
   void runTask(const ThreadPtr& thread, Task&& task);
 
+  bool isTaskCpuTimeAccountingEnabled() const {
+    return taskCpuTimeAccounting_.load(std::memory_order_relaxed);
+  }
+  // CPU time used by the calling thread.
+  static std::chrono::nanoseconds threadCpuTime();
+  // Adds the CPU time of a task, that ran in the context ctx, to the stats of
+  // the thread.
+  static void accountTaskCpuTime(
+      Thread& thread,
+      const RequestContext* ctx,
+      std::chrono::nanoseconds cpuTime);
+
   virtual void validateNumThreads(size_t /* numThreads */) {}
 
   // The function that will be bound to pool threads. It must call
@@ -331,6 +401,9 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
       CHECK(std::next(itPair.first) == itPair.second);
       vec_.erase(itPair.first);
       pastCpuUsed_ += state->usedCpuTime();
+      state->taskClassStats.withRLock([&](const auto& stats) {
+        mergeTaskClassStats(pastTaskClassStats_, stats);
+      });
     }
 
     bool contains(const ThreadPtr& ts) const {
@@ -347,7 +420,25 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
       return acc;
     }
 
+    TaskClassStatsMap getTaskClassStats() const {
+      auto acc{pastTaskClassStats_};
+      for (const auto& thread : vec_) {
+        thread->taskClassStats.withRLock(
+            [&](const auto& stats) { mergeTaskClassStats(acc, stats); });
+      }
+      return acc;
+    }
+
    private:
+    static void mergeTaskClassStats(
+        TaskClassStatsMap& acc, const TaskClassStatsMap& stats) {
+      for (const auto& [taskClass, classStats] : stats) {
+        auto& accStats = acc[taskClass];
+        accStats.taskCount += classStats.taskCount;
+        accStats.cpuTime += classStats.cpuTime;
+      }
+    }
+
     struct Compare {
       bool operator()(const ThreadPtr& ts1, const ThreadPtr& ts2) const {
         return ts1->id < ts2->id;
@@ -356,6 +447,8 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
     std::vector<ThreadPtr> vec_;
     // cpu time used by threads that are no longer alive
     std::chrono::nanoseconds pastCpuUsed_{0};
+    // task class stats of threads that are no longer alive
+    TaskClassStatsMap pastTaskClassStats_;
   };
 
   class StoppedThreadQueue : public BlockingQueue<ThreadPtr> {
@@ -397,6 +490,7 @@ class ThreadPoolExecutor : public DefaultKeepAliveExecutor {
 
   std::atomic<size_t> threadsToJoin_{0};
   std::atomic<std::chrono::milliseconds> threadTimeout_;
+  std::atomic<bool> taskCpuTimeAccounting_{false};
 
   bool joinKeepAliveOnce() {
     if (!std::exchange(keepAliveJoined_, true)) {
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <folly/CPortability.h>
+
+/**
+ * Cooperative time slicing for long running tasks.
+ *
+ * An executor grants each task a time slice by running it under a
+ * TimeSliceGuard. Long running tasks poll shouldYield() and, once it returns
+ * true, give up the thread by re-adding their continuation to the executor,
+ * which lets the tasks queued meanwhile run. Coroutines can do both at once
+ * with co_await folly::coro::co_reschedule_if_should_yield.
+ *
+ * Outside of a time slice shouldYield() always returns false.
+ *
+ * void process(std::vector<Item> items, size_t begin) {
+ *   for (auto i = begin; i < items.size(); ++i) {
+ *     if (folly::shouldYield()) {
+ *       executor->add([=] { process(std::move(items), i); });
+ *       return;
+ *     }
+ *     processItem(items[i]);
+ *   }
+ * }
+ */
+
+namespace folly {
+
+namespace detail {
+// The default value, the epoch, means no time slice.
+FOLLY_EXPORT FOLLY_ALWAYS_INLINE std::chrono::steady_clock::time_point&
+timeSliceDeadline() noexcept {
+  static thread_local std::chrono::steady_clock::time_point deadline;
+  return deadline;
+}
+} // namespace detail
+
+/**
+ * Returns true if the time slice of the task running on the calling thread
+ * has expired. Costs a thread-local read if there is no time slice, and a
+ * read of the steady clock otherwise.
+ */
+inline bool shouldYield() noexcept {
+  auto deadline = detail::timeSliceDeadline();
+  return deadline != std::chrono::steady_clock::time_point{} &&
+      std::chrono::steady_clock::now() >= deadline;
+}
+
+/**
+ * Grants a time slice to the code run in its scope. A zero time slice means no
+ * time slice. Nested guards override the outer time slice until destroyed.
+ */
+class TimeSliceGuard {
+ public:
+  explicit TimeSliceGuard(std::chrono::nanoseconds timeSlice) noexcept
+      : prevDeadline_(detail::timeSliceDeadline()) {
+    detail::timeSliceDeadline() = timeSlice > std::chrono::nanoseconds::zero()
+        ? std::chrono::steady_clock::now() + timeSlice
+        : std::chrono::steady_clock::time_point{};
+  }
+
+  ~TimeSliceGuard() { detail::timeSliceDeadline() = prevDeadline_; }
+
+  TimeSliceGuard(const TimeSliceGuard&) = delete;
+  TimeSliceGuard& operator=(const TimeSliceGuard&) = delete;
+
+ private:
+  const std::chrono::steady_clock::time_point prevDeadline_;
+};
+
+} // namespace folly
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/WheelFunctionScheduler.h>
+
+#include <limits>
+#include <random>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/Random.h>
+#include <folly/ScopeGuard.h>
+#include <folly/String.h>
+#include <folly/lang/Bits.h>
+#include <folly/system/ThreadName.h>
+
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace folly {
+
+namespace {
+
+struct UniformDistributionFunctor {
+  std::default_random_engine generator;
+  std::uniform_int_distribution<microseconds::rep> dist;
+
+  UniformDistributionFunctor(microseconds minInterval, microseconds maxInterval)
+      : generator(Random::rand32()),
+        dist(minInterval.count(), maxInterval.count()) {}
+
+  microseconds operator()() { return microseconds(dist(generator)); }
+};
+
+// Distance from slot `from` to the first set slot at or after it, wrapping
+// around, or -1 if no slot is set.
+template <size_t N>
+int firstSetFrom(const std::array<uint64_t, N>& bits, unsigned from) {
+  constexpr unsigned kSlots = N * 64;
+  const uint64_t fromMask = ~uint64_t(0) << (from % 64);
+  for (unsigned i = 0; i <= N; ++i) {
+    auto idx = (from / 64 + i) % N;
+    auto word = bits[idx];
+    if (i == 0) {
+      word &= fromMask;
+    } else if (i == N) {
+      word &= ~fromMask;
+    }
+    if (word) {
+      auto slot = idx * 64 + findFirstSet(word) - 1;
+      return static_cast<int>((slot + kSlots - from) % kSlots);
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+WheelFunctionScheduler::WheelFunctionScheduler(
+    Executor::KeepAlive<> executor, Options options)
+    : options_(std::move(options)), executor_(std::move(executor)) {
+  if (options_.tick <= microseconds::zero()) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: tick must be positive");
+  }
+}
+
+WheelFunctionScheduler::~WheelFunctionScheduler() {
+  shutdown();
+  std::unique_lock lock(mutex_);
+  inFlightCv_.wait(lock, [&] { return inFlight_ == 0; });
+  clearWheel();
+}
+
+void WheelFunctionScheduler::addFunction(
+    Function<void()>&& cb,
+    microseconds interval,
+    StringPiece nameID,
+    microseconds startDelay) {
+  if (interval < microseconds::zero()) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: time interval must be non-negative");
+  }
+  addFunctionInternal(
+      std::move(cb), [interval] { return interval; }, nameID, startDelay);
+}
+
+void WheelFunctionScheduler::addFunctionUniformDistribution(
+    Function<void()>&& cb,
+    microseconds minInterval,
+    microseconds maxInterval,
+    StringPiece nameID,
+    microseconds startDelay) {
+  if (minInterval > maxInterval) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: "
+        "min time interval must be less or equal than max interval");
+  }
+  if (minInterval < microseconds::zero()) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: time interval must be non-negative");
+  }
+  addFunctionInternal(
+      std::move(cb),
+      UniformDistributionFunctor(minInterval, maxInterval),
+      nameID,
+      startDelay);
+}
+
+void WheelFunctionScheduler::addFunctionOnce(
+    Function<void()>&& cb, StringPiece nameID, microseconds startDelay) {
+  addFunctionInternal(std::move(cb), nullptr, nameID, startDelay);
+}
+
+void WheelFunctionScheduler::addFunctionInternal(
+    Function<void()>&& cb,
+    Function<microseconds()>&& interval,
+    StringPiece nameID,
+    microseconds startDelay) {
+  if (!cb) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: Scheduled function must be set");
+  }
+  if (startDelay < microseconds::zero()) {
+    throw std::invalid_argument(
+        "WheelFunctionScheduler: start delay must be non-negative");
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->cb = std::move(cb);
+  entry->interval = std::move(interval);
+  entry->name = nameID.str();
+  entry->startDelay = startDelay;
+
+  std::lock_guard lock(mutex_);
+  auto [it, inserted] = functions_.emplace(entry->name, entry);
+  if (!inserted) {
+    throw std::invalid_argument(to<std::string>(
+        "WheelFunctionScheduler: a function named \"",
+        nameID,
+        "\" already exists"));
+  }
+  if (running_) {
+    schedule(*entry, steady_clock::now() + startDelay);
+  }
+}
+
+bool WheelFunctionScheduler::cancelFunction(StringPiece nameID) {
+  std::lock_guard lock(mutex_);
+  auto it = functions_.find(nameID);
+  if (it == functions_.end()) {
+    return false;
+  }
+  it->second->cancelled = true;
+  remove(*it->second);
+  functions_.erase(it);
+  return true;
+}
+
+void WheelFunctionScheduler::cancelAllFunctions() {
+  std::lock_guard lock(mutex_);
+  for (auto& [_, entry] : functions_) {
+    entry->cancelled = true;
+  }
+  clearWheel();
+  functions_.clear();
+}
+
+bool WheelFunctionScheduler::start() {
+  std::lock_guard lock(mutex_);
+  if (running_) {
+    return false;
+  }
+  VLOG(1) << "Starting WheelFunctionScheduler with " << functions_.size()
+          << " functions.";
+  clearWheel();
+  epoch_ = steady_clock::now();
+  curTick_ = 0;
+  wakeTick_ = 0;
+  for (auto& [_, entry] : functions_) {
+    // Functions still running from before the last shutdown are scheduled
+    // when they return.
+    if (!entry->running) {
+      schedule(*entry, epoch_ + entry->startDelay);
+    }
+  }
+  running_ = true;
+  thread_ = std::thread([this] { run(); });
+  return true;
+}
+
+bool WheelFunctionScheduler::shutdown() {
+  {
+    std::lock_guard lock(mutex_);
+    if (!running_) {
+      return false;
+    }
+    running_ = false;
+  }
+  wakeCv_.notify_one();
+  thread_.join();
+  return true;
+}
+
+size_t WheelFunctionScheduler::numFunctions() const {
+  std::lock_guard lock(mutex_);
+  return functions_.size();
+}
+
+void WheelFunctionScheduler::run() {
+  setThreadName(options_.threadName);
+
+  std::vector<std::shared_ptr<Entry>> due;
+  std::unique_lock lock(mutex_);
+  while (running_) {
+    auto now = steady_clock::now();
+    expire(tickAt(now), due);
+    if (!due.empty()) {
+      for (auto& entry : due) {
+        entry->running = true;
+        entry->lastStart = now;
+      }
+      inFlight_ += due.size();
+      lock.unlock();
+      for (auto& entry : due) {
+        dispatch(std::move(entry));
+      }
+      due.clear();
+      lock.lock();
+      continue;
+    }
+
+    wakeTick_ = nextEventTick();
+    if (wakeTick_ == std::numeric_limits<int64_t>::max()) {
+      wakeCv_.wait(lock);
+    } else {
+      wakeCv_.wait_until(lock, epoch_ + options_.tick * wakeTick_);
+    }
+  }
+}
+
+void WheelFunctionScheduler::dispatch(std::shared_ptr<Entry> entry) {
+  auto guard = makeGuard([this, entry] { finishFunction(entry); });
+  if (!executor_) {
+    runFunction(*entry);
+    return;
+  }
+  // The guard also finishes the run if the executor drops it.
+  executor_->add(
+      [this, entry = std::move(entry), guard = std::move(guard)]() mutable {
+        runFunction(*entry);
+      });
+}
+
+void WheelFunctionScheduler::runFunction(Entry& entry) {
+  entry.lastStart = steady_clock::now();
+  try {
+    VLOG(5) << "Now running " << entry.name;
+    entry.cb();
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Error running the scheduled function <" << entry.name
+               << ">: " << exceptionStr(ex);
+  }
+}
+
+void WheelFunctionScheduler::finishFunction(
+    const std::shared_ptr<Entry>& entry) {
+  std::lock_guard lock(mutex_);
+  entry->running = false;
+  if (!entry->cancelled) {
+    if (!entry->interval) {
+      entry->cancelled = true;
+      functions_.erase(entry->name);
+    } else if (running_) {
+      schedule(*entry, entry->lastStart + entry->interval());
+    }
+  }
+  if (--inFlight_ == 0) {
+    inFlightCv_.notify_all();
+  }
+}
+
+int64_t WheelFunctionScheduler::tickAt(steady_clock::time_point time) const {
+  auto delta = nanoseconds(time - epoch_).count();
+  return delta <= 0 ? 0 : delta / nanoseconds(options_.tick).count();
+}
+
+void WheelFunctionScheduler::schedule(
+    Entry& entry, steady_clock::time_point time) {
+  // Round up, so that functions never run early.
+  auto tickNs = nanoseconds(options_.tick).count();
+  auto delta = nanoseconds(time - epoch_).count();
+  entry.expireTick = delta <= 0 ? 0 : (delta + tickNs - 1) / tickNs;
+  insert(entry);
+  if (entry.expireTick < wakeTick_) {
+    wakeCv_.notify_one();
+  }
+}
+
+void WheelFunctionScheduler::insert(Entry& entry) {
+  auto tick = std::max(entry.expireTick, curTick_);
+  auto diff = tick - curTick_;
+  unsigned level = 0;
+  while (level < kWheelLevels &&
+         diff >= (int64_t(1) << (kWheelBits * (level + 1)))) {
+    ++level;
+  }
+  unsigned slot;
+  if (level < kWheelLevels) {
+    slot = (tick >> (kWheelBits * level)) & kWheelMask;
+  } else {
+    // Beyond the range of the wheel: park the entry in the last slot of the
+    // top level, it is inserted again when that slot cascades.
+    level = kWheelLevels - 1;
+    slot = ((curTick_ >> (kWheelBits * level)) + kWheelMask) & kWheelMask;
+  }
+  entry.level = static_cast<uint8_t>(level);
+  entry.slot = static_cast<uint8_t>(slot);
+  wheel_[level][slot].push_back(entry);
+  bitmaps_[level][slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void WheelFunctionScheduler::remove(Entry& entry) {
+  if (!entry.hook.is_linked()) {
+    return;
+  }
+  entry.hook.unlink();
+  if (wheel_[entry.level][entry.slot].empty()) {
+    bitmaps_[entry.level][entry.slot / 64] &=
+        ~(uint64_t(1) << (entry.slot % 64));
+  }
+}
+
+void WheelFunctionScheduler::cascade(int64_t tick) {
+  // Higher levels first, their entries may move to the next lower slot that
+  // cascades on this tick.
+  for (unsigned level = kWheelLevels - 1; level > 0; --level) {
+    auto shift = kWheelBits * level;
+    if (tick & ((int64_t(1) << shift) - 1)) {
+      continue;
+    }
+    auto slot = (tick >> shift) & kWheelMask;
+    EntryList entries;
+    entries.swap(wheel_[level][slot]);
+    bitmaps_[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    while (!entries.empty()) {
+      auto& entry = entries.front();
+      entries.pop_front();
+      insert(entry);
+    }
+  }
+}
+
+int64_t WheelFunctionScheduler::nextEventTick() const {
+  auto next = std::numeric_limits<int64_t>::max();
+  if (auto d = firstSetFrom(bitmaps_[0], curTick_ & kWheelMask); d >= 0) {
+    next = curTick_ + d;
+  }
+  for (unsigned level = 1; level < kWheelLevels; ++level) {
+    auto shift = kWheelBits * level;
+    // Index of the next cascade of this level.
+    auto index = curTick_ >> shift;
+    if (curTick_ & ((int64_t(1) << shift) - 1)) {
+      ++index;
+    }
+    if (auto d = firstSetFrom(bitmaps_[level], index & kWheelMask); d >= 0) {
+      next = std::min(next, (index + d) << shift);
+    }
+  }
+  return next;
+}
+
+void WheelFunctionScheduler::expire(
+    int64_t nowTick, std::vector<std::shared_ptr<Entry>>& due) {
+  // Jumps from event to event rather than walking every tick, so that an
+  // idle or sparse wheel costs nothing.
+  while (curTick_ <= nowTick) {
+    auto next = nextEventTick();
+    if (next > nowTick) {
+      curTick_ = nowTick + 1;
+      return;
+    }
+    curTick_ = next;
+    cascade(curTick_);
+    auto slot = curTick_ & kWheelMask;
+    auto& entries = wheel_[0][slot];
+    bitmaps_[0][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    while (!entries.empty()) {
+      auto& entry = entries.front();
+      entries.pop_front();
+      due.push_back(entry.shared_from_this());
+    }
+    ++curTick_;
+  }
+}
+
+void WheelFunctionScheduler::clearWheel() {
+  for (auto& level : wheel_) {
+    for (auto& entries : level) {
+      entries.clear();
+    }
+  }
+  bitmaps_ = {};
+}
+
+} // namespace folly
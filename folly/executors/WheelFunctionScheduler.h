@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/Range.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/IntrusiveList.h>
+
+namespace folly {
+
+/**
+ * Schedules functions to run periodically, like FunctionScheduler, but keeps
+ * them in a hierarchical timer wheel instead of a heap, so that adding,
+ * rescheduling and cancelling a function are O(1) whatever the number of
+ * functions. This suits hundreds of thousands of periodic functions with
+ * jittered intervals, where FunctionScheduler spends its time in heap
+ * operations under its lock.
+ *
+ *   WheelFunctionScheduler fs(getKeepAliveToken(pool));
+ *   fs.addFunctionUniformDistribution(
+ *       [&] { refresh(key); }, seconds(9), seconds(11), key);
+ *   fs.start();
+ *   ........
+ *   fs.cancelFunction(key);
+ *   fs.shutdown();
+ *
+ * Time is divided into ticks of Options::tick, the resolution of the
+ * scheduler: a function never runs before its due time, and runs within the
+ * tick after it. The wheel has 4 levels of 256 slots, as in HHWheelTimer;
+ * the scheduler thread only wakes up for the next non-empty slot, and
+ * dispatches all the functions due in it at once.
+ *
+ * Due functions are added to the given executor, or run on the scheduler
+ * thread if there is none. A function is never run concurrently with
+ * itself: its next run is scheduled once the current one returns, interval
+ * after it started, as FunctionScheduler does when it is not steady.
+ */
+class WheelFunctionScheduler {
+ public:
+  struct Options {
+    Options() {}
+    // Resolution of the scheduler.
+    std::chrono::microseconds tick = std::chrono::milliseconds(1);
+    std::string threadName = "WheelFuncSched";
+  };
+
+  explicit WheelFunctionScheduler(
+      Executor::KeepAlive<> executor = {}, Options options = Options());
+
+  /**
+   * Shuts the scheduler down, and waits for the runs dispatched to the
+   * executor to complete, or to be destroyed if the executor drops them.
+   */
+  ~WheelFunctionScheduler();
+
+  /**
+   * Adds a function run every interval, starting after startDelay. As with
+   * FunctionScheduler, functions added before start() are scheduled by
+   * start(), and each function must have a unique name.
+   *
+   * Throws std::invalid_argument on error.
+   */
+  void addFunction(
+      Function<void()>&& cb,
+      std::chrono::microseconds interval,
+      StringPiece nameID = StringPiece(),
+      std::chrono::microseconds startDelay = std::chrono::microseconds(0));
+
+  /**
+   * Adds a function run at intervals uniformly distributed in
+   * [minInterval, maxInterval], which spreads out functions added together.
+   */
+  void addFunctionUniformDistribution(
+      Function<void()>&& cb,
+      std::chrono::microseconds minInterval,
+      std::chrono::microseconds maxInterval,
+      StringPiece nameID,
+      std::chrono::microseconds startDelay);
+
+  /**
+   * Adds a function run once, after startDelay.
+   */
+  void addFunctionOnce(
+      Function<void()>&& cb,
+      StringPiece nameID = StringPiece(),
+      std::chrono::microseconds startDelay = std::chrono::microseconds(0));
+
+  /**
+   * Cancels the function with the given name. A run in progress completes,
+   * but the function is not run again. Returns false if there is no such
+   * function.
+   */
+  bool cancelFunction(StringPiece nameID);
+
+  void cancelAllFunctions();
+
+  /**
+   * Starts the scheduler thread. Returns false if it is already running.
+   */
+  bool start();
+
+  /**
+   * Stops the scheduler thread. Runs in progress complete, and the functions
+   * are kept, to be scheduled again by start(). Returns false if the
+   * scheduler was not running.
+   */
+  bool shutdown();
+
+  size_t numFunctions() const;
+
+ private:
+  static constexpr unsigned kWheelBits = 8;
+  static constexpr unsigned kWheelSize = 1u << kWheelBits;
+  static constexpr unsigned kWheelMask = kWheelSize - 1;
+  static constexpr unsigned kWheelLevels = 4;
+
+  struct Entry : std::enable_shared_from_this<Entry> {
+    IntrusiveListHook hook;
+    Function<void()> cb;
+    // Empty for functions run once.
+    Function<std::chrono::microseconds()> interval;
+    std::string name;
+    std::chrono::microseconds startDelay;
+    int64_t expireTick = 0;
+    // Position in the wheel while the hook is linked.
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    std::chrono::steady_clock::time_point lastStart;
+    bool running = false;
+    bool cancelled = false;
+  };
+
+  using EntryList = IntrusiveList<Entry, &Entry::hook>;
+  using Bitmap = std::array<uint64_t, kWheelSize / 64>;
+
+  void addFunctionInternal(
+      Function<void()>&& cb,
+      Function<std::chrono::microseconds()>&& interval,
+      StringPiece nameID,
+      std::chrono::microseconds startDelay);
+
+  void run();
+  void dispatch(std::shared_ptr<Entry> entry);
+  void runFunction(Entry& entry);
+  void finishFunction(const std::shared_ptr<Entry>& entry);
+
+  int64_t tickAt(std::chrono::steady_clock::time_point time) const;
+  // Schedules the entry at the given time, and wakes the scheduler thread up
+  // if it is due before the time it sleeps until.
+  void schedule(Entry& entry, std::chrono::steady_clock::time_point time);
+  void insert(Entry& entry);
+  void remove(Entry& entry);
+  void cascade(int64_t tick);
+  // Tick of the next non-empty slot of level 0, or of the next cascade of a
+  // non-empty slot of a higher level. INT64_MAX if the wheel is empty.
+  int64_t nextEventTick() const;
+  void expire(int64_t nowTick, std::vector<std::shared_ptr<Entry>>& due);
+  void clearWheel();
+
+  const Options options_;
+  const Executor::KeepAlive<> executor_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wakeCv_;
+  std::condition_variable inFlightCv_;
+  F14FastMap<std::string, std::shared_ptr<Entry>> functions_;
+  std::array<std::array<EntryList, kWheelSize>, kWheelLevels> wheel_;
+  std::array<Bitmap, kWheelLevels> bitmaps_{};
+  std::chrono::steady_clock::time_point epoch_;
+  // Next tick to process.
+  int64_t curTick_ = 0;
+  // Tick the scheduler thread sleeps until.
+  int64_t wakeTick_ = 0;
+  size_t inFlight_ = 0;
+  bool running_ = false;
+  std::thread thread_;
+};
+
+} // namespace folly
@@ -17,13 +17,16 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <exception>
 #include <stdexcept>
+#include <type_traits>
 
 #include <glog/logging.h>
 
 #include <folly/CPortability.h>
 #include <folly/Optional.h>
+#include <folly/container/span.h>
 
 namespace folly {
 
@@ -41,6 +44,29 @@ struct BlockingQueueAddResult {
   bool reusedThread;
 };
 
+namespace detail {
+
+// Posts n units to a LifoSem-like semaphore, returning whether there were
+// enough waiters to consume all of them. LifoSem::post(n) does not report
+// that, so hand off to waiters one at a time and post the remainder at once.
+template <class Semaphore>
+BlockingQueueAddResult postBlockingQueueSemaphore(Semaphore& sem, uint32_t n) {
+  if constexpr (std::is_void_v<decltype(sem.post(n))>) {
+    while (n > 0 && sem.tryPost()) {
+      --n;
+    }
+    if (n == 0) {
+      return true;
+    }
+    sem.post(n);
+    return false;
+  } else {
+    return sem.post(n);
+  }
+}
+
+} // namespace detail
+
 template <class T>
 class BlockingQueue {
  public:
@@ -55,6 +81,16 @@ class BlockingQueue {
       T item, int8_t /* priority */) {
     return add(std::move(item));
   }
+  // Adds all items, moving them out of the span. Returns true only if existing
+  // threads were able to work on all of them. Implementations may override
+  // this to enqueue the whole batch with a single wakeup.
+  virtual BlockingQueueAddResult addBatch(span<T> items) {
+    bool reusedThread = true;
+    for (auto& item : items) {
+      reusedThread &= add(std::move(item)).reusedThread;
+    }
+    return reusedThread;
+  }
   virtual uint8_t getNumPriorities() { return 1; }
   virtual T take() = 0;
   virtual folly::Optional<T> try_take_for(std::chrono::milliseconds time) = 0;
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <limits>
+#include <thread>
+
+#include <folly/Executor.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/concurrency/container/MultiQueue.h>
+#include <folly/executors/task_queue/BlockingQueue.h>
+#include <folly/synchronization/LifoSem.h>
+
+namespace folly {
+
+/**
+ * An unbounded priority BlockingQueue backed by a MultiQueue.
+ *
+ * Every int8_t priority is a level of its own, higher first, instead of
+ * being folded into a handful of queues as in PriorityLifoSemMPMCQueue and
+ * PriorityUnboundedBlockingQueue, whose cost grows with the number of
+ * levels. The ordering is relaxed: a task may be taken ahead of a few tasks
+ * of higher priority, which were queued on heaps other than the two a
+ * consumer looked at. In exchange, producers and consumers spread over
+ * many heaps and rarely contend.
+ *
+ * The lowest priority, LO_PRI, is kept apart in a FIFO that is only taken
+ * from when the heaps are empty. This keeps "after everything else" exact,
+ * which CPUThreadPoolExecutor::join() relies on: the poison tasks it queues
+ * at LO_PRI must not overtake the tasks queued before them.
+ */
+template <class T, class Semaphore = folly::LifoSem>
+class MultiQueueBlockingQueue : public BlockingQueue<T> {
+ public:
+  /// numQueues is the number of heaps, 0 for two per hardware thread.
+  explicit MultiQueueBlockingQueue(
+      size_t numQueues = 0,
+      const typename Semaphore::Options& semaphoreOptions = {})
+      : sem_(semaphoreOptions), queue_(numQueues) {}
+
+  uint8_t getNumPriorities() override {
+    return std::numeric_limits<uint8_t>::max();
+  }
+
+  // Add at medium priority by default
+  BlockingQueueAddResult add(T item) override {
+    return addWithPriority(std::move(item), folly::Executor::MID_PRI);
+  }
+
+  BlockingQueueAddResult addWithPriority(T item, int8_t priority) override {
+    if (priority == folly::Executor::LO_PRI) {
+      lowest_.enqueue(std::move(item));
+    } else {
+      queue_.push(priority, std::move(item));
+    }
+    return sem_.post();
+  }
+
+  BlockingQueueAddResult addBatch(span<T> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    queue_.pushBatch(folly::Executor::MID_PRI, items);
+    return detail::postBlockingQueueSemaphore(
+        sem_, static_cast<uint32_t>(items.size()));
+  }
+
+  T take() override {
+    sem_.wait();
+    return dequeueAcquired();
+  }
+
+  folly::Optional<T> try_take_for(std::chrono::milliseconds time) override {
+    if (!sem_.try_wait_for(time)) {
+      return folly::none;
+    }
+    return dequeueAcquired();
+  }
+
+  size_t size() override { return queue_.size() + lowest_.size(); }
+
+ private:
+  // Called after a semaphore unit has been acquired, so an item is present
+  // somewhere, though a concurrent consumer may transiently beat us to it.
+  T dequeueAcquired() {
+    while (true) {
+      if (auto item = queue_.tryPop()) {
+        return std::move(*item);
+      }
+      if (auto item = lowest_.try_dequeue()) {
+        return std::move(*item);
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  Semaphore sem_;
+  MultiQueue<T, int8_t> queue_;
+  UMPMCQueue<T, false, 6> lowest_;
+};
+
+} // namespace folly
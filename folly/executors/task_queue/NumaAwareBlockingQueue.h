@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <thread>
+
+#include <glog/logging.h>
+
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/executors/task_queue/BlockingQueue.h>
+#include <folly/executors/thread_factory/NumaThreadFactory.h>
+#include <folly/synchronization/LifoSem.h>
+
+namespace folly {
+
+/**
+ * An unbounded BlockingQueue keeping one shard per NUMA node.
+ *
+ * add() enqueues into the shard of the node the caller is running on.
+ * Consumers dequeue from the shard of their own node and only spill over to
+ * the shards of other nodes when their own is empty, i.e. when there is a
+ * backlog on a remote node that its own consumers are not keeping up with.
+ *
+ * This is meant to be paired with a NumaThreadFactory, which pins consumer
+ * threads to their nodes; without pinning the node of a consumer is wherever
+ * the scheduler happens to run it. A single semaphore is shared by all
+ * shards, so a wakeup never waits on a node that has no consumers.
+ */
+template <class T, class Semaphore = folly::LifoSem>
+class NumaAwareBlockingQueue : public BlockingQueue<T> {
+ public:
+  explicit NumaAwareBlockingQueue(
+      size_t numNodes = NumaThreadFactory::systemNumNodes(),
+      const typename Semaphore::Options& semaphoreOptions = {})
+      : numNodes_(std::max(size_t(1), numNodes)),
+        sem_(semaphoreOptions),
+        shards_(std::make_unique<Shard[]>(numNodes_)) {}
+
+  BlockingQueueAddResult add(T item) override {
+    shards_[NumaThreadFactory::currentNode(numNodes_)].enqueue(
+        std::move(item));
+    return sem_.post();
+  }
+
+  BlockingQueueAddResult addBatch(span<T> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    auto& shard = shards_[NumaThreadFactory::currentNode(numNodes_)];
+    for (auto& item : items) {
+      shard.enqueue(std::move(item));
+    }
+    return detail::postBlockingQueueSemaphore(
+        sem_, static_cast<uint32_t>(items.size()));
+  }
+
+  T take() override {
+    sem_.wait();
+    return dequeueAcquired();
+  }
+
+  folly::Optional<T> try_take_for(std::chrono::milliseconds time) override {
+    if (!sem_.try_wait_for(time)) {
+      return folly::none;
+    }
+    return dequeueAcquired();
+  }
+
+  size_t size() override {
+    size_t n = 0;
+    for (size_t i = 0; i < numNodes_; ++i) {
+      n += shards_[i].size();
+    }
+    return n;
+  }
+
+  size_t numNodes() const { return numNodes_; }
+
+  /// Size of the shard of the given node.
+  size_t sizeOfNode(size_t node) { return shards_[node].size(); }
+
+ private:
+  using Shard = UMPMCQueue<T, false, 6>;
+
+  // Called after a semaphore unit has been acquired, so an item is present in
+  // some shard, though a concurrent consumer may transiently beat us to it.
+  T dequeueAcquired() {
+    auto local = NumaThreadFactory::currentNode(numNodes_);
+    while (true) {
+      for (size_t i = 0; i < numNodes_; ++i) {
+        if (auto item = shards_[(local + i) % numNodes_].try_dequeue()) {
+          return std::move(*item);
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  const size_t numNodes_;
+  Semaphore sem_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace folly
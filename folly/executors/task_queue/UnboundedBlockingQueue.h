@@ -34,6 +34,17 @@ class UnboundedBlockingQueue : public BlockingQueue<T> {
     return sem_.post();
   }
 
+  BlockingQueueAddResult addBatch(span<T> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    for (auto& item : items) {
+      queue_.enqueue(std::move(item));
+    }
+    return detail::postBlockingQueueSemaphore(
+        sem_, static_cast<uint32_t>(items.size()));
+  }
+
   T take() override {
     sem_.wait();
     return queue_.dequeue();
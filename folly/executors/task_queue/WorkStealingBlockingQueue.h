@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <glog/logging.h>
+
+#include <folly/Random.h>
+#include <folly/ThreadLocal.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/executors/task_queue/BlockingQueue.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <folly/portability/Asm.h>
+#include <folly/synchronization/LifoSem.h>
+
+namespace folly {
+
+namespace detail {
+
+/**
+ * Fixed-capacity Chase-Lev work-stealing deque of pointers.
+ *
+ * Only the owning thread may call push() and pop(), which operate on the
+ * bottom of the deque in LIFO order. Any thread may call steal(), which takes
+ * from the top in FIFO order. The memory orderings follow "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+ */
+template <typename T, template <typename> class Atom = std::atomic>
+class ChaseLevDeque {
+ public:
+  explicit ChaseLevDeque(size_t capacity)
+      : mask_(nextPowTwo(capacity < 2 ? size_t(2) : capacity) - 1),
+        buffer_(new Atom<T*>[mask_ + 1]) {}
+
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  /// Owner only. Returns false if the deque is full.
+  bool push(T* item) noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_acquire);
+    if (b - t > static_cast<int64_t>(mask_)) {
+      return false;
+    }
+    buffer_[b & mask_].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Owner only. Returns nullptr if the deque is empty or the last element
+  /// was lost to a concurrent steal().
+  T* pop() noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+    if (t == b) {
+      if (!top_.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /// Any thread. Returns nullptr if the deque is empty or if it lost a race
+  /// with another thief or the owner.
+  T* steal() noexcept {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /// Approximate number of elements, safe to call from any thread.
+  size_t size() const noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+ private:
+  alignas(hardware_destructive_interference_size) Atom<int64_t> top_{0};
+  alignas(hardware_destructive_interference_size) Atom<int64_t> bottom_{0};
+  const size_t mask_;
+  const std::unique_ptr<Atom<T*>[]> buffer_;
+};
+
+} // namespace detail
+
+/**
+ * A BlockingQueue that gives each consumer thread its own work-stealing deque.
+ *
+ * Items added from a thread that consumes from this queue (e.g. a task running
+ * on a CPUThreadPoolExecutor worker that schedules a subtask) are pushed onto
+ * that thread's local deque, without touching any shared cache line other
+ * than the semaphore. Items added from any other thread go to a shared
+ * injection queue. A consumer first looks at its own deque (LIFO, for cache
+ * locality), then at the injection queue, and finally steals (FIFO) from the
+ * deques of the other consumers, starting at a random victim. To prevent the
+ * injection queue from starving when workers keep spawning local work, it is
+ * checked first on every globalCheckInterval-th take.
+ *
+ * Consumer threads claim one of maxWorkers deque slots on their first take;
+ * when a thread exits its slot is released and any items still in its deque
+ * remain available to thieves and to the slot's next owner. Threads that
+ * cannot claim a slot fall back to the injection queue and stealing.
+ *
+ * Priorities are not supported; addWithPriority() behaves like add().
+ */
+template <class T, class Semaphore = folly::LifoSem>
+class WorkStealingBlockingQueue : public BlockingQueue<T> {
+ public:
+  struct Options {
+    Options() {}
+
+    // Maximum number of consumer threads that get a local deque.
+    size_t maxWorkers{256};
+    // Capacity of each local deque; overflow goes to the injection queue.
+    size_t localCapacity{1024};
+    // Every this many takes, the injection queue is checked before the local
+    // deque.
+    uint32_t globalCheckInterval{61};
+    typename Semaphore::Options semaphoreOptions{};
+  };
+
+  explicit WorkStealingBlockingQueue(const Options& options = {})
+      : options_(options),
+        sem_(options.semaphoreOptions),
+        slots_(makeSlots(options_.maxWorkers, options_.localCapacity)) {}
+
+  ~WorkStealingBlockingQueue() override {
+    local_.reset();
+    for (size_t i = 0; i < options_.maxWorkers; ++i) {
+      while (T* item = slots_[i]->deque.steal()) {
+        delete item;
+      }
+    }
+  }
+
+  BlockingQueueAddResult add(T item) override {
+    if (auto* worker = local_.get(); worker && worker->slot) {
+      auto ptr = std::make_unique<T>(std::move(item));
+      if (worker->slot->deque.push(ptr.get())) {
+        ptr.release();
+        return sem_.post();
+      }
+      item = std::move(*ptr);
+    }
+    global_.enqueue(std::move(item));
+    return sem_.post();
+  }
+
+  BlockingQueueAddResult addBatch(span<T> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    auto* worker = local_.get();
+    for (auto& item : items) {
+      if (worker && worker->slot) {
+        auto ptr = std::make_unique<T>(std::move(item));
+        if (worker->slot->deque.push(ptr.get())) {
+          ptr.release();
+          continue;
+        }
+        item = std::move(*ptr);
+      }
+      global_.enqueue(std::move(item));
+    }
+    return detail::postBlockingQueueSemaphore(
+        sem_, static_cast<uint32_t>(items.size()));
+  }
+
+  T take() override {
+    sem_.wait();
+    return takeAcquired();
+  }
+
+  folly::Optional<T> try_take_for(std::chrono::milliseconds time) override {
+    if (!sem_.try_wait_for(time)) {
+      return folly::none;
+    }
+    return takeAcquired();
+  }
+
+  size_t size() override {
+    size_t n = global_.size();
+    auto highWater = highWater_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < highWater; ++i) {
+      n += slots_[i]->deque.size();
+    }
+    return n;
+  }
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Slot {
+    explicit Slot(size_t capacity) : deque(capacity) {}
+
+    detail::ChaseLevDeque<T> deque;
+    std::atomic<bool> owned{false};
+  };
+
+  // Per-thread handle on the slot owned by the calling consumer thread, if
+  // any. Releases the slot when the thread exits or the queue is destroyed.
+  struct Worker {
+    explicit Worker(Slot* s) : slot(s) {}
+    ~Worker() {
+      if (slot) {
+        slot->owned.store(false, std::memory_order_release);
+      }
+    }
+
+    Slot* const slot;
+    uint32_t ticks{0};
+  };
+
+  static std::unique_ptr<std::unique_ptr<Slot>[]> makeSlots(
+      size_t n, size_t capacity) {
+    CHECK_GT(n, 0u) << "WorkStealingBlockingQueue needs at least one slot";
+    auto slots = std::make_unique<std::unique_ptr<Slot>[]>(n);
+    for (size_t i = 0; i < n; ++i) {
+      slots[i] = std::make_unique<Slot>(capacity);
+    }
+    return slots;
+  }
+
+  Worker& getOrRegisterWorker() {
+    if (auto* worker = local_.get()) {
+      return *worker;
+    }
+    Slot* claimed = nullptr;
+    for (size_t i = 0; i < options_.maxWorkers; ++i) {
+      bool expected = false;
+      if (!slots_[i]->owned.load(std::memory_order_relaxed) &&
+          slots_[i]->owned.compare_exchange_strong(
+              expected, true, std::memory_order_acq_rel)) {
+        claimed = slots_[i].get();
+        auto highWater = highWater_.load(std::memory_order_relaxed);
+        while (highWater < i + 1 &&
+               !highWater_.compare_exchange_weak(
+                   highWater, i + 1, std::memory_order_release)) {
+        }
+        break;
+      }
+    }
+    auto* worker = new Worker(claimed);
+    local_.reset(worker);
+    return *worker;
+  }
+
+  T* trySteal(const Slot* self) {
+    auto highWater = highWater_.load(std::memory_order_acquire);
+    if (highWater == 0) {
+      return nullptr;
+    }
+    auto start = folly::Random::rand32(static_cast<uint32_t>(highWater));
+    for (size_t i = 0; i < highWater; ++i) {
+      auto& victim = *slots_[(start + i) % highWater];
+      if (&victim == self) {
+        continue;
+      }
+      if (T* item = victim.deque.steal()) {
+        return item;
+      }
+    }
+    return nullptr;
+  }
+
+  static T unwrap(T* item) {
+    std::unique_ptr<T> owner(item);
+    return std::move(*owner);
+  }
+
+  // Called after a semaphore unit has been acquired, so an item is guaranteed
+  // to be present somewhere; individual attempts may still fail transiently
+  // because of races with other consumers.
+  T takeAcquired() {
+    auto& worker = getOrRegisterWorker();
+    auto* self = worker.slot;
+    bool globalFirst = options_.globalCheckInterval != 0 &&
+        ++worker.ticks % options_.globalCheckInterval == 0;
+    for (size_t spins = 0;; ++spins) {
+      if (globalFirst) {
+        if (auto item = global_.try_dequeue()) {
+          return std::move(*item);
+        }
+      }
+      if (self) {
+        if (T* item = self->deque.pop()) {
+          return unwrap(item);
+        }
+      }
+      if (!globalFirst) {
+        if (auto item = global_.try_dequeue()) {
+          return std::move(*item);
+        }
+      }
+      if (T* item = trySteal(self)) {
+        return unwrap(item);
+      }
+      if (spins < kSpinsBeforeYield) {
+        asm_volatile_pause();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  static constexpr size_t kSpinsBeforeYield = 64;
+
+  const Options options_;
+  Semaphore sem_;
+  UMPMCQueue<T, false, 6> global_;
+  const std::unique_ptr<std::unique_ptr<Slot>[]> slots_;
+  std::atomic<size_t> highWater_{0};
+  struct LocalTag {};
+  ThreadLocalPtr<Worker, LocalTag> local_;
+};
+
+} // namespace folly
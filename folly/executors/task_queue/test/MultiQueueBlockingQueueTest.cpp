@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/task_queue/MultiQueueBlockingQueue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(MultiQueueBlockingQueue, pushPop) {
+  MultiQueueBlockingQueue<int> q;
+  EXPECT_EQ(255, q.getNumPriorities());
+  q.add(42);
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ(42, q.take());
+  EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(1)).has_value());
+}
+
+TEST(MultiQueueBlockingQueue, priorities) {
+  MultiQueueBlockingQueue<int> q(1);
+  q.addWithPriority(0, Executor::LO_PRI);
+  q.addWithPriority(1, -3);
+  q.add(2);
+  q.addWithPriority(3, 42);
+  q.addWithPriority(4, Executor::HI_PRI);
+  // With a single heap the order is exact.
+  EXPECT_EQ(4, q.take());
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(0, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(MultiQueueBlockingQueue, lowestPriorityComesLast) {
+  MultiQueueBlockingQueue<int> q(16);
+  for (int i = 0; i < 100; ++i) {
+    q.addWithPriority(i, Executor::LO_PRI);
+  }
+  for (int i = 100; i < 1000; ++i) {
+    q.addWithPriority(i, int8_t(i % 255 - 127));
+  }
+  for (int i = 100; i < 1000; ++i) {
+    EXPECT_LE(100, q.take());
+  }
+  // In FIFO order once the other priorities are drained.
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, q.take());
+  }
+}
+
+TEST(MultiQueueBlockingQueue, addBatch) {
+  MultiQueueBlockingQueue<int> q;
+  std::vector<int> items = {1, 2, 3};
+  q.addBatch(items);
+  EXPECT_EQ(3, q.size());
+  int sum = 0;
+  for (int i = 0; i < 3; ++i) {
+    sum += q.take();
+  }
+  EXPECT_EQ(6, sum);
+}
+
+TEST(MultiQueueBlockingQueue, concurrentPushPop) {
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr int kPerProducer = 10000;
+  constexpr int kTotal = kProducers * kPerProducer;
+  MultiQueueBlockingQueue<int> q(8);
+  std::atomic<int> sum{0};
+  std::atomic<int> taken{0};
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kConsumers; ++c) {
+    // The order is relaxed, so a sentinel could overtake other items: stop
+    // once everything was taken instead.
+    threads.emplace_back([&] {
+      while (taken.load() < kTotal) {
+        if (auto v = q.try_take_for(std::chrono::milliseconds(1))) {
+          sum += *v;
+          ++taken;
+        }
+      }
+    });
+  }
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        q.addWithPriority(1, int8_t((i + p) % 256 - 128));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(kTotal, sum.load());
+  EXPECT_EQ(0, q.size());
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/task_queue/NumaAwareBlockingQueue.h>
+
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(NumaAwareBlockingQueue, pushPop) {
+  NumaAwareBlockingQueue<int> q;
+  EXPECT_GE(q.numNodes(), 1);
+  q.add(42);
+  EXPECT_EQ(42, q.take());
+  EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(1)).has_value());
+}
+
+TEST(NumaAwareBlockingQueue, addGoesToLocalNode) {
+  NumaAwareBlockingQueue<int> q(4);
+  EXPECT_EQ(4, q.numNodes());
+  q.add(1);
+  q.add(2);
+  EXPECT_EQ(2, q.size());
+  auto node = NumaThreadFactory::currentNode(4);
+  EXPECT_EQ(2, q.sizeOfNode(node));
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(NumaAwareBlockingQueue, concurrentPushPop) {
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr int kPerProducer = 10000;
+  NumaAwareBlockingQueue<int> q(2);
+  std::atomic<int> sum{0};
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      for (int v; (v = q.take()) >= 0;) {
+        sum += v;
+      }
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        q.add(1);
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    q.add(-1);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(kProducers * kPerProducer, sum.load());
+  EXPECT_EQ(0, q.size());
+}
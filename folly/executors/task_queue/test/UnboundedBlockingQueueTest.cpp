@@ -17,6 +17,7 @@
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
 
 #include <thread>
+#include <vector>
 
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Baton.h>
@@ -37,6 +38,18 @@ TEST(UnboundedBlockingQueue, size) {
   EXPECT_EQ(0, q.size());
 }
 
+TEST(UnboundedBlockingQueue, addBatch) {
+  UnboundedBlockingQueue<int> q;
+  std::vector<int> items{1, 2, 3};
+  EXPECT_FALSE(q.addBatch(items).reusedThread);
+  EXPECT_TRUE(q.addBatch({}).reusedThread);
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
 TEST(UnboundedBlockingQueue, concurrentPushPop) {
   UnboundedBlockingQueue<int> q;
   Baton<> b1, b2;
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/task_queue/WorkStealingBlockingQueue.h>
+
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+
+TEST(ChaseLevDeque, pushPopSteal) {
+  detail::ChaseLevDeque<int> d(4);
+  EXPECT_EQ(4, d.capacity());
+  int v[5] = {0, 1, 2, 3, 4};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(d.push(&v[i]));
+  }
+  EXPECT_FALSE(d.push(&v[4]));
+  EXPECT_EQ(4, d.size());
+  // Owner pops LIFO, thieves steal FIFO.
+  EXPECT_EQ(&v[3], d.pop());
+  EXPECT_EQ(&v[0], d.steal());
+  EXPECT_EQ(&v[2], d.pop());
+  EXPECT_EQ(&v[1], d.steal());
+  EXPECT_EQ(nullptr, d.pop());
+  EXPECT_EQ(nullptr, d.steal());
+  EXPECT_EQ(0, d.size());
+}
+
+TEST(ChaseLevDeque, concurrentSteal) {
+  constexpr int kItems = 100000;
+  constexpr int kThieves = 4;
+  detail::ChaseLevDeque<int> d(256);
+  std::vector<int> items(kItems);
+  std::vector<std::atomic<int>> seen(kItems);
+  std::atomic<int> taken{0};
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < kThieves; ++t) {
+    thieves.emplace_back([&] {
+      while (taken.load() < kItems) {
+        if (int* p = d.steal()) {
+          seen[p - items.data()]++;
+          taken++;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kItems; ++i) {
+    while (!d.push(&items[i])) {
+      if (int* p = d.pop()) {
+        seen[p - items.data()]++;
+        taken++;
+      }
+    }
+  }
+  while (int* p = d.pop()) {
+    seen[p - items.data()]++;
+    taken++;
+  }
+  for (auto& t : thieves) {
+    t.join();
+  }
+  EXPECT_EQ(kItems, taken.load());
+  for (auto& s : seen) {
+    EXPECT_EQ(1, s.load());
+  }
+}
+
+TEST(WorkStealingBlockingQueue, pushPop) {
+  WorkStealingBlockingQueue<int> q;
+  q.add(42);
+  EXPECT_EQ(42, q.take());
+  EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(1)).has_value());
+}
+
+TEST(WorkStealingBlockingQueue, size) {
+  WorkStealingBlockingQueue<int> q;
+  EXPECT_EQ(0, q.size());
+  q.add(42);
+  EXPECT_EQ(1, q.size());
+  q.take();
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, localLifo) {
+  WorkStealingBlockingQueue<int>::Options opts;
+  opts.globalCheckInterval = 0;
+  WorkStealingBlockingQueue<int> q(opts);
+  // The first take registers this thread as a consumer, so subsequent adds
+  // from it go to its local deque and are taken in LIFO order.
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  q.add(1);
+  q.add(2);
+  q.add(3);
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_EQ(1, q.take());
+}
+
+TEST(WorkStealingBlockingQueue, addBatch) {
+  WorkStealingBlockingQueue<int>::Options opts;
+  opts.globalCheckInterval = 0;
+  opts.localCapacity = 2;
+  WorkStealingBlockingQueue<int> q(opts);
+  std::vector<int> items{1, 2, 3};
+  // Not a consumer yet, so the batch goes to the injection queue.
+  q.addBatch(items);
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_EQ(3, q.take());
+  // Now a consumer: the batch fills the local deque and overflows.
+  items = {4, 5, 6};
+  q.addBatch(items);
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(5, q.take());
+  EXPECT_EQ(4, q.take());
+  EXPECT_EQ(6, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, steal) {
+  WorkStealingBlockingQueue<int> q;
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  for (int i = 1; i <= 3; ++i) {
+    q.add(i);
+  }
+  // Another consumer steals from the top of this thread's deque.
+  std::thread t([&] {
+    EXPECT_EQ(1, q.take());
+    EXPECT_EQ(2, q.take());
+  });
+  t.join();
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, noSlotFallsBackToGlobal) {
+  WorkStealingBlockingQueue<int>::Options opts;
+  opts.maxWorkers = 1;
+  WorkStealingBlockingQueue<int> q(opts);
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  std::thread t([&] {
+    // This consumer can't claim a slot, so its adds go to the shared queue.
+    q.add(1);
+    EXPECT_EQ(1, q.take());
+  });
+  t.join();
+}
+
+TEST(WorkStealingBlockingQueue, slotReleasedOnThreadExit) {
+  WorkStealingBlockingQueue<int>::Options opts;
+  opts.maxWorkers = 1;
+  WorkStealingBlockingQueue<int> q(opts);
+  std::thread([&] {
+    q.add(0);
+    EXPECT_EQ(0, q.take());
+    // Left behind in the deque when the thread exits.
+    q.add(1);
+  }).join();
+  EXPECT_EQ(1, q.take());
+  q.add(2);
+  EXPECT_EQ(2, q.take());
+}
+
+TEST(WorkStealingBlockingQueue, concurrentPushPop) {
+  constexpr int kConsumers = 4;
+  constexpr int kPerConsumer = 10000;
+  WorkStealingBlockingQueue<int> q;
+  std::atomic<int> sum{0};
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&] {
+      // Each consumer spawns local work from items taken off the queue; -1
+      // means stop.
+      while (true) {
+        int v = q.take();
+        if (v < 0) {
+          return;
+        }
+        if (v > 1) {
+          q.add(v / 2);
+          q.add(v - v / 2);
+        } else {
+          sum += v;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kPerConsumer; ++i) {
+    q.add(8);
+  }
+  while (sum.load() < 8 * kPerConsumer) {
+    std::this_thread::yield();
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    q.add(-1);
+  }
+  for (auto& t : consumers) {
+    t.join();
+  }
+  EXPECT_EQ(8 * kPerConsumer, sum.load());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, destroyWithPendingItems) {
+  auto q = std::make_unique<WorkStealingBlockingQueue<std::unique_ptr<int>>>();
+  q->add(std::make_unique<int>(0));
+  q->take();
+  q->add(std::make_unique<int>(1));
+  std::thread([&] { q->add(std::make_unique<int>(2)); }).join();
+  EXPECT_EQ(2, q->size());
+  q.reset();
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/CodelExecutor.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/ManualExecutor.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+using std::chrono::milliseconds;
+using std::this_thread::sleep_for;
+
+namespace {
+
+CodelExecutor::Options makeOptions(CodelExecutor::Policy policy) {
+  CodelExecutor::Options options;
+  options.codelOptions =
+      Codel::Options().setInterval(milliseconds(100)).setTargetDelay(
+          milliseconds(5));
+  options.policy = policy;
+  return options;
+}
+
+class CountingObserver : public ExecutionObserver {
+ public:
+  void starting(uintptr_t, CallbackType) noexcept override {}
+  void stopped(uintptr_t, CallbackType) noexcept override {}
+  void shed(uintptr_t, CallbackType callbackType) noexcept override {
+    EXPECT_EQ(CallbackType::Codel, callbackType);
+    ++numShed;
+  }
+
+  size_t numShed{0};
+};
+
+} // namespace
+
+TEST(CodelExecutorTest, NotOverloaded) {
+  ManualExecutor inner;
+  CodelExecutor executor(getKeepAliveToken(inner));
+  int ran = 0;
+  for (int i = 0; i < 10; ++i) {
+    executor.add([&] { ++ran; });
+    inner.run();
+  }
+  EXPECT_EQ(10, ran);
+  EXPECT_EQ(0, executor.getNumShed());
+  EXPECT_FALSE(executor.overloaded());
+}
+
+TEST(CodelExecutorTest, Reject) {
+  ManualExecutor inner;
+  CodelExecutor executor(
+      getKeepAliveToken(inner), makeOptions(CodelExecutor::Policy::Reject));
+  CountingObserver observer;
+  executor.addExecutionObserver(&observer);
+
+  std::vector<int> ran;
+  for (int i = 0; i < 3; ++i) {
+    executor.add([&ran, i] { ran.push_back(i); });
+  }
+  sleep_for(milliseconds(20));
+  EXPECT_EQ(1, inner.step());
+  // The minimum delay of the interval is above the target.
+  EXPECT_TRUE(executor.overloaded());
+  executor.add([&ran] { ran.push_back(-1); });
+  EXPECT_EQ(1, executor.getNumShed());
+
+  // The next interval is overloaded: the first task of the interval is not
+  // dropped, the next one is sloughed off when dequeued.
+  sleep_for(milliseconds(110));
+  EXPECT_EQ(2, inner.run());
+  EXPECT_EQ((std::vector<int>{0, 1}), ran);
+  EXPECT_EQ(2, executor.getNumShed());
+  EXPECT_EQ(2, observer.numShed);
+
+  // No task is dequeued in this interval and the next: the overload ends.
+  executor.removeExecutionObserver(&observer);
+  sleep_for(milliseconds(210));
+  EXPECT_FALSE(executor.overloaded());
+  executor.add([&ran] { ran.push_back(3); });
+  EXPECT_EQ(1, inner.run());
+  EXPECT_EQ((std::vector<int>{0, 1, 3}), ran);
+  EXPECT_EQ(2, executor.getNumShed());
+}
+
+TEST(CodelExecutorTest, Deprioritize) {
+  ManualExecutor inner;
+  CodelExecutor executor(
+      getKeepAliveToken(inner),
+      makeOptions(CodelExecutor::Policy::Deprioritize));
+
+  std::vector<int> ran;
+  for (int i = 0; i < 2; ++i) {
+    executor.add([&ran, i] { ran.push_back(i); });
+  }
+  sleep_for(milliseconds(20));
+  EXPECT_EQ(1, inner.step());
+  EXPECT_TRUE(executor.overloaded());
+  executor.add([&ran] { ran.push_back(10); });
+  executor.add([&ran] { ran.push_back(11); });
+  EXPECT_EQ(2, executor.getNumShed());
+
+  sleep_for(milliseconds(110));
+  EXPECT_FALSE(executor.overloaded());
+  executor.add([&ran] { ran.push_back(2); });
+  inner.drain();
+  // The deprioritized tasks yield to the others, and are never dropped.
+  EXPECT_EQ((std::vector<int>{0, 1, 10, 2, 11}), ran);
+  EXPECT_EQ(2, executor.getNumShed());
+}
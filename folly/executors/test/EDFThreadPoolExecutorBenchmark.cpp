@@ -194,6 +194,62 @@ BENCHMARK_NAMED_PARAM(
 BENCHMARK_RELATIVE_NAMED_PARAM(
     multiThreaded, EDFEx, std::make_unique<EDFThreadPoolExecutor>(kNumThreads))
 
+// Tasks in 3 priority bands. The CPUThreadPoolExecutor uses a
+// PriorityLifoSemMPMCQueue, the EDFThreadPoolExecutor maps the bands to
+// deadlines.
+static constexpr int8_t kNumPriorities = 3;
+
+void prioritized(uint32_t n, std::unique_ptr<ThreadPoolExecutor> ex) {
+  auto* edf = dynamic_cast<EDFThreadPoolExecutor*>(ex.get());
+  for (uint32_t i = 0; i < n; ++i) {
+    auto band = static_cast<int8_t>(i % kNumPriorities);
+    if (edf) {
+      edf->add([]() {}, /* total */ 1, /* deadline */ kNumPriorities - band);
+    } else {
+      ex->addWithPriority([]() {}, band - 1);
+    }
+  }
+  ex->join();
+}
+
+BENCHMARK_NAMED_PARAM(
+    prioritized,
+    CPUEx,
+    std::make_unique<CPUThreadPoolExecutor>(
+        kNumThreads,
+        CPUThreadPoolExecutor::makeLifoSemPriorityQueue(kNumPriorities)))
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    prioritized, EDFEx, std::make_unique<EDFThreadPoolExecutor>(kNumThreads))
+
+// Tasks run many times, which all the workers pick up concurrently.
+void repeated(
+    uint32_t n, std::unique_ptr<ThreadPoolExecutor> ex, size_t numRepeats) {
+  auto* edf = dynamic_cast<EDFThreadPoolExecutor*>(ex.get());
+  for (uint32_t i = 0; i < n; i += numRepeats) {
+    if (edf) {
+      edf->add([]() {}, numRepeats, /* deadline */ i);
+    } else {
+      for (size_t j = 0; j < numRepeats; ++j) {
+        ex->add([]() {});
+      }
+    }
+  }
+  ex->join();
+}
+
+BENCHMARK_NAMED_PARAM(
+    repeated,
+    CPUEx_100,
+    std::make_unique<CPUThreadPoolExecutor>(
+        kNumThreads,
+        CPUThreadPoolExecutor::makeLifoSemPriorityQueue(kNumPriorities)),
+    100)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    repeated,
+    EDFEx_100,
+    std::make_unique<EDFThreadPoolExecutor>(kNumThreads),
+    100)
+
 int main(int argc, char* argv[]) {
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
   folly::runBenchmarks();
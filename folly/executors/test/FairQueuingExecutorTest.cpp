@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/FairQueuingExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+using namespace std::chrono;
+
+namespace {
+
+void spin(nanoseconds d) {
+  auto end = steady_clock::now() + d;
+  while (steady_clock::now() < end) {
+  }
+}
+
+} // namespace
+
+TEST(FairQueuingExecutorTest, Basic) {
+  ManualExecutor manual;
+  FairQueuingExecutor executor(getKeepAliveToken(manual));
+  auto tenant = executor.addTenant(2);
+  EXPECT_EQ(2, tenant->weight());
+
+  std::vector<int> ran;
+  executor.add([&] { ran.push_back(0); });
+  tenant->add([&] { ran.push_back(1); });
+  tenant->add([&] { ran.push_back(2); });
+  EXPECT_EQ(3, executor.pendingTasks());
+  EXPECT_EQ(2, tenant->pendingTasks());
+
+  manual.drain();
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), ran);
+  EXPECT_EQ(0, executor.pendingTasks());
+  EXPECT_EQ(0, tenant->pendingTasks());
+}
+
+TEST(FairQueuingExecutorTest, RequestContext) {
+  ManualExecutor manual;
+  FairQueuingExecutor executor(getKeepAliveToken(manual));
+  auto tenant = executor.addTenant(1);
+  RequestContextScopeGuard guard;
+  auto* rctx = RequestContext::get();
+  tenant->add([&] { EXPECT_EQ(rctx, RequestContext::get()); });
+  {
+    RequestContextScopeGuard other;
+    manual.drain();
+  }
+}
+
+TEST(FairQueuingExecutorTest, SharesByWeight) {
+  ManualExecutor manual;
+  FairQueuingExecutor::Options options;
+  options.quantum = milliseconds(1);
+  FairQueuingExecutor executor(getKeepAliveToken(manual), options);
+  auto light = executor.addTenant(1);
+  auto heavy = executor.addTenant(3);
+
+  constexpr auto kTask = microseconds(100);
+  std::atomic<int> ranLight{0};
+  std::atomic<int> ranHeavy{0};
+  for (int i = 0; i < 1000; ++i) {
+    light->add([&] {
+      spin(kTask);
+      ++ranLight;
+    });
+    heavy->add([&] {
+      spin(kTask);
+      ++ranHeavy;
+    });
+  }
+  // Run a few rounds while both tenants have a backlog.
+  for (int i = 0; i < 400; ++i) {
+    manual.step();
+  }
+  EXPECT_GT(ranHeavy.load(), 2 * ranLight.load());
+  EXPECT_LT(ranHeavy.load(), 4 * ranLight.load());
+  manual.drain();
+  EXPECT_EQ(1000, ranLight.load());
+  EXPECT_EQ(1000, ranHeavy.load());
+}
+
+TEST(FairQueuingExecutorTest, CostIsRunTime) {
+  // A tenant with expensive tasks does not crowd out one with cheap tasks of
+  // the same weight: they get the same run time, not the same task count.
+  ManualExecutor manual;
+  FairQueuingExecutor::Options options;
+  options.quantum = microseconds(500);
+  FairQueuingExecutor executor(getKeepAliveToken(manual), options);
+  auto cheap = executor.addTenant(1);
+  auto expensive = executor.addTenant(1);
+
+  std::atomic<int> ranCheap{0};
+  std::atomic<int> ranExpensive{0};
+  for (int i = 0; i < 2000; ++i) {
+    cheap->add([&] {
+      spin(microseconds(20));
+      ++ranCheap;
+    });
+  }
+  for (int i = 0; i < 200; ++i) {
+    expensive->add([&] {
+      spin(microseconds(400));
+      ++ranExpensive;
+    });
+  }
+  for (int i = 0; i < 500; ++i) {
+    manual.step();
+  }
+  EXPECT_GT(ranCheap.load(), 5 * ranExpensive.load());
+  auto ratio = double(cheap->runTime().count()) /
+      double(expensive->runTime().count());
+  EXPECT_GT(ratio, 0.5);
+  EXPECT_LT(ratio, 2.0);
+  manual.drain();
+}
+
+TEST(FairQueuingExecutorTest, IdleTenantLeavesItsShare) {
+  ManualExecutor manual;
+  FairQueuingExecutor executor(getKeepAliveToken(manual));
+  auto busy = executor.addTenant(1);
+  auto idle = executor.addTenant(100);
+  int ran = 0;
+  for (int i = 0; i < 100; ++i) {
+    busy->add([&] { ++ran; });
+  }
+  manual.drain();
+  EXPECT_EQ(100, ran);
+  EXPECT_EQ(0, idle->runTime().count());
+}
+
+TEST(FairQueuingExecutorTest, DestructorDrains) {
+  CPUThreadPoolExecutor pool(4);
+  std::atomic<int> ran{0};
+  {
+    FairQueuingExecutor::Options options;
+    options.maxInQueue = 4;
+    FairQueuingExecutor executor(getKeepAliveToken(pool), options);
+    std::vector<Executor::KeepAlive<FairQueuingExecutor::Tenant>> tenants;
+    for (uint32_t w = 1; w <= 4; ++w) {
+      tenants.push_back(executor.addTenant(w));
+    }
+    for (int i = 0; i < 1000; ++i) {
+      tenants[i % 4]->add([&] { ++ran; });
+    }
+    // Tasks may add more tasks to their own tenant.
+    tenants[0]->add([&, ka = tenants[0]] { ka->add([&] { ++ran; }); });
+  }
+  EXPECT_EQ(1001, ran.load());
+}
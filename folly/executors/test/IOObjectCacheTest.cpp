@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/IOObjectCache.h>
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+
+#include <folly/executors/IOConnectionPool.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+constexpr size_t kNumThreads = 4;
+
+class IOObjectCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    executor_ = std::make_shared<IOThreadPoolExecutor>(kNumThreads);
+    setUnsafeMutableGlobalIOExecutor(executor_);
+  }
+
+  void TearDown() override {
+    setUnsafeMutableGlobalIOExecutor(std::weak_ptr<IOExecutor>());
+    executor_->join();
+  }
+
+  std::shared_ptr<IOThreadPoolExecutor> executor_;
+};
+
+struct Connection {
+  EventBase* evb;
+  int key;
+  bool open = true;
+};
+
+} // namespace
+
+TEST_F(IOObjectCacheTest, Warmup) {
+  std::atomic<size_t> created{0};
+  std::atomic<size_t> createdInEventBase{0};
+  IOObjectCache<EventBase*> cache([&](EventBase* evb) {
+    ++created;
+    if (evb->isInEventBaseThread()) {
+      ++createdInEventBase;
+    }
+    return std::make_shared<EventBase*>(evb);
+  });
+
+  std::atomic<size_t> prepared{0};
+  cache.warmup([&](EventBase* evb, EventBase*& object) {
+    EXPECT_TRUE(evb->isInEventBaseThread());
+    EXPECT_EQ(evb, object);
+    ++prepared;
+  });
+  EXPECT_EQ(kNumThreads, created);
+  EXPECT_EQ(kNumThreads, createdInEventBase);
+  EXPECT_EQ(kNumThreads, prepared);
+
+  // get() finds the objects of all the EventBases.
+  std::set<EventBase*> seen;
+  for (size_t i = 0; i < 2 * kNumThreads; ++i) {
+    seen.insert(*cache.get());
+  }
+  EXPECT_EQ(kNumThreads, seen.size());
+  EXPECT_EQ(kNumThreads, created);
+
+  // Warming up again only prepares the existing objects.
+  cache.warmup([&](EventBase*, EventBase*&) { ++prepared; });
+  EXPECT_EQ(kNumThreads, created);
+  EXPECT_EQ(2 * kNumThreads, prepared);
+}
+
+TEST_F(IOObjectCacheTest, WarmupRethrows) {
+  std::atomic<size_t> created{0};
+  IOObjectCache<int> cache([&](EventBase*) {
+    if (created++ == 0) {
+      throw std::runtime_error("failed");
+    }
+    return std::make_shared<int>(0);
+  });
+  EXPECT_THROW(cache.warmup(), std::runtime_error);
+  EXPECT_EQ(kNumThreads, created);
+
+  // The object that failed is created by get().
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    cache.get();
+  }
+  EXPECT_EQ(kNumThreads + 1, created);
+}
+
+TEST_F(IOObjectCacheTest, ConnectionPool) {
+  std::atomic<size_t> connected{0};
+  IOConnectionPool<int, Connection> pool(
+      [&](EventBase* evb, const int& key) {
+        ++connected;
+        return std::make_shared<Connection>(Connection{evb, key});
+      },
+      2,
+      [](const Connection& connection) { return connection.open; });
+
+  pool.warmup({1, 2});
+  EXPECT_EQ(2 * kNumThreads, connected);
+
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    auto connection = pool.get(1);
+    EXPECT_EQ(1, connection->key);
+    EXPECT_FALSE(connection->evb->isInEventBaseThread());
+  }
+  EXPECT_EQ(2 * kNumThreads, connected);
+
+  // A third key evicts the least recently used one, 2.
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    pool.get(3);
+  }
+  EXPECT_EQ(3 * kNumThreads, connected);
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    pool.get(1);
+  }
+  EXPECT_EQ(3 * kNumThreads, connected);
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    pool.get(2);
+  }
+  EXPECT_EQ(4 * kNumThreads, connected);
+
+  // Closed connections are replaced.
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    pool.get(2)->open = false;
+  }
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    EXPECT_TRUE(pool.get(2)->open);
+  }
+  EXPECT_EQ(5 * kNumThreads, connected);
+}
@@ -16,6 +16,7 @@
 
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include <folly/executors/test/IOThreadPoolExecutorBaseTestLib.h>
+#include <folly/synchronization/Latch.h>
 
 namespace folly {
 namespace test {
@@ -25,5 +26,22 @@ INSTANTIATE_TYPED_TEST_SUITE_P(
     IOThreadPoolExecutorBaseTest,
     IOThreadPoolExecutor);
 
+TEST(IOThreadPoolExecutorTest, NumaAware) {
+  constexpr int kTasks = 1000;
+  IOThreadPoolExecutor ex(
+      4,
+      std::make_shared<NamedThreadFactory>("NumaIO"),
+      EventBaseManager::get(),
+      IOThreadPoolExecutor::Options().setNumaAware(true).setNumaSpillThreshold(
+          0));
+  folly::Latch done(kTasks);
+  for (int i = 0; i < kTasks; ++i) {
+    ex.add([&] { done.count_down(); });
+  }
+  done.wait();
+  EXPECT_NE(nullptr, ex.getEventBase());
+  ex.join();
+}
+
 } // namespace test
 } // namespace folly
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/SerialExecutorGroup.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+
+TEST(SerialExecutorGroupTest, Order) {
+  ManualExecutor parent;
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent));
+  auto a = group->createStrand();
+  auto b = group->createStrand();
+
+  std::vector<int> ran;
+  for (int i = 0; i < 100; ++i) {
+    a->add([&, i] { ran.push_back(i); });
+    b->add([&, i] { ran.push_back(1000 + i); });
+  }
+  EXPECT_EQ(2, group->readyStrands());
+  // A single drainer is scheduled for both strands.
+  EXPECT_EQ(1, parent.run());
+  parent.drain();
+
+  ASSERT_EQ(200, ran.size());
+  int nextA = 0;
+  int nextB = 1000;
+  for (auto v : ran) {
+    if (v < 1000) {
+      EXPECT_EQ(nextA++, v);
+    } else {
+      EXPECT_EQ(nextB++, v);
+    }
+  }
+}
+
+TEST(SerialExecutorGroupTest, Batches) {
+  ManualExecutor parent;
+  SerialExecutorGroup::Options options;
+  options.maxBatch = 4;
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent), options);
+  auto a = group->createStrand();
+  auto b = group->createStrand();
+
+  std::vector<int> ran;
+  for (int i = 0; i < 8; ++i) {
+    a->add([&] { ran.push_back(0); });
+    b->add([&] { ran.push_back(1); });
+  }
+  parent.drain();
+  // Strands take turns, maxBatch tasks at a time.
+  EXPECT_EQ(
+      (std::vector<int>{0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1}),
+      ran);
+}
+
+TEST(SerialExecutorGroupTest, DrainBudget) {
+  ManualExecutor parent;
+  SerialExecutorGroup::Options options;
+  options.drainBudget = std::chrono::microseconds(0);
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent), options);
+  auto strand = group->createStrand();
+  int ran = 0;
+  for (int i = 0; i < 3; ++i) {
+    strand->add([&] { ++ran; });
+  }
+  // Each drainer runs a single task and yields back to the parent.
+  EXPECT_EQ(1, parent.step());
+  EXPECT_EQ(1, ran);
+  EXPECT_EQ(1, parent.step());
+  EXPECT_EQ(2, ran);
+  EXPECT_EQ(1, parent.step());
+  EXPECT_EQ(3, ran);
+  EXPECT_EQ(0, parent.step());
+}
+
+TEST(SerialExecutorGroupTest, StrandReleasedBeforeRunning) {
+  ManualExecutor parent;
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent));
+  int ran = 0;
+  group->createStrand()->add([&] { ++ran; });
+  parent.drain();
+  EXPECT_EQ(1, ran);
+}
+
+TEST(SerialExecutorGroupTest, DroppedDrainer) {
+  // An executor which destroys the functions added to it without running
+  // them.
+  class DroppingExecutor : public Executor {
+   public:
+    void add(Func) override {}
+  } parent;
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent));
+  bool destroyed = false;
+  auto guard =
+      std::shared_ptr<void>(nullptr, [&](void*) { destroyed = true; });
+  group->createStrand()->add([guard = std::move(guard)] { FAIL(); });
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(0, group->readyStrands());
+  std::weak_ptr<SerialExecutorGroup> weak = group;
+  group.reset();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(SerialExecutorGroupTest, Concurrent) {
+  CPUThreadPoolExecutor parent(4);
+  SerialExecutorGroup::Options options;
+  options.maxDrainers = 4;
+  auto group = SerialExecutorGroup::create(getKeepAliveToken(parent), options);
+  constexpr int kStrands = 100;
+  constexpr int kTasks = 200;
+  std::vector<Executor::KeepAlive<SerializedExecutor>> strands;
+  std::vector<int> counters(kStrands);
+  std::vector<std::atomic<bool>> running(kStrands);
+  for (int i = 0; i < kStrands; ++i) {
+    strands.push_back(group->createStrand());
+  }
+  std::atomic<int> done{0};
+  Baton<> baton;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; ++t) {
+    producers.emplace_back([&, t] {
+      for (int j = 0; j < kTasks; ++j) {
+        for (int i = t; i < kStrands; i += 4) {
+          strands[i]->add([&, i, j] {
+            EXPECT_FALSE(running[i].exchange(true));
+            EXPECT_EQ(j, counters[i]++);
+            running[i] = false;
+            if (++done == kStrands * kTasks) {
+              baton.post();
+            }
+          });
+        }
+      }
+    });
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  baton.wait();
+  for (int i = 0; i < kStrands; ++i) {
+    EXPECT_EQ(kTasks, counters[i]);
+  }
+}
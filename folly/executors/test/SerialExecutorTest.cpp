@@ -18,6 +18,7 @@
 
 #include <chrono>
 #include <optional>
+#include <vector>
 
 #include <folly/Random.h>
 #include <folly/ScopeGuard.h>
@@ -254,6 +255,36 @@ TYPED_TEST(SerialExecutorTest, Stress) {
   EXPECT_EQ(tasksRan, kNumProducers * (kNumIterations + 1));
 }
 
+TYPED_TEST(SerialExecutorTest, AddBatch) {
+  struct CountingExecutor : folly::Executor {
+    void add(folly::Func f) override {
+      ++adds;
+      funcs.push_back(std::move(f));
+    }
+    size_t adds = 0;
+    std::vector<folly::Func> funcs;
+  };
+
+  CountingExecutor parent;
+  auto se = TypeParam::create(&parent);
+  std::vector<int> ran;
+  std::vector<folly::Func> batch;
+  for (int i = 0; i < 10; ++i) {
+    batch.push_back([&ran, i] { ran.push_back(i); });
+  }
+  se->addBatch(batch);
+  se->addBatch({});
+  // The whole batch is run by a single task on the parent.
+  EXPECT_EQ(1, parent.adds);
+  se = {};
+  while (!parent.funcs.empty()) {
+    auto f = std::move(parent.funcs.back());
+    parent.funcs.pop_back();
+    f();
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), ran);
+}
+
 // Basic test for SerialExecutorMPSCQueue, does not exercise concurrent access
 // but just ensure that the state stays consistent under different
 // enqueue/dequeue patterns.
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/ThreadPoolAutoscaler.h>
+
+#include <thread>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+
+namespace {
+
+ThreadPoolAutoscaler::Options makeOptions() {
+  ThreadPoolAutoscaler::Options opts;
+  opts.minThreads = 1;
+  opts.maxThreads = 8;
+  opts.targetQueueDelay = 5ms;
+  opts.shrinkAfterIdleIntervals = 3;
+  opts.growthFactor = 2;
+  return opts;
+}
+
+// Makes the next task wait at least 10ms in the queue of a single thread.
+void delayQueue(CPUThreadPoolExecutor& pool) {
+  Baton<> blocked;
+  Baton<> done;
+  pool.add([&] {
+    blocked.post();
+    /* sleep override */ std::this_thread::sleep_for(10ms);
+  });
+  blocked.wait();
+  pool.add([&] { done.post(); });
+  done.wait();
+}
+
+} // namespace
+
+TEST(ThreadPoolAutoscalerTest, GrowsOnQueueDelay) {
+  CPUThreadPoolExecutor pool(1);
+  ThreadPoolAutoscaler autoscaler(pool, makeOptions());
+
+  delayQueue(pool);
+  EXPECT_EQ(2, autoscaler.update());
+  EXPECT_EQ(2, pool.numThreads());
+
+  pool.setNumThreads(1);
+  delayQueue(pool);
+  pool.setNumThreads(6);
+  delayQueue(pool);
+  // Capped at maxThreads.
+  EXPECT_EQ(8, autoscaler.update());
+  EXPECT_EQ(8, pool.numThreads());
+}
+
+TEST(ThreadPoolAutoscalerTest, ShrinksAfterIdleIntervals) {
+  CPUThreadPoolExecutor pool(8);
+  ThreadPoolAutoscaler autoscaler(pool, makeOptions());
+
+  EXPECT_EQ(8, autoscaler.update());
+  EXPECT_EQ(8, autoscaler.update());
+  // Shrinks by half at most.
+  EXPECT_EQ(4, autoscaler.update());
+  EXPECT_EQ(4, autoscaler.update());
+  EXPECT_EQ(4, autoscaler.update());
+  EXPECT_EQ(2, autoscaler.update());
+  for (int i = 0; i < 6; ++i) {
+    autoscaler.update();
+  }
+  EXPECT_EQ(1, pool.numThreads());
+}
+
+TEST(ThreadPoolAutoscalerTest, QueueDelayResetsIdleIntervals) {
+  CPUThreadPoolExecutor pool(4);
+  ThreadPoolAutoscaler autoscaler(pool, makeOptions());
+
+  EXPECT_EQ(4, autoscaler.update());
+  EXPECT_EQ(4, autoscaler.update());
+  pool.setNumThreads(1);
+  delayQueue(pool);
+  EXPECT_EQ(2, autoscaler.update());
+  EXPECT_EQ(2, autoscaler.update());
+  EXPECT_EQ(2, autoscaler.update());
+  EXPECT_EQ(1, autoscaler.update());
+}
+
+TEST(ThreadPoolAutoscalerTest, Start) {
+  CPUThreadPoolExecutor pool(8);
+  auto opts = makeOptions();
+  opts.interval = 1ms;
+  opts.shrinkAfterIdleIntervals = 1;
+  ThreadPoolAutoscaler autoscaler(pool, opts);
+  autoscaler.start();
+  while (pool.numThreads() > 1) {
+    /* sleep override */ std::this_thread::sleep_for(1ms);
+  }
+  autoscaler.stop();
+  EXPECT_EQ(1, pool.numThreads());
+}
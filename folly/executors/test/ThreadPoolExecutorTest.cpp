@@ -36,8 +36,13 @@
 #include <folly/executors/VirtualExecutor.h>
 #include <folly/executors/task_queue/LifoSemMPMCQueue.h>
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
+#include <folly/executors/task_queue/WorkStealingBlockingQueue.h>
 #include <folly/executors/thread_factory/InitThreadFactory.h>
+#include <folly/executors/thread_factory/JemallocArenaThreadFactory.h>
+#include <folly/executors/thread_factory/NumaThreadFactory.h>
 #include <folly/executors/thread_factory/PriorityThreadFactory.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
 #include <folly/portability/PThread.h>
@@ -119,6 +124,24 @@ TYPED_TEST(ThreadPoolExecutorTypedTest, Basic) {
   basic<TypeParam>();
 }
 
+template <class TPE>
+static void addBatch() {
+  TPE tpe(4);
+  std::atomic<int> completed{0};
+  std::vector<Func> batch;
+  for (int i = 0; i < 100; ++i) {
+    batch.push_back([&] { completed++; });
+  }
+  tpe.addBatch(batch);
+  tpe.addBatch({});
+  tpe.join();
+  EXPECT_EQ(100, completed);
+}
+
+TYPED_TEST(ThreadPoolExecutorTypedTest, AddBatch) {
+  addBatch<TypeParam>();
+}
+
 template <class TPE>
 static void resize() {
   TPE tpe(100);
@@ -598,6 +621,35 @@ TEST(ThreadPoolExecutorTest, AddWithPriority) {
   EXPECT_EQ(7, c);
 }
 
+TEST(ThreadPoolExecutorTest, EDFDeadlines) {
+  EDFThreadPoolExecutor edfExe(1);
+  Baton<> started;
+  Baton<> unblock;
+  edfExe.add([&] {
+    started.post();
+    unblock.wait();
+  });
+  started.wait();
+
+  // Deadlines in the same and in different buckets of the queue.
+  std::vector<int> order;
+  edfExe.add([&] { order.push_back(3); }, 200);
+  edfExe.add([&] { order.push_back(1); }, 100);
+  edfExe.add([&] { order.push_back(2); }, 100 + 64);
+  edfExe.add([&] { order.push_back(4); }, 3, 200);
+  std::vector<Func> fs;
+  fs.emplace_back([&] { order.push_back(5); });
+  fs.emplace_back([&] { order.push_back(6); });
+  edfExe.add(std::move(fs), 200);
+  edfExe.add([&] { order.push_back(0); }, 2, 36);
+  EXPECT_EQ(6, edfExe.getPendingTaskCount());
+
+  unblock.post();
+  edfExe.join();
+  EXPECT_EQ((std::vector<int>{0, 0, 1, 2, 3, 4, 4, 4, 5, 6}), order);
+  EXPECT_EQ(0, edfExe.getPendingTaskCount());
+}
+
 TEST(ThreadPoolExecutorTest, BlockingQueue) {
   std::atomic_int c{0};
   auto f = [&] {
@@ -627,6 +679,31 @@ TEST(ThreadPoolExecutorTest, BlockingQueue) {
   EXPECT_EQ(5, c);
 }
 
+TEST(ThreadPoolExecutorTest, WorkStealingQueue) {
+  // Tasks recursively spawn subtasks from worker threads, which exercises the
+  // local deques and stealing.
+  std::atomic<int> leaves{0};
+  constexpr int kDepth = 12;
+  CPUThreadPoolExecutor cpuExe(
+      4,
+      CPUThreadPoolExecutor::makeWorkStealingQueue(),
+      std::make_shared<NamedThreadFactory>("CPUThreadPool"));
+  folly::Function<void(int)> spawn = [&](int depth) {
+    if (depth == 0) {
+      leaves++;
+      return;
+    }
+    cpuExe.add([&, depth] { spawn(depth - 1); });
+    cpuExe.add([&, depth] { spawn(depth - 1); });
+  };
+  cpuExe.add([&] { spawn(kDepth); });
+  while (leaves.load() < (1 << kDepth)) {
+    std::this_thread::yield();
+  }
+  cpuExe.join();
+  EXPECT_EQ(1 << kDepth, leaves.load());
+}
+
 TEST(PriorityThreadFactoryTest, ThreadPriority) {
   errno = 0;
   auto currentPriority = getpriority(PRIO_PROCESS, 0);
@@ -647,6 +724,65 @@ TEST(PriorityThreadFactoryTest, ThreadPriority) {
   EXPECT_EQ(desiredPriority, actualPriority);
 }
 
+TEST(NumaThreadFactoryTest, ThreadRunsOnItsNode) {
+  NumaThreadFactory factory(std::make_shared<NamedThreadFactory>("numa"));
+  auto numNodes = factory.numNodes();
+  EXPECT_EQ(NumaThreadFactory::systemNumNodes(), numNodes);
+  for (size_t i = 0; i < 2 * numNodes; ++i) {
+    size_t node = numNodes;
+    factory.newThread([&] { node = NumaThreadFactory::currentNode(numNodes); })
+        .join();
+    EXPECT_EQ(i % numNodes, node);
+  }
+}
+
+TEST(JemallocArenaThreadFactoryTest, ThreadsBoundToArenas) {
+  JemallocArenaThreadFactory::Options options;
+  options.numArenas = 2;
+  JemallocArenaThreadFactory factory(
+      std::make_shared<NamedThreadFactory>("arena"), options);
+  if (!usingJEMalloc()) {
+    EXPECT_TRUE(factory.arenas().empty());
+    bool ran = false;
+    factory.newThread([&] { ran = true; }).join();
+    EXPECT_TRUE(ran);
+    return;
+  }
+  ASSERT_EQ(2, factory.arenas().size());
+  for (size_t i = 0; i < 4; ++i) {
+    unsigned arena = 0;
+    factory.newThread([&] { mallctlRead("thread.arena", &arena); }).join();
+    EXPECT_EQ(factory.arenas()[i % 2], arena);
+  }
+}
+
+TEST(ThreadPoolExecutorTest, NumaAwareQueue) {
+  std::atomic<int> c{0};
+  CPUThreadPoolExecutor cpuExe(
+      4,
+      CPUThreadPoolExecutor::makeNumaAwareQueue(),
+      std::make_shared<NumaThreadFactory>(
+          std::make_shared<NamedThreadFactory>("CPUThreadPool")));
+  for (int i = 0; i < 100; ++i) {
+    cpuExe.add([&] { c++; });
+  }
+  cpuExe.join();
+  EXPECT_EQ(100, c);
+}
+
+TEST(ThreadPoolExecutorTest, MultiQueuePriorityQueue) {
+  std::atomic<int> c{0};
+  CPUThreadPoolExecutor cpuExe(
+      4, CPUThreadPoolExecutor::makeMultiQueuePriorityQueue());
+  EXPECT_EQ(255, cpuExe.getNumPriorities());
+  // join() must run everything, LO_PRI tasks included, before stopping.
+  for (int i = 0; i < 1000; ++i) {
+    cpuExe.addWithPriority([&] { c++; }, int8_t(i % 256 - 128));
+  }
+  cpuExe.join();
+  EXPECT_EQ(1000, c);
+}
+
 TEST(InitThreadFactoryTest, InitializerCalled) {
   int initializerCalledCount = 0;
   InitThreadFactory factory(
@@ -728,6 +864,53 @@ TEST(ThreadPoolExecutorTest, RequestContext) {
   }
 }
 
+template <class TPE>
+static void taskCpuTimeAccounting() {
+  TPE executor(2);
+  executor.setTaskCpuTimeAccounting(true);
+
+  auto burn = [] {
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < milliseconds(10)) {
+      // spin
+    }
+  };
+  executor.add(burn);
+  for (int i = 0; i < 3; ++i) {
+    RequestContextScopeGuard rctx;
+    RequestTaskClass::set(i < 2 ? "heavy" : "light");
+    executor.add(i < 2 ? Func(burn) : Func([] {}));
+  }
+  executor.join();
+
+  auto stats = executor.getTaskClassStats();
+  ASSERT_EQ(3, stats.size());
+  EXPECT_EQ(1, stats[""].taskCount);
+  EXPECT_EQ(2, stats["heavy"].taskCount);
+  EXPECT_EQ(1, stats["light"].taskCount);
+  EXPECT_GE(stats["heavy"].cpuTime, stats["light"].cpuTime);
+  EXPECT_GT(stats["heavy"].cpuTime, milliseconds(10));
+}
+
+TEST(ThreadPoolExecutorTest, CPUTaskCpuTimeAccounting) {
+  taskCpuTimeAccounting<CPUThreadPoolExecutor>();
+}
+
+TEST(ThreadPoolExecutorTest, IOTaskCpuTimeAccounting) {
+  taskCpuTimeAccounting<IOThreadPoolExecutor>();
+}
+
+TEST(ThreadPoolExecutorTest, EDFTaskCpuTimeAccounting) {
+  taskCpuTimeAccounting<EDFThreadPoolExecutor>();
+}
+
+TEST(ThreadPoolExecutorTest, TaskCpuTimeAccountingDisabled) {
+  CPUThreadPoolExecutor executor(1);
+  executor.add([] {});
+  executor.join();
+  EXPECT_TRUE(executor.getTaskClassStats().empty());
+}
+
 std::atomic<int> g_sequence{};
 
 struct SlowMover {
@@ -797,6 +980,15 @@ TEST(ThreadPoolExecutorTest, UnboundedBlockingQueueBugD3527722) {
   bugD3527722_test<UBQ<SlowMover>>();
 }
 
+template <typename T>
+struct WSQ : public WorkStealingBlockingQueue<T> {
+  explicit WSQ(int) {}
+};
+
+TEST(ThreadPoolExecutorTest, WorkStealingBlockingQueueBugD3527722) {
+  bugD3527722_test<WSQ<SlowMover>>();
+}
+
 template <typename Q>
 void nothrow_not_full_test() {
   /* LifoSemMPMCQueue should not throw when not full when active
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/TimeSlice.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+
+TEST(TimeSliceTest, NoTimeSlice) {
+  EXPECT_FALSE(shouldYield());
+  TimeSliceGuard guard{0ns};
+  EXPECT_FALSE(shouldYield());
+}
+
+TEST(TimeSliceTest, Guard) {
+  {
+    TimeSliceGuard guard{1ms};
+    /* sleep override */ std::this_thread::sleep_for(2ms);
+    EXPECT_TRUE(shouldYield());
+    {
+      TimeSliceGuard nested{1h};
+      EXPECT_FALSE(shouldYield());
+    }
+    EXPECT_TRUE(shouldYield());
+  }
+  EXPECT_FALSE(shouldYield());
+}
+
+TEST(TimeSliceTest, CPUThreadPoolExecutor) {
+  CPUThreadPoolExecutor pool(
+      1, CPUThreadPoolExecutor::Options().setTimeSlice(1ms));
+
+  // A long task yields to a task queued after it, by re-adding itself.
+  std::vector<int> order;
+  Baton<> queued;
+  Baton<> done;
+  std::function<void(int)> step = [&](int i) {
+    queued.wait();
+    while (!shouldYield()) {
+    }
+    order.push_back(i);
+    if (i == 0) {
+      pool.add([&] { step(1); });
+    } else {
+      done.post();
+    }
+  };
+  pool.add([&] { step(0); });
+  pool.add([&] { order.push_back(-1); });
+  queued.post();
+  done.wait();
+  EXPECT_EQ((std::vector<int>{0, -1, 1}), order);
+}
+
+TEST(TimeSliceTest, CPUThreadPoolExecutorNoTimeSlice) {
+  CPUThreadPoolExecutor pool(1);
+  bool yield = true;
+  pool.add([&] { yield = shouldYield(); });
+  pool.join();
+  EXPECT_FALSE(yield);
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/WheelFunctionScheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+using std::chrono::steady_clock;
+
+namespace {
+
+class CountingExecutor : public Executor {
+ public:
+  void add(Func func) override {
+    ++count;
+    func();
+  }
+
+  std::atomic<size_t> count{0};
+};
+
+class DroppingExecutor : public Executor {
+ public:
+  void add(Func) override { ++count; }
+
+  std::atomic<size_t> count{0};
+};
+
+template <typename Pred>
+bool waitFor(Pred pred, std::chrono::milliseconds timeout = 10s) {
+  auto deadline = steady_clock::now() + timeout;
+  while (!pred()) {
+    if (steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(WheelFunctionSchedulerTest, RunsPeriodically) {
+  std::atomic<int> runs{0};
+  WheelFunctionScheduler fs;
+  fs.addFunction([&] { ++runs; }, 5ms, "f");
+  EXPECT_TRUE(fs.start());
+  EXPECT_FALSE(fs.start());
+  EXPECT_TRUE(waitFor([&] { return runs >= 5; }));
+  EXPECT_TRUE(fs.shutdown());
+  EXPECT_FALSE(fs.shutdown());
+
+  // Functions are kept across shutdown() and start().
+  auto before = runs.load();
+  EXPECT_EQ(1, fs.numFunctions());
+  fs.start();
+  EXPECT_TRUE(waitFor([&] { return runs >= before + 2; }));
+}
+
+TEST(WheelFunctionSchedulerTest, NeverRunsEarly) {
+  // With 10us ticks, the delays span the first three levels of the wheel,
+  // so functions reach level 0 through cascades.
+  WheelFunctionScheduler::Options options;
+  options.tick = 10us;
+  WheelFunctionScheduler fs({}, options);
+  std::vector<std::chrono::microseconds> delays = {
+      0us, 1ms, 5ms, 100ms, 300ms, 700ms};
+  std::vector<std::atomic<steady_clock::duration::rep>> ranAfter(
+      delays.size());
+  std::atomic<size_t> done{0};
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < delays.size(); ++i) {
+    fs.addFunctionOnce(
+        [&, i] {
+          ranAfter[i] = (steady_clock::now() - start).count();
+          ++done;
+        },
+        to<std::string>("f", i),
+        delays[i]);
+  }
+  fs.start();
+  ASSERT_TRUE(waitFor([&] { return done == delays.size(); }));
+  for (size_t i = 0; i < delays.size(); ++i) {
+    EXPECT_GE(steady_clock::duration(ranAfter[i].load()), delays[i]) << i;
+  }
+  EXPECT_EQ(0, fs.numFunctions());
+}
+
+TEST(WheelFunctionSchedulerTest, CancelFunction) {
+  std::atomic<int> runs{0};
+  std::atomic<int> otherRuns{0};
+  WheelFunctionScheduler fs;
+  fs.addFunction([&] { ++runs; }, 1ms, "f");
+  fs.addFunction([&] { ++otherRuns; }, 1ms, "other");
+  fs.addFunction([] { FAIL(); }, 1ms, "later", 1h);
+  fs.start();
+  EXPECT_TRUE(waitFor([&] { return runs >= 2; }));
+  EXPECT_TRUE(fs.cancelFunction("f"));
+  EXPECT_FALSE(fs.cancelFunction("f"));
+  EXPECT_FALSE(fs.cancelFunction("unknown"));
+  EXPECT_TRUE(fs.cancelFunction("later"));
+  auto cancelledRuns = runs.load();
+  auto before = otherRuns.load();
+  EXPECT_TRUE(waitFor([&] { return otherRuns >= before + 5; }));
+  EXPECT_EQ(cancelledRuns, runs);
+
+  // The name can be used again.
+  fs.addFunction([&] { ++runs; }, 1ms, "f");
+  EXPECT_TRUE(waitFor([&] { return runs > cancelledRuns; }));
+
+  fs.cancelAllFunctions();
+  EXPECT_EQ(0, fs.numFunctions());
+}
+
+TEST(WheelFunctionSchedulerTest, InvalidArguments) {
+  WheelFunctionScheduler fs;
+  fs.addFunction([] {}, 1s, "f");
+  EXPECT_THROW(fs.addFunction([] {}, 1s, "f"), std::invalid_argument);
+  EXPECT_THROW(fs.addFunction(nullptr, 1s, "g"), std::invalid_argument);
+  EXPECT_THROW(fs.addFunction([] {}, -1s, "g"), std::invalid_argument);
+  EXPECT_THROW(
+      fs.addFunction([] {}, 1s, "g", -1s), std::invalid_argument);
+  EXPECT_THROW(
+      fs.addFunctionUniformDistribution([] {}, 2s, 1s, "g", 0s),
+      std::invalid_argument);
+  EXPECT_EQ(1, fs.numFunctions());
+}
+
+TEST(WheelFunctionSchedulerTest, RunsOnExecutor) {
+  CountingExecutor executor;
+  std::atomic<int> runs{0};
+  {
+    WheelFunctionScheduler fs(getKeepAliveToken(executor));
+    fs.addFunction([&] { ++runs; }, 1ms, "f");
+    fs.addFunctionOnce([&] { ++runs; }, "once");
+    fs.start();
+    EXPECT_TRUE(waitFor([&] { return runs >= 5; }));
+  }
+  EXPECT_EQ(runs, executor.count);
+}
+
+TEST(WheelFunctionSchedulerTest, DestructorWaitsForRuns) {
+  CPUThreadPoolExecutor pool(2);
+  std::atomic<bool> finished{false};
+  Baton<> started;
+  {
+    WheelFunctionScheduler fs(getKeepAliveToken(pool));
+    fs.addFunctionOnce([&] {
+      started.post();
+      std::this_thread::sleep_for(50ms);
+      finished = true;
+    });
+    fs.start();
+    started.wait();
+  }
+  EXPECT_TRUE(finished);
+}
+
+TEST(WheelFunctionSchedulerTest, DroppedRunsAreFinished) {
+  // Runs dropped by the executor are rescheduled like completed ones, and
+  // do not block destruction.
+  DroppingExecutor executor;
+  WheelFunctionScheduler fs(getKeepAliveToken(executor));
+  fs.addFunction([] { FAIL(); }, 1ms, "f");
+  fs.start();
+  EXPECT_TRUE(waitFor([&] { return executor.count >= 3; }));
+}
+
+TEST(WheelFunctionSchedulerTest, ManyJitteredFunctions) {
+  constexpr size_t kFunctions = 20000;
+  std::vector<std::atomic<int>> runs(kFunctions);
+  std::atomic<size_t> ranTwice{0};
+  CPUThreadPoolExecutor pool(4);
+  WheelFunctionScheduler fs(getKeepAliveToken(pool));
+  for (size_t i = 0; i < kFunctions; ++i) {
+    fs.addFunctionUniformDistribution(
+        [&, i] {
+          if (++runs[i] == 2) {
+            ++ranTwice;
+          }
+        },
+        5ms,
+        50ms,
+        to<std::string>(i),
+        0ms);
+  }
+  fs.start();
+  EXPECT_TRUE(waitFor([&] { return ranTwice == kFunctions; }));
+}
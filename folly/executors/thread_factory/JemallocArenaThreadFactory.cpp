@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/thread_factory/JemallocArenaThreadFactory.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+#include <folly/portability/SysTypes.h>
+
+namespace folly {
+
+JemallocArenaThreadFactory::JemallocArenaThreadFactory(
+    std::shared_ptr<ThreadFactory> threadFactory, Options options)
+    : threadFactory_(std::move(threadFactory)), options_(std::move(options)) {
+  if (!usingJEMalloc()) {
+    return;
+  }
+  try {
+    for (size_t i = 0; i < std::max<size_t>(1, options_.numArenas); ++i) {
+      unsigned arena;
+      mallctlRead("arenas.create", &arena);
+      arenas_.push_back(arena);
+      if (options_.dirtyDecay) {
+        mallctlWrite<ssize_t>(
+            to<std::string>("arena.", arena, ".dirty_decay_ms").c_str(),
+            static_cast<ssize_t>(options_.dirtyDecay->count()));
+      }
+    }
+  } catch (const std::exception& e) {
+    // The threads are spread over the arenas created so far.
+    LOG(WARNING) << "JemallocArenaThreadFactory: " << e.what();
+  }
+}
+
+std::thread JemallocArenaThreadFactory::newThread(Func&& func) {
+  if (arenas_.empty()) {
+    return threadFactory_->newThread(std::move(func));
+  }
+  auto n = nextThread_.fetch_add(1, std::memory_order_relaxed);
+  return threadFactory_->newThread([arenas = arenas_,
+                                    n,
+                                    assignment = options_.assignment,
+                                    threadCache = options_.threadCache,
+                                    func = std::move(func)]() mutable {
+    auto index = assignment == Assignment::Locality
+        ? AccessSpreader<>::cachedCurrent(arenas.size())
+        : n % arenas.size();
+    try {
+      mallctlWrite("thread.arena", arenas[index]);
+      if (!threadCache) {
+        mallctlWrite("thread.tcache.enabled", false);
+      }
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "JemallocArenaThreadFactory: " << e.what();
+    }
+    func();
+  });
+}
+
+} // namespace folly
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <folly/executors/thread_factory/ThreadFactory.h>
+
+namespace folly {
+
+/**
+ * A ThreadFactory that binds the threads it creates to dedicated jemalloc
+ * arenas.
+ *
+ * By default jemalloc assigns threads to its automatic arenas round-robin,
+ * so the threads of a pool share arenas, and their locks, with every other
+ * thread of the process. This factory creates numArenas arenas of its own
+ * and binds each thread to one of them when it starts:
+ *  - RoundRobin: in creation order.
+ *  - Locality: by the cache locality stripe of the cpu the thread starts
+ *    on, as AccessSpreader sees it. Combined with a NumaThreadFactory as the
+ *    wrapped factory and numArenas == NumaThreadFactory::systemNumNodes(),
+ *    the threads of a node share an arena, whose memory stays on that node.
+ *
+ * auto factory = std::make_shared<JemallocArenaThreadFactory>(
+ *     std::make_shared<NamedThreadFactory>("CPUThreadPool"), options);
+ * CPUThreadPoolExecutor pool(numThreads, std::move(factory));
+ *
+ * jemalloc cannot destroy arenas that threads may still be bound to, so the
+ * arenas outlive the factory: create one factory per pool, not per thread.
+ * Without jemalloc, or if the arenas cannot be created, the factory just
+ * forwards to the wrapped one.
+ */
+class JemallocArenaThreadFactory : public ThreadFactory {
+ public:
+  enum class Assignment {
+    RoundRobin,
+    Locality,
+  };
+
+  struct Options {
+    Options() {}
+    size_t numArenas = 1;
+    Assignment assignment = Assignment::RoundRobin;
+    // Whether the threads use a thread cache. Disabling it saves the memory
+    // of the caches of pools with many mostly idle threads.
+    bool threadCache = true;
+    // Overrides the dirty page decay time of the arenas, e.g. 0 to return
+    // freed pages to the system right away.
+    std::optional<std::chrono::milliseconds> dirtyDecay;
+  };
+
+  explicit JemallocArenaThreadFactory(
+      std::shared_ptr<ThreadFactory> threadFactory,
+      Options options = Options());
+
+  std::thread newThread(Func&& func) override;
+
+  const std::string& getNamePrefix() const override {
+    return threadFactory_->getNamePrefix();
+  }
+
+  /// The indexes of the arenas of the factory, empty if it does not bind
+  /// threads.
+  const std::vector<unsigned>& arenas() const { return arenas_; }
+
+ private:
+  std::shared_ptr<ThreadFactory> threadFactory_;
+  const Options options_;
+  std::vector<unsigned> arenas_;
+  std::atomic<size_t> nextThread_{0};
+};
+
+} // namespace folly
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/thread_factory/NumaThreadFactory.h>
+
+#include <glog/logging.h>
+
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/portability/PThread.h>
+#include <folly/portability/Sched.h>
+
+namespace folly {
+
+namespace {
+
+void bindCurrentThreadToCpus(const std::vector<size_t>& cpus) {
+#if defined(__linux__) && !FOLLY_MOBILE
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (auto cpu : cpus) {
+    CPU_SET(cpu, &cpuSet);
+  }
+  if (int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+      err != 0) {
+    LOG(WARNING) << "NumaThreadFactory: pthread_setaffinity_np failed with "
+                 << err;
+  }
+#else
+  (void)cpus;
+#endif
+  AccessSpreader<>::invalidateCachedCurrent();
+}
+
+} // namespace
+
+NumaThreadFactory::NumaThreadFactory(
+    std::shared_ptr<ThreadFactory> threadFactory)
+    : threadFactory_(std::move(threadFactory)) {
+  const auto& locality = CacheLocality::system();
+  cpusByNode_ = locality.cpusByStripe(locality.numLastLevelCaches());
+}
+
+std::thread NumaThreadFactory::newThread(Func&& func) {
+  const auto& cpus =
+      cpusByNode_[nextNode_.fetch_add(1, std::memory_order_relaxed) %
+                  cpusByNode_.size()];
+  return threadFactory_->newThread([cpus, func = std::move(func)]() mutable {
+    bindCurrentThreadToCpus(cpus);
+    func();
+  });
+}
+
+/* static */ size_t NumaThreadFactory::currentNode(size_t numNodes) {
+  return numNodes <= 1 ? 0 : AccessSpreader<>::cachedCurrent(numNodes);
+}
+
+/* static */ size_t NumaThreadFactory::systemNumNodes() {
+  return CacheLocality::system().numLastLevelCaches();
+}
+
+} // namespace folly
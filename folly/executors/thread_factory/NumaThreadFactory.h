@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <folly/executors/thread_factory/ThreadFactory.h>
+
+namespace folly {
+
+/**
+ * A ThreadFactory that partitions the threads it creates across NUMA nodes.
+ *
+ * Nodes are approximated by last-level cache domains as discovered by
+ * CacheLocality, which matches the socket layout on typical multi-socket
+ * hosts. Threads are assigned to nodes round-robin and their affinity is set
+ * to the cpus of their node, so that AccessSpreader<>::cachedCurrent(
+ * numNodes()) run on such a thread returns its node. Components such as
+ * NumaAwareBlockingQueue and IOThreadPoolExecutor use this to keep work on
+ * the node it was submitted from.
+ *
+ * Setting the affinity is best effort: if it fails (or is unsupported on the
+ * platform) the thread still runs, just without pinning.
+ */
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  explicit NumaThreadFactory(std::shared_ptr<ThreadFactory> threadFactory);
+
+  std::thread newThread(Func&& func) override;
+
+  const std::string& getNamePrefix() const override {
+    return threadFactory_->getNamePrefix();
+  }
+
+  size_t numNodes() const { return cpusByNode_.size(); }
+
+  /// Returns the node of the calling thread, as seen by AccessSpreader.
+  static size_t currentNode(size_t numNodes);
+
+  /// Returns the number of nodes on this system.
+  static size_t systemNumNodes();
+
+ private:
+  std::shared_ptr<ThreadFactory> threadFactory_;
+  std::vector<std::vector<size_t>> cpusByNode_;
+  std::atomic<size_t> nextNode_{0};
+};
+
+} // namespace folly
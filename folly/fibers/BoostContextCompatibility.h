@@ -53,6 +53,12 @@ class FiberImpl {
     DCHECK_EQ(0, context);
   }
 
+  /**
+   * Lowest address in use on the stack of the fiber, while it is not
+   * running.
+   */
+  void* stackPointer() const { return fiberContext_; }
+
   void deactivate() {
     auto transfer =
         boost::context::detail::jump_fcontext(mainContext_, nullptr);
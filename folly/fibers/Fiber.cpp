@@ -62,9 +62,9 @@ void Fiber::resume() {
   }
 }
 
-Fiber::Fiber(FiberManager& fiberManager)
+Fiber::Fiber(FiberManager& fiberManager, size_t stackSize)
     : fiberManager_(fiberManager),
-      fiberStackSize_(fiberManager_.options_.stackSize),
+      fiberStackSize_(stackSize),
       fiberStackHighWatermark_(0),
       fiberStackLimit_(fiberManager_.stackAllocator_.allocate(fiberStackSize_)),
       fiberImpl_([this] { fiberFunc(); }, fiberStackLimit_, fiberStackSize_) {
@@ -113,7 +113,10 @@ Fiber::~Fiber() {
   __tsan_destroy_fiber(tsanCtx_);
 #endif
 
-  fiberManager_.stackAllocator_.deallocate(fiberStackLimit_, fiberStackSize_);
+  fiberManager_.stackAllocator_.deallocate(
+      fiberStackLimit_,
+      fiberStackSize_,
+      fiberManager_.stackHighWatermark());
 }
 
 void Fiber::recordStackPosition() {
@@ -168,8 +171,10 @@ void Fiber::recordStackPosition() {
       auto newHighWatermark =
           fiberManager_.recordStackPosition(currentPosition);
       VLOG(3) << "Max stack usage: " << newHighWatermark;
-      CHECK_LT(newHighWatermark, fiberManager_.options_.stackSize - 64)
-          << "Fiber stack overflow";
+      CHECK_LT(currentPosition, fiberStackSize_ - 64) << "Fiber stack overflow";
+      if (taskOptions_.stackSizeProfile) {
+        taskOptions_.stackSizeProfile->record(currentPosition);
+      }
     }
 
     state_ = INVALID;
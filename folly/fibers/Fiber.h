@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <thread>
 #include <typeinfo>
@@ -27,6 +30,7 @@
 #include <folly/Portability.h>
 #include <folly/fibers/BoostContextCompatibility.h>
 #include <folly/io/async/Request.h>
+#include <folly/lang/Bits.h>
 #include <folly/lang/Thunk.h>
 #include <folly/portability/PThread.h>
 
@@ -43,6 +47,61 @@ namespace fibers {
 class Baton;
 class FiberManager;
 
+/**
+ * Stack usage of a kind of task, e.g. of the tasks added from a given call
+ * site, as measured on the fibers that record it (see
+ * FiberManager::Options::recordStackEvery). Tasks that refer to it in their
+ * TaskOptions run on stacks of twice the most that any of them was seen to
+ * use, rounded up to a power of two, once minSamples of them were measured,
+ * and on stacks of FiberManager::Options::stackSize until then.
+ *
+ * Can be shared by any number of FiberManagers and threads, e.g.
+ *
+ *   static StackSizeProfile profile;
+ *   TaskOptions taskOptions;
+ *   taskOptions.stackSizeProfile = &profile;
+ *   fm.addTask(std::move(func), std::move(taskOptions));
+ *
+ * Tasks that may take much deeper paths than they were seen to take should
+ * not use one: a stack overflow is only caught on stacks with guard pages.
+ */
+class StackSizeProfile {
+ public:
+  static constexpr size_t kMinStackSize = 4 * 1024;
+
+  explicit StackSizeProfile(size_t minSamples = 100)
+      : minSamples_(minSamples) {}
+
+  void record(size_t stackUsed) noexcept {
+    auto highWatermark = highWatermark_.load(std::memory_order_relaxed);
+    while (stackUsed > highWatermark &&
+           !highWatermark_.compare_exchange_weak(
+               highWatermark, stackUsed, std::memory_order_relaxed)) {
+    }
+    samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Stack size for the tasks, or 0 if not enough of them were measured yet.
+   */
+  size_t stackSize() const noexcept {
+    if (samples_.load(std::memory_order_relaxed) < minSamples_) {
+      return 0;
+    }
+    return nextPowTwo(std::max(
+        2 * highWatermark_.load(std::memory_order_relaxed), kMinStackSize));
+  }
+
+  size_t highWatermark() const noexcept {
+    return highWatermark_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const size_t minSamples_;
+  std::atomic<size_t> samples_{0};
+  std::atomic<size_t> highWatermark_{0};
+};
+
 struct TaskOptions {
   TaskOptions() {}
   /**
@@ -50,6 +109,18 @@ struct TaskOptions {
    * getCurrentTaskRunningTime() for details.
    */
   bool logRunningTime = false;
+  /**
+   * Run the task on a fiber with a stack of at least this many bytes, times
+   * FiberManager::Options::stackSizeMultiplier, rounded up to a power of two,
+   * instead of FiberManager::Options::stackSize. 0 if not set.
+   */
+  size_t stackSize = 0;
+  /**
+   * If set, and stackSize isn't, the task runs on a stack sized for the tasks
+   * of its kind, but no larger than FiberManager::Options::stackSize, and
+   * its stack usage is recorded there when measured.
+   */
+  StackSizeProfile* stackSizeProfile = nullptr;
 };
 
 /**
@@ -105,7 +176,7 @@ class Fiber {
   friend class Baton;
   friend class FiberManager;
 
-  explicit Fiber(FiberManager& fiberManager);
+  Fiber(FiberManager& fiberManager, size_t stackSize);
 
   void init(bool recordStackUsed);
 
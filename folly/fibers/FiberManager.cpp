@@ -28,6 +28,7 @@
 
 #include <folly/ConstexprMath.h>
 #include <folly/SingletonThreadLocal.h>
+#include <folly/detail/MemoryIdler.h>
 #include <folly/memory/SanitizeAddress.h>
 #include <folly/portability/Config.h>
 #include <folly/portability/SysSyscall.h>
@@ -72,6 +73,11 @@ FiberManager::~FiberManager() {
   while (!fibersPool_.empty()) {
     fibersPool_.pop_front_and_dispose([](Fiber* fiber) { delete fiber; });
   }
+  for (auto& [_, pool] : sizedFibersPools_) {
+    while (!pool.empty()) {
+      pool.pop_front_and_dispose([](Fiber* fiber) { delete fiber; });
+    }
+  }
   assert(readyFibers_.empty());
   assert(!hasTasks());
 }
@@ -94,7 +100,28 @@ bool FiberManager::isRemoteScheduled() const {
   return remoteCount_ > 0;
 }
 
-Fiber* FiberManager::getFiber() {
+FiberManager::FiberTailQueue& FiberManager::fibersPool(size_t stackSize) {
+  if (FOLLY_LIKELY(stackSize == options_.stackSize)) {
+    return fibersPool_;
+  }
+  return sizedFibersPools_[stackSize];
+}
+
+size_t FiberManager::getStackSize(const TaskOptions& taskOptions) const {
+  if (taskOptions.stackSize != 0) {
+    return nextPowTwo(std::max(
+        taskOptions.stackSize * stackSizeMultiplier_,
+        StackSizeProfile::kMinStackSize));
+  }
+  if (taskOptions.stackSizeProfile) {
+    if (auto stackSize = taskOptions.stackSizeProfile->stackSize()) {
+      return std::min(stackSize, options_.stackSize);
+    }
+  }
+  return options_.stackSize;
+}
+
+Fiber* FiberManager::getFiber(size_t stackSize) {
   Fiber* fiber = nullptr;
 
   if (options_.fibersPoolResizePeriodMs > 0 && !fibersPoolResizerScheduled_) {
@@ -102,12 +129,13 @@ Fiber* FiberManager::getFiber() {
     fibersPoolResizerScheduled_ = true;
   }
 
-  if (fibersPool_.empty()) {
-    fiber = new Fiber(*this);
+  auto& pool = fibersPool(stackSize);
+  if (pool.empty()) {
+    fiber = new Fiber(*this, stackSize);
     fibersAllocated_.store(fibersAllocated() + 1, std::memory_order_relaxed);
   } else {
-    fiber = &fibersPool_.front();
-    fibersPool_.pop_front();
+    fiber = &pool.front();
+    pool.pop_front();
     auto fibersPoolSize = fibersPoolSize_.load(std::memory_order_relaxed);
     assert(fibersPoolSize > 0);
     fibersPoolSize_.store(fibersPoolSize - 1, std::memory_order_relaxed);
@@ -171,19 +199,56 @@ void FiberManager::doFibersPoolResizing() {
           fibersPoolSize > options_.maxFibersPoolSize)) {
       break;
     }
-    auto fiber = &fibersPool_.front();
+    // Free the fibers with other stack sizes first.
+    auto* pool = &fibersPool_;
+    for (auto& [_, sizedPool] : sizedFibersPools_) {
+      if (!sizedPool.empty()) {
+        pool = &sizedPool;
+        break;
+      }
+    }
+    auto fiber = &pool->front();
     assert(fiber != nullptr);
-    fibersPool_.pop_front();
+    pool->pop_front();
     delete fiber;
     fibersPoolSize_.store(fibersPoolSize - 1, std::memory_order_relaxed);
     fibersAllocated_.store(fibersAllocated - 1, std::memory_order_relaxed);
   }
 
+  if (maxFibersActiveLastPeriod_ > 0) {
+    idleStacksReleased_ = false;
+  } else if (options_.releaseIdleStacks && !idleStacksReleased_) {
+    releaseIdleStacks();
+    idleStacksReleased_ = true;
+  }
+
   maxFibersActiveLastPeriod_ = fibersActive_.load(std::memory_order_relaxed);
 }
 
+void FiberManager::releaseIdleStacks() {
+  auto release = [](FiberTailQueue& pool) {
+    for (auto& fiber : pool) {
+      // Zeroing the stack would defeat the search for the magic values.
+      if (!fiber.stackFilledWithMagic_) {
+        // The pooled fiber is suspended in Fiber::fiberFunc(), the part of
+        // its stack below that frame is dead.
+        folly::detail::MemoryIdler::unmapUnusedStack(
+            fiber.fiberStackLimit_, fiber.fiberImpl_.stackPointer());
+      }
+    }
+  };
+  release(fibersPool_);
+  for (auto& [_, pool] : sizedFibersPools_) {
+    release(pool);
+  }
+}
+
 void FiberManager::FibersPoolResizer::run() {
   fiberManager_.doFibersPoolResizing();
+  if (fiberManager_.options_.useSharedStackPool) {
+    SharedStackPool::instance().maybeTrim(std::chrono::milliseconds(
+        fiberManager_.options_.fibersPoolResizePeriodMs));
+  }
   if (auto timer = fiberManager_.loopController_->timer()) {
     RequestContextScopeGuard rctxGuard(std::shared_ptr<RequestContext>{});
     timer->scheduleTimeout(
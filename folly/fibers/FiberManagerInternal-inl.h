@@ -201,7 +201,7 @@ inline void FiberManager::runReadyFiber(Fiber* fiber) {
     if (fibersPoolSize_ < options_.maxFibersPoolSize ||
         options_.fibersPoolResizePeriodMs > 0) {
       fiber->fiberStackHighWatermark_ = 0;
-      fibersPool_.push_front(*fiber);
+      fibersPool(fiber->fiberStackSize_).push_front(*fiber);
       ++fibersPoolSize_;
     } else {
       delete fiber;
@@ -294,7 +294,7 @@ inline void FiberManager::loopUntilNoReadyImpl() {
       auto hadRemoteTask =
           remoteTaskQueue_.sweepOnce([this](RemoteTask* taskPtr) {
             std::unique_ptr<RemoteTask> task(taskPtr);
-            auto fiber = getFiber();
+            auto fiber = getFiber(options_.stackSize);
             if (task->localData) {
               fiber->localData_ = *task->localData;
             }
@@ -373,7 +373,7 @@ template <typename F>
 Fiber* FiberManager::createTask(F&& func, TaskOptions taskOptions) {
   typedef AddTaskHelper<F> Helper;
 
-  auto fiber = getFiber();
+  auto fiber = getFiber(getStackSize(taskOptions));
   initLocalData(*fiber);
 
   if (Helper::allocateInBuffer) {
@@ -500,7 +500,7 @@ Fiber* FiberManager::createTaskFinally(F&& func, G&& finally) {
               typename FirstArgOf<G>::type>::type::element_type>::value,
       "finally(Try<T>&&): T must be convertible from func()'s return type");
 
-  auto fiber = getFiber();
+  auto fiber = getFiber(options_.stackSize);
   initLocalData(*fiber);
 
   typedef AddTaskFinallyHelper<
@@ -614,7 +614,8 @@ FiberManager::FiberManager(
     std::unique_ptr<LoopController> loopController__,
     Options options)
     : loopController_(std::move(loopController__)),
-      stackAllocator_(options.guardPagesPerStack),
+      stackAllocator_(options.guardPagesPerStack, options.useSharedStackPool),
+      stackSizeMultiplier_(options.stackSizeMultiplier),
       options_(preprocessOptions(std::move(options))),
       exceptionCallback_(defaultExceptionCallback),
       fibersPoolResizer_(*this),
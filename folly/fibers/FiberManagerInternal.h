@@ -17,6 +17,7 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 #include <thread>
@@ -131,6 +132,25 @@ class FiberManager : public ::folly::Executor {
      */
     uint32_t fibersPoolResizePeriodMs{0};
 
+    /**
+     * Take the fiber stacks that aren't protected with guard pages from the
+     * process-wide SharedStackPool, where the fibers freed by any
+     * FiberManager leave them, instead of malloc(). The memory of the stacks
+     * left idle there is released every fibersPoolResizePeriodMs, keeping
+     * the part seen in use if recordStackEvery is set. Set maxFibersPoolSize
+     * low to let stacks move between FiberManagers.
+     */
+    bool useSharedStackPool{false};
+
+    /**
+     * When no fiber was active for a whole fibersPoolResizePeriodMs, release
+     * the unused pages of the stacks of the fibers in the pool, as
+     * MemoryIdler does for the stacks of idle threads. The fibers stay in
+     * the pool, and fault their stack pages back in when reused. Not done
+     * for the stacks used to record stack usage.
+     */
+    bool releaseIdleStacks{false};
+
     constexpr Options() {}
 
     auto hash() const {
@@ -140,7 +160,9 @@ class FiberManager : public ::folly::Executor {
           recordStackEvery,
           maxFibersPoolSize,
           guardPagesPerStack,
-          fibersPoolResizePeriodMs);
+          fibersPoolResizePeriodMs,
+          useSharedStackPool,
+          releaseIdleStacks);
     }
   };
 
@@ -497,6 +519,11 @@ class FiberManager : public ::folly::Executor {
   FiberTailQueue* yieldedFibers_{nullptr}; /**< queue of fibers which have
                                       yielded execution */
   FiberTailQueue fibersPool_; /**< pool of uninitialized Fiber objects */
+  /**
+   * Pools of uninitialized Fiber objects with other stack sizes than
+   * Options::stackSize, by stack size.
+   */
+  std::map<size_t, FiberTailQueue> sizedFibersPools_;
 
   GlobalFiberTailQueue allFibers_; /**< list of all Fiber objects owned */
 
@@ -514,6 +541,12 @@ class FiberManager : public ::folly::Executor {
    */
   size_t maxFibersActiveLastPeriod_{0};
 
+  /**
+   * Whether the stacks of the pooled fibers were released since a fiber was
+   * last active, see Options::releaseIdleStacks.
+   */
+  bool idleStacksReleased_{false};
+
   std::unique_ptr<LoopController> loopController_;
   bool isLoopScheduled_{false}; /**< was the ready loop scheduled to run? */
 
@@ -529,6 +562,8 @@ class FiberManager : public ::folly::Executor {
    */
   GuardPageAllocator stackAllocator_;
 
+  const size_t stackSizeMultiplier_; /**< Options::stackSizeMultiplier */
+
   const Options options_; /**< FiberManager options */
 
   /**
@@ -544,7 +579,14 @@ class FiberManager : public ::folly::Executor {
   /**
    * @return An initialized Fiber object from the pool
    */
-  Fiber* getFiber();
+  Fiber* getFiber(size_t stackSize);
+
+  /**
+   * @return The stack size of the fibers to run tasks with these options on
+   */
+  size_t getStackSize(const TaskOptions& taskOptions) const;
+
+  FiberTailQueue& fibersPool(size_t stackSize);
 
   /**
    * Sets local data for given fiber if all conditions are met.
@@ -605,6 +647,7 @@ class FiberManager : public ::folly::Executor {
   bool fibersPoolResizerScheduled_{false};
 
   void doFibersPoolResizing();
+  void releaseIdleStacks();
 
   /**
    * Only local of this type will be available for fibers.
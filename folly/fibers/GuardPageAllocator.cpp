@@ -20,15 +20,18 @@
 #include <dlfcn.h>
 #endif
 
+#include <algorithm>
 #include <csignal>
 #include <iostream>
 #include <mutex>
+#include <new>
 
 #include <glog/logging.h>
 
 #include <folly/Singleton.h>
 #include <folly/SpinLock.h>
 #include <folly/Synchronized.h>
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/portability/SysMman.h>
 #include <folly/portability/Unistd.h>
 
@@ -331,8 +334,154 @@ StackCacheEntry::~StackCacheEntry() {
   CacheManager::instance().giveBack(std::move(stackCache_));
 }
 
-GuardPageAllocator::GuardPageAllocator(size_t guardPagesPerStack)
-    : guardPagesPerStack_(guardPagesPerStack) {
+namespace {
+
+size_t stackPageSize() {
+  static const auto pagesize = size_t(sysconf(_SC_PAGESIZE));
+  return pagesize;
+}
+
+size_t roundUpToPages(size_t size) {
+  return (size + stackPageSize() - 1) / stackPageSize() * stackPageSize();
+}
+
+} // namespace
+
+SharedStackPool::~SharedStackPool() {
+  for (auto& node : nodes_) {
+    for (const auto& stack : node.stacks) {
+      PCHECK(0 == ::munmap(stack.base, stack.allocSize));
+    }
+  }
+}
+
+SharedStackPool& SharedStackPool::instance() {
+  static auto inst = new SharedStackPool();
+  return *inst;
+}
+
+SharedStackPool::Node& SharedStackPool::localNode() {
+  static const auto getcpu = Getcpu::resolveVdsoFunc();
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (!getcpu || getcpu(&cpu, &node, nullptr) != 0) {
+    node = 0;
+  }
+  return nodes_[node % kMaxNumaNodes];
+}
+
+unsigned char* SharedStackPool::allocate(size_t size) {
+  auto allocSize = roundUpToPages(size);
+  unsigned char* base = nullptr;
+  {
+    auto& node = localNode();
+    std::lock_guard lg(node.lock);
+    // Most recently cached first, as its memory is the most likely to be
+    // resident.
+    for (auto it = node.stacks.rbegin(); it != node.stacks.rend(); ++it) {
+      if (it->allocSize == allocSize) {
+        base = it->base;
+        node.stacks.erase(std::next(it).base());
+        break;
+      }
+    }
+  }
+  if (!base) {
+    auto p = ::mmap(
+        nullptr,
+        allocSize,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (p == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    base = static_cast<unsigned char*>(p);
+  }
+  /* As in StackCache, the stack is aligned at the top of the pages. */
+  return base + allocSize - size;
+}
+
+void SharedStackPool::deallocate(
+    unsigned char* limit, size_t size, size_t highWatermark) {
+  auto allocSize = roundUpToPages(size);
+  auto base = limit + size - allocSize;
+  {
+    auto& node = localNode();
+    std::lock_guard lg(node.lock);
+    if (node.stacks.size() < options_.maxStacksPerNode) {
+      node.stacks.push_back(CachedStack{
+          base,
+          allocSize,
+          std::min(roundUpToPages(highWatermark), allocSize),
+          trimEpoch_.load(std::memory_order_relaxed),
+          /* trimmed= */ false});
+      return;
+    }
+  }
+  PCHECK(0 == ::munmap(base, allocSize));
+}
+
+void SharedStackPool::trim() {
+  auto epoch = trimEpoch_.fetch_add(1, std::memory_order_relaxed);
+  std::vector<CachedStack> toTrim;
+  for (auto& node : nodes_) {
+    // Take the stacks out of the cache while they are being trimmed, so that
+    // no fiber can start using them meanwhile.
+    {
+      std::lock_guard lg(node.lock);
+      auto it = std::stable_partition(
+          node.stacks.begin(), node.stacks.end(), [&](const auto& stack) {
+            return stack.trimmed || stack.epoch >= epoch;
+          });
+      toTrim.assign(it, node.stacks.end());
+      node.stacks.erase(it, node.stacks.end());
+    }
+    if (toTrim.empty()) {
+      continue;
+    }
+    for (auto& stack : toTrim) {
+      // The stack grows down from the end of its pages.
+      if (stack.keepSize < stack.allocSize) {
+        ::madvise(stack.base, stack.allocSize - stack.keepSize, MADV_DONTNEED);
+      }
+      stack.trimmed = true;
+    }
+    // Put them back below the stacks that are still warm.
+    std::lock_guard lg(node.lock);
+    node.stacks.insert(node.stacks.begin(), toTrim.begin(), toTrim.end());
+  }
+}
+
+void SharedStackPool::maybeTrim(std::chrono::milliseconds period) {
+  {
+    std::unique_lock lg(trimLock_, std::try_to_lock);
+    if (!lg.owns_lock()) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastTrim_ < period) {
+      return;
+    }
+    lastTrim_ = now;
+  }
+  trim();
+}
+
+size_t SharedStackPool::cachedStacks() const {
+  size_t count = 0;
+  for (const auto& node : nodes_) {
+    std::lock_guard lg(node.lock);
+    count += node.stacks.size();
+  }
+  return count;
+}
+
+GuardPageAllocator::GuardPageAllocator(
+    size_t guardPagesPerStack, bool useSharedStackPool)
+    : guardPagesPerStack_(guardPagesPerStack),
+      useSharedStackPool_(useSharedStackPool) {
 #ifndef _WIN32
   installSignalHandler();
 #endif
@@ -352,11 +501,20 @@ unsigned char* GuardPageAllocator::allocate(size_t size) {
       return p;
     }
   }
+  if (useSharedStackPool_) {
+    return SharedStackPool::instance().allocate(size);
+  }
   return fallbackAllocator_.allocate(size);
 }
 
-void GuardPageAllocator::deallocate(unsigned char* limit, size_t size) {
-  if (!(stackCache_ && stackCache_->cache().giveBack(limit, size))) {
+void GuardPageAllocator::deallocate(
+    unsigned char* limit, size_t size, size_t highWatermark) {
+  if (stackCache_ && stackCache_->cache().giveBack(limit, size)) {
+    return;
+  }
+  if (useSharedStackPool_) {
+    SharedStackPool::instance().deallocate(limit, size, highWatermark);
+  } else {
     fallbackAllocator_.deallocate(limit, size);
   }
 }
@@ -16,13 +16,109 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
+
+#include <folly/SpinLock.h>
+#include <folly/lang/Align.h>
 
 namespace folly {
 namespace fibers {
 
 class StackCacheEntry;
 
+/**
+ * Process-wide cache of fiber stacks. FiberManagers that share it reuse each
+ * other's stacks instead of each keeping its own, and the memory of idle
+ * stacks is given back to the kernel by trim().
+ *
+ * Stacks are mapped with mmap() and cached per NUMA node, that of the thread
+ * freeing them, and handed out to threads of the same node first.
+ *
+ * trim() MADV_DONTNEEDs the stacks that have stayed in the cache since before
+ * the previous trim(), except for the top of each, as much as the fibers that
+ * used it were seen to use (see FiberManager::Options::recordStackEvery).
+ * The rest was touched only to fill the stack with the marker used to
+ * measure the stack usage, if at all.
+ */
+class SharedStackPool {
+ public:
+  struct Options {
+    /// Stacks that are cached per NUMA node. Freeing more unmaps them.
+    size_t maxStacksPerNode{1024};
+  };
+
+  SharedStackPool() : SharedStackPool(Options()) {}
+  explicit SharedStackPool(Options options) : options_(options) {}
+  ~SharedStackPool();
+
+  SharedStackPool(const SharedStackPool&) = delete;
+  SharedStackPool& operator=(const SharedStackPool&) = delete;
+
+  /**
+   * The pool used by the FiberManagers with Options::useSharedStackPool set.
+   */
+  static SharedStackPool& instance();
+
+  /**
+   * @return pointer to the bottom of the allocated stack of `size' bytes.
+   */
+  unsigned char* allocate(size_t size);
+
+  /**
+   * Caches the previous result of an `allocate(size)' call. The top
+   * `highWatermark' bytes of it are kept when trimming, if nonzero.
+   */
+  void deallocate(unsigned char* limit, size_t size, size_t highWatermark);
+
+  /**
+   * Releases the unused memory of the stacks that are cached since before the
+   * previous call.
+   */
+  void trim();
+
+  /**
+   * Calls trim() if it was not called for at least `period'.
+   */
+  void maybeTrim(std::chrono::milliseconds period);
+
+  size_t cachedStacks() const;
+
+ private:
+  static constexpr size_t kMaxNumaNodes = 16;
+
+  struct CachedStack {
+    unsigned char* base;
+    size_t allocSize;
+    // Top bytes to keep when trimming, a multiple of the page size.
+    size_t keepSize;
+    // Value of trimEpoch_ when the stack was cached.
+    uint64_t epoch;
+    bool trimmed;
+  };
+
+  struct alignas(hardware_destructive_interference_size) Node {
+    mutable folly::SpinLock lock;
+    /**
+     * LIFO free list.
+     */
+    std::vector<CachedStack> stacks;
+  };
+
+  Node& localNode();
+
+  const Options options_;
+  std::array<Node, kMaxNumaNodes> nodes_;
+  std::atomic<uint64_t> trimEpoch_{0};
+  folly::SpinLock trimLock_;
+  std::chrono::steady_clock::time_point lastTrim_;
+};
+
 /**
  * Stack allocator that protects an extra memory page after
  * the end of the stack.
@@ -34,8 +130,11 @@ class GuardPageAllocator {
   /**
    * @param guardPagesPerStack  Protect a small number of fiber stacks
    *   with this many guard pages.  If 0, acts as std::allocator.
+   * @param useSharedStackPool  Take the stacks that aren't protected from
+   *   SharedStackPool::instance() instead of std::allocator.
    */
-  explicit GuardPageAllocator(size_t guardPagesPerStack);
+  explicit GuardPageAllocator(
+      size_t guardPagesPerStack, bool useSharedStackPool = false);
   ~GuardPageAllocator();
 
   /**
@@ -45,13 +144,15 @@ class GuardPageAllocator {
 
   /**
    * Deallocates the previous result of an `allocate(size)' call.
+   * `highWatermark' is passed on to SharedStackPool::deallocate().
    */
-  void deallocate(unsigned char* limit, size_t size);
+  void deallocate(unsigned char* limit, size_t size, size_t highWatermark = 0);
 
  private:
   std::unique_ptr<StackCacheEntry> stackCache_;
   std::allocator<unsigned char> fallbackAllocator_;
   size_t guardPagesPerStack_{0};
+  bool useSharedStackPool_{false};
 };
 } // namespace fibers
 } // namespace folly
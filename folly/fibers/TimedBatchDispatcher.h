@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/Synchronized.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/Promise.h>
+
+namespace folly {
+namespace fibers {
+
+/**
+ * TimedBatchDispatcher batches values across loop iterations: a batch is
+ * dispatched as soon as it holds maxBatchSize values, or maxDelay after its
+ * first value was added, whichever comes first. This bounds the latency added
+ * to every value by maxDelay (plus the time to get the dispatch scheduled).
+ *
+ * Unlike BatchDispatcher, which relies on the executor running tasks in order
+ * and so only batches values added within one loop iteration, this works with
+ * any executor and is thread safe: add() may be called from fibers, from
+ * coroutines (the returned SemiFuture can be co_awaited), or from plain
+ * threads.
+ *
+ * The dispatch function is called on the given executor with the values of a
+ * batch, and returns a SemiFuture to the results in the same order. Batches
+ * may be dispatched concurrently if the executor runs tasks in parallel.
+ *
+ * Example:
+ *   TimedBatchDispatcher<int, std::string> dispatcher(
+ *       evb,
+ *       [&](std::vector<int>&& ids) { return client.lookup(std::move(ids)); },
+ *       100, // maxBatchSize
+ *       std::chrono::microseconds(500)); // maxDelay
+ *
+ *   fm.addTask([&] { auto name = dispatcher.add(42).get(); });
+ *
+ * The executor must outlive the dispatcher. Values which are still pending
+ * when the dispatcher is destroyed are dispatched right away.
+ */
+template <typename ValueT, typename ResultT>
+class TimedBatchDispatcher {
+ public:
+  using ValueBatchT = std::vector<ValueT>;
+  using ResultBatchT = std::vector<ResultT>;
+  using PromiseBatchT = std::vector<folly::Promise<ResultT>>;
+  using DispatchFunctionT =
+      folly::Function<SemiFuture<ResultBatchT>(ValueBatchT&&)>;
+
+  /**
+   * If timekeeper is null, the global Timekeeper is used.
+   */
+  TimedBatchDispatcher(
+      Executor& executor,
+      DispatchFunctionT dispatchFunc,
+      size_t maxBatchSize,
+      std::chrono::microseconds maxDelay,
+      Timekeeper* timekeeper = nullptr)
+      : state_(std::make_shared<DispatchState>(
+            executor, std::move(dispatchFunc), timekeeper)),
+        maxBatchSize_(maxBatchSize),
+        maxDelay_(maxDelay) {
+    if (maxBatchSize_ == 0) {
+      throw std::invalid_argument("maxBatchSize must be positive");
+    }
+  }
+
+  TimedBatchDispatcher(const TimedBatchDispatcher&) = delete;
+  TimedBatchDispatcher& operator=(const TimedBatchDispatcher&) = delete;
+
+  ~TimedBatchDispatcher() { flush(); }
+
+  SemiFuture<ResultT> add(ValueT value) {
+    folly::Promise<ResultT> resultPromise;
+    auto resultFuture = resultPromise.getSemiFuture();
+
+    Batch full;
+    bool startTimer = false;
+    uint64_t batchId = 0;
+    {
+      auto batch = state_->batch.lock();
+      startTimer = batch->values.empty();
+      batchId = batch->id;
+      batch->values.emplace_back(std::move(value));
+      batch->promises.emplace_back(std::move(resultPromise));
+      if (batch->values.size() >= maxBatchSize_) {
+        full = takeBatch(*batch);
+      }
+    }
+
+    if (!full.values.empty()) {
+      dispatch(state_, std::move(full));
+    } else if (startTimer) {
+      // The timer doesn't hold a KeepAlive to the executor until it fires, so
+      // that a pending deadline doesn't keep e.g. an EventBase loop running.
+      futures::sleep(maxDelay_, state_->timekeeper)
+          .toUnsafeFuture()
+          .thenValue([weakState = std::weak_ptr<DispatchState>(state_),
+                      batchId](Unit) {
+            if (auto state = weakState.lock()) {
+              flushBatch(std::move(state), &batchId);
+            }
+          });
+    }
+
+    return resultFuture;
+  }
+
+  /**
+   * Dispatches the pending values now, without waiting for the batch to fill
+   * up or for its deadline.
+   */
+  void flush() { flushBatch(state_, nullptr); }
+
+ private:
+  struct Batch {
+    ValueBatchT values;
+    PromiseBatchT promises;
+    // Identifies the batch being filled, so that the timer of a batch which
+    // was already dispatched doesn't flush the next one.
+    uint64_t id{0};
+  };
+
+  struct DispatchState {
+    DispatchState(
+        Executor& executor_,
+        DispatchFunctionT&& dispatchFunction,
+        Timekeeper* timekeeper_)
+        : executor(executor_),
+          dispatchFunc(std::move(dispatchFunction)),
+          timekeeper(timekeeper_) {}
+
+    Executor& executor;
+    DispatchFunctionT dispatchFunc;
+    Timekeeper* const timekeeper;
+    folly::Synchronized<Batch, std::mutex> batch;
+  };
+
+  static Batch takeBatch(Batch& batch) {
+    Batch taken;
+    taken.values.swap(batch.values);
+    taken.promises.swap(batch.promises);
+    ++batch.id;
+    return taken;
+  }
+
+  // Flushes the pending batch if its id is *batchId, or in any case if batchId
+  // is null.
+  static void flushBatch(
+      std::shared_ptr<DispatchState> state, const uint64_t* batchId) {
+    Batch batch;
+    {
+      auto pending = state->batch.lock();
+      if (pending->values.empty() || (batchId && *batchId != pending->id)) {
+        return;
+      }
+      batch = takeBatch(*pending);
+    }
+    dispatch(std::move(state), std::move(batch));
+  }
+
+  static void dispatch(std::shared_ptr<DispatchState> state, Batch batch) {
+    auto executor = getKeepAliveToken(state->executor);
+    folly::via(
+        std::move(executor),
+        [state = std::move(state), values = std::move(batch.values)]() mutable {
+          return state->dispatchFunc(std::move(values));
+        })
+        .thenTry([promises = std::move(batch.promises)](
+                     Try<ResultBatchT>&& results) mutable {
+          if (results.hasValue() && results->size() != promises.size()) {
+            results.emplaceException(std::logic_error(
+                "Unexpected number of results returned from "
+                "dispatch function"));
+          }
+          for (size_t i = 0; i < promises.size(); i++) {
+            if (results.hasException()) {
+              promises[i].setException(results.exception());
+            } else {
+              promises[i].setValue(std::move((*results)[i]));
+            }
+          }
+        });
+  }
+
+  const std::shared_ptr<DispatchState> state_;
+  const size_t maxBatchSize_;
+  const std::chrono::microseconds maxDelay_;
+};
+
+} // namespace fibers
+} // namespace folly
@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include <vector>
 
@@ -24,7 +26,9 @@
 #include <folly/Memory.h>
 #include <folly/Random.h>
 #include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
 #include <folly/coro/GtestHelpers.h>
+#include <folly/coro/Task.h>
 #include <folly/coro/Timeout.h>
 #include <folly/coro/WithCancellation.h>
 #include <folly/executors/CPUThreadPoolExecutor.h>
@@ -37,13 +41,19 @@
 #include <folly/fibers/FiberManager.h>
 #include <folly/fibers/FiberManagerMap.h>
 #include <folly/fibers/GenericBaton.h>
+#include <folly/fibers/GuardPageAllocator.h>
 #include <folly/fibers/Semaphore.h>
 #include <folly/fibers/SimpleLoopController.h>
+#include <folly/fibers/TimedBatchDispatcher.h>
 #include <folly/fibers/TimedMutex.h>
 #include <folly/fibers/WhenN.h>
 #include <folly/futures/Future.h>
+#include <folly/futures/ManualTimekeeper.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/lang/Hint.h>
 #include <folly/portability/GTest.h>
+#include <folly/portability/SysMman.h>
+#include <folly/portability/Unistd.h>
 #include <folly/tracing/AsyncStack.h>
 
 using namespace folly::fibers;
@@ -1594,6 +1604,190 @@ TEST(FiberManager, resizePeriodically) {
   std::this_thread::sleep_for(std::chrono::milliseconds(400));
 }
 
+TEST(FiberManager, releaseIdleStacks) {
+  if (!folly::kIsLinux || folly::kIsSanitize) {
+    GTEST_SKIP() << "Stacks are only released on Linux";
+  }
+  FiberManager::Options opts;
+  opts.fibersPoolResizePeriodMs = 50;
+  opts.releaseIdleStacks = true;
+
+  FiberManager manager(std::make_unique<EventBaseLoopController>(), opts);
+
+  folly::EventBase evb;
+  dynamic_cast<EventBaseLoopController&>(manager.loopController())
+      .attachEventBase(evb);
+
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::pair<void*, size_t> stack;
+  auto task = [&] {
+    stack = manager.currentFiber()->getStack();
+    std::array<char, 8192> buffer;
+    memset(buffer.data(), 1, buffer.size());
+    folly::compiler_must_not_elide(buffer);
+  };
+  auto residentPages = [&] {
+    auto begin = reinterpret_cast<uintptr_t>(stack.first);
+    auto end = begin + stack.second;
+    begin = begin / pageSize * pageSize;
+    std::vector<unsigned char> pages((end - begin + pageSize - 1) / pageSize);
+    PCHECK(
+        mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) ==
+        0);
+    return std::count_if(
+        pages.begin(), pages.end(), [](unsigned char p) { return p & 1; });
+  };
+
+  manager.addTask(task);
+  evb.loopOnce();
+  EXPECT_EQ(1, manager.fibersPoolSize());
+  auto busy = residentPages();
+  EXPECT_GE(busy, 8192 / pageSize);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(70));
+  evb.loopOnce(); // a fiber was active in this period
+  EXPECT_EQ(busy, residentPages());
+  std::this_thread::sleep_for(std::chrono::milliseconds(70));
+  evb.loopOnce(); // no fibers active in this period
+  EXPECT_LT(residentPages(), busy);
+
+  auto before = stack;
+  manager.addTask(task);
+  evb.loopOnce();
+  EXPECT_EQ(before, stack);
+  EXPECT_EQ(busy, residentPages());
+}
+
+TEST(FiberManager, sharedStackPool) {
+  FiberManager::Options opts;
+  opts.guardPagesPerStack = 0;
+  opts.maxFibersPoolSize = 0;
+  opts.useSharedStackPool = true;
+
+  FiberManager manager1(std::make_unique<SimpleLoopController>(), opts);
+  FiberManager manager2(std::make_unique<SimpleLoopController>(), opts);
+  auto& pool = SharedStackPool::instance();
+  auto cachedStacks = pool.cachedStacks();
+
+  auto run = [](FiberManager& manager) {
+    auto& loopController =
+        dynamic_cast<SimpleLoopController&>(manager.loopController());
+    bool ran = false;
+    manager.addTask([&] { ran = true; });
+    loopController.loop([&] { loopController.stop(); });
+    EXPECT_TRUE(ran);
+  };
+
+  // The stack of the fiber is cached when the fiber is freed...
+  run(manager1);
+  EXPECT_EQ(0, manager1.fibersAllocated());
+  EXPECT_EQ(cachedStacks + 1, pool.cachedStacks());
+  // ... and reused by the other FiberManager.
+  run(manager2);
+  EXPECT_EQ(cachedStacks + 1, pool.cachedStacks());
+}
+
+TEST(FiberManager, taskStackSize) {
+  FiberManager::Options opts;
+  opts.stackSizeMultiplier = 1;
+  FiberManager manager(std::make_unique<SimpleLoopController>(), opts);
+  auto& loopController =
+      dynamic_cast<SimpleLoopController&>(manager.loopController());
+
+  auto runTask = [&](TaskOptions taskOptions) {
+    size_t stackSize = 0;
+    manager.addTask(
+        [&] { stackSize = manager.currentFiber()->getStack().second; },
+        std::move(taskOptions));
+    loopController.loop([&] { loopController.stop(); });
+    return stackSize;
+  };
+
+  TaskOptions small;
+  small.stackSize = 5000;
+  TaskOptions large;
+  large.stackSize = 64 * 1024;
+  EXPECT_EQ(opts.stackSize, runTask(TaskOptions()));
+  EXPECT_EQ(8 * 1024, runTask(small));
+  EXPECT_EQ(64 * 1024, runTask(large));
+  EXPECT_EQ(3, manager.fibersPoolSize());
+
+  // Each fiber is reused for tasks with the same stack size.
+  EXPECT_EQ(8 * 1024, runTask(small));
+  EXPECT_EQ(opts.stackSize, runTask(TaskOptions()));
+  EXPECT_EQ(3, manager.fibersAllocated());
+}
+
+TEST(FiberManager, stackSizeProfile) {
+  if (folly::kIsSanitizeAddress) {
+    // Stack usage is not recorded.
+    return;
+  }
+  FiberManager::Options opts;
+  opts.stackSize = 64 * 1024;
+  opts.stackSizeMultiplier = 1;
+  opts.recordStackEvery = 1;
+  FiberManager manager(std::make_unique<SimpleLoopController>(), opts);
+  auto& loopController =
+      dynamic_cast<SimpleLoopController&>(manager.loopController());
+
+  StackSizeProfile profile(/* minSamples= */ 10);
+  TaskOptions taskOptions;
+  taskOptions.stackSizeProfile = &profile;
+  auto runTask = [&] {
+    size_t stackSize = 0;
+    manager.addTask(
+        [&] { stackSize = manager.currentFiber()->getStack().second; },
+        taskOptions);
+    loopController.loop([&] { loopController.stop(); });
+    return stackSize;
+  };
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(opts.stackSize, runTask());
+  }
+  EXPECT_GT(profile.highWatermark(), 0);
+  EXPECT_EQ(profile.stackSize(), runTask());
+  EXPECT_LT(profile.stackSize(), opts.stackSize);
+  EXPECT_GE(profile.stackSize(), 2 * profile.highWatermark());
+}
+
+TEST(SharedStackPool, trim) {
+  const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  const size_t kStackSize = 16 * kPageSize;
+  SharedStackPool pool;
+
+  auto stack = pool.allocate(kStackSize);
+  std::memset(stack, 0xab, kStackSize);
+  // The fibers used the top page.
+  pool.deallocate(stack, kStackSize, kPageSize / 2);
+  EXPECT_EQ(1, pool.cachedStacks());
+
+  // Only the stacks that were idle for a whole period are trimmed.
+  pool.trim();
+  EXPECT_EQ(stack, pool.allocate(kStackSize));
+  EXPECT_EQ(0xab, stack[0]);
+  pool.deallocate(stack, kStackSize, kPageSize / 2);
+  pool.trim();
+  pool.trim();
+
+  EXPECT_EQ(stack, pool.allocate(kStackSize));
+  EXPECT_EQ(0, stack[0]);
+  EXPECT_EQ(0, stack[kStackSize - kPageSize - 1]);
+  EXPECT_EQ(0xab, stack[kStackSize - kPageSize]);
+  EXPECT_EQ(0xab, stack[kStackSize - 1]);
+  pool.deallocate(stack, kStackSize, 0);
+
+  SharedStackPool::Options options;
+  options.maxStacksPerNode = 1;
+  SharedStackPool smallPool(options);
+  auto stack1 = smallPool.allocate(kStackSize);
+  auto stack2 = smallPool.allocate(kStackSize);
+  smallPool.deallocate(stack1, kStackSize, 0);
+  smallPool.deallocate(stack2, kStackSize, 0);
+  EXPECT_EQ(1, smallPool.cachedStacks());
+}
+
 TEST(FiberManager, batonWaitTimeoutHandler) {
   FiberManager manager(std::make_unique<EventBaseLoopController>());
 
@@ -2297,6 +2491,165 @@ TEST(FiberManager, batchDispatchExceptionHandlingTest) {
   evb.loop();
 }
 
+namespace {
+TimedBatchDispatcher<int, std::string>::DispatchFunctionT toStringDispatch(
+    std::vector<size_t>& batchSizes) {
+  return [&batchSizes](std::vector<int>&& batch) {
+    batchSizes.push_back(batch.size());
+    std::vector<std::string> results;
+    for (auto& it : batch) {
+      results.push_back(folly::to<std::string>(it));
+    }
+    return folly::makeSemiFuture(std::move(results));
+  };
+}
+} // namespace
+
+TEST(FiberManager, timedBatchDispatchSizeTest) {
+  folly::EventBase evb;
+  auto& executor = getFiberManager(evb);
+  folly::ManualTimekeeper timekeeper;
+  std::vector<size_t> batchSizes;
+  TimedBatchDispatcher<int, std::string> batchDispatcher(
+      evb,
+      toStringDispatch(batchSizes),
+      5,
+      std::chrono::seconds(1),
+      &timekeeper);
+
+  // Full batches are dispatched without waiting for the deadline.
+  for (int i = 0; i < 10; i++) {
+    executor.addTask([&, i] {
+      EXPECT_EQ(
+          folly::to<std::string>(i), batchDispatcher.add(int(i)).get());
+    });
+  }
+  evb.loop();
+  EXPECT_FALSE(executor.hasTasks());
+  EXPECT_EQ((std::vector<size_t>{5, 5}), batchSizes);
+}
+
+TEST(FiberManager, timedBatchDispatchDeadlineTest) {
+  folly::EventBase evb;
+  auto& executor = getFiberManager(evb);
+  folly::ManualTimekeeper timekeeper;
+  std::vector<size_t> batchSizes;
+  TimedBatchDispatcher<int, std::string> batchDispatcher(
+      evb,
+      toStringDispatch(batchSizes),
+      100,
+      std::chrono::milliseconds(10),
+      &timekeeper);
+
+  // Values added over several loop iterations are batched together.
+  int done = 0;
+  executor.addTask([&] {
+    for (int i = 0; i < 3; i++) {
+      executor.addTask([&, i] {
+        EXPECT_EQ(
+            folly::to<std::string>(i), batchDispatcher.add(int(i)).get());
+        ++done;
+      });
+      Baton baton;
+      baton.try_wait_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(0, done);
+    EXPECT_TRUE(batchSizes.empty());
+
+    timekeeper.advance(std::chrono::milliseconds(10));
+  });
+  evb.loop();
+  EXPECT_EQ(3, done);
+  EXPECT_EQ((std::vector<size_t>{3}), batchSizes);
+
+  // The next batch gets its own deadline.
+  auto result = batchDispatcher.add(3);
+  evb.loop();
+  EXPECT_FALSE(result.isReady());
+  timekeeper.advance(std::chrono::milliseconds(10));
+  evb.loop();
+  EXPECT_EQ("3", std::move(result).get());
+  EXPECT_EQ((std::vector<size_t>{3, 1}), batchSizes);
+}
+
+TEST(FiberManager, timedBatchDispatchCoroTest) {
+  folly::EventBase evb;
+  folly::ManualTimekeeper timekeeper;
+  std::vector<size_t> batchSizes;
+  TimedBatchDispatcher<int, std::string> batchDispatcher(
+      evb,
+      toStringDispatch(batchSizes),
+      2,
+      std::chrono::seconds(1),
+      &timekeeper);
+
+  auto lookup = [&](int i) -> folly::coro::Task<std::string> {
+    co_return co_await batchDispatcher.add(std::move(i));
+  };
+  auto [a, b] = folly::coro::blockingWait(
+      folly::coro::collectAll(lookup(1), lookup(2)), &evb);
+  EXPECT_EQ("1", a);
+  EXPECT_EQ("2", b);
+  EXPECT_EQ((std::vector<size_t>{2}), batchSizes);
+}
+
+TEST(FiberManager, timedBatchDispatchFlushTest) {
+  folly::EventBase evb;
+  folly::ManualTimekeeper timekeeper;
+  std::vector<size_t> batchSizes;
+  auto result = folly::SemiFuture<std::string>::makeEmpty();
+  {
+    TimedBatchDispatcher<int, std::string> batchDispatcher(
+        evb,
+        toStringDispatch(batchSizes),
+        100,
+        std::chrono::seconds(1),
+        &timekeeper);
+    batchDispatcher.add(1);
+    batchDispatcher.flush();
+    result = batchDispatcher.add(2);
+  }
+  // Pending values are dispatched on destruction.
+  evb.loop();
+  EXPECT_EQ("2", std::move(result).get());
+  EXPECT_EQ((std::vector<size_t>{1, 1}), batchSizes);
+  // The deadline of the flushed batches doesn't dispatch anything.
+  timekeeper.advance(std::chrono::seconds(1));
+  evb.loop();
+  EXPECT_EQ((std::vector<size_t>{1, 1}), batchSizes);
+}
+
+TEST(FiberManager, timedBatchDispatchExceptionHandlingTest) {
+  folly::EventBase evb;
+  folly::ManualTimekeeper timekeeper;
+  TimedBatchDispatcher<int, int> batchDispatcher(
+      evb,
+      [](std::vector<int>&&) -> folly::SemiFuture<std::vector<int>> {
+        throw std::runtime_error("Surprise!!");
+      },
+      2,
+      std::chrono::seconds(1),
+      &timekeeper);
+  TimedBatchDispatcher<int, int> shortBatchDispatcher(
+      evb,
+      [](std::vector<int>&&) {
+        return folly::makeSemiFuture(std::vector<int>{});
+      },
+      2,
+      std::chrono::seconds(1),
+      &timekeeper);
+
+  auto a = batchDispatcher.add(1);
+  auto b = batchDispatcher.add(2);
+  auto c = shortBatchDispatcher.add(1);
+  auto d = shortBatchDispatcher.add(2);
+  evb.loop();
+  EXPECT_THROW(std::move(a).get(), std::runtime_error);
+  EXPECT_THROW(std::move(b).get(), std::runtime_error);
+  EXPECT_THROW(std::move(c).get(), std::logic_error);
+  EXPECT_THROW(std::move(d).get(), std::logic_error);
+}
+
 namespace AtomicBatchDispatcherTesting {
 
 using ValueT = size_t;
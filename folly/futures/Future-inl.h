@@ -2154,7 +2154,14 @@ SemiFuture<T> SemiFuture<T>::within(
     }
     Promise<T> promise;
     explicit Context(E ex)
-        : ContextBase(goPromiseSetException, exception_wrapper(std::move(ex))) {
+        : ContextBase(goPromiseSetException, make_exception(std::move(ex))) {}
+    static exception_wrapper make_exception(E&& ex) {
+      // the default timeout error is stateless and may be shared
+      if constexpr (std::is_same_v<E, FutureTimeout>) {
+        return exception_wrapper{static_exception_ptr<FutureTimeout>()};
+      } else {
+        return exception_wrapper(std::move(ex));
+      }
     }
   };
 
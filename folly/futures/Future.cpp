@@ -19,6 +19,7 @@
 #include <folly/Likely.h>
 #include <folly/Singleton.h>
 #include <folly/futures/HeapTimekeeper.h>
+#include <folly/futures/ShardedTimekeeper.h>
 #include <folly/futures/ThreadWheelTimekeeper.h>
 #include <folly/portability/GFlags.h>
 
@@ -26,6 +27,11 @@ FOLLY_GFLAGS_DEFINE_bool(
     folly_futures_use_thread_wheel_timekeeper,
     false,
     "Use ThreadWheelTimekeeper for the default Future timekeeper singleton");
+FOLLY_GFLAGS_DEFINE_uint32(
+    folly_futures_timekeeper_shards,
+    0,
+    "If greater than 1, use a ShardedTimekeeper with this many shards for the "
+    "default Future timekeeper singleton");
 
 namespace folly {
 namespace futures {
@@ -51,7 +57,8 @@ void WithinAfterFutureCallback::operator()(Try<Unit>&& t) {
     return;
   }
   // "after" completed first, cancel "this"
-  lockedCtx->thisFuture.raise(FutureTimeout());
+  lockedCtx->thisFuture.raise(
+      exception_wrapper{static_exception_ptr<FutureTimeout>()});
   if (!lockedCtx->token.exchange(true, std::memory_order_relaxed)) {
     auto& exn = t.hasException() ? t.exception() : lockedCtx->exception;
     lockedCtx->doPromiseSetException(*lockedCtx, std::move(exn));
@@ -122,6 +129,8 @@ Singleton<Timekeeper, TimekeeperSingletonTag> gTimekeeperSingleton(
     []() -> Timekeeper* {
       if (FLAGS_folly_futures_use_thread_wheel_timekeeper) {
         return new ThreadWheelTimekeeper;
+      } else if (FLAGS_folly_futures_timekeeper_shards > 1) {
+        return new ShardedTimekeeper(FLAGS_folly_futures_timekeeper_shards);
       } else {
         return new HeapTimekeeper;
       }
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/futures/ShardedTimekeeper.h>
+
+#include <algorithm>
+
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/system/HardwareConcurrency.h>
+
+namespace folly {
+
+ShardedTimekeeper::ShardedTimekeeper()
+    : ShardedTimekeeper(folly::hardware_concurrency()) {}
+
+ShardedTimekeeper::ShardedTimekeeper(size_t numShards) {
+  shards_.resize(std::max<size_t>(numShards, 1));
+  for (auto& shard : shards_) {
+    shard = std::make_unique<HeapTimekeeper>();
+  }
+}
+
+ShardedTimekeeper::~ShardedTimekeeper() = default;
+
+SemiFuture<Unit> ShardedTimekeeper::after(HighResDuration dur) {
+  return shards_[AccessSpreader<>::cachedCurrent(shards_.size())]->after(dur);
+}
+
+} // namespace folly
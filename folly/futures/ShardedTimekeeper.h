@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <folly/futures/Future.h>
+#include <folly/futures/HeapTimekeeper.h>
+
+namespace folly {
+
+/**
+ * A Timekeeper made of several HeapTimekeeper shards, each with its own
+ * thread, so that scheduling timeouts from many threads at a high rate doesn't
+ * contend on a single queue. Timeouts are scheduled on the shard assigned to
+ * the current CPU by AccessSpreader, so threads which share a cache schedule
+ * on the same shard.
+ *
+ * By default there is one shard per CPU. The default Future timekeeper can be
+ * made sharded with --folly_futures_timekeeper_shards.
+ */
+class ShardedTimekeeper : public Timekeeper {
+ public:
+  ShardedTimekeeper();
+  explicit ShardedTimekeeper(size_t numShards);
+  ~ShardedTimekeeper() override;
+
+  SemiFuture<Unit> after(HighResDuration) override;
+
+  size_t numShards() const { return shards_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<HeapTimekeeper>> shards_;
+};
+
+} // namespace folly
@@ -16,6 +16,8 @@
 
 #include <folly/Benchmark.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <folly/executors/InlineExecutor.h>
@@ -51,6 +53,17 @@ void someThens(size_t n) {
   f = thens(std::move(f), n);
 }
 
+void someThensWithCaptures(size_t n) {
+  // Together these don't fit in the inline storage of a folly::Function.
+  auto ptr = std::make_shared<int>(1);
+  std::string str = "capture";
+  auto f = makeFuture<int>(42);
+  for (size_t i = 0; i < n; i++) {
+    f = std::move(f).thenValue(
+        [ptr, str, i](int x) { return x + *ptr + static_cast<int>(i); });
+  }
+}
+
 void someThensOnThread(size_t n, bool runInline = false) {
   auto executor = std::make_unique<TestExecutor>(1);
   auto f = makeFuture<int>(42).via(executor.get());
@@ -102,6 +115,11 @@ BENCHMARK_RELATIVE(hundredThens) {
   someThens(100);
 }
 
+// look for >= 25% relative
+BENCHMARK_RELATIVE(fourThensWithCaptures) {
+  someThensWithCaptures(4);
+}
+
 BENCHMARK_DRAW_LINE();
 
 // look for >= 25% relative
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/futures/ShardedTimekeeper.h>
+#include <folly/futures/test/TimekeeperTestLib.h>
+
+namespace folly {
+
+INSTANTIATE_TYPED_TEST_SUITE_P(
+    ShardedTimekeeperTest, TimekeeperTest, ShardedTimekeeper);
+
+TEST(ShardedTimekeeperTest, NumShards) {
+  EXPECT_EQ(4, ShardedTimekeeper(4).numShards());
+  EXPECT_EQ(1, ShardedTimekeeper(0).numShards());
+
+  ShardedTimekeeper tk(2);
+  std::vector<SemiFuture<Unit>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(tk.after(std::chrono::milliseconds(i % 10)));
+  }
+  for (auto& future : futures) {
+    EXPECT_NO_THROW(std::move(future).get());
+  }
+}
+
+} // namespace folly
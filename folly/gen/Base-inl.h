@@ -20,6 +20,7 @@
 
 #include <folly/Function.h>
 #include <folly/Portability.h>
+#include <folly/Random.h>
 #include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 #include <folly/functional/Invoke.h>
@@ -890,14 +891,20 @@ class Sample : public Operator<Sample<Random>> {
       // use reservoir sampling to give each source value an equal chance
       // of appearing in our output.
       size_t n = 1;
+      // The random values are drawn by blocks, and reduced to [0, n) by a
+      // multiply rather than a modulus (see folly::Random::fill()).
+      uint64_t draws[64];
+      size_t drawn = std::size(draws);
       source_.foreach([&](Value value) -> void {
         if (v.size() < count_) {
           v.push_back(std::forward<Value>(value));
         } else {
-          // alternatively, we could create a std::uniform_int_distribution
-          // instead of using modulus, but benchmarks show this has
-          // substantial overhead.
-          size_t index = rng_() % n;
+          if (drawn == std::size(draws)) {
+            folly::Random::fill(span<uint64_t>(draws), rng_);
+            drawn = 0;
+          }
+          auto const index = folly::detail::randomBounded<uint64_t>(
+              draws[drawn++], n, [&] { return folly::Random::rand64(rng_); });
           if (index < v.size()) {
             v[index] = std::forward<Value>(value);
           }
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FOLLY_GEN_EXECUTORMAP_H_
+#error This file may only be included from folly/gen/ExecutorMap.h
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/functional/Invoke.h>
+#include <folly/system/HardwareConcurrency.h>
+
+namespace folly::gen::detail {
+
+/**
+ * ExecutorMap - Map in parallel, on the tasks of an executor. For producing
+ * a sequence of values by passing chunks of the values from a source
+ * collection through a predicate, each chunk in a task of the executor.
+ *
+ * This type is usually used through the 'pmapOn' and 'pmapOnUnordered'
+ * helper functions:
+ *
+ *   auto squares = seq(1, 10) | pmapOn(executor, fibonacci) | sum;
+ */
+template <class Predicate, bool Ordered>
+class ExecutorMap : public Operator<ExecutorMap<Predicate, Ordered>> {
+  Executor::KeepAlive<> executor_;
+  Predicate pred_;
+  size_t chunkSize_;
+  size_t maxChunks_;
+
+ public:
+  ExecutorMap(
+      Executor::KeepAlive<> executor,
+      Predicate pred,
+      size_t chunkSize,
+      size_t maxChunks)
+      : executor_(std::move(executor)),
+        pred_(std::move(pred)),
+        chunkSize_(std::max<size_t>(chunkSize, 1)),
+        maxChunks_(maxChunks ? maxChunks : 2 * hardware_concurrency()) {}
+
+  template <
+      class Value,
+      class Source,
+      class Input = typename std::decay<Value>::type,
+      class Output =
+          typename std::decay<invoke_result_t<Predicate, Value>>::type>
+  class Generator
+      : public GenImpl<Output, Generator<Value, Source, Input, Output>> {
+    Source source_;
+    Executor::KeepAlive<> executor_;
+    Predicate pred_;
+    const size_t chunkSize_;
+    const size_t maxChunks_;
+
+    struct Chunk {
+      std::vector<Input> inputs;
+      std::vector<Output> outputs;
+      std::exception_ptr error;
+      // Guarded by State::mutex.
+      bool done = false;
+    };
+
+    // Shared with the tasks, which may still hold the mutex when the caller
+    // sees that their chunk is done.
+    struct State {
+      std::mutex mutex;
+      std::condition_variable cv;
+    };
+
+    class ExecutionPipeline {
+      Executor& executor_;
+      const Predicate& pred_;
+      const size_t chunkSize_;
+      std::shared_ptr<State> state_ = std::make_shared<State>();
+      // The values of the next chunk.
+      std::vector<Input> inputs_;
+      // The chunks whose results haven't been read, oldest first.
+      std::deque<std::shared_ptr<Chunk>> chunks_;
+
+      static void run(State& state, Chunk& chunk, const Predicate& pred) {
+        try {
+          chunk.outputs.reserve(chunk.inputs.size());
+          for (auto& in : chunk.inputs) {
+            chunk.outputs.push_back(pred(std::move(in)));
+          }
+        } catch (...) {
+          chunk.error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        chunk.done = true;
+        state.cv.notify_one();
+      }
+
+     public:
+      ExecutionPipeline(
+          Executor& executor, const Predicate& pred, size_t chunkSize)
+          : executor_(executor), pred_(pred), chunkSize_(chunkSize) {}
+
+      ~ExecutionPipeline() {
+        // The tasks use pred_, so they must be done even if the results
+        // weren't all consumed, due to an exception or to termination
+        // requested by the consumer like take(n).
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->cv.wait(lock, [&] {
+          return std::all_of(chunks_.begin(), chunks_.end(), [](auto& c) {
+            return c->done;
+          });
+        });
+      }
+
+      size_t size() const { return chunks_.size(); }
+
+      // Adds value to the next chunk, and returns whether that started it.
+      bool write(Value&& value) {
+        inputs_.push_back(std::forward<Value>(value));
+        if (inputs_.size() < chunkSize_) {
+          return false;
+        }
+        flush();
+        return true;
+      }
+
+      // Starts the next chunk, if it has any value.
+      void flush() {
+        if (inputs_.empty()) {
+          return;
+        }
+        auto chunk = std::make_shared<Chunk>();
+        chunk->inputs = std::exchange(inputs_, {});
+        chunks_.push_back(chunk);
+        try {
+          executor_.add([state = state_, chunk, pred = &pred_] {
+            run(*state, *chunk, *pred);
+          });
+        } catch (...) {
+          // The caller runs the chunks which the executor rejects.
+          run(*state_, *chunk, pred_);
+        }
+      }
+
+      // Removes and returns the next chunk whose results can be consumed:
+      // the oldest one if Ordered, or any done one otherwise. Waits for it
+      // if wait, and returns nullptr if there is none.
+      std::shared_ptr<Chunk> read(bool wait) {
+        if (chunks_.empty()) {
+          return nullptr;
+        }
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        auto next = [&] {
+          if constexpr (Ordered) {
+            return chunks_.front()->done ? chunks_.begin() : chunks_.end();
+          } else {
+            return std::find_if(chunks_.begin(), chunks_.end(), [](auto& c) {
+              return c->done;
+            });
+          }
+        };
+        auto it = next();
+        if (wait) {
+          state_->cv.wait(lock, [&] { return (it = next()) != chunks_.end(); });
+        }
+        if (it == chunks_.end()) {
+          return nullptr;
+        }
+        auto chunk = std::move(*it);
+        chunks_.erase(it);
+        return chunk;
+      }
+    };
+
+   public:
+    Generator(
+        Source source,
+        Executor::KeepAlive<> executor,
+        const Predicate& pred,
+        size_t chunkSize,
+        size_t maxChunks)
+        : source_(std::move(source)),
+          executor_(std::move(executor)),
+          pred_(pred),
+          chunkSize_(chunkSize),
+          maxChunks_(maxChunks) {}
+
+    template <class Handler>
+    bool apply(Handler&& handler) const {
+      ExecutionPipeline pipeline(*executor_, pred_, chunkSize_);
+
+      // Passes the results of the chunks which are done to handler, waiting
+      // while more than maxChunks are in flight.
+      auto drain = [&](size_t maxChunks) {
+        while (auto chunk = pipeline.read(pipeline.size() > maxChunks)) {
+          if (chunk->error) {
+            std::rethrow_exception(chunk->error);
+          }
+          for (auto& out : chunk->outputs) {
+            if (!handler(std::move(out))) {
+              return false;
+            }
+          }
+        }
+        return true;
+      };
+
+      if (!source_.apply([&](Value value) {
+            return !pipeline.write(std::forward<Value>(value)) ||
+                drain(maxChunks_);
+          })) {
+        return false;
+      }
+
+      // flush the last chunk, and wait for all of them
+      pipeline.flush();
+      return drain(0);
+    }
+
+    static constexpr bool infinite = Source::infinite;
+  };
+
+  template <class Source, class Value, class Gen = Generator<Value, Source>>
+  Gen compose(GenImpl<Value, Source>&& source) const {
+    return Gen(
+        std::move(source.self()), executor_, pred_, chunkSize_, maxChunks_);
+  }
+
+  template <class Source, class Value, class Gen = Generator<Value, Source>>
+  Gen compose(const GenImpl<Value, Source>& source) const {
+    return Gen(source.self(), executor_, pred_, chunkSize_, maxChunks_);
+  }
+};
+
+} // namespace folly::gen::detail
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#define FOLLY_GEN_EXECUTORMAP_H_
+
+#include <folly/Executor.h>
+#include <folly/gen/Core.h>
+
+namespace folly {
+namespace gen {
+
+namespace detail {
+
+template <class Predicate, bool Ordered>
+class ExecutorMap;
+
+} // namespace detail
+
+/**
+ * Run `pred` on the tasks of `executor`, such as a CPUThreadPoolExecutor
+ * shared by all the pipelines of a process, rather than on threads of its
+ * own like pmap. Results are returned in the same order in which they were
+ * retrieved from the source generator (similar to map).
+ *
+ * The values are passed to the tasks in chunks of `chunkSize`, so that
+ * cheap predicates aren't dominated by the cost of scheduling a task. At
+ * most `maxChunks` chunks are in flight, 2 per CPU by default: the source
+ * isn't read further until the oldest chunk is done, which bounds the
+ * memory held by a slow consumer.
+ *
+ *   auto squares = seq(1, 1000)
+ *     | pmapOn(getGlobalCPUExecutor(), fibonacci, 16)
+ *     | sum;
+ *
+ * NOTE: Only `pred` is run on the executor; the source generator and the
+ *       rest of the pipeline is executed in the caller thread, which blocks
+ *       while waiting for results. So the executor must not be the one the
+ *       caller runs on, unless it has other threads.
+ */
+template <class Predicate, class Map = detail::ExecutorMap<Predicate, true>>
+Map pmapOn(
+    Executor::KeepAlive<> executor,
+    Predicate pred,
+    size_t chunkSize = 1,
+    size_t maxChunks = 0) {
+  return Map(std::move(executor), std::move(pred), chunkSize, maxChunks);
+}
+
+/**
+ * Same as pmapOn, but results are returned as soon as their chunk is done,
+ * so that a slow value doesn't hold back the results of the values after
+ * it.
+ */
+template <class Predicate, class Map = detail::ExecutorMap<Predicate, false>>
+Map pmapOnUnordered(
+    Executor::KeepAlive<> executor,
+    Predicate pred,
+    size_t chunkSize = 1,
+    size_t maxChunks = 0) {
+  return Map(std::move(executor), std::move(pred), chunkSize, maxChunks);
+}
+} // namespace gen
+} // namespace folly
+
+#include <folly/gen/ExecutorMap-inl.h>
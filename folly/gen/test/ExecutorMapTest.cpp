@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/gen/ExecutorMap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
+#include <folly/gen/Base.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly::gen;
+
+namespace {
+
+struct ExecutorMapTest : testing::Test {
+  folly::CPUThreadPoolExecutor executor{4};
+
+  static std::vector<int> squares(int n) {
+    return seq(1, n) | map([](int x) { return x * x; }) |
+        as<std::vector<int>>();
+  }
+};
+
+} // namespace
+
+TEST_F(ExecutorMapTest, Ordered) {
+  for (size_t chunkSize : {1, 3, 100}) {
+    for (size_t maxChunks : {1, 2, 0}) {
+      auto result = seq(1, 1000) |
+          pmapOn(&executor, [](int x) { return x * x; }, chunkSize, maxChunks) |
+          as<std::vector<int>>();
+      EXPECT_EQ(squares(1000), result);
+    }
+  }
+}
+
+TEST_F(ExecutorMapTest, Unordered) {
+  for (size_t chunkSize : {1, 7}) {
+    auto result = seq(1, 1000) |
+        pmapOnUnordered(
+                      &executor,
+                      [](int x) {
+                        if (x % 10 == 0) {
+                          std::this_thread::yield();
+                        }
+                        return x * x;
+                      },
+                      chunkSize) |
+        as<std::vector<int>>();
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(squares(1000), result);
+  }
+}
+
+TEST_F(ExecutorMapTest, Empty) {
+  auto result = seq(1, 0) | pmapOn(&executor, [](int x) { return x * x; }) |
+      as<std::vector<int>>();
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(ExecutorMapTest, Infinite) {
+  auto result = seq(1) | pmapOn(&executor, [](int x) { return x * x; }, 5) |
+      until([](int x) { return x > 1000 * 1000; }) | as<std::vector<int>>();
+  EXPECT_EQ(squares(1000), result);
+}
+
+TEST_F(ExecutorMapTest, Take) {
+  std::atomic<int> calls{0};
+  auto result = seq(1) | pmapOn(
+                             &executor,
+                             [&](int x) {
+                               ++calls;
+                               return x;
+                             },
+                             4,
+                             2) |
+      take(10) | as<std::vector<int>>();
+  EXPECT_EQ(seq(1, 10) | as<std::vector<int>>(), result);
+  // At most the chunks in flight, and the one being filled, are wasted.
+  EXPECT_LE(calls.load(), 10 + 3 * 4);
+}
+
+TEST_F(ExecutorMapTest, Exception) {
+  auto pipeline = seq(1, 1000) | pmapOn(&executor, [](int x) {
+                    if (x == 500) {
+                      throw std::runtime_error("500");
+                    }
+                    return x;
+                  });
+  EXPECT_THROW(pipeline | sum, std::runtime_error);
+}
+
+TEST_F(ExecutorMapTest, Inline) {
+  // An executor which runs the tasks in add() makes it a map.
+  auto result = seq(1, 100) |
+      pmapOn(&folly::InlineExecutor::instance(), [](int x) { return x * x; }) |
+      as<std::vector<int>>();
+  EXPECT_EQ(squares(100), result);
+}
+
+TEST_F(ExecutorMapTest, MoveOnly) {
+  auto result = seq(1, 100) |
+      map([](int x) { return std::make_unique<int>(x); }) |
+      pmapOn(&executor, [](std::unique_ptr<int> p) { return *p * 2; }, 8) |
+      sum;
+  EXPECT_EQ(100 * 101, result);
+}
@@ -17,11 +17,11 @@
 #include <folly/hash/Checksum.h>
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/crc.hpp>
 
-#include <folly/CpuId.h>
 #include <folly/detail/TrapOnAvx512.h>
 #include <folly/external/fast-crc32/avx512_crc32c_v8s3x4.h> // @manual
 #include <folly/external/fast-crc32/neon_crc32c_v3s4x2e_v2.h> // @manual
@@ -29,12 +29,17 @@
 #include <folly/external/fast-crc32/neon_eor3_crc32c_v8s2x4_s3.h> // @manual
 #include <folly/external/fast-crc32/sse_crc32c_v8s3x3.h> // @manual
 #include <folly/hash/detail/ChecksumDetail.h>
+#include <folly/system/CpuDispatch.h>
 
 #if FOLLY_SSE_PREREQ(4, 2)
 #include <emmintrin.h>
 #include <nmmintrin.h>
 #endif
 
+#if FOLLY_ARM_FEATURE_CRC32
+#include <arm_acle.h>
+#endif
+
 namespace folly {
 
 namespace detail {
@@ -78,19 +83,17 @@ bool crc32c_hw_supported() {
 }
 
 bool crc32c_hw_supported_sse42() {
-  static folly::CpuId id;
-  return id.sse42();
+  return cpuFeatures().cpuId.sse42();
 }
 
 bool crc32c_hw_supported_avx512() {
-  static folly::CpuId id;
-  static bool supported = id.avx512vl() && !detail::hasTrapOnAvx512();
+  static bool supported =
+      cpuFeatures().cpuId.avx512vl() && !detail::hasTrapOnAvx512();
   return supported;
 }
 
 bool crc32_hw_supported() {
-  static folly::CpuId id;
-  return id.sse42();
+  return cpuFeatures().cpuId.sse42();
 }
 
 bool crc32c_hw_supported_neon() {
@@ -212,51 +215,277 @@ uint32_t crc32_sw(
   return crc_sw<CRC32_POLYNOMIAL>(data, nbytes, startingChecksum);
 }
 
+#if (FOLLY_X64 && FOLLY_SSE_PREREQ(4, 2)) || \
+    (FOLLY_AARCH64 && FOLLY_ARM_FEATURE_CRC32)
+
+namespace {
+
+// The checksum loop below has a statement per lane.
+constexpr size_t kMultiLanes = 4;
+// Larger buffers are passed to crc32c(), which interleaves within the buffer.
+constexpr size_t kMultiMaxLength = 256;
+
+// The checksum is kept in 64 bits, as _mm_crc32_u64() takes it, to avoid
+// zero-extending it at every step.
+FOLLY_ALWAYS_INLINE uint64_t crc32c_u64(uint64_t crc, const uint8_t* data) {
+  uint64_t val;
+  std::memcpy(&val, data, sizeof(val));
+#if FOLLY_SSE_PREREQ(4, 2)
+  return _mm_crc32_u64(crc, val);
+#else
+  return __crc32cd(static_cast<uint32_t>(crc), val);
+#endif
+}
+
+// Checksums the last len < 8 bytes of a buffer.
+FOLLY_ALWAYS_INLINE uint32_t
+crc32c_tail(uint32_t crc, const uint8_t* data, size_t len) {
+  if (len & 4) {
+    uint32_t val;
+    std::memcpy(&val, data, sizeof(val));
+#if FOLLY_SSE_PREREQ(4, 2)
+    crc = _mm_crc32_u32(crc, val);
+#else
+    crc = __crc32cw(crc, val);
+#endif
+    data += sizeof(val);
+  }
+  if (len & 2) {
+    uint16_t val;
+    std::memcpy(&val, data, sizeof(val));
+#if FOLLY_SSE_PREREQ(4, 2)
+    crc = _mm_crc32_u16(crc, val);
+#else
+    crc = __crc32ch(crc, val);
+#endif
+    data += sizeof(val);
+  }
+  if (len & 1) {
+#if FOLLY_SSE_PREREQ(4, 2)
+    crc = _mm_crc32_u8(crc, *data);
+#else
+    crc = __crc32cb(crc, *data);
+#endif
+  }
+  return crc;
+}
+
+} // namespace
+
+void crc32c_multi_hw(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum) {
+  // Each lane checksums one buffer.
+  const uint8_t* next[kMultiLanes];
+  size_t left[kMultiLanes];
+  uint32_t crc[kMultiLanes];
+  size_t index[kMultiLanes];
+
+  size_t i = 0;
+  // Moves the next small buffer into lane, and returns false if there is
+  // none left.
+  auto fill = [&](size_t lane) {
+    for (; i < count; ++i) {
+      if (nbytes[i] > kMultiMaxLength) {
+        checksums[i] = crc32c(data[i], nbytes[i], startingChecksum);
+        continue;
+      }
+      next[lane] = data[i];
+      left[lane] = nbytes[i];
+      crc[lane] = startingChecksum;
+      index[lane] = i++;
+      return true;
+    }
+    return false;
+  };
+
+  size_t active = 0;
+  while (active < kMultiLanes && fill(active)) {
+    ++active;
+  }
+  while (active == kMultiLanes) {
+    // Run all the lanes until one of them has less than 8 bytes left, with
+    // independent dependency chains.
+    size_t steps = left[0];
+    for (size_t lane = 1; lane < kMultiLanes; ++lane) {
+      steps = std::min(steps, left[lane]);
+    }
+    steps /= 8;
+    // Spelled out, so that the checksums stay in registers.
+    uint64_t crc0 = crc[0], crc1 = crc[1], crc2 = crc[2], crc3 = crc[3];
+    for (size_t offset = 0; offset < 8 * steps; offset += 8) {
+      crc0 = crc32c_u64(crc0, next[0] + offset);
+      crc1 = crc32c_u64(crc1, next[1] + offset);
+      crc2 = crc32c_u64(crc2, next[2] + offset);
+      crc3 = crc32c_u64(crc3, next[3] + offset);
+    }
+    crc[0] = static_cast<uint32_t>(crc0);
+    crc[1] = static_cast<uint32_t>(crc1);
+    crc[2] = static_cast<uint32_t>(crc2);
+    crc[3] = static_cast<uint32_t>(crc3);
+    for (size_t lane = 0; lane < kMultiLanes; ++lane) {
+      next[lane] += 8 * steps;
+      left[lane] -= 8 * steps;
+    }
+
+    // Finish the lanes that are done, and refill them, or else move the
+    // last lane into their place.
+    for (size_t lane = 0; lane < active;) {
+      if (left[lane] >= 8) {
+        ++lane;
+        continue;
+      }
+      checksums[index[lane]] = crc32c_tail(crc[lane], next[lane], left[lane]);
+      if (!fill(lane)) {
+        --active;
+        next[lane] = next[active];
+        left[lane] = left[active];
+        crc[lane] = crc[active];
+        index[lane] = index[active];
+      }
+    }
+  }
+
+  // Fewer buffers than lanes are left, so there is nothing to interleave.
+  for (size_t lane = 0; lane < active; ++lane) {
+    checksums[index[lane]] = crc32c_hw(next[lane], left[lane], crc[lane]);
+  }
+}
+
+#else
+
+void crc32c_multi_hw(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum) {
+  for (size_t i = 0; i < count; ++i) {
+    checksums[i] = crc32c_hw(data[i], nbytes[i], startingChecksum);
+  }
+}
+
+#endif
+
 } // namespace detail
 
-uint32_t crc32c(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+namespace {
+
+using ChecksumFn = uint32_t(const uint8_t*, size_t, uint32_t);
+
+// The implementations of crc32c() and crc32(), one per set of CPU features,
+// each of which calls the fastest of the kernels for the size of the data.
+
+uint32_t crc32c_hw_any(
+    const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+#if defined(FOLLY_ENABLE_SSE42_CRC32C_V8S3X3)
+  if (nbytes > 4096) {
+    return detail::sse_crc32c_v8s3x3(data, nbytes, startingChecksum);
+  }
+#endif
+  return detail::crc32c_hw(data, nbytes, startingChecksum);
+}
+
 #if defined(FOLLY_ENABLE_AVX512_CRC32C_V8S3X4)
-  if (detail::crc32c_hw_supported_avx512() && nbytes > 4096) {
+uint32_t crc32c_avx512(
+    const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  if (nbytes > 4096) {
     return detail::avx512_crc32c_v8s3x4(data, nbytes, startingChecksum);
   }
+  return crc32c_hw_any(data, nbytes, startingChecksum);
+}
 #endif
 
 #if FOLLY_AARCH64
-  if (nbytes >= 2048 && detail::crc32c_hw_supported_neon_eor3_sha3()) {
+uint32_t crc32c_neon_eor3(
+    const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  if (nbytes >= 2048) {
     return detail::neon_eor3_crc32c_v8s2x4_s3(data, nbytes, startingChecksum);
   }
+  return crc32c_hw_any(data, nbytes, startingChecksum);
+}
 
-  if (nbytes >= 4096 && detail::crc32c_hw_supported_neon()) {
+uint32_t crc32c_neon(
+    const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  if (nbytes >= 4096) {
     return detail::neon_crc32c_v3s4x2e_v2(data, nbytes, startingChecksum);
   }
+  return crc32c_hw_any(data, nbytes, startingChecksum);
+}
+
+uint32_t crc32_neon_eor3(
+    const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  if (nbytes >= 2048) {
+    return detail::neon_eor3_crc32_v9s3x2e_s3(data, nbytes, startingChecksum);
+  }
+  return detail::crc32_hw(data, nbytes, startingChecksum);
+}
 #endif
 
-  if (detail::crc32c_hw_supported()) {
-#if defined(FOLLY_ENABLE_SSE42_CRC32C_V8S3X3)
-    if (nbytes > 4096) {
-      return detail::sse_crc32c_v8s3x3(data, nbytes, startingChecksum);
-    }
+// The crc32*_hw_supported() functions check the CPU features.
+ChecksumFn* select_crc32c(const CpuFeatures&) {
+#if defined(FOLLY_ENABLE_AVX512_CRC32C_V8S3X4)
+  if (detail::crc32c_hw_supported_avx512()) {
+    return crc32c_avx512;
+  }
 #endif
-    return detail::crc32c_hw(data, nbytes, startingChecksum);
-  } else {
-    return detail::crc32c_sw(data, nbytes, startingChecksum);
+#if FOLLY_AARCH64
+  if (detail::crc32c_hw_supported_neon_eor3_sha3()) {
+    return crc32c_neon_eor3;
+  }
+  if (detail::crc32c_hw_supported_neon()) {
+    return crc32c_neon;
+  }
+#endif
+  if (detail::crc32c_hw_supported()) {
+    return crc32c_hw_any;
   }
+  return detail::crc32c_sw;
 }
 
-uint32_t crc32(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+ChecksumFn* select_crc32(const CpuFeatures&) {
 #if FOLLY_AARCH64
-  if (nbytes >= 2048 && detail::crc32_hw_supported_neon_eor3_sha3()) {
-    return detail::neon_eor3_crc32_v9s3x2e_s3(data, nbytes, startingChecksum);
+  if (detail::crc32_hw_supported_neon_eor3_sha3()) {
+    return crc32_neon_eor3;
   }
 #endif
-
   if (detail::crc32_hw_supported()) {
-    return detail::crc32_hw(data, nbytes, startingChecksum);
+    return detail::crc32_hw;
+  }
+  return detail::crc32_sw;
+}
+
+FOLLY_CONSTINIT CpuDispatch<ChecksumFn> crc32c_impl{select_crc32c};
+FOLLY_CONSTINIT CpuDispatch<ChecksumFn> crc32_impl{select_crc32};
+
+} // namespace
+
+uint32_t crc32c(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  return crc32c_impl(data, nbytes, startingChecksum);
+}
+
+void crc32c_multi(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum) {
+  if (detail::crc32c_hw_supported()) {
+    detail::crc32c_multi_hw(data, nbytes, count, checksums, startingChecksum);
   } else {
-    return detail::crc32_sw(data, nbytes, startingChecksum);
+    for (size_t i = 0; i < count; ++i) {
+      checksums[i] = detail::crc32c_sw(data[i], nbytes[i], startingChecksum);
+    }
   }
 }
 
+uint32_t crc32(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
+  return crc32_impl(data, nbytes, startingChecksum);
+}
+
 uint32_t crc32_type(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
   return ~crc32(data, nbytes, startingChecksum);
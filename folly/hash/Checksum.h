@@ -38,6 +38,24 @@ namespace folly {
 uint32_t crc32c(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Compute the CRC-32C checksums of count independent buffers, such that
+ * checksums[i] == crc32c(data[i], nbytes[i], startingChecksum).
+ *
+ * The CRC-32C instruction has a latency of several cycles, so checksumming
+ * a small buffer is bound by the dependency chain through its checksum.
+ * With hardware support, this interleaves the instruction streams of several
+ * buffers, which is faster than calling crc32c() on each of many small
+ * buffers, such as individual records. Large buffers are passed to crc32c(),
+ * which interleaves within the buffer.
+ */
+void crc32c_multi(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum = ~0U);
+
 /**
  * Compute the CRC-32 checksum of a buffer, using a hardware-accelerated
  * implementation if available or a portable software implementation as
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/Xxh3.h>
+
+#include <cassert>
+#include <cstring>
+
+#if FOLLY_X64
+#include <immintrin.h>
+#elif FOLLY_NEON && FOLLY_AARCH64
+#include <arm_neon.h>
+#endif
+
+namespace folly {
+namespace hash {
+namespace detail {
+namespace xxh3 {
+
+namespace {
+
+constexpr size_t kStripeLen = 64;
+constexpr size_t kSecretConsumeRate = 8;
+constexpr size_t kAccNb = kStripeLen / sizeof(uint64_t);
+constexpr size_t kSecretLastAccStart = 7;
+constexpr size_t kSecretMergeAccsStart = 11;
+
+// The accumulators of the long inputs, which the SIMD implementations keep in
+// registers over a block of stripes.
+struct alignas(64) Acc {
+  uint64_t lanes[kAccNb] = {
+      kPrime32_3,
+      kPrime64_1,
+      kPrime64_2,
+      kPrime64_3,
+      kPrime64_4,
+      kPrime32_2,
+      kPrime64_5,
+      kPrime32_1,
+  };
+};
+
+#if FOLLY_X64 && defined(__AVX2__)
+
+void accumulate(
+    Acc& acc, const uint8_t* in, const uint8_t* secret, size_t stripes) {
+  auto const lanes = reinterpret_cast<__m256i*>(acc.lanes);
+  __m256i a0 = _mm256_load_si256(lanes);
+  __m256i a1 = _mm256_load_si256(lanes + 1);
+  auto const round = [](__m256i a, const uint8_t* p, const uint8_t* s) {
+    auto const data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto const key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    auto const dataKey = _mm256_xor_si256(data, key);
+    auto const product =
+        _mm256_mul_epu32(dataKey, _mm256_srli_epi64(dataKey, 32));
+    auto const swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(product, _mm256_add_epi64(a, swapped));
+  };
+  for (size_t n = 0; n < stripes; ++n) {
+    auto const p = in + n * kStripeLen;
+    auto const s = secret + n * kSecretConsumeRate;
+    a0 = round(a0, p, s);
+    a1 = round(a1, p + 32, s + 32);
+  }
+  _mm256_store_si256(lanes, a0);
+  _mm256_store_si256(lanes + 1, a1);
+}
+
+void scramble(Acc& acc, const uint8_t* secret) {
+  auto const lanes = reinterpret_cast<__m256i*>(acc.lanes);
+  auto const prime = _mm256_set1_epi32(int(kPrime32_1));
+  for (size_t i = 0; i < 2; ++i) {
+    auto a = _mm256_load_si256(lanes + i);
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    a = _mm256_xor_si256(
+        a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+    auto const lo = _mm256_mul_epu32(a, prime);
+    auto const hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+    _mm256_store_si256(
+        lanes + i, _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+  }
+}
+
+#elif FOLLY_X64
+
+void accumulate(
+    Acc& acc, const uint8_t* in, const uint8_t* secret, size_t stripes) {
+  auto const lanes = reinterpret_cast<__m128i*>(acc.lanes);
+  __m128i a[4];
+  for (size_t i = 0; i < 4; ++i) {
+    a[i] = _mm_load_si128(lanes + i);
+  }
+  for (size_t n = 0; n < stripes; ++n) {
+    auto const p = reinterpret_cast<const __m128i*>(in + n * kStripeLen);
+    auto const s =
+        reinterpret_cast<const __m128i*>(secret + n * kSecretConsumeRate);
+    for (size_t i = 0; i < 4; ++i) {
+      auto const data = _mm_loadu_si128(p + i);
+      auto const dataKey = _mm_xor_si128(data, _mm_loadu_si128(s + i));
+      auto const product = _mm_mul_epu32(
+          dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+      auto const swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+      a[i] = _mm_add_epi64(product, _mm_add_epi64(a[i], swapped));
+    }
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    _mm_store_si128(lanes + i, a[i]);
+  }
+}
+
+void scramble(Acc& acc, const uint8_t* secret) {
+  auto const lanes = reinterpret_cast<__m128i*>(acc.lanes);
+  auto const prime = _mm_set1_epi32(int(kPrime32_1));
+  for (size_t i = 0; i < 4; ++i) {
+    auto a = _mm_load_si128(lanes + i);
+    a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+    a = _mm_xor_si128(
+        a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+    auto const lo = _mm_mul_epu32(a, prime);
+    auto const hi = _mm_mul_epu32(
+        _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+    _mm_store_si128(lanes + i, _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+  }
+}
+
+#elif FOLLY_NEON && FOLLY_AARCH64
+
+void accumulate(
+    Acc& acc, const uint8_t* in, const uint8_t* secret, size_t stripes) {
+  uint64x2_t a[4];
+  for (size_t i = 0; i < 4; ++i) {
+    a[i] = vld1q_u64(acc.lanes + 2 * i);
+  }
+  for (size_t n = 0; n < stripes; ++n) {
+    auto const p = in + n * kStripeLen;
+    auto const s = secret + n * kSecretConsumeRate;
+    for (size_t i = 0; i < 4; ++i) {
+      auto const data = vreinterpretq_u64_u8(vld1q_u8(p + 16 * i));
+      auto const key = vreinterpretq_u64_u8(vld1q_u8(s + 16 * i));
+      auto const dataKey = veorq_u64(data, key);
+      auto const swapped = vextq_u64(data, data, 1);
+      a[i] = vmlal_u32(
+          vaddq_u64(a[i], swapped),
+          vmovn_u64(dataKey),
+          vshrn_n_u64(dataKey, 32));
+    }
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    vst1q_u64(acc.lanes + 2 * i, a[i]);
+  }
+}
+
+void scramble(Acc& acc, const uint8_t* secret) {
+  auto const prime = vdup_n_u32(kPrime32_1);
+  for (size_t i = 0; i < 4; ++i) {
+    auto a = vld1q_u64(acc.lanes + 2 * i);
+    a = veorq_u64(a, vshrq_n_u64(a, 47));
+    a = veorq_u64(a, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+    auto const hi = vmull_u32(vshrn_n_u64(a, 32), prime);
+    vst1q_u64(
+        acc.lanes + 2 * i,
+        vmlal_u32(vshlq_n_u64(hi, 32), vmovn_u64(a), prime));
+  }
+}
+
+#else
+
+void accumulate(
+    Acc& acc, const uint8_t* in, const uint8_t* secret, size_t stripes) {
+  for (size_t n = 0; n < stripes; ++n) {
+    auto const p = in + n * kStripeLen;
+    auto const s = secret + n * kSecretConsumeRate;
+    for (size_t i = 0; i < kAccNb; ++i) {
+      auto const data = read64(p + 8 * i);
+      auto const dataKey = data ^ read64(s + 8 * i);
+      acc.lanes[i ^ 1] += data;
+      acc.lanes[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+    }
+  }
+}
+
+void scramble(Acc& acc, const uint8_t* secret) {
+  for (size_t i = 0; i < kAccNb; ++i) {
+    auto a = acc.lanes[i];
+    a ^= a >> 47;
+    a ^= read64(secret + 8 * i);
+    acc.lanes[i] = a * kPrime32_1;
+  }
+}
+
+#endif
+
+void hashLongLoop(
+    Acc& acc, const uint8_t* in, size_t len, const uint8_t* secret) {
+  constexpr size_t kStripesPerBlock =
+      (kSecretSize - kStripeLen) / kSecretConsumeRate;
+  constexpr size_t kBlockLen = kStripeLen * kStripesPerBlock;
+  auto const blocks = (len - 1) / kBlockLen;
+  for (size_t n = 0; n < blocks; ++n) {
+    accumulate(acc, in + n * kBlockLen, secret, kStripesPerBlock);
+    scramble(acc, secret + kSecretSize - kStripeLen);
+  }
+  auto const stripes = ((len - 1) - kBlockLen * blocks) / kStripeLen;
+  accumulate(acc, in + blocks * kBlockLen, secret, stripes);
+  // The last stripe, which may overlap the previous one.
+  accumulate(
+      acc,
+      in + len - kStripeLen,
+      secret + kSecretSize - kStripeLen - kSecretLastAccStart,
+      1);
+}
+
+uint64_t mergeAccs(const Acc& acc, const uint8_t* secret, uint64_t start) {
+  auto result = start;
+  for (size_t i = 0; i < 4; ++i) {
+    result += mul128Fold64(
+        acc.lanes[2 * i] ^ read64(secret + 16 * i),
+        acc.lanes[2 * i + 1] ^ read64(secret + 16 * i + 8));
+  }
+  return avalanche(result);
+}
+
+// The secret of the long inputs for a non-zero seed.
+void initCustomSecret(uint8_t* secret, uint64_t seed) {
+  for (size_t i = 0; i < kSecretSize / 16; ++i) {
+    auto const lo = Endian::little(read64(kSecret + 16 * i) + seed);
+    auto const hi = Endian::little(read64(kSecret + 16 * i + 8) - seed);
+    std::memcpy(secret + 16 * i, &lo, sizeof(lo));
+    std::memcpy(secret + 16 * i + 8, &hi, sizeof(hi));
+  }
+}
+
+std::pair<uint64_t, uint64_t> mix32B(
+    std::pair<uint64_t, uint64_t> acc,
+    const uint8_t* in1,
+    const uint8_t* in2,
+    const uint8_t* secret,
+    uint64_t seed) {
+  acc.first += mix16B(in1, secret, seed);
+  acc.first ^= read64(in2) + read64(in2 + 8);
+  acc.second += mix16B(in2, secret + 16, seed);
+  acc.second ^= read64(in1) + read64(in1 + 8);
+  return acc;
+}
+
+} // namespace
+
+uint64_t hash64Len129To240(const uint8_t* in, size_t len, uint64_t seed) {
+  assert(len > 128 && len <= kMidSizeMax);
+  auto const secret = kSecret;
+  uint64_t acc = len * kPrime64_1;
+  for (size_t i = 0; i < 8; ++i) {
+    acc += mix16B(in + 16 * i, secret + 16 * i, seed);
+  }
+  acc = avalanche(acc);
+  auto accEnd = mix16B(
+      in + len - 16, secret + kSecretSizeMin - kMidSizeLastOffset, seed);
+  auto const rounds = len / 16;
+  for (size_t i = 8; i < rounds; ++i) {
+    accEnd += mix16B(
+        in + 16 * i, secret + 16 * (i - 8) + kMidSizeStartOffset, seed);
+  }
+  return avalanche(acc + accEnd);
+}
+
+uint64_t hash64Long(const uint8_t* in, size_t len, uint64_t seed) {
+  assert(len > kMidSizeMax);
+  alignas(64) uint8_t custom[kSecretSize];
+  auto secret = kSecret;
+  if (seed != 0) {
+    initCustomSecret(custom, seed);
+    secret = custom;
+  }
+  Acc acc;
+  hashLongLoop(acc, in, len, secret);
+  return mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1);
+}
+
+std::pair<uint64_t, uint64_t> hash128Len17To240(
+    const uint8_t* in, size_t len, uint64_t seed) {
+  assert(len > 16 && len <= kMidSizeMax);
+  auto const secret = kSecret;
+  std::pair<uint64_t, uint64_t> acc{len * kPrime64_1, 0};
+  if (len <= 128) {
+    if (len > 32) {
+      if (len > 64) {
+        if (len > 96) {
+          acc = mix32B(acc, in + 48, in + len - 64, secret + 96, seed);
+        }
+        acc = mix32B(acc, in + 32, in + len - 48, secret + 64, seed);
+      }
+      acc = mix32B(acc, in + 16, in + len - 32, secret + 32, seed);
+    }
+    acc = mix32B(acc, in, in + len - 16, secret, seed);
+  } else {
+    for (size_t i = 32; i < 160; i += 32) {
+      acc = mix32B(acc, in + i - 32, in + i - 16, secret + i - 32, seed);
+    }
+    acc = {avalanche(acc.first), avalanche(acc.second)};
+    for (size_t i = 160; i <= len; i += 32) {
+      acc = mix32B(
+          acc,
+          in + i - 32,
+          in + i - 16,
+          secret + kMidSizeStartOffset + i - 160,
+          seed);
+    }
+    acc = mix32B(
+        acc,
+        in + len - 16,
+        in + len - 32,
+        secret + kSecretSizeMin - kMidSizeLastOffset - 16,
+        0 - seed);
+  }
+  auto const low = acc.first + acc.second;
+  auto const high = acc.first * kPrime64_1 + acc.second * kPrime64_4 +
+      (len - seed) * kPrime64_2;
+  return {avalanche(low), 0 - avalanche(high)};
+}
+
+std::pair<uint64_t, uint64_t> hash128Long(
+    const uint8_t* in, size_t len, uint64_t seed) {
+  assert(len > kMidSizeMax);
+  alignas(64) uint8_t custom[kSecretSize];
+  auto secret = kSecret;
+  if (seed != 0) {
+    initCustomSecret(custom, seed);
+    secret = custom;
+  }
+  Acc acc;
+  hashLongLoop(acc, in, len, secret);
+  return {
+      mergeAccs(acc, secret + kSecretMergeAccsStart, len * kPrime64_1),
+      mergeAccs(
+          acc,
+          secret + kSecretSize - sizeof(acc.lanes) - kSecretMergeAccsStart,
+          ~(len * kPrime64_2))};
+}
+
+} // namespace xxh3
+} // namespace detail
+
+void xxh3Hash64Many(
+    span<const StringPiece> keys, span<uint64_t> out, uint64_t seed) {
+  assert(out.size() >= keys.size());
+  auto const hash = [seed](StringPiece key) {
+    return xxh3Hash64(key.data(), key.size(), seed);
+  };
+  auto const prefetch = [](StringPiece key) {
+#ifndef _WIN32
+    __builtin_prefetch(key.data());
+#elif FOLLY_X64
+    _mm_prefetch(key.data(), _MM_HINT_T0);
+#endif
+  };
+  size_t const n = keys.size();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (size_t j = i + 4; j < i + 8 && j < n; ++j) {
+      prefetch(keys[j]);
+    }
+    auto const h0 = hash(keys[i]);
+    auto const h1 = hash(keys[i + 1]);
+    auto const h2 = hash(keys[i + 2]);
+    auto const h3 = hash(keys[i + 3]);
+    out[i] = h0;
+    out[i + 1] = h1;
+    out[i + 2] = h2;
+    out[i + 3] = h3;
+  }
+  for (; i < n; ++i) {
+    out[i] = hash(keys[i]);
+  }
+}
+
+} // namespace hash
+} // namespace folly
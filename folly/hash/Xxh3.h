@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// XXH3, the 64-bit and 128-bit hashes of xxHash 0.8 by Yann Collet
+// (https://github.com/Cyan4973/xxHash), BSD 2-Clause licensed: the outputs
+// are those of XXH3_64bits_withSeed() and XXH3_128bits_withSeed().
+//
+// The inputs of up to 240 bytes are hashed by inline code, and the longer ones
+// by stripes of 64 bytes with SSE2, AVX2 or NEON, as the target allows.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/container/span.h>
+#include <folly/lang/Bits.h>
+
+#if defined(_MSC_VER) && !FOLLY_HAVE_INT128_T
+#include <intrin.h>
+#endif
+
+namespace folly {
+namespace hash {
+
+namespace detail {
+
+namespace xxh3 {
+
+constexpr uint32_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint32_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint32_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t kSecretSize = 192;
+constexpr size_t kSecretSizeMin = 136;
+constexpr size_t kMidSizeMax = 240;
+constexpr size_t kMidSizeStartOffset = 3;
+constexpr size_t kMidSizeLastOffset = 17;
+
+// The default secret, from FARSH.
+alignas(64) inline constexpr uint8_t kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+FOLLY_ALWAYS_INLINE uint32_t read32(const uint8_t* p) {
+  return Endian::little(loadUnaligned<uint32_t>(p));
+}
+
+FOLLY_ALWAYS_INLINE uint64_t read64(const uint8_t* p) {
+  return Endian::little(loadUnaligned<uint64_t>(p));
+}
+
+FOLLY_ALWAYS_INLINE uint64_t rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// The low and high halves of the product.
+FOLLY_ALWAYS_INLINE std::pair<uint64_t, uint64_t> mul128(
+    uint64_t x, uint64_t y) {
+#if FOLLY_HAVE_INT128_T
+  auto const m = static_cast<unsigned __int128>(x) * y;
+  return {uint64_t(m), uint64_t(m >> 64)};
+#elif defined(_MSC_VER) && defined(_M_X64)
+  uint64_t high;
+  uint64_t const low = _umul128(x, y, &high);
+  return {low, high};
+#else
+  uint64_t const lolo = (x & 0xFFFFFFFF) * (y & 0xFFFFFFFF);
+  uint64_t const hilo = (x >> 32) * (y & 0xFFFFFFFF);
+  uint64_t const lohi = (x & 0xFFFFFFFF) * (y >> 32);
+  uint64_t const hihi = (x >> 32) * (y >> 32);
+  uint64_t const cross = (lolo >> 32) + (hilo & 0xFFFFFFFF) + lohi;
+  return {
+      (cross << 32) | (lolo & 0xFFFFFFFF),
+      (hilo >> 32) + (cross >> 32) + hihi};
+#endif
+}
+
+FOLLY_ALWAYS_INLINE uint64_t mul128Fold64(uint64_t x, uint64_t y) {
+  auto const m = mul128(x, y);
+  return m.first ^ m.second;
+}
+
+FOLLY_ALWAYS_INLINE uint64_t xxh64Avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= kPrime64_2;
+  h ^= h >> 29;
+  h *= kPrime64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+FOLLY_ALWAYS_INLINE uint64_t avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= kPrimeMx1;
+  h ^= h >> 32;
+  return h;
+}
+
+FOLLY_ALWAYS_INLINE uint64_t rrmxmx(uint64_t h, uint64_t len) {
+  h ^= rotl64(h, 49) ^ rotl64(h, 24);
+  h *= kPrimeMx2;
+  h ^= (h >> 35) + len;
+  h *= kPrimeMx2;
+  return h ^ (h >> 28);
+}
+
+FOLLY_ALWAYS_INLINE uint64_t
+mix16B(const uint8_t* in, const uint8_t* secret, uint64_t seed) {
+  return mul128Fold64(
+      read64(in) ^ (read64(secret) + seed),
+      read64(in + 8) ^ (read64(secret + 8) - seed));
+}
+
+FOLLY_ALWAYS_INLINE uint64_t
+hash64Len0To16(const uint8_t* in, size_t len, uint64_t seed) {
+  auto const secret = kSecret;
+  if (FOLLY_LIKELY(len > 8)) {
+    auto const bitflip1 = (read64(secret + 24) ^ read64(secret + 32)) + seed;
+    auto const bitflip2 = (read64(secret + 40) ^ read64(secret + 48)) - seed;
+    auto const lo = read64(in) ^ bitflip1;
+    auto const hi = read64(in + len - 8) ^ bitflip2;
+    return avalanche(len + Endian::swap(lo) + hi + mul128Fold64(lo, hi));
+  }
+  if (FOLLY_LIKELY(len >= 4)) {
+    seed ^= uint64_t(Endian::swap(uint32_t(seed))) << 32;
+    auto const in1 = read32(in);
+    auto const in2 = read32(in + len - 4);
+    auto const bitflip = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+    return rrmxmx((in2 + (uint64_t(in1) << 32)) ^ bitflip, len);
+  }
+  if (len > 0) {
+    uint32_t const combined = (uint32_t(in[0]) << 16) |
+        (uint32_t(in[len >> 1]) << 24) | uint32_t(in[len - 1]) |
+        (uint32_t(len) << 8);
+    auto const bitflip = (read32(secret) ^ read32(secret + 4)) + seed;
+    return xxh64Avalanche(combined ^ bitflip);
+  }
+  return xxh64Avalanche(seed ^ (read64(secret + 56) ^ read64(secret + 64)));
+}
+
+FOLLY_ALWAYS_INLINE uint64_t
+hash64Len17To128(const uint8_t* in, size_t len, uint64_t seed) {
+  auto const secret = kSecret;
+  uint64_t acc = len * kPrime64_1;
+  if (len > 32) {
+    if (len > 64) {
+      if (len > 96) {
+        acc += mix16B(in + 48, secret + 96, seed);
+        acc += mix16B(in + len - 64, secret + 112, seed);
+      }
+      acc += mix16B(in + 32, secret + 64, seed);
+      acc += mix16B(in + len - 48, secret + 80, seed);
+    }
+    acc += mix16B(in + 16, secret + 32, seed);
+    acc += mix16B(in + len - 32, secret + 48, seed);
+  }
+  acc += mix16B(in, secret, seed);
+  acc += mix16B(in + len - 16, secret + 16, seed);
+  return avalanche(acc);
+}
+
+FOLLY_ALWAYS_INLINE std::pair<uint64_t, uint64_t>
+hash128Len0To16(const uint8_t* in, size_t len, uint64_t seed) {
+  auto const secret = kSecret;
+  if (FOLLY_LIKELY(len > 8)) {
+    auto const bitflipl = (read64(secret + 32) ^ read64(secret + 40)) - seed;
+    auto const bitfliph = (read64(secret + 48) ^ read64(secret + 56)) + seed;
+    auto const lo = read64(in);
+    auto hi = read64(in + len - 8);
+    auto m = mul128(lo ^ hi ^ bitflipl, kPrime64_1);
+    m.first += uint64_t(len - 1) << 54;
+    hi ^= bitfliph;
+    m.second += hi + uint64_t(uint32_t(hi)) * (kPrime32_2 - 1);
+    m.first ^= Endian::swap(m.second);
+    auto h = mul128(m.first, kPrime64_2);
+    h.second += m.second * kPrime64_2;
+    return {avalanche(h.first), avalanche(h.second)};
+  }
+  if (FOLLY_LIKELY(len >= 4)) {
+    seed ^= uint64_t(Endian::swap(uint32_t(seed))) << 32;
+    auto const in64 = read32(in) + (uint64_t(read32(in + len - 4)) << 32);
+    auto const bitflip = (read64(secret + 16) ^ read64(secret + 24)) + seed;
+    auto m = mul128(in64 ^ bitflip, kPrime64_1 + (len << 2));
+    m.second += m.first << 1;
+    m.first ^= m.second >> 3;
+    m.first ^= m.first >> 35;
+    m.first *= kPrimeMx2;
+    m.first ^= m.first >> 28;
+    return {m.first, avalanche(m.second)};
+  }
+  if (len > 0) {
+    uint32_t const combinedl = (uint32_t(in[0]) << 16) |
+        (uint32_t(in[len >> 1]) << 24) | uint32_t(in[len - 1]) |
+        (uint32_t(len) << 8);
+    auto const swapped = Endian::swap(combinedl);
+    uint32_t const combinedh = (swapped << 13) | (swapped >> 19);
+    auto const bitflipl = (read32(secret) ^ read32(secret + 4)) + seed;
+    auto const bitfliph = (read32(secret + 8) ^ read32(secret + 12)) - seed;
+    return {
+        xxh64Avalanche(combinedl ^ bitflipl),
+        xxh64Avalanche(combinedh ^ bitfliph)};
+  }
+  return {
+      xxh64Avalanche(seed ^ read64(secret + 64) ^ read64(secret + 72)),
+      xxh64Avalanche(seed ^ read64(secret + 80) ^ read64(secret + 88))};
+}
+
+uint64_t hash64Len129To240(const uint8_t* in, size_t len, uint64_t seed);
+uint64_t hash64Long(const uint8_t* in, size_t len, uint64_t seed);
+std::pair<uint64_t, uint64_t> hash128Len17To240(
+    const uint8_t* in, size_t len, uint64_t seed);
+std::pair<uint64_t, uint64_t> hash128Long(
+    const uint8_t* in, size_t len, uint64_t seed);
+
+} // namespace xxh3
+
+} // namespace detail
+
+/**
+ * XXH3 64-bit hash of the data, as XXH3_64bits_withSeed().
+ */
+FOLLY_ALWAYS_INLINE uint64_t
+xxh3Hash64(const void* data, size_t size, uint64_t seed = 0) noexcept {
+  auto const in = static_cast<const uint8_t*>(data);
+  if (size <= 16) {
+    return detail::xxh3::hash64Len0To16(in, size, seed);
+  }
+  if (size <= 128) {
+    return detail::xxh3::hash64Len17To128(in, size, seed);
+  }
+  if (size <= detail::xxh3::kMidSizeMax) {
+    return detail::xxh3::hash64Len129To240(in, size, seed);
+  }
+  return detail::xxh3::hash64Long(in, size, seed);
+}
+
+inline uint64_t xxh3Hash64(StringPiece data, uint64_t seed = 0) noexcept {
+  return xxh3Hash64(data.data(), data.size(), seed);
+}
+
+/**
+ * XXH3 128-bit hash of the data, as XXH3_128bits_withSeed(): its low 64 bits
+ * first and its high 64 bits second.
+ */
+inline std::pair<uint64_t, uint64_t> xxh3Hash128(
+    const void* data, size_t size, uint64_t seed = 0) noexcept {
+  auto const in = static_cast<const uint8_t*>(data);
+  if (size <= 16) {
+    return detail::xxh3::hash128Len0To16(in, size, seed);
+  }
+  if (size <= detail::xxh3::kMidSizeMax) {
+    return detail::xxh3::hash128Len17To240(in, size, seed);
+  }
+  return detail::xxh3::hash128Long(in, size, seed);
+}
+
+/**
+ * Writes xxh3Hash64() of each of the keys to out, which must be as large.
+ *
+ * The hashes of short keys are latency bound: this hashes them by groups of
+ * four, whose independent computations the CPU overlaps, and prefetches the
+ * keys of the next group meanwhile.
+ */
+void xxh3Hash64Many(
+    span<const StringPiece> keys, span<uint64_t> out, uint64_t seed = 0);
+
+/**
+ * An avalanching hasher of strings for the F14 containers and others, as
+ * F14FastMap<std::string, T, Xxh3Hasher>. It is transparent, so that such a
+ * map with std::equal_to<> as KeyEqual may be looked up with a StringPiece.
+ */
+struct Xxh3Hasher {
+  using folly_is_avalanching = std::true_type;
+  using is_transparent = void;
+
+  size_t operator()(StringPiece key) const noexcept {
+    return static_cast<size_t>(xxh3Hash64(key.data(), key.size()));
+  }
+};
+
+} // namespace hash
+} // namespace folly
@@ -42,6 +42,20 @@ namespace detail {
 uint32_t crc32c_hw(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Compute the CRC-32C checksums of several buffers, interleaving the
+ * hardware CRC-32C instructions of up to four buffers at a time.
+ *
+ * @note Like crc32c_hw(), only call this if crc32c_hw_supported(); for all
+ *       other scenarios, please call crc32c_multi().
+ */
+void crc32c_multi_hw(
+    const uint8_t* const* data,
+    const size_t* nbytes,
+    size_t count,
+    uint32_t* checksums,
+    uint32_t startingChecksum = ~0U);
+
 /**
  * Check whether a SSE4.2 hardware-accelerated CRC-32C implementation is
  * supported on the current CPU.
@@ -15,6 +15,7 @@
  */
 
 #include <random>
+#include <vector>
 #include <glog/logging.h>
 #include <folly/Benchmark.h>
 #include <folly/Memory.h>
@@ -57,6 +58,34 @@ BENCH_CRC32C(131072)
 BENCH_CRC32C(262144)
 BENCH_CRC32C(524288)
 
+// Checksums of many small records, one at a time or interleaved.
+constexpr size_t kRecordSize = 64;
+constexpr size_t kNumRecords = kBufSize / kRecordSize;
+
+BENCHMARK(crc32c_records_64, iters) {
+  std::vector<uint32_t> checksums(kNumRecords);
+  while (iters--) {
+    for (size_t i = 0; i < kNumRecords; ++i) {
+      checksums[i] = folly::crc32c(buf + i * kRecordSize, kRecordSize);
+    }
+    folly::doNotOptimizeAway(checksums.data());
+  }
+}
+
+BENCHMARK_RELATIVE(crc32c_multi_records_64, iters) {
+  std::vector<const uint8_t*> data(kNumRecords);
+  std::vector<size_t> nbytes(kNumRecords, kRecordSize);
+  std::vector<uint32_t> checksums(kNumRecords);
+  for (size_t i = 0; i < kNumRecords; ++i) {
+    data[i] = buf + i * kRecordSize;
+  }
+  while (iters--) {
+    folly::crc32c_multi(
+        data.data(), nbytes.data(), kNumRecords, checksums.data());
+    folly::doNotOptimizeAway(checksums.data());
+  }
+}
+
 int main(int argc, char** argv) {
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
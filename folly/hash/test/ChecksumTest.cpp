@@ -415,6 +415,52 @@ TEST(Checksum, crc32cCombine) {
   }
 }
 
+void testCRC32CMulti(
+    std::function<void(
+        const uint8_t* const*, const size_t*, size_t, uint32_t*, uint32_t)>
+        impl) {
+  // Mixes tiny, small and large buffers, at all alignments, so lanes finish
+  // at different times.
+  for (size_t count : {0, 1, 3, 4, 5, 17, 1000}) {
+    std::vector<const uint8_t*> data;
+    std::vector<size_t> nbytes;
+    for (size_t i = 0; i < count; ++i) {
+      auto const length = folly::Random::rand32(8) == 0
+          ? folly::Random::rand32(100000)
+          : folly::Random::rand32(300);
+      data.push_back(buffer + folly::Random::rand32(BUFFER_SIZE - length));
+      nbytes.push_back(length);
+    }
+    for (uint32_t startingChecksum : {~0U, 0U, 12345U}) {
+      std::vector<uint32_t> checksums(count);
+      impl(
+          data.data(),
+          nbytes.data(),
+          count,
+          checksums.data(),
+          startingChecksum);
+      for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(
+            folly::detail::crc32c_sw(data[i], nbytes[i], startingChecksum),
+            checksums[i]);
+      }
+    }
+  }
+}
+
+TEST(Checksum, crc32cMultiHardware) {
+  if (folly::detail::crc32c_hw_supported()) {
+    testCRC32CMulti(folly::detail::crc32c_multi_hw);
+  } else {
+    LOG(WARNING) << "skipping hardware-accelerated CRC-32C tests"
+                 << " (not supported on this CPU)";
+  }
+}
+
+TEST(Checksum, crc32cMultiAutodetect) {
+  testCRC32CMulti(folly::crc32c_multi);
+}
+
 void benchmarkHardwareCRC32C(unsigned long iters, size_t blockSize) {
   if (folly::detail::crc32c_hw_supported()) {
     uint32_t checksum;
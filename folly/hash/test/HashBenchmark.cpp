@@ -16,10 +16,12 @@
 
 #include <folly/hash/Hash.h>
 #include <folly/hash/MurmurHash.h>
+#include <folly/hash/Xxh3.h>
 
 #include <stdint.h>
 
 #include <deque>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -111,6 +113,49 @@ struct MurmurHash {
   }
 };
 
+struct Xxh3 {
+  uint64_t operator()(const uint8_t* data, size_t size) const {
+    return folly::hash::xxh3Hash64(data, size);
+  }
+};
+
+// Hashes 1024 keys of size k per iteration, one at a time or as a batch.
+void addHashManyBenchmark() {
+  static std::deque<std::string> names;
+  constexpr size_t kKeys = 1024;
+
+  for (size_t k : {4, 8, 16, 32, 64}) {
+    auto keys = std::make_shared<std::vector<folly::StringPiece>>();
+    for (size_t i = 0; i < kKeys; ++i) {
+      auto const pos = (i * 4099) % (benchData.size() - k);
+      keys->emplace_back(
+          reinterpret_cast<const char*>(benchData.data()) + pos, k);
+    }
+    names.emplace_back(fmt::format("Xxh3 loop: {} keys, k={}", kKeys, k));
+    folly::addBenchmark(__FILE__, names.back().c_str(), [=](unsigned iters) {
+      std::vector<uint64_t> out(kKeys);
+      for (unsigned i = 0; i < iters; ++i) {
+        for (size_t j = 0; j < kKeys; ++j) {
+          out[j] = folly::hash::xxh3Hash64((*keys)[j]);
+        }
+        folly::doNotOptimizeAway(out.data());
+      }
+      return iters;
+    });
+    names.emplace_back(fmt::format("Xxh3 many: {} keys, k={}", kKeys, k));
+    folly::addBenchmark(__FILE__, names.back().c_str(), [=](unsigned iters) {
+      std::vector<uint64_t> out(kKeys);
+      for (unsigned i = 0; i < iters; ++i) {
+        folly::hash::xxh3Hash64Many(*keys, out);
+        folly::doNotOptimizeAway(out.data());
+      }
+      return iters;
+    });
+  }
+
+  folly::addBenchmark(__FILE__, "-", []() { return 0; });
+}
+
 } // namespace detail
 
 int main(int argc, char** argv) {
@@ -125,9 +170,12 @@ int main(int argc, char** argv) {
   BENCHMARK_HASH(SpookyHashV2);
   BENCHMARK_HASH(FNV64);
   BENCHMARK_HASH(MurmurHash);
+  BENCHMARK_HASH(Xxh3);
 
 #undef BENCHMARK_HASH
 
+  detail::addHashManyBenchmark();
+
   folly::runBenchmarks();
 
   return 0;
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/Xxh3.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+#include <folly/hash/Hash.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly::hash;
+
+namespace {
+
+struct TestCase {
+  size_t size;
+  uint64_t seed;
+  uint64_t hash64;
+  uint64_t low128;
+  uint64_t high128;
+};
+
+constexpr uint64_t kSeed = 0x9e3779b185ebca8d;
+
+// From the reference implementation, over the bytes of data() below: each
+// size class of the algorithm, with and without a seed.
+const TestCase kTestCases[] = {
+    {0, 0, 0x2d06800538d394c2, 0x6001c324468d497f, 0x99aa06d3014798d8},
+    {0, kSeed, 0xa8a6b918b2f0364a, 0xa986dfc5d7605bfe, 0x00feaa732a3ce25e},
+    {1, 0, 0x4c5cca45d0f4811f, 0x4c5cca45d0f4811f, 0x495b62073ef70ca4},
+    {1, kSeed, 0xfb9ffac0328029fc, 0xfb9ffac0328029fc, 0x9fa6e8d542998318},
+    {3, 0, 0x6e3e2670e61106ac, 0x6e3e2670e61106ac, 0x390cdc5b4a895dd7},
+    {3, kSeed, 0xea2313880f3cdaea, 0xea2313880f3cdaea, 0xe49644eecbcb225a},
+    {4, 0, 0x5c4c63133443d03f, 0x3d668af6f2a44d77, 0xaa6e2f274640a3f4},
+    {4, kSeed, 0x9ed5758ad388108e, 0xffb0763706acff7a, 0x5e5cd892f0591e5d},
+    {8, 0, 0xf9fd4dd0b04d78f5, 0x61ddbe7f31a6100d, 0x6a86a3bda6af4e3d},
+    {8, kSeed, 0xcda4b01376fb6fee, 0xdfe2010bb7caeb7c, 0x963881bb60d62313},
+    {9, 0, 0x7c20df9712c26edf, 0x8c7b67fd458a936b, 0x664c7ca18afd6255},
+    {9, kSeed, 0x61e9c4f6989e2ebe, 0x2b2347eb33df7e56, 0xb7643ed355c3313d},
+    {16, 0, 0x86abf6baccea0858, 0xe2ce54a7c19c730d, 0x7f9a218b0425449a},
+    {16, kSeed, 0x002c5dbcd9e84e88, 0x1ec153f521bf930c, 0x97ce164280401238},
+    {17, 0, 0xb58bf5dc5022d071, 0x8d96ef110fcdebb4, 0x66fc23f6439dbd77},
+    {17, kSeed, 0x26c99ae8313daaf0, 0x7a1e4bcb53803e92, 0xca9bcd303ebd8f58},
+    {32, 0, 0xe3712ed84c04a66e, 0xfd357cf6cb2dda18, 0x49a11ee743d6d342},
+    {32, kSeed, 0x8bdd66ab9a43c5d5, 0xdc45c1537c2f8ae9, 0x8d5343bb4c134189},
+    {33, 0, 0xa4dee99b093e1f73, 0xf8994653f4bfe6da, 0x7228d9284a8116f6},
+    {33, kSeed, 0x2cc4c6aa8e0db410, 0xaafbbdbee4fe4cd9, 0x1d25dcb67b4ff822},
+    {64, 0, 0x1291d2d4042330dd, 0xba7e015a54f14be1, 0xe0faf20e0e0fe0dd},
+    {64, kSeed, 0xeb83e6b52d65e4a7, 0xbfab697ff4cb8184, 0x2fe28508405d5b54},
+    {65, 0, 0x97c6bf83217e5ec9, 0x85326f4078a61329, 0x9397df27b7a98713},
+    {65, kSeed, 0x39899bd3ca4bea9c, 0x090de6661bea8e66, 0x605b2efadb768192},
+    {96, 0, 0x81296929fc063365, 0x8b8720f565dcf40c, 0xfb78ac185ef55443},
+    {96, kSeed, 0xcd21449bb6b2a410, 0x231c0945b1bd63e1, 0x2c38f28a3ae38c01},
+    {97, 0, 0xf145a45b658ab9dd, 0xbb385623e598c6d4, 0x9cfc8c7d6e7815c8},
+    {97, kSeed, 0xda89a1aeb54d8600, 0x55582bccdb85a746, 0x2c5076062dc60173},
+    {128, 0, 0x10d17f72c0ccba41, 0xff361dec1385710a, 0xaec730751478556c},
+    {128, kSeed, 0x687966cb6159cbc7, 0x123b2c51388ff793, 0x4d3fdade14bbe2a9},
+    {129, 0, 0x1648bdc3db49d1a2, 0x4545b3a09738e31a, 0x98cd36ccbb557926},
+    {129, kSeed, 0x25b2d1a1f5780bfa, 0x36154ea3dbf8e1e6, 0xfbd5e58cc652a7ad},
+    {240, 0, 0xb6cfaf343fab81e6, 0x3f2c53e72293711f, 0x5293e17bf553903d},
+    {240, kSeed, 0x7a689e088cdb8a88, 0x96c37ec528e157e4, 0x2831e6d565baae0b},
+    {241, 0, 0x956cae592c67279e, 0x956cae592c67279e, 0xb53840fe3fedf161},
+    {241, kSeed, 0xd8e8bd54329068cb, 0xd8e8bd54329068cb, 0x115527d18ca521c3},
+    {1024, 0, 0x70bd377d9574f4bb, 0x70bd377d9574f4bb, 0xf69630613f24324d},
+    {1024, kSeed, 0x023e2783c9ca89b7, 0x023e2783c9ca89b7, 0x67a5a34d56d31376},
+    {1025, 0, 0x66c4487c41e127a7, 0x66c4487c41e127a7, 0x621af7b8277effa4},
+    {1025, kSeed, 0x4183325be9472621, 0x4183325be9472621, 0x07c63e83421100e0},
+    {4999, 0, 0xc3af6109daa0965b, 0xc3af6109daa0965b, 0x87e70b4ea9c61edb},
+    {4999, kSeed, 0xf2b822715e52b777, 0xf2b822715e52b777, 0x444f9aad8e5ec97f},
+};
+
+std::vector<uint8_t> data() {
+  std::vector<uint8_t> data(5000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = uint8_t(i * 131 + 7);
+  }
+  return data;
+}
+
+} // namespace
+
+TEST(Xxh3, Hash64) {
+  auto const bytes = data();
+  for (auto const& test : kTestCases) {
+    EXPECT_EQ(test.hash64, xxh3Hash64(bytes.data(), test.size, test.seed))
+        << test.size << " " << test.seed;
+  }
+}
+
+TEST(Xxh3, Hash128) {
+  auto const bytes = data();
+  for (auto const& test : kTestCases) {
+    auto const hash = xxh3Hash128(bytes.data(), test.size, test.seed);
+    EXPECT_EQ(test.low128, hash.first) << test.size << " " << test.seed;
+    EXPECT_EQ(test.high128, hash.second) << test.size << " " << test.seed;
+  }
+}
+
+TEST(Xxh3, Unaligned) {
+  auto const bytes = data();
+  std::vector<uint8_t> copy(bytes.size() + 7);
+  for (size_t offset = 1; offset < 8; ++offset) {
+    std::copy(bytes.begin(), bytes.end(), copy.begin() + offset);
+    for (size_t size : {15, 200, 4999}) {
+      EXPECT_EQ(
+          xxh3Hash64(bytes.data(), size, 1),
+          xxh3Hash64(copy.data() + offset, size, 1));
+      EXPECT_EQ(
+          xxh3Hash128(bytes.data(), size, 1),
+          xxh3Hash128(copy.data() + offset, size, 1));
+    }
+  }
+}
+
+TEST(Xxh3, Hash64Many) {
+  auto const bytes = data();
+  std::vector<std::string> strings;
+  for (size_t size = 0; size < 300; size += 7) {
+    strings.emplace_back(bytes.begin(), bytes.begin() + size);
+  }
+  std::vector<folly::StringPiece> keys(strings.begin(), strings.end());
+  for (size_t n : {0, 1, 3, 4, 5, 8, 9, 43}) {
+    std::vector<uint64_t> out(n);
+    xxh3Hash64Many(folly::span(keys.data(), n), out, 42);
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(xxh3Hash64(keys[i], 42), out[i]) << n << " " << i;
+    }
+  }
+}
+
+TEST(Xxh3, F14Hasher) {
+  static_assert(folly::IsAvalanchingHasher<Xxh3Hasher, std::string>::value);
+  folly::F14FastMap<std::string, int, Xxh3Hasher, std::equal_to<>> map;
+  for (int i = 0; i < 1000; ++i) {
+    map[std::to_string(i)] = i;
+  }
+  EXPECT_EQ(1000, map.size());
+  EXPECT_EQ(42, map.at("42"));
+  // Heterogeneous lookup.
+  EXPECT_EQ(999, map.find(folly::StringPiece("999"))->second);
+  EXPECT_EQ(map.end(), map.find(folly::StringPiece("1000")));
+}
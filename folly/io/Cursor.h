@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
@@ -472,6 +473,74 @@ class CursorBase {
     return Endian::little(read<T>());
   }
 
+  /**
+   * Read values.size() consecutive values from the cursor.
+   *
+   * @methodset Consumers
+   *
+   * Equivalent to calling read<T>() for each element, but checks the length
+   * once when the values are all in the current IOBuf, and copies them across
+   * IOBuf boundaries otherwise.
+   *
+   * @throws out_of_range if there aren't enough bytes left in the cursor; the
+   * cursor and values are left in an unspecified state.
+   */
+  template <class T>
+  void read(span<T> values) {
+    readArray(values, [](T value) { return value; });
+  }
+
+  /**
+   * Read values.size() consecutive Big-Endian integrals from the cursor.
+   *
+   * @methodset Consumers
+   *
+   * @see read(span<T>)
+   */
+  template <class T>
+  void readBE(span<T> values) {
+    readArray(values, [](T value) { return Endian::big(value); });
+  }
+
+  /**
+   * Read values.size() consecutive Little-Endian integrals from the cursor.
+   *
+   * @methodset Consumers
+   *
+   * @see read(span<T>)
+   */
+  template <class T>
+  void readLE(span<T> values) {
+    readArray(values, [](T value) { return Endian::little(value); });
+  }
+
+  /**
+   * Read values.size() consecutive unsigned LEB128 varints, as encoded by
+   * folly::encodeVarint(), which may span IOBufs.
+   *
+   * @methodset Consumers
+   *
+   * While a varint of maximal length fits in the current IOBuf, varints are
+   * decoded from it without bounds checks.
+   *
+   * @throws out_of_range if the cursor ends in the middle of a varint, and
+   * invalid_argument if a varint is longer than 10 bytes; values before the
+   * invalid one have been decoded.
+   */
+  void readVarints(span<uint64_t> values) {
+    size_t i = 0;
+    while (i < values.size()) {
+      const uint8_t* p = crtPos_;
+      while (i < values.size() && size_t(crtEnd_ - p) >= kMaxVarintLength64) {
+        values[i++] = decodeVarint([&] { return *p++; });
+      }
+      crtPos_ = p;
+      if (i < values.size()) {
+        values[i++] = readVarintSlow();
+      }
+    }
+  }
+
   /**
    * Read a fixed-length string.
    *
@@ -656,6 +725,26 @@ class CursorBase {
     }
   }
 
+  /**
+   * Copies up to buf.size() bytes from the cursor.
+   *
+   * @methodset Consumers
+   *
+   * @see pullAtMost(void*, size_t)
+   */
+  size_t pullAtMost(span<uint8_t> buf) {
+    return pullAtMost(buf.data(), buf.size());
+  }
+
+  /**
+   * Copies buf.size() bytes from the cursor.
+   *
+   * @methodset Consumers
+   *
+   * @throw out_of_range if there aren't enough bytes in the cursor.
+   */
+  void pull(span<uint8_t> buf) { pull(buf.data(), buf.size()); }
+
   /**
    * Return the available data in the current IOBuf.
    *
@@ -925,6 +1014,48 @@ class CursorBase {
     return val;
   }
 
+  template <class T, class Swap>
+  FOLLY_ALWAYS_INLINE void readArray(span<T> values, Swap swap) {
+    static_assert(
+        std::is_trivially_copyable<T>::value && !std::is_const<T>::value,
+        "read() needs writable, bit-copyable values");
+    size_t len = values.size() * sizeof(T);
+    if (FOLLY_LIKELY(uintptr_t(crtPos_) + len <= uintptr_t(crtEnd_))) {
+      const uint8_t* p = crtPos_;
+      for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = swap(loadUnaligned<T>(p + i * sizeof(T)));
+      }
+      crtPos_ += len;
+      return;
+    }
+    if (len > 0) {
+      pullSlow(values.data(), len);
+    }
+    for (auto& value : values) {
+      value = swap(value);
+    }
+  }
+
+  // At most 10 bytes, the length of a varint encoding 64 bits.
+  static constexpr size_t kMaxVarintLength64 = 10;
+
+  template <class NextByte>
+  FOLLY_ALWAYS_INLINE static uint64_t decodeVarint(NextByte next) {
+    uint64_t val = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = next();
+      val |= uint64_t(byte & 0x7f) << shift;
+      if (byte < 0x80) {
+        return val;
+      }
+    }
+    throw_exception<std::invalid_argument>("varint too long");
+  }
+
+  FOLLY_NOINLINE uint64_t readVarintSlow() {
+    return decodeVarint([&] { return read<uint8_t>(); });
+  }
+
   FOLLY_NOINLINE void readFixedStringSlow(std::string* str, size_t len) {
     for (size_t available; (available = length()) < len;) {
       str->append(reinterpret_cast<const char*>(data()), available);
@@ -1194,6 +1325,56 @@ class Writable {
     d->write(Endian::little(value));
   }
 
+  /**
+   * Write consecutive values to the cursor.
+   *
+   * @methodset Writing
+   *
+   * Equivalent to calling write() for each element, but pushes the values
+   * at once.
+   */
+  template <class T>
+  void write(span<T> values) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "write() needs bit-copyable values");
+    Derived* d = static_cast<Derived*>(this);
+    d->push(
+        reinterpret_cast<const uint8_t*>(values.data()), values.size_bytes());
+  }
+
+  /**
+   * Write consecutive values to the cursor in Big-Endian.
+   *
+   * @methodset Writing
+   *
+   * @see write(span<T>)
+   */
+  template <class T>
+  void writeBE(span<T> values) {
+    if constexpr (kIsBigEndian || sizeof(T) == 1) {
+      write(values);
+    } else {
+      writeArray(values, [](auto value) { return Endian::big(value); });
+    }
+  }
+
+  /**
+   * Write consecutive values to the cursor in Little-Endian.
+   *
+   * @methodset Writing
+   *
+   * @see write(span<T>)
+   */
+  template <class T>
+  void writeLE(span<T> values) {
+    if constexpr (kIsLittleEndian || sizeof(T) == 1) {
+      write(values);
+    } else {
+      writeArray(values, [](auto value) { return Endian::little(value); });
+    }
+  }
+
   /**
    * Write bytes to the cursor.
    *
@@ -1255,6 +1436,23 @@ class Writable {
       len -= available;
     }
   }
+
+ private:
+  template <class T, class Swap>
+  void writeArray(span<T> values, Swap swap) {
+    using U = std::remove_const_t<T>;
+    // Swap a chunk at a time on the stack, rather than pushing each value.
+    constexpr size_t kChunk = sizeof(U) < 256 ? 256 / sizeof(U) : 1;
+    U chunk[kChunk];
+    Derived* d = static_cast<Derived*>(this);
+    for (size_t i = 0; i < values.size(); i += kChunk) {
+      size_t n = std::min(kChunk, values.size() - i);
+      for (size_t j = 0; j < n; ++j) {
+        chunk[j] = swap(values[i + j]);
+      }
+      d->push(reinterpret_cast<const uint8_t*>(chunk), n * sizeof(U));
+    }
+  }
 };
 
 enum class CursorAccess { PRIVATE, UNSHARE };
@@ -1707,6 +1905,7 @@ class QueueAppender : public Writable<QueueAppender> {
     queueCache_.appendUnsafe(n);
   }
 
+  using Writable<QueueAppender>::write;
   using Writable<QueueAppender>::pushAtMost;
   size_t pushAtMost(const uint8_t* buf, size_t len) {
     // Fill the current buffer
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/HugePageBufferArena.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <folly/Exception.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/SysMman.h>
+
+namespace folly {
+
+namespace {
+
+// The PMD size of transparent huge pages on x86-64 and arm64 with 4K pages.
+constexpr std::size_t kTransparentHugePageSize = 2 * 1024 * 1024;
+constexpr std::size_t kBasePageSize = 4096;
+
+} // namespace
+
+HugePageBufferArena::HugePageBufferArena()
+    : HugePageBufferArena(Options{}) {}
+
+HugePageBufferArena::HugePageBufferArena(Options options)
+    : options_(options),
+      bufferStride_(align_ceil(
+          options.bufferSize, hardware_destructive_interference_size)) {
+  if (options_.bufferSize < sizeof(void*)) {
+    throw_exception<std::invalid_argument>(
+        "HugePageBufferArena: bufferSize must hold at least a pointer");
+  }
+  if (options_.hugePageSize & (options_.hugePageSize - 1)) {
+    throw_exception<std::invalid_argument>(
+        "HugePageBufferArena: hugePageSize must be a power of two");
+  }
+  map();
+  bufferEnd_ = base_;
+  regionBegin_ = base_ + size_;
+}
+
+HugePageBufferArena::~HugePageBufferArena() {
+  ::munmap(base_, size_);
+}
+
+void HugePageBufferArena::map() {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  if (auto hugePageSize = options_.hugePageSize) {
+    auto size = align_ceil(options_.size, hugePageSize);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+        (findLastSet(hugePageSize) - 1) << MAP_HUGE_SHIFT;
+    if (options_.prefault) {
+      flags |= MAP_POPULATE;
+    }
+    // Fails if not enough pages of this size are reserved.
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p != MAP_FAILED) {
+      base_ = static_cast<uint8_t*>(p);
+      size_ = size;
+      pageSize_ = hugePageSize;
+      hugetlb_ = true;
+      return;
+    }
+    VLOG(1) << "cannot map " << size << " bytes of " << hugePageSize
+            << " byte hugetlb pages, using transparent huge pages";
+  }
+#endif
+
+  // Over-allocate to align the region to the huge page size, and unmap the
+  // excess on both ends.
+  auto size = align_ceil(options_.size, kTransparentHugePageSize);
+  auto mappingSize = size + kTransparentHugePageSize;
+  void* p = ::mmap(
+      nullptr,
+      mappingSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (p == MAP_FAILED) {
+    throwSystemError("HugePageBufferArena: cannot map ", mappingSize, " bytes");
+  }
+  auto mapping = static_cast<uint8_t*>(p);
+  auto base = align_ceil(mapping, kTransparentHugePageSize);
+  if (base != mapping) {
+    ::munmap(mapping, base - mapping);
+  }
+  auto end = base + size;
+  if (end != mapping + mappingSize) {
+    ::munmap(end, mapping + mappingSize - end);
+  }
+  base_ = base;
+  size_ = size;
+  pageSize_ = kTransparentHugePageSize;
+
+#ifdef MADV_HUGEPAGE
+  int ret = ::madvise(base_, size_, MADV_HUGEPAGE);
+  PLOG_IF(ERROR, ret) << "cannot enable huge pages";
+#endif
+  if (options_.prefault) {
+    // The first write to each huge page faults all of it in.
+    for (std::size_t offset = 0; offset < size_; offset += kBasePageSize) {
+      base_[offset] = 0;
+    }
+  }
+}
+
+std::unique_ptr<IOBuf> HugePageBufferArena::create(std::size_t capacity) {
+  if (capacity <= options_.bufferSize) {
+    if (void* buf = allocateBuffer()) {
+      return IOBuf::takeOwnership(
+          buf, options_.bufferSize, 0, 0, &freeBuffer, this, true);
+    }
+  }
+  return IOBuf::create(capacity);
+}
+
+void* HugePageBufferArena::allocateRegion(std::size_t size) {
+  size = align_ceil(size, pageSize_);
+  std::lock_guard lock{mutex_};
+  if (size > std::size_t(regionBegin_ - bufferEnd_)) {
+    return nullptr;
+  }
+  regionBegin_ -= size;
+  return regionBegin_;
+}
+
+void* HugePageBufferArena::allocateBuffer() {
+  std::lock_guard lock{mutex_};
+  if (freeBuffers_ != nullptr) {
+    void* buf = freeBuffers_;
+    std::memcpy(&freeBuffers_, buf, sizeof(void*));
+    return buf;
+  }
+  if (bufferStride_ > std::size_t(regionBegin_ - bufferEnd_)) {
+    return nullptr;
+  }
+  void* buf = bufferEnd_;
+  bufferEnd_ += bufferStride_;
+  return buf;
+}
+
+void HugePageBufferArena::releaseBuffer(void* buf) {
+  std::lock_guard lock{mutex_};
+  std::memcpy(buf, &freeBuffers_, sizeof(void*));
+  freeBuffers_ = buf;
+}
+
+void HugePageBufferArena::freeBuffer(void* buf, void* userData) {
+  static_cast<HugePageBufferArena*>(userData)->releaseBuffer(buf);
+}
+
+} // namespace folly
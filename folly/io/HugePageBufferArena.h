@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include <folly/Range.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
+
+namespace folly {
+
+/**
+ * A region of memory backed by huge pages, faulted in up front, from which
+ * large network and disk buffers are carved, so that checksumming and copying
+ * them takes few TLB misses and no page faults.
+ *
+ *   folly::HugePageBufferArena::Options options;
+ *   options.size = 1 << 30;
+ *   folly::HugePageBufferArena arena{options};
+ *   auto buf = arena.create(64 * 1024);
+ *
+ *   folly::IOBufQueue::Options queueOptions;
+ *   queueOptions.allocator = &arena;
+ *   folly::IOBufQueue queue{queueOptions}; // preallocate() uses the arena
+ *
+ * With hugePageSize set, for instance to getHugePageSize()->size from
+ * HugePages.h, the region is mapped from the hugetlb pool. Otherwise, or if not
+ * enough pages of that size are reserved, it is aligned to transparent huge
+ * pages and madvise()d for them.
+ *
+ * The front of the region is cut into buffers of bufferSize bytes, which
+ * create() hands out as IOBufs and takes back when they are freed, from any
+ * thread. The back serves allocateRegion(), for users that manage their own
+ * buffers, such as IoUringProvidedBufferRing; regions are only reclaimed with
+ * the arena. Requests that do not fit fall back to IOBuf::create(), so a full
+ * arena degrades to malloc() instead of failing.
+ *
+ * The arena must outlive all the IOBufs and regions it handed out.
+ */
+class HugePageBufferArena : public IOBufQueue::BufferAllocator {
+ public:
+  struct Options {
+    /// Bytes to map, rounded up to a multiple of pageSize().
+    std::size_t size{64 * 1024 * 1024};
+    /// Capacity of the IOBufs that create() hands out.
+    std::size_t bufferSize{64 * 1024};
+    /// Size of the hugetlb pages to map, 0 for transparent huge pages.
+    std::size_t hugePageSize{0};
+    /// Fault all pages in when mapping the region.
+    bool prefault{true};
+  };
+
+  HugePageBufferArena();
+  /// Throws std::system_error if the region cannot be mapped, and
+  /// std::invalid_argument if bufferSize is smaller than a pointer or
+  /// hugePageSize is not a power of two.
+  explicit HugePageBufferArena(Options options);
+  ~HugePageBufferArena() override;
+
+  HugePageBufferArena(const HugePageBufferArena&) = delete;
+  HugePageBufferArena& operator=(const HugePageBufferArena&) = delete;
+
+  /**
+   * Returns an empty IOBuf with at least the requested capacity, backed by
+   * the arena if capacity is at most bufferSize and a buffer is left.
+   */
+  std::unique_ptr<IOBuf> create(std::size_t capacity);
+
+  std::unique_ptr<IOBuf> allocate(std::size_t capacity) override {
+    return create(capacity);
+  }
+
+  /**
+   * Returns size bytes aligned to pageSize(), or nullptr if the arena does not
+   * have that much left. The memory is never reused before the arena is
+   * destroyed.
+   */
+  void* allocateRegion(std::size_t size);
+
+  /// The whole mapping, for instance to register it with the kernel.
+  ByteRange range() const noexcept { return {base_, size_}; }
+
+  /// The size of the pages backing the region.
+  std::size_t pageSize() const noexcept { return pageSize_; }
+
+  /// Whether the region comes from the hugetlb pool rather than from
+  /// transparent huge pages.
+  bool hugetlb() const noexcept { return hugetlb_; }
+
+  const Options& options() const noexcept { return options_; }
+
+ private:
+  void map();
+  void* allocateBuffer();
+  void releaseBuffer(void* buf);
+
+  static void freeBuffer(void* buf, void* userData);
+
+  Options options_;
+  uint8_t* base_{nullptr};
+  std::size_t size_{0};
+  std::size_t pageSize_{0};
+  bool hugetlb_{false};
+  // Distance between buffers, bufferSize rounded up to a cache line.
+  std::size_t bufferStride_{0};
+
+  std::mutex mutex_;
+  // Buffers are carved from the front, regions from the back.
+  uint8_t* bufferEnd_{nullptr};
+  uint8_t* regionBegin_{nullptr};
+  // Freed buffers, linked through their first bytes.
+  void* freeBuffers_{nullptr};
+};
+
+} // namespace folly
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <folly/Likely.h>
+#include <folly/lang/Exception.h>
+#include <folly/memory/Malloc.h>
+
+namespace folly {
+
+IOBufPool::IOBufPool() : IOBufPool(Options{}) {}
+
+IOBufPool::IOBufPool(Options options) : options_(std::move(options)) {
+  auto const& sizes = options_.sizeClasses;
+  if (sizes.empty() || sizes.size() > kMaxSizeClasses || sizes.front() == 0 ||
+      std::adjacent_find(sizes.begin(), sizes.end(), std::greater_equal<>()) !=
+          sizes.end()) {
+    throw_exception<std::invalid_argument>(
+        "IOBufPool: size classes must be 1 to kMaxSizeClasses nonzero, "
+        "increasing capacities");
+  }
+  numSizeClasses_ = static_cast<uint32_t>(sizes.size());
+}
+
+IOBufPool::~IOBufPool() {
+  for (auto cache : orphans_) {
+    delete cache;
+  }
+}
+
+std::unique_ptr<IOBuf> IOBufPool::create(std::size_t capacity) {
+  auto const& sizes = options_.sizeClasses;
+  auto it = std::lower_bound(sizes.begin(), sizes.end(), capacity);
+  if (FOLLY_UNLIKELY(it == sizes.end())) {
+    return IOBuf::create(capacity);
+  }
+  auto sizeClass = static_cast<uint32_t>(it - sizes.begin()) + 1;
+  void* buf = localCache().allocate(sizeClass);
+#if FOLLY_HAS_MEMORY_RESOURCE
+  return IOBuf::takeOwnership(
+      &controlResource_, buf, *it, 0, 0, &freeBuffer, nullptr, true);
+#else
+  return IOBuf::takeOwnership(buf, *it, 0, 0, &freeBuffer, nullptr, true);
+#endif
+}
+
+IOBufPool::Cache& IOBufPool::localCache() {
+  auto cache = caches_.get();
+  if (FOLLY_LIKELY(cache != nullptr)) {
+    return *cache;
+  }
+  {
+    std::lock_guard lock{orphansMutex_};
+    if (!orphans_.empty()) {
+      cache = orphans_.back();
+      orphans_.pop_back();
+    }
+  }
+  if (cache == nullptr) {
+    cache = new Cache(*this);
+  }
+  caches_.reset(cache, [](Cache* c, TLPDestructionMode mode) {
+    if (mode == TLPDestructionMode::ALL_THREADS) {
+      delete c;
+      return;
+    }
+    // Buffers of the exited thread still in flight keep coming back to its
+    // cache, until another thread adopts it.
+    c->clear();
+    auto& pool = *c->pool;
+    std::lock_guard lock{pool.orphansMutex_};
+    pool.orphans_.push_back(c);
+  });
+  return *cache;
+}
+
+std::size_t IOBufPool::blockSize(uint32_t sizeClass) const noexcept {
+  return sizeClass == kControlClass ? kControlBlockSize
+                                    : options_.sizeClasses[sizeClass - 1];
+}
+
+std::size_t IOBufPool::maxCached(uint32_t sizeClass) const noexcept {
+  // Every pooled IOBuf has a control block.
+  return sizeClass == kControlClass
+      ? options_.maxCachedPerClass * numSizeClasses_
+      : options_.maxCachedPerClass;
+}
+
+void* IOBufPool::Cache::allocate(uint32_t sizeClass) {
+  auto& list = lists[sizeClass];
+  if (FOLLY_UNLIKELY(list.head == nullptr) &&
+      !(drainRemote() && list.head != nullptr)) {
+    auto block = static_cast<Block*>(
+        checkedMalloc(kBlockHeaderSize + pool->blockSize(sizeClass)));
+    block->owner = this;
+    block->sizeClass = sizeClass;
+    return blockData(block);
+  }
+  auto block = list.head;
+  list.head = block->next;
+  --list.count;
+  return blockData(block);
+}
+
+void IOBufPool::Cache::releaseLocal(Block* block) {
+  auto& list = lists[block->sizeClass];
+  if (FOLLY_UNLIKELY(list.count >= pool->maxCached(block->sizeClass))) {
+    std::free(block);
+    return;
+  }
+  block->next = list.head;
+  list.head = block;
+  ++list.count;
+}
+
+void IOBufPool::Cache::releaseRemote(Block* block) noexcept {
+  auto head = remote.load(std::memory_order_relaxed);
+  do {
+    block->next = head;
+  } while (!remote.compare_exchange_weak(
+      head, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool IOBufPool::Cache::drainRemote() {
+  auto block = remote.exchange(nullptr, std::memory_order_acquire);
+  if (block == nullptr) {
+    return false;
+  }
+  while (block != nullptr) {
+    auto next = block->next;
+    releaseLocal(block);
+    block = next;
+  }
+  return true;
+}
+
+void IOBufPool::Cache::clear() noexcept {
+  auto freeAll = [](Block* block) {
+    while (block != nullptr) {
+      auto next = block->next;
+      std::free(block);
+      block = next;
+    }
+  };
+  for (auto& list : lists) {
+    freeAll(list.head);
+    list = {};
+  }
+  freeAll(remote.exchange(nullptr, std::memory_order_acquire));
+}
+
+void* IOBufPool::allocateUnpooled(std::size_t bytes) {
+  auto block = static_cast<Block*>(checkedMalloc(kBlockHeaderSize + bytes));
+  block->owner = nullptr;
+  block->sizeClass = kUnpooled;
+  return blockData(block);
+}
+
+void IOBufPool::release(void* p) {
+  auto block = reinterpret_cast<Block*>(
+      static_cast<uint8_t*>(p) - kBlockHeaderSize);
+  if (FOLLY_UNLIKELY(block->sizeClass == kUnpooled)) {
+    std::free(block);
+    return;
+  }
+  auto owner = block->owner;
+  if (owner->pool->caches_.get() == owner) {
+    owner->releaseLocal(block);
+  } else {
+    owner->releaseRemote(block);
+  }
+}
+
+void IOBufPool::freeBuffer(void* buf, void* /* userData */) {
+  release(buf);
+}
+
+#if FOLLY_HAS_MEMORY_RESOURCE
+
+void* IOBufPool::ControlResource::do_allocate(
+    std::size_t bytes, std::size_t alignment) {
+  DCHECK_LE(alignment, alignof(std::max_align_t));
+  if (FOLLY_UNLIKELY(bytes > kControlBlockSize)) {
+    return allocateUnpooled(bytes);
+  }
+  return pool_->localCache().allocate(kControlClass);
+}
+
+void IOBufPool::ControlResource::do_deallocate(
+    void* p, std::size_t, std::size_t) {
+  release(p);
+}
+
+#endif // FOLLY_HAS_MEMORY_RESOURCE
+
+} // namespace folly
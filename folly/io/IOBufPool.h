@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/ThreadLocal.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/lang/Align.h>
+#include <folly/memory/MemoryResource.h>
+
+namespace folly {
+
+namespace detail {
+struct IOBufPoolTag;
+} // namespace detail
+
+/**
+ * IOBufPool creates IOBufs whose buffers, and control blocks, are recycled
+ * through per-thread caches of a few fixed size classes instead of going
+ * through malloc() for every packet.
+ *
+ *   folly::IOBufPool pool; // 2K, 16K and 64K classes by default
+ *   auto buf = pool.create(1500); // capacity() == 2048
+ *
+ *   folly::IOBufQueue::Options queueOptions;
+ *   queueOptions.allocator = &pool;
+ *   folly::IOBufQueue queue{queueOptions}; // preallocate() uses the pool
+ *
+ * Each thread that creates IOBufs gets its own cache, typically one per
+ * EventBase thread. create() rounds the capacity up to the smallest class that
+ * fits and pops a buffer from the cache of the calling thread; requests larger
+ * than the largest class fall back to IOBuf::create(). When the IOBuf is
+ * freed, the buffer goes back to the cache of the thread that created it:
+ * directly if freed on that thread, or otherwise with a single CAS onto a
+ * lock-free list of the owning cache, which the owner takes over as a batch
+ * the next time it runs out of buffers of some class. Buffers beyond
+ * maxCachedPerClass are returned to malloc().
+ *
+ * The control block (IOBuf and SharedInfo) is allocated from the same caches
+ * through the PMR overload of IOBuf::takeOwnership() where
+ * std::pmr::memory_resource is available, so a pooled IOBuf costs no
+ * allocator call in the steady state. clone() of a pooled IOBuf shares the
+ * pooled buffer but allocates its own control block with malloc() as usual.
+ *
+ * The pool must outlive all the IOBufs it created. The caches of exited
+ * threads are adopted by new threads, so every thread that ever created a
+ * buffer keeps no more than maxCachedPerClass buffers of each class cached.
+ */
+class IOBufPool : public IOBufQueue::BufferAllocator {
+ public:
+  static constexpr std::size_t kMaxSizeClasses = 8;
+
+  struct Options {
+    /// Buffer capacities, in increasing order.
+    std::vector<std::size_t> sizeClasses{2048, 16384, 65536};
+    /// Free buffers of each class that a thread keeps cached.
+    std::size_t maxCachedPerClass{64};
+  };
+
+  /// Throws std::invalid_argument if the size classes are empty, unsorted or
+  /// more than kMaxSizeClasses.
+  IOBufPool();
+  explicit IOBufPool(Options options);
+  ~IOBufPool() override;
+
+  IOBufPool(const IOBufPool&) = delete;
+  IOBufPool& operator=(const IOBufPool&) = delete;
+
+  /**
+   * Returns an empty IOBuf with at least the requested capacity, and exactly
+   * the capacity of its size class if it has one.
+   */
+  std::unique_ptr<IOBuf> create(std::size_t capacity);
+
+  std::unique_ptr<IOBuf> allocate(std::size_t capacity) override {
+    return create(capacity);
+  }
+
+  const Options& options() const noexcept { return options_; }
+
+ private:
+  struct Cache;
+
+  // Precedes every block handed out by a cache.
+  struct Block {
+    Cache* owner;
+    Block* next;
+    uint32_t sizeClass;
+  };
+  // Keeps buffers aligned to 64 bytes whenever malloc() does.
+  static constexpr std::size_t kBlockHeaderSize = 64;
+  static_assert(sizeof(Block) <= kBlockHeaderSize);
+
+  // Class 0 holds control blocks, classes 1 and up the configured sizes.
+  static constexpr uint32_t kControlClass = 0;
+  static constexpr uint32_t kUnpooled = ~uint32_t(0);
+  static constexpr std::size_t kControlBlockSize = 256;
+
+  struct Cache {
+    struct FreeList {
+      Block* head{nullptr};
+      std::size_t count{0};
+    };
+
+    explicit Cache(IOBufPool& p) : pool(&p) {}
+    ~Cache() { clear(); }
+
+    void* allocate(uint32_t sizeClass);
+    void releaseLocal(Block* block);
+    void releaseRemote(Block* block) noexcept;
+    // Moves the blocks freed by other threads to the local lists.
+    bool drainRemote();
+    void clear() noexcept;
+
+    IOBufPool* pool;
+    std::array<FreeList, kMaxSizeClasses + 1> lists;
+    // Blocks freed by other threads, pushed with a CAS and taken all at once
+    // by the owner.
+    alignas(hardware_destructive_interference_size) std::atomic<Block*> remote{
+        nullptr};
+  };
+
+#if FOLLY_HAS_MEMORY_RESOURCE
+  // Serves the control blocks of pooled IOBufs.
+  class ControlResource : public std::pmr::memory_resource {
+   public:
+    explicit ControlResource(IOBufPool& pool) : pool_(&pool) {}
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t, std::size_t) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    IOBufPool* pool_;
+  };
+#endif
+
+  Cache& localCache();
+  std::size_t blockSize(uint32_t sizeClass) const noexcept;
+  std::size_t maxCached(uint32_t sizeClass) const noexcept;
+
+  static void* blockData(Block* block) noexcept {
+    return reinterpret_cast<uint8_t*>(block) + kBlockHeaderSize;
+  }
+  static void* allocateUnpooled(std::size_t bytes);
+  static void release(void* p);
+  static void freeBuffer(void* buf, void* userData);
+
+  Options options_;
+  uint32_t numSizeClasses_;
+#if FOLLY_HAS_MEMORY_RESOURCE
+  ControlResource controlResource_{*this};
+#endif
+  // Caches of exited threads, adopted by the next threads that need one.
+  std::mutex orphansMutex_;
+  std::vector<Cache*> orphans_;
+  // Destroyed first, while the rest of the pool is still alive.
+  ThreadLocalPtr<Cache, detail::IOBufPoolTag> caches_;
+};
+
+} // namespace folly
@@ -245,8 +245,7 @@ void IOBufQueue::append(const void* buf, size_t len) {
         (head_->prev()->tailroom() == 0)) {
       appendToChain(
           head_,
-          IOBuf::create(
-              std::max(MIN_ALLOC_SIZE, std::min(len, MAX_ALLOC_SIZE))),
+          createBuffer(std::max(MIN_ALLOC_SIZE, std::min(len, MAX_ALLOC_SIZE))),
           false);
     }
     IOBuf* last = head_->prev();
@@ -275,7 +274,7 @@ pair<void*, std::size_t> IOBufQueue::preallocateSlow(
   // Avoid grabbing update guard, since we're manually setting the cache ptrs.
   flushCache();
   // Allocate a new buffer of the requested max size.
-  unique_ptr<IOBuf> newBuf(IOBuf::create(std::max(min, newAllocationSize)));
+  unique_ptr<IOBuf> newBuf(createBuffer(std::max(min, newAllocationSize)));
 
   tailStart_ = newBuf->writableTail();
   cachePtr_->cachedRange = std::pair<uint8_t*, uint8_t*>(
@@ -87,9 +87,24 @@ class IOBufQueue {
   };
 
  public:
+  /**
+   * Source of the buffers that append() and preallocate() add to the queue,
+   * such as HugePageBufferArena.
+   */
+  class BufferAllocator {
+   public:
+    virtual ~BufferAllocator() = default;
+
+    /// Returns an empty IOBuf with at least the given capacity.
+    virtual std::unique_ptr<IOBuf> allocate(std::size_t capacity) = 0;
+  };
+
   struct Options {
-    Options() : cacheChainLength(false) {}
+    Options() : cacheChainLength(false), allocator(nullptr) {}
     bool cacheChainLength;
+    // Allocates the buffers of the queue instead of IOBuf::create() if set.
+    // Not owned, must outlive the queue.
+    BufferAllocator* allocator;
   };
 
   /**
@@ -751,6 +766,11 @@ class IOBufQueue {
       std::size_t min, std::size_t newAllocationSize, std::size_t max);
 
   void maybeReuseTail(folly::IOBuf& oldTail);
+
+  std::unique_ptr<folly::IOBuf> createBuffer(std::size_t capacity) {
+    return options_.allocator ? options_.allocator->allocate(capacity)
+                              : IOBuf::create(capacity);
+  }
 };
 
 } // namespace folly
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/ReadFiles.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+#include <system_error>
+
+#include <folly/Exception.h>
+#include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/io/async/Liburing.h>
+#include <folly/portability/Fcntl.h>
+
+#if FOLLY_HAS_LIBURING
+#include <liburing.h> // @manual
+#endif
+
+namespace folly {
+
+namespace {
+
+using Result = Try<std::unique_ptr<IOBuf>>;
+
+Result readError(int err, const std::string& path) {
+  return Result(make_exception_wrapper<std::system_error>(
+      makeSystemErrorExplicit(err, "failed to read ", path)));
+}
+
+// Reads fd past the length of buf to the end of the file, growing buf as
+// needed. Returns an errno value, or 0.
+int readToEnd(int fd, IOBuf& buf) {
+  while (true) {
+    if (buf.tailroom() == 0) {
+      buf.reserve(0, std::max<size_t>(buf.length(), 4096));
+    }
+    auto const n = preadNoInt(
+        fd, buf.writableTail(), buf.tailroom(), off_t(buf.length()));
+    if (n == -1) {
+      return errno;
+    }
+    if (n == 0) {
+      return 0;
+    }
+    buf.append(size_t(n));
+  }
+}
+
+// One byte more than the size of the file, so that the end is found without
+// growing the buffer.
+std::unique_ptr<IOBuf> createBuffer(uint64_t size) {
+  return IOBuf::create(size_t(std::min<uint64_t>(size, size_t(1) << 30)) + 1);
+}
+
+Result readFileSync(const std::string& path) {
+  auto const fd = openNoInt(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return readError(errno, path);
+  }
+  SCOPE_EXIT {
+    closeNoInt(fd);
+  };
+  struct stat st;
+  auto buf = createBuffer(fstat(fd, &st) == 0 ? uint64_t(st.st_size) : 0);
+  if (auto const err = readToEnd(fd, *buf)) {
+    return readError(err, path);
+  }
+  return Result(std::move(buf));
+}
+
+#if FOLLY_HAS_LIBURING
+
+// Submits the queued requests and calls complete(data, res) for count
+// completions.
+template <typename Complete>
+void submitAndWait(io_uring& ring, size_t count, Complete complete) {
+  while (true) {
+    auto const rc = io_uring_submit_and_wait(&ring, unsigned(count));
+    if (rc >= 0) {
+      break;
+    }
+    if (rc != -EINTR && rc != -EAGAIN && rc != -EBUSY) {
+      throwSystemErrorExplicit(-rc, "io_uring_submit_and_wait");
+    }
+  }
+  for (size_t done = 0; done < count;) {
+    io_uring_cqe* cqe;
+    auto const rc = io_uring_wait_cqe(&ring, &cqe);
+    if (rc == -EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      throwSystemErrorExplicit(-rc, "io_uring_wait_cqe");
+    }
+    complete(io_uring_cqe_get_data64(cqe), cqe->res);
+    io_uring_cqe_seen(&ring, cqe);
+    ++done;
+  }
+}
+
+bool opcodesSupported(io_uring& ring) {
+  auto const probe = io_uring_get_probe_ring(&ring);
+  if (probe == nullptr) {
+    return false;
+  }
+  SCOPE_EXIT {
+    io_uring_free_probe(probe);
+  };
+  return io_uring_opcode_supported(probe, IORING_OP_OPENAT) &&
+      io_uring_opcode_supported(probe, IORING_OP_STATX) &&
+      io_uring_opcode_supported(probe, IORING_OP_READ);
+}
+
+// Returns false, having read nothing, if io_uring isn't supported.
+bool readFilesUring(
+    Range<const std::string*> paths, size_t batchSize, Result* results) {
+  io_uring ring;
+  if (io_uring_queue_init(unsigned(2 * batchSize), &ring, 0) != 0) {
+    return false;
+  }
+  SCOPE_EXIT {
+    io_uring_queue_exit(&ring);
+  };
+  if (!opcodesSupported(ring)) {
+    return false;
+  }
+
+  std::vector<int> fds;
+  std::vector<int> errors;
+  std::vector<struct statx> stats;
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  for (size_t begin = 0; begin < paths.size(); begin += batchSize) {
+    auto const n = std::min(batchSize, paths.size() - begin);
+    auto const batch = paths.subpiece(begin, n);
+    fds.assign(n, -1);
+    errors.assign(n, 0);
+    stats.assign(n, {});
+    bufs.clear();
+    bufs.resize(n);
+    SCOPE_EXIT {
+      for (auto const fd : fds) {
+        if (fd != -1) {
+          closeNoInt(fd);
+        }
+      }
+    };
+
+    // Open and size the files. The size is only a hint, as the file may
+    // change in between.
+    for (size_t i = 0; i < n; ++i) {
+      auto sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_openat(
+          sqe, AT_FDCWD, batch[i].c_str(), O_RDONLY | O_CLOEXEC, 0);
+      io_uring_sqe_set_data64(sqe, 2 * i);
+      sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_statx(
+          sqe, AT_FDCWD, batch[i].c_str(), 0, STATX_SIZE, &stats[i]);
+      io_uring_sqe_set_data64(sqe, 2 * i + 1);
+    }
+    submitAndWait(ring, 2 * n, [&](uint64_t data, int res) {
+      auto const i = size_t(data / 2);
+      if (data % 2 == 0) {
+        if (res >= 0) {
+          fds[i] = res;
+        } else {
+          errors[i] = -res;
+        }
+      } else if (res < 0) {
+        stats[i].stx_size = 0;
+      }
+    });
+
+    size_t reads = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (fds[i] == -1) {
+        continue;
+      }
+      bufs[i] = createBuffer(stats[i].stx_size);
+      auto const sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_read(
+          sqe,
+          fds[i],
+          bufs[i]->writableData(),
+          unsigned(bufs[i]->capacity()),
+          0);
+      io_uring_sqe_set_data64(sqe, i);
+      ++reads;
+    }
+    submitAndWait(ring, reads, [&](uint64_t i, int res) {
+      if (res >= 0) {
+        bufs[i]->append(size_t(res));
+      } else {
+        errors[i] = -res;
+      }
+    });
+
+    for (size_t i = 0; i < n; ++i) {
+      // Files which grew, or were read short.
+      if (errors[i] == 0) {
+        errors[i] = readToEnd(fds[i], *bufs[i]);
+      }
+      results[begin + i] = errors[i] == 0 ? Result(std::move(bufs[i]))
+                                          : readError(errors[i], batch[i]);
+    }
+  }
+  return true;
+}
+
+#endif
+
+} // namespace
+
+std::vector<Try<std::unique_ptr<IOBuf>>> readFiles(
+    Range<const std::string*> paths, const ReadFilesOptions& options) {
+  std::vector<Result> results(paths.size());
+#if FOLLY_HAS_LIBURING
+  auto const batchSize = std::clamp<size_t>(options.batchSize, 1, 4096);
+  if (readFilesUring(paths, batchSize, results.data())) {
+    return results;
+  }
+#else
+  (void)options;
+#endif
+  for (size_t i = 0; i < paths.size(); ++i) {
+    results[i] = readFileSync(paths[i]);
+  }
+  return results;
+}
+
+SemiFuture<std::vector<Try<std::unique_ptr<IOBuf>>>> readFiles(
+    std::vector<std::string> paths,
+    Executor::KeepAlive<> executor,
+    const ReadFilesOptions& options) {
+  auto const shared =
+      std::make_shared<const std::vector<std::string>>(std::move(paths));
+  auto const batchSize = std::max<size_t>(options.batchSize, 1);
+  std::vector<SemiFuture<std::vector<Result>>> batches;
+  for (size_t begin = 0; begin < shared->size(); begin += batchSize) {
+    auto const n = std::min(batchSize, shared->size() - begin);
+    auto read = [shared, begin, n, options] {
+      return readFiles(
+          Range<const std::string*>(shared->data() + begin, n), options);
+    };
+    batches.push_back(via(executor, std::move(read)).semi());
+  }
+  return collect(std::move(batches))
+      .deferValue([](std::vector<std::vector<Result>> batches) {
+        std::vector<Result> results;
+        for (auto& batch : batches) {
+          std::move(batch.begin(), batch.end(), std::back_inserter(results));
+        }
+        return results;
+      });
+}
+
+} // namespace folly
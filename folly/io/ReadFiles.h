@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/Range.h>
+#include <folly/Try.h>
+#include <folly/futures/Future.h>
+#include <folly/io/IOBuf.h>
+
+namespace folly {
+
+struct ReadFilesOptions {
+  ReadFilesOptions() {}
+
+  // The files read together: with io_uring, opened and sized with a single
+  // submission, then read with another one. The asynchronous readFiles() runs
+  // a batch per task of its executor.
+  size_t batchSize = 64;
+};
+
+/**
+ * Read whole files into IOBufs, as readFile() does into strings. The result of
+ * each file holds either its contents or a std::system_error.
+ *
+ * Where io_uring is available, the system calls of a batch of files are
+ * submitted together, so that a batch costs a few round trips to the kernel
+ * and keeps as many requests in flight for the storage as it has files.
+ * Elsewhere, the files are read one after the other.
+ */
+std::vector<Try<std::unique_ptr<IOBuf>>> readFiles(
+    Range<const std::string*> paths,
+    const ReadFilesOptions& options = ReadFilesOptions());
+
+/**
+ * Read whole files on executor, a batch per task, as the synchronous
+ * readFiles() does. The results are in the order of the paths.
+ *
+ *   auto contents = readFiles(paths, getGlobalIOExecutor()).get();
+ */
+SemiFuture<std::vector<Try<std::unique_ptr<IOBuf>>>> readFiles(
+    std::vector<std::string> paths,
+    Executor::KeepAlive<> executor,
+    const ReadFilesOptions& options = ReadFilesOptions());
+
+} // namespace folly
@@ -39,17 +39,38 @@ class RecordIOReader::Iterator
   Iterator(ByteRange range, uint32_t fileId, off_t pos);
 
   reference dereference() const { return recordAndPos_; }
-  bool equal(const Iterator& other) const { return range_ == other.range_; }
+  bool equal(const Iterator& other) const {
+    return range_ == other.range_ &&
+        blockRecords_.size() == other.blockRecords_.size();
+  }
   void increment() {
-    size_t skip = recordio_helpers::headerSize() + recordAndPos_.first.size();
+    if (!blockRecords_.empty() && nextBlockRecord()) {
+      return;
+    }
+    size_t skip = recordio_helpers::headerSize() + recordSize_;
     recordAndPos_.second += off_t(skip);
     range_.advance(skip);
     advanceToValid();
   }
 
+  bool nextBlockRecord() {
+    auto record = recordio_helpers::popBlockRecord(blockRecords_);
+    if (record.empty()) {
+      blockRecords_.clear();
+      return false;
+    }
+    recordAndPos_.first = record;
+    return true;
+  }
+
   void advanceToValid();
   ByteRange range_;
   uint32_t fileId_ = 0;
+  // The size of the data of the current record, or block.
+  size_t recordSize_ = 0;
+  // In a block, the records after the current one, and their storage.
+  std::shared_ptr<IOBuf> block_;
+  ByteRange blockRecords_;
   // stored as a pair so we can return by reference in dereference()
   std::pair<ByteRange, off_t> recordAndPos_;
 };
@@ -81,8 +102,10 @@ struct Header {
   // repeated prefix (that is, if we see kMagic, we know that the next
   // occurrence must start at least 4 bytes later)
   static constexpr uint32_t kMagic = 0xeac313a1;
+  // The version of the blocks of records written in block mode.
+  static constexpr uint8_t kBlockVersion = 1;
   uint32_t magic;
-  uint8_t version; // backwards incompatible version, currently 0
+  uint8_t version; // backwards incompatible version, 0 or kBlockVersion
   uint8_t hashFunction; // 0 = SpookyHashV2
   uint16_t flags; // reserved (must be 0)
   uint32_t fileId; // unique file ID
@@ -96,6 +119,14 @@ static_assert(
     offsetof(Header, headerHash) + sizeof(Header::headerHash) == sizeof(Header),
     "invalid header layout");
 
+// The data of a block starts with this, followed by the compressed records.
+FOLLY_PACK_PUSH
+struct BlockHeader {
+  uint8_t codecType; // compression::CodecType
+  uint32_t uncompressedLength;
+} FOLLY_PACK_ATTR;
+FOLLY_PACK_POP
+
 } // namespace recordio_detail
 
 constexpr size_t headerSize() {
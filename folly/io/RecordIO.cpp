@@ -18,18 +18,178 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/Varint.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/portability/Unistd.h>
+#include <folly/synchronization/Baton.h>
 
 namespace folly {
 
 using namespace recordio_helpers;
 
+using recordio_detail::BlockHeader;
+using recordio_detail::Header;
+
+namespace recordio_helpers {
+namespace {
+size_t prependHeader(
+    std::unique_ptr<IOBuf>& buf, uint32_t fileId, uint8_t version);
+} // namespace
+} // namespace recordio_helpers
+
+// Packs the records into blocks, which a thread compresses and writes.
+class RecordIOWriter::BlockWriter {
+ public:
+  BlockWriter(RecordIOWriter& writer, BlockOptions options)
+      : writer_(writer),
+        blockSize_(std::max<size_t>(options.blockSize, 1)),
+        maxPendingBlocks_(std::max<size_t>(options.maxPendingBlocks, 1)),
+        codec_(compression::getCodec(options.codecType)),
+        thread_([this] { run(); }) {}
+
+  ~BlockWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      seal();
+      stopping_ = true;
+    }
+    pending_.notify_one();
+    thread_.join();
+    if (error_) {
+      LOG(ERROR) << "RecordIOWriter: failed to write a block: "
+                 << exceptionStr(error_);
+    }
+  }
+
+  void add(std::unique_ptr<IOBuf> buf) {
+    auto length = buf->computeChainDataLength();
+    if (length == 0) {
+      return; // no zero-length records
+    }
+    uint8_t varint[kMaxVarintLength64];
+    auto varintLength = encodeVarint(length, varint);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    checkError();
+    // Copied, as without blocks, the caller may reuse buf once we return.
+    current_.append(varint, varintLength);
+    for (auto range : *buf) {
+      current_.append(range.data(), range.size());
+    }
+    currentLength_ += varintLength + length;
+    if (currentLength_ >= blockSize_) {
+      seal();
+      written_.wait(lock, [&] {
+        return sealed_.size() < maxPendingBlocks_ || error_;
+      });
+      checkError();
+    }
+  }
+
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    seal();
+    written_.wait(
+        lock, [&] { return (sealed_.empty() && !writing_) || error_; });
+    checkError();
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<IOBuf> records;
+    size_t length;
+  };
+
+  // Called with mutex_ held.
+  void seal() {
+    if (currentLength_ == 0) {
+      return;
+    }
+    sealed_.push_back({current_.move(), currentLength_});
+    currentLength_ = 0;
+    pending_.notify_one();
+  }
+
+  // Called with mutex_ held.
+  void checkError() {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      pending_.wait(lock, [&] { return !sealed_.empty() || stopping_; });
+      if (sealed_.empty()) {
+        return;
+      }
+      auto block = std::move(sealed_.front());
+      sealed_.pop_front();
+      writing_ = true;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        write(std::move(block));
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      writing_ = false;
+      if (error && !error_) {
+        error_ = error;
+      }
+      written_.notify_all();
+    }
+  }
+
+  void write(Block block) {
+    if (block.length > std::numeric_limits<uint32_t>::max()) {
+      throw std::invalid_argument("RecordIO block length must fit in 32 bits");
+    }
+    BlockHeader header;
+    header.codecType = uint8_t(codec_->type());
+    header.uncompressedLength = uint32_t(block.length);
+    auto data = IOBuf::copyBuffer(&header, sizeof(header), headerSize());
+    data->appendToChain(codec_->compress(block.records.get()));
+    writer_.writeRecord(std::move(data), Header::kBlockVersion);
+  }
+
+  RecordIOWriter& writer_;
+  const size_t blockSize_;
+  const size_t maxPendingBlocks_;
+  std::unique_ptr<compression::Codec> codec_;
+
+  std::mutex mutex_;
+  // Signaled when a block is sealed, or on stop.
+  std::condition_variable pending_;
+  // Signaled when a block is written.
+  std::condition_variable written_;
+  IOBufQueue current_{IOBufQueue::cacheChainLength()};
+  size_t currentLength_ = 0;
+  std::deque<Block> sealed_;
+  bool writing_ = false;
+  bool stopping_ = false;
+  std::exception_ptr error_;
+
+  std::thread thread_;
+};
+
 RecordIOWriter::RecordIOWriter(File file, uint32_t fileId)
     : file_(std::move(file)),
       fileId_(fileId),
@@ -45,8 +205,29 @@ RecordIOWriter::RecordIOWriter(File file, uint32_t fileId)
   filePos_ = st.st_size;
 }
 
+RecordIOWriter::RecordIOWriter(File file, uint32_t fileId, BlockOptions options)
+    : RecordIOWriter(std::move(file), fileId) {
+  blockWriter_ = std::make_unique<BlockWriter>(*this, options);
+}
+
+RecordIOWriter::~RecordIOWriter() = default;
+
 void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
-  size_t totalLength = prependHeader(buf, fileId_);
+  if (blockWriter_) {
+    blockWriter_->add(std::move(buf));
+    return;
+  }
+  writeRecord(std::move(buf), 0);
+}
+
+void RecordIOWriter::flush() {
+  if (blockWriter_) {
+    blockWriter_->flush();
+  }
+}
+
+void RecordIOWriter::writeRecord(std::unique_ptr<IOBuf> buf, uint8_t version) {
+  size_t totalLength = prependHeader(buf, fileId_, version);
   if (totalLength == 0) {
     return; // nothing to do
   }
@@ -85,18 +266,256 @@ RecordIOReader::Iterator::Iterator(ByteRange range, uint32_t fileId, off_t pos)
   }
 }
 
+namespace {
+
+// The sidecar written by RecordIOReader::writeIndex(): this header, then the
+// positions of the records.
+struct IndexHeader {
+  static constexpr uint32_t kMagic = 0x31584952; // "RIX1"
+  uint32_t magic;
+  uint32_t fileId;
+  uint64_t dataSize;
+  uint64_t count;
+};
+
+// The records which begin in [from, end) of range, as iterating from from
+// returns them, and the position where iterating goes on.
+struct ChunkRecords {
+  std::vector<std::pair<ByteRange, off_t>> records;
+  // The storage of the records of the blocks.
+  std::vector<std::unique_ptr<IOBuf>> blocks;
+  size_t next = 0;
+};
+
+ChunkRecords scanChunk(
+    ByteRange range, size_t from, size_t end, uint32_t fileId) {
+  ChunkRecords chunk;
+  auto pos = from;
+  while (pos < end) {
+    auto info = findRecord(
+        ByteRange(range.begin() + pos, range.begin() + end), range, fileId);
+    auto record = info.record;
+    if (record.empty()) {
+      break;
+    }
+    auto begin = size_t(record.begin() - range.begin()) - headerSize();
+    pos = begin + headerSize() + record.size();
+    if (info.version != Header::kBlockVersion) {
+      chunk.records.emplace_back(record, off_t(begin));
+      continue;
+    }
+    try {
+      chunk.blocks.push_back(uncompressBlock(record));
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "RecordIOReader: skipping a block: " << ex.what();
+      continue;
+    }
+    auto records = chunk.blocks.back()->coalesce();
+    for (auto r = popBlockRecord(records); !r.empty();
+         r = popBlockRecord(records)) {
+      chunk.records.emplace_back(r, off_t(begin));
+    }
+  }
+  chunk.next = pos;
+  return chunk;
+}
+
+} // namespace
+
+size_t RecordIOReader::scan(
+    FunctionRef<void(ByteRange record, off_t pos)> fn,
+    ScanOptions options) const {
+  auto range = map_.range();
+  auto chunkSize = std::max<size_t>(options.chunkSize, 1);
+  auto numChunks = (range.size() + chunkSize - 1) / chunkSize;
+  if (numChunks == 0) {
+    return 0;
+  }
+  auto threads = options.threads != 0
+      ? options.threads
+      : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  threads = std::min(threads, numChunks);
+
+  // Chunk i waits for the position where iterating leaves chunk i - 1, to
+  // check that it resynchronized on the same records.
+  std::vector<Baton<>> left(numChunks);
+  std::vector<size_t> leftAt(numChunks);
+  std::atomic<size_t> nextChunk{0};
+  std::atomic<size_t> count{0};
+  std::atomic<bool> stop{false};
+  std::mutex exceptionMutex;
+  std::exception_ptr exception;
+
+  auto work = [&] {
+    size_t i;
+    while ((i = nextChunk.fetch_add(1)) < numChunks) {
+      auto begin = i * chunkSize;
+      auto end = std::min(begin + chunkSize, range.size());
+      ChunkRecords chunk;
+      if (!stop.load(std::memory_order_relaxed)) {
+        chunk = scanChunk(range, begin, end, fileId_);
+      }
+      size_t enter = 0;
+      if (i > 0) {
+        left[i - 1].wait();
+        enter = leftAt[i - 1];
+      }
+      if (!chunk.records.empty() &&
+          size_t(chunk.records.front().second) < enter) {
+        chunk = scanChunk(range, enter, end, fileId_);
+      }
+      leftAt[i] = chunk.records.empty() ? std::max(enter, end) : chunk.next;
+      left[i].post();
+
+      count += chunk.records.size();
+      try {
+        for (auto& [record, pos] : chunk.records) {
+          if (stop.load(std::memory_order_relaxed)) {
+            break;
+          }
+          fn(record, pos);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+        stop = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threads; ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+  return count.load();
+}
+
+void RecordIOReader::writeIndex(File indexFile, ScanOptions options) const {
+  std::mutex mutex;
+  std::vector<uint64_t> positions;
+  scan(
+      [&](ByteRange, off_t pos) {
+        std::lock_guard<std::mutex> lock(mutex);
+        positions.push_back(uint64_t(pos));
+      },
+      options);
+  std::sort(positions.begin(), positions.end());
+
+  IndexHeader header;
+  header.magic = IndexHeader::kMagic;
+  header.fileId = fileId_;
+  header.dataSize = map_.range().size();
+  header.count = positions.size();
+  checkUnixError(
+      writeFull(indexFile.fd(), &header, sizeof(header)),
+      "write() failed");
+  checkUnixError(
+      writeFull(
+          indexFile.fd(),
+          positions.data(),
+          positions.size() * sizeof(uint64_t)),
+      "write() failed");
+}
+
+void RecordIOReader::loadIndex(File indexFile) {
+  MemoryMapping index(std::move(indexFile));
+  auto range = index.range();
+  IndexHeader header;
+  if (range.size() < sizeof(header)) {
+    throw std::runtime_error("RecordIOReader: truncated index");
+  }
+  std::memcpy(&header, range.data(), sizeof(header));
+  if (header.magic != IndexHeader::kMagic ||
+      range.size() != sizeof(header) + header.count * sizeof(uint64_t)) {
+    throw std::runtime_error("RecordIOReader: invalid index");
+  }
+  if (header.fileId != fileId_ || header.dataSize > map_.range().size()) {
+    throw std::runtime_error("RecordIOReader: index doesn't match the file");
+  }
+  index_.emplace(std::move(index));
+}
+
+size_t RecordIOReader::indexedRecords() const {
+  if (!index_) {
+    return 0;
+  }
+  IndexHeader header;
+  std::memcpy(&header, index_->range().data(), sizeof(header));
+  return header.count;
+}
+
+auto RecordIOReader::seekToRecord(size_t n) const -> Iterator {
+  if (n >= indexedRecords()) {
+    return end();
+  }
+  auto positions = index_->range().data() + sizeof(IndexHeader);
+  auto positionOf = [&](size_t i) {
+    uint64_t pos;
+    std::memcpy(&pos, positions + i * sizeof(uint64_t), sizeof(pos));
+    return pos;
+  };
+  // The records of a block have its position: skip those before the n-th.
+  auto pos = positionOf(n);
+  auto first = n;
+  while (first > 0 && positionOf(first - 1) == pos) {
+    --first;
+  }
+  auto it = seek(off_t(pos));
+  for (; first < n && it != end(); ++first) {
+    ++it;
+  }
+  return it;
+}
+
 void RecordIOReader::Iterator::advanceToValid() {
-  ByteRange record = findRecord(range_, fileId_).record;
-  if (record.empty()) {
-    recordAndPos_ = std::make_pair(ByteRange(), off_t(-1));
-    range_.clear(); // at end
-  } else {
+  while (true) {
+    auto info = findRecord(range_, fileId_);
+    ByteRange record = info.record;
+    if (record.empty()) {
+      recordAndPos_ = std::make_pair(ByteRange(), off_t(-1));
+      range_.clear(); // at end
+      block_.reset();
+      blockRecords_.clear();
+      return;
+    }
     auto skipped = size_t(record.begin() - range_.begin());
     DCHECK_GE(skipped, headerSize());
     skipped -= headerSize();
     range_.advance(skipped);
-    recordAndPos_.first = record;
     recordAndPos_.second += off_t(skipped);
+    recordSize_ = record.size();
+    if (info.version != Header::kBlockVersion) {
+      block_.reset();
+      blockRecords_.clear();
+      recordAndPos_.first = record;
+      return;
+    }
+
+    // An empty block, or one which can't be uncompressed, is skipped, as a
+    // corrupted record would be.
+    try {
+      block_ = uncompressBlock(record);
+      blockRecords_ = ByteRange(block_->data(), block_->length());
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "RecordIOReader: skipping a block: " << ex.what();
+      block_.reset();
+      blockRecords_.clear();
+    }
+    if (nextBlockRecord()) {
+      return;
+    }
+    auto skip = headerSize() + recordSize_;
+    recordAndPos_.second += off_t(skip);
+    range_.advance(skip);
   }
 }
 
@@ -134,9 +553,8 @@ std::size_t dataHash(ByteRange range) {
   return hash::SpookyHashV2::Hash64(range.data(), range.size(), kHashSeed);
 }
 
-} // namespace
-
-size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
+size_t prependHeader(
+    std::unique_ptr<IOBuf>& buf, uint32_t fileId, uint8_t version) {
   if (fileId == 0) {
     throw std::invalid_argument("invalid file id");
   }
@@ -159,6 +577,7 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
   auto header = reinterpret_cast<Header*>(buf->writableData());
   memset(header, 0, sizeof(Header));
   header->magic = Header::kMagic;
+  header->version = version;
   header->fileId = fileId;
   header->dataLength = uint32_t(lengthAndHash.first);
   header->dataHash = lengthAndHash.second;
@@ -167,12 +586,19 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
   return lengthAndHash.first + headerSize();
 }
 
+} // namespace
+
+size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId) {
+  return prependHeader(buf, fileId, 0);
+}
+
 bool validateRecordHeader(ByteRange range, uint32_t fileId) {
   if (range.size() < headerSize()) { // records may not be empty
     return false;
   }
   auto header = reinterpret_cast<const Header*>(range.begin());
-  if (header->magic != Header::kMagic || header->version != 0 ||
+  if (header->magic != Header::kMagic ||
+      header->version > Header::kBlockVersion ||
       header->hashFunction != 0 || header->flags != 0 ||
       (fileId != 0 && header->fileId != fileId)) {
     return false;
@@ -196,7 +622,7 @@ RecordInfo validateRecordData(ByteRange range) {
   if (dataHash(range) != header->dataHash) {
     return {0, {}};
   }
-  return {header->fileId, range};
+  return {header->fileId, range, header->version};
 }
 
 RecordInfo validateRecord(ByteRange range, uint32_t fileId) {
@@ -206,6 +632,32 @@ RecordInfo validateRecord(ByteRange range, uint32_t fileId) {
   return validateRecordData(range);
 }
 
+std::unique_ptr<IOBuf> uncompressBlock(ByteRange data) {
+  BlockHeader header;
+  if (data.size() < sizeof(header)) {
+    throw std::runtime_error("RecordIO: truncated block");
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  data.advance(sizeof(header));
+  auto codec =
+      compression::getCodec(compression::CodecType(header.codecType));
+  auto compressed = IOBuf::wrapBufferAsValue(data);
+  auto records = codec->uncompress(&compressed, header.uncompressedLength);
+  records->coalesce();
+  return records;
+}
+
+ByteRange popBlockRecord(ByteRange& records) {
+  auto length = tryDecodeVarint(records);
+  if (!length || *length == 0 || *length > records.size()) {
+    records.clear();
+    return ByteRange();
+  }
+  auto record = records.subpiece(0, *length);
+  records.advance(*length);
+  return record;
+}
+
 RecordInfo findRecord(
     ByteRange searchRange, ByteRange wholeRange, uint32_t fileId) {
   static const uint32_t magic = Header::kMagic;
@@ -27,11 +27,15 @@
 #define FOLLY_IO_RECORDIO_H_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 #include <folly/File.h>
+#include <folly/Function.h>
 #include <folly/Range.h>
+#include <folly/compression/Compression.h>
 #include <folly/io/IOBuf.h>
 #include <folly/system/MemoryMapping.h>
 
@@ -59,23 +63,59 @@ class RecordIOWriter {
    */
   explicit RecordIOWriter(File file, uint32_t fileId = 1);
 
+  /**
+   * Block mode packs the records into blocks, which are compressed and
+   * written by a background thread, so that small records don't pay for a
+   * header and a write each. A block is a record of format version 1, with
+   * the checksum of its compressed data; RecordIOReader returns the records
+   * it holds, which all have the position of the block.
+   */
+  struct BlockOptions {
+    BlockOptions() {}
+
+    compression::CodecType codecType = compression::CodecType::NO_COMPRESSION;
+    // A block is sealed once its records take this many bytes, or flush().
+    size_t blockSize = size_t(1) << 20;
+    // write() waits while this many sealed blocks are waiting to be written.
+    size_t maxPendingBlocks = 4;
+  };
+
+  RecordIOWriter(File file, uint32_t fileId, BlockOptions options);
+
+  ~RecordIOWriter();
+
   /**
    * Write a record.  We will use at most headerSize() bytes of headroom,
    * you might want to arrange that before copying your data into it.
+   *
+   * In block mode, the record is added to the current block; this rethrows
+   * the error of a block written in the background, if any.
    */
   void write(std::unique_ptr<IOBuf> buf);
 
+  /**
+   * In block mode, seal the current block and wait until all blocks are
+   * written. The destructor flushes too.
+   */
+  void flush();
+
   /**
    * Return the position in the file where the next byte will be written.
    * Conservative, as stuff can be written at any time from another thread.
+   * In block mode, the blocks not written yet aren't accounted for.
    */
   off_t filePos() const { return filePos_; }
 
  private:
+  class BlockWriter;
+
+  void writeRecord(std::unique_ptr<IOBuf> buf, uint8_t version);
+
   File file_;
   uint32_t fileId_;
   std::unique_lock<File> writeLock_;
   std::atomic<off_t> filePos_;
+  std::unique_ptr<BlockWriter> blockWriter_;
 };
 
 /**
@@ -114,9 +154,62 @@ class RecordIOReader {
    */
   Iterator seek(off_t pos) const;
 
+  struct ScanOptions {
+    ScanOptions() {}
+
+    // The threads which scan, the calling one included; 0 means one per CPU.
+    size_t threads = 0;
+    // The file is split in chunks of about this many bytes, which the threads
+    // take in turns.
+    size_t chunkSize = size_t(64) << 20;
+  };
+
+  /**
+   * Call fn(record, pos) on each record that iterating returns, validating and
+   * handling the chunks of the file on several threads. The records of a chunk
+   * are handed to fn in order, by one thread, but the chunks are handled
+   * concurrently: fn must be thread-safe.
+   *
+   * A chunk resynchronizes on the first valid record which begins in it, as
+   * iterating does after corrupted data; if that record turns out to lie in
+   * the last record of the chunk before, the chunk is scanned again from the
+   * end of that one. So the records are exactly those iterating returns.
+   *
+   * If fn throws, the scan stops early and rethrows the first exception.
+   * Returns the number of records.
+   */
+  size_t scan(
+      FunctionRef<void(ByteRange record, off_t pos)> fn,
+      ScanOptions options = ScanOptions()) const;
+
+  /**
+   * Write an index of the records to indexFile, as a sidecar which
+   * loadIndex() loads to seek to the n-th record in O(1).
+   */
+  void writeIndex(File indexFile, ScanOptions options = ScanOptions()) const;
+
+  /**
+   * Load an index which writeIndex() wrote, for this file and fileId.
+   * Throws if it doesn't match them, or if the file shrank since. The records
+   * appended since aren't indexed.
+   */
+  void loadIndex(File indexFile);
+
+  /**
+   * The number of records the loaded index holds, 0 if none was loaded.
+   */
+  size_t indexedRecords() const;
+
+  /**
+   * Create an iterator to the n-th record, counting from 0, using the loaded
+   * index; end() if the index holds n records or less.
+   */
+  Iterator seekToRecord(size_t n) const;
+
  private:
   MemoryMapping map_;
   uint32_t fileId_;
+  std::optional<MemoryMapping> index_;
 };
 
 namespace recordio_helpers {
@@ -156,6 +249,8 @@ size_t prependHeader(std::unique_ptr<IOBuf>& buf, uint32_t fileId = 1);
 struct RecordInfo {
   uint32_t fileId;
   ByteRange record;
+  // 1 for the blocks of records written in block mode: see uncompressBlock().
+  uint8_t version = 0;
 };
 RecordInfo findRecord(
     ByteRange searchRange, ByteRange wholeRange, uint32_t fileId);
@@ -190,6 +285,20 @@ RecordInfo validateRecordData(ByteRange range);
  */
 RecordInfo validateRecord(ByteRange range, uint32_t fileId);
 
+/**
+ * Uncompress the data of a block, a record of version 1 written in block mode
+ * (see RecordIOWriter::BlockOptions). Returns the records it holds, each as a
+ * varint length followed by the data, which popBlockRecord() splits. Throws if
+ * the block can't be uncompressed.
+ */
+std::unique_ptr<IOBuf> uncompressBlock(ByteRange data);
+
+/**
+ * Pop the next record of records, which uncompressBlock() returned. Returns
+ * ByteRange() at the end, or if records is malformed.
+ */
+ByteRange popBlockRecord(ByteRange& records);
+
 } // namespace recordio_helpers
 
 } // namespace folly
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/io/async/AdaptiveReadBufferSizer.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace folly {
+
+namespace {
+// Steps of 16 bytes below this size, powers of two from it on.
+constexpr size_t kLinearLimit = 512;
+constexpr uint32_t kLinearSteps = kLinearLimit / 16 - 1;
+} // namespace
+
+size_t AdaptiveReadBufferSizer::sizeAt(uint32_t index) {
+  if (index < kLinearSteps) {
+    return size_t(16) * (index + 1);
+  }
+  return kLinearLimit << (index - kLinearSteps);
+}
+
+uint32_t AdaptiveReadBufferSizer::indexOf(size_t size) {
+  if (size <= kLinearLimit - 16) {
+    return size <= 16 ? 0 : uint32_t((size + 15) / 16 - 1);
+  }
+  uint32_t index = kLinearSteps;
+  while (sizeAt(index) < size) {
+    ++index;
+  }
+  return index;
+}
+
+AdaptiveReadBufferSizer::AdaptiveReadBufferSizer(const Options& options)
+    : minIndex_(indexOf(options.minimum)),
+      maxIndex_(indexOf(options.maximum)),
+      index_(std::clamp(indexOf(options.initial), minIndex_, maxIndex_)) {
+  DCHECK_LE(options.minimum, options.maximum);
+}
+
+void AdaptiveReadBufferSizer::record(size_t bytesRead) {
+  if (bytesRead <= sizeAt(std::max(index_, kDecrement) - kDecrement)) {
+    if (decreaseNow_) {
+      index_ = std::max(index_ - std::min(index_, kDecrement), minIndex_);
+      decreaseNow_ = false;
+    } else {
+      decreaseNow_ = true;
+    }
+  } else if (bytesRead >= nextSize()) {
+    index_ = std::min(index_ + kIncrement, maxIndex_);
+    decreaseNow_ = false;
+  }
+}
+
+} // namespace folly
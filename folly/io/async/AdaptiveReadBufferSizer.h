@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace folly {
+
+/**
+ * Guesses the size of the next read buffer of a connection from the sizes
+ * of its recent reads, as Netty's AdaptiveRecvByteBufAllocator does.
+ *
+ * Sizes are taken from a table of steps of 16 bytes up to 512 bytes, and
+ * of powers of two above. The guess moves up four steps as soon as a read
+ * fills the buffer, and down one step after two reads in a row that would
+ * have fit in the step below: it follows bursts quickly, and only shrinks
+ * once the connection has clearly quietened down.
+ *
+ *   AdaptiveReadBufferSizer sizer;
+ *   auto buf = IOBuf::create(sizer.nextSize());
+ *   ...
+ *   sizer.record(bytesRead);
+ */
+class AdaptiveReadBufferSizer {
+ public:
+  struct Options {
+    Options() {}
+    size_t minimum = 64;
+    size_t initial = 2048;
+    size_t maximum = 64 * 1024;
+  };
+
+  explicit AdaptiveReadBufferSizer(const Options& options = Options());
+
+  size_t nextSize() const { return sizeAt(index_); }
+
+  /**
+   * Records that a read into a buffer of nextSize() bytes returned
+   * bytesRead bytes.
+   */
+  void record(size_t bytesRead);
+
+  /**
+   * Size of the index-th step of the table, and index of the smallest step
+   * of at least size bytes.
+   */
+  static size_t sizeAt(uint32_t index);
+  static uint32_t indexOf(size_t size);
+
+ private:
+  static constexpr uint32_t kIncrement = 4;
+  static constexpr uint32_t kDecrement = 1;
+
+  uint32_t minIndex_;
+  uint32_t maxIndex_;
+  uint32_t index_;
+  bool decreaseNow_{false};
+};
+
+} // namespace folly
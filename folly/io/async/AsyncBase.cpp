@@ -138,6 +138,9 @@ int AsyncBase::submit(Range<Op**> ops) {
   // We can increment past capacity, but we'll clean up after ourselves.
   auto p = pending_.fetch_add(ops.size(), std::memory_order_acq_rel);
   if (p >= capacity_) {
+    for (auto& op : ops) {
+      op->unstart();
+    }
     decrementPending(ops.size());
     throw std::range_error("AsyncBase: too many pending requests");
   }
@@ -145,6 +148,9 @@ int AsyncBase::submit(Range<Op**> ops) {
   int rc = submitRange(ops);
 
   if (rc < 0) {
+    for (auto& op : ops) {
+      op->unstart();
+    }
     decrementPending(ops.size());
     throwSystemErrorExplicit(-rc, "AsyncBase: io_submit failed");
   }
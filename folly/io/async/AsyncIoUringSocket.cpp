@@ -644,8 +644,8 @@ void AsyncIoUringSocket::ReadSqe::callback(const io_uring_cqe* cqe) noexcept {
       readCallback_->readEOF();
     } else if (res == -ENOBUFS) {
       if (lastUsedBufferProvider_) {
-        // urgh, resubmit and let submit logic deal with the fact
-        // we have no more buffers
+        // the provider may grow here, otherwise resubmit and let submit
+        // logic deal with the fact we have no more buffers
         lastUsedBufferProvider_->enobuf();
       }
       if (parent_) {
@@ -1510,6 +1510,16 @@ bool AsyncIoUringSocket::canZC(std::unique_ptr<IOBuf> const& buf) const {
   if (!options_.zeroCopyEnable) {
     return false;
   }
+  // The kernel may still read from the pages after the write completed, so
+  // only send chains whose memory the WriteSqe keeps alive until the
+  // notification arrives, as AsyncSocket does for MSG_ZEROCOPY.
+  if (!buf->isManaged()) {
+    return false;
+  }
+  if (options_.zeroCopyMinSize > 0 &&
+      buf->computeChainDataLength() < options_.zeroCopyMinSize) {
+    return false;
+  }
   return (*options_.zeroCopyEnable)(buf);
 }
 
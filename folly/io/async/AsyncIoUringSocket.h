@@ -66,6 +66,10 @@ class AsyncIoUringSocket : public AsyncSocketTransport {
     static std::unique_ptr<IOBuf> defaultAllocateNoBufferPoolBuffer();
     folly::Function<std::unique_ptr<IOBuf>()> allocateNoBufferPoolBuffer;
     folly::Optional<AsyncWriter::ZeroCopyEnableFunc> zeroCopyEnable;
+    // Writes of fewer bytes are sent with a copying sendmsg even if
+    // zeroCopyEnable accepts them: pinning pages and waiting for the
+    // notification costs more than copying small buffers.
+    size_t zeroCopyMinSize{0};
     bool multishotRecv;
   };
 
@@ -132,6 +136,7 @@ class AsyncIoUringSocket : public AsyncSocketTransport {
       std::unique_ptr<IOBuf>&& buf,
       WriteFlags flags) override;
   bool canZC(std::unique_ptr<IOBuf> const& buf) const;
+  void setZeroCopyMinSize(size_t bytes) { options_.zeroCopyMinSize = bytes; }
 
   // AsyncTransport
   void close() override;
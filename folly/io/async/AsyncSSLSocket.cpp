@@ -39,6 +39,16 @@
 #include <folly/ssl/SSLSession.h>
 #include <folly/ssl/SSLSessionManager.h>
 
+#if defined(__linux__) && !defined(OPENSSL_IS_BORINGSSL) && \
+    defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS) &&  \
+    __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#define FOLLY_SSL_KTLS 1
+#else
+#define FOLLY_SSL_KTLS 0
+#endif
+
 using std::shared_ptr;
 
 using folly::SpinLock;
@@ -61,6 +71,14 @@ SpinLock dummyCtxLock;
 // stack, otherwise it is allocated on heap
 const size_t MAX_STACK_BUF_SIZE = 2048;
 
+#if FOLLY_SSL_KTLS
+// The BIO controls through which OpenSSL sets up kTLS on a socket BIO. They
+// aren't exported, see openssl/bio.h.
+constexpr int kBioCtrlSetKtls = 72;
+constexpr int kBioCtrlSetKtlsTxSendCtrlMsg = 74;
+constexpr int kBioCtrlClearKtlsTxCtrlMsg = 75;
+#endif
+
 char const* str_or(char const* const str, char const* const def = "(unknown)") {
   return str ? str : def;
 }
@@ -95,6 +113,8 @@ void* initsslBioMethod() {
   // override the bwrite method for MSG_EOR support
   OpenSSLUtils::setCustomBioWriteMethod(sslBioMethod, AsyncSSLSocket::bioWrite);
   OpenSSLUtils::setCustomBioReadMethod(sslBioMethod, AsyncSSLSocket::bioRead);
+  // override the ctrl method for kTLS support
+  OpenSSLUtils::setCustomBioCtrlMethod(sslBioMethod, AsyncSSLSocket::bioCtrl);
 
   // Note that the sslBioMethod.type and sslBioMethod.name are not
   // set here. openssl code seems to be checking ".type == BIO_TYPE_SOCKET" and
@@ -875,6 +895,13 @@ bool AsyncSSLSocket::setupSSLBio() {
   OpenSSLUtils::setBioAppData(sslBio, this);
   OpenSSLUtils::setBioFd(sslBio, fd_, BIO_NOCLOSE);
   SSL_set_bio(ssl_.get(), sslBio, sslBio);
+#if FOLLY_SSL_KTLS
+  if (ktlsEnabled_) {
+    // OpenSSL then hands the keys to the BIO when it changes the write
+    // cipher, see bioCtrl().
+    SSL_set_options(ssl_.get(), SSL_OP_ENABLE_KTLS);
+  }
+#endif
   return true;
 }
 
@@ -1726,6 +1753,15 @@ AsyncSocket::WriteResult AsyncSSLSocket::performWrite(
     return WriteResult(
         WRITE_ERROR, std::make_unique<SSLException>(SSLError::EARLY_WRITE));
   }
+  if (ktlsTxActive_) {
+    // The kernel frames and encrypts whatever is written to the socket.
+    auto result = AsyncSocket::performWrite(
+        vec, count, flags, countWritten, partialWritten, std::move(writeTag));
+    if (result.writeReturn > 0) {
+      appBytesWritten_ += result.writeReturn;
+    }
+    return result;
+  }
 
   // Declare a buffer used to hold small write requests.  It could point to a
   // memory block either on stack or on heap. If it is on heap, we release it
@@ -1939,6 +1975,37 @@ int AsyncSSLSocket::bioWrite(BIO* b, const char* in, int inl) {
   struct iovec vec;
   vec.iov_base = const_cast<char*>(in);
   vec.iov_len = size_t(inl);
+#if FOLLY_SSL_KTLS
+  if (sslSock->ktlsRecordType_ != 0) {
+    // OpenSSL writes the plaintext of a record which isn't application data,
+    // e.g. an alert; the kernel needs its type.
+    union {
+      char buf[CMSG_SPACE(sizeof(uint8_t))];
+      cmsghdr align;
+    } control;
+    msghdr msg{};
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+    *CMSG_DATA(cmsg) = sslSock->ktlsRecordType_;
+    auto result = sslSock->sendSocketMessage(
+        sslSock->fd_, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    BIO_clear_retry_flags(b);
+    if (result.writeReturn == inl) {
+      sslSock->ktlsRecordType_ = 0;
+    } else if (!result.exception && result.writeReturn <= 0) {
+      if (OpenSSLUtils::getBioShouldRetryWrite(int(result.writeReturn))) {
+        BIO_set_retry_write(b);
+      }
+    }
+    return int(result.writeReturn);
+  }
+#endif
   // NB: It would be technically possible to plumb through the actual write
   // tag in here, but we decided it not to be worth the implementation
   // complexity.  The PoC implementation + tests are D43023628 (V15) +
@@ -1985,6 +2052,52 @@ int AsyncSSLSocket::bioRead(BIO* b, char* out, int outl) {
   }
 }
 
+long AsyncSSLSocket::bioCtrl(BIO* b, int cmd, long num, void* ptr) {
+  static const auto socketCtrl =
+      BIO_meth_get_ctrl(const_cast<BIO_METHOD*>(BIO_s_socket()));
+#if FOLLY_SSL_KTLS
+  switch (cmd) {
+    case kBioCtrlSetKtls: {
+      auto sslSock =
+          reinterpret_cast<AsyncSSLSocket*>(OpenSSLUtils::getBioAppData(b));
+      // bioRead() doesn't handle the records the kernel would decrypt, so
+      // only the write side is offloaded.
+      if (!sslSock || num == 0) {
+        return 0;
+      }
+      static const char kUlp[] = "tls";
+      if (netops::setsockopt(
+              sslSock->fd_, SOL_TCP, TCP_ULP, kUlp, sizeof(kUlp)) != 0 &&
+          errno != EEXIST) {
+        VLOG(4) << "AsyncSSLSocket::bioCtrl() this=" << sslSock
+                << ", kTLS unavailable: " << errnoStr(errno);
+        return 0;
+      }
+      long ret = socketCtrl(b, cmd, num, ptr);
+      if (ret > 0) {
+        sslSock->ktlsTxActive_ = true;
+      }
+      return ret;
+    }
+    case kBioCtrlSetKtlsTxSendCtrlMsg:
+    case kBioCtrlClearKtlsTxCtrlMsg: {
+      // The socket BIO would remember the record type for its own write
+      // method, so bioWrite() has to.
+      auto sslSock =
+          reinterpret_cast<AsyncSSLSocket*>(OpenSSLUtils::getBioAppData(b));
+      if (sslSock) {
+        sslSock->ktlsRecordType_ =
+            cmd == kBioCtrlSetKtlsTxSendCtrlMsg ? uint8_t(num) : 0;
+      }
+      return 0;
+    }
+    default:
+      break;
+  }
+#endif
+  return socketCtrl(b, cmd, num, ptr);
+}
+
 int AsyncSSLSocket::sslVerifyCallback(
     int preverifyOk, X509_STORE_CTX* x509Ctx) {
   SSL* ssl = (SSL*)X509_STORE_CTX_get_ex_data(
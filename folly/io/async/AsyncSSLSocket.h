@@ -173,9 +173,13 @@ class AsyncSSLSocket : public AsyncSocket {
 
     void readDataAvailable(size_t len) noexcept override {
       CHECK_EQ(len, 1u);
-      sslSocket_->restartSSLAccept();
+      // The handshake may wait for another asynchronous operation, with a
+      // new callback, so release this one (and delete it) before resuming.
+      auto sslSocket = sslSocket_;
+      auto dg = std::move(dg_);
       pipeReader_->setReadCB(nullptr);
-      sslSocket_->setAsyncOperationFinishCallback(nullptr);
+      sslSocket->setAsyncOperationFinishCallback(nullptr);
+      sslSocket->restartSSLAccept();
     }
 
     void getReadBuffer(void** bufReturn, size_t* lenReturn) noexcept override {
@@ -798,6 +802,7 @@ class AsyncSSLSocket : public AsyncSocket {
   static AsyncSSLSocket* getFromSSL(const SSL* ssl);
   static int bioWrite(BIO* b, const char* in, int inl);
   static int bioRead(BIO* b, char* out, int outl);
+  static long bioCtrl(BIO* b, int cmd, long num, void* ptr);
   void resetClientHelloParsing(SSL* ssl);
   static void parseClientAlpns(
       AsyncSSLSocket* sock,
@@ -879,6 +884,26 @@ class AsyncSSLSocket : public AsyncSocket {
     return false;
   }
 
+  /**
+   * Offload the encryption of the records written to the socket to the
+   * kernel (kTLS), if OpenSSL and the kernel support it for the negotiated
+   * cipher. Must be called before the handshake; otherwise, or if kTLS can't
+   * be set up, the records are encrypted by OpenSSL as usual.
+   *
+   * Once the handshake completes, writes skip SSL_write() and pass the
+   * plaintext to the socket, which frames and encrypts it into records. This
+   * saves a copy, and allows sendfile() on the socket once the pending writes
+   * are flushed. Records read from the socket are still decrypted by OpenSSL.
+   */
+  void setKtlsEnabled(bool enabled) { ktlsEnabled_ = enabled; }
+
+  bool getKtlsEnabled() const { return ktlsEnabled_; }
+
+  /**
+   * Whether the kernel encrypts the records written to the socket.
+   */
+  bool isKtlsTxActive() const { return ktlsTxActive_; }
+
   const char* getNegotiatedGroup() const;
 
  private:
@@ -1008,6 +1033,13 @@ class AsyncSSLSocket : public AsyncSocket {
   // It doesn't take effect when it is 0.
   size_t minWriteSize_{1500};
 
+  // See setKtlsEnabled()
+  bool ktlsEnabled_{false};
+  bool ktlsTxActive_{false};
+  // Type of the record being written by bioWrite() if it isn't application
+  // data while kTLS is active, which the kernel must be told about, or 0.
+  uint8_t ktlsRecordType_{0};
+
   std::shared_ptr<const folly::SSLContext> handshakeCtx_;
   std::string tlsextHostname_;
 
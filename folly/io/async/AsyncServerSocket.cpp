@@ -794,7 +794,16 @@ void AsyncServerSocket::startAccepting() {
     return;
   }
 
+  // The callback stays set when the handlers are registered again, e.g.
+  // after a backoff.
+  bool multishot = multishotAccept_ && eventBase_ &&
+      eventBase_->getBackend()->supportsMultishotAccept();
   for (auto& handler : sockets_) {
+    if (multishot) {
+      handler.setAcceptMultishotCallback(&handler);
+    } else {
+      handler.resetEventCallback();
+    }
     if (!handler.registerHandler(EventHandler::READ | EventHandler::PERSIST)) {
       throw std::runtime_error("failed to register for accept events");
     }
@@ -1031,129 +1040,174 @@ void AsyncServerSocket::handlerReady(
 #else
     auto clientSocket = netops::accept(fd, saddr, &addrLen);
 #endif
+    int errnoValue = clientSocket == NetworkSocket() ? errno : 0;
 
     address.setFromSockaddr(saddr, addrLen);
 
-    if (clientSocket != NetworkSocket() && connectionEventCallback_) {
-      connectionEventCallback_->onConnectionAccepted(clientSocket, address);
+    if (!processAccepted(
+            clientSocket, std::move(address), addressFamily, errnoValue)) {
+      break;
     }
+  }
+}
 
-    // Connection accepted, get the SYN packet from the client if
-    // TOS reflect is enabled
-    if (kIsLinux && clientSocket != NetworkSocket() && tosReflect_) {
-      std::array<uint32_t, 64> buffer;
-      socklen_t len = sizeof(buffer);
-      int ret = netops::getsockopt(
-          clientSocket, IPPROTO_TCP, TCP_SAVED_SYN, &buffer, &len);
-
-      if (ret == 0) {
-        uint32_t tosWord = folly::Endian::big(buffer[0]);
-        if (addressFamily == AF_INET6) {
-          tosWord = (tosWord & 0x0FC00000) >> 20;
-          // Set the TOS on the return socket only if it is non-zero
-          if (tosWord) {
-            ret = netops::setsockopt(
-                clientSocket,
-                IPPROTO_IPV6,
-                IPV6_TCLASS,
-                &tosWord,
-                sizeof(tosWord));
-          }
-        } else if (addressFamily == AF_INET) {
-          tosWord = (tosWord & 0x00FC0000) >> 16;
-          if (tosWord) {
-            ret = netops::setsockopt(
-                clientSocket, IPPROTO_IP, IP_TOS, &tosWord, sizeof(tosWord));
-          }
-        }
+void AsyncServerSocket::handlerAccepted(
+    int res, sa_family_t addressFamily) noexcept {
+  if (res == -ECANCELED) {
+    // The handler was unregistered.
+    return;
+  }
+  DestructorGuard dg(this);
+
+  NetworkSocket clientSocket;
+  SocketAddress address;
+  if (res >= 0) {
+    clientSocket = NetworkSocket::fromFd(res);
+    if (callbacks_.empty()) {
+      closeNoInt(clientSocket);
+      return;
+    }
+    // The multishot accept doesn't report the client address.
+    sockaddr_storage addrStorage = {};
+    socklen_t addrLen = sizeof(addrStorage);
+    auto saddr = reinterpret_cast<sockaddr*>(&addrStorage);
+    if (netops::getpeername(clientSocket, saddr, &addrLen) != 0) {
+      // The client is already gone.
+      closeNoInt(clientSocket);
+      return;
+    }
+    if (addressFamily == AF_UNIX) {
+      saddr->sa_family = AF_UNIX;
+    }
+    address.setFromSockaddr(saddr, addrLen);
+  }
+
+  processAccepted(
+      clientSocket, std::move(address), addressFamily, res < 0 ? -res : 0);
+}
+
+bool AsyncServerSocket::processAccepted(
+    NetworkSocket clientSocket,
+    SocketAddress&& address,
+    sa_family_t addressFamily,
+    int errnoValue) {
+  if (clientSocket != NetworkSocket() && connectionEventCallback_) {
+    connectionEventCallback_->onConnectionAccepted(clientSocket, address);
+  }
 
-        if (ret != 0) {
-          LOG(ERROR) << "Unable to set TOS for accepted socket "
-                     << clientSocket;
+  // Connection accepted, get the SYN packet from the client if
+  // TOS reflect is enabled
+  if (kIsLinux && clientSocket != NetworkSocket() && tosReflect_) {
+    std::array<uint32_t, 64> buffer;
+    socklen_t len = sizeof(buffer);
+    int ret = netops::getsockopt(
+        clientSocket, IPPROTO_TCP, TCP_SAVED_SYN, &buffer, &len);
+
+    if (ret == 0) {
+      uint32_t tosWord = folly::Endian::big(buffer[0]);
+      if (addressFamily == AF_INET6) {
+        tosWord = (tosWord & 0x0FC00000) >> 20;
+        // Set the TOS on the return socket only if it is non-zero
+        if (tosWord) {
+          ret = netops::setsockopt(
+              clientSocket,
+              IPPROTO_IPV6,
+              IPV6_TCLASS,
+              &tosWord,
+              sizeof(tosWord));
         }
-      } else {
-        LOG(ERROR) << "Unable to get SYN packet for accepted socket "
+      } else if (addressFamily == AF_INET) {
+        tosWord = (tosWord & 0x00FC0000) >> 16;
+        if (tosWord) {
+          ret = netops::setsockopt(
+              clientSocket, IPPROTO_IP, IP_TOS, &tosWord, sizeof(tosWord));
+        }
+      }
+
+      if (ret != 0) {
+        LOG(ERROR) << "Unable to set TOS for accepted socket "
                    << clientSocket;
       }
+    } else {
+      LOG(ERROR) << "Unable to get SYN packet for accepted socket "
+                 << clientSocket;
     }
+  }
 
-    std::chrono::time_point<std::chrono::steady_clock> nowMs =
-        std::chrono::steady_clock::now();
-    auto timeSinceLastAccept = std::max<int64_t>(
-        0,
-        nowMs.time_since_epoch().count() -
-            lastAccepTimestamp_.time_since_epoch().count());
-    lastAccepTimestamp_ = nowMs;
-    if (acceptRate_ < 1) {
-      acceptRate_ *= 1 + acceptRateAdjustSpeed_ * timeSinceLastAccept;
-      if (acceptRate_ >= 1) {
-        acceptRate_ = 1;
-      } else if (rand() > acceptRate_ * RAND_MAX) {
-        ++numDroppedConnections_;
-        if (clientSocket != NetworkSocket()) {
-          closeNoInt(clientSocket);
-          if (connectionEventCallback_) {
-            connectionEventCallback_->onConnectionDropped(
-                clientSocket,
-                address,
-                fmt::format(
-                    "Server is rate limiting new connections. Current accept rate is {}",
-                    acceptRate_));
-          }
+  std::chrono::time_point<std::chrono::steady_clock> nowMs =
+      std::chrono::steady_clock::now();
+  auto timeSinceLastAccept = std::max<int64_t>(
+      0,
+      nowMs.time_since_epoch().count() -
+          lastAccepTimestamp_.time_since_epoch().count());
+  lastAccepTimestamp_ = nowMs;
+  if (acceptRate_ < 1) {
+    acceptRate_ *= 1 + acceptRateAdjustSpeed_ * timeSinceLastAccept;
+    if (acceptRate_ >= 1) {
+      acceptRate_ = 1;
+    } else if (rand() > acceptRate_ * RAND_MAX) {
+      ++numDroppedConnections_;
+      if (clientSocket != NetworkSocket()) {
+        closeNoInt(clientSocket);
+        if (connectionEventCallback_) {
+          connectionEventCallback_->onConnectionDropped(
+              clientSocket,
+              address,
+              fmt::format(
+                  "Server is rate limiting new connections. Current accept rate is {}",
+                  acceptRate_));
         }
-        continue;
       }
+      return true;
     }
+  }
 
-    if (clientSocket == NetworkSocket()) {
-      if (errno == EAGAIN) {
-        // No more sockets to accept right now.
-        // Check for this code first, since it's the most common.
-        return;
-      } else if (errno == EMFILE || errno == ENFILE) {
-        // We're out of file descriptors.  Perhaps we're accepting connections
-        // too quickly. Pause accepting briefly to back off and give the server
-        // a chance to recover.
-        LOG(ERROR) << "accept failed: out of file descriptors; entering accept "
-                      "back-off state";
-        enterBackoff();
-
-        // Dispatch the error message
-        dispatchError("accept() failed", errno);
-      } else {
-        dispatchError("accept() failed", errno);
-      }
-      if (connectionEventCallback_) {
-        connectionEventCallback_->onConnectionAcceptError(errno);
-      }
-      return;
+  if (clientSocket == NetworkSocket()) {
+    if (errnoValue == EAGAIN) {
+      // No more sockets to accept right now.
+      // Check for this code first, since it's the most common.
+      return false;
+    } else if (errnoValue == EMFILE || errnoValue == ENFILE) {
+      // We're out of file descriptors.  Perhaps we're accepting connections
+      // too quickly. Pause accepting briefly to back off and give the server
+      // a chance to recover.
+      LOG(ERROR) << "accept failed: out of file descriptors; entering accept "
+                    "back-off state";
+      enterBackoff();
+
+      // Dispatch the error message
+      dispatchError("accept() failed", errnoValue);
+    } else {
+      dispatchError("accept() failed", errnoValue);
+    }
+    if (connectionEventCallback_) {
+      connectionEventCallback_->onConnectionAcceptError(errnoValue);
     }
+    return false;
+  }
 
 #if !FOLLY_HAVE_ACCEPT4
-    // Explicitly set the new connection to non-blocking mode
-    if (netops::set_socket_non_blocking(clientSocket) != 0) {
-      closeNoInt(clientSocket);
-      std::string errorMsg =
-          "Failed to set accepted socket to non-blocking mode.";
-      dispatchError(errorMsg.c_str(), errno);
-      if (connectionEventCallback_) {
-        connectionEventCallback_->onConnectionDropped(
-            clientSocket,
-            address,
-            fmt::format("{} errno ({})", std::move(errorMsg), errno));
-      }
-      return;
+  // Explicitly set the new connection to non-blocking mode
+  if (netops::set_socket_non_blocking(clientSocket) != 0) {
+    closeNoInt(clientSocket);
+    std::string errorMsg =
+        "Failed to set accepted socket to non-blocking mode.";
+    dispatchError(errorMsg.c_str(), errno);
+    if (connectionEventCallback_) {
+      connectionEventCallback_->onConnectionDropped(
+          clientSocket,
+          address,
+          fmt::format("{} errno ({})", std::move(errorMsg), errno));
     }
+    return false;
+  }
 #endif
 
-    // Inform the callback about the new connection
-    dispatchSocket(clientSocket, std::move(address));
+  // Inform the callback about the new connection
+  dispatchSocket(clientSocket, std::move(address));
 
-    // If we aren't accepting any more, break out of the loop
-    if (!accepting_ || callbacks_.empty()) {
-      break;
-    }
-  }
+  // Stop there if we aren't accepting any more
+  return accepting_ && !callbacks_.empty();
 }
 
 void AsyncServerSocket::dispatchSocket(
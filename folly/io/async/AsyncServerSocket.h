@@ -611,6 +611,19 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
    */
   void setMaxAcceptAtOnce(uint32_t numConns) { maxAcceptAtOnce_ = numConns; }
 
+  /**
+   * Accept connections with a single multishot accept request per listening
+   * socket, when the EventBase backend supports it (IoUringBackend on Linux
+   * 5.19 or later), instead of an accept() call per connection once the
+   * socket is readable. Each accepted connection is then handled as soon as
+   * the backend reaps its completion, and maxAcceptAtOnce doesn't apply.
+   *
+   * Takes effect the next time startAccepting() is called.
+   */
+  void setMultishotAccept(bool enabled) { multishotAccept_ = enabled; }
+
+  bool getMultishotAccept() const { return multishotAccept_; }
+
   /**
    * Get the duration after which new connection messages will be dropped from
    * the NotificationQueue if it has not started processing yet.
@@ -942,6 +955,12 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
 
   virtual void handlerReady(
       uint16_t events, NetworkSocket fd, sa_family_t family) noexcept;
+  void handlerAccepted(int res, sa_family_t family) noexcept;
+  bool processAccepted(
+      NetworkSocket clientSocket,
+      SocketAddress&& address,
+      sa_family_t addressFamily,
+      int errnoValue);
 
   NetworkSocket createSocket(int family);
   void setupSocket(NetworkSocket fd, int family);
@@ -977,7 +996,8 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
     return info;
   }
 
-  struct ServerEventHandler : public EventHandler {
+  struct ServerEventHandler : public EventHandler,
+                              public EventAcceptMultishotCallback {
     ServerEventHandler(
         EventBase* eventBase,
         NetworkSocket socket,
@@ -1015,6 +1035,18 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
       parent_->handlerReady(events, socket_, addressFamily_);
     }
 
+    // Inherited from EventAcceptMultishotCallback
+    Hdr* allocateAcceptMultishotData() noexcept override {
+      auto* hdr = new Hdr();
+      hdr->arg_ = this;
+      hdr->freeFunc_ = [](Hdr* h) { delete h; };
+      hdr->cbFunc_ = [](Hdr* h, int res) {
+        auto* handler = static_cast<ServerEventHandler*>(h->arg_);
+        handler->parent_->handlerAccepted(res, handler->addressFamily_);
+      };
+      return hdr;
+    }
+
     EventBase* eventBase_;
     NetworkSocket socket_;
     AsyncServerSocket* parent_;
@@ -1026,6 +1058,7 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
   std::vector<NetworkSocket> pendingCloseSockets_;
   bool accepting_;
   uint32_t maxAcceptAtOnce_;
+  bool multishotAccept_{false};
   uint32_t maxNumMsgsInQueue_;
   double acceptRateAdjustSpeed_; // 0 to disable auto adjust
   double acceptRate_;
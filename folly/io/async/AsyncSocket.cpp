@@ -25,6 +25,7 @@
 
 #include <folly/Exception.h>
 #include <folly/Format.h>
+#include <folly/Indestructible.h>
 #include <folly/Portability.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
@@ -32,6 +33,7 @@
 #include <folly/io/IOBuf.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/io/SocketOptionMap.h>
+#include <folly/io/async/EventBaseLocal.h>
 #include <folly/lang/CheckedMath.h>
 #include <folly/portability/Fcntl.h>
 #include <folly/portability/Sockets.h>
@@ -637,6 +639,14 @@ AsyncSocket::ByteEventHelper::processCmsg(
 namespace {
 AsyncSocket::SendMsgParamsCallback defaultSendMsgParamsCallback;
 
+// Blocks that the sockets of an EventBase read into in ReadMode::ReadVec
+// with adaptive read buffers. Reads are synchronous, so no two sockets ever
+// use the builder at the same time.
+IOBufIovecBuilder& readIovecBuilder(EventBase& evb) {
+  static Indestructible<EventBaseLocal<IOBufIovecBuilder>> builders;
+  return builders->try_emplace(evb, IOBufIovecBuilder::Options());
+}
+
 // Based on flags, signal the transparent handler to disable certain functions
 void disableTransparentFunctions(
     NetworkSocket fd, bool noTransparentTls, bool noTSocks) {
@@ -814,6 +824,10 @@ NetworkSocket AsyncSocket::detachNetworkSocket() {
   VLOG(6) << "AsyncSocket::detachFd(this=" << this << ", fd=" << fd_
           << ", evb=" << eventBase_ << ", state=" << state_
           << ", events=" << std::hex << eventFlags_ << ")";
+  if (state_ == StateEnum::ESTABLISHED) {
+    flushCoalescedWrites();
+  }
+
   // legacy observer support
   for (const auto& cb : lifecycleObservers_) {
     cb->fdDetach(this);
@@ -1789,8 +1803,106 @@ void AsyncSocket::writev(
   writeImpl(callback, vec, count, unique_ptr<IOBuf>(), totalBytes, flags);
 }
 
+/**
+ * Write callback of a flush of coalesced writes, which fans the outcome out
+ * to the callbacks of the writes, in order.
+ */
+class AsyncSocket::CoalescedWriteCallback : public AsyncSocket::WriteCallback {
+ public:
+  explicit CoalescedWriteCallback(std::vector<CoalescedWrite> writes)
+      : writes_(std::move(writes)) {}
+
+  void writeSuccess() noexcept override {
+    auto writes = std::move(writes_);
+    delete this;
+    for (const auto& write : writes) {
+      write.callback->writeSuccess();
+    }
+  }
+
+  void writeErr(
+      size_t bytesWritten, const AsyncSocketException& ex) noexcept override {
+    auto writes = std::move(writes_);
+    delete this;
+    for (const auto& write : writes) {
+      size_t written = bytesWritten > write.offset
+          ? std::min(bytesWritten - write.offset, write.length)
+          : 0;
+      write.callback->writeErr(written, ex);
+    }
+  }
+
+ private:
+  std::vector<CoalescedWrite> writes_;
+};
+
+void AsyncSocket::setWriteCoalescing(size_t maxBytes) {
+  writeCoalescingMaxBytes_ = maxBytes;
+  if (maxBytes == 0) {
+    flushCoalescedWrites();
+  }
+}
+
+void AsyncSocket::flushCoalescedWrites() {
+  if (!coalescedWrites_) {
+    return;
+  }
+  if (coalescedWritesHandler_.isLoopCallbackScheduled()) {
+    coalescedWritesHandler_.cancelLoopCallback();
+  }
+  auto buf = std::move(coalescedWrites_);
+  coalescedBytes_ = 0;
+  WriteCallback* callback = nullptr;
+  if (!coalescedCallbacks_.empty()) {
+    callback = new CoalescedWriteCallback(std::move(coalescedCallbacks_));
+    coalescedCallbacks_.clear();
+  }
+  writeChainNow(callback, std::move(buf), WriteFlags::NONE);
+}
+
+void AsyncSocket::failCoalescedWrites(const AsyncSocketException& ex) {
+  if (coalescedWritesHandler_.isLoopCallbackScheduled()) {
+    coalescedWritesHandler_.cancelLoopCallback();
+  }
+  coalescedWrites_.reset();
+  coalescedBytes_ = 0;
+  auto callbacks = std::move(coalescedCallbacks_);
+  coalescedCallbacks_.clear();
+  for (const auto& write : callbacks) {
+    write.callback->writeErr(0, ex);
+  }
+}
+
 void AsyncSocket::writeChain(
     WriteCallback* callback, unique_ptr<IOBuf>&& buf, WriteFlags flags) {
+  if (writeCoalescingMaxBytes_ > 0 && flags == WriteFlags::NONE &&
+      state_ == StateEnum::ESTABLISHED &&
+      !(shutdownFlags_ & (SHUT_WRITE | SHUT_WRITE_PENDING)) &&
+      !(callback && callback->getReleaseIOBufCallback())) {
+    eventBase_->dcheckIsInEventBaseThread();
+    size_t length = buf->computeChainDataLength();
+    if (callback) {
+      coalescedCallbacks_.push_back({callback, coalescedBytes_, length});
+    }
+    coalescedBytes_ += length;
+    if (coalescedWrites_) {
+      coalescedWrites_->appendToChain(std::move(buf));
+    } else {
+      coalescedWrites_ = std::move(buf);
+    }
+    if (coalescedBytes_ >= writeCoalescingMaxBytes_) {
+      DestructorGuard dg(this);
+      flushCoalescedWrites();
+    } else if (!coalescedWritesHandler_.isLoopCallbackScheduled()) {
+      eventBase_->runInLoop(&coalescedWritesHandler_, true);
+    }
+    return;
+  }
+  writeChainNow(callback, std::move(buf), flags);
+}
+
+void AsyncSocket::writeChainNow(
+    WriteCallback* callback, unique_ptr<IOBuf>&& buf, WriteFlags flags) {
   adjustZeroCopyFlags(flags);
 
   // adjustZeroCopyFlags can set zeroCopyEnabled_ to true
@@ -1838,6 +1950,8 @@ void AsyncSocket::writeImpl(
   DestructorGuard dg(this);
   unique_ptr<IOBuf> ioBuf(std::move(buf));
   eventBase_->dcheckIsInEventBaseThread();
+  // Keep the order of the writes.
+  flushCoalescedWrites();
   WriteCallbackWithState callbackWithState(callback);
 
   auto* releaseIOBufCallback =
@@ -1983,6 +2097,7 @@ void AsyncSocket::writeImpl(
 }
 
 void AsyncSocket::writeRequest(WriteRequest* req) {
+  flushCoalescedWrites();
   if (writeReqTail_ == nullptr) {
     assert(writeReqHead_ == nullptr);
     writeReqHead_ = writeReqTail_ = req;
@@ -2011,15 +2126,14 @@ void AsyncSocket::close() {
   //
   // We only need to drain pending writes if we are still in STATE_CONNECTING
   // or STATE_ESTABLISHED
+  DestructorGuard dg(this);
+  flushCoalescedWrites();
   if ((writeReqHead_ == nullptr) ||
       !(state_ == StateEnum::CONNECTING || state_ == StateEnum::ESTABLISHED)) {
     closeNow();
     return;
   }
 
-  // Declare a DestructorGuard to ensure that the AsyncSocket cannot be
-  // destroyed until close() returns.
-  DestructorGuard dg(this);
   eventBase_->dcheckIsInEventBaseThread();
 
   // Since there are write requests pending, we have to set the
@@ -2056,6 +2170,10 @@ void AsyncSocket::closeNow() {
     eventBase_->dcheckIsInEventBaseThread();
   }
 
+  if (state_ == StateEnum::ESTABLISHED) {
+    flushCoalescedWrites();
+  }
+
   switch (state_) {
     case StateEnum::ESTABLISHED:
     case StateEnum::CONNECTING:
@@ -2141,6 +2259,8 @@ void AsyncSocket::shutdownWrite() {
 
   // If there are no pending writes, shutdownWrite() is identical to
   // shutdownWriteNow().
+  DestructorGuard dg(this);
+  flushCoalescedWrites();
   if (writeReqHead_ == nullptr) {
     shutdownWriteNow();
     return;
@@ -2177,6 +2297,10 @@ void AsyncSocket::shutdownWriteNow() {
     eventBase_->dcheckIsInEventBaseThread();
   }
 
+  if (state_ == StateEnum::ESTABLISHED) {
+    flushCoalescedWrites();
+  }
+
   switch (static_cast<StateEnum>(state_)) {
     case StateEnum::ESTABLISHED: {
       shutdownFlags_ |= SHUT_WRITE;
@@ -2337,6 +2461,8 @@ void AsyncSocket::detachEventBase() {
   assert(eventBase_ != nullptr);
   eventBase_->dcheckIsInEventBaseThread();
 
+  flushCoalescedWrites();
+
   // Make a copy of the existing event base, to invoke lifecycle observer
   // callbacks
   EventBase* existingEvb = eventBase_;
@@ -3202,15 +3328,39 @@ AsyncSocket::ReadCode AsyncSocket::processZeroCopyRead() {
   return ReadCode::READ_NOT_SUPPORTED;
 }
 
+void AsyncSocket::setAdaptiveReadBuffers(
+    folly::Optional<AdaptiveReadBufferSizer::Options> options) {
+  if (options) {
+    readBufferSizer_.emplace(*options);
+  } else {
+    readBufferSizer_.reset();
+  }
+}
+
 AsyncSocket::ReadCode AsyncSocket::processNormalRead() {
   auto readMode = readCallback_->getReadMode();
   // Get the buffer(s) to read into.
   void* buf = nullptr;
   size_t buflen = 0;
   IOBufIovecBuilder::IoVecVec iovs; // this can be an AsyncSocket member too
+  // Set when the socket allocates the buffer(s), see setAdaptiveReadBuffers()
+  const bool adaptive = readBufferSizer_ && readCallback_->isBufferMovable();
+  std::unique_ptr<IOBuf> readBuf;
+  IOBufIovecBuilder* iovecBuilder = nullptr;
 
   try {
-    if (readMode == AsyncReader::ReadCallback::ReadMode::ReadVec) {
+    if (adaptive) {
+      auto size = std::min(
+          readBufferSizer_->nextSize(), readCallback_->maxBufferSize());
+      if (readMode == AsyncReader::ReadCallback::ReadMode::ReadVec) {
+        iovecBuilder = &readIovecBuilder(*eventBase_);
+        buflen = iovecBuilder->allocateBuffers(iovs, size);
+      } else {
+        readBuf = IOBuf::create(size);
+        buf = readBuf->writableData();
+        buflen = readBuf->tailroom();
+      }
+    } else if (readMode == AsyncReader::ReadCallback::ReadMode::ReadVec) {
       prepareReadBuffers(iovs);
       VLOG(5) << "prepareReadBuffers() bufs=" << iovs.data()
               << ", num=" << iovs.size();
@@ -3300,7 +3450,17 @@ AsyncSocket::ReadCode AsyncSocket::processNormalRead() {
         return failRead(__func__, ex);
       }
     }
-    readCallback_->readDataAvailable(size_t(bytesRead));
+    if (adaptive) {
+      readBufferSizer_->record(size_t(bytesRead));
+      if (iovecBuilder) {
+        readBuf = iovecBuilder->extractIOBufChain(size_t(bytesRead));
+      } else {
+        readBuf->append(size_t(bytesRead));
+      }
+      readCallback_->readBufferAvailable(std::move(readBuf));
+    } else {
+      readCallback_->readDataAvailable(size_t(bytesRead));
+    }
 
     // Continue reading if we filled the available buffer
     return (size_t(bytesRead) < buflen)
@@ -4249,6 +4409,8 @@ void AsyncSocket::failAllWrites(const AsyncSocketException& ex) {
 
   // All pending writes have failed - reset totalAppBytesScheduledForWrite_
   totalAppBytesScheduledForWrite_ = appBytesWritten_;
+
+  failCoalescedWrites(ex);
 }
 
 void AsyncSocket::failByteEvents(const AsyncSocketException& ex) {
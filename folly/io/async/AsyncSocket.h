@@ -21,6 +21,7 @@
 #include <chrono>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <folly/ConstructorCallbackList.h>
 #include <folly/Optional.h>
@@ -30,6 +31,7 @@
 #include <folly/io/IOBufIovecBuilder.h>
 #include <folly/io/ShutdownSocketSet.h>
 #include <folly/io/SocketOptionMap.h>
+#include <folly/io/async/AdaptiveReadBufferSizer.h>
 #include <folly/io/async/AsyncSocketException.h>
 #include <folly/io/async/AsyncSocketTransport.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -682,6 +684,56 @@ class AsyncSocket : public AsyncSocketTransport {
    */
   uint16_t getMaxReadsPerEvent() const { return maxReadsPerEvent_; }
 
+  /**
+   * Let the socket allocate the read buffers of the read callbacks that
+   * take their ownership, i.e. whose isBufferMovable() returns true.
+   *
+   * Buffers are then sized by an AdaptiveReadBufferSizer from the recent
+   * reads of the socket, up to the maxBufferSize() of the callback, and
+   * handed over with readBufferAvailable(). They are only allocated once
+   * the socket is readable, so idle connections hold no read buffer.
+   *
+   * Callbacks in ReadMode::ReadVec are read into with a single recvmsg()
+   * into several blocks, carved from an IOBufIovecBuilder shared by the
+   * sockets of the EventBase. Small reads then share allocations, while
+   * every callback still gets unshared IOBufs.
+   *
+   * Other callbacks keep providing their buffers with getReadBuffer().
+   *
+   * @param options  The sizing options, or none to go back to allocating
+   *                 with getReadBuffer() for all callbacks.
+   */
+  void setAdaptiveReadBuffers(
+      folly::Optional<AdaptiveReadBufferSizer::Options> options);
+
+  bool getAdaptiveReadBuffers() const { return readBufferSizer_.hasValue(); }
+
+  /**
+   * Enable coalescing of the writes made in one EventBase loop iteration.
+   *
+   * writeChain() calls without flags are then not written right away: their
+   * buffers are appended to a pending chain, written with a single writev()
+   * at the end of the loop iteration, or as soon as maxBytes are pending.
+   * Write callbacks are invoked in order once their bytes are written. This
+   * trades up to a loop iteration of latency for fewer syscalls, for
+   * protocols that issue many small writes.
+   *
+   * Writes with flags, write() and writev() calls, and writes whose
+   * callback has a ReleaseIOBufCallback are not coalesced: they, close(),
+   * closeNow() and shutdownWrite() flush the pending writes first.
+   *
+   * @param maxBytes  Number of pending bytes that triggers a flush; a value
+   *                  of zero disables coalescing, which is the default.
+   */
+  void setWriteCoalescing(size_t maxBytes);
+
+  size_t getWriteCoalescing() const { return writeCoalescingMaxBytes_; }
+
+  /**
+   * Write the writes pending because of write coalescing now.
+   */
+  void flushCoalescedWrites();
+
   /**
    * Set a pointer to ErrMessageCallback implementation which will be
    * receiving notifications for messages posted to the error queue
@@ -899,7 +951,8 @@ class AsyncSocket : public AsyncSocketTransport {
   size_t getRawBytesReceived() const override { return getAppBytesReceived(); }
 
   size_t getAppBytesBuffered() const override {
-    return totalAppBytesScheduledForWrite_ - appBytesWritten_;
+    return totalAppBytesScheduledForWrite_ - appBytesWritten_ +
+        coalescedBytes_;
   }
   size_t getRawBytesBuffered() const override { return getAppBytesBuffered(); }
 
@@ -1640,6 +1693,33 @@ class AsyncSocket : public AsyncSocketTransport {
     AsyncSocket* socket_;
   };
 
+  class CoalescedWritesCB : public folly::EventBase::LoopCallback {
+   public:
+    explicit CoalescedWritesCB(AsyncSocket* socket) : socket_(socket) {}
+    void runLoopCallback() noexcept override {
+      DestructorGuard dg(socket_);
+      socket_->flushCoalescedWrites();
+    }
+
+   private:
+    AsyncSocket* socket_;
+  };
+
+  // A write callback of a coalesced write, and the range of its bytes in the
+  // pending chain.
+  struct CoalescedWrite {
+    WriteCallback* callback;
+    size_t offset;
+    size_t length;
+  };
+
+  class CoalescedWriteCallback;
+
+  /**
+   * Fail the writes pending because of write coalescing.
+   */
+  void failCoalescedWrites(const AsyncSocketException& ex);
+
   /**
    * Schedule checkForImmediateRead to be executed in the next loop
    * iteration.
@@ -1697,6 +1777,14 @@ class AsyncSocket : public AsyncSocketTransport {
    * @param buf      Chain of iovecs.
    * @param flags    set of flags for the underlying write calls, like cork
    */
+  /**
+   * Write an IOBuf chain now, bypassing write coalescing.
+   */
+  void writeChainNow(
+      WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf>&& buf,
+      WriteFlags flags);
+
   void writeChainImpl(
       WriteCallback* callback,
       iovec* vec,
@@ -1946,6 +2034,16 @@ class AsyncSocket : public AsyncSocketTransport {
   // Num of bytes allocated in IOBufs pending write.
   size_t allocatedBytesBuffered_{0};
 
+  // Sizes the read buffers, see setAdaptiveReadBuffers().
+  folly::Optional<AdaptiveReadBufferSizer> readBufferSizer_;
+
+  // Write coalescing, see setWriteCoalescing().
+  size_t writeCoalescingMaxBytes_{0};
+  std::unique_ptr<IOBuf> coalescedWrites_;
+  size_t coalescedBytes_{0};
+  std::vector<CoalescedWrite> coalescedCallbacks_;
+  CoalescedWritesCB coalescedWritesHandler_{this};
+
   // Lifecycle observers.
   //
   // Use small_vector to avoid heap allocation for up to two observers, unless
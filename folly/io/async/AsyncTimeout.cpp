@@ -138,6 +138,10 @@ void AsyncTimeout::libeventCallback(libevent_fd_t fd, short events, void* arg) {
   // this can't possibly fire if timeout->eventBase_ is nullptr
   timeout->timeoutManager_->bumpHandlingTime();
 
+  // The event is always registered with the underlying EventBase, also when
+  // the timeout manager is a VirtualEventBase.
+  EventBase::LoopPhaseGuard phaseGuard(
+      *timeout->event_.eb_ev_base(), EventBase::LoopPhase::Timeout);
   RequestContextScopeGuard rctx(timeout->context_);
 
   timeout->timeoutExpired();
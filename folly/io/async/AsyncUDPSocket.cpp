@@ -91,6 +91,23 @@ void AsyncUDPSocket::fromMsg(
   }
 #endif
 }
+void AsyncUDPSocket::ReadCallback::onDataBatchAvailable(
+    folly::Range<ReceivedDatagram*> datagrams) noexcept {
+  for (auto& datagram : datagrams) {
+    void* buf{nullptr};
+    size_t len{0};
+    getReadBuffer(&buf, &len);
+    if (buf == nullptr || len == 0) {
+      continue;
+    }
+    size_t dataLen = datagram.data->length();
+    bool truncated = datagram.truncated || dataLen > len;
+    dataLen = std::min(dataLen, len);
+    memcpy(buf, datagram.data->data(), dataLen);
+    onDataAvailable(datagram.client, dataLen, truncated, datagram.params);
+  }
+}
+
 static constexpr bool msgErrQueueSupported =
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
     true;
@@ -1120,6 +1137,19 @@ int AsyncUDPSocket::recvmmsg(
   return netops::recvmmsg(fd_, msgvec, vlen, flags, timeout);
 }
 
+void AsyncUDPSocket::setReadBatch(size_t maxMessages, size_t maxMessageSize) {
+  readBatchMessageSize_ = maxMessages ? maxMessageSize : 0;
+  readBatchArena_.reset();
+  readBatchMsgs_.resize(maxMessages);
+  readBatchIovecs_.resize(maxMessages);
+  readBatchAddrs_.resize(maxMessages);
+  readBatch_.resize(maxMessages);
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  readBatchControl_.resize(
+      maxMessages * ReadCallback::OnDataAvailableParams::kCmsgSpace);
+#endif
+}
+
 void AsyncUDPSocket::resumeRead(ReadCallback* cob) {
   CHECK(!readCallback_) << "Another read callback already installed";
   CHECK_NE(NetworkSocket(), fd_)
@@ -1300,6 +1330,9 @@ void AsyncUDPSocket::handleRead() noexcept {
   if (readCallback_->shouldOnlyNotify()) {
     return readCallback_->onNotifyDataAvailable(*this);
   }
+  if (!readBatchMsgs_.empty()) {
+    return handleReadBatch();
+  }
 
   size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
   EventBase* originalEventBase = eventBase_;
@@ -1427,6 +1460,113 @@ void AsyncUDPSocket::handleRead() noexcept {
   }
 }
 
+void AsyncUDPSocket::handleReadBatch() noexcept {
+  const size_t maxMessages = readBatchMsgs_.size();
+  const size_t messageSize = readBatchMessageSize_;
+  bool useControl = false;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  useControl = (gro_.has_value() && gro_.value() > 0) ||
+      (ts_.has_value() && ts_.value() > 0) || recvTos_;
+#endif
+
+  size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
+  EventBase* originalEventBase = eventBase_;
+  // The callback may also change the batch size.
+  while (numReads-- && readCallback_ && eventBase_ == originalEventBase &&
+         readBatchMsgs_.size() == maxMessages) {
+    // Reuse the arena if the previous batch let go of all its buffers.
+    if (!readBatchArena_ || readBatchArena_->isSharedOne()) {
+      readBatchArena_ = IOBuf::create(maxMessages * messageSize);
+      readBatchArena_->append(maxMessages * messageSize);
+    }
+    uint8_t* base = readBatchArena_->writableData();
+    for (size_t i = 0; i < maxMessages; ++i) {
+      auto& iov = readBatchIovecs_[i];
+      iov.iov_base = base + i * messageSize;
+      iov.iov_len = messageSize;
+
+      auto& msg = readBatchMsgs_[i].msg_hdr;
+      msg = {};
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_name = &readBatchAddrs_[i];
+      msg.msg_namelen = sizeof(readBatchAddrs_[i]);
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+      if (useControl) {
+        constexpr size_t kCmsgSpace =
+            ReadCallback::OnDataAvailableParams::kCmsgSpace;
+        auto* control = readBatchControl_.data() + i * kCmsgSpace;
+        memset(control, 0, kCmsgSpace);
+        msg.msg_control = control;
+        msg.msg_controllen = kCmsgSpace;
+      }
+#endif
+      readBatchMsgs_[i].msg_len = 0;
+    }
+
+    int ret = recvmmsg(
+        readBatchMsgs_.data(),
+        static_cast<unsigned int>(maxMessages),
+        MSG_TRUNC,
+        nullptr);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // No data could be read without blocking the socket
+        return;
+      }
+
+      AsyncSocketException ex(
+          AsyncSocketException::INTERNAL_ERROR, "::recvmmsg() failed", errno);
+      auto cob = readCallback_;
+      readCallback_ = nullptr;
+      updateRegistration();
+      cob->onReadError(ex);
+      return;
+    }
+
+    size_t numDatagrams = 0;
+    for (size_t i = 0; i < size_t(ret); ++i) {
+      auto& msg = readBatchMsgs_[i].msg_hdr;
+      size_t len = readBatchMsgs_[i].msg_len;
+      if (len == 0) {
+        continue;
+      }
+      auto& datagram = readBatch_[numDatagrams++];
+      if (msg.msg_namelen > 0) {
+        datagram.client.setFromSockaddr(
+            reinterpret_cast<sockaddr*>(msg.msg_name), msg.msg_namelen);
+      } else {
+        datagram.client = connectedAddress_;
+      }
+      datagram.truncated = len > messageSize;
+      datagram.params = {};
+      if (useControl) {
+        fromMsg(datagram.params, msg);
+      }
+      datagram.data = readBatchArena_->cloneOne();
+      datagram.data->trimStart(i * messageSize);
+      datagram.data->trimEnd(
+          datagram.data->length() - std::min(len, messageSize));
+    }
+
+    if (numDatagrams > 0) {
+      readCallback_->onDataBatchAvailable(
+          folly::Range<ReadCallback::ReceivedDatagram*>(
+              readBatch_.data(), numDatagrams));
+    }
+    // Drop the buffers the callback didn't take, so that the arena can be
+    // reused.
+    for (size_t i = 0; i < std::min(numDatagrams, readBatch_.size()); ++i) {
+      readBatch_[i].data.reset();
+    }
+
+    if (size_t(ret) < maxMessages) {
+      // The socket is drained.
+      return;
+    }
+  }
+}
+
 bool AsyncUDPSocket::updateRegistration() noexcept {
   uint16_t flags = NONE;
 
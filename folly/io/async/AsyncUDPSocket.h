@@ -17,9 +17,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <folly/io/SocketOptionMap.h>
 
 #include <folly/Function.h>
+#include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/io/IOBuf.h>
@@ -81,6 +83,30 @@ class AsyncUDPSocket : public EventHandler {
         bool truncated,
         OnDataAvailableParams params) noexcept = 0;
 
+    /**
+     * A datagram read as part of a batch, see setReadBatch(). With GRO, data
+     * may hold several segments of params.gro bytes (the last one may be
+     * shorter).
+     */
+    struct ReceivedDatagram {
+      folly::SocketAddress client;
+      std::unique_ptr<folly::IOBuf> data;
+      bool truncated{false};
+      OnDataAvailableParams params;
+    };
+
+    /**
+     * Invoked instead of getReadBuffer() and onDataAvailable() with the
+     * datagrams of each recvmmsg() call, once the socket reads in batches.
+     * The buffers of a batch share the same allocation, which the socket
+     * reuses for the next batch unless some of them are still held.
+     *
+     * The default implementation copies each datagram into the buffer from
+     * getReadBuffer() and calls onDataAvailable().
+     */
+    virtual void onDataBatchAvailable(
+        folly::Range<ReceivedDatagram*> datagrams) noexcept;
+
     /**
      * Notifies when data is available. This is only invoked when
      * shouldNotifyOnly() returns true.
@@ -482,6 +508,17 @@ class AsyncUDPSocket : public EventHandler {
    */
   uint16_t getMaxReadsPerEvent() const { return maxReadsPerEvent_; }
 
+  /**
+   * Read up to maxMessages datagrams (or GRO super-packets) of up to
+   * maxMessageSize bytes with each recvmmsg() call, and deliver them to
+   * ReadCallback::onDataBatchAvailable(). maxReadsPerEvent then limits the
+   * number of recvmmsg() calls per event. maxMessages == 0 disables batching,
+   * which is the default.
+   */
+  void setReadBatch(size_t maxMessages, size_t maxMessageSize);
+
+  size_t getReadBatchSize() const { return readBatchMsgs_.size(); }
+
   virtual void detachEventBase();
 
   virtual void attachEventBase(folly::EventBase* evb);
@@ -623,6 +660,7 @@ class AsyncUDPSocket : public EventHandler {
   void handlerReady(uint16_t events) noexcept override;
 
   void handleRead() noexcept;
+  void handleReadBatch() noexcept;
   bool updateRegistration() noexcept;
   void maybeUpdateDynamicCmsgs() noexcept;
 
@@ -635,6 +673,15 @@ class AsyncUDPSocket : public EventHandler {
   // Temp space to receive client address
   folly::SocketAddress clientAddress_;
 
+  // Batched reads, see setReadBatch()
+  size_t readBatchMessageSize_{0};
+  std::unique_ptr<folly::IOBuf> readBatchArena_;
+  std::vector<struct mmsghdr> readBatchMsgs_;
+  std::vector<struct iovec> readBatchIovecs_;
+  std::vector<sockaddr_storage> readBatchAddrs_;
+  std::vector<char> readBatchControl_;
+  std::vector<ReadCallback::ReceivedDatagram> readBatch_;
+
   // If the socket is connected.
   folly::SocketAddress connectedAddress_;
   bool connected_{false};
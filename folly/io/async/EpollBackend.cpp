@@ -20,8 +20,11 @@
 
 #include <signal.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
 #include <sys/timerfd.h>
 
+#include <algorithm>
+
 #include <folly/IntrusiveList.h>
 #include <folly/MapUtil.h>
 #include <folly/String.h>
@@ -47,6 +50,8 @@ struct EventInfo {
   folly::IntrusiveListHook listHook;
   struct event* ev{nullptr};
   int what_{0};
+  // Registered with EPOLLEXCLUSIVE, which cannot be modified.
+  bool exclusive_{false};
 };
 
 using EventInfoList = folly::IntrusiveList<EventInfo, &EventInfo::listHook>;
@@ -137,6 +142,13 @@ uint32_t getPollFlags(short events) {
   return ret;
 }
 
+bool isListening(int fd) {
+  int listening = 0;
+  socklen_t len = sizeof(listening);
+  return ::getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &len) == 0 &&
+      listening;
+}
+
 } // namespace
 
 struct EpollBackend::TimerInfo : public IntrusiveHeapNode<> {
@@ -240,6 +252,13 @@ int EpollBackend::eb_event_base_loop(int flags) {
       eb_poll_loop_post_hook(call_time, numEvents);
     }
 
+    stats_.numWaits++;
+    if (numEvents > 0) {
+      stats_.numEvents += numEvents;
+      stats_.maxEventsPerWait =
+          std::max(stats_.maxEventsPerWait, size_t(numEvents));
+    }
+
     if (numEvents < 0) {
       return -1;
     } else if (numEvents == 0) {
@@ -286,6 +305,14 @@ int EpollBackend::eb_event_base_loop(int flags) {
       infoList.push_back(*info);
     }
 
+    // The events have been copied out, the batch can grow.
+    if (size_t(numEvents) == events_.size()) {
+      stats_.numFullBatches++;
+      if (events_.size() < options_.maxNumLoopEvents) {
+        events_.resize(std::min(events_.size() * 2, options_.maxNumLoopEvents));
+      }
+    }
+
     // Process timers and signals first.
     if (shouldProcessTimers) {
       processTimers();
@@ -381,6 +408,15 @@ int EpollBackend::eb_event_add(Event& event, const struct timeval* timeout) {
 
   struct epoll_event epev = {};
   epev.events = getPollFlags(ev->ev_events & (EV_READ | EV_WRITE));
+  if (options_.edgeTriggered) {
+    epev.events |= EPOLLET;
+  }
+  info->exclusive_ = options_.exclusiveListeners &&
+      (ev->ev_events & (EV_READ | EV_WRITE)) == EV_READ &&
+      isListening(ev->ev_fd);
+  if (info->exclusive_) {
+    epev.events |= EPOLLEXCLUSIVE;
+  }
   epev.data.ptr = info;
 
   return ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, ev->ev_fd, &epev);
@@ -442,9 +478,12 @@ bool EpollBackend::setEdgeTriggered(Event& event) {
   CHECK(ev);
 
   EventInfo* info = static_cast<EventInfo*>(event.getUserData());
-  if (info == nullptr) {
+  if (info == nullptr || info->exclusive_) {
     return false;
   }
+  if (options_.edgeTriggered) {
+    return true;
+  }
 
   struct epoll_event epev = {};
   epev.events = getPollFlags(ev->ev_events & (EV_READ | EV_WRITE)) | EPOLLET;
@@ -20,6 +20,8 @@
 
 #if FOLLY_HAS_EPOLL
 
+#include <sys/epoll.h>
+
 #include <chrono>
 #include <map>
 #include <optional>
@@ -34,12 +36,54 @@ namespace folly {
 class EpollBackend : public EventBaseBackendBase {
  public:
   struct Options {
+    // Number of events an epoll_wait() call returns at most.
     size_t numLoopEvents{128};
+    // When larger than numLoopEvents, the batch doubles up to this size each
+    // time an epoll_wait() call fills it, so that a loop with many active fds
+    // needs fewer calls per iteration.
+    size_t maxNumLoopEvents{0};
+    // Register all the fd events edge-triggered (EPOLLET), instead of only
+    // those for which setEdgeTriggered() is called. This saves the wakeups of
+    // the fds that stay ready, but is only correct if every handler consumes
+    // its fd until it would block (or reschedules itself), as AsyncSocket
+    // does: a handler that leaves data behind is not notified again until
+    // more arrives.
+    bool edgeTriggered{false};
+    // Register the read events of listening sockets with EPOLLEXCLUSIVE, so
+    // that a connection to a listener shared by several loops only wakes one
+    // of them up. This costs a getsockopt() per fd event registration.
+    bool exclusiveListeners{false};
 
     Options& setNumLoopEvents(size_t val) {
       numLoopEvents = val;
       return *this;
     }
+
+    Options& setMaxNumLoopEvents(size_t val) {
+      maxNumLoopEvents = val;
+      return *this;
+    }
+
+    Options& setEdgeTriggered(bool val) {
+      edgeTriggered = val;
+      return *this;
+    }
+
+    Options& setExclusiveListeners(bool val) {
+      exclusiveListeners = val;
+      return *this;
+    }
+  };
+
+  struct Stats {
+    // Number of epoll_wait() calls.
+    uint64_t numWaits{0};
+    // Number of events they returned, including the internal timer and
+    // signal events.
+    uint64_t numEvents{0};
+    // Number of calls that filled the whole batch.
+    uint64_t numFullBatches{0};
+    size_t maxEventsPerWait{0};
   };
 
   explicit EpollBackend(Options options);
@@ -63,6 +107,17 @@ class EpollBackend : public EventBaseBackendBase {
 
   bool setEdgeTriggered(Event& event) override;
 
+  const Stats& getStats() const { return stats_; }
+
+  // Current size of the epoll_wait() batch.
+  size_t getNumLoopEvents() const { return events_.size(); }
+
+  // Number of fd events registered by the users of the backend, excluding
+  // timers, signals and the EventBase internal events.
+  size_t getNumRegisteredFdEvents() const {
+    return numInsertedEvents_ - numInternalEvents_;
+  }
+
  private:
   struct TimerInfo;
 
@@ -102,6 +157,7 @@ class EpollBackend : public EventBaseBackendBase {
 
   bool loopBreak_{false};
   std::vector<struct epoll_event> events_; // Cache allocation.
+  Stats stats_;
 
   int timerFd_{-1};
   std::optional<std::chrono::steady_clock::time_point> timerFdExpiration_;
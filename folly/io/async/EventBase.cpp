@@ -35,6 +35,7 @@
 #include <folly/io/async/EventBaseLocal.h>
 #include <folly/io/async/VirtualEventBase.h>
 #include <folly/lang/Assume.h>
+#include <folly/lang/Bits.h>
 #include <folly/portability/Unistd.h>
 #include <folly/synchronization/Baton.h>
 #include <folly/synchronization/EventCount.h>
@@ -203,6 +204,7 @@ class EventBase::FuncRunner {
       curLoopCnt_ = eventBase_.nextLoopCnt_;
     }
 
+    LoopPhaseGuard phaseGuard(eventBase_, LoopPhase::NotificationQueue);
     ExecutionObserverScopeGuard guard(
         &eventBase_.getExecutionObserverList(),
         &func,
@@ -301,6 +303,8 @@ EventBase::EventBase(Options options)
               ? options.backendFactory()
               : getDefaultBackend()),
       threadIdCollector_(std::make_unique<ThreadIdCollector>(*this)) {
+  setBusyPollBudget(options.busyPollBudget);
+  setLoopPhaseHistograms(options.loopPhaseHistograms);
   initNotificationQueue();
 }
 
@@ -422,6 +426,10 @@ void EventBase::setMaxReadAtOnce(uint32_t maxAtOnce) {
   queue_->setMaxReadAtOnce(maxAtOnce);
 }
 
+void EventBase::setNotificationQueueArmDelay(std::chrono::microseconds delay) {
+  queue_->setArmDelay(delay);
+}
+
 bool EventBase::isInEventBaseThread() const {
   auto tid = loopTid_.load(std::memory_order_relaxed);
   return tid == static_cast<pid_t>(getOSThreadID()) ||
@@ -470,6 +478,99 @@ void EventBase::resetLoadAvg(double value) {
   maxLatencyLoopTime_.reset(value);
 }
 
+void EventBase::setBusyPollBudget(std::chrono::microseconds budget) {
+  auto count = std::max<int64_t>(budget.count(), 0);
+  busyPoll_.maxBudget.store(count, std::memory_order_relaxed);
+  busyPoll_.budget.store(count, std::memory_order_relaxed);
+}
+
+EventBase::BusyPollStats EventBase::getBusyPollStats() const {
+  BusyPollStats stats;
+  stats.polls = busyPoll_.polls.load(std::memory_order_relaxed);
+  stats.hits = busyPoll_.hits.load(std::memory_order_relaxed);
+  stats.pollTime = std::chrono::nanoseconds(
+      busyPoll_.pollTimeNs.load(std::memory_order_relaxed));
+  stats.budget = std::chrono::microseconds(
+      busyPoll_.budget.load(std::memory_order_relaxed));
+  return stats;
+}
+
+EventBase::LoopPhaseStats EventBase::getLoopPhaseStats() const {
+  LoopPhaseStats stats;
+  stats.iterations = loopIterations_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kNumLoopPhases; ++i) {
+    auto& counters = loopPhases_[i];
+    auto& phase = stats.phases[i];
+    phase.count = counters.count.load(std::memory_order_relaxed);
+    phase.time = std::chrono::nanoseconds(
+        counters.time.load(std::memory_order_relaxed));
+    phase.maxTime = std::chrono::nanoseconds(
+        counters.maxTime.load(std::memory_order_relaxed));
+    for (size_t j = 0; j < kLoopPhaseHistogramBuckets; ++j) {
+      phase.histogram[j] =
+          counters.histogram[j].load(std::memory_order_relaxed);
+    }
+  }
+  return stats;
+}
+
+void EventBase::addLoopPhaseSample(
+    LoopPhase phase, std::chrono::nanoseconds time) {
+  // Only the loop thread writes the counters, so there is no need for atomic
+  // read-modify-writes.
+  auto add = [](std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed);
+  };
+  auto& counters = loopPhases_[static_cast<size_t>(phase)];
+  auto ns = static_cast<uint64_t>(std::max<int64_t>(time.count(), 0));
+  add(counters.count, 1);
+  add(counters.time, ns);
+  if (ns > counters.maxTime.load(std::memory_order_relaxed)) {
+    counters.maxTime.store(ns, std::memory_order_relaxed);
+  }
+  if (loopPhaseHistograms_.load(std::memory_order_relaxed)) {
+    auto bucket = std::min<size_t>(
+        findLastSet(ns / 1000), kLoopPhaseHistogramBuckets - 1);
+    add(counters.histogram[bucket], 1);
+  }
+}
+
+namespace {
+
+const char* const kLoopPhaseNames[EventBase::kNumLoopPhases] = {
+    "EventBase::Wait",
+    "EventBase::Event",
+    "EventBase::Timeout",
+    "EventBase::Loop",
+    "EventBase::NotificationQueue",
+};
+
+} // namespace
+
+EventBase::LoopPhaseGuard::LoopPhaseGuard(
+    EventBase& evb, LoopPhase phase) noexcept
+    : evb_(evb.enableTimeMeasurement_ ? &evb : nullptr),
+      phase_(phase),
+      trace_(kLoopPhaseNames[static_cast<size_t>(phase)], "EventBase") {
+  if (evb_) {
+    parent_ = std::exchange(evb_->currentLoopPhase_, this);
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+EventBase::LoopPhaseGuard::~LoopPhaseGuard() {
+  if (evb_) {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    evb_->addLoopPhaseSample(phase_, elapsed - nested_);
+    if (parent_) {
+      parent_->nested_ += elapsed;
+    }
+    evb_->currentLoopPhase_ = parent_;
+  }
+}
+
 static std::chrono::milliseconds getTimeDelta(
     std::chrono::steady_clock::time_point* prev) {
   auto result = std::chrono::steady_clock::now() - *prev;
@@ -605,6 +706,9 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
         applyLoopKeepAlive();
       }
       ++nextLoopCnt_;
+      loopIterations_.store(
+          loopIterations_.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
 
       // Run the before-loop callbacks
       LoopCallbackList callbacks;
@@ -616,10 +720,17 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
 
     // nobody can add loop callbacks from within this thread if
     // we don't have to handle anything to start with...
-    if (blocking && loopCallbacks_.empty()) {
-      res = evb_->eb_event_base_loop(EVLOOP_ONCE);
-    } else {
-      res = evb_->eb_event_base_loop(EVLOOP_ONCE | EVLOOP_NONBLOCK);
+    {
+      LoopPhaseGuard waitGuard(*this, LoopPhase::Wait);
+      if (blocking && loopCallbacks_.empty()) {
+        if (busyPoll_.maxBudget.load(std::memory_order_relaxed) > 0) {
+          res = busyPollAndLoop();
+        } else {
+          res = evb_->eb_event_base_loop(EVLOOP_ONCE);
+        }
+      } else {
+        res = evb_->eb_event_base_loop(EVLOOP_ONCE | EVLOOP_NONBLOCK);
+      }
     }
     if (res == 2) {
       // Only backends with pollable fd support return value 2.
@@ -991,6 +1102,7 @@ void EventBase::runLoopCallbackList(
     // pop_front() in the previous callback's context, but that is non-blocking
     // and doesn't run application logic.
     RequestContext::setContext(std::move(callback->context_));
+    LoopPhaseGuard phaseGuard(*this, LoopPhase::Loop);
     ExecutionObserverScopeGuard guard(
         &executionObserverList_,
         callback,
@@ -999,6 +1111,63 @@ void EventBase::runLoopCallbackList(
   } while (!currentCallbacks.empty() && !deadline.expired());
 }
 
+int EventBase::busyPollAndLoop() {
+  // The budget grows from at least this, so that it can recover from zero.
+  constexpr std::chrono::microseconds kMinBudget{10};
+
+  auto maxBudget = std::chrono::microseconds(
+      busyPoll_.maxBudget.load(std::memory_order_relaxed));
+  auto budget = std::min(
+      std::chrono::microseconds(
+          busyPoll_.budget.load(std::memory_order_relaxed)),
+      maxBudget);
+  auto start = std::chrono::steady_clock::now();
+
+  if (budget > std::chrono::microseconds::zero()) {
+    busyPoll_.polls.fetch_add(1, std::memory_order_relaxed);
+    auto deadline = start + budget;
+    while (true) {
+      // The notification queue is cheap to check, and may have become
+      // non-empty before the backend reports its event.
+      bool queued = !queue_->empty() || stop_.load(std::memory_order_relaxed);
+      int res = evb_->eb_event_base_loop(EVLOOP_ONCE | EVLOOP_NONBLOCK);
+      auto now = std::chrono::steady_clock::now();
+      bool found = queued || !nothingHandledYet() || !loopCallbacks_.empty();
+      if (found || res != 0 || now >= deadline) {
+        busyPoll_.pollTimeNs.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - start)
+                .count(),
+            std::memory_order_relaxed);
+        if (found) {
+          busyPoll_.hits.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (found || res != 0) {
+          return res;
+        }
+        break;
+      }
+    }
+  }
+
+  int res = evb_->eb_event_base_loop(EVLOOP_ONCE);
+
+  // Work arrived when the first handler ran, if time is measured.
+  auto end = enableTimeMeasurement_ && !nothingHandledYet()
+      ? startWork_
+      : std::chrono::steady_clock::now();
+  if (end - start <= maxBudget) {
+    // Polling a little longer would have avoided blocking.
+    budget = std::min(std::max(budget * 2, kMinBudget), maxBudget);
+  } else {
+    budget /= 2;
+    if (budget < kMinBudget) {
+      budget = std::chrono::microseconds::zero();
+    }
+  }
+  busyPoll_.budget.store(budget.count(), std::memory_order_relaxed);
+  return res;
+}
+
 bool EventBase::runLoopCallbacks() {
   bumpHandlingTime();
   if (!loopCallbacks_.empty()) {
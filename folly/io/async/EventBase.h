@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <cmath>
@@ -54,6 +55,7 @@
 #include <folly/io/async/TimeoutManager.h>
 #include <folly/portability/Event.h>
 #include <folly/synchronization/CallOnce.h>
+#include <folly/tracing/TraceRecorder.h>
 
 namespace folly {
 class EventBaseBackendBase;
@@ -327,6 +329,83 @@ class EventBase
       loopCallbacksTimeslice = timeslice;
       return *this;
     }
+
+    /**
+     * If non-zero, the loop busy-polls for events for up to this long before
+     * blocking. See setBusyPollBudget().
+     */
+    std::chrono::microseconds busyPollBudget{0};
+
+    Options& setBusyPollBudget(std::chrono::microseconds budget) {
+      busyPollBudget = budget;
+      return *this;
+    }
+
+    /**
+     * Keep histograms of callback durations in the loop phase stats. See
+     * getLoopPhaseStats().
+     */
+    bool loopPhaseHistograms{false};
+
+    Options& setLoopPhaseHistograms(bool enabled) {
+      loopPhaseHistograms = enabled;
+      return *this;
+    }
+  };
+
+  struct BusyPollStats {
+    // Number of times the loop busy-polled before blocking.
+    uint64_t polls{0};
+    // Number of polls which found work, so that the loop didn't block.
+    uint64_t hits{0};
+    // Total time spent busy-polling.
+    std::chrono::nanoseconds pollTime{0};
+    // The current adaptive budget, at most the one set by setBusyPollBudget().
+    std::chrono::microseconds budget{0};
+  };
+
+  /**
+   * The phases of a loop iteration, as accounted by getLoopPhaseStats().
+   */
+  enum class LoopPhase : uint8_t {
+    // In the backend, waiting for or polling for events, including
+    // busy-polling.
+    Wait,
+    // EventHandler callbacks, i.e. I/O.
+    Event,
+    // AsyncTimeout callbacks. All the HHWheelTimer callbacks which expire on
+    // the same tick count as one.
+    Timeout,
+    // runInLoop(), runBeforeLoop() and runAfterLoop() callbacks.
+    Loop,
+    // runInEventBaseThread() callbacks.
+    NotificationQueue,
+  };
+  static constexpr size_t kNumLoopPhases = 5;
+  // Bucket i > 0 counts the callbacks which took [2^(i-1), 2^i) us, bucket 0
+  // those which took less than 1us, and the last one is unbounded.
+  static constexpr size_t kLoopPhaseHistogramBuckets = 20;
+
+  struct LoopPhaseStats {
+    struct Phase {
+      // Number of callbacks run, or of backend iterations for Wait.
+      uint64_t count{0};
+      // Total time spent, excluding the nested phases: e.g. the Wait time
+      // doesn't include the callbacks the backend ran.
+      std::chrono::nanoseconds time{0};
+      // The longest single callback (or wait).
+      std::chrono::nanoseconds maxTime{0};
+      // Only filled if histograms are enabled.
+      std::array<uint64_t, kLoopPhaseHistogramBuckets> histogram{};
+    };
+
+    const Phase& operator[](LoopPhase phase) const {
+      return phases[static_cast<size_t>(phase)];
+    }
+
+    // Number of loop iterations.
+    uint64_t iterations{0};
+    std::array<Phase, kNumLoopPhases> phases{};
   };
 
   /**
@@ -761,6 +840,51 @@ class EventBase
     dampenMaxLatency_ = dampen;
   }
 
+  /**
+   * Busy-poll for events for up to `budget` before blocking.
+   *
+   * Waking up a loop blocked in the backend (e.g. in epoll_wait()) adds tens
+   * of microseconds of latency to runInEventBaseThread() calls from other
+   * threads, and to I/O. When busy-polling, the loop instead spins on the
+   * notification queue and polls the backend without blocking until work
+   * arrives, for up to the budget, and only then blocks. This trades CPU time
+   * for latency, and is meant for latency-critical EventBases.
+   *
+   * The budget actually used adapts to recent arrivals, like adaptive halt
+   * polling: it grows (up to `budget`) when work arrives shortly after the
+   * loop gave up polling, and shrinks when the loop then blocked for longer
+   * than `budget`, so that an idle EventBase soon stops spinning.
+   *
+   * Zero (the default) disables busy-polling. Can be called from any thread.
+   */
+  void setBusyPollBudget(std::chrono::microseconds budget);
+
+  std::chrono::microseconds getBusyPollBudget() const {
+    return std::chrono::microseconds(
+        busyPoll_.maxBudget.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * Get the busy-polling counters. Can be called from any thread.
+   */
+  BusyPollStats getBusyPollStats() const;
+
+  /**
+   * Get a breakdown of the loop time by phase, to find e.g. which kind of
+   * callbacks keeps the loop busy. Can be called from any thread, and the
+   * counters are cumulative: diff two snapshots to get rates.
+   *
+   * Each callback costs two clock reads, and nothing is accounted if time
+   * measurement is disabled. Histograms of the callback durations are only
+   * kept if enabled, see Options::setLoopPhaseHistograms() and
+   * setLoopPhaseHistograms().
+   */
+  LoopPhaseStats getLoopPhaseStats() const;
+
+  void setLoopPhaseHistograms(bool enabled) {
+    loopPhaseHistograms_.store(enabled, std::memory_order_relaxed);
+  }
+
   /**
    * Set smoothing coefficient for loop load average; # of milliseconds
    * for exp(-1) (1/2.71828...) decay.
@@ -805,6 +929,16 @@ class EventBase
 
   void setMaxReadAtOnce(uint32_t maxAtOnce);
 
+  /**
+   * Keep polling the runInEventBaseThread() queue for up to `delay` after it
+   * last had tasks, rather than having producers wake up the loop through
+   * the notification fd. This saves fd writes and wakeups when many threads
+   * keep scheduling work, at the cost of the loop not blocking in the
+   * meantime. Zero (the default) disables it.
+   * Can be called from the EventBase thread only.
+   */
+  void setNotificationQueueArmDelay(std::chrono::microseconds delay);
+
   /**
    * Verify that current thread is the EventBase thread.
    *
@@ -876,6 +1010,30 @@ class EventBase
    */
   void bumpHandlingTime() final;
 
+  /**
+   * Accounts the time until destruction to the given phase in
+   * getLoopPhaseStats(), less the time accounted by nested guards, and
+   * records it into the TraceRecorder if enabled. Only EventHandler/
+   * AsyncTimeout and ourselves should use this, in the loop thread.
+   */
+  class LoopPhaseGuard {
+   public:
+    LoopPhaseGuard(EventBase& evb, LoopPhase phase) noexcept;
+    ~LoopPhaseGuard();
+
+    LoopPhaseGuard(const LoopPhaseGuard&) = delete;
+    LoopPhaseGuard& operator=(const LoopPhaseGuard&) = delete;
+
+   private:
+    // Null if time isn't measured.
+    EventBase* const evb_;
+    const LoopPhase phase_;
+    LoopPhaseGuard* parent_{nullptr};
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::nanoseconds nested_{0};
+    TraceSection trace_;
+  };
+
   class SmoothLoopTime {
    public:
     explicit SmoothLoopTime(std::chrono::microseconds timeInterval)
@@ -1050,6 +1208,9 @@ class EventBase
   // executes any callbacks queued by runInLoop(); returns false if none found
   bool runLoopCallbacks();
 
+  // Runs a blocking iteration of the backend loop, busy-polling first.
+  int busyPollAndLoop();
+
   void initNotificationQueue();
 
   // Tick granularity to wheelTimer_
@@ -1059,6 +1220,31 @@ class EventBase
   const std::chrono::milliseconds loopCallbacksTimeslice_;
   bool strictLoopThread_ = false;
 
+  // Durations are stored as counts, of microseconds unless noted otherwise.
+  struct BusyPollState {
+    std::atomic<int64_t> maxBudget{0};
+    // Adapted by the loop thread, reset by setBusyPollBudget().
+    std::atomic<int64_t> budget{0};
+    std::atomic<uint64_t> polls{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<int64_t> pollTimeNs{0};
+  };
+  BusyPollState busyPoll_;
+
+  // Written only by the loop thread. Durations are in nanoseconds.
+  struct LoopPhaseCounters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> time{0};
+    std::atomic<uint64_t> maxTime{0};
+    std::array<std::atomic<uint64_t>, kLoopPhaseHistogramBuckets> histogram{};
+  };
+  void addLoopPhaseSample(LoopPhase phase, std::chrono::nanoseconds time);
+  std::atomic<uint64_t> loopIterations_{0};
+  std::array<LoopPhaseCounters, kNumLoopPhases> loopPhases_;
+  std::atomic<bool> loopPhaseHistograms_{false};
+  // The innermost guard, in the loop thread.
+  LoopPhaseGuard* currentLoopPhase_{nullptr};
+
   // Loop state that needs to survive suspension.
   struct LoopState {
     std::chrono::steady_clock::time_point prev = {};
@@ -113,6 +113,12 @@ void EventBaseAtomicNotificationQueue<Task, Consumer>::setMaxReadAtOnce(
     uint32_t maxAtOnce) {
   notificationQueue_.setMaxReadAtOnce(maxAtOnce);
 }
+template <typename Task, typename Consumer>
+void EventBaseAtomicNotificationQueue<Task, Consumer>::setArmDelay(
+    std::chrono::microseconds delay) {
+  armDelay_ = delay;
+}
+
 template <typename Task, typename Consumer>
 size_t EventBaseAtomicNotificationQueue<Task, Consumer>::size() const {
   return notificationQueue_.size();
@@ -256,6 +262,17 @@ template <typename Task, typename Consumer>
 void EventBaseAtomicNotificationQueue<Task, Consumer>::
     runLoopCallback() noexcept {
   DCHECK(!armed_);
+  if (armDelay_.count() > 0 &&
+      std::chrono::steady_clock::now() - lastConsumed_ < armDelay_) {
+    // Tasks are likely to keep coming: poll the queue again on the next loop
+    // iteration rather than arming it, so that producers don't signal the fd.
+    if (notificationQueue_.empty()) {
+      evb_->runInLoop(this, false, nullptr);
+    } else {
+      activateEvent();
+    }
+    return;
+  }
   if (!notificationQueue_.arm()) {
     activateEvent();
   } else {
@@ -286,7 +303,9 @@ void EventBaseAtomicNotificationQueue<Task, Consumer>::execute() {
   if (!edgeTriggeredSet_) {
     drainFd();
   }
-  drive(consumer_);
+  if (drive(consumer_) && armDelay_.count() > 0) {
+    lastConsumed_ = std::chrono::steady_clock::now();
+  }
   evb_->runInLoop(this, false, nullptr);
 }
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <folly/io/async/AtomicNotificationQueue.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventHandler.h>
@@ -60,6 +62,24 @@ class EventBaseAtomicNotificationQueue
    */
   void setMaxReadAtOnce(uint32_t maxAtOnce);
 
+  /*
+   * Keep the queue disarmed for up to `delay` after tasks were last consumed,
+   * polling it on every loop iteration instead of arming it. Producers only
+   * signal the fd when the queue is armed, so under a steady fan-in of tasks
+   * from many threads this saves most of the fd writes and wakeups, at the
+   * cost of the loop not blocking during the delay. Zero (the default) arms
+   * the queue as soon as it is empty.
+   * Can be called from consumer thread only.
+   */
+  void setArmDelay(std::chrono::microseconds delay);
+
+  /*
+   * Returns the number of times the queue was armed. This bounds the number
+   * of times producers had to signal the fd.
+   * Can be called from consumer thread only.
+   */
+  size_t getArmCount() const { return successfulArmCount_; }
+
   /*
    * Returns the number of tasks in the queue.
    * Can be called from any thread.
@@ -188,6 +208,8 @@ class EventBaseAtomicNotificationQueue
   ssize_t consumerDisarmedCount_{0};
   ssize_t writesObserved_{0};
   ssize_t writesLocal_{0};
+  std::chrono::microseconds armDelay_{0};
+  std::chrono::steady_clock::time_point lastConsumed_;
   bool armed_{false};
   bool edgeTriggeredSet_{false};
 };
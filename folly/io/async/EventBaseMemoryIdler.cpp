@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/EventBaseMemoryIdler.h>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include <folly/detail/MemoryIdler.h>
+
+namespace folly {
+
+using folly::detail::MemoryIdler;
+
+EventBaseMemoryIdler::EventBaseMemoryIdler(EventBase& evb)
+    : AsyncTimeout(&evb), evb_(evb) {
+  evb_.runBeforeLoop(this);
+}
+
+void EventBaseMemoryIdler::timeoutExpired() noexcept {
+  idled_ = true;
+  timerRunning_ = false;
+}
+
+void EventBaseMemoryIdler::runLoopCallback() noexcept {
+  if (idled_) {
+    // The iteration that ran the timeout is the only one since it was
+    // armed: the loop has been idle all along.
+    if (num_ == 0) {
+      MemoryIdler::flushLocalMallocCaches();
+      MemoryIdler::unmapUnusedStack(MemoryIdler::kDefaultStackToRetain);
+      ++numFlushes_;
+    }
+
+    idled_ = false;
+    num_ = 0;
+  } else if (!timerRunning_) {
+    std::chrono::steady_clock::duration idleTimeout =
+        MemoryIdler::defaultIdleTimeout.load(std::memory_order_acquire);
+    // A negative timeout disables flushing, as for futex waits, and so does
+    // one too long to be scheduled with its variation, e.g. duration::max().
+    constexpr std::chrono::milliseconds kMaxTimeout{
+        std::numeric_limits<uint32_t>::max() / 2};
+    if (idleTimeout >= idleTimeout.zero() && idleTimeout <= kMaxTimeout) {
+      idleTimeout = MemoryIdler::getVariationTimeout(idleTimeout);
+      timerRunning_ = true;
+      scheduleTimeout(static_cast<uint32_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(idleTimeout)
+              .count()));
+    }
+  } else {
+    num_++;
+  }
+
+  // reschedule this callback for the next event loop.
+  evb_.runBeforeLoop(this);
+}
+
+} // namespace folly
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+namespace folly {
+
+/**
+ * Returns the idle memory of the thread driving an EventBase, as
+ * detail::MemoryIdler does for threads blocked on a futex: once the loop
+ * has not handled any event for MemoryIdler::defaultIdleTimeout (with the
+ * usual variation), flushes the thread's malloc caches (and, depending on
+ * the memory idler flags, purges or decays its jemalloc arena) and discards
+ * the unused pages of its stack.
+ *
+ * The idler arms a timeout when the loop becomes busy again, not on every
+ * iteration, and does not wake an idle loop up again after it has flushed.
+ *
+ * Construct it in the loop thread, before driving the loop, and destroy it
+ * there too:
+ *
+ *   EventBaseMemoryIdler idler(evb);
+ *   evb.loopForever();
+ */
+class EventBaseMemoryIdler : private AsyncTimeout,
+                             private EventBase::LoopCallback {
+ public:
+  explicit EventBaseMemoryIdler(EventBase& evb);
+
+  EventBaseMemoryIdler(const EventBaseMemoryIdler&) = delete;
+  EventBaseMemoryIdler& operator=(const EventBaseMemoryIdler&) = delete;
+
+  /**
+   * Number of times the idle memory was released.
+   */
+  size_t numFlushes() const { return numFlushes_; }
+
+ private:
+  void timeoutExpired() noexcept override;
+  void runLoopCallback() noexcept override;
+
+  EventBase& evb_;
+  bool idled_{false};
+  bool timerRunning_{false};
+  // Loop iterations since the timeout was armed.
+  size_t num_{0};
+  size_t numFlushes_{0};
+};
+
+} // namespace folly
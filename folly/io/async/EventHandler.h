@@ -182,6 +182,10 @@ class EventHandler {
     event_.setCallback(cb);
   }
 
+  void setAcceptMultishotCallback(EventAcceptMultishotCallback* cb) {
+    event_.setCallback(cb);
+  }
+
   void resetEventCallback() { event_.resetCallback(); }
 
   /*
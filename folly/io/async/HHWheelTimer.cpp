@@ -75,10 +75,15 @@ void HHWheelTimerBase<Duration>::Callback::cancelTimeoutImpl() {
     assert(wheel_->count_ == 0);
     wheel_->AsyncTimeout::cancelTimeout();
   }
-  unlink();
-  if ((-1 != bucket_) && (wheel_->buckets_[0][bucket_].empty())) {
-    auto bi = makeBitIterator(wheel_->bitmap_.begin());
-    *(bi + bucket_) = false;
+  if (-1 == bucket_ && wheel_->lazyCancellation_) {
+    // Leave the callback in its slot, it is dropped once the slot is cascaded
+    // (or once the callback is rescheduled or destroyed).
+  } else {
+    unlink();
+    if ((-1 != bucket_) && (wheel_->buckets_[0][bucket_].empty())) {
+      auto bi = makeBitIterator(wheel_->bitmap_.begin());
+      *(bi + bucket_) = false;
+    }
   }
 
   wheel_ = nullptr;
@@ -123,6 +128,8 @@ void HHWheelTimerBase<Duration>::scheduleTimeoutImpl(
   CallbackList* list;
 
   auto bi = makeBitIterator(bitmap_.begin());
+  // Only the slots of the first bucket are tracked in the bitmap.
+  callback->bucket_ = -1;
 
   if (diff < 0) {
     list = &buckets_[0][nextTick & WHEEL_MASK];
@@ -150,17 +157,24 @@ void HHWheelTimerBase<Duration>::scheduleTimeoutImpl(
 template <class Duration>
 void HHWheelTimerBase<Duration>::scheduleTimeout(
     Callback* callback, Duration timeout) {
+  scheduleTimeout(callback, timeout, Duration::zero());
+}
+
+template <class Duration>
+void HHWheelTimerBase<Duration>::scheduleTimeout(
+    Callback* callback, Duration timeout, Duration slack) {
   // Make sure that the timeout is not negative.
   timeout = std::max(timeout, Duration::zero());
   // Cancel the callback if it happens to be scheduled already.
   callback->cancelTimeout();
+  // If it was cancelled lazily, it may still be linked into its old slot.
+  callback->unlink();
   callback->requestContext_ = RequestContext::saveContext();
 
   count_++;
 
   auto now = getCurTime();
   auto nextTick = calcNextTick(now);
-  callback->setScheduled(this, now + timeout);
 
   // There are three possible scenarios:
   //   - we are currently inside of HHWheelTimerBase<Duration>::timeoutExpired.
@@ -175,6 +189,13 @@ void HHWheelTimerBase<Duration>::scheduleTimeout(
     baseTick = std::min(expireTick_, nextTick);
   }
   int64_t ticks = timeToWheelTicks(timeout);
+  if (slack > Duration::zero()) {
+    auto minTicks = ticks;
+    ticks = coalesceTicks(
+        nextTick, baseTick, minTicks, minTicks + timeToWheelTicks(slack));
+    timeout += interval_.fromWheelTicks(ticks - minTicks);
+  }
+  callback->setScheduled(this, now + timeout);
   int64_t due = ticks + nextTick;
   scheduleTimeoutImpl(callback, due, baseTick, nextTick);
 
@@ -195,6 +216,47 @@ void HHWheelTimerBase<Duration>::scheduleTimeout(
   }
 }
 
+template <class Duration>
+int64_t HHWheelTimerBase<Duration>::coalesceTicks(
+    int64_t nextTick, int64_t baseTick, int64_t minTicks, int64_t maxTicks) {
+  if (minTicks == maxTicks) {
+    return minTicks;
+  }
+  auto scheduledTicks = expireTick_ - nextTick;
+  if (!processingCallbacksGuard_ && isScheduled() &&
+      scheduledTicks >= minTicks && scheduledTicks <= maxTicks) {
+    // Expire along with the timeouts the timer is already going to wake up
+    // for.
+    return scheduledTicks;
+  }
+  if (nextTick + maxTicks - baseTick < WHEEL_SIZE) {
+    // Expire along with the earliest timeouts of the first bucket that are
+    // due within range, if any. All of them are due before baseTick +
+    // WHEEL_SIZE, so each slot in range maps to a single tick.
+    auto bi = makeBitIterator(bitmap_.begin());
+    auto first = (nextTick + minTicks) & WHEEL_MASK;
+    auto last = (nextTick + maxTicks) & WHEEL_MASK;
+    auto end = bi + (first <= last ? last + 1 : WHEEL_SIZE);
+    auto it = folly::findFirstSet(bi + first, end);
+    if (it != end) {
+      return minTicks + std::distance(bi + first, it);
+    }
+    if (first > last) {
+      end = bi + last + 1;
+      it = folly::findFirstSet(bi, end);
+      if (it != end) {
+        return minTicks + (WHEEL_SIZE - first) + std::distance(bi, it);
+      }
+    }
+  }
+  // Round the latest acceptable tick down to a multiple of the largest power
+  // of two that keeps it in range.
+  auto align = static_cast<int64_t>(
+      folly::prevPowTwo(static_cast<uint64_t>(maxTicks - minTicks + 1)));
+  auto due = (nextTick + maxTicks) & ~(align - 1);
+  return due - nextTick;
+}
+
 template <class Duration>
 void HHWheelTimerBase<Duration>::scheduleTimeout(Callback* callback) {
   CHECK(Duration(-1) != defaultTimeout_)
@@ -211,6 +273,10 @@ bool HHWheelTimerBase<Duration>::cascadeTimers(
   while (!cbs.empty()) {
     auto* cb = &cbs.front();
     cbs.pop_front();
+    if (!cb->isScheduled()) {
+      // Cancelled lazily.
+      continue;
+    }
     scheduleTimeoutImpl(
         cb,
         nextTick + timeToWheelTicks(cb->getTimeRemaining(curTime)),
@@ -308,24 +374,27 @@ size_t HHWheelTimerBase<Duration>::cancelAll() {
 
   if (count_ != 0) {
     const std::size_t numElements = WHEEL_BUCKETS * WHEEL_SIZE;
-    auto maxBuckets = std::min(numElements, count_);
+    // Lazily cancelled callbacks may still occupy some buckets.
+    auto maxBuckets =
+        lazyCancellation_ ? numElements : std::min(numElements, count_);
     auto buckets = std::make_unique<CallbackList[]>(maxBuckets);
     size_t countBuckets = 0;
+    size_t found = 0;
     for (auto& tick : buckets_) {
       for (auto& bucket : tick) {
         if (bucket.empty()) {
           continue;
         }
-        count += bucket.size();
+        found += bucket.size();
         std::swap(bucket, buckets[countBuckets++]);
-        if (count >= count_) {
+        if (!lazyCancellation_ && found >= count_) {
           break;
         }
       }
     }
 
     for (size_t i = 0; i < countBuckets; ++i) {
-      cancelTimeoutsFromList(buckets[i]);
+      count += cancelTimeoutsFromList(buckets[i]);
     }
     // Swap the list to prevent potential recursion if cancelAll is called by
     // one of the callbacks.
@@ -367,8 +436,13 @@ size_t HHWheelTimerBase<Duration>::cancelTimeoutsFromList(
     CallbackList& timeouts) {
   size_t count = 0;
   while (!timeouts.empty()) {
-    ++count;
     auto& cb = timeouts.front();
+    timeouts.pop_front();
+    if (!cb.isScheduled()) {
+      // Cancelled lazily.
+      continue;
+    }
+    ++count;
     cb.cancelTimeout();
     cb.callbackCanceled();
   }
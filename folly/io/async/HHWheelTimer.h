@@ -266,6 +266,22 @@ class HHWheelTimerBase
    */
   void scheduleTimeout(Callback* callback, Duration timeout);
 
+  /**
+   * Schedule the specified Callback to be invoked after at least `timeout`
+   * and at most `timeout + slack`.
+   *
+   * Within that range, the timer picks the tick it is already going to wake up
+   * for, or else a tick other timeouts are already due at, or else the most
+   * aligned tick, which other timeouts with slack are likely to pick as well.
+   * Timeouts that tolerate some imprecision, e.g. most RPC timeouts, can so be
+   * expired together with fewer wakeups and fewer reschedulings of the
+   * underlying timer.
+   *
+   * If the callback is already scheduled, this cancels the existing timeout
+   * before scheduling the new timeout.
+   */
+  void scheduleTimeout(Callback* callback, Duration timeout, Duration slack);
+
   /**
    * Schedule the specified Callback to be invoked after the
    * default timeout interval.
@@ -302,6 +318,18 @@ class HHWheelTimerBase
    */
   std::size_t count() const { return count_; }
 
+  /**
+   * Cancel distant timeouts lazily: a cancelled timeout which is not due
+   * within the current wheel epoch is only marked as cancelled and left in
+   * its slot, without touching its neighbours in the slot list. It is dropped
+   * when the slot is cascaded, or when its Callback is rescheduled or
+   * destroyed. This makes cancellation cheaper for timeouts which are almost
+   * always cancelled before they fire, such as RPC timeouts.
+   *
+   * Lazy cancellation cannot be disabled once enabled.
+   */
+  void enableLazyCancellation() { lazyCancellation_ = true; }
+
   bool isDetachable() const { return !folly::AsyncTimeout::isScheduled(); }
 
   using folly::AsyncTimeout::attachEventBase;
@@ -346,6 +374,7 @@ class HHWheelTimerBase
 
   int64_t expireTick_;
   std::size_t count_;
+  bool lazyCancellation_{false};
   std::chrono::steady_clock::time_point startTime_;
 
   int64_t calcNextTick();
@@ -387,6 +416,17 @@ class HHWheelTimerBase
    */
   void scheduleNextTimeout(int64_t nextTick, int64_t ticks);
 
+  /**
+   * Pick the number of ticks in [minTicks, maxTicks] after which to expire a
+   * timeout with slack.
+   *
+   * @param nextTick  next tick based on the actual time
+   * @param baseTick  tick the first bucket is relative to, see
+   *                  scheduleTimeoutImpl()
+   */
+  int64_t coalesceTicks(
+      int64_t nextTick, int64_t baseTick, int64_t minTicks, int64_t maxTicks);
+
   size_t cancelTimeoutsFromList(CallbackList& timeouts);
 
   bool* processingCallbacksGuard_;
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/io/async/IoQueueDepthController.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace folly {
+
+IoQueueDepthController::IoQueueDepthController(const Options& options)
+    : options_(options),
+      depth_(std::clamp(
+          options.initialDepth,
+          std::max<size_t>(options.minDepth, 1),
+          std::max<size_t>(options.maxDepth, 1))) {
+  DCHECK_LE(options.minDepth, options.maxDepth);
+}
+
+void IoQueueDepthController::onComplete(
+    std::chrono::nanoseconds latency,
+    Clock::time_point now,
+    bool depthLimited) {
+  ++roundCompletions_;
+  roundLatency_ += latency;
+  roundDepthLimited_ |= depthLimited;
+  if (roundCompletions_ >= depth_) {
+    endRound(now);
+  }
+}
+
+void IoQueueDepthController::endRound(Clock::time_point now) {
+  const auto avgLatency =
+      roundLatency_ / static_cast<int64_t>(roundCompletions_);
+  if (minLatency_.count() == 0 || avgLatency < minLatency_ ||
+      now - minLatencyTime_ > options_.minLatencyWindow) {
+    minLatency_ = avgLatency;
+    minLatencyTime_ = now;
+  }
+
+  const size_t step = std::max<size_t>(depth_ / 4, 1);
+  const auto limit = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      minLatency_ * options_.latencyTolerance);
+  if (avgLatency > limit) {
+    depth_ = std::max(depth_ - std::min(depth_, step), options_.minDepth);
+    depth_ = std::max<size_t>(depth_, 1);
+  } else if (roundDepthLimited_) {
+    depth_ = std::min(depth_ + step, std::max<size_t>(options_.maxDepth, 1));
+  }
+
+  roundCompletions_ = 0;
+  roundLatency_ = std::chrono::nanoseconds{0};
+  roundDepthLimited_ = false;
+}
+
+} // namespace folly
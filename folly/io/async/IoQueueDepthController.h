@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace folly {
+
+/**
+ * Picks how many IOs to keep in flight on a device from the latencies of
+ * the recent ones, a simple storage analog of the BBR congestion control.
+ *
+ * Up to some depth, a device (e.g. an SSD) serves more requests in parallel
+ * at the same latency; beyond it, requests just queue up in the device and
+ * their latency grows with no gain in throughput. The controller tracks the
+ * minimum latency over a window, as the latency of the unloaded device, and
+ * works in rounds of depth() completions:
+ *  - if the average latency of the round stayed within latencyTolerance of
+ *    the minimum and the round was limited by the depth, it probes a deeper
+ *    queue (by a quarter);
+ *  - if the latency inflated beyond that, it drains the queue (by a
+ *    quarter).
+ * The minimum is re-measured once per minLatencyWindow, so that the
+ * controller follows a device that got slower.
+ *
+ *   IoQueueDepthController controller;
+ *   while (inFlight < controller.depth() && ...) submit(...);
+ *   ...
+ *   controller.onComplete(latency, now, depthLimited);
+ */
+class IoQueueDepthController {
+ public:
+  struct Options {
+    Options() {}
+    size_t minDepth = 1;
+    size_t initialDepth = 4;
+    size_t maxDepth = 256;
+    double latencyTolerance = 1.5;
+    std::chrono::nanoseconds minLatencyWindow = std::chrono::seconds{10};
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  explicit IoQueueDepthController(const Options& options = Options());
+
+  size_t depth() const { return depth_; }
+
+  // Zero until the first round completes.
+  std::chrono::nanoseconds minLatency() const { return minLatency_; }
+
+  /**
+   * Records the completion of an IO. depthLimited tells whether some IO was
+   * waiting for the depth to allow it in when this one was submitted.
+   */
+  void onComplete(
+      std::chrono::nanoseconds latency,
+      Clock::time_point now,
+      bool depthLimited);
+
+ private:
+  void endRound(Clock::time_point now);
+
+  const Options options_;
+  size_t depth_;
+
+  std::chrono::nanoseconds minLatency_{0};
+  Clock::time_point minLatencyTime_;
+
+  size_t roundCompletions_{0};
+  std::chrono::nanoseconds roundLatency_{0};
+  bool roundDepthLimited_{false};
+};
+
+} // namespace folly
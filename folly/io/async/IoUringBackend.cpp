@@ -977,6 +977,11 @@ void IoUringBackend::processPollIo(
         ioSqe->useCount_--;
       };
       if (ioSqe->cbData_.processCb(this, res, flags)) {
+        if (!ioSqe->event_) {
+          // The callback deleted the event, which couldn't cancel the
+          // multishot request while it was in use.
+          cancelOne(ioSqe);
+        }
         return;
       }
     }
@@ -1003,7 +1008,12 @@ void IoUringBackend::processPollIo(
     ioSqe->cqeFlags_ = flags;
     activeEvents_.push_back(*ioSqe);
   } else {
-    releaseIoSqe(ioSqe);
+    // The event was deleted: drop the result. A multishot request is
+    // released with its last completion.
+    ioSqe->cbData_.discardResult(this, res, flags);
+    if (!(flags & IORING_CQE_F_MORE)) {
+      releaseIoSqe(ioSqe);
+    }
   }
 }
 
@@ -1111,8 +1121,12 @@ void IoUringBackend::initSubmissionLinked() {
 
     int sizeShift =
         std::max<int>(get_shift(options_.initialProvidedBuffersEachSize), 5);
-    int ringShift =
-        std::max<int>(get_shift(options_.initialProvidedBuffersCount), 1);
+    // The ring needs an entry for every buffer it may grow to.
+    int ringShift = std::max<int>(
+        get_shift(std::max(
+            options_.initialProvidedBuffersCount,
+            options_.maxProvidedBuffersCount)),
+        1);
 
     try {
       IoUringProvidedBufferRing::Options options = {
@@ -1121,6 +1135,7 @@ void IoUringBackend::initSubmissionLinked() {
           .bufferShift = sizeShift,
           .ringSizeShift = ringShift,
           .useHugePages = false,
+          .maxCount = options_.maxProvidedBuffersCount,
       };
       bufferProvider_ = makeProvidedBufferRing(this->ioRingPtr(), options);
     } catch (const IoUringProvidedBufferRing::LibUringCallError& ex) {
@@ -1144,6 +1159,22 @@ void IoUringBackend::initSubmissionLinked() {
     };
     zcBufferPool_ = IoUringZeroCopyBufferPool::create(params);
   }
+
+  if (options_.registeredBuffersCount > 0) {
+    // fixed buffers are an optimization, run without them if this fails
+    try {
+      registeredBufferPool_ = IoUringRegisteredBufferPool::create({
+          .ring = this->ioRingPtr(),
+          .bufferSize = options_.registeredBuffersEachSize,
+          .count = options_.registeredBuffersCount,
+      });
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "failed to register buffers, buffer count: "
+                 << options_.registeredBuffersCount
+                 << ", buffer size: " << options_.registeredBuffersEachSize
+                 << ": " << ex.what();
+    }
+  }
 }
 
 void IoUringBackend::delayedInit() {
@@ -1396,8 +1427,9 @@ void IoUringBackend::submitNextLoop(IoSqeBase& ioSqe) noexcept {
 }
 
 void IoUringBackend::submitImmediateIoSqe(IoSqeBase& ioSqe) {
-  if (options_.flags &
-      (Options::Flags::POLL_SQ | Options::Flags::POLL_SQ_IMMEDIATE_IO)) {
+  if (submitBatchDepth_ == 0 &&
+      (options_.flags &
+       (Options::Flags::POLL_SQ | Options::Flags::POLL_SQ_IMMEDIATE_IO))) {
     submitNow(ioSqe);
   } else {
     submitList_.push_back(ioSqe);
@@ -1425,7 +1457,30 @@ void IoUringBackend::internalSubmit(IoSqeBase& ioSqe) noexcept {
 
 void IoUringBackend::submitSoon(IoSqeBase& ioSqe) noexcept {
   internalSubmit(ioSqe);
-  if (waitingToSubmit_ >= options_.maxSubmit) {
+  if (submitBatchDepth_ == 0 && waitingToSubmit_ >= options_.maxSubmit) {
+    submitBusyCheck(waitingToSubmit_, WaitForEventsMode::DONT_WAIT);
+  }
+}
+
+void IoUringBackend::submitLinked(Range<IoSqe* const*> ioSqes) {
+  delayedInit();
+  // getSqe() submits when the queue is full, which would split the chain
+  if (::io_uring_sq_space_left(&ioRing_) < ioSqes.size()) {
+    submitEager();
+  }
+  for (size_t i = 0; i < ioSqes.size(); i++) {
+    auto* sqe = getSqe();
+    setSubmitting();
+    ioSqes[i]->internalSubmit(sqe);
+    doneSubmitting();
+    if (i + 1 < ioSqes.size()) {
+      sqe->flags |= IOSQE_IO_LINK;
+    }
+  }
+  if (submitBatchDepth_ == 0 &&
+      ((options_.flags &
+        (Options::Flags::POLL_SQ | Options::Flags::POLL_SQ_IMMEDIATE_IO)) ||
+       waitingToSubmit_ >= options_.maxSubmit)) {
     submitBusyCheck(waitingToSubmit_, WaitForEventsMode::DONT_WAIT);
   }
 }
@@ -1769,6 +1824,9 @@ void IoUringBackend::queueRead(
   };
   auto* ioSqe = new ReadIoSqe(this, fd, &iov, offset, std::move(cb));
   ioSqe->backendCb_ = processFileOpCB;
+  if (registeredBufferPool_) {
+    ioSqe->bufIndex_ = registeredBufferPool_->bufferIndex(buf, nbytes);
+  }
 
   submitImmediateIoSqe(*ioSqe);
 }
@@ -1784,6 +1842,9 @@ void IoUringBackend::queueWrite(
   };
   auto* ioSqe = new WriteIoSqe(this, fd, &iov, offset, std::move(cb));
   ioSqe->backendCb_ = processFileOpCB;
+  if (registeredBufferPool_) {
+    ioSqe->bufIndex_ = registeredBufferPool_->bufferIndex(buf, nbytes);
+  }
 
   submitImmediateIoSqe(*ioSqe);
 }
@@ -1894,6 +1955,127 @@ void IoUringBackend::queueRecvmsg(
   submitImmediateIoSqe(*ioSqe);
 }
 
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::add(
+    Type type, int fd, Range<const struct iovec*> iov, off_t offset) {
+  ops_.push_back(Op{type, fd, {iov.begin(), iov.end()}, offset});
+  return *this;
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::read(
+    int fd, void* buf, unsigned int nbytes, off_t offset) {
+  struct iovec iov{buf, nbytes};
+  return add(Type::READ, fd, {&iov, 1}, offset);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::write(
+    int fd, const void* buf, unsigned int nbytes, off_t offset) {
+  struct iovec iov{const_cast<void*>(buf), nbytes};
+  return add(Type::WRITE, fd, {&iov, 1}, offset);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::readv(
+    int fd, Range<const struct iovec*> iovecs, off_t offset) {
+  return add(Type::READV, fd, iovecs, offset);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::writev(
+    int fd, Range<const struct iovec*> iovecs, off_t offset) {
+  return add(Type::WRITEV, fd, iovecs, offset);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::fsync(int fd) {
+  return add(Type::FSYNC, fd, {}, 0);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::fdatasync(
+    int fd) {
+  return add(Type::FDATASYNC, fd, {}, 0);
+}
+
+IoUringBackend::LinkedFileOps& IoUringBackend::LinkedFileOps::close(int fd) {
+  return add(Type::CLOSE, fd, {}, 0);
+}
+
+void IoUringBackend::queueLinked(
+    LinkedFileOps&& ops, LinkedFileOpsCallback&& cb) {
+  size_t const num = ops.ops_.size();
+  if (num == 0) {
+    cb({});
+    return;
+  }
+  if (num > ioRing_.sq.ring_entries) {
+    throw std::invalid_argument(folly::to<std::string>(
+        "linked chain of ",
+        num,
+        " operations does not fit in a submission queue of ",
+        ioRing_.sq.ring_entries));
+  }
+
+  struct ChainState {
+    std::vector<int> results;
+    size_t pending;
+    LinkedFileOpsCallback cb;
+  };
+  auto* state = new ChainState{std::vector<int>(num), num, std::move(cb)};
+
+  std::vector<IoSqe*> ioSqes;
+  ioSqes.reserve(num);
+  for (size_t i = 0; i < num; i++) {
+    FileOpCallback opCb = [state, i](int res) {
+      state->results[i] = res;
+      if (--state->pending == 0) {
+        std::unique_ptr<ChainState> done(state);
+        done->cb(std::move(done->results));
+      }
+    };
+    auto& op = ops.ops_[i];
+    Range<const struct iovec*> iov(op.iov.data(), op.iov.size());
+    FileOpIoSqe* ioSqe = nullptr;
+    switch (op.type) {
+      case LinkedFileOps::Type::READ: {
+        auto* rw = new ReadIoSqe(this, op.fd, iov, op.offset, std::move(opCb));
+        if (registeredBufferPool_) {
+          rw->bufIndex_ = registeredBufferPool_->bufferIndex(
+              iov[0].iov_base, iov[0].iov_len);
+        }
+        ioSqe = rw;
+        break;
+      }
+      case LinkedFileOps::Type::WRITE: {
+        auto* rw =
+            new WriteIoSqe(this, op.fd, iov, op.offset, std::move(opCb));
+        if (registeredBufferPool_) {
+          rw->bufIndex_ = registeredBufferPool_->bufferIndex(
+              iov[0].iov_base, iov[0].iov_len);
+        }
+        ioSqe = rw;
+        break;
+      }
+      case LinkedFileOps::Type::READV:
+        ioSqe = new ReadvIoSqe(this, op.fd, iov, op.offset, std::move(opCb));
+        break;
+      case LinkedFileOps::Type::WRITEV:
+        ioSqe = new WritevIoSqe(this, op.fd, iov, op.offset, std::move(opCb));
+        break;
+      case LinkedFileOps::Type::FSYNC:
+        ioSqe = new FSyncIoSqe(
+            this, op.fd, FSyncFlags::FLAGS_FSYNC, std::move(opCb));
+        break;
+      case LinkedFileOps::Type::FDATASYNC:
+        ioSqe = new FSyncIoSqe(
+            this, op.fd, FSyncFlags::FLAGS_FDATASYNC, std::move(opCb));
+        break;
+      case LinkedFileOps::Type::CLOSE:
+        ioSqe = new FCloseIoSqe(this, op.fd, std::move(opCb));
+        break;
+    }
+    ioSqe->backendCb_ = processFileOpCB;
+    ioSqes.push_back(ioSqe);
+  }
+
+  submitLinked(Range<IoSqe* const*>(ioSqes.data(), ioSqes.size()));
+}
+
 void IoUringBackend::queueRecvZc(
     int fd, void* buf, unsigned long nbytes, RecvZcCallback&& cb) {
   iovec iov = {
@@ -2028,6 +2210,67 @@ static bool doKernelSupportsDeferTaskrun() {
   return false;
 }
 
+static bool doKernelSupportsAcceptMultishot() {
+#if FOLLY_IO_URING_UP_TO_DATE
+  // Older kernels fail the accept with EINVAL because of the multishot flag,
+  // newer ones accept a pending connection and keep the request armed.
+  auto listenFd = netops::socket(AF_INET, SOCK_STREAM, 0);
+  auto clientFd = netops::socket(AF_INET, SOCK_STREAM, 0);
+  SCOPE_EXIT {
+    netops::close(clientFd);
+    netops::close(listenFd);
+  };
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen = sizeof(addr);
+  if (netops::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), addrLen) ||
+      netops::listen(listenFd, 1) ||
+      netops::getsockname(
+          listenFd, reinterpret_cast<sockaddr*>(&addr), &addrLen) ||
+      netops::connect(clientFd, reinterpret_cast<sockaddr*>(&addr), addrLen)) {
+    return false;
+  }
+
+  struct io_uring ring;
+  int ret = io_uring_queue_init(4, &ring, 0);
+  if (ret) {
+    LOG(ERROR) << "doKernelSupportsAcceptMultishot: Unexpectedly "
+               << "io_uring_queue_init failed";
+    return false;
+  }
+  SCOPE_EXIT {
+    io_uring_queue_exit(&ring);
+  };
+
+  auto* sqe = ::io_uring_get_sqe(&ring);
+  if (!sqe) {
+    LOG(ERROR) << "doKernelSupportsAcceptMultishot: no sqe?";
+    return false;
+  }
+
+  io_uring_prep_multishot_accept(sqe, listenFd.toFd(), nullptr, nullptr, 0);
+  ret = ::io_uring_submit(&ring);
+  if (ret != 1) {
+    return false;
+  }
+
+  struct io_uring_cqe* cqe = nullptr;
+  ret = ::io_uring_wait_cqe(&ring, &cqe);
+  if (ret) {
+    return false;
+  }
+
+  if (cqe->res >= 0) {
+    fileops::close(cqe->res);
+  }
+  return cqe->res >= 0 && (cqe->flags & IORING_CQE_F_MORE);
+#endif
+
+  // fallthrough
+  return false;
+}
+
 static bool doKernelSupportsSendZC() {
 #if FOLLY_IO_URING_UP_TO_DATE
   struct io_uring ring;
@@ -2078,6 +2321,11 @@ bool IoUringBackend::kernelSupportsRecvmsgMultishot() {
   return ret;
 }
 
+bool IoUringBackend::kernelSupportsAcceptMultishot() {
+  static bool const ret = doKernelSupportsAcceptMultishot();
+  return ret;
+}
+
 bool IoUringBackend::kernelSupportsDeferTaskrun() {
   static bool const ret = doKernelSupportsDeferTaskrun();
   return ret;
@@ -39,9 +39,11 @@
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventBaseBackendBase.h>
 #include <folly/io/async/IoUringBase.h>
+#include <folly/io/async/IoUringRegisteredBufferPool.h>
 #include <folly/io/async/IoUringZeroCopyBufferPool.h>
 #include <folly/io/async/Liburing.h>
 #include <folly/portability/Asm.h>
+#include <folly/portability/Unistd.h>
 #include <folly/small_vector.h>
 
 #if __has_include(<poll.h>)
@@ -164,6 +166,21 @@ class IoUringBackend : public EventBaseBackendBase {
       return *this;
     }
 
+    // Lets the provided buffer ring grow, in steps of the initial count, up
+    // to count buffers when the kernel runs out of them.
+    Options& setMaxProvidedBuffers(size_t count) {
+      maxProvidedBuffersCount = count;
+      return *this;
+    }
+
+    // Registers count buffers of eachSize bytes with the ring, see
+    // allocateRegisteredBuffer().
+    Options& setRegisteredBuffers(size_t eachSize, size_t count) {
+      registeredBuffersCount = count;
+      registeredBuffersEachSize = eachSize;
+      return *this;
+    }
+
     Options& setRegisterRingFd(bool v) {
       registerRingFd = v;
 
@@ -248,6 +265,9 @@ class IoUringBackend : public EventBaseBackendBase {
     size_t sqGroupNumThreads{1};
     size_t initialProvidedBuffersCount{0};
     size_t initialProvidedBuffersEachSize{0};
+    size_t maxProvidedBuffersCount{0};
+    size_t registeredBuffersCount{0};
+    size_t registeredBuffersEachSize{0};
 
     uint32_t flags{0};
 
@@ -310,6 +330,10 @@ class IoUringBackend : public EventBaseBackendBase {
 
   bool eb_event_active(Event&, int) override { return false; }
 
+  bool supportsMultishotAccept() const override {
+    return kernelSupportsAcceptMultishot();
+  }
+
   size_t loopPoll();
   void submitOutstanding();
   unsigned int processCompleted();
@@ -319,6 +343,7 @@ class IoUringBackend : public EventBaseBackendBase {
   static bool isAvailable();
   bool kernelHasNonBlockWriteFixes() const;
   static bool kernelSupportsRecvmsgMultishot();
+  static bool kernelSupportsAcceptMultishot();
   static bool kernelSupportsDeferTaskrun();
   static bool kernelSupportsSendZC();
 
@@ -342,6 +367,15 @@ class IoUringBackend : public EventBaseBackendBase {
   // i.e. the result of the file operation
   using FileOpCallback = folly::Function<void(int)>;
 
+  // Returns an empty IOBuf backed by one of the buffers registered with
+  // Options::setRegisteredBuffers(), or nullptr if there are none or all of
+  // them are in use. queueRead() and queueWrite() use READ_FIXED and
+  // WRITE_FIXED for ranges that lie within such a buffer. The IOBuf may be
+  // freed from any thread, and outlive the backend.
+  std::unique_ptr<IOBuf> allocateRegisteredBuffer() {
+    return registeredBufferPool_ ? registeredBufferPool_->allocate() : nullptr;
+  }
+
   void queueRead(
       int fd,
       void* buf,
@@ -408,6 +442,75 @@ class IoUringBackend : public EventBaseBackendBase {
   void queueRecvmsg(
       int fd, struct msghdr* msg, unsigned int flags, FileOpCallback&& cb);
 
+  // A sequence of file operations submitted as one chain of linked SQEs
+  // (IOSQE_IO_LINK): each operation only starts once the previous one has
+  // succeeded. If one fails, or a read or write is short, the remaining ones
+  // complete with -ECANCELED. Buffers must stay valid until the chain's
+  // callback runs.
+  class LinkedFileOps {
+   public:
+    LinkedFileOps& read(int fd, void* buf, unsigned int nbytes, off_t offset);
+    LinkedFileOps& write(
+        int fd, const void* buf, unsigned int nbytes, off_t offset);
+    LinkedFileOps& readv(
+        int fd, Range<const struct iovec*> iovecs, off_t offset);
+    LinkedFileOps& writev(
+        int fd, Range<const struct iovec*> iovecs, off_t offset);
+    LinkedFileOps& fsync(int fd);
+    LinkedFileOps& fdatasync(int fd);
+    LinkedFileOps& close(int fd);
+
+    size_t size() const { return ops_.size(); }
+    bool empty() const { return ops_.empty(); }
+
+   private:
+    friend class IoUringBackend;
+
+    enum class Type { READ, WRITE, READV, WRITEV, FSYNC, FDATASYNC, CLOSE };
+    struct Op {
+      Type type;
+      int fd;
+      std::vector<struct iovec> iov;
+      off_t offset;
+    };
+
+    LinkedFileOps& add(
+        Type type, int fd, Range<const struct iovec*> iov, off_t offset);
+
+    std::vector<Op> ops_;
+  };
+
+  // Invoked once all the operations of a chain completed, with the
+  // io_uring_cqe res field of each of them, in order.
+  using LinkedFileOpsCallback = folly::Function<void(std::vector<int>)>;
+
+  // Throws std::invalid_argument if the chain has more operations than the
+  // submission queue has entries.
+  void queueLinked(LinkedFileOps&& ops, LinkedFileOpsCallback&& cb);
+
+  // While a SubmitBatch is alive, operations queued on the backend are not
+  // submitted to the kernel, even with the POLL_SQ flags, unless the
+  // submission queue fills up. When the outermost SubmitBatch goes away, they
+  // are all submitted at once instead of waiting for the next loop iteration.
+  // Must only be used in the event base thread.
+  class SubmitBatch {
+   public:
+    explicit SubmitBatch(IoUringBackend& backend) : backend_(backend) {
+      ++backend_.submitBatchDepth_;
+    }
+    ~SubmitBatch() {
+      if (--backend_.submitBatchDepth_ == 0) {
+        backend_.submitOutstanding();
+      }
+    }
+
+    SubmitBatch(const SubmitBatch&) = delete;
+    SubmitBatch& operator=(const SubmitBatch&) = delete;
+
+   private:
+    IoUringBackend& backend_;
+  };
+
   void submit(IoSqeBase& ioSqe) {
     // todo verify that the sqe is valid!
     submitImmediateIoSqe(ioSqe);
@@ -422,6 +525,9 @@ class IoUringBackend : public EventBaseBackendBase {
   IoUringBufferProviderBase* bufferProvider() { return bufferProvider_.get(); }
   uint16_t nextBufferProviderGid() { return bufferProviderGidNext_++; }
   IoUringZeroCopyBufferPool* zcBufferPool() { return zcBufferPool_.get(); }
+  IoUringRegisteredBufferPool* registeredBufferPool() {
+    return registeredBufferPool_.get();
+  }
 
  protected:
   enum class WaitForEventsMode { WAIT, DONT_WAIT };
@@ -522,6 +628,9 @@ class IoUringBackend : public EventBaseBackendBase {
 
   void internalSubmit(IoSqeBase& ioSqe) noexcept;
 
+  // Preps the entries back to back with IOSQE_IO_LINK on all but the last.
+  void submitLinked(Range<IoSqe* const*> ioSqes);
+
   enum class InternalProcessCqeMode {
     NORMAL, // process existing and any available
     AVAILABLE_ONLY, // process existing but don't get more
@@ -624,6 +733,14 @@ class IoUringBackend : public EventBaseBackendBase {
               return;
             }
             break;
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT:
+            if (auto* hdr =
+                    cb.acceptMultishotCb_->allocateAcceptMultishotData()) {
+              prepAcceptMultishot(sqe, ev->ev_fd);
+              cbData_.set(hdr);
+              return;
+            }
+            break;
         }
         prepPollAdd(sqe, ev->ev_fd, getPollFlags(ev->ev_events));
       }
@@ -637,6 +754,7 @@ class IoUringBackend : public EventBaseBackendBase {
         EventReadCallback::IoVec* ioVec_;
         EventRecvmsgCallback::MsgHdr* msgHdr_;
         EventRecvmsgMultishotCallback::Hdr* hdr_;
+        EventAcceptMultishotCallback::Hdr* acceptHdr_;
       };
 
       void set(EventReadCallback::IoVec* ioVec) {
@@ -654,6 +772,11 @@ class IoUringBackend : public EventBaseBackendBase {
         hdr_ = hdr;
       }
 
+      void set(EventAcceptMultishotCallback::Hdr* hdr) {
+        type_ = EventCallback::Type::TYPE_ACCEPT_MULTISHOT;
+        acceptHdr_ = hdr;
+      }
+
       void reset() { type_ = EventCallback::Type::TYPE_NONE; }
 
       bool processCb(IoUringBackend* backend, int res, uint32_t flags) {
@@ -687,6 +810,15 @@ class IoUringBackend : public EventBaseBackendBase {
             }
             break;
           }
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT: {
+            ret = true;
+            acceptHdr_->cbFunc_(acceptHdr_, res);
+            if (!(flags & IORING_CQE_F_MORE)) {
+              acceptHdr_->freeFunc_(acceptHdr_);
+              released = true;
+            }
+            break;
+          }
           case EventCallback::Type::TYPE_NONE:
             break;
         }
@@ -698,6 +830,28 @@ class IoUringBackend : public EventBaseBackendBase {
         return ret;
       }
 
+      // Drops the result of a request whose event was deleted.
+      void discardResult(IoUringBackend* backend, int res, uint32_t flags) {
+        switch (type_) {
+          case EventCallback::Type::TYPE_RECVMSG_MULTISHOT:
+            if (flags & IORING_CQE_F_BUFFER) {
+              if (IoUringBufferProviderBase* bp = backend->bufferProvider()) {
+                bp->getIoBuf(flags >> 16, res);
+              }
+            }
+            break;
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT:
+            if (res >= 0) {
+              fileops::close(res);
+            }
+            break;
+          case EventCallback::Type::TYPE_READ:
+          case EventCallback::Type::TYPE_RECVMSG:
+          case EventCallback::Type::TYPE_NONE:
+            break;
+        }
+      }
+
       void releaseData() {
         switch (type_) {
           case EventCallback::Type::TYPE_READ: {
@@ -713,6 +867,9 @@ class IoUringBackend : public EventBaseBackendBase {
           case EventCallback::Type::TYPE_RECVMSG_MULTISHOT:
             hdr_->freeFunc_(hdr_);
             break;
+          case EventCallback::Type::TYPE_ACCEPT_MULTISHOT:
+            acceptHdr_->freeFunc_(acceptHdr_);
+            break;
           case EventCallback::Type::TYPE_NONE:
             break;
         }
@@ -808,6 +965,18 @@ class IoUringBackend : public EventBaseBackendBase {
       ::io_uring_sqe_set_data(sqe, this);
     }
 
+    void prepAcceptMultishot(struct io_uring_sqe* sqe, int fd) noexcept {
+      CHECK(sqe);
+      // The client address is not reported: all the completions would share
+      // the same buffer.
+      ::io_uring_prep_accept(sqe, fd, nullptr, nullptr, SOCK_NONBLOCK);
+      // IORING_ACCEPT_MULTISHOT, which io_uring_prep_multishot_accept sets;
+      // see the note in prepRecvmsgMultishot
+      constexpr uint16_t kAcceptMultishotFlag = 1U << 0;
+      sqe->ioprio |= kAcceptMultishotFlag;
+      ::io_uring_sqe_set_data(sqe, this);
+    }
+
     FOLLY_ALWAYS_INLINE void prepCancel(
         struct io_uring_sqe* sqe, IoSqe* cancel_sqe) {
       CHECK(sqe);
@@ -856,13 +1025,27 @@ class IoUringBackend : public EventBaseBackendBase {
     static constexpr size_t kNumInlineIoVec = 4;
     folly::small_vector<struct iovec> iov_;
     off_t offset_;
+    // index of the registered buffer holding iov_[0], if any
+    int bufIndex_{-1};
   };
 
   struct ReadIoSqe : public ReadWriteIoSqe {
     using ReadWriteIoSqe::ReadWriteIoSqe;
 
     void processSubmit(struct io_uring_sqe* sqe) noexcept override {
-      prepRead(sqe, fd_, iov_.data(), offset_, false);
+      if (bufIndex_ >= 0) {
+        prepUtilFunc(
+            ::io_uring_prep_read_fixed,
+            sqe,
+            false,
+            fd_,
+            iov_[0].iov_base,
+            (unsigned int)iov_[0].iov_len,
+            (__u64)offset_,
+            bufIndex_);
+      } else {
+        prepRead(sqe, fd_, iov_.data(), offset_, false);
+      }
     }
   };
 
@@ -870,7 +1053,19 @@ class IoUringBackend : public EventBaseBackendBase {
     using ReadWriteIoSqe::ReadWriteIoSqe;
 
     void processSubmit(struct io_uring_sqe* sqe) noexcept override {
-      prepWrite(sqe, fd_, iov_.data(), offset_, false);
+      if (bufIndex_ >= 0) {
+        prepUtilFunc(
+            ::io_uring_prep_write_fixed,
+            sqe,
+            false,
+            fd_,
+            (const void*)iov_[0].iov_base,
+            (unsigned int)iov_[0].iov_len,
+            (__u64)offset_,
+            bufIndex_);
+      } else {
+        prepWrite(sqe, fd_, iov_.data(), offset_, false);
+      }
     }
   };
 
@@ -1157,6 +1352,7 @@ class IoUringBackend : public EventBaseBackendBase {
   uint16_t bufferProviderGidNext_{0};
   IoUringBufferProviderBase::UniquePtr bufferProvider_;
   IoUringZeroCopyBufferPool::UniquePtr zcBufferPool_;
+  IoUringRegisteredBufferPool::UniquePtr registeredBufferPool_;
 
   // loop related
   bool loopBreak_{false};
@@ -1165,6 +1361,7 @@ class IoUringBackend : public EventBaseBackendBase {
   bool processSignals_{false};
   IoSqeList activeEvents_;
   size_t waitingToSubmit_{0};
+  size_t submitBatchDepth_{0};
   size_t numInsertedEvents_{0};
   size_t numInternalEvents_{0};
   size_t numSendEvents_{0};
@@ -26,8 +26,17 @@
 namespace folly {
 
 IoUringProvidedBufferRing::ProvidedBuffersBuffer::ProvidedBuffersBuffer(
-    size_t count, int bufferShift, int ringCountShift, bool huge_pages)
-    : bufferShift_(bufferShift), bufferCount_(count) {
+    size_t count,
+    int bufferShift,
+    int ringCountShift,
+    bool huge_pages,
+    size_t maxCount,
+    HugePageBufferArena* arena)
+    : bufferShift_(bufferShift),
+      bufferCount_(count),
+      chunkCount_(count),
+      hugePages_(huge_pages),
+      arena_(arena) {
   // space for the ring
   int ringCount = 1 << ringCountShift;
   ringMask_ = ringCount - 1;
@@ -52,15 +61,9 @@ IoUringProvidedBufferRing::ProvidedBuffersBuffer::ProvidedBuffersBuffer(
     pages = allSize_ / kPageSizeBytes;
   }
 
-  buffer_ = ::mmap(
-      nullptr,
-      allSize_,
-      PROT_READ | PROT_WRITE,
-      MAP_ANONYMOUS | MAP_PRIVATE,
-      -1,
-      0);
+  buffer_ = allocate(allSize_);
 
-  if (buffer_ == MAP_FAILED) {
+  if (buffer_ == nullptr) {
     auto errnoCopy = errno;
     throw std::runtime_error(folly::to<std::string>(
         "unable to allocate pages of size ",
@@ -68,18 +71,77 @@ IoUringProvidedBufferRing::ProvidedBuffersBuffer::ProvidedBuffersBuffer(
         " pages=",
         pages,
         ": ",
-        folly::errnoStr(errnoCopy)));
+        arena_ ? std::string("arena exhausted") : folly::errnoStr(errnoCopy)));
   }
 
   bufferBuffer_ = ((char*)buffer_) + ringMemSize_;
   ringPtr_ = (struct io_uring_buf_ring*)buffer_;
 
-  if (huge_pages) {
-    int ret = ::madvise(buffer_, allSize_, MADV_HUGEPAGE);
+  chunkAllocSize_ = align_ceil(
+      bufferSize_, huge_pages ? kHugePageSizeBytes : kPageSizeBytes);
+  if (count > 0 && maxCount > count) {
+    maxGrownChunks_ = (maxCount - count) / count;
+    grownChunks_ = std::make_unique<char*[]>(maxGrownChunks_);
+  }
+}
+
+IoUringProvidedBufferRing::ProvidedBuffersBuffer::~ProvidedBuffersBuffer() {
+  for (size_t i = 0; i < numGrownChunks_; i++) {
+    deallocate(grownChunks_[i], chunkAllocSize_);
+  }
+  deallocate(buffer_, allSize_);
+}
+
+void* IoUringProvidedBufferRing::ProvidedBuffersBuffer::allocate(
+    size_t size) noexcept {
+  if (arena_ != nullptr) {
+    return arena_->allocateRegion(size);
+  }
+  void* p = ::mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_ANONYMOUS | MAP_PRIVATE,
+      -1,
+      0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  if (hugePages_) {
+    int ret = ::madvise(p, size, MADV_HUGEPAGE);
     PLOG_IF(ERROR, ret) << "cannot enable huge pages";
   } else {
-    ::madvise(buffer_, allSize_, MADV_NOHUGEPAGE);
+    ::madvise(p, size, MADV_NOHUGEPAGE);
+  }
+  return p;
+}
+
+void IoUringProvidedBufferRing::ProvidedBuffersBuffer::deallocate(
+    void* p, size_t size) noexcept {
+  // Arena regions are reclaimed with the arena.
+  if (arena_ == nullptr) {
+    ::munmap(p, size);
+  }
+}
+
+bool IoUringProvidedBufferRing::ProvidedBuffersBuffer::grow() noexcept {
+  if (numGrownChunks_ >= maxGrownChunks_) {
+    return false;
+  }
+  void* chunk = allocate(chunkAllocSize_);
+  if (chunk == nullptr) {
+    if (arena_ != nullptr) {
+      LOG(ERROR) << "unable to grow provided buffer ring by "
+                 << chunkAllocSize_ << " bytes: arena exhausted";
+    } else {
+      PLOG(ERROR) << "unable to grow provided buffer ring by "
+                  << chunkAllocSize_ << " bytes";
+    }
+    return false;
   }
+  grownChunks_[numGrownChunks_++] = static_cast<char*>(chunk);
+  bufferCount_ += chunkCount_;
+  return true;
 }
 
 IoUringProvidedBufferRing::IoUringProvidedBufferRing(
@@ -92,16 +154,23 @@ IoUringProvidedBufferRing::IoUringProvidedBufferRing(
           options.count,
           options.bufferShift,
           options.ringSizeShift,
-          options.useHugePages) {
-  if (options.count > std::numeric_limits<uint16_t>::max()) {
+          options.useHugePages,
+          options.maxCount,
+          options.arena) {
+  size_t const maxCount = std::max(options.count, options.maxCount);
+  if (maxCount > std::numeric_limits<uint16_t>::max()) {
     throw std::runtime_error("too many buffers");
   }
   if (options.count == 0) {
     throw std::runtime_error("not enough buffers");
   }
+  if (maxCount > buffer_.ringCount()) {
+    throw std::runtime_error("ring too small for buffer count");
+  }
 
+  // Sized for the maximum count, as this must never reallocate.
   ioBufCallbacks_.assign(
-      (options.count + (sizeof(void*) - 1)) / sizeof(void*), this);
+      (maxCount + (sizeof(void*) - 1)) / sizeof(void*), this);
 
   initialRegister();
 
@@ -112,6 +181,12 @@ IoUringProvidedBufferRing::IoUringProvidedBufferRing(
 }
 
 void IoUringProvidedBufferRing::enobuf() noexcept {
+  // Only grow if the ring is really empty: buffers may have been returned
+  // since the kernel ran out, and completions of the same batch may report
+  // ENOBUFS after the ring already grew.
+  if (buffersInRing() == 0 && tryGrow()) {
+    return;
+  }
   {
     // what we want to do is something like
     // if (cachedTail_ != localTail_) {
@@ -125,6 +200,21 @@ void IoUringProvidedBufferRing::enobuf() noexcept {
   VLOG_EVERY_N(1, 500) << "enobuf";
 }
 
+bool IoUringProvidedBufferRing::tryGrow() noexcept {
+  uint32_t const first = buffer_.bufferCount();
+  if (!buffer_.grow()) {
+    return false;
+  }
+  uint32_t const last = buffer_.bufferCount();
+  gottenBuffers_ += last - first;
+  for (uint32_t i = first; i < last; i++) {
+    returnBuffer(i);
+  }
+  VLOG(1) << "grew provided buffer ring " << gid() << " to " << last
+          << " buffers";
+  return true;
+}
+
 void IoUringProvidedBufferRing::unusedBuf(uint16_t i) noexcept {
   gottenBuffers_++;
   returnBuffer(i);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <folly/io/HugePageBufferArena.h>
 #include <folly/io/async/IoUringBase.h>
 #include <folly/io/async/Liburing.h>
 #include <folly/portability/SysMman.h>
@@ -39,6 +40,14 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
     int bufferShift{0};
     int ringSizeShift{0};
     bool useHugePages{false};
+    // If larger than count, the ring grows by count buffers whenever the
+    // kernel runs out of them, up to at most maxCount buffers. The ring must
+    // have room for maxCount entries.
+    size_t maxCount{0};
+    // If set, the ring and its buffers, including grown ones, are carved from
+    // this pre-faulted region, which must outlive the ring, and useHugePages
+    // is ignored.
+    HugePageBufferArena* arena{nullptr};
   };
 
   IoUringProvidedBufferRing(io_uring* ioRingPtr, Options options);
@@ -57,6 +66,13 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
   void initialRegister();
   void returnBufferInShutdown() noexcept;
   void returnBuffer(uint16_t i) noexcept;
+  bool tryGrow() noexcept;
+
+  // Buffers that were published and not handed out by the kernel yet.
+  uint64_t buffersInRing() const noexcept {
+    return buffer_.bufferCount() -
+        (gottenBuffers_ - returnedBuffers_.load(std::memory_order_acquire));
+  }
 
   std::atomic<uint16_t>* sharedTail() {
     return reinterpret_cast<std::atomic<uint16_t>*>(&buffer_.ring()->tail);
@@ -72,8 +88,13 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
   class ProvidedBuffersBuffer {
    public:
     ProvidedBuffersBuffer(
-        size_t count, int bufferShift, int ringCountShift, bool huge_pages);
-    ~ProvidedBuffersBuffer() { ::munmap(buffer_, allSize_); }
+        size_t count,
+        int bufferShift,
+        int ringCountShift,
+        bool huge_pages,
+        size_t maxCount = 0,
+        HugePageBufferArena* arena = nullptr);
+    ~ProvidedBuffersBuffer();
 
     static size_t calcBufferSize(int bufferShift) {
       return 1LLU << std::max<int>(5, bufferShift);
@@ -89,13 +110,27 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
     uint32_t ringCount() const noexcept { return 1 + ringMask_; }
 
     char* buffer(uint16_t idx) {
-      size_t offset = (size_t)idx << bufferShift_;
-      return bufferBuffer_ + offset;
+      if (FOLLY_LIKELY(idx < chunkCount_)) {
+        size_t offset = (size_t)idx << bufferShift_;
+        return bufferBuffer_ + offset;
+      }
+      size_t offset = (size_t)(idx % chunkCount_) << bufferShift_;
+      return grownChunks_[idx / chunkCount_ - 1] + offset;
     }
 
+    // Maps another chunk of chunkCount_ buffers, numbered from the current
+    // bufferCount(). Returns false if the maximum count was reached or the
+    // allocation failed.
+    bool grow() noexcept;
+
     size_t sizePerBuffer() const { return sizePerBuffer_; }
 
    private:
+    // Maps size bytes for the ring or a chunk, or takes them from arena_.
+    // Returns nullptr on failure.
+    void* allocate(size_t size) noexcept;
+    void deallocate(void* p, size_t size) noexcept;
+
     void* buffer_;
     size_t allSize_;
 
@@ -109,6 +144,17 @@ class IoUringProvidedBufferRing : public IoUringBufferProviderBase {
     char* bufferBuffer_;
     uint32_t bufferCount_;
 
+    // Buffers added by grow() live in separate mappings of chunkCount_
+    // buffers each. The array is sized up front as buffer() may be called
+    // concurrently from threads releasing IOBufs.
+    uint32_t chunkCount_;
+    size_t chunkAllocSize_;
+    bool hugePages_;
+    HugePageBufferArena* arena_;
+    std::unique_ptr<char*[]> grownChunks_;
+    size_t numGrownChunks_{0};
+    size_t maxGrownChunks_{0};
+
     static constexpr size_t kHugePageSizeBytes = 1024 * 1024 * 2;
     static constexpr size_t kPageSizeBytes = 4096;
     static constexpr size_t kBufferAlignBytes = 32;
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/IoUringRegisteredBufferPool.h>
+
+#include <mutex>
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <folly/lang/Align.h>
+#include <folly/portability/SysMman.h>
+
+#if FOLLY_HAS_LIBURING
+
+namespace folly {
+
+namespace {
+// IORING_MAX_REG_BUFFERS
+constexpr size_t kMaxBuffers = 1U << 14;
+} // namespace
+
+void IoUringRegisteredBufferPool::Deleter::operator()(
+    IoUringRegisteredBufferPool* base) {
+  if (base) {
+    base->destroy();
+  }
+}
+
+IoUringRegisteredBufferPool::UniquePtr IoUringRegisteredBufferPool::create(
+    Params params) {
+  return IoUringRegisteredBufferPool::UniquePtr(
+      new IoUringRegisteredBufferPool(params));
+}
+
+IoUringRegisteredBufferPool::IoUringRegisteredBufferPool(Params params)
+    : bufferSize_(params.bufferSize), count_(params.count) {
+  if (bufferSize_ == 0 || count_ == 0) {
+    throw std::invalid_argument(
+        "IoUringRegisteredBufferPool needs a buffer size and count");
+  }
+  if (count_ > kMaxBuffers) {
+    throw std::invalid_argument("IoUringRegisteredBufferPool too many buffers");
+  }
+  mapMemory();
+  if (params.ring != nullptr) {
+    initialRegister(params.ring);
+  }
+  free_.reserve(count_);
+  for (size_t i = count_; i > 0; i--) {
+    free_.push_back(static_cast<uint32_t>(i - 1));
+  }
+}
+
+void IoUringRegisteredBufferPool::destroy() noexcept {
+  // The registration goes away with the ring, and buffers that are still in
+  // use remain valid memory until they are returned.
+  std::unique_lock lock{mutex_};
+  DCHECK(free_.size() <= count_);
+  auto remaining = static_cast<uint32_t>(count_ - free_.size());
+  shutdownReferences_ = remaining;
+  wantsShutdown_ = true;
+  lock.unlock();
+  delayedDestroy(remaining);
+}
+
+std::unique_ptr<IOBuf> IoUringRegisteredBufferPool::allocate() noexcept {
+  uint32_t idx;
+  {
+    std::unique_lock lock{mutex_};
+    DCHECK(!wantsShutdown_);
+    if (free_.empty()) {
+      return nullptr;
+    }
+    idx = free_.back();
+    free_.pop_back();
+  }
+
+  auto freeFn = [](void* buf, void* userData) {
+    static_cast<IoUringRegisteredBufferPool*>(userData)->returnBuffer(buf);
+  };
+
+  return IOBuf::takeOwnership(
+      static_cast<char*>(area_) + idx * bufferSize_,
+      bufferSize_,
+      0,
+      freeFn,
+      this);
+}
+
+void IoUringRegisteredBufferPool::mapMemory() {
+  areaSize_ = align_ceil(count_ * bufferSize_, size_t(sysconf(_SC_PAGESIZE)));
+  area_ = ::mmap(
+      nullptr,
+      areaSize_,
+      PROT_READ | PROT_WRITE,
+      MAP_ANONYMOUS | MAP_PRIVATE,
+      -1,
+      0);
+  if (area_ == MAP_FAILED) {
+    throw std::runtime_error(folly::to<std::string>(
+        "IoUringRegisteredBufferPool failed to mmap size ", areaSize_));
+  }
+}
+
+void IoUringRegisteredBufferPool::initialRegister(io_uring* ring) {
+  std::vector<struct iovec> iovs(count_);
+  for (size_t i = 0; i < count_; i++) {
+    iovs[i].iov_base = static_cast<char*>(area_) + i * bufferSize_;
+    iovs[i].iov_len = bufferSize_;
+  }
+  int ret = ::io_uring_register_buffers(ring, iovs.data(), iovs.size());
+  if (ret) {
+    ::munmap(area_, areaSize_);
+    throw std::runtime_error(folly::to<std::string>(
+        "IoUringRegisteredBufferPool failed io_uring_register_buffers: ",
+        folly::errnoStr(-ret)));
+  }
+}
+
+void IoUringRegisteredBufferPool::returnBuffer(void* buf) noexcept {
+  std::unique_lock lock{mutex_};
+  if (FOLLY_UNLIKELY(wantsShutdown_)) {
+    auto refs = --shutdownReferences_;
+    lock.unlock();
+    delayedDestroy(refs);
+    return;
+  }
+  auto offset = static_cast<char*>(buf) - static_cast<char*>(area_);
+  free_.push_back(static_cast<uint32_t>(offset / bufferSize_));
+}
+
+void IoUringRegisteredBufferPool::delayedDestroy(uint32_t refs) noexcept {
+  if (refs == 0) {
+    ::munmap(area_, areaSize_);
+    delete this;
+  }
+}
+
+} // namespace folly
+
+#endif
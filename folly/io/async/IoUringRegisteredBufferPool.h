@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/Liburing.h>
+#include <folly/synchronization/DistributedMutex.h>
+
+#if FOLLY_HAS_LIBURING
+
+#include <liburing.h> // @manual
+
+namespace folly {
+
+/**
+ * A pool of equally sized buffers registered with an io_uring through
+ * IORING_REGISTER_BUFFERS. Reads and writes into registered buffers can use
+ * IORING_OP_READ_FIXED/WRITE_FIXED, which skip pinning the user pages on
+ * every operation.
+ *
+ * Buffers are handed out as IOBufs, which return them to the pool when freed,
+ * from any thread. The pool is only deleted once it was destroyed and all its
+ * buffers were returned.
+ */
+class IoUringRegisteredBufferPool {
+ public:
+  struct Deleter {
+    void operator()(IoUringRegisteredBufferPool* base);
+  };
+
+  struct Params {
+    // If null, the buffers are not registered (for tests).
+    io_uring* ring;
+    size_t bufferSize;
+    size_t count;
+  };
+
+  // Only support heap construction with a custom Deleter. This is to avoid
+  // deleting the object until all buffers have been returned.
+  using UniquePtr = std::unique_ptr<IoUringRegisteredBufferPool, Deleter>;
+  static IoUringRegisteredBufferPool::UniquePtr create(Params params);
+
+  ~IoUringRegisteredBufferPool() = default;
+
+  void destroy() noexcept;
+
+  // Returns an empty IOBuf with a capacity of bufferSize() bytes, or nullptr
+  // if all the buffers are in use.
+  std::unique_ptr<IOBuf> allocate() noexcept;
+
+  // Index of the registered buffer holding all of [buf, buf + len), or -1 if
+  // there is none.
+  int bufferIndex(const void* buf, size_t len) const noexcept {
+    auto p = static_cast<const char*>(buf);
+    auto base = static_cast<const char*>(area_);
+    if (p < base || p >= base + count_ * bufferSize_) {
+      return -1;
+    }
+    size_t idx = static_cast<size_t>(p - base) / bufferSize_;
+    if (len > static_cast<size_t>(base + (idx + 1) * bufferSize_ - p)) {
+      return -1;
+    }
+    return static_cast<int>(idx);
+  }
+
+  size_t bufferSize() const noexcept { return bufferSize_; }
+  size_t count() const noexcept { return count_; }
+
+ private:
+  explicit IoUringRegisteredBufferPool(Params params);
+
+  IoUringRegisteredBufferPool(IoUringRegisteredBufferPool&&) = delete;
+  IoUringRegisteredBufferPool(IoUringRegisteredBufferPool const&) = delete;
+  IoUringRegisteredBufferPool& operator=(IoUringRegisteredBufferPool&&) =
+      delete;
+  IoUringRegisteredBufferPool& operator=(IoUringRegisteredBufferPool const&) =
+      delete;
+
+  void mapMemory();
+  void initialRegister(io_uring* ring);
+
+  void returnBuffer(void* buf) noexcept;
+
+  void delayedDestroy(uint32_t refs) noexcept;
+
+  size_t bufferSize_{0};
+  size_t count_{0};
+  void* area_{nullptr};
+  size_t areaSize_{0};
+
+  folly::DistributedMutex mutex_;
+  std::vector<uint32_t> free_;
+  bool wantsShutdown_{false};
+  uint32_t shutdownReferences_{0};
+};
+
+} // namespace folly
+
+#endif
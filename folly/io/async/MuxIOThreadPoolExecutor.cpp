@@ -16,11 +16,14 @@
 
 #include <folly/io/async/MuxIOThreadPoolExecutor.h>
 
+#include <cmath>
 #include <stdexcept>
 
 #include <fmt/format.h>
+#include <folly/Random.h>
 #include <folly/container/Enumerate.h>
 #include <folly/experimental/io/EpollBackend.h>
+#include <folly/io/async/AsyncTransport.h>
 #include <folly/lang/Align.h>
 #include <folly/synchronization/Latch.h>
 
@@ -35,6 +38,24 @@ ThrottledLifoSem::Options throttledLifoSemOptions(
   return opts;
 }
 
+int64_t steadyNowNs(std::chrono::steady_clock::time_point now) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             now.time_since_epoch())
+      .count();
+}
+
+int64_t decayBusyNs(int64_t busyNs, int64_t elapsedNs, int64_t intervalNs) {
+  if (intervalNs <= 0) {
+    return 0;
+  }
+  if (elapsedNs <= 0) {
+    return busyNs;
+  }
+  return static_cast<int64_t>(
+      static_cast<double>(busyNs) *
+      std::exp(-static_cast<double>(elapsedNs) / intervalNs));
+}
+
 } // namespace
 
 struct MuxIOThreadPoolExecutor::EvbState {
@@ -45,6 +66,30 @@ struct MuxIOThreadPoolExecutor::EvbState {
 
   alignas(cacheline_align_v) std::atomic<size_t> pendingTasks = 0;
 
+  // Load tracking: written by the thread running the loop (and by
+  // maybeMigrate()), read by any thread. The busy time is exponentially
+  // decayed and was last updated at busyUpdatedNs.
+  relaxed_atomic<int64_t> busyNs{0};
+  relaxed_atomic<int64_t> busyUpdatedNs{0};
+  relaxed_atomic<size_t> numRegisteredFds{0};
+
+  void recordLoop(
+      std::chrono::steady_clock::time_point start,
+      std::chrono::steady_clock::time_point end,
+      std::chrono::nanoseconds decayInterval) {
+    const auto endNs = steadyNowNs(end);
+    busyNs = decayBusyNs(busyNs, endNs - busyUpdatedNs, decayInterval.count()) +
+        (endNs - steadyNowNs(start));
+    busyUpdatedNs = endNs;
+#if FOLLY_HAS_EPOLL
+    // The notification queue of the EventBase is registered as a regular
+    // event while the executor holds its keep-alive, do not count it.
+    const auto numFds = static_cast<EpollBackend*>(evb.getBackend())
+                            ->getNumRegisteredFdEvents();
+    numRegisteredFds = numFds > 0 ? numFds - 1 : 0;
+#endif
+  }
+
  private:
   static const EventBase::Options& evbOptions() {
 #if FOLLY_HAS_EPOLL
@@ -170,8 +215,18 @@ void MuxIOThreadPoolExecutor::threadRun(ThreadPtr thread) {
     ioThread->curEvbState = evbState;
     eventBaseManager_->setEventBase(evb, false);
 
+    std::chrono::steady_clock::time_point loopStart;
+    if (options_.loadAwarePlacement) {
+      loopStart = std::chrono::steady_clock::now();
+    }
     auto status = evb->loopWithSuspension();
     CHECK(status != EventBase::LoopStatus::kError);
+    if (options_.loadAwarePlacement) {
+      evbState->recordLoop(
+          loopStart,
+          std::chrono::steady_clock::now(),
+          options_.loadDecayInterval);
+    }
 
     eventBaseManager_->clearEventBase();
     ioThread->curEvbState = nullptr;
@@ -192,7 +247,114 @@ MuxIOThreadPoolExecutor::EvbState& MuxIOThreadPoolExecutor::pickEvbState() {
     return *(*ioThread)->curEvbState;
   }
 
-  return *evbStates_[nextEvb_++ % evbStates_.size()];
+  const size_t n = evbStates_.size();
+  if (!options_.loadAwarePlacement || n == 1) {
+    return *evbStates_[nextEvb_++ % n];
+  }
+
+  // Compare two EventBases picked at random rather than scanning for the
+  // least loaded one: the loads are only refreshed at the end of each loop
+  // run, so a burst of placements would otherwise all go to the same one.
+  const size_t i = folly::Random::rand32(n);
+  const size_t j = (i + 1 + folly::Random::rand32(n - 1)) % n;
+  const auto now = std::chrono::steady_clock::now();
+  auto& a = *evbStates_[i];
+  auto& b = *evbStates_[j];
+  return loadOf(a, now) <= loadOf(b, now) ? a : b;
+}
+
+MuxIOThreadPoolExecutor::EvbState&
+MuxIOThreadPoolExecutor::pickLeastLoadedEvbState(
+    std::chrono::steady_clock::time_point now) {
+  EvbState* ret = nullptr;
+  std::chrono::nanoseconds retLoad;
+  for (const auto& evbState : evbStates_) {
+    auto load = loadOf(*evbState, now);
+    if (ret == nullptr || load < retLoad) {
+      ret = evbState.get();
+      retLoad = load;
+    }
+  }
+  return *ret;
+}
+
+MuxIOThreadPoolExecutor::EvbState* MuxIOThreadPoolExecutor::findEvbState(
+    const EventBase* evb) const {
+  for (const auto& evbState : evbStates_) {
+    if (&evbState->evb == evb) {
+      return evbState.get();
+    }
+  }
+  return nullptr;
+}
+
+std::chrono::nanoseconds MuxIOThreadPoolExecutor::loadOf(
+    const EvbState& evbState, std::chrono::steady_clock::time_point now) const {
+  const auto busy = decayBusyNs(
+      evbState.busyNs,
+      steadyNowNs(now) - evbState.busyUpdatedNs,
+      options_.loadDecayInterval.count());
+  return std::chrono::nanoseconds{busy} +
+      options_.fdLoadWeight *
+      static_cast<int64_t>(evbState.numRegisteredFds.load());
+}
+
+std::vector<MuxIOThreadPoolExecutor::EventBaseLoad>
+MuxIOThreadPoolExecutor::getEventBaseLoads() const {
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<EventBaseLoad> ret;
+  ret.reserve(evbStates_.size());
+  for (const auto& evbState : evbStates_) {
+    const auto busy = decayBusyNs(
+        evbState->busyNs,
+        steadyNowNs(now) - evbState->busyUpdatedNs,
+        options_.loadDecayInterval.count());
+    ret.push_back(
+        {&evbState->evb,
+         std::chrono::nanoseconds{busy},
+         evbState->numRegisteredFds});
+  }
+  return ret;
+}
+
+bool MuxIOThreadPoolExecutor::maybeMigrate(
+    AsyncTransport& transport, Func onMigrated) {
+  if (!options_.loadAwarePlacement) {
+    return false;
+  }
+  auto* from = findEvbState(transport.getEventBase());
+  CHECK(from != nullptr)
+      << "The transport is not attached to an EventBase of this executor";
+  from->evb.dcheckIsInEventBaseThread();
+  if (!transport.isDetachable()) {
+    return false;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  auto& to = pickLeastLoadedEvbState(now);
+  if (&to == from ||
+      static_cast<double>(loadOf(*from, now).count()) <=
+          options_.migrationLoadRatio *
+              static_cast<double>(loadOf(to, now).count())) {
+    return false;
+  }
+
+  transport.detachEventBase();
+  // Account for the move until the next loop runs refresh the counts, so
+  // that consecutive migrations do not all pick the same EventBase.
+  if (from->numRegisteredFds > 0) {
+    from->numRegisteredFds--;
+  }
+  to.numRegisteredFds++;
+  to.evb.runInEventBaseThread([&transport,
+                               evb = &to.evb,
+                               onMigrated = std::move(onMigrated)]() mutable {
+    transport.attachEventBase(evb);
+    if (onMigrated) {
+      onMigrated();
+    }
+  });
+  return true;
 }
 
 size_t MuxIOThreadPoolExecutor::getPendingTaskCountImpl() const {
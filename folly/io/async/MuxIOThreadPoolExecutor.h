@@ -32,6 +32,8 @@
 
 namespace folly {
 
+class AsyncTransport;
+
 /**
  * NOTE: This is highly experimental. Do not use.
  *
@@ -56,6 +58,13 @@ namespace folly {
  * supported either: attempting to set the number of threads to 0 or to a value
  * greater than numEventBases() (either in construction or using
  * setNumThreads()) will throw std::invalid_argument).
+ *
+ * By default, work submitted from outside the pool is assigned to the
+ * EventBases round-robin. With Options::loadAwarePlacement, each EventBase
+ * instead tracks its recent loop busy time and its number of registered fds,
+ * and getEventBase() and add() pick the less loaded of two EventBases chosen
+ * at random. maybeMigrate() can additionally be used to move idle connections
+ * off an EventBase that became a hot spot.
  */
 class MuxIOThreadPoolExecutor : public IOThreadPoolExecutorBase {
  public:
@@ -82,12 +91,54 @@ class MuxIOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       return *this;
     }
 
+    Options& setLoadAwarePlacement(bool b) {
+      loadAwarePlacement = b;
+      return *this;
+    }
+
+    Options& setLoadDecayInterval(std::chrono::nanoseconds d) {
+      loadDecayInterval = d;
+      return *this;
+    }
+
+    Options& setFdLoadWeight(std::chrono::nanoseconds w) {
+      fdLoadWeight = w;
+      return *this;
+    }
+
+    Options& setMigrationLoadRatio(double r) {
+      migrationLoadRatio = r;
+      return *this;
+    }
+
     bool enableThreadIdCollection{false};
     // If 0, the number of EventBases is set to the number of threads.
     size_t numEventBases{0};
     std::chrono::nanoseconds wakeUpInterval{std::chrono::microseconds{100}};
     // Max spin for an idle thread waiting for work before going to sleep.
     std::chrono::nanoseconds idleSpinMax = std::chrono::microseconds{10};
+    // Place the work submitted from outside the pool based on the load of
+    // the EventBases rather than round-robin. This costs two clock reads per
+    // loop run.
+    bool loadAwarePlacement{false};
+    // Time constant of the exponential decay of the busy time, that is how
+    // far back the "recent" busy time of an EventBase looks.
+    std::chrono::nanoseconds loadDecayInterval{std::chrono::seconds{1}};
+    // Busy time each registered fd is worth when comparing EventBases, so
+    // that the connections placed on an EventBase count before they become
+    // active.
+    std::chrono::nanoseconds fdLoadWeight{std::chrono::microseconds{10}};
+    // maybeMigrate() only moves a connection if the load of its EventBase is
+    // more than this many times the load of the least loaded one.
+    double migrationLoadRatio{2.0};
+  };
+
+  struct EventBaseLoad {
+    folly::EventBase* evb;
+    // Busy time decayed over Options::loadDecayInterval.
+    std::chrono::nanoseconds recentBusyTime;
+    // As of the end of the last loop run.
+    size_t numRegisteredFds;
   };
 
   explicit MuxIOThreadPoolExecutor(
@@ -120,6 +171,24 @@ class MuxIOThreadPoolExecutor : public IOThreadPoolExecutorBase {
     return threadIdCollector_.get();
   }
 
+  // Returns the load of each EventBase, in the order of getAllEventBases().
+  // Only tracked if Options::loadAwarePlacement is set.
+  std::vector<EventBaseLoad> getEventBaseLoads() const;
+
+  /**
+   * Moves the transport to the least loaded EventBase if its own is more than
+   * Options::migrationLoadRatio times as loaded, and the transport is idle
+   * (isDetachable()). Must be called in the thread of the transport's
+   * EventBase, which must belong to this executor, and the transport must be
+   * kept alive until it is attached to the new EventBase, after which
+   * onMigrated is called in that EventBase's thread. The transport keeps its
+   * callbacks, but they will be invoked in the new EventBase from then on.
+   *
+   * Returns whether the migration was started; it always returns false
+   * unless Options::loadAwarePlacement is set.
+   */
+  bool maybeMigrate(AsyncTransport& transport, Func onMigrated = nullptr);
+
   void addObserver(std::shared_ptr<Observer> o) override;
   void removeObserver(std::shared_ptr<Observer> o) override;
 
@@ -140,6 +209,11 @@ class MuxIOThreadPoolExecutor : public IOThreadPoolExecutorBase {
   void validateNumThreads(size_t numThreads) override;
   ThreadPtr makeThread() override;
   EvbState& pickEvbState();
+  EvbState& pickLeastLoadedEvbState(std::chrono::steady_clock::time_point now);
+  EvbState* findEvbState(const EventBase* evb) const;
+  std::chrono::nanoseconds loadOf(
+      const EvbState& evbState, std::chrono::steady_clock::time_point now)
+      const;
   void threadRun(ThreadPtr thread) override;
   void stopThreads(size_t n) override;
   size_t getPendingTaskCountImpl() const override final;
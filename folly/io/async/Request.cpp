@@ -216,6 +216,7 @@ RequestContext::State::State(const State& o) {
     p->debugCheckConsistency();
     p->acquireDataRefs();
     setCombined(p);
+    updateHasCallbacks();
   }
 }
 
@@ -256,6 +257,18 @@ RequestContext::State::Combined* RequestContext::State::combined() const {
   return combined_.load(std::memory_order_acquire);
 }
 
+FOLLY_ALWAYS_INLINE
+bool RequestContext::State::hasCallbacks() const {
+  return hasCallbacks_.load(std::memory_order_acquire);
+}
+
+FOLLY_ALWAYS_INLINE
+void RequestContext::State::updateHasCallbacks() {
+  auto c = combined();
+  hasCallbacks_.store(
+      c && c->callbackData_.size() > 0, std::memory_order_release);
+}
+
 FOLLY_ALWAYS_INLINE
 RequestContext::State::Combined* RequestContext::State::ensureCombined() {
   auto c = combined();
@@ -281,9 +294,11 @@ bool RequestContext::State::doSetContextData(
   SetContextDataResult result;
   if (safe) {
     result = doSetContextDataHelper(token, data, behaviour, safe);
+    updateHasCallbacks();
   } else {
     LockGuard lock{*this};
     result = doSetContextDataHelper(token, data, behaviour, safe);
+    updateHasCallbacks();
   }
   if (result.unexpected) {
     FB_LOG_ONCE(WARNING) << "Calling RequestContext::setContextData for "
@@ -506,6 +521,7 @@ void RequestContext::State::clearContextData(const RequestToken& token) {
     DCHECK(erased);
     cur->acquireDataRefs();
     setCombined(cur);
+    updateHasCallbacks();
   } // Unlock mutex_
   DCHECK(data);
   data->releaseRefClearOnly();
@@ -615,8 +631,8 @@ void RequestContext::clearContextData(const RequestToken& val) {
 
   std::shared_ptr<RequestContext> prevCtx;
   RequestContext* curCtx = staticCtx.requestContext.get();
-  bool checkCur = curCtx && curCtx->state_.combined();
-  bool checkNew = newCtx && newCtx->state_.combined();
+  bool checkCur = curCtx && curCtx->state_.hasCallbacks();
+  bool checkNew = newCtx && newCtx->state_.hasCallbacks();
   if (checkCur && checkNew) {
     hazptr_array<2> h = make_hazard_pointer_array<2>();
     auto curc = h[0].protect(curCtx->state_.combined_);
@@ -642,7 +658,7 @@ void RequestContext::clearContextData(const RequestToken& val) {
       }
     }
   } else {
-    if (curCtx) {
+    if (checkCur) {
       curCtx->state_.onUnset();
     }
     prevCtx = std::move(staticCtx.requestContext);
@@ -650,7 +666,9 @@ void RequestContext::clearContextData(const RequestToken& val) {
     if (staticCtx.requestContext) {
       staticCtx.rootId.store(
           staticCtx.requestContext->rootId_, std::memory_order_relaxed);
-      staticCtx.requestContext->state_.onSet();
+      if (checkNew) {
+        staticCtx.requestContext->state_.onSet();
+      }
     } else {
       staticCtx.rootId.store(0, std::memory_order_relaxed);
     }
@@ -434,6 +434,10 @@ class RequestContext {
     // This should never be used directly. Use LockGuard so that thread caches
     // are invalidated at the end of the critical section.
     mutable folly::SharedMutex mutex_; // small exclusive mutex
+    // Whether the current Combined holds any data with callbacks. Lets
+    // setContext() skip protecting and iterating the callback sets when
+    // switching between contexts without callbacks, the common case.
+    std::atomic<bool> hasCallbacks_{false};
 
     State();
     State(const State& o);
@@ -454,6 +458,8 @@ class RequestContext {
     class LockGuard;
 
     Combined* combined() const;
+    bool hasCallbacks() const;
+    void updateHasCallbacks(); // Called by writers after changes
     Combined* ensureCombined(); // Lazy allocation if needed
     void setCombined(Combined* p);
     Combined* expand(Combined* combined);
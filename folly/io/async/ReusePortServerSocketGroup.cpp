@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/ReusePortServerSocketGroup.h>
+
+#include <stdexcept>
+
+#include <folly/ExceptionWrapper.h>
+#include <folly/ScopeGuard.h>
+#include <folly/String.h>
+#include <folly/net/NetOps.h>
+#include <folly/portability/Sockets.h>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
+namespace folly {
+
+namespace {
+
+// Runs fn in the thread of evb and waits for it, rethrowing its exception.
+template <typename Fn>
+void runInEventBaseAndWait(EventBase* evb, Fn&& fn) {
+  exception_wrapper ew;
+  evb->runImmediatelyOrRunInEventBaseThreadAndWait([&] {
+    try {
+      fn();
+    } catch (...) {
+      ew = exception_wrapper(std::current_exception());
+    }
+  });
+  if (ew) {
+    ew.throw_exception();
+  }
+}
+
+} // namespace
+
+ReusePortServerSocketGroup::ReusePortServerSocketGroup(
+    std::vector<EventBase*> eventBases)
+    : eventBases_(std::move(eventBases)) {
+  if (eventBases_.empty()) {
+    throw std::invalid_argument("ReusePortServerSocketGroup needs EventBases");
+  }
+}
+
+ReusePortServerSocketGroup::~ReusePortServerSocketGroup() {
+  stop();
+}
+
+void ReusePortServerSocketGroup::setSteering(
+    Steering steering, std::vector<int> cpus) {
+  if (!sockets_.empty()) {
+    throw std::logic_error("setSteering() called after start()");
+  }
+  if (steering == Steering::IncomingCpu && cpus.size() != eventBases_.size()) {
+    throw std::invalid_argument(
+        "IncomingCpu steering needs one CPU per EventBase");
+  }
+  steering_ = steering;
+  cpus_ = std::move(cpus);
+}
+
+void ReusePortServerSocketGroup::start(
+    const SocketAddress& address,
+    int backlog,
+    AcceptCallbackFactory callbackFactory) {
+  if (!sockets_.empty()) {
+    throw std::logic_error("ReusePortServerSocketGroup already started");
+  }
+#ifndef __linux__
+  if (steering_ != Steering::Hash) {
+    throw std::runtime_error("CPU steering is only supported on Linux");
+  }
+#endif
+
+  auto guard = makeGuard([&] { stop(); });
+  sockets_.resize(eventBases_.size());
+
+  SocketAddress bindAddress = address;
+  for (size_t i = 0; i < eventBases_.size(); ++i) {
+    auto evb = eventBases_[i];
+    runInEventBaseAndWait(evb, [&] {
+      auto socket = AsyncServerSocket::newSocket(evb);
+      sockets_[i] = socket;
+      socket->setReusePortEnabled(true);
+      socket->bind(bindAddress);
+#ifdef SO_INCOMING_CPU
+      if (steering_ == Steering::IncomingCpu) {
+        int cpu = cpus_[i];
+        for (auto fd : socket->getNetworkSockets()) {
+          if (netops::setsockopt(
+                  fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) != 0) {
+            throwSystemError(errno, "failed to set SO_INCOMING_CPU");
+          }
+        }
+      }
+#endif
+      socket->listen(backlog);
+      // A null EventBase makes the socket run the callback inline, in its
+      // own thread, rather than pass the connections through a queue.
+      socket->addAcceptCallback(callbackFactory(evb), nullptr);
+    });
+    if (i == 0 && bindAddress.getPort() == 0) {
+      // The other sockets join the port that the first one picked.
+      bindAddress.setPort(sockets_[0]->getAddress().getPort());
+    }
+  }
+
+  if (steering_ == Steering::CpuBpf) {
+    attachCpuSteering();
+  }
+
+  for (size_t i = 0; i < eventBases_.size(); ++i) {
+    runInEventBaseAndWait(
+        eventBases_[i], [&] { sockets_[i]->startAccepting(); });
+  }
+  guard.dismiss();
+}
+
+void ReusePortServerSocketGroup::attachCpuSteering() {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  // The reuseport group of the sockets picks the socket at index A, which
+  // is the CPU the packet was processed on modulo the number of sockets.
+  sock_filter code[] = {
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0, uint32_t(SKF_AD_OFF + SKF_AD_CPU)},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, uint32_t(sockets_.size())},
+      {BPF_RET | BPF_A, 0, 0, 0},
+  };
+  sock_fprog prog;
+  prog.len = sizeof(code) / sizeof(code[0]);
+  prog.filter = code;
+  // The program applies to the whole group, so attaching it to one socket is
+  // enough. The sockets are indexed in the order they were bound.
+  runInEventBaseAndWait(eventBases_[0], [&] {
+    for (auto fd : sockets_[0]->getNetworkSockets()) {
+      if (netops::setsockopt(
+              fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) !=
+          0) {
+        throwSystemError(errno, "failed to attach the reuseport CPU program");
+      }
+    }
+  });
+#else
+  throw std::runtime_error("SO_ATTACH_REUSEPORT_CBPF is not supported");
+#endif
+}
+
+void ReusePortServerSocketGroup::stop() {
+  for (size_t i = 0; i < sockets_.size(); ++i) {
+    if (sockets_[i]) {
+      // The last reference must go away in the thread of the socket.
+      eventBases_[i]->runImmediatelyOrRunInEventBaseThreadAndWait(
+          [&] { sockets_[i].reset(); });
+    }
+  }
+  sockets_.clear();
+}
+
+SocketAddress ReusePortServerSocketGroup::getAddress() const {
+  if (sockets_.empty() || !sockets_[0]) {
+    throw std::logic_error("ReusePortServerSocketGroup not started");
+  }
+  return sockets_[0]->getAddress();
+}
+
+} // namespace folly
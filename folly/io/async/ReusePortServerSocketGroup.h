@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <folly/Function.h>
+#include <folly/SocketAddress.h>
+#include <folly/io/async/AsyncServerSocket.h>
+#include <folly/io/async/EventBase.h>
+
+namespace folly {
+
+/**
+ * A group of AsyncServerSockets listening on the same address with
+ * SO_REUSEPORT, one per EventBase, typically one per IO thread.
+ *
+ * A single AsyncServerSocket accepts connections in its EventBase thread and
+ * hands them off to the IO threads through notification queues. In a group,
+ * each EventBase instead accepts the connections it serves: the kernel
+ * distributes the connections among the listening sockets, and the accept
+ * callbacks run inline.
+ *
+ * The socket which gets a connection depends on the steering, see Steering.
+ * To keep a connection on the CPU which processed its packets, the EventBase
+ * threads should be pinned to the CPUs that the steering maps them to.
+ *
+ * Example:
+ *   ReusePortServerSocketGroup group(ioEventBases);
+ *   group.setSteering(ReusePortServerSocketGroup::Steering::CpuBpf);
+ *   group.start(SocketAddress("::", 443), 1024, [&](EventBase* evb) {
+ *     return acceptors.at(evb).get();
+ *   });
+ *
+ * The methods are not thread safe, and wait for each EventBase in turn: if
+ * called from one of the EventBase threads, the others must not be waiting
+ * for it. The EventBases must be running their loops, and outlive the group.
+ */
+class ReusePortServerSocketGroup {
+ public:
+  enum class Steering {
+    // The kernel picks a socket by hashing the connection's addresses.
+    Hash,
+    // The incoming CPU (SO_INCOMING_CPU) of the i-th socket is cpus[i]: a
+    // connection goes to a socket whose incoming CPU processed its SYN, if
+    // any. Only supported on Linux.
+    IncomingCpu,
+    // A BPF program picks the socket at index cpu % size(), where cpu is the
+    // CPU which processed the SYN. Only supported on Linux.
+    CpuBpf,
+  };
+
+  using AcceptCallbackFactory =
+      Function<AsyncServerSocket::AcceptCallback*(EventBase*)>;
+
+  explicit ReusePortServerSocketGroup(std::vector<EventBase*> eventBases);
+
+  ReusePortServerSocketGroup(const ReusePortServerSocketGroup&) = delete;
+  ReusePortServerSocketGroup& operator=(const ReusePortServerSocketGroup&) =
+      delete;
+
+  ~ReusePortServerSocketGroup();
+
+  /**
+   * Must be called before start(). cpus is only used with IncomingCpu, and
+   * must then have one CPU per EventBase.
+   */
+  void setSteering(Steering steering, std::vector<int> cpus = {});
+
+  Steering getSteering() const { return steering_; }
+
+  /**
+   * Binds one socket per EventBase to the address, and starts accepting on
+   * each with the callback that callbackFactory returns for its EventBase.
+   * callbackFactory is called in the EventBase thread. If the port is 0, the
+   * first socket picks the port of the group.
+   *
+   * Throws if the sockets can't be bound or the steering can't be set up, in
+   * which case the sockets which were already bound are closed.
+   */
+  void start(
+      const SocketAddress& address,
+      int backlog,
+      AcceptCallbackFactory callbackFactory);
+
+  /**
+   * Stops accepting and closes the sockets. The accept callbacks are then
+   * notified through acceptStopped().
+   */
+  void stop();
+
+  /**
+   * Returns the address the group is bound to. Only valid after start().
+   */
+  SocketAddress getAddress() const;
+
+  size_t size() const { return eventBases_.size(); }
+
+  /**
+   * The sockets, in the order of the EventBases, between start() and stop().
+   * They must only be used in the thread of their EventBase.
+   */
+  const std::vector<std::shared_ptr<AsyncServerSocket>>& getSockets() const {
+    return sockets_;
+  }
+
+ private:
+  void attachCpuSteering();
+
+  const std::vector<EventBase*> eventBases_;
+  Steering steering_{Steering::Hash};
+  std::vector<int> cpus_;
+  std::vector<std::shared_ptr<AsyncServerSocket>> sockets_;
+};
+
+} // namespace folly
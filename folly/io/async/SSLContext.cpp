@@ -23,6 +23,7 @@
 #include <folly/SpinLock.h>
 #include <folly/ssl/OpenSSLTicketHandler.h>
 #include <folly/ssl/PasswordCollector.h>
+#include <folly/ssl/SSLServerSessionCache.h>
 #include <folly/ssl/SSLSessionManager.h>
 #include <folly/system/ThreadId.h>
 
@@ -838,6 +839,19 @@ int SSLContext::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
   SSL_CTX* ctx = SSL_get_SSL_CTX(ssl);
   SSLContext* context = getFromSSLCtx(ctx);
 
+  if (context->serverSessionCache_ && SSL_is_server(ssl)) {
+    int length = i2d_SSL_SESSION(session, nullptr);
+    if (length > 0) {
+      std::string serialized(size_t(length), '\0');
+      auto p = reinterpret_cast<unsigned char*>(&serialized[0]);
+      i2d_SSL_SESSION(session, &p);
+      unsigned int idLength = 0;
+      const unsigned char* id = SSL_SESSION_get_id(session, &idLength);
+      context->serverSessionCache_->add(
+          ByteRange(id, idLength), std::move(serialized));
+    }
+  }
+
   auto& cb = context->sessionLifecycleCallbacks_;
   if (cb != nullptr && cb) {
     SSL_SESSION_up_ref(session);
@@ -856,6 +870,38 @@ int SSLContext::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
   return 1;
 }
 
+SSL_SESSION* SSLContext::getSessionCallback(
+    SSL* ssl, const unsigned char* id, int idLength, int* copy) {
+  *copy = 0;
+  SSLContext* context = getFromSSLCtx(SSL_get_SSL_CTX(ssl));
+  if (!context->serverSessionCache_) {
+    return nullptr;
+  }
+  auto serialized =
+      context->serverSessionCache_->get(ByteRange(id, size_t(idLength)));
+  if (!serialized) {
+    return nullptr;
+  }
+  auto p = reinterpret_cast<const unsigned char*>(serialized->data());
+  return d2i_SSL_SESSION(nullptr, &p, long(serialized->size()));
+}
+
+void SSLContext::removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session) {
+  SSLContext* context = getFromSSLCtx(ctx);
+  if (context && context->serverSessionCache_) {
+    unsigned int idLength = 0;
+    const unsigned char* id = SSL_SESSION_get_id(session, &idLength);
+    context->serverSessionCache_->remove(ByteRange(id, idLength));
+  }
+}
+
+void SSLContext::setServerSessionCache(
+    std::shared_ptr<ssl::SSLServerSessionCache> cache) {
+  serverSessionCache_ = std::move(cache);
+  SSL_CTX_sess_set_get_cb(ctx_, SSLContext::getSessionCallback);
+  SSL_CTX_sess_set_remove_cb(ctx_, SSLContext::removeSessionCallback);
+}
+
 void SSLContext::setSessionLifecycleCallbacks(
     std::unique_ptr<SessionLifecycleCallbacks> cb) {
   sessionLifecycleCallbacks_ = std::move(cb);
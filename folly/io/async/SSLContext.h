@@ -40,6 +40,7 @@ namespace folly {
 class OpenSSLTicketHandler;
 namespace ssl {
 class PasswordCollector;
+class SSLServerSessionCache;
 }
 
 /**
@@ -644,6 +645,20 @@ class SSLContext {
   void setSessionLifecycleCallbacks(
       std::unique_ptr<SessionLifecycleCallbacks> cb);
 
+  /**
+   * Caches the sessions established by this server context, so that clients
+   * can resume them with their session id (TLS 1.2), or with a stateful
+   * ticket (TLS 1.3, if tickets are disabled with SSL_OP_NO_TICKET).
+   *
+   * The cache may be shared by several contexts, e.g. one per thread, which
+   * must then have the same session id context, see setSessionCacheContext().
+   */
+  void setServerSessionCache(std::shared_ptr<ssl::SSLServerSessionCache> cache);
+
+  ssl::SSLServerSessionCache* getServerSessionCache() const {
+    return serverSessionCache_.get();
+  }
+
   /**
    * Set the TLS 1.3 ciphersuites to be used in the SSL handshake, in
    * order of preference.
@@ -684,6 +699,7 @@ class SSLContext {
 
   std::unique_ptr<SSLAcceptRunner> sslAcceptRunner_;
   std::unique_ptr<OpenSSLTicketHandler> ticketHandler_;
+  std::shared_ptr<ssl::SSLServerSessionCache> serverSessionCache_;
 
   struct AdvertisedNextProtocolsItem {
     unsigned char* protocols;
@@ -735,6 +751,9 @@ class SSLContext {
       nullptr};
 
   static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+  static SSL_SESSION* getSessionCallback(
+      SSL* ssl, const unsigned char* id, int idLength, int* copy);
+  static void removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session);
 };
 
 typedef std::shared_ptr<SSLContext> SSLContextPtr;
@@ -22,6 +22,7 @@
 #include <folly/io/async/IoUring.h>
 #include <folly/io/async/Liburing.h>
 #include <folly/portability/Sockets.h>
+#include <folly/portability/SysStat.h>
 
 namespace folly {
 
@@ -57,7 +58,8 @@ void SimpleAsyncIO::init<void>() {}
 SimpleAsyncIO::SimpleAsyncIO(Config cfg)
     : maxRequests_(cfg.maxRequests_),
       completionExecutor_(cfg.completionExecutor_),
-      terminating_(false) {
+      terminating_(false),
+      submitBatching_(cfg.submitBatching_) {
   static bool has_io_uring = has_io_uring_rt();
   if (!has_aio && !has_io_uring) {
     LOG(FATAL) << "neither aio nor io_uring is available";
@@ -84,13 +86,20 @@ SimpleAsyncIO::SimpleAsyncIO(Config cfg)
   }
 
   if (cfg.evb_) {
-    initHandler(cfg.evb_, NetworkSocket::fromFd(asyncIO_->pollFd()));
+    eventBase_ = cfg.evb_;
   } else {
     evb_ = std::make_unique<ScopedEventBaseThread>();
-    initHandler(
-        evb_->getEventBase(), NetworkSocket::fromFd(asyncIO_->pollFd()));
+    eventBase_ = evb_->getEventBase();
   }
+  initHandler(eventBase_, NetworkSocket::fromFd(asyncIO_->pollFd()));
   registerHandler(EventHandler::READ | EventHandler::PERSIST);
+
+  if (cfg.adaptiveQueueDepth_) {
+    auto options = *cfg.adaptiveQueueDepth_;
+    options.maxDepth = std::min(options.maxDepth, maxRequests_);
+    options.minDepth = std::min(options.minDepth, options.maxDepth);
+    depthController_.emplace(options);
+  }
 }
 
 SimpleAsyncIO::~SimpleAsyncIO() {
@@ -144,13 +153,23 @@ void SimpleAsyncIO::putOp(std::unique_ptr<AsyncBaseOp>&& op) {
 }
 
 void SimpleAsyncIO::submitOp(
-    Function<void(AsyncBaseOp*)> preparer, SimpleAsyncIOCompletor completor) {
+    int fd,
+    Function<void(AsyncBaseOp*)> preparer,
+    SimpleAsyncIOCompletor completor) {
   std::unique_ptr<AsyncBaseOp> opHolder = getOp();
   if (!opHolder) {
     completor(-EBUSY);
     return;
   }
 
+  if (submitBatching_) {
+    preparer(opHolder.get());
+    struct stat st;
+    const dev_t device = ::fstat(fd, &st) == 0 ? st.st_dev : 0;
+    enqueueOp({std::move(opHolder), std::move(completor), device});
+    return;
+  }
+
   // Grab a raw pointer to the op before we create the completion lambda,
   // since we move the unique_ptr into the lambda and can no longer access
   // it.
@@ -175,6 +194,142 @@ void SimpleAsyncIO::submitOp(
   asyncIO_->submit(op);
 }
 
+void SimpleAsyncIO::enqueueOp(QueuedOp queued) {
+  const bool scheduleFlush = submitQueue_.withWLock([&](auto& queue) {
+    queue.ops.push_back(std::move(queued));
+    return !std::exchange(queue.flushScheduled, true);
+  });
+  if (scheduleFlush) {
+    // The IO queued by any thread until this runs is submitted together.
+    eventBase_->runInEventBaseThread([this] { flushSubmitQueue(); });
+  }
+}
+
+void SimpleAsyncIO::flushSubmitQueue() {
+  auto ops = submitQueue_.withWLock([](auto& queue) {
+    queue.flushScheduled = false;
+    return std::exchange(queue.ops, {});
+  });
+  for (auto& queued : ops) {
+    waitingOps_.push_back(std::move(queued));
+  }
+  submitWaitingOps();
+}
+
+void SimpleAsyncIO::submitWaitingOps() {
+  const size_t depth =
+      depthController_ ? depthController_->depth() : maxRequests_;
+  const size_t n = std::min(
+      waitingOps_.size(), depth > numInFlight_ ? depth - numInFlight_ : 0);
+  if (n == 0) {
+    return;
+  }
+  // Tells the controller whether this batch was held back by the depth.
+  const bool depthLimited = waitingOps_.size() > n;
+
+  std::vector<QueuedOp> batch(
+      std::make_move_iterator(waitingOps_.begin()),
+      std::make_move_iterator(waitingOps_.begin() + n));
+  waitingOps_.erase(waitingOps_.begin(), waitingOps_.begin() + n);
+  submitBatch_.clear();
+  for (auto& queued : batch) {
+    submitBatch_.push_back(queued.op.get());
+  }
+
+  const auto submitTime = std::chrono::steady_clock::now();
+  size_t submitted = 0;
+  int err = EAGAIN;
+  try {
+    submitted = static_cast<size_t>(asyncIO_->submit(range(submitBatch_)));
+  } catch (const std::system_error& ex) {
+    err = ex.code().value();
+  } catch (const std::exception&) {
+    err = EBUSY;
+  }
+  ++numSubmits_;
+  numOpsSubmitted_ += submitted;
+  numInFlight_ += submitted;
+
+  // Completions are only reaped in this thread, by handlerReady(), so the
+  // callbacks can be set after the submission.
+  for (size_t i = 0; i < submitted; ++i) {
+    auto* op = batch[i].op.get();
+    op->setNotificationCallback(
+        [this, submitTime, depthLimited, queued = std::move(batch[i])](
+            AsyncBaseOp* op_) mutable {
+          CHECK(op_ == queued.op.get());
+          const auto now = std::chrono::steady_clock::now();
+          const std::chrono::nanoseconds latency = now - submitTime;
+          const int rc = op_->result();
+
+          auto& stats = deviceStats_[queued.device];
+          stats.device = queued.device;
+          ++stats.numOps;
+          if (rc < 0) {
+            ++stats.numErrors;
+          } else {
+            stats.numBytes += rc;
+          }
+          stats.totalLatency += latency;
+          stats.maxLatency = std::max(stats.maxLatency, latency);
+          if (depthController_) {
+            depthController_->onComplete(latency, now, depthLimited);
+          }
+          --numInFlight_;
+          submitWaitingOps();
+
+          // NB: as in submitOp(), this must come last.
+          completeQueuedOp(queued, rc);
+        });
+  }
+
+  // The ops that were not submitted are back to INITIALIZED. The next
+  // completion retries them, if there is IO in flight; otherwise nothing
+  // would, so fail them.
+  if (numInFlight_ > 0) {
+    for (size_t i = n; i-- > submitted;) {
+      waitingOps_.push_front(std::move(batch[i]));
+    }
+    return;
+  }
+  for (size_t i = submitted; i < n; ++i) {
+    completeQueuedOp(batch[i], -err);
+  }
+}
+
+void SimpleAsyncIO::completeQueuedOp(QueuedOp& queued, int rc) {
+  completionExecutor_->add(
+      [rc, completor{std::move(queued.completor)}]() mutable {
+        completor(rc);
+      });
+  // NB: the moment we put the op, the destructor might delete the current
+  // instance.
+  putOp(std::move(queued.op));
+}
+
+SimpleAsyncIO::Stats SimpleAsyncIO::getStats() {
+  Stats stats;
+  eventBase_->runImmediatelyOrRunInEventBaseThreadAndWait([&] {
+    if (submitBatching_) {
+      stats.numSubmits = numSubmits_;
+      stats.numOpsSubmitted = numOpsSubmitted_;
+    } else {
+      stats.numSubmits = asyncIO_->totalSubmits();
+      stats.numOpsSubmitted = asyncIO_->totalSubmits();
+    }
+    stats.queueDepth =
+        depthController_ ? depthController_->depth() : maxRequests_;
+    if (depthController_) {
+      stats.minLatency = depthController_->minLatency();
+    }
+    stats.devices.reserve(deviceStats_.size());
+    for (const auto& [_, deviceStats] : deviceStats_) {
+      stats.devices.push_back(deviceStats);
+    }
+  });
+  return stats;
+}
+
 void SimpleAsyncIO::pread(
     int fd,
     void* buf,
@@ -182,6 +337,7 @@ void SimpleAsyncIO::pread(
     off_t start,
     SimpleAsyncIOCompletor completor) {
   submitOp(
+      fd,
       [=](AsyncBaseOp* op) { op->pread(fd, buf, size, start); },
       std::move(completor));
 }
@@ -193,6 +349,7 @@ void SimpleAsyncIO::pwrite(
     off_t start,
     SimpleAsyncIOCompletor completor) {
   submitOp(
+      fd,
       [=](AsyncBaseOp* op) { op->pwrite(fd, buf, size, start); },
       std::move(completor));
 }
@@ -16,13 +16,19 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
+#include <optional>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 
 #include <folly/Synchronized.h>
 #include <folly/coro/Task.h>
 #include <folly/executors/GlobalExecutor.h>
 #include <folly/experimental/io/AsyncBase.h>
 #include <folly/io/async/EventHandler.h>
+#include <folly/io/async/IoQueueDepthController.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
 
 namespace folly {
@@ -70,6 +76,14 @@ namespace folly {
  *        SimpleAsyncIO io(SimpleAsyncIO::Config()
  *            .setMaxRequests(100)
  *            .setMode(SimpleAsyncIO::Mode::IOURING));
+ *
+ * With submit batching, IO is instead queued and submitted from the
+ * EventBase thread, once per loop iteration, with a single submit call for
+ * all the IO queued by all the callers in the meantime. On top of it, an
+ * adaptive queue depth keeps only as much IO in flight as the device serves
+ * without queueing it internally (see IoQueueDepthController); the rest
+ * waits in the queue rather than failing with -EBUSY, as long as the total
+ * stays under maxRequests.
  */
 class SimpleAsyncIO : public EventHandler {
  public:
@@ -113,12 +127,32 @@ class SimpleAsyncIO : public EventHandler {
       evb_ = evb;
       return *this;
     }
+    /// Submit IO from the EventBase thread, in one batch per loop iteration.
+    /// This also collects the per device stats of getStats(), at the cost
+    /// of an fstat() per IO.
+    Config& setSubmitBatching(bool submitBatching) {
+      submitBatching_ = submitBatching;
+      return *this;
+    }
+    /// Adapt the number of IOs in flight to the device latency, up to
+    /// maxRequests. Implies submit batching.
+    Config& setAdaptiveQueueDepth(
+        std::optional<IoQueueDepthController::Options> options =
+            IoQueueDepthController::Options()) {
+      adaptiveQueueDepth_ = std::move(options);
+      if (adaptiveQueueDepth_) {
+        submitBatching_ = true;
+      }
+      return *this;
+    }
 
    private:
     size_t maxRequests_;
     Executor::KeepAlive<> completionExecutor_;
     Mode mode_;
     EventBase* evb_;
+    bool submitBatching_{false};
+    std::optional<IoQueueDepthController::Options> adaptiveQueueDepth_;
 
     friend class SimpleAsyncIO;
   };
@@ -166,6 +200,35 @@ class SimpleAsyncIO : public EventHandler {
       off_t offset,
       SimpleAsyncIOCompletor completor);
 
+  struct DeviceStats {
+    dev_t device{0};
+    uint64_t numOps{0};
+    uint64_t numErrors{0};
+    uint64_t numBytes{0};
+    std::chrono::nanoseconds totalLatency{0};
+    std::chrono::nanoseconds maxLatency{0};
+  };
+
+  struct Stats {
+    // Number of submit calls and of IOs they submitted.
+    uint64_t numSubmits{0};
+    uint64_t numOpsSubmitted{0};
+    // Current limit of IOs in flight, and the latency of the unloaded
+    // device it was derived from (0 without adaptive queue depth).
+    size_t queueDepth{0};
+    std::chrono::nanoseconds minLatency{0};
+    // One entry per device IO was done on, in no particular order. Only
+    // collected with submit batching.
+    std::vector<DeviceStats> devices;
+  };
+
+  /**
+   * Cumulative stats since construction; compute throughput and latency
+   * averages from the difference between two calls. Runs in the EventBase
+   * thread, waiting for it if called from another thread.
+   */
+  Stats getStats();
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Coroutine version of pread().
@@ -195,7 +258,25 @@ class SimpleAsyncIO : public EventHandler {
   void putOp(std::unique_ptr<AsyncBaseOp>&&);
 
   void submitOp(
-      Function<void(AsyncBaseOp*)> preparer, SimpleAsyncIOCompletor completor);
+      int fd,
+      Function<void(AsyncBaseOp*)> preparer,
+      SimpleAsyncIOCompletor completor);
+
+  struct QueuedOp {
+    std::unique_ptr<AsyncBaseOp> op;
+    SimpleAsyncIOCompletor completor;
+    dev_t device;
+  };
+
+  struct SubmitQueue {
+    std::vector<QueuedOp> ops;
+    bool flushScheduled{false};
+  };
+
+  void enqueueOp(QueuedOp queued);
+  void flushSubmitQueue();
+  void submitWaitingOps();
+  void completeQueuedOp(QueuedOp& queued, int rc);
 
   virtual void handlerReady(uint16_t events) noexcept override;
 
@@ -209,6 +290,19 @@ class SimpleAsyncIO : public EventHandler {
   std::unique_ptr<ScopedEventBaseThread> evb_;
   bool terminating_;
   Baton<> drainedBaton_;
+
+  EventBase* eventBase_{nullptr};
+  const bool submitBatching_;
+  Synchronized<SubmitQueue> submitQueue_;
+
+  // Only accessed in the EventBase thread.
+  std::deque<QueuedOp> waitingOps_;
+  std::vector<AsyncBaseOp*> submitBatch_;
+  size_t numInFlight_{0};
+  std::optional<IoQueueDepthController> depthController_;
+  uint64_t numSubmits_{0};
+  uint64_t numOpsSubmitted_{0};
+  std::unordered_map<dev_t, DeviceStats> deviceStats_;
 };
 
 } // namespace folly
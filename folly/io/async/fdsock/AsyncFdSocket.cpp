@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
 #include <limits>
 #include <fmt/core.h>
 
@@ -140,6 +143,12 @@ void AsyncFdSocket::writeChainWithFds(
           withAddr("Buffer was already owned by this socket"));
       return failWrite(__func__, callback, 0, ex);
     }
+
+    // The FDs are keyed on this exact IOBuf, so it must not be merged into
+    // a coalesced write.
+    DestructorGuard dg(this);
+    flushCoalescedWrites();
+    return writeChainNow(callback, std::move(buf), flags);
   }
 
 #endif // !Windows
@@ -412,4 +421,109 @@ SocketFds::SeqNum AsyncFdSocket::injectSocketSeqNumIntoFdsToSend(
 #endif // !Windows
 }
 
+#if !defined(_WIN32)
+
+namespace {
+
+// Owns itself, and deletes itself once every batch it queued has completed.
+class FdsBatchWriter : public AsyncWriter::WriteCallback {
+ public:
+  FdsBatchWriter(
+      AsyncFdSocket* socket,
+      AsyncFdSocket::WriteFdsInBatchesCallback* callback,
+      SocketFds::ToSend fds,
+      size_t maxQueuedBatches)
+      : socket_(socket),
+        callback_(callback),
+        fds_(std::move(fds)),
+        maxQueuedBatches_(std::max<size_t>(maxQueuedBatches, 1)) {}
+
+  void start() noexcept { pump(); }
+
+  void writeSuccess() noexcept override {
+    numFdsWritten_ += queuedBatchSizes_.front();
+    queuedBatchSizes_.pop_front();
+    if (!failed_) {
+      callback_->writeFdsProgress(numFdsWritten_, fds_.size());
+    }
+    pump();
+  }
+
+  void writeErr(size_t, const AsyncSocketException& ex) noexcept override {
+    queuedBatchSizes_.pop_front();
+    if (!failed_) {
+      failed_ = true;
+      callback_->writeFdsErr(numFdsWritten_, ex);
+    }
+    pump();
+  }
+
+ private:
+  // The writes may complete (or fail) inline, in which case the loop that
+  // is already queueing batches carries on.
+  void pump() noexcept {
+    if (pumping_) {
+      return;
+    }
+    pumping_ = true;
+    while (!failed_ && nextFd_ < fds_.size() &&
+           queuedBatchSizes_.size() < maxQueuedBatches_) {
+      const auto first = fds_.begin() + nextFd_;
+      const size_t n = std::min(
+          AsyncFdSocket::kMaxFdsPerSocketMsg, fds_.size() - nextFd_);
+      nextFd_ += n;
+      SocketFds batch{SocketFds::ToSend(
+          std::make_move_iterator(first), std::make_move_iterator(first + n))};
+      socket_->injectSocketSeqNumIntoFdsToSend(&batch);
+      queuedBatchSizes_.push_back(n);
+      socket_->writeChainWithFds(
+          this,
+          IOBuf::wrapBuffer(&AsyncFdSocket::kFdsBatchDataByte, 1),
+          std::move(batch));
+    }
+    pumping_ = false;
+
+    if (queuedBatchSizes_.empty() && (failed_ || nextFd_ == fds_.size())) {
+      if (!failed_) {
+        callback_->writeFdsSuccess(fds_.size());
+      }
+      delete this;
+    }
+  }
+
+  AsyncFdSocket* const socket_;
+  AsyncFdSocket::WriteFdsInBatchesCallback* const callback_;
+  // Sent FDs are moved out into their batch; only the size stays valid.
+  SocketFds::ToSend fds_;
+  const size_t maxQueuedBatches_;
+
+  size_t nextFd_{0};
+  size_t numFdsWritten_{0};
+  // The FD counts of the batches queued on the socket, which complete in
+  // order.
+  std::deque<size_t> queuedBatchSizes_;
+  bool failed_{false};
+  bool pumping_{false};
+};
+
+} // namespace
+
+#endif // !Windows
+
+void AsyncFdSocket::writeFdsInBatches(
+    WriteFdsInBatchesCallback* callback,
+    SocketFds::ToSend fds,
+    size_t maxQueuedBatches) {
+#if defined(_WIN32)
+  AsyncSocketException ex(
+      AsyncSocketException::NOT_SUPPORTED,
+      "AsyncFdSocket cannot send FDs on Windows");
+  callback->writeFdsErr(0, ex);
+#else
+  eventBase_->dcheckIsInEventBaseThread();
+  (new FdsBatchWriter(this, callback, std::move(fds), maxQueuedBatches))
+      ->start();
+#endif // !Windows
+}
+
 } // namespace folly
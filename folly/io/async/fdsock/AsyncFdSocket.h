@@ -40,6 +40,29 @@ class AsyncFdSocket : public AsyncSocket {
  public:
   using UniquePtr = std::unique_ptr<AsyncSocket, Destructor>;
 
+  // Max number of fds in a single `sendmsg` / `recvmsg` message
+  // Defined as SCM_MAX_FD in linux/include/net/scm.h
+  static constexpr size_t kMaxFdsPerSocketMsg{253};
+
+  // The data byte carried by each message of `writeFdsInBatches`.
+  static constexpr char kFdsBatchDataByte{'F'};
+
+  class WriteFdsInBatchesCallback {
+   public:
+    virtual ~WriteFdsInBatchesCallback() = default;
+
+    // Called each time a batch was fully written to the socket.
+    virtual void writeFdsProgress(
+        size_t /* numFdsWritten */, size_t /* numFdsTotal */) noexcept {}
+
+    virtual void writeFdsSuccess(size_t numFdsTotal) noexcept = 0;
+
+    // Called once, with the number of FDs of the batches that were fully
+    // written before the error.  The FDs that were not sent are released.
+    virtual void writeFdsErr(
+        size_t numFdsWritten, const AsyncSocketException& ex) noexcept = 0;
+  };
+
   /**
    * Create a new unconnected AsyncSocket.
    *
@@ -116,6 +139,31 @@ class AsyncFdSocket : public AsyncSocket {
       SocketFds,
       WriteFlags flags = WriteFlags::NONE);
 
+  /**
+   * Sends a large number of FDs, e.g. the listening and accepted sockets
+   * handed over to a new process on restart, without a round-trip through
+   * the caller per message:
+   *  - FDs are packed `kMaxFdsPerSocketMsg` per message, each message
+   *    carrying a single `kFdsBatchDataByte` data byte.
+   *  - Up to `maxQueuedBatches` messages are kept queued on the socket, so
+   *    the next `sendmsg` is ready as soon as the socket is writable.
+   *  - `callback` (which must outlive the transfer) gets a progress report
+   *    per message, then exactly one of `writeFdsSuccess` / `writeFdsErr`.
+   *
+   * The sequence numbers are injected here.  The receiver gets one
+   * `popNextReceivedFds()` group and one data byte per message, in order.
+   *
+   * Linux caps the number of FDs in flight (sent but not yet received) per
+   * user at RLIMIT_NOFILE, unless the sender has CAP_SYS_RESOURCE; beyond
+   * it, writes fail with ETOOMANYREFS.  The receiver has to keep reading.
+   *
+   * Must be called from the EventBase thread.
+   */
+  void writeFdsInBatches(
+      WriteFdsInBatchesCallback* callback,
+      SocketFds::ToSend fds,
+      size_t maxQueuedBatches = 16);
+
   /**
    * This socket will look for file descriptors in the ancillary data (`man
    * cmsg`) of each incoming read.
@@ -223,10 +271,6 @@ class AsyncFdSocket : public AsyncSocket {
     }
 
    private:
-    // Max number of fds in a single `sendmsg` / `recvmsg` message
-    // Defined as SCM_MAX_FD in linux/include/net/scm.h
-    static constexpr size_t kMaxFdsPerSocketMsg{253};
-
     AsyncFdSocket* socket_;
     std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxFdsPerSocketMsg)>
         ancillaryDataCtrlBuffer_;
@@ -378,6 +378,120 @@ INSTANTIATE_TEST_SUITE_P(
           std::get<1>(info.param));
     });
 
+struct WriteFdsInBatchesCallback
+    : public AsyncFdSocket::WriteFdsInBatchesCallback {
+  void writeFdsProgress(size_t numFdsWritten, size_t) noexcept override {
+    progress.push_back(numFdsWritten);
+  }
+
+  void writeFdsSuccess(size_t numFdsTotal) noexcept override {
+    EXPECT_FALSE(done);
+    done = true;
+    numFdsWritten = numFdsTotal;
+  }
+
+  void writeFdsErr(
+      size_t numFdsWritten_, const AsyncSocketException& ex) noexcept override {
+    EXPECT_FALSE(done);
+    done = true;
+    numFdsWritten = numFdsWritten_;
+    exception.emplace(ex);
+  }
+
+  bool done{false};
+  size_t numFdsWritten{0};
+  std::vector<size_t> progress;
+  std::optional<AsyncSocketException> exception;
+};
+
+struct AsyncFdSocketWriteFdsInBatchesTest
+    : public AsyncFdSocketTest,
+      public testing::WithParamInterface<size_t> {};
+
+TEST_P(AsyncFdSocketWriteFdsInBatchesTest, WithNumFds) {
+  const size_t numFds = GetParam();
+  const size_t numBatches =
+      (numFds + AsyncFdSocket::kMaxFdsPerSocketMsg - 1) /
+      AsyncFdSocket::kMaxFdsPerSocketMsg;
+  auto sendFds = makeFdsToSend(numFds);
+
+  WriteFdsInBatchesCallback wfcb;
+  sendSock_.writeFdsInBatches(&wfcb, sendFds, /* maxQueuedBatches */ 2);
+
+  // Each batch arrives as one group of FDs with the next sequence number.
+  size_t numFdsReceived = 0;
+  for (int i = 0; i < 1000 && (!wfcb.done || numFdsReceived < numFds); ++i) {
+    evb_.loopOnce(EVLOOP_NONBLOCK);
+    for (auto fds = recvSock_->popNextReceivedFds(); !fds.empty();
+         fds = recvSock_->popNextReceivedFds()) {
+      const size_t n = std::min(
+          AsyncFdSocket::kMaxFdsPerSocketMsg, numFds - numFdsReceived);
+      checkFdsMatch(
+          SocketFds::ToSend(
+              sendFds.begin() + numFdsReceived,
+              sendFds.begin() + numFdsReceived + n),
+          numFdsReceived,
+          std::move(fds));
+      numFdsReceived += n;
+    }
+  }
+  ASSERT_TRUE(wfcb.done);
+  EXPECT_FALSE(wfcb.exception.has_value());
+  EXPECT_EQ(numFds, wfcb.numFdsWritten);
+  EXPECT_EQ(numFds, numFdsReceived);
+
+  std::vector<size_t> expectedProgress;
+  for (size_t i = 1; i <= numBatches; ++i) {
+    expectedProgress.push_back(
+        std::min(i * AsyncFdSocket::kMaxFdsPerSocketMsg, numFds));
+  }
+  EXPECT_EQ(expectedProgress, wfcb.progress);
+
+  std::string expectedData(numBatches, AsyncFdSocket::kFdsBatchDataByte);
+  rcb_.verifyData(expectedData.data(), expectedData.size());
+  rcb_.clearData();
+  EXPECT_TRUE(recvSock_->popNextReceivedFds().empty()) << "Extra FDs";
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    VaryFdCount,
+    AsyncFdSocketWriteFdsInBatchesTest,
+    testing::Values(0, 1, 253, 254, 1000));
+
+TEST_F(AsyncFdSocketTest, WriteFdsInBatchesError) {
+  sendSock_.shutdownWrite();
+
+  WriteFdsInBatchesCallback wfcb;
+  sendSock_.writeFdsInBatches(&wfcb, makeFdsToSend(300));
+  evb_.loopOnce(EVLOOP_NONBLOCK);
+  ASSERT_TRUE(wfcb.done);
+  ASSERT_TRUE(wfcb.exception.has_value());
+  EXPECT_EQ(0, wfcb.numFdsWritten);
+  EXPECT_TRUE(wfcb.progress.empty());
+}
+
+// The FDs are keyed on the IOBuf being written, which must not be merged
+// into a coalesced write.
+TEST_F(AsyncFdSocketTest, WriteCoalescingKeepsFds) {
+  sendSock_.setWriteCoalescing(4096);
+  char data[] = {'a', 'b'};
+  sendSock_.writeChain(&wcb_, IOBuf::wrapBuffer(&data[0], 1));
+
+  auto sendFds = makeFdsToSend(3);
+  SocketFds fds(sendFds);
+  const auto sendSeqNum = sendSock_.injectSocketSeqNumIntoFdsToSend(&fds);
+  sendSock_.writeChainWithFds(
+      &wcb_, IOBuf::wrapBuffer(&data[1], 1), std::move(fds));
+  evb_.loopOnce();
+  while (rcb_.dataRead() < sizeof(data)) {
+    evb_.loopOnce();
+  }
+
+  rcb_.verifyData(data, sizeof(data));
+  rcb_.clearData();
+  checkFdsMatch(sendFds, sendSeqNum, recvSock_->popNextReceivedFds());
+}
+
 #endif // !Windows
 
 } // namespace folly
@@ -233,6 +233,11 @@ bool OpenSSLUtils::setCustomBioWriteMethod(
   return ret;
 }
 
+bool OpenSSLUtils::setCustomBioCtrlMethod(
+    BIO_METHOD* bioMeth, long (*meth)(BIO*, int, long, void*)) {
+  return BIO_meth_set_ctrl(bioMeth, meth) == 1;
+}
+
 int OpenSSLUtils::getBioShouldRetryWrite(int r) {
   int ret = 0;
 #ifdef OPENSSL_IS_BORINGSSL
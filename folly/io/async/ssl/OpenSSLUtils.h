@@ -148,6 +148,8 @@ class OpenSSLUtils {
       BIO_METHOD* bioMeth, int (*meth)(BIO*, char*, int));
   static bool setCustomBioWriteMethod(
       BIO_METHOD* bioMeth, int (*meth)(BIO*, const char*, int));
+  static bool setCustomBioCtrlMethod(
+      BIO_METHOD* bioMeth, long (*meth)(BIO*, int, long, void*));
   static int getBioShouldRetryWrite(int ret);
   static void setBioAppData(BIO* b, void* ptr);
   static void* getBioAppData(BIO* b);
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/ssl/PrivateKeyOffload.h>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/portability/Fcntl.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/portability/Unistd.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+
+// The async jobs wait on a file descriptor, which is a HANDLE on Windows.
+#if defined(SSL_MODE_ASYNC) && !defined(_WIN32)
+#define FOLLY_SSL_PRIVATE_KEY_OFFLOAD 1
+#else
+#define FOLLY_SSL_PRIVATE_KEY_OFFLOAD 0
+#endif
+
+namespace folly {
+namespace ssl {
+
+#if FOLLY_SSL_PRIVATE_KEY_OFFLOAD
+
+namespace {
+
+// The key of the wait fd of the offloaded operations in the ASYNC_WAIT_CTX.
+const char kWaitKey = 0;
+
+// An offloaded operation. It is shared with the executor, so that it
+// outlives the handshake if the socket is closed while the operation runs.
+struct Operation {
+  std::vector<unsigned char> out;
+  int ret{-1};
+  std::atomic<bool> done{false};
+};
+
+// Runs op on the executor, and pauses the async job of the handshake until
+// it is done. Outside of an async job, runs op inline.
+template <typename Op>
+std::shared_ptr<Operation> runOperation(
+    Executor* executor, size_t outSize, Op op) {
+  auto operation = std::make_shared<Operation>();
+  operation->out.resize(outSize);
+
+  ASYNC_JOB* job = ASYNC_get_current_job();
+  int fds[2];
+  if (executor == nullptr || job == nullptr || fileops::pipe(fds) != 0) {
+    op(*operation);
+    return operation;
+  }
+  // The read end is owned by the waiter, which is the AsyncPipeReader of
+  // AsyncSSLSocket, and the write end by the operation.
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  ASYNC_WAIT_CTX* waitCtx = ASYNC_get_wait_ctx(job);
+  if (!ASYNC_WAIT_CTX_set_wait_fd(
+          waitCtx, &kWaitKey, fds[0], nullptr, nullptr)) {
+    fileops::close(fds[0]);
+    fileops::close(fds[1]);
+    op(*operation);
+    return operation;
+  }
+
+  try {
+    executor->add([operation, op = std::move(op), writeFd = fds[1]]() mutable {
+      op(*operation);
+      // The errors are reported by the handshake, on its own thread.
+      ERR_clear_error();
+      operation->done.store(true, std::memory_order_release);
+      uint8_t byte = 1;
+      if (fileops::write(writeFd, &byte, 1) != 1) {
+        PLOG(ERROR) << "Failed to signal an offloaded private key operation";
+      }
+      fileops::close(writeFd);
+    });
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to offload a private key operation: " << ex.what();
+    ASYNC_WAIT_CTX_clear_fd(waitCtx, &kWaitKey);
+    fileops::close(fds[0]);
+    fileops::close(fds[1]);
+    return operation;
+  }
+
+  // The handshake is resumed when the wait fd is readable, i.e. when the
+  // operation is done, but we can't rely on it.
+  while (!operation->done.load(std::memory_order_acquire)) {
+    ASYNC_pause_job();
+  }
+  ASYNC_WAIT_CTX_clear_fd(waitCtx, &kWaitKey);
+  return operation;
+}
+
+void freeExecutor(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+  delete static_cast<std::shared_ptr<Executor>*>(ptr);
+}
+
+int rsaExecutorIndex() {
+  static const int index =
+      RSA_get_ex_new_index(0, nullptr, nullptr, nullptr, freeExecutor);
+  return index;
+}
+
+int ecExecutorIndex() {
+  static const int index =
+      EC_KEY_get_ex_new_index(0, nullptr, nullptr, nullptr, freeExecutor);
+  return index;
+}
+
+Executor* getExecutor(void* data) {
+  auto executor = static_cast<std::shared_ptr<Executor>*>(data);
+  return executor ? executor->get() : nullptr;
+}
+
+using RsaOp = int (*)(int, const unsigned char*, unsigned char*, RSA*, int);
+
+int runRsaOperation(
+    RsaOp defaultOp,
+    int flen,
+    const unsigned char* from,
+    unsigned char* to,
+    RSA* rsa,
+    int padding) {
+  RSA_up_ref(rsa);
+  auto operation = runOperation(
+      getExecutor(RSA_get_ex_data(rsa, rsaExecutorIndex())),
+      RSA_size(rsa),
+      [defaultOp,
+       in = std::vector<unsigned char>(from, from + flen),
+       key = RsaUniquePtr(rsa),
+       padding](Operation& op) {
+        op.ret = defaultOp(
+            int(in.size()), in.data(), op.out.data(), key.get(), padding);
+      });
+  if (operation->ret > 0) {
+    std::memcpy(to, operation->out.data(), operation->ret);
+  }
+  return operation->ret;
+}
+
+int rsaPrivEnc(
+    int flen, const unsigned char* from, unsigned char* to, RSA* rsa, int pad) {
+  return runRsaOperation(
+      RSA_meth_get_priv_enc(RSA_PKCS1_OpenSSL()), flen, from, to, rsa, pad);
+}
+
+int rsaPrivDec(
+    int flen, const unsigned char* from, unsigned char* to, RSA* rsa, int pad) {
+  return runRsaOperation(
+      RSA_meth_get_priv_dec(RSA_PKCS1_OpenSSL()), flen, from, to, rsa, pad);
+}
+
+using EcSign = int (*)(
+    int,
+    const unsigned char*,
+    int,
+    unsigned char*,
+    unsigned int*,
+    const BIGNUM*,
+    const BIGNUM*,
+    EC_KEY*);
+
+EcSign defaultEcSign() {
+  EcSign sign = nullptr;
+  EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), &sign, nullptr, nullptr);
+  return sign;
+}
+
+int ecSign(
+    int type,
+    const unsigned char* dgst,
+    int dlen,
+    unsigned char* sig,
+    unsigned int* siglen,
+    const BIGNUM* kinv,
+    const BIGNUM* r,
+    EC_KEY* ecKey) {
+  if (kinv != nullptr || r != nullptr) {
+    // Precomputed values, which the handshakes don't use.
+    return defaultEcSign()(type, dgst, dlen, sig, siglen, kinv, r, ecKey);
+  }
+  EC_KEY_up_ref(ecKey);
+  auto operation = runOperation(
+      getExecutor(EC_KEY_get_ex_data(ecKey, ecExecutorIndex())),
+      ECDSA_size(ecKey),
+      [type,
+       in = std::vector<unsigned char>(dgst, dgst + dlen),
+       key = EcKeyUniquePtr(ecKey)](Operation& op) {
+        unsigned int len = 0;
+        op.ret = defaultEcSign()(
+            type,
+            in.data(),
+            int(in.size()),
+            op.out.data(),
+            &len,
+            nullptr,
+            nullptr,
+            key.get());
+        op.out.resize(len);
+      });
+  if (operation->ret == 1) {
+    std::memcpy(sig, operation->out.data(), operation->out.size());
+    *siglen = static_cast<unsigned int>(operation->out.size());
+  }
+  return operation->ret;
+}
+
+// The methods are shared by all the offloaded keys, and never freed.
+RSA_METHOD* rsaMethod() {
+  static RSA_METHOD* const method = [] {
+    RSA_METHOD* m = RSA_meth_dup(RSA_PKCS1_OpenSSL());
+    if (m == nullptr ||
+        RSA_meth_set1_name(m, "folly offloaded RSA method") != 1 ||
+        RSA_meth_set_priv_enc(m, rsaPrivEnc) != 1 ||
+        RSA_meth_set_priv_dec(m, rsaPrivDec) != 1) {
+      throw std::runtime_error("Cannot create the offloaded RSA method");
+    }
+    return m;
+  }();
+  return method;
+}
+
+EC_KEY_METHOD* ecMethod() {
+  static EC_KEY_METHOD* const method = [] {
+    EC_KEY_METHOD* m = EC_KEY_METHOD_new(EC_KEY_OpenSSL());
+    if (m == nullptr) {
+      throw std::runtime_error("Cannot create the offloaded EC method");
+    }
+    decltype(&ECDSA_sign_setup) signSetup = nullptr;
+    ECDSA_SIG* (*signSig)(
+        const unsigned char*, int, const BIGNUM*, const BIGNUM*, EC_KEY*) =
+        nullptr;
+    EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), nullptr, &signSetup, &signSig);
+    EC_KEY_METHOD_set_sign(m, ecSign, signSetup, signSig);
+    return m;
+  }();
+  return method;
+}
+
+// Returns a copy of the key, with the methods which offload its operations.
+EvpPkeyUniquePtr makeOffloadedKey(
+    EVP_PKEY* key, std::shared_ptr<Executor> executor) {
+  auto executorData =
+      std::make_unique<std::shared_ptr<Executor>>(std::move(executor));
+  EvpPkeyUniquePtr offloaded(EVP_PKEY_new());
+  if (!offloaded) {
+    throw std::runtime_error("Cannot allocate the offloaded private key");
+  }
+  switch (EVP_PKEY_base_id(key)) {
+    case EVP_PKEY_RSA: {
+      RsaUniquePtr rsa(EVP_PKEY_get1_RSA(key));
+      RsaUniquePtr copy(rsa ? RSAPrivateKey_dup(rsa.get()) : nullptr);
+      if (!copy || RSA_set_method(copy.get(), rsaMethod()) != 1 ||
+          !RSA_set_ex_data(
+              copy.get(), rsaExecutorIndex(), executorData.get())) {
+        throw std::runtime_error("Cannot copy the RSA private key");
+      }
+      executorData.release();
+      EVP_PKEY_assign_RSA(offloaded.get(), copy.release());
+      break;
+    }
+    case EVP_PKEY_EC: {
+      EcKeyUniquePtr ecKey(EVP_PKEY_get1_EC_KEY(key));
+      EcKeyUniquePtr copy(ecKey ? EC_KEY_dup(ecKey.get()) : nullptr);
+      if (!copy || EC_KEY_set_method(copy.get(), ecMethod()) != 1 ||
+          !EC_KEY_set_ex_data(
+              copy.get(), ecExecutorIndex(), executorData.get())) {
+        throw std::runtime_error("Cannot copy the EC private key");
+      }
+      executorData.release();
+      EVP_PKEY_assign_EC_KEY(offloaded.get(), copy.release());
+      break;
+    }
+    default:
+      throw std::runtime_error(
+          "Private key operations can only be offloaded for RSA and EC keys");
+  }
+  return offloaded;
+}
+
+} // namespace
+
+void offloadPrivateKeyOperations(
+    SSLContext& ctx, std::shared_ptr<folly::Executor> executor) {
+  SSL_CTX* sslCtx = ctx.getSSLCtx();
+  EVP_PKEY* key = SSL_CTX_get0_privatekey(sslCtx);
+  if (key == nullptr) {
+    throw std::runtime_error(
+        "offloadPrivateKeyOperations: the private key must be loaded first");
+  }
+  auto offloaded = makeOffloadedKey(key, std::move(executor));
+  if (SSL_CTX_use_PrivateKey(sslCtx, offloaded.get()) != 1) {
+    throw std::runtime_error(
+        "offloadPrivateKeyOperations: cannot use the offloaded private key");
+  }
+  SSL_CTX_set_mode(sslCtx, SSL_MODE_ASYNC);
+}
+
+#else
+
+void offloadPrivateKeyOperations(
+    SSLContext&, std::shared_ptr<folly::Executor>) {
+  throw std::runtime_error(
+      "offloadPrivateKeyOperations: OpenSSL was built without async support");
+}
+
+#endif
+
+} // namespace ssl
+} // namespace folly
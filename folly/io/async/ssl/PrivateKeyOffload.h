@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <folly/Executor.h>
+#include <folly/io/async/SSLContext.h>
+
+namespace folly {
+namespace ssl {
+
+/**
+ * Runs the private key operations of the handshakes of a server SSLContext
+ * (the RSA or ECDSA signature, or the RSA key exchange decryption) on an
+ * executor, e.g. a CPUThreadPoolExecutor, instead of the IO thread.
+ *
+ * This uses the OpenSSL async jobs (SSL_MODE_ASYNC): the handshake is
+ * paused while the operation runs on the executor, and AsyncSSLSocket
+ * resumes it on its EventBase when the operation is done, so that a burst
+ * of full handshakes doesn't stall the other connections of the thread.
+ * Handshakes which aren't run by an AsyncSSLSocket, e.g. with SSL_accept()
+ * without SSL_MODE_ASYNC, run the operations inline.
+ *
+ * The private key must already be loaded in the context; it is replaced by
+ * a copy which offloads its operations. Only RSA and EC keys are supported.
+ *
+ * Throws std::runtime_error if there is no private key, if the key type
+ * isn't supported, or if OpenSSL was built without async support.
+ */
+void offloadPrivateKeyOperations(
+    SSLContext& ctx, std::shared_ptr<folly::Executor> executor);
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/io/async/AdaptiveReadBufferSizer.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(AdaptiveReadBufferSizerTest, SizeTable) {
+  EXPECT_EQ(16, AdaptiveReadBufferSizer::sizeAt(0));
+  EXPECT_EQ(496, AdaptiveReadBufferSizer::sizeAt(30));
+  EXPECT_EQ(512, AdaptiveReadBufferSizer::sizeAt(31));
+  EXPECT_EQ(1024, AdaptiveReadBufferSizer::sizeAt(32));
+  for (size_t size : {1, 16, 17, 100, 496, 497, 512, 513, 2048, 65536}) {
+    auto index = AdaptiveReadBufferSizer::indexOf(size);
+    EXPECT_GE(AdaptiveReadBufferSizer::sizeAt(index), size);
+    if (index > 0) {
+      EXPECT_LT(AdaptiveReadBufferSizer::sizeAt(index - 1), size);
+    }
+  }
+}
+
+TEST(AdaptiveReadBufferSizerTest, GrowsOnFullReads) {
+  AdaptiveReadBufferSizer sizer;
+  EXPECT_EQ(2048, sizer.nextSize());
+  sizer.record(2048);
+  EXPECT_EQ(32 * 1024, sizer.nextSize());
+  sizer.record(32 * 1024);
+  EXPECT_EQ(64 * 1024, sizer.nextSize());
+  // Capped at the maximum.
+  sizer.record(64 * 1024);
+  EXPECT_EQ(64 * 1024, sizer.nextSize());
+}
+
+TEST(AdaptiveReadBufferSizerTest, ShrinksOnTwoSmallReads) {
+  AdaptiveReadBufferSizer sizer;
+  // A read that fits in the step below does not shrink by itself.
+  sizer.record(100);
+  EXPECT_EQ(2048, sizer.nextSize());
+  // Nor does one that needs the current step in between.
+  sizer.record(1500);
+  EXPECT_EQ(2048, sizer.nextSize());
+  sizer.record(100);
+  EXPECT_EQ(1024, sizer.nextSize());
+  sizer.record(100);
+  sizer.record(100);
+  EXPECT_EQ(512, sizer.nextSize());
+  for (int i = 0; i < 100; ++i) {
+    sizer.record(1);
+  }
+  // Floored at the minimum.
+  EXPECT_EQ(64, sizer.nextSize());
+}
+
+TEST(AdaptiveReadBufferSizerTest, Options) {
+  AdaptiveReadBufferSizer::Options options;
+  options.minimum = 1000;
+  options.initial = 100;
+  options.maximum = 3000;
+  AdaptiveReadBufferSizer sizer(options);
+  EXPECT_EQ(1024, sizer.nextSize());
+  sizer.record(1024);
+  EXPECT_EQ(4096, sizer.nextSize());
+  for (int i = 0; i < 10; ++i) {
+    sizer.record(0);
+  }
+  EXPECT_EQ(1024, sizer.nextSize());
+}
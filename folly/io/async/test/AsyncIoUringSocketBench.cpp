@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares receiving a stream through an AsyncSocket on an epoll EventBase
+// with an AsyncIoUringSocket using multishot recv into provided buffers, with
+// and without growing the buffer ring.
+
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/io/EpollBackend.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncIoUringSocket.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/IoUringBackend.h>
+#include <folly/portability/GFlags.h>
+#include <folly/portability/Sockets.h>
+
+DEFINE_int32(write_size, 64 * 1024, "bytes per write on the sending side");
+DEFINE_int32(buffer_size, 16 * 1024, "size of each provided buffer");
+DEFINE_int32(buffer_count, 64, "initial number of provided buffers");
+
+using namespace folly;
+
+namespace {
+
+constexpr size_t kBytesPerIter = 1024 * 1024;
+
+enum class ReaderType {
+  EPOLL,
+  IO_URING,
+};
+
+class CountingReadCallback : public AsyncTransport::ReadCallback {
+ public:
+  CountingReadCallback(EventBase& evb, size_t expected, bool movable)
+      : evb_(evb), remaining_(expected), movable_(movable) {}
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_.data();
+    *lenReturn = buf_.size();
+  }
+
+  void readDataAvailable(size_t len) noexcept override { consumed(len); }
+
+  bool isBufferMovable() noexcept override { return movable_; }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> data) noexcept override {
+    consumed(data->computeChainDataLength());
+  }
+
+  void readEOF() noexcept override { evb_.terminateLoopSoon(); }
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "read error: " << ex.what();
+  }
+
+  size_t remaining() const { return remaining_; }
+
+ private:
+  void consumed(size_t len) {
+    CHECK_LE(len, remaining_);
+    remaining_ -= len;
+    if (remaining_ == 0) {
+      evb_.terminateLoopSoon();
+    }
+  }
+
+  EventBase& evb_;
+  size_t remaining_;
+  bool movable_;
+  std::vector<char> buf_ = std::vector<char>(64 * 1024);
+};
+
+std::unique_ptr<EventBase> makeEventBase(ReaderType type, size_t growFactor) {
+  if (type == ReaderType::EPOLL) {
+    EpollBackend::Options opts;
+    opts.setNumLoopEvents(256);
+    return std::make_unique<EventBase>(EventBase::Options().setBackendFactory(
+        [opts] { return std::make_unique<EpollBackend>(opts); }));
+  }
+  IoUringBackend::Options opts;
+  opts.setInitialProvidedBuffers(FLAGS_buffer_size, FLAGS_buffer_count)
+      .setMaxProvidedBuffers(growFactor * FLAGS_buffer_count);
+  return std::make_unique<EventBase>(EventBase::Options().setBackendFactory(
+      [opts] { return std::make_unique<IoUringBackend>(opts); }));
+}
+
+void runBM(unsigned iters, ReaderType type, size_t growFactor) {
+  BenchmarkSuspender suspender;
+  std::unique_ptr<EventBase> evb;
+  try {
+    evb = makeEventBase(type, growFactor);
+  } catch (const IoUringBackend::NotAvailable&) {
+    return;
+  }
+
+  NetworkSocket fds[2];
+  CHECK_EQ(netops::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  AsyncTransport::UniquePtr reader;
+  if (type == ReaderType::EPOLL) {
+    reader = AsyncSocket::newSocket(evb.get(), fds[0]);
+  } else {
+    AsyncIoUringSocket::Options options;
+    options.multishotRecv = true;
+    reader = AsyncTransport::UniquePtr(
+        new AsyncIoUringSocket(evb.get(), fds[0], std::move(options)));
+  }
+
+  size_t const total = size_t(iters) * kBytesPerIter;
+  CountingReadCallback cb(*evb, total, type == ReaderType::IO_URING);
+
+  std::thread writer([fd = fds[1], total] {
+    std::vector<char> data(FLAGS_write_size, 'x');
+    for (size_t left = total; left > 0;) {
+      size_t n = std::min(left, data.size());
+      CHECK_EQ(writeFull(fd.toFd(), data.data(), n), ssize_t(n));
+      left -= n;
+    }
+  });
+
+  suspender.dismissing([&] {
+    reader->setReadCB(&cb);
+    evb->loopForever();
+  });
+  CHECK_EQ(cb.remaining(), 0);
+
+  writer.join();
+  reader->setReadCB(nullptr);
+  reader.reset();
+  netops::close(fds[1]);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(runBM, epoll_async_socket, ReaderType::EPOLL, 0)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, io_uring_multishot, ReaderType::IO_URING, 0)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, io_uring_multishot_grow_4x, ReaderType::IO_URING, 4)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, io_uring_multishot_grow_16x, ReaderType::IO_URING, 16)
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -655,6 +655,31 @@ TEST_P(AsyncIoUringSocketTest, FastOpen) {
   }
 }
 
+TEST_P(AsyncIoUringSocketTest, ZeroCopyMinSize) {
+  MAYBE_SKIP();
+  if (!IoUringBackend::kernelSupportsSendZC()) {
+    GTEST_SKIP() << "no send zerocopy support";
+  }
+  auto [e, s, cb] = makeConnected();
+  auto* sock = s->getUnderlyingTransport<folly::AsyncIoUringSocket>();
+  ASSERT_NE(sock, nullptr);
+  s->setZeroCopy(true);
+  sock->setZeroCopyMinSize(4096);
+
+  auto small = IOBuf::copyBuffer("hello");
+  EXPECT_FALSE(sock->canZC(small));
+  std::string big(16384, 'X');
+  auto bigBuf = IOBuf::copyBuffer(big);
+  EXPECT_TRUE(sock->canZC(bigBuf));
+  // Wrapped buffers may be reused once the write callback ran.
+  EXPECT_FALSE(sock->canZC(IOBuf::wrapBuffer(big.data(), big.size())));
+
+  s->writeChain(&nullWriteCallback, std::move(small));
+  EXPECT_EQ("hello", cb->waitFor(5).via(base.get()).getVia(base.get()));
+  s->writeChain(&nullWriteCallback, std::move(bigBuf));
+  EXPECT_EQ(big, cb->waitFor(big.size()).via(base.get()).getVia(base.get()));
+}
+
 class AsyncIoUringSocketTestAll : public AsyncIoUringSocketTest {};
 
 TEST_P(AsyncIoUringSocketTestAll, WriteChain2) {
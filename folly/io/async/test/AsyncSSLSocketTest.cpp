@@ -30,6 +30,8 @@
 
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/async/AsyncPipe.h>
 #include <folly/io/async/AsyncSSLSocket.h>
@@ -39,6 +41,7 @@
 #include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/io/async/ssl/BasicTransportCertificate.h>
 #include <folly/io/async/ssl/OpenSSLTransportCertificate.h>
+#include <folly/io/async/ssl/PrivateKeyOffload.h>
 #include <folly/io/async/test/BlockingSocket.h>
 #include <folly/io/async/test/MockAsyncSocketLegacyObserver.h>
 #include <folly/io/async/test/TFOUtil.h>
@@ -257,6 +260,46 @@ TEST(AsyncSSLSocketTest, ZeroCopy) {
   EXPECT_FALSE(socket->getZeroCopy());
 }
 
+/**
+ * Test writing with kTLS enabled. If the kernel can't encrypt the records,
+ * OpenSSL does, so the data must go through either way.
+ */
+TEST(AsyncSSLSocketTest, KtlsWriteReadClose) {
+  // Start listening on a local port
+  WriteCallbackBase writeCallback;
+  ReadCallback readCallback(&writeCallback);
+  HandshakeCallback handshakeCallback(&readCallback);
+  SSLServerAcceptCallback acceptCallback(&handshakeCallback);
+  TestSSLServer server(&acceptCallback);
+
+  // Set up SSL context.
+  std::shared_ptr<SSLContext> sslContext(new SSLContext());
+  sslContext->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+
+  // connect
+  auto socket =
+      std::make_shared<BlockingSocket>(server.getAddress(), sslContext);
+  socket->getSSLSocket()->setKtlsEnabled(true);
+  socket->open(std::chrono::milliseconds(10000));
+  VLOG(1) << "kTLS TX active: " << socket->getSSLSocket()->isKtlsTxActive();
+
+  // write() and read() back a few times
+  uint8_t buf[128];
+  memset(buf, 'a', sizeof(buf));
+  for (int i = 0; i < 3; ++i) {
+    socket->write(buf, sizeof(buf));
+
+    // read()
+    uint8_t readbuf[128];
+    uint32_t bytesRead = socket->readAll(readbuf, sizeof(readbuf));
+    EXPECT_EQ(bytesRead, 128);
+    EXPECT_EQ(memcmp(buf, readbuf, bytesRead), 0);
+  }
+
+  // close()
+  socket->close();
+}
+
 /**
  * Same as above simple test, but with a large read len to test
  * clamping behavior.
@@ -2288,6 +2331,110 @@ TEST(AsyncSSLSocketTest, OpenSSL110AsyncTestClosedWithCallbackPending) {
   ASYNC_cleanup_thread();
   jobEvbThread.reset();
 }
+
+namespace {
+
+class CountingExecutor : public Executor {
+ public:
+  explicit CountingExecutor(std::shared_ptr<Executor> executor)
+      : executor_(std::move(executor)) {}
+
+  void add(Func func) override {
+    ++count_;
+    executor_->add(std::move(func));
+  }
+
+  std::shared_ptr<Executor> executor_;
+  std::atomic<int> count_{0};
+};
+
+// Sets a self-signed certificate, with a new P-256 key, on the context.
+void useEcCertificate(SSLContext& ctx) {
+  ssl::EcKeyUniquePtr ecKey(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  ASSERT_TRUE(ecKey && EC_KEY_generate_key(ecKey.get()));
+  ssl::EvpPkeyUniquePtr key(EVP_PKEY_new());
+  ASSERT_TRUE(EVP_PKEY_assign_EC_KEY(key.get(), ecKey.release()));
+
+  ssl::X509UniquePtr cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+  X509_set_pubkey(cert.get(), key.get());
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(
+      name,
+      "CN",
+      MBSTRING_ASC,
+      reinterpret_cast<const unsigned char*>("Offload"),
+      -1,
+      -1,
+      0);
+  X509_set_issuer_name(cert.get(), name);
+  ASSERT_TRUE(X509_sign(cert.get(), key.get(), EVP_sha256()));
+
+  ASSERT_EQ(1, SSL_CTX_use_certificate(ctx.getSSLCtx(), cert.get()));
+  ASSERT_EQ(1, SSL_CTX_use_PrivateKey(ctx.getSSLCtx(), key.get()));
+}
+
+void testPrivateKeyOffload(std::shared_ptr<SSLContext> serverCtx) {
+  EventBase eventBase;
+  auto pool = std::make_shared<CPUThreadPoolExecutor>(2);
+  auto executor = std::make_shared<CountingExecutor>(pool);
+  ssl::offloadPrivateKeyOperations(*serverCtx, executor);
+
+  auto clientCtx = std::make_shared<SSLContext>();
+  clientCtx->setVerificationOption(SSLContext::SSLVerifyPeerEnum::NO_VERIFY);
+  clientCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+
+  // Two handshakes, which run their signatures concurrently on the pool.
+  std::vector<std::unique_ptr<SSLHandshakeClient>> clients;
+  std::vector<std::unique_ptr<SSLHandshakeServer>> servers;
+  for (int i = 0; i < 2; ++i) {
+    NetworkSocket fds[2];
+    getfds(fds);
+    AsyncSSLSocket::UniquePtr clientSock(
+        new AsyncSSLSocket(clientCtx, &eventBase, fds[0], false));
+    AsyncSSLSocket::UniquePtr serverSock(
+        new AsyncSSLSocket(serverCtx, &eventBase, fds[1], true));
+    clients.push_back(std::make_unique<SSLHandshakeClient>(
+        std::move(clientSock), false, false));
+    servers.push_back(std::make_unique<SSLHandshakeServer>(
+        std::move(serverSock), false, false));
+  }
+
+  eventBase.loop();
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(servers[i]->handshakeSuccess_);
+    EXPECT_TRUE(clients[i]->handshakeSuccess_);
+  }
+  EXPECT_EQ(2, executor->count_);
+}
+
+} // namespace
+
+TEST(AsyncSSLSocketTest, PrivateKeyOffloadRSA) {
+  auto serverCtx = std::make_shared<SSLContext>();
+  serverCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  serverCtx->loadCertificate(find_resource(kTestCert).c_str());
+  serverCtx->loadPrivateKey(find_resource(kTestKey).c_str());
+  testPrivateKeyOffload(serverCtx);
+}
+
+TEST(AsyncSSLSocketTest, PrivateKeyOffloadEC) {
+  auto serverCtx = std::make_shared<SSLContext>();
+  serverCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  useEcCertificate(*serverCtx);
+  testPrivateKeyOffload(serverCtx);
+}
+
+TEST(AsyncSSLSocketTest, PrivateKeyOffloadWithoutKey) {
+  SSLContext ctx;
+  EXPECT_THROW(
+      ssl::offloadPrivateKeyOperations(ctx, std::make_shared<InlineExecutor>()),
+      std::runtime_error);
+}
 #endif // FOLLY_SANITIZE_ADDRESS
 
 TEST(AsyncSSLSocketTest, LoadCertFromMemory) {
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 
 #include <time.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <thread>
@@ -28,6 +29,7 @@
 #include <folly/Random.h>
 #include <folly/SocketAddress.h>
 #include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/io/SocketOptionMap.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBase.h>
@@ -927,6 +929,80 @@ TEST_P(AsyncSocketConnectTest, ConnectAndReadv) {
   ASSERT_FALSE(socket->isClosedByPeer());
 }
 
+namespace {
+class MovableReadCallback : public AsyncTransport::ReadCallback {
+ public:
+  explicit MovableReadCallback(ReadMode readMode) { setReadMode(readMode); }
+
+  bool isBufferMovable() noexcept override { return true; }
+
+  void getReadBuffer(void**, size_t*) override {
+    FAIL() << "getReadBuffer() should not be called";
+  }
+
+  void readDataAvailable(size_t) noexcept override {
+    ADD_FAILURE() << "readDataAvailable() should not be called";
+  }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> readBuf) noexcept override {
+    capacities.push_back(readBuf->computeChainCapacity());
+    data.append(std::move(readBuf));
+  }
+
+  void readEOF() noexcept override { eof = true; }
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    ADD_FAILURE() << ex.what();
+  }
+
+  IOBufQueue data{IOBufQueue::cacheChainLength()};
+  std::vector<size_t> capacities;
+  bool eof{false};
+};
+} // namespace
+
+TEST(AsyncSocketTest, AdaptiveReadBuffers) {
+  for (auto readMode :
+       {AsyncTransport::ReadCallback::ReadMode::ReadBuffer,
+        AsyncTransport::ReadCallback::ReadMode::ReadVec}) {
+    TestServer server;
+
+    EventBase evb;
+    std::shared_ptr<AsyncSocket> socket =
+        AsyncSocket::newSocket(&evb, server.getAddress(), 30);
+    AdaptiveReadBufferSizer::Options options;
+    options.initial = 1024;
+    options.maximum = 16 * 1024;
+    socket->setAdaptiveReadBuffers(options);
+    EXPECT_TRUE(socket->getAdaptiveReadBuffers());
+    MovableReadCallback rcb(readMode);
+    socket->setReadCB(&rcb);
+
+    std::shared_ptr<BlockingSocket> acceptedSocket = server.accept();
+    std::string data(256 * 1024, 'A');
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = 'A' + i % 26;
+    }
+    acceptedSocket->write(
+        reinterpret_cast<unsigned char*>(data.data()), data.size());
+    acceptedSocket->flush();
+    acceptedSocket->close();
+
+    evb.loop();
+
+    EXPECT_TRUE(rcb.eof);
+    EXPECT_EQ(data, rcb.data.move()->to<std::string>());
+    // The buffers start small, and grow with the reads up to the maximum.
+    ASSERT_GT(rcb.capacities.size(), 1);
+    if (readMode == AsyncTransport::ReadCallback::ReadMode::ReadBuffer) {
+      EXPECT_LT(rcb.capacities.front(), 2048);
+    }
+    EXPECT_GE(
+        *std::max_element(rcb.capacities.begin(), rcb.capacities.end()),
+        options.maximum);
+  }
+}
+
 TEST_P(AsyncSocketConnectTest, ConnectAndZeroCopyRead) {
   TestServer server;
 
@@ -2059,6 +2135,61 @@ TEST(AsyncSocketTest, WriteIOBufCorked) {
   ASSERT_FALSE(socket->isClosedByPeer());
 }
 
+TEST(AsyncSocketTest, WriteIOBufCoalesced) {
+  TestServer server;
+
+  // connect()
+  EventBase evb;
+  std::shared_ptr<AsyncSocket> socket =
+      AsyncSocket::newSocket(&evb, server.getAddress(), 30);
+  evb.loop(); // loop until the socket is connected
+
+  socket->setWriteCoalescing(1024);
+  EXPECT_EQ(1024, socket->getWriteCoalescing());
+
+  std::string expected;
+  WriteCallback wcbs[3];
+  for (size_t i = 0; i < 3; ++i) {
+    std::string data(5 + i, 'a' + i);
+    expected += data;
+    socket->writeChain(&wcbs[i], IOBuf::copyBuffer(data));
+  }
+  // Nothing is written before the end of the loop iteration.
+  for (auto& wcb : wcbs) {
+    EXPECT_EQ(STATE_WAITING, wcb.state);
+  }
+  EXPECT_EQ(expected.size(), socket->getAppBytesBuffered());
+  EXPECT_EQ(0, socket->getRawBytesWritten());
+
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  for (auto& wcb : wcbs) {
+    EXPECT_EQ(STATE_SUCCEEDED, wcb.state);
+  }
+  EXPECT_EQ(0, socket->getAppBytesBuffered());
+  EXPECT_EQ(expected.size(), socket->getRawBytesWritten());
+
+  // Reaching the byte cap flushes right away.
+  socket->setWriteCoalescing(10);
+  WriteCallback wcb1;
+  socket->writeChain(&wcb1, IOBuf::copyBuffer("12345"));
+  EXPECT_EQ(STATE_WAITING, wcb1.state);
+  WriteCallback wcb2;
+  socket->writeChain(&wcb2, IOBuf::copyBuffer("67890"));
+  EXPECT_EQ(STATE_SUCCEEDED, wcb1.state);
+  EXPECT_EQ(STATE_SUCCEEDED, wcb2.state);
+  expected += "1234567890";
+
+  // Writes that are not coalesced, and close(), flush first.
+  socket->writeChain(nullptr, IOBuf::copyBuffer("x"));
+  socket->write(nullptr, "y", 1);
+  socket->writeChain(nullptr, IOBuf::copyBuffer("z"));
+  expected += "xyz";
+  socket->close();
+
+  server.verifyConnection(expected.data(), expected.size());
+  ASSERT_TRUE(socket->isClosedBySelf());
+}
+
 /**
  * Test performing a zero-length write
  */
@@ -1486,3 +1486,106 @@ TEST_F(AsyncUDPSocketTest, TestWritemNontrivialCmsgs) {
 #endif // FOLLY_HAVE_MSG_ERRQUEUE
   socket_->close();
 }
+
+class BatchReadCallback : public AsyncUDPSocket::ReadCallback {
+ public:
+  void getReadBuffer(void**, size_t*) noexcept override {
+    ADD_FAILURE() << "getReadBuffer() called in batch mode";
+  }
+
+  void onDataAvailable(
+      const folly::SocketAddress&,
+      size_t,
+      bool,
+      OnDataAvailableParams) noexcept override {
+    ADD_FAILURE() << "onDataAvailable() called in batch mode";
+  }
+
+  void onDataBatchAvailable(
+      folly::Range<ReceivedDatagram*> datagrams) noexcept override {
+    batchSizes.push_back(datagrams.size());
+    for (auto& datagram : datagrams) {
+      clients.push_back(datagram.client);
+      truncated.push_back(datagram.truncated);
+      received.push_back(std::move(datagram.data));
+    }
+  }
+
+  void onReadError(const folly::AsyncSocketException& ex) noexcept override {
+    ADD_FAILURE() << ex.what();
+  }
+
+  void onReadClosed() noexcept override {}
+
+  std::vector<size_t> batchSizes;
+  std::vector<folly::SocketAddress> clients;
+  std::vector<bool> truncated;
+  std::vector<std::unique_ptr<folly::IOBuf>> received;
+};
+
+TEST_F(AsyncUDPSocketTest, ReadBatch) {
+  constexpr size_t kNumDatagrams = 20;
+  constexpr size_t kMessageSize = 64;
+  socket_->setReadBatch(8, kMessageSize);
+  EXPECT_EQ(8, socket_->getReadBatchSize());
+  BatchReadCallback batchCb;
+  socket_->resumeRead(&batchCb);
+
+  AsyncUDPSocket client(&evb_);
+  client.bind(folly::SocketAddress("127.0.0.1", 0));
+  for (size_t i = 0; i < kNumDatagrams; ++i) {
+    client.write(
+        socket_->address(),
+        folly::IOBuf::copyBuffer(folly::to<std::string>(i)));
+  }
+  // One more, too large to fit in a message buffer.
+  client.write(
+      socket_->address(),
+      folly::IOBuf::copyBuffer(std::string(kMessageSize * 2, 'x')));
+
+  for (int i = 0; i < 100 && batchCb.received.size() <= kNumDatagrams; ++i) {
+    evb_.loopOnce(EVLOOP_NONBLOCK);
+  }
+  ASSERT_EQ(kNumDatagrams + 1, batchCb.received.size());
+  EXPECT_EQ(8, batchCb.batchSizes.front());
+  for (size_t i = 0; i < kNumDatagrams; ++i) {
+    EXPECT_EQ(
+        folly::to<std::string>(i), batchCb.received[i]->moveToFbString());
+    EXPECT_EQ(client.address(), batchCb.clients[i]);
+    EXPECT_FALSE(batchCb.truncated[i]);
+  }
+  EXPECT_EQ(kMessageSize, batchCb.received.back()->length());
+  EXPECT_TRUE(batchCb.truncated.back());
+  socket_->pauseRead();
+}
+
+TEST_F(AsyncUDPSocketTest, ReadBatchDefaultCallback) {
+  // A callback which doesn't handle batches gets a copy of each datagram.
+  socket_->setReadBatch(4, 1500);
+  char buf[1500];
+  EXPECT_CALL(readCb, shouldOnlyNotify()).WillRepeatedly(Return(false));
+  EXPECT_CALL(readCb, getReadBuffer_(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](void** data, size_t* len) {
+        *data = buf;
+        *len = sizeof(buf);
+      }));
+  std::vector<std::string> received;
+  EXPECT_CALL(readCb, onDataAvailable_(_, _, false, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](auto&, size_t len, bool, auto) {
+        received.emplace_back(buf, len);
+      }));
+  socket_->resumeRead(&readCb);
+
+  AsyncUDPSocket client(&evb_);
+  client.bind(folly::SocketAddress("127.0.0.1", 0));
+  for (auto data : {"a", "bb", "ccc"}) {
+    client.write(socket_->address(), folly::IOBuf::copyBuffer(data));
+  }
+  for (int i = 0; i < 100 && received.size() < 3; ++i) {
+    evb_.loopOnce(EVLOOP_NONBLOCK);
+  }
+  EXPECT_EQ((std::vector<std::string>{"a", "bb", "ccc"}), received);
+  socket_->pauseRead();
+}
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <functional>
 #include <utility>
 #include <vector>
@@ -277,3 +278,33 @@ TEST(AtomicNotificationQueueTest, DriveSnapshot) {
   ASSERT_EQ(std::exchange(consumed, 0), 1);
   EXPECT_TRUE(lastRan);
 }
+
+TEST(AtomicNotificationQueueTest, ArmDelay) {
+  vector<int> data;
+  AtomicNotificationQueueConsumer<int> consumer{data};
+  EventBaseAtomicNotificationQueue<int, decltype(consumer)> queue{
+      std::move(consumer)};
+
+  EventBase eventBase;
+  queue.setArmDelay(std::chrono::hours(1));
+  queue.startConsuming(&eventBase);
+
+  // The queue is polled rather than armed after consuming tasks, so
+  // producers don't need to signal the fd.
+  for (int i = 1; i <= 5; ++i) {
+    queue.putMessage(i);
+    while (data.size() < size_t(i)) {
+      eventBase.loopOnce(EVLOOP_NONBLOCK);
+    }
+  }
+  EXPECT_EQ(data, (vector<int>{1, 2, 3, 4, 5}));
+  EXPECT_EQ(queue.getArmCount(), 0);
+
+  // Once the delay elapsed, the queue is armed as soon as it is empty.
+  queue.setArmDelay(std::chrono::microseconds::zero());
+  eventBase.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(queue.getArmCount(), 1);
+  queue.putMessage(6);
+  eventBase.loopOnce();
+  EXPECT_EQ(data.back(), 6);
+}
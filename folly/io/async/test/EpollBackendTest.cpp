@@ -18,8 +18,14 @@
 
 #if FOLLY_HAS_EPOLL
 
+#include <fstream>
+#include <string>
+
+#include <folly/FileUtil.h>
+#include <folly/io/async/EventHandler.h>
 #include <folly/io/async/test/AsyncSignalHandlerTestLib.h>
 #include <folly/io/async/test/EventBaseTestLib.h>
+#include <folly/portability/Sockets.h>
 
 namespace folly {
 namespace test {
@@ -35,6 +41,145 @@ INSTANTIATE_TYPED_TEST_SUITE_P(
 INSTANTIATE_TYPED_TEST_SUITE_P(
     AsyncSignalHandlerTest, AsyncSignalHandlerTest, EpollBackendProvider);
 
+namespace {
+std::unique_ptr<EventBase> makeEventBase(
+    const EpollBackend::Options& options) {
+  return std::make_unique<EventBase>(EventBase::Options().setBackendFactory(
+      [options] { return std::make_unique<EpollBackend>(options); }));
+}
+
+EpollBackend& getBackend(EventBase& evb) {
+  return dynamic_cast<EpollBackend&>(*evb.getBackend());
+}
+
+class CountingHandler : public EventHandler {
+ public:
+  CountingHandler(EventBase* evb, int fd)
+      : EventHandler(evb, NetworkSocket::fromFd(fd)) {}
+
+  void handlerReady(uint16_t) noexcept override { ++count; }
+
+  size_t count{0};
+};
+
+struct Pipe {
+  Pipe() { CHECK_EQ(::pipe(fds), 0); }
+  ~Pipe() {
+    fileops::close(fds[0]);
+    fileops::close(fds[1]);
+  }
+  void write() { CHECK_EQ(fileops::write(fds[1], "x", 1), 1); }
+
+  int fds[2];
+};
+
+// The events mask of fd in the epoll set, from /proc/self/fdinfo.
+uint32_t registeredEvents(int epollFd, int fd) {
+  std::ifstream fdinfo("/proc/self/fdinfo/" + std::to_string(epollFd));
+  std::string line;
+  while (std::getline(fdinfo, line)) {
+    int tfd = -1;
+    unsigned events = 0;
+    if (std::sscanf(line.c_str(), "tfd: %d events: %x", &tfd, &events) == 2 &&
+        tfd == fd) {
+      return events;
+    }
+  }
+  return 0;
+}
+} // namespace
+
+TEST(EpollBackendTest, EdgeTriggered) {
+  for (bool edgeTriggered : {false, true}) {
+    auto evb =
+        makeEventBase(EpollBackend::Options().setEdgeTriggered(edgeTriggered));
+    Pipe pipe;
+    CountingHandler handler(evb.get(), pipe.fds[0]);
+    handler.registerHandler(EventHandler::READ | EventHandler::PERSIST);
+    pipe.write();
+
+    // The data is never read: level-triggered events keep firing, an
+    // edge-triggered one only fires again once more data arrives.
+    evb->loopOnce(EVLOOP_NONBLOCK);
+    evb->loopOnce(EVLOOP_NONBLOCK);
+    EXPECT_EQ(edgeTriggered ? 1 : 2, handler.count);
+    pipe.write();
+    evb->loopOnce(EVLOOP_NONBLOCK);
+    EXPECT_EQ(edgeTriggered ? 2 : 3, handler.count);
+
+    EXPECT_EQ(
+        edgeTriggered,
+        (registeredEvents(getBackend(*evb).getEpollFd(), pipe.fds[0]) &
+         EPOLLET) != 0);
+    handler.unregisterHandler();
+  }
+}
+
+TEST(EpollBackendTest, BatchGrowsAndStats) {
+  auto evb = makeEventBase(
+      EpollBackend::Options().setNumLoopEvents(4).setMaxNumLoopEvents(16));
+  auto& backend = getBackend(*evb);
+  EXPECT_EQ(4, backend.getNumLoopEvents());
+
+  std::vector<std::unique_ptr<Pipe>> pipes;
+  std::vector<std::unique_ptr<CountingHandler>> handlers;
+  for (size_t i = 0; i < 20; ++i) {
+    pipes.push_back(std::make_unique<Pipe>());
+    handlers.push_back(
+        std::make_unique<CountingHandler>(evb.get(), pipes.back()->fds[0]));
+    handlers.back()->registerHandler(EventHandler::READ);
+  }
+  // Let the EventBase handle its own events first.
+  evb->loopOnce(EVLOOP_NONBLOCK);
+  for (auto& pipe : pipes) {
+    pipe->write();
+  }
+
+  // Each iteration makes one epoll_wait() call: 4 events fill the batch,
+  // which doubles to 8, filled too, then the last 8 fit in 16.
+  auto before = backend.getStats();
+  for (size_t i = 0; i < 3; ++i) {
+    evb->loopOnce(EVLOOP_NONBLOCK);
+  }
+  for (auto& handler : handlers) {
+    EXPECT_EQ(1, handler->count);
+  }
+  auto stats = backend.getStats();
+  EXPECT_EQ(16, backend.getNumLoopEvents());
+  EXPECT_EQ(before.numWaits + 3, stats.numWaits);
+  EXPECT_EQ(before.numEvents + 20, stats.numEvents);
+  EXPECT_EQ(before.numFullBatches + 2, stats.numFullBatches);
+  EXPECT_EQ(8, stats.maxEventsPerWait);
+}
+
+TEST(EpollBackendTest, ExclusiveListeners) {
+  auto evb =
+      makeEventBase(EpollBackend::Options().setExclusiveListeners(true));
+  int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(listener, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_EQ(::bind(listener, (struct sockaddr*)&addr, sizeof(addr)), 0);
+  ASSERT_EQ(::listen(listener, 16), 0);
+  Pipe pipe;
+
+  CountingHandler listenHandler(evb.get(), listener);
+  listenHandler.registerHandler(EventHandler::READ | EventHandler::PERSIST);
+  CountingHandler pipeHandler(evb.get(), pipe.fds[0]);
+  pipeHandler.registerHandler(EventHandler::READ | EventHandler::PERSIST);
+
+  int epollFd = getBackend(*evb).getEpollFd();
+  EXPECT_NE(0, registeredEvents(epollFd, listener) & EPOLLEXCLUSIVE);
+  EXPECT_EQ(0, registeredEvents(epollFd, pipe.fds[0]) & EPOLLEXCLUSIVE);
+  // Exclusive registrations cannot be modified.
+  EXPECT_FALSE(listenHandler.setEdgeTriggered());
+
+  listenHandler.unregisterHandler();
+  pipeHandler.unregisterHandler();
+  fileops::close(listener);
+}
+
 } // namespace test
 } // namespace folly
 
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Compares the event backends of EventBase on an echo workload: pairs of
+// AsyncSockets on one loop, each client sending a message that its server
+// echoes back, and sending the next one once the echo is in. An iteration is
+// one round trip.
+
+#include <memory>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/experimental/io/EpollBackend.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/IoUringBackend.h>
+#include <folly/portability/GFlags.h>
+#include <folly/portability/Sockets.h>
+
+DEFINE_int32(message_size, 64, "bytes per echoed message");
+
+using namespace folly;
+
+namespace {
+
+enum class BackendType {
+  LIBEVENT,
+  EPOLL,
+  EPOLL_EDGE_TRIGGERED,
+  IO_URING,
+};
+
+std::unique_ptr<EventBase> makeEventBase(BackendType type) {
+  switch (type) {
+    case BackendType::LIBEVENT:
+      return std::make_unique<EventBase>();
+    case BackendType::EPOLL:
+    case BackendType::EPOLL_EDGE_TRIGGERED: {
+      EpollBackend::Options opts;
+      opts.setNumLoopEvents(64)
+          .setMaxNumLoopEvents(1024)
+          .setEdgeTriggered(type == BackendType::EPOLL_EDGE_TRIGGERED);
+      return std::make_unique<EventBase>(EventBase::Options().setBackendFactory(
+          [opts] { return std::make_unique<EpollBackend>(opts); }));
+    }
+    case BackendType::IO_URING: {
+      IoUringBackend::Options opts;
+      opts.setCapacity(1024).setMaxSubmit(256);
+      return std::make_unique<EventBase>(EventBase::Options().setBackendFactory(
+          [opts] { return std::make_unique<IoUringBackend>(opts); }));
+    }
+  }
+  CHECK(false);
+  return nullptr;
+}
+
+// Reads messages of FLAGS_message_size bytes, and calls onMessage() for
+// each.
+class MessageReader : public AsyncTransport::ReadCallback {
+ public:
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_.data();
+    *lenReturn = buf_.size();
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    pending_ += len;
+    while (pending_ >= size_t(FLAGS_message_size)) {
+      pending_ -= FLAGS_message_size;
+      onMessage();
+    }
+  }
+
+  void readEOF() noexcept override {}
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "read error: " << ex.what();
+  }
+
+ protected:
+  virtual void onMessage() noexcept = 0;
+
+ private:
+  size_t pending_{0};
+  std::vector<char> buf_ = std::vector<char>(16 * 1024);
+};
+
+class EchoServer : public MessageReader {
+ public:
+  explicit EchoServer(AsyncSocket::UniquePtr socket)
+      : socket_(std::move(socket)) {
+    socket_->setReadCB(this);
+  }
+
+  ~EchoServer() override { socket_->setReadCB(nullptr); }
+
+ private:
+  void onMessage() noexcept override {
+    socket_->write(nullptr, message_.data(), message_.size());
+  }
+
+  AsyncSocket::UniquePtr socket_;
+  std::vector<char> message_ = std::vector<char>(FLAGS_message_size, 'e');
+};
+
+class EchoClient : public MessageReader {
+ public:
+  EchoClient(AsyncSocket::UniquePtr socket, size_t& remaining, size_t& active)
+      : socket_(std::move(socket)), remaining_(remaining), active_(active) {
+    socket_->setReadCB(this);
+  }
+
+  ~EchoClient() override { socket_->setReadCB(nullptr); }
+
+  // Sends the next message, if any is left, and returns whether it did.
+  bool send() {
+    if (remaining_ == 0) {
+      return false;
+    }
+    --remaining_;
+    socket_->write(nullptr, message_.data(), message_.size());
+    return true;
+  }
+
+ private:
+  void onMessage() noexcept override {
+    if (!send() && --active_ == 0) {
+      socket_->getEventBase()->terminateLoopSoon();
+    }
+  }
+
+  AsyncSocket::UniquePtr socket_;
+  size_t& remaining_;
+  size_t& active_;
+  std::vector<char> message_ = std::vector<char>(FLAGS_message_size, 'c');
+};
+
+void runBM(unsigned iters, BackendType type, size_t numConnections) {
+  BenchmarkSuspender suspender;
+  std::unique_ptr<EventBase> evb;
+  try {
+    evb = makeEventBase(type);
+  } catch (const IoUringBackend::NotAvailable&) {
+    return;
+  }
+
+  size_t remaining = iters;
+  size_t active = numConnections;
+  std::vector<std::unique_ptr<EchoServer>> servers;
+  std::vector<std::unique_ptr<EchoClient>> clients;
+  for (size_t i = 0; i < numConnections; ++i) {
+    NetworkSocket fds[2];
+    CHECK_EQ(netops::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    servers.push_back(std::make_unique<EchoServer>(
+        AsyncSocket::newSocket(evb.get(), fds[0])));
+    clients.push_back(std::make_unique<EchoClient>(
+        AsyncSocket::newSocket(evb.get(), fds[1]), remaining, active));
+  }
+
+  suspender.dismissing([&] {
+    for (auto& client : clients) {
+      if (!client->send()) {
+        --active;
+      }
+    }
+    if (active > 0) {
+      evb->loopForever();
+    }
+  });
+
+  clients.clear();
+  servers.clear();
+}
+
+} // namespace
+
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(runBM, libevent_1_conn, BackendType::LIBEVENT, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(runBM, epoll_1_conn, BackendType::EPOLL, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, epoll_et_1_conn, BackendType::EPOLL_EDGE_TRIGGERED, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(runBM, io_uring_1_conn, BackendType::IO_URING, 1)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(runBM, libevent_100_conns, BackendType::LIBEVENT, 100)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, epoll_100_conns, BackendType::EPOLL, 100)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, epoll_et_100_conns, BackendType::EPOLL_EDGE_TRIGGERED, 100)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    runBM, io_uring_100_conns, BackendType::IO_URING, 100)
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <thread>
+
 #include <folly/Benchmark.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/portability/GFlags.h>
@@ -57,6 +59,35 @@ BENCHMARK_RELATIVE(timeMeasurementsOff, n) {
   }
 }
 
+// Round trips of runInEventBaseThreadAndWait() to a looping EventBase. Needs
+// at least two cores to be meaningful when busy-polling.
+void crossThreadRoundTrips(
+    size_t n, std::chrono::microseconds busyPollBudget) {
+  BenchmarkSuspender suspender;
+  EventBase eventBase(EventBase::Options().setBusyPollBudget(busyPollBudget));
+  std::thread loopThread([&] { eventBase.loopForever(); });
+  eventBase.runInEventBaseThreadAndWait([] {});
+  suspender.dismiss();
+
+  while (n--) {
+    eventBase.runInEventBaseThreadAndWait([] {});
+  }
+
+  suspender.rehire();
+  eventBase.terminateLoopSoon();
+  loopThread.join();
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(crossThreadRoundTrip, n) {
+  crossThreadRoundTrips(n, std::chrono::microseconds(0));
+}
+
+BENCHMARK_RELATIVE(crossThreadRoundTripBusyPoll, n) {
+  crossThreadRoundTrips(n, std::chrono::microseconds(100));
+}
+
 /**
  * --bm_min_iters=1000000
  *
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/EventBaseMemoryIdler.h>
+
+#include <chrono>
+
+#include <folly/detail/MemoryIdler.h>
+#include <folly/portability/GTest.h>
+
+using namespace std::chrono_literals;
+using folly::EventBase;
+using folly::EventBaseMemoryIdler;
+using folly::detail::MemoryIdler;
+
+namespace {
+
+class EventBaseMemoryIdlerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    saved_ = MemoryIdler::defaultIdleTimeout.load();
+    MemoryIdler::defaultIdleTimeout.store(10ms);
+  }
+
+  void TearDown() override { MemoryIdler::defaultIdleTimeout.store(saved_); }
+
+ private:
+  std::chrono::steady_clock::duration saved_;
+};
+
+} // namespace
+
+TEST_F(EventBaseMemoryIdlerTest, flushesWhenIdle) {
+  EventBase evb;
+  EventBaseMemoryIdler idler(evb);
+
+  // Arms the timeout, then waits for it.
+  evb.loopOnce();
+  EXPECT_EQ(0, idler.numFlushes());
+  // The loop has been idle since the timeout was armed.
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(1, idler.numFlushes());
+
+  // The loop wakes up before the timeout expires.
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  evb.loopOnce();
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(1, idler.numFlushes());
+
+  evb.loopOnce();
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(2, idler.numFlushes());
+}
+
+TEST_F(EventBaseMemoryIdlerTest, disabled) {
+  MemoryIdler::defaultIdleTimeout.store(
+      std::chrono::steady_clock::duration::max());
+  EventBase evb;
+  EventBaseMemoryIdler idler(evb);
+
+  bool ran = false;
+  evb.runAfterDelay([&] { ran = true; }, 50);
+  // Only the delayed function can wake the loop up.
+  evb.loopOnce();
+  EXPECT_TRUE(ran);
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(0, idler.numFlushes());
+}
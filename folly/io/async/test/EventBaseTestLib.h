@@ -17,6 +17,7 @@
 #include <atomic>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <thread>
 
 #include <folly/Math.h>
@@ -2818,6 +2819,114 @@ TYPED_TEST_P(EventBaseTest, LoopCallbackTimeslice) {
   EXPECT_EQ(numCbsRun[1], expectedNumCbsRun[1]);
 }
 
+TYPED_TEST_P(EventBaseTest, BusyPoll) {
+  const std::chrono::microseconds kBudget{1000};
+  auto evb =
+      this->makeEventBase(EventBase::Options().setBusyPollBudget(kBudget));
+  EXPECT_EQ(evb->getBusyPollBudget(), kBudget);
+
+  // The loop blocks for longer than the budget before the timeout fires, so
+  // the budget shrinks.
+  bool fired = false;
+  evb->tryRunAfterDelay([&] { fired = true; }, 20);
+  evb->loop();
+  EXPECT_TRUE(fired);
+  auto stats = evb->getBusyPollStats();
+  EXPECT_GE(stats.polls, 1);
+  EXPECT_LE(stats.hits, stats.polls);
+  EXPECT_GE(stats.pollTime, kBudget);
+  EXPECT_LT(stats.budget, kBudget);
+
+  // Work from other threads runs whether it arrives while polling or not.
+  std::thread loopThread([&] { evb->loopForever(); });
+  size_t n = 0;
+  for (size_t i = 0; i < 100; ++i) {
+    evb->runInEventBaseThreadAndWait([&] { ++n; });
+    /* sleep override */ std::this_thread::sleep_for(
+        std::chrono::microseconds(i % 4 * 500));
+  }
+  evb->terminateLoopSoon();
+  loopThread.join();
+  EXPECT_EQ(n, 100);
+  auto stats2 = evb->getBusyPollStats();
+  EXPECT_GT(stats2.polls, stats.polls);
+  EXPECT_LE(stats2.hits, stats2.polls);
+  EXPECT_LE(stats2.budget, kBudget);
+
+  evb->setBusyPollBudget(std::chrono::microseconds::zero());
+  EXPECT_EQ(evb->getBusyPollBudget(), std::chrono::microseconds::zero());
+  EXPECT_EQ(evb->getBusyPollStats().budget, std::chrono::microseconds::zero());
+}
+
+TYPED_TEST_P(EventBaseTest, LoopPhaseStats) {
+  using Phase = EventBase::LoopPhase;
+  using std::chrono::milliseconds;
+  auto evb =
+      this->makeEventBase(EventBase::Options().setLoopPhaseHistograms(true));
+  SocketPair sp;
+  TestHandler handler(evb.get(), sp[0]);
+  handler.registerHandler(EventHandler::READ);
+  writeToFD(sp[1], 1);
+
+  auto sleep = [](milliseconds duration) {
+    /* sleep override */ std::this_thread::sleep_for(duration);
+  };
+  evb->runInLoop([&] { sleep(milliseconds(2)); });
+  evb->runInEventBaseThread([&] { sleep(milliseconds(3)); });
+  evb->tryRunAfterDelay([&] { sleep(milliseconds(4)); }, 20);
+  auto start = std::chrono::steady_clock::now();
+  evb->loop();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(handler.log.size(), 1);
+
+  auto stats = evb->getLoopPhaseStats();
+  EXPECT_GE(stats.iterations, 1);
+  EXPECT_GE(stats[Phase::Event].count, 1);
+  EXPECT_GE(stats[Phase::Loop].maxTime, milliseconds(2));
+  EXPECT_GE(stats[Phase::NotificationQueue].maxTime, milliseconds(3));
+  EXPECT_GE(stats[Phase::Timeout].maxTime, milliseconds(4));
+  // The loop waited for the timeout.
+  EXPECT_GE(stats[Phase::Wait].time, milliseconds(10));
+
+  // Nested phases, e.g. the notification queue callbacks run from the
+  // queue's event handler, are not accounted twice.
+  std::chrono::nanoseconds total{0};
+  for (auto& phase : stats.phases) {
+    EXPECT_LE(phase.maxTime, phase.time);
+    total += phase.time;
+    uint64_t histogramCount = 0;
+    for (auto count : phase.histogram) {
+      histogramCount += count;
+    }
+    EXPECT_EQ(histogramCount, phase.count);
+  }
+  EXPECT_LE(total, elapsed);
+  // 4ms is in [2^12, 2^13)us.
+  auto& timeouts = stats[Phase::Timeout].histogram;
+  EXPECT_GE(
+      std::accumulate(timeouts.begin() + 12, timeouts.end(), uint64_t{0}), 1);
+
+  // Without histograms, only the counters are kept.
+  evb->setLoopPhaseHistograms(false);
+  evb->runInLoop([] {});
+  evb->loopOnce();
+  auto stats2 = evb->getLoopPhaseStats();
+  EXPECT_GT(stats2.iterations, stats.iterations);
+  EXPECT_EQ(stats2[Phase::Loop].count, stats[Phase::Loop].count + 1);
+  EXPECT_EQ(stats2[Phase::Loop].histogram, stats[Phase::Loop].histogram);
+
+  // Nothing is accounted if time isn't measured.
+  auto untimed =
+      this->makeEventBase(EventBase::Options().setSkipTimeMeasurement(true));
+  untimed->runInLoop([] {});
+  untimed->loop();
+  auto untimedStats = untimed->getLoopPhaseStats();
+  EXPECT_GE(untimedStats.iterations, 1);
+  for (auto& phase : untimedStats.phases) {
+    EXPECT_EQ(phase.count, 0);
+  }
+}
+
 struct BackendProviderBase {
   static bool isIoUringBackend() { return false; }
 };
@@ -2900,7 +3009,9 @@ REGISTER_TYPED_TEST_SUITE_P(
     InternalExternalCallbackOrderTest,
     PidCheck,
     EventBaseExecutionObserver,
-    LoopCallbackTimeslice);
+    LoopCallbackTimeslice,
+    BusyPoll,
+    LoopPhaseStats);
 
 } // namespace test
 } // namespace folly
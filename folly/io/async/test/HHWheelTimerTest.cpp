@@ -560,6 +560,81 @@ TEST_F(HHWheelTimerTest, NegativeTimeout) {
   T_CHECK_TIMEOUT(start, end, milliseconds(1));
 }
 
+TEST_F(HHWheelTimerTest, Slack) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+
+  t.scheduleTimeout(&t1, milliseconds(20));
+  // The timer already wakes up within the slack of t2, so t2 expires with t1.
+  t.scheduleTimeout(&t2, milliseconds(10), milliseconds(15));
+  ASSERT_GT(t2.getTimeRemaining(), milliseconds(15));
+  // But t3 can't.
+  t.scheduleTimeout(&t3, milliseconds(30), milliseconds(5));
+  ASSERT_GE(t3.getTimeRemaining(), milliseconds(25));
+  ASSERT_LE(t3.getTimeRemaining(), milliseconds(35));
+  ASSERT_EQ(t.count(), 3);
+
+  TimePoint start;
+  eventBase.loop();
+
+  ASSERT_EQ(t1.timestamps.size(), 1);
+  ASSERT_EQ(t2.timestamps.size(), 1);
+  ASSERT_EQ(t3.timestamps.size(), 1);
+  T_CHECK_TIMEOUT(start, t1.timestamps[0], milliseconds(20));
+  T_CHECK_TIMEOUT(start, t2.timestamps[0], milliseconds(20));
+  ASSERT_GE(t3.timestamps[0].getTime() - start.getTime(), milliseconds(30));
+  ASSERT_EQ(t.count(), 0);
+}
+
+TEST_F(HHWheelTimerTest, LazyCancellation) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  t.enableLazyCancellation();
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+  auto t4 = std::make_unique<TestTimeout>();
+
+  // Schedule distant timeouts, beyond the first wheel epoch.
+  t.scheduleTimeout(&t1, milliseconds(300));
+  t.scheduleTimeout(&t2, milliseconds(300));
+  t.scheduleTimeout(&t3, milliseconds(400));
+  t.scheduleTimeout(t4.get(), milliseconds(300));
+  ASSERT_EQ(t.count(), 4);
+
+  t1.cancelTimeout();
+  ASSERT_FALSE(t1.isScheduled());
+  ASSERT_EQ(t.count(), 3);
+  // The callback can be destroyed while still in its slot.
+  t4->cancelTimeout();
+  t4.reset();
+  ASSERT_EQ(t.count(), 2);
+  // Or rescheduled.
+  t2.cancelTimeout();
+  t.scheduleTimeout(&t2, milliseconds(10));
+  ASSERT_EQ(t.count(), 2);
+
+  TimePoint start;
+  eventBase.loop();
+
+  ASSERT_EQ(t1.timestamps.size(), 0);
+  ASSERT_EQ(t2.timestamps.size(), 1);
+  ASSERT_EQ(t3.timestamps.size(), 1);
+  T_CHECK_TIMEOUT(start, t2.timestamps[0], milliseconds(10));
+  ASSERT_GE(t3.timestamps[0].getTime() - start.getTime(), milliseconds(400));
+  ASSERT_EQ(t.count(), 0);
+
+  // Only the timeouts which are still scheduled are cancelled.
+  t.scheduleTimeout(&t1, milliseconds(1000));
+  t.scheduleTimeout(&t2, milliseconds(1000));
+  t1.cancelTimeout();
+  ASSERT_EQ(t.cancelAll(), 1);
+  ASSERT_EQ(t1.canceledTimestamps.size(), 0);
+  ASSERT_EQ(t2.canceledTimestamps.size(), 1);
+  ASSERT_EQ(t.count(), 0);
+}
+
 TEST(HHWheelTimerDetailsTest, Divider) {
   auto no_overflow_add = [](uint64_t& base, int offset) -> bool {
     if (offset >= 0 || static_cast<unsigned int>(-offset) < base) {
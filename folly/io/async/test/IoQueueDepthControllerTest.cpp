@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/io/async/IoQueueDepthController.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace std::chrono_literals;
+
+namespace folly {
+namespace {
+
+using Clock = IoQueueDepthController::Clock;
+
+// Completes a round of depth() IOs of the given latency.
+void runRound(
+    IoQueueDepthController& controller,
+    std::chrono::nanoseconds latency,
+    Clock::time_point& now,
+    bool depthLimited = true) {
+  const size_t n = controller.depth();
+  for (size_t i = 0; i < n; ++i) {
+    now += latency / n;
+    controller.onComplete(latency, now, depthLimited);
+  }
+}
+
+IoQueueDepthController::Options makeOptions(
+    size_t minDepth, size_t initialDepth, size_t maxDepth) {
+  IoQueueDepthController::Options options;
+  options.minDepth = minDepth;
+  options.initialDepth = initialDepth;
+  options.maxDepth = maxDepth;
+  return options;
+}
+
+} // namespace
+
+TEST(IoQueueDepthControllerTest, InitialDepth) {
+  EXPECT_EQ(4, IoQueueDepthController().depth());
+  EXPECT_EQ(8, IoQueueDepthController(makeOptions(8, 4, 16)).depth());
+  EXPECT_EQ(16, IoQueueDepthController(makeOptions(1, 32, 16)).depth());
+  EXPECT_EQ(0, IoQueueDepthController().minLatency().count());
+}
+
+TEST(IoQueueDepthControllerTest, ProbesWhileLatencyIsFlat) {
+  IoQueueDepthController controller(makeOptions(1, 4, 20));
+  auto now = Clock::now();
+  std::vector<size_t> depths;
+  for (int i = 0; i < 8; ++i) {
+    runRound(controller, 100us, now);
+    depths.push_back(controller.depth());
+  }
+  EXPECT_EQ((std::vector<size_t>{5, 6, 7, 8, 10, 12, 15, 18}), depths);
+  EXPECT_EQ(100us, controller.minLatency());
+
+  runRound(controller, 100us, now);
+  runRound(controller, 100us, now);
+  EXPECT_EQ(20, controller.depth());
+}
+
+TEST(IoQueueDepthControllerTest, HoldsWhenNotDepthLimited) {
+  IoQueueDepthController controller;
+  auto now = Clock::now();
+  for (int i = 0; i < 4; ++i) {
+    runRound(controller, 100us, now, /* depthLimited */ false);
+  }
+  EXPECT_EQ(4, controller.depth());
+
+  // A single limited IO in the round is enough.
+  for (size_t i = 0; i < 4; ++i) {
+    controller.onComplete(100us, now, i == 2);
+  }
+  EXPECT_EQ(5, controller.depth());
+}
+
+TEST(IoQueueDepthControllerTest, DrainsOnLatencyInflation) {
+  IoQueueDepthController controller(makeOptions(2, 16, 64));
+  auto now = Clock::now();
+  runRound(controller, 100us, now);
+  EXPECT_EQ(20, controller.depth());
+
+  // Within the tolerance: keep probing.
+  runRound(controller, 140us, now);
+  EXPECT_EQ(25, controller.depth());
+
+  std::vector<size_t> depths;
+  for (int i = 0; i < 8; ++i) {
+    runRound(controller, 200us, now);
+    depths.push_back(controller.depth());
+  }
+  EXPECT_EQ((std::vector<size_t>{19, 15, 12, 9, 7, 6, 5, 4}), depths);
+  EXPECT_EQ(100us, controller.minLatency());
+
+  for (int i = 0; i < 4; ++i) {
+    runRound(controller, 200us, now);
+  }
+  EXPECT_EQ(2, controller.depth());
+}
+
+TEST(IoQueueDepthControllerTest, MinLatencyExpires) {
+  auto options = makeOptions(1, 8, 64);
+  options.minLatencyWindow = 1s;
+  IoQueueDepthController controller(options);
+  auto now = Clock::now();
+  runRound(controller, 100us, now);
+  EXPECT_EQ(10, controller.depth());
+
+  // The device got slower for good: the controller first drains, then
+  // re-measures the minimum and probes again.
+  runRound(controller, 1ms, now);
+  EXPECT_EQ(8, controller.depth());
+  now += 2s;
+  runRound(controller, 1ms, now);
+  EXPECT_EQ(1ms, controller.minLatency());
+  EXPECT_EQ(10, controller.depth());
+}
+
+} // namespace folly
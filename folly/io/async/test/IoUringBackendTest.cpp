@@ -22,6 +22,7 @@
 #include <folly/String.h>
 #include <folly/experimental/io/test/IoTestTempFileUtil.h>
 #include <folly/init/Init.h>
+#include <folly/io/async/AsyncServerSocket.h>
 #include <folly/io/async/AsyncUDPServerSocket.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <folly/io/async/EventHandler.h>
@@ -984,6 +985,75 @@ TEST(IoUringBackend, AsyncUDPRecvmsgMultishotRegisterFd) {
   testAsyncUDPRecvmsg(true, true);
 }
 
+TEST(IoUringBackend, AsyncServerSocketMultishotAccept) {
+  static constexpr int kNumClients = 16;
+  auto evbPtr = getEventBase();
+  SKIP_IF(!evbPtr) << "Backend not available";
+  SKIP_IF(!folly::IoUringBackend::kernelSupportsAcceptMultishot())
+      << "Multishot accept not available";
+
+  struct AcceptCallback : folly::AsyncServerSocket::AcceptCallback {
+    void connectionAccepted(
+        folly::NetworkSocket fd,
+        const folly::SocketAddress& address,
+        AcceptInfo) noexcept override {
+      EXPECT_EQ(AF_INET6, address.getFamily());
+      folly::netops::close(fd);
+      if (++accepted == pauseAt) {
+        // Pausing from the callback must stop the multishot request.
+        serverSocket->pauseAccepting();
+        serverSocket->getEventBase()->terminateLoopSoon();
+      }
+    }
+    void acceptError(folly::exception_wrapper ew) noexcept override {
+      ADD_FAILURE() << ew.what();
+    }
+
+    folly::AsyncServerSocket* serverSocket{nullptr};
+    int accepted{0};
+    int pauseAt{0};
+  } cb;
+
+  auto serverSocket = folly::AsyncServerSocket::newSocket(evbPtr.get());
+  serverSocket->setMultishotAccept(true);
+  serverSocket->bind(folly::SocketAddress("::1", 0));
+  serverSocket->listen(kNumClients * 2);
+  serverSocket->addAcceptCallback(&cb, nullptr);
+  cb.serverSocket = serverSocket.get();
+  auto address = serverSocket->getAddress();
+
+  auto connect = [&](int numClients) {
+    for (int i = 0; i < numClients; ++i) {
+      auto fd = folly::netops::socket(AF_INET6, SOCK_STREAM, 0);
+      sockaddr_storage addr;
+      auto len = address.getAddress(&addr);
+      CHECK_EQ(
+          0,
+          folly::netops::connect(
+              fd, reinterpret_cast<sockaddr*>(&addr), len));
+      folly::netops::close(fd);
+    }
+  };
+
+  connect(kNumClients);
+  cb.pauseAt = kNumClients;
+  serverSocket->startAccepting();
+  evbPtr->loopForever();
+  EXPECT_EQ(kNumClients, cb.accepted);
+
+  // Connections which arrive while paused wait in the backlog.
+  connect(kNumClients);
+  evbPtr->loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(kNumClients, cb.accepted);
+
+  cb.pauseAt = kNumClients * 2;
+  serverSocket->startAccepting();
+  evbPtr->loopForever();
+  EXPECT_EQ(kNumClients * 2, cb.accepted);
+
+  serverSocket->stopAccepting();
+}
+
 TEST(IoUringBackend, EventFDNooverflownopersist) {
   testEventFD(false, false, false);
 }
@@ -1144,6 +1214,180 @@ TEST(IoUringBackend, FileReadWrite) {
   EXPECT_EQ(num, kNumBlocks);
 }
 
+TEST(IoUringBackend, FileReadWriteFixed) {
+  static constexpr size_t kNumBlocks = 64;
+  static constexpr size_t kBlockSize = 4096;
+  static constexpr size_t kFileSize = kNumBlocks * kBlockSize;
+
+  folly::PollIoBackend::Options options;
+  options.setCapacity(512).setMaxSubmit(8).setMaxGet(8).setRegisteredBuffers(
+      kBlockSize, 2 * kNumBlocks);
+  auto evbPtr = getEventBase(options);
+  SKIP_IF(!evbPtr) << "Backend not available";
+  auto* backendPtr = dynamic_cast<folly::IoUringBackend*>(evbPtr->getBackend());
+  CHECK(!!backendPtr);
+  SKIP_IF(!backendPtr->registeredBufferPool()) << "Cannot register buffers";
+
+  auto tempFile = folly::test::TempFileUtil::getTempFile(kFileSize);
+  int fd = folly::fileops::open(tempFile.path().c_str(), O_RDWR);
+  SKIP_IF(fd == -1) << "Tempfile can't be opened: " << folly::errnoStr(errno);
+  SCOPE_EXIT {
+    folly::fileops::close(fd);
+  };
+
+  std::vector<std::unique_ptr<folly::IOBuf>> writeBufs, readBufs;
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    writeBufs.push_back(backendPtr->allocateRegisteredBuffer());
+    readBufs.push_back(backendPtr->allocateRegisteredBuffer());
+    ASSERT_TRUE(writeBufs.back() && readBufs.back());
+    ASSERT_EQ(writeBufs.back()->tailroom(), kBlockSize);
+    memset(writeBufs.back()->writableTail(), 'A' + i % 26, kBlockSize);
+    writeBufs.back()->append(kBlockSize);
+  }
+  // all the buffers are in use
+  EXPECT_FALSE(backendPtr->allocateRegisteredBuffer());
+
+  size_t num = 0;
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    folly::IoUringBackend::FileOpCallback writeCb = [&, i](int res) {
+      CHECK_EQ(res, kBlockSize);
+      folly::IoUringBackend::FileOpCallback readCb = [&, i](int res) {
+        CHECK_EQ(res, kBlockSize);
+        readBufs[i]->append(res);
+        CHECK_EQ(
+            folly::StringPiece(readBufs[i]->coalesce()),
+            folly::StringPiece(writeBufs[i]->coalesce()));
+        ++num;
+      };
+      backendPtr->queueRead(
+          fd,
+          readBufs[i]->writableTail(),
+          kBlockSize,
+          i * kBlockSize,
+          std::move(readCb));
+    };
+    backendPtr->queueWrite(
+        fd,
+        writeBufs[i]->data(),
+        kBlockSize,
+        i * kBlockSize,
+        std::move(writeCb));
+  }
+
+  evbPtr->loop();
+
+  EXPECT_EQ(num, kNumBlocks);
+
+  readBufs.clear();
+  EXPECT_TRUE(backendPtr->allocateRegisteredBuffer());
+}
+
+TEST(IoUringBackend, LinkedFileOps) {
+  static constexpr int kBlockSize = 4096;
+
+  folly::PollIoBackend::Options options;
+  options.setCapacity(64).setMaxSubmit(8).setMaxGet(8);
+  auto evbPtr = getEventBase(options);
+  SKIP_IF(!evbPtr) << "Backend not available";
+  auto* backendPtr = dynamic_cast<folly::IoUringBackend*>(evbPtr->getBackend());
+  CHECK(!!backendPtr);
+
+  auto tempFile = folly::test::TempFileUtil::getTempFile(2 * kBlockSize);
+  int fd = folly::fileops::open(tempFile.path().c_str(), O_RDWR);
+  SKIP_IF(fd == -1) << "Tempfile can't be opened: " << folly::errnoStr(errno);
+  int closeFd = ::dup(fd);
+  SCOPE_EXIT {
+    folly::fileops::close(fd);
+  };
+
+  std::string writeBuf(kBlockSize, 'x');
+  std::string readBuf(kBlockSize, '\0');
+  folly::IoUringBackend::LinkedFileOps ops;
+  ops.write(fd, writeBuf.data(), kBlockSize, kBlockSize)
+      .fdatasync(fd)
+      .read(fd, readBuf.data(), kBlockSize, kBlockSize)
+      .close(closeFd);
+  EXPECT_EQ(ops.size(), 4);
+
+  std::vector<int> results;
+  size_t num = 0;
+  backendPtr->queueLinked(std::move(ops), [&](std::vector<int> res) {
+    results = std::move(res);
+    ++num;
+  });
+  evbPtr->loop();
+
+  EXPECT_EQ(num, 1);
+  EXPECT_EQ(results, (std::vector<int>{kBlockSize, 0, kBlockSize, 0}));
+  EXPECT_EQ(readBuf, writeBuf);
+}
+
+TEST(IoUringBackend, LinkedFileOpsFailure) {
+  folly::PollIoBackend::Options options;
+  options.setCapacity(64).setMaxSubmit(8).setMaxGet(8);
+  auto evbPtr = getEventBase(options);
+  SKIP_IF(!evbPtr) << "Backend not available";
+  auto* backendPtr = dynamic_cast<folly::IoUringBackend*>(evbPtr->getBackend());
+  CHECK(!!backendPtr);
+
+  char buf[16];
+  folly::IoUringBackend::LinkedFileOps ops;
+  ops.read(-1, buf, sizeof(buf), 0).fsync(-1).read(-1, buf, sizeof(buf), 0);
+
+  std::vector<int> results;
+  backendPtr->queueLinked(
+      std::move(ops), [&](std::vector<int> res) { results = std::move(res); });
+  evbPtr->loop();
+
+  EXPECT_EQ(results, (std::vector<int>{-EBADF, -ECANCELED, -ECANCELED}));
+
+  // chains that cannot fit in the submission queue are rejected
+  folly::IoUringBackend::LinkedFileOps tooLong;
+  for (size_t i = 0; i < 1024; i++) {
+    tooLong.fsync(-1);
+  }
+  EXPECT_THROW(
+      backendPtr->queueLinked(std::move(tooLong), [](std::vector<int>) {}),
+      std::invalid_argument);
+}
+
+TEST(IoUringBackend, SubmitBatch) {
+  static constexpr size_t kNumBlocks = 32;
+  static constexpr size_t kBlockSize = 4096;
+
+  folly::PollIoBackend::Options options;
+  options.setCapacity(512).setMaxSubmit(4).setMaxGet(8);
+  auto evbPtr = getEventBase(options);
+  SKIP_IF(!evbPtr) << "Backend not available";
+  auto* backendPtr = dynamic_cast<folly::IoUringBackend*>(evbPtr->getBackend());
+  CHECK(!!backendPtr);
+
+  auto tempFile =
+      folly::test::TempFileUtil::getTempFile(kNumBlocks * kBlockSize);
+  int fd = folly::fileops::open(tempFile.path().c_str(), O_RDWR);
+  SKIP_IF(fd == -1) << "Tempfile can't be opened: " << folly::errnoStr(errno);
+  SCOPE_EXIT {
+    folly::fileops::close(fd);
+  };
+
+  std::vector<std::string> bufs(kNumBlocks, std::string(kBlockSize, '\0'));
+  size_t num = 0;
+  {
+    folly::IoUringBackend::SubmitBatch batch(*backendPtr);
+    folly::IoUringBackend::SubmitBatch nested(*backendPtr);
+    for (size_t i = 0; i < kNumBlocks; i++) {
+      backendPtr->queueRead(
+          fd, bufs[i].data(), kBlockSize, i * kBlockSize, [&](int res) {
+            CHECK_EQ(res, kBlockSize);
+            ++num;
+          });
+    }
+  }
+  evbPtr->loop();
+
+  EXPECT_EQ(num, kNumBlocks);
+}
+
 TEST(IoUringBackend, FileReadvWritev) {
   static constexpr size_t kBackendCapacity = 512;
   static constexpr size_t kBackendMaxSubmit = 8;
@@ -16,6 +16,9 @@
 
 #include <folly/io/async/IoUringProvidedBufferRing.h>
 
+#include <set>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #if FOLLY_HAS_LIBURING
@@ -66,4 +69,55 @@ TEST_F(IoUringProvidedBufferRingTest, CreateNoHugepages) {
   EXPECT_EQ(bufRing.count(), 1000);
 }
 
+TEST_F(IoUringProvidedBufferRingTest, GrowOnEnobuf) {
+  io_uring ring{};
+  io_uring_queue_init(512, &ring, 0);
+  IoUringProvidedBufferRing::Options options = {
+      .gid = 1,
+      .count = 4,
+      .bufferShift = get_shift(4096),
+      .ringSizeShift = get_shift(12),
+      .useHugePages = false,
+      .maxCount = 12,
+  };
+  IoUringProvidedBufferRing bufRing{&ring, options};
+  EXPECT_EQ(bufRing.count(), 4);
+
+  // Pretend the kernel handed out every buffer.
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  auto takeAll = [&](uint16_t begin, uint16_t end) {
+    for (uint16_t i = begin; i < end; i++) {
+      bufs.push_back(bufRing.getIoBuf(i, 4096));
+      memset(bufs.back()->writableData(), i, 4096);
+    }
+  };
+  takeAll(0, 4);
+  bufRing.enobuf();
+  EXPECT_EQ(bufRing.count(), 8);
+  EXPECT_TRUE(bufRing.available());
+
+  // The new buffers were not used yet, so don't grow again.
+  bufRing.enobuf();
+  EXPECT_EQ(bufRing.count(), 8);
+  EXPECT_FALSE(bufRing.available());
+
+  takeAll(4, 8);
+  bufRing.enobuf();
+  EXPECT_EQ(bufRing.count(), 12);
+  takeAll(8, 12);
+  bufRing.enobuf();
+  EXPECT_EQ(bufRing.count(), 12);
+  EXPECT_FALSE(bufRing.available());
+
+  std::set<const uint8_t*> addrs;
+  for (size_t i = 0; i < bufs.size(); i++) {
+    EXPECT_EQ(bufs[i]->data()[4095], i);
+    addrs.insert(bufs[i]->data());
+  }
+  EXPECT_EQ(addrs.size(), 12);
+
+  bufs.clear();
+  EXPECT_TRUE(bufRing.available());
+}
+
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <folly/io/async/IoUringRegisteredBufferPool.h>
+
+#if FOLLY_HAS_LIBURING
+
+using namespace ::testing;
+using namespace ::std;
+using namespace ::folly;
+
+TEST(IoUringRegisteredBufferPoolTest, Allocate) {
+  auto pool = IoUringRegisteredBufferPool::create(
+      {.ring = nullptr, .bufferSize = 4096, .count = 8});
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  std::set<int> indices;
+  for (size_t i = 0; i < 8; i++) {
+    auto buf = pool->allocate();
+    ASSERT_TRUE(buf);
+    EXPECT_EQ(buf->length(), 0);
+    EXPECT_EQ(buf->tailroom(), 4096);
+    int idx = pool->bufferIndex(buf->data(), 4096);
+    EXPECT_GE(idx, 0);
+    indices.insert(idx);
+    // ranges within the buffer map to it, ranges crossing its end don't
+    EXPECT_EQ(pool->bufferIndex(buf->data() + 100, 3996), idx);
+    EXPECT_EQ(pool->bufferIndex(buf->data() + 100, 3997), -1);
+    bufs.push_back(std::move(buf));
+  }
+  EXPECT_EQ(indices.size(), 8);
+  EXPECT_FALSE(pool->allocate());
+
+  char other[16];
+  EXPECT_EQ(pool->bufferIndex(other, sizeof(other)), -1);
+
+  bufs.pop_back();
+  EXPECT_TRUE(pool->allocate());
+}
+
+TEST(IoUringRegisteredBufferPoolTest, ReturnFromOtherThread) {
+  auto pool = IoUringRegisteredBufferPool::create(
+      {.ring = nullptr, .bufferSize = 1024, .count = 2});
+  auto buf1 = pool->allocate();
+  auto buf2 = pool->allocate();
+  EXPECT_FALSE(pool->allocate());
+  std::thread([b = std::move(buf1)]() mutable { b.reset(); }).join();
+  EXPECT_TRUE(pool->allocate());
+}
+
+TEST(IoUringRegisteredBufferPoolTest, DelayedDestruction) {
+  auto pool = IoUringRegisteredBufferPool::create(
+      {.ring = nullptr, .bufferSize = 1024, .count = 4});
+  auto buf1 = pool->allocate();
+  auto buf2 = pool->allocate();
+  buf1.reset();
+  pool.reset();
+  // still usable after the pool was destroyed
+  memset(buf2->writableTail(), 'x', buf2->tailroom());
+  buf2.reset();
+}
+
+TEST(IoUringRegisteredBufferPoolTest, InvalidParams) {
+  EXPECT_THROW(
+      IoUringRegisteredBufferPool::create(
+          {.ring = nullptr, .bufferSize = 0, .count = 4}),
+      std::invalid_argument);
+  EXPECT_THROW(
+      IoUringRegisteredBufferPool::create(
+          {.ring = nullptr, .bufferSize = 4096, .count = 0}),
+      std::invalid_argument);
+}
+
+#endif
@@ -20,9 +20,14 @@
 
 #include <thread>
 
+#include <folly/FileUtil.h>
 #include <folly/executors/test/IOThreadPoolExecutorBaseTestLib.h>
 #include <folly/experimental/io/MuxIOThreadPoolExecutor.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventHandler.h>
+#include <folly/io/async/test/SocketPair.h>
 #include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
 #include <folly/synchronization/Latch.h>
 
 namespace folly {
@@ -103,6 +108,157 @@ TEST(MuxIOThreadPoolExecutor, InvalidSetNumThreads) {
       folly::MuxIOThreadPoolExecutor(2, options), std::invalid_argument);
 }
 
+namespace {
+
+folly::MuxIOThreadPoolExecutor::Options loadAwareOptions() {
+  return folly::MuxIOThreadPoolExecutor::Options{}
+      .setNumEventBases(2)
+      .setLoadAwarePlacement(true)
+      .setLoadDecayInterval(std::chrono::seconds{60})
+      .setFdLoadWeight(std::chrono::nanoseconds{0});
+}
+
+// Waits for the end of the loop run that recorded the condition.
+template <class Pred>
+void waitForLoads(folly::MuxIOThreadPoolExecutor& ex, Pred pred) {
+  for (int i = 0; i < 1000 && !pred(ex.getEventBaseLoads()); ++i) {
+    /* sleep override */ std::this_thread::sleep_for(
+        std::chrono::milliseconds{1});
+  }
+  ASSERT_TRUE(pred(ex.getEventBaseLoads()));
+}
+
+void makeBusy(folly::MuxIOThreadPoolExecutor& ex, size_t idx) {
+  ex.getAllEventBases()[idx]->runInEventBaseThreadAndWait([] {
+    /* sleep override */ std::this_thread::sleep_for(
+        std::chrono::milliseconds{50});
+  });
+  waitForLoads(ex, [&](const auto& loads) {
+    return loads[idx].recentBusyTime >= std::chrono::milliseconds{50};
+  });
+}
+
+class NoopHandler : public folly::EventHandler {
+ public:
+  using EventHandler::EventHandler;
+
+  void handlerReady(uint16_t /* events */) noexcept override {}
+};
+
+class ReadCallback : public folly::AsyncTransport::ReadCallback {
+ public:
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf.data();
+    *lenReturn = buf.size();
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    data.append(buf.data(), len);
+    evb = folly::EventBaseManager::get()->getExistingEventBase();
+    baton.post();
+  }
+
+  void readEOF() noexcept override {}
+
+  void readErr(const folly::AsyncSocketException&) noexcept override {}
+
+  std::array<char, 64> buf;
+  std::string data;
+  folly::EventBase* evb{nullptr};
+  folly::Baton<> baton;
+};
+
+} // namespace
+
+TEST(MuxIOThreadPoolExecutor, LoadAwarePlacementBusyTime) {
+  folly::MuxIOThreadPoolExecutor ex(2, loadAwareOptions());
+  const auto evbs = ex.getAllEventBases();
+
+  makeBusy(ex, 0);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(ex.getEventBase(), evbs[1].get());
+  }
+}
+
+TEST(MuxIOThreadPoolExecutor, LoadAwarePlacementFds) {
+  static constexpr size_t kNumFds = 3;
+  folly::MuxIOThreadPoolExecutor ex(
+      2,
+      loadAwareOptions()
+          .setLoadDecayInterval(std::chrono::nanoseconds{1})
+          .setFdLoadWeight(std::chrono::seconds{1}));
+  const auto evbs = ex.getAllEventBases();
+
+  std::vector<folly::SocketPair> socketPairs(kNumFds);
+  std::vector<std::unique_ptr<NoopHandler>> handlers;
+  evbs[1]->runInEventBaseThreadAndWait([&] {
+    for (const auto& socketPair : socketPairs) {
+      handlers.push_back(std::make_unique<NoopHandler>(
+          evbs[1].get(), folly::NetworkSocket::fromFd(socketPair[0])));
+      handlers.back()->registerHandler(
+          folly::EventHandler::READ | folly::EventHandler::PERSIST);
+    }
+  });
+  waitForLoads(ex, [](const auto& loads) {
+    return loads[1].numRegisteredFds == kNumFds;
+  });
+  EXPECT_EQ(ex.getEventBaseLoads()[0].numRegisteredFds, 0);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(ex.getEventBase(), evbs[0].get());
+  }
+
+  evbs[1]->runInEventBaseThreadAndWait([&] { handlers.clear(); });
+}
+
+TEST(MuxIOThreadPoolExecutor, MigrateIdleConnection) {
+  folly::MuxIOThreadPoolExecutor ex(2, loadAwareOptions());
+  const auto evbs = ex.getAllEventBases();
+
+  folly::SocketPair socketPair;
+  folly::AsyncSocket::UniquePtr socket;
+  ReadCallback readCallback;
+  folly::Baton<> migrated;
+  makeBusy(ex, 0);
+  evbs[0]->runInEventBaseThreadAndWait([&] {
+    socket = folly::AsyncSocket::newSocket(
+        evbs[0].get(), socketPair.extractNetworkSocket0());
+    socket->setReadCB(&readCallback);
+    EXPECT_TRUE(ex.maybeMigrate(*socket, [&] { migrated.post(); }));
+  });
+  migrated.wait();
+
+  evbs[1]->runInEventBaseThreadAndWait([&] {
+    EXPECT_EQ(socket->getEventBase(), evbs[1].get());
+    // Already on the least loaded EventBase.
+    EXPECT_FALSE(ex.maybeMigrate(*socket));
+  });
+
+  // The read callback survives the migration.
+  const std::string message = "hello";
+  ASSERT_EQ(
+      folly::writeFull(socketPair[1], message.data(), message.size()),
+      message.size());
+  readCallback.baton.wait();
+  EXPECT_EQ(readCallback.data, message);
+  EXPECT_EQ(readCallback.evb, evbs[1].get());
+
+  evbs[1]->runInEventBaseThreadAndWait([&] { socket.reset(); });
+}
+
+TEST(MuxIOThreadPoolExecutor, MigrateRequiresLoadAwarePlacement) {
+  folly::MuxIOThreadPoolExecutor ex(
+      2, folly::MuxIOThreadPoolExecutor::Options{}.setNumEventBases(2));
+  const auto evbs = ex.getAllEventBases();
+
+  folly::SocketPair socketPair;
+  evbs[0]->runInEventBaseThreadAndWait([&] {
+    auto socket = folly::AsyncSocket::newSocket(
+        evbs[0].get(), socketPair.extractNetworkSocket0());
+    EXPECT_FALSE(ex.maybeMigrate(*socket));
+  });
+}
+
 INSTANTIATE_TYPED_TEST_SUITE_P(
     MuxIOThreadPoolExecutorTest,
     IOThreadPoolExecutorBaseTest,
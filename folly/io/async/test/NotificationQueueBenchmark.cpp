@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <thread>
 
 #include <folly/Benchmark.h>
@@ -54,6 +55,15 @@ struct AtomicNotificationQueueConsumerAdaptor {
   }
 };
 
+struct AtomicNotificationQueueArmDelayConsumerAdaptor {
+  void startConsuming(
+      EventBase* evb,
+      EventBaseAtomicNotificationQueue<Func, FuncRunner>* queue) {
+    queue->setArmDelay(std::chrono::microseconds(50));
+    queue->startConsuming(evb);
+  }
+};
+
 static void burn(size_t n) {
   for (size_t i = 0; i < n; ++i) {
     folly::doNotOptimizeAway(i);
@@ -153,6 +163,15 @@ void multiProducerMultiConsumerANQ(
       iters, numProducers, numConsumers);
 }
 
+void multiProducerMultiConsumerANQArmDelay(
+    int iters, size_t numProducers, size_t numConsumers) {
+  CHECK(numConsumers == 1);
+  multiProducerMultiConsumer<
+      EventBaseAtomicNotificationQueue<Func, FuncRunner>,
+      AtomicNotificationQueueArmDelayConsumerAdaptor>(
+      iters, numProducers, numConsumers);
+}
+
 BENCHMARK(EnqueueBenchmark, n) {
   BenchmarkSuspender suspender;
   NotificationQueue<Func> queue;
@@ -192,6 +211,13 @@ BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQ, _8p__1c, 8, 1)
 BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQ, 16p__1c, 16, 1)
 BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQ, 32p__1c, 32, 1)
 BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, _1p__1c, 1, 1)
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, _2p__1c, 2, 1)
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, _4p__1c, 4, 1)
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, _8p__1c, 8, 1)
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, 16p__1c, 16, 1)
+BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerANQArmDelay, 32p__1c, 32, 1)
+BENCHMARK_DRAW_LINE();
 BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerNQ, _1p__1c, 1, 1)
 BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerNQ, _2p__1c, 2, 1)
 BENCHMARK_NAMED_PARAM(multiProducerMultiConsumerNQ, _4p__1c, 4, 1)
@@ -34,6 +34,18 @@ using namespace folly;
 
 RequestToken token("test");
 
+class NoCallbackData : public RequestData {
+ public:
+  bool hasCallback() override { return false; }
+};
+
+std::unique_ptr<RequestData> makeData(int data, bool callbacks) {
+  if (callbacks) {
+    return std::make_unique<TestData>(data);
+  }
+  return std::make_unique<NoCallbackData>();
+}
+
 template <typename Func>
 inline uint64_t run_once(int nthr, const Func& fn) {
   folly::test::Barrier b1(nthr + 1);
@@ -169,16 +181,17 @@ uint64_t bench_onUnset(int nthr, uint64_t ops, bool nonempty) {
   return runBench(ops, nthr, fn);
 }
 
-uint64_t bench_setContext(int nthr, uint64_t ops, bool nonempty) {
+uint64_t bench_setContext(
+    int nthr, uint64_t ops, bool nonempty, bool callbacks = true) {
   auto fn = [&](int tid) {
     auto ctx = std::make_shared<RequestContext>();
     if (nonempty) {
-      ctx->setContextData(token, std::make_unique<TestData>(1));
+      ctx->setContextData(token, makeData(1, callbacks));
     }
     RequestContext::setContext(std::move(ctx));
     ctx = std::make_shared<RequestContext>();
     if (nonempty) {
-      ctx->setContextData(token, std::make_unique<TestData>(2));
+      ctx->setContextData(token, makeData(2, callbacks));
     }
     for (uint64_t i = tid; i < ops; i += nthr) {
       ctx = RequestContext::setContext(std::move(ctx));
@@ -188,16 +201,16 @@ uint64_t bench_setContext(int nthr, uint64_t ops, bool nonempty) {
   return runBench(ops, nthr, fn);
 }
 
-uint64_t bench_RequestContextScopeGuard(int nthr, uint64_t ops, bool nonempty) {
+uint64_t bench_RequestContextScopeGuard(
+    int nthr, uint64_t ops, bool nonempty, bool callbacks = true) {
   auto fn = [&](int tid) {
     RequestContextScopeGuard g1;
     if (nonempty) {
-      RequestContext::get()->setContextData(
-          token, std::make_unique<TestData>(1));
+      RequestContext::get()->setContextData(token, makeData(1, callbacks));
     }
     auto ctx = std::make_shared<RequestContext>();
     if (nonempty) {
-      ctx->setContextData(token, std::make_unique<TestData>(2));
+      ctx->setContextData(token, makeData(2, callbacks));
     }
     for (uint64_t i = tid; i < ops; i += nthr) {
       RequestContextScopeGuard g2(ctx);
@@ -206,6 +219,21 @@ uint64_t bench_RequestContextScopeGuard(int nthr, uint64_t ops, bool nonempty) {
   return runBench(ops, nthr, fn);
 }
 
+// Models an executor hop or coroutine resumption that stays within the
+// request which is already current, e.g. a continuation of the same request.
+uint64_t bench_RequestContextScopeGuardSameContext(int nthr, uint64_t ops) {
+  auto fn = [&](int tid) {
+    RequestContextScopeGuard g1;
+    RequestContext::get()->setContextData(
+        token, std::make_unique<TestData>(1));
+    auto ctx = RequestContext::saveContext();
+    for (uint64_t i = tid; i < ops; i += nthr) {
+      RequestContextScopeGuard g2(ctx);
+    }
+  };
+  return runBench(ops, nthr, fn);
+}
+
 uint64_t bench_ShallowCopyRequestContextScopeGuard(
     int nthr, uint64_t ops, int keep, bool replace) {
   auto fn = [&](int tid) {
@@ -268,8 +296,14 @@ void benches() {
     bench_onUnset(i, ops, true);
     std::cout << "setContext                      ";
     bench_setContext(i, ops, true);
+    std::cout << "setContext-nocallbacks          ";
+    bench_setContext(i, ops, true, false);
     std::cout << "RequestContextScopeGuard        ";
     bench_RequestContextScopeGuard(i, ops, true);
+    std::cout << "RequestContextScopeGuard-nocb   ";
+    bench_RequestContextScopeGuard(i, ops, true, false);
+    std::cout << "RequestContextScopeGuard-same   ";
+    bench_RequestContextScopeGuardSameContext(i, ops);
     std::cout << "ShallowCopyRequestC...-replace  ";
     bench_ShallowCopyRequestContextScopeGuard(i, ops, 0, true);
     std::cout << "ShallowCopyReq...-keep&replace  ";
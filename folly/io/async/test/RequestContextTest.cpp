@@ -235,6 +235,47 @@ TEST_F(RequestContextTest, testSetUnset) {
   EXPECT_EQ(1, testData2->unset_);
 }
 
+TEST_F(RequestContextTest, testSetUnsetWithoutCallbacks) {
+  class NoCallbackData : public RequestData {
+   public:
+    bool hasCallback() override { return false; }
+  };
+
+  auto ctx1 = std::make_shared<RequestContext>();
+  ctx1->setContextData("nocb", std::make_unique<NoCallbackData>());
+  auto ctx2 = std::make_shared<RequestContext>();
+  ctx2->setContextData("test", std::make_unique<TestData>(10));
+  auto testData = dynamic_cast<TestData*>(ctx2->getContextData("test"));
+  EXPECT_EQ(1, testData->set_);
+
+  RequestContext::setContext(ctx1);
+  RequestContext::setContext(ctx2);
+  EXPECT_EQ(2, testData->set_);
+  RequestContext::setContext(ctx1);
+  EXPECT_EQ(1, testData->unset_);
+
+  // Once its callback data is cleared, ctx2 switches like ctx1.
+  RequestContext::setContext(ctx2);
+  EXPECT_EQ(3, testData->set_);
+  ctx2->clearContextData("test");
+  EXPECT_EQ(2, testData->unset_);
+  RequestContext::setContext(ctx1);
+  RequestContext::setContext(ctx2);
+  EXPECT_EQ(3, testData->set_);
+  EXPECT_EQ(2, testData->unset_);
+
+  // A shallow copy inherits the callbacks of its parent.
+  ctx2->setContextData("test2", std::make_unique<TestData>(20));
+  auto testData2 = dynamic_cast<TestData*>(ctx2->getContextData("test2"));
+  {
+    ShallowCopyRequestContextScopeGuard g;
+    EXPECT_EQ(1, testData2->set_);
+    RequestContext::setContext(ctx1);
+    EXPECT_EQ(1, testData2->unset_);
+  }
+  EXPECT_EQ(2, testData2->set_);
+}
+
 TEST_F(RequestContextTest, deadlockTest) {
   class DeadlockTestData : public RequestData {
    public:
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/ReusePortServerSocketGroup.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/net/NetOps.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Sockets.h>
+
+using namespace folly;
+
+namespace {
+
+constexpr size_t kNumThreads = 3;
+constexpr int kNumConnections = 30;
+
+class CountingAcceptCallback : public AsyncServerSocket::AcceptCallback {
+ public:
+  CountingAcceptCallback(EventBase* evb, std::atomic<int>& total)
+      : evb_(evb), total_(total) {}
+
+  void connectionAccepted(
+      NetworkSocket fd, const SocketAddress&, AcceptInfo) noexcept override {
+    // Accepted inline, in the thread of the socket.
+    EXPECT_TRUE(evb_->isInEventBaseThread());
+    netops::close(fd);
+    ++accepted;
+    ++total_;
+  }
+
+  void acceptError(exception_wrapper ew) noexcept override {
+    ADD_FAILURE() << ew.what();
+  }
+
+  void acceptStopped() noexcept override { stopped = true; }
+
+  std::atomic<int> accepted{0};
+  std::atomic<bool> stopped{false};
+
+ private:
+  EventBase* const evb_;
+  std::atomic<int>& total_;
+};
+
+class ReusePortServerSocketGroupTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (size_t i = 0; i < kNumThreads; ++i) {
+      threads_.push_back(std::make_unique<ScopedEventBaseThread>());
+      eventBases_.push_back(threads_.back()->getEventBase());
+      callbacks_.push_back(
+          std::make_unique<CountingAcceptCallback>(eventBases_.back(), total_));
+    }
+  }
+
+  CountingAcceptCallback* callbackFor(EventBase* evb) {
+    for (size_t i = 0; i < eventBases_.size(); ++i) {
+      if (eventBases_[i] == evb) {
+        return callbacks_[i].get();
+      }
+    }
+    return nullptr;
+  }
+
+  void start(ReusePortServerSocketGroup& group) {
+    group.start(SocketAddress("127.0.0.1", 0), 128, [&](EventBase* evb) {
+      return callbackFor(evb);
+    });
+  }
+
+  void connectClients(const SocketAddress& address) {
+    sockaddr_storage addr;
+    auto len = address.getAddress(&addr);
+    for (int i = 0; i < kNumConnections; ++i) {
+      auto fd = netops::socket(AF_INET, SOCK_STREAM, 0);
+      ASSERT_NE(fd, NetworkSocket());
+      ASSERT_EQ(
+          0, netops::connect(fd, reinterpret_cast<sockaddr*>(&addr), len));
+      netops::close(fd);
+    }
+  }
+
+  void waitForAccepts() {
+    for (int i = 0; i < 1000 && total_.load() < kNumConnections; ++i) {
+      /* sleep override */ std::this_thread::sleep_for(
+          std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(kNumConnections, total_.load());
+  }
+
+  std::vector<std::unique_ptr<ScopedEventBaseThread>> threads_;
+  std::vector<EventBase*> eventBases_;
+  std::vector<std::unique_ptr<CountingAcceptCallback>> callbacks_;
+  std::atomic<int> total_{0};
+};
+
+} // namespace
+
+TEST_F(ReusePortServerSocketGroupTest, Hash) {
+  ReusePortServerSocketGroup group(eventBases_);
+  start(group);
+  ASSERT_EQ(kNumThreads, group.getSockets().size());
+  auto address = group.getAddress();
+  EXPECT_NE(0, address.getPort());
+  for (auto& socket : group.getSockets()) {
+    EXPECT_EQ(address, socket->getAddress());
+  }
+
+  connectClients(address);
+  waitForAccepts();
+
+  group.stop();
+  EXPECT_TRUE(group.getSockets().empty());
+  for (auto& callback : callbacks_) {
+    EXPECT_TRUE(callback->stopped);
+  }
+}
+
+TEST_F(ReusePortServerSocketGroupTest, IncomingCpu) {
+  ReusePortServerSocketGroup group(eventBases_);
+  EXPECT_THROW(
+      group.setSteering(
+          ReusePortServerSocketGroup::Steering::IncomingCpu, {0}),
+      std::invalid_argument);
+  group.setSteering(
+      ReusePortServerSocketGroup::Steering::IncomingCpu, {0, 1, 2});
+  try {
+    start(group);
+  } catch (const std::exception& ex) {
+    GTEST_SKIP() << "SO_INCOMING_CPU is not supported: " << ex.what();
+  }
+  connectClients(group.getAddress());
+  waitForAccepts();
+}
+
+TEST_F(ReusePortServerSocketGroupTest, CpuBpf) {
+  ReusePortServerSocketGroup group(eventBases_);
+  group.setSteering(ReusePortServerSocketGroup::Steering::CpuBpf);
+  try {
+    start(group);
+  } catch (const std::exception& ex) {
+    GTEST_SKIP() << "SO_ATTACH_REUSEPORT_CBPF is not supported: " << ex.what();
+  }
+  EXPECT_EQ(kNumThreads, group.getSockets().size());
+  connectClients(group.getAddress());
+  waitForAccepts();
+
+  // Which sockets get the connections depends on the CPUs that handle them,
+  // which the test doesn't control.
+  int busySockets = 0;
+  for (auto& callback : callbacks_) {
+    busySockets += callback->accepted > 0;
+  }
+  EXPECT_GE(busySockets, 1);
+}
+
+TEST_F(ReusePortServerSocketGroupTest, StartFailure) {
+  // A socket without SO_REUSEPORT holds the port, so the group can't bind.
+  auto taken = AsyncServerSocket::newSocket(eventBases_[0]);
+  eventBases_[0]->runInEventBaseThreadAndWait([&] {
+    taken->bind(SocketAddress("127.0.0.1", 0));
+    taken->listen(16);
+  });
+  SocketAddress address;
+  taken->getAddress(&address);
+
+  ReusePortServerSocketGroup group(eventBases_);
+  EXPECT_THROW(
+      group.start(
+          address, 128, [&](EventBase* evb) { return callbackFor(evb); }),
+      std::system_error);
+  EXPECT_TRUE(group.getSockets().empty());
+  EXPECT_THROW(group.getAddress(), std::logic_error);
+
+  eventBases_[0]->runInEventBaseThreadAndWait([&] { taken.reset(); });
+}
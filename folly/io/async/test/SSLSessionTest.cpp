@@ -24,6 +24,8 @@
 #include <folly/portability/GTest.h>
 #include <folly/portability/OpenSSL.h>
 #include <folly/portability/Sockets.h>
+#include <folly/ssl/SSLServerSessionCache.h>
+#include <folly/ssl/TLSTicketKeyHandler.h>
 #include <folly/ssl/detail/OpenSSLSession.h>
 #include <folly/testing/TestUtil.h>
 
@@ -196,3 +198,127 @@ TEST_F(SSLSessionTest, NullSessionResumptionTest) {
     ASSERT_FALSE(clientPtr->getSSLSessionReused());
   }
 }
+
+TEST_F(SSLSessionTest, ServerSessionCacheTest) {
+  // Resume with the session id, or with a stateful ticket with TLS 1.3
+  dfServerCtx_->setOptions(SSL_OP_NO_TICKET);
+  auto cache = std::make_shared<ssl::ShardedSSLServerSessionCache>();
+  dfServerCtx_->setServerSessionCache(cache);
+
+  ssl::SSLSessionUniquePtr sslSession;
+  // Full handshake
+  {
+    NetworkSocket fds[2];
+    getfds(fds);
+    auto sessionCb = std::make_unique<SimpleSessionLifecycleCallback>();
+    auto sessionCbPtr = sessionCb.get();
+    clientCtx_->setSessionLifecycleCallbacks(std::move(sessionCb));
+
+    AsyncSSLSocket::UniquePtr clientSock(
+        new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+    auto clientPtr = clientSock.get();
+
+    AsyncSSLSocket::UniquePtr serverSock(
+        new AsyncSSLSocket(dfServerCtx_, &eventBase_, fds[1], true));
+    SSLHandshakeClient client(std::move(clientSock), false, false);
+    SSLHandshakeServerParseClientHello server(
+        std::move(serverSock), false, false);
+    sessionCbPtr->socket_ = clientPtr;
+    SimpleReadCallback readCb;
+    clientPtr->setReadCB(&readCb);
+    eventBase_.loop();
+    ASSERT_TRUE(client.handshakeSuccess_);
+    sslSession = std::move(sessionCbPtr->session_);
+    ASSERT_TRUE(sslSession != nullptr);
+    ASSERT_FALSE(clientPtr->getSSLSessionReused());
+    // TLS 1.3 servers issue two tickets by default.
+    EXPECT_GE(cache->getStats().adds, 1);
+  }
+
+  // Session resumption, from the server session cache
+  {
+    NetworkSocket fds[2];
+    getfds(fds);
+    AsyncSSLSocket::UniquePtr clientSock(
+        new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+    auto clientPtr = clientSock.get();
+
+    clientPtr->setRawSSLSession(std::move(sslSession));
+
+    AsyncSSLSocket::UniquePtr serverSock(
+        new AsyncSSLSocket(dfServerCtx_, &eventBase_, fds[1], true));
+    SSLHandshakeClient client(std::move(clientSock), false, false);
+    SSLHandshakeServerParseClientHello server(
+        std::move(serverSock), false, false);
+
+    eventBase_.loop();
+    ASSERT_TRUE(client.handshakeSuccess_);
+    ASSERT_TRUE(clientPtr->getSSLSessionReused());
+  }
+  auto stats = cache->getStats();
+  EXPECT_EQ(1, stats.lookups);
+  EXPECT_EQ(1, stats.hits);
+}
+
+TEST_F(SSLSessionTest, TicketKeyHandlerTest) {
+  // Two servers with the same ticket key seeds, e.g. two processes.
+  auto otherServerCtx = std::make_shared<SSLContext>();
+  getctx(clientCtx_, otherServerCtx);
+  for (const auto& ctx : {dfServerCtx_, otherServerCtx}) {
+    auto handler = std::make_unique<ssl::TLSTicketKeyHandler>();
+    handler->setTicketKeySeeds({"old"}, {"current"}, {"new"});
+    ctx->setTicketHandler(std::move(handler));
+  }
+
+  ssl::SSLSessionUniquePtr sslSession;
+  // Full handshake with the first server
+  {
+    NetworkSocket fds[2];
+    getfds(fds);
+    auto sessionCb = std::make_unique<SimpleSessionLifecycleCallback>();
+    auto sessionCbPtr = sessionCb.get();
+    clientCtx_->setSessionLifecycleCallbacks(std::move(sessionCb));
+
+    AsyncSSLSocket::UniquePtr clientSock(
+        new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+    auto clientPtr = clientSock.get();
+
+    AsyncSSLSocket::UniquePtr serverSock(
+        new AsyncSSLSocket(dfServerCtx_, &eventBase_, fds[1], true));
+    SSLHandshakeClient client(std::move(clientSock), false, false);
+    SSLHandshakeServerParseClientHello server(
+        std::move(serverSock), false, false);
+    sessionCbPtr->socket_ = clientPtr;
+    SimpleReadCallback readCb;
+    clientPtr->setReadCB(&readCb);
+    eventBase_.loop();
+    ASSERT_TRUE(client.handshakeSuccess_);
+    sslSession = std::move(sessionCbPtr->session_);
+    ASSERT_TRUE(sslSession != nullptr);
+    ASSERT_FALSE(clientPtr->getSSLSessionReused());
+  }
+
+  // Session resumption with the second server
+  {
+    NetworkSocket fds[2];
+    getfds(fds);
+    AsyncSSLSocket::UniquePtr clientSock(
+        new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+    auto clientPtr = clientSock.get();
+
+    clientPtr->setRawSSLSession(std::move(sslSession));
+
+    AsyncSSLSocket::UniquePtr serverSock(
+        new AsyncSSLSocket(otherServerCtx, &eventBase_, fds[1], true));
+    SSLHandshakeClient client(std::move(clientSock), false, false);
+    SSLHandshakeServerParseClientHello server(
+        std::move(serverSock), false, false);
+
+    eventBase_.loop();
+    ASSERT_TRUE(client.handshakeSuccess_);
+    ASSERT_TRUE(clientPtr->getSSLSessionReused());
+  }
+  auto handler = static_cast<ssl::TLSTicketKeyHandler*>(
+      otherServerCtx->getTicketHandler());
+  EXPECT_EQ(1, handler->getStats().decrypted);
+}
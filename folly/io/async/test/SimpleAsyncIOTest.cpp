@@ -24,6 +24,7 @@
 #include <folly/coro/Collect.h>
 #include <folly/io/IOBuf.h>
 #include <folly/portability/GTest.h>
+#include <folly/portability/SysStat.h>
 #include <folly/synchronization/Baton.h>
 
 #include <glog/logging.h>
@@ -160,6 +161,86 @@ TEST_P(SimpleAsyncIOTest, DestroyWithPendingIO) {
   ASSERT_EQ(completed, numWrites);
 }
 
+TEST_P(SimpleAsyncIOTest, SubmitBatching) {
+  auto tmpfile = File::temporary();
+  int fd = tmpfile.fd();
+  static const size_t bufferSize = 128;
+  static const size_t numWrites = 100;
+  std::array<uint8_t, bufferSize> buffer;
+  memset(buffer.data(), 0, buffer.size());
+  std::atomic<uint32_t> completed = 0;
+  Baton done;
+
+  SimpleAsyncIO aio(config_.setSubmitBatching(true));
+  for (size_t i = 0; i < numWrites; ++i) {
+    aio.pwrite(
+        fd,
+        buffer.data(),
+        bufferSize,
+        i * bufferSize,
+        [&completed, &done](int rc) {
+          ASSERT_EQ(rc, bufferSize);
+          if (++completed == numWrites) {
+            done.post();
+          }
+        });
+  }
+  ASSERT_TRUE(done.try_wait_for(std::chrono::seconds(10)));
+
+  auto stats = aio.getStats();
+  EXPECT_EQ(stats.numOpsSubmitted, numWrites);
+  EXPECT_LE(stats.numSubmits, stats.numOpsSubmitted);
+  ASSERT_EQ(stats.devices.size(), 1);
+  struct stat st;
+  ASSERT_EQ(::fstat(fd, &st), 0);
+  EXPECT_EQ(stats.devices[0].device, st.st_dev);
+  EXPECT_EQ(stats.devices[0].numOps, numWrites);
+  EXPECT_EQ(stats.devices[0].numErrors, 0);
+  EXPECT_EQ(stats.devices[0].numBytes, numWrites * bufferSize);
+  EXPECT_GE(stats.devices[0].totalLatency, stats.devices[0].maxLatency);
+}
+
+TEST_P(SimpleAsyncIOTest, AdaptiveQueueDepth) {
+  auto tmpfile = File::temporary();
+  int fd = tmpfile.fd();
+  static const size_t bufferSize = 4096;
+  static const size_t numWrites = 1000;
+  std::array<uint8_t, bufferSize> buffer;
+  memset(buffer.data(), 0, buffer.size());
+  std::atomic<uint32_t> completed = 0;
+  Baton done;
+
+  IoQueueDepthController::Options options;
+  options.initialDepth = 2;
+  options.maxDepth = 64;
+  // Unlike with a fixed depth, the IO above the current depth waits in the
+  // queue instead of failing with -EBUSY.
+  SimpleAsyncIO aio(
+      config_.setMaxRequests(numWrites).setAdaptiveQueueDepth(options));
+  for (size_t i = 0; i < numWrites; ++i) {
+    aio.pwrite(
+        fd,
+        buffer.data(),
+        bufferSize,
+        i * bufferSize,
+        [&completed, &done](int rc) {
+          ASSERT_EQ(rc, bufferSize);
+          if (++completed == numWrites) {
+            done.post();
+          }
+        });
+  }
+  ASSERT_TRUE(done.try_wait_for(std::chrono::seconds(60)));
+
+  auto stats = aio.getStats();
+  EXPECT_EQ(stats.numOpsSubmitted, numWrites);
+  EXPECT_GE(stats.queueDepth, 1);
+  EXPECT_LE(stats.queueDepth, 64);
+  EXPECT_GT(stats.minLatency.count(), 0);
+  ASSERT_EQ(stats.devices.size(), 1);
+  EXPECT_EQ(stats.devices[0].numOps, numWrites);
+}
+
 #if FOLLY_HAS_COROUTINES
 static folly::coro::Task<folly::Unit> doCoAsyncWrites(
     SimpleAsyncIO& aio, int fd, std::string const& data, int copies) {
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/coro/File.h>
+
+#include <fcntl.h>
+#include <limits.h>
+
+#include <folly/CancellationToken.h>
+#include <folly/Exception.h>
+#include <folly/coro/Baton.h>
+#include <folly/io/async/IoUringEventBaseLocal.h>
+#include <folly/portability/SysUio.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+namespace folly {
+namespace coro {
+
+namespace detail {
+
+// Completes the awaiting coroutine with the cqe result. A reference to itself
+// is held while the operation is in the ring, so that it outlives the
+// coroutine being resumed from done().
+struct IoUringFileSqe : IoSqeBase {
+  void callback(const io_uring_cqe* cqe) noexcept override { done(cqe->res); }
+
+  void callbackCancelled(const io_uring_cqe* cqe) noexcept override {
+    done(cqe->res);
+  }
+
+  void done(int res) noexcept {
+    res_ = res;
+    auto self = std::move(self_);
+    baton_.post();
+  }
+
+  int res_{0};
+  Baton baton_;
+  std::shared_ptr<IoUringFileSqe> self_;
+};
+
+} // namespace detail
+
+namespace {
+
+struct ReadvSqe final : detail::IoUringFileSqe {
+  ReadvSqe(int fd, off_t offset, std::vector<struct iovec> iov)
+      : fd_(fd), offset_(offset), iov_(std::move(iov)) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_readv(
+        sqe, fd_, iov_.data(), (unsigned int)iov_.size(), offset_);
+  }
+
+  int fd_;
+  off_t offset_;
+  std::vector<struct iovec> iov_;
+};
+
+struct WritevSqe final : detail::IoUringFileSqe {
+  WritevSqe(int fd, off_t offset, const struct iovec* iov, size_t num)
+      : fd_(fd), offset_(offset), iov_(iov), num_(num) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_writev(sqe, fd_, iov_, (unsigned int)num_, offset_);
+  }
+
+  int fd_;
+  off_t offset_;
+  const struct iovec* iov_;
+  size_t num_;
+};
+
+struct FsyncSqe final : detail::IoUringFileSqe {
+  FsyncSqe(int fd, unsigned int flags) : fd_(fd), flags_(flags) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_fsync(sqe, fd_, flags_);
+  }
+
+  int fd_;
+  unsigned int flags_;
+};
+
+struct FallocateSqe final : detail::IoUringFileSqe {
+  FallocateSqe(int fd, int mode, off_t offset, off_t len)
+      : fd_(fd), mode_(mode), offset_(offset), len_(len) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_fallocate(sqe, fd_, mode_, offset_, len_);
+  }
+
+  int fd_;
+  int mode_;
+  off_t offset_;
+  off_t len_;
+};
+
+struct FadviseSqe final : detail::IoUringFileSqe {
+  FadviseSqe(int fd, off_t offset, off_t len, int advice)
+      : fd_(fd), offset_(offset), len_(len), advice_(advice) {}
+
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_fadvise(sqe, fd_, offset_, len_, advice_);
+  }
+
+  int fd_;
+  off_t offset_;
+  off_t len_;
+  int advice_;
+};
+
+IoUringBackend* getBackendFromEventBase(EventBase* evb) {
+  auto* b = IoUringEventBaseLocal::try_get(evb);
+  if (!b) {
+    b = dynamic_cast<IoUringBackend*>(evb->getBackend());
+  }
+  if (!b) {
+    throw std::invalid_argument("coro::File needs an IoUringBackend");
+  }
+  return b;
+}
+
+void checkResult(int res, const char* what) {
+  if (res < 0) {
+    throwSystemErrorExplicit(-res, what);
+  }
+}
+
+} // namespace
+
+File::File(EventBase* evb, folly::File file)
+    : evb_(evb),
+      backend_(getBackendFromEventBase(evb)),
+      file_(std::move(file)) {}
+
+Task<int> File::submit(std::shared_ptr<detail::IoUringFileSqe> sqe) {
+  auto token = co_await co_current_cancellation_token;
+  auto* backend = backend_;
+  evb_->runInEventBaseThread([backend, sqe]() mutable {
+    sqe->self_ = sqe;
+    // preps the sqe right away so that a cancellation can find it
+    backend->submitSoon(*sqe);
+  });
+  {
+    CancellationCallback cancelCallback(
+        token, [evb = evb_, backend, sqe]() mutable {
+          evb->runInEventBaseThread([backend, sqe = std::move(sqe)] {
+            if (sqe->inFlight() && !sqe->cancelled()) {
+              backend->cancel(sqe.get());
+            }
+          });
+        });
+    co_await sqe->baton_;
+  }
+  if (sqe->res_ == -ECANCELED && token.isCancellationRequested()) {
+    co_yield co_error(OperationCancelled{});
+  }
+  co_return sqe->res_;
+}
+
+Task<std::unique_ptr<IOBuf>> File::read(off_t offset, size_t len) {
+  return readv(offset, len, len);
+}
+
+Task<std::unique_ptr<IOBuf>> File::readv(
+    off_t offset, size_t len, size_t blockSize) {
+  if (len == 0) {
+    co_return IOBuf::create(0);
+  }
+  if (blockSize == 0 || (len + blockSize - 1) / blockSize > IOV_MAX) {
+    throw std::invalid_argument("coro::File::readv invalid block size");
+  }
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  std::vector<struct iovec> iov;
+  for (size_t left = len; left > 0;) {
+    size_t n = std::min(left, blockSize);
+    bufs.push_back(IOBuf::create(n));
+    iov.push_back({bufs.back()->writableTail(), n});
+    left -= n;
+  }
+  int res = co_await submit(
+      std::make_shared<ReadvSqe>(file_.fd(), offset, std::move(iov)));
+  checkResult(res, "coro::File preadv failed");
+
+  std::unique_ptr<IOBuf> ret;
+  for (size_t left = size_t(res), i = 0; left > 0; i++) {
+    size_t n = std::min(left, bufs[i]->tailroom());
+    bufs[i]->append(n);
+    left -= n;
+    if (ret) {
+      ret->appendToChain(std::move(bufs[i]));
+    } else {
+      ret = std::move(bufs[i]);
+    }
+  }
+  co_return ret ? std::move(ret) : IOBuf::create(0);
+}
+
+Task<size_t> File::write(off_t offset, ByteRange buf) {
+  std::vector<struct iovec> iov;
+  if (!buf.empty()) {
+    iov.push_back({const_cast<uint8_t*>(buf.data()), buf.size()});
+  }
+  return writeIov(offset, std::move(iov));
+}
+
+Task<size_t> File::writev(off_t offset, const IOBuf& buf) {
+  std::vector<struct iovec> iov;
+  for (auto range : buf) {
+    if (!range.empty()) {
+      iov.push_back({const_cast<uint8_t*>(range.data()), range.size()});
+    }
+  }
+  return writeIov(offset, std::move(iov));
+}
+
+Task<size_t> File::writeIov(off_t offset, std::vector<struct iovec> iov) {
+  size_t written = 0;
+  size_t first = 0;
+  while (first < iov.size()) {
+    size_t num = std::min<size_t>(iov.size() - first, IOV_MAX);
+    int res = co_await submit(std::make_shared<WritevSqe>(
+        file_.fd(), offset + written, iov.data() + first, num));
+    checkResult(res, "coro::File pwritev failed");
+    if (res == 0) {
+      throwSystemErrorExplicit(EIO, "coro::File pwritev made no progress");
+    }
+    written += res;
+    for (size_t n = size_t(res); n > 0;) {
+      auto& v = iov[first];
+      if (n >= v.iov_len) {
+        n -= v.iov_len;
+        first++;
+      } else {
+        v.iov_base = static_cast<char*>(v.iov_base) + n;
+        v.iov_len -= n;
+        n = 0;
+      }
+    }
+  }
+  co_return written;
+}
+
+Task<Unit> File::fsync() {
+  int res = co_await submit(std::make_shared<FsyncSqe>(file_.fd(), 0));
+  checkResult(res, "coro::File fsync failed");
+  co_return unit;
+}
+
+Task<Unit> File::fdatasync() {
+  int res = co_await submit(
+      std::make_shared<FsyncSqe>(file_.fd(), IORING_FSYNC_DATASYNC));
+  checkResult(res, "coro::File fdatasync failed");
+  co_return unit;
+}
+
+Task<Unit> File::fallocate(int mode, off_t offset, off_t len) {
+  int res = co_await submit(
+      std::make_shared<FallocateSqe>(file_.fd(), mode, offset, len));
+  checkResult(res, "coro::File fallocate failed");
+  co_return unit;
+}
+
+Task<Unit> File::readahead(off_t offset, off_t len) {
+  int res = co_await submit(std::make_shared<FadviseSqe>(
+      file_.fd(), offset, len, POSIX_FADV_WILLNEED));
+  checkResult(res, "coro::File readahead failed");
+  co_return unit;
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <folly/File.h>
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/Unit.h>
+#include <folly/coro/Task.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/IoUringBackend.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+namespace folly {
+namespace coro {
+
+namespace detail {
+struct IoUringFileSqe;
+} // namespace detail
+
+/**
+ * A file whose I/O is issued through the IoUringBackend of an EventBase.
+ *
+ * Every operation may be awaited from any thread: it is submitted from the
+ * EventBase thread and the awaiting coroutine resumes on its own executor.
+ * Errors are reported by throwing std::system_error.
+ *
+ * Operations honour the cancellation token of the awaiting coroutine: the
+ * request is cancelled in the kernel (IORING_OP_ASYNC_CANCEL) and, if it had
+ * not completed yet, the operation throws folly::OperationCancelled. Either
+ * way an operation only returns once the kernel is done with its buffers.
+ *
+ * Usage:
+ *
+ *   coro::File file(evb, folly::File("/data/log", O_RDWR | O_CREAT));
+ *   co_await file.write(0, folly::StringPiece("hello"));
+ *   co_await file.fdatasync();
+ *   auto buf = co_await file.read(0, 5);
+ */
+class File {
+ public:
+  // evb must be driven by an IoUringBackend, or own one attached with
+  // IoUringEventBaseLocal. Throws std::invalid_argument otherwise.
+  File(EventBase* evb, folly::File file);
+
+  File(File&&) = default;
+  File& operator=(File&&) = default;
+
+  EventBase* getEventBase() const noexcept { return evb_; }
+  int fd() const noexcept { return file_.fd(); }
+
+  // Reads up to len bytes at offset into a single buffer. The result is
+  // shorter than len at end of file.
+  Task<std::unique_ptr<IOBuf>> read(off_t offset, size_t len);
+
+  // Reads up to len bytes at offset with one preadv, into a chain of buffers
+  // of at most blockSize bytes each. Only buffers that received data are
+  // part of the result; it is a single empty IOBuf at end of file.
+  Task<std::unique_ptr<IOBuf>> readv(
+      off_t offset, size_t len, size_t blockSize);
+
+  // Writes all of buf at offset and returns the number of bytes written.
+  // Short writes are resubmitted. buf must stay valid until this completes.
+  Task<size_t> write(off_t offset, ByteRange buf);
+
+  // Same as write(), gathering the whole chain with pwritev.
+  Task<size_t> writev(off_t offset, const IOBuf& buf);
+
+  Task<Unit> fsync();
+  Task<Unit> fdatasync();
+
+  // Same as fallocate(2).
+  Task<Unit> fallocate(int mode, off_t offset, off_t len);
+
+  // Hints that [offset, offset + len) will be read soon
+  // (POSIX_FADV_WILLNEED), which starts readahead into the page cache.
+  Task<Unit> readahead(off_t offset, off_t len);
+
+ private:
+  // Returns the io_uring_cqe res of sqe.
+  Task<int> submit(std::shared_ptr<detail::IoUringFileSqe> sqe);
+
+  Task<size_t> writeIov(off_t offset, std::vector<struct iovec> iov);
+
+  EventBase* evb_;
+  IoUringBackend* backend_;
+  folly::File file_;
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
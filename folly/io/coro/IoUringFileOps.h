@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <folly/Portability.h>
+#include <folly/coro/Baton.h>
+#include <folly/coro/Task.h>
+#include <folly/io/async/IoUringBackend.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+namespace folly {
+namespace coro {
+
+// Submits ops as one linked chain and completes with the io_uring_cqe res of
+// each operation, in order. Must be awaited on the thread of the EventBase
+// owning backend. The chain is not cancellable: it always runs to completion,
+// since the kernel may still be using its buffers.
+inline Task<std::vector<int>> co_queueLinked(
+    IoUringBackend& backend, IoUringBackend::LinkedFileOps ops) {
+  Baton baton;
+  std::vector<int> results;
+  backend.queueLinked(std::move(ops), [&](std::vector<int> res) {
+    results = std::move(res);
+    baton.post();
+  });
+  co_await baton;
+  co_return results;
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
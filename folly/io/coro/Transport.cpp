@@ -16,8 +16,12 @@
 
 #include <folly/Portability.h>
 
+#include <array>
+#include <cstring>
 #include <functional>
+#include <optional>
 
+#include <folly/io/Cursor.h>
 #include <folly/io/coro/Transport.h>
 #include <folly/io/coro/TransportCallbacks.h>
 
@@ -28,6 +32,159 @@ using namespace folly::coro;
 namespace folly {
 namespace coro {
 
+namespace {
+
+// Read sizes used by the frame helpers.
+constexpr size_t kFrameMinReadSize = 4000;
+constexpr size_t kFrameNewAllocationSize = 16384;
+
+// Chains with more buffers are written from a heap allocated iovec array.
+constexpr size_t kSmallWriteIovecs = 64;
+
+// Whether 'delimiter' starts at 'offset' in 'buf', possibly continuing into
+// the following buffers of the chain starting at 'head'.
+bool delimiterAt(
+    const IOBuf* head, const IOBuf* buf, size_t offset, ByteRange delimiter) {
+  while (true) {
+    auto n = std::min(buf->length() - offset, delimiter.size());
+    if (std::memcmp(buf->data() + offset, delimiter.data(), n) != 0) {
+      return false;
+    }
+    delimiter.advance(n);
+    if (delimiter.empty()) {
+      return true;
+    }
+    buf = buf->next();
+    if (buf == head) {
+      return false;
+    }
+    offset = 0;
+  }
+}
+
+// Returns the offset of the first 'delimiter' at or after 'start' in the
+// chain, without coalescing it, if there is one.
+std::optional<size_t> findDelimiter(
+    const IOBuf& head, ByteRange delimiter, size_t start) {
+  size_t base = 0;
+  const IOBuf* buf = &head;
+  do {
+    if (start < base + buf->length()) {
+      auto begin = buf->data() + (start > base ? start - base : 0);
+      auto end = buf->tail();
+      while (auto p = static_cast<const uint8_t*>(
+                 std::memchr(begin, delimiter[0], end - begin))) {
+        if (delimiterAt(&head, buf, p - buf->data(), delimiter)) {
+          return base + (p - buf->data());
+        }
+        begin = p + 1;
+      }
+    }
+    base += buf->length();
+    buf = buf->next();
+  } while (buf != &head);
+  return std::nullopt;
+}
+
+} // namespace
+
+Task<std::unique_ptr<IOBuf>> TransportIf::readUntil(
+    IOBufQueue& buf,
+    ByteRange delimiter,
+    size_t maxFrameSize,
+    std::chrono::milliseconds timeout) {
+  DCHECK(!delimiter.empty());
+  // Only the new data, and the end of the old one that may hold the start of
+  // the delimiter, needs to be searched after each read.
+  size_t searchStart = 0;
+  while (true) {
+    auto length = buf.chainLength();
+    if (length > 0) {
+      auto pos = findDelimiter(*buf.front(), delimiter, searchStart);
+      auto frameSize = pos ? *pos + delimiter.size() : length + 1;
+      if (frameSize > maxFrameSize) {
+        co_yield co_error(AsyncSocketException(
+            AsyncSocketException::CORRUPTED_DATA,
+            "Frame larger than the maximum frame size"));
+      }
+      if (pos) {
+        co_return buf.split(frameSize);
+      }
+      searchStart =
+          length >= delimiter.size() ? length - delimiter.size() + 1 : 0;
+    }
+    auto bytesRead = co_await read(
+        buf, kFrameMinReadSize, kFrameNewAllocationSize, timeout);
+    if (bytesRead == 0) {
+      if (buf.empty()) {
+        co_return nullptr;
+      }
+      co_yield co_error(AsyncSocketException(
+          AsyncSocketException::END_OF_FILE, "EOF in the middle of a frame"));
+    }
+  }
+}
+
+Task<std::unique_ptr<IOBuf>> TransportIf::readLengthPrefixed(
+    IOBufQueue& buf,
+    size_t lengthFieldSize,
+    size_t maxFrameSize,
+    std::chrono::milliseconds timeout) {
+  DCHECK(
+      lengthFieldSize == 1 || lengthFieldSize == 2 || lengthFieldSize == 4 ||
+      lengthFieldSize == 8);
+  std::optional<size_t> frameSize;
+  while (true) {
+    auto length = buf.chainLength();
+    if (!frameSize && length >= lengthFieldSize) {
+      io::Cursor cursor(buf.front());
+      uint64_t value = 0;
+      switch (lengthFieldSize) {
+        case 1:
+          value = cursor.read<uint8_t>();
+          break;
+        case 2:
+          value = cursor.readBE<uint16_t>();
+          break;
+        case 4:
+          value = cursor.readBE<uint32_t>();
+          break;
+        default:
+          value = cursor.readBE<uint64_t>();
+          break;
+      }
+      if (value > maxFrameSize) {
+        co_yield co_error(AsyncSocketException(
+            AsyncSocketException::CORRUPTED_DATA,
+            "Frame larger than the maximum frame size"));
+      }
+      frameSize = size_t(value);
+    }
+    if (frameSize && length >= lengthFieldSize + *frameSize) {
+      buf.trimStart(lengthFieldSize);
+      co_return buf.split(*frameSize);
+    }
+    // Once the size is known, read the rest of a large frame into as few
+    // buffers as possible.
+    auto minReadSize = kFrameMinReadSize;
+    if (frameSize) {
+      minReadSize = std::max(
+          minReadSize,
+          std::min(
+              lengthFieldSize + *frameSize - length, kFrameNewAllocationSize));
+    }
+    auto bytesRead =
+        co_await read(buf, minReadSize, kFrameNewAllocationSize, timeout);
+    if (bytesRead == 0) {
+      if (buf.empty()) {
+        co_return nullptr;
+      }
+      co_yield co_error(AsyncSocketException(
+          AsyncSocketException::END_OF_FILE, "EOF in the middle of a frame"));
+    }
+  }
+}
+
 Task<Transport> Transport::newConnectedSocket(
     folly::EventBase* evb,
     const folly::SocketAddress& destAddr,
@@ -144,8 +301,45 @@ Task<folly::Unit> Transport::write(
     WriteInfo* writeInfo) {
   transport_->setSendTimeout(timeout.count());
   WriteCallback cb{*transport_};
-  auto iovec = ioBufQueue.front()->getIov();
-  transport_->writev(&cb, iovec.data(), iovec.size(), writeFlags);
+  if (auto front = ioBufQueue.front()) {
+    // AsyncSocket copies the iovecs if it can't write everything at once, so
+    // the usual short chains don't need a heap allocated array.
+    std::array<iovec, kSmallWriteIovecs> smallIovec;
+    auto res = front->fillIov(smallIovec.data(), smallIovec.size());
+    if (res.numIovecs > 0 || front->empty()) {
+      transport_->writev(&cb, smallIovec.data(), res.numIovecs, writeFlags);
+    } else {
+      auto iovec = front->getIov();
+      transport_->writev(&cb, iovec.data(), iovec.size(), writeFlags);
+    }
+  } else {
+    transport_->writev(&cb, nullptr, 0, writeFlags);
+  }
+  auto waitRet = co_await co_awaitTry(cb.wait());
+  if (waitRet.hasException()) {
+    if (writeInfo) {
+      writeInfo->bytesWritten = cb.bytesWritten;
+    }
+    co_yield co_error(std::move(waitRet.exception()));
+  }
+
+  if (cb.error) {
+    if (writeInfo) {
+      writeInfo->bytesWritten = cb.bytesWritten;
+    }
+    co_yield co_error(std::move(*cb.error));
+  }
+  co_return unit;
+}
+
+Task<folly::Unit> Transport::write(
+    std::unique_ptr<IOBuf> buf,
+    std::chrono::milliseconds timeout,
+    folly::WriteFlags writeFlags,
+    WriteInfo* writeInfo) {
+  transport_->setSendTimeout(timeout.count());
+  WriteCallback cb{*transport_};
+  transport_->writeChain(&cb, std::move(buf), writeFlags);
   auto waitRet = co_await co_awaitTry(cb.wait());
   if (waitRet.hasException()) {
     if (writeInfo) {
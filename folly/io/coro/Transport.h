@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <folly/Range.h>
 #include <folly/SocketAddress.h>
 #include <folly/coro/Task.h>
@@ -40,12 +42,37 @@ class TransportIf {
       void* buf, size_t buflen, std::chrono::milliseconds timeout) {
     return read(MutableByteRange((unsigned char*)buf, buflen), timeout);
   }
+  // Reads into the tail of 'buf', reusing its tailroom and allocating new
+  // buffers with at least 'newAllocationSize' bytes (from the allocator of the
+  // queue if it has one, e.g. an IOBufPool) only when less than 'minReadSize'
+  // bytes are left. 'buf' must cache its chain length.
   virtual Task<size_t> read(
       IOBufQueue& buf,
       size_t minReadSize,
       size_t newAllocationSize,
       std::chrono::milliseconds timeout) = 0;
 
+  // Reads into 'buf' until it holds 'delimiter', and returns the data up to
+  // and including the delimiter, split off the front of 'buf' without
+  // copying. The data after it stays in 'buf' for the next call. Returns
+  // nullptr on EOF when 'buf' is empty. Fails with END_OF_FILE on EOF in the
+  // middle of a frame, and with CORRUPTED_DATA if the frame would be larger
+  // than 'maxFrameSize'. 'timeout' applies to each read.
+  Task<std::unique_ptr<IOBuf>> readUntil(
+      IOBufQueue& buf,
+      ByteRange delimiter,
+      size_t maxFrameSize,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+  // Like readUntil(), but for frames prefixed with their length, as a
+  // big-endian integer of 'lengthFieldSize' (1, 2, 4 or 8) bytes. Returns the
+  // frame without its length field.
+  Task<std::unique_ptr<IOBuf>> readLengthPrefixed(
+      IOBufQueue& buf,
+      size_t lengthFieldSize,
+      size_t maxFrameSize,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
   struct WriteInfo {
     size_t bytesWritten{0};
   };
@@ -60,6 +87,17 @@ class TransportIf {
       std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
       folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
       WriteInfo* writeInfo = nullptr) = 0;
+  // Writes the whole chain with a single writev(), taking ownership of the
+  // buffers until the write completes.
+  virtual Task<Unit> write(
+      std::unique_ptr<IOBuf> buf,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+      folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
+      WriteInfo* writeInfo = nullptr) {
+    IOBufQueue ioBufQueue;
+    ioBufQueue.append(std::move(buf));
+    co_return co_await write(ioBufQueue, timeout, writeFlags, writeInfo);
+  }
 
   virtual SocketAddress getLocalAddress() const noexcept = 0;
 
@@ -113,6 +151,11 @@ class Transport : public TransportIf {
       std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
       folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
       WriteInfo* writeInfo = nullptr) override;
+  Task<folly::Unit> write(
+      std::unique_ptr<IOBuf> buf,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+      folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
+      WriteInfo* writeInfo = nullptr) override;
 
   AsyncTransport* getTransport() const override { return transport_.get(); }
 
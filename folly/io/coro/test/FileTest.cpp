@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/Portability.h>
+
+#include <folly/CancellationToken.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/WithCancellation.h>
+#include <folly/io/coro/File.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Unistd.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+using namespace folly;
+using namespace folly::coro;
+
+class CoroFileTest : public testing::Test {
+ public:
+  void SetUp() override {
+    try {
+      evb_ = std::make_unique<EventBase>(
+          EventBase::Options().setBackendFactory([] {
+            return std::make_unique<IoUringBackend>(IoUringBackend::Options());
+          }));
+    } catch (const IoUringBackend::NotAvailable&) {
+      GTEST_SKIP() << "io_uring not available";
+    }
+  }
+
+  template <typename F>
+  void run(F f) {
+    blockingWait(co_invoke(std::move(f)), evb_.get());
+  }
+
+  coro::File tempFile() {
+    return coro::File(evb_.get(), folly::File::temporary());
+  }
+
+  std::unique_ptr<EventBase> evb_;
+};
+
+TEST_F(CoroFileTest, WriteRead) {
+  auto file = tempFile();
+  run([&]() -> Task<> {
+    std::string data(10000, 'a');
+    for (size_t i = 0; i < data.size(); i++) {
+      data[i] += i % 26;
+    }
+    co_await file.fallocate(0, 0, 16384);
+    EXPECT_EQ(co_await file.write(0, StringPiece(data)), data.size());
+    co_await file.fdatasync();
+    co_await file.readahead(0, data.size());
+
+    auto buf = co_await file.read(0, data.size());
+    EXPECT_FALSE(buf->isChained());
+    EXPECT_EQ(buf->moveToFbString(), data);
+
+    auto chain = co_await file.readv(100, 5000, 1024);
+    EXPECT_EQ(chain->countChainElements(), 5);
+    EXPECT_EQ(chain->computeChainDataLength(), 5000);
+    EXPECT_EQ(chain->moveToFbString(), data.substr(100, 5000));
+
+    co_await file.fsync();
+  });
+}
+
+TEST_F(CoroFileTest, Writev) {
+  auto file = tempFile();
+  run([&]() -> Task<> {
+    auto chain = IOBuf::copyBuffer("hello ");
+    chain->appendToChain(IOBuf::create(0));
+    chain->appendToChain(IOBuf::copyBuffer("world"));
+    EXPECT_EQ(co_await file.writev(10, *chain), 11);
+
+    auto buf = co_await file.read(10, 100);
+    EXPECT_EQ(buf->moveToFbString(), "hello world");
+  });
+}
+
+TEST_F(CoroFileTest, ReadPastEof) {
+  auto file = tempFile();
+  run([&]() -> Task<> {
+    co_await file.write(0, StringPiece("abc"));
+
+    auto chain = co_await file.readv(0, 4096, 2);
+    EXPECT_EQ(chain->countChainElements(), 2);
+    EXPECT_EQ(chain->moveToFbString(), "abc");
+
+    auto empty = co_await file.read(100, 10);
+    EXPECT_EQ(empty->length(), 0);
+    EXPECT_FALSE(empty->isChained());
+  });
+}
+
+TEST_F(CoroFileTest, Error) {
+  auto file = coro::File(evb_.get(), folly::File("/dev/null", O_RDONLY));
+  run([&]() -> Task<> {
+    bool threw = false;
+    try {
+      co_await file.write(0, StringPiece("abc"));
+    } catch (const std::system_error& ex) {
+      threw = true;
+      EXPECT_EQ(ex.code().value(), EBADF);
+    }
+    EXPECT_TRUE(threw);
+  });
+}
+
+TEST_F(CoroFileTest, Cancel) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  folly::File writeEnd(fds[1], true);
+  auto file = coro::File(evb_.get(), folly::File(fds[0], true));
+  run([&]() -> Task<> {
+    CancellationSource cancelSource;
+    evb_->runAfterDelay([&] { cancelSource.requestCancellation(); }, 10);
+    bool cancelled = false;
+    try {
+      co_await co_withCancellation(cancelSource.getToken(), file.read(0, 16));
+    } catch (const OperationCancelled&) {
+      cancelled = true;
+    }
+    EXPECT_TRUE(cancelled);
+
+    // the pipe is still usable
+    EXPECT_EQ(::write(writeEnd.fd(), "x", 1), 1);
+    auto buf = co_await file.read(0, 16);
+    EXPECT_EQ(buf->moveToFbString(), "x");
+  });
+}
+
+#endif
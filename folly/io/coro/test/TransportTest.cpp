@@ -18,11 +18,13 @@
 
 #include <folly/coro/BlockingWait.h>
 #include <folly/coro/Collect.h>
+#include <folly/io/IOBufPool.h>
 #include <folly/io/async/test/AsyncSocketTest.h>
 #include <folly/io/async/test/MockAsyncTransport.h>
 #include <folly/io/async/test/ScopedBoundPort.h>
 #include <folly/io/coro/ServerSocket.h>
 #include <folly/io/coro/Transport.h>
+#include <folly/lang/Bits.h>
 #include <folly/portability/GTest.h>
 
 #if FOLLY_HAS_COROUTINES
@@ -268,6 +270,116 @@ TEST_F(ServerTransportTest, SimpleWritev) {
   });
 }
 
+TEST_F(ServerTransportTest, WriteChain) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    constexpr auto kBufSize = 4096;
+    constexpr auto kNumBufs = 100;
+    std::string expected;
+    auto chain = IOBuf::create(0);
+    for (int i = 0; i < kNumBufs; ++i) {
+      std::string data(kBufSize, 'a' + i % 26);
+      chain->appendToChain(IOBuf::copyBuffer(data));
+      expected += data;
+    }
+
+    // more buffers than fit in the small iovec array
+    IOBufQueue sndBuf;
+    sndBuf.append(chain->clone());
+    co_await cs.write(sndBuf);
+    co_await cs.write(std::move(chain));
+
+    std::string rcvBuf(2 * expected.size(), '\0');
+    ss->readAll(reinterpret_cast<uint8_t*>(rcvBuf.data()), rcvBuf.size());
+    EXPECT_EQ(expected + expected, rcvBuf);
+  });
+}
+
+TEST_F(ServerTransportTest, ReadUntil) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    IOBufPool pool;
+    IOBufQueue::Options options;
+    options.cacheChainLength = true;
+    options.allocator = &pool;
+    IOBufQueue rcvBuf(options);
+
+    auto send = [&](StringPiece data) {
+      ss->write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    };
+    auto toString = [](std::unique_ptr<IOBuf> frame) {
+      return frame->moveToFbString().toStdString();
+    };
+
+    send("GET / HTTP/1.1\r\nHost: a\r");
+    auto frame = co_await cs.readUntil(rcvBuf, StringPiece("\r\n"), 1000);
+    EXPECT_EQ("GET / HTTP/1.1\r\n", toString(std::move(frame)));
+    // The delimiter is split across two reads
+    send("\n\r\n");
+    frame = co_await cs.readUntil(rcvBuf, StringPiece("\r\n"), 1000);
+    EXPECT_EQ("Host: a\r\n", toString(std::move(frame)));
+    frame = co_await cs.readUntil(rcvBuf, StringPiece("\r\n"), 1000);
+    EXPECT_EQ("\r\n", toString(std::move(frame)));
+    EXPECT_TRUE(rcvBuf.empty());
+
+    send(std::string(100, 'a'));
+    EXPECT_THROW(
+        co_await cs.readUntil(rcvBuf, StringPiece("\r\n"), 50),
+        AsyncSocketException);
+  });
+}
+
+TEST_F(ServerTransportTest, ReadLengthPrefixed) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    auto send = [&](StringPiece data) {
+      uint32_t length = Endian::big(uint32_t(data.size()));
+      ss->write(reinterpret_cast<const uint8_t*>(&length), sizeof(length));
+      ss->write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    };
+
+    IOBufQueue rcvBuf(IOBufQueue::cacheChainLength());
+    std::string large(100000, 'x');
+    send("hello");
+    send("");
+    send(large);
+    ss->close();
+
+    auto frame = co_await cs.readLengthPrefixed(rcvBuf, 4, 1 << 20);
+    EXPECT_EQ("hello", frame->moveToFbString());
+    frame = co_await cs.readLengthPrefixed(rcvBuf, 4, 1 << 20);
+    EXPECT_EQ(0, frame->computeChainDataLength());
+    frame = co_await cs.readLengthPrefixed(rcvBuf, 4, 1 << 20);
+    EXPECT_EQ(large, frame->moveToFbString().toStdString());
+    frame = co_await cs.readLengthPrefixed(rcvBuf, 4, 1 << 20);
+    EXPECT_EQ(nullptr, frame);
+  });
+}
+
+TEST_F(ServerTransportTest, ReadLengthPrefixedTooLarge) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    uint16_t length = Endian::big(uint16_t(1000));
+    ss->write(reinterpret_cast<const uint8_t*>(&length), sizeof(length));
+
+    IOBufQueue rcvBuf(IOBufQueue::cacheChainLength());
+    EXPECT_THROW(
+        co_await cs.readLengthPrefixed(rcvBuf, 2, 999), AsyncSocketException);
+  });
+}
+
 TEST_F(ServerTransportTest, WriteCancelled) {
   run([&]() -> Task<> {
     auto cs = co_await connect();
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/HugePageBufferArena.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+HugePageBufferArena::Options smallArena() {
+  HugePageBufferArena::Options options;
+  options.size = 4 * 1024 * 1024;
+  options.bufferSize = 64 * 1024;
+  return options;
+}
+
+bool inArena(const HugePageBufferArena& arena, const void* p) {
+  auto range = arena.range();
+  auto q = static_cast<const uint8_t*>(p);
+  return q >= range.begin() && q < range.end();
+}
+
+} // namespace
+
+TEST(HugePageBufferArena, Mapping) {
+  HugePageBufferArena arena{smallArena()};
+  auto range = arena.range();
+  EXPECT_GE(range.size(), 4 * 1024 * 1024);
+  EXPECT_EQ(0, range.size() % arena.pageSize());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(range.data()) % arena.pageSize());
+  // Writable everywhere.
+  std::memset(const_cast<uint8_t*>(range.data()), 1, range.size());
+}
+
+TEST(HugePageBufferArena, Hugetlb) {
+  auto options = smallArena();
+  options.hugePageSize = 2 * 1024 * 1024;
+  // Falls back to transparent huge pages if none are reserved.
+  HugePageBufferArena arena{options};
+  EXPECT_EQ(2 * 1024 * 1024, arena.pageSize());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.range().data()) % (1 << 21));
+  auto buf = arena.create(100);
+  EXPECT_TRUE(inArena(arena, buf->data()));
+}
+
+TEST(HugePageBufferArena, CreateAndReuse) {
+  HugePageBufferArena arena{smallArena()};
+  auto buf = arena.create(1500);
+  EXPECT_TRUE(inArena(arena, buf->data()));
+  EXPECT_EQ(64 * 1024, buf->capacity());
+  EXPECT_EQ(0, buf->length());
+  std::memset(buf->writableTail(), 'x', buf->tailroom());
+  auto data = buf->data();
+  buf.reset();
+  EXPECT_EQ(data, arena.create(64 * 1024)->data());
+
+  // Too large for the buffers.
+  auto large = arena.create(64 * 1024 + 1);
+  EXPECT_FALSE(inArena(arena, large->data()));
+  EXPECT_LE(64 * 1024 + 1, large->capacity());
+}
+
+TEST(HugePageBufferArena, Exhaustion) {
+  HugePageBufferArena arena{smallArena()};
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  size_t count = arena.range().size() / (64 * 1024);
+  for (size_t i = 0; i < count; ++i) {
+    bufs.push_back(arena.create(100));
+    ASSERT_TRUE(inArena(arena, bufs.back()->data()));
+  }
+  // Falls back to malloc() when full.
+  auto extra = arena.create(100);
+  EXPECT_FALSE(inArena(arena, extra->data()));
+  auto data = bufs.back()->data();
+  bufs.pop_back();
+  EXPECT_EQ(data, arena.create(100)->data());
+}
+
+TEST(HugePageBufferArena, Regions) {
+  HugePageBufferArena arena{smallArena()};
+  auto size = arena.range().size();
+  auto region = arena.allocateRegion(1);
+  ASSERT_NE(nullptr, region);
+  EXPECT_TRUE(inArena(arena, region));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(region) % arena.pageSize());
+  // Buffers and regions do not overlap.
+  auto buf = arena.create(100);
+  EXPECT_LT(buf->data() + buf->capacity(), static_cast<uint8_t*>(region));
+
+  EXPECT_EQ(nullptr, arena.allocateRegion(size));
+  std::vector<void*> regions;
+  while (auto r = arena.allocateRegion(arena.pageSize())) {
+    regions.push_back(r);
+  }
+  EXPECT_EQ(size / arena.pageSize() - 2, regions.size());
+}
+
+TEST(HugePageBufferArena, InvalidOptions) {
+  auto options = smallArena();
+  options.bufferSize = 1;
+  EXPECT_THROW(HugePageBufferArena{options}, std::invalid_argument);
+  options = smallArena();
+  options.hugePageSize = 3 * 1024 * 1024;
+  EXPECT_THROW(HugePageBufferArena{options}, std::invalid_argument);
+}
+
+TEST(HugePageBufferArena, CrossThreadFree) {
+  HugePageBufferArena arena{smallArena()};
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  for (int i = 0; i < 16; ++i) {
+    bufs.push_back(arena.create(100));
+  }
+  std::vector<std::thread> threads;
+  for (auto& buf : bufs) {
+    threads.emplace_back([b = std::move(buf)]() mutable { b.reset(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < 16; ++i) {
+    bufs[i] = arena.create(100);
+    EXPECT_TRUE(inArena(arena, bufs[i]->data()));
+  }
+}
+
+TEST(HugePageBufferArena, IOBufQueue) {
+  HugePageBufferArena arena{smallArena()};
+  auto options = IOBufQueue::cacheChainLength();
+  options.allocator = &arena;
+  IOBufQueue queue{options};
+
+  auto range = queue.preallocate(4000, 16000);
+  EXPECT_TRUE(inArena(arena, range.first));
+  EXPECT_EQ(64 * 1024, range.second);
+  queue.postallocate(4000);
+
+  std::string data(100000, 'a');
+  queue.append(data.data(), data.size());
+  EXPECT_EQ(104000, queue.chainLength());
+  for (auto& buf : *queue.front()) {
+    EXPECT_TRUE(inArena(arena, buf.data()));
+  }
+  queue.reset();
+  EXPECT_EQ(nullptr, queue.front());
+}
@@ -16,6 +16,7 @@
 
 #include <folly/Benchmark.h>
 #include <folly/io/IOBuf.h>
+#include <folly/io/IOBufPool.h>
 
 using folly::IOBuf;
 
@@ -146,6 +147,28 @@ BENCHMARK_NAMED_PARAM(createAndDestroyMulti, 16384, 16384)
 BENCHMARK_NAMED_PARAM(createAndDestroyMulti, 17000, 17000)
 BENCHMARK_DRAW_LINE();
 
+static void createAndDestroyMultiPooled(size_t iters, size_t size) {
+  static constexpr auto kSize = 1024;
+  folly::IOBufPool::Options options;
+  options.maxCachedPerClass = kSize;
+  folly::IOBufPool pool{options};
+  std::array<std::unique_ptr<IOBuf>, kSize> buffers;
+
+  while (iters--) {
+    for (auto i = 0; i < kSize; ++i) {
+      buffers[i] = pool.create(size);
+    }
+  }
+}
+
+BENCHMARK_NAMED_PARAM(createAndDestroyMulti, 2K, 2048)
+BENCHMARK_RELATIVE_NAMED_PARAM(createAndDestroyMultiPooled, 2K, 2048)
+BENCHMARK_NAMED_PARAM(createAndDestroyMulti, 16K, 16384)
+BENCHMARK_RELATIVE_NAMED_PARAM(createAndDestroyMultiPooled, 16K, 16384)
+BENCHMARK_NAMED_PARAM(createAndDestroyMulti, 64K, 65536)
+BENCHMARK_RELATIVE_NAMED_PARAM(createAndDestroyMultiPooled, 64K, 65536)
+BENCHMARK_DRAW_LINE();
+
 /**
  * folly/io/test:iobuf_benchmark -- --bm_min_iters 100000
  *  ============================================================================
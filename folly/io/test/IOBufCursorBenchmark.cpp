@@ -14,9 +14,17 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <string>
+#include <vector>
+
 #include <folly/Benchmark.h>
 #include <folly/Format.h>
+#include <folly/Random.h>
 #include <folly/Range.h>
+#include <folly/Varint.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/lang/Keep.h>
@@ -190,6 +198,124 @@ BENCHMARK_RELATIVE(prefix, iters) {
   }
 }
 
+constexpr size_t kBulkCount = 1000;
+unique_ptr<IOBuf> iobuf_bulk_benchmark;
+unique_ptr<IOBuf> iobuf_bulk_chain_benchmark;
+unique_ptr<IOBuf> iobuf_varint_benchmark;
+unique_ptr<IOBuf> iobuf_varint_chain_benchmark;
+
+unique_ptr<IOBuf> splitBuffer(folly::ByteRange data, size_t chunk) {
+  auto buf = IOBuf::copyBuffer(data.data(), std::min(chunk, data.size()));
+  for (size_t offset = chunk; offset < data.size(); offset += chunk) {
+    buf->appendToChain(IOBuf::copyBuffer(
+        data.data() + offset, std::min(chunk, data.size() - offset)));
+  }
+  return buf;
+}
+
+void readBEScalar(const IOBuf* buf, size_t iters) {
+  std::array<uint32_t, kBulkCount> values;
+  while (iters--) {
+    Cursor c(buf);
+    for (auto& value : values) {
+      value = c.readBE<uint32_t>();
+    }
+    folly::doNotOptimizeAway(values);
+  }
+}
+
+void readBESpan(const IOBuf* buf, size_t iters) {
+  std::array<uint32_t, kBulkCount> values;
+  while (iters--) {
+    Cursor c(buf);
+    c.readBE(folly::span<uint32_t>(values));
+    folly::doNotOptimizeAway(values);
+  }
+}
+
+BENCHMARK(readBEScalarContiguous, iters) {
+  readBEScalar(iobuf_bulk_benchmark.get(), iters);
+}
+
+BENCHMARK_RELATIVE(readBESpanContiguous, iters) {
+  readBESpan(iobuf_bulk_benchmark.get(), iters);
+}
+
+BENCHMARK(readBEScalarChain, iters) {
+  readBEScalar(iobuf_bulk_chain_benchmark.get(), iters);
+}
+
+BENCHMARK_RELATIVE(readBESpanChain, iters) {
+  readBESpan(iobuf_bulk_chain_benchmark.get(), iters);
+}
+
+void readVarintScalar(const IOBuf* buf, size_t iters) {
+  std::array<uint64_t, kBulkCount> values;
+  while (iters--) {
+    Cursor c(buf);
+    for (auto& value : values) {
+      value = 0;
+      for (unsigned shift = 0;; shift += 7) {
+        auto byte = c.read<uint8_t>();
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+          break;
+        }
+      }
+    }
+    folly::doNotOptimizeAway(values);
+  }
+}
+
+void readVarintSpan(const IOBuf* buf, size_t iters) {
+  std::array<uint64_t, kBulkCount> values;
+  while (iters--) {
+    Cursor c(buf);
+    c.readVarints(folly::span<uint64_t>(values));
+    folly::doNotOptimizeAway(values);
+  }
+}
+
+BENCHMARK(readVarintScalarContiguous, iters) {
+  readVarintScalar(iobuf_varint_benchmark.get(), iters);
+}
+
+BENCHMARK_RELATIVE(readVarintsContiguous, iters) {
+  readVarintSpan(iobuf_varint_benchmark.get(), iters);
+}
+
+BENCHMARK(readVarintScalarChain, iters) {
+  readVarintScalar(iobuf_varint_chain_benchmark.get(), iters);
+}
+
+BENCHMARK_RELATIVE(readVarintsChain, iters) {
+  readVarintSpan(iobuf_varint_chain_benchmark.get(), iters);
+}
+
+BENCHMARK(writeBEScalar, iters) {
+  std::array<uint32_t, kBulkCount> values{};
+  folly::IOBufQueue queue;
+  while (iters--) {
+    QueueAppender appender(&queue, 4096);
+    for (auto value : values) {
+      appender.writeBE(value);
+    }
+    folly::doNotOptimizeAway(queue.front());
+    queue.reset();
+  }
+}
+
+BENCHMARK_RELATIVE(writeBESpan, iters) {
+  std::array<uint32_t, kBulkCount> values{};
+  folly::IOBufQueue queue;
+  while (iters--) {
+    QueueAppender appender(&queue, 4096);
+    appender.writeBE(folly::span<const uint32_t>(values));
+    folly::doNotOptimizeAway(queue.front());
+    queue.reset();
+  }
+}
+
 /**
  * ============================================================================
  * folly/io/test/IOBufCursorBenchmark.cpp          relative  time/iter  iters/s
@@ -218,6 +344,26 @@ int main(int argc, char** argv) {
     iobuf_read_benchmark->prependChain(std::move(iobuf2));
   }
 
+  std::vector<uint32_t> values(kBulkCount);
+  std::iota(values.begin(), values.end(), 0);
+  folly::ByteRange bytes(
+      reinterpret_cast<const uint8_t*>(values.data()),
+      values.size() * sizeof(uint32_t));
+  iobuf_bulk_benchmark = IOBuf::copyBuffer(bytes.data(), bytes.size());
+  iobuf_bulk_chain_benchmark = splitBuffer(bytes, 250);
+
+  std::string varints;
+  for (size_t i = 0; i < kBulkCount; ++i) {
+    uint8_t encoded[folly::kMaxVarintLength64];
+    auto value = folly::Random::rand64() >> folly::Random::rand32(64);
+    varints.append(
+        reinterpret_cast<const char*>(encoded),
+        folly::encodeVarint(value, encoded));
+  }
+  iobuf_varint_benchmark = IOBuf::copyBuffer(varints);
+  iobuf_varint_chain_benchmark =
+      splitBuffer(folly::ByteRange(folly::StringPiece(varints)), 250);
+
   folly::runBenchmarks();
   return 0;
 }
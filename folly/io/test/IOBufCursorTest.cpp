@@ -14,11 +14,15 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <numeric>
 #include <vector>
 
 #include <folly/Format.h>
 #include <folly/Range.h>
+#include <folly/Varint.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/portability/GTest.h>
@@ -1258,6 +1262,153 @@ TEST(IOBuf, readConsumesAllInputOnFailure) {
   EXPECT_EQ(0, rcursor.totalLength());
 }
 
+TEST(IOBuf, readSpan) {
+  std::vector<uint32_t> expected(100);
+  std::iota(expected.begin(), expected.end(), 0x01020304);
+  auto bytes = reinterpret_cast<const uint8_t*>(expected.data());
+  auto size = expected.size() * sizeof(uint32_t);
+
+  // Contiguous, and split at odd offsets into chains of up to 7 bytes.
+  for (size_t chunk : {size, size_t(1), size_t(3), size_t(7)}) {
+    SCOPED_TRACE(chunk);
+    unique_ptr<IOBuf> buf;
+    for (size_t offset = 0; offset < size; offset += chunk) {
+      auto next =
+          IOBuf::copyBuffer(bytes + offset, std::min(chunk, size - offset));
+      if (buf) {
+        buf->appendToChain(std::move(next));
+      } else {
+        buf = std::move(next);
+      }
+    }
+
+    Cursor cursor(buf.get());
+    std::vector<uint32_t> actual(expected.size() - 1);
+    cursor.read(folly::span<uint32_t>(actual));
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin()));
+    EXPECT_EQ(sizeof(uint32_t), cursor.totalLength());
+    EXPECT_THROW(
+        cursor.read(folly::span<uint32_t>(actual.data(), 2)),
+        std::out_of_range);
+
+    cursor.reset(buf.get());
+    cursor.readBE(folly::span<uint32_t>(actual));
+    for (size_t i = 0; i < actual.size(); ++i) {
+      EXPECT_EQ(folly::Endian::big(expected[i]), actual[i]);
+    }
+    cursor.reset(buf.get());
+    cursor.readLE(folly::span<uint32_t>(actual));
+    for (size_t i = 0; i < actual.size(); ++i) {
+      EXPECT_EQ(folly::Endian::little(expected[i]), actual[i]);
+    }
+
+    cursor.reset(buf.get());
+    cursor.read(folly::span<uint32_t>());
+    EXPECT_EQ(size, cursor.totalLength());
+  }
+}
+
+TEST(IOBuf, writeSpan) {
+  std::vector<uint16_t> values(1000);
+  std::iota(values.begin(), values.end(), 0x0102);
+
+  folly::IOBufQueue queue;
+  QueueAppender queueAppender(&queue, 100);
+  queueAppender.writeBE(folly::span<const uint16_t>(values));
+  queueAppender.writeLE(folly::span<const uint16_t>(values));
+  queueAppender.write(folly::span<const uint16_t>(values));
+  auto buf = queue.move();
+  EXPECT_TRUE(buf->isChained());
+
+  Appender appender(buf.get(), 10);
+  appender.writeBE(folly::span<uint16_t>(values));
+
+  Cursor cursor(buf.get());
+  for (auto value : values) {
+    EXPECT_EQ(value, cursor.readBE<uint16_t>());
+  }
+  for (auto value : values) {
+    EXPECT_EQ(value, cursor.readLE<uint16_t>());
+  }
+  for (auto value : values) {
+    EXPECT_EQ(value, cursor.read<uint16_t>());
+  }
+  for (auto value : values) {
+    EXPECT_EQ(value, cursor.readBE<uint16_t>());
+  }
+  EXPECT_TRUE(cursor.isAtEnd());
+
+  RWPrivateCursor wcursor(buf.get());
+  std::vector<uint16_t> tooMany(buf->computeChainDataLength() / 2 + 1);
+  EXPECT_THROW(
+      wcursor.writeBE(folly::span<uint16_t>(tooMany)), std::out_of_range);
+}
+
+TEST(IOBuf, pullSpan) {
+  auto buf = IOBuf::copyBuffer("hello");
+  buf->appendToChain(IOBuf::copyBuffer(" world"));
+  Cursor cursor(buf.get());
+  std::array<uint8_t, 8> out;
+  cursor.pull(folly::span<uint8_t>(out.data(), 3));
+  EXPECT_EQ("hel", StringPiece(ByteRange(out.data(), 3)));
+  EXPECT_EQ(8, cursor.pullAtMost(folly::span<uint8_t>(out)));
+  EXPECT_EQ("lo world", StringPiece(ByteRange(out.data(), 8)));
+  EXPECT_EQ(0, cursor.pullAtMost(folly::span<uint8_t>(out)));
+  EXPECT_THROW(cursor.pull(folly::span<uint8_t>(out)), std::out_of_range);
+}
+
+TEST(IOBuf, readVarints) {
+  std::vector<uint64_t> expected;
+  for (uint64_t i = 0; i < 64; ++i) {
+    expected.push_back(uint64_t(1) << i);
+    expected.push_back((uint64_t(1) << i) - 1);
+  }
+  expected.push_back(std::numeric_limits<uint64_t>::max());
+
+  folly::IOBufQueue queue;
+  for (auto value : expected) {
+    uint8_t encoded[folly::kMaxVarintLength64];
+    queue.append(encoded, folly::encodeVarint(value, encoded));
+  }
+  auto encodedBuf = queue.move();
+  auto encoded = encodedBuf->coalesce();
+
+  // Contiguous, and split at odd offsets into chains of up to 11 bytes.
+  for (size_t chunk : {encoded.size(), size_t(1), size_t(4), size_t(11)}) {
+    SCOPED_TRACE(chunk);
+    unique_ptr<IOBuf> buf;
+    for (size_t offset = 0; offset < encoded.size(); offset += chunk) {
+      auto next = IOBuf::copyBuffer(
+          encoded.data() + offset, std::min(chunk, encoded.size() - offset));
+      if (buf) {
+        buf->appendToChain(std::move(next));
+      } else {
+        buf = std::move(next);
+      }
+    }
+    Cursor cursor(buf.get());
+    std::vector<uint64_t> actual(expected.size());
+    cursor.readVarints(folly::span<uint64_t>(actual));
+    EXPECT_EQ(expected, actual);
+    EXPECT_TRUE(cursor.isAtEnd());
+  }
+
+  // Truncated in the middle of the last varint.
+  auto truncated = IOBuf::copyBuffer(encoded.data(), encoded.size() - 1);
+  Cursor cursor(truncated.get());
+  std::vector<uint64_t> actual(expected.size());
+  EXPECT_THROW(
+      cursor.readVarints(folly::span<uint64_t>(actual)), std::out_of_range);
+
+  // Too long.
+  std::array<uint8_t, 12> tooLong;
+  tooLong.fill(0x80);
+  auto buf = IOBuf::wrapBuffer(tooLong.data(), tooLong.size());
+  cursor.reset(buf.get());
+  EXPECT_THROW(
+      cursor.readVarints(folly::span<uint64_t>(actual)), std::invalid_argument);
+}
+
 TEST(IOBuf, pushEmptyByteRange) {
   // Test pushing an empty ByteRange.  This mainly tests that we do not
   // trigger UBSAN warnings by calling memcpy() with an null source pointer,
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/MPMCQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(IOBufPool, SizeClasses) {
+  IOBufPool pool;
+  auto buf = pool.create(1500);
+  EXPECT_EQ(2048, buf->capacity());
+  EXPECT_EQ(0, buf->length());
+  EXPECT_EQ(2048, buf->tailroom());
+  EXPECT_EQ(2048, pool.create(2048)->capacity());
+  EXPECT_EQ(16384, pool.create(2049)->capacity());
+  EXPECT_EQ(65536, pool.create(65536)->capacity());
+  // Larger than the largest class.
+  EXPECT_LE(65537, pool.create(65537)->capacity());
+  EXPECT_EQ(2048, pool.create(0)->capacity());
+}
+
+TEST(IOBufPool, InvalidOptions) {
+  auto make = [](std::vector<std::size_t> sizes) {
+    IOBufPool::Options options;
+    options.sizeClasses = std::move(sizes);
+    IOBufPool pool{options};
+  };
+  EXPECT_THROW(make({}), std::invalid_argument);
+  EXPECT_THROW(make({0, 1024}), std::invalid_argument);
+  EXPECT_THROW(make({4096, 1024}), std::invalid_argument);
+  EXPECT_THROW(make({1024, 1024}), std::invalid_argument);
+  EXPECT_THROW(make({1, 2, 3, 4, 5, 6, 7, 8, 9}), std::invalid_argument);
+  make({1, 2, 3, 4, 5, 6, 7, 8});
+}
+
+TEST(IOBufPool, ReusesBuffers) {
+  IOBufPool pool;
+  auto buf = pool.create(100);
+  std::memset(buf->writableTail(), 'x', buf->tailroom());
+  buf->append(buf->tailroom());
+  auto data = buf->data();
+  buf.reset();
+
+  buf = pool.create(2000);
+  EXPECT_EQ(data, buf->data());
+  EXPECT_EQ(0, buf->length());
+  // Other classes have their own buffers.
+  EXPECT_NE(data, pool.create(10000)->data());
+}
+
+TEST(IOBufPool, CloneSharesBuffer) {
+  IOBufPool pool;
+  auto buf = pool.create(100);
+  buf->append(10);
+  auto data = buf->data();
+  auto clone = buf->clone();
+  EXPECT_TRUE(buf->isShared());
+  buf.reset();
+  EXPECT_EQ(data, clone->data());
+  clone.reset();
+  EXPECT_EQ(data, pool.create(100)->data());
+}
+
+TEST(IOBufPool, CrossThreadFree) {
+  IOBufPool pool;
+  auto buf = pool.create(100);
+  auto data = buf->data();
+  std::thread([&] { buf.reset(); }).join();
+  // Returned to this thread's cache, not the one of the freeing thread.
+  EXPECT_EQ(data, pool.create(100)->data());
+}
+
+TEST(IOBufPool, MaxCached) {
+  IOBufPool::Options options;
+  options.sizeClasses = {1024};
+  options.maxCachedPerClass = 1;
+  IOBufPool pool{options};
+  auto a = pool.create(100);
+  auto b = pool.create(100);
+  auto dataB = b->data();
+  b.reset();
+  a.reset(); // Cache full, freed.
+  EXPECT_EQ(dataB, pool.create(100)->data());
+}
+
+TEST(IOBufPool, ThreadExit) {
+  IOBufPool pool;
+  std::unique_ptr<IOBuf> buf;
+  std::thread([&] { buf = pool.create(100); }).join();
+  auto data = buf->data();
+  buf.reset();
+  // The next thread adopts the cache of the exited one.
+  std::thread([&] { EXPECT_EQ(data, pool.create(100)->data()); }).join();
+}
+
+TEST(IOBufPool, FreeAfterPoolThreadExit) {
+  IOBufPool pool;
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  for (int i = 0; i < 4; ++i) {
+    std::thread([&] {
+      for (int j = 0; j < 100; ++j) {
+        bufs.push_back(pool.create(j * 1000));
+      }
+    }).join();
+  }
+  bufs.clear();
+}
+
+TEST(IOBufPool, ProducerConsumer) {
+  IOBufPool pool;
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr int kPerProducer = 20000;
+  MPMCQueue<std::unique_ptr<IOBuf>> queue(1024);
+  std::atomic<int> done{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        auto buf = pool.create((i % 3) * 10000);
+        std::memset(buf->writableTail(), p, 16);
+        buf->append(16);
+        queue.blockingWrite(std::move(buf));
+      }
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      std::unique_ptr<IOBuf> buf;
+      while (done.fetch_add(1) < kProducers * kPerProducer) {
+        queue.blockingRead(buf);
+        auto first = buf->data()[0];
+        for (size_t i = 0; i < buf->length(); ++i) {
+          ASSERT_EQ(first, buf->data()[i]);
+        }
+        buf.reset();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/ReadFiles.h>
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <folly/FileUtil.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/testing/TestUtil.h>
+
+using namespace folly;
+
+namespace {
+
+class ReadFilesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    contents_ = {"", "hello", std::string(1 << 20, 'x'), "world"};
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      paths_.push_back(dir_.path().string() + "/" + std::to_string(i));
+      writeFile(contents_[i], paths_.back().c_str());
+    }
+    paths_.push_back(dir_.path().string() + "/missing");
+  }
+
+  void check(const std::vector<Try<std::unique_ptr<IOBuf>>>& results) {
+    ASSERT_EQ(paths_.size(), results.size());
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      ASSERT_TRUE(results[i].hasValue()) << paths_[i];
+      EXPECT_EQ(contents_[i], results[i].value()->toString());
+    }
+    auto const ex = results.back().tryGetExceptionObject<std::system_error>();
+    ASSERT_NE(nullptr, ex);
+    EXPECT_EQ(ENOENT, ex->code().value());
+  }
+
+  test::TemporaryDirectory dir_{"read_files_test"};
+  std::vector<std::string> contents_;
+  std::vector<std::string> paths_;
+};
+
+} // namespace
+
+TEST_F(ReadFilesTest, Sync) {
+  check(readFiles(paths_));
+
+  ReadFilesOptions options;
+  options.batchSize = 2;
+  check(readFiles(paths_, options));
+  EXPECT_TRUE(readFiles(Range<const std::string*>()).empty());
+}
+
+TEST_F(ReadFilesTest, Async) {
+  CPUThreadPoolExecutor executor(4);
+  ReadFilesOptions options;
+  options.batchSize = 2;
+  check(readFiles(paths_, getKeepAliveToken(executor), options).get());
+  EXPECT_TRUE(readFiles({}, getKeepAliveToken(executor)).get().empty());
+}
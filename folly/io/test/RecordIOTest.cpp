@@ -18,12 +18,17 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <random>
+#include <stdexcept>
 
 #include <glog/logging.h>
 
 #include <folly/Conv.h>
 #include <folly/FBString.h>
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/portability/GFlags.h>
@@ -260,7 +265,221 @@ TEST(RecordIOTest, Randomized) {
       ++i;
     }
     EXPECT_EQ(records.size(), i);
+
+    RecordIOReader::ScanOptions options;
+    options.chunkSize = 1 << 16;
+    options.threads = 4;
+    std::atomic<size_t> matching{0};
+    auto count = reader.scan(
+        [&](ByteRange record, off_t pos) {
+          auto it = std::lower_bound(
+              records.begin(), records.end(), pos, [](auto& r, off_t p) {
+                return r.second < p;
+              });
+          if (it != records.end() && it->second == pos &&
+              it->first == sp(record)) {
+            ++matching;
+          }
+        },
+        options);
+    EXPECT_EQ(records.size(), count);
+    EXPECT_EQ(records.size(), matching.load());
+  }
+}
+
+namespace {
+
+std::string recordBytes(StringPiece data, uint32_t fileId) {
+  auto buf = iobufs({data});
+  recordio_helpers::prependHeader(buf, fileId);
+  return sp(buf->coalesce()).str();
+}
+
+// Records between junk, some of which hold a record themselves: iterating
+// returns the outer ones only, while a chunk of a scan may begin in one.
+TemporaryFile writeNestedRecords(size_t count) {
+  std::string data;
+  for (size_t i = 0; i < count; ++i) {
+    auto inner = recordBytes(to<std::string>("inner ", i), 1);
+    data += recordBytes(to<std::string>("outer ", i, " ", inner), 1);
+    if (i % 3 == 0) {
+      data += to<std::string>("junk ", i);
+    }
+  }
+  TemporaryFile file;
+  EXPECT_EQ(data.size(), writeFull(file.fd(), data.data(), data.size()));
+  return file;
+}
+
+std::vector<std::pair<std::string, off_t>> iterate(
+    const RecordIOReader& reader) {
+  std::vector<std::pair<std::string, off_t>> records;
+  for (auto& r : reader) {
+    records.emplace_back(sp(r.first).str(), r.second);
+  }
+  return records;
+}
+
+} // namespace
+
+TEST(RecordIOTest, Scan) {
+  auto file = writeNestedRecords(50);
+  RecordIOReader reader(File(file.fd()));
+  auto expected = iterate(reader);
+  ASSERT_EQ(50, expected.size());
+
+  for (size_t chunkSize : {1, 7, 64, 1000, 1 << 20}) {
+    for (size_t threads : {1, 4}) {
+      SCOPED_TRACE(to<std::string>(chunkSize, " ", threads));
+      RecordIOReader::ScanOptions options;
+      options.chunkSize = chunkSize;
+      options.threads = threads;
+      std::mutex mutex;
+      std::vector<std::pair<std::string, off_t>> records;
+      auto count = reader.scan(
+          [&](ByteRange record, off_t pos) {
+            std::lock_guard<std::mutex> lock(mutex);
+            records.emplace_back(sp(record).str(), pos);
+          },
+          options);
+      std::sort(records.begin(), records.end(), [](auto& a, auto& b) {
+        return a.second < b.second;
+      });
+      EXPECT_EQ(expected.size(), count);
+      EXPECT_EQ(expected, records);
+    }
+  }
+}
+
+TEST(RecordIOTest, ScanRethrows) {
+  auto file = writeNestedRecords(20);
+  RecordIOReader reader(File(file.fd()));
+  RecordIOReader::ScanOptions options;
+  options.chunkSize = 64;
+  options.threads = 3;
+  EXPECT_THROW(
+      reader.scan(
+          [](ByteRange record, off_t) {
+            if (sp(record).startsWith("outer 7 ")) {
+              throw std::runtime_error("stop");
+            }
+          },
+          options),
+      std::runtime_error);
+}
+
+TEST(RecordIOTest, Index) {
+  auto file = writeNestedRecords(30);
+  TemporaryFile indexFile;
+  RecordIOReader reader(File(file.fd()));
+  auto expected = iterate(reader);
+  EXPECT_EQ(0, reader.indexedRecords());
+  EXPECT_TRUE(reader.seekToRecord(0) == reader.end());
+
+  RecordIOReader::ScanOptions options;
+  options.chunkSize = 100;
+  reader.writeIndex(File(indexFile.fd()), options);
+  reader.loadIndex(File(indexFile.fd()));
+  ASSERT_EQ(expected.size(), reader.indexedRecords());
+  for (size_t n : {size_t(0), size_t(13), expected.size() - 1}) {
+    auto it = reader.seekToRecord(n);
+    ASSERT_FALSE(it == reader.end());
+    EXPECT_EQ(expected[n].first, sp(it->first));
+    EXPECT_EQ(expected[n].second, it->second);
+  }
+  EXPECT_TRUE(reader.seekToRecord(expected.size()) == reader.end());
+
+  // Another fileId, or a file shorter than the indexed one, don't match.
+  RecordIOReader other(File(file.fd()), 1);
+  EXPECT_THROW(other.loadIndex(File(indexFile.fd())), std::runtime_error);
+  auto shorter = writeNestedRecords(3);
+  RecordIOReader shorterReader(File(shorter.fd()));
+  EXPECT_THROW(
+      shorterReader.loadIndex(File(indexFile.fd())), std::runtime_error);
+}
+
+TEST(RecordIOTest, BlockMode) {
+  for (auto type :
+       {compression::CodecType::NO_COMPRESSION,
+        compression::CodecType::ZSTD,
+        compression::CodecType::ZLIB}) {
+    if (!compression::hasCodec(type)) {
+      continue;
+    }
+    SCOPED_TRACE(to<std::string>(int(type)));
+    TemporaryFile file;
+    std::vector<std::string> expected;
+    {
+      RecordIOWriter::BlockOptions options;
+      options.codecType = type;
+      options.blockSize = 100;
+      options.maxPendingBlocks = 1;
+      RecordIOWriter writer(File(file.fd()), 1, options);
+      for (size_t i = 0; i < 50; ++i) {
+        expected.push_back(to<std::string>("record ", i));
+        writer.write(iobufs({expected.back()}));
+      }
+      writer.write(iobufs({""})); // skipped, as without blocks
+      writer.flush();
+      EXPECT_GT(writer.filePos(), 0);
+    }
+    {
+      // Records without blocks may follow.
+      RecordIOWriter writer(File(file.fd()));
+      expected.push_back("plain");
+      writer.write(iobufs({expected.back()}));
+    }
+
+    RecordIOReader reader(File(file.fd()));
+    auto records = iterate(reader);
+    ASSERT_EQ(expected.size(), records.size());
+    size_t blocks = 1;
+    for (size_t i = 0; i < records.size(); ++i) {
+      EXPECT_EQ(expected[i], records[i].first);
+      if (i > 0 && records[i].second != records[i - 1].second) {
+        ++blocks;
+      }
+    }
+    EXPECT_LT(2, blocks);
+    EXPECT_GT(expected.size(), blocks);
+
+    RecordIOReader::ScanOptions options;
+    options.chunkSize = 64;
+    options.threads = 2;
+    std::atomic<size_t> scanned{0};
+    EXPECT_EQ(
+        expected.size(),
+        reader.scan([&](ByteRange, off_t) { ++scanned; }, options));
+    EXPECT_EQ(expected.size(), scanned.load());
+
+    TemporaryFile indexFile;
+    reader.writeIndex(File(indexFile.fd()));
+    reader.loadIndex(File(indexFile.fd()));
+    for (size_t n : {size_t(0), size_t(7), size_t(31), expected.size() - 1}) {
+      auto it = reader.seekToRecord(n);
+      ASSERT_FALSE(it == reader.end());
+      EXPECT_EQ(expected[n], sp(it->first));
+    }
+  }
+}
+
+TEST(RecordIOTest, BlockModeCorruption) {
+  TemporaryFile file;
+  {
+    RecordIOWriter::BlockOptions options;
+    options.blockSize = 27; // 3 records of 9 bytes, with their lengths
+    RecordIOWriter writer(File(file.fd()), 1, options);
+    for (size_t i = 0; i < 6; ++i) {
+      writer.write(iobufs({to<std::string>("record ", i)}));
+    }
   }
+  // Corrupt the data of the first block.
+  corrupt(file.fd(), recordio_helpers::headerSize() + 10);
+  RecordIOReader reader(File(file.fd()));
+  auto records = iterate(reader);
+  ASSERT_EQ(3, records.size());
+  EXPECT_EQ("record 3", records[0].first);
+  EXPECT_EQ("record 5", records[2].first);
 }
 
 TEST(RecordIOTest, validateRecordAPI) {
@@ -20,7 +20,8 @@
  *
  * Can be used in conjunction with folly/json.h to read a JSON value (which
  * returns a folly::dynamic) and then turn that JSON value into a well-typed
- * representation.
+ * representation. To convert between JSON text and structs without going
+ * through a dynamic, see folly/json/json_struct.h.
  *
  * @file DynamicConverter.h
  * @refcode folly/docs/examples/folly/DynamicConverter.cpp
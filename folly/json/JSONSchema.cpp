@@ -25,7 +25,10 @@
 #include <folly/Optional.h>
 #include <folly/Singleton.h>
 #include <folly/String.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <folly/json/json.h>
+#include <folly/lang/Exception.h>
 #include <folly/portability/Math.h>
 
 namespace folly {
@@ -72,11 +75,17 @@ struct IValidator {
 
 /**
  * This is a 'context' used only when executing the validators to validate some
- * json. It keeps track of which validators have been executed on which json so
- * we can detect infinite recursion.
+ * json. It keeps track of which refs have been followed on which json so we can
+ * detect infinite recursion: every other validator is owned by a single parent,
+ * so only a ref can lead back to a validator already running on a value.
  */
 struct ValidationContext {
   Optional<SchemaError> validate(IValidator* validator, const dynamic& value) {
+    return validator->validate(*this, value);
+  }
+
+  Optional<SchemaError> validateRef(
+      IValidator* validator, const dynamic& value) {
     auto ret = seen.insert(std::make_pair(validator, &value));
     if (!ret.second) {
       throw std::runtime_error("Infinite recursion detected");
@@ -85,7 +94,23 @@ struct ValidationContext {
   }
 
  private:
-  std::unordered_set<std::pair<const IValidator*, const dynamic*>> seen;
+  F14FastSet<std::pair<const IValidator*, const dynamic*>> seen;
+};
+
+/**
+ * A property name with its hash, as computed by dynamic, so that looking it up
+ * in the objects being validated doesn't hash it each time.
+ */
+struct PropertyName {
+  explicit PropertyName(std::string n)
+      : hash(dynamic(n).hash()), name(std::move(n)) {}
+
+  const dynamic* lookup(const dynamic& object) const {
+    return object.get_ptr(name, hash);
+  }
+
+  size_t hash;
+  std::string name;
 };
 
 /**
@@ -261,15 +286,26 @@ struct ArrayUniqueValidator final : IValidator {
     if (!unique_ || !value.isArray()) {
       return none;
     }
-    for (const auto& i : value) {
-      for (const auto& j : value) {
-        if (&i != &j && i == j) {
-          return makeError("unique items in array", value);
-        }
+    // Equal values hash the same, including integers and equal doubles.
+    F14FastSet<const dynamic*, Hash, Equal> seen;
+    seen.reserve(value.size());
+    for (const auto& item : value) {
+      if (!seen.insert(&item).second) {
+        return makeError("unique items in array", value);
       }
     }
     return none;
   }
+
+  struct Hash {
+    size_t operator()(const dynamic* d) const { return d->hash(); }
+  };
+  struct Equal {
+    bool operator()(const dynamic* a, const dynamic* b) const {
+      return *a == *b;
+    }
+  };
+
   bool unique_;
 };
 
@@ -353,8 +389,8 @@ struct RequiredValidator final : IValidator {
       ValidationContext&, const dynamic& value) const override {
     if (value.isObject()) {
       for (const auto& prop : properties_) {
-        if (!value.get_ptr(prop)) {
-          return makeError("property ", prop, value);
+        if (!prop.lookup(value)) {
+          return makeError("property ", prop.name, value);
         }
       }
     }
@@ -362,7 +398,7 @@ struct RequiredValidator final : IValidator {
   }
 
  private:
-  std::vector<std::string> properties_;
+  std::vector<PropertyName> properties_;
 };
 
 struct PropertiesValidator final : IValidator {
@@ -375,8 +411,10 @@ struct PropertiesValidator final : IValidator {
     if (properties && properties->isObject()) {
       for (const auto& pair : properties->items()) {
         if (pair.first.isString()) {
-          propertyValidators_[pair.first.getString()] =
-              SchemaValidator::make(context, pair.second);
+          auto& validator = propertyValidators_[pair.first.getString()];
+          validator = SchemaValidator::make(context, pair.second);
+          propertyList_.emplace_back(
+              PropertyName(pair.first.getString()), validator.get());
         }
       }
     }
@@ -404,6 +442,19 @@ struct PropertiesValidator final : IValidator {
     if (!value.isObject()) {
       return none;
     }
+    // Unless the other members must be checked too, look up the properties
+    // instead of visiting the object when it has more members.
+    if (patternPropertyValidators_.empty() && allowAdditionalProperties_ &&
+        !additionalPropertyValidator_ && propertyList_.size() < value.size()) {
+      for (const auto& [prop, validator] : propertyList_) {
+        if (const auto* v = prop.lookup(value)) {
+          if (auto se = vc.validate(validator, *v)) {
+            return se;
+          }
+        }
+      }
+      return none;
+    }
     for (const auto& pair : value.items()) {
       if (!pair.first.isString()) {
         continue;
@@ -443,8 +494,8 @@ struct PropertiesValidator final : IValidator {
     return none;
   }
 
-  std::unordered_map<std::string, std::unique_ptr<IValidator>>
-      propertyValidators_;
+  F14FastMap<std::string, std::unique_ptr<IValidator>> propertyValidators_;
+  std::vector<std::pair<PropertyName, IValidator*>> propertyList_;
   std::vector<std::pair<boost::regex, std::unique_ptr<IValidator>>>
       patternPropertyValidators_;
   std::unique_ptr<IValidator> additionalPropertyValidator_;
@@ -461,17 +512,18 @@ struct DependencyValidator final : IValidator {
         continue;
       }
       if (pair.second.isArray()) {
-        auto p = make_pair(pair.first.getString(), std::vector<std::string>());
+        auto p = std::make_pair(
+            PropertyName(pair.first.getString()), std::vector<PropertyName>());
         for (const auto& item : pair.second) {
           if (item.isString()) {
-            p.second.push_back(item.getString());
+            p.second.emplace_back(item.getString());
           }
         }
         propertyDep_.emplace_back(std::move(p));
       }
       if (pair.second.isObject()) {
         schemaDep_.emplace_back(
-            pair.first.getString(),
+            PropertyName(pair.first.getString()),
             SchemaValidator::make(context, pair.second));
       }
     }
@@ -483,16 +535,16 @@ struct DependencyValidator final : IValidator {
       return none;
     }
     for (const auto& pair : propertyDep_) {
-      if (value.count(pair.first)) {
+      if (pair.first.lookup(value)) {
         for (const auto& prop : pair.second) {
-          if (!value.count(prop)) {
-            return makeError("property ", prop, value);
+          if (!prop.lookup(value)) {
+            return makeError("property ", prop.name, value);
           }
         }
       }
     }
     for (const auto& pair : schemaDep_) {
-      if (value.count(pair.first)) {
+      if (pair.first.lookup(value)) {
         if (auto se = vc.validate(pair.second.get(), value)) {
           return se;
         }
@@ -501,8 +553,8 @@ struct DependencyValidator final : IValidator {
     return none;
   }
 
-  std::vector<std::pair<std::string, std::vector<std::string>>> propertyDep_;
-  std::vector<std::pair<std::string, std::unique_ptr<IValidator>>> schemaDep_;
+  std::vector<std::pair<PropertyName, std::vector<PropertyName>>> propertyDep_;
+  std::vector<std::pair<PropertyName, std::unique_ptr<IValidator>>> schemaDep_;
 };
 
 struct EnumValidator final : IValidator {
@@ -613,13 +665,15 @@ struct AnyOfValidator final : IValidator {
 
   Optional<SchemaError> validate(
       ValidationContext& vc, const dynamic& value) const override {
-    std::vector<SchemaError> errors;
+    // Stop as soon as the outcome is known: at the first success for anyOf,
+    // and at the second one for oneOf.
+    const size_t enough = type_ == Type::ONE_OR_MORE ? 1 : 2;
+    size_t success = 0;
     for (const auto& val : validators_) {
-      if (auto se = vc.validate(val.get(), value)) {
-        errors.emplace_back(*se);
+      if (!vc.validate(val.get(), value) && ++success == enough) {
+        break;
       }
     }
-    const auto success = validators_.size() - errors.size();
     if (success == 0) {
       return makeError("at least one valid schema", value);
     } else if (success > 1 && type_ == Type::EXACTLY_ONE) {
@@ -637,7 +691,7 @@ struct RefValidator final : IValidator {
 
   Optional<SchemaError> validate(
       ValidationContext& vc, const dynamic& value) const override {
-    return vc.validate(validator_, value);
+    return vc.validateRef(validator_, value);
   }
   IValidator* validator_;
 };
@@ -716,6 +770,12 @@ void SchemaValidator::loadSchema(
     }
   }
 
+  // The type is checked first: it is cheap, and rejects most invalid values
+  // before any subschema is looked at.
+  if (const auto* p = schema.get_ptr("type")) {
+    validators_.emplace_back(std::make_unique<TypeValidator>(*p));
+  }
+
   // Numeric validators
   if (const auto* p = schema.get_ptr("multipleOf")) {
     validators_.emplace_back(std::make_unique<MultipleOfValidator>(*p));
@@ -799,9 +859,6 @@ void SchemaValidator::loadSchema(
   if (const auto* p = schema.get_ptr("enum")) {
     validators_.emplace_back(std::make_unique<EnumValidator>(*p));
   }
-  if (const auto* p = schema.get_ptr("type")) {
-    validators_.emplace_back(std::make_unique<TypeValidator>(*p));
-  }
   if (const auto* p = schema.get_ptr("allOf")) {
     validators_.emplace_back(std::make_unique<AllOfValidator>(context, *p));
   }
@@ -1015,6 +1072,27 @@ folly::Singleton<Validator> schemaValidator([]() {
 
 Validator::~Validator() = default;
 
+std::vector<exception_wrapper> Validator::try_validate_each(
+    const dynamic& values) const {
+  return try_validate_each(values, [](size_t n, FunctionRef<void(size_t)> f) {
+    for (size_t i = 0; i < n; ++i) {
+      f(i);
+    }
+  });
+}
+
+std::vector<exception_wrapper> Validator::try_validate_each(
+    const dynamic& values, ParallelFor parallel) const {
+  if (!values.isArray()) {
+    throw_exception<TypeError>("array", values.type());
+  }
+  std::vector<exception_wrapper> results(values.size());
+  parallel(values.size(), [&](size_t i) {
+    results[i] = try_validate(values[i]);
+  });
+  return results;
+}
+
 std::unique_ptr<Validator> makeValidator(const dynamic& schema) {
   auto v = std::make_unique<SchemaValidator>();
   SchemaValidatorContext context(schema);
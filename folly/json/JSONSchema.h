@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include <folly/ExceptionWrapper.h>
+#include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/json/dynamic.h>
 
@@ -57,6 +60,23 @@ struct Validator {
    */
   virtual exception_wrapper try_validate(
       const dynamic& value) const noexcept = 0;
+
+  /**
+   * Called with a count of tasks n and a function task, and must call task(i)
+   * exactly once for each i in [0, n) before returning, in any order and on
+   * any threads.
+   */
+  using ParallelFor = FunctionRef<void(size_t, FunctionRef<void(size_t)>)>;
+
+  /**
+   * Check each element of the given array, e.g. a batch of documents. Returns
+   * the result of try_validate() for each element, in order. With parallel,
+   * the elements are checked concurrently, one task per element. Throws
+   * TypeError if values is not an array.
+   */
+  std::vector<exception_wrapper> try_validate_each(const dynamic& values) const;
+  std::vector<exception_wrapper> try_validate_each(
+      const dynamic& values, ParallelFor parallel) const;
 };
 
 /**
@@ -20,6 +20,8 @@
 
 #include <folly/CPortability.h>
 #include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/json/dynamic.h>
@@ -100,6 +102,143 @@ size_t decodePduLength(const folly::IOBuf*);
 folly::fbstring toBser(folly::dynamic const&, const serialization_opts&);
 std::unique_ptr<folly::IOBuf> toBserIOBuf(
     folly::dynamic const&, const serialization_opts&);
+
+// Streams BSER straight into IOBufs, without building a dynamic first.
+//
+// Arrays and objects are length-prefixed in BSER, so their sizes are given
+// up front: after beginArray(n), write n values; after beginObject(n), write
+// n pairs of a key (with writeString) and a value. Nothing checks that the
+// counts match.
+//
+//   BserWriter w;
+//   w.beginObject(2);
+//   w.writeString("name").writeString("fred");
+//   w.writeString("age").writeInt(20);
+//   auto pdu = w.finish();
+class BserWriter {
+ public:
+  explicit BserWriter(size_t growth_increment = 8192);
+
+  BserWriter(const BserWriter&) = delete;
+  BserWriter& operator=(const BserWriter&) = delete;
+
+  BserWriter& writeNull();
+  BserWriter& writeBool(bool value);
+  BserWriter& writeInt(int64_t value);
+  BserWriter& writeDouble(double value);
+  BserWriter& writeString(folly::StringPiece value);
+  BserWriter& beginArray(size_t size);
+  BserWriter& beginObject(size_t size);
+
+  // Write a whole dynamic, as toBser does.
+  BserWriter& write(
+      folly::dynamic const& value,
+      const serialization_opts& opts = serialization_opts());
+
+  // The number of bytes written, not counting the PDU header.
+  size_t size() const { return queue_.chainLength(); }
+
+  // Return the PDU: the header followed by everything written. The header
+  // goes in headroom reserved up front, so nothing is copied. The writer must
+  // not be used afterwards.
+  std::unique_ptr<folly::IOBuf> finish();
+  // Same, appended to out.
+  void finish(folly::IOBufQueue& out);
+
+ private:
+  folly::IOBufQueue queue_;
+  folly::io::QueueAppender appender_;
+};
+
+// A lazy, zero-copy view of an encoded BSER value.
+//
+// parseBser decodes a whole PDU into a dynamic. A BserView instead points at
+// a value in the encoded bytes and decodes it on access: scalars are read in
+// place, strings are StringPieces into the buffer, and the elements and
+// members of containers are found by skipping the values before them. This
+// is much cheaper when only a few fields of a large blob are read.
+//
+// Lookups are linear in the size of the container; to access most of a
+// value, or the same members repeatedly, use toDynamic(). The encoded bytes
+// must outlive the view. Malformed input throws BserDecodeError on access,
+// and reading a value as the wrong type throws TypeError.
+class BserView {
+ public:
+  // The value of a complete PDU, as produced by toBser.
+  static BserView parsePdu(folly::ByteRange pdu);
+  static BserView parsePdu(folly::StringPiece pdu);
+  // buf must not be chained: coalesce() it first.
+  static BserView parsePdu(const folly::IOBuf& buf);
+
+  folly::dynamic::Type type() const;
+  bool isNull() const { return type() == folly::dynamic::NULLT; }
+  bool isBool() const { return type() == folly::dynamic::BOOL; }
+  bool isInt() const { return type() == folly::dynamic::INT64; }
+  bool isDouble() const { return type() == folly::dynamic::DOUBLE; }
+  bool isString() const { return type() == folly::dynamic::STRING; }
+  bool isArray() const { return type() == folly::dynamic::ARRAY; }
+  bool isObject() const { return type() == folly::dynamic::OBJECT; }
+
+  bool getBool() const;
+  int64_t getInt() const;
+  double getDouble() const;
+  folly::StringPiece getString() const;
+
+  // The number of elements of an array, members of an object, or bytes of
+  // a string.
+  size_t size() const;
+
+  // The element at index of an array. Throws std::out_of_range.
+  BserView at(size_t index) const;
+  // The member named key of an object, if any.
+  folly::Optional<BserView> get(folly::StringPiece key) const;
+
+  // Call fn(BserView) for each element of an array.
+  template <typename Fn>
+  void forEachElement(Fn fn) const {
+    for (auto it = iterate(folly::dynamic::ARRAY); it.remaining > 0;) {
+      fn(nextElement(it));
+    }
+  }
+  // Call fn(StringPiece key, BserView value) for each member of an object.
+  template <typename Fn>
+  void forEachItem(Fn fn) const {
+    for (auto it = iterate(folly::dynamic::OBJECT); it.remaining > 0;) {
+      auto const key = nextKey(it);
+      fn(key, nextElement(it));
+    }
+  }
+
+  folly::dynamic toDynamic() const;
+
+ private:
+  struct Iter {
+    const uint8_t* pos;
+    size_t remaining;
+    // For a templated array, the array of the keys of its objects and their
+    // number.
+    const uint8_t* templ;
+    size_t templSize;
+    // For an object of a templated array, its next key. The keys of other
+    // objects are inline, before each value.
+    const uint8_t* keys;
+  };
+
+  BserView(const uint8_t* pos, const uint8_t* end, const uint8_t* names)
+      : pos_(pos), end_(end), names_(names) {}
+
+  Iter iterate(folly::dynamic::Type expected) const;
+  folly::StringPiece nextKey(Iter& it) const;
+  BserView nextElement(Iter& it) const;
+
+  // The encoded value.
+  const uint8_t* pos_;
+  // The end of the buffer.
+  const uint8_t* end_;
+  // For an object of a templated array, the array of its keys; pos_ is then
+  // its first value.
+  const uint8_t* names_;
+};
 } // namespace bser
 } // namespace folly
 
@@ -189,20 +189,13 @@ static void bserEncode(
   }
 }
 
-std::unique_ptr<folly::IOBuf> toBserIOBuf(
-    folly::dynamic const& dyn, const serialization_opts& opts) {
-  IOBufQueue q(IOBufQueue::cacheChainLength());
-  uint8_t hdrbuf[sizeof(kMagic) + 1 + sizeof(int64_t)];
-
-  // Reserve some headroom for the overall PDU size; we'll fill this in
-  // after we've serialized the data and know the length
-  auto firstbuf = IOBuf::create(opts.growth_increment);
-  firstbuf->advance(sizeof(hdrbuf));
-  q.append(std::move(firstbuf));
+// The largest PDU header: the magic, and the length as a BSER Int64.
+static constexpr size_t kMaxHeaderSize = sizeof(kMagic) + 1 + sizeof(int64_t);
 
-  // encode the value
-  QueueAppender appender(&q, opts.growth_increment);
-  bserEncode(dyn, appender, opts);
+// Prepend the PDU header to the serialized data in q, which must have been
+// allocated with kMaxHeaderSize bytes of headroom.
+static void prependHeader(IOBufQueue& q) {
+  uint8_t hdrbuf[kMaxHeaderSize];
 
   // compute the length
   auto len = q.chainLength();
@@ -239,10 +232,90 @@ std::unique_ptr<folly::IOBuf> toBserIOBuf(
 
   // and place the data in the headroom
   q.prepend(hdrbuf, hdrlen);
+}
+
+// Start q with a buffer with headroom for the PDU header.
+static void reserveHeader(IOBufQueue& q, size_t growth_increment) {
+  auto firstbuf = IOBuf::create(std::max(growth_increment, kMaxHeaderSize));
+  firstbuf->advance(kMaxHeaderSize);
+  q.append(std::move(firstbuf));
+}
+
+std::unique_ptr<folly::IOBuf> toBserIOBuf(
+    folly::dynamic const& dyn, const serialization_opts& opts) {
+  IOBufQueue q(IOBufQueue::cacheChainLength());
 
+  // Reserve some headroom for the overall PDU size; we'll fill this in
+  // after we've serialized the data and know the length
+  reserveHeader(q, opts.growth_increment);
+
+  // encode the value
+  QueueAppender appender(&q, opts.growth_increment);
+  bserEncode(dyn, appender, opts);
+
+  prependHeader(q);
   return q.move();
 }
 
+BserWriter::BserWriter(size_t growth_increment)
+    : queue_(IOBufQueue::cacheChainLength()),
+      appender_(&queue_, growth_increment) {
+  reserveHeader(queue_, growth_increment);
+}
+
+BserWriter& BserWriter::writeNull() {
+  appender_.write((int8_t)BserType::Null);
+  return *this;
+}
+
+BserWriter& BserWriter::writeBool(bool value) {
+  appender_.write((int8_t)(value ? BserType::True : BserType::False));
+  return *this;
+}
+
+BserWriter& BserWriter::writeInt(int64_t value) {
+  bserEncodeInt(value, appender_);
+  return *this;
+}
+
+BserWriter& BserWriter::writeDouble(double value) {
+  appender_.write((int8_t)BserType::Real);
+  appender_.write(value);
+  return *this;
+}
+
+BserWriter& BserWriter::writeString(folly::StringPiece value) {
+  bserEncodeString(value, appender_);
+  return *this;
+}
+
+BserWriter& BserWriter::beginArray(size_t size) {
+  appender_.write((int8_t)BserType::Array);
+  bserEncodeInt(int64_t(size), appender_);
+  return *this;
+}
+
+BserWriter& BserWriter::beginObject(size_t size) {
+  appender_.write((int8_t)BserType::Object);
+  bserEncodeInt(int64_t(size), appender_);
+  return *this;
+}
+
+BserWriter& BserWriter::write(
+    folly::dynamic const& value, const serialization_opts& opts) {
+  bserEncode(value, appender_, opts);
+  return *this;
+}
+
+std::unique_ptr<folly::IOBuf> BserWriter::finish() {
+  prependHeader(queue_);
+  return queue_.move();
+}
+
+void BserWriter::finish(folly::IOBufQueue& out) {
+  out.append(finish());
+}
+
 fbstring toBser(dynamic const& dyn, const serialization_opts& opts) {
   auto buf = toBserIOBuf(dyn, opts);
   return buf->moveToFbString();
@@ -18,6 +18,7 @@
 
 #include <folly/String.h>
 #include <folly/io/Cursor.h>
+#include <folly/lang/Bits.h>
 
 using namespace folly;
 using folly::io::Cursor;
@@ -239,6 +240,317 @@ folly::dynamic parseBser(ByteRange str) {
 folly::dynamic parseBser(StringPiece str) {
   return parseBser(ByteRange((uint8_t*)str.data(), str.size()));
 }
+
+namespace {
+
+// Decoding in place, for BserView. p is the position of the next value and
+// end the end of the buffer; every read is bounds-checked.
+
+[[noreturn]] void throwTruncated() {
+  throw BserDecodeError("truncated BSER value");
+}
+
+template <typename T>
+T readRaw(const uint8_t*& p, const uint8_t* end) {
+  if (size_t(end - p) < sizeof(T)) {
+    throwTruncated();
+  }
+  auto const value = loadUnaligned<T>(p);
+  p += sizeof(T);
+  return value;
+}
+
+BserType readType(const uint8_t*& p, const uint8_t* end) {
+  return (BserType)readRaw<int8_t>(p, end);
+}
+
+int64_t readInt(const uint8_t*& p, const uint8_t* end) {
+  auto const enc = readType(p, end);
+  switch (enc) {
+    case BserType::Int8:
+      return readRaw<int8_t>(p, end);
+    case BserType::Int16:
+      return readRaw<int16_t>(p, end);
+    case BserType::Int32:
+      return readRaw<int32_t>(p, end);
+    case BserType::Int64:
+      return readRaw<int64_t>(p, end);
+    default:
+      throw BserDecodeError(folly::to<std::string>(
+          "invalid integer encoding detected (", (int8_t)enc, ")"));
+  }
+}
+
+size_t readSize(const uint8_t*& p, const uint8_t* end) {
+  auto const size = readInt(p, end);
+  if (size < 0) {
+    throw BserDecodeError("BSER size must not be negative");
+  }
+  return size_t(size);
+}
+
+// Read the string at p.
+StringPiece readString(const uint8_t*& p, const uint8_t* end) {
+  if (readType(p, end) != BserType::String) {
+    throw BserDecodeError("expected String");
+  }
+  auto const len = readSize(p, end);
+  if (size_t(end - p) < len) {
+    throwTruncated();
+  }
+  StringPiece str(reinterpret_cast<const char*>(p), len);
+  p += len;
+  return str;
+}
+
+// Read the header of the names array of a template at p, leaving p at the
+// first name.
+size_t readTemplateNames(const uint8_t*& p, const uint8_t* end) {
+  if (readType(p, end) != BserType::Array) {
+    throw BserDecodeError("Expected array encoding for property names");
+  }
+  return readSize(p, end);
+}
+
+void skipValue(const uint8_t*& p, const uint8_t* end);
+
+void skipValues(const uint8_t*& p, const uint8_t* end, size_t count) {
+  while (count-- > 0) {
+    skipValue(p, end);
+  }
+}
+
+void skipValue(const uint8_t*& p, const uint8_t* end) {
+  auto const start = p;
+  switch (readType(p, end)) {
+    case BserType::Int8:
+    case BserType::Int16:
+    case BserType::Int32:
+    case BserType::Int64:
+      p = start;
+      readInt(p, end);
+      return;
+    case BserType::Real:
+      readRaw<double>(p, end);
+      return;
+    case BserType::True:
+    case BserType::False:
+    case BserType::Null:
+    case BserType::Skip:
+      return;
+    case BserType::String:
+      p = start;
+      readString(p, end);
+      return;
+    case BserType::Array:
+      skipValues(p, end, readSize(p, end));
+      return;
+    case BserType::Object: {
+      auto size = readSize(p, end);
+      while (size-- > 0) {
+        readString(p, end);
+        skipValue(p, end);
+      }
+      return;
+    }
+    case BserType::Template: {
+      auto const names = readTemplateNames(p, end);
+      skipValues(p, end, names);
+      auto const count = readSize(p, end);
+      for (size_t i = 0; i < count; ++i) {
+        skipValues(p, end, names);
+      }
+      return;
+    }
+    default:
+      throw BserDecodeError("invalid bser encoding");
+  }
+}
+
+} // namespace
+
+BserView BserView::parsePdu(ByteRange pdu) {
+  auto const end = pdu.end();
+  auto p = pdu.begin();
+  if (size_t(end - p) < sizeof(kMagic) ||
+      memcmp(p, kMagic, sizeof(kMagic))) {
+    throw std::runtime_error("invalid BSER magic header");
+  }
+  p += sizeof(kMagic);
+  auto const len = readSize(p, end);
+  if (size_t(end - p) < len) {
+    throwTruncated();
+  }
+  return BserView(p, p + len, nullptr);
+}
+
+BserView BserView::parsePdu(StringPiece pdu) {
+  return parsePdu(ByteRange(pdu));
+}
+
+BserView BserView::parsePdu(const IOBuf& buf) {
+  if (buf.isChained()) {
+    throw std::invalid_argument("BserView needs a contiguous buffer");
+  }
+  return parsePdu(ByteRange(buf.data(), buf.length()));
+}
+
+dynamic::Type BserView::type() const {
+  if (names_) {
+    return dynamic::OBJECT;
+  }
+  auto p = pos_;
+  switch (readType(p, end_)) {
+    case BserType::Int8:
+    case BserType::Int16:
+    case BserType::Int32:
+    case BserType::Int64:
+      return dynamic::INT64;
+    case BserType::Real:
+      return dynamic::DOUBLE;
+    case BserType::True:
+    case BserType::False:
+      return dynamic::BOOL;
+    // A missing member of an object of a templated array.
+    case BserType::Null:
+    case BserType::Skip:
+      return dynamic::NULLT;
+    case BserType::String:
+      return dynamic::STRING;
+    case BserType::Array:
+    case BserType::Template:
+      return dynamic::ARRAY;
+    case BserType::Object:
+      return dynamic::OBJECT;
+    default:
+      throw BserDecodeError("invalid bser encoding");
+  }
+}
+
+bool BserView::getBool() const {
+  auto const t = type();
+  if (t != dynamic::BOOL) {
+    throw TypeError("bool", t);
+  }
+  return (BserType)*pos_ == BserType::True;
+}
+
+int64_t BserView::getInt() const {
+  auto const t = type();
+  if (t != dynamic::INT64) {
+    throw TypeError("int64", t);
+  }
+  auto p = pos_;
+  return readInt(p, end_);
+}
+
+double BserView::getDouble() const {
+  auto const t = type();
+  if (t != dynamic::DOUBLE) {
+    throw TypeError("double", t);
+  }
+  auto p = pos_ + 1;
+  return readRaw<double>(p, end_);
+}
+
+StringPiece BserView::getString() const {
+  auto const t = type();
+  if (t != dynamic::STRING) {
+    throw TypeError("string", t);
+  }
+  auto p = pos_;
+  return readString(p, end_);
+}
+
+size_t BserView::size() const {
+  switch (type()) {
+    case dynamic::STRING:
+      return getString().size();
+    case dynamic::ARRAY:
+      return iterate(dynamic::ARRAY).remaining;
+    case dynamic::OBJECT:
+      return iterate(dynamic::OBJECT).remaining;
+    case dynamic::NULLT:
+    case dynamic::BOOL:
+    case dynamic::DOUBLE:
+    case dynamic::INT64:
+    default:
+      throw TypeError("array/object/string", type());
+  }
+}
+
+BserView BserView::at(size_t index) const {
+  auto it = iterate(dynamic::ARRAY);
+  if (index >= it.remaining) {
+    throw std::out_of_range("BserView index out of range");
+  }
+  while (index-- > 0) {
+    nextElement(it);
+  }
+  return nextElement(it);
+}
+
+Optional<BserView> BserView::get(StringPiece key) const {
+  for (auto it = iterate(dynamic::OBJECT); it.remaining > 0;) {
+    auto const name = nextKey(it);
+    auto const value = nextElement(it);
+    if (name == key) {
+      return value;
+    }
+  }
+  return none;
+}
+
+BserView::Iter BserView::iterate(dynamic::Type expected) const {
+  auto const t = type();
+  if (t != expected) {
+    throw TypeError(expected == dynamic::ARRAY ? "array" : "object", t);
+  }
+  Iter it{pos_, 0, nullptr, 0, nullptr};
+  if (names_) {
+    it.keys = names_;
+    it.remaining = readTemplateNames(it.keys, end_);
+    return it;
+  }
+  if (readType(it.pos, end_) == BserType::Template) {
+    it.templ = it.pos;
+    it.templSize = readTemplateNames(it.pos, end_);
+    skipValues(it.pos, end_, it.templSize);
+  }
+  it.remaining = readSize(it.pos, end_);
+  return it;
+}
+
+StringPiece BserView::nextKey(Iter& it) const {
+  return readString(it.keys ? it.keys : it.pos, end_);
+}
+
+BserView BserView::nextElement(Iter& it) const {
+  BserView value(it.pos, end_, it.templ);
+  if (it.templ) {
+    skipValues(it.pos, end_, it.templSize);
+  } else {
+    skipValue(it.pos, end_);
+  }
+  --it.remaining;
+  return value;
+}
+
+dynamic BserView::toDynamic() const {
+  if (names_) {
+    dynamic obj = dynamic::object;
+    forEachItem([&](StringPiece key, BserView value) {
+      obj[key] = value.toDynamic();
+    });
+    return obj;
+  }
+  if ((BserType)*pos_ == BserType::Skip) {
+    return nullptr;
+  }
+  auto const buf = IOBuf::wrapBufferAsValue(pos_, size_t(end_ - pos_));
+  Cursor curs(&buf);
+  return parseBser(curs);
+}
 } // namespace bser
 } // namespace folly
 
@@ -146,5 +146,96 @@ TEST(Bser, CursorLength) {
   }
 }
 
+TEST(Bser, Writer) {
+  folly::bser::BserWriter writer(16);
+  writer.beginObject(3);
+  writer.writeString("name").writeString("fred");
+  writer.writeString("age").writeInt(20);
+  writer.writeString("rest").beginArray(5);
+  writer.writeNull().writeBool(true).writeDouble(1.5);
+  writer.write(dynamic::array(1, 2)).writeInt(1 << 20);
+  EXPECT_GT(writer.size(), 16);
+
+  folly::IOBufQueue q;
+  q.append(folly::IOBuf::copyBuffer("x"));
+  writer.finish(q);
+  q.trimStart(1);
+  auto const pdu = q.move();
+  dynamic const expected = dynamic::object("name", "fred")("age", 20)(
+      "rest",
+      dynamic::array(nullptr, true, 1.5, dynamic::array(1, 2), 1 << 20));
+  EXPECT_EQ(expected, folly::bser::parseBser(pdu.get()));
+}
+
+TEST(Bser, View) {
+  for (const auto& dyn : roundtrips) {
+    auto const str =
+        folly::bser::toBser(dyn, folly::bser::serialization_opts());
+    auto const view = folly::bser::BserView::parsePdu(folly::StringPiece(str));
+    EXPECT_EQ(dyn.type(), view.type());
+    EXPECT_EQ(dyn, view.toDynamic());
+  }
+
+  dynamic const dyn = dynamic::object("name", "fred")("age", 20)(
+      "pets", dynamic::array("cat", dynamic::object("dog", 1.5)))("ok", true);
+  auto const buf = folly::bser::toBserIOBuf(dyn, {});
+  auto const view = folly::bser::BserView::parsePdu(*buf);
+  ASSERT_TRUE(view.isObject());
+  EXPECT_EQ(4, view.size());
+  EXPECT_EQ("fred", view.get("name")->getString());
+  // Strings point into the buffer.
+  auto const name = view.get("name")->getString();
+  EXPECT_GE(name.data(), reinterpret_cast<const char*>(buf->data()));
+  EXPECT_LT(name.data(), reinterpret_cast<const char*>(buf->tail()));
+  EXPECT_EQ(20, view.get("age")->getInt());
+  EXPECT_TRUE(view.get("ok")->getBool());
+  EXPECT_FALSE(view.get("missing").has_value());
+  auto const pets = *view.get("pets");
+  EXPECT_EQ(2, pets.size());
+  EXPECT_EQ("cat", pets.at(0).getString());
+  EXPECT_EQ(1.5, pets.at(1).get("dog")->getDouble());
+  EXPECT_THROW(pets.at(2), std::out_of_range);
+  EXPECT_THROW(pets.getInt(), folly::TypeError);
+  EXPECT_THROW(view.get("name")->getInt(), folly::TypeError);
+
+  std::vector<std::string> keys;
+  view.forEachItem([&](folly::StringPiece key, folly::bser::BserView value) {
+    keys.push_back(key.str());
+    EXPECT_EQ(dyn[key], value.toDynamic());
+  });
+  EXPECT_EQ(4, keys.size());
+  size_t elements = 0;
+  pets.forEachElement([&](folly::bser::BserView value) {
+    EXPECT_EQ(dyn["pets"][elements++], value.toDynamic());
+  });
+  EXPECT_EQ(2, elements);
+}
+
+TEST(Bser, ViewTemplate) {
+  auto const view = folly::bser::BserView::parsePdu(
+      folly::ByteRange(template_blob, sizeof(template_blob) - 1));
+  ASSERT_TRUE(view.isArray());
+  EXPECT_EQ(3, view.size());
+  EXPECT_EQ(template_dynamic, view.toDynamic());
+  EXPECT_EQ("pete", view.at(1).get("name")->getString());
+  EXPECT_EQ(30, view.at(1).get("age")->getInt());
+  EXPECT_TRUE(view.at(2).get("name")->isNull());
+  EXPECT_EQ(25, view.at(2).get("age")->getInt());
+  EXPECT_EQ(2, view.at(0).size());
+}
+
+TEST(Bser, ViewTruncated) {
+  auto const str = folly::bser::toBser(
+      dynamic::object("key", dynamic::array("a", "b", "c")),
+      folly::bser::serialization_opts());
+  for (size_t i = 0; i < str.size(); ++i) {
+    EXPECT_ANY_THROW({
+      auto const view =
+          folly::bser::BserView::parsePdu(folly::StringPiece(str.data(), i));
+      view.get("key")->at(2).getString();
+    }) << i;
+  }
+}
+
 /* vim:ts=2:sw=2:et:
  */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/compiled_json_pointer.h>
+
+#include <stdexcept>
+
+#include <folly/Conv.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+compiled_json_pointer::compiled_json_pointer(json_pointer pointer)
+    : pointer_(std::move(pointer)) {
+  tokens_.reserve(pointer_.tokens().size());
+  for (auto const& key : pointer_.tokens()) {
+    token t{dynamic(key).hash(), 0, index_kind::valid};
+    if (key.size() > 1 && key[0] == '0') {
+      t.kind = index_kind::leading_zero;
+    } else if (key == "-") {
+      t.kind = index_kind::append;
+    } else if (auto const idx = tryTo<std::size_t>(key)) {
+      t.index = *idx;
+    } else {
+      t.kind = index_kind::not_numeric;
+    }
+    tokens_.push_back(t);
+  }
+}
+
+bool compiled_json_pointer::check_index(token const& t, std::size_t size) {
+  switch (t.kind) {
+    case index_kind::valid:
+      return t.index < size;
+    case index_kind::append:
+      return false;
+    case index_kind::not_numeric:
+      throw std::invalid_argument("array index is not numeric");
+    case index_kind::leading_zero:
+      throw std::invalid_argument(
+          "leading zero not allowed when indexing arrays");
+  }
+  return false;
+}
+
+const dynamic* compiled_json_pointer::get_ptr(dynamic const& root) const {
+  auto const& keys = pointer_.tokens();
+  dynamic const* curr = &root;
+  for (std::size_t i = 0; i < tokens_.size(); ++i) {
+    auto const& t = tokens_[i];
+    if (curr->isObject()) {
+      curr = curr->get_ptr(keys[i], t.hash);
+    } else if (curr->isArray()) {
+      curr = check_index(t, curr->size()) ? &(*curr)[t.index] : nullptr;
+    } else {
+      throw_exception<TypeError>("object/array", curr->type());
+    }
+    if (!curr) {
+      return nullptr;
+    }
+  }
+  return curr;
+}
+
+Optional<json_tape::value> compiled_json_pointer::get(
+    json_tape::value root) const {
+  auto const& keys = pointer_.tokens();
+  Optional<json_tape::value> curr = root;
+  for (std::size_t i = 0; i < tokens_.size(); ++i) {
+    auto const& t = tokens_[i];
+    if (curr->is_object()) {
+      curr = curr->find(keys[i]);
+    } else if (curr->is_array()) {
+      curr = check_index(t, curr->size()) ? (*curr)[t.index] : none;
+    } else {
+      throw_exception<TypeError>("object/array", curr->type());
+    }
+    if (!curr) {
+      return none;
+    }
+  }
+  return curr;
+}
+
+// static
+std::vector<Optional<dynamic>> compiled_json_pointer::extract(
+    StringPiece json,
+    Range<compiled_json_pointer const*> pointers,
+    const json::serialization_opts& opts) {
+  auto const doc = json_tape::parse(json, opts);
+  std::vector<Optional<dynamic>> ret;
+  ret.reserve(pointers.size());
+  for (auto const& pointer : pointers) {
+    if (auto const v = pointer.get(doc.root())) {
+      ret.emplace_back(v->to_dynamic());
+    } else {
+      ret.emplace_back();
+    }
+  }
+  return ret;
+}
+
+} // namespace folly
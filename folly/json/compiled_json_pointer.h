@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json_pointer.h>
+#include <folly/json/json_tape.h>
+
+namespace folly {
+
+/*
+ * compiled_json_pointer
+ *
+ * A json_pointer prepared for repeated evaluation. Each token is decoded
+ * once: its hash, as dynamic computes it for string keys, and its meaning as
+ * an array index are precomputed, so a lookup in a dynamic neither parses
+ * indices nor hashes keys.
+ *
+ * Evaluating against a json_tape extracts values straight from the raw JSON
+ * text: only the tape is built, never a dynamic tree, and to_dynamic() can
+ * then be called on just the values found. extract() does both for a set of
+ * pointers.
+ *
+ * The lookups follow the semantics of dynamic::get_ptr(json_pointer const&):
+ * they return nullptr (or none) for missing keys, out of range indices and
+ * "-", and throw std::invalid_argument if a token indexing an array is not
+ * numeric or has a leading zero, and TypeError if a token is applied to a
+ * value that is neither an array nor an object.
+ *
+ *   static const compiled_json_pointer ptr("/user/ids/0");
+ *   if (auto* id = ptr.get_ptr(doc)) { ... }
+ */
+class compiled_json_pointer {
+ public:
+  compiled_json_pointer() = default;
+  explicit compiled_json_pointer(json_pointer pointer);
+  /// Throws json_pointer::parse_exception if str is not a valid pointer.
+  explicit compiled_json_pointer(StringPiece str)
+      : compiled_json_pointer(json_pointer::parse(str)) {}
+
+  json_pointer const& pointer() const { return pointer_; }
+
+  const dynamic* get_ptr(dynamic const& root) const;
+  dynamic* get_ptr(dynamic& root) const {
+    return const_cast<dynamic*>(get_ptr(static_cast<dynamic const&>(root)));
+  }
+
+  Optional<json_tape::value> get(json_tape::value root) const;
+
+  /// Parses json into a tape and returns, for each pointer, the value it
+  /// points to, converted to dynamic, or none if there is no such value.
+  /// Throws json::parse_error if json is invalid.
+  static std::vector<Optional<dynamic>> extract(
+      StringPiece json,
+      Range<compiled_json_pointer const*> pointers,
+      const json::serialization_opts& opts = {});
+
+  friend bool operator==(
+      compiled_json_pointer const& lhs, compiled_json_pointer const& rhs) {
+    return lhs.pointer_ == rhs.pointer_;
+  }
+  friend bool operator!=(
+      compiled_json_pointer const& lhs, compiled_json_pointer const& rhs) {
+    return lhs.pointer_ != rhs.pointer_;
+  }
+
+ private:
+  enum class index_kind : uint8_t {
+    valid,
+    append, // "-"
+    not_numeric,
+    leading_zero,
+  };
+
+  // The key is the token of pointer_ at the same position.
+  struct token {
+    std::size_t hash;
+    std::size_t index;
+    index_kind kind;
+  };
+
+  // Throws if t cannot index an array, otherwise returns whether it indexes
+  // one of the given size in range.
+  static bool check_index(token const& t, std::size_t size);
+
+  json_pointer pointer_;
+  std::vector<token> tokens_;
+};
+
+} // namespace folly
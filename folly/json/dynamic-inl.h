@@ -751,6 +751,11 @@ inline dynamic* dynamic::get_ptr(StringPiece idx) & {
   return const_cast<dynamic*>(const_cast<dynamic const*>(this)->get_ptr(idx));
 }
 
+inline dynamic* dynamic::get_ptr(StringPiece key, std::size_t hash) & {
+  return const_cast<dynamic*>(
+      const_cast<dynamic const*>(this)->get_ptr(key, hash));
+}
+
 // clang-format off
 inline
 dynamic::resolved_json_pointer<dynamic>
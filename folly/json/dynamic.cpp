@@ -294,6 +294,18 @@ const dynamic* dynamic::get_ptr(StringPiece idx) const& {
   return &it->second;
 }
 
+const dynamic* dynamic::get_ptr(StringPiece key, std::size_t hash) const& {
+  auto* pobject = get_nothrow<ObjectImpl>();
+  if (!pobject) {
+    throw_exception<TypeError>("object", type());
+  }
+  auto it = pobject->find(pobject->prehash(key, hash), key);
+  if (it == pobject->end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
 std::size_t dynamic::size() const {
   if (auto* ar = get_nothrow<Array>()) {
     return ar->size();
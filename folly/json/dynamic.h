@@ -788,6 +788,15 @@ struct dynamic {
   dynamic* get_ptr(StringPiece) &;
   dynamic* get_ptr(StringPiece) && = delete;
 
+  /*
+   * Like get_ptr(StringPiece), with the hash of the key precomputed: hash
+   * must be equal to dynamic(key).hash(). This lets lookups that repeat the
+   * same keys, such as the ones of compiled_json_pointer, skip hashing them.
+   */
+  const dynamic* get_ptr(StringPiece key, std::size_t hash) const&;
+  dynamic* get_ptr(StringPiece key, std::size_t hash) &;
+  dynamic* get_ptr(StringPiece key, std::size_t hash) && = delete;
+
   /**
    * Element lookup.
    *
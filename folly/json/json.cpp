@@ -30,6 +30,8 @@
 #include <folly/Range.h>
 #include <folly/Unicode.h>
 #include <folly/Utility.h>
+#include <folly/algorithm/simd/Movemask.h>
+#include <folly/algorithm/simd/detail/SimdPlatform.h>
 #include <folly/lang/Bits.h>
 #include <folly/portability/Constexpr.h>
 
@@ -95,13 +97,31 @@ struct Printer {
   };
 
   explicit Printer(
-      std::string& out, unsigned* indentLevel, serialization_opts const* opts)
-      : out_(out), indentLevel_(indentLevel), opts_(*opts) {}
+      std::string& out,
+      unsigned* indentLevel,
+      serialization_opts const* opts,
+      FunctionRef<void(StringPiece)>* sink = nullptr)
+      : out_(out), indentLevel_(indentLevel), opts_(*opts), sink_(sink) {}
+
+  // Hands the buffered output to the sink. The buffer keeps its capacity, so
+  // it is allocated only once.
+  void flush() const {
+    (*sink_)(out_);
+    out_.clear();
+  }
+
+  // With a sink, out_ is only a buffer which is flushed before printing a
+  // value once it holds at least this many bytes. Values are not split, so
+  // a chunk can be larger, e.g. for a long string.
+  static constexpr std::size_t kSinkChunkSize = 8192;
 
   void operator()(dynamic const& v, const Context& context) const {
     (*this)(v, &context);
   }
   void operator()(dynamic const& v, const Context* context) const {
+    if (sink_ && out_.size() >= kSinkChunkSize) {
+      flush();
+    }
     switch (v.type()) {
       case dynamic::DOUBLE: {
         if (!opts_.allow_nan_inf) {
@@ -294,6 +314,7 @@ struct Printer {
   std::string& out_;
   unsigned* const indentLevel_;
   serialization_opts const& opts_;
+  FunctionRef<void(StringPiece)>* const sink_;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -765,11 +786,27 @@ std::string serialize(dynamic const& dyn, serialization_opts const& opts) {
   return ret;
 }
 
+void serialize(
+    dynamic const& dyn,
+    serialization_opts const& opts,
+    FunctionRef<void(StringPiece)> sink) {
+  std::string buf;
+  buf.reserve(2 * Printer::kSinkChunkSize);
+  unsigned indentLevel = 0;
+  Printer p(
+      buf, opts.pretty_formatting ? &indentLevel : nullptr, &opts, &sink);
+  p(dyn, nullptr);
+  if (!buf.empty()) {
+    p.flush();
+  }
+}
+
 // Fast path to determine the longest prefix that can be left
 // unescaped in a string of sizeof(T) bytes packed in an integer of
 // type T.
 template <bool EnableExtraAsciiEscapes, class T>
-size_t firstEscapableInWord(T s, const serialization_opts& opts) {
+size_t firstEscapableInWord(
+    T s, bool escapeHigh, const serialization_opts& opts) {
   static_assert(std::is_unsigned<T>::value, "Unsigned integer required");
   static constexpr T kOnes = ~T() / 255; // 0x...0101
   static constexpr T kMsbs = kOnes * 0x80; // 0x...8080
@@ -788,7 +825,7 @@ size_t firstEscapableInWord(T s, const serialization_opts& opts) {
 
   // The following masks have the MSB set for each byte of the word
   // that satisfies the corresponding condition.
-  auto isHigh = s & kMsbs; // >= 128
+  auto isHigh = escapeHigh ? s & kMsbs : 0; // >= 128
   auto isLow = isLess(s, 0x20); // <= 0x1f
   auto needsEscape = isHigh | isLow | isChar('\\') | isChar('"');
 
@@ -823,6 +860,39 @@ size_t firstEscapableInWord(T s, const serialization_opts& opts) {
   }
 }
 
+#if FOLLY_DETAIL_HAS_SIMD_PLATFORM
+
+// Vectorized version of the loop over firstEscapableInWord(), without the
+// extra ASCII escapes: returns the first byte of [p, e) which may need
+// escaping, or the start of the last partial register.
+FOLLY_ALWAYS_INLINE const unsigned char* firstEscapableSimd(
+    const unsigned char* p, const unsigned char* e, bool escapeHigh) {
+  using Platform = simd::detail::SimdPlatform<uint8_t>;
+  constexpr auto kCardinal = std::size_t(Platform::kCardinal);
+  for (; to_unsigned(e - p) >= kCardinal; p += kCardinal) {
+    auto reg = Platform::loadu(p, simd::ignore_none{});
+    auto special = Platform::logical_or(
+        Platform::less_equal(reg, 0x1f),
+        Platform::logical_or(
+            Platform::equal(reg, '\\'), Platform::equal(reg, '"')));
+    auto [bits, bitsPerElement] = simd::movemask<uint8_t>(special);
+    if (escapeHigh) {
+      // There is no unsigned greater-than, so complement the ASCII mask.
+      auto ascii =
+          simd::movemask<uint8_t>(Platform::less_equal(reg, 0x7f)).first;
+      bits |= ~ascii &
+          n_least_significant_bits<decltype(bits)>(
+                  kCardinal * bitsPerElement);
+    }
+    if (bits) {
+      return p + (findFirstSet(bits) - 1) / bitsPerElement;
+    }
+  }
+  return p;
+}
+
+#endif
+
 // Escape a string so that it is legal to print it in JSON text.
 template <bool EnableExtraAsciiEscapes>
 void escapeStringImpl(
@@ -837,10 +907,24 @@ void escapeStringImpl(
   auto* q = reinterpret_cast<const unsigned char*>(input.begin());
   auto* e = reinterpret_cast<const unsigned char*>(input.end());
 
+  // Since non-ascii encoding inherently does utf8 validation
+  // we explicitly validate utf8 only if non-ascii encoding is disabled.
+  // Valid strings, which is almost all of them, are checked up front
+  // with SIMD, and then non-ascii bytes are copied as is. Otherwise they
+  // are decoded one by one below, to throw or replace invalid sequences.
+  const bool checkUtf8 = (opts.validate_utf8 || opts.skip_invalid_utf8) &&
+      !opts.encode_non_ascii && !isValidUtf8(input);
+  const bool escapeHigh = opts.encode_non_ascii || checkUtf8;
+
   while (p < e) {
     // Find the longest prefix that does not need escaping, and copy
     // it literally into the output string.
     auto firstEsc = p;
+#if FOLLY_DETAIL_HAS_SIMD_PLATFORM
+    if /* constexpr */ (!EnableExtraAsciiEscapes) {
+      firstEsc = firstEscapableSimd(p, e, escapeHigh);
+    }
+#endif
     while (firstEsc < e) {
       auto avail = to_unsigned(e - firstEsc);
       uint64_t word = 0;
@@ -849,7 +933,8 @@ void escapeStringImpl(
       } else {
         word = folly::partialLoadUnaligned<uint64_t>(firstEsc, avail);
       }
-      auto prefix = firstEscapableInWord<EnableExtraAsciiEscapes>(word, opts);
+      auto prefix = firstEscapableInWord<EnableExtraAsciiEscapes>(
+          word, escapeHigh, opts);
       DCHECK_LE(prefix, avail);
       firstEsc += prefix;
       if (prefix < 8) {
@@ -868,13 +953,9 @@ void escapeStringImpl(
 
     // Handle the next byte that may need escaping.
 
-    // Since non-ascii encoding inherently does utf8 validation
-    // we explicitly validate utf8 only if non-ascii encoding is disabled.
-    if ((opts.validate_utf8 || opts.skip_invalid_utf8) &&
-        !opts.encode_non_ascii) {
-      // To achieve better spatial and temporal coherence
-      // we do utf8 validation progressively along with the
-      // string-escaping instead of two separate passes.
+    if (checkUtf8) {
+      // Find the invalid sequences progressively along with the
+      // string-escaping.
 
       // As the encoding progresses, q will stay at or ahead of p.
       CHECK_GE(q, p);
@@ -155,6 +155,21 @@ std::array<uint64_t, 2> buildExtraAsciiToEscapeBitmap(StringPiece chars);
  */
 std::string serialize(dynamic const&, serialization_opts const&);
 
+/**
+ * Serialize dynamic to json, with options, passing the output to sink in
+ * chunks instead of returning it as a single string.
+ *
+ * The chunks are a few KB each, so memory use doesn't grow with the size of
+ * the output; the StringPiece passed to sink is only valid during the call.
+ * If serialization throws, the chunks already passed to sink are a prefix of
+ * an incomplete document. See folly/json/json_iobuf.h to serialize into an
+ * IOBufQueue.
+ */
+void serialize(
+    dynamic const&,
+    serialization_opts const&,
+    FunctionRef<void(StringPiece)> sink);
+
 /**
  * Escape a string so that it is legal to print it in JSON text.
  *
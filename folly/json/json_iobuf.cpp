@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_iobuf.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+// Buffer sizes for serialize(IOBufQueue&): start small so that short
+// documents don't waste memory, and grow up to a size that keeps the number
+// of IOBufs in the chain of a multi-MB document reasonable.
+constexpr std::size_t kMinGrowth = 4096;
+constexpr std::size_t kMaxGrowth = 256 * 1024;
+} // namespace
+
+void serialize(
+    dynamic const& dyn,
+    serialization_opts const& opts,
+    io::QueueAppender& appender) {
+  serialize(
+      dyn, opts, [&](StringPiece chunk) { appender.push(ByteRange(chunk)); });
+}
+
+void serialize(
+    dynamic const& dyn, serialization_opts const& opts, IOBufQueue& out) {
+  io::QueueAppender appender(&out, kMinGrowth, kMaxGrowth);
+  serialize(dyn, opts, appender);
+}
+
+} // namespace json
+
+void toJson(dynamic const& dyn, IOBufQueue& out) {
+  json::serialize(dyn, json::serialization_opts(), out);
+}
+
+void toPrettyJson(dynamic const& dyn, IOBufQueue& out) {
+  json::serialization_opts opts;
+  opts.pretty_formatting = true;
+  opts.sort_keys = true;
+  json::serialize(dyn, opts, out);
+}
+
+} // namespace folly
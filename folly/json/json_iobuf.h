@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+
+/**
+ * Serialize folly::dynamic values as JSON directly into IOBufs.
+ *
+ * These produce the same output as json::serialize(), toJson() and
+ * toPrettyJson(), but append it to an IOBufQueue as it is generated rather
+ * than building a std::string that would then have to be copied into an
+ * IOBuf. This avoids holding the whole document twice, and reallocating the
+ * string as it grows, when sending large documents over the network.
+ *
+ *   IOBufQueue queue{IOBufQueue::cacheChainLength()};
+ *   toJson(response, queue);
+ *   transport->writeChain(callback, queue.move());
+ */
+
+namespace folly {
+namespace json {
+
+/**
+ * Append the serialization of dyn to the queue behind appender, which
+ * determines how the buffers are sized.
+ */
+void serialize(
+    dynamic const& dyn,
+    serialization_opts const& opts,
+    io::QueueAppender& appender);
+
+/**
+ * Append the serialization of dyn to out, in buffers of growing size.
+ */
+void serialize(
+    dynamic const& dyn, serialization_opts const& opts, IOBufQueue& out);
+
+} // namespace json
+
+/**
+ * Append the json serialization of dyn to out.
+ */
+void toJson(dynamic const& dyn, IOBufQueue& out);
+
+/**
+ * Append the json serialization of dyn with indentation and sorted keys to
+ * out.
+ */
+void toPrettyJson(dynamic const& dyn, IOBufQueue& out);
+
+} // namespace folly
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_struct.h>
+
+#include <vector>
+
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+namespace json_struct {
+
+error::error(std::string pointer, std::string_view what)
+    : std::runtime_error(to<std::string>(
+          "folly::json_struct: ",
+          pointer.empty() ? "document" : pointer,
+          ": ",
+          what)),
+      pointer_(std::move(pointer)) {}
+
+} // namespace json_struct
+
+namespace json_struct_detail {
+
+namespace {
+
+std::string to_pointer(const path* at) {
+  std::vector<const path*> components;
+  for (; at; at = at->parent) {
+    components.push_back(at);
+  }
+  std::string pointer;
+  for (auto it = components.rbegin(); it != components.rend(); ++it) {
+    pointer += '/';
+    if ((*it)->is_index) {
+      toAppend((*it)->index, &pointer);
+      continue;
+    }
+    for (auto c : (*it)->key) {
+      if (c == '~') {
+        pointer += "~0";
+      } else if (c == '/') {
+        pointer += "~1";
+      } else {
+        pointer += c;
+      }
+    }
+  }
+  return pointer;
+}
+
+const char* type_name(dynamic::Type type) {
+  switch (type) {
+    case dynamic::NULLT:
+      return "null";
+    case dynamic::ARRAY:
+      return "array";
+    case dynamic::BOOL:
+      return "boolean";
+    case dynamic::DOUBLE:
+      return "double";
+    case dynamic::INT64:
+      return "integer";
+    case dynamic::OBJECT:
+      return "object";
+    case dynamic::STRING:
+      return "string";
+  }
+  return "unknown";
+}
+
+} // namespace
+
+void throw_error(const path* at, std::string_view what) {
+  throw_exception<json_struct::error>(to_pointer(at), what);
+}
+
+void throw_type_error(
+    const path* at, const char* expected, dynamic::Type actual) {
+  throw_error(
+      at, to<std::string>("expected ", expected, ", got ", type_name(actual)));
+}
+
+void append_double(
+    double value, std::string& out, const json::serialization_opts& opts) {
+  if (!opts.allow_nan_inf && !std::isfinite(value)) {
+    throw_exception<json::print_error>(
+        "folly::json_struct: cannot serialize NaN or INF");
+  }
+  toAppend(
+      value, &out, opts.dtoa_mode, opts.double_num_digits, opts.dtoa_flags);
+}
+
+} // namespace json_struct_detail
+
+} // namespace folly
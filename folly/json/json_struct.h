@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Direct conversions between JSON text and C++ structs.
+ *
+ * DynamicConverter goes through a folly::dynamic in both directions: every
+ * value of the document is allocated as a node, then converted. For structs
+ * registered with FOLLY_JSON_STRUCT, json_struct::parse() reads the fields
+ * straight out of a json_tape and json_struct::serialize() writes the JSON
+ * text straight from the fields, with no dynamic in between.
+ *
+ *   struct Config {
+ *     std::string name;
+ *     int32_t port = 0;
+ *     std::vector<std::string> hosts;
+ *     folly::Optional<double> ratio;
+ *   };
+ *   FOLLY_JSON_STRUCT(Config, name, port, hosts, ratio)
+ *
+ *   auto config = folly::json_struct::parse<Config>(text);
+ *   std::string text = folly::json_struct::serialize(config);
+ *
+ * The field types supported are bool, the integral and floating point types,
+ * std::string, std::vector, std::map and std::unordered_map with string keys,
+ * folly::Optional and std::optional, folly::dynamic (to keep a subtree
+ * untyped), and other registered structs.
+ *
+ * Parsing validates the document against the schema implied by the struct,
+ * as JSON Schema would with the corresponding "type", "required",
+ * "additionalProperties", "minimum" and "maximum" keywords: values must have
+ * the type of their field (integers are accepted for floating point fields),
+ * integers must be in the range of their field's type, and, depending on the
+ * options, fields that are not optional must be present and members that are
+ * not fields are rejected. Optional fields accept null. Violations throw
+ * json_struct::error, which names the offending value with a JSON pointer.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <folly/CPortability.h>
+#include <folly/Conv.h>
+#include <folly/Optional.h>
+#include <folly/Preprocessor.h>
+#include <folly/Range.h>
+#include <folly/Traits.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/json/json_tape.h>
+
+/**
+ * Registers the fields of struct Type for json_struct. Must be used at
+ * namespace scope, in the namespace of Type. Supports up to 15 fields; the
+ * JSON member names are the field names.
+ */
+#define FOLLY_JSON_STRUCT(Type, ...)                      \
+  [[maybe_unused]] inline auto folly_json_struct_fields( \
+      ::folly::tag_t<Type>) {                             \
+    using folly_json_struct_type = Type;                  \
+    return std::tuple{FOLLY_PP_FOR_EACH(                  \
+        FOLLY_JSON_STRUCT_DETAIL_FIELD, __VA_ARGS__)};    \
+  }
+
+#define FOLLY_JSON_STRUCT_DETAIL_FIELD(field) \
+  ::folly::json_struct_detail::make_field(    \
+      #field, &folly_json_struct_type::field),
+
+namespace folly {
+
+namespace json_struct {
+
+struct options {
+  /// If false, members of an object that are not fields of the struct are
+  /// an error, as with "additionalProperties": false; otherwise they are
+  /// skipped.
+  bool allow_unknown_fields = true;
+  /// If false, fields that are not optional must be present, as if they
+  /// were "required"; otherwise absent fields keep their value.
+  bool allow_missing_fields = false;
+  /// For parsing, the options honored by json_tape::parse(); for
+  /// serializing, the string escaping options, allow_nan_inf and the dtoa
+  /// options. All of them apply to dynamic fields.
+  json::serialization_opts json_opts;
+};
+
+/// Thrown when a document does not match the struct it is parsed into.
+class FOLLY_EXPORT error : public std::runtime_error {
+ public:
+  error(std::string pointer, std::string_view what);
+
+  /// The JSON pointer of the offending value.
+  const std::string& pointer() const { return pointer_; }
+
+ private:
+  std::string pointer_;
+};
+
+} // namespace json_struct
+
+namespace json_struct_detail {
+
+template <typename T, typename M>
+struct field {
+  std::string_view name;
+  M T::*member;
+};
+
+template <typename T, typename M>
+constexpr field<T, M> make_field(std::string_view name, M T::*member) {
+  return {name, member};
+}
+
+// The location of the value being read. Paths live on the stack and are only
+// turned into a JSON pointer when an error is thrown.
+struct path {
+  const path* parent;
+  std::string_view key;
+  std::size_t index;
+  bool is_index;
+};
+
+[[noreturn]] void throw_error(const path* at, std::string_view what);
+[[noreturn]] void throw_type_error(
+    const path* at, const char* expected, dynamic::Type actual);
+void append_double(
+    double value, std::string& out, const json::serialization_opts& opts);
+
+template <typename T, typename = void>
+struct is_registered : std::false_type {};
+template <typename T>
+struct is_registered<T, void_t<decltype(folly_json_struct_fields(tag<T>))>>
+    : std::true_type {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<Optional<T>> : std::true_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T, typename = void>
+struct codec {
+  static_assert(
+      sizeof(T) == 0,
+      "json_struct: unsupported type; register structs with FOLLY_JSON_STRUCT");
+};
+
+template <>
+struct codec<bool> {
+  static void read(
+      json_tape::value v,
+      bool& out,
+      const json_struct::options&,
+      const path* at) {
+    if (!v.is_bool()) {
+      throw_type_error(at, "boolean", v.type());
+    }
+    out = v.as_bool();
+  }
+  static void write(bool v, std::string& out, const json_struct::options&) {
+    out += v ? "true" : "false";
+  }
+};
+
+template <typename T>
+struct codec<
+    T,
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+  static void read(
+      json_tape::value v, T& out, const json_struct::options&, const path* at) {
+    if (!v.is_int()) {
+      throw_type_error(at, "integer", v.type());
+    }
+    auto const value = tryTo<T>(v.as_int());
+    if (!value) {
+      throw_error(at, "integer out of range");
+    }
+    out = *value;
+  }
+  static void write(T v, std::string& out, const json_struct::options&) {
+    toAppend(v, &out);
+  }
+};
+
+template <typename T>
+struct codec<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  static void read(
+      json_tape::value v, T& out, const json_struct::options&, const path* at) {
+    if (!v.is_number()) {
+      throw_type_error(at, "number", v.type());
+    }
+    out = static_cast<T>(v.as_double());
+  }
+  static void write(T v, std::string& out, const json_struct::options& opts) {
+    append_double(static_cast<double>(v), out, opts.json_opts);
+  }
+};
+
+template <>
+struct codec<std::string> {
+  static void read(
+      json_tape::value v,
+      std::string& out,
+      const json_struct::options&,
+      const path* at) {
+    if (!v.is_string()) {
+      throw_type_error(at, "string", v.type());
+    }
+    out.assign(v.as_string());
+  }
+  static void write(
+      const std::string& v,
+      std::string& out,
+      const json_struct::options& opts) {
+    json::escapeString(v, out, opts.json_opts);
+  }
+};
+
+template <>
+struct codec<dynamic> {
+  static void read(
+      json_tape::value v,
+      dynamic& out,
+      const json_struct::options&,
+      const path*) {
+    out = v.to_dynamic();
+  }
+  static void write(
+      const dynamic& v, std::string& out, const json_struct::options& opts) {
+    out += json::serialize(v, opts.json_opts);
+  }
+};
+
+template <typename T>
+struct codec<T, std::enable_if_t<is_optional<T>::value>> {
+  using value_type = typename T::value_type;
+
+  static void read(
+      json_tape::value v,
+      T& out,
+      const json_struct::options& opts,
+      const path* at) {
+    if (v.is_null()) {
+      out.reset();
+      return;
+    }
+    codec<value_type>::read(v, out.emplace(), opts, at);
+  }
+  static void write(
+      const T& v, std::string& out, const json_struct::options& opts) {
+    if (v.has_value()) {
+      codec<value_type>::write(*v, out, opts);
+    } else {
+      out += "null";
+    }
+  }
+};
+
+template <typename T, typename A>
+struct codec<std::vector<T, A>> {
+  static void read(
+      json_tape::value v,
+      std::vector<T, A>& out,
+      const json_struct::options& opts,
+      const path* at) {
+    if (!v.is_array()) {
+      throw_type_error(at, "array", v.type());
+    }
+    out.clear();
+    out.reserve(v.size());
+    std::size_t index = 0;
+    for (auto element : v.elements()) {
+      path const element_at{at, {}, index++, true};
+      T value{};
+      codec<T>::read(element, value, opts, &element_at);
+      out.push_back(std::move(value));
+    }
+  }
+  static void write(
+      const std::vector<T, A>& v,
+      std::string& out,
+      const json_struct::options& opts) {
+    out += '[';
+    bool first = true;
+    for (auto const& element : v) {
+      if (!std::exchange(first, false)) {
+        out += ',';
+      }
+      codec<T>::write(element, out, opts);
+    }
+    out += ']';
+  }
+};
+
+template <typename Map>
+struct map_codec {
+  using mapped_type = typename Map::mapped_type;
+
+  static void read(
+      json_tape::value v,
+      Map& out,
+      const json_struct::options& opts,
+      const path* at) {
+    if (!v.is_object()) {
+      throw_type_error(at, "object", v.type());
+    }
+    out.clear();
+    for (auto [key, member] : v.items()) {
+      path const member_at{at, key, 0, false};
+      mapped_type value{};
+      codec<mapped_type>::read(member, value, opts, &member_at);
+      out.insert_or_assign(std::string(key), std::move(value));
+    }
+  }
+  static void write(
+      const Map& v, std::string& out, const json_struct::options& opts) {
+    out += '{';
+    bool first = true;
+    for (auto const& [key, value] : v) {
+      if (!std::exchange(first, false)) {
+        out += ',';
+      }
+      json::escapeString(key, out, opts.json_opts);
+      out += ':';
+      codec<mapped_type>::write(value, out, opts);
+    }
+    out += '}';
+  }
+};
+
+template <typename T, typename C, typename A>
+struct codec<std::map<std::string, T, C, A>>
+    : map_codec<std::map<std::string, T, C, A>> {};
+
+template <typename T, typename H, typename E, typename A>
+struct codec<std::unordered_map<std::string, T, H, E, A>>
+    : map_codec<std::unordered_map<std::string, T, H, E, A>> {};
+
+template <typename T>
+struct codec<T, std::enable_if_t<is_registered<T>::value>> {
+  template <typename F, std::size_t... I>
+  static void for_each_field(F&& f, std::index_sequence<I...>) {
+    auto const fields = folly_json_struct_fields(tag<T>);
+    (f(std::get<I>(fields), index_constant<I>{}), ...);
+  }
+  template <typename F>
+  static void for_each_field(F&& f) {
+    using fields = decltype(folly_json_struct_fields(tag<T>));
+    for_each_field(f, std::make_index_sequence<std::tuple_size_v<fields>>{});
+  }
+  static constexpr std::size_t size() {
+    return std::tuple_size_v<decltype(folly_json_struct_fields(tag<T>))>;
+  }
+
+  static void read(
+      json_tape::value v,
+      T& out,
+      const json_struct::options& opts,
+      const path* at) {
+    if (!v.is_object()) {
+      throw_type_error(at, "object", v.type());
+    }
+    std::array<bool, size()> seen{};
+    for (auto [key, member] : v.items()) {
+      path const member_at{at, key, 0, false};
+      bool found = false;
+      for_each_field([&](auto const& field, auto index) {
+        if (!found && field.name == key) {
+          found = true;
+          seen[index] = true;
+          using type = std::remove_reference_t<decltype(out.*field.member)>;
+          codec<type>::read(member, out.*field.member, opts, &member_at);
+        }
+      });
+      if (!found && !opts.allow_unknown_fields) {
+        throw_error(&member_at, "unknown field");
+      }
+    }
+    if (!opts.allow_missing_fields) {
+      for_each_field([&](auto const& field, auto index) {
+        using type = std::remove_reference_t<decltype(out.*field.member)>;
+        if (!is_optional<type>::value && !seen[index]) {
+          path const field_at{at, field.name, 0, false};
+          throw_error(&field_at, "missing required field");
+        }
+      });
+    }
+  }
+
+  static void write(
+      const T& v, std::string& out, const json_struct::options& opts) {
+    out += '{';
+    bool first = true;
+    for_each_field([&](auto const& field, auto) {
+      auto const& value = v.*field.member;
+      using type = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+      if constexpr (is_optional<type>::value) {
+        if (!value.has_value()) {
+          return;
+        }
+      }
+      if (!std::exchange(first, false)) {
+        out += ',';
+      }
+      json::escapeString(field.name, out, opts.json_opts);
+      out += ':';
+      codec<type>::write(value, out, opts);
+    });
+    out += '}';
+  }
+};
+
+} // namespace json_struct_detail
+
+namespace json_struct {
+
+/// Whether T was registered with FOLLY_JSON_STRUCT.
+template <typename T>
+constexpr bool is_registered_v = json_struct_detail::is_registered<T>::value;
+
+/// Parses json into out, which may be a registered struct or any other
+/// supported type. Throws json::parse_error if json is not valid JSON, and
+/// json_struct::error if it does not match the type of out. On error, out is
+/// left in a valid but unspecified state.
+template <typename T>
+void parse(StringPiece json, T& out, const options& opts = {}) {
+  auto const doc = json_tape::parse(json, opts.json_opts);
+  json_struct_detail::codec<T>::read(doc.root(), out, opts, nullptr);
+}
+
+template <typename T>
+T parse(StringPiece json, const options& opts = {}) {
+  T out{};
+  parse(json, out, opts);
+  return out;
+}
+
+/// Appends the JSON text of value to out. Optional fields without a value
+/// are omitted. Throws json::print_error on NaN and infinities, unless
+/// opts.json_opts.allow_nan_inf.
+template <typename T>
+void serialize(const T& value, std::string& out, const options& opts = {}) {
+  json_struct_detail::codec<T>::write(value, out, opts);
+}
+
+template <typename T>
+std::string serialize(const T& value, const options& opts = {}) {
+  std::string out;
+  serialize(value, out, opts);
+  return out;
+}
+
+} // namespace json_struct
+
+} // namespace folly
@@ -0,0 +1,695 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_tape.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <folly/Conv.h>
+#include <folly/Portability.h>
+#include <folly/Unicode.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+#if FOLLY_SSE >= 2
+#include <emmintrin.h>
+#endif
+
+namespace folly {
+
+namespace {
+
+// Bit i of each mask describes byte i of a 64-byte block.
+struct block_masks {
+  uint64_t quote{0};
+  uint64_t backslash{0};
+  uint64_t whitespace{0};
+  uint64_t op{0}; // one of {}[]:,
+};
+
+#if FOLLY_SSE >= 2
+
+block_masks classify(const char* p) {
+  block_masks m;
+  for (int k = 0; k < 4; ++k) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+    auto eq = [&](__m128i x, char c) {
+      return uint64_t(uint16_t(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(c)))));
+    };
+    // Setting bit 5 maps [ to { and ] to }, and no other byte to either.
+    auto lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    auto shift = 16 * k;
+    m.quote |= eq(v, '"') << shift;
+    m.backslash |= eq(v, '\\') << shift;
+    m.whitespace |=
+        (eq(v, ' ') | eq(v, '\t') | eq(v, '\n') | eq(v, '\r')) << shift;
+    m.op |= (eq(lower, '{') | eq(lower, '}') | eq(v, ':') | eq(v, ','))
+        << shift;
+  }
+  return m;
+}
+
+#else
+
+block_masks classify(const char* p) {
+  block_masks m;
+  for (int i = 0; i < 64; ++i) {
+    auto bit = uint64_t(1) << i;
+    switch (p[i]) {
+      case '"':
+        m.quote |= bit;
+        break;
+      case '\\':
+        m.backslash |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        m.whitespace |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        m.op |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+  return m;
+}
+
+#endif
+
+// Bit i of the result is the xor of bits 0..i of x.
+uint64_t prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+[[noreturn]] void throw_parse_error(std::size_t offset, const char* what) {
+  throw_exception<json::parse_error>(
+      to<std::string>("json parse error at offset ", offset, ": ", what));
+}
+
+} // namespace
+
+class json_tape::parser {
+ public:
+  parser(json_tape& doc, const json::serialization_opts& opts)
+      : doc_(doc),
+        in_(doc.input_),
+        opts_(opts),
+        structurals_(doc.structurals_) {}
+
+  void run() {
+    find_structurals();
+    build_tape();
+  }
+
+ private:
+  // Stage 1: fills structurals_ with the offsets of all the structural
+  // characters outside of strings, of the opening quote of every string and
+  // of the first byte of every scalar (number, literal or garbage).
+  void find_structurals() {
+    structurals_.reserve(in_.size() / 4 + 1);
+    uint64_t prev_escaped = 0; // the first byte of the block is escaped
+    uint64_t prev_in_string = 0; // all ones if the block starts in a string
+    uint64_t prev_scalar = 0; // the block starts in the middle of a scalar
+    char padded[64];
+    for (std::size_t base = 0; base < in_.size(); base += 64) {
+      const char* p = in_.data() + base;
+      if (in_.size() - base < 64) {
+        std::memset(padded, ' ', sizeof(padded));
+        std::memcpy(padded, p, in_.size() - base);
+        p = padded;
+      }
+      auto m = classify(p);
+
+      // Backslashes are rare outside of text-heavy documents, so resolving
+      // runs of them one at a time is cheap enough.
+      uint64_t escaped = prev_escaped;
+      prev_escaped = 0;
+      for (uint64_t bs = m.backslash & ~escaped; bs; bs &= bs - 1) {
+        auto bit = bs & -bs;
+        if (escaped & bit) {
+          continue;
+        }
+        if (bit >> 63) {
+          prev_escaped = 1;
+        } else {
+          escaped |= bit << 1;
+        }
+      }
+
+      auto quote = m.quote & ~escaped;
+      // Includes opening quotes, but not closing ones.
+      auto in_string = prefix_xor(quote) ^ prev_in_string;
+      prev_in_string = uint64_t(int64_t(in_string) >> 63);
+
+      auto scalar = ~(m.op | m.whitespace | quote) & ~in_string;
+      auto scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+      prev_scalar = scalar >> 63;
+
+      auto structural =
+          (m.op & ~in_string) | (quote & in_string) | scalar_start;
+      while (structural) {
+        structurals_.push_back(uint32_t(base + findFirstSet(structural) - 1));
+        structural &= structural - 1;
+      }
+    }
+    if (prev_in_string) {
+      throw_parse_error(in_.size(), "unterminated string");
+    }
+  }
+
+  struct scope {
+    uint32_t begin; // index of the opening tape word
+    uint32_t count;
+    bool object;
+  };
+
+  // Stage 2: validates the grammar and writes the tape.
+  void build_tape() {
+    auto& tape = doc_.tape_;
+    tape.reserve(structurals_.size() + structurals_.size() / 2 + 1);
+    std::vector<scope> stack;
+
+    enum class state { value, array_next, object_key, object_next };
+    auto st = state::value;
+    std::size_t pos = 0;
+    const std::size_t n = structurals_.size();
+
+    auto after_value = [&] {
+      if (stack.empty()) {
+        if (pos != n) {
+          throw_parse_error(structurals_[pos], "trailing characters");
+        }
+        return false;
+      }
+      ++stack.back().count;
+      st = stack.back().object ? state::object_next : state::array_next;
+      return true;
+    };
+    auto peek = [&]() -> char {
+      return pos < n ? in_[structurals_[pos]] : '\0';
+    };
+    auto offset = [&] { return pos < n ? structurals_[pos] : in_.size(); };
+    auto open = [&](bool object) {
+      if (stack.size() >= opts_.recursion_limit) {
+        throw_parse_error(offset(), "recursion limit exceeded");
+      }
+      stack.push_back({uint32_t(tape.size()), 0, object});
+      tape.push_back(0); // patched by close()
+    };
+    auto close = [&] {
+      auto s = stack.back();
+      stack.pop_back();
+      auto begin_tag = s.object ? tag_object_begin : tag_array_begin;
+      auto end_tag = s.object ? tag_object_end : tag_array_end;
+      uint64_t count = std::min<uint64_t>(s.count, kMaxCount);
+      tape[s.begin] = word(begin_tag, (count << 32) | tape.size());
+      tape.push_back(word(end_tag, s.begin));
+    };
+
+    while (true) {
+      switch (st) {
+        case state::value: {
+          if (pos == n) {
+            throw_parse_error(in_.size(), "expected json value");
+          }
+          auto off = structurals_[pos++];
+          switch (in_[off]) {
+            case '{':
+              open(true);
+              if (peek() == '}') {
+                ++pos;
+                close();
+                break;
+              }
+              st = state::object_key;
+              continue;
+            case '[':
+              open(false);
+              if (peek() == ']') {
+                ++pos;
+                close();
+                break;
+              }
+              continue;
+            case '"':
+              parse_string(off);
+              break;
+            case '}':
+            case ']':
+            case ':':
+            case ',':
+              throw_parse_error(off, "expected json value");
+            default:
+              parse_scalar(off);
+              break;
+          }
+          if (!after_value()) {
+            return;
+          }
+          break;
+        }
+        case state::object_key: {
+          if (peek() != '"') {
+            throw_parse_error(offset(), "expected string for object key");
+          }
+          parse_string(structurals_[pos++]);
+          if (peek() != ':') {
+            throw_parse_error(offset(), "expected ':'");
+          }
+          ++pos;
+          st = state::value;
+          break;
+        }
+        case state::array_next:
+        case state::object_next: {
+          bool object = st == state::object_next;
+          char c = peek();
+          if (c == (object ? '}' : ']')) {
+            ++pos;
+            close();
+            if (!after_value()) {
+              return;
+            }
+            break;
+          }
+          if (c != ',') {
+            throw_parse_error(
+                offset(),
+                object ? "expected ',' or '}'" : "expected ',' or ']'");
+          }
+          ++pos;
+          if (opts_.allow_trailing_comma && peek() == (object ? '}' : ']')) {
+            ++pos;
+            close();
+            if (!after_value()) {
+              return;
+            }
+            break;
+          }
+          st = object ? state::object_key : state::value;
+          break;
+        }
+      }
+    }
+  }
+
+  static uint64_t word(tag t, uint64_t payload) {
+    return (uint64_t(t) << 56) | payload;
+  }
+
+  void parse_string(uint32_t off) {
+    auto& tape = doc_.tape_;
+    const char* begin = in_.data() + off + 1;
+    const char* end = in_.data() + in_.size();
+    const char* p = begin;
+    while (*p != '"' && *p != '\\') {
+      if (*p == '\0') {
+        throw_parse_error(p - in_.data(), "null byte in string");
+      }
+      ++p;
+    }
+    if (*p == '"') {
+      tape.push_back(word(tag_string, uint64_t(off + 1)));
+      tape.push_back(uint64_t(p - begin));
+      return;
+    }
+
+    // Has escapes: unescape into the arena.
+    auto builder = doc_.strings_.new_record_builder();
+    std::copy(begin, p, builder.back_inserter());
+    while (true) {
+      if (*p == '"') {
+        break;
+      }
+      if (*p == '\0') {
+        throw_parse_error(p - in_.data(), "null byte in string");
+      }
+      if (*p != '\\') {
+        builder.push_back(*p++);
+        continue;
+      }
+      ++p;
+      switch (*p) {
+        // clang-format off
+        case '"':  builder.push_back('"');  ++p; break;
+        case '\\': builder.push_back('\\'); ++p; break;
+        case '/':  builder.push_back('/');  ++p; break;
+        case 'b':  builder.push_back('\b'); ++p; break;
+        case 'f':  builder.push_back('\f'); ++p; break;
+        case 'n':  builder.push_back('\n'); ++p; break;
+        case 'r':  builder.push_back('\r'); ++p; break;
+        case 't':  builder.push_back('\t'); ++p; break;
+        // clang-format on
+        case 'u':
+          ++p;
+          decode_unicode_escape(p, end, builder);
+          break;
+        default:
+          throw_parse_error(p - in_.data(), "unknown escape in string");
+      }
+    }
+    auto size = builder.size();
+    builder.commit();
+    tape.push_back(word(tag_string, kArenaString | (doc_.strings_.size() - 1)));
+    tape.push_back(uint64_t(size));
+  }
+
+  template <class Builder>
+  void decode_unicode_escape(const char*& p, const char* end, Builder& out) {
+    auto read_hex = [&]() -> uint16_t {
+      if (end - p < 4) {
+        throw_parse_error(p - in_.data(), "expected 4 hex digits");
+      }
+      uint16_t ret = 0;
+      for (int i = 0; i < 4; ++i, ++p) {
+        char c = *p;
+        int digit;
+        if (c >= '0' && c <= '9') {
+          digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+          digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+          digit = c - 'A' + 10;
+        } else {
+          throw_parse_error(p - in_.data(), "invalid hex digit");
+        }
+        ret = uint16_t(ret * 16 + digit);
+      }
+      return ret;
+    };
+
+    uint16_t prefix = read_hex();
+    char32_t code_point = prefix;
+    if (utf16_code_unit_is_high_surrogate(prefix)) {
+      if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+        throw_parse_error(
+            p - in_.data(),
+            "expected another unicode escape for second half of "
+            "surrogate pair");
+      }
+      p += 2;
+      uint16_t suffix = read_hex();
+      if (!utf16_code_unit_is_low_surrogate(suffix)) {
+        throw_parse_error(
+            p - in_.data(), "second character in surrogate pair is invalid");
+      }
+      code_point = unicode_code_point_from_utf16_surrogate_pair(prefix, suffix);
+    } else if (!utf16_code_unit_is_bmp(prefix)) {
+      throw_parse_error(
+          p - in_.data(),
+          "invalid unicode code point (in range [0xdc00,0xdfff])");
+    }
+    auto utf8 = codePointToUtf8(code_point);
+    std::copy(utf8.begin(), utf8.end(), out.back_inserter());
+  }
+
+  // Scalars end at the next structural character or whitespace; stage 1 has
+  // recorded where the next token starts, but not where this one ends.
+  StringPiece scalar_token(uint32_t off) const {
+    const char* p = in_.data() + off;
+    const char* end = in_.data() + in_.size();
+    const char* q = p;
+    while (q != end) {
+      switch (*q) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+        case '"':
+          return StringPiece(p, q);
+        default:
+          ++q;
+      }
+    }
+    return StringPiece(p, q);
+  }
+
+  void push_double(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(d));
+    doc_.tape_.push_back(word(tag_double, 0));
+    doc_.tape_.push_back(bits);
+  }
+
+  void parse_scalar(uint32_t off) {
+    auto& tape = doc_.tape_;
+    auto token = scalar_token(off);
+    if (token == "true") {
+      tape.push_back(word(tag_true, 0));
+    } else if (token == "false") {
+      tape.push_back(word(tag_false, 0));
+    } else if (token == "null") {
+      tape.push_back(word(tag_null, 0));
+    } else if (token == "Infinity") {
+      push_double(std::numeric_limits<double>::infinity());
+    } else if (token == "-Infinity") {
+      push_double(-std::numeric_limits<double>::infinity());
+    } else if (token == "NaN") {
+      push_double(std::numeric_limits<double>::quiet_NaN());
+    } else {
+      parse_number(off, token);
+    }
+  }
+
+  void parse_number(uint32_t off, StringPiece token) {
+    auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+    const char* p = token.begin();
+    const char* end = token.end();
+    if (p != end && *p == '-') {
+      ++p;
+    }
+    const char* digits = p;
+    while (p != end && is_digit(*p)) {
+      ++p;
+    }
+    if (p == digits) {
+      throw_parse_error(
+          off,
+          token[0] == '-' ? "expected digits after `-'"
+                          : "expected json value");
+    }
+    bool integral = true;
+    if (p != end && *p == '.') {
+      integral = false;
+      ++p;
+      while (p != end && is_digit(*p)) {
+        ++p;
+      }
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+      integral = false;
+      ++p;
+      if (p != end && (*p == '+' || *p == '-')) {
+        ++p;
+      }
+      const char* exp = p;
+      while (p != end && is_digit(*p)) {
+        ++p;
+      }
+      if (p == exp) {
+        throw_parse_error(off, "expected digits in exponent");
+      }
+    }
+    if (p != end) {
+      throw_parse_error(off, "unexpected character in number");
+    }
+
+    if (integral) {
+      auto i = tryTo<int64_t>(token);
+      if (i.hasValue()) {
+        doc_.tape_.push_back(word(tag_int64, 0));
+        doc_.tape_.push_back(uint64_t(*i));
+        return;
+      }
+      if (!opts_.double_fallback) {
+        throw_parse_error(off, "integer out of range");
+      }
+    }
+    auto d = tryTo<double>(token);
+    if (!d.hasValue()) {
+      throw_parse_error(off, "invalid number");
+    }
+    push_double(*d);
+  }
+
+  json_tape& doc_;
+  const StringPiece in_;
+  const json::serialization_opts& opts_;
+  std::vector<uint32_t>& structurals_;
+};
+
+json_tape json_tape::parse(
+    StringPiece input, const json::serialization_opts& opts) {
+  json_tape doc;
+  doc.reparse(input, opts);
+  // Only worth keeping when the json_tape is reused.
+  doc.structurals_ = {};
+  return doc;
+}
+
+void json_tape::reparse(
+    StringPiece input, const json::serialization_opts& opts) {
+  tape_.clear();
+  strings_.clear();
+  structurals_.clear();
+  input_ = input;
+  try {
+    if (input.size() > std::numeric_limits<uint32_t>::max()) {
+      throw_parse_error(0, "input too large");
+    }
+    parser(*this, opts).run();
+  } catch (...) {
+    input_ = {};
+    tape_.assign(1, uint64_t(tag_null) << 56);
+    strings_.clear();
+    throw;
+  }
+}
+
+dynamic json_tape::to_dynamic(uint32_t i) const {
+  switch (tag_at(i)) {
+    case tag_null:
+      return nullptr;
+    case tag_true:
+      return true;
+    case tag_false:
+      return false;
+    case tag_int64:
+      return value(this, i).as_int();
+    case tag_double:
+      return value(this, i).as_double();
+    case tag_string: {
+      auto s = string_at(i);
+      return dynamic(std::string(s.data(), s.size()));
+    }
+    case tag_array_begin: {
+      dynamic ret = dynamic::array;
+      ret.reserve(value(this, i).size());
+      auto end = uint32_t(payload_at(i));
+      for (auto j = i + 1; j != end; j = skip(j)) {
+        ret.push_back(to_dynamic(j));
+      }
+      return ret;
+    }
+    case tag_object_begin: {
+      dynamic ret = dynamic::object;
+      auto end = uint32_t(payload_at(i));
+      for (auto j = i + 1; j != end; j = skip(j + 2)) {
+        auto key = string_at(j);
+        ret[std::string(key.data(), key.size())] = to_dynamic(j + 2);
+      }
+      return ret;
+    }
+    case tag_array_end:
+    case tag_object_end:
+    default:
+      break;
+  }
+  assume_unreachable();
+}
+
+dynamic::Type json_tape::value::type() const {
+  switch (doc_->tag_at(index_)) {
+    case tag_null:
+      return dynamic::NULLT;
+    case tag_true:
+    case tag_false:
+      return dynamic::BOOL;
+    case tag_int64:
+      return dynamic::INT64;
+    case tag_double:
+      return dynamic::DOUBLE;
+    case tag_string:
+      return dynamic::STRING;
+    case tag_array_begin:
+      return dynamic::ARRAY;
+    case tag_object_begin:
+      return dynamic::OBJECT;
+    case tag_array_end:
+    case tag_object_end:
+    default:
+      break;
+  }
+  assume_unreachable();
+}
+
+void json_tape::value::expect(tag t, const char* expected) const {
+  if (doc_->tag_at(index_) != t) {
+    throw_exception<TypeError>(expected, type());
+  }
+}
+
+std::size_t json_tape::value::size() const {
+  auto t = doc_->tag_at(index_);
+  if (t != tag_array_begin && t != tag_object_begin) {
+    throw_exception<TypeError>("array/object", type());
+  }
+  auto count = doc_->payload_at(index_) >> 32;
+  if (count < kMaxCount) {
+    return std::size_t(count);
+  }
+  std::size_t n = 0;
+  auto end = uint32_t(doc_->payload_at(index_));
+  auto stride = t == tag_object_begin ? 2 : 0;
+  for (auto j = index_ + 1; j != end; j = doc_->skip(j + stride)) {
+    ++n;
+  }
+  return n;
+}
+
+Optional<json_tape::value> json_tape::value::operator[](std::size_t i) const {
+  for (auto v : elements()) {
+    if (i-- == 0) {
+      return v;
+    }
+  }
+  return none;
+}
+
+Optional<json_tape::value> json_tape::value::find(std::string_view key) const {
+  Optional<value> ret;
+  for (auto [k, v] : items()) {
+    if (k == key) {
+      ret = v;
+    }
+  }
+  return ret;
+}
+
+} // namespace folly
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/container/tape.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+
+namespace folly {
+
+/*
+ * json_tape
+ *
+ * A read-only JSON document, parsed into a flat array of 64-bit words (the
+ * "tape") in the style of simdjson (Langdale and Lemire, "Parsing Gigabytes
+ * of JSON per Second", 2019).
+ *
+ * Parsing happens in two stages. The first one classifies the input 64 bytes
+ * at a time using SIMD compares where available, resolves escapes and string
+ * boundaries with bitwise arithmetic, and produces the offsets of all the
+ * structural characters and of the first byte of every scalar. The second
+ * one walks these offsets, validates the grammar and writes the tape. Unlike
+ * parseJson(), which allocates a node per value and a buffer per string, the
+ * whole document lives in two buffers: the tape and a string_tape holding the
+ * unescaped copies of the strings that contain escape sequences. All other
+ * strings, including object keys, are string_views into the input, which must
+ * therefore outlive the json_tape.
+ *
+ * Values are accessed through json_tape::value, a cheap handle. Arrays and
+ * objects know their size and where they end, so skipping over them is
+ * constant time, but indexing an array or looking up an object key is linear
+ * in the number of elements. to_dynamic() converts (a subtree of) the
+ * document when a mutable representation is needed.
+ *
+ * The accepted syntax is the same as parseJson()'s: in particular, top-level
+ * scalars, NaN and (-)Infinity are accepted. Of the serialization_opts, only
+ * allow_trailing_comma, double_fallback and recursion_limit are honored; as
+ * with parseJson(), if an object has duplicate keys the last one wins.
+ * Documents are limited to 4GB. On error, json::parse_error is thrown.
+ *
+ *   auto doc = json_tape::parse(R"({"a": [1, 2.5, "three"]})");
+ *   for (auto v : doc.root()["a"]->elements()) { ... }
+ */
+class json_tape {
+ public:
+  class value;
+  class array_iterator;
+  class object_iterator;
+
+  template <class Iterator>
+  class range {
+   public:
+    range(Iterator b, Iterator e) : begin_(b), end_(e) {}
+    Iterator begin() const { return begin_; }
+    Iterator end() const { return end_; }
+
+   private:
+    Iterator begin_;
+    Iterator end_;
+  };
+
+  static json_tape parse(
+      StringPiece input, const json::serialization_opts& opts = {});
+
+  /// Replaces the document with the parse of input, reusing the memory of
+  /// the current one: once warmed up, parsing a stream of documents with one
+  /// json_tape does not allocate. Values of the previous document are
+  /// invalidated. If parsing fails, the document is left null.
+  void reparse(StringPiece input, const json::serialization_opts& opts = {});
+
+  json_tape(json_tape&&) = default;
+  json_tape& operator=(json_tape&&) = default;
+
+  value root() const;
+
+  dynamic to_dynamic() const;
+
+  /// Number of 64-bit words in the tape, for memory accounting.
+  std::size_t tape_size() const { return tape_.size(); }
+
+ private:
+  friend class value;
+  friend class array_iterator;
+  friend class object_iterator;
+  class parser;
+
+  // Each word holds a tag in its top byte and a 56-bit payload.
+  enum tag : uint8_t {
+    tag_null = 'n',
+    tag_true = 't',
+    tag_false = 'f',
+    tag_int64 = 'l', // followed by a word holding the value
+    tag_double = 'd', // followed by a word holding the value's bits
+    tag_string = 's', // payload: source and offset; followed by the length
+    tag_array_begin = '[', // payload: count << 32 | index of array_end
+    tag_array_end = ']', // payload: index of array_begin
+    tag_object_begin = '{', // payload: count << 32 | index of object_end
+    tag_object_end = '}', // payload: index of object_begin
+  };
+
+  static constexpr uint64_t kPayloadMask = (uint64_t(1) << 56) - 1;
+  // Set in a string's payload if its offset is a record of strings_.
+  static constexpr uint64_t kArenaString = uint64_t(1) << 55;
+  static constexpr uint64_t kMaxCount = (uint64_t(1) << 24) - 1;
+
+  json_tape() = default;
+
+  tag tag_at(uint32_t i) const { return tag(tape_[i] >> 56); }
+  uint64_t payload_at(uint32_t i) const { return tape_[i] & kPayloadMask; }
+
+  /// Index of the word following the value starting at i.
+  uint32_t skip(uint32_t i) const {
+    switch (tag_at(i)) {
+      case tag_array_begin:
+      case tag_object_begin:
+        return uint32_t(payload_at(i)) + 1;
+      case tag_int64:
+      case tag_double:
+      case tag_string:
+        return i + 2;
+      default:
+        return i + 1;
+    }
+  }
+
+  std::string_view string_at(uint32_t i) const {
+    auto payload = payload_at(i);
+    auto size = std::size_t(tape_[i + 1]);
+    if (payload & kArenaString) {
+      auto record = strings_[std::size_t(payload & ~kArenaString)];
+      return std::string_view(record.data(), record.size());
+    }
+    return std::string_view(input_.data() + payload, size);
+  }
+
+  dynamic to_dynamic(uint32_t i) const;
+
+  StringPiece input_;
+  std::vector<uint64_t> tape_;
+  string_tape strings_;
+  // Scratch space of the parser, kept for reparse().
+  std::vector<uint32_t> structurals_;
+};
+
+/// A handle on one value of a json_tape; valid as long as the json_tape is.
+class json_tape::value {
+ public:
+  dynamic::Type type() const;
+
+  bool is_null() const { return doc_->tag_at(index_) == tag_null; }
+  bool is_bool() const {
+    auto t = doc_->tag_at(index_);
+    return t == tag_true || t == tag_false;
+  }
+  bool is_int() const { return doc_->tag_at(index_) == tag_int64; }
+  bool is_double() const { return doc_->tag_at(index_) == tag_double; }
+  bool is_number() const { return is_int() || is_double(); }
+  bool is_string() const { return doc_->tag_at(index_) == tag_string; }
+  bool is_array() const { return doc_->tag_at(index_) == tag_array_begin; }
+  bool is_object() const { return doc_->tag_at(index_) == tag_object_begin; }
+
+  /// The accessors throw TypeError if the value has a different type, except
+  /// that as_double() also accepts integers.
+  bool as_bool() const;
+  int64_t as_int() const;
+  double as_double() const;
+  std::string_view as_string() const;
+
+  /// Number of elements of an array or members of an object.
+  std::size_t size() const;
+
+  /// The elements of an array.
+  range<array_iterator> elements() const;
+  /// The (key, value) members of an object, in document order.
+  range<object_iterator> items() const;
+
+  /// Element i of an array, or none if out of range. Linear in i.
+  Optional<value> operator[](std::size_t i) const;
+  /// Member of an object, or none if absent. Linear in the object's size.
+  Optional<value> find(std::string_view key) const;
+  Optional<value> operator[](std::string_view key) const { return find(key); }
+
+  dynamic to_dynamic() const { return doc_->to_dynamic(index_); }
+
+ private:
+  friend class json_tape;
+  friend class array_iterator;
+  friend class object_iterator;
+
+  value(const json_tape* doc, uint32_t index) : doc_(doc), index_(index) {}
+
+  void expect(tag t, const char* expected) const;
+
+  const json_tape* doc_;
+  uint32_t index_;
+};
+
+class json_tape::array_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = json_tape::value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = json_tape::value;
+
+  value operator*() const { return value(doc_, index_); }
+  array_iterator& operator++() {
+    index_ = doc_->skip(index_);
+    return *this;
+  }
+  array_iterator operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+  friend bool operator==(array_iterator a, array_iterator b) {
+    return a.index_ == b.index_;
+  }
+  friend bool operator!=(array_iterator a, array_iterator b) {
+    return a.index_ != b.index_;
+  }
+
+ private:
+  friend class json_tape::value;
+
+  array_iterator(const json_tape* doc, uint32_t index)
+      : doc_(doc), index_(index) {}
+
+  const json_tape* doc_;
+  uint32_t index_;
+};
+
+class json_tape::object_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<std::string_view, json_tape::value>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  value_type operator*() const {
+    return {doc_->string_at(index_), value(doc_, index_ + 2)};
+  }
+  object_iterator& operator++() {
+    index_ = doc_->skip(index_ + 2);
+    return *this;
+  }
+  object_iterator operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+  friend bool operator==(object_iterator a, object_iterator b) {
+    return a.index_ == b.index_;
+  }
+  friend bool operator!=(object_iterator a, object_iterator b) {
+    return a.index_ != b.index_;
+  }
+
+ private:
+  friend class json_tape::value;
+
+  object_iterator(const json_tape* doc, uint32_t index)
+      : doc_(doc), index_(index) {}
+
+  const json_tape* doc_;
+  uint32_t index_;
+};
+
+inline json_tape::value json_tape::root() const {
+  return value(this, 0);
+}
+
+inline dynamic json_tape::to_dynamic() const {
+  return to_dynamic(0);
+}
+
+inline bool json_tape::value::as_bool() const {
+  auto t = doc_->tag_at(index_);
+  if (t != tag_true && t != tag_false) {
+    expect(tag_true, "bool");
+  }
+  return t == tag_true;
+}
+
+inline int64_t json_tape::value::as_int() const {
+  expect(tag_int64, "int64");
+  return int64_t(doc_->tape_[index_ + 1]);
+}
+
+inline double json_tape::value::as_double() const {
+  if (is_int()) {
+    return double(int64_t(doc_->tape_[index_ + 1]));
+  }
+  expect(tag_double, "double");
+  double d;
+  std::memcpy(&d, &doc_->tape_[index_ + 1], sizeof(d));
+  return d;
+}
+
+inline std::string_view json_tape::value::as_string() const {
+  expect(tag_string, "string");
+  return doc_->string_at(index_);
+}
+
+inline auto json_tape::value::elements() const -> range<array_iterator> {
+  expect(tag_array_begin, "array");
+  return {
+      array_iterator(doc_, index_ + 1),
+      array_iterator(doc_, uint32_t(doc_->payload_at(index_)))};
+}
+
+inline auto json_tape::value::items() const -> range<object_iterator> {
+  expect(tag_object_begin, "object");
+  return {
+      object_iterator(doc_, index_ + 1),
+      object_iterator(doc_, uint32_t(doc_->payload_at(index_)))};
+}
+
+} // namespace folly
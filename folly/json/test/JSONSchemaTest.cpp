@@ -15,6 +15,10 @@
  */
 
 #include <folly/json/JSONSchema.h>
+
+#include <thread>
+#include <vector>
+
 #include <folly/json/json.h>
 #include <folly/portability/GTest.h>
 
@@ -181,6 +185,14 @@ TEST(JSONSchemaTest, TestArrayUniqueItems) {
 
   schema = dynamic::object("uniqueItems", false);
   ASSERT_TRUE(check(schema, dynamic::array(1, 2, 3, 1)));
+
+  schema = dynamic::object("uniqueItems", true);
+  ASSERT_FALSE(check(schema, dynamic::array(1, 2.0, 2)));
+  ASSERT_FALSE(check(
+      schema,
+      dynamic::array(
+          dynamic::array(1, dynamic::object("a", 1)),
+          dynamic::array(1, dynamic::object("a", 1)))));
 }
 
 TEST(JSONSchemaTest, TestArrayItems) {
@@ -288,6 +300,17 @@ TEST(JSONSchemaTest, TestProperties) {
   ASSERT_TRUE(check(schema, dynamic::object("other_property", 4)));
   ASSERT_FALSE(check(schema, dynamic::object("other_property", 6)));
 }
+TEST(JSONSchemaTest, TestPropertiesOfLargerObject) {
+  dynamic schema = dynamic::object(
+      "properties", dynamic::object("p1", dynamic::object("minimum", 1)));
+  dynamic value = dynamic::object("p1", 1)("p2", 0)("p3", "x");
+  ASSERT_TRUE(check(schema, value));
+  value["p1"] = 0;
+  ASSERT_FALSE(check(schema, value));
+  value.erase("p1");
+  ASSERT_TRUE(check(schema, value));
+}
+
 TEST(JSONSchemaTest, TestPropertyAndPattern) {
   dynamic schema = dynamic::object(
       "properties", dynamic::object("p1", dynamic::object("minimum", 1)))(
@@ -448,3 +471,29 @@ TEST(JSONSchemaTest, TestProductSchema) {
   }";
   ASSERT_TRUE(check(parseJson(productSchema), parseJson(product)));
 }
+
+TEST(JSONSchemaTest, TestValidateEach) {
+  auto validator = makeValidator(dynamic::object("type", "integer"));
+  auto values = dynamic::array(1, "two", 3, dynamic::array());
+  for (bool parallel : {false, true}) {
+    auto results = parallel
+        ? validator->try_validate_each(
+              values,
+              [](size_t n, folly::FunctionRef<void(size_t)> task) {
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < n; ++i) {
+                  threads.emplace_back([&task, i] { task(i); });
+                }
+                for (auto& thread : threads) {
+                  thread.join();
+                }
+              })
+        : validator->try_validate_each(values);
+    ASSERT_EQ(4, results.size());
+    EXPECT_FALSE(results[0]);
+    EXPECT_TRUE(results[1]);
+    EXPECT_FALSE(results[2]);
+    EXPECT_TRUE(results[3]);
+  }
+  EXPECT_THROW(validator->try_validate_each(1), folly::TypeError);
+}
@@ -17,6 +17,9 @@
 #include <folly/json/json.h>
 
 #include <folly/Benchmark.h>
+#include <folly/io/IOBuf.h>
+#include <folly/json/json_iobuf.h>
+#include <folly/json/json_tape.h>
 
 #include <fstream>
 #include <streambuf>
@@ -240,6 +243,46 @@ BENCHMARK(PerfJson2Obj, iters) {
   }
 }
 
+BENCHMARK_RELATIVE(PerfJson2Tape, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(json_tape::parse(kJsonBenchmarkString));
+  }
+}
+
+BENCHMARK_RELATIVE(PerfJson2TapeToObj, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(
+        json_tape::parse(kJsonBenchmarkString).to_dynamic());
+  }
+}
+
+BENCHMARK_RELATIVE(PerfJson2TapeReparse, iters) {
+  BenchmarkSuspender s;
+  auto doc = json_tape::parse(kJsonBenchmarkString);
+  s.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    doc.reparse(kJsonBenchmarkString);
+    folly::doNotOptimizeAway(doc.tape_size());
+  }
+}
+
+BENCHMARK(PerfObjDestroy, iters) {
+  // Freeing a parsed dynamic releases every node and string separately.
+  BenchmarkSuspender s;
+  for (size_t i = 0; i < iters; ++i) {
+    dynamic parsed = parseJson(kJsonBenchmarkString);
+    s.dismissing([&] { parsed = nullptr; });
+  }
+}
+
+BENCHMARK_RELATIVE(PerfTapeDestroy, iters) {
+  BenchmarkSuspender s;
+  for (size_t i = 0; i < iters; ++i) {
+    auto doc = folly::make_optional(json_tape::parse(kJsonBenchmarkString));
+    s.dismissing([&] { doc.reset(); });
+  }
+}
+
 BENCHMARK(PerfObj2Json, iters) {
   BenchmarkSuspender s;
   dynamic parsed = parseJson(kJsonBenchmarkString);
@@ -250,6 +293,38 @@ BENCHMARK(PerfObj2Json, iters) {
   }
 }
 
+// A multi-MB response, serialized to be written to a socket.
+static dynamic largeDocument() {
+  dynamic parsed = parseJson(kJsonBenchmarkString);
+  dynamic doc = dynamic::array;
+  for (size_t i = 0; i < 1000; ++i) {
+    doc.push_back(parsed);
+  }
+  return doc;
+}
+
+BENCHMARK(PerfLargeObj2JsonIOBufCopy, iters) {
+  BenchmarkSuspender s;
+  dynamic doc = largeDocument();
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(IOBuf::copyBuffer(toJson(doc)));
+  }
+}
+
+BENCHMARK_RELATIVE(PerfLargeObj2JsonIOBufQueue, iters) {
+  BenchmarkSuspender s;
+  dynamic doc = largeDocument();
+  s.dismiss();
+
+  for (size_t i = 0; i < iters; ++i) {
+    IOBufQueue queue{IOBufQueue::cacheChainLength()};
+    toJson(doc, queue);
+    folly::doNotOptimizeAway(queue.move());
+  }
+}
+
 // Benchmark results in a Macbook Pro 2015 (i7-4870HQ, 4th gen)
 // ============================================================================
 // folly/test/JsonBenchmark.cpp                   relative  time/iter   iters/s
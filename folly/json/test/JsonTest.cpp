@@ -503,9 +503,9 @@ TEST(Json, JsonEscape) {
 }
 
 TEST(Json, EscapeCornerCases) {
-  // The escaping logic uses some bitwise operations to determine
-  // which bytes need escaping 8 bytes at a time. Test that this logic
-  // is correct regardless of positions by planting 2 characters that
+  // The escaping logic uses SIMD or bitwise operations to determine
+  // which bytes need escaping up to 32 bytes at a time. Test that this
+  // logic is correct regardless of positions by planting 2 characters that
   // may need escaping at each possible position and checking the
   // result, for varying string lengths.
 
@@ -517,7 +517,7 @@ TEST(Json, EscapeCornerCases) {
   for (bool ascii : {true, false}) {
     opts.encode_non_ascii = ascii;
 
-    for (size_t len = 2; len < 32; ++len) {
+    for (size_t len = 2; len < 72; ++len) {
       for (size_t i = 0; i < len; ++i) {
         for (size_t j = 0; j < len; ++j) {
           if (i == j) {
@@ -673,7 +673,19 @@ TEST(Json, UTF8Validation) {
   // not a valid unicode because it is larger than the max 0x10FFFF code-point
   EXPECT_ANY_THROW(folly::json::serialize("\xF6\x8D\x9B\xBC", opts));
 
+  // Strings long enough to be validated a register at a time.
+  std::string valid;
+  for (int i = 0; i < 20; ++i) {
+    valid += "x\xe2\x82\xac";
+  }
+  EXPECT_EQ(folly::json::serialize(valid, opts), "\"" + valid + "\"");
+  EXPECT_ANY_THROW(folly::json::serialize(valid + "\xc0\x80" + valid, opts));
+  EXPECT_ANY_THROW(folly::json::serialize(valid + "\xe2\x82", opts));
+
   opts.skip_invalid_utf8 = true;
+  EXPECT_EQ(
+      folly::json::serialize(valid + "\xc0" + valid, opts),
+      "\"" + valid + "\xef\xbf\xbd" + valid + "\"");
   EXPECT_EQ(
       folly::json::serialize("a\xe0\xa0\x80z\xc0\x80", opts),
       reinterpret_cast<const char*>(u8"\"a\xe0\xa0\x80z\ufffd\ufffd\""));
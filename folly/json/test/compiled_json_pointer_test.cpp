@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/compiled_json_pointer.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <folly/json/json.h>
+#include <folly/portability/GTest.h>
+
+using folly::compiled_json_pointer;
+using folly::dynamic;
+using folly::json_pointer;
+using folly::json_tape;
+
+namespace {
+
+constexpr folly::StringPiece kJson = R"({
+  "a": {"b": [10, 20, {"c": "d"}], "": 1, "x/y": 2, "m~n": 3},
+  "00": "zero",
+  "-": "dash",
+  "s": "str",
+  "n": null
+})";
+
+const char* const kPointers[] = {
+    "",
+    "/a",
+    "/a/b",
+    "/a/b/0",
+    "/a/b/2/c",
+    "/a/b/3",
+    "/a/b/-",
+    "/a/b/-/c",
+    "/a/",
+    "/a/x~1y",
+    "/a/m~0n",
+    "/00",
+    "/-",
+    "/n",
+    "/missing",
+    "/missing/deeper",
+};
+
+const char* const kThrowing[] = {
+    "/a/b/01", // leading zero
+    "/a/b/x", // not numeric
+    "/a/b/", // not numeric
+    "/s/0", // not a container
+    "/n/x", // not a container
+};
+
+} // namespace
+
+TEST(CompiledJsonPointerTest, SameAsDynamic) {
+  auto const doc = folly::parseJson(kJson);
+  for (auto str : kPointers) {
+    SCOPED_TRACE(str);
+    auto const pointer = json_pointer::parse(str);
+    compiled_json_pointer const compiled(pointer);
+    EXPECT_EQ(pointer, compiled.pointer());
+    EXPECT_EQ(doc.get_ptr(pointer), compiled.get_ptr(doc));
+  }
+  for (auto str : kThrowing) {
+    SCOPED_TRACE(str);
+    compiled_json_pointer const compiled(str);
+    EXPECT_ANY_THROW(doc.get_ptr(json_pointer::parse(str)));
+    EXPECT_ANY_THROW(compiled.get_ptr(doc));
+  }
+  EXPECT_THROW(
+      compiled_json_pointer("/a/b/01").get_ptr(doc), std::invalid_argument);
+  EXPECT_THROW(compiled_json_pointer("/s/0").get_ptr(doc), folly::TypeError);
+  EXPECT_THROW(compiled_json_pointer("a"), json_pointer::parse_exception);
+}
+
+TEST(CompiledJsonPointerTest, Mutable) {
+  dynamic doc = folly::parseJson(kJson);
+  compiled_json_pointer const ptr("/a/b/2/c");
+  *ptr.get_ptr(doc) = "e";
+  EXPECT_EQ("e", doc["a"]["b"][2]["c"]);
+}
+
+TEST(CompiledJsonPointerTest, PrehashedGetPtr) {
+  auto const doc = folly::parseJson(kJson);
+  for (std::string key : {"a", "00", "-", "missing"}) {
+    EXPECT_EQ(doc.get_ptr(key), doc.get_ptr(key, dynamic(key).hash()));
+  }
+  EXPECT_THROW(doc["s"].get_ptr("x", dynamic("x").hash()), folly::TypeError);
+}
+
+TEST(CompiledJsonPointerTest, Tape) {
+  auto const doc = folly::parseJson(kJson);
+  auto const tape = json_tape::parse(kJson);
+  for (auto str : kPointers) {
+    SCOPED_TRACE(str);
+    compiled_json_pointer const compiled(str);
+    auto const expected = compiled.get_ptr(doc);
+    auto const actual = compiled.get(tape.root());
+    ASSERT_EQ(expected != nullptr, actual.has_value());
+    if (expected) {
+      EXPECT_EQ(*expected, actual->to_dynamic());
+    }
+  }
+  for (auto str : kThrowing) {
+    SCOPED_TRACE(str);
+    EXPECT_ANY_THROW(compiled_json_pointer(str).get(tape.root()));
+  }
+}
+
+TEST(CompiledJsonPointerTest, Extract) {
+  std::vector<compiled_json_pointer> const pointers = {
+      compiled_json_pointer("/a/b/2"),
+      compiled_json_pointer("/missing"),
+      compiled_json_pointer("/s"),
+  };
+  auto const values = compiled_json_pointer::extract(
+      kJson, folly::range(pointers));
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(dynamic(dynamic::object("c", "d")), values[0]);
+  EXPECT_FALSE(values[1].has_value());
+  EXPECT_EQ(dynamic("str"), values[2]);
+  EXPECT_THROW(
+      compiled_json_pointer::extract("{", folly::range(pointers)),
+      folly::json::parse_error);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_iobuf.h>
+
+#include <string>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::IOBufQueue;
+
+namespace {
+
+std::string toString(IOBufQueue& queue) {
+  return queue.empty() ? std::string() : queue.move()->toString();
+}
+
+dynamic makeLarge() {
+  dynamic d = dynamic::object;
+  for (int i = 0; i < 2000; ++i) {
+    auto name = "entry \"" + std::to_string(i) + "\"";
+    dynamic entry = dynamic::object("id", i)("name", name)("score", i / 7.0)(
+        "tags", dynamic::array("a", "b", nullptr, true));
+    d[std::to_string(i)] = std::move(entry);
+  }
+  d["blob"] = std::string(100000, 'x');
+  return d;
+}
+
+} // namespace
+
+TEST(JsonIOBufTest, SameAsString) {
+  std::vector<dynamic> values = {
+      nullptr,
+      1,
+      -2.5,
+      "str\n\"ing\"",
+      dynamic::array,
+      dynamic::object,
+      dynamic::array(1, "two", dynamic::object("three", 3)),
+      dynamic::object("b", 1)("a", dynamic::array(2, 3))("c", nullptr),
+      makeLarge(),
+  };
+  for (auto& v : values) {
+    IOBufQueue compact;
+    folly::toJson(v, compact);
+    EXPECT_EQ(folly::toJson(v), toString(compact));
+
+    IOBufQueue pretty;
+    folly::toPrettyJson(v, pretty);
+    EXPECT_EQ(folly::toPrettyJson(v), toString(pretty));
+  }
+}
+
+TEST(JsonIOBufTest, Options) {
+  dynamic d = dynamic::object("z", 1)("y", int64_t(1) << 40)("x", "é");
+  folly::json::serialization_opts opts;
+  opts.sort_keys = true;
+  opts.encode_non_ascii = true;
+  opts.javascript_safe = true;
+  IOBufQueue queue;
+  folly::json::serialize(d, opts, queue);
+  EXPECT_EQ(folly::json::serialize(d, opts), toString(queue));
+
+  d["y"] = (int64_t(1) << 60) + 1;
+  EXPECT_THROW(folly::json::serialize(d, opts, queue), folly::ConversionError);
+}
+
+TEST(JsonIOBufTest, Appends) {
+  IOBufQueue queue;
+  queue.append("prefix ");
+  folly::io::QueueAppender appender(&queue, 16);
+  folly::json::serialize(
+      dynamic::array(1, 2), folly::json::serialization_opts(), appender);
+  appender.push(folly::ByteRange(folly::StringPiece(" suffix")));
+  EXPECT_EQ("prefix [1,2] suffix", toString(queue));
+}
+
+TEST(JsonIOBufTest, Chunks) {
+  auto d = makeLarge();
+  auto expected = folly::toJson(d);
+  std::string out;
+  size_t chunks = 0;
+  folly::json::serialize(
+      d, folly::json::serialization_opts(), [&](folly::StringPiece chunk) {
+        EXPECT_FALSE(chunk.empty());
+        out.append(chunk.data(), chunk.size());
+        ++chunks;
+      });
+  EXPECT_EQ(expected, out);
+  // The output is split, apart from the 100KB string which is one value.
+  EXPECT_GT(chunks, 10);
+  EXPECT_LT(chunks, expected.size() / 4096);
+
+  IOBufQueue queue;
+  folly::toJson(d, queue);
+  EXPECT_GT(queue.front()->countChainElements(), 1);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_struct.h>
+
+#include <cmath>
+#include <limits>
+
+#include <folly/portability/GTest.h>
+
+namespace test {
+
+struct Endpoint {
+  std::string host;
+  uint16_t port = 0;
+
+  friend bool operator==(const Endpoint& a, const Endpoint& b) {
+    return a.host == b.host && a.port == b.port;
+  }
+};
+FOLLY_JSON_STRUCT(Endpoint, host, port)
+
+struct Config {
+  std::string name;
+  bool enabled = false;
+  int32_t retries = 0;
+  double ratio = 0;
+  std::vector<Endpoint> endpoints;
+  std::map<std::string, int64_t> limits;
+  folly::Optional<std::string> comment;
+  std::optional<std::vector<int>> shards;
+  folly::dynamic extra;
+};
+FOLLY_JSON_STRUCT(
+    Config,
+    name,
+    enabled,
+    retries,
+    ratio,
+    endpoints,
+    limits,
+    comment,
+    shards,
+    extra)
+
+} // namespace test
+
+using folly::dynamic;
+using namespace folly::json_struct;
+
+namespace {
+
+constexpr folly::StringPiece kConfig = R"({
+  "name": "svc",
+  "enabled": true,
+  "retries": 3,
+  "ratio": 1,
+  "endpoints": [{"host": "a", "port": 80}, {"host": "b\n", "port": 443}],
+  "limits": {"qps": 100, "~/": -1},
+  "shards": null,
+  "extra": {"x": [1, "y"]}
+})";
+
+std::string errorPointer(folly::StringPiece json, const options& opts = {}) {
+  try {
+    parse<test::Config>(json, opts);
+  } catch (const error& e) {
+    return e.pointer();
+  }
+  ADD_FAILURE() << "no error: " << json;
+  return {};
+}
+
+} // namespace
+
+TEST(JsonStructTest, Registered) {
+  EXPECT_TRUE(is_registered_v<test::Config>);
+  EXPECT_FALSE(is_registered_v<std::string>);
+}
+
+TEST(JsonStructTest, Parse) {
+  auto const config = parse<test::Config>(kConfig);
+  EXPECT_EQ("svc", config.name);
+  EXPECT_TRUE(config.enabled);
+  EXPECT_EQ(3, config.retries);
+  EXPECT_EQ(1.0, config.ratio);
+  ASSERT_EQ(2, config.endpoints.size());
+  EXPECT_EQ((test::Endpoint{"b\n", 443}), config.endpoints[1]);
+  EXPECT_EQ(100, config.limits.at("qps"));
+  EXPECT_EQ(-1, config.limits.at("~/"));
+  EXPECT_FALSE(config.comment.has_value());
+  EXPECT_FALSE(config.shards.has_value());
+  EXPECT_EQ(dynamic::array(1, "y"), config.extra["x"]);
+}
+
+TEST(JsonStructTest, RoundTrip) {
+  auto const config = parse<test::Config>(kConfig);
+  auto const json = serialize(config);
+  // Absent optional fields are omitted.
+  EXPECT_EQ(std::string::npos, json.find("comment"));
+  EXPECT_EQ(std::string::npos, json.find("shards"));
+  // The text is the same as the one of the dynamic of the original.
+  auto expected = folly::parseJson(kConfig);
+  expected.erase("shards");
+  expected["ratio"] = 1.0;
+  EXPECT_EQ(expected, folly::parseJson(json));
+
+  auto copy = config;
+  copy.comment = "c";
+  copy.shards.emplace({1, 2});
+  auto const again = parse<test::Config>(serialize(copy));
+  EXPECT_EQ("c", again.comment.value());
+  EXPECT_EQ((std::vector<int>{1, 2}), again.shards.value());
+  EXPECT_EQ(copy.endpoints, again.endpoints);
+}
+
+TEST(JsonStructTest, OtherTypes) {
+  EXPECT_EQ(
+      (std::vector<test::Endpoint>{{"h", 1}}),
+      parse<std::vector<test::Endpoint>>(R"([{"host": "h", "port": 1}])"));
+  EXPECT_EQ("[1,2,3]", serialize(std::vector<int>{1, 2, 3}));
+  EXPECT_EQ("\"a\\\"b\"", serialize(std::string("a\"b")));
+  EXPECT_EQ(2.5, parse<double>("2.5"));
+}
+
+TEST(JsonStructTest, Validation) {
+  EXPECT_EQ("/retries", errorPointer(R"({"retries": "3"})"));
+  EXPECT_EQ(
+      "/endpoints/1/port",
+      errorPointer(
+          R"({"name": "", "endpoints": [{"host": "", "port": 1},
+              {"host": "", "port": 65536}]})"));
+  EXPECT_EQ("/limits/~0~1", errorPointer(R"({"limits": {"~/": 1.5}})"));
+  EXPECT_EQ("", errorPointer("[]"));
+
+  // Required fields.
+  options lenient;
+  lenient.allow_missing_fields = true;
+  EXPECT_EQ("/enabled", errorPointer(R"({"name": "svc"})"));
+  auto const partial = parse<test::Config>(R"({"retries": 1})", lenient);
+  EXPECT_EQ(1, partial.retries);
+  EXPECT_FALSE(partial.enabled);
+
+  // Unknown fields.
+  options strict;
+  strict.allow_unknown_fields = false;
+  strict.allow_missing_fields = true;
+  EXPECT_NO_THROW(parse<test::Config>(R"({"other": 1})", lenient));
+  EXPECT_EQ("/other", errorPointer(R"({"other": 1})", strict));
+
+  try {
+    parse<test::Endpoint>(R"({"host": 1, "port": 1})");
+    ADD_FAILURE();
+  } catch (const error& e) {
+    EXPECT_STREQ(
+        "folly::json_struct: /host: expected string, got integer", e.what());
+  }
+  EXPECT_THROW(parse<test::Endpoint>("{"), folly::json::parse_error);
+}
+
+TEST(JsonStructTest, NonFinite) {
+  EXPECT_THROW(
+      serialize(std::numeric_limits<double>::infinity()),
+      folly::json::print_error);
+  options opts;
+  opts.json_opts.allow_nan_inf = true;
+  EXPECT_EQ("NaN", serialize(std::nan(""), opts));
+}
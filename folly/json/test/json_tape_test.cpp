@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/json_tape.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/json/json.h>
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::json_tape;
+
+namespace {
+
+void checkSameAsParseJson(
+    folly::StringPiece json, const folly::json::serialization_opts& opts = {}) {
+  SCOPED_TRACE(json.str());
+  EXPECT_EQ(
+      folly::parseJson(json, opts), json_tape::parse(json, opts).to_dynamic());
+}
+
+} // namespace
+
+TEST(JsonTapeTest, Scalars) {
+  EXPECT_TRUE(json_tape::parse("null").root().is_null());
+  EXPECT_TRUE(json_tape::parse(" true ").root().as_bool());
+  EXPECT_FALSE(json_tape::parse("false").root().as_bool());
+  EXPECT_EQ(-42, json_tape::parse("-42").root().as_int());
+  EXPECT_EQ(1.5, json_tape::parse("1.5").root().as_double());
+  EXPECT_EQ(1e10, json_tape::parse("1e10").root().as_double());
+  EXPECT_EQ(3.0, json_tape::parse("3").root().as_double());
+  EXPECT_EQ("abc", json_tape::parse("\"abc\"").root().as_string());
+  EXPECT_EQ(
+      INT64_MIN, json_tape::parse("-9223372036854775808").root().as_int());
+  EXPECT_TRUE(std::isinf(json_tape::parse("-Infinity").root().as_double()));
+  EXPECT_TRUE(std::isnan(json_tape::parse("NaN").root().as_double()));
+
+  auto doc = json_tape::parse("\"x\"");
+  auto v = doc.root();
+  EXPECT_EQ(dynamic::STRING, v.type());
+  EXPECT_THROW(v.as_int(), folly::TypeError);
+  EXPECT_THROW(v.size(), folly::TypeError);
+  EXPECT_THROW(v.elements(), folly::TypeError);
+}
+
+TEST(JsonTapeTest, Navigation) {
+  std::string json = R"({
+    "name": "tape",
+    "tags": ["a", "b", "c"],
+    "nested": {"x": 1, "y": [true, null, {}], "z": []},
+    "count": 3
+  })";
+  auto doc = json_tape::parse(json);
+  auto root = doc.root();
+  ASSERT_TRUE(root.is_object());
+  EXPECT_EQ(4, root.size());
+  EXPECT_EQ("tape", root["name"]->as_string());
+  EXPECT_EQ(3, root["count"]->as_int());
+  EXPECT_FALSE(root.find("missing").has_value());
+
+  auto tags = *root["tags"];
+  EXPECT_EQ(3, tags.size());
+  std::vector<std::string> seen;
+  for (auto tag : tags.elements()) {
+    seen.emplace_back(tag.as_string());
+  }
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), seen);
+  EXPECT_EQ("c", tags[2]->as_string());
+  EXPECT_FALSE(tags[3].has_value());
+
+  auto nested = *root["nested"];
+  auto y = *nested["y"];
+  EXPECT_TRUE(y[0]->as_bool());
+  EXPECT_TRUE(y[1]->is_null());
+  EXPECT_TRUE(y[2]->is_object());
+  EXPECT_EQ(0, y[2]->size());
+  EXPECT_EQ(0, nested["z"]->size());
+
+  std::vector<std::string> keys;
+  for (auto [key, value] : root.items()) {
+    keys.emplace_back(key);
+  }
+  EXPECT_EQ(
+      (std::vector<std::string>{"name", "tags", "nested", "count"}), keys);
+
+  EXPECT_EQ(folly::parseJson(json), doc.to_dynamic());
+  EXPECT_EQ(folly::parseJson(json)["nested"], nested.to_dynamic());
+}
+
+TEST(JsonTapeTest, ZeroCopyStrings) {
+  std::string json = R"(["plain", "esc\"aped\n", "\u00e9\ud83d\ude00"])";
+  auto doc = json_tape::parse(json);
+  auto plain = doc.root()[0]->as_string();
+  EXPECT_EQ("plain", plain);
+  // Strings without escapes point into the input.
+  EXPECT_GE(plain.data(), json.data());
+  EXPECT_LT(plain.data(), json.data() + json.size());
+  EXPECT_EQ("esc\"aped\n", doc.root()[1]->as_string());
+  EXPECT_EQ("\u00e9\U0001F600", doc.root()[2]->as_string());
+}
+
+TEST(JsonTapeTest, Reparse) {
+  std::string first = R"({"a": [1, 2, "esc\"aped"], "b": {"c": null}})";
+  std::string second = R"(["x\ny", 3.5, {"z": true}])";
+  auto doc = json_tape::parse(first);
+  doc.reparse(second);
+  EXPECT_EQ(folly::parseJson(second), doc.to_dynamic());
+  doc.reparse(first);
+  EXPECT_EQ(folly::parseJson(first), doc.to_dynamic());
+
+  EXPECT_THROW(doc.reparse("[1, 2"), folly::json::parse_error);
+  EXPECT_TRUE(doc.root().is_null());
+  doc.reparse(second);
+  EXPECT_EQ(folly::parseJson(second), doc.to_dynamic());
+}
+
+TEST(JsonTapeTest, DuplicateKeys) {
+  auto doc = json_tape::parse(R"({"a": 1, "a": 2})");
+  EXPECT_EQ(2, doc.root().size());
+  EXPECT_EQ(2, doc.root()["a"]->as_int());
+  EXPECT_EQ(dynamic(dynamic::object("a", 2)), doc.to_dynamic());
+}
+
+TEST(JsonTapeTest, Options) {
+  folly::json::serialization_opts opts;
+  EXPECT_THROW(json_tape::parse("[1,]"), folly::json::parse_error);
+  opts.allow_trailing_comma = true;
+  checkSameAsParseJson("[1,]", opts);
+  checkSameAsParseJson(R"({"a": [1, 2, ], "b": {"c": 3,},})", opts);
+  EXPECT_THROW(json_tape::parse("[,]", opts), folly::json::parse_error);
+
+  EXPECT_THROW(
+      json_tape::parse("9223372036854775808"), folly::json::parse_error);
+  opts.double_fallback = true;
+  EXPECT_EQ(
+      9223372036854775808.0,
+      json_tape::parse("9223372036854775808", opts).root().as_double());
+
+  opts.recursion_limit = 3;
+  EXPECT_NO_THROW(json_tape::parse("[[[1]]]", opts));
+  EXPECT_THROW(json_tape::parse("[[[[1]]]]", opts), folly::json::parse_error);
+}
+
+TEST(JsonTapeTest, Errors) {
+  for (auto json : {
+           "",
+           "   ",
+           "[",
+           "]",
+           "{",
+           "{]",
+           "[1 2]",
+           "[1,,2]",
+           "{\"a\" 1}",
+           "{\"a\":}",
+           "{1: 2}",
+           "{\"a\": 1,}",
+           "\"unterminated",
+           "\"escaped quote\\\"",
+           "tru",
+           "nulll",
+           "-",
+           "1.5.3",
+           "1e",
+           "01x",
+           "[1]x",
+           "1 2",
+           "\"a\"\"b\"",
+           "\"bad \\q escape\"",
+           "\"\\u12\"",
+           "\"\\ud800\"",
+       }) {
+    SCOPED_TRACE(json);
+    EXPECT_THROW(json_tape::parse(json), folly::json::parse_error);
+  }
+  EXPECT_THROW(
+      json_tape::parse(folly::StringPiece("\"a\0b\"", 5)),
+      folly::json::parse_error);
+}
+
+TEST(JsonTapeTest, BlockBoundaries) {
+  // Move escapes, quotes and scalars across the 64-byte blocks of stage 1.
+  for (size_t pad = 0; pad < 140; ++pad) {
+    std::string s(pad, ' ');
+    checkSameAsParseJson(s + R"(["a\\", "b\\\"c", 12345, true, "\\\\"])");
+    checkSameAsParseJson("[\"" + std::string(pad, 'x') + "\\\\\\\"\", 1]");
+    checkSameAsParseJson(
+        "{\"" + std::string(pad, '\\') + std::string(pad % 2, '\\') +
+        "\": 0." + std::string(pad + 1, '1') + "}");
+  }
+}
+
+TEST(JsonTapeTest, MatchesParseJson) {
+  std::mt19937 rng(1234);
+  auto pick = [&](size_t n) { return size_t(rng() % n); };
+  std::function<dynamic(int)> gen = [&](int depth) -> dynamic {
+    switch (depth > 4 ? pick(5) : pick(7)) {
+      case 0:
+        return nullptr;
+      case 1:
+        return pick(2) == 0;
+      case 2:
+        return int64_t(rng()) - int64_t(rng()) * 1000;
+      case 3:
+        return double(rng()) / 7;
+      case 4: {
+        std::string s;
+        for (size_t i = pick(40); i > 0; --i) {
+          static const char kChars[] = "ab\"\\/\n\t {}[]:,\x01\xc3\xa9";
+          s.push_back(kChars[pick(sizeof(kChars) - 1)]);
+        }
+        return s;
+      }
+      case 5: {
+        dynamic a = dynamic::array;
+        for (size_t i = pick(6); i > 0; --i) {
+          a.push_back(gen(depth + 1));
+        }
+        return a;
+      }
+      default: {
+        dynamic o = dynamic::object;
+        for (size_t i = pick(6); i > 0; --i) {
+          o[folly::to<std::string>("k", pick(100), "\"\\")] = gen(depth + 1);
+        }
+        return o;
+      }
+    }
+  };
+  for (int i = 0; i < 500; ++i) {
+    auto d = gen(0);
+    auto json = i % 2 ? folly::toJson(d) : folly::toPrettyJson(d);
+    SCOPED_TRACE(json);
+    EXPECT_EQ(d, json_tape::parse(json).to_dynamic());
+  }
+}
@@ -632,6 +632,26 @@ void* exception_ptr_get_object_(
 
 #endif // defined(_WIN32)
 
+void* exception_ptr_get_object_cached_(
+    std::exception_ptr const& ptr,
+    std::type_info const* const target,
+    exception_ptr_upcast_cache& cache) noexcept {
+  auto const object = static_cast<char*>(exception_ptr_get_object_(ptr, {}));
+  auto const type = object ? exception_ptr_get_type_(ptr) : nullptr;
+  if (!type) {
+    return nullptr;
+  }
+  if (type != cache.type) {
+    auto const upcast =
+        static_cast<char*>(exception_ptr_get_object_(ptr, target));
+    auto const none = exception_ptr_upcast_cache::none;
+    cache = {type, upcast ? upcast - object : none};
+  }
+  return cache.offset == exception_ptr_upcast_cache::none
+      ? nullptr
+      : object + cache.offset;
+}
+
 } // namespace detail
 
 namespace detail {
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <string>
@@ -457,6 +459,24 @@ std::type_info const* exception_ptr_get_type_(
 void* exception_ptr_get_object_(
     std::exception_ptr const&, std::type_info const*) noexcept;
 
+//  The offset of the target subobject within the stored exception object, for
+//  the last stored type seen. The offset only depends on the pair of types, so
+//  repeated lookups of the same target in exceptions of the same type may skip
+//  walking the class hierarchy.
+struct exception_ptr_upcast_cache {
+  static constexpr std::ptrdiff_t none = PTRDIFF_MIN;
+
+  std::type_info const* type;
+  std::ptrdiff_t offset;
+};
+template <typename T>
+thread_local exception_ptr_upcast_cache exception_ptr_upcast_cache_v{};
+
+void* exception_ptr_get_object_cached_(
+    std::exception_ptr const&,
+    std::type_info const*,
+    exception_ptr_upcast_cache&) noexcept;
+
 } // namespace detail
 
 //  exception_ptr_access
@@ -523,9 +543,16 @@ T* exception_ptr_get_object(std::exception_ptr const& ptr) noexcept {
         ptr, +[](T& ex) { return std::addressof(ex); });
   }
   auto const target = type_info_of<T>();
-  auto const object =
-      !to_bool(target) ? nullptr : exception_ptr_get_object(ptr, target);
-  return static_cast<T*>(object);
+  if (!to_bool(target)) {
+    return nullptr;
+  }
+  if constexpr (std::is_class_v<T>) {
+    // class targets are found at a fixed offset within each stored type
+    auto& cache = detail::exception_ptr_upcast_cache_v<std::remove_cv_t<T>>;
+    return static_cast<T*>(
+        detail::exception_ptr_get_object_cached_(ptr, target, cache));
+  }
+  return static_cast<T*>(exception_ptr_get_object(ptr, target));
 }
 
 /// exception_ptr_try_get_object_exact_fast
@@ -855,6 +882,26 @@ struct make_exception_ptr_with_fn {
 };
 inline constexpr make_exception_ptr_with_fn make_exception_ptr_with{};
 
+/// static_exception_ptr
+///
+/// Returns a std::exception_ptr holding a default-constructed exception of type
+/// E, which is created on first use and never destroyed. Copying the result is
+/// only a refcount increment, with no allocation and no construction of an
+/// exception object, so this suits stateless errors which may be reported at a
+/// high rate, such as timeouts and cancellation.
+///
+/// All copies share the same exception object, which must not be mutated.
+///
+/// Example:
+///
+///   exception_wrapper ew{static_exception_ptr<FutureTimeout>()};
+template <typename E>
+std::exception_ptr const& static_exception_ptr() {
+  static auto const& ptr =
+      *new std::exception_ptr(make_exception_ptr_with(std::in_place_type<E>));
+  return ptr;
+}
+
 //  exception_shared_string
 //
 //  An immutable refcounted string, with the same layout as a pointer, suitable
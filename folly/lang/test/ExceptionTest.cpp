@@ -421,6 +421,62 @@ TEST_F(ExceptionTest, make_exception_ptr_with_in_place) {
   EXPECT_EQ(17, *folly::exception_ptr_get_object<int>(ptr));
 }
 
+TEST_F(ExceptionTest, exception_ptr_get_object_repeated) {
+  using A0 = Virt<0>;
+  using A1 = Virt<1>;
+  struct B : A1 {
+    char pad[24] = {};
+  };
+  struct C : virtual A0, B {};
+  struct D : B, virtual A0 {};
+  struct P : private A1 {};
+
+  // Lookups of a base may be answered from a per-thread cache of the offset of
+  // the base in the last stored type; alternate the types to exercise it.
+  auto const c1 = std::make_exception_ptr(C());
+  auto const c2 = std::make_exception_ptr(C());
+  auto const d = std::make_exception_ptr(D());
+  auto const p = std::make_exception_ptr(P());
+  auto const i = std::make_exception_ptr(17);
+  for (int n = 0; n < 2; ++n) {
+    for (auto const& ptr : {c1, d, c2, p, i, std::exception_ptr(), c1}) {
+      auto const object = folly::exception_ptr_get_object(ptr);
+      auto const type = folly::exception_ptr_get_type(ptr);
+      auto const a0 = folly::exception_ptr_get_object<A0>(ptr);
+      auto const a1 = folly::exception_ptr_get_object<A1 const>(ptr);
+      auto const b = folly::exception_ptr_get_object<B>(ptr);
+      if (type == &typeid(C)) {
+        EXPECT_EQ(static_cast<A0*>(static_cast<C*>(object)), a0);
+        EXPECT_EQ(static_cast<A1*>(static_cast<C*>(object)), a1);
+        EXPECT_EQ(static_cast<B*>(static_cast<C*>(object)), b);
+      } else if (type == &typeid(D)) {
+        EXPECT_EQ(static_cast<A0*>(static_cast<D*>(object)), a0);
+        EXPECT_EQ(static_cast<A1*>(static_cast<D*>(object)), a1);
+        EXPECT_EQ(static_cast<B*>(static_cast<D*>(object)), b);
+      } else {
+        EXPECT_EQ(nullptr, a0);
+        EXPECT_EQ(nullptr, a1);
+        EXPECT_EQ(nullptr, b);
+      }
+      if (a1) {
+        EXPECT_EQ(1, a1->value);
+      }
+    }
+  }
+}
+
+TEST_F(ExceptionTest, static_exception_ptr) {
+  auto const& ptr = folly::static_exception_ptr<std::bad_alloc>();
+  EXPECT_EQ(&ptr, &folly::static_exception_ptr<std::bad_alloc>());
+  EXPECT_EQ(&typeid(std::bad_alloc), folly::exception_ptr_get_type(ptr));
+  EXPECT_NE(ptr, folly::static_exception_ptr<std::exception>());
+  auto const copy = ptr;
+  EXPECT_EQ(
+      folly::exception_ptr_get_object(ptr),
+      folly::exception_ptr_get_object(copy));
+  EXPECT_THROW(std::rethrow_exception(copy), std::bad_alloc);
+}
+
 TEST_F(ExceptionTest, get_exception_from_std_exception_ptr) {
   using folly::get_exception;
   using folly::get_mutable_exception;
@@ -73,6 +73,26 @@ void AsyncFileWriter::writeToFile(
 #endif // _WIN32
   }
 
+  writeNumDiscardedMsg(numDiscarded);
+}
+
+void AsyncFileWriter::writeToFile(
+    const std::vector<struct iovec>& data, size_t numDiscarded) {
+  // Each entry already points at a run of several messages.  writevFull()
+  // updates the iovecs it is given, so write them from a copy.
+  constexpr size_t kNumIovecs = 64;
+  std::array<iovec, kNumIovecs> iovecs;
+  for (size_t idx = 0; idx < data.size(); idx += kNumIovecs) {
+    auto num = std::min(kNumIovecs, data.size() - idx);
+    std::copy_n(data.begin() + idx, num, iovecs.begin());
+    auto ret = folly::writevFull(file_.fd(), iovecs.data(), int(num));
+    folly::checkUnixError(ret, "writevFull() failed");
+  }
+
+  writeNumDiscardedMsg(numDiscarded);
+}
+
+void AsyncFileWriter::writeNumDiscardedMsg(size_t numDiscarded) {
   if (numDiscarded > 0) {
     auto msg = getNumDiscardedMsg(numDiscarded);
     if (!msg.empty()) {
@@ -99,6 +119,21 @@ void AsyncFileWriter::performIO(
   }
 }
 
+void AsyncFileWriter::performBufferIO(
+    const std::vector<struct iovec>& data, size_t numDiscarded) {
+  try {
+    writeToFile(data, numDiscarded);
+  } catch (const std::exception& ex) {
+    LoggerDB::internalWarning(
+        __FILE__,
+        __LINE__,
+        "error writing to log file ",
+        file_.fd(),
+        " in AsyncFileWriter: ",
+        folly::exceptionStr(ex));
+  }
+}
+
 std::string AsyncFileWriter::getNumDiscardedMsg(size_t numDiscarded) {
   // We may want to make this customizable in the future (e.g., to allow it to
   // conform to the LogFormatter style being used).
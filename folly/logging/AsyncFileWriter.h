@@ -55,9 +55,13 @@ class AsyncFileWriter : public AsyncLogWriter {
  private:
   void writeToFile(
       const std::vector<std::string>& ioQueue, size_t numDiscarded);
+  void writeToFile(const std::vector<struct iovec>& data, size_t numDiscarded);
+  void writeNumDiscardedMsg(size_t numDiscarded);
 
   void performIO(
       const std::vector<std::string>& ioQueue, size_t numDiscarded) override;
+  void performBufferIO(
+      const std::vector<struct iovec>& data, size_t numDiscarded) override;
 
   std::string getNumDiscardedMsg(size_t numDiscarded);
 
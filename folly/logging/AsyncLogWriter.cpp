@@ -16,9 +16,13 @@
 
 #include <folly/logging/AsyncLogWriter.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
 #include <folly/Portability.h>
+#include <folly/lang/Bits.h>
 #include <folly/logging/LoggerDB.h>
 #include <folly/system/AtFork.h>
 #include <folly/system/ThreadName.h>
@@ -75,7 +79,9 @@ void AsyncLogWriter::invokeDiscardCallback(size_t numDiscarded) {
 
 void AsyncLogWriter::cleanup() {
   std::vector<std::string>* ioQueue;
+  std::vector<std::pair<size_t, DeferredLogMessage>>* deferredQueue;
   size_t numDiscarded;
+  std::vector<struct iovec> bufferData;
   {
     // Stop the I/O thread
     auto data = data_.lock();
@@ -85,27 +91,77 @@ void AsyncLogWriter::cleanup() {
     // without waiting for all pending messages to be written.  Extract any
     // remaining messages to write them below.
     ioQueue = data->getCurrentQueue();
-    numDiscarded = data->numDiscarded;
+    deferredQueue = data->getCurrentDeferredQueue();
+    numDiscarded = data->numDiscarded + collectBufferDiscards(*data);
+    for (const auto& buffer : data->threadBuffers) {
+      buffer->getPending(bufferData);
+    }
   }
+  formatDeferredMessages(*ioQueue, *deferredQueue);
   if (numDiscarded > 0) {
     invokeDiscardCallback(numDiscarded);
   }
 
   // If there are still any pending messages, flush them now.
-  if (!ioQueue->empty()) {
+  if (!bufferData.empty()) {
+    performBufferIO(bufferData, 0);
+  }
+  if (!ioQueue->empty() || numDiscarded > 0) {
     performIO(*ioQueue, numDiscarded);
   }
 }
 
+AsyncLogWriter::ThreadBuffer::ThreadBuffer(size_t size)
+    : capacity(nextPowTwo(size)), buf(new char[capacity]) {}
+
+bool AsyncLogWriter::ThreadBuffer::tryWrite(StringPiece msg) {
+  auto t = tail.load(std::memory_order_relaxed);
+  auto h = head.load(std::memory_order_acquire);
+  if (capacity - (t - h) < msg.size()) {
+    return false;
+  }
+  auto offset = t & (capacity - 1);
+  auto first = std::min(msg.size(), capacity - offset);
+  std::memcpy(buf.get() + offset, msg.data(), first);
+  std::memcpy(buf.get(), msg.data() + first, msg.size() - first);
+  tail.store(t + msg.size(), std::memory_order_release);
+  return true;
+}
+
+size_t AsyncLogWriter::ThreadBuffer::getPending(
+    std::vector<struct iovec>& iov) const {
+  auto h = head.load(std::memory_order_relaxed);
+  auto t = tail.load(std::memory_order_acquire);
+  if (t != h) {
+    auto offset = h & (capacity - 1);
+    auto first = std::min(t - h, capacity - offset);
+    iov.push_back({buf.get() + offset, first});
+    if (first < t - h) {
+      iov.push_back({buf.get(), t - h - first});
+    }
+  }
+  return t;
+}
+
 void AsyncLogWriter::writeMessage(StringPiece buffer, uint32_t flags) {
+  if (perThreadBufferSize_.load(std::memory_order_relaxed) != 0 &&
+      writeToThreadBuffer(buffer, flags)) {
+    return;
+  }
   return writeMessage(buffer.str(), flags);
 }
 
 void AsyncLogWriter::writeMessage(std::string&& buffer, uint32_t flags) {
+  if (perThreadBufferSize_.load(std::memory_order_relaxed) != 0 &&
+      writeToThreadBuffer(buffer, flags)) {
+    return;
+  }
+
   auto data = data_.lock();
   if ((data->currentBufferSize >= data->maxBufferBytes) &&
       !(flags & NEVER_DISCARD)) {
     ++data->numDiscarded;
+    ++data->totalDiscarded;
     return;
   }
 
@@ -115,6 +171,112 @@ void AsyncLogWriter::writeMessage(std::string&& buffer, uint32_t flags) {
   messageReady_.notify_one();
 }
 
+bool AsyncLogWriter::writeDeferredMessage(
+    DeferredLogMessage&& message, uint32_t flags) {
+  auto data = data_.lock();
+  if ((data->currentBufferSize >= data->maxBufferBytes) &&
+      !(flags & NEVER_DISCARD)) {
+    ++data->numDiscarded;
+    ++data->totalDiscarded;
+    return true;
+  }
+
+  data->currentBufferSize += sizeof(DeferredLogMessage);
+  auto* queue = data->getCurrentQueue();
+  data->getCurrentDeferredQueue()->emplace_back(
+      queue->size(), std::move(message));
+  queue->emplace_back();
+  messageReady_.notify_one();
+  return true;
+}
+
+void AsyncLogWriter::formatDeferredMessages(
+    std::vector<std::string>& queue,
+    std::vector<std::pair<size_t, DeferredLogMessage>>& deferredQueue) {
+  for (const auto& [index, message] : deferredQueue) {
+    queue[index] = message.format();
+  }
+  deferredQueue.clear();
+}
+
+bool AsyncLogWriter::writeToThreadBuffer(StringPiece buffer, uint32_t flags) {
+  auto& threadBuffer =
+      getThreadBuffer(perThreadBufferSize_.load(std::memory_order_relaxed));
+  if (buffer.size() > threadBuffer.capacity) {
+    return false;
+  }
+
+  if (!threadBuffer.tryWrite(buffer)) {
+    if (!(flags & NEVER_DISCARD) &&
+        overflowPolicy_.load(std::memory_order_relaxed) ==
+            OverflowPolicy::DISCARD) {
+      threadBuffer.numDiscarded.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    // The I/O thread never waits while a buffer has data in it, so it will
+    // eventually make room.
+    do {
+      notifyIoThreadIfWaiting();
+      std::this_thread::yield();
+    } while (!threadBuffer.tryWrite(buffer));
+  }
+
+  notifyIoThreadIfWaiting();
+  return true;
+}
+
+AsyncLogWriter::ThreadBuffer& AsyncLogWriter::getThreadBuffer(
+    size_t bufferSize) {
+  auto& holder = *threadBuffers_;
+  if (FOLLY_UNLIKELY(!holder.buffer)) {
+    holder.buffer = std::make_shared<ThreadBuffer>(bufferSize);
+    auto data = data_.lock();
+    data->threadBuffers.push_back(holder.buffer);
+    ++data->threadBuffersVersion;
+  }
+  return *holder.buffer;
+}
+
+void AsyncLogWriter::notifyIoThreadIfWaiting() {
+  // Pairs with the fence in ioThread(): either the I/O thread sees the data
+  // that was just published, or we see that it is waiting and wake it up.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ioThreadWaiting_.load(std::memory_order_relaxed)) {
+    // Notify with the lock held so the I/O thread cannot miss it between
+    // checking for data and waiting.
+    auto data = data_.lock();
+    messageReady_.notify_one();
+  }
+}
+
+bool AsyncLogWriter::hasBufferedData(const Data& data) {
+  for (const auto& buffer : data.threadBuffers) {
+    if (!buffer->empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t AsyncLogWriter::collectBufferDiscards(Data& data) {
+  size_t numDiscarded = 0;
+  for (const auto& buffer : data.threadBuffers) {
+    numDiscarded += buffer->numDiscarded.exchange(0, std::memory_order_relaxed);
+  }
+  data.totalDiscarded += numDiscarded;
+  return numDiscarded;
+}
+
+void AsyncLogWriter::performBufferIO(
+    const std::vector<struct iovec>& data, size_t numDiscarded) {
+  std::vector<std::string> logs;
+  logs.reserve(data.size());
+  for (const auto& iov : data) {
+    logs.emplace_back(static_cast<const char*>(iov.iov_base), iov.iov_len);
+  }
+  performIO(logs, numDiscarded);
+}
+
 void AsyncLogWriter::flush() {
   auto data = data_.lock();
   auto start = data->ioThreadCounter;
@@ -146,21 +308,58 @@ size_t AsyncLogWriter::getMaxBufferSize() const {
   return data->maxBufferBytes;
 }
 
+void AsyncLogWriter::setPerThreadBufferSize(
+    size_t bufferSize, OverflowPolicy policy) {
+  overflowPolicy_.store(policy, std::memory_order_relaxed);
+  perThreadBufferSize_.store(bufferSize, std::memory_order_relaxed);
+}
+
+size_t AsyncLogWriter::getPerThreadBufferSize() const {
+  return perThreadBufferSize_.load(std::memory_order_relaxed);
+}
+
+size_t AsyncLogWriter::getNumDiscarded() const {
+  auto data = data_.lock();
+  auto numDiscarded = data->totalDiscarded;
+  for (const auto& buffer : data->threadBuffers) {
+    numDiscarded += buffer->numDiscarded.load(std::memory_order_relaxed);
+  }
+  return numDiscarded;
+}
+
 void AsyncLogWriter::ioThread() {
   folly::setThreadName("log_writer");
 
+  // A copy of data_->threadBuffers, so they can be drained without the lock.
+  std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+  uint64_t threadBuffersVersion = 0;
+  std::vector<struct iovec> bufferData;
+  std::vector<size_t> bufferTails;
+
   while (true) {
     // With the lock held, grab a pointer to the current queue, then increment
     // the ioThreadCounter index so that other threads will write into the
     // other queue as we process this one.
     std::vector<std::string>* ioQueue;
+    std::vector<std::pair<size_t, DeferredLogMessage>>* deferredQueue;
     size_t numDiscarded;
     {
       auto data = data_.lock();
       ioQueue = data->getCurrentQueue();
-      while (ioQueue->empty() && !(data->flags & FLAG_STOP)) {
-        // Wait for a message or one of the above flags to be set.
-        messageReady_.wait(data.as_lock());
+      deferredQueue = data->getCurrentDeferredQueue();
+      auto hasWork = [&] {
+        return !ioQueue->empty() || (data->flags & FLAG_STOP) ||
+            hasBufferedData(*data);
+      };
+      if (!hasWork()) {
+        ioThreadWaiting_.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in notifyIoThreadIfWaiting().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!hasWork()) {
+          // Wait for a message or one of the above flags to be set.
+          messageReady_.wait(data.as_lock());
+        }
+        ioThreadWaiting_.store(false, std::memory_order_relaxed);
       }
 
       if (data->flags & FLAG_STOP) {
@@ -177,14 +376,42 @@ void AsyncLogWriter::ioThread() {
       }
 
       ++data->ioThreadCounter;
-      numDiscarded = data->numDiscarded;
+      numDiscarded = data->numDiscarded + collectBufferDiscards(*data);
       data->numDiscarded = 0;
       data->currentBufferSize = 0;
+
+      // Forget the buffers of threads that exited once they are drained.
+      auto& buffers = data->threadBuffers;
+      auto it = std::remove_if(buffers.begin(), buffers.end(), [](auto& b) {
+        return b->orphaned.load(std::memory_order_acquire) && b->empty();
+      });
+      if (it != buffers.end()) {
+        buffers.erase(it, buffers.end());
+        ++data->threadBuffersVersion;
+      }
+      if (threadBuffersVersion != data->threadBuffersVersion) {
+        threadBuffers = buffers;
+        threadBuffersVersion = data->threadBuffersVersion;
+      }
     }
     ioCV_.notify_all();
 
     // Write the log messages now that we have released the lock
-    performIO(*ioQueue, numDiscarded);
+    formatDeferredMessages(*ioQueue, *deferredQueue);
+    bufferData.clear();
+    bufferTails.clear();
+    for (const auto& buffer : threadBuffers) {
+      bufferTails.push_back(buffer->getPending(bufferData));
+    }
+    if (!bufferData.empty()) {
+      performBufferIO(bufferData, 0);
+      for (size_t i = 0; i < threadBuffers.size(); ++i) {
+        threadBuffers[i]->head.store(bufferTails[i], std::memory_order_release);
+      }
+    }
+    if (!ioQueue->empty() || numDiscarded > 0) {
+      performIO(*ioQueue, numDiscarded);
+    }
 
     if (numDiscarded > 0) {
       invokeDiscardCallback(numDiscarded);
@@ -228,6 +455,12 @@ void AsyncLogWriter::postForkChild() {
   // and we let the parent process handle writing them.
   lockedData_->queues[0].clear();
   lockedData_->queues[1].clear();
+  lockedData_->deferredQueues[0].clear();
+  lockedData_->deferredQueues[1].clear();
+  for (const auto& buffer : lockedData_->threadBuffers) {
+    auto tail = buffer->tail.load(std::memory_order_relaxed);
+    buffer->head.store(tail, std::memory_order_relaxed);
+  }
 
   // Restart the I/O thread
   restartThread();
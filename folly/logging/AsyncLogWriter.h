@@ -16,14 +16,20 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 #include <folly/File.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
+#include <folly/ThreadLocal.h>
+#include <folly/lang/Align.h>
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/LogWriter.h>
+#include <folly/portability/SysUio.h>
 
 namespace folly {
 
@@ -45,6 +51,15 @@ namespace folly {
  * However, one downside is that if your program crashes, not all log messages
  * may have been written, so you may lose messages generated immediately before
  * the crash.
+ *
+ * By default all writer threads append to a single mutex-protected queue. With
+ * setPerThreadBufferSize() each writer thread appends to its own ring buffer
+ * instead, without locking or allocating, and the I/O thread drains all the
+ * rings at once.
+ *
+ * Messages logged with XLOGF_DEFERRED() are queued unformatted and formatted
+ * by the I/O thread right before performIO().  They always go through the
+ * shared queue, in order with the other messages of that queue.
  */
 class AsyncLogWriter : public LogWriter {
  public:
@@ -63,6 +78,9 @@ class AsyncLogWriter : public LogWriter {
 
   void writeMessage(std::string&& buffer, uint32_t flags = 0) override;
 
+  bool writeDeferredMessage(
+      DeferredLogMessage&& message, uint32_t flags = 0) override;
+
   /**
    * Block until the I/O thread has finished writing all messages that
    * were already enqueued when flush() was called.
@@ -99,6 +117,39 @@ class AsyncLogWriter : public LogWriter {
    */
   static void setDiscardCallback(DiscardCallback callback);
 
+  /**
+   * What happens to a message that does not fit in the free space of the
+   * writing thread's buffer.
+   */
+  enum class OverflowPolicy {
+    // Discard it, as the shared queue does when it exceeds its maximum size.
+    DISCARD,
+    // Wait for the I/O thread to make room for it.
+    BLOCK,
+  };
+
+  /**
+   * Give each thread that writes messages its own ring buffer of bufferSize
+   * bytes (rounded up to a power of two), which it fills without taking any
+   * lock.  The messages of each thread are written out in order, but the
+   * interleaving between threads is only approximately chronological.
+   *
+   * Messages flagged NEVER_DISCARD always block rather than being discarded,
+   * and messages larger than a whole buffer go through the shared queue.
+   *
+   * A bufferSize of 0 (the default) goes back to the shared queue.  Buffers
+   * that were already allocated keep their size.
+   */
+  void setPerThreadBufferSize(
+      size_t bufferSize, OverflowPolicy policy = OverflowPolicy::DISCARD);
+
+  size_t getPerThreadBufferSize() const;
+
+  /**
+   * Get the total number of messages discarded so far.
+   */
+  size_t getNumDiscarded() const;
+
  protected:
   /**
    * Drain up the log message queue. Subclasses must call this method in their
@@ -106,6 +157,16 @@ class AsyncLogWriter : public LogWriter {
    */
   void cleanup();
 
+  /**
+   * Called in the I/O thread with the contents of the per-thread buffers.
+   * Each iovec holds complete messages from a single thread, in order.
+   *
+   * The default implementation copies the data into strings and passes them to
+   * performIO().  Subclasses can override it to avoid the copy.
+   */
+  virtual void performBufferIO(
+      const std::vector<struct iovec>& data, size_t numDiscarded);
+
  private:
   enum Flags : uint32_t {
     // FLAG_IO_THREAD_STARTED indicates that the constructor has started the
@@ -132,18 +193,65 @@ class AsyncLogWriter : public LogWriter {
    * We could potentially also provide an implementation using folly::MPMCQueue
    * in the future, which may improve contention under very high write loads.
    */
+  /*
+   * A single producer, single consumer ring buffer of message bytes.  Only the
+   * owning thread moves tail, and only the I/O thread moves head.
+   */
+  struct ThreadBuffer {
+    explicit ThreadBuffer(size_t size);
+
+    // Returns false if there is not enough free space for msg.
+    bool tryWrite(StringPiece msg);
+    // Appends the iovecs for the bytes in [head, tail) and returns tail.
+    size_t getPending(std::vector<struct iovec>& iov) const;
+    bool empty() const {
+      return head.load(std::memory_order_relaxed) ==
+          tail.load(std::memory_order_acquire);
+    }
+
+    const size_t capacity;
+    const std::unique_ptr<char[]> buf;
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> tail{0};
+    std::atomic<size_t> numDiscarded{0};
+    alignas(hardware_destructive_interference_size) std::atomic<size_t> head{0};
+    // set once the owning thread exited
+    std::atomic<bool> orphaned{false};
+  };
+
+  struct ThreadBufferHolder {
+    ~ThreadBufferHolder() {
+      if (buffer) {
+        buffer->orphaned.store(true, std::memory_order_release);
+      }
+    }
+
+    std::shared_ptr<ThreadBuffer> buffer;
+  };
+
   struct Data {
     std::array<std::vector<std::string>, 2> queues;
+    // The deferred messages of each queue, with the index of the empty string
+    // in the queue that their text replaces.
+    std::array<std::vector<std::pair<size_t, DeferredLogMessage>>, 2>
+        deferredQueues;
     uint32_t flags{0};
     uint64_t ioThreadCounter{0};
     size_t maxBufferBytes{kDefaultMaxBufferSize};
     size_t currentBufferSize{0};
     size_t numDiscarded{0};
+    size_t totalDiscarded{0};
     std::thread ioThread;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+    // incremented each time threadBuffers changes
+    uint64_t threadBuffersVersion{0};
 
     std::vector<std::string>* getCurrentQueue() {
       return &queues[ioThreadCounter & 0x1];
     }
+    std::vector<std::pair<size_t, DeferredLogMessage>>*
+    getCurrentDeferredQueue() {
+      return &deferredQueues[ioThreadCounter & 0x1];
+    }
   };
 
   /**
@@ -155,6 +263,18 @@ class AsyncLogWriter : public LogWriter {
 
   void invokeDiscardCallback(size_t numDiscarded);
 
+  static void formatDeferredMessages(
+      std::vector<std::string>& queue,
+      std::vector<std::pair<size_t, DeferredLogMessage>>& deferredQueue);
+
+  // Returns false if the message must go through the shared queue instead.
+  bool writeToThreadBuffer(StringPiece buffer, uint32_t flags);
+  ThreadBuffer& getThreadBuffer(size_t bufferSize);
+  void notifyIoThreadIfWaiting();
+
+  static bool hasBufferedData(const Data& data);
+  static size_t collectBufferDiscards(Data& data);
+
   void ioThread();
 
   bool preFork();
@@ -185,6 +305,12 @@ class AsyncLogWriter : public LogWriter {
    */
   folly::Synchronized<Data, std::mutex>::LockedPtr lockedData_;
 
+  std::atomic<size_t> perThreadBufferSize_{0};
+  std::atomic<OverflowPolicy> overflowPolicy_{OverflowPolicy::DISCARD};
+  // set by the I/O thread while it waits for messages with an empty queue
+  std::atomic<bool> ioThreadWaiting_{false};
+  folly::ThreadLocal<ThreadBufferHolder> threadBuffers_;
+
   static FOLLY_CONSTINIT std::atomic<DiscardCallback> discardCallback_;
 };
 
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/DeferredLogFormat.h>
+
+#include <folly/ExceptionString.h>
+#include <folly/lang/Exception.h>
+#include <folly/logging/LogFormatter.h>
+#include <folly/logging/LogMessage.h>
+
+namespace folly {
+
+std::string DeferredLogFormat::vformat(
+    folly::StringPiece fmt, fmt::format_args args, bool& failed) noexcept {
+  // Same error handling as LogStreamProcessor::vformatLogString()
+  return folly::catch_exception<const std::exception&>(
+      [&] {
+        return fmt::vformat(fmt::string_view(fmt.data(), fmt.size()), args);
+      },
+      [&](const std::exception& ex) {
+        failed = true;
+        std::string result;
+        result.append("error formatting log message: ");
+        result.append(exceptionStr(ex).c_str());
+        result.append("; format string: \"");
+        result.append(fmt.data(), fmt.size());
+        result.append("\", arguments: ");
+        return result;
+      });
+}
+
+DeferredLogMessage::DeferredLogMessage(
+    const LogMessage& message,
+    LogFormatter* formatter,
+    const LogCategory* handlerCategory)
+    : category_{message.getCategory()},
+      level_{message.getLevel()},
+      threadID_{message.getThreadID()},
+      timestamp_{message.getTimestamp()},
+      filename_{message.getFileName()},
+      lineNumber_{message.getLineNumber()},
+      functionName_{message.getFunctionName()},
+      contextString_{message.getContextString()},
+      format_{*message.getDeferredFormat()},
+      formatter_{formatter},
+      handlerCategory_{handlerCategory} {}
+
+std::string DeferredLogMessage::format() const {
+  LogMessage message{
+      category_,
+      level_,
+      timestamp_,
+      threadID_,
+      filename_,
+      lineNumber_,
+      functionName_,
+      contextString_,
+      format_.format()};
+  return formatter_->formatMessage(message, handlerCategory_);
+}
+
+} // namespace folly
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fmt/core.h>
+#include <folly/Range.h>
+#include <folly/Traits.h>
+#include <folly/logging/LogLevel.h>
+#include <folly/logging/ObjectToString.h>
+
+namespace folly {
+
+class LogCategory;
+class LogFormatter;
+class LogMessage;
+
+namespace detail {
+
+// Arguments are copied by value and formatted later, possibly in another
+// thread, so they must not refer to memory owned by the caller.
+template <typename T>
+constexpr bool isDeferredLogArg() {
+  if constexpr (std::is_pointer_v<T>) {
+    return std::is_void_v<std::remove_pointer_t<T>>;
+  } else {
+    return std::is_trivially_copyable_v<T> &&
+        !is_instantiation_of_v<Range, T> &&
+        !is_instantiation_of_v<std::basic_string_view, T>;
+  }
+}
+
+template <typename... Args>
+struct DeferredLogArgs;
+
+template <>
+struct DeferredLogArgs<> {};
+
+template <typename T, typename... Rest>
+struct DeferredLogArgs<T, Rest...> {
+  T first;
+  DeferredLogArgs<Rest...> rest;
+};
+
+template <size_t I, typename T, typename... Rest>
+const auto& getDeferredLogArg(const DeferredLogArgs<T, Rest...>& args) {
+  if constexpr (I == 0) {
+    return args.first;
+  } else {
+    return getDeferredLogArg<I - 1>(args.rest);
+  }
+}
+
+} // namespace detail
+
+/**
+ * DeferredLogFormat captures a format string and a copy of its arguments, so
+ * that the fmt::format() call can happen later, typically in the I/O thread
+ * of an AsyncLogWriter.  This is what XLOGF_DEFERRED() logs.
+ *
+ * It is a fixed size, trivially copyable record: capturing the arguments
+ * neither allocates nor formats anything.  In exchange:
+ * - the format string must have static storage duration (a string literal),
+ *   since only a pointer to it is kept;
+ * - the arguments must be trivially copyable values that do not refer to
+ *   other memory (enforced for pointers, folly::Range and std::string_view,
+ *   but not for user defined types), and fit in kMaxArgsSize bytes.
+ */
+class DeferredLogFormat {
+ public:
+  static constexpr size_t kMaxArgsSize = 64;
+
+  template <typename... Args>
+  explicit DeferredLogFormat(folly::StringPiece fmt, const Args&... args)
+      : fmt_{fmt}, format_{&formatArgs<std::decay_t<Args>...>} {
+    using Stored = detail::DeferredLogArgs<std::decay_t<Args>...>;
+    static_assert(
+        (detail::isDeferredLogArg<std::decay_t<Args>>() && ...),
+        "XLOGF_DEFERRED() arguments must be trivially copyable values that "
+        "do not point to other memory; use XLOGF() for strings");
+    static_assert(
+        sizeof(Stored) <= kMaxArgsSize,
+        "too many arguments for XLOGF_DEFERRED()");
+    static_assert(alignof(Stored) <= alignof(std::max_align_t));
+    new (args_) Stored{args...};
+  }
+
+  /**
+   * Format the message.
+   *
+   * Like XLOGF(), this does not throw if the format string and arguments do
+   * not match: the result describes the error instead.
+   */
+  std::string format() const { return format_(fmt_, args_); }
+
+  folly::StringPiece getFormatString() const { return fmt_; }
+
+ private:
+  using FormatFn = std::string (*)(folly::StringPiece, const void*);
+
+  template <typename... Args>
+  static std::string formatArgs(folly::StringPiece fmt, const void* storage) {
+    const auto& args = *std::launder(
+        static_cast<const detail::DeferredLogArgs<Args...>*>(storage));
+    return formatArgsImpl(fmt, args, std::index_sequence_for<Args...>{});
+  }
+
+  template <typename Stored, size_t... Indices>
+  static std::string formatArgsImpl(
+      folly::StringPiece fmt,
+      const Stored& args,
+      std::index_sequence<Indices...>) {
+    bool failed = false;
+    std::string result = vformat(
+        fmt,
+        fmt::make_format_args(detail::getDeferredLogArg<Indices>(args)...),
+        failed);
+    if (failed) {
+      folly::logging::appendToString(
+          result, detail::getDeferredLogArg<Indices>(args)...);
+    }
+    return result;
+  }
+
+  static std::string vformat(
+      folly::StringPiece fmt, fmt::format_args args, bool& failed) noexcept;
+
+  folly::StringPiece fmt_;
+  FormatFn format_;
+  alignas(std::max_align_t) unsigned char args_[kMaxArgsSize];
+};
+
+static_assert(std::is_trivially_copyable_v<DeferredLogFormat>);
+
+/**
+ * A message logged with XLOGF_DEFERRED() on its way to a LogWriter, together
+ * with everything needed to format it later: the metadata of the original
+ * LogMessage, and the LogFormatter of the handler that received it.
+ *
+ * LogWriter::writeDeferredMessage() receives these.  The formatter is not
+ * owned: StandardLogHandler flushes its writer before releasing it.
+ */
+class DeferredLogMessage {
+ public:
+  DeferredLogMessage(
+      const LogMessage& message,
+      LogFormatter* formatter,
+      const LogCategory* handlerCategory);
+
+  /**
+   * Format the message and pass it through the formatter, producing the same
+   * text that the handler would have written if it did not defer formatting.
+   */
+  std::string format() const;
+
+ private:
+  const LogCategory* category_;
+  LogLevel level_;
+  uint64_t threadID_;
+  std::chrono::system_clock::time_point timestamp_;
+  folly::StringPiece filename_;
+  unsigned int lineNumber_;
+  folly::StringPiece functionName_;
+  std::string contextString_;
+  DeferredLogFormat format_;
+  LogFormatter* formatter_;
+  const LogCategory* handlerCategory_;
+};
+
+} // namespace folly
@@ -18,8 +18,11 @@
 
 #include <folly/Conv.h>
 #include <folly/File.h>
+#include <folly/io/async/IoUringBackend.h>
 #include <folly/logging/AsyncFileWriter.h>
 #include <folly/logging/ImmediateFileWriter.h>
+#include <folly/logging/IoUringFileWriter.h>
+#include <folly/logging/LoggerDB.h>
 
 using std::make_shared;
 using std::string;
@@ -28,7 +31,16 @@ namespace folly {
 
 bool FileWriterFactory::processOption(StringPiece name, StringPiece value) {
   if (name == "async") {
+    if (value == "uring") {
+      async_ = true;
+      uring_ = true;
+      return true;
+    }
     async_ = to<bool>(value);
+    uring_ = false;
+    return true;
+  } else if (name == "direct_io") {
+    directIO_ = to<bool>(value);
     return true;
   } else if (name == "max_buffer_size") {
     auto size = to<size_t>(value);
@@ -37,18 +49,46 @@ bool FileWriterFactory::processOption(StringPiece name, StringPiece value) {
     }
     maxBufferSize_ = size;
     return true;
+  } else if (name == "thread_buffer_size") {
+    threadBufferSize_ = to<size_t>(value);
+    return true;
+  } else if (name == "thread_buffer_overflow") {
+    if (value == "discard") {
+      overflowPolicy_ = AsyncLogWriter::OverflowPolicy::DISCARD;
+    } else if (value == "block") {
+      overflowPolicy_ = AsyncLogWriter::OverflowPolicy::BLOCK;
+    } else {
+      throw std::invalid_argument(
+          to<string>("must be \"discard\" or \"block\""));
+    }
+    return true;
   } else {
     return false;
   }
 }
 
 std::shared_ptr<LogWriter> FileWriterFactory::createWriter(File file) {
-  // Determine whether we should use ImmediateFileWriter or AsyncFileWriter
+  // Determine whether we should use ImmediateFileWriter, AsyncFileWriter or
+  // IoUringFileWriter
+  if (directIO_ && !uring_) {
+    throw std::invalid_argument(to<string>(
+        "the \"direct_io\" option is only valid with \"async=uring\""));
+  }
   if (async_) {
-    auto asyncWriter = make_shared<AsyncFileWriter>(std::move(file));
+    std::shared_ptr<AsyncLogWriter> asyncWriter;
+    if (uring_) {
+      asyncWriter = createIoUringWriter(file);
+    }
+    if (!asyncWriter) {
+      asyncWriter = make_shared<AsyncFileWriter>(std::move(file));
+    }
     if (maxBufferSize_.has_value()) {
       asyncWriter->setMaxBufferSize(maxBufferSize_.value());
     }
+    if (threadBufferSize_.has_value()) {
+      asyncWriter->setPerThreadBufferSize(
+          threadBufferSize_.value(), overflowPolicy_);
+    }
     return asyncWriter;
   } else {
     if (maxBufferSize_.has_value()) {
@@ -56,8 +96,35 @@ std::shared_ptr<LogWriter> FileWriterFactory::createWriter(File file) {
           "the \"max_buffer_size\" option is only valid for async file "
           "handlers"));
     }
+    if (threadBufferSize_.has_value()) {
+      throw std::invalid_argument(to<string>(
+          "the \"thread_buffer_size\" option is only valid for async file "
+          "handlers"));
+    }
     return make_shared<ImmediateFileWriter>(std::move(file));
   }
 }
 
+std::shared_ptr<AsyncLogWriter> FileWriterFactory::createIoUringWriter(
+    File& file) {
+#if FOLLY_HAS_LIBURING
+  if (IoUringBackend::isAvailable()) {
+    IoUringFileWriter::Options options;
+    options.directIO = directIO_;
+    return make_shared<IoUringFileWriter>(std::move(file), options);
+  }
+#endif
+  // Keep logging, without the io_uring specific options.
+  if (directIO_) {
+    throw std::invalid_argument(to<string>(
+        "the \"direct_io\" option requires io_uring, which is not "
+        "available"));
+  }
+  LoggerDB::internalWarning(
+      __FILE__,
+      __LINE__,
+      "io_uring is not available, using AsyncFileWriter for the log file");
+  return nullptr;
+}
+
 } // namespace folly
@@ -20,6 +20,7 @@
 
 #include <folly/Optional.h>
 #include <folly/Range.h>
+#include <folly/logging/AsyncLogWriter.h>
 
 namespace folly {
 
@@ -27,8 +28,8 @@ class File;
 class LogWriter;
 
 /**
- * A helper class for creating an AsyncFileWriter or ImmediateFileWriter based
- * on log handler options settings.
+ * A helper class for creating an AsyncFileWriter, IoUringFileWriter or
+ * ImmediateFileWriter based on log handler options settings.
  *
  * This is used by StreamHandlerFactory and FileHandlerFactory.
  */
@@ -38,8 +39,16 @@ class FileWriterFactory {
   std::shared_ptr<LogWriter> createWriter(File file);
 
  private:
+  // Returns null, after a warning, if io_uring is not available.
+  std::shared_ptr<AsyncLogWriter> createIoUringWriter(File& file);
+
   bool async_{true};
+  bool uring_{false};
+  bool directIO_{false};
   Optional<size_t> maxBufferSize_;
+  Optional<size_t> threadBufferSize_;
+  AsyncLogWriter::OverflowPolicy overflowPolicy_{
+      AsyncLogWriter::OverflowPolicy::DISCARD};
 };
 
 } // namespace folly
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/IoUringFileWriter.h>
+
+#if FOLLY_HAS_LIBURING
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <folly/Conv.h>
+#include <folly/Exception.h>
+#include <folly/ExceptionString.h>
+#include <folly/FileUtil.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/IoUringBackend.h>
+#include <folly/logging/LoggerDB.h>
+#include <folly/portability/Unistd.h>
+
+namespace folly {
+
+namespace {
+
+size_t alignUp(size_t n) {
+  constexpr auto kAlign = IoUringFileWriter::kDirectIOAlignment;
+  return (n + kAlign - 1) & ~(kAlign - 1);
+}
+
+std::unique_ptr<EventBase> makeEventBase(size_t capacity) {
+  return std::make_unique<EventBase>(
+      EventBase::Options().setBackendFactory([capacity] {
+        IoUringBackend::Options options;
+        options.setCapacity(capacity).setMaxSubmit(capacity);
+        return std::make_unique<IoUringBackend>(options);
+      }));
+}
+
+std::string getNumDiscardedMsg(size_t numDiscarded) {
+  // Same message as AsyncFileWriter
+  return folly::to<std::string>(
+      numDiscarded,
+      " log messages discarded: logging faster than we can write\n");
+}
+
+} // namespace
+
+IoUringFileWriter::IoUringFileWriter(StringPiece path)
+    : IoUringFileWriter{path, Options{}} {}
+
+IoUringFileWriter::IoUringFileWriter(StringPiece path, Options options)
+    : IoUringFileWriter{
+          File{path.str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC},
+          options} {}
+
+IoUringFileWriter::IoUringFileWriter(folly::File&& file)
+    : IoUringFileWriter{std::move(file), Options{}} {}
+
+IoUringFileWriter::IoUringFileWriter(folly::File&& file, Options options)
+    : file_{std::move(file)}, options_{options} {
+  try {
+    evb_ = makeEventBase(options_.capacity);
+    backend_ = dynamic_cast<IoUringBackend*>(evb_->getBackend());
+    ownerPid_ = getpid();
+    if (options_.directIO) {
+      initDirectIO();
+    }
+  } catch (...) {
+    // The I/O thread was started by the AsyncLogWriter constructor.
+    cleanup();
+    throw;
+  }
+}
+
+IoUringFileWriter::~IoUringFileWriter() {
+  cleanup();
+}
+
+bool IoUringFileWriter::ttyOutput() const {
+  return isatty(file_.fd());
+}
+
+void IoUringFileWriter::initDirectIO() {
+  struct stat st;
+  checkUnixError(::fstat(file_.fd(), &st), "fstat() failed on log file");
+  auto size = size_t(st.st_size);
+  blockOffset_ = off_t(size & ~(kDirectIOAlignment - 1));
+  directBufferLength_ = size - size_t(blockOffset_);
+  directBufferCapacity_ = 16 * kDirectIOAlignment;
+  directBuffer_.reset(static_cast<char*>(
+      aligned_malloc(directBufferCapacity_, kDirectIOAlignment)));
+  if (!directBuffer_) {
+    throw_exception<std::bad_alloc>();
+  }
+
+  // The last partial block is rewritten by the first write.
+  if (directBufferLength_ > 0) {
+    auto ret = preadFull(
+        file_.fd(), directBuffer_.get(), directBufferLength_, blockOffset_);
+    checkUnixError(ret, "pread() failed on log file");
+    if (size_t(ret) != directBufferLength_) {
+      throwSystemErrorExplicit(EIO, "short read from log file");
+    }
+  }
+
+  // Positioned writes would be ignored with O_APPEND.
+  int flags = ::fcntl(file_.fd(), F_GETFL);
+  checkUnixError(flags, "fcntl(F_GETFL) failed on log file");
+  checkUnixError(
+      ::fcntl(file_.fd(), F_SETFL, (flags | O_DIRECT) & ~O_APPEND),
+      "cannot enable O_DIRECT on log file");
+}
+
+IoUringBackend& IoUringFileWriter::getBackend() {
+  if (FOLLY_UNLIKELY(getpid() != ownerPid_)) {
+    // The ring is shared with the parent process after fork(), and must not be
+    // used, nor torn down, by the child.
+    (void)evb_.release();
+    evb_ = makeEventBase(options_.capacity);
+    backend_ = dynamic_cast<IoUringBackend*>(evb_->getBackend());
+    ownerPid_ = getpid();
+  }
+  return *backend_;
+}
+
+void IoUringFileWriter::writeIovecs(
+    std::vector<struct iovec>& iov, off_t offset) {
+  auto& backend = getBackend();
+  const size_t maxOps = backend.params().sq_entries;
+  size_t first = 0;
+  while (first < iov.size()) {
+    IoUringBackend::LinkedFileOps ops;
+    std::vector<size_t> opLengths;
+    auto opOffset = offset;
+    for (size_t idx = first; idx < iov.size() && ops.size() < maxOps;) {
+      auto num = std::min<size_t>(iov.size() - idx, IOV_MAX);
+      size_t len = 0;
+      for (size_t i = idx; i < idx + num; ++i) {
+        len += iov[i].iov_len;
+      }
+      ops.writev(
+          file_.fd(),
+          Range<const struct iovec*>(iov.data() + idx, num),
+          opOffset);
+      opLengths.push_back(len);
+      if (opOffset >= 0) {
+        opOffset += off_t(len);
+      }
+      idx += num;
+    }
+
+    std::vector<int> results;
+    bool done = false;
+    backend.queueLinked(std::move(ops), [&](std::vector<int> res) {
+      results = std::move(res);
+      done = true;
+    });
+    while (!done) {
+      evb_->loopOnce();
+    }
+
+    // A short write cancels the rest of the chain: resubmit from where it
+    // stopped.
+    for (size_t op = 0; op < results.size(); ++op) {
+      auto res = results[op];
+      if (res < 0) {
+        throwSystemErrorExplicit(-res, "io_uring writev() failed");
+      }
+      if (res == 0) {
+        throwSystemErrorExplicit(EIO, "io_uring writev() made no progress");
+      }
+      if (offset >= 0) {
+        offset += res;
+      }
+      for (size_t n = size_t(res); n > 0;) {
+        auto& v = iov[first];
+        if (n >= v.iov_len) {
+          n -= v.iov_len;
+          ++first;
+        } else {
+          v.iov_base = static_cast<char*>(v.iov_base) + n;
+          v.iov_len -= n;
+          n = 0;
+        }
+      }
+      if (size_t(res) < opLengths[op]) {
+        break;
+      }
+    }
+  }
+}
+
+void IoUringFileWriter::writeDirect(const std::vector<struct iovec>& iov) {
+  size_t length = directBufferLength_;
+  for (const auto& v : iov) {
+    length += v.iov_len;
+  }
+  if (alignUp(length) > directBufferCapacity_) {
+    auto capacity = std::max(alignUp(length), 2 * directBufferCapacity_);
+    AlignedBuffer buffer{
+        static_cast<char*>(aligned_malloc(capacity, kDirectIOAlignment))};
+    if (!buffer) {
+      throw_exception<std::bad_alloc>();
+    }
+    std::memcpy(buffer.get(), directBuffer_.get(), directBufferLength_);
+    directBuffer_ = std::move(buffer);
+    directBufferCapacity_ = capacity;
+  }
+  for (const auto& v : iov) {
+    std::memcpy(
+        directBuffer_.get() + directBufferLength_, v.iov_base, v.iov_len);
+    directBufferLength_ += v.iov_len;
+  }
+
+  auto writeLength = alignUp(directBufferLength_);
+  std::memset(
+      directBuffer_.get() + directBufferLength_,
+      0,
+      writeLength - directBufferLength_);
+  std::vector<struct iovec> block{{directBuffer_.get(), writeLength}};
+  writeIovecs(block, blockOffset_);
+  checkUnixError(
+      ::ftruncate(file_.fd(), blockOffset_ + off_t(directBufferLength_)),
+      "ftruncate() failed on log file");
+
+  // Keep the last partial block, to complete it with the next batch.
+  auto complete = directBufferLength_ & ~(kDirectIOAlignment - 1);
+  std::memmove(
+      directBuffer_.get(),
+      directBuffer_.get() + complete,
+      directBufferLength_ - complete);
+  blockOffset_ += off_t(complete);
+  directBufferLength_ -= complete;
+}
+
+void IoUringFileWriter::writeToFile(
+    std::vector<struct iovec>& iov, size_t numDiscarded) {
+  std::string discardedMsg;
+  if (numDiscarded > 0) {
+    discardedMsg = getNumDiscardedMsg(numDiscarded);
+    iov.push_back({discardedMsg.data(), discardedMsg.size()});
+  }
+  if (iov.empty()) {
+    return;
+  }
+  if (options_.directIO) {
+    writeDirect(iov);
+  } else {
+    writeIovecs(iov, -1);
+  }
+}
+
+void IoUringFileWriter::performIO(
+    const std::vector<std::string>& ioQueue, size_t numDiscarded) {
+  try {
+    std::vector<struct iovec> iov;
+    iov.reserve(ioQueue.size() + 1);
+    for (const auto& str : ioQueue) {
+      if (!str.empty()) {
+        iov.push_back({const_cast<char*>(str.data()), str.size()});
+      }
+    }
+    writeToFile(iov, numDiscarded);
+  } catch (const std::exception& ex) {
+    LoggerDB::internalWarning(
+        __FILE__,
+        __LINE__,
+        "error writing to log file ",
+        file_.fd(),
+        " in IoUringFileWriter: ",
+        folly::exceptionStr(ex));
+  }
+}
+
+void IoUringFileWriter::performBufferIO(
+    const std::vector<struct iovec>& data, size_t numDiscarded) {
+  try {
+    auto iov = data;
+    writeToFile(iov, numDiscarded);
+  } catch (const std::exception& ex) {
+    LoggerDB::internalWarning(
+        __FILE__,
+        __LINE__,
+        "error writing to log file ",
+        file_.fd(),
+        " in IoUringFileWriter: ",
+        folly::exceptionStr(ex));
+  }
+}
+
+} // namespace folly
+
+#endif // FOLLY_HAS_LIBURING
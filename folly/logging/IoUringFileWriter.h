@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include <folly/File.h>
+#include <folly/Memory.h>
+#include <folly/Range.h>
+#include <folly/io/async/Liburing.h>
+#include <folly/logging/AsyncLogWriter.h>
+
+#if FOLLY_HAS_LIBURING
+
+namespace folly {
+
+class EventBase;
+class IoUringBackend;
+
+/**
+ * An AsyncLogWriter that writes log messages to a file through io_uring.
+ *
+ * Each time the I/O thread wakes up, all the pending messages are submitted
+ * as a single chain of linked writev operations, so a batch costs one
+ * io_uring_enter() call regardless of its size.
+ *
+ * With Options::directIO the file is switched to O_DIRECT and messages are
+ * copied into a block aligned buffer.  The last, partial block is rewritten by
+ * the next batch and the file is truncated to the length of the data after
+ * each write, so readers never see the padding.  This bypasses the page cache,
+ * which keeps a heavy log writer from evicting the rest of the process' data.
+ *
+ * The constructors throw IoUringBackend::NotAvailable if the kernel does not
+ * support io_uring.
+ */
+class IoUringFileWriter : public AsyncLogWriter {
+ public:
+  struct Options {
+    // Number of submission queue entries, which bounds the number of writes
+    // in flight.
+    size_t capacity{64};
+    // Write with O_DIRECT through block aligned buffers.  Throws
+    // std::system_error if the file system does not support O_DIRECT.
+    bool directIO{false};
+  };
+
+  /**
+   * The alignment and size granularity of O_DIRECT writes.
+   */
+  static constexpr size_t kDirectIOAlignment = 4096;
+
+  /**
+   * Construct an IoUringFileWriter that appends to the file at the specified
+   * path.
+   */
+  explicit IoUringFileWriter(folly::StringPiece path);
+  IoUringFileWriter(folly::StringPiece path, Options options);
+
+  /**
+   * Construct an IoUringFileWriter that writes to the specified File object.
+   */
+  explicit IoUringFileWriter(folly::File&& file);
+  IoUringFileWriter(folly::File&& file, Options options);
+
+  ~IoUringFileWriter() override;
+
+  /**
+   * Returns true if the output stream is a tty.
+   */
+  bool ttyOutput() const override;
+
+  /**
+   * Get the output file.
+   */
+  const folly::File& getFile() const { return file_; }
+
+  bool isDirectIO() const { return options_.directIO; }
+
+ private:
+  using AlignedBuffer =
+      std::unique_ptr<char, static_function_deleter<void, &aligned_free>>;
+
+  void performIO(
+      const std::vector<std::string>& ioQueue, size_t numDiscarded) override;
+  void performBufferIO(
+      const std::vector<struct iovec>& data, size_t numDiscarded) override;
+
+  void writeToFile(std::vector<struct iovec>& iov, size_t numDiscarded);
+  void writeDirect(const std::vector<struct iovec>& iov);
+  // Writes all of iov at offset, or at the current file position if offset
+  // is -1, updating iov as it goes.
+  void writeIovecs(std::vector<struct iovec>& iov, off_t offset);
+
+  void initDirectIO();
+  IoUringBackend& getBackend();
+
+  folly::File file_;
+  Options options_;
+
+  // Only used from the I/O thread, or from cleanup() once it has stopped.
+  std::unique_ptr<EventBase> evb_;
+  IoUringBackend* backend_{nullptr};
+  pid_t ownerPid_{0};
+
+  // O_DIRECT state: directBuffer_ holds the data of the file from blockOffset_
+  // on, which has not been written as complete blocks yet.
+  AlignedBuffer directBuffer_;
+  size_t directBufferCapacity_{0};
+  size_t directBufferLength_{0};
+  off_t blockOffset_{0};
+};
+
+} // namespace folly
+
+#endif // FOLLY_HAS_LIBURING
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/JsonLogFormatter.h>
+
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+
+#include <fmt/format.h>
+#include <folly/logging/LogCategory.h>
+#include <folly/logging/LogLevel.h>
+#include <folly/logging/LogMessage.h>
+#include <folly/portability/Time.h>
+
+namespace folly {
+namespace {
+
+void appendJsonString(std::string& out, StringPiece str) {
+  static constexpr StringPiece hexdigits{"0123456789abcdef"};
+  out.push_back('"');
+  const char* begin = str.begin();
+  for (const char* p = str.begin(); p != str.end(); ++p) {
+    auto c = static_cast<unsigned char>(*p);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(begin, p);
+    begin = p + 1;
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        out.append("\\u00");
+        out.push_back(hexdigits[c >> 4]);
+        out.push_back(hexdigits[c & 0xf]);
+        break;
+    }
+  }
+  out.append(begin, str.end());
+  out.push_back('"');
+}
+
+void appendKey(std::string& out, StringPiece key) {
+  appendJsonString(out, key);
+  out.push_back(':');
+}
+
+void appendField(std::string& out, const LogField& field) {
+  appendKey(out, field.getKey());
+  switch (field.getType()) {
+    case LogField::Type::INT64:
+      fmt::format_to(std::back_inserter(out), "{}", field.getInt64());
+      return;
+    case LogField::Type::UINT64:
+      fmt::format_to(std::back_inserter(out), "{}", field.getUInt64());
+      return;
+    case LogField::Type::DOUBLE:
+      if (std::isfinite(field.getDouble())) {
+        fmt::format_to(std::back_inserter(out), "{}", field.getDouble());
+      } else {
+        out.append("null");
+      }
+      return;
+    case LogField::Type::BOOL:
+      out.append(field.getBool() ? "true" : "false");
+      return;
+    case LogField::Type::STRING:
+      appendJsonString(out, field.getString());
+      return;
+  }
+  out.append("null");
+}
+
+} // namespace
+
+std::string JsonLogFormatter::formatMessage(
+    const LogMessage& message, const LogCategory* /* handlerCategory */) {
+  auto timeSinceEpoch = message.getTimestamp().time_since_epoch();
+  auto epochSeconds =
+      std::chrono::duration_cast<std::chrono::seconds>(timeSinceEpoch);
+  std::chrono::microseconds usecs =
+      std::chrono::duration_cast<std::chrono::microseconds>(timeSinceEpoch) -
+      epochSeconds;
+  time_t unixTimestamp = epochSeconds.count();
+  struct tm utime;
+  if (!gmtime_r(&unixTimestamp, &utime)) {
+    memset(&utime, 0, sizeof(utime));
+  }
+
+  const auto& text = message.getRawMessage();
+  const auto& context = message.getContextString();
+  auto fields = message.getFields();
+
+  // The fixed portion of the output takes up roughly 120 bytes; guess a bit
+  // more for the category and file names and for the fields.
+  std::string buffer;
+  buffer.reserve(
+      160 + text.size() + context.size() + message.getFileName().size() +
+      (fields.empty() ? 0 : 16 + 32 * fields.size()));
+
+  fmt::format_to(
+      std::back_inserter(buffer),
+      "{{\"time\":\"{:04d}-{:02d}-{:02d}T{:02d}:{:02d}:{:02d}.{:06d}Z\",",
+      utime.tm_year + 1900,
+      utime.tm_mon + 1,
+      utime.tm_mday,
+      utime.tm_hour,
+      utime.tm_min,
+      utime.tm_sec,
+      usecs.count());
+  appendKey(buffer, "level");
+  appendJsonString(buffer, logLevelToString(message.getLevel()));
+  buffer.push_back(',');
+  appendKey(buffer, "category");
+  appendJsonString(
+      buffer,
+      message.getCategory() ? StringPiece{message.getCategory()->getName()}
+                            : StringPiece{});
+  buffer.push_back(',');
+  appendKey(buffer, "file");
+  appendJsonString(buffer, message.getFileName());
+  fmt::format_to(
+      std::back_inserter(buffer), ",\"line\":{},", message.getLineNumber());
+  appendKey(buffer, "function");
+  appendJsonString(buffer, message.getFunctionName());
+  fmt::format_to(
+      std::back_inserter(buffer), ",\"thread\":{},", message.getThreadID());
+  if (!context.empty()) {
+    appendKey(buffer, "context");
+    appendJsonString(buffer, context);
+    buffer.push_back(',');
+  }
+  appendKey(buffer, "message");
+  appendJsonString(buffer, text);
+  if (!fields.empty()) {
+    buffer.append(",\"fields\":{");
+    for (size_t n = 0; n < fields.size(); ++n) {
+      if (n != 0) {
+        buffer.push_back(',');
+      }
+      appendField(buffer, fields[n]);
+    }
+    buffer.push_back('}');
+  }
+  buffer.append("}\n");
+  return buffer;
+}
+} // namespace folly
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <folly/logging/LogFormatter.h>
+
+namespace folly {
+
+/**
+ * A LogFormatter implementation that emits each message as a single line
+ * JSON object, for consumption by log processing pipelines.
+ *
+ * For example:
+ *
+ *   {"time":"2017-04-17T13:45:56.123456Z","level":"INFO","category":"foo",
+ *    "file":"src/foo.cpp","line":1234,"function":"doStuff","thread":29533,
+ *    "message":"request done","fields":{"user":"bob","ms":12}}
+ *
+ * (The output does not contain newlines; the example is wrapped here.)
+ *
+ * The timestamp is always in UTC.  "context" is included if the message has
+ * a context string, and "fields" if it has structured fields attached with
+ * logFields().  Field values keep their type: integers, floating point
+ * numbers and bools are emitted as JSON numbers and booleans.  Non-finite
+ * floating point values are emitted as null.
+ *
+ * The output is built directly in the returned string, without formatting
+ * the fields into an intermediate representation.
+ */
+class JsonLogFormatter : public LogFormatter {
+ public:
+  std::string formatMessage(
+      const LogMessage& message, const LogCategory* handlerCategory) override;
+};
+} // namespace folly
@@ -231,8 +231,10 @@ void LogCategory::updateEffectiveLevel(LogLevel newEffectiveLevel) {
     return;
   }
 
-  // Update all of the values in xlogLevels_
-  for (auto* levelPtr : xlogLevels_) {
+  // Update all of the values in xlogLevels_.  registerXlogLevel() reads
+  // effectiveLevel_ while holding the lock, so each value either gets
+  // registered after our update above or is updated here.
+  for (auto* levelPtr : *xlogLevels_.rlock()) {
     levelPtr->store(newEffectiveLevel, std::memory_order_release);
   }
 
@@ -256,7 +258,11 @@ void LogCategory::parentLevelUpdated(LogLevel parentEffectiveLevel) {
   updateEffectiveLevel(newEffectiveLevel);
 }
 
-void LogCategory::registerXlogLevel(std::atomic<LogLevel>* levelPtr) {
-  xlogLevels_.push_back(levelPtr);
+LogLevel LogCategory::registerXlogLevel(std::atomic<LogLevel>* levelPtr) {
+  auto xlogLevels = xlogLevels_.wlock();
+  auto level = getEffectiveLevel();
+  levelPtr->store(level, std::memory_order_release);
+  xlogLevels->push_back(levelPtr);
+  return level;
 }
 } // namespace folly
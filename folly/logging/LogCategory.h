@@ -237,13 +237,14 @@ class LogCategory {
    * Register a std::atomic<LogLevel> value used by XLOG*() macros to check the
    * effective level for this category.
    *
-   * The LogCategory will keep this value updated whenever its effective log
-   * level changes.
+   * This initializes the value to the current effective level, and the
+   * LogCategory will keep it updated whenever its effective log level
+   * changes.  Returns the effective level the value was initialized with.
    *
-   * This function should only be invoked by LoggerDB, and the LoggerDB lock
-   * must be held when calling it.
+   * This function should only be invoked by LoggerDB.  It does not require
+   * the LoggerDB lock.
    */
-  void registerXlogLevel(std::atomic<LogLevel>* levelPtr);
+  LogLevel registerXlogLevel(std::atomic<LogLevel>* levelPtr);
 
  private:
   enum : uint32_t { FLAG_INHERIT = 0x80000000 };
@@ -331,8 +332,9 @@ class LogCategory {
    * The XLOG*() statements will check these values.  We ensure they are kept
    * up-to-date each time the effective log level changes for this category.
    *
-   * This list may only be accessed while holding the main LoggerDB lock.
+   * This list has its own lock so that XLOG*() statements can be registered
+   * without acquiring the main LoggerDB lock.
    */
-  std::vector<std::atomic<LogLevel>*> xlogLevels_;
+  folly::Synchronized<std::vector<std::atomic<LogLevel>*>> xlogLevels_;
 };
 } // namespace folly
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <folly/Range.h>
+
+namespace folly {
+
+/**
+ * LogField is a typed key/value pair attached to a log message, so that
+ * structured LogFormatters (such as JsonLogFormatter) can emit it without
+ * having to parse it back out of the message text.
+ *
+ * Values are stored inline.  Neither the key nor a string value is copied:
+ * they must remain valid until the log statement completes.  This is always
+ * the case for string literals and for temporaries created in the log
+ * statement itself.  LogMessage copies them when the LogMessage is copied.
+ */
+class LogField {
+ public:
+  enum class Type : uint8_t {
+    INT64,
+    UINT64,
+    DOUBLE,
+    BOOL,
+    STRING,
+  };
+
+  template <
+      typename T,
+      std::enable_if_t<
+          std::is_integral_v<T> && std::is_signed_v<T> &&
+              !std::is_same_v<T, char>,
+          int> = 0>
+  LogField(StringPiece key, T value) : key_{key}, type_{Type::INT64} {
+    value_.i = value;
+  }
+
+  template <
+      typename T,
+      std::enable_if_t<
+          std::is_integral_v<T> && std::is_unsigned_v<T> &&
+              !std::is_same_v<T, bool>,
+          int> = 0>
+  LogField(StringPiece key, T value) : key_{key}, type_{Type::UINT64} {
+    value_.u = value;
+  }
+
+  template <
+      typename T,
+      std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+  LogField(StringPiece key, T value) : key_{key}, type_{Type::DOUBLE} {
+    value_.d = static_cast<double>(value);
+  }
+
+  template <typename T, std::enable_if_t<std::is_same_v<T, bool>, int> = 0>
+  LogField(StringPiece key, T value) : key_{key}, type_{Type::BOOL} {
+    value_.b = value;
+  }
+
+  LogField(StringPiece key, StringPiece value)
+      : key_{key}, type_{Type::STRING} {
+    value_.s.data = value.data();
+    value_.s.size = value.size();
+  }
+
+  StringPiece getKey() const { return key_; }
+  Type getType() const { return type_; }
+
+  int64_t getInt64() const { return value_.i; }
+  uint64_t getUInt64() const { return value_.u; }
+  double getDouble() const { return value_.d; }
+  bool getBool() const { return value_.b; }
+  StringPiece getString() const {
+    return StringPiece{value_.s.data, value_.s.size};
+  }
+
+  /**
+   * Return a copy of this field that refers to the specified key and string
+   * value instead.  This is used to re-point a field at owned storage.
+   */
+  LogField withStorage(StringPiece key, StringPiece stringValue) const {
+    LogField result{*this};
+    result.key_ = key;
+    if (type_ == Type::STRING) {
+      result.value_.s.data = stringValue.data();
+      result.value_.s.size = stringValue.size();
+    }
+    return result;
+  }
+
+ private:
+  StringPiece key_;
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    bool b;
+    struct {
+      const char* data;
+      size_t size;
+    } s;
+  } value_;
+  Type type_;
+};
+
+/**
+ * A fixed size set of LogFields, stored inline.  Create one with
+ * logFields() and pass it as an argument to XLOG() or FB_LOG():
+ *
+ *   XLOG(INFO, "request done", folly::logFields("user", id, "ms", ms));
+ *
+ * The fields are not part of the message text; they are attached to the
+ * LogMessage and can be retrieved with LogMessage::getFields().
+ */
+template <std::size_t N>
+class LogFields {
+ public:
+  explicit LogFields(const std::array<LogField, N>& fields)
+      : fields_{fields} {}
+
+  Range<const LogField*> getFields() const {
+    return Range<const LogField*>{fields_.data(), fields_.size()};
+  }
+
+ private:
+  std::array<LogField, N> fields_;
+};
+
+// LogFields do not contribute to the message text.
+template <class String, std::size_t N>
+void toAppend(const LogFields<N>&, String*) {}
+
+template <std::size_t N>
+constexpr size_t estimateSpaceNeeded(const LogFields<N>&) {
+  return 0;
+}
+
+namespace detail {
+
+template <typename Tuple, std::size_t... I>
+std::array<LogField, sizeof...(I)> makeLogFields(
+    const Tuple& args, std::index_sequence<I...>) {
+  return {{LogField(std::get<2 * I>(args), std::get<2 * I + 1>(args))...}};
+}
+
+template <typename T>
+void collectLogFields(Range<const LogField*>&, const T&) {}
+
+template <std::size_t N>
+void collectLogFields(Range<const LogField*>& result, const LogFields<N>& f) {
+  result = f.getFields();
+}
+
+/**
+ * Return the fields of the last LogFields object among args, or an empty
+ * range if there is none.
+ */
+template <typename... Args>
+Range<const LogField*> findLogFields(const Args&... args) {
+  Range<const LogField*> result;
+  (collectLogFields(result, args), ...);
+  return result;
+}
+
+} // namespace detail
+
+/**
+ * Build a LogFields object from alternating keys and values.
+ *
+ * Keys must be strings.  Values may be integers, floating point numbers,
+ * bools or strings.
+ */
+template <typename... Args>
+LogFields<sizeof...(Args) / 2> logFields(const Args&... keysAndValues) {
+  static_assert(
+      sizeof...(Args) % 2 == 0,
+      "logFields() arguments must be alternating keys and values");
+  return LogFields<sizeof...(Args) / 2>{detail::makeLogFields(
+      std::forward_as_tuple(keysAndValues...),
+      std::make_index_sequence<sizeof...(Args) / 2>{})};
+}
+
+} // namespace folly
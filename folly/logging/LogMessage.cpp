@@ -16,6 +16,7 @@
 
 #include <folly/logging/LogMessage.h>
 
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/LogCategory.h>
 #include <folly/logging/LoggerDB.h>
 #include <folly/system/ThreadId.h>
@@ -36,7 +37,8 @@ LogMessage::LogMessage(
     StringPiece filename,
     unsigned int lineNumber,
     StringPiece functionName,
-    std::string&& msg)
+    std::string&& msg,
+    Range<const LogField*> fields)
     : category_{category},
       level_{level},
       threadID_{getOSThreadID()},
@@ -45,7 +47,8 @@ LogMessage::LogMessage(
       lineNumber_{lineNumber},
       functionName_{functionName},
       contextString_{getContextStringFromCategory(category_)},
-      rawMessage_{std::move(msg)} {
+      rawMessage_{std::move(msg)},
+      fields_{fields} {
   sanitizeMessage();
 }
 
@@ -69,6 +72,101 @@ LogMessage::LogMessage(
   sanitizeMessage();
 }
 
+LogMessage::LogMessage(
+    const LogCategory* category,
+    LogLevel level,
+    StringPiece filename,
+    unsigned int lineNumber,
+    StringPiece functionName,
+    const DeferredLogFormat& deferred)
+    : category_{category},
+      level_{level},
+      threadID_{getOSThreadID()},
+      timestamp_{system_clock::now()},
+      filename_{filename},
+      lineNumber_{lineNumber},
+      functionName_{functionName},
+      contextString_{getContextStringFromCategory(category_)},
+      deferred_{&deferred},
+      needsFormat_{true} {}
+
+LogMessage::LogMessage(
+    const LogCategory* category,
+    LogLevel level,
+    system_clock::time_point timestamp,
+    uint64_t threadID,
+    StringPiece filename,
+    unsigned int lineNumber,
+    StringPiece functionName,
+    std::string contextString,
+    std::string&& msg,
+    Range<const LogField*> fields)
+    : category_{category},
+      level_{level},
+      threadID_{threadID},
+      timestamp_{timestamp},
+      filename_{filename},
+      lineNumber_{lineNumber},
+      functionName_{functionName},
+      contextString_{std::move(contextString)},
+      rawMessage_{std::move(msg)},
+      fields_{fields} {
+  sanitizeMessage();
+}
+
+LogMessage::LogMessage(const LogMessage& other)
+    : category_{other.category_},
+      level_{other.level_},
+      threadID_{other.threadID_},
+      timestamp_{other.timestamp_},
+      filename_{other.filename_},
+      lineNumber_{other.lineNumber_},
+      functionName_{other.functionName_},
+      numNewlines_{other.getNumNewlines()},
+      contextString_{other.contextString_},
+      rawMessage_{other.rawMessage_},
+      message_{other.message_} {
+  copyFields(other.fields_);
+}
+
+void LogMessage::copyFields(Range<const LogField*> fields) {
+  if (fields.empty()) {
+    return;
+  }
+
+  // Reserve all of the space up front, so that the StringPieces pointing
+  // into ownedFieldData_ stay valid as it is filled in.
+  size_t dataSize = 0;
+  for (const auto& field : fields) {
+    dataSize += field.getKey().size();
+    if (field.getType() == LogField::Type::STRING) {
+      dataSize += field.getString().size();
+    }
+  }
+  ownedFieldData_.reserve(dataSize);
+  auto store = [this](StringPiece str) {
+    auto* data = ownedFieldData_.data() + ownedFieldData_.size();
+    ownedFieldData_.append(str.data(), str.size());
+    return StringPiece{data, str.size()};
+  };
+
+  ownedFields_.reserve(fields.size());
+  for (const auto& field : fields) {
+    auto key = store(field.getKey());
+    auto value = field.getType() == LogField::Type::STRING
+        ? store(field.getString())
+        : StringPiece{};
+    ownedFields_.push_back(field.withStorage(key, value));
+  }
+  fields_ = Range<const LogField*>{ownedFields_.data(), ownedFields_.size()};
+}
+
+void LogMessage::formatDeferred() const {
+  rawMessage_ = deferred_->format();
+  sanitizeMessage();
+  needsFormat_ = false;
+}
+
 StringPiece LogMessage::getFileBaseName() const {
 #ifdef _WIN32
   // Windows allows either backwards or forwards slash as path separator
@@ -91,7 +189,7 @@ StringPiece LogMessage::getFileBaseName() const {
   return filename_.subpiece(idx + 1);
 }
 
-void LogMessage::sanitizeMessage() {
+void LogMessage::sanitizeMessage() const {
   // Compute how long the sanitized string will be.
   size_t sanitizedLength = 0;
   size_t numNewlines = 0;
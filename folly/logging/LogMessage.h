@@ -20,12 +20,16 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
+#include <folly/Likely.h>
 #include <folly/Range.h>
+#include <folly/logging/LogField.h>
 #include <folly/logging/LogLevel.h>
 
 namespace folly {
 
+class DeferredLogFormat;
 class LogCategory;
 
 /**
@@ -36,6 +40,10 @@ class LogCategory;
  * only live in the thread that logged the message, and are not modified once
  * created.  (That said, LogHandler implementations may copy and store
  * LogMessage objects for later use if desired.)
+ *
+ * The text of messages logged with XLOGF_DEFERRED() is formatted the first
+ * time it is accessed, so such messages must not be accessed concurrently
+ * from multiple threads until they have been copied.
  */
 class LogMessage {
  public:
@@ -45,7 +53,8 @@ class LogMessage {
       folly::StringPiece filename,
       unsigned int lineNumber,
       folly::StringPiece functionName,
-      std::string&& msg);
+      std::string&& msg,
+      Range<const LogField*> fields = {});
   LogMessage(
       const LogCategory* category,
       LogLevel level,
@@ -70,6 +79,40 @@ class LogMessage {
       folly::StringPiece functionName,
       std::string&& msg);
 
+  /**
+   * Construct a LogMessage whose text is only formatted from deferred when it
+   * is first needed, so that handlers may defer formatting to another thread.
+   *
+   * deferred is not copied and must outlive this LogMessage.  Copying the
+   * LogMessage formats the text, and the copy no longer refers to deferred.
+   */
+  LogMessage(
+      const LogCategory* category,
+      LogLevel level,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      const DeferredLogFormat& deferred);
+
+  /**
+   * Construct a LogMessage with all of its metadata explicitly specified.
+   * This is used to recreate a message in a thread other than the one that
+   * logged it.
+   */
+  LogMessage(
+      const LogCategory* category,
+      LogLevel level,
+      std::chrono::system_clock::time_point timestamp,
+      uint64_t threadID,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      std::string contextString,
+      std::string&& msg,
+      Range<const LogField*> fields = {});
+
+  LogMessage(const LogMessage& other);
+
   const LogCategory* getCategory() const { return category_; }
 
   LogLevel getLevel() const { return level_; }
@@ -88,6 +131,7 @@ class LogMessage {
   uint64_t getThreadID() const { return threadID_; }
 
   const std::string& getMessage() const {
+    formatIfDeferred();
     // If no characters needed to be sanitized, message_ will be empty.
     if (message_.empty()) {
       return rawMessage_;
@@ -95,16 +139,44 @@ class LogMessage {
     return message_;
   }
 
-  const std::string& getRawMessage() const { return rawMessage_; }
+  const std::string& getRawMessage() const {
+    formatIfDeferred();
+    return rawMessage_;
+  }
 
-  bool containsNewlines() const { return numNewlines_ > 0; }
+  bool containsNewlines() const { return getNumNewlines() > 0; }
 
-  size_t getNumNewlines() const { return numNewlines_; }
+  size_t getNumNewlines() const {
+    formatIfDeferred();
+    return numNewlines_;
+  }
 
   const std::string& getContextString() const { return contextString_; }
 
+  /**
+   * Returns the structured fields attached to this message.
+   *
+   * The fields of a message created by a log statement refer to the values
+   * passed to the statement, and are only valid while it executes.  A copy
+   * of the LogMessage owns copies of its fields.
+   */
+  Range<const LogField*> getFields() const { return fields_; }
+
+  /**
+   * Returns the deferred format this message was logged with, or null if it
+   * was logged with an already formatted string.
+   */
+  const DeferredLogFormat* getDeferredFormat() const { return deferred_; }
+
  private:
-  void sanitizeMessage();
+  void formatIfDeferred() const {
+    if (FOLLY_UNLIKELY(needsFormat_)) {
+      formatDeferred();
+    }
+  }
+  void formatDeferred() const;
+  void sanitizeMessage() const;
+  void copyFields(Range<const LogField*> fields);
 
   const LogCategory* const category_{nullptr};
   LogLevel const level_{static_cast<LogLevel>(0)};
@@ -133,7 +205,7 @@ class LogMessage {
    * messages to easily detect if a message contains multiple lines or not and
    * size their buffers appropriately.
    */
-  size_t numNewlines_{0};
+  mutable size_t numNewlines_{0};
 
   /**
    * contextString_ contains user defined context information.
@@ -149,7 +221,7 @@ class LogMessage {
    * This may contain arbitrary binary data, including unprintable characters
    * and nul bytes.
    */
-  std::string const rawMessage_;
+  mutable std::string rawMessage_;
 
   /**
    * message_ contains a sanitized version of the log message.
@@ -159,6 +231,24 @@ class LogMessage {
    * are responsible for deciding how they want to handle log messages with
    * internal newlines.
    */
-  std::string message_;
+  mutable std::string message_;
+
+  /**
+   * deferred_ is the format of a message logged with XLOGF_DEFERRED(), and
+   * needsFormat_ is set until rawMessage_ has been formatted from it.
+   */
+  const DeferredLogFormat* const deferred_{nullptr};
+  mutable bool needsFormat_{false};
+
+  /**
+   * fields_ contains the structured fields attached to the message.
+   *
+   * It refers to the caller's fields for a message created by a log
+   * statement, and to ownedFields_ (whose keys and string values are stored
+   * in ownedFieldData_) for a copied message.
+   */
+  Range<const LogField*> fields_;
+  std::vector<LogField> ownedFields_;
+  std::string ownedFieldData_;
 };
 } // namespace folly
@@ -111,6 +111,29 @@ LogStreamProcessor::LogStreamProcessor(
       message_{std::move(msg)},
       stream_{this} {}
 
+LogStreamProcessor::LogStreamProcessor(
+    XlogCategoryInfo<true>* categoryInfo,
+    LogLevel level,
+    folly::StringPiece categoryName,
+    bool isCategoryNameOverridden,
+    folly::StringPiece filename,
+    unsigned int lineNumber,
+    folly::StringPiece functionName,
+    DeferredFormatType,
+    const DeferredLogFormat& deferred) noexcept
+    : LogStreamProcessor(
+          categoryInfo,
+          level,
+          categoryName,
+          isCategoryNameOverridden,
+          filename,
+          lineNumber,
+          functionName,
+          INTERNAL,
+          std::string()) {
+  deferred_ = &deferred;
+}
+
 namespace {
 LogCategory* getXlogCategory(XlogFileScopeInfo* fileScopeInfo) {
   // By the time a LogStreamProcessor is created, the XlogFileScopeInfo object
@@ -165,6 +188,25 @@ LogStreamProcessor::LogStreamProcessor(
           INTERNAL,
           std::string()) {}
 
+LogStreamProcessor::LogStreamProcessor(
+    XlogFileScopeInfo* fileScopeInfo,
+    LogLevel level,
+    folly::StringPiece filename,
+    unsigned int lineNumber,
+    folly::StringPiece functionName,
+    DeferredFormatType,
+    const DeferredLogFormat& deferred) noexcept
+    : LogStreamProcessor(
+          fileScopeInfo,
+          level,
+          filename,
+          lineNumber,
+          functionName,
+          INTERNAL,
+          std::string()) {
+  deferred_ = &deferred;
+}
+
 /*
  * We intentionally define the LogStreamProcessor destructor in
  * LogStreamProcessor.cpp instead of LogStreamProcessor.h to avoid having it
@@ -187,13 +229,29 @@ void LogStreamProcessor::logNow() noexcept {
   //
   // Any other error here is unexpected and we also want to fail hard
   // in that situation too.
+  if (deferred_) {
+    if (stream_.empty()) {
+      category_->admitMessage(LogMessage{
+          category_,
+          level_,
+          filename_,
+          lineNumber_,
+          functionName_,
+          *deferred_});
+      return;
+    }
+    // Text was streamed after XLOGF_DEFERRED(), so the message needs to be
+    // formatted now to append it.
+    message_ = deferred_->format();
+  }
   category_->admitMessage(LogMessage{
       category_,
       level_,
       filename_,
       lineNumber_,
       functionName_,
-      extractMessageString(stream_)});
+      extractMessageString(stream_),
+      fields_});
 }
 
 std::string LogStreamProcessor::extractMessageString(
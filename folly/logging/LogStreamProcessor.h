@@ -24,7 +24,9 @@
 #include <folly/ExceptionString.h>
 #include <folly/Portability.h>
 #include <folly/lang/Exception.h>
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/LogCategory.h>
+#include <folly/logging/LogField.h>
 #include <folly/logging/LogMessage.h>
 #include <folly/logging/LogStream.h>
 #include <folly/logging/ObjectToString.h>
@@ -51,6 +53,7 @@ class LogStreamProcessor {
  public:
   enum AppendType { APPEND };
   enum FormatType { FORMAT };
+  enum DeferredFormatType { DEFERRED_FORMAT };
 
   /**
    * LogStreamProcessor constructor for use with a LOG() macro with no extra
@@ -73,6 +76,9 @@ class LogStreamProcessor {
    * LogStreamProcessor constructor for use with a LOG() macro with arguments
    * to be concatenated with folly::to<std::string>()
    *
+   * An argument created with logFields() is not added to the message text,
+   * but attached to the LogMessage as structured fields.
+   *
    * Note that the filename argument is not copied.  The caller should ensure
    * that it points to storage that will remain valid for the lifetime of the
    * LogStreamProcessor.  (This is always the case for the __FILE__
@@ -94,7 +100,9 @@ class LogStreamProcessor {
             lineNumber,
             functionName,
             INTERNAL,
-            createLogString(std::forward<Args>(args)...)) {}
+            createLogString(std::forward<Args>(args)...)) {
+    fields_ = detail::findLogFields(args...);
+  }
 
   /**
    * LogStreamProcessor constructor for use with a LOG() macro with arguments
@@ -162,7 +170,9 @@ class LogStreamProcessor {
             lineNumber,
             functionName,
             INTERNAL,
-            createLogString(std::forward<Args>(args)...)) {}
+            createLogString(std::forward<Args>(args)...)) {
+    fields_ = detail::findLogFields(args...);
+  }
   template <typename... Args>
   LogStreamProcessor(
       XlogCategoryInfo<true>* categoryInfo,
@@ -185,6 +195,21 @@ class LogStreamProcessor {
             functionName,
             INTERNAL,
             formatLogString(fmt, std::forward<Args>(args)...)) {}
+  /*
+   * LogStreamProcessor constructor for XLOGF_DEFERRED().  The message is only
+   * formatted from deferred when a LogHandler needs its text, which may be in
+   * another thread.  deferred must outlive the LogStreamProcessor.
+   */
+  LogStreamProcessor(
+      XlogCategoryInfo<true>* categoryInfo,
+      LogLevel level,
+      folly::StringPiece categoryName,
+      bool isCategoryNameOverridden,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      DeferredFormatType,
+      const DeferredLogFormat& deferred) noexcept;
 
   /*
    * Versions of the above constructors to use in XLOG() macros that appear in
@@ -232,7 +257,9 @@ class LogStreamProcessor {
             lineNumber,
             functionName,
             INTERNAL,
-            createLogString(std::forward<Args>(args)...)) {}
+            createLogString(std::forward<Args>(args)...)) {
+    fields_ = detail::findLogFields(args...);
+  }
   template <typename... Args>
   LogStreamProcessor(
       XlogFileScopeInfo* fileScopeInfo,
@@ -253,6 +280,32 @@ class LogStreamProcessor {
             functionName,
             INTERNAL,
             formatLogString(fmt, std::forward<Args>(args)...)) {}
+  LogStreamProcessor(
+      XlogFileScopeInfo* fileScopeInfo,
+      LogLevel level,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      DeferredFormatType,
+      const DeferredLogFormat& deferred) noexcept;
+  LogStreamProcessor(
+      XlogFileScopeInfo* fileScopeInfo,
+      LogLevel level,
+      folly::StringPiece /* categoryName */,
+      bool /* isCategoryNameOverridden */,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      DeferredFormatType,
+      const DeferredLogFormat& deferred) noexcept
+      : LogStreamProcessor(
+            fileScopeInfo,
+            level,
+            filename,
+            lineNumber,
+            functionName,
+            DEFERRED_FORMAT,
+            deferred) {}
 
   ~LogStreamProcessor() noexcept;
 
@@ -381,6 +434,10 @@ class LogStreamProcessor {
   unsigned int lineNumber_;
   folly::StringPiece functionName_;
   std::string message_;
+  const DeferredLogFormat* deferred_{nullptr};
+  // Fields passed with logFields(); they outlive the LogStreamProcessor,
+  // since they are temporaries of the same log statement.
+  Range<const LogField*> fields_;
   LogStream stream_;
 };
 
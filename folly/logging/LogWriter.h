@@ -20,6 +20,8 @@
 
 namespace folly {
 
+class DeferredLogMessage;
+
 /**
  * LogWriter defines the interface for processing a serialized log message.
  */
@@ -76,6 +78,19 @@ class LogWriter {
     flush();
   }
 
+  /**
+   * Write a message logged with XLOGF_DEFERRED(), formatting it later by
+   * calling message.format(), possibly in another thread.
+   *
+   * Returns false if this LogWriter does not support deferred formatting, in
+   * which case the caller formats the message and calls writeMessage().
+   * The default implementation always returns false.
+   */
+  virtual bool writeDeferredMessage(
+      DeferredLogMessage&& /* message */, uint32_t /* flags */ = 0) {
+    return false;
+  }
+
   /**
    * Block until all messages that have already been sent to this LogWriter
    * have been written.
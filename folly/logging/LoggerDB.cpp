@@ -69,33 +69,125 @@ FOLLY_ATTR_WEAK void initializeLoggerDB(LoggerDB& db) {
   db.updateConfig(config);
 }
 
+/**
+ * An insert-only hash table of LogCategory pointers.
+ *
+ * Readers never lock: each bucket is a singly-linked list whose head is
+ * published with a release store after the new node is fully initialized.
+ * Only one writer may insert at a time (the loggersByName_ lock holder).
+ */
+class LoggerDB::CategoryIndex {
+ public:
+  static constexpr size_t kInitialBuckets = 64;
+
+  CategoryIndex(size_t numBuckets, std::unique_ptr<CategoryIndex> previous)
+      : buckets_(new std::atomic<Node*>[numBuckets]),
+        mask_(numBuckets - 1),
+        previous_(std::move(previous)) {
+    DCHECK_EQ(numBuckets & mask_, 0);
+    for (size_t n = 0; n <= mask_; ++n) {
+      buckets_[n].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  LogCategory* FOLLY_NULLABLE find(StringPiece name) const {
+    auto hash = LogName::hash(name);
+    auto* node = buckets_[hash & mask_].load(std::memory_order_acquire);
+    for (; node != nullptr; node = node->next) {
+      if (node->hash == hash &&
+          LogName::cmp(node->category->getName(), name) == 0) {
+        return node->category;
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns false if the index is too full, in which case a larger copy
+  // should be built with grow().
+  bool insert(LogCategory* category) {
+    if (nodes_.size() > mask_) {
+      return false;
+    }
+    auto hash = LogName::hash(category->getName());
+    auto& bucket = buckets_[hash & mask_];
+    nodes_.push_back(std::make_unique<Node>(
+        Node{category, hash, bucket.load(std::memory_order_relaxed)}));
+    bucket.store(nodes_.back().get(), std::memory_order_release);
+    return true;
+  }
+
+  static std::unique_ptr<CategoryIndex> grow(
+      std::unique_ptr<CategoryIndex> index) {
+    auto numBuckets = index ? 2 * (index->mask_ + 1) : kInitialBuckets;
+    std::vector<LogCategory*> categories;
+    if (index) {
+      for (const auto& node : index->nodes_) {
+        categories.push_back(node->category);
+      }
+    }
+    auto grown = std::make_unique<CategoryIndex>(numBuckets, std::move(index));
+    for (auto* category : categories) {
+      grown->insert(category);
+    }
+    return grown;
+  }
+
+ private:
+  struct Node {
+    LogCategory* category;
+    size_t hash;
+    Node* next;
+  };
+
+  std::unique_ptr<std::atomic<Node*>[]> buckets_;
+  const size_t mask_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+  // Readers may still be using older copies, so they live as long as we do.
+  std::unique_ptr<CategoryIndex> previous_;
+};
+
 LoggerDB::LoggerDB() {
   // Create the root log category and set its log level
   auto rootUptr = std::make_unique<LogCategory>(this);
   LogCategory* root = rootUptr.get();
-  auto ret =
-      loggersByName_.wlock()->emplace(root->getName(), std::move(rootUptr));
+  auto loggersByName = loggersByName_.wlock();
+  auto ret = loggersByName->emplace(root->getName(), std::move(rootUptr));
   DCHECK(ret.second);
+  indexCategoryLocked(root);
 
   root->setLevelLocked(kDefaultLogLevel, false);
 }
 
 LoggerDB::LoggerDB(TestConstructorArg) : LoggerDB() {}
 
-LoggerDB::~LoggerDB() = default;
+LoggerDB::~LoggerDB() {
+  delete categoryIndex_.load(std::memory_order_relaxed);
+}
 
 LogCategory* LoggerDB::getCategory(StringPiece name) {
+  if (auto* category = findCategory(name)) {
+    return category;
+  }
   return getOrCreateCategoryLocked(*loggersByName_.wlock(), name);
 }
 
 LogCategory* FOLLY_NULLABLE LoggerDB::getCategoryOrNull(StringPiece name) {
-  auto loggersByName = loggersByName_.rlock();
+  return findCategory(name);
+}
 
-  auto it = loggersByName->find(name);
-  if (it == loggersByName->end()) {
-    return nullptr;
+LogCategory* FOLLY_NULLABLE LoggerDB::findCategory(StringPiece name) const {
+  return categoryIndex_.load(std::memory_order_acquire)->find(name);
+}
+
+void LoggerDB::indexCategoryLocked(LogCategory* category) {
+  auto* index = categoryIndex_.load(std::memory_order_relaxed);
+  if (index && index->insert(category)) {
+    return;
   }
-  return it->second.get();
+  auto grown = CategoryIndex::grow(std::unique_ptr<CategoryIndex>(index));
+  bool inserted = grown->insert(category);
+  DCHECK(inserted);
+  categoryIndex_.store(grown.release(), std::memory_order_release);
 }
 
 void LoggerDB::setLevel(folly::StringPiece name, LogLevel level, bool inherit) {
@@ -367,18 +459,32 @@ void LoggerDB::updateConfig(const LogConfig& config) {
     }
   }
 
+  // Build the new handler lists before acquiring the loggersByName_ lock, so
+  // that lookups of categories which do not exist yet are blocked for as
+  // short a time as possible.
+  std::vector<std::vector<std::shared_ptr<LogHandler>>> categoryHandlers;
+  categoryHandlers.reserve(config.getCategoryConfigs().size());
+  for (const auto& entry : config.getCategoryConfigs()) {
+    if (entry.second.handlers.has_value()) {
+      categoryHandlers.push_back(buildCategoryHandlerList(
+          handlers, entry.first, entry.second.handlers.value()));
+    } else {
+      categoryHandlers.emplace_back();
+    }
+  }
+
   // Update log levels and handlers mentioned in the config update
   auto loggersByName = loggersByName_.wlock();
+  auto catHandlers = categoryHandlers.begin();
   for (const auto& entry : config.getCategoryConfigs()) {
     LogCategory* category =
         getOrCreateCategoryLocked(*loggersByName, entry.first);
 
     // Update the log handlers
     if (entry.second.handlers.has_value()) {
-      auto catHandlers = buildCategoryHandlerList(
-          handlers, entry.first, entry.second.handlers.value());
-      category->replaceHandlers(std::move(catHandlers));
+      category->replaceHandlers(std::move(*catHandlers));
     }
+    ++catHandlers;
 
     // Update the level settings
     category->setLevelLocked(
@@ -471,6 +577,7 @@ LogCategory* LoggerDB::createCategoryLocked(
   LogCategory* logger = uptr.get();
   auto ret = loggersByName.emplace(logger->getName(), std::move(uptr));
   DCHECK(ret.second);
+  indexCategoryLocked(logger);
   return logger;
 }
 
@@ -554,42 +661,39 @@ LogLevel LoggerDB::xlogInit(
     StringPiece categoryName,
     std::atomic<LogLevel>* xlogCategoryLevel,
     LogCategory** xlogCategory) {
-  // Hold the lock for the duration of the operation
+  auto* category = getCategory(categoryName);
+
   // xlogInit() may be called from multiple threads simultaneously.
   // Only one needs to perform the initialization.
-  auto loggersByName = loggersByName_.wlock();
+  std::lock_guard<std::mutex> guard(xlogInitMutex_);
   if (xlogCategory != nullptr && *xlogCategory != nullptr) {
     // The xlogCategory was already initialized before we acquired the lock
     return (*xlogCategory)->getEffectiveLevel();
   }
 
-  auto* category = getOrCreateCategoryLocked(*loggersByName, categoryName);
   if (xlogCategory) {
     // Set *xlogCategory before we update xlogCategoryLevel below.
     // This is important, since the XLOG() macros check xlogCategoryLevel to
     // tell if *xlogCategory has been initialized yet.
     *xlogCategory = category;
   }
-  auto level = category->getEffectiveLevel();
-  xlogCategoryLevel->store(level, std::memory_order_release);
-  category->registerXlogLevel(xlogCategoryLevel);
-  return level;
+  return category->registerXlogLevel(xlogCategoryLevel);
 }
 
 LogCategory* LoggerDB::xlogInitCategory(
     StringPiece categoryName,
     LogCategory** xlogCategory,
     std::atomic<bool>* isInitialized) {
-  // Hold the lock for the duration of the operation
+  auto* category = getCategory(categoryName);
+
   // xlogInitCategory() may be called from multiple threads simultaneously.
   // Only one needs to perform the initialization.
-  auto loggersByName = loggersByName_.wlock();
+  std::lock_guard<std::mutex> guard(xlogInitMutex_);
   if (isInitialized->load(std::memory_order_acquire)) {
     // The xlogCategory was already initialized before we acquired the lock
     return *xlogCategory;
   }
 
-  auto* category = getOrCreateCategoryLocked(*loggersByName, categoryName);
   *xlogCategory = category;
   isInitialized->store(true, std::memory_order_release);
   return category;
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -55,7 +57,7 @@ class LoggerDB {
    * Get the LogCategory for the specified name.
    *
    * This creates the LogCategory for the specified name if it does not exist
-   * already.
+   * already.  Looking up an existing category does not acquire any locks.
    */
   LogCategory* getCategory(folly::StringPiece name);
 
@@ -63,7 +65,8 @@ class LoggerDB {
    * Get the LogCategory for the specified name, if it already exists.
    *
    * This returns nullptr if no LogCategory has been created yet for the
-   * specified name.
+   * specified name.  Looking up an existing category does not acquire any
+   * locks.
    */
   LogCategory* FOLLY_NULLABLE getCategoryOrNull(folly::StringPiece name);
 
@@ -273,7 +276,11 @@ class LoggerDB {
   LoggerDB(LoggerDB const&) = delete;
   LoggerDB& operator=(LoggerDB const&) = delete;
 
+  class CategoryIndex;
+
   LoggerDB();
+  LogCategory* FOLLY_NULLABLE findCategory(folly::StringPiece name) const;
+  void indexCategoryLocked(LogCategory* category);
   LogCategory* getOrCreateCategoryLocked(
       LoggerNameMap& loggersByName, folly::StringPiece name);
   LogCategory* createCategoryLocked(
@@ -313,6 +320,29 @@ class LoggerDB {
    */
   folly::Synchronized<LoggerNameMap> loggersByName_;
 
+  /**
+   * A lock-free index of all LogCategory objects in loggersByName_.
+   *
+   * Categories are never removed, so the index only grows.  New categories
+   * are inserted while holding the loggersByName_ lock.  When the index gets
+   * too full, a larger copy is published and the old one is kept alive, owned
+   * by the new one, until the LoggerDB is destroyed.  Since each copy doubles
+   * in size this costs at most as much memory as the latest copy.
+   *
+   * This allows getCategory() and XLOG() initialization to find existing
+   * categories without contending with config updates for the
+   * loggersByName_ lock.
+   */
+  std::atomic<CategoryIndex*> categoryIndex_{nullptr};
+
+  /**
+   * Serializes initialization of XLOG() call sites.
+   *
+   * This is separate from loggersByName_ so that initializing a call site
+   * is never blocked behind a config update.
+   */
+  std::mutex xlogInitMutex_;
+
   /**
    * The LogHandlers and LogHandlerFactories.
    *
@@ -17,8 +17,10 @@
 #pragma once
 
 #include <atomic>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <type_traits>
 
 #include <folly/Chrono.h>
@@ -73,5 +75,93 @@ class IntervalRateLimiter {
   std::atomic<clock::rep> timestamp_{kInitialTimestamp};
 };
 
+
+/**
+ * A token bucket rate limiter that allows up to @param ratePerSecond events
+ * per second on average, with bursts of up to @param burstSize events.
+ *
+ * Unlike IntervalRateLimiter, rejecting an event does not perform any atomic
+ * read-modify-write operation: it only loads the bucket state and checks the
+ * coarse clock.  This keeps the cost of a log storm low once the bucket has
+ * been drained.  A compare-and-swap is only needed when an event is admitted.
+ *
+ * The limiter also counts the events it rejected, so that callers can report
+ * how many messages were suppressed.  This count is approximate when check()
+ * is called concurrently from multiple threads, since it is maintained
+ * without atomic increments.
+ */
+class TokenBucketRateLimiter {
+ public:
+  using clock = chrono::coarse_steady_clock;
+
+  constexpr TokenBucketRateLimiter(double ratePerSecond, uint64_t burstSize)
+      : interval_{computeInterval(ratePerSecond)},
+        burstInterval_{computeBurstInterval(interval_, burstSize)} {}
+
+  bool check() {
+    auto zeroTime = zeroTime_.load(std::memory_order_relaxed);
+    auto const now = clock::now().time_since_epoch().count();
+    while (true) {
+      // zeroTime_ is the time at which the bucket was (or will be) empty.
+      // The bucket never holds more than burstInterval_ worth of tokens.
+      auto const next = std::max(zeroTime, now - burstInterval_) + interval_;
+      if (next > now) {
+        auto const suppressed = suppressed_.load(std::memory_order_relaxed);
+        suppressed_.store(suppressed + 1, std::memory_order_relaxed);
+        return false;
+      }
+      if (zeroTime_.compare_exchange_weak(
+              zeroTime, next, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Return the number of events rejected by check() since the last call to
+   * takeSuppressed(), and reset the count to zero.
+   */
+  uint64_t takeSuppressed() {
+    if (suppressed_.load(std::memory_order_relaxed) == 0) {
+      return 0;
+    }
+    return suppressed_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  using rep = clock::rep;
+
+  static_assert(
+      std::is_signed<rep>::value,
+      "Need signed time point to represent initial time");
+
+  static constexpr rep kMaxSpan = std::numeric_limits<rep>::max() / 4;
+
+  static constexpr rep computeInterval(double ratePerSecond) {
+    constexpr double ticksPerSecond =
+        double(clock::period::den) / double(clock::period::num);
+    if (!(ratePerSecond > ticksPerSecond / double(kMaxSpan))) {
+      return kMaxSpan;
+    }
+    return std::max(rep(1), rep(ticksPerSecond / ratePerSecond));
+  }
+
+  static constexpr rep computeBurstInterval(rep interval, uint64_t burstSize) {
+    auto const burst = std::max(burstSize, uint64_t(1));
+    if (burst > uint64_t(kMaxSpan / interval)) {
+      return kMaxSpan;
+    }
+    return rep(burst) * interval;
+  }
+
+  const rep interval_;
+  const rep burstInterval_;
+
+  // Start with a full bucket: any time far enough in the past works, and
+  // this one cannot overflow when subtracting burstInterval_.
+  std::atomic<rep> zeroTime_{std::numeric_limits<rep>::min() / 2};
+  std::atomic<uint64_t> suppressed_{0};
+};
+
 } // namespace logging
 } // namespace folly
@@ -18,6 +18,7 @@
 
 #include <utility>
 
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/LogFormatter.h>
 #include <folly/logging/LogMessage.h>
 #include <folly/logging/LogWriter.h>
@@ -34,13 +35,28 @@ StandardLogHandler::StandardLogHandler(
       writer_{std::move(writer)},
       config_{std::move(config)} {}
 
-StandardLogHandler::~StandardLogHandler() = default;
+StandardLogHandler::~StandardLogHandler() {
+  // Deferred messages still queued in the writer refer to formatter_.
+  if (hasDeferredMessages_.load(std::memory_order_relaxed)) {
+    writer_->flush();
+  }
+}
 
 void StandardLogHandler::handleMessage(
     const LogMessage& message, const LogCategory* handlerCategory) {
   if (message.getLevel() < getLevel()) {
     return;
   }
+  if (message.getDeferredFormat() &&
+      message.getLevel() < syncLevel_.load(std::memory_order_relaxed)) {
+    if (writer_->writeDeferredMessage(
+            DeferredLogMessage{message, formatter_.get(), handlerCategory})) {
+      if (!hasDeferredMessages_.load(std::memory_order_relaxed)) {
+        hasDeferredMessages_.store(true, std::memory_order_relaxed);
+      }
+      return;
+    }
+  }
   std::string formattedMessage =
       formatter_->formatMessage(message, handlerCategory);
   if (message.getLevel() >= syncLevel_.load(std::memory_order_relaxed)) {
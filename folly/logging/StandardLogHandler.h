@@ -38,6 +38,10 @@ class LogWriter;
  *
  * StandardLogHandler also supports ignoring messages less than a specific
  * LogLevel.  By default it processes all messages.
+ *
+ * Messages logged with XLOGF_DEFERRED() below the sync level are given to the
+ * LogWriter unformatted if it supports it (see
+ * LogWriter::writeDeferredMessage()), to be formatted in the writer's thread.
  */
 class StandardLogHandler : public LogHandler {
  public:
@@ -87,6 +91,8 @@ class StandardLogHandler : public LogHandler {
  private:
   std::atomic<LogLevel> level_{LogLevel::NONE};
   std::atomic<LogLevel> syncLevel_{LogLevel::MAX_LEVEL};
+  // set once a message was given to writer_->writeDeferredMessage()
+  std::atomic<bool> hasDeferredMessages_{false};
 
   // The following variables are const, and cannot be modified after the
   // log handler is constructed.  This allows us to access them without
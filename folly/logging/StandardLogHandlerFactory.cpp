@@ -21,6 +21,7 @@
 #include <folly/String.h>
 #include <folly/logging/CustomLogFormatter.h>
 #include <folly/logging/GlogStyleFormatter.h>
+#include <folly/logging/JsonLogFormatter.h>
 #include <folly/logging/LogLevel.h>
 #include <folly/logging/LogWriter.h>
 #include <folly/logging/StandardLogHandler.h>
@@ -106,6 +107,19 @@ class CustomLogFormatterFactory
   std::string format_;
   Colored colored_{NEVER}; // Turn off coloring by default.
 };
+
+class JsonLogFormatterFactory
+    : public StandardLogHandlerFactory::FormatterFactory {
+ public:
+  bool processOption(StringPiece /* name */, StringPiece /* value */) override {
+    return false;
+  }
+
+  std::shared_ptr<LogFormatter> createFormatter(
+      const std::shared_ptr<LogWriter>& /* logWriter */) override {
+    return std::make_shared<JsonLogFormatter>();
+  }
+};
 } // namespace
 
 std::shared_ptr<StandardLogHandler> StandardLogHandlerFactory::createHandler(
@@ -118,6 +132,8 @@ std::shared_ptr<StandardLogHandler> StandardLogHandlerFactory::createHandler(
     formatterFactory = std::make_unique<GlogFormatterFactory>();
   } else if (!formatterType || *formatterType == "custom") {
     formatterFactory = std::make_unique<CustomLogFormatterFactory>();
+  } else if (*formatterType == "json") {
+    formatterFactory = std::make_unique<JsonLogFormatterFactory>();
   } else {
     throw std::invalid_argument(
         to<string>("unknown log formatter type \"", *formatterType, "\""));
@@ -32,8 +32,13 @@
 #include <folly/futures/Promise.h>
 #include <folly/init/Init.h>
 #include <folly/lang/SafeAssert.h>
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/Init.h>
+#include <folly/logging/LogFormatter.h>
+#include <folly/logging/LogHandlerConfig.h>
+#include <folly/logging/LogMessage.h>
 #include <folly/logging/LoggerDB.h>
+#include <folly/logging/StandardLogHandler.h>
 #include <folly/logging/xlog.h>
 #include <folly/portability/Config.h>
 #include <folly/portability/GFlags.h>
@@ -265,6 +270,154 @@ TEST(AsyncFileWriter, flush) {
   std::move(future).get(50ms);
 }
 
+TEST(AsyncFileWriter, perThreadBuffers) {
+  TemporaryFile tmpFile{"logging_test"};
+
+  constexpr size_t kNumThreads = 8;
+  constexpr size_t kNumMessages = 2000;
+  {
+    AsyncFileWriter writer{folly::File{tmpFile.fd(), false}};
+    writer.setPerThreadBufferSize(1024, AsyncLogWriter::OverflowPolicy::BLOCK);
+    EXPECT_EQ(1024, writer.getPerThreadBufferSize());
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&writer, t] {
+        for (size_t n = 0; n < kNumMessages; ++n) {
+          writer.writeMessage(folly::to<std::string>(t, " ", n, "\n"));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    // larger than a thread buffer, goes through the shared queue
+    writer.writeMessage(std::string(2000, 'x') + "\n");
+    writer.flush();
+    EXPECT_EQ(0, writer.getNumDiscarded());
+  }
+  tmpFile.close();
+
+  std::string data;
+  ASSERT_TRUE(folly::readFile(tmpFile.path().string().c_str(), data));
+  std::vector<StringPiece> lines;
+  folly::split('\n', StringPiece(data).subpiece(0, data.size() - 1), lines);
+  ASSERT_EQ(kNumThreads * kNumMessages + 1, lines.size());
+
+  std::vector<size_t> next(kNumThreads, 0);
+  for (auto line : lines) {
+    if (line.startsWith('x')) {
+      EXPECT_EQ(2000, line.size());
+      continue;
+    }
+    auto thread = folly::to<size_t>(line.split_step(' '));
+    ASSERT_LT(thread, kNumThreads);
+    EXPECT_EQ(next[thread]++, folly::to<size_t>(line));
+  }
+  for (auto n : next) {
+    EXPECT_EQ(kNumMessages, n);
+  }
+}
+
+TEST(AsyncFileWriter, perThreadBuffersDiscard) {
+  // Block the I/O thread by filling up a pipe nobody reads from yet
+  std::array<int, 2> fds;
+  auto rc = fileops::pipe(fds.data());
+  folly::checkUnixError(rc, "failed to create pipe");
+  File readPipe{fds[0], true};
+  File writePipe{fds[1], true};
+  auto paddingSize = fillUpPipe(writePipe.fd());
+
+  std::thread reader;
+  {
+    AsyncFileWriter writer{std::move(writePipe)};
+    writer.setPerThreadBufferSize(256);
+    for (size_t n = 0; n < 100; ++n) {
+      writer.writeMessage(folly::to<std::string>("message ", n, "\n"));
+    }
+    auto numDiscarded = writer.getNumDiscarded();
+    EXPECT_GT(numDiscarded, 0);
+
+    // Drain the pipe until the writer closes it
+    reader = std::thread([&] {
+      std::vector<char> buf(paddingSize);
+      while (fileops::read(readPipe.fd(), buf.data(), buf.size()) > 0) {
+      }
+    });
+    writer.flush();
+    EXPECT_EQ(numDiscarded, writer.getNumDiscarded());
+  }
+  reader.join();
+}
+
+namespace {
+// Records the thread that formats the messages.
+class ThreadRecordingFormatter : public LogFormatter {
+ public:
+  std::string formatMessage(
+      const LogMessage& message, const LogCategory* /* handlerCategory */)
+      override {
+    formatThreadID = getOSThreadID();
+    return folly::to<std::string>(
+        message.getThreadID(), " ", message.getMessage(), "\n");
+  }
+
+  std::atomic<uint64_t> formatThreadID{0};
+};
+} // namespace
+
+TEST(AsyncFileWriter, deferredMessages) {
+  TemporaryFile tmpFile{"logging_test"};
+  LoggerDB db{LoggerDB::TESTING};
+  auto* category = db.getCategory("test");
+  auto formatter = std::make_shared<ThreadRecordingFormatter>();
+  {
+    auto writer =
+        std::make_shared<AsyncFileWriter>(folly::File{tmpFile.fd(), false});
+    StandardLogHandler handler{LogHandlerConfig{"file"}, formatter, writer};
+
+    writer->writeMessage(std::string("first\n"));
+    for (int n = 0; n < 3; ++n) {
+      DeferredLogFormat format{"deferred {} {:.1f}", n, 0.5};
+      handler.handleMessage(
+          LogMessage{category, LogLevel::INFO, "file.cpp", 1, "fn", format},
+          category);
+    }
+    writer->writeMessage(std::string("last\n"));
+    writer->flush();
+    EXPECT_NE(0, formatter->formatThreadID.load());
+    EXPECT_NE(getOSThreadID(), formatter->formatThreadID.load());
+  }
+  tmpFile.close();
+
+  std::string data;
+  ASSERT_TRUE(folly::readFile(tmpFile.path().string().c_str(), data));
+  auto tid = folly::to<std::string>(getOSThreadID());
+  EXPECT_EQ(
+      folly::to<std::string>(
+          "first\n",
+          tid,
+          " deferred 0 0.5\n",
+          tid,
+          " deferred 1 0.5\n",
+          tid,
+          " deferred 2 0.5\n",
+          "last\n"),
+      data);
+}
+
+/*
+ * The discard test spawns a number of threads that each write a large number
+ * of messages quickly.  The AsyncFileWriter writes to a pipe, an a separate
+ * thread reads from it slowly, causing a backlog to build up.
+ *
+ * The test then checks that:
+ * - The read thread always receives full messages (no partial log messages)
+ * - Messages that are received are received in order
+ * - The number of messages received plus the number reported in discard
+ *   notifications matches the number of messages sent.
+ */
+
 // A large-ish message suffix, just to consume space and help fill up
 // log buffers faster.
 static constexpr StringPiece kMsgSuffix{
@@ -574,18 +727,6 @@ void writeThread(
   }
 }
 
-/*
- * The discard test spawns a number of threads that each write a large number
- * of messages quickly.  The AsyncFileWriter writes to a pipe, an a separate
- * thread reads from it slowly, causing a backlog to build up.
- *
- * The test then checks that:
- * - The read thread always receives full messages (no partial log messages)
- * - Messages that are received are received in order
- * - The number of messages received plus the number reported in discard
- *   notifications matches the number of messages sent.
- */
-
 TEST(AsyncFileWriter, discard) {
   std::array<int, 2> fds;
   auto pipeResult = fileops::pipe(fds.data());
@@ -17,9 +17,11 @@
 #include <folly/logging/FileHandlerFactory.h>
 
 #include <folly/Exception.h>
+#include <folly/io/async/IoUringBackend.h>
 #include <folly/logging/AsyncFileWriter.h>
 #include <folly/logging/GlogStyleFormatter.h>
 #include <folly/logging/ImmediateFileWriter.h>
+#include <folly/logging/IoUringFileWriter.h>
 #include <folly/logging/StandardLogHandler.h>
 #include <folly/logging/StreamHandlerFactory.h>
 #include <folly/portability/GTest.h>
@@ -147,6 +149,71 @@ TEST(FileHandlerFactory, pathWithMaxBufferSize) {
       stdHandler->getWriter().get(), tmpFile.path().string().c_str(), 4096000);
 }
 
+TEST(FileHandlerFactory, pathWithThreadBuffers) {
+  FileHandlerFactory factory;
+
+  TemporaryFile tmpFile{"logging_test"};
+  auto options = LogHandlerFactory::Options{
+      make_pair("path", tmpFile.path().string()),
+      make_pair("thread_buffer_size", "65536"),
+      make_pair("thread_buffer_overflow", "block"),
+  };
+  auto handler = factory.createHandler(options);
+
+  auto stdHandler = std::dynamic_pointer_cast<StandardLogHandler>(handler);
+  ASSERT_TRUE(stdHandler);
+  auto asyncWriter =
+      std::dynamic_pointer_cast<AsyncFileWriter>(stdHandler->getWriter());
+  ASSERT_TRUE(asyncWriter);
+  EXPECT_EQ(65536, asyncWriter->getPerThreadBufferSize());
+
+  options.at("thread_buffer_overflow") = "sometimes";
+  EXPECT_THROW(factory.createHandler(options), std::invalid_argument);
+}
+
+TEST(FileHandlerFactory, pathWithUring) {
+  FileHandlerFactory factory;
+
+  TemporaryFile tmpFile{"logging_test"};
+  auto options = LogHandlerFactory::Options{
+      make_pair("path", tmpFile.path().string()),
+      make_pair("async", "uring"),
+      make_pair("max_buffer_size", "4096"),
+  };
+  auto handler = factory.createHandler(options);
+
+  auto stdHandler = std::dynamic_pointer_cast<StandardLogHandler>(handler);
+  ASSERT_TRUE(stdHandler);
+  auto asyncWriter =
+      std::dynamic_pointer_cast<AsyncLogWriter>(stdHandler->getWriter());
+  ASSERT_TRUE(asyncWriter);
+  EXPECT_EQ(4096, asyncWriter->getMaxBufferSize());
+#if FOLLY_HAS_LIBURING
+  if (IoUringBackend::isAvailable()) {
+    auto uringWriter = std::dynamic_pointer_cast<IoUringFileWriter>(asyncWriter);
+    ASSERT_TRUE(uringWriter);
+    EXPECT_FALSE(uringWriter->isDirectIO());
+    return;
+  }
+#endif
+  // Without io_uring this falls back to an AsyncFileWriter.
+  EXPECT_TRUE(std::dynamic_pointer_cast<AsyncFileWriter>(asyncWriter));
+}
+
+TEST(FileHandlerFactory, directIORequiresUring) {
+  FileHandlerFactory factory;
+
+  TemporaryFile tmpFile{"logging_test"};
+  auto options = LogHandlerFactory::Options{
+      make_pair("path", tmpFile.path().string()),
+      make_pair("direct_io", "true"),
+  };
+  EXPECT_THROW_RE(
+      factory.createHandler(options),
+      std::invalid_argument,
+      "the \"direct_io\" option is only valid with \"async=uring\"");
+}
+
 TEST(StreamHandlerFactory, nonAsyncStderr) {
   StreamHandlerFactory factory;
 
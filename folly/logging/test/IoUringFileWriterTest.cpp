@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/IoUringFileWriter.h>
+
+#include <thread>
+
+#include <folly/Conv.h>
+#include <folly/File.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/io/async/IoUringBackend.h>
+#include <folly/portability/GTest.h>
+#include <folly/testing/TestUtil.h>
+
+#if FOLLY_HAS_LIBURING
+
+using namespace folly;
+using folly::test::TemporaryFile;
+
+namespace {
+std::string readTmpFile(TemporaryFile& tmpFile) {
+  std::string data;
+  EXPECT_TRUE(folly::readFile(tmpFile.path().string().c_str(), data));
+  return data;
+}
+
+// The O_DIRECT writer rewrites the file from a block aligned offset, so it
+// needs a file opened for writing without O_APPEND.
+folly::File openForDirectIO(TemporaryFile& tmpFile) {
+  return folly::File{tmpFile.path().string(), O_WRONLY | O_CLOEXEC};
+}
+} // namespace
+
+class IoUringFileWriterTest : public testing::Test {
+ public:
+  void SetUp() override {
+    if (!IoUringBackend::isAvailable()) {
+      GTEST_SKIP() << "io_uring not available";
+    }
+  }
+};
+
+TEST_F(IoUringFileWriterTest, simpleMessages) {
+  TemporaryFile tmpFile{"logging_test"};
+  {
+    IoUringFileWriter writer{folly::File{tmpFile.fd(), false}};
+    for (int n = 0; n < 10; ++n) {
+      writer.writeMessage(folly::to<std::string>("message ", n, "\n"));
+      std::this_thread::yield();
+    }
+  }
+  tmpFile.close();
+
+  std::string expected;
+  for (int n = 0; n < 10; ++n) {
+    expected += folly::to<std::string>("message ", n, "\n");
+  }
+  EXPECT_EQ(expected, readTmpFile(tmpFile));
+}
+
+TEST_F(IoUringFileWriterTest, largeBatches) {
+  // More messages per batch than IOV_MAX times the ring size, so that batches
+  // need several chains.
+  constexpr size_t kNumMessages = 50000;
+  TemporaryFile tmpFile{"logging_test"};
+  {
+    IoUringFileWriter::Options options;
+    options.capacity = 4;
+    IoUringFileWriter writer{folly::File{tmpFile.fd(), false}, options};
+    writer.setMaxBufferSize(64 * 1024 * 1024);
+    for (size_t n = 0; n < kNumMessages; ++n) {
+      writer.writeMessage(folly::to<std::string>(n, "\n"));
+    }
+    writer.flush();
+    EXPECT_EQ(0, writer.getNumDiscarded());
+  }
+  tmpFile.close();
+
+  auto data = readTmpFile(tmpFile);
+  std::vector<StringPiece> lines;
+  folly::split('\n', StringPiece(data).subpiece(0, data.size() - 1), lines);
+  ASSERT_EQ(kNumMessages, lines.size());
+  for (size_t n = 0; n < kNumMessages; ++n) {
+    EXPECT_EQ(n, folly::to<size_t>(lines[n]));
+  }
+}
+
+TEST_F(IoUringFileWriterTest, directIO) {
+  TemporaryFile tmpFile{"logging_test"};
+  ASSERT_EQ(5, folly::writeFull(tmpFile.fd(), "head\n", 5));
+
+  IoUringFileWriter::Options options;
+  options.directIO = true;
+  std::string expected = "head\n";
+  try {
+    IoUringFileWriter writer{openForDirectIO(tmpFile), options};
+    EXPECT_TRUE(writer.isDirectIO());
+    // Messages that straddle block boundaries, each written in its own batch.
+    for (int n = 0; n < 5; ++n) {
+      auto msg = std::string(3000 + n, char('a' + n)) + "\n";
+      expected += msg;
+      writer.writeMessage(std::move(msg));
+      writer.flush();
+      EXPECT_EQ(expected, readTmpFile(tmpFile));
+    }
+  } catch (const std::system_error& ex) {
+    if (ex.code().value() == EINVAL) {
+      GTEST_SKIP() << "O_DIRECT is not supported for " << tmpFile.path();
+    }
+    throw;
+  }
+  EXPECT_EQ(expected, readTmpFile(tmpFile));
+}
+
+#endif // FOLLY_HAS_LIBURING
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/JsonLogFormatter.h>
+
+#include <limits>
+
+#include <folly/logging/LogMessage.h>
+#include <folly/logging/LoggerDB.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+std::string formatMsg(
+    StringPiece msg,
+    Range<const LogField*> fields = {},
+    std::string context = {}) {
+  LoggerDB db{LoggerDB::TESTING};
+  auto* category = db.getCategory("test.json");
+  JsonLogFormatter formatter;
+
+  // 2017-04-17 13:45:56.123456 UTC
+  std::chrono::system_clock::time_point timestamp{
+      std::chrono::microseconds{1492436756123456ULL}};
+  LogMessage logMessage{
+      category,
+      LogLevel::WARN,
+      timestamp,
+      5678,
+      "src/test.cpp",
+      1234,
+      "testFunction",
+      std::move(context),
+      msg.str(),
+      fields};
+  return formatter.formatMessage(logMessage, category);
+}
+} // namespace
+
+TEST(JsonLogFormatter, message) {
+  EXPECT_EQ(
+      "{\"time\":\"2017-04-17T13:45:56.123456Z\",\"level\":\"WARN\","
+      "\"category\":\"test.json\",\"file\":\"src/test.cpp\",\"line\":1234,"
+      "\"function\":\"testFunction\",\"thread\":5678,"
+      "\"message\":\"hello world\"}\n",
+      formatMsg("hello world"));
+}
+
+TEST(JsonLogFormatter, context) {
+  EXPECT_EQ(
+      "{\"time\":\"2017-04-17T13:45:56.123456Z\",\"level\":\"WARN\","
+      "\"category\":\"test.json\",\"file\":\"src/test.cpp\",\"line\":1234,"
+      "\"function\":\"testFunction\",\"thread\":5678,"
+      "\"context\":\" ctx\",\"message\":\"hi\"}\n",
+      formatMsg("hi", {}, " ctx"));
+}
+
+TEST(JsonLogFormatter, escaping) {
+  auto out =
+      formatMsg(std::string("quote\" backslash\\ nl\n tab\t nul\0 bell\a", 37));
+  EXPECT_NE(
+      std::string::npos,
+      out.find("\"message\":\"quote\\\" backslash\\\\ nl\\n tab\\t "
+               "nul\\u0000 bell\\u0007\"}\n"))
+      << out;
+  // Only the trailing newline is left unescaped.
+  EXPECT_EQ(out.size() - 1, out.find('\n'));
+}
+
+TEST(JsonLogFormatter, fields) {
+  std::string name = "a \"name\"";
+  auto fields = logFields(
+      "user",
+      name,
+      "count",
+      -3,
+      "bytes",
+      uint64_t(18446744073709551615ULL),
+      "ratio",
+      0.25,
+      "nan",
+      std::numeric_limits<double>::quiet_NaN(),
+      "ok",
+      false);
+  auto out = formatMsg("done", fields.getFields());
+  EXPECT_NE(
+      std::string::npos,
+      out.find("\"message\":\"done\",\"fields\":{\"user\":\"a \\\"name\\\"\","
+               "\"count\":-3,\"bytes\":18446744073709551615,\"ratio\":0.25,"
+               "\"nan\":null,\"ok\":false}}\n"))
+      << out;
+}
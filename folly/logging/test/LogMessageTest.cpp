@@ -82,3 +82,53 @@ TEST(LogMessage, sanitize) {
   CHECK_MSG("\x82\n\x83\n", "\x82\n\x83\n", true);
   CHECK_MSG("\x82\n\\x0c\x83\n", "\x82\n\f\x83\n", true);
 }
+
+TEST(LogMessage, fields) {
+  LoggerDB db{LoggerDB::TESTING};
+  Logger logger{&db, "test"};
+  auto* category = logger.getCategory();
+
+  std::string user = "alice";
+  auto fields = logFields(
+      "user", user, "ms", 12, "bytes", 4096u, "ratio", 0.5, "ok", true);
+  LogMessage msg{
+      category,
+      LogLevel::INFO,
+      __FILE__,
+      __LINE__,
+      __func__,
+      std::string{"done"},
+      fields.getFields()};
+  ASSERT_EQ(5, msg.getFields().size());
+  EXPECT_EQ(fields.getFields().data(), msg.getFields().data());
+
+  // Copies own their fields, and do not refer to the original strings.
+  LogMessage copy{msg};
+  user = "bob";
+  auto copied = copy.getFields();
+  ASSERT_EQ(5, copied.size());
+  EXPECT_NE(fields.getFields().data(), copied.data());
+  EXPECT_EQ("user", copied[0].getKey());
+  EXPECT_EQ(LogField::Type::STRING, copied[0].getType());
+  EXPECT_EQ("alice", copied[0].getString());
+  EXPECT_EQ("ms", copied[1].getKey());
+  EXPECT_EQ(LogField::Type::INT64, copied[1].getType());
+  EXPECT_EQ(12, copied[1].getInt64());
+  EXPECT_EQ(LogField::Type::UINT64, copied[2].getType());
+  EXPECT_EQ(4096, copied[2].getUInt64());
+  EXPECT_EQ(LogField::Type::DOUBLE, copied[3].getType());
+  EXPECT_EQ(0.5, copied[3].getDouble());
+  EXPECT_EQ(LogField::Type::BOOL, copied[4].getType());
+  EXPECT_TRUE(copied[4].getBool());
+
+  LogMessage noFields{
+      category,
+      LogLevel::INFO,
+      __FILE__,
+      __LINE__,
+      __func__,
+      std::string{"plain"}};
+  EXPECT_TRUE(noFields.getFields().empty());
+  LogMessage noFieldsCopy(noFields);
+  EXPECT_TRUE(noFieldsCopy.getFields().empty());
+}
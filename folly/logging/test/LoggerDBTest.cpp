@@ -16,6 +16,14 @@
 
 #include <folly/logging/LoggerDB.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/logging/LogCategory.h>
+#include <folly/logging/LogConfigParser.h>
+#include <folly/logging/LogLevel.h>
 #include <folly/logging/Logger.h>
 #include <folly/logging/test/TestLogHandler.h>
 #include <folly/portability/GTest.h>
@@ -37,6 +45,82 @@ TEST(LoggerDB, getCategory) {
   LoggerDB db{LoggerDB::TESTING};
 }
 
+TEST(LoggerDB, getCategoryOrNull) {
+  LoggerDB db{LoggerDB::TESTING};
+  EXPECT_EQ(nullptr, db.getCategoryOrNull("foo.bar"));
+  auto* fooBar = db.getCategory("foo.bar");
+  EXPECT_EQ(fooBar, db.getCategoryOrNull("foo.bar"));
+  EXPECT_EQ(fooBar, db.getCategoryOrNull("..foo..bar."));
+  EXPECT_NE(nullptr, db.getCategoryOrNull("foo"));
+  EXPECT_EQ(db.getCategory(""), db.getCategoryOrNull("."));
+}
+
+TEST(LoggerDB, manyCategories) {
+  LoggerDB db{LoggerDB::TESTING};
+  std::vector<LogCategory*> categories;
+  for (size_t n = 0; n < 1000; ++n) {
+    categories.push_back(db.getCategory(folly::to<std::string>("cat", n)));
+  }
+  for (size_t n = 0; n < categories.size(); ++n) {
+    auto name = folly::to<std::string>("cat", n);
+    EXPECT_EQ(categories[n], db.getCategoryOrNull(name));
+    EXPECT_EQ(categories[n], db.getCategory(name));
+  }
+}
+
+TEST(LoggerDB, lookupsDuringConfigUpdates) {
+  LoggerDB db{LoggerDB::TESTING};
+  auto* foo = db.getCategory("foo");
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t] {
+      size_t n = 0;
+      while (!stop.load()) {
+        EXPECT_EQ(foo, db.getCategory("foo"));
+        // Also create categories concurrently with the config updates.
+        auto name = folly::to<std::string>("reader", t, ".", n++ % 200);
+        auto* category = db.getCategory(name);
+        EXPECT_EQ(category, db.getCategoryOrNull(name));
+      }
+    });
+  }
+  for (int n = 0; n < 200; ++n) {
+    db.updateConfig(parseLogConfig(
+        n % 2 ? "foo=DBG2,foo.bar=INFO" : "foo=WARN,foo.bar=ERR"));
+  }
+  stop.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(LogLevel::INFO, db.getCategory("foo.bar")->getLevel());
+}
+
+TEST(LoggerDB, xlogInit) {
+  LoggerDB db{LoggerDB::TESTING};
+  db.setLevel("foo", LogLevel::WARN, /* inherit */ false);
+
+  std::atomic<LogLevel> xlogLevel{LogLevel::UNINITIALIZED};
+  LogCategory* xlogCategory = nullptr;
+  EXPECT_EQ(
+      LogLevel::WARN, db.xlogInit("foo.bar", &xlogLevel, &xlogCategory));
+  EXPECT_EQ(db.getCategory("foo.bar"), xlogCategory);
+  EXPECT_EQ(LogLevel::WARN, xlogLevel.load());
+
+  // Initializing again is a no-op.
+  EXPECT_EQ(
+      LogLevel::WARN, db.xlogInit("foo.bar", &xlogLevel, &xlogCategory));
+
+  // Level changes propagate to the registered XLOG level.
+  db.setLevel("foo", LogLevel::DBG1);
+  EXPECT_EQ(LogLevel::DBG1, xlogLevel.load());
+  db.setLevel("foo.bar", LogLevel::ERR);
+  EXPECT_EQ(LogLevel::DBG1, xlogLevel.load());
+  db.updateConfig(parseLogConfig("foo=ERR,foo.bar=ERR"));
+  EXPECT_EQ(LogLevel::INFO, xlogLevel.load());
+  EXPECT_EQ(xlogCategory->getEffectiveLevel(), xlogLevel.load());
+}
+
 TEST(LoggerDB, flushAllHandlers) {
   LoggerDB db{LoggerDB::TESTING};
   auto* cat1 = db.getCategory("foo");
@@ -25,6 +25,7 @@
 #include <folly/portability/GTest.h>
 
 using folly::logging::IntervalRateLimiter;
+using folly::logging::TokenBucketRateLimiter;
 using std::chrono::duration_cast;
 using namespace std::literals::chrono_literals;
 
@@ -124,3 +125,76 @@ TEST(RateLimiter, LargeInterval) {
   IntervalRateLimiter limiter{1, std::chrono::hours{8765}}; // Just under a year
   EXPECT_TRUE(limiter.check());
 }
+
+TEST(RateLimiter, tokenBucketBurst) {
+  TokenBucketRateLimiter limiter{1, 5};
+  for (int n = 0; n < 5; ++n) {
+    EXPECT_TRUE(limiter.check()) << "event " << n;
+  }
+  for (int n = 0; n < 20; ++n) {
+    EXPECT_FALSE(limiter.check()) << "event " << n;
+  }
+  EXPECT_EQ(20, limiter.takeSuppressed());
+  EXPECT_EQ(0, limiter.takeSuppressed());
+}
+
+TEST(RateLimiter, tokenBucketRefill) {
+  // One token every 50ms, with room for two.
+  TokenBucketRateLimiter limiter{20, 2};
+  EXPECT_TRUE(limiter.check());
+  EXPECT_TRUE(limiter.check());
+  EXPECT_FALSE(limiter.check());
+
+  /* sleep override */
+  std::this_thread::sleep_for(75ms);
+  EXPECT_TRUE(limiter.check());
+  EXPECT_FALSE(limiter.check());
+
+  // The bucket never holds more than the burst size.
+  /* sleep override */
+  std::this_thread::sleep_for(500ms);
+  EXPECT_TRUE(limiter.check());
+  EXPECT_TRUE(limiter.check());
+  EXPECT_FALSE(limiter.check());
+  EXPECT_EQ(3, limiter.takeSuppressed());
+}
+
+TEST(RateLimiter, tokenBucketExtremeRates) {
+  TokenBucketRateLimiter slow{1e-12, 1};
+  EXPECT_TRUE(slow.check());
+  EXPECT_FALSE(slow.check());
+
+  TokenBucketRateLimiter huge{1, std::numeric_limits<uint64_t>::max()};
+  for (int n = 0; n < 1000; ++n) {
+    EXPECT_TRUE(huge.check());
+  }
+
+  TokenBucketRateLimiter zero{0, 1};
+  EXPECT_TRUE(zero.check());
+  EXPECT_FALSE(zero.check());
+}
+
+TEST(RateLimiter, tokenBucketConcurrentThreads) {
+  constexpr uint64_t burst = 20;
+  constexpr uint64_t numThreads = 16;
+  constexpr uint64_t checksPerThread = 100;
+
+  TokenBucketRateLimiter limiter{1e-6, burst};
+  std::atomic<uint64_t> count{0};
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (uint64_t n = 0; n < numThreads; ++n) {
+    threads.emplace_back([&] {
+      for (uint64_t i = 0; i < checksPerThread; ++i) {
+        if (limiter.check()) {
+          count.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(burst, count.load(std::memory_order_relaxed));
+}
@@ -197,3 +197,18 @@ TEST_F(StandardLogHandlerFactoryTest, CustomFormatterTest) {
       testing::MatchesRegex("^.+pollution secretary bean.+$"));
   EXPECT_EQ(writer->messages[1], "Test Formatter! ethereal potato kick");
 }
+
+TEST_F(StandardLogHandlerFactoryTest, JsonFormatterTest) {
+  Logger logger{&db, "test"};
+  db.resetConfig(
+      parseLogConfig("test=WARN:default; default=test:formatter=json"));
+
+  FB_LOG(logger, WARN, "disk full", logFields("free_bytes", 0));
+
+  ASSERT_EQ(writer->messages.size(), 1);
+  EXPECT_THAT(
+      writer->messages[0],
+      testing::MatchesRegex(
+          "^\\{\"time\":.*\"level\":\"WARN\",\"category\":\"test\".*"
+          "\"message\":\"disk full\",\"fields\":\\{\"free_bytes\":0\\}\\}\n$"));
+}
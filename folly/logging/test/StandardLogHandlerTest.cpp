@@ -17,6 +17,7 @@
 #include <folly/logging/StandardLogHandler.h>
 
 #include <folly/Conv.h>
+#include <folly/logging/DeferredLogFormat.h>
 #include <folly/logging/LogCategory.h>
 #include <folly/logging/LogFormatter.h>
 #include <folly/logging/LogHandlerConfig.h>
@@ -65,6 +66,20 @@ class TestLogWriter : public LogWriter {
  private:
   std::vector<std::string> messages_;
 };
+
+class TestDeferringLogWriter : public TestLogWriter {
+ public:
+  bool writeDeferredMessage(
+      DeferredLogMessage&& message, uint32_t /* flags */ = 0) override {
+    deferred_.push_back(std::move(message));
+    return true;
+  }
+
+  std::vector<DeferredLogMessage>& getDeferred() { return deferred_; }
+
+ private:
+  std::vector<DeferredLogMessage> deferred_;
+};
 } // namespace
 
 TEST(StandardLogHandler, simple) {
@@ -136,3 +151,40 @@ TEST(StandardLogHandler, levelCheck) {
       "ERR::log_cat::handler_cat::src/test.cpp::1234::oh noes", messages.at(2));
   messages.clear();
 }
+
+TEST(StandardLogHandler, deferred) {
+  LoggerDB db{LoggerDB::TESTING};
+  auto logCategory = db.getCategory("log_cat");
+  auto handlerCategory = db.getCategory("handler_cat");
+  DeferredLogFormat format{"number {}", 7};
+  LogMessage msg{
+      logCategory, LogLevel::INFO, "src/test.cpp", 1234, "testMethod", format};
+  const std::string expected =
+      "INFO::log_cat::handler_cat::src/test.cpp::1234::number 7";
+
+  // Writers that do not support deferred messages get the formatted text.
+  auto writer = make_shared<TestLogWriter>();
+  LogHandlerConfig config{"std_test"};
+  StandardLogHandler handler(config, make_shared<TestLogFormatter>(), writer);
+  handler.handleMessage(msg, handlerCategory);
+  ASSERT_EQ(1, writer->getMessages().size());
+  EXPECT_EQ(expected, writer->getMessages()[0]);
+
+  auto deferringWriter = make_shared<TestDeferringLogWriter>();
+  StandardLogHandler deferringHandler(
+      config, make_shared<TestLogFormatter>(), deferringWriter, LogLevel::ERR);
+  deferringHandler.handleMessage(msg, handlerCategory);
+  EXPECT_EQ(0, deferringWriter->getMessages().size());
+  ASSERT_EQ(1, deferringWriter->getDeferred().size());
+  EXPECT_EQ(expected, deferringWriter->getDeferred()[0].format());
+
+  // Messages at or above the sync level are never deferred.
+  LogMessage errMsg{
+      logCategory, LogLevel::ERR, "src/test.cpp", 1234, "testMethod", format};
+  deferringHandler.handleMessage(errMsg, handlerCategory);
+  EXPECT_EQ(1, deferringWriter->getDeferred().size());
+  ASSERT_EQ(1, deferringWriter->getMessages().size());
+  EXPECT_EQ(
+      "ERR::log_cat::handler_cat::src/test.cpp::1234::number 7",
+      deferringWriter->getMessages()[0]);
+}
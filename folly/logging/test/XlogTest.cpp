@@ -214,6 +214,42 @@ TEST_F(XlogTest, xlog) {
   messages.clear();
 }
 
+TEST_F(XlogTest, xlogDeferred) {
+  auto handler = make_shared<TestLogHandler>();
+  LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
+  auto& messages = handler->getMessages();
+
+  // The arguments are not evaluated when the level check fails.
+  int evaluated = 0;
+  XLOGF_DEFERRED(INFO, "not enabled: {}", ++evaluated);
+  EXPECT_EQ(0, evaluated);
+  EXPECT_EQ(0, messages.size());
+
+  XLOGF_DEFERRED(WARN, "number: {:>3d}; double: {:.1f}", 12, 2.5);
+  ASSERT_EQ(1, messages.size());
+  // TestLogHandler stores a copy, which is formatted and no longer deferred.
+  EXPECT_EQ(nullptr, messages[0].first.getDeferredFormat());
+  EXPECT_EQ("number:  12; double: 2.5", messages[0].first.getMessage());
+  EXPECT_EQ(LogLevel::WARN, messages[0].first.getLevel());
+  EXPECT_EQ(current_xlog_category, messages[0].first.getCategory()->getName());
+  EXPECT_EQ(current_xlog_parent, messages[0].second->getName());
+  messages.clear();
+
+  XLOGF_DEFERRED(ERR, "stream: {}", 1) << ", two";
+  ASSERT_EQ(1, messages.size());
+  EXPECT_EQ("stream: 1, two", messages[0].first.getMessage());
+  messages.clear();
+
+  XLOGF_DEFERRED(ERR, "bad format {:d}", 1.5);
+  ASSERT_EQ(1, messages.size());
+  EXPECT_THAT(
+      messages[0].first.getMessage(),
+      testing::StartsWith("error formatting log message: "));
+  EXPECT_THAT(
+      messages[0].first.getMessage(), testing::HasSubstr("arguments: 1.5"));
+  messages.clear();
+}
+
 TEST_F(XlogTest, perFileCategoryHandling) {
   using namespace logging_test;
 
@@ -566,6 +602,91 @@ TEST_F(XlogTest, rateLimiting) {
   handler->clearMessages();
 }
 
+TEST_F(XlogTest, sampling) {
+  auto handler = make_shared<TestLogHandler>();
+  LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
+  LoggerDB::get().setLevel(current_xlog_parent, LogLevel::DBG1);
+
+  for (size_t n = 0; n < 5; ++n) {
+    XLOG_SAMPLED(DBG1, 1, "all ", n);
+    XLOGF_SAMPLED(DBG1, 1, "all fmt {}", n);
+  }
+  EXPECT_EQ(10, handler->getMessages().size());
+  handler->clearMessages();
+
+  // The sampling is random, so just check that the number of messages is
+  // in the right ballpark.
+  for (size_t n = 0; n < 10000; ++n) {
+    XLOG_SAMPLED(DBG1, 10, "sampled ", n);
+  }
+  EXPECT_GT(handler->getMessages().size(), 700);
+  EXPECT_LT(handler->getMessages().size(), 1300);
+  handler->clearMessages();
+
+  // Nothing is evaluated when the level is disabled.
+  LoggerDB::get().setLevel(current_xlog_parent, LogLevel::INFO);
+  size_t evaluated = 0;
+  for (size_t n = 0; n < 10; ++n) {
+    XLOG_SAMPLED(DBG1, (++evaluated, 1), "disabled ", n);
+  }
+  EXPECT_EQ(0, evaluated);
+  EXPECT_EQ(0, handler->getMessages().size());
+}
+
+TEST_F(XlogTest, tokenBucketRateLimiting) {
+  auto handler = make_shared<TestLogHandler>();
+  LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
+  LoggerDB::get().setLevel(current_xlog_parent, LogLevel::DBG1);
+
+  auto logBurst = [](size_t begin, size_t end) {
+    for (size_t n = begin; n < end; ++n) {
+      XLOG_RATE_LIMITED(DBG1, 10, 3, "msg ", n);
+    }
+  };
+
+  logBurst(0, 10);
+  EXPECT_THAT(
+      handler->getMessageValues(), ElementsAre("msg 0", "msg 1", "msg 2"));
+  handler->clearMessages();
+
+  // At 10 messages per second a token is added every 100ms.
+  /* sleep override */
+  std::this_thread::sleep_for(150ms);
+  logBurst(10, 20);
+  ASSERT_FALSE(handler->getMessages().empty());
+  EXPECT_EQ(
+      "[7 similar messages suppressed] msg 10",
+      handler->getMessageValues().front());
+  handler->clearMessages();
+}
+
+TEST_F(XlogTest, fields) {
+  auto handler = make_shared<TestLogHandler>();
+  LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
+  LoggerDB::get().setLevel(current_xlog_parent, LogLevel::DBG1);
+
+  XLOG(INFO, "request ", 7, logFields("user", std::string("bob"), "ms", 3));
+  XLOG(INFO, logFields("streamed", true)) << "via stream";
+  XLOG(INFO, "no fields");
+
+  auto& messages = handler->getMessages();
+  ASSERT_EQ(3, messages.size());
+
+  EXPECT_EQ("request 7", messages[0].first.getMessage());
+  auto fields = messages[0].first.getFields();
+  ASSERT_EQ(2, fields.size());
+  EXPECT_EQ("user", fields[0].getKey());
+  EXPECT_EQ("bob", fields[0].getString());
+  EXPECT_EQ("ms", fields[1].getKey());
+  EXPECT_EQ(3, fields[1].getInt64());
+
+  EXPECT_EQ("via stream", messages[1].first.getMessage());
+  ASSERT_EQ(1, messages[1].first.getFields().size());
+  EXPECT_TRUE(messages[1].first.getFields()[0].getBool());
+
+  EXPECT_TRUE(messages[2].first.getFields().empty());
+}
+
 TEST_F(XlogTest, rateLimitingEndOfThread) {
   auto handler = make_shared<TestLogHandler>();
   LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
@@ -16,9 +16,13 @@
 
 #include <folly/logging/xlog.h>
 
+#include <chrono>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 
+#include <folly/Conv.h>
 #include <folly/Synchronized.h>
 #include <folly/portability/PThread.h>
 
@@ -32,6 +36,39 @@ bool const xlog_support_buck2 = false;
 #endif
 } // namespace detail
 
+namespace detail {
+namespace {
+thread_local uint64_t xlogSuppressedCount = 0;
+} // namespace
+
+uint64_t xlogSampleSeed() {
+  // splitmix64 over the thread id and the current time, so that threads
+  // started together do not share a sampling sequence.
+  uint64_t z = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+      uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+  z += 0x9e3779b97f4a7c15;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  z ^= z >> 31;
+  // xorshift never leaves the all-zero state, so avoid it.
+  return z == 0 ? 1 : z;
+}
+
+void xlogSetSuppressedCount(uint64_t count) {
+  xlogSuppressedCount = count;
+}
+
+std::string xlogSuppressedPrefix() {
+  auto const count = std::exchange(xlogSuppressedCount, 0);
+  if (count == 0) {
+    return std::string();
+  }
+  return folly::to<std::string>(
+      "[", count, " similar message", count == 1 ? "" : "s", " suppressed] ");
+}
+
+} // namespace detail
+
 namespace detail {
 size_t& xlogEveryNThreadEntry(void const* const key) {
   using Map = std::unordered_map<void const*, size_t>;
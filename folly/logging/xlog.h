@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <string>
 
 #include <folly/Likely.h>
 #include <folly/Portability.h>
@@ -124,6 +126,25 @@ static_assert(
       fmt,                                 \
       ##__VA_ARGS__)
 
+/**
+ * Log a message to this file's default log category, using a format string
+ * that is only formatted when a LogHandler needs the text.
+ *
+ * With an AsyncFileWriter this happens in its I/O thread: the logging thread
+ * just copies the format string pointer and the arguments into a fixed size
+ * record, without allocating or calling fmt::format().  The level checks are
+ * the same as for XLOGF().
+ *
+ * The format string must be a string literal, and the arguments must be
+ * trivially copyable values that do not point to other memory: numbers,
+ * enums, void pointers and the like.  Use XLOGF() to log strings.
+ */
+#define XLOGF_DEFERRED(level, fmt, ...)             \
+  XLOG_IMPL(                                        \
+      ::folly::LogLevel::level,                     \
+      ::folly::LogStreamProcessor::DEFERRED_FORMAT, \
+      ::folly::DeferredLogFormat(fmt, ##__VA_ARGS__))
+
 /**
  * Similar to XLOG(...) except only log a message every @param ms
  * milliseconds.
@@ -458,6 +479,93 @@ FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogFirstNExactImpl(std::size_t n) {
       }(),                                                                     \
       ##__VA_ARGS__)
 
+namespace folly {
+namespace detail {
+
+uint64_t xlogSampleSeed();
+
+FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogSampledImpl(std::size_t n) {
+  static thread_local uint64_t state = 0;
+  if (FOLLY_UNLIKELY(state == 0)) {
+    state = xlogSampleSeed();
+  }
+  // xorshift64: cheap, thread-local, and good enough for sampling.
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return FOLLY_UNLIKELY(n <= 1 || (state % n) == 0);
+}
+
+} // namespace detail
+} // namespace folly
+
+/**
+ * Similar to XLOG(...) except each invocation is logged with probability
+ * 1/@param n.
+ *
+ * The sampling decision uses a thread-local random number generator, so
+ * unlike XLOG_EVERY_N(...) there is no counter shared between threads and
+ * no per-thread map lookup as with XLOG_EVERY_N_THREAD(...).  Since the
+ * choice is random, messages emitted in a regular pattern (for instance by
+ * a loop that alternates between several XLOG statements) are not aliased
+ * with the sampling period.
+ */
+#define XLOG_SAMPLED(level, n, ...) \
+  XLOG_IF(level, ::folly::detail::xlogSampledImpl(n), ##__VA_ARGS__)
+
+/**
+ * Similar to XLOGF(...) except each invocation is logged with probability
+ * 1/@param n.
+ *
+ * See XLOG_SAMPLED(...) for details.
+ */
+#define XLOGF_SAMPLED(level, n, fmt, ...) \
+  XLOGF_IF(level, ::folly::detail::xlogSampledImpl(n), fmt, ##__VA_ARGS__)
+
+namespace folly {
+namespace detail {
+
+void xlogSetSuppressedCount(uint64_t count);
+std::string xlogSuppressedPrefix();
+
+FOLLY_ALWAYS_INLINE bool xlogRateLimitedImpl(
+    logging::TokenBucketRateLimiter& limiter) {
+  if (FOLLY_UNLIKELY(!limiter.check())) {
+    return false;
+  }
+  xlogSetSuppressedCount(limiter.takeSuppressed());
+  return true;
+}
+
+} // namespace detail
+} // namespace folly
+
+/**
+ * Similar to XLOG(...) except messages are rate limited with a token bucket:
+ * on average at most @param perSecond messages are logged per second, with
+ * bursts of up to @param burst messages.
+ *
+ * When messages have been dropped since the last one logged by this
+ * statement, the next logged message is prefixed with the number of
+ * suppressed messages, e.g. "[42 similar messages suppressed] ".
+ *
+ * Each XLOG_RATE_LIMITED() statement has its own limiter, which is
+ * process-global and threadsafe.  Dropping a message does not perform any
+ * atomic read-modify-write operation, so a statement that is being
+ * suppressed remains cheap even when it is hit from many threads.
+ */
+#define XLOG_RATE_LIMITED(level, perSecond, burst, ...)       \
+  XLOG_IF(                                                    \
+      level,                                                  \
+      [&] {                                                   \
+        static ::folly::logging::TokenBucketRateLimiter       \
+            folly_detail_xlog_limiter((perSecond), (burst));  \
+        return ::folly::detail::xlogRateLimitedImpl(          \
+            folly_detail_xlog_limiter);                       \
+      }(),                                                    \
+      ::folly::detail::xlogSuppressedPrefix(),                \
+      ##__VA_ARGS__)
+
 /**
  * FOLLY_XLOG_STRIP_PREFIXES can be defined to a string containing a
  * colon-separated list of directory prefixes to strip off from the filename
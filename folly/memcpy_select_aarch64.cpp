@@ -29,9 +29,9 @@
  * architecture extensions it needs in the source file, which is how we get
  * SVE support without having requested it on our command-line.
  *
- * At runtime we use a GNU IFUNC with a resolver to choose the most performant
- * implementation based on the CPU features presented to us in the aux data
- * by the kernel.
+ * At runtime we use a GNU IFUNC with a resolver, through FOLLY_CPU_DISPATCH,
+ * to choose the most performant implementation based on the CPU features
+ * presented to us in the aux data by the kernel.
  *
  * Finally, we alias memcpy and memmove to our implementations when instructed
  * to do so.
@@ -46,7 +46,8 @@
  * implemented or how to detect it. This is all important because we cannot
  * call any library functions (like getauxval) in a resolver function, and
  * it's unsafe to query ISAR registers without having checked AUX_HWCAP to
- * see if those are callable by userspace.
+ * see if those are callable by userspace. FOLLY_CPU_DISPATCH passes both to
+ * the selection functions below, as a CpuFeatures, when glibc provides them.
  */
 
 #include <cstddef>
@@ -54,17 +55,7 @@
 
 #if defined(__linux__) && defined(__aarch64__)
 
-#include <asm/hwcap.h> // @manual
-
-#if defined(__has_include)
-#if __has_include(<sys/ifunc.h>)
-#include <sys/ifunc.h>
-#endif
-#endif
-
-#if !defined(HWCAP2_MOPS)
-#define HWCAP2_MOPS (1UL << 43)
-#endif
+#include <folly/system/CpuDispatch.h>
 
 extern "C" {
 
@@ -78,68 +69,71 @@ void* __folly_memmove_aarch64_mops(void* dst, const void* src, std::size_t len);
 void* __folly_memmove_aarch64_simd(void* dst, const void* src, std::size_t len);
 void* __folly_memmove_aarch64_sve(void* dst, const void* src, std::size_t len);
 
-[[gnu::no_sanitize_address]]
-decltype(&__folly_memcpy_aarch64) __folly_detail_memcpy_resolve(
-    uint64_t hwcaps, const void* arg2) {
-#if defined(_IFUNC_ARG_HWCAP)
-  if (hwcaps & _IFUNC_ARG_HWCAP && arg2 != nullptr) {
-    const __ifunc_arg_t* args = reinterpret_cast<const __ifunc_arg_t*>(arg2);
-    if (args->_hwcap2 & HWCAP2_MOPS) {
-      return __folly_memcpy_aarch64_mops;
-    }
+void* __folly_memcpy(void* dst, const void* src, std::size_t size);
+void* __folly_memmove(void* dst, const void* src, std::size_t size);
+
+} // extern "C"
+
+namespace {
+
+decltype(&__folly_memcpy) select_memcpy(const folly::CpuFeatures& cpu) {
+  if (cpu.hwCaps.aarch64_mops()) {
+    return __folly_memcpy_aarch64_mops;
   }
-#endif
 
-  if (hwcaps & HWCAP_SVE) {
+  if (cpu.hwCaps.aarch64_sve()) {
     return __folly_memcpy_aarch64_sve;
   }
 
-  if (hwcaps & HWCAP_ASIMD) {
+  if (cpu.hwCaps.aarch64_asimd()) {
     return __folly_memcpy_aarch64_simd;
   }
 
   return __folly_memcpy_aarch64;
 }
 
-[[gnu::no_sanitize_address]]
-decltype(&__folly_memmove_aarch64) __folly_detail_memmove_resolve(
-    uint64_t hwcaps, const void* arg2) {
-#if defined(_IFUNC_ARG_HWCAP)
-  if (hwcaps & _IFUNC_ARG_HWCAP && arg2 != nullptr) {
-    const __ifunc_arg_t* args = reinterpret_cast<const __ifunc_arg_t*>(arg2);
-    if (args->_hwcap2 & HWCAP2_MOPS) {
-      return __folly_memmove_aarch64_mops;
-    }
+decltype(&__folly_memmove) select_memmove(const folly::CpuFeatures& cpu) {
+  if (cpu.hwCaps.aarch64_mops()) {
+    return __folly_memmove_aarch64_mops;
   }
-#endif
 
-  if (hwcaps & HWCAP_SVE) {
+  if (cpu.hwCaps.aarch64_sve()) {
     return __folly_memmove_aarch64_sve;
   }
 
-  if (hwcaps & HWCAP_ASIMD) {
+  if (cpu.hwCaps.aarch64_asimd()) {
     return __folly_memmove_aarch64_simd;
   }
 
   return __folly_memmove_aarch64;
 }
 
-[[gnu::ifunc("__folly_detail_memcpy_resolve")]]
-void* __folly_memcpy(void* dst, const void* src, std::size_t size);
+} // namespace
 
-[[gnu::ifunc("__folly_detail_memmove_resolve")]]
-void* __folly_memmove(void* dst, const void* src, std::size_t size);
+FOLLY_CPU_DISPATCH(
+    __folly_memcpy,
+    select_memcpy,
+    (void* dst, const void* src, std::size_t size),
+    (dst, src, size));
+
+FOLLY_CPU_DISPATCH(
+    __folly_memmove,
+    select_memmove,
+    (void* dst, const void* src, std::size_t size),
+    (dst, src, size));
 
 #ifdef FOLLY_MEMCPY_IS_MEMCPY
 
+extern "C" {
+
 [[gnu::weak, gnu::alias("__folly_memcpy")]]
 void* memcpy(void* dst, const void* src, std::size_t size);
 
 [[gnu::weak, gnu::alias("__folly_memmove")]]
 void* memmove(void* dst, const void* src, std::size_t size);
 
-#endif
-
 } // extern "C"
 
+#endif
+
 #endif // defined(__linux__) && defined(__aarch64__)
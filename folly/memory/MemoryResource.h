@@ -30,3 +30,61 @@
 #endif
 
 #endif // FOLLY_HAS_MEMORY_RESOURCE
+
+#if FOLLY_HAS_MEMORY_RESOURCE
+
+#include <cstddef>
+
+#include <folly/lang/Align.h>
+
+namespace folly {
+
+/**
+ * A std::pmr::memory_resource that allocates from an arena, such as SysArena
+ * or RecyclingArena: any type with allocate(size) and deallocate(p, size)
+ * that aligns its allocations to alignof(std::max_align_t), which is their
+ * default.  The arena is not owned and must outlive the resource.
+ *
+ *   SysRecyclingArena arena;
+ *   ArenaMemoryResource<SysRecyclingArena> resource{arena};
+ *   std::pmr::vector<int> v{&resource};
+ *
+ * Allocations with a larger alignment are padded, and never passed back to
+ * the arena's deallocate().
+ */
+template <typename Arena>
+class ArenaMemoryResource : public std::pmr::memory_resource {
+ public:
+  explicit ArenaMemoryResource(Arena& arena) noexcept : arena_{&arena} {}
+
+  Arena& arena() const noexcept { return *arena_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (alignment <= alignof(std::max_align_t)) {
+      return arena_->allocate(bytes);
+    }
+    return align_ceil(
+        static_cast<char*>(arena_->allocate(bytes + alignment - 1)),
+        alignment);
+  }
+
+  void do_deallocate(
+      void* p, std::size_t bytes, std::size_t alignment) override {
+    if (alignment <= alignof(std::max_align_t)) {
+      arena_->deallocate(p, bytes);
+    }
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    auto resource = dynamic_cast<const ArenaMemoryResource*>(&other);
+    return resource != nullptr && resource->arena_ == arena_;
+  }
+
+  Arena* arena_;
+};
+
+} // namespace folly
+
+#endif // FOLLY_HAS_MEMORY_RESOURCE
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <folly/Likely.h>
+#include <folly/Memory.h>
+#include <folly/lang/Align.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+
+/**
+ * Recycling arena: an Arena whose freed memory is reused.
+ *
+ * Arena never reuses memory until it is destroyed (or clear()ed), so a
+ * long-lived arena that backs containers which grow and shrink keeps growing
+ * too.  RecyclingArena keeps one free list per size class for allocations of
+ * up to kMaxSizeClass bytes: deallocate() pushes the memory on the free list
+ * of its size class and the next allocation of that class pops it.  Larger
+ * allocations are served by the underlying Arena as usual, and are only
+ * released by reset().
+ *
+ * reset() releases everything at once while keeping the arena's blocks, so a
+ * RecyclingArena that is reset at the end of each request serves the
+ * allocations of the following requests without calling the underlying
+ * allocator at all once it has warmed up.
+ *
+ * Like Arena, RecyclingArena is not thread-safe: use one per thread, or per
+ * request.  Unlike Arena, deallocate() must be called with the size that was
+ * passed to allocate().
+ */
+template <class Alloc>
+class RecyclingArena {
+ public:
+  // Allocations are rounded up to a multiple of kSizeClassGranularity, which
+  // is also their alignment.
+  static constexpr size_t kSizeClassGranularity = max_align_v;
+  static constexpr size_t kMaxSizeClass = 1024;
+  static constexpr size_t kNumSizeClasses =
+      kMaxSizeClass / kSizeClassGranularity;
+  static constexpr size_t kDefaultMinBlockSize =
+      Arena<Alloc>::kDefaultMinBlockSize;
+  static constexpr size_t kNoSizeLimit = Arena<Alloc>::kNoSizeLimit;
+
+  explicit RecyclingArena(
+      const Alloc& alloc,
+      size_t minBlockSize = kDefaultMinBlockSize,
+      size_t sizeLimit = kNoSizeLimit)
+      : arena_(alloc, minBlockSize, sizeLimit, kSizeClassGranularity) {}
+
+  void* allocate(size_t size) {
+    if (FOLLY_UNLIKELY(size > kMaxSizeClass)) {
+      bytesUsed_ += size;
+      return arena_.allocate(size);
+    }
+    auto sizeClass = sizeClassOf(size);
+    bytesUsed_ += classSize(sizeClass);
+    FreeNode* node = freeLists_[sizeClass];
+    if (FOLLY_LIKELY(node != nullptr)) {
+      freeLists_[sizeClass] = node->next;
+      return node;
+    }
+    return arena_.allocate(classSize(sizeClass));
+  }
+
+  void deallocate(void* p, size_t size) {
+    if (FOLLY_UNLIKELY(size > kMaxSizeClass)) {
+      // Large allocations are not recycled until reset().
+      bytesUsed_ -= size;
+      return;
+    }
+    auto sizeClass = sizeClassOf(size);
+    bytesUsed_ -= classSize(sizeClass);
+    auto node = static_cast<FreeNode*>(p);
+    node->next = freeLists_[sizeClass];
+    freeLists_[sizeClass] = node;
+  }
+
+  // Release all the allocations, keeping the memory for future ones (except
+  // for allocations larger than the minimum block size, which are freed).
+  void reset() {
+    freeLists_.fill(nullptr);
+    bytesUsed_ = 0;
+    arena_.clear();
+  }
+
+  // Gets the total memory used by the arena
+  size_t totalSize() const {
+    return arena_.totalSize() - sizeof(arena_) + sizeof(RecyclingArena);
+  }
+
+  // Gets the number of bytes currently allocated, rounded up to their size
+  // classes.  Unlike Arena::bytesUsed(), this decreases on deallocate().
+  size_t bytesUsed() const { return bytesUsed_; }
+
+  // not copyable or movable
+  RecyclingArena(const RecyclingArena&) = delete;
+  RecyclingArena& operator=(const RecyclingArena&) = delete;
+  RecyclingArena(RecyclingArena&&) = delete;
+  RecyclingArena& operator=(RecyclingArena&&) = delete;
+
+ private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+  static_assert(sizeof(FreeNode) <= kSizeClassGranularity, "");
+
+  static size_t sizeClassOf(size_t size) {
+    // Zero sized allocations share the smallest size class.
+    return size == 0 ? 0 : (size - 1) / kSizeClassGranularity;
+  }
+
+  static size_t classSize(size_t sizeClass) {
+    return (sizeClass + 1) * kSizeClassGranularity;
+  }
+
+  Arena<Alloc> arena_;
+  std::array<FreeNode*, kNumSizeClasses> freeLists_{};
+  size_t bytesUsed_{0};
+};
+
+/**
+ * RecyclingArena that uses the system allocator (malloc / free)
+ */
+class SysRecyclingArena : public RecyclingArena<SysAllocator<char>> {
+ public:
+  explicit SysRecyclingArena(
+      size_t minBlockSize = kDefaultMinBlockSize,
+      size_t sizeLimit = kNoSizeLimit)
+      : RecyclingArena<SysAllocator<char>>({}, minBlockSize, sizeLimit) {}
+};
+
+template <typename T, typename Alloc>
+using RecyclingArenaAllocator = CxxAllocatorAdaptor<T, RecyclingArena<Alloc>>;
+
+template <typename T>
+using SysRecyclingArenaAllocator =
+    RecyclingArenaAllocator<T, SysAllocator<char>>;
+
+} // namespace folly
@@ -16,6 +16,8 @@
 
 #include <folly/memory/MemoryResource.h>
 
+#include <folly/memory/Arena.h>
+#include <folly/memory/RecyclingArena.h>
 #include <folly/portability/GTest.h>
 
 #if FOLLY_HAS_MEMORY_RESOURCE
@@ -27,4 +29,33 @@ TEST(MemoryResource, simple) {
   EXPECT_THROW(v.push_back('x'), std::bad_alloc);
 }
 
+TEST(MemoryResource, arena) {
+  folly::SysRecyclingArena arena;
+  folly::ArenaMemoryResource<folly::SysRecyclingArena> resource{arena};
+  {
+    std::pmr::vector<int> v{&resource};
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    EXPECT_GT(arena.bytesUsed(), 0);
+  }
+  EXPECT_EQ(0, arena.bytesUsed());
+
+  folly::ArenaMemoryResource<folly::SysRecyclingArena> same{arena};
+  EXPECT_TRUE(resource.is_equal(same));
+  folly::SysRecyclingArena otherArena;
+  folly::ArenaMemoryResource<folly::SysRecyclingArena> other{otherArena};
+  EXPECT_FALSE(resource.is_equal(other));
+}
+
+TEST(MemoryResource, arenaOverAligned) {
+  folly::SysArena arena;
+  folly::ArenaMemoryResource<folly::SysArena> resource{arena};
+  for (size_t align = 1; align <= 4096; align *= 2) {
+    void* p = resource.allocate(10, align);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % align);
+    resource.deallocate(p, 10, align);
+  }
+}
+
 #endif // FOLLY_HAS_MEMORY_RESOURCE
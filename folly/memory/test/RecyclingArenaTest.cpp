@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/memory/RecyclingArena.h>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+static_assert(
+    !AllocatorHasTrivialDeallocate<SysRecyclingArenaAllocator<int>>::value,
+    "");
+
+TEST(RecyclingArena, reuseSizeClass) {
+  SysRecyclingArena arena;
+  void* p = arena.allocate(24);
+  constexpr auto kAlign = SysRecyclingArena::kSizeClassGranularity;
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % kAlign);
+  EXPECT_EQ(32, arena.bytesUsed());
+  arena.deallocate(p, 24);
+  EXPECT_EQ(0, arena.bytesUsed());
+
+  // Same size class
+  EXPECT_EQ(p, arena.allocate(17));
+  // Different size class
+  void* q = arena.allocate(64);
+  EXPECT_NE(p, q);
+  arena.deallocate(q, 64);
+  EXPECT_EQ(q, arena.allocate(50));
+}
+
+TEST(RecyclingArena, noGrowthWhenRecycling) {
+  SysRecyclingArena arena;
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < 1000; ++i) {
+    ptrs.push_back(arena.allocate(i % 200));
+  }
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    arena.deallocate(ptrs[i], i % 200);
+  }
+  EXPECT_EQ(0, arena.bytesUsed());
+  auto totalSize = arena.totalSize();
+
+  for (int round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      ptrs[i] = arena.allocate(i % 200);
+    }
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      arena.deallocate(ptrs[i], i % 200);
+    }
+  }
+  EXPECT_EQ(totalSize, arena.totalSize());
+}
+
+TEST(RecyclingArena, noOverlap) {
+  SysRecyclingArena arena;
+  std::map<char*, size_t> live;
+  for (size_t i = 0; i < 5000; ++i) {
+    size_t size = (i * 7919) % 1500;
+    if (i % 3 == 2 && !live.empty()) {
+      auto it = live.begin();
+      arena.deallocate(it->first, it->second);
+      live.erase(it);
+    }
+    auto p = static_cast<char*>(arena.allocate(size));
+    std::memset(p, 0xff, size);
+    live.emplace(p, size);
+  }
+  char* end = nullptr;
+  for (const auto& [p, size] : live) {
+    EXPECT_LE(end, p);
+    end = p + size;
+  }
+}
+
+TEST(RecyclingArena, largeAllocations) {
+  SysRecyclingArena arena;
+  auto size = SysRecyclingArena::kMaxSizeClass + 1;
+  void* p = arena.allocate(size);
+  EXPECT_GE(arena.bytesUsed(), size);
+  arena.deallocate(p, size);
+  EXPECT_EQ(0, arena.bytesUsed());
+  // Not recycled
+  EXPECT_NE(p, arena.allocate(size));
+}
+
+TEST(RecyclingArena, reset) {
+  SysRecyclingArena arena;
+  std::set<void*> first;
+  for (int i = 0; i < 1000; ++i) {
+    first.insert(arena.allocate(100));
+  }
+  auto totalSize = arena.totalSize();
+
+  arena.reset();
+  EXPECT_EQ(0, arena.bytesUsed());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(1, first.count(arena.allocate(100)));
+  }
+  EXPECT_EQ(totalSize, arena.totalSize());
+}
+
+TEST(RecyclingArena, allocator) {
+  SysRecyclingArena arena;
+  {
+    std::vector<int, SysRecyclingArenaAllocator<int>> v{
+        SysRecyclingArenaAllocator<int>(arena)};
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    EXPECT_GT(arena.bytesUsed(), 0);
+  }
+  EXPECT_EQ(0, arena.bytesUsed());
+}
@@ -283,6 +283,13 @@ struct TcpInfo {
   explicit TcpInfo(const tcp_info& tInfo)
       : tcpInfo(tInfo), tcpInfoBytesRead{sizeof(TcpInfo::tcp_info)} {}
 
+  /**
+   * Initializes from a tcp_info struct of which the kernel only filled the
+   * first bytesRead bytes, e.g. from an INET_DIAG_INFO netlink attribute.
+   */
+  TcpInfo(const tcp_info& tInfo, int bytesRead)
+      : tcpInfo(tInfo), tcpInfoBytesRead{bytesRead} {}
+
   /**
    * Returns pointer containing requested field from tcp_info struct.
    *
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/net/TcpInfoSampler.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <folly/Random.h>
+#include <folly/portability/SysStat.h>
+#include <folly/portability/Unistd.h>
+
+#if defined(__linux__) && defined(FOLLY_HAVE_TCP_INFO)
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <sys/socket.h>
+
+#define FOLLY_TCP_INFO_SAMPLER_SUPPORTED 1
+#endif
+
+namespace folly {
+
+TcpInfoSampler::TcpInfoSampler(Options options)
+    : options_(std::move(options)) {}
+
+TcpInfoSampler::~TcpInfoSampler() {
+  if (netlinkFd_ >= 0) {
+    ::close(netlinkFd_);
+  }
+}
+
+namespace {
+
+Optional<uint64_t> socketInode(NetworkSocket fd) {
+  struct stat st;
+  if (fd == NetworkSocket() || ::fstat(fd.toFd(), &st) != 0) {
+    return none;
+  }
+  return uint64_t(st.st_ino);
+}
+
+} // namespace
+
+bool TcpInfoSampler::add(NetworkSocket fd) {
+  auto inode = socketInode(fd);
+  if (!inode) {
+    return false;
+  }
+  sockets_.insert_or_assign(*inode, fd);
+  return true;
+}
+
+void TcpInfoSampler::remove(NetworkSocket fd) {
+  if (auto inode = socketInode(fd)) {
+    sockets_.erase(*inode);
+    return;
+  }
+  // The fd was closed already.
+  for (auto it = sockets_.begin(); it != sockets_.end();) {
+    if (it->second == fd) {
+      it = sockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+Expected<size_t, std::errc> TcpInfoSampler::sample(Callback cb) {
+#ifdef FOLLY_TCP_INFO_SAMPLER_SUPPORTED
+  if (netlinkFd_ < 0) {
+    netlinkFd_ =
+        ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (netlinkFd_ < 0) {
+      return makeUnexpected(static_cast<std::errc>(errno));
+    }
+  }
+  size_t reported = 0;
+  for (int family : {AF_INET, AF_INET6}) {
+    auto n = dump(family, cb);
+    if (n.hasError()) {
+      return n;
+    }
+    reported += *n;
+  }
+  return reported;
+#else
+  (void)cb;
+  return makeUnexpected(std::errc::operation_not_supported);
+#endif
+}
+
+Expected<size_t, std::errc> TcpInfoSampler::dump(int family, Callback cb) {
+#ifdef FOLLY_TCP_INFO_SAMPLER_SUPPORTED
+  struct {
+    nlmsghdr header;
+    inet_diag_req_v2 request;
+  } req{};
+  req.header.nlmsg_len = sizeof(req);
+  req.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  req.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.header.nlmsg_seq = ++seq_;
+  req.request.sdiag_family = uint8_t(family);
+  req.request.sdiag_protocol = IPPROTO_TCP;
+  req.request.idiag_ext = 1 << (INET_DIAG_INFO - 1);
+  req.request.idiag_states = options_.states;
+
+  sockaddr_nl kernel{};
+  kernel.nl_family = AF_NETLINK;
+  if (::sendto(
+          netlinkFd_,
+          &req,
+          sizeof(req),
+          0,
+          reinterpret_cast<sockaddr*>(&kernel),
+          sizeof(kernel)) < 0) {
+    return makeUnexpected(static_cast<std::errc>(errno));
+  }
+
+  const bool everySocket = options_.sampleRate >= 1.0;
+  size_t reported = 0;
+  // Each recv() returns as many whole messages as fit.
+  alignas(nlmsghdr) char buf[64 * 1024];
+  while (true) {
+    auto len = ::recv(netlinkFd_, buf, sizeof(buf), 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return makeUnexpected(static_cast<std::errc>(errno));
+    }
+    auto size = static_cast<unsigned int>(len);
+    for (auto* header = reinterpret_cast<nlmsghdr*>(buf);
+         NLMSG_OK(header, size);
+         header = NLMSG_NEXT(header, size)) {
+      if (header->nlmsg_seq != seq_) {
+        continue;
+      }
+      if (header->nlmsg_type == NLMSG_DONE) {
+        return reported;
+      }
+      if (header->nlmsg_type == NLMSG_ERROR) {
+        auto* error = static_cast<nlmsgerr*>(NLMSG_DATA(header));
+        return makeUnexpected(static_cast<std::errc>(-error->error));
+      }
+      auto* msg = static_cast<inet_diag_msg*>(NLMSG_DATA(header));
+      auto it = sockets_.find(msg->idiag_inode);
+      if (it == sockets_.end() ||
+          (!everySocket && Random::randDouble01() >= options_.sampleRate)) {
+        continue;
+      }
+      auto attrLen = header->nlmsg_len - NLMSG_LENGTH(sizeof(*msg));
+      for (auto* attr = reinterpret_cast<rtattr*>(msg + 1);
+           RTA_OK(attr, attrLen);
+           attr = RTA_NEXT(attr, attrLen)) {
+        if (attr->rta_type != INET_DIAG_INFO) {
+          continue;
+        }
+        TcpInfo::tcp_info info{};
+        auto infoLen = std::min<size_t>(RTA_PAYLOAD(attr), sizeof(info));
+        std::memcpy(&info, RTA_DATA(attr), infoLen);
+        cb(it->second, TcpInfo(info, int(infoLen)));
+        ++reported;
+        break;
+      }
+    }
+  }
+#else
+  (void)family;
+  (void)cb;
+  return makeUnexpected(std::errc::operation_not_supported);
+#endif
+}
+
+} // namespace folly
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <system_error>
+
+#include <folly/Expected.h>
+#include <folly/Function.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/net/NetworkSocket.h>
+#include <folly/net/TcpInfo.h>
+
+namespace folly {
+
+/**
+ * Samples the TCP_INFO of many sockets at once.
+ *
+ * TcpInfo::initFromFd() costs a getsockopt() per socket. Instead, sample()
+ * asks the kernel for a dump of the TCP sockets of the host over a
+ * NETLINK_SOCK_DIAG socket (the INET_DIAG interface used by ss), which
+ * returns the tcp_info of hundreds of sockets per recv(), and reports the
+ * sockets that were added to the sampler.
+ *
+ * Sockets are matched by inode, so a socket that was closed without being
+ * removed is just not reported anymore, even if its fd is reused. Users of
+ * AsyncSocket add getNetworkSocket() when the socket connects, and map the
+ * NetworkSocket back to their AsyncSocket in the callback, e.g. with a map
+ * of their own.
+ *
+ * add() and remove() may be called from any thread, including concurrently
+ * with sample(); sample() must not be called concurrently with itself.
+ *
+ * Only available on Linux: elsewhere sample() fails with
+ * std::errc::operation_not_supported.
+ */
+class TcpInfoSampler {
+ public:
+  struct Options {
+    Options() {}
+    // Fraction of the matching sockets reported by each sample(), chosen at
+    // random.
+    double sampleRate{1.0};
+    // Bitmask of the TCP states (1 << TCP_ESTABLISHED, ...) of the sockets
+    // to dump, ESTABLISHED only by default.
+    uint32_t states{1u << 1};
+  };
+
+  using Callback = FunctionRef<void(NetworkSocket, const TcpInfo&)>;
+
+  explicit TcpInfoSampler(Options options = Options());
+  ~TcpInfoSampler();
+
+  TcpInfoSampler(const TcpInfoSampler&) = delete;
+  TcpInfoSampler& operator=(const TcpInfoSampler&) = delete;
+
+  /**
+   * Adds a connected TCP socket. Returns false if its inode could not be
+   * determined.
+   */
+  bool add(NetworkSocket fd);
+
+  /**
+   * Removes a socket, before it is closed.
+   */
+  void remove(NetworkSocket fd);
+
+  size_t size() const { return sockets_.size(); }
+
+  /**
+   * Dumps the IPv4 and IPv6 TCP sockets of the host, and calls cb for the
+   * sampled sockets that were added. Returns the number of calls.
+   */
+  Expected<size_t, std::errc> sample(Callback cb);
+
+ private:
+  Expected<size_t, std::errc> dump(int family, Callback cb);
+
+  const Options options_;
+  // Inode of the socket -> fd.
+  ConcurrentHashMap<uint64_t, NetworkSocket> sockets_;
+  // NETLINK_SOCK_DIAG socket, opened on the first sample().
+  int netlinkFd_{-1};
+  uint32_t seq_{0};
+};
+
+} // namespace folly
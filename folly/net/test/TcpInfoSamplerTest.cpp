@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/net/TcpInfoSampler.h>
+
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/SocketAddress.h>
+#include <folly/net/NetOps.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// A connected pair of TCP sockets on the loopback interface.
+struct Connection {
+  Connection() {
+    auto listener = netops::socket(AF_INET, SOCK_STREAM, 0);
+    SocketAddress addr("127.0.0.1", 0);
+    sockaddr_storage storage;
+    auto len = addr.getAddress(&storage);
+    CHECK_EQ(0, netops::bind(listener, (sockaddr*)&storage, len));
+    CHECK_EQ(0, netops::listen(listener, 1));
+    addr.setFromLocalAddress(listener);
+    len = addr.getAddress(&storage);
+    client = netops::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_EQ(0, netops::connect(client, (sockaddr*)&storage, len));
+    server = netops::accept(listener, nullptr, nullptr);
+    netops::close(listener);
+  }
+
+  ~Connection() {
+    netops::close(client);
+    netops::close(server);
+  }
+
+  NetworkSocket client;
+  NetworkSocket server;
+};
+
+} // namespace
+
+TEST(TcpInfoSamplerTest, Sample) {
+  Connection conn;
+  char data[1000] = {};
+  ASSERT_EQ(sizeof(data), netops::send(conn.client, data, sizeof(data), 0));
+
+  TcpInfoSampler sampler;
+  EXPECT_TRUE(sampler.add(conn.client));
+  EXPECT_FALSE(sampler.add(NetworkSocket()));
+  EXPECT_EQ(1, sampler.size());
+
+  std::vector<NetworkSocket> sockets;
+  Optional<uint64_t> bytesAcked;
+  auto n = sampler.sample([&](NetworkSocket fd, const TcpInfo& info) {
+    sockets.push_back(fd);
+    bytesAcked = info.bytesAcked();
+  });
+  if (!kIsLinux) {
+    EXPECT_EQ(std::errc::operation_not_supported, n.error());
+    return;
+  }
+  ASSERT_TRUE(n.hasValue()) << std::make_error_code(n.error()).message();
+  EXPECT_EQ(1, *n);
+  ASSERT_EQ(1, sockets.size());
+  EXPECT_EQ(conn.client, sockets[0]);
+  // The SYN is acked as well.
+  EXPECT_LE(bytesAcked.value_or(sizeof(data)), sizeof(data) + 1);
+
+  sampler.add(conn.server);
+  sockets.clear();
+  EXPECT_EQ(2, sampler.sample([&](NetworkSocket fd, const TcpInfo&) {
+    sockets.push_back(fd);
+  }).value());
+  EXPECT_EQ(2, sockets.size());
+
+  sampler.remove(conn.client);
+  sampler.remove(conn.server);
+  EXPECT_EQ(0, sampler.size());
+  EXPECT_EQ(0, sampler.sample([](NetworkSocket, const TcpInfo&) {}).value());
+}
+
+TEST(TcpInfoSamplerTest, SampleRate) {
+  if (!kIsLinux) {
+    GTEST_SKIP() << "TcpInfoSampler requires Linux";
+  }
+  Connection conn;
+  TcpInfoSampler::Options options;
+  options.sampleRate = 0;
+  TcpInfoSampler sampler(options);
+  sampler.add(conn.client);
+  EXPECT_EQ(0, sampler.sample([](NetworkSocket, const TcpInfo&) {}).value());
+}
+
+TEST(TcpInfoSamplerTest, RemoveClosed) {
+  TcpInfoSampler sampler;
+  auto fd = netops::socket(AF_INET, SOCK_STREAM, 0);
+  EXPECT_TRUE(sampler.add(fd));
+  netops::close(fd);
+  sampler.remove(fd);
+  EXPECT_EQ(0, sampler.size());
+}
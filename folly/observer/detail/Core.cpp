@@ -90,6 +90,11 @@ size_t Core::refresh(size_t version) {
     }
 
     try {
+      auto const start = std::chrono::steady_clock::now();
+      SCOPE_EXIT {
+        ObserverManager::recordRefresh(
+            std::chrono::steady_clock::now() - start);
+      };
       VersionedData newData{
           creator_(), version, std::chrono::system_clock::now()};
       if (!newData.data) {
@@ -148,6 +153,16 @@ void Core::setForceRefresh() {
   forceRefresh_ = true;
 }
 
+bool Core::tryMarkRefreshScheduled(size_t version) {
+  auto scheduled = versionScheduled_.load();
+  do {
+    if (scheduled >= version) {
+      return false;
+    }
+  } while (!versionScheduled_.compare_exchange_weak(scheduled, version));
+  return true;
+}
+
 Core::Core(
     folly::Function<std::shared_ptr<const void>()> creator,
     CreatorContext creatorContext)
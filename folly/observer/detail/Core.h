@@ -124,6 +124,14 @@ class Core : public std::enable_shared_from_this<Core> {
    */
   void setForceRefresh();
 
+  /**
+   * Records that a refresh to at least the given version is scheduled. Returns
+   * false if one already was, so that scheduling another would be redundant.
+   *
+   * This should be only called from ObserverManager.
+   */
+  bool tryMarkRefreshScheduled(size_t version);
+
   const CreatorContext& getCreatorContext() const { return creatorContext_; }
 
   ~Core();
@@ -147,6 +155,7 @@ class Core : public std::enable_shared_from_this<Core> {
 
   std::atomic<size_t> version_{0};
   std::atomic<size_t> versionLastChange_{0};
+  std::atomic<size_t> versionScheduled_{0};
 
   folly::Synchronized<VersionedData> data_;
 
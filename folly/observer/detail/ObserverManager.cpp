@@ -16,6 +16,7 @@
 
 #include <folly/observer/detail/ObserverManager.h>
 
+#include <chrono>
 #include <future>
 
 #include <folly/ExceptionString.h>
@@ -47,6 +48,20 @@ auto& currentQueue() {
   return *instance;
 }
 
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void updateMax(std::atomic<int64_t>& max, int64_t value) {
+  auto current = max.load(std::memory_order_relaxed);
+  while (current < value &&
+         !max.compare_exchange_weak(
+             current, value, std::memory_order_relaxed)) {
+  }
+}
+
 auto& nextQueue() {
   static folly::Indestructible<UMPSCQueue<Function<Core::Ptr()>, true>>
       instance;
@@ -137,8 +152,12 @@ class ObserverManager::UpdatesManager::NextQueueProcessor {
           ++manager.version_;
         }
 
-        for (auto& core : cores) {
-          manager.scheduleRefresh(std::move(core), manager.version_);
+        if (!cores.empty()) {
+          manager.beginVersion();
+          for (auto& core : cores) {
+            manager.scheduleRefresh(std::move(core), manager.version_);
+          }
+          manager.finishRefresh();
         }
 
         {
@@ -196,6 +215,51 @@ void ObserverManager::scheduleNext(Function<Core::Ptr()> coreFunc) {
   getUpdatesManager();
 }
 
+void ObserverManager::beginVersion() {
+  versions_.fetch_add(1, std::memory_order_relaxed);
+  versionBegin_.store(nowNs());
+  // Held until all the cores are scheduled, so that the version doesn't look
+  // done after the refresh of the first one.
+  pendingRefreshes_.fetch_add(1);
+}
+
+void ObserverManager::finishRefresh() {
+  if (pendingRefreshes_.fetch_sub(1) != 1) {
+    return;
+  }
+  if (auto const begin = versionBegin_.exchange(0)) {
+    auto const latency = nowNs() - begin;
+    lastVersionLatency_.store(latency, std::memory_order_relaxed);
+    updateMax(maxVersionLatency_, latency);
+  }
+}
+
+void ObserverManager::recordRefresh(std::chrono::nanoseconds time) {
+  auto& instance = getInstance();
+  instance.refreshes_.fetch_add(1, std::memory_order_relaxed);
+  instance.refreshTime_.fetch_add(time.count(), std::memory_order_relaxed);
+  updateMax(instance.maxRefreshTime_, time.count());
+}
+
+ObserverManager::Stats ObserverManager::getStats() {
+  auto& instance = getInstance();
+  auto const load = [](const auto& counter) {
+    return counter.load(std::memory_order_relaxed);
+  };
+  Stats stats;
+  stats.versions = load(instance.versions_);
+  stats.refreshes = load(instance.refreshes_);
+  stats.refreshTime = std::chrono::nanoseconds(load(instance.refreshTime_));
+  stats.maxRefreshTime =
+      std::chrono::nanoseconds(load(instance.maxRefreshTime_));
+  stats.coalescedRefreshes = load(instance.coalescedRefreshes_);
+  stats.lastVersionLatency =
+      std::chrono::nanoseconds(load(instance.lastVersionLatency_));
+  stats.maxVersionLatency =
+      std::chrono::nanoseconds(load(instance.maxVersionLatency_));
+  return stats;
+}
+
 bool ObserverManager::tryWaitForAllUpdatesImpl(TryWaitForAllUpdatesImplOp op) {
   if (auto updatesManager = getUpdatesManager()) {
     return updatesManager->tryWaitForAllUpdatesImpl(op);
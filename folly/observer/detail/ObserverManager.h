@@ -52,6 +52,12 @@ namespace observer_detail {
  * version is bumped and all updates from the ObserverManager::NextQueue are
  * performed. If leaf Observer gets updated more then once before being picked
  * from the ObserverManager::NextQueue, then only the last update is processed.
+ *
+ * An Observer is added to ObserverManager::CurrentQueue at most once per
+ * version, however many of its dependencies were updated: it pulls all of them
+ * when it's refreshed, so the other refreshes would find it up to date.
+ * Observers which don't depend on each other are refreshed in parallel, on the
+ * --observer_manager_pool_size threads.
  */
 class ObserverManager {
  public:
@@ -68,12 +74,21 @@ class ObserverManager {
 
     auto& instance = getInstance();
 
+    if (!core->tryMarkRefreshScheduled(minVersion)) {
+      instance.coalescedRefreshes_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
     std::shared_lock rh(instance.versionMutex_);
 
+    instance.pendingRefreshes_.fetch_add(1);
     instance.scheduleCurrent(
         [coreWeak = folly::to_weak_ptr(std::move(core)),
          &instance,
          rh_2 = std::move(rh)]() {
+          SCOPE_EXIT {
+            instance.finishRefresh();
+          };
           if (auto coreShared = coreWeak.lock()) {
             coreShared->refresh(instance.version_);
           }
@@ -124,6 +139,29 @@ class ObserverManager {
     });
   }
 
+  struct Stats {
+    // The versions bumped for updates of Observables.
+    size_t versions{0};
+    // The runs of the Observer creators, and the time they took. A creator
+    // which pulls the refresh of a dependency includes its time.
+    size_t refreshes{0};
+    std::chrono::nanoseconds refreshTime{0};
+    std::chrono::nanoseconds maxRefreshTime{0};
+    // The refreshes not scheduled, as one to the same version was already.
+    size_t coalescedRefreshes{0};
+    // The time from bumping a version to having refreshed all the Observers
+    // it affects, for the last version and at most.
+    std::chrono::nanoseconds lastVersionLatency{0};
+    std::chrono::nanoseconds maxVersionLatency{0};
+  };
+
+  /**
+   * Returns the counters of the refreshes since the start of the process.
+   */
+  static Stats getStats();
+
+  static void recordRefresh(std::chrono::nanoseconds time);
+
   class DependencyRecorder {
    public:
     using DependencySet = std::unordered_set<Core::Ptr>;
@@ -221,6 +259,9 @@ class ObserverManager {
   void scheduleCurrent(Function<void()>);
   void scheduleNext(Function<Core::Ptr()>);
 
+  void beginVersion();
+  void finishRefresh();
+
   class UpdatesManager {
    public:
     UpdatesManager();
@@ -251,6 +292,18 @@ class ObserverManager {
   mutable SharedMutexReadPriority versionMutex_;
   std::atomic<size_t> version_{1};
 
+  // Counters of getStats(). The refreshes scheduled for the current version
+  // are pending, and the version began at versionBegin_ until they are done.
+  std::atomic<size_t> versions_{0};
+  std::atomic<size_t> refreshes_{0};
+  std::atomic<int64_t> refreshTime_{0};
+  std::atomic<int64_t> maxRefreshTime_{0};
+  std::atomic<size_t> coalescedRefreshes_{0};
+  std::atomic<size_t> pendingRefreshes_{0};
+  std::atomic<int64_t> versionBegin_{0};
+  std::atomic<int64_t> lastVersionLatency_{0};
+  std::atomic<int64_t> maxVersionLatency_{0};
+
   using CycleDetector = GraphCycleDetector<const Core*>;
   folly::Synchronized<CycleDetector, std::mutex> cycleDetector_;
 };
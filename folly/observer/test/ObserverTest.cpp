@@ -18,6 +18,7 @@
 #include <chrono>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <utility>
 #include <folly/Demangle.h>
@@ -510,6 +511,45 @@ TEST(Observer, WaitForAllUpdates) {
   folly::observer_detail::ObserverManager::waitForAllUpdates();
 }
 
+TEST(Observer, CoalescedRefreshes) {
+  using folly::observer_detail::ObserverManager;
+
+  SimpleObservable<int> observable(0);
+  std::vector<Observer<int>> observers;
+  for (int i = 0; i < 100; ++i) {
+    observers.push_back(makeObserver(
+        [i, o = observable.getObserver()] { return **o + i; }));
+  }
+  std::atomic<size_t> sumRefreshes{0};
+  auto sum = makeObserver([observers, &sumRefreshes] {
+    ++sumRefreshes;
+    int sum = 0;
+    for (auto& observer : observers) {
+      sum += **observer;
+    }
+    return sum;
+  });
+  EXPECT_EQ(4950, **sum);
+  EXPECT_EQ(1, sumRefreshes);
+
+  auto const before = ObserverManager::getStats();
+  observable.setValue(1);
+  ObserverManager::waitForAllUpdates();
+  auto const after = ObserverManager::getStats();
+
+  EXPECT_EQ(5050, **sum);
+  // sum is scheduled by each of the observers it depends on, and refreshed
+  // once.
+  EXPECT_EQ(2, sumRefreshes);
+  EXPECT_GT(after.coalescedRefreshes, before.coalescedRefreshes);
+  EXPECT_EQ(before.versions + 1, after.versions);
+  EXPECT_GE(after.refreshes - before.refreshes, 101);
+  EXPECT_GT(after.refreshTime, before.refreshTime);
+  EXPECT_GE(after.maxRefreshTime, before.maxRefreshTime);
+  EXPECT_GT(after.lastVersionLatency.count(), 0);
+  EXPECT_GE(after.maxVersionLatency, after.lastVersionLatency);
+}
+
 TEST(Observer, IgnoreUpdates) {
   int callbackCalled = 0;
   folly::observer::SimpleObservable<int> observable(42);
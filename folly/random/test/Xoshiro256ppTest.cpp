@@ -304,6 +304,23 @@ TEST(Xoshiro256ppTest, StdLibCompatibility) {
   }
 }
 
+// Test that fill() gives the outputs of as many calls, across the blocks
+TEST(Xoshiro256ppTest, FillMatchesCalls) {
+  constexpr uint64_t kTestSeed = 0x1234567890ABCDEF;
+  xoshiro256pp_64 filled(kTestSeed);
+  xoshiro256pp_64 called(kTestSeed);
+
+  std::vector<uint64_t> values;
+  for (size_t n : {0, 1, 5, 32, 100, 3, 64, 1000}) {
+    values.assign(n, 0);
+    filled.fill(values.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+      ASSERT_EQ(called(), values[i]) << n << ' ' << i;
+    }
+  }
+  EXPECT_EQ(called(), filled());
+}
+
 // Helper function for random resizing of vectors using xoshiro256pp as RNG
 template <typename T, typename RNG>
 void random_resize(std::vector<T>& collection, size_t max, RNG&& rng) {
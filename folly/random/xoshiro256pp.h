@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <random>
 
@@ -58,6 +60,29 @@ class xoshiro256pp {
   }
 
   result_type operator()() noexcept { return next(); }
+
+  /**
+   * Writes the next n outputs to out, as n calls would, but copies them by
+   * whole blocks of lanes rather than one at a time.
+   */
+  void fill(result_type* out, size_t n) noexcept {
+    auto const buffered = std::min<size_t>(n, ResultCount - cur);
+    std::memcpy(out, res + cur, buffered * sizeof(result_type));
+    cur += buffered;
+    out += buffered;
+    n -= buffered;
+    for (; n >= ResultCount; n -= ResultCount, out += ResultCount) {
+      calc();
+      std::memcpy(out, res, sizeof(res));
+      cur = ResultCount;
+    }
+    if (n > 0) {
+      calc();
+      std::memcpy(out, res, n * sizeof(result_type));
+      cur = n;
+    }
+  }
+
   static constexpr result_type min() noexcept {
     return std::numeric_limits<result_type>::min();
   }
@@ -85,6 +110,9 @@ class xoshiro256pp {
  private:
 #if defined(__AVX2__) && defined(__GNUC__)
   using vector_type = __v4du; // GCC-specific unsigned vector type
+#elif defined(__ARM_NEON) && defined(__GNUC__)
+  // Lowered to pairs of NEON registers.
+  typedef uint64_t vector_type __attribute__((vector_size(32)));
 #else
   using vector_type = uint64_t; // Fallback for other compilers
 #endif
@@ -150,12 +150,18 @@ class non_value_result {
     return folly::get_exception<Ex>(ew);
   }
 
+  // The stopped state shares one immortal `OperationCancelled`, so stopping
+  // neither allocates nor constructs an exception, and `has_stopped()` is
+  // usually a pointer comparison.
+  static const std::exception_ptr& stopped_exception_ptr() {
+    return static_exception_ptr<OperationCancelled>();
+  }
+
  public:
   /// Future: Fine to make implicit if a good use-case arises.
-  explicit non_value_result(stopped_result_t)
-      : ew_(make_exception_wrapper<OperationCancelled>()) {}
+  explicit non_value_result(stopped_result_t) : ew_(stopped_exception_ptr()) {}
   non_value_result& operator=(stopped_result_t) {
-    ew_ = make_exception_wrapper<OperationCancelled>();
+    ew_ = exception_wrapper{stopped_exception_ptr()};
     return *this;
   }
 
@@ -174,7 +180,10 @@ class non_value_result {
         "your `result` or `non_value_result` via `stopped_result`");
   }
 
-  bool has_stopped() const { return ew_.get_exception<OperationCancelled>(); }
+  bool has_stopped() const {
+    return ew_.exception_ptr() == stopped_exception_ptr() ||
+        ew_.get_exception<OperationCancelled>();
+  }
 
   // Implement the `folly::get_exception<Ex>(res)` protocol
   template <typename Ex>
@@ -18,7 +18,10 @@
 #include <folly/settings/Settings.h>
 
 #include <map>
+#include <mutex>
+#include <vector>
 
+#include <folly/Indestructible.h>
 #include <folly/Synchronized.h>
 
 namespace folly {
@@ -29,6 +32,14 @@ Synchronized<SettingsMap>& settingsMap() {
   return *map;
 }
 
+namespace {
+/* The registered settings by index, guarded by the settingsMap() lock */
+std::vector<SettingCoreBase*>& settingsByIndex() {
+  static Indestructible<std::vector<SettingCoreBase*>> settings;
+  return *settings;
+}
+} // namespace
+
 void registerSetting(SettingCoreBase& core) {
   if (core.meta().project.empty() ||
       core.meta().project.find('_') != std::string::npos) {
@@ -45,6 +56,10 @@ void registerSetting(SettingCoreBase& core) {
     throw std::logic_error("FOLLY_SETTING already exists: " + fullname);
   }
   mapPtr->emplace(std::move(fullname), &core);
+  core.index_ = settingsByIndex().size();
+  settingsByIndex().push_back(&core);
+  /* Makes the published SettingsView stale, as it lacks the setting */
+  nextGlobalVersion();
 }
 
 } // namespace detail
@@ -137,6 +152,7 @@ void Snapshot::forEachSetting(
 
 namespace detail {
 std::atomic<SettingCoreBase::Version> gGlobalVersion_;
+std::atomic<SettingsView*> gSettingsView{nullptr};
 
 auto& getSavedValuesMutex() {
   static Indestructible<SharedMutex> gSavedValuesMutex;
@@ -204,6 +220,38 @@ SnapshotBase::~SnapshotBase() {
   }
 }
 
+SettingsView* refreshSettingsView(hazptr_holder<>& holder) {
+  static Indestructible<std::mutex> refreshMutex;
+  std::unique_lock lg(*refreshMutex);
+  /* Only retired under refreshMutex, so safe to protect while holding it */
+  auto current = gSettingsView.load(std::memory_order_acquire);
+  if (current && current->version == gGlobalVersion_.load()) {
+    holder.reset_protection(current);
+    return current;
+  }
+
+  /* Each setting is read under its own lock, so retry until no update
+     happened meanwhile: then the contents are those of a single version */
+  auto view = std::make_unique<SettingsView>();
+  do {
+    view->version = gGlobalVersion_.load();
+    view->contents.clear();
+    settingsMap().withRLock([&](const auto&) {
+      view->contents.reserve(settingsByIndex().size());
+      for (auto core : settingsByIndex()) {
+        view->contents.push_back(core->getGlobalContents());
+      }
+    });
+  } while (view->version != gGlobalVersion_.load());
+
+  holder.reset_protection(view.get());
+  gSettingsView.store(view.get(), std::memory_order_release);
+  if (current) {
+    current->retire();
+  }
+  return view.release();
+}
+
 std::pair<std::string, std::string>
 SnapshotBase::SettingVisitorInfo::valueAndReason() const {
   return core_.getAsString(&snapshot_);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cassert>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -31,6 +32,7 @@ namespace folly {
 namespace settings {
 
 class Snapshot;
+class ReadSnapshot;
 namespace detail {
 
 /**
@@ -95,6 +97,12 @@ class SettingWrapper {
   std::conditional_t<IsSmallPOD<T>, T, const T&> value(
       const Snapshot& snapshot) const;
 
+  /**
+   * Returns the setting's value in the read snapshot. The returned reference
+   * is valid for the lifetime of the snapshot.
+   */
+  const T& value(const ReadSnapshot& snapshot) const;
+
   /**
    * Atomically updates the setting's current value. The next call to
    * operator*() will invalidate all references returned by previous calls to
@@ -145,6 +153,11 @@ class SettingWrapper {
    */
   std::string_view updateReason(const Snapshot& snapshot) const;
 
+  /**
+   * Returns the setting's update reason in the read snapshot.
+   */
+  std::string_view updateReason(const ReadSnapshot& snapshot) const;
+
   explicit SettingWrapper(SettingCore<T, Tag>& core) : core_(core) {}
 
  private:
@@ -456,6 +469,51 @@ class Snapshot final : public detail::SnapshotBase {
   friend class detail::SettingWrapper;
 };
 
+/**
+ * A consistent, read-only view of the global values of all settings, which is
+ * cheap to take and to read. Taking it protects the current values with a
+ * hazard pointer and checks their version, without locks; each read is then an
+ * index into an array. Reading many settings from one ReadSnapshot gives
+ * values of a single version, whatever updates happen meanwhile, which reading
+ * them one by one doesn't.
+ *
+ *   folly::settings::ReadSnapshot snapshot;
+ *   auto limit = FOLLY_SETTING(project, limit).value(snapshot);
+ *   auto& name = FOLLY_SETTING(project, name).value(snapshot);
+ *
+ * The first ReadSnapshot taken after an update collects the values anew,
+ * which locks and copies like Snapshot does, so this suits settings which are
+ * read much more often than updated. Unlike Snapshot, it can't be updated.
+ *
+ * A ReadSnapshot can't be used concurrently from different threads, but may
+ * be moved to another thread.
+ */
+class ReadSnapshot final {
+ public:
+  ReadSnapshot() : holder_(make_hazard_pointer<>()) {
+    view_ = holder_.protect(detail::gSettingsView);
+    if (FOLLY_UNLIKELY(
+            !view_ || view_->version != detail::gGlobalVersion_.load())) {
+      view_ = detail::refreshSettingsView(holder_);
+    }
+  }
+
+ private:
+  template <typename T, std::atomic<uint64_t>* TrivialPtr, typename Tag>
+  friend class detail::SettingWrapper;
+
+  template <class T>
+  const detail::SettingContents<T>& get(
+      const detail::TypedSettingCore<T>& core) const {
+    assert(core.getIndex() < view_->contents.size());
+    return *static_cast<const detail::SettingContents<T>*>(
+        view_->contents[core.getIndex()].get());
+  }
+
+  hazptr_holder<> holder_;
+  detail::SettingsView* view_;
+};
+
 namespace detail {
 template <class T, typename Tag>
 inline const T& SnapshotSettingWrapper<T, Tag>::operator*() const {
@@ -473,6 +531,18 @@ std::string_view SettingWrapper<T, TrivialPtr, Tag>::updateReason(
     const Snapshot& snapshot) const {
   return snapshot.get(core_).updateReason;
 }
+
+template <class T, std::atomic<uint64_t>* TrivialPtr, typename Tag>
+inline const T& SettingWrapper<T, TrivialPtr, Tag>::value(
+    const ReadSnapshot& snapshot) const {
+  return snapshot.get(core_).value;
+}
+
+template <class T, std::atomic<uint64_t>* TrivialPtr, typename Tag>
+std::string_view SettingWrapper<T, TrivialPtr, Tag>::updateReason(
+    const ReadSnapshot& snapshot) const {
+  return snapshot.get(core_).updateReason;
+}
 } // namespace detail
 
 } // namespace settings
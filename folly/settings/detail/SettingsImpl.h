@@ -22,6 +22,7 @@
 #include <string_view>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/Conv.h>
 #include <folly/Function.h>
@@ -35,6 +36,7 @@
 #include <folly/lang/Aligned.h>
 #include <folly/settings/Immutables.h>
 #include <folly/settings/Types.h>
+#include <folly/synchronization/Hazptr.h>
 #include <folly/synchronization/RelaxedAtomic.h>
 
 namespace folly {
@@ -82,12 +84,27 @@ class SettingCoreBase {
   virtual const SettingMetadata& meta() const = 0;
   virtual uint64_t accessCount() const = 0;
   virtual bool hasHadCallbacks() const = 0;
+  /**
+   * Returns the current global SettingContents, type erased
+   */
+  virtual std::shared_ptr<const void> getGlobalContents() const = 0;
   virtual ~SettingCoreBase() {}
 
   /**
    * Hashable key uniquely identifying this setting in this process
    */
   Key getKey() const { return reinterpret_cast<Key>(this); }
+
+  /**
+   * Dense index of this setting among the registered ones, in order of
+   * registration
+   */
+  size_t getIndex() const { return index_; }
+
+ private:
+  friend void registerSetting(SettingCoreBase& core);
+
+  size_t index_{0};
 };
 
 void registerSetting(SettingCoreBase& core);
@@ -100,6 +117,29 @@ Synchronized<SettingsMap>& settingsMap();
  */
 SettingCoreBase::Version nextGlobalVersion();
 
+/**
+ * The last version returned by nextGlobalVersion(). It's bumped by every
+ * global update and registration of a setting.
+ */
+extern std::atomic<SettingCoreBase::Version> gGlobalVersion_;
+
+/**
+ * The global contents of all the settings at a version, read by ReadSnapshot.
+ * Immutable once published; indexed by SettingCoreBase::getIndex().
+ */
+struct SettingsView : hazptr_obj_base<SettingsView> {
+  SettingCoreBase::Version version{0};
+  std::vector<std::shared_ptr<const void>> contents;
+};
+
+extern std::atomic<SettingsView*> gSettingsView;
+
+/**
+ * Publishes the view of the current version, unless it already is, and
+ * returns it protected by holder.
+ */
+SettingsView* refreshSettingsView(hazptr_holder<>& holder);
+
 template <class T, typename Tag>
 class SettingCore;
 
@@ -248,6 +288,11 @@ class TypedSettingCore : public SettingCoreBase {
   }
   const SettingContents<T>& getSlow() const { return *tlValue(); }
 
+  std::shared_ptr<const void> getGlobalContents() const override {
+    std::shared_lock lg(globalLock_);
+    return globalValue_;
+  }
+
   SetResult set(
       const T& t, std::string_view reason, SnapshotBase* snapshot = nullptr) {
     if (isFrozenImmutable()) {
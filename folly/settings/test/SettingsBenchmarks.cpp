@@ -74,6 +74,24 @@ BENCHMARK(non_trivial_access, iters) {
   }
 }
 
+BENCHMARK(snapshot_access, iters) {
+  for (unsigned int i = 0; i < iters; ++i) {
+    folly::settings::Snapshot snapshot;
+    folly::doNotOptimizeAway(FOLLY_SETTING(follytest, trivial).value(snapshot));
+    folly::doNotOptimizeAway(
+        FOLLY_SETTING(follytest, non_trivial).value(snapshot));
+  }
+}
+
+BENCHMARK(read_snapshot_access, iters) {
+  for (unsigned int i = 0; i < iters; ++i) {
+    folly::settings::ReadSnapshot snapshot;
+    folly::doNotOptimizeAway(FOLLY_SETTING(follytest, trivial).value(snapshot));
+    folly::doNotOptimizeAway(
+        FOLLY_SETTING(follytest, non_trivial).value(snapshot));
+  }
+}
+
 template <typename Func>
 void parallel(size_t numThreads, const Func& func) {
   folly::BenchmarkSuspender suspender;
@@ -998,3 +998,91 @@ TEST(Settings, settingReferenceGuarantees) {
     EXPECT_EQ(value, "abc");
   }
 }
+
+TEST(Settings, readSnapshot) {
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("first", "reason1");
+  some_ns::FOLLY_SETTING(follytest, multi_token_type).set(1);
+  {
+    folly::settings::ReadSnapshot snapshot;
+    auto& value = some_ns::FOLLY_SETTING(follytest, some_flag).value(snapshot);
+    EXPECT_EQ(value, "first");
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, some_flag).updateReason(snapshot),
+        "reason1");
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, multi_token_type).value(snapshot), 1);
+    // Settings defined in other translation units are in the snapshot too
+    EXPECT_EQ(
+        a_ns::FOLLY_SETTING(follytest, public_flag_to_a).value(snapshot),
+        *a_ns::FOLLY_SETTING(follytest, public_flag_to_a));
+
+    // Global updates aren't visible in the snapshot, and don't invalidate the
+    // references it returned
+    some_ns::FOLLY_SETTING(follytest, some_flag).set("second", "reason2");
+    some_ns::FOLLY_SETTING(follytest, multi_token_type).set(2);
+    EXPECT_EQ(value, "first");
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, multi_token_type).value(snapshot), 1);
+
+    folly::settings::ReadSnapshot newSnapshot;
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, some_flag).value(newSnapshot),
+        "second");
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, some_flag).updateReason(newSnapshot),
+        "reason2");
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, multi_token_type).value(newSnapshot),
+        2);
+  }
+  {
+    // Published snapshots are visible too
+    folly::settings::Snapshot snapshot;
+    snapshot(some_ns::FOLLY_SETTING(follytest, some_flag)).set("third");
+    snapshot.publish();
+    folly::settings::ReadSnapshot readSnapshot;
+    EXPECT_EQ(
+        some_ns::FOLLY_SETTING(follytest, some_flag).value(readSnapshot),
+        "third");
+  }
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("default");
+  some_ns::FOLLY_SETTING(follytest, multi_token_type).set(123);
+}
+
+TEST(Settings, readSnapshotConsistency) {
+  const unsigned numSets = 10'000;
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("0");
+  some_ns::FOLLY_SETTING(follytest, multi_token_type).set(0);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        folly::settings::ReadSnapshot snapshot;
+        // multi_token_type is only set after some_flag, so it can't be ahead,
+        // although it's read after
+        auto first = folly::to<unsigned>(
+            some_ns::FOLLY_SETTING(follytest, some_flag).value(snapshot));
+        auto second =
+            some_ns::FOLLY_SETTING(follytest, multi_token_type).value(snapshot);
+        ASSERT_LE(second, first);
+      }
+    });
+  }
+  for (unsigned j = 1; j <= numSets; ++j) {
+    some_ns::FOLLY_SETTING(follytest, some_flag).set(folly::to<std::string>(j));
+    some_ns::FOLLY_SETTING(follytest, multi_token_type).set(j);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  folly::settings::ReadSnapshot snapshot;
+  EXPECT_EQ(
+      some_ns::FOLLY_SETTING(follytest, multi_token_type).value(snapshot),
+      numSets);
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("default");
+  some_ns::FOLLY_SETTING(follytest, multi_token_type).set(123);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/SSLServerSessionCache.h>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace folly {
+namespace ssl {
+
+namespace {
+
+std::string_view toStringView(ByteRange range) {
+  return std::string_view(
+      reinterpret_cast<const char*>(range.data()), range.size());
+}
+
+} // namespace
+
+ShardedSSLServerSessionCache::Shard::Shard(size_t capacity)
+    : state(std::in_place, capacity) {
+  auto locked = state.lock();
+  auto* lockedState = &*locked;
+  locked->sessions.setPruneHook(
+      [lockedState](const std::string&, std::string&&) {
+        // Only called from set(), under the lock of the shard.
+        ++lockedState->evictions;
+      });
+}
+
+ShardedSSLServerSessionCache::ShardedSSLServerSessionCache(Options options) {
+  if (options.numShards == 0) {
+    throw std::invalid_argument("ShardedSSLServerSessionCache needs shards");
+  }
+  auto shardCapacity =
+      std::max<size_t>(1, options.capacity / options.numShards);
+  shards_.reserve(options.numShards);
+  for (size_t i = 0; i < options.numShards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(shardCapacity));
+  }
+}
+
+ShardedSSLServerSessionCache::Shard& ShardedSSLServerSessionCache::shardFor(
+    ByteRange sessionId) {
+  auto hash = std::hash<std::string_view>()(toStringView(sessionId));
+  return *shards_[hash % shards_.size()];
+}
+
+void ShardedSSLServerSessionCache::add(
+    ByteRange sessionId, std::string session) {
+  std::string key(toStringView(sessionId));
+  auto state = shardFor(sessionId).state.lock();
+  state->sessions.set(key, std::move(session));
+  ++state->adds;
+}
+
+Optional<std::string> ShardedSSLServerSessionCache::get(ByteRange sessionId) {
+  std::string key(toStringView(sessionId));
+  auto state = shardFor(sessionId).state.lock();
+  ++state->lookups;
+  auto it = state->sessions.find(key);
+  if (it == state->sessions.end()) {
+    return none;
+  }
+  ++state->hits;
+  return it->second;
+}
+
+void ShardedSSLServerSessionCache::remove(ByteRange sessionId) {
+  std::string key(toStringView(sessionId));
+  auto state = shardFor(sessionId).state.lock();
+  if (state->sessions.erase(key)) {
+    ++state->removals;
+  }
+}
+
+ShardedSSLServerSessionCache::Stats ShardedSSLServerSessionCache::getStats()
+    const {
+  Stats stats;
+  for (const auto& shard : shards_) {
+    auto state = shard->state.lock();
+    stats.lookups += state->lookups;
+    stats.hits += state->hits;
+    stats.adds += state->adds;
+    stats.removals += state->removals;
+    stats.evictions += state->evictions;
+    stats.size += state->sessions.size();
+  }
+  return stats;
+}
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/lang/Align.h>
+
+namespace folly {
+namespace ssl {
+
+/**
+ * A server side cache of TLS sessions, keyed by session id, which lets
+ * clients resume a session with the session id (TLS 1.2), or with a stateful
+ * ticket (TLS 1.3 with SSL_OP_NO_TICKET).
+ *
+ * The sessions are serialized (see i2d_SSL_SESSION), so that an
+ * implementation can share them with other processes, e.g. through shared
+ * memory or a remote store. See SSLContext::setServerSessionCache().
+ *
+ * The methods are called during the handshakes, from the threads of the
+ * contexts which use the cache, and must be thread safe.
+ */
+class SSLServerSessionCache {
+ public:
+  virtual ~SSLServerSessionCache() = default;
+
+  virtual void add(ByteRange sessionId, std::string session) = 0;
+
+  virtual Optional<std::string> get(ByteRange sessionId) = 0;
+
+  virtual void remove(ByteRange sessionId) = 0;
+};
+
+/**
+ * An in-process SSLServerSessionCache for a server which handles connections
+ * in several threads. The sessions are spread over shards, each with its own
+ * lock and its own LRU eviction, so that the threads rarely contend.
+ */
+class ShardedSSLServerSessionCache : public SSLServerSessionCache {
+ public:
+  struct Options {
+    // Maximum number of sessions, split evenly among the shards.
+    size_t capacity{20480};
+    size_t numShards{16};
+  };
+
+  struct Stats {
+    uint64_t lookups{0};
+    uint64_t hits{0};
+    uint64_t adds{0};
+    uint64_t removals{0};
+    // Sessions evicted to make room for new ones.
+    uint64_t evictions{0};
+    size_t size{0};
+
+    double hitRate() const {
+      return lookups == 0 ? 0.0 : double(hits) / double(lookups);
+    }
+  };
+
+  ShardedSSLServerSessionCache() : ShardedSSLServerSessionCache(Options()) {}
+  explicit ShardedSSLServerSessionCache(Options options);
+
+  void add(ByteRange sessionId, std::string session) override;
+
+  Optional<std::string> get(ByteRange sessionId) override;
+
+  void remove(ByteRange sessionId) override;
+
+  /**
+   * Sums up the counters of the shards, which are updated under their locks:
+   * the result isn't a snapshot of all of them at a single point in time.
+   */
+  Stats getStats() const;
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Shard {
+    explicit Shard(size_t capacity);
+
+    struct State {
+      explicit State(size_t capacity) : sessions(capacity) {}
+
+      EvictingCacheMap<std::string, std::string> sessions;
+      uint64_t lookups{0};
+      uint64_t hits{0};
+      uint64_t adds{0};
+      uint64_t removals{0};
+      uint64_t evictions{0};
+    };
+
+    Synchronized<State, std::mutex> state;
+  };
+
+  Shard& shardFor(ByteRange sessionId);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/TLSTicketKeyHandler.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <folly/Range.h>
+#include <folly/ssl/OpenSSLHash.h>
+
+namespace folly {
+namespace ssl {
+
+namespace {
+
+// Each key of a seed is derived with HMAC-SHA256 of a label, keyed with the
+// seed, so that knowing one of them tells nothing about the others.
+void deriveFromSeed(
+    const std::string& seed, StringPiece label, MutableByteRange out) {
+  std::array<unsigned char, 32> digest;
+  OpenSSLHash::hmac_sha256(
+      range(digest), ByteRange(StringPiece(seed)), ByteRange(label));
+  std::memcpy(out.data(), digest.data(), out.size());
+}
+
+} // namespace
+
+TLSTicketKeyHandler::TicketKey TLSTicketKeyHandler::deriveKey(
+    const std::string& seed, bool renew) {
+  TicketKey key;
+  deriveFromSeed(seed, "folly ticket key name", range(key.name));
+  deriveFromSeed(seed, "folly ticket aes key", range(key.aesKey));
+  deriveFromSeed(seed, "folly ticket hmac key", range(key.hmacKey));
+  key.renew = renew;
+  return key;
+}
+
+void TLSTicketKeyHandler::setTicketKeySeeds(
+    const std::vector<std::string>& oldSeeds,
+    const std::vector<std::string>& currentSeeds,
+    const std::vector<std::string>& newSeeds) {
+  if (currentSeeds.empty()) {
+    throw std::invalid_argument("TLSTicketKeyHandler needs a current seed");
+  }
+  auto keys = std::make_shared<TicketKeys>();
+  keys->encryptionKey = deriveKey(currentSeeds.front(), false);
+  for (const auto& seed : currentSeeds) {
+    keys->keys.push_back(deriveKey(seed, false));
+  }
+  for (const auto* seeds : {&oldSeeds, &newSeeds}) {
+    for (const auto& seed : *seeds) {
+      keys->keys.push_back(deriveKey(seed, true));
+    }
+  }
+  *keys_.wlock() = std::move(keys);
+}
+
+int TLSTicketKeyHandler::ticketCallback(
+    SSL*,
+    unsigned char* keyName,
+    unsigned char* iv,
+    EVP_CIPHER_CTX* cipherCtx,
+    HMAC_CTX* hmacCtx,
+    int encrypt) {
+  auto keys = keys_.copy();
+  if (!keys) {
+    // No ticket is issued, and the client gets a full handshake.
+    return 0;
+  }
+  const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+
+  if (encrypt) {
+    const auto& key = keys->encryptionKey;
+    if (RAND_bytes(iv, EVP_CIPHER_iv_length(cipher)) != 1) {
+      return -1;
+    }
+    std::memcpy(keyName, key.name.data(), kNameLength);
+    if (EVP_EncryptInit_ex(cipherCtx, cipher, nullptr, key.aesKey.data(), iv) !=
+            1 ||
+        HMAC_Init_ex(
+            hmacCtx, key.hmacKey.data(), kKeyLength, EVP_sha256(), nullptr) !=
+            1) {
+      return -1;
+    }
+    encrypted_.fetch_add(1, std::memory_order_relaxed);
+    return 1;
+  }
+
+  for (const auto& key : keys->keys) {
+    if (std::memcmp(keyName, key.name.data(), kNameLength) != 0) {
+      continue;
+    }
+    if (EVP_DecryptInit_ex(cipherCtx, cipher, nullptr, key.aesKey.data(), iv) !=
+            1 ||
+        HMAC_Init_ex(
+            hmacCtx, key.hmacKey.data(), kKeyLength, EVP_sha256(), nullptr) !=
+            1) {
+      return -1;
+    }
+    decrypted_.fetch_add(1, std::memory_order_relaxed);
+    if (key.renew) {
+      renewed_.fetch_add(1, std::memory_order_relaxed);
+      return 2;
+    }
+    return 1;
+  }
+  unknownKey_.fetch_add(1, std::memory_order_relaxed);
+  return 0;
+}
+
+TLSTicketKeyHandler::Stats TLSTicketKeyHandler::getStats() const {
+  Stats stats;
+  stats.encrypted = encrypted_.load(std::memory_order_relaxed);
+  stats.decrypted = decrypted_.load(std::memory_order_relaxed);
+  stats.renewed = renewed_.load(std::memory_order_relaxed);
+  stats.unknownKey = unknownKey_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLTicketHandler.h>
+
+namespace folly {
+namespace ssl {
+
+/**
+ * An OpenSSLTicketHandler which encrypts TLS tickets with keys derived from
+ * rotating secrets ("seeds"), in the manner of the ticket key files of web
+ * servers: servers which are given the same seeds, e.g. the processes of an
+ * edge tier, can resume each other's tickets.
+ *
+ * The seeds are split in three sets:
+ *  - the tickets are encrypted with the key of the first current seed;
+ *  - tickets encrypted with the key of any seed are accepted;
+ *  - tickets encrypted with the key of an old or a new seed are renewed.
+ *
+ * To rotate the keys without failing resumptions, shift the seeds at a
+ * regular interval, e.g. every hour, on all the servers:
+ *   setTicketKeySeeds({s0}, {s1}, {s2});
+ *   setTicketKeySeeds({s1}, {s2}, {s3});
+ * A server which rotates before another still accepts its tickets, with the
+ * new keys.
+ *
+ * Unlike OpenSSLTicketHandler in general, a TLSTicketKeyHandler is thread
+ * safe: the seeds may be set from any thread.
+ */
+class TLSTicketKeyHandler : public OpenSSLTicketHandler {
+ public:
+  struct Stats {
+    uint64_t encrypted{0};
+    uint64_t decrypted{0};
+    // Tickets which were decrypted and renewed.
+    uint64_t renewed{0};
+    // Tickets encrypted with an unknown key, which lead to full handshakes.
+    uint64_t unknownKey{0};
+  };
+
+  TLSTicketKeyHandler() = default;
+
+  /**
+   * Throws std::invalid_argument if there is no current seed.
+   */
+  void setTicketKeySeeds(
+      const std::vector<std::string>& oldSeeds,
+      const std::vector<std::string>& currentSeeds,
+      const std::vector<std::string>& newSeeds);
+
+  int ticketCallback(
+      SSL* ssl,
+      unsigned char* keyName,
+      unsigned char* iv,
+      EVP_CIPHER_CTX* cipherCtx,
+      HMAC_CTX* hmacCtx,
+      int encrypt) override;
+
+  Stats getStats() const;
+
+ private:
+  static constexpr size_t kNameLength = 16;
+  static constexpr size_t kKeyLength = 32;
+
+  struct TicketKey {
+    std::array<unsigned char, kNameLength> name;
+    std::array<unsigned char, kKeyLength> aesKey;
+    std::array<unsigned char, kKeyLength> hmacKey;
+    // Whether the tickets it decrypts should be renewed.
+    bool renew;
+  };
+
+  struct TicketKeys {
+    TicketKey encryptionKey;
+    std::vector<TicketKey> keys;
+  };
+
+  static TicketKey deriveKey(const std::string& seed, bool renew);
+
+  Synchronized<std::shared_ptr<const TicketKeys>, SharedMutex> keys_;
+
+  std::atomic<uint64_t> encrypted_{0};
+  std::atomic<uint64_t> decrypted_{0};
+  std::atomic<uint64_t> renewed_{0};
+  std::atomic<uint64_t> unknownKey_{0};
+};
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/SSLServerSessionCache.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/portability/GTest.h>
+
+using folly::ssl::ShardedSSLServerSessionCache;
+
+namespace folly {
+
+namespace {
+
+ByteRange id(const std::string& s) {
+  return ByteRange(StringPiece(s));
+}
+
+} // namespace
+
+TEST(ShardedSSLServerSessionCacheTest, AddGetRemove) {
+  ShardedSSLServerSessionCache cache;
+  EXPECT_FALSE(cache.get(id("a")).has_value());
+
+  cache.add(id("a"), "session a");
+  cache.add(id("b"), "session b");
+  EXPECT_EQ("session a", cache.get(id("a")).value());
+  EXPECT_EQ("session b", cache.get(id("b")).value());
+
+  cache.remove(id("a"));
+  cache.remove(id("c"));
+  EXPECT_FALSE(cache.get(id("a")).has_value());
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(4, stats.lookups);
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(2, stats.adds);
+  EXPECT_EQ(1, stats.removals);
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(1, stats.size);
+  EXPECT_DOUBLE_EQ(0.5, stats.hitRate());
+}
+
+TEST(ShardedSSLServerSessionCacheTest, Eviction) {
+  ShardedSSLServerSessionCache::Options options;
+  options.capacity = 4;
+  options.numShards = 1;
+  ShardedSSLServerSessionCache cache(options);
+  for (int i = 0; i < 6; ++i) {
+    cache.add(id(to<std::string>(i)), to<std::string>("session ", i));
+  }
+  // The least recently used sessions were evicted.
+  EXPECT_FALSE(cache.get(id("0")).has_value());
+  EXPECT_FALSE(cache.get(id("1")).has_value());
+  EXPECT_EQ("session 5", cache.get(id("5")).value());
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(2, stats.evictions);
+  EXPECT_EQ(4, stats.size);
+}
+
+TEST(ShardedSSLServerSessionCacheTest, Concurrent) {
+  ShardedSSLServerSessionCache cache;
+  constexpr int kThreads = 8;
+  constexpr int kSessions = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kSessions; ++i) {
+        auto key = to<std::string>(t, ":", i);
+        cache.add(id(key), key);
+        EXPECT_EQ(key, cache.get(id(key)).value());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto stats = cache.getStats();
+  EXPECT_EQ(kThreads * kSessions, stats.adds);
+  EXPECT_EQ(kThreads * kSessions, stats.hits);
+  EXPECT_DOUBLE_EQ(1.0, stats.hitRate());
+}
+
+} // namespace folly
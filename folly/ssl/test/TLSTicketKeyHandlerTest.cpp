@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/TLSTicketKeyHandler.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <folly/Range.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+
+using folly::ssl::TLSTicketKeyHandler;
+
+namespace folly {
+
+namespace {
+
+// The ticket as OpenSSL sees it: the key name and IV in the clear, and the
+// contents encrypted with the cipher context set up by the callback.
+struct Ticket {
+  std::array<unsigned char, 16> keyName{};
+  std::array<unsigned char, EVP_MAX_IV_LENGTH> iv{};
+  std::array<unsigned char, 32> encrypted{};
+};
+
+// 16 bytes, which AES-CBC encrypts in 32 bytes with the padding.
+const ByteRange kContents{StringPiece("session contents")};
+
+// Returns the result of the encryption callback.
+int encrypt(TLSTicketKeyHandler& handler, Ticket& ticket) {
+  ssl::EvpCipherCtxUniquePtr cipherCtx(EVP_CIPHER_CTX_new());
+  ssl::HmacCtxUniquePtr hmacCtx(HMAC_CTX_new());
+  int ret = handler.ticketCallback(
+      nullptr,
+      ticket.keyName.data(),
+      ticket.iv.data(),
+      cipherCtx.get(),
+      hmacCtx.get(),
+      1);
+  if (ret == 1) {
+    int len = 0;
+    int finalLen = 0;
+    EXPECT_EQ(
+        1,
+        EVP_EncryptUpdate(
+            cipherCtx.get(),
+            ticket.encrypted.data(),
+            &len,
+            kContents.data(),
+            int(kContents.size())));
+    EXPECT_EQ(
+        1,
+        EVP_EncryptFinal_ex(
+            cipherCtx.get(), ticket.encrypted.data() + len, &finalLen));
+    EXPECT_EQ(ticket.encrypted.size(), size_t(len + finalLen));
+  }
+  return ret;
+}
+
+// Returns the result of the decryption callback, and checks the contents
+// of the ticket if it was decrypted.
+int decrypt(TLSTicketKeyHandler& handler, Ticket& ticket) {
+  ssl::EvpCipherCtxUniquePtr cipherCtx(EVP_CIPHER_CTX_new());
+  ssl::HmacCtxUniquePtr hmacCtx(HMAC_CTX_new());
+  int ret = handler.ticketCallback(
+      nullptr,
+      ticket.keyName.data(),
+      ticket.iv.data(),
+      cipherCtx.get(),
+      hmacCtx.get(),
+      0);
+  if (ret == 1 || ret == 2) {
+    std::array<unsigned char, 48> decrypted;
+    int len = 0;
+    int finalLen = 0;
+    EXPECT_EQ(
+        1,
+        EVP_DecryptUpdate(
+            cipherCtx.get(),
+            decrypted.data(),
+            &len,
+            ticket.encrypted.data(),
+            int(ticket.encrypted.size())));
+    EXPECT_EQ(
+        1,
+        EVP_DecryptFinal_ex(
+            cipherCtx.get(), decrypted.data() + len, &finalLen));
+    EXPECT_EQ(kContents.size(), size_t(len + finalLen));
+    EXPECT_EQ(
+        0,
+        std::memcmp(kContents.data(), decrypted.data(), kContents.size()));
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST(TLSTicketKeyHandlerTest, NoSeeds) {
+  TLSTicketKeyHandler handler;
+  Ticket ticket;
+  EXPECT_EQ(0, encrypt(handler, ticket));
+  EXPECT_EQ(0, decrypt(handler, ticket));
+  EXPECT_THROW(
+      handler.setTicketKeySeeds({"old"}, {}, {}), std::invalid_argument);
+}
+
+TEST(TLSTicketKeyHandlerTest, SharedSeeds) {
+  // Two servers with the same seeds accept each other's tickets.
+  TLSTicketKeyHandler server1;
+  TLSTicketKeyHandler server2;
+  server1.setTicketKeySeeds({"s0"}, {"s1"}, {"s2"});
+  server2.setTicketKeySeeds({"s0"}, {"s1"}, {"s2"});
+
+  Ticket ticket;
+  ASSERT_EQ(1, encrypt(server1, ticket));
+  EXPECT_EQ(1, decrypt(server2, ticket));
+
+  // A server with other seeds doesn't.
+  TLSTicketKeyHandler server3;
+  server3.setTicketKeySeeds({}, {"other"}, {});
+  EXPECT_EQ(0, decrypt(server3, ticket));
+
+  EXPECT_EQ(1, server1.getStats().encrypted);
+  EXPECT_EQ(1, server2.getStats().decrypted);
+  EXPECT_EQ(1, server3.getStats().unknownKey);
+}
+
+TEST(TLSTicketKeyHandlerTest, Rotation) {
+  TLSTicketKeyHandler handler;
+  handler.setTicketKeySeeds({"s0"}, {"s1"}, {"s2"});
+  Ticket ticket;
+  ASSERT_EQ(1, encrypt(handler, ticket));
+
+  // After a rotation, the ticket is still accepted, and renewed.
+  handler.setTicketKeySeeds({"s1"}, {"s2"}, {"s3"});
+  EXPECT_EQ(2, decrypt(handler, ticket));
+  EXPECT_EQ(1, handler.getStats().renewed);
+
+  // A server which rotated first issues tickets that are accepted, and
+  // renewed, by the servers which haven't rotated yet.
+  Ticket newTicket;
+  ASSERT_EQ(1, encrypt(handler, newTicket));
+  TLSTicketKeyHandler lagging;
+  lagging.setTicketKeySeeds({"s0"}, {"s1"}, {"s2"});
+  EXPECT_EQ(2, decrypt(lagging, newTicket));
+
+  // After two rotations, the ticket is rejected.
+  handler.setTicketKeySeeds({"s2"}, {"s3"}, {"s4"});
+  EXPECT_EQ(0, decrypt(handler, ticket));
+}
+
+} // namespace folly
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <folly/Conv.h>
+#include <folly/concurrency/CacheLocality.h>
+
+namespace folly {
+
+template <size_t PrecisionBits>
+ConcurrentLogHistogram<PrecisionBits>::ConcurrentLogHistogram()
+    : numShards_(CacheLocality::system().numCachesByLevel[0]) {
+  shards_ = std::make_unique<Shard[]>(numShards_);
+}
+
+template <size_t PrecisionBits>
+void ConcurrentLogHistogram<PrecisionBits>::addValue(uint64_t value) noexcept {
+  auto& shard = shards_[AccessSpreader<>::cachedCurrent(numShards_)];
+  shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+
+  // Only values that are new extremes for the shard need a CAS.
+  auto min = shard.min.load(std::memory_order_relaxed);
+  while (FOLLY_UNLIKELY(value < min) &&
+         !shard.min.compare_exchange_weak(
+             min, value, std::memory_order_relaxed)) {
+  }
+  auto max = shard.max.load(std::memory_order_relaxed);
+  while (FOLLY_UNLIKELY(value > max) &&
+         !shard.max.compare_exchange_weak(
+             max, value, std::memory_order_relaxed)) {
+  }
+}
+
+template <size_t PrecisionBits>
+auto ConcurrentLogHistogram<PrecisionBits>::snapshot() const -> Snapshot {
+  Snapshot result;
+  uint64_t min = std::numeric_limits<uint64_t>::max();
+  uint64_t max = 0;
+  for (size_t i = 0; i < numShards_; ++i) {
+    const auto& shard = shards_[i];
+    for (size_t b = 0; b < kNumBuckets; ++b) {
+      auto count = shard.buckets[b].load(std::memory_order_relaxed);
+      result.buckets_[b] += count;
+      result.count_ += count;
+    }
+    result.sum_ += shard.sum.load(std::memory_order_relaxed);
+    min = std::min(min, shard.min.load(std::memory_order_relaxed));
+    max = std::max(max, shard.max.load(std::memory_order_relaxed));
+  }
+  if (result.count_ > 0) {
+    // The bounds of the buckets that were seen are always consistent, even if
+    // min and max were updated after the buckets were read.
+    size_t first = 0;
+    while (result.buckets_[first] == 0) {
+      ++first;
+    }
+    size_t last = kNumBuckets - 1;
+    while (result.buckets_[last] == 0) {
+      --last;
+    }
+    result.min_ = std::clamp(min, bucketMin(first), bucketMax(first));
+    result.max_ = std::clamp(max, bucketMin(last), bucketMax(last));
+  }
+  return result;
+}
+
+template <size_t PrecisionBits>
+void ConcurrentLogHistogram<PrecisionBits>::clear() noexcept {
+  for (size_t i = 0; i < numShards_; ++i) {
+    auto& shard = shards_[i];
+    for (auto& bucket : shard.buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    shard.sum.store(0, std::memory_order_relaxed);
+    shard.min.store(
+        std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    shard.max.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <size_t PrecisionBits>
+double ConcurrentLogHistogram<PrecisionBits>::Snapshot::estimateQuantile(
+    double q) const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  if (q <= 0.0) {
+    return double(min_);
+  }
+  if (q >= 1.0) {
+    return double(max_);
+  }
+
+  double rank = q * double(count_);
+  uint64_t seen = 0;
+  for (size_t b = 0; b < kNumBuckets; ++b) {
+    auto count = buckets_[b];
+    if (count == 0 || double(seen + count) < rank) {
+      seen += count;
+      continue;
+    }
+    double lo = std::max(double(bucketMin(b)), double(min_));
+    double hi = std::min(double(bucketMax(b)), double(max_));
+    return lo + (hi - lo) * (rank - double(seen)) / double(count);
+  }
+  return double(max_);
+}
+
+template <size_t PrecisionBits>
+TDigest ConcurrentLogHistogram<PrecisionBits>::Snapshot::toTDigest(
+    size_t maxSize) const {
+  if (count_ == 0) {
+    return TDigest(maxSize);
+  }
+  std::vector<TDigest::Centroid> centroids;
+  for (size_t b = 0; b < kNumBuckets; ++b) {
+    if (buckets_[b] > 0) {
+      double lo = std::max(double(bucketMin(b)), double(min_));
+      double hi = std::min(double(bucketMax(b)), double(max_));
+      centroids.emplace_back(lo + (hi - lo) / 2, double(buckets_[b]));
+    }
+  }
+  return TDigest(
+      std::move(centroids),
+      double(sum_),
+      double(count_),
+      double(max_),
+      double(min_),
+      maxSize);
+}
+
+template <size_t PrecisionBits>
+template <class Q>
+QuantileHistogram<Q>
+ConcurrentLogHistogram<PrecisionBits>::Snapshot::toQuantileHistogram() const {
+  std::remove_const_t<decltype(Q::kQuantiles)> locations{};
+  for (size_t i = 0; i < locations.size(); ++i) {
+    locations[i] = estimateQuantile(Q::kQuantiles[i]);
+  }
+  return QuantileHistogram<Q>(locations, count_);
+}
+
+template <size_t PrecisionBits>
+std::string ConcurrentLogHistogram<PrecisionBits>::Snapshot::debugString()
+    const {
+  std::string ret = folly::to<std::string>(
+      "count: ", count_, ", sum: ", sum_, ", min: ", min_, ", max: ", max_);
+  for (size_t b = 0; b < kNumBuckets; ++b) {
+    if (buckets_[b] > 0) {
+      folly::toAppend(
+          "\n  [", bucketMin(b), ", ", bucketMax(b), "]: ", buckets_[b], &ret);
+    }
+  }
+  return ret;
+}
+
+} // namespace folly
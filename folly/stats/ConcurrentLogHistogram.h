@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Likely.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <folly/stats/QuantileHistogram.h>
+#include <folly/stats/TDigest.h>
+
+namespace folly {
+
+/*
+ * ConcurrentLogHistogram records non-negative integer values, typically
+ * latencies, from any number of threads, and estimates their quantiles.
+ *
+ * Values are counted in log-linear buckets, in the style of HdrHistogram:
+ * values below 2^(PrecisionBits + 1) get a bucket each, and every larger power
+ * of two range is split into 2^PrecisionBits buckets of equal width. The
+ * relative error of estimates is therefore at most 2^-PrecisionBits (6.25%
+ * with the default of 4), over the whole range of uint64_t.
+ *
+ * There is one array of buckets per cpu cache, like DigestBuilder, but with
+ * no lock and no buffer: addValue() is a couple of relaxed atomic updates to
+ * memory that is mostly local to the cpu, and never allocates. The memory
+ * used is fixed at construction, about (65 - PrecisionBits) << PrecisionBits
+ * counters per cpu cache.
+ *
+ * Reads are expensive in comparison: snapshot() merges all the shards. A
+ * snapshot taken while values are being added may include some of them and
+ * not others, and its min, max and sum may not exactly match its buckets.
+ * Snapshots can be converted to TDigest or QuantileHistogram, to be merged
+ * with stats recorded elsewhere.
+ */
+template <size_t PrecisionBits = 4>
+class ConcurrentLogHistogram {
+  static_assert(PrecisionBits >= 1 && PrecisionBits <= 10, "");
+
+ public:
+  static constexpr size_t kNumBuckets = (65 - PrecisionBits) << PrecisionBits;
+
+  /*
+   * Returns the index of the bucket that counts value.
+   */
+  static constexpr size_t bucketIndex(uint64_t value) {
+    if (value < (uint64_t(1) << PrecisionBits)) {
+      return size_t(value);
+    }
+    size_t shift = findLastSet(value) - 1 - PrecisionBits;
+    return (shift << PrecisionBits) + size_t(value >> shift);
+  }
+
+  /*
+   * Returns the smallest value counted by the given bucket.
+   */
+  static constexpr uint64_t bucketMin(size_t bucket) {
+    if (bucket < (size_t(2) << PrecisionBits)) {
+      return bucket;
+    }
+    size_t shift = (bucket >> PrecisionBits) - 1;
+    return uint64_t(bucket - (shift << PrecisionBits)) << shift;
+  }
+
+  /*
+   * Returns the largest value counted by the given bucket.
+   */
+  static constexpr uint64_t bucketMax(size_t bucket) {
+    if (bucket < (size_t(2) << PrecisionBits)) {
+      return bucket;
+    }
+    size_t shift = (bucket >> PrecisionBits) - 1;
+    return bucketMin(bucket) + ((uint64_t(1) << shift) - 1);
+  }
+
+  /*
+   * The merged contents of a ConcurrentLogHistogram at some point in time.
+   */
+  class Snapshot {
+   public:
+    uint64_t count() const { return count_; }
+
+    bool empty() const { return count_ == 0; }
+
+    // Wraps around if the sum of the values does not fit in 64 bits.
+    uint64_t sum() const { return sum_; }
+
+    double mean() const { return count_ > 0 ? double(sum_) / count_ : 0; }
+
+    // Exact. Both are 0 if the snapshot is empty.
+    uint64_t min() const { return min_; }
+    uint64_t max() const { return max_; }
+
+    uint64_t bucketCount(size_t bucket) const { return buckets_[bucket]; }
+
+    /*
+     * Estimates the value of the given quantile, interpolating linearly
+     * within buckets.
+     */
+    double estimateQuantile(double q) const;
+
+    /*
+     * Builds a TDigest with one centroid per non-empty bucket, compressed
+     * down to maxSize centroids.
+     */
+    TDigest toTDigest(size_t maxSize = TDigest::kDefaultMaxSize) const;
+
+    /*
+     * Builds a QuantileHistogram tracking the estimates of its quantiles.
+     */
+    template <class Q = PredefinedQuantiles::Default>
+    QuantileHistogram<Q> toQuantileHistogram() const;
+
+    std::string debugString() const;
+
+   private:
+    friend class ConcurrentLogHistogram;
+
+    std::vector<uint64_t> buckets_ = std::vector<uint64_t>(kNumBuckets);
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t min_{0};
+    uint64_t max_{0};
+  };
+
+  ConcurrentLogHistogram();
+
+  ConcurrentLogHistogram(const ConcurrentLogHistogram&) = delete;
+  ConcurrentLogHistogram& operator=(const ConcurrentLogHistogram&) = delete;
+
+  void addValue(uint64_t value) noexcept;
+
+  Snapshot snapshot() const;
+
+  /*
+   * Removes all the values. Values added concurrently may or may not be kept.
+   */
+  void clear() noexcept;
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Shard {
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max{0};
+  };
+
+  std::unique_ptr<Shard[]> shards_;
+  size_t numShards_;
+};
+
+} // namespace folly
+
+#include <folly/stats/ConcurrentLogHistogram-inl.h>
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utility>
+
+#include <folly/Likely.h>
+#include <folly/concurrency/CacheLocality.h>
+
+namespace folly {
+
+template <typename VT, typename CT>
+ConcurrentMultiLevelTimeSeries<VT, CT>::ConcurrentMultiLevelTimeSeries(
+    size_t numBuckets, folly::Range<const Duration*> durations)
+    : numShards_(CacheLocality::system().numCachesByLevel[0]),
+      timeSeries_(numBuckets, durations) {
+  shards_ = std::make_unique<Shard[]>(numShards_);
+}
+
+template <typename VT, typename CT>
+void ConcurrentMultiLevelTimeSeries<VT, CT>::addValueAggregated(
+    TimePoint now, const ValueType& total, uint64_t nsamples) {
+  auto& shard = shards_[AccessSpreader<>::cachedCurrent(numShards_)];
+  auto time = now.time_since_epoch().count();
+  if (FOLLY_UNLIKELY(shard.time.load(std::memory_order_relaxed) != time)) {
+    std::lock_guard<std::mutex> g(mutex_);
+    if (shard.time.load(std::memory_order_relaxed) != time) {
+      flushShard(shard);
+      shard.time.store(time, std::memory_order_relaxed);
+    }
+  }
+  add(shard.sum, total);
+  shard.count.fetch_add(nsamples, std::memory_order_relaxed);
+}
+
+template <typename VT, typename CT>
+auto ConcurrentMultiLevelTimeSeries<VT, CT>::snapshot(TimePoint now)
+    -> TimeSeries {
+  return withTimeSeries(
+      now, [](const TimeSeries& timeSeries) { return timeSeries; });
+}
+
+template <typename VT, typename CT>
+template <typename Fn>
+decltype(auto) ConcurrentMultiLevelTimeSeries<VT, CT>::withTimeSeries(
+    TimePoint now, Fn&& fn) {
+  std::lock_guard<std::mutex> g(mutex_);
+  flushShards();
+  timeSeries_.update(now);
+  return std::forward<Fn>(fn)(std::as_const(timeSeries_));
+}
+
+template <typename VT, typename CT>
+void ConcurrentMultiLevelTimeSeries<VT, CT>::clear() {
+  std::lock_guard<std::mutex> g(mutex_);
+  for (size_t i = 0; i < numShards_; ++i) {
+    shards_[i].sum.store(0, std::memory_order_relaxed);
+    shards_[i].count.store(0, std::memory_order_relaxed);
+  }
+  timeSeries_.clear();
+}
+
+template <typename VT, typename CT>
+void ConcurrentMultiLevelTimeSeries<VT, CT>::flushShard(Shard& shard) {
+  auto count = shard.count.exchange(0, std::memory_order_relaxed);
+  auto sum = shard.sum.exchange(0, std::memory_order_relaxed);
+  // A racing addition may have been half flushed: keep either half.
+  if (count > 0 || sum != ValueType(0)) {
+    auto time = TimePoint(Duration(shard.time.load(std::memory_order_relaxed)));
+    timeSeries_.addValueAggregated(time, sum, count);
+  }
+}
+
+template <typename VT, typename CT>
+void ConcurrentMultiLevelTimeSeries<VT, CT>::flushShards() {
+  for (size_t i = 0; i < numShards_; ++i) {
+    flushShard(shards_[i]);
+  }
+}
+
+template <typename VT, typename CT>
+void ConcurrentMultiLevelTimeSeries<VT, CT>::add(
+    std::atomic<ValueType>& sum, ValueType value) {
+  if constexpr (std::is_integral<ValueType>::value) {
+    sum.fetch_add(value, std::memory_order_relaxed);
+  } else {
+    auto old = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(
+        old, old + value, std::memory_order_relaxed)) {
+    }
+  }
+}
+
+} // namespace folly
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include <folly/Range.h>
+#include <folly/lang/Align.h>
+#include <folly/stats/MultiLevelTimeSeries.h>
+
+namespace folly {
+
+/*
+ * A thread-safe MultiLevelTimeSeries, for counters that are updated from many
+ * threads and read rarely.
+ *
+ * Like the cache of MultiLevelTimeSeries for values added at the same time,
+ * there is one pending sum and count per cpu cache, for the current tick of
+ * the clock. Adding a value in the same tick as the previous value added on
+ * the same cpu cache is two relaxed atomic additions, with no lock. The first
+ * value of a tick takes a mutex, to move the values of the previous tick of
+ * the shard to the underlying MultiLevelTimeSeries. Bucket rotation and
+ * aggregation only happen in that case and on reads, which move all the
+ * pending values under the mutex.
+ *
+ * So, as for MultiLevelTimeSeries, the duration of the clock should be coarse:
+ * the default of one second means that each shard takes the mutex about once
+ * per second. Values added concurrently with a change of tick of their shard
+ * may be counted in the new tick. A read concurrent with additions may see
+ * the sum of a value but not its count, or the reverse.
+ *
+ * Pending sums wrap around on overflow for integral types, rather than being
+ * clamped.
+ */
+template <typename VT, typename CT = LegacyStatsClock<std::chrono::seconds>>
+class ConcurrentMultiLevelTimeSeries {
+  static_assert(std::is_arithmetic<VT>::value, "");
+
+ public:
+  using ValueType = VT;
+  using Clock = CT;
+  using Duration = typename Clock::duration;
+  using TimePoint = typename Clock::time_point;
+  using TimeSeries = MultiLevelTimeSeries<ValueType, Clock>;
+
+  /*
+   * Same arguments as for MultiLevelTimeSeries.
+   */
+  ConcurrentMultiLevelTimeSeries(
+      size_t numBuckets, std::initializer_list<Duration> durations)
+      : ConcurrentMultiLevelTimeSeries(numBuckets, folly::range(durations)) {}
+
+  ConcurrentMultiLevelTimeSeries(
+      size_t numBuckets, folly::Range<const Duration*> durations);
+
+  ConcurrentMultiLevelTimeSeries(const ConcurrentMultiLevelTimeSeries&) =
+      delete;
+  ConcurrentMultiLevelTimeSeries& operator=(
+      const ConcurrentMultiLevelTimeSeries&) = delete;
+
+  void addValue(TimePoint now, const ValueType& val) {
+    addValueAggregated(now, val, 1);
+  }
+
+  void addValue(TimePoint now, const ValueType& val, uint64_t times) {
+    addValueAggregated(now, val * ValueType(times), times);
+  }
+
+  void addValueAggregated(
+      TimePoint now, const ValueType& total, uint64_t nsamples);
+
+  /*
+   * Moves all the pending values to the time series, updates it to now, and
+   * returns a copy of it to read the sums, counts, averages and rates of its
+   * levels from.
+   */
+  TimeSeries snapshot(TimePoint now);
+
+  /*
+   * Moves all the pending values to the time series, updates it to now, and
+   * calls fn with a const reference to it, under the mutex. This avoids the
+   * copy of snapshot(), but blocks the threads that need the mutex in the
+   * meantime.
+   */
+  template <typename Fn>
+  decltype(auto) withTimeSeries(TimePoint now, Fn&& fn);
+
+  /*
+   * Discards all the values. Values added concurrently may or may not be
+   * kept.
+   */
+  void clear();
+
+ private:
+  using TimeRep = typename Duration::rep;
+
+  struct alignas(hardware_destructive_interference_size) Shard {
+    std::atomic<TimeRep> time{0};
+    std::atomic<ValueType> sum{0};
+    std::atomic<uint64_t> count{0};
+  };
+
+  // Requires mutex_.
+  void flushShard(Shard& shard);
+  void flushShards();
+
+  static void add(std::atomic<ValueType>& sum, ValueType value);
+
+  std::unique_ptr<Shard[]> shards_;
+  size_t numShards_;
+
+  std::mutex mutex_;
+  TimeSeries timeSeries_;
+};
+
+} // namespace folly
+
+#include <folly/stats/ConcurrentMultiLevelTimeSeries-inl.h>
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/DigestSerialization.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/Likely.h>
+#include <folly/Varint.h>
+#include <folly/lang/Bits.h>
+
+/*
+ * TDigest, version 1:
+ *   uint8    version
+ *   uint8    precisionBits
+ *   uint8    flags: kWholeWeights
+ *   varint   maxSize
+ *   varint   number of centroids, n
+ *   if n > 0:
+ *     double   sum, count, min, max (little endian)
+ *     n times:
+ *       mean, delta encoded
+ *       weight, as a varint with kWholeWeights, else as a double
+ *
+ * QuantileHistogram, version 1:
+ *   uint8    version
+ *   uint8    precisionBits
+ *   varint   number of quantiles, n
+ *   varint   count
+ *   if count > 0:
+ *     n locations, delta encoded
+ */
+
+namespace folly {
+
+namespace {
+
+constexpr uint8_t kTDigestSerializationVersion = 1;
+
+constexpr uint8_t kWholeWeights = 1;
+
+constexpr size_t kMaxCentroidLength = 2 * kMaxVarintLength64;
+
+// Largest double such that all the whole numbers up to it are exact.
+constexpr double kMaxWholeWeight = double(uint64_t(1) << 53);
+
+constexpr uint64_t kSignBit = uint64_t(1) << 63;
+constexpr uint64_t kInfinityBits = uint64_t(0x7ff) << 52;
+
+// Maps the bits of doubles to integers with the same order.
+// See http://stereopsis.com/radix.html for details.
+uint64_t toOrderedKey(uint64_t bits) {
+  uint64_t mask = -int64_t(bits >> 63) | kSignBit;
+  return bits ^ mask;
+}
+
+double fromOrderedKey(uint64_t key) {
+  uint64_t mask = ((key >> 63) - 1) | kSignBit;
+  uint64_t bits = key ^ mask;
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+bool hasWholeWeights(const std::vector<TDigest::Centroid>& centroids) {
+  for (const auto& c : centroids) {
+    if (!(c.weight() <= kMaxWholeWeight) ||
+        c.weight() != std::floor(c.weight())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t readVarint(io::Cursor& cursor) {
+  return detail::readDigestVarint(cursor);
+}
+
+uint64_t readVarint(ByteRange& bytes) {
+  return decodeVarint(bytes);
+}
+
+double readDouble(io::Cursor& cursor) {
+  return cursor.readLE<double>();
+}
+
+// The caller checks that there are enough bytes.
+double readDouble(ByteRange& bytes) {
+  double value;
+  std::memcpy(&value, bytes.data(), sizeof(value));
+  bytes.advance(sizeof(value));
+  return Endian::little(value);
+}
+
+template <class Input>
+void readCentroids(
+    Input& in,
+    size_t numCentroids,
+    detail::DigestDeltaDecoder& decoder,
+    bool wholeWeights,
+    std::vector<TDigest::Centroid>& centroids) {
+  for (size_t i = 0; i < numCentroids; ++i) {
+    double mean = decoder.read(in);
+    double weight = wholeWeights ? double(readVarint(in)) : readDouble(in);
+    if (!(weight > 0)) {
+      throw_exception<std::invalid_argument>(
+          "TDigest centroid weights must be positive");
+    }
+    centroids.emplace_back(mean, weight);
+  }
+}
+
+} // namespace
+
+namespace detail {
+
+void writeDigestVarint(io::QueueAppender& out, uint64_t value) {
+  out.ensure(kMaxVarintLength64);
+  out.append(encodeVarint(value, out.writableData()));
+}
+
+uint64_t readDigestVarint(io::Cursor& cursor) {
+  auto bytes = cursor.peekBytes();
+  if (FOLLY_LIKELY(bytes.size() >= kMaxVarintLength64)) {
+    auto rest = bytes;
+    auto value = decodeVarint(rest);
+    cursor.skip(bytes.size() - rest.size());
+    return value;
+  }
+  // Near the end of a buffer, the varint may continue in the next one.
+  uint64_t value = 0;
+  for (size_t shift = 0; shift < 64; shift += 7) {
+    auto b = cursor.read<uint8_t>();
+    value |= uint64_t(b & 0x7f) << shift;
+    if (b < 0x80) {
+      return value;
+    }
+  }
+  throw_exception<std::invalid_argument>("Invalid varint value: too big.");
+}
+
+void writeDigestHeader(
+    io::QueueAppender& out, uint8_t version, size_t precisionBits) {
+  if (precisionBits > kDigestLosslessPrecisionBits) {
+    throw_exception<std::invalid_argument>(to<std::string>(
+        "precisionBits must be at most ",
+        kDigestLosslessPrecisionBits,
+        ", got ",
+        precisionBits));
+  }
+  out.write<uint8_t>(version);
+  out.write<uint8_t>(uint8_t(precisionBits));
+}
+
+size_t readDigestHeader(
+    io::Cursor& cursor, uint8_t version, const char* what) {
+  auto actualVersion = cursor.read<uint8_t>();
+  if (actualVersion != version) {
+    throw_exception<std::invalid_argument>(to<std::string>(
+        "Unsupported ", what, " serialization version ", actualVersion));
+  }
+  auto precisionBits = cursor.read<uint8_t>();
+  if (precisionBits > kDigestLosslessPrecisionBits) {
+    throw_exception<std::invalid_argument>(to<std::string>(
+        "Invalid ", what, " precision of ", precisionBits, " bits"));
+  }
+  return precisionBits;
+}
+
+void DigestDeltaEncoder::write(io::QueueAppender& out, double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if (shift_ > 0) {
+    // Round the magnitude to nearest, so that negative and positive values
+    // are rounded the same way.
+    uint64_t sign = bits & kSignBit;
+    uint64_t magnitude = bits ^ sign;
+    magnitude = (magnitude >> shift_) + ((magnitude >> (shift_ - 1)) & 1);
+    bits = sign | std::min(magnitude << shift_, kInfinityBits);
+  }
+  // The low bits of the key are now the same for all values of the same sign.
+  uint64_t key = toOrderedKey(bits) >> shift_;
+  writeDigestVarint(out, encodeZigZag(int64_t(key - prev_)));
+  prev_ = key;
+}
+
+double DigestDeltaDecoder::read(io::Cursor& cursor) {
+  return decode(readDigestVarint(cursor));
+}
+
+double DigestDeltaDecoder::read(ByteRange& bytes) {
+  return decode(decodeVarint(bytes));
+}
+
+double DigestDeltaDecoder::decode(uint64_t zigzag) {
+  prev_ += uint64_t(decodeZigZag(zigzag));
+  uint64_t key = prev_ << shift_;
+  if (!(key & kSignBit)) {
+    // Negative value, whose magnitude bits are inverted in the key.
+    key |= (uint64_t(1) << shift_) - 1;
+  }
+  return fromOrderedKey(key);
+}
+
+} // namespace detail
+
+void serializeTDigest(
+    const TDigest& digest, io::QueueAppender& out, size_t precisionBits) {
+  const auto& centroids = digest.getCentroids();
+  bool wholeWeights = hasWholeWeights(centroids);
+
+  detail::writeDigestHeader(out, kTDigestSerializationVersion, precisionBits);
+  out.write<uint8_t>(wholeWeights ? kWholeWeights : 0);
+  detail::writeDigestVarint(out, digest.maxSize());
+  detail::writeDigestVarint(out, centroids.size());
+  if (centroids.empty()) {
+    return;
+  }
+
+  out.writeLE(digest.sum());
+  out.writeLE(digest.count());
+  out.writeLE(digest.min());
+  out.writeLE(digest.max());
+  detail::DigestDeltaEncoder encoder(precisionBits);
+  for (const auto& c : centroids) {
+    encoder.write(out, c.mean());
+    if (wholeWeights) {
+      detail::writeDigestVarint(out, uint64_t(c.weight()));
+    } else {
+      out.writeLE(c.weight());
+    }
+  }
+}
+
+TDigest deserializeTDigest(io::Cursor& cursor) {
+  auto precisionBits = detail::readDigestHeader(
+      cursor, kTDigestSerializationVersion, "TDigest");
+  auto flags = cursor.read<uint8_t>();
+  if ((flags & ~kWholeWeights) != 0) {
+    throw_exception<std::invalid_argument>(
+        to<std::string>("Invalid TDigest flags ", flags));
+  }
+  auto maxSize = detail::readDigestVarint(cursor);
+  auto numCentroids = detail::readDigestVarint(cursor);
+  if (numCentroids == 0) {
+    return TDigest(maxSize);
+  }
+  // Check before allocating that the input is not obviously truncated.
+  if (!cursor.canAdvance(numCentroids)) {
+    throw_exception<std::out_of_range>("underflow");
+  }
+
+  auto sum = cursor.readLE<double>();
+  auto count = cursor.readLE<double>();
+  auto min = cursor.readLE<double>();
+  auto max = cursor.readLE<double>();
+
+  std::vector<TDigest::Centroid> centroids;
+  centroids.reserve(numCentroids);
+  bool wholeWeights = flags & kWholeWeights;
+  detail::DigestDeltaDecoder decoder(precisionBits);
+  while (centroids.size() < numCentroids) {
+    // Decode the centroids that are surely in this buffer without the checks
+    // and bookkeeping of the cursor, and the others one at a time.
+    auto bytes = cursor.peekBytes();
+    auto n = std::min<size_t>(
+        numCentroids - centroids.size(), bytes.size() / kMaxCentroidLength);
+    if (n > 0) {
+      auto rest = bytes;
+      readCentroids(rest, n, decoder, wholeWeights, centroids);
+      cursor.skip(bytes.size() - rest.size());
+    } else {
+      readCentroids(cursor, 1, decoder, wholeWeights, centroids);
+    }
+  }
+  return TDigest(std::move(centroids), sum, count, max, min, maxSize);
+}
+
+} // namespace folly
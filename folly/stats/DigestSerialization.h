@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include <folly/io/Cursor.h>
+#include <folly/lang/Exception.h>
+#include <folly/stats/QuantileHistogram.h>
+#include <folly/stats/TDigest.h>
+
+namespace folly {
+
+/*
+ * Compact, versioned binary encodings of TDigest and QuantileHistogram, to
+ * ship them between hosts and merge them there.
+ *
+ * Means and quantile locations are sorted, so they are encoded as the
+ * differences of their order preserving integer representations, as zigzag
+ * varints. Centroid weights are usually whole numbers, in which case they are
+ * encoded as varints too. Sums, counts, min and max are kept exactly.
+ *
+ * precisionBits is the number of bits of mantissa of the means and locations
+ * to keep, out of the 52 bits of a double. The default is lossless. Fewer bits
+ * make the differences shorter: with 20 bits, the relative error is at most
+ * 2^-21, well below the error of the estimators, and a TDigest of 100
+ * centroids takes about 5 bytes per centroid, instead of 10 losslessly and 16
+ * as pairs of doubles.
+ *
+ * Deserialization reads directly from the, possibly chained, buffers of a
+ * Cursor, without coalescing them. Truncated input throws std::out_of_range,
+ * and invalid input throws std::invalid_argument.
+ */
+constexpr size_t kDigestLosslessPrecisionBits = 52;
+
+void serializeTDigest(
+    const TDigest& digest,
+    io::QueueAppender& out,
+    size_t precisionBits = kDigestLosslessPrecisionBits);
+
+TDigest deserializeTDigest(io::Cursor& cursor);
+
+template <class Q>
+void serializeQuantileHistogram(
+    const QuantileHistogram<Q>& hist,
+    io::QueueAppender& out,
+    size_t precisionBits = kDigestLosslessPrecisionBits);
+
+/*
+ * Throws std::invalid_argument if the histogram was serialized with different
+ * quantiles.
+ */
+template <class Q = PredefinedQuantiles::Default>
+QuantileHistogram<Q> deserializeQuantileHistogram(io::Cursor& cursor);
+
+namespace detail {
+
+void writeDigestVarint(io::QueueAppender& out, uint64_t value);
+
+uint64_t readDigestVarint(io::Cursor& cursor);
+
+void writeDigestHeader(
+    io::QueueAppender& out, uint8_t version, size_t precisionBits);
+
+// Checks the version, and returns the precision.
+size_t readDigestHeader(io::Cursor& cursor, uint8_t version, const char* what);
+
+// Encodes a sequence of doubles as the deltas of their rounded order
+// preserving integer representations, which are small if the sequence is
+// sorted.
+class DigestDeltaEncoder {
+ public:
+  explicit DigestDeltaEncoder(size_t precisionBits)
+      : shift_(kDigestLosslessPrecisionBits - precisionBits) {}
+
+  void write(io::QueueAppender& out, double value);
+
+ private:
+  size_t shift_;
+  uint64_t prev_{0};
+};
+
+class DigestDeltaDecoder {
+ public:
+  explicit DigestDeltaDecoder(size_t precisionBits)
+      : shift_(kDigestLosslessPrecisionBits - precisionBits) {}
+
+  double read(io::Cursor& cursor);
+  double read(ByteRange& bytes);
+
+ private:
+  double decode(uint64_t zigzag);
+
+  size_t shift_;
+  uint64_t prev_{0};
+};
+
+constexpr uint8_t kQuantileHistogramSerializationVersion = 1;
+
+} // namespace detail
+
+template <class Q>
+void serializeQuantileHistogram(
+    const QuantileHistogram<Q>& hist,
+    io::QueueAppender& out,
+    size_t precisionBits) {
+  detail::writeDigestHeader(
+      out, detail::kQuantileHistogramSerializationVersion, precisionBits);
+  detail::writeDigestVarint(out, hist.quantiles().size());
+  detail::writeDigestVarint(out, hist.count());
+  if (hist.empty()) {
+    return;
+  }
+  detail::DigestDeltaEncoder encoder(precisionBits);
+  for (double location : hist.locations()) {
+    encoder.write(out, location);
+  }
+}
+
+template <class Q>
+QuantileHistogram<Q> deserializeQuantileHistogram(io::Cursor& cursor) {
+  auto precisionBits = detail::readDigestHeader(
+      cursor,
+      detail::kQuantileHistogramSerializationVersion,
+      "QuantileHistogram");
+  if (detail::readDigestVarint(cursor) != Q::kQuantiles.size()) {
+    throw_exception<std::invalid_argument>(
+        "QuantileHistogram was serialized with different quantiles");
+  }
+  auto count = detail::readDigestVarint(cursor);
+  if (count == 0) {
+    return QuantileHistogram<Q>();
+  }
+  std::remove_const_t<decltype(Q::kQuantiles)> locations;
+  detail::DigestDeltaDecoder decoder(precisionBits);
+  for (auto& location : locations) {
+    location = decoder.read(cursor);
+  }
+  for (size_t i = 1; i < locations.size(); ++i) {
+    if (!(locations[i - 1] <= locations[i])) {
+      throw_exception<std::invalid_argument>(
+          "QuantileHistogram locations are not sorted");
+    }
+  }
+  return QuantileHistogram<Q>(locations, count);
+}
+
+} // namespace folly
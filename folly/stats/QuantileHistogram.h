@@ -89,6 +89,15 @@ class QuantileHistogram {
   QuantileHistogram() = default;
   explicit QuantileHistogram(size_t) : QuantileHistogram() {}
 
+  /*
+   * Constructs a histogram from the locations of its quantiles, in the order
+   * of quantiles(), as estimated by other means.
+   */
+  QuantileHistogram(const decltype(Q::kQuantiles)& locations, uint64_t count)
+      : locations_(locations), count_(count) {
+    dcheckSane();
+  }
+
   static constexpr decltype(Q::kQuantiles) quantiles() { return Q::kQuantiles; }
 
   /*
@@ -117,6 +126,11 @@ class QuantileHistogram {
 
   double max() const { return locations_.back(); }
 
+  /*
+   * The locations of the quantiles, in the order of quantiles().
+   */
+  const decltype(Q::kQuantiles)& locations() const { return locations_; }
+
   std::string debugString() const;
 
  private:
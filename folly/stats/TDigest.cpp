@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <optional>
 
 #include <glog/logging.h>
@@ -107,6 +108,52 @@ class Buffer : NonCopyableNonMovable {
   size_t size_;
 };
 
+// Maps doubles to integers with the same order.
+// See http://stereopsis.com/radix.html for details.
+uint64_t radixKey(double d) {
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  uint64_t mask = -int64_t(bits >> 63) | 0x8000000000000000;
+  return bits ^ mask;
+}
+
+// Sorts the union of the sorted runs of centroids with a LSD radix sort of
+// their means, one byte at a time, skipping the bytes that all the means
+// share.
+template <class Runs>
+std::vector<TDigest::Centroid> radixSortRuns(
+    const Runs& runs, size_t nCentroids) {
+  std::vector<TDigest::Centroid> centroids;
+  centroids.reserve(nCentroids);
+  for (const auto& run : runs) {
+    centroids.insert(centroids.end(), run.begin(), run.end());
+  }
+  std::vector<TDigest::Centroid> tmp(nCentroids);
+  std::vector<size_t> counts(8 * 256);
+  for (const auto& c : centroids) {
+    auto key = radixKey(c.mean());
+    for (size_t b = 0; b < 8; ++b) {
+      ++counts[b * 256 + ((key >> (8 * b)) & 0xff)];
+    }
+  }
+  for (size_t b = 0; b < 8; ++b) {
+    auto* count = &counts[b * 256];
+    auto key = radixKey(centroids[0].mean());
+    if (count[(key >> (8 * b)) & 0xff] == nCentroids) {
+      continue;
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < 256; ++i) {
+      pos += std::exchange(count[i], pos);
+    }
+    for (const auto& c : centroids) {
+      tmp[count[(radixKey(c.mean()) >> (8 * b)) & 0xff]++] = c;
+    }
+    centroids.swap(tmp);
+  }
+  return centroids;
+}
+
 } // namespace
 
 class TDigest::CentroidMerger {
@@ -216,7 +263,7 @@ TDigest::TDigest(
 
 // Merge unsorted values by first sorting them.
 TDigest TDigest::merge(Range<const double*> unsortedValues) const {
-  constexpr size_t kRadixSortThreshold = 700;
+  constexpr size_t kRadixSortThreshold = 300;
 
   auto n = unsortedValues.size();
 
@@ -397,21 +444,33 @@ template <class T>
     }
   }
 
-  // Use a heap to iterate the union of the centroids to merge in sorted order.
-  std::make_heap(cursors.begin(), cursors.end());
-
   std::vector<Centroid> workingBuffer;
   workingBuffer.reserve(maxSize);
   CentroidMerger merger(std::move(workingBuffer), maxSize, count);
-  while (!cursors.empty()) {
-    auto& top = cursors.front();
-    merger.append(top.front());
-    top.pop_front();
-    if (top.empty()) {
-      top = cursors.back();
-      cursors.pop_back();
+
+  // Each centroid popped from the heap costs log(cursors) unpredictable
+  // compares, while the radix sort costs the same for any number of digests,
+  // so it is faster for many of them.
+  constexpr size_t kMaxHeapMergeDigests = 48;
+
+  if (cursors.size() > kMaxHeapMergeDigests) {
+    for (const auto& centroid : radixSortRuns(cursors, nCentroids)) {
+      merger.append(centroid);
+    }
+  } else {
+    // Use a heap to iterate the union of the centroids to merge in sorted
+    // order.
+    std::make_heap(cursors.begin(), cursors.end());
+    while (!cursors.empty()) {
+      auto& top = cursors.front();
+      merger.append(top.front());
+      top.pop_front();
+      if (top.empty()) {
+        top = cursors.back();
+        cursors.pop_back();
+      }
+      down_heap(cursors.begin(), cursors.end());
     }
-    down_heap(cursors.begin(), cursors.end());
   }
 
   TDigest result(maxSize);
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/ConcurrentLogHistogram.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+using Histogram = ConcurrentLogHistogram<>;
+
+TEST(ConcurrentLogHistogramTest, Buckets) {
+  // Every value is in the bucket that bucketIndex() returns, and the buckets
+  // cover the whole range contiguously.
+  EXPECT_EQ(0, Histogram::bucketMin(0));
+  for (size_t b = 1; b < Histogram::kNumBuckets; ++b) {
+    EXPECT_EQ(Histogram::bucketMax(b - 1) + 1, Histogram::bucketMin(b));
+    EXPECT_EQ(b, Histogram::bucketIndex(Histogram::bucketMin(b)));
+    EXPECT_EQ(b, Histogram::bucketIndex(Histogram::bucketMax(b)));
+    // Precision
+    auto width = Histogram::bucketMax(b) - Histogram::bucketMin(b) + 1;
+    EXPECT_LE(width * 16, std::max<uint64_t>(Histogram::bucketMin(b), 16));
+  }
+  EXPECT_EQ(
+      std::numeric_limits<uint64_t>::max(),
+      Histogram::bucketMax(Histogram::kNumBuckets - 1));
+  EXPECT_EQ(31, Histogram::bucketIndex(31));
+  EXPECT_EQ(32, Histogram::bucketIndex(32));
+  EXPECT_EQ(32, Histogram::bucketIndex(33));
+  EXPECT_EQ(33, Histogram::bucketIndex(34));
+}
+
+TEST(ConcurrentLogHistogramTest, Empty) {
+  Histogram hist;
+  auto snapshot = hist.snapshot();
+  EXPECT_TRUE(snapshot.empty());
+  EXPECT_EQ(0, snapshot.count());
+  EXPECT_EQ(0, snapshot.min());
+  EXPECT_EQ(0, snapshot.max());
+  EXPECT_EQ(0.0, snapshot.estimateQuantile(0.5));
+  EXPECT_TRUE(snapshot.toTDigest().empty());
+}
+
+TEST(ConcurrentLogHistogramTest, Quantiles) {
+  Histogram hist;
+  for (uint64_t i = 1; i <= 100000; ++i) {
+    hist.addValue(i);
+  }
+  auto snapshot = hist.snapshot();
+  EXPECT_EQ(100000, snapshot.count());
+  EXPECT_EQ(uint64_t(100000) * 100001 / 2, snapshot.sum());
+  EXPECT_EQ(1, snapshot.min());
+  EXPECT_EQ(100000, snapshot.max());
+  EXPECT_EQ(1, snapshot.estimateQuantile(0.0));
+  EXPECT_EQ(100000, snapshot.estimateQuantile(1.0));
+  for (double q : {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+    EXPECT_NEAR(q * 100000, snapshot.estimateQuantile(q), q * 100000 / 16)
+        << q;
+  }
+
+  auto digest = snapshot.toTDigest();
+  EXPECT_EQ(100000, digest.count());
+  EXPECT_EQ(1, digest.min());
+  EXPECT_EQ(100000, digest.max());
+  for (double q : {0.01, 0.5, 0.99}) {
+    EXPECT_NEAR(q * 100000, digest.estimateQuantile(q), q * 100000 / 10) << q;
+  }
+
+  auto qhist = snapshot.toQuantileHistogram();
+  EXPECT_EQ(100000, qhist.count());
+  EXPECT_EQ(1, qhist.min());
+  EXPECT_EQ(100000, qhist.max());
+  EXPECT_EQ(snapshot.estimateQuantile(0.99), qhist.estimateQuantile(0.99));
+}
+
+TEST(ConcurrentLogHistogramTest, ExtremeValues) {
+  Histogram hist;
+  hist.addValue(0);
+  hist.addValue(std::numeric_limits<uint64_t>::max());
+  auto snapshot = hist.snapshot();
+  EXPECT_EQ(2, snapshot.count());
+  EXPECT_EQ(0, snapshot.min());
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), snapshot.max());
+  EXPECT_EQ(1, snapshot.bucketCount(0));
+  EXPECT_EQ(1, snapshot.bucketCount(Histogram::kNumBuckets - 1));
+}
+
+TEST(ConcurrentLogHistogramTest, Clear) {
+  Histogram hist;
+  hist.addValue(42);
+  hist.clear();
+  EXPECT_TRUE(hist.snapshot().empty());
+  hist.addValue(7);
+  auto snapshot = hist.snapshot();
+  EXPECT_EQ(1, snapshot.count());
+  EXPECT_EQ(7, snapshot.min());
+  EXPECT_EQ(7, snapshot.max());
+}
+
+TEST(ConcurrentLogHistogramTest, Concurrent) {
+  constexpr size_t kNumThreads = 8;
+  constexpr size_t kNumValues = 100000;
+  Histogram hist;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&hist, t] {
+      std::mt19937_64 rng(t);
+      std::uniform_int_distribution<uint64_t> dist(1000, 2000);
+      for (size_t i = 0; i < kNumValues; ++i) {
+        hist.addValue(dist(rng));
+      }
+    });
+  }
+  // Concurrent reads see a consistent prefix of the counts.
+  for (int i = 0; i < 10; ++i) {
+    auto snapshot = hist.snapshot();
+    if (!snapshot.empty()) {
+      EXPECT_GE(snapshot.min(), 1000);
+      EXPECT_LE(snapshot.max(), 2000);
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = hist.snapshot();
+  EXPECT_EQ(kNumThreads * kNumValues, snapshot.count());
+  EXPECT_NEAR(1500, snapshot.estimateQuantile(0.5), 1500 / 16);
+  EXPECT_NEAR(1500, snapshot.mean(), 5);
+}
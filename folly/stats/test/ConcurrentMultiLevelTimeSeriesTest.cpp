@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/ConcurrentMultiLevelTimeSeries.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+using std::chrono::seconds;
+
+using StatsClock = LegacyStatsClock<seconds>;
+using TimePoint = StatsClock::time_point;
+
+namespace {
+
+TimePoint mkTimePoint(int value) {
+  return TimePoint(StatsClock::duration(value));
+}
+
+// 1 minute, 1 hour and all-time levels.
+const seconds kDurations[] = {seconds(60), seconds(3600), seconds(0)};
+
+} // namespace
+
+TEST(ConcurrentMultiLevelTimeSeries, SameAsMultiLevelTimeSeries) {
+  ConcurrentMultiLevelTimeSeries<int64_t> concurrent(60, range(kDurations));
+  MultiLevelTimeSeries<int64_t> expected(60, range(kDurations));
+
+  std::mt19937 gen(42);
+  int time = 0;
+  for (int i = 0; i < 10000; ++i) {
+    time += gen() % 2;
+    auto value = int64_t(gen() % 1000);
+    concurrent.addValue(mkTimePoint(time), value);
+    expected.addValue(mkTimePoint(time), value);
+    if (i % 1000 == 0) {
+      auto now = mkTimePoint(time);
+      expected.update(now);
+      auto snapshot = concurrent.snapshot(now);
+      for (size_t level = 0; level < expected.numLevels(); ++level) {
+        EXPECT_EQ(expected.sum(level), snapshot.sum(level));
+        EXPECT_EQ(expected.count(level), snapshot.count(level));
+        EXPECT_EQ(expected.rate(level), snapshot.rate(level));
+      }
+    }
+  }
+
+  // Time passes without new values.
+  auto now = mkTimePoint(time + 120);
+  expected.update(now);
+  concurrent.withTimeSeries(now, [&](const auto& timeSeries) {
+    EXPECT_EQ(0, timeSeries.count(0));
+    for (size_t level = 0; level < expected.numLevels(); ++level) {
+      EXPECT_EQ(expected.sum(level), timeSeries.sum(level));
+      EXPECT_EQ(expected.count(level), timeSeries.count(level));
+    }
+  });
+}
+
+TEST(ConcurrentMultiLevelTimeSeries, Concurrent) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumSeconds = 100;
+  constexpr int kValuesPerSecond = 1000;
+  ConcurrentMultiLevelTimeSeries<int64_t> ts(60, range(kDurations));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int s = 0; s < kNumSeconds; ++s) {
+        for (int i = 0; i < kValuesPerSecond; ++i) {
+          ts.addValue(mkTimePoint(s), 2);
+        }
+      }
+    });
+  }
+  // Reads in the meantime may see the sum of the values being added and not
+  // their count, or the reverse.
+  for (int s = 0; s < kNumSeconds; ++s) {
+    auto snapshot = ts.snapshot(mkTimePoint(s));
+    EXPECT_NEAR(2 * snapshot.count(2), snapshot.sum(2), 2 * kNumThreads);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = ts.snapshot(mkTimePoint(kNumSeconds - 1));
+  constexpr int64_t kTotal = kNumThreads * kNumSeconds * kValuesPerSecond;
+  EXPECT_EQ(kTotal, snapshot.count(2));
+  EXPECT_EQ(2 * kTotal, snapshot.sum(2));
+  // Values are counted at their time, except the few added concurrently with
+  // a change of time of their shard.
+  EXPECT_NEAR(kTotal * 60 / kNumSeconds, snapshot.count(0), kTotal / 100);
+}
+
+TEST(ConcurrentMultiLevelTimeSeries, Double) {
+  ConcurrentMultiLevelTimeSeries<double> ts(60, range(kDurations));
+  ts.addValue(mkTimePoint(0), 0.5);
+  ts.addValue(mkTimePoint(1), 0.25, 4);
+  ts.addValueAggregated(mkTimePoint(1), 3.0, 2);
+  auto snapshot = ts.snapshot(mkTimePoint(1));
+  EXPECT_EQ(4.5, snapshot.sum(0));
+  EXPECT_EQ(7, snapshot.count(0));
+  EXPECT_EQ(4.5 / 7, snapshot.avg(0));
+}
+
+TEST(ConcurrentMultiLevelTimeSeries, Clear) {
+  ConcurrentMultiLevelTimeSeries<int64_t> ts(60, range(kDurations));
+  ts.addValue(mkTimePoint(0), 10);
+  ts.addValue(mkTimePoint(1), 20);
+  EXPECT_EQ(30, ts.snapshot(mkTimePoint(1)).sum(2));
+  ts.addValue(mkTimePoint(2), 40);
+  ts.clear();
+  EXPECT_EQ(0, ts.snapshot(mkTimePoint(2)).sum(2));
+  ts.addValue(mkTimePoint(2), 5);
+  EXPECT_EQ(5, ts.snapshot(mkTimePoint(2)).sum(2));
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/DigestSerialization.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+TDigest makeDigest(size_t numValues) {
+  std::mt19937 gen(42);
+  std::lognormal_distribution<double> dist(0.0, 1.0);
+  std::vector<double> values;
+  for (size_t i = 0; i < numValues; ++i) {
+    values.push_back(dist(gen));
+    values.push_back(-dist(gen));
+  }
+  return TDigest(100).merge(values);
+}
+
+std::unique_ptr<IOBuf> serialize(
+    const TDigest& digest,
+    size_t precisionBits = kDigestLosslessPrecisionBits) {
+  IOBufQueue queue;
+  io::QueueAppender appender(&queue, 1024);
+  serializeTDigest(digest, appender, precisionBits);
+  return queue.move();
+}
+
+TDigest deserialize(const IOBuf& buf) {
+  io::Cursor cursor(&buf);
+  auto digest = deserializeTDigest(cursor);
+  EXPECT_TRUE(cursor.isAtEnd());
+  return digest;
+}
+
+// Copies the buffer to a chain of one byte buffers.
+std::unique_ptr<IOBuf> fragment(const IOBuf& buf) {
+  auto data = buf.to<std::string>();
+  auto chain = IOBuf::copyBuffer(data.data(), 1);
+  for (size_t i = 1; i < data.size(); ++i) {
+    chain->appendToChain(IOBuf::copyBuffer(data.data() + i, 1));
+  }
+  return chain;
+}
+
+void expectSameDigest(const TDigest& expected, const TDigest& actual) {
+  EXPECT_EQ(expected.maxSize(), actual.maxSize());
+  EXPECT_EQ(expected.sum(), actual.sum());
+  EXPECT_EQ(expected.count(), actual.count());
+  EXPECT_EQ(expected.min(), actual.min());
+  EXPECT_EQ(expected.max(), actual.max());
+  ASSERT_EQ(expected.getCentroids().size(), actual.getCentroids().size());
+  for (size_t i = 0; i < expected.getCentroids().size(); ++i) {
+    EXPECT_EQ(
+        expected.getCentroids()[i].mean(), actual.getCentroids()[i].mean());
+    EXPECT_EQ(
+        expected.getCentroids()[i].weight(),
+        actual.getCentroids()[i].weight());
+  }
+}
+
+} // namespace
+
+TEST(DigestSerializationTest, TDigestLossless) {
+  auto digest = makeDigest(10000);
+  auto buf = serialize(digest);
+  expectSameDigest(digest, deserialize(*buf));
+  expectSameDigest(digest, deserialize(*fragment(*buf)));
+}
+
+TEST(DigestSerializationTest, TDigestEmpty) {
+  TDigest digest(123);
+  auto result = deserialize(*serialize(digest));
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(123, result.maxSize());
+  EXPECT_EQ(0, result.count());
+}
+
+TEST(DigestSerializationTest, TDigestFractionalWeights) {
+  std::vector<TDigest::Centroid> centroids{
+      TDigest::Centroid(1.0, 0.5),
+      TDigest::Centroid(2.0, 1.0),
+      TDigest::Centroid(4.0, 2.25)};
+  TDigest digest(std::move(centroids), 11.5, 3.75, 4.0, 1.0);
+  expectSameDigest(digest, deserialize(*serialize(digest)));
+}
+
+TEST(DigestSerializationTest, TDigestPrecision) {
+  auto digest = makeDigest(10000);
+  auto lossless = serialize(digest)->computeChainDataLength();
+  auto buf = serialize(digest, 20);
+  EXPECT_LT(buf->computeChainDataLength(), lossless * 2 / 3);
+  EXPECT_LT(buf->computeChainDataLength(), 6 * digest.getCentroids().size());
+
+  auto result = deserialize(*buf);
+  EXPECT_EQ(digest.sum(), result.sum());
+  EXPECT_EQ(digest.count(), result.count());
+  EXPECT_EQ(digest.min(), result.min());
+  EXPECT_EQ(digest.max(), result.max());
+  ASSERT_EQ(digest.getCentroids().size(), result.getCentroids().size());
+  for (size_t i = 0; i < digest.getCentroids().size(); ++i) {
+    double expected = digest.getCentroids()[i].mean();
+    double tolerance = std::ldexp(std::abs(expected), -20);
+    EXPECT_NEAR(expected, result.getCentroids()[i].mean(), tolerance);
+    EXPECT_EQ(
+        digest.getCentroids()[i].weight(), result.getCentroids()[i].weight());
+  }
+  for (double q : {0.001, 0.01, 0.5, 0.99, 0.999}) {
+    double expected = digest.estimateQuantile(q);
+    double tolerance = std::ldexp(std::abs(expected), -20);
+    EXPECT_NEAR(expected, result.estimateQuantile(q), tolerance);
+  }
+
+  // Zero bits of mantissa keeps the powers of two.
+  result = deserialize(*serialize(digest, 0));
+  for (const auto& c : result.getCentroids()) {
+    int exp;
+    EXPECT_EQ(0.5, std::abs(std::frexp(c.mean(), &exp)));
+  }
+}
+
+TEST(DigestSerializationTest, TDigestInvalid) {
+  auto buf = serialize(makeDigest(1000));
+  auto data = buf->coalesce();
+
+  // Truncated
+  for (size_t size : {size_t(0), size_t(3), data.size() / 2, data.size() - 1}) {
+    auto truncated = IOBuf::wrapBuffer(data.data(), size);
+    io::Cursor cursor(truncated.get());
+    EXPECT_THROW(deserializeTDigest(cursor), std::out_of_range) << size;
+  }
+
+  // Unknown version
+  auto copy = IOBuf::copyBuffer(data);
+  copy->writableData()[0] = 2;
+  io::Cursor cursor(copy.get());
+  EXPECT_THROW(deserializeTDigest(cursor), std::invalid_argument);
+
+  // Too many bits of precision
+  IOBufQueue queue;
+  io::QueueAppender appender(&queue, 1024);
+  EXPECT_THROW(
+      serializeTDigest(makeDigest(10), appender, 53), std::invalid_argument);
+}
+
+TEST(DigestSerializationTest, QuantileHistogram) {
+  QuantileHistogram<> hist;
+  std::mt19937 gen(42);
+  std::lognormal_distribution<double> dist(0.0, 1.0);
+  for (size_t i = 0; i < 10000; ++i) {
+    hist.addValue(dist(gen));
+  }
+
+  for (size_t precisionBits : {52, 20}) {
+    IOBufQueue queue;
+    io::QueueAppender appender(&queue, 1024);
+    serializeQuantileHistogram(hist, appender, precisionBits);
+    auto buf = fragment(*queue.move());
+
+    io::Cursor cursor(buf.get());
+    auto result = deserializeQuantileHistogram<>(cursor);
+    EXPECT_TRUE(cursor.isAtEnd());
+    EXPECT_EQ(hist.count(), result.count());
+    for (size_t i = 0; i < hist.quantiles().size(); ++i) {
+      double expected = hist.locations()[i];
+      if (precisionBits == 52) {
+        EXPECT_EQ(expected, result.locations()[i]);
+      } else {
+        double tolerance = std::ldexp(std::abs(expected), -20);
+        EXPECT_NEAR(expected, result.locations()[i], tolerance);
+      }
+    }
+
+    // The quantiles must match.
+    cursor = io::Cursor(buf.get());
+    EXPECT_THROW(
+        deserializeQuantileHistogram<PredefinedQuantiles::Median>(cursor),
+        std::invalid_argument);
+  }
+
+  IOBufQueue queue;
+  io::QueueAppender appender(&queue, 1024);
+  serializeQuantileHistogram(QuantileHistogram<>(), appender);
+  auto buf = queue.move();
+  io::Cursor cursor(buf.get());
+  EXPECT_TRUE(deserializeQuantileHistogram<>(cursor).empty());
+}
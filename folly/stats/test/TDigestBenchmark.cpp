@@ -97,6 +97,31 @@ void merge(unsigned int iters, size_t maxSize, size_t bufSize) {
   }
 }
 
+void mergeUnsorted(unsigned int iters, size_t maxSize, size_t bufSize) {
+  TDigest digest(maxSize);
+
+  std::vector<std::vector<double>> buffers;
+
+  BENCHMARK_SUSPEND {
+    std::default_random_engine generator;
+    generator.seed(std::chrono::system_clock::now().time_since_epoch().count());
+
+    std::lognormal_distribution<double> distribution(0.0, 1.0);
+
+    for (size_t i = 0; i < iters; ++i) {
+      std::vector<double> buffer;
+      for (size_t j = 0; j < bufSize; ++j) {
+        buffer.push_back(distribution(generator));
+      }
+      buffers.push_back(std::move(buffer));
+    }
+  }
+
+  for (const auto& buffer : buffers) {
+    digest = digest.merge(buffer);
+  }
+}
+
 void mergeDigests(unsigned int iters, size_t maxSize, size_t nDigests) {
   std::vector<TDigest> digests;
   BENCHMARK_SUSPEND {
@@ -165,11 +190,21 @@ BENCHMARK_RELATIVE_NAMED_PARAM(merge, 1000x1, 1000, 1000)
 BENCHMARK_RELATIVE_NAMED_PARAM(merge, 1000x5, 1000, 5000)
 BENCHMARK_RELATIVE_NAMED_PARAM(merge, 1000x10, 1000, 10000)
 
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(mergeUnsorted, 100x1, 100, 100)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeUnsorted, 100x3, 100, 300)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeUnsorted, 100x5, 100, 500)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeUnsorted, 100x7, 100, 700)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeUnsorted, 100x10, 100, 1000)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeUnsorted, 1000x10, 1000, 10000)
+
 BENCHMARK_DRAW_LINE();
 BENCHMARK_NAMED_PARAM(mergeDigests, 100x10, 100, 10)
 BENCHMARK_RELATIVE_NAMED_PARAM(mergeDigests, 100x30, 100, 30)
 BENCHMARK_RELATIVE_NAMED_PARAM(mergeDigests, 100x60, 100, 60)
 BENCHMARK_RELATIVE_NAMED_PARAM(mergeDigests, 1000x60, 1000, 60)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeDigests, 100x1000, 100, 1000)
+BENCHMARK_RELATIVE_NAMED_PARAM(mergeDigests, 100x10000, 100, 10000)
 
 BENCHMARK_DRAW_LINE();
 BENCHMARK_NAMED_PARAM(estimateQuantile, 100x1_p001, 100, 0.001)
@@ -156,6 +156,49 @@ TEST(TDigest, MergeLargeAsDigests) {
   EXPECT_EQ(999.5, digest.estimateQuantile(0.999));
 }
 
+TEST(TDigest, MergeManyDigests) {
+  std::vector<double> values;
+  for (int i = 1; i <= 500; ++i) {
+    values.push_back(i);
+    values.push_back(-i);
+  }
+  std::shuffle(
+      values.begin(), values.end(), std::mt19937(std::random_device()()));
+
+  // Each value is its own centroid in the digests to merge, so merging them is
+  // the same as compressing the sorted values as centroids.
+  auto sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<TDigest::Centroid> centroids;
+  for (auto value : sorted) {
+    centroids.emplace_back(value, 1.0);
+  }
+  TDigest expected(std::move(centroids), 0, 1000, 500, -500, 100);
+
+  // Few and many digests, of uneven sizes.
+  for (size_t numDigests : {3, 10, 49, 100, 1000}) {
+    // The merged digest takes the maxSize of the first one.
+    std::vector<TDigest> digests{TDigest(100)};
+    for (size_t i = 0; i < numDigests; ++i) {
+      auto begin = values.begin() + i * values.size() / numDigests;
+      auto end = values.begin() + (i + 1) * values.size() / numDigests;
+      digests.push_back(TDigest(1000).merge(std::vector<double>(begin, end)));
+    }
+
+    auto digest = TDigest::merge(digests);
+
+    EXPECT_EQ(expected.getCentroids().size(), digest.getCentroids().size());
+    EXPECT_EQ(1000, digest.count());
+    EXPECT_EQ(0, digest.sum());
+    EXPECT_EQ(-500, digest.min());
+    EXPECT_EQ(500, digest.max());
+    for (double q : {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+      EXPECT_EQ(expected.estimateQuantile(q), digest.estimateQuantile(q))
+          << numDigests << " digests, q = " << q;
+    }
+  }
+}
+
 TEST(TDigest, NegativeValues) {
   std::vector<TDigest> digests;
   TDigest digest(100);
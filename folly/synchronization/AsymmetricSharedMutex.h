@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#include <glog/logging.h>
+
+#include <folly/Likely.h>
+#include <folly/ThreadLocal.h>
+#include <folly/detail/Futex.h>
+#include <folly/synchronization/AsymmetricThreadFence.h>
+#include <folly/synchronization/detail/ThreadCachedReaders.h>
+
+namespace folly {
+
+namespace detail {
+struct AsymmetricSharedMutexTag;
+} // namespace detail
+
+/// A reader-writer mutex for read-mostly data, such as configuration looked up
+/// on every request, whose readers never write a shared cache line.
+///
+/// SharedMutex's deferred readers and RCU's version counter still have readers
+/// CAS a shared slot or read a line that writers keep dirtying. Here a reader
+/// only stores to a counter owned by its thread and reads the writer flag,
+/// ordering the two with asymmetric_thread_fence_light. The writer pays for
+/// both sides with asymmetric_thread_fence_heavy, a membarrier() where
+/// available, before it scans the counters of all threads. Uncontended read
+/// lock and unlock thus cost a thread local lookup and a compiler barrier, and
+/// scale with the number of cores, while lock() costs a system call and a walk
+/// over all threads.
+///
+/// Read locks are recursive, and must be unlocked on the thread that locked
+/// them before that thread exits. Every thread that ever read locks an
+/// instance keeps a counter for it until either exits, so prefer few long
+/// lived instances. Writers are not starved: once a writer is waiting, new
+/// (non-nested) readers block until it is done.
+///
+///     folly::AsymmetricSharedMutex mutex;
+///     Config config;
+///
+///     // Readers.
+///     std::shared_lock lock{mutex};
+///     use(config);
+///
+///     // Writer.
+///     std::unique_lock lock{mutex};
+///     config = newConfig;
+class AsymmetricSharedMutex {
+ public:
+  AsymmetricSharedMutex() = default;
+  AsymmetricSharedMutex(const AsymmetricSharedMutex&) = delete;
+  AsymmetricSharedMutex& operator=(const AsymmetricSharedMutex&) = delete;
+
+  void lock_shared() {
+    auto& readers = localReaders();
+    while (FOLLY_UNLIKELY(!tryLockShared(readers))) {
+      detail::futexWait(&writer_, 1);
+    }
+  }
+
+  bool try_lock_shared() { return tryLockShared(localReaders()); }
+
+  void unlock_shared() {
+    auto readers = readers_.get();
+    DCHECK(readers != nullptr);
+    // Orders the critical section before the decrement, matches D.
+    folly::asymmetric_thread_fence_light(std::memory_order_seq_cst);
+    uint32_t count = readers->count;
+    DCHECK_GT(count, 0u);
+    readers->count = count - 1;
+    wakeWriter();
+  }
+
+  void lock() {
+    writerMutex_.lock();
+    writer_.store(1, std::memory_order_relaxed);
+    // Matches A and C, either the readers see writer_ or we see their counts.
+    waiting_.store(1, std::memory_order_relaxed);
+    folly::asymmetric_thread_fence_heavy(std::memory_order_seq_cst); // D
+    while (!readersClear()) {
+      detail::futexWait(&waiting_, 1);
+      waiting_.store(1, std::memory_order_relaxed);
+      folly::asymmetric_thread_fence_heavy(std::memory_order_seq_cst); // D
+    }
+    waiting_.store(0, std::memory_order_relaxed);
+  }
+
+  bool try_lock() {
+    if (!writerMutex_.try_lock()) {
+      return false;
+    }
+    writer_.store(1, std::memory_order_relaxed);
+    folly::asymmetric_thread_fence_heavy(std::memory_order_seq_cst); // D
+    if (readersClear()) {
+      return true;
+    }
+    unlockWriter();
+    return false;
+  }
+
+  void unlock() { unlockWriter(); }
+
+ private:
+  struct Readers {
+    detail::thread_cached_readers_atomic<uint32_t> count{0};
+
+    ~Readers() { DCHECK_EQ(0u, uint32_t(count)) << "read lock held on exit"; }
+  };
+
+  Readers& localReaders() {
+    auto readers = readers_.get();
+    if (FOLLY_UNLIKELY(readers == nullptr)) {
+      readers = new Readers();
+      readers_.reset(readers);
+    }
+    return *readers;
+  }
+
+  bool tryLockShared(Readers& readers) {
+    uint32_t count = readers.count;
+    DCHECK_LT(count, std::numeric_limits<uint32_t>::max());
+    readers.count = count + 1;
+    // Nested readers must not wait for a writer that waits for them.
+    if (count != 0) {
+      return true;
+    }
+    folly::asymmetric_thread_fence_light(std::memory_order_seq_cst); // A
+    if (FOLLY_LIKELY(writer_.load(std::memory_order_acquire) == 0)) {
+      return true;
+    }
+    // Back off, a writer may already be waiting for us.
+    readers.count = count;
+    wakeWriter();
+    return false;
+  }
+
+  void wakeWriter() {
+    folly::asymmetric_thread_fence_light(std::memory_order_seq_cst); // C
+    if (FOLLY_UNLIKELY(waiting_.load(std::memory_order_relaxed))) {
+      waiting_.store(0, std::memory_order_relaxed);
+      detail::futexWake(&waiting_);
+    }
+  }
+
+  bool readersClear() {
+    auto access = readers_.accessAllThreads();
+    return std::all_of(access.begin(), access.end(), [](const Readers& r) {
+      return r.count == 0;
+    });
+  }
+
+  void unlockWriter() {
+    writer_.store(0, std::memory_order_release);
+    detail::futexWake(&writer_);
+    writerMutex_.unlock();
+  }
+
+  folly::ThreadLocalPtr<Readers, detail::AsymmetricSharedMutexTag> readers_;
+  // Serializes writers.
+  std::mutex writerMutex_;
+  // 1 while a writer holds or waits for the lock, new readers wait on it.
+  detail::Futex<> writer_{0};
+  // 1 while a writer waits for readers to drain, readers wake it on unlock.
+  detail::Futex<> waiting_{0};
+};
+
+} // namespace folly
@@ -314,6 +314,7 @@ class Baton {
               deadline - Clock::now()));
     }
 
+    detail::adaptive_spin_timer timer{opt};
     switch (detail::spin_pause_until(deadline, opt, [this] {
       return ready();
     })) {
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+#include <folly/lang/Exception.h>
+#include <folly/lang/SafeAssert.h>
+#include <folly/synchronization/ParkingLot.h>
+
+namespace folly {
+
+/**
+ * DelayedInitPtr -- thread-safe delayed initialization of a value, like
+ * DelayedInit, but allocating the value and keeping its address in the word
+ * that otherwise serves as the once flag.
+ *
+ * The word is 0 until initialization starts, 1 while the value is being
+ * constructed (other threads park on it), and the address of the value
+ * afterwards. So an initialized DelayedInitPtr is a pointer: an access is one
+ * acquire load whose result is the value's address, not a flag check before
+ * an access to the storage next to it.
+ *
+ * Prefer DelayedInit, which keeps the value inline, unless the value is large
+ * and often never initialized (a DelayedInitPtr takes a single word until it
+ * is), or readers only need the address.
+ */
+template <typename T>
+struct DelayedInitPtr {
+  DelayedInitPtr() = default;
+  DelayedInitPtr(const DelayedInitPtr&) = delete;
+  DelayedInitPtr& operator=(const DelayedInitPtr&) = delete;
+
+  ~DelayedInitPtr() { delete get(); }
+
+  /**
+   * Gets the pre-existing value if already initialized or creates the value
+   * returned by the provided factory function. If the value already exists,
+   * then the provided function is not called. If it throws, the next call
+   * tries again.
+   */
+  template <typename Func>
+  FOLLY_ALWAYS_INLINE T& try_emplace_with(Func func) {
+    if (auto value = get(); FOLLY_LIKELY(value != nullptr)) {
+      return *value;
+    }
+    return emplace_slow(func);
+  }
+
+  /**
+   * Gets the pre-existing value if already initialized or constructs the value
+   * in-place by direct-initializing with the provided arguments.
+   */
+  template <typename... A>
+  T& try_emplace(A&&... a) {
+    return try_emplace_with([&] { return T(static_cast<A&&>(a)...); });
+  }
+  template <
+      typename U,
+      typename... A,
+      typename = std::enable_if_t<
+          std::is_constructible<T, std::initializer_list<U>, A...>::value>>
+  T& try_emplace(std::initializer_list<U> ilist, A&&... a) {
+    return try_emplace_with([&] { return T(ilist, static_cast<A&&>(a)...); });
+  }
+
+  bool has_value() const { return get() != nullptr; }
+  explicit operator bool() const { return has_value(); }
+
+  T& value() { return require_value(); }
+  const T& value() const { return require_value(); }
+
+  T& operator*() { return *checked_get(); }
+  const T& operator*() const { return *checked_get(); }
+  T* operator->() { return checked_get(); }
+  const T* operator->() const { return checked_get(); }
+
+ private:
+  static constexpr uintptr_t kEmpty = 0;
+  static constexpr uintptr_t kBusy = 1;
+
+  T* get() const noexcept {
+    auto const word = word_.load(std::memory_order_acquire);
+    return word > kBusy ? reinterpret_cast<T*>(word) : nullptr;
+  }
+
+  T* checked_get() const noexcept {
+    auto value = get();
+    FOLLY_SAFE_DCHECK(value, "tried to access empty DelayedInitPtr");
+    return value;
+  }
+
+  T& require_value() const {
+    if (auto value = get()) {
+      return *value;
+    }
+    throw_exception<std::logic_error>("tried to access empty DelayedInitPtr");
+  }
+
+  static ParkingLot<>& parkingLot() {
+    static ParkingLot<> lot;
+    return lot;
+  }
+
+  void wake() {
+    parkingLot().unpark(
+        &word_, [](auto&&) { return UnparkControl::RemoveContinue; });
+  }
+
+  template <typename Func>
+  FOLLY_NOINLINE T& emplace_slow(Func& func) {
+    auto word = word_.load(std::memory_order_acquire);
+    while (true) {
+      if (word > kBusy) {
+        return *reinterpret_cast<T*>(word);
+      }
+      if (word == kBusy) {
+        parkingLot().park(
+            &word_,
+            Unit{},
+            [&] { return word_.load(std::memory_order_relaxed) == kBusy; },
+            [] {});
+        word = word_.load(std::memory_order_acquire);
+        continue;
+      }
+      if (!word_.compare_exchange_weak(
+              word, kBusy, std::memory_order_acquire)) {
+        continue;
+      }
+      std::unique_ptr<T> value;
+      try {
+        value = std::make_unique<T>(func());
+      } catch (...) {
+        // Let a waiting thread try.
+        word_.store(kEmpty, std::memory_order_release);
+        wake();
+        throw;
+      }
+      auto const result = value.release();
+      word_.store(
+          reinterpret_cast<uintptr_t>(result), std::memory_order_release);
+      wake();
+      return *result;
+    }
+  }
+
+  // kEmpty, kBusy, or a T* to a value, allocated, and so at least 2 aligned.
+  std::atomic<uintptr_t> word_{kEmpty};
+};
+
+} // namespace folly
@@ -31,6 +31,7 @@
 #include <folly/ScopeGuard.h>
 #include <folly/Utility.h>
 #include <folly/chrono/Hardware.h>
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/detail/Futex.h>
 #include <folly/functional/Invoke.h>
 #include <folly/lang/Align.h>
@@ -161,6 +162,10 @@ constexpr auto kMaxSpinTime = CpuTicks{40000};
 // two-phased mutual exclusion to ensure that we don't starve the combiner
 // thread
 constexpr auto kMaxCombineIterations = 2;
+// The maximum number of consecutive handoffs to waiters on the same NUMA node
+// in NumaCohorts mode, before waiters on other nodes are no longer skipped.
+// This bounds the unfairness towards remote waiters
+constexpr auto kMaxCohortHandoffs = std::uint32_t{64};
 
 /**
  * Write only data that is available to the thread that is waking up another.
@@ -196,6 +201,9 @@ class WakerMetadata {
   // the current thread sees a contention chain on the mutex, it should pass
   // on this list to the next thread that gets woken up
   std::uintptr_t waiters_{0};
+  // the number of consecutive handoffs within the NUMA node of the woken
+  // thread, only maintained in NumaCohorts mode
+  std::uint32_t handoffs_{0};
   // The futex that this waiter will sleep on
   //
   // how can we reuse futex_ from above for futex management?
@@ -285,6 +293,9 @@ class Waiter {
   // Note that we use relaxed loads and stores, so this should not have any
   // additional overhead compared to a regular load on most architectures
   std::atomic<std::uintptr_t> next_{0};
+  // The NUMA node of the waiting thread in NumaCohorts mode.  Written before
+  // the release store to futex_ in initialize() and immutable after that
+  std::uint32_t node_{0};
   // We use an anonymous union for the combined critical section request and
   // the metadata that will be filled in from the leader's end.  Only one is
   // active at a time - if a leader decides to combine the requested critical
@@ -754,8 +765,23 @@ inline std::uint64_t recover(std::uint64_t from) {
   return from >> 8;
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
-class DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy {
+/**
+ * Get the NUMA node of the current thread, approximated by the last-level
+ * cache it runs on.  This uses the cached cpu of AccessSpreader, so it is
+ * cheap enough to call on every contended lock and unlock
+ */
+inline std::uint32_t numaNode() {
+  static const auto nodes = CacheLocality::system().numLastLevelCaches();
+  return static_cast<std::uint32_t>(AccessSpreader<>::cachedCurrent(nodes));
+}
+
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
+class DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy {
  public:
   DistributedMutexStateProxy() = default;
 
@@ -770,7 +796,7 @@ class DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy {
   // private:
   // friend the mutex class, since that will be accessing state private to
   // this class
-  friend class DistributedMutex<Atomic, TimePublishing>;
+  friend class DistributedMutex<Atomic, TimePublishing, NumaCohorts>;
 
   DistributedMutexStateProxy(
       Waiter<Atomic>* next,
@@ -779,14 +805,16 @@ class DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy {
       bool combined = false,
       std::uintptr_t waker = 0,
       Waiter<Atomic>* waiters = nullptr,
-      Waiter<Atomic>* ready = nullptr)
+      Waiter<Atomic>* ready = nullptr,
+      std::uint32_t handoffs = 0)
       : next_{next},
         expected_{expected},
         timedWaiters_{timedWaiter},
         combined_{combined},
         waker_{waker},
         waiters_{waiters},
-        ready_{ready} {}
+        ready_{ready},
+        handoffs_{handoffs} {}
 
   // the next thread that is to be woken up, this being null at the time of
   // unlock() shows that the current thread acquired the mutex without
@@ -829,10 +857,17 @@ class DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy {
   // unlocks has to wake up threads from this list if it has any, before it
   // goes to sleep to prevent pathological unfairness
   Waiter<Atomic>* ready_{nullptr};
+  // the number of consecutive handoffs within the current NUMA node that led
+  // to this thread acquiring the mutex, only maintained in NumaCohorts mode
+  std::uint32_t handoffs_{0};
 };
 
-template <template <typename> class Atomic, bool TimePublishing>
-DistributedMutex<Atomic, TimePublishing>::DistributedMutex()
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::DistributedMutex()
     : state_{kUnlocked} {}
 
 template <typename Waiter>
@@ -1040,10 +1075,14 @@ void wakeTimedWaiters(Atomic* state, bool timedWaiters) {
   }
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
 template <typename Func>
-auto DistributedMutex<Atomic, TimePublishing>::lock_combine(Func func)
-    -> folly::invoke_result_t<const Func&> {
+auto DistributedMutex<Atomic, TimePublishing, NumaCohorts>::lock_combine(
+    Func func) -> folly::invoke_result_t<const Func&> {
   // invoke the lock implementation function and check whether we came out of
   // it with our task executed as a combined critical section.  This usually
   // happens when the mutex is contended.
@@ -1078,17 +1117,26 @@ auto DistributedMutex<Atomic, TimePublishing>::lock_combine(Func func)
   return std::move(task).get();
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
-typename DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy
-DistributedMutex<Atomic, TimePublishing>::lock() {
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
+typename DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::lock() {
   auto null = nullptr;
   return lockImplementation(*this, state_, null);
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
 template <typename Rep, typename Period, typename Func>
 folly::Optional<invoke_result_t<Func&>>
-DistributedMutex<Atomic, TimePublishing>::try_lock_combine_for(
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::try_lock_combine_for(
     const std::chrono::duration<Rep, Period>& duration, Func func) {
   auto state = try_lock_for(duration);
   if (state) {
@@ -1101,10 +1149,14 @@ DistributedMutex<Atomic, TimePublishing>::try_lock_combine_for(
   return folly::none;
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
 template <typename Clock, typename Duration, typename Func>
 folly::Optional<invoke_result_t<Func&>>
-DistributedMutex<Atomic, TimePublishing>::try_lock_combine_until(
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::try_lock_combine_until(
     const std::chrono::time_point<Clock, Duration>& deadline, Func func) {
   auto state = try_lock_until(deadline);
   if (state) {
@@ -1117,22 +1169,27 @@ DistributedMutex<Atomic, TimePublishing>::try_lock_combine_until(
   return folly::none;
 }
 
-template <typename Atomic, template <typename> class A, bool T>
-auto tryLockNoLoad(Atomic& atomic, DistributedMutex<A, T>&) {
+template <typename Atomic, template <typename> class A, bool T, bool C>
+auto tryLockNoLoad(Atomic& atomic, DistributedMutex<A, T, C>&) {
   // Try and set the least significant bit of the centralized lock state to 1,
   // if this succeeds, it must have been the case that we had a kUnlocked (or
   // 0) in the central storage before, since that is the only case where a 0
   // can be found in the least significant bit
   //
   // If this fails, then it is a no-op
-  using Proxy = typename DistributedMutex<A, T>::DistributedMutexStateProxy;
+  using Proxy = typename DistributedMutex<A, T, C>::DistributedMutexStateProxy;
   auto previous = atomic_fetch_set(atomic, 0, std::memory_order_acquire);
   return Proxy{nullptr, previous ? 0 : kLocked};
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
-typename DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy
-DistributedMutex<Atomic, TimePublishing>::try_lock() {
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
+typename DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::try_lock() {
   // The lock attempt below requires an expensive atomic fetch-and-mutate or
   // an even more expensive atomic compare-and-swap loop depending on the
   // platform.  These operations require pulling the lock cacheline into the
@@ -1151,11 +1208,13 @@ template <
     template <typename>
     class Atomic,
     bool TimePublishing,
+    bool NumaCohorts,
     typename State,
     typename Request>
-typename DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy
+typename DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy
 lockImplementation(
-    DistributedMutex<Atomic, TimePublishing>& mutex,
+    DistributedMutex<Atomic, TimePublishing, NumaCohorts>& mutex,
     State& atomic,
     Request& request) {
   // first try and acquire the lock as a fast path, the underlying
@@ -1188,6 +1247,9 @@ lockImplementation(
     auto&& storage = makeReturnValueStorageFor(task);
     auto&& address = folly::bit_cast<std::uintptr_t>(&state);
     attach(task, storage);
+    if (NumaCohorts) {
+      state.node_ = numaNode();
+    }
     state.initialize(waitMode, std::move(task));
     DCHECK(!(address & 0b1));
 
@@ -1272,7 +1334,8 @@ lockImplementation(
         /* combined */ combineRequested && (combined || exceptionOccurred),
         /* waker */ state.metadata_.waker_,
         /* waiters */ extractPtr<Waiter<Atomic>>(state.metadata_.waiters_),
-        /* ready */ nextSleeper};
+        /* ready */ nextSleeper,
+        /* handoffs */ state.metadata_.handoffs_};
   }
 }
 
@@ -1374,7 +1437,8 @@ FOLLY_ALWAYS_INLINE std::uintptr_t tryWake(
     std::uintptr_t waker,
     Waiter*& sleepers,
     std::uint64_t iteration,
-    CombineFunction task) {
+    CombineFunction task,
+    std::uint32_t handoffs) {
   // try and combine the waiter's request first, if that succeeds that means
   // we have successfully executed their critical section and can move on to
   // the rest of the chain
@@ -1396,7 +1460,7 @@ FOLLY_ALWAYS_INLINE std::uintptr_t tryWake(
     // are unlocking the mutex, the thread we do the handoff to here should
     // see the modified data
     new (&waiter->metadata_)
-        Metadata{waker, folly::bit_cast<uintptr_t>(sleepers)};
+        Metadata{waker, folly::bit_cast<uintptr_t>(sleepers), handoffs};
     waiter->futex_.store(kWake, std::memory_order_release);
     return 0;
   }
@@ -1453,6 +1517,7 @@ FOLLY_ALWAYS_INLINE std::uintptr_t tryWake(
   DCHECK(isSleeper(value));
   waiter->metadata_.waker_ = waker;
   waiter->metadata_.waiters_ = folly::bit_cast<std::uintptr_t>(sleepers);
+  waiter->metadata_.handoffs_ = handoffs;
   auto pre =
       waiter->metadata_.sleeper_.exchange(kSleeping, std::memory_order_acq_rel);
 
@@ -1473,13 +1538,20 @@ FOLLY_ALWAYS_INLINE std::uintptr_t tryWake(
   return next;
 }
 
-template <typename Waiter>
+template <bool NumaCohorts, typename Waiter>
 bool wake(
     bool publishing,
     Waiter& waiter,
     std::uintptr_t waker,
     Waiter*& sleepers,
-    std::uint64_t iter) {
+    std::uint64_t iter,
+    std::uint32_t handoffs) {
+  // in NumaCohorts mode we skip over waiters on other NUMA nodes in the first
+  // pass over the contention chains, unless the lock has stayed within this
+  // node for too long already
+  auto node = NumaCohorts ? numaNode() : std::uint32_t{0};
+  auto cohort = NumaCohorts && !iter && (handoffs < kMaxCohortHandoffs);
+
   // loop till we find a node that is either at the end of the list (as
   // specified by waker) or we find a node that is active (as specified by
   // the last published timestamp of the node)
@@ -1499,9 +1571,26 @@ bool wake(
     // dereference when needed)
     auto value = current->futex_.load(std::memory_order_acquire);
     auto next = current->next_.load(std::memory_order_relaxed);
+
+    // only waiters that are spinning in the lock/unlock mode can be skipped,
+    // like preempted ones.  They have published their next_ pointer and will
+    // put themselves back on the mutex when they see kSkipped.  Sleepers are
+    // not skipped as they are already off the CPU, and combiners are better
+    // served by executing their critical section right here
+    //
+    // the release store is needed for the same reason as when skipping a
+    // preempted waiter in tryWake()
+    if (cohort && ((value & 0xff) == kWaiting) && (current->node_ != node)) {
+      current->futex_.store(kSkipped, std::memory_order_release);
+      current = (next == waker) ? nullptr : extractPtr<Waiter>(next);
+      continue;
+    }
+
     auto task = loadTask(current, value);
-    next =
-        tryWake(publishing, current, value, next, waker, sleepers, iter, task);
+    auto local = NumaCohorts && (current->node_ == node);
+    auto count = local ? std::min(handoffs + 1, kMaxCohortHandoffs) : 0;
+    next = tryWake(
+        publishing, current, value, next, waker, sleepers, iter, task, count);
 
     // if there is no next node, we have managed to wake someone up and have
     // successfully migrated the lock to another thread
@@ -1547,8 +1636,12 @@ bool tryUnlockClean(Atomic& state, Proxy& proxy, Sleepers sleepers) {
   }
 }
 
-template <template <typename> class Atomic, bool Publish>
-void DistributedMutex<Atomic, Publish>::unlock(
+template <
+    template <typename>
+    class Atomic,
+    bool Publish,
+    bool NumaCohorts>
+void DistributedMutex<Atomic, Publish, NumaCohorts>::unlock(
     DistributedMutex::DistributedMutexStateProxy const& proxy_) {
   auto proxy = proxy_;
   // we always wake up ready threads and timed waiters if we saw either
@@ -1563,7 +1656,13 @@ void DistributedMutex<Atomic, Publish>::unlock(
   // don't bother with the mutex state
   auto sleepers = proxy.waiters_;
   if (proxy.next_) {
-    if (wake(Publish, *proxy.next_, proxy.waker_, sleepers, 0)) {
+    if (wake<NumaCohorts>(
+            Publish,
+            *proxy.next_,
+            proxy.waker_,
+            sleepers,
+            0,
+            proxy.handoffs_)) {
       return;
     }
 
@@ -1604,7 +1703,8 @@ void DistributedMutex<Atomic, Publish>::unlock(
     auto next = extractPtr<Waiter<Atomic>>(head);
     auto expected = std::exchange(proxy.expected_, kLocked);
     DCHECK((head & kLocked) && (head != kLocked)) << "incorrect state " << head;
-    if (wake(Publish, *next, expected, sleepers, i)) {
+    if (wake<NumaCohorts>(
+            Publish, *next, expected, sleepers, i, proxy.handoffs_)) {
       break;
     }
   }
@@ -1674,10 +1774,15 @@ auto timedLock(Atomic& state, Deadline deadline, MakeProxy proxy) {
   }
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
 template <typename Clock, typename Duration>
-typename DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy
-DistributedMutex<Atomic, TimePublishing>::try_lock_until(
+typename DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::try_lock_until(
     const std::chrono::time_point<Clock, Duration>& deadline) {
   // fast path for the uncontended case
   //
@@ -1697,10 +1802,15 @@ DistributedMutex<Atomic, TimePublishing>::try_lock_until(
   return timedLock(state_, deadline, [](auto... as) { return Proxy{as...}; });
 }
 
-template <template <typename> class Atomic, bool TimePublishing>
+template <
+    template <typename>
+    class Atomic,
+    bool TimePublishing,
+    bool NumaCohorts>
 template <typename Rep, typename Period>
-typename DistributedMutex<Atomic, TimePublishing>::DistributedMutexStateProxy
-DistributedMutex<Atomic, TimePublishing>::try_lock_for(
+typename DistributedMutex<Atomic, TimePublishing, NumaCohorts>::
+    DistributedMutexStateProxy
+DistributedMutex<Atomic, TimePublishing, NumaCohorts>::try_lock_for(
     const std::chrono::duration<Rep, Period>& duration) {
   // fast path for the uncontended case.  Reasoning for doing this here is the
   // same as in try_lock_until()
@@ -1719,28 +1829,38 @@ DistributedMutex<Atomic, TimePublishing>::try_lock_for(
 
 namespace std {
 
-template <template <typename> class Atom, bool TimePublishing>
-class unique_lock<
-    ::folly::detail::distributed_mutex::DistributedMutex<Atom, TimePublishing>>
+template <
+    template <typename>
+    class Atom,
+    bool TimePublishing,
+    bool NumaCohorts>
+class unique_lock<::folly::detail::distributed_mutex::
+                      DistributedMutex<Atom, TimePublishing, NumaCohorts>>
     : public ::folly::unique_lock_base<
           ::folly::detail::distributed_mutex::
-              DistributedMutex<Atom, TimePublishing>> {
+              DistributedMutex<Atom, TimePublishing, NumaCohorts>> {
  public:
   using ::folly::unique_lock_base<
       ::folly::detail::distributed_mutex::
-          DistributedMutex<Atom, TimePublishing>>::unique_lock_base;
+          DistributedMutex<Atom, TimePublishing, NumaCohorts>>::
+      unique_lock_base;
 };
 
-template <template <typename> class Atom, bool TimePublishing>
-class lock_guard<
-    ::folly::detail::distributed_mutex::DistributedMutex<Atom, TimePublishing>>
+template <
+    template <typename>
+    class Atom,
+    bool TimePublishing,
+    bool NumaCohorts>
+class lock_guard<::folly::detail::distributed_mutex::
+                     DistributedMutex<Atom, TimePublishing, NumaCohorts>>
     : public ::folly::unique_lock_guard_base<
           ::folly::detail::distributed_mutex::
-              DistributedMutex<Atom, TimePublishing>> {
+              DistributedMutex<Atom, TimePublishing, NumaCohorts>> {
  public:
   using ::folly::unique_lock_guard_base<
       ::folly::detail::distributed_mutex::
-          DistributedMutex<Atom, TimePublishing>>::unique_lock_guard_base;
+          DistributedMutex<Atom, TimePublishing, NumaCohorts>>::
+      unique_lock_guard_base;
 };
 
 } // namespace std
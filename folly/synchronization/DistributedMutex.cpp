@@ -20,7 +20,8 @@ namespace folly {
 namespace detail {
 namespace distributed_mutex {
 
-template class DistributedMutex<std::atomic, true>;
+template class DistributedMutex<std::atomic, true, false>;
+template class DistributedMutex<std::atomic, true, true>;
 
 } // namespace distributed_mutex
 } // namespace detail
@@ -136,10 +136,22 @@ namespace distributed_mutex {
  * incompatible with futex(FUTEX_WAIT) on most systems, a non-standard
  * implementation of futex() is used, where wait queues are managed in
  * user-space (see p1135r0 and folly::ParkingLot for more)
+ *
+ * On multi-socket machines every handoff to a waiter on another socket moves
+ * the lock and the data it protects across the interconnect.  With
+ * NumaCohorts set, the thread releasing the mutex skips waiters spinning on
+ * other NUMA nodes (approximated by last-level caches, see CacheLocality) in
+ * favor of those on its own node, for up to kMaxCohortHandoffs consecutive
+ * handoffs.  Skipped waiters requeue themselves just like preempted ones, and
+ * waiters that are sleeping or asked to be combined are never skipped, so the
+ * fairness bounds above still hold up to that constant factor.  This trades a
+ * bit of latency for waiters on remote nodes for throughput when the mutex is
+ * contended from several nodes at once, and costs nothing when not enabled
  */
 template <
     template <typename> class Atomic = std::atomic,
-    bool TimePublishing = true>
+    bool TimePublishing = true,
+    bool NumaCohorts = false>
 class DistributedMutex {
  public:
   class DistributedMutexStateProxy;
@@ -337,6 +349,15 @@ class DistributedMutex {
 extern template class detail::distributed_mutex::DistributedMutex<>;
 using DistributedMutex = detail::distributed_mutex::DistributedMutex<>;
 
+/**
+ * DistributedMutex that prefers to hand the lock to waiters on the same NUMA
+ * node, for mutexes contended from several sockets
+ */
+extern template class detail::distributed_mutex::
+    DistributedMutex<std::atomic, true, true>;
+using NumaDistributedMutex =
+    detail::distributed_mutex::DistributedMutex<std::atomic, true, true>;
+
 } // namespace folly
 
 #include <folly/synchronization/DistributedMutex-inl.h>
@@ -20,6 +20,7 @@
 #include <folly/IndexedMemPool.h>
 #include <folly/Portability.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/container/span.h>
 #include <folly/synchronization/SaturatingSemaphore.h>
 #include <folly/system/ThreadName.h>
 
@@ -27,6 +28,7 @@
 #include <cassert>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace folly {
 
@@ -101,6 +103,12 @@ namespace folly {
 /// See test/FlatCombiningExamples.h for more examples. See the
 /// comments for requestFC() below for a list of simple and custom
 /// variants of that function.
+///
+/// For smart combining, the derived class can override
+/// combineBatch(span<Rec* const>), which receives all the valid
+/// requests collected in one combining pass at once, so that it can
+/// sort, merge or eliminate them and apply them in one go. See
+/// FlatCombiningPriorityQueue for an example.
 
 template <
     typename T, // concurrent data structure using FC interface
@@ -211,6 +219,7 @@ class FlatCombining {
         recs_(NULL_INDEX),
         dedicated_(dedicated),
         recsPool_(numRecs_) {
+    batch_.reserve(numRecs_);
     if (dedicatedCombinerThreadName && !dedicated) {
       throw std::runtime_error(
           "can't set the name of a dedicated combiner thread if this thread is not created at all");
@@ -399,6 +408,9 @@ class FlatCombining {
   uint64_t combined_ = 0;
   uint64_t passes_ = 0;
   uint64_t sessions_ = 0;
+  // The valid requests of the current combining pass, only accessed by the
+  // combiner
+  std::vector<Rec*> batch_;
 
   template <typename OpFunc, typename FillFunc, typename ResFn>
   void requestOp(
@@ -593,12 +605,31 @@ class FlatCombining {
       Req& req = rec.getReq();
       static_cast<T*>(this)->combinedOp(req); // defined in derived class
     }
+    completeReq(rec);
+  }
+
+  /// Processes all the valid requests found in one combining pass, in
+  /// the order they were found. The default processes them one at a
+  /// time with processReq(). An override may process the requests in
+  /// any order, as they are all concurrent, and must either call
+  /// processReq() or apply the request and then call completeReq() for
+  /// every one of them. Requests made through the simple interface
+  /// have a non-empty getFn(), which the override can simply pass to
+  /// processReq().
+  void combineBatch(span<Rec* const> batch) {
+    for (auto rec : batch) {
+      processReq(*rec);
+    }
+  }
+
+  /// Marks a request that has been applied as done, which releases its
+  /// requester.
+  void completeReq(Rec& rec) {
     rec.setLast(passes_);
     rec.complete();
   }
 
   uint64_t combiningPass() {
-    uint64_t count = 0;
     auto idx = getRecsHead();
     Rec* prev = nullptr;
     while (idx != NULL_INDEX) {
@@ -617,11 +648,15 @@ class FlatCombining {
         prev = &rec;
       }
       if (valid) {
-        processReq(rec);
-        ++count;
+        batch_.push_back(&rec);
       }
       idx = next;
     }
+    uint64_t count = batch_.size();
+    if (count > 0) {
+      static_cast<T*>(this)->combineBatch(span<Rec* const>(batch_));
+      batch_.clear();
+    }
     return count;
   }
 };
@@ -21,6 +21,7 @@
 #include <folly/Executor.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/container/F14Set.h>
 #include <folly/synchronization/AsymmetricThreadFence.h>
 #include <folly/synchronization/Hazptr-fwd.h>
@@ -76,6 +77,9 @@ folly::Executor::KeepAlive<> hazptr_get_default_executor();
  *     checked. This type of reclamation operation is expected to be
  *     inexpensive and may be invoked more frequently than
  *     asynchronous reclamation.
+ *  - Untagged retired objects are kept in lists sharded by CPU, so
+ *    that threads retiring objects concurrently on different CPUs do
+ *    not contend on the same list head.
  *  - Tagged retired objects are kept in a sharded list in the domain
  *    structure.
  *  - Both asynchronous and synchronous reclamation pop all the
@@ -118,6 +122,9 @@ class hazptr_domain {
   static constexpr int kShardMask = kNumShards - 1;
   static_assert(
       (kNumShards & kShardMask) == 0, "kNumShards must be a power of 2");
+  /* Untagged shards are picked by CPU rather than by address, as they
+     need not be found again by tag. */
+  static constexpr int kNumUntaggedShards = 64;
 
   Atom<Rec*> hazptrs_{nullptr};
   Atom<uintptr_t> avail_{reinterpret_cast<uintptr_t>(nullptr)};
@@ -128,12 +135,12 @@ class hazptr_domain {
   Atom<int> hcount_{0};
   Atom<uint16_t> num_bulk_reclaims_{0};
   bool shutdown_{false};
-  RetiredList untagged_[kNumShards];
+  RetiredList untagged_[kNumUntaggedShards];
   RetiredList tagged_[kNumShards];
   Atom<int> count_{0};
   Atom<uint64_t> due_time_{0};
   Atom<ExecFn> exec_fn_{nullptr};
-  Atom<int> exec_backlog_{0};
+  Atom<bool> exec_pending_{false};
 
  public:
   /** Constructor */
@@ -338,7 +345,7 @@ class hazptr_domain {
         std::memory_order_seq_cst);
     List ll(l.head(), l.tail());
     if (!tagged) {
-      untagged_[calc_shard(l.head())].push(ll, RetiredList::kMayNotBeLocked);
+      untagged_[calc_untagged_shard()].push(ll, RetiredList::kMayNotBeLocked);
     } else {
       tagged_[calc_shard(btag)].push(ll, RetiredList::kMayBeLocked);
     }
@@ -374,8 +381,11 @@ class hazptr_domain {
     return shard;
   }
 
-  size_t calc_shard(Obj* obj) {
-    return calc_shard(reinterpret_cast<uintptr_t>(obj));
+  /** calc_untagged_shard */
+  size_t calc_untagged_shard() {
+    size_t shard = AccessSpreader<>::cachedCurrent(kNumUntaggedShards);
+    DCHECK(shard < kNumUntaggedShards);
+    return shard;
   }
 
   /** check_due_time */
@@ -418,7 +428,7 @@ class hazptr_domain {
 
   /** untagged_empty */
   bool untagged_empty() {
-    for (int s = 0; s < kNumShards; ++s) {
+    for (int s = 0; s < kNumUntaggedShards; ++s) {
       if (!untagged_[s].empty())
         return false;
     }
@@ -428,7 +438,7 @@ class hazptr_domain {
   /** extract_retired_objects */
   bool extract_retired_objects(Obj* untagged[], Obj* tagged[]) {
     bool empty = true;
-    for (int s = 0; s < kNumShards; ++s) {
+    for (int s = 0; s < kNumUntaggedShards; ++s) {
       untagged[s] = untagged_[s].pop_all(RetiredList::kDontLock);
       if (untagged[s]) {
         empty = false;
@@ -494,7 +504,10 @@ class hazptr_domain {
     done = true;
     ObjList not_reclaimed;
     int count = 0;
-    for (int s = 0; s < kNumShards; ++s) {
+    for (int s = 0; s < kNumUntaggedShards; ++s) {
+      if (!untagged[s]) {
+        continue;
+      }
       ObjList match, nomatch;
       list_match_condition(untagged[s], match, nomatch, [&](Obj* o) {
         return hs.count(o->raw_ptr()) > 0;
@@ -518,7 +531,7 @@ class hazptr_domain {
   void do_reclamation(int rcount) {
     DCHECK_GE(rcount, 0);
     while (true) {
-      Obj* untagged[kNumShards];
+      Obj* untagged[kNumUntaggedShards];
       Obj* tagged[kNumShards];
       bool done = true;
       if (extract_retired_objects(untagged, tagged)) {
@@ -581,7 +594,7 @@ class hazptr_domain {
   }
 
   void reclaim_all_objects() {
-    for (int s = 0; s < kNumShards; ++s) {
+    for (int s = 0; s < kNumUntaggedShards; ++s) {
       Obj* head = untagged_[s].pop_all(RetiredList::kDontLock);
       reclaim_list_transitive(head);
     }
@@ -726,9 +739,16 @@ class hazptr_domain {
     if (!ex) {
       return false;
     }
-    auto backlog = exec_backlog_.fetch_add(1, std::memory_order_relaxed);
+    /* Batch with the reclamation already queued, if it has not started
+       yet. It extracts all the retired objects once it runs, so it is
+       enough to give the count back. */
+    if (exec_pending_.exchange(true, std::memory_order_acq_rel)) {
+      add_count(rcount);
+      dec_num_bulk_reclaims();
+      return true;
+    }
     auto recl_fn = [this, rcount, ka = ex] {
-      exec_backlog_.store(0, std::memory_order_relaxed);
+      exec_pending_.store(false, std::memory_order_release);
       do_reclamation(rcount);
     };
     if (ex.get() == detail::hazptr_get_default_executor().get()) {
@@ -736,9 +756,6 @@ class hazptr_domain {
     } else {
       ex->add(recl_fn);
     }
-    if (backlog >= 10) {
-      hazptr_warning_executor_backlog(backlog);
-    }
     return true;
   }
 
@@ -763,16 +780,6 @@ class hazptr_domain {
                    << " shard=" << shard << " count=" << count;
     }
   }
-
-  FOLLY_EXPORT FOLLY_NOINLINE void hazptr_warning_executor_backlog(
-      int backlog) {
-    static std::atomic<uint64_t> warning_count{0};
-    if ((warning_count++ % 10000) == 0) {
-      LOG(WARNING) << backlog
-                   << " request backlog for hazptr asynchronous "
-                      "reclamation executor";
-    }
-  }
 }; // hazptr_domain
 
 /**
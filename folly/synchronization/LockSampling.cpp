@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/synchronization/LockSampling.h>
+
+#include <algorithm>
+
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+namespace {
+
+std::atomic<uint32_t> sampleRate{0};
+
+// How many acquisitions a thread makes between two checks of the rate while
+// sampling is disabled.
+constexpr uint32_t kDisabledCountdown = 4096;
+
+// The sites sampled so far, most recent first. Sites are statics, so never
+// removed.
+std::atomic<LockSite*> sites{nullptr};
+
+size_t bucket(uint64_t nanos) noexcept {
+  auto const log2 = nanos == 0 ? 0 : findLastSet(nanos) - 1;
+  return std::min<size_t>(log2, kLockSampleBuckets - 1);
+}
+
+void updateMax(std::atomic<uint64_t>& max, uint64_t value) noexcept {
+  auto current = max.load(std::memory_order_relaxed);
+  while (current < value &&
+         !max.compare_exchange_weak(
+             current, value, std::memory_order_relaxed)) {
+  }
+}
+
+template <typename T>
+std::array<uint64_t, kLockSampleBuckets> load(const T& histogram) {
+  std::array<uint64_t, kLockSampleBuckets> result;
+  for (size_t i = 0; i < kLockSampleBuckets; ++i) {
+    result[i] = histogram[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+} // namespace
+
+void LockSite::recordSample(
+    std::chrono::nanoseconds wait, std::chrono::nanoseconds hold) noexcept {
+  if (!registered_.load(std::memory_order_relaxed) &&
+      !registered_.exchange(true, std::memory_order_relaxed)) {
+    next_ = sites.load(std::memory_order_relaxed);
+    while (!sites.compare_exchange_weak(
+        next_, this, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+
+  auto const waitNanos = static_cast<uint64_t>(wait.count());
+  auto const holdNanos = static_cast<uint64_t>(hold.count());
+  samples_.fetch_add(1, std::memory_order_relaxed);
+  totalWaitNanos_.fetch_add(waitNanos, std::memory_order_relaxed);
+  totalHoldNanos_.fetch_add(holdNanos, std::memory_order_relaxed);
+  updateMax(maxWaitNanos_, waitNanos);
+  updateMax(maxHoldNanos_, holdNanos);
+  waitHistogram_[bucket(waitNanos)].fetch_add(1, std::memory_order_relaxed);
+  holdHistogram_[bucket(holdNanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LockSite::reset() noexcept {
+  samples_.store(0, std::memory_order_relaxed);
+  totalWaitNanos_.store(0, std::memory_order_relaxed);
+  totalHoldNanos_.store(0, std::memory_order_relaxed);
+  maxWaitNanos_.store(0, std::memory_order_relaxed);
+  maxHoldNanos_.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < kLockSampleBuckets; ++i) {
+    waitHistogram_[i].store(0, std::memory_order_relaxed);
+    holdHistogram_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LockSiteStats::LockSiteStats(const LockSite& site)
+    : name(site.name_),
+      file(site.file_),
+      line(site.line_),
+      samples(site.samples_.load(std::memory_order_relaxed)),
+      totalWait(site.totalWaitNanos_.load(std::memory_order_relaxed)),
+      totalHold(site.totalHoldNanos_.load(std::memory_order_relaxed)),
+      maxWait(site.maxWaitNanos_.load(std::memory_order_relaxed)),
+      maxHold(site.maxHoldNanos_.load(std::memory_order_relaxed)),
+      waitHistogram(load(site.waitHistogram_)),
+      holdHistogram(load(site.holdHistogram_)) {}
+
+void setLockSampleRate(uint32_t rate) {
+  sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+uint32_t getLockSampleRate() {
+  return sampleRate.load(std::memory_order_relaxed);
+}
+
+std::vector<LockSiteStats> getLockSiteStats() {
+  std::vector<LockSiteStats> result;
+  for (auto site = sites.load(std::memory_order_acquire); site;
+       site = site->next_) {
+    result.emplace_back(*site);
+  }
+  std::sort(result.begin(), result.end(), [](auto& lhs, auto& rhs) {
+    return lhs.totalWait > rhs.totalWait;
+  });
+  return result;
+}
+
+void resetLockSiteStats() {
+  for (auto site = sites.load(std::memory_order_acquire); site;
+       site = site->next_) {
+    site->reset();
+  }
+}
+
+namespace detail {
+
+bool lockSampleTickSlow(uint32_t& countdown) noexcept {
+  auto const rate = sampleRate.load(std::memory_order_relaxed);
+  if (rate == 0) {
+    countdown = kDisabledCountdown;
+    return false;
+  }
+  countdown = rate;
+  return true;
+}
+
+} // namespace detail
+
+} // namespace folly
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * Opt-in sampling of the time spent waiting for and holding locks, by call
+ * site, to find contention hotspots.
+ *
+ * A call site acquires its lock through FOLLY_SAMPLED_LOCK, which takes the
+ * expression acquiring the lock and returns what it returns wrapped in a
+ * SampledLock. Any lock holder works:
+ *
+ *   auto lock = FOLLY_SAMPLED_LOCK("cache insert", std::unique_lock{mutex});
+ *   auto locked = FOLLY_SAMPLED_LOCK("cache lookup", cache.rlock());
+ *   locked->find(key);
+ *
+ * which covers folly::SharedMutex (std::unique_lock, std::shared_lock),
+ * folly::DistributedMutex (folly::unique_lock) and folly::Synchronized (its
+ * LockedPtr).
+ *
+ * Sampling is off until setLockSampleRate() is called. An acquisition that is
+ * not sampled costs a decrement of a thread local countdown; one that is
+ * reads the clock three times and updates the histograms of its site.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+
+namespace folly {
+
+/**
+ * The number of buckets of the wait and hold time histograms. Bucket 0 counts
+ * the samples under 2ns, bucket i > 0 those in [2^i, 2^(i+1)) nanoseconds,
+ * and the last one also all the longer ones (over about 2s).
+ */
+constexpr size_t kLockSampleBuckets = 32;
+
+struct LockSiteStats;
+
+/**
+ * A call site acquiring a lock. Declared, as a constant initialized static,
+ * by FOLLY_SAMPLED_LOCK, and listed by getLockSiteStats() once sampled.
+ */
+class LockSite {
+ public:
+  constexpr LockSite(const char* name, const char* file, unsigned line) noexcept
+      : name_(name), file_(file), line_(line) {}
+
+  LockSite(const LockSite&) = delete;
+  LockSite& operator=(const LockSite&) = delete;
+
+  void recordSample(
+      std::chrono::nanoseconds wait, std::chrono::nanoseconds hold) noexcept;
+
+ private:
+  friend struct LockSiteStats;
+  friend std::vector<LockSiteStats> getLockSiteStats();
+  friend void resetLockSiteStats();
+
+  void reset() noexcept;
+
+  const char* const name_;
+  const char* const file_;
+  const unsigned line_;
+
+  std::atomic<bool> registered_{false};
+  LockSite* next_{nullptr};
+
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> totalWaitNanos_{0};
+  std::atomic<uint64_t> totalHoldNanos_{0};
+  std::atomic<uint64_t> maxWaitNanos_{0};
+  std::atomic<uint64_t> maxHoldNanos_{0};
+  std::array<std::atomic<uint64_t>, kLockSampleBuckets> waitHistogram_{};
+  std::array<std::atomic<uint64_t>, kLockSampleBuckets> holdHistogram_{};
+};
+
+struct LockSiteStats {
+  const char* name;
+  const char* file;
+  unsigned line;
+  uint64_t samples;
+  std::chrono::nanoseconds totalWait;
+  std::chrono::nanoseconds totalHold;
+  std::chrono::nanoseconds maxWait;
+  std::chrono::nanoseconds maxHold;
+  // See kLockSampleBuckets.
+  std::array<uint64_t, kLockSampleBuckets> waitHistogram;
+  std::array<uint64_t, kLockSampleBuckets> holdHistogram;
+
+  explicit LockSiteStats(const LockSite& site);
+};
+
+/**
+ * Sample one in every rate lock acquisitions of each thread; 0, the default,
+ * disables sampling. A thread that is not sampling only notices the change
+ * after a few thousand acquisitions.
+ */
+void setLockSampleRate(uint32_t rate);
+uint32_t getLockSampleRate();
+
+/**
+ * The statistics of the sites sampled so far, those that waited the longest
+ * in total first.
+ */
+std::vector<LockSiteStats> getLockSiteStats();
+
+/**
+ * Clear the statistics of all the sites. Samples recorded concurrently may be
+ * partially cleared.
+ */
+void resetLockSiteStats();
+
+namespace detail {
+
+bool lockSampleTickSlow(uint32_t& countdown) noexcept;
+
+// Whether to sample this acquisition.
+FOLLY_ALWAYS_INLINE bool lockSampleTick() noexcept {
+  static thread_local uint32_t countdown = 1;
+  if (FOLLY_LIKELY(--countdown != 0)) {
+    return false;
+  }
+  return lockSampleTickSlow(countdown);
+}
+
+} // namespace detail
+
+/**
+ * A lock, as returned by the expression passed to FOLLY_SAMPLED_LOCK, that
+ * records the time it was held when released, if its acquisition was sampled.
+ * Dereferences to what the lock dereferences to, if anything.
+ */
+template <typename Lock>
+class SampledLock {
+  static constexpr bool kNothrowMove =
+      std::is_nothrow_move_constructible_v<Lock>;
+
+ public:
+  SampledLock(Lock&& lock) noexcept(kNothrowMove) : lock_(std::move(lock)) {}
+
+  SampledLock(
+      Lock&& lock,
+      LockSite& site,
+      std::chrono::steady_clock::time_point acquired,
+      std::chrono::nanoseconds wait) noexcept(kNothrowMove)
+      : lock_(std::move(lock)),
+        site_(&site),
+        acquired_(acquired),
+        wait_(wait) {}
+
+  SampledLock(SampledLock&& other) noexcept(kNothrowMove)
+      : lock_(std::move(other.lock_)),
+        site_(std::exchange(other.site_, nullptr)),
+        acquired_(other.acquired_),
+        wait_(other.wait_) {}
+
+  SampledLock& operator=(SampledLock&&) = delete;
+
+  ~SampledLock() { record(); }
+
+  /**
+   * Release the lock before the end of the scope.
+   */
+  void unlock() {
+    record();
+    lock_.unlock();
+  }
+
+  Lock& get() noexcept { return lock_; }
+  const Lock& get() const noexcept { return lock_; }
+
+  template <typename L = Lock>
+  auto operator->() -> decltype(std::declval<L&>().operator->()) {
+    return lock_.operator->();
+  }
+
+  template <typename L = Lock>
+  auto operator*() -> decltype(*std::declval<L&>()) {
+    return *lock_;
+  }
+
+ private:
+  void record() noexcept {
+    if (FOLLY_UNLIKELY(site_ != nullptr)) {
+      site_->recordSample(
+          wait_, std::chrono::steady_clock::now() - acquired_);
+      site_ = nullptr;
+    }
+  }
+
+  Lock lock_;
+  LockSite* site_{nullptr};
+  std::chrono::steady_clock::time_point acquired_;
+  std::chrono::nanoseconds wait_{};
+};
+
+/**
+ * Acquire a lock by calling acquire, sampling the time it takes and the time
+ * it is held at the site returned by site. See FOLLY_SAMPLED_LOCK.
+ */
+template <typename Acquire, typename Site>
+FOLLY_ALWAYS_INLINE auto sampleLock(Acquire&& acquire, Site&& site)
+    -> SampledLock<std::invoke_result_t<Acquire&>> {
+  if (FOLLY_LIKELY(!detail::lockSampleTick())) {
+    return {acquire()};
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto lock = acquire();
+  auto const acquired = std::chrono::steady_clock::now();
+  return {std::move(lock), site(), acquired, acquired - start};
+}
+
+} // namespace folly
+
+/**
+ * Evaluate the expression acquiring a lock, sampling it as site name (a
+ * string literal). See the top of this file.
+ */
+#define FOLLY_SAMPLED_LOCK(name, ...)                      \
+  ::folly::sampleLock(                                     \
+      [&]() -> decltype(auto) { return __VA_ARGS__; },     \
+      []() -> ::folly::LockSite& {                         \
+        static ::folly::LockSite folly_sampled_lock_site{  \
+            name, __FILE__, __LINE__};                     \
+        return folly_sampled_lock_site;                    \
+      })
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include <folly/synchronization/Rcu.h>
+
+namespace folly {
+
+/**
+ * RcuProtected<T> is a Synchronized-like wrapper for read-mostly data, whose
+ * readers never touch a lock shared with other threads: rlock() enters an RCU
+ * read region and loads a pointer. Writers copy the value, mutate the copy,
+ * and publish it, retiring the previous one once the readers that may still
+ * see it are done.
+ *
+ *   folly::RcuProtected<RoutingTable> routes;
+ *
+ *   // Millions of times per second.
+ *   auto route = routes.withRLock([&](auto& table) { return table.find(k); });
+ *
+ *   // Once a minute.
+ *   routes.withWLock([&](auto& table) { table.update(delta); });
+ *
+ * Writers are serialized by a mutex, so that none loses the update of
+ * another, and each pays for a copy of T; prefer Synchronized for data that
+ * changes often. As with any RCU reader, a reader must not block for long or
+ * call rcu_synchronize(), and values are reclaimed asynchronously (see
+ * Rcu.h). The values are const for readers.
+ */
+template <typename T>
+class RcuProtected {
+  static_assert(std::is_copy_constructible_v<T>, "not copy-constructible");
+
+  struct Box : rcu_obj_base<Box> {
+    template <typename... A>
+    explicit Box(std::in_place_t, A&&... a) : value(std::forward<A>(a)...) {}
+
+    T value;
+  };
+
+ public:
+  using value_type = T;
+
+  /**
+   * A read region, and the value published when it was entered, which it
+   * keeps alive.
+   */
+  class ReadPtr {
+   public:
+    ReadPtr(ReadPtr&&) noexcept = default;
+    ReadPtr& operator=(ReadPtr&&) noexcept = default;
+
+    const T& operator*() const noexcept { return box_->value; }
+    const T* operator->() const noexcept { return &box_->value; }
+    const T* get() const noexcept { return &box_->value; }
+
+    /**
+     * Leave the read region before the end of the scope.
+     */
+    void unlock() noexcept {
+      box_ = nullptr;
+      reader_.unlock();
+    }
+
+   private:
+    friend class RcuProtected;
+
+    explicit ReadPtr(const RcuProtected& parent) noexcept
+        : reader_(parent.domain_),
+          box_(parent.current_.load(std::memory_order_acquire)) {}
+
+    std::unique_lock<rcu_domain> reader_;
+    const Box* box_;
+  };
+
+  /**
+   * A copy of the value, being mutated, and the lock of the writers. Publishes
+   * the copy when unlocked or destroyed, unless destroyed by an exception.
+   */
+  class WritePtr {
+   public:
+    WritePtr(WritePtr&&) noexcept = default;
+    WritePtr& operator=(WritePtr&&) = delete;
+
+    ~WritePtr() {
+      if (std::uncaught_exceptions() == uncaughtExceptions_) {
+        publish();
+      }
+    }
+
+    T& operator*() const noexcept { return copy_->value; }
+    T* operator->() const noexcept { return &copy_->value; }
+    T* get() const noexcept { return &copy_->value; }
+
+    /**
+     * Publish the copy before the end of the scope.
+     */
+    void unlock() noexcept { publish(); }
+
+   private:
+    friend class RcuProtected;
+
+    explicit WritePtr(RcuProtected& parent)
+        : parent_(&parent),
+          lock_(parent.writeMutex_),
+          copy_(std::make_unique<Box>(
+              std::in_place,
+              parent.current_.load(std::memory_order_relaxed)->value)),
+          uncaughtExceptions_(std::uncaught_exceptions()) {}
+
+    void publish() noexcept {
+      if (copy_) {
+        parent_->publish(std::move(copy_));
+        lock_.unlock();
+      }
+    }
+
+    RcuProtected* parent_;
+    std::unique_lock<std::mutex> lock_;
+    std::unique_ptr<Box> copy_;
+    int uncaughtExceptions_;
+  };
+
+  template <
+      typename U = T,
+      std::enable_if_t<std::is_default_constructible_v<U>, int> = 0>
+  RcuProtected() : RcuProtected(std::in_place) {}
+
+  explicit RcuProtected(const T& value) : RcuProtected(std::in_place, value) {}
+
+  explicit RcuProtected(T&& value)
+      : RcuProtected(std::in_place, std::move(value)) {}
+
+  template <typename... A>
+  explicit RcuProtected(std::in_place_t, A&&... a)
+      : RcuProtected(
+            rcu_default_domain(), std::in_place, std::forward<A>(a)...) {}
+
+  /**
+   * Read in domain rather than in the default domain.
+   */
+  template <typename... A>
+  RcuProtected(rcu_domain& domain, std::in_place_t, A&&... a)
+      : domain_(domain),
+        current_(new Box(std::in_place, std::forward<A>(a)...)) {}
+
+  RcuProtected(const RcuProtected&) = delete;
+  RcuProtected& operator=(const RcuProtected&) = delete;
+
+  /**
+   * There must be no readers left, as for the destruction of any object.
+   */
+  ~RcuProtected() { delete current_.load(std::memory_order_relaxed); }
+
+  ReadPtr rlock() const noexcept { return ReadPtr(*this); }
+
+  template <typename F>
+  decltype(auto) withRLock(F&& f) const {
+    auto ptr = rlock();
+    return std::forward<F>(f)(*ptr);
+  }
+
+  /**
+   * Copy the value for mutation, holding off the other writers until the
+   * copy is published. Does not block readers.
+   */
+  WritePtr wlock() { return WritePtr(*this); }
+
+  /**
+   * Call f with a copy of the value and publish it, unless f throws.
+   */
+  template <typename F>
+  decltype(auto) withWLock(F&& f) {
+    auto ptr = wlock();
+    return std::forward<F>(f)(*ptr);
+  }
+
+  /**
+   * Publish value, replacing the current one without copying it.
+   */
+  void store(T value) {
+    auto box = std::make_unique<Box>(std::in_place, std::move(value));
+    std::lock_guard lock(writeMutex_);
+    publish(std::move(box));
+  }
+
+  T copy() const { return *rlock(); }
+
+ private:
+  void publish(std::unique_ptr<Box> box) noexcept {
+    auto const old =
+        current_.exchange(box.release(), std::memory_order_acq_rel);
+    old->retire({}, domain_);
+  }
+
+  rcu_domain& domain_;
+  std::atomic<Box*> current_;
+  std::mutex writeMutex_;
+};
+
+} // namespace folly
@@ -275,6 +275,7 @@ template <typename Clock, typename Duration>
 FOLLY_NOINLINE bool SaturatingSemaphore<MayBlock, Atom>::tryWaitSlow(
     const std::chrono::time_point<Clock, Duration>& deadline,
     const WaitOptions& opt) noexcept {
+  detail::adaptive_spin_timer timer{opt};
   switch (detail::spin_pause_until(deadline, opt, [this] { return ready(); })) {
     case detail::spin_result::success:
       return true;
@@ -139,6 +139,7 @@ class ThrottledLifoSem {
 
     state_.fetch_add(kNumWaitersInc, std::memory_order_seq_cst);
 
+    detail::adaptive_spin_timer timer{opt};
     switch (detail::spin_pause_until(deadline, opt, [this] {
       return tryWaitImpl<DecrNumWaiters::OnSuccess>();
     })) {
@@ -16,12 +16,95 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 
 #include <folly/CPortability.h>
 
 namespace folly {
 
+/// AdaptiveSpin
+///
+/// A fixed spin_max is a guess about how long waits take. It spins in vain on
+/// waits much longer than the cost of blocking, and blocks on waits that would
+/// have ended a few spins later. AdaptiveSpin instead learns the typical wait
+/// time, as an exponentially weighted moving average of the waits it is told
+/// about, and sizes the spin from it:
+///
+/// * Waits expected to end within spin_limit spin for twice the expected
+///   time, so the bulk of them end before blocking.
+/// * Longer waits block right away, except for one in kProbeInterval which
+///   spins for spin_limit, so the average follows waits becoming short again.
+///
+/// Pass it to waits with WaitOptions::adaptive_spin. One instance learns from
+/// every wait it is passed to, so keep one per synchronization object or per
+/// call site, whichever has waits of similar length:
+///
+///     folly::AdaptiveSpin spin;
+///     baton.wait(folly::WaitOptions().adaptive_spin(&spin));
+///
+/// Updates are relaxed and may race and lose samples, which only slows down
+/// learning. Every adaptive wait writes the average, so an instance shared by
+/// many threads waiting concurrently bounces a cache line between them.
+class AdaptiveSpin {
+ public:
+  /// spin_limit
+  ///
+  /// The longest expected wait worth spinning for, rather than blocking. The
+  /// default is a little above the cost of FUTEX_WAIT and wakeup quoted for
+  /// WaitOptions::Defaults::spin_max.
+  static constexpr std::chrono::nanoseconds kDefaultSpinLimit =
+      std::chrono::microseconds(10);
+  static constexpr uint32_t kProbeInterval = 64;
+
+  explicit AdaptiveSpin(
+      std::chrono::nanoseconds spin_limit = kDefaultSpinLimit) noexcept
+      : spin_limit_(spin_limit.count()), expected_(spin_limit.count() / 2) {}
+
+  AdaptiveSpin(const AdaptiveSpin&) = delete;
+  AdaptiveSpin& operator=(const AdaptiveSpin&) = delete;
+
+  /// The duration to spin for before blocking in the next wait.
+  std::chrono::nanoseconds spin_max() noexcept {
+    auto const expected = expected_.load(std::memory_order_relaxed);
+    if (expected <= spin_limit_) {
+      return std::chrono::nanoseconds(
+          std::clamp(2 * expected, kMinSpin, spin_limit_));
+    }
+    auto const waits = waits_.load(std::memory_order_relaxed) + 1;
+    waits_.store(waits, std::memory_order_relaxed);
+    return std::chrono::nanoseconds(
+        waits % kProbeInterval == 0 ? spin_limit_ : 0);
+  }
+
+  /// Records how long a wait took, from the start of its spin to its end.
+  void record(std::chrono::nanoseconds waited) noexcept {
+    // Past a few spin limits, a wait is just long. Capping keeps a single very
+    // long wait from skewing the average for many waits to come.
+    auto const sample = std::min<int64_t>(waited.count(), 4 * spin_limit_);
+    auto const expected = expected_.load(std::memory_order_relaxed);
+    expected_.store(
+        expected + (sample - expected) / kWeight, std::memory_order_relaxed);
+  }
+
+  /// The current estimate of how long a wait takes.
+  std::chrono::nanoseconds expected() const noexcept {
+    return std::chrono::nanoseconds(expected_.load(std::memory_order_relaxed));
+  }
+
+ private:
+  // Each sample contributes 1/kWeight to the average.
+  static constexpr int64_t kWeight = 8;
+  // Spinning for less than a couple of clock reads is pointless.
+  static constexpr int64_t kMinSpin = 100;
+
+  const int64_t spin_limit_;
+  std::atomic<int64_t> expected_;
+  std::atomic<uint32_t> waits_{0};
+};
+
 /// WaitOptions
 ///
 /// Various synchronization primitives as well as various concurrent data
@@ -61,6 +144,17 @@ class WaitOptions {
     spin_max_ = dur;
     return *this;
   }
+  /// adaptive_spin
+  ///
+  /// If set, waits spin for as long as the given AdaptiveSpin advises instead
+  /// of spin_max, and report how long they took back to it. The AdaptiveSpin
+  /// must outlive the waits. Primitives which block through the futex, like
+  /// Baton, SaturatingSemaphore and ThrottledLifoSem, honor it.
+  constexpr AdaptiveSpin* adaptive_spin() const { return adaptive_spin_; }
+  constexpr WaitOptions& adaptive_spin(AdaptiveSpin* spin) {
+    adaptive_spin_ = spin;
+    return *this;
+  }
   constexpr bool logging_enabled() const { return logging_enabled_; }
   constexpr WaitOptions& logging_enabled(bool enable) {
     logging_enabled_ = enable;
@@ -69,6 +163,7 @@ class WaitOptions {
 
  private:
   std::chrono::nanoseconds spin_max_ = Defaults::spin_max;
+  AdaptiveSpin* adaptive_spin_ = nullptr;
   bool logging_enabled_ = Defaults::logging_enabled;
 };
 
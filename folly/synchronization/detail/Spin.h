@@ -32,12 +32,38 @@ enum class spin_result {
   advance, // exceeded current wait-options component timeout
 };
 
+//  Times a wait for its WaitOptions::adaptive_spin, if any. Construct it before
+//  spin_pause_until, it reports when destroyed at the end of the wait.
+class adaptive_spin_timer {
+ public:
+  explicit adaptive_spin_timer(WaitOptions const& opt) noexcept
+      : spin_(opt.adaptive_spin()),
+        begin_(
+            spin_ ? std::chrono::steady_clock::now()
+                  : std::chrono::steady_clock::time_point{}) {}
+
+  adaptive_spin_timer(adaptive_spin_timer const&) = delete;
+  adaptive_spin_timer& operator=(adaptive_spin_timer const&) = delete;
+
+  ~adaptive_spin_timer() {
+    if (spin_) {
+      spin_->record(std::chrono::steady_clock::now() - begin_);
+    }
+  }
+
+ private:
+  AdaptiveSpin* const spin_;
+  std::chrono::steady_clock::time_point const begin_;
+};
+
 template <typename Clock, typename Duration, typename F>
 spin_result spin_pause_until(
     std::chrono::time_point<Clock, Duration> const& deadline,
     WaitOptions const& opt,
     F f) {
-  if (opt.spin_max() <= opt.spin_max().zero()) {
+  auto const spin_max =
+      opt.adaptive_spin() ? opt.adaptive_spin()->spin_max() : opt.spin_max();
+  if (spin_max <= spin_max.zero()) {
     return spin_result::advance;
   }
 
@@ -63,7 +89,7 @@ spin_result spin_pause_until(
 
     //  Backward time discontinuity in Clock? revise pre_block starting point
     tbegin = std::min(tbegin, tnow);
-    if (tnow >= tbegin + opt.spin_max()) {
+    if (tnow >= tbegin + spin_max) {
       return spin_result::advance;
     }
 
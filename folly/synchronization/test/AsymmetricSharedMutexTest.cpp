@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/synchronization/AsymmetricSharedMutex.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+
+TEST(AsymmetricSharedMutex, Basic) {
+  AsymmetricSharedMutex mutex;
+  mutex.lock_shared();
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+
+  EXPECT_TRUE(mutex.try_lock());
+  std::thread([&] { EXPECT_FALSE(mutex.try_lock_shared()); }).join();
+  mutex.unlock();
+
+  mutex.lock();
+  mutex.unlock();
+  std::thread([&] {
+    EXPECT_TRUE(mutex.try_lock_shared());
+    mutex.unlock_shared();
+  }).join();
+}
+
+TEST(AsymmetricSharedMutex, WriterWaitsForReaders) {
+  AsymmetricSharedMutex mutex;
+  std::atomic<bool> locked{false};
+  mutex.lock_shared();
+  std::thread writer([&] {
+    mutex.lock();
+    locked = true;
+    mutex.unlock();
+  });
+  /* sleep override */ std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(locked);
+  // Nested readers do not wait for the writer waiting for them.
+  mutex.lock_shared();
+  mutex.unlock_shared();
+  mutex.unlock_shared();
+  writer.join();
+  EXPECT_TRUE(locked);
+}
+
+TEST(AsymmetricSharedMutex, ReadersWaitForWriter) {
+  AsymmetricSharedMutex mutex;
+  std::atomic<bool> locked{false};
+  Baton<> reading;
+  mutex.lock();
+  std::thread reader([&] {
+    reading.post();
+    std::shared_lock lock{mutex};
+    locked = true;
+  });
+  reading.wait();
+  /* sleep override */ std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(locked);
+  mutex.unlock();
+  reader.join();
+  EXPECT_TRUE(locked);
+}
+
+TEST(AsymmetricSharedMutex, Stress) {
+  AsymmetricSharedMutex mutex;
+  // Writers keep both equal while holding the lock.
+  uint64_t a = 0;
+  uint64_t b = 0;
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> mismatches{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        std::shared_lock lock{mutex};
+        if (a != b) {
+          ++mismatches;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        std::unique_lock lock{mutex};
+        ++a;
+        ++b;
+      }
+    });
+  }
+  for (size_t i = threads.size() - 2; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  stop = true;
+  for (size_t i = 0; i < threads.size() - 2; ++i) {
+    threads[i].join();
+  }
+  EXPECT_EQ(0, mismatches.load());
+  EXPECT_EQ(2000, a);
+  EXPECT_EQ(2000, b);
+}
+
+TEST(AsymmetricSharedMutex, ReaderThreadExit) {
+  AsymmetricSharedMutex mutex;
+  for (int i = 0; i < 16; ++i) {
+    std::thread([&] { std::shared_lock lock{mutex}; }).join();
+  }
+  mutex.lock();
+  mutex.unlock();
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/synchronization/DelayedInitPtr.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/test/Barrier.h>
+
+namespace folly {
+
+TEST(DelayedInitPtr, Simple) {
+  int calls = 0;
+  DelayedInitPtr<std::string> lazy;
+  EXPECT_FALSE(lazy.has_value());
+  EXPECT_FALSE(lazy);
+
+  for (int i = 0; i < 100; ++i) {
+    auto& value = lazy.try_emplace_with([&] {
+      ++calls;
+      return std::string("hello");
+    });
+    EXPECT_EQ(value, "hello");
+    EXPECT_EQ(&value, &*lazy);
+  }
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(lazy.has_value());
+  EXPECT_EQ(lazy->size(), 5);
+  EXPECT_EQ(lazy.value(), "hello");
+}
+
+TEST(DelayedInitPtr, TryEmplace) {
+  DelayedInitPtr<std::string> lazy;
+  EXPECT_EQ(lazy.try_emplace(3, 'x'), "xxx");
+  EXPECT_EQ(lazy.try_emplace(2, 'y'), "xxx");
+
+  DelayedInitPtr<std::vector<int>> list;
+  EXPECT_EQ(list.try_emplace({1, 2, 3}).size(), 3);
+}
+
+TEST(DelayedInitPtr, ValueThrowsWhenEmpty) {
+  DelayedInitPtr<int> lazy;
+  EXPECT_THROW(lazy.value(), std::logic_error);
+  const auto& clazy = lazy;
+  EXPECT_THROW(clazy.value(), std::logic_error);
+}
+
+TEST(DelayedInitPtr, ExceptionProof) {
+  DelayedInitPtr<int> lazy;
+  EXPECT_THROW(
+      lazy.try_emplace_with([]() -> int { throw std::runtime_error("x"); }),
+      std::runtime_error);
+  EXPECT_FALSE(lazy.has_value());
+  EXPECT_EQ(lazy.try_emplace(7), 7);
+}
+
+TEST(DelayedInitPtr, DestroysValue) {
+  auto counter = std::make_shared<int>(0);
+  {
+    DelayedInitPtr<std::shared_ptr<int>> lazy;
+    lazy.try_emplace(counter);
+    EXPECT_EQ(counter.use_count(), 2);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(DelayedInitPtr, Concurrent) {
+  constexpr int kThreads = 32;
+  for (int round = 0; round < 20; ++round) {
+    std::atomic<int> calls{0};
+    DelayedInitPtr<int> lazy;
+    test::Barrier barrier{kThreads};
+    std::vector<std::thread> threads;
+    std::vector<int*> seen(kThreads);
+    for (int i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&, i] {
+        barrier.wait();
+        seen[i] = &lazy.try_emplace_with([&] {
+          ++calls;
+          std::this_thread::yield();
+          return 42;
+        });
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(calls.load(), 1);
+    for (auto* p : seen) {
+      EXPECT_EQ(p, &*lazy);
+    }
+    EXPECT_EQ(*lazy, 42);
+  }
+}
+
+TEST(DelayedInitPtr, ConcurrentWithFailures) {
+  constexpr int kThreads = 16;
+  std::atomic<int> calls{0};
+  DelayedInitPtr<int> lazy;
+  test::Barrier barrier{kThreads};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&] {
+      barrier.wait();
+      while (true) {
+        try {
+          lazy.try_emplace_with([&] {
+            // Fail the first few attempts so waiters have to take over.
+            if (++calls < 4) {
+              throw std::runtime_error("retry");
+            }
+            return 1;
+          });
+          return;
+        } catch (const std::runtime_error&) {
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(calls.load(), 4);
+  EXPECT_EQ(*lazy, 1);
+}
+
+} // namespace folly
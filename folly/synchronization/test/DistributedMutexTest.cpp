@@ -258,9 +258,12 @@ int sum(int n) {
   return (n * (n + 1)) / 2;
 }
 
-template <template <typename> class Atom = std::atomic>
+template <
+    template <typename> class Atom = std::atomic,
+    bool NumaCohorts = false>
 void basicNThreads(int numThreads, int iterations = kStressFactor) {
-  auto&& mutex = detail::distributed_mutex::DistributedMutex<Atom>{};
+  auto&& mutex =
+      detail::distributed_mutex::DistributedMutex<Atom, true, NumaCohorts>{};
   auto&& barrier = std::atomic<int>{0};
   auto&& threads = std::vector<std::thread>{};
   auto&& result = std::vector<int>{};
@@ -348,9 +351,12 @@ void lockWithTryAndTimedNThreads(
   }
 }
 
-template <template <typename> class Atom = std::atomic>
+template <
+    template <typename> class Atom = std::atomic,
+    bool NumaCohorts = false>
 void combineNThreads(int numThreads, std::chrono::seconds duration) {
-  auto&& mutex = detail::distributed_mutex::DistributedMutex<Atom>{};
+  auto&& mutex =
+      detail::distributed_mutex::DistributedMutex<Atom, true, NumaCohorts>{};
   auto&& barrier = std::atomic<int>{0};
   auto&& threads = std::vector<std::thread>{};
   auto&& stop = std::atomic<bool>{false};
@@ -817,6 +823,12 @@ TEST(DistributedMutex, StressHundredThreads) {
 TEST(DistributedMutex, StressHardwareConcurrencyThreads) {
   basicNThreads(std::thread::hardware_concurrency());
 }
+TEST(DistributedMutex, StressEightThreadsNumaCohorts) {
+  basicNThreads<std::atomic, true>(8);
+}
+TEST(DistributedMutex, StressHardwareConcurrencyThreadsNumaCohorts) {
+  basicNThreads<std::atomic, true>(std::thread::hardware_concurrency());
+}
 
 TEST(DistributedMutex, StressThreeThreadsLockTryAndTimed) {
   lockWithTryAndTimedNThreads(3, std::chrono::seconds{kStressTestSeconds});
@@ -880,6 +892,11 @@ TEST(DistributedMutex, StressHardwareConcurrencyThreadsCombine) {
       std::thread::hardware_concurrency(),
       std::chrono::seconds{kStressTestSeconds});
 }
+TEST(DistributedMutex, StressHardwareConcurrencyThreadsCombineNumaCohorts) {
+  combineNThreads<std::atomic, true>(
+      std::thread::hardware_concurrency(),
+      std::chrono::seconds{kStressTestSeconds});
+}
 
 TEST(DistributedMutex, StressTwoThreadsCombineAndLock) {
   combineWithLockNThreads(2, std::chrono::seconds{kStressTestSeconds});
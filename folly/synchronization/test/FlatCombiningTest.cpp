@@ -16,7 +16,10 @@
 
 #include <folly/synchronization/test/FlatCombiningTestHelpers.h>
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <folly/portability/GTest.h>
 
@@ -92,6 +95,78 @@ TEST_P(FlatCombiningTest, more_threads_than_records) {
       true);
 }
 
+namespace {
+
+// Counter that applies all the combined additions of a pass at once.
+class BatchCounter
+    : public folly::FlatCombining<BatchCounter, std::mutex, std::atomic, int> {
+  using FC = folly::FlatCombining<BatchCounter, std::mutex, std::atomic, int>;
+  friend FC;
+
+ public:
+  explicit BatchCounter(bool dedicated) : FC(dedicated) {}
+
+  void add(int n) {
+    auto opFn = [&] { count_ += n; };
+    auto fillFn = [&](int& req) { req = n; };
+    requestFC(opFn, fillFn);
+  }
+
+  uint64_t count() {
+    uint64_t res;
+    auto fn = [&] { res = count_; };
+    requestFC(fn);
+    return res;
+  }
+
+  size_t maxBatch() const { return maxBatch_; }
+
+ private:
+  void combineBatch(folly::span<Rec* const> batch) {
+    maxBatch_ = std::max(maxBatch_, batch.size());
+    uint64_t sum = 0;
+    for (auto rec : batch) {
+      if (!rec->getFn()) {
+        sum += rec->getReq();
+      }
+    }
+    count_ += sum;
+    for (auto rec : batch) {
+      if (rec->getFn()) {
+        processReq(*rec);
+      } else {
+        completeReq(*rec);
+      }
+    }
+  }
+
+  uint64_t count_{0};
+  size_t maxBatch_{0};
+};
+
+} // namespace
+
+TEST(FlatCombiningTest, combineBatch) {
+  constexpr int kThreads = 8;
+  constexpr int kOps = 10000;
+  for (bool dedicated : {true, false}) {
+    BatchCounter counter(dedicated);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < kOps; ++i) {
+          counter.add(2);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    EXPECT_EQ(2 * kThreads * kOps, counter.count());
+    EXPECT_GE(counter.maxBatch(), 1);
+  }
+}
+
 constexpr Params params[] = {
     {false, false, false, false, false}, // no combining
     // simple combining
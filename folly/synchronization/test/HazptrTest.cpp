@@ -1597,6 +1597,7 @@ uint64_t tc_miss_bench(std::string name, int nthreads) {
 
 const int nthr[] = {1, 10};
 const int sizes[] = {10, 20};
+const int retire_nthr[] = {1, 8, 32, 128};
 
 void benches() {
   for (int i : nthr) {
@@ -1637,6 +1638,13 @@ void benches() {
     std::cout << "Life cycle of unused tagged obj cohort        ";
     cohort_bench("", i);
   }
+  std::cout << "=========================== retire scaling "
+            << "===========================" << std::endl;
+  for (int i : retire_nthr) {
+    std::cout << "allocate/retire/reclaim object " << std::setw(3) << i
+              << " threads    ";
+    obj_bench("", i);
+  }
 }
 
 TEST(HazptrTest, bench) {
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Compares the initialized fast path of the thread-safe lazy initialization
+// primitives. Every thread reads an already initialized value, so the numbers
+// are the cost of the check and the load, plus any cache-line contention on
+// the flag, at increasing concurrency.
+
+#include <deque>
+#include <thread>
+
+#include <glog/logging.h>
+
+#include <folly/Benchmark.h>
+#include <folly/ConcurrentLazy.h>
+#include <folly/synchronization/CallOnce.h>
+#include <folly/synchronization/DelayedInit.h>
+#include <folly/synchronization/DelayedInitPtr.h>
+
+template <typename Func>
+void bm_impl(size_t iters, size_t nthreads, Func fn) {
+  // Initialize outside the timed threads so that only the fast path is timed.
+  fn();
+  std::deque<std::thread> threads;
+  for (size_t i = 0u; i < nthreads; ++i) {
+    threads.emplace_back([&fn, iters] {
+      for (size_t j = 0u; j < iters; ++j) {
+        folly::doNotOptimizeAway(fn());
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+void callOnce(size_t iters, size_t nthreads) {
+  folly::BenchmarkSuspender braces;
+  folly::once_flag flag;
+  int value = 0;
+  braces.dismissing([&] {
+    bm_impl(iters, nthreads, [&] {
+      folly::call_once(flag, [&] { value = 1; });
+      return value;
+    });
+  });
+  CHECK_EQ(1, value);
+}
+
+void delayedInit(size_t iters, size_t nthreads) {
+  folly::BenchmarkSuspender braces;
+  folly::DelayedInit<int> value;
+  braces.dismissing([&] {
+    bm_impl(iters, nthreads, [&] { return value.try_emplace(1); });
+  });
+  CHECK_EQ(1, *value);
+}
+
+void delayedInitPtr(size_t iters, size_t nthreads) {
+  folly::BenchmarkSuspender braces;
+  folly::DelayedInitPtr<int> value;
+  braces.dismissing([&] {
+    bm_impl(iters, nthreads, [&] { return value.try_emplace(1); });
+  });
+  CHECK_EQ(1, *value);
+}
+
+void concurrentLazy(size_t iters, size_t nthreads) {
+  folly::BenchmarkSuspender braces;
+  auto const value = folly::concurrent_lazy([] { return 1; });
+  braces.dismissing([&] { bm_impl(iters, nthreads, [&] { return value(); }); });
+  CHECK_EQ(1, value());
+}
+
+void concurrentLazyPtr(size_t iters, size_t nthreads) {
+  folly::BenchmarkSuspender braces;
+  auto const value = folly::concurrent_lazy_ptr([] { return 1; });
+  braces.dismissing([&] { bm_impl(iters, nthreads, [&] { return value(); }); });
+  CHECK_EQ(1, value());
+}
+
+#define LAZY_INIT_BENCHMARKS(nthreads)                                  \
+  BENCHMARK_NAMED_PARAM(callOnce, t##nthreads, nthreads)                \
+  BENCHMARK_RELATIVE_NAMED_PARAM(delayedInit, t##nthreads, nthreads)    \
+  BENCHMARK_RELATIVE_NAMED_PARAM(delayedInitPtr, t##nthreads, nthreads) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(concurrentLazy, t##nthreads, nthreads) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(concurrentLazyPtr, t##nthreads, nthreads)
+
+LAZY_INIT_BENCHMARKS(1)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(2)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(4)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(8)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(16)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(32)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(64)
+BENCHMARK_DRAW_LINE();
+LAZY_INIT_BENCHMARKS(128)
+
+int main(int argc, char** argv) {
+  folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
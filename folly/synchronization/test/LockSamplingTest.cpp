@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/synchronization/LockSampling.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+
+#include <folly/ScopeGuard.h>
+#include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/synchronization/DistributedMutex.h>
+#include <folly/synchronization/Lock.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+
+namespace {
+
+// The statistics of the site named name, if sampled.
+std::optional<LockSiteStats> statsOf(const char* name) {
+  for (auto& stats : getLockSiteStats()) {
+    if (std::strcmp(stats.name, name) == 0) {
+      return stats;
+    }
+  }
+  return std::nullopt;
+}
+
+// Each thread starts with a countdown of 1, so that tests run in a thread of
+// their own sample from their first acquisition, whatever the ones before
+// them did.
+template <typename F>
+void inNewThread(uint32_t rate, F f) {
+  setLockSampleRate(rate);
+  SCOPE_EXIT {
+    setLockSampleRate(0);
+  };
+  std::thread(f).join();
+}
+
+// Sites are static, so their statistics outlive the tests.
+class LockSampling : public testing::Test {
+ protected:
+  void SetUp() override { resetLockSiteStats(); }
+};
+
+uint64_t sum(const std::array<uint64_t, kLockSampleBuckets>& histogram) {
+  uint64_t result = 0;
+  for (auto count : histogram) {
+    result += count;
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(LockSampling, disabledByDefault) {
+  EXPECT_EQ(0, getLockSampleRate());
+  std::mutex mutex;
+  std::thread([&] {
+    for (int i = 0; i < 10000; ++i) {
+      auto lock = FOLLY_SAMPLED_LOCK("disabled", std::unique_lock{mutex});
+    }
+  }).join();
+  EXPECT_FALSE(statsOf("disabled"));
+}
+
+TEST_F(LockSampling, sampleRate) {
+  std::mutex mutex;
+  inNewThread(4, [&] {
+    for (int i = 0; i < 100; ++i) {
+      auto lock = FOLLY_SAMPLED_LOCK("rate", std::unique_lock{mutex});
+      EXPECT_TRUE(lock.get().owns_lock());
+    }
+  });
+  auto stats = *statsOf("rate");
+  EXPECT_EQ(25, stats.samples);
+  EXPECT_EQ(25, sum(stats.waitHistogram));
+  EXPECT_EQ(25, sum(stats.holdHistogram));
+  EXPECT_NE(nullptr, std::strstr(stats.file, "LockSamplingTest.cpp"));
+  EXPECT_GT(stats.line, 0);
+}
+
+TEST_F(LockSampling, lockKinds) {
+  SharedMutex sharedMutex;
+  DistributedMutex distributedMutex;
+  Synchronized<int> synchronized{0};
+  inNewThread(1, [&] {
+    {
+      auto lock =
+          FOLLY_SAMPLED_LOCK("shared mutex", std::unique_lock{sharedMutex});
+    }
+    {
+      auto lock = FOLLY_SAMPLED_LOCK(
+          "shared mutex shared", std::shared_lock{sharedMutex});
+    }
+    {
+      auto lock = FOLLY_SAMPLED_LOCK(
+          "distributed mutex", folly::unique_lock{distributedMutex});
+    }
+    {
+      auto locked = FOLLY_SAMPLED_LOCK("synchronized", synchronized.wlock());
+      *locked = 42;
+    }
+    {
+      auto locked = FOLLY_SAMPLED_LOCK("synchronized", synchronized.rlock());
+      EXPECT_EQ(42, *locked);
+    }
+  });
+  EXPECT_EQ(1, statsOf("shared mutex")->samples);
+  EXPECT_EQ(1, statsOf("shared mutex shared")->samples);
+  EXPECT_EQ(1, statsOf("distributed mutex")->samples);
+  // The same name, but two sites.
+  auto stats = getLockSiteStats();
+  EXPECT_EQ(2, std::count_if(stats.begin(), stats.end(), [](auto& site) {
+              return std::strcmp(site.name, "synchronized") == 0;
+            }));
+  EXPECT_TRUE(sharedMutex.try_lock());
+  sharedMutex.unlock();
+}
+
+TEST_F(LockSampling, arrow) {
+  Synchronized<std::vector<int>> synchronized;
+  inNewThread(1, [&] {
+    auto locked = FOLLY_SAMPLED_LOCK("arrow", synchronized.wlock());
+    locked->push_back(1);
+  });
+  EXPECT_EQ(1, synchronized.rlock()->size());
+}
+
+TEST_F(LockSampling, holdAndWaitTimes) {
+  setLockSampleRate(1);
+  SCOPE_EXIT {
+    setLockSampleRate(0);
+  };
+  std::mutex mutex;
+  Baton<> locked;
+  std::thread holder([&] {
+    auto lock = FOLLY_SAMPLED_LOCK("hold", std::unique_lock{mutex});
+    locked.post();
+    std::this_thread::sleep_for(20ms);
+  });
+  locked.wait();
+  std::thread([&] {
+    auto lock = FOLLY_SAMPLED_LOCK("wait", std::unique_lock{mutex});
+  }).join();
+  holder.join();
+
+  auto hold = *statsOf("hold");
+  EXPECT_EQ(1, hold.samples);
+  EXPECT_GE(hold.maxHold, 20ms);
+  EXPECT_EQ(hold.maxHold, hold.totalHold);
+  auto wait = *statsOf("wait");
+  EXPECT_EQ(1, wait.samples);
+  EXPECT_GE(wait.maxWait, 1ms);
+  EXPECT_EQ(1, sum(wait.waitHistogram));
+  EXPECT_EQ(0, wait.waitHistogram[0]);
+
+  // Waited the longest.
+  EXPECT_STREQ("wait", getLockSiteStats().front().name);
+}
+
+TEST_F(LockSampling, unlockAndMove) {
+  std::mutex mutex;
+  inNewThread(1, [&] {
+    auto lock = FOLLY_SAMPLED_LOCK("unlock", std::unique_lock{mutex});
+    auto moved = std::move(lock);
+    moved.unlock();
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+  });
+  EXPECT_EQ(1, statsOf("unlock")->samples);
+}
+
+TEST_F(LockSampling, reset) {
+  std::mutex mutex;
+  inNewThread(1, [&] {
+    auto lock = FOLLY_SAMPLED_LOCK("reset", std::unique_lock{mutex});
+  });
+  EXPECT_EQ(1, statsOf("reset")->samples);
+  resetLockSiteStats();
+  auto stats = *statsOf("reset");
+  EXPECT_EQ(0, stats.samples);
+  EXPECT_EQ(0, sum(stats.holdHistogram));
+  EXPECT_EQ(0ns, stats.maxHold);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <folly/synchronization/RcuProtected.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// Counts the live instances, to check that replaced values are reclaimed.
+struct Counted {
+  static std::atomic<int> live;
+
+  explicit Counted(int v = 0) : value(v) { ++live; }
+  Counted(const Counted& other) : value(other.value) { ++live; }
+  ~Counted() { --live; }
+
+  int value;
+};
+
+std::atomic<int> Counted::live{0};
+
+} // namespace
+
+TEST(RcuProtected, readAndWrite) {
+  RcuProtected<std::vector<int>> protectedVector{std::vector<int>{1, 2}};
+  EXPECT_EQ(2, protectedVector.rlock()->size());
+
+  protectedVector.withWLock([](auto& v) { v.push_back(3); });
+  EXPECT_EQ(3, protectedVector.withRLock([](auto& v) { return v.back(); }));
+
+  {
+    auto writer = protectedVector.wlock();
+    writer->push_back(4);
+    // Not published until unlocked.
+    EXPECT_EQ(3, protectedVector.rlock()->size());
+  }
+  EXPECT_EQ(4, protectedVector.rlock()->size());
+
+  protectedVector.store({5});
+  EXPECT_EQ(std::vector<int>{5}, protectedVector.copy());
+}
+
+TEST(RcuProtected, readersKeepTheirValue) {
+  RcuProtected<std::string> str{std::string("old")};
+  auto reader = str.rlock();
+  auto writer = str.wlock();
+  *writer = "new";
+  writer.unlock();
+  EXPECT_EQ("old", *reader);
+  reader.unlock();
+  EXPECT_EQ("new", *str.rlock());
+}
+
+TEST(RcuProtected, throwingWriterPublishesNothing) {
+  RcuProtected<int> value{1};
+  EXPECT_THROW(
+      value.withWLock([](int& v) {
+        v = 2;
+        throw std::runtime_error("fail");
+      }),
+      std::runtime_error);
+  EXPECT_EQ(1, *value.rlock());
+  // And does not keep the writers' lock.
+  value.withWLock([](int& v) { v = 3; });
+  EXPECT_EQ(3, *value.rlock());
+}
+
+TEST(RcuProtected, reclaimsReplacedValues) {
+  {
+    RcuProtected<Counted> counted{std::in_place, 0};
+    for (int i = 0; i < 100; ++i) {
+      counted.withWLock([](Counted& c) { ++c.value; });
+    }
+    EXPECT_EQ(100, counted.rlock()->value);
+    rcu_synchronize();
+    rcu_synchronize();
+    EXPECT_EQ(1, Counted::live.load());
+  }
+  EXPECT_EQ(0, Counted::live.load());
+}
+
+TEST(RcuProtected, customDomain) {
+  rcu_domain domain;
+  {
+    RcuProtected<int> value{domain, std::in_place, 1};
+    value.withWLock([](int& v) { ++v; });
+    EXPECT_EQ(2, value.copy());
+  }
+  domain.synchronize();
+}
+
+TEST(RcuProtected, concurrentReadersAndWriters) {
+  // Writers keep both halves equal, so a reader seeing a half-written value
+  // would see them differ.
+  RcuProtected<std::pair<int, int>> pair{std::in_place, 0, 0};
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      int last = 0;
+      while (!done.load()) {
+        auto p = pair.rlock();
+        EXPECT_EQ(p->first, p->second);
+        // Writes are ordered.
+        EXPECT_GE(p->first, last);
+        last = p->first;
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 2; ++i) {
+    writers.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        pair.withWLock([](auto& p) {
+          ++p.first;
+          ++p.second;
+        });
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(2000, pair.rlock()->first);
+}
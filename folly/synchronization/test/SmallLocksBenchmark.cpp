@@ -27,7 +27,10 @@
 
 #include <folly/Benchmark.h>
 #include <folly/SharedMutex.h>
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/lang/Aligned.h>
+#include <folly/portability/PThread.h>
+#include <folly/portability/Sched.h>
 #include <folly/synchronization/DistributedMutex.h>
 #include <folly/synchronization/FlatCombining.h>
 #include <folly/synchronization/SmallLocks.h>
@@ -87,6 +90,11 @@ class DistributedMutexFlatCombining {
   folly::DistributedMutex mutex_;
 };
 
+class NumaDistributedMutexFlatCombining {
+ public:
+  folly::NumaDistributedMutex mutex_;
+};
+
 class NoLock {
  public:
   void lock() {}
@@ -139,6 +147,10 @@ auto lock_and(DistributedMutexFlatCombining& mutex, std::size_t, F func) {
   return mutex.mutex_.lock_combine(std::move(func));
 }
 template <typename F>
+auto lock_and(NumaDistributedMutexFlatCombining& mutex, std::size_t, F func) {
+  return mutex.mutex_.lock_combine(std::move(func));
+}
+template <typename F>
 auto lock_and(FlatCombiningMutexNoCaching& mutex, std::size_t i, F func) {
   return mutex.lock_combine(func, i);
 }
@@ -277,6 +289,69 @@ static void runContended(
   });
 }
 
+static void bindToCpus(const std::vector<size_t>& cpus) {
+#if defined(__linux__)
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (auto cpu : cpus) {
+    CPU_SET(cpu, &cpuSet);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+  (void)cpus;
+#endif
+  folly::AccessSpreader<>::invalidateCachedCurrent();
+}
+
+/**
+ * All threads contend on a single lock, with the threads spread round-robin
+ * over the NUMA nodes (last-level caches) of the machine.  Each critical
+ * section writes a few cache lines of protected data, so every handoff to a
+ * thread on another node also moves that data across the interconnect
+ */
+template <typename Lock>
+static void runCrossNode(size_t numOps, size_t numThreads) {
+  folly::BenchmarkSuspender braces;
+  const auto& locality = folly::CacheLocality::system();
+  auto cpusByNode = locality.cpusByStripe(locality.numLastLevelCaches());
+
+  struct lockstruct {
+    char padding1[128];
+    Lock mutex;
+    char padding2[128];
+    std::array<std::uint64_t, 32> value;
+  };
+  auto lock = std::make_unique<lockstruct>();
+  lock->value.fill(0);
+
+  std::vector<std::thread> threads(numThreads);
+  SimpleBarrier runbarrier(numThreads + 1);
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads[t] = std::thread([&, t] {
+      bindToCpus(cpusByNode[t % cpusByNode.size()]);
+      runbarrier.wait();
+      for (size_t op = 0; op < numOps; op += 1) {
+        auto val = lock_and(lock->mutex, t, [&value = lock->value]() noexcept {
+          burn(FLAGS_work);
+          for (auto& v : value) {
+            ++v;
+          }
+          return value[0];
+        });
+        read(val);
+        burn(FLAGS_unlocked_work);
+      }
+    });
+  }
+
+  runbarrier.wait();
+  braces.dismissing([&] {
+    for (auto& thr : threads) {
+      thr.join();
+    }
+  });
+}
+
 template <typename Lock>
 static void runFairness(std::size_t numThreads) {
   size_t totalthreads = std::thread::hardware_concurrency();
@@ -509,6 +584,22 @@ static void folly_distributedmutex_simple(size_t numOps, size_t numThreads) {
 static void folly_distributedmutex_combining_simple(size_t o, size_t t) {
   runContended<DistributedMutexFlatCombining, Ints>(o, t, 0);
 }
+static void std_mutex_cross_node(size_t numOps, size_t numThreads) {
+  runCrossNode<std::mutex>(numOps, numThreads);
+}
+static void folly_distributedmutex_cross_node(size_t ops, size_t threads) {
+  runCrossNode<folly::DistributedMutex>(ops, threads);
+}
+static void folly_numadistributedmutex_cross_node(size_t ops, size_t threads) {
+  runCrossNode<folly::NumaDistributedMutex>(ops, threads);
+}
+static void folly_distributedmutex_combining_cross_node(size_t o, size_t t) {
+  runCrossNode<DistributedMutexFlatCombining>(o, t);
+}
+static void folly_numadistributedmutex_combining_cross_node(
+    size_t o, size_t t) {
+  runCrossNode<NumaDistributedMutexFlatCombining>(o, t);
+}
 static void atomics_fetch_add(size_t numOps, size_t numThreads) {
   runContended<NoLock, AtomicsAdd>(numOps, numThreads, 0);
 }
@@ -727,6 +818,26 @@ BENCH_REL(atomics_fetch_add, 128thread, 128)
 BENCH_REL(atomic_fetch_xor, 128thread, 128)
 BENCH_REL(atomic_cas, 128thread, 128)
 
+// Cross-node contention, threads spread over all NUMA nodes
+BENCHMARK_DRAW_LINE();
+BENCH_BASE(std_mutex_cross_node, 8thread, 8)
+BENCH_REL(folly_distributedmutex_cross_node, 8thread, 8)
+BENCH_REL(folly_numadistributedmutex_cross_node, 8thread, 8)
+BENCH_REL(folly_distributedmutex_combining_cross_node, 8thread, 8)
+BENCH_REL(folly_numadistributedmutex_combining_cross_node, 8thread, 8)
+BENCHMARK_DRAW_LINE();
+BENCH_BASE(std_mutex_cross_node, 32thread, 32)
+BENCH_REL(folly_distributedmutex_cross_node, 32thread, 32)
+BENCH_REL(folly_numadistributedmutex_cross_node, 32thread, 32)
+BENCH_REL(folly_distributedmutex_combining_cross_node, 32thread, 32)
+BENCH_REL(folly_numadistributedmutex_combining_cross_node, 32thread, 32)
+BENCHMARK_DRAW_LINE();
+BENCH_BASE(std_mutex_cross_node, 64thread, 64)
+BENCH_REL(folly_distributedmutex_cross_node, 64thread, 64)
+BENCH_REL(folly_numadistributedmutex_cross_node, 64thread, 64)
+BENCH_REL(folly_distributedmutex_combining_cross_node, 64thread, 64)
+BENCH_REL(folly_numadistributedmutex_combining_cross_node, 64thread, 64)
+
 template <typename Mutex>
 void fairnessTest(std::string type, std::size_t numThreads) {
   std::cout << "------- " << type << " " << numThreads << " threads";
@@ -751,6 +862,8 @@ int main(int argc, char** argv) {
           "folly::DistributedMutex", numThreads);
       fairnessTest<DistributedMutexFlatCombining>(
           "folly::DistributedMutex (Combining)", numThreads);
+      fairnessTest<folly::NumaDistributedMutex>(
+          "folly::NumaDistributedMutex", numThreads);
 
       std::cout << std::string(76, '=') << std::endl;
     }
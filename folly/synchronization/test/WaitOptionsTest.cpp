@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/synchronization/WaitOptions.h>
+
+#include <thread>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/synchronization/SaturatingSemaphore.h>
+#include <folly/synchronization/ThrottledLifoSem.h>
+
+using namespace folly;
+using namespace std::chrono_literals;
+
+TEST(AdaptiveSpin, ShortWaits) {
+  AdaptiveSpin spin{10us};
+  EXPECT_EQ(10us, spin.spin_max());
+  for (int i = 0; i < 100; ++i) {
+    spin.record(1us);
+  }
+  EXPECT_GE(spin.expected(), 900ns);
+  EXPECT_LE(spin.expected(), 1100ns);
+  EXPECT_GE(spin.spin_max(), 1800ns);
+  EXPECT_LE(spin.spin_max(), 2200ns);
+
+  for (int i = 0; i < 100; ++i) {
+    spin.record(0ns);
+  }
+  EXPECT_GT(spin.spin_max(), 0ns);
+}
+
+TEST(AdaptiveSpin, LongWaits) {
+  AdaptiveSpin spin{10us};
+  for (int i = 0; i < 100; ++i) {
+    spin.record(1s);
+  }
+  // Long waits are capped, so a few short ones bring the average back.
+  EXPECT_GE(spin.expected(), 39us);
+  EXPECT_LE(spin.expected(), 40us);
+
+  size_t probes = 0;
+  for (uint32_t i = 0; i < AdaptiveSpin::kProbeInterval; ++i) {
+    auto spinMax = spin.spin_max();
+    if (spinMax > 0ns) {
+      EXPECT_EQ(10us, spinMax);
+      ++probes;
+    }
+  }
+  EXPECT_EQ(1, probes);
+
+  for (int i = 0; i < 100; ++i) {
+    spin.record(1us);
+  }
+  EXPECT_LT(spin.expected(), 10us);
+  EXPECT_GT(spin.spin_max(), 0ns);
+}
+
+TEST(AdaptiveSpin, Baton) {
+  AdaptiveSpin spin;
+  auto const opt = WaitOptions().adaptive_spin(&spin);
+
+  // Waits which time out are long, and stop spinning.
+  Baton<> b;
+  for (int i = 0; i < 100; ++i) {
+    b.reset();
+    EXPECT_FALSE(b.try_wait_for(100us, opt));
+  }
+  EXPECT_GE(spin.expected(), 30us);
+  EXPECT_EQ(0ns, spin.spin_max());
+
+  b.reset();
+  std::thread t([&] { b.post(); });
+  b.wait(opt);
+  t.join();
+}
+
+TEST(AdaptiveSpin, SaturatingSemaphore) {
+  AdaptiveSpin spin;
+  auto const opt = WaitOptions().adaptive_spin(&spin);
+  SaturatingSemaphore<true> s;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(s.try_wait_for(100us, opt));
+  }
+  EXPECT_GE(spin.expected(), 30us);
+
+  std::thread t([&] { s.post(); });
+  s.wait(opt);
+  t.join();
+}
+
+TEST(AdaptiveSpin, ThrottledLifoSem) {
+  AdaptiveSpin spin;
+  auto const opt = WaitOptions().adaptive_spin(&spin);
+  ThrottledLifoSem sem;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(sem.try_wait_for(100us, opt));
+  }
+  EXPECT_GE(spin.expected(), 30us);
+
+  std::thread t([&] { sem.post(); });
+  sem.wait(opt);
+  t.join();
+}
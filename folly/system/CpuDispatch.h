@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include <folly/CPortability.h>
+#include <folly/CpuId.h>
+#include <folly/Likely.h>
+#include <folly/Portability.h>
+#include <folly/system/AuxVector.h>
+
+//  FOLLY_CPU_DISPATCH_IFUNC
+//
+//  Whether FOLLY_CPU_DISPATCH defines GNU ifuncs. The resolver of an ifunc
+//  runs while the program is being loaded, before the sanitizers are set up,
+//  so the instrumented builds dispatch on the first call instead.
+#if FOLLY_HAVE_IFUNC && defined(__ELF__) && !FOLLY_SANITIZE && \
+    (FOLLY_X64 || (FOLLY_AARCH64 && defined(__linux__)))
+#define FOLLY_CPU_DISPATCH_IFUNC 1
+#else
+#define FOLLY_CPU_DISPATCH_IFUNC 0
+#endif
+
+#if FOLLY_CPU_DISPATCH_IFUNC && FOLLY_AARCH64 && __has_include(<sys/ifunc.h>)
+#include <sys/ifunc.h>
+#endif
+
+namespace folly {
+
+/**
+ * The features of a CPU, which select the best of the implementations of a
+ * function: cpuId on x86, and hwCaps, from the ELF auxiliary vector, on
+ * aarch64. The features of the other architecture are all false.
+ */
+struct CpuFeatures {
+  CpuId cpuId;
+  ElfHwCaps hwCaps{0, 0};
+
+  // glibc rewrites the hwcaps of x86 (see ElfHwCaps), so they are left out.
+  FOLLY_ALWAYS_INLINE CpuFeatures() {
+#if FOLLY_AARCH64
+    hwCaps = ElfHwCaps();
+#endif
+  }
+
+  // Doesn't call any function, for ifunc resolvers, which get the hwcaps of
+  // aarch64 as arguments.
+  FOLLY_ALWAYS_INLINE CpuFeatures(uint64_t hwcap, uint64_t hwcap2)
+      : hwCaps(hwcap, hwcap2) {}
+};
+
+/**
+ * The features of the CPU the process runs on, read once: cpuid is
+ * serializing, and traps to the hypervisor in some virtual machines.
+ */
+inline const CpuFeatures& cpuFeatures() noexcept {
+  static const CpuFeatures features;
+  return features;
+}
+
+/**
+ * A function of type F, which calls the implementation returned by select,
+ * given the features of the CPU. select is called on the first call, and its
+ * result kept for the next ones.
+ *
+ * The constructor is constexpr, so that a CpuDispatch at namespace scope may
+ * be called during static initialization:
+ *
+ *   uint32_t crc32cSse42(const uint8_t*, size_t, uint32_t);
+ *   uint32_t crc32cSoftware(const uint8_t*, size_t, uint32_t);
+ *
+ *   auto selectCrc32c(const CpuFeatures& cpu) {
+ *     return cpu.cpuId.sse42() ? crc32cSse42 : crc32cSoftware;
+ *   }
+ *   CpuDispatch<uint32_t(const uint8_t*, size_t, uint32_t)> crc32cImpl{
+ *       selectCrc32c};
+ *
+ *   auto crc = crc32cImpl(data, size, ~0U);
+ *
+ * Prefer FOLLY_CPU_DISPATCH to define an extern function, which saves the
+ * check and the indirection where ifuncs are supported.
+ */
+template <typename F>
+class CpuDispatch {
+  static_assert(std::is_function_v<F>, "CpuDispatch takes a function type");
+
+ public:
+  using pointer = F*;
+  using select_type = pointer (*)(const CpuFeatures&);
+
+  constexpr explicit CpuDispatch(select_type select) noexcept
+      : select_(select) {}
+
+  CpuDispatch(const CpuDispatch&) = delete;
+  CpuDispatch& operator=(const CpuDispatch&) = delete;
+
+  /// The selected implementation.
+  FOLLY_ALWAYS_INLINE pointer get() const noexcept {
+    auto fn = fn_.load(std::memory_order_relaxed);
+    return FOLLY_LIKELY(fn != nullptr) ? fn : select();
+  }
+
+  template <typename... A>
+  FOLLY_ALWAYS_INLINE decltype(auto) operator()(A&&... args) const
+      noexcept(std::is_nothrow_invocable_v<pointer, A&&...>) {
+    return get()(static_cast<A&&>(args)...);
+  }
+
+ private:
+  // Threads racing on the first call all store the same pointer.
+  FOLLY_NOINLINE pointer select() const noexcept {
+    auto fn = select_(cpuFeatures());
+    fn_.store(fn, std::memory_order_relaxed);
+    return fn;
+  }
+
+  select_type select_;
+  mutable std::atomic<pointer> fn_{nullptr};
+};
+
+namespace detail {
+
+template <typename F>
+struct cpu_dispatch_result;
+template <typename R, typename... A>
+struct cpu_dispatch_result<R(A...)> {
+  using type = R;
+  static constexpr bool nothrow = false;
+};
+template <typename R, typename... A>
+struct cpu_dispatch_result<R(A...) noexcept> {
+  using type = R;
+  static constexpr bool nothrow = true;
+};
+
+// The features which an ifunc resolver can read without calling functions:
+// glibc passes the hwcaps of aarch64 as arguments, and the x86 ones are read
+// by inline cpuid instructions.
+FOLLY_ALWAYS_INLINE CpuFeatures
+cpuDispatchIfuncFeatures(uint64_t hwcap, const void* arg) noexcept {
+#if FOLLY_AARCH64 && defined(_IFUNC_ARG_HWCAP)
+  uint64_t hwcap2 = 0;
+  if ((hwcap & _IFUNC_ARG_HWCAP) && arg != nullptr) {
+    hwcap2 = static_cast<const __ifunc_arg_t*>(arg)->_hwcap2;
+  }
+  return CpuFeatures(hwcap & ~uint64_t(_IFUNC_ARG_HWCAP), hwcap2);
+#elif FOLLY_AARCH64
+  (void)arg;
+  return CpuFeatures(hwcap, 0);
+#else
+  (void)hwcap;
+  (void)arg;
+  return CpuFeatures(0, 0);
+#endif
+}
+
+} // namespace detail
+
+} // namespace folly
+
+/**
+ * FOLLY_CPU_DISPATCH(name, select, params, args)
+ *
+ * Defines the function name, declared beforehand, as calling the
+ * implementation returned by select, given the features of the CPU. params
+ * is the parenthesized parameter list of name, and args the parenthesized
+ * names of its parameters. To be used in a .cpp file, in the namespace of
+ * the declaration:
+ *
+ *   // Range.h
+ *   size_t findByte(StringPiece haystack, char needle);
+ *
+ *   // Range.cpp
+ *   namespace {
+ *   decltype(&findByte) selectFindByte(const CpuFeatures& cpu) {
+ *     return cpu.cpuId.avx2() ? findByteAvx2 : findByteSse2;
+ *   }
+ *   } // namespace
+ *
+ *   FOLLY_CPU_DISPATCH(
+ *       findByte,
+ *       selectFindByte,
+ *       (StringPiece haystack, char needle),
+ *       (haystack, needle));
+ *
+ * Where FOLLY_CPU_DISPATCH_IFUNC, name is a GNU ifunc: select is called once
+ * by the dynamic linker, which binds name to the implementation, so calls
+ * cost the same as to any function of a shared library. select then runs
+ * before the relocations of the program are done, so it must not call any
+ * function but the inline ones of CpuFeatures, and static ones of the same
+ * translation unit. Elsewhere, name calls select the first time, through a
+ * CpuDispatch.
+ */
+#if FOLLY_CPU_DISPATCH_IFUNC
+
+#define FOLLY_CPU_DISPATCH(name, select, params, args)                    \
+  extern "C" decltype(&name) folly_detail_cpu_dispatch_##name(            \
+      std::uint64_t hwcap, const void* arg) {                             \
+    return select(::folly::detail::cpuDispatchIfuncFeatures(hwcap, arg)); \
+  }                                                                       \
+  __attribute__((ifunc("folly_detail_cpu_dispatch_" #name)))              \
+  decltype(name) name
+
+#else
+
+#define FOLLY_CPU_DISPATCH(name, select, params, args)                 \
+  auto name params noexcept(                                           \
+      ::folly::detail::cpu_dispatch_result<decltype(name)>::nothrow)   \
+      -> ::folly::detail::cpu_dispatch_result<decltype(name)>::type {  \
+    static ::folly::CpuDispatch<decltype(name)> dispatch{select};      \
+    return dispatch args;                                              \
+  }                                                                    \
+  decltype(name) name
+
+#endif
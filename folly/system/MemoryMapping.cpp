@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <cstdint>
 #include <utility>
 
 #include <fmt/core.h>
@@ -65,6 +66,44 @@ enum mmap_flags : int {
 #endif
 };
 
+// The advice values newer than the system headers may be, or -1 where there's
+// no such advice.
+#ifdef __linux__
+constexpr int kMadvWillNeed = MADV_WILLNEED;
+constexpr int kMadvHugePage = 14;
+constexpr int kMadvPopulateRead = 22;
+constexpr int kMadvPopulateWrite = 23;
+constexpr int kMadvCollapse = 25;
+#else
+constexpr int kMadvWillNeed = -1;
+constexpr int kMadvHugePage = -1;
+constexpr int kMadvPopulateRead = -1;
+constexpr int kMadvPopulateWrite = -1;
+constexpr int kMadvCollapse = -1;
+#endif
+
+bool madviseIfSupported(void* addr, size_t length, int advice) {
+  return advice >= 0 && ::madvise(addr, length, advice) == 0;
+}
+
+// Populates the page tables of [begin, begin + length), which begins at a page
+// boundary: see MemoryMapping::populate().
+bool populatePages(
+    char* begin, size_t length, size_t pageSize, bool readable, bool write) {
+  if (length == 0 ||
+      madviseIfSupported(
+          begin, length, write ? kMadvPopulateWrite : kMadvPopulateRead)) {
+    return true;
+  }
+  if (write || !readable) {
+    return false;
+  }
+  for (size_t offset = 0; offset < length; offset += pageSize) {
+    (void)*static_cast<volatile char*>(begin + offset);
+  }
+  return true;
+}
+
 } // namespace
 
 MemoryMapping::MemoryMapping(MemoryMapping&& other) noexcept {
@@ -415,6 +454,37 @@ void MemoryMapping::advise(int advice, size_t offset, size_t length) const {
   PLOG_IF(WARNING, ::madvise(mapStart, length, advice)) << "madvise";
 }
 
+bool MemoryMapping::populate(size_t offset, size_t length, bool write) const {
+  CHECK_LE(offset + length, size_t(mapLength_))
+      << " offset: " << offset << " length: " << length
+      << " mapLength_: " << mapLength_;
+  if (write && !options_.writable) {
+    return false;
+  }
+
+  // Include the entire first and last pages.
+  auto const pageSize = size_t(options_.pageSize);
+  auto const end = std::min(
+      (offset + length + pageSize - 1) / pageSize * pageSize,
+      size_t(mapLength_));
+  offset -= offset % pageSize;
+  return populatePages(
+      static_cast<char*>(mapStart_) + offset,
+      length == 0 ? 0 : end - offset,
+      pageSize,
+      options_.readable,
+      write);
+}
+
+bool MemoryMapping::adviseHugePages(bool collapse) const {
+  if (mapLength_ == 0 ||
+      !madviseIfSupported(mapStart_, size_t(mapLength_), kMadvHugePage)) {
+    return false;
+  }
+  return !collapse ||
+      madviseIfSupported(mapStart_, size_t(mapLength_), kMadvCollapse);
+}
+
 MemoryMapping& MemoryMapping::operator=(MemoryMapping&& other) {
   swap(other);
   return *this;
@@ -475,4 +545,86 @@ bool MemoryMapping::LockFlags::operator==(const LockFlags& other) const {
   return lockOnFault == other.lockOnFault;
 }
 
+MemoryMappingPrefetcher::MemoryMappingPrefetcher(
+    const MemoryMapping& mapping, Options options)
+    : range_(mapping.range()), options_(options) {
+  CHECK_GT(options_.step, 0);
+  thread_ = std::thread([this] { run(); });
+  advance(0);
+}
+
+MemoryMappingPrefetcher::~MemoryMappingPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_.store(true, std::memory_order_relaxed);
+  }
+  requestedCv_.notify_one();
+  thread_.join();
+}
+
+void MemoryMappingPrefetcher::advance(size_t offset) {
+  auto const size = range_.size();
+  auto const wanted = offset < size && options_.window < size - offset
+      ? offset + options_.window
+      : size;
+  // Wait for the window to move by a step, unless it reached the end.
+  if (wanted <= lastRequested_ ||
+      (wanted - lastRequested_ < options_.step && wanted < size)) {
+    return;
+  }
+  lastRequested_ = wanted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requested_ = wanted;
+  }
+  requestedCv_.notify_one();
+}
+
+void MemoryMappingPrefetcher::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  doneCv_.wait(lock, [&] {
+    return stop_.load(std::memory_order_relaxed) ||
+        done_.load(std::memory_order_relaxed) >= requested_;
+  });
+}
+
+void MemoryMappingPrefetcher::run() {
+  auto const pageSize = size_t(sysconf(_SC_PAGESIZE));
+  auto const base = const_cast<char*>(
+      reinterpret_cast<const char*>(range_.begin()));
+  // The first page of the range may begin before it.
+  auto const misalign = reinterpret_cast<uintptr_t>(base) % pageSize;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    requestedCv_.wait(lock, [&] {
+      return stop_.load(std::memory_order_relaxed) ||
+          requested_ > done_.load(std::memory_order_relaxed);
+    });
+    if (stop_.load(std::memory_order_relaxed)) {
+      break;
+    }
+    auto from = done_.load(std::memory_order_relaxed);
+    auto const to = requested_;
+    lock.unlock();
+    while (from < to && !stop_.load(std::memory_order_relaxed)) {
+      auto const next = std::min(to, from + options_.step);
+      // Page aligned, including the entire last page.
+      auto const begin = base + from - (from + misalign) % pageSize;
+      auto const end = base + next;
+      auto const length = size_t(end - begin);
+      if (options_.populate) {
+        populatePages(begin, length, pageSize, true, false);
+      } else {
+        madviseIfSupported(begin, length, kMadvWillNeed);
+      }
+      from = next;
+      done_.store(from, std::memory_order_release);
+    }
+    lock.lock();
+    doneCv_.notify_all();
+  }
+  doneCv_.notify_all();
+}
+
 } // namespace folly
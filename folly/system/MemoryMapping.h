@@ -18,6 +18,11 @@
 
 #include <cassert>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <folly/File.h>
 #include <folly/Range.h>
 #include <folly/portability/Unistd.h>
@@ -195,6 +200,23 @@ class MemoryMapping {
   void advise(int advice) const;
   void advise(int advice, size_t offset, size_t length) const;
 
+  /**
+   * Populate the page tables of a range, as Options::prefault does for the
+   * whole mapping, so that accessing it doesn't fault: madvise() with
+   * MADV_POPULATE_READ, or MADV_POPULATE_WRITE if write. Where these aren't
+   * supported (before Linux 5.14), a read populates by touching each page, and
+   * a write returns false. The range is as for advise().
+   */
+  bool populate(size_t offset, size_t length, bool write = false) const;
+
+  /**
+   * Back the mapping with transparent huge pages: madvise(MADV_HUGEPAGE), and
+   * if collapse, madvise(MADV_COLLAPSE) to collapse the pages which are
+   * already populated right away (Linux >= 6.1). File mappings need huge page
+   * support from their file system. Returns false if not supported.
+   */
+  bool adviseHugePages(bool collapse = false) const;
+
   /**
    * A bitwise cast of the mapped bytes as range of values. Only intended for
    * use with POD or in-place usable types.
@@ -259,6 +281,77 @@ class MemoryMapping {
 
 void swap(MemoryMapping&, MemoryMapping&) noexcept;
 
+/**
+ * Prefetches the pages of a mapping ahead of a sequential scan, on a thread of
+ * its own, so that the scan doesn't stall on page faults. The scan reports how
+ * far it got with advance(), and the prefetcher keeps the next window bytes
+ * advised with MADV_WILLNEED, which starts reading them from the file, or
+ * populated.
+ *
+ *   MemoryMappingPrefetcher prefetcher(mapping);
+ *   for (size_t pos = 0; pos < size; pos += recordSize) {
+ *     prefetcher.advance(pos);
+ *     ...
+ *   }
+ *
+ * With a window as large as the mapping and populate set, it prefaults the
+ * whole mapping asynchronously. The mapping must outlive the prefetcher.
+ */
+class MemoryMappingPrefetcher {
+ public:
+  struct Options {
+    Options() {}
+
+    // The bytes after the cursor which are prefetched.
+    size_t window = size_t(64) << 20;
+    // The thread wakes up once the window moved by this many bytes.
+    size_t step = size_t(4) << 20;
+    // Populate the page tables (see MemoryMapping::populate()), rather than
+    // only advising MADV_WILLNEED.
+    bool populate = false;
+  };
+
+  explicit MemoryMappingPrefetcher(
+      const MemoryMapping& mapping, Options options = Options());
+
+  ~MemoryMappingPrefetcher();
+
+  MemoryMappingPrefetcher(const MemoryMappingPrefetcher&) = delete;
+  MemoryMappingPrefetcher& operator=(const MemoryMappingPrefetcher&) = delete;
+
+  /**
+   * Move the cursor to offset in range(). Cheap unless the window moved by a
+   * step. Must not be called concurrently.
+   */
+  void advance(size_t offset);
+
+  /**
+   * The bytes of range() prefetched so far, from its beginning.
+   */
+  size_t prefetched() const { return done_.load(std::memory_order_acquire); }
+
+  /**
+   * Wait until the window of the cursor is prefetched.
+   */
+  void wait();
+
+ private:
+  void run();
+
+  const ByteRange range_;
+  const Options options_;
+  // Only used by advance().
+  size_t lastRequested_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable requestedCv_;
+  std::condition_variable doneCv_;
+  size_t requested_ = 0;
+  std::atomic<size_t> done_{0};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
 /**
  * A special case of memcpy() that always copies memory forwards.
  * (libc's memcpy() is allowed to copy memory backwards, and will do so
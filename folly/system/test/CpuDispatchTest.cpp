@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/system/CpuDispatch.h>
+
+#include <type_traits>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+int addOne(int x) {
+  return x + 1;
+}
+
+int addTwo(int x) {
+  return x + 2;
+}
+
+int selectCount = 0;
+
+decltype(&addOne) selectAdd(const CpuFeatures& cpu) {
+  ++selectCount;
+  return cpu.cpuId.sse42() ? addTwo : addOne;
+}
+
+int expectedAdd(int x) {
+  return CpuId().sse42() ? addTwo(x) : addOne(x);
+}
+
+FOLLY_CONSTINIT CpuDispatch<int(int)> add{selectAdd};
+
+int negate(int x) noexcept {
+  return -x;
+}
+
+decltype(&negate) selectNegate(const CpuFeatures&) {
+  return negate;
+}
+
+} // namespace
+
+namespace folly {
+
+int cpuDispatchTestAdd(int x);
+
+FOLLY_CPU_DISPATCH(cpuDispatchTestAdd, selectAdd, (int x), (x));
+
+} // namespace folly
+
+TEST(CpuDispatch, cpuFeatures) {
+  CpuId cpuId;
+  auto const& features = cpuFeatures();
+  EXPECT_EQ(&features, &cpuFeatures());
+  EXPECT_EQ(cpuId.sse42(), features.cpuId.sse42());
+  EXPECT_EQ(cpuId.avx2(), features.cpuId.avx2());
+  EXPECT_EQ(ElfHwCaps().aarch64_asimd(), features.hwCaps.aarch64_asimd());
+}
+
+TEST(CpuDispatch, selectsOnce) {
+  auto const before = selectCount;
+  EXPECT_EQ(expectedAdd(1), add(1));
+  EXPECT_EQ(expectedAdd(2), add(2));
+  EXPECT_EQ(add.get(), add.get());
+  EXPECT_LE(selectCount - before, 1);
+}
+
+TEST(CpuDispatch, noexcept) {
+  static CpuDispatch<int(int) noexcept> neg{selectNegate};
+  static_assert(noexcept(neg(1)));
+  static_assert(!noexcept(add(1)));
+  EXPECT_EQ(-3, neg(3));
+}
+
+TEST(CpuDispatch, function) {
+  static_assert(std::is_same_v<decltype(&cpuDispatchTestAdd), int (*)(int)>);
+  EXPECT_EQ(expectedAdd(1), cpuDispatchTestAdd(1));
+  EXPECT_EQ(expectedAdd(5), cpuDispatchTestAdd(5));
+}
@@ -17,6 +17,7 @@
 #include <folly/system/MemoryMapping.h>
 
 #include <cstdlib>
+#include <string>
 
 #include <glog/logging.h>
 
@@ -176,4 +177,75 @@ TEST(MemoryMapping, Advise) {
   EXPECT_DEATH(m.advise(MADV_NORMAL, off, size - off + 1), "");
 }
 
+TEST(MemoryMapping, Populate) {
+  File f = File::temporary();
+  size_t kPageSize = 4096;
+  std::string contents(3 * kPageSize + 10, 'x');
+  writeStringToFileOrDie(contents, f.fd());
+
+  MemoryMapping m(File(f.fd()));
+  EXPECT_TRUE(m.populate(0, contents.size()));
+  EXPECT_TRUE(m.populate(1, 2));
+  EXPECT_TRUE(m.populate(kPageSize + 1, 0));
+  // Not writable.
+  EXPECT_FALSE(m.populate(0, kPageSize, true));
+  EXPECT_EQ(contents, m.data());
+  EXPECT_DEATH(m.populate(0, 4 * kPageSize + 1), "");
+
+  // Whether huge pages are supported depends on the kernel.
+  MemoryMapping anon(
+      MemoryMapping::kAnonymous,
+      size_t(4) << 20,
+      MemoryMapping::Options().setWritable(true).setPrefault(false));
+  anon.adviseHugePages(true);
+  EXPECT_TRUE(anon.populate(0, anon.range().size(), true));
+  anon.writableRange()[42] = 'a';
+  EXPECT_EQ('a', anon.range()[42]);
+}
+
+TEST(MemoryMapping, Prefetcher) {
+  File f = File::temporary();
+  size_t const size = (size_t(1) << 20) + 10;
+  PCHECK(ftruncateNoInt(f.fd(), size) == 0) << size;
+  MemoryMapping m(File(f.fd()), 1);
+
+  MemoryMappingPrefetcher::Options options;
+  options.window = 64 << 10;
+  options.step = 16 << 10;
+  MemoryMappingPrefetcher prefetcher(m, options);
+  prefetcher.wait();
+  EXPECT_EQ(64 << 10, prefetcher.prefetched());
+
+  // Less than a step.
+  prefetcher.advance(4 << 10);
+  prefetcher.wait();
+  EXPECT_EQ(64 << 10, prefetcher.prefetched());
+
+  for (size_t pos = 0; pos < m.range().size(); pos += 4096) {
+    prefetcher.advance(pos);
+  }
+  prefetcher.wait();
+  EXPECT_EQ(m.range().size(), prefetcher.prefetched());
+}
+
+TEST(MemoryMapping, PrefetcherPrefault) {
+  File f = File::temporary();
+  std::string contents(size_t(1) << 20, 'x');
+  writeStringToFileOrDie(contents, f.fd());
+  MemoryMapping m(File(f.fd()));
+
+  MemoryMappingPrefetcher::Options options;
+  options.window = contents.size();
+  options.populate = true;
+  {
+    MemoryMappingPrefetcher prefetcher(m, options);
+    prefetcher.wait();
+    EXPECT_EQ(contents.size(), prefetcher.prefetched());
+  }
+  // Stopping with prefetches pending.
+  options.step = 4096;
+  { MemoryMappingPrefetcher prefetcher(m, options); }
+  EXPECT_EQ(contents, m.data());
+}
+
 } // namespace folly
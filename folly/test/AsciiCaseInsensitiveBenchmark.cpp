@@ -114,6 +114,42 @@ BENCHMARK(CurrentCaseInsensitiveCheck, iters) {
   test_operator_on_search<AsciiCaseInsensitive>(iters);
 }
 
+BENCHMARK(QfindCaseInsensitive, iters) {
+  StringPiece const haystack(lorem_ipsum);
+  StringPiece const n(needle);
+  size_t dummy = 0;
+  for (int i = 0; i < iters; ++i) {
+    dummy += qfind(haystack, n, AsciiCaseInsensitive());
+  }
+  doNotOptimizeAway(dummy);
+}
+
+BENCHMARK_DRAW_LINE();
+
+// Case-insensitive header name matching, as in HTTP parsing.
+BENCHMARK(EqualsCaseInsensitiveScalar, iters) {
+  std::string const name = "Access-Control-Allow-Credentials";
+  std::string const other = "access-control-allow-credentials";
+  bool dummy = false;
+  for (int i = 0; i < iters; ++i) {
+    doNotOptimizeAway(name);
+    dummy ^= std::equal(
+        name.begin(), name.end(), other.begin(), AsciiCaseInsensitive());
+  }
+  doNotOptimizeAway(dummy);
+}
+
+BENCHMARK_RELATIVE(EqualsCaseInsensitive, iters) {
+  std::string const name = "Access-Control-Allow-Credentials";
+  std::string const other = "access-control-allow-credentials";
+  bool dummy = false;
+  for (int i = 0; i < iters; ++i) {
+    doNotOptimizeAway(name);
+    dummy ^= StringPiece(name).equals(other, AsciiCaseInsensitive());
+  }
+  doNotOptimizeAway(dummy);
+}
+
 int main(int argc, char** argv) {
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
   folly::runBenchmarks();
@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <string>
 
 #include <folly/Range.h>
 #include <folly/portability/GFlags.h>
@@ -31,6 +32,108 @@ TEST(CaseInsensitiveMatch, CompareWithLegacy) {
   }
 }
 
+namespace {
+
+bool naiveEqual(StringPiece lhs, StringPiece rhs) {
+  return lhs.size() == rhs.size() &&
+      std::equal(lhs.begin(), lhs.end(), rhs.begin(), AsciiCaseInsensitive());
+}
+
+size_t naiveFind(StringPiece haystack, StringPiece needle) {
+  auto it = std::search(
+      haystack.begin(),
+      haystack.end(),
+      needle.begin(),
+      needle.end(),
+      AsciiCaseInsensitive());
+  return it == haystack.end() && !needle.empty() ? std::string::npos
+                                                 : it - haystack.begin();
+}
+
+} // namespace
+
+TEST(CaseInsensitiveMatch, EqualsAllCharacters) {
+  // Each pair of characters, in a position of each block of the vectorized
+  // comparison and of its tail, so that the characters which differ by 0x20
+  // but aren't letters, e.g. '@' and '`', and the non-ASCII bytes are checked.
+  for (size_t size : {1, 7, 8, 15, 16, 17, 31, 33}) {
+    std::string lhs(size, 'x');
+    std::string rhs(size, 'X');
+    for (int i = 0; i < (1 << 8); i++) {
+      for (int j = 0; j < (1 << 8); j++) {
+        size_t const pos = (i + j) % size;
+        lhs[pos] = char(i);
+        rhs[pos] = char(j);
+        EXPECT_EQ(
+            naiveEqual(lhs, rhs),
+            StringPiece(lhs).equals(rhs, AsciiCaseInsensitive()))
+            << i << " " << j << " " << size;
+        lhs[pos] = 'x';
+        rhs[pos] = 'X';
+      }
+    }
+  }
+}
+
+TEST(CaseInsensitiveMatch, StartsEndsWith) {
+  std::string const text = "Content-Type: Application/JSON; Charset=UTF-8";
+  StringPiece const sp(text);
+  EXPECT_TRUE(sp.startsWith("content-type:", AsciiCaseInsensitive()));
+  EXPECT_TRUE(
+      sp.startsWith("CONTENT-TYPE: APPLICATION", AsciiCaseInsensitive()));
+  EXPECT_FALSE(sp.startsWith("content_type:", AsciiCaseInsensitive()));
+  EXPECT_TRUE(sp.endsWith("charset=utf-8", AsciiCaseInsensitive()));
+  EXPECT_TRUE(
+      sp.endsWith("application/json; charset=utf-8", AsciiCaseInsensitive()));
+  EXPECT_FALSE(sp.endsWith("charset=utf-9", AsciiCaseInsensitive()));
+  EXPECT_FALSE(sp.startsWith(text + "x", AsciiCaseInsensitive()));
+  EXPECT_TRUE(sp.equals(text, AsciiCaseInsensitive()));
+  EXPECT_FALSE(sp.equals(text + "x", AsciiCaseInsensitive()));
+
+  std::string mutableText = text;
+  MutableStringPiece msp(&mutableText[0], mutableText.size());
+  EXPECT_TRUE(msp.startsWith("CONTENT-type", AsciiCaseInsensitive()));
+}
+
+TEST(CaseInsensitiveMatch, Find) {
+  std::string haystack;
+  for (int i = 0; i < 100; i++) {
+    haystack += char('a' + i % 26);
+    haystack += char('A' + i % 7);
+  }
+  for (size_t pos = 0; pos < haystack.size(); pos++) {
+    for (size_t len = 0; pos + len <= haystack.size() && len < 40; len++) {
+      std::string needle = haystack.substr(pos, len);
+      for (auto& c : needle) {
+        c = char(c ^ 0x20);
+      }
+      EXPECT_EQ(
+          naiveFind(haystack, needle),
+          qfind(
+              StringPiece(haystack),
+              StringPiece(needle),
+              AsciiCaseInsensitive()))
+          << pos << " " << len;
+    }
+  }
+  StringPiece const header = "Accept-Encoding: gzip, deflate, br";
+  EXPECT_EQ(17, qfind(header, StringPiece("GZIP"), AsciiCaseInsensitive()));
+  EXPECT_EQ(
+      std::string::npos,
+      qfind(header, StringPiece("gzip`"), AsciiCaseInsensitive()));
+  EXPECT_EQ(0, qfind(header, StringPiece(""), AsciiCaseInsensitive()));
+  EXPECT_EQ(
+      std::string::npos,
+      qfind(StringPiece("ab"), StringPiece("abc"), AsciiCaseInsensitive()));
+  // '@' and '`' only differ by the case bit, but they aren't letters.
+  EXPECT_EQ(
+      std::string::npos,
+      qfind(
+          StringPiece("user`example.com"),
+          StringPiece("@"),
+          AsciiCaseInsensitive()));
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
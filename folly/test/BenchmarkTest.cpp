@@ -16,13 +16,16 @@
 
 #include <folly/Benchmark.h>
 #include <folly/detail/PerfScoped.h>
+#include <folly/json/dynamic.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
 #include <folly/test/TestUtils.h>
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <thread>
 
 namespace folly {
 namespace detail {
@@ -306,6 +309,46 @@ TEST_F(BenchmarkingStateTest, SkipWarmUp) {
   }
 }
 
+TEST_F(BenchmarkingStateTest, Latency) {
+  state.addBenchmark(__FILE__, "latency", [&](unsigned n) {
+    doBaseline();
+    TestClock::advance(std::chrono::nanoseconds(n));
+    BenchmarkLatency latency;
+    for (unsigned i = 0; i < n; ++i) {
+      latency.measure([] {});
+    }
+    return n;
+  });
+  state.addBenchmark(__FILE__, "none", [&] {
+    doBaseline();
+    return 1;
+  });
+
+  // Not measured by default.
+  auto results = state.runBenchmarksWithResults();
+  ASSERT_EQ(2, results.size());
+  EXPECT_FALSE(results[0].latencies);
+
+  folly::gflags::SetCommandLineOption("bm_latency", "true");
+  folly::gflags::SetCommandLineOption("bm_max_iters", "1000");
+  results = state.runBenchmarksWithResults();
+  ASSERT_EQ(2, results.size());
+  ASSERT_TRUE(results[0].latencies);
+  auto& latencies = *results[0].latencies;
+  EXPECT_GT(latencies.count, 0);
+  EXPECT_LE(latencies.p50, latencies.p99);
+  EXPECT_LE(latencies.p99, latencies.p999);
+  EXPECT_LE(latencies.p999, latencies.max);
+  EXPECT_FALSE(results[1].latencies);
+}
+
+TEST(BenchmarkLatency, CallsTheOperation) {
+  int calls = 0;
+  BenchmarkLatency latency;
+  latency.measure([&] { ++calls; });
+  EXPECT_EQ(1, calls);
+}
+
 TEST_F(BenchmarkingStateTest, ListTests) {
   std::string output;
 
@@ -349,6 +392,79 @@ TEST_F(BenchmarkingStateTest, ListTests) {
   }
 }
 
+TEST(BenchmarkCompare, FindRegressions) {
+  BenchmarkResult fast{__FILE__, "fast", 10, {}};
+  fast.samples = {10, 10.1, 9.9, 10, 10.05, 9.95};
+  BenchmarkResult slow{__FILE__, "slow", 20, {}};
+  slow.samples = {20, 20.1, 19.9, 20, 20.05, 19.95};
+  BenchmarkResult noisy{__FILE__, "noisy", 30, {}};
+  noisy.samples = {30, 30.3, 29.7, 30, 30.1, 29.9};
+  BenchmarkResult single{__FILE__, "single", 40, {}};
+  const std::vector<BenchmarkResult> base{fast, slow, noisy, single};
+
+  // The samples survive the JSON of --bm_json_verbose.
+  dynamic d;
+  benchmarkResultsToDynamic(base, d);
+  std::vector<BenchmarkResult> parsed;
+  benchmarkResultsFromDynamic(d, parsed);
+  ASSERT_EQ(base.size(), parsed.size());
+  for (size_t i = 0; i < base.size(); ++i) {
+    EXPECT_EQ(base[i].samples, parsed[i].samples);
+  }
+
+  auto test = base;
+  for (auto& sample : test[0].samples) {
+    sample *= 0.9;
+  }
+  for (auto& sample : test[1].samples) {
+    sample *= 1.1;
+  }
+  test[2].samples[0] = 30.2;
+  test[3].timeInNs = 80;
+  EXPECT_EQ(
+      std::vector<std::string>{"slow"}, findBenchmarkRegressions(parsed, test));
+
+  // A slowdown below the threshold isn't a regression, however significant.
+  folly::gflags::FlagSaver _;
+  folly::gflags::SetCommandLineOption("bm_regression_threshold", "0.2");
+  EXPECT_TRUE(findBenchmarkRegressions(parsed, test).empty());
+}
+
+TEST(BenchmarkMT, ThreadCounts) {
+  EXPECT_EQ(std::vector<unsigned>({1}), benchmarkThreadCounts(1));
+  EXPECT_EQ(std::vector<unsigned>({1, 2}), benchmarkThreadCounts(2));
+  EXPECT_EQ(std::vector<unsigned>({1, 2, 4, 6}), benchmarkThreadCounts(6));
+  EXPECT_EQ(std::vector<unsigned>({1, 2, 4, 8}), benchmarkThreadCounts(8));
+  EXPECT_FALSE(benchmarkThreadCounts(0).empty());
+}
+
+TEST(BenchmarkMT, RunOnThreads) {
+  std::atomic<unsigned> calls{0};
+  std::atomic<unsigned> iterations{0};
+  std::atomic<unsigned> threadMask{0};
+  auto duration = runBenchmarkOnThreads(4, 100, [&](unsigned n, unsigned t) {
+    calls.fetch_add(1);
+    iterations.fetch_add(n);
+    threadMask.fetch_or(1u << t);
+  });
+  EXPECT_EQ(4, calls.load());
+  EXPECT_EQ(400, iterations.load());
+  EXPECT_EQ(0xf, threadMask.load());
+  EXPECT_GE(duration.count(), 0);
+}
+
+TEST(BenchmarkMT, RunConcurrently) {
+  // Each thread waits for the others, which must run at the same time.
+  std::atomic<unsigned> started{0};
+  runBenchmarkOnThreads(3, 1, [&](unsigned, unsigned) {
+    started.fetch_add(1);
+    while (started.load() < 3) {
+      std::this_thread::yield();
+    }
+  });
+  EXPECT_EQ(3, started.load());
+}
+
 } // namespace
 } // namespace detail
 } // namespace folly
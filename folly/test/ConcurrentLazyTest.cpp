@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <mutex>
+#include <string>
 #include <thread>
 
 #include <folly/portability/GTest.h>
@@ -112,3 +113,28 @@ TEST(ConcurrentLazy, NonLambda) {
   auto const lazyF = folly::concurrent_lazy(f);
   EXPECT_EQ(lazyF(), true);
 }
+
+TEST(ConcurrentLazy, Ptr) {
+  std::atomic_int computeCount = 0;
+
+  auto const val = folly::concurrent_lazy_ptr([&] {
+    ++computeCount;
+    return std::string("hello");
+  });
+  EXPECT_EQ(computeCount, 0);
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 10; ++i) {
+    readers.push_back(std::thread([&] {
+      for (int j = 0; j < 1000; ++j) {
+        EXPECT_EQ(val(), "hello");
+      }
+    }));
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(&val(), &val());
+  EXPECT_EQ(computeCount, 1);
+}
@@ -18,6 +18,7 @@
 
 #include <map>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <set>
 #include <thread>
@@ -305,6 +306,27 @@ void BM_AddSkipList(int iters, int size) {
   }
 }
 
+// Appends iters increasing values, one by one or in sorted batches of size.
+void BM_AppendSkipList(int iters, int /* size */) {
+  auto skipList = SkipListType::create(kInitHeadHeight);
+  for (int i = 0; i < iters; ++i) {
+    skipList.add(i);
+  }
+}
+
+void BM_AppendSortedSkipList(int iters, int size) {
+  BenchmarkSuspender susp;
+  auto skipList = SkipListType::create(kInitHeadHeight);
+  std::vector<ValueType> batch(size);
+  susp.dismiss();
+
+  for (int i = 0; i < iters; i += size) {
+    std::iota(batch.begin(), batch.end(), i);
+    auto end = batch.begin() + std::min(size, iters - i);
+    skipList.insertSorted(batch.begin(), end);
+  }
+}
+
 BENCHMARK(Accessor, iters) {
   BenchmarkSuspender susp;
   auto skiplist = SkipListType::createInstance(kInitHeadHeight);
@@ -571,6 +593,11 @@ BENCHMARK_PARAM(BM_AddSet, 1000000)
 BENCHMARK_PARAM(BM_AddSkipList, 1000000)
 BENCHMARK_DRAW_LINE();
 
+BENCHMARK_PARAM(BM_AppendSkipList, 1)
+BENCHMARK_PARAM(BM_AppendSortedSkipList, 16)
+BENCHMARK_PARAM(BM_AppendSortedSkipList, 1024)
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK_PARAM(BM_SetMerge, 1000)
 BENCHMARK_PARAM(BM_CSLMergeIntersection, 1000)
 BENCHMARK_PARAM(BM_CSLMergeLookup, 1000)
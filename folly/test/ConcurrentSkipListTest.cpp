@@ -16,8 +16,10 @@
 
 #include <folly/ConcurrentSkipList.h>
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <system_error>
 #include <thread>
@@ -29,6 +31,7 @@
 #include <folly/String.h>
 #include <folly/container/Foreach.h>
 #include <folly/memory/Arena.h>
+#include <folly/memory/ThreadCachedArena.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GTest.h>
 
@@ -498,6 +501,116 @@ TEST(ConcurrentSkipList, NonTrivialDeallocationWithSysArena) {
   TestNonTrivialDeallocation(list);
 }
 
+TEST(ConcurrentSkipList, InsertSorted) {
+  auto skipList = SkipListType::create(kHeadHeight);
+  SetType verifier;
+  for (int i = 0; i < 1000; i += 3) {
+    skipList.add(i);
+    verifier.insert(i);
+  }
+  // Interleaved with and equal to existing values, with duplicates.
+  vector<ValueType> batch;
+  for (int i = 0; i < 2000; i += 2) {
+    batch.push_back(i);
+    if (i % 10 == 0) {
+      batch.push_back(i);
+    }
+  }
+  size_t expected = 0;
+  for (auto v : batch) {
+    expected += verifier.insert(v).second;
+  }
+  EXPECT_EQ(expected, skipList.insertSorted(batch.begin(), batch.end()));
+  verifyEqual(skipList, verifier);
+  EXPECT_EQ(0, skipList.insertSorted(batch.begin(), batch.end()));
+  EXPECT_EQ(0, skipList.insertSorted(batch.end(), batch.end()));
+  verifyEqual(skipList, verifier);
+}
+
+TEST(ConcurrentSkipList, InsertSortedGrowsHeight) {
+  auto skipList = SkipListType::create(1);
+  vector<ValueType> batch(100000);
+  std::iota(batch.begin(), batch.end(), 0);
+  EXPECT_EQ(batch.size(), skipList.insertSorted(batch.begin(), batch.end()));
+  // As high as with single adds.
+  auto single = SkipListType::create(1);
+  for (auto v : batch) {
+    single.add(v);
+  }
+  EXPECT_EQ(single.height(), skipList.height());
+  EXPECT_TRUE(std::equal(batch.begin(), batch.end(), skipList.begin()));
+
+  // Towers are spread over the whole list.
+  SkipListAccessor::Skipper skipper(skipList);
+  for (int i = 0; i < 100000; i += 997) {
+    EXPECT_TRUE(skipper.to(i));
+    EXPECT_EQ(i, *skipper);
+  }
+}
+
+TEST(ConcurrentSkipList, ConcurrentInsertSorted) {
+  int numThreads = 8;
+  auto skipList = SkipListType::create(kHeadHeight);
+  vector<std::thread> threads;
+  vector<SetType> verifiers(numThreads);
+  for (int i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&, i] {
+      // Overlapping batches, racing with single adds and removes.
+      for (int round = 0; round < 50; ++round) {
+        vector<ValueType> batch;
+        for (int j = 0; j < 500; ++j) {
+          batch.push_back(rand() % kMaxValue);
+        }
+        std::sort(batch.begin(), batch.end());
+        skipList.insertSorted(batch.begin(), batch.end());
+        verifiers[i].insert(batch.begin(), batch.end());
+        int r = rand() % kMaxValue;
+        skipList.add(r);
+        verifiers[i].insert(r);
+        skipList.remove(kMaxValue + r);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SetType all;
+  for (auto& verifier : verifiers) {
+    all.insert(verifier.begin(), verifier.end());
+  }
+  verifyEqual(skipList, all);
+}
+
+TEST(ConcurrentSkipList, InsertSortedThreadCachedArena) {
+  using ArenaSkipListType = ConcurrentSkipList<
+      ValueType,
+      std::less<ValueType>,
+      ThreadCachedArenaAllocator<char>>;
+  ThreadCachedArena arena;
+  auto skipList = ArenaSkipListType::create(
+      kHeadHeight, ThreadCachedArenaAllocator<char>(arena));
+  vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i] {
+      vector<ValueType> batch;
+      for (int j = i; j < 4000; j += 4) {
+        batch.push_back(j);
+      }
+      skipList.insertSorted(batch.begin(), batch.end());
+      skipList.remove(i);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(3996, skipList.size());
+  int expected = 4;
+  for (auto value : skipList) {
+    EXPECT_EQ(expected++, value);
+  }
+  EXPECT_GT(arena.totalSize(), 0);
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
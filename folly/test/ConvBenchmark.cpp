@@ -19,11 +19,15 @@
 #include <array>
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include <boost/lexical_cast.hpp>
 
 #include <folly/Benchmark.h>
 #include <folly/CppAttributes.h>
+#include <folly/FormatNumbers.h>
 #include <folly/container/Foreach.h>
 #include <folly/lang/ToAscii.h>
 
@@ -332,6 +336,54 @@ void lexicalCastMeasure(unsigned int n, unsigned int digits) {
   }
 }
 
+// Columns of an ingested file: the digits are parsed eight at a time.
+static std::array<StringPiece, 4> pcColumns{
+    {"42", "20240131", "1706659200123", "-9223372036854775807"}};
+
+void follyAtoiColumnsMeasure(unsigned int n, unsigned int column) {
+  auto p = pcColumns[column];
+  FOR_EACH_RANGE (i, 0, n) {
+    doNotOptimizeAway(folly::to<int64_t>(p.begin(), p.end()));
+  }
+}
+
+void clibAtoiColumnsMeasure(unsigned int n, unsigned int column) {
+  auto p = pcColumns[column];
+  assert(*p.end() == 0);
+  FOR_EACH_RANGE (i, 0, n) {
+    doNotOptimizeAway(strtoll(p.begin(), nullptr, 10));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmarks for ASCII to double conversion
+////////////////////////////////////////////////////////////////////////////////
+
+static std::array<StringPiece, 5> pdValues{
+    {"7", "3.14", "-271.8281828", "12345678.90123456", "6.02214076e23"}};
+
+void follyAtofMeasure(unsigned int n, unsigned int index) {
+  auto p = pdValues[index];
+  FOR_EACH_RANGE (i, 0, n) {
+    doNotOptimizeAway(folly::to<double>(p));
+  }
+}
+
+void follyTryToAtofMeasure(unsigned int n, unsigned int index) {
+  auto p = pdValues[index];
+  FOR_EACH_RANGE (i, 0, n) {
+    doNotOptimizeAway(folly::tryTo<double>(p).value_or(0.0));
+  }
+}
+
+void clibAtofMeasure(unsigned int n, unsigned int index) {
+  auto p = pdValues[index];
+  assert(*p.end() == 0);
+  FOR_EACH_RANGE (i, 0, n) {
+    doNotOptimizeAway(strtod(p.begin(), nullptr));
+  }
+}
+
 // Benchmarks for unsigned to string conversion, raw
 
 unsigned u64ToAsciiTable(uint64_t value, char* dst) {
@@ -895,6 +947,32 @@ DEFINE_BENCHMARK_GROUP(19);
 
 #undef DEFINE_BENCHMARK_GROUP
 
+#define DEFINE_BENCHMARK_GROUP(n)                      \
+  BENCHMARK_PARAM(clibAtoiColumnsMeasure, n)           \
+  BENCHMARK_RELATIVE_PARAM(follyAtoiColumnsMeasure, n) \
+  BENCHMARK_DRAW_LINE()
+
+DEFINE_BENCHMARK_GROUP(0);
+DEFINE_BENCHMARK_GROUP(1);
+DEFINE_BENCHMARK_GROUP(2);
+DEFINE_BENCHMARK_GROUP(3);
+
+#undef DEFINE_BENCHMARK_GROUP
+
+#define DEFINE_BENCHMARK_GROUP(n)                    \
+  BENCHMARK_PARAM(clibAtofMeasure, n)                \
+  BENCHMARK_RELATIVE_PARAM(follyAtofMeasure, n)      \
+  BENCHMARK_RELATIVE_PARAM(follyTryToAtofMeasure, n) \
+  BENCHMARK_DRAW_LINE()
+
+DEFINE_BENCHMARK_GROUP(0);
+DEFINE_BENCHMARK_GROUP(1);
+DEFINE_BENCHMARK_GROUP(2);
+DEFINE_BENCHMARK_GROUP(3);
+DEFINE_BENCHMARK_GROUP(4);
+
+#undef DEFINE_BENCHMARK_GROUP
+
 #define DEFINE_BENCHMARK_GROUP(T, n)            \
   BENCHMARK_PARAM(T##VariadicToBM, n)           \
   BENCHMARK_RELATIVE_PARAM(T##IdenticalToBM, n) \
@@ -1128,6 +1206,68 @@ FLOAT_TO_ARITH_BENCHMARK(int, Int, double2IntGood, double2IntBad)
 #undef INT_TO_ARITH_BENCHMARK
 #undef FLOAT_TO_ARITH_BENCHMARK
 
+// A row of 1000 values of a CSV file or a metrics export, formatted with
+// toAppend one value at a time, or in bulk with appendNumbers.
+namespace {
+
+template <typename T>
+std::vector<T> makeRow() {
+  std::vector<T> row;
+  for (int i = 0; i < 1000; ++i) {
+    row.push_back(T(i * 7919) / (std::is_floating_point_v<T> ? 64 : 1));
+  }
+  return row;
+}
+
+template <typename T>
+void toAppendRow(size_t iters) {
+  std::vector<T> row;
+  std::string out;
+  BENCHMARK_SUSPEND {
+    row = makeRow<T>();
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    out.clear();
+    for (size_t j = 0; j < row.size(); ++j) {
+      if (j != 0) {
+        out.push_back(',');
+      }
+      toAppend(row[j], &out);
+    }
+    doNotOptimizeAway(out.data());
+  }
+}
+
+template <typename T>
+void appendNumbersRow(size_t iters) {
+  std::vector<T> row;
+  std::string out;
+  BENCHMARK_SUSPEND {
+    row = makeRow<T>();
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    out.clear();
+    appendNumbers(out, row, ",");
+    doNotOptimizeAway(out.data());
+  }
+}
+
+} // namespace
+
+BENCHMARK(toAppendRowInt64, iters) {
+  toAppendRow<int64_t>(iters);
+}
+BENCHMARK_RELATIVE(appendNumbersRowInt64, iters) {
+  appendNumbersRow<int64_t>(iters);
+}
+BENCHMARK(toAppendRowDouble, iters) {
+  toAppendRow<double>(iters);
+}
+BENCHMARK_RELATIVE(appendNumbersRowDouble, iters) {
+  appendNumbersRow<double>(iters);
+}
+BENCHMARK_DRAW_LINE();
+
 int main(int argc, char** argv) {
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
   folly::runBenchmarks();
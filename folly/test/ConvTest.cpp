@@ -460,6 +460,46 @@ TEST(Conv, BadStringToIntegral) {
   }
 }
 
+TEST(Conv, StringToIntegralDigitChunks) {
+  // The digits are checked and parsed eight at a time, so try every length,
+  // and a non-digit at every position.
+  const std::string digits = "1234567890123456789";
+  for (size_t len = 1; len <= digits.size(); ++len) {
+    auto str = digits.substr(0, len);
+    auto expected = std::stoull(str);
+    EXPECT_EQ(expected, to<uint64_t>(str));
+    EXPECT_EQ(expected, to<uint64_t>(str.data(), str.data() + str.size()));
+    EXPECT_EQ(expected, to<uint64_t>(std::string(20, '0') + str));
+    for (size_t pos = 0; pos < len; ++pos) {
+      for (char c : {'/', ':', 'a', '\0', '\xb5'}) {
+        auto bad = str;
+        bad[pos] = c;
+        EXPECT_FALSE(tryTo<uint64_t>(bad.data(), bad.data() + bad.size()))
+            << "bad=" << bad;
+        StringPiece sp(bad);
+        auto prefix = tryTo<uint64_t>(&sp);
+        if (pos == 0) {
+          EXPECT_FALSE(prefix) << "bad=" << bad;
+        } else {
+          EXPECT_EQ(std::stoull(str.substr(0, pos)), prefix.value());
+          EXPECT_EQ(len - pos, sp.size());
+        }
+      }
+    }
+  }
+
+  EXPECT_EQ(4294967295u, to<uint32_t>("4294967295"));
+  EXPECT_EQ(4294967295u, to<uint32_t>("000000000004294967295"));
+  EXPECT_THROW(to<uint32_t>("4294967296"), std::range_error);
+  EXPECT_EQ(
+      std::numeric_limits<int64_t>::min(), to<int64_t>("-9223372036854775808"));
+  EXPECT_THROW(to<int64_t>("9223372036854775808"), std::range_error);
+  EXPECT_EQ(
+      std::numeric_limits<uint64_t>::max(),
+      to<uint64_t>("18446744073709551615"));
+  EXPECT_THROW(to<uint64_t>("18446744073709551616"), std::range_error);
+}
+
 template <class String>
 void testIdenticalTo() {
   String s("Yukkuri shiteitte ne!!!");
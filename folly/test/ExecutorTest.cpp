@@ -17,6 +17,7 @@
 #include <folly/Executor.h>
 
 #include <atomic>
+#include <vector>
 
 #include <folly/lang/Keep.h>
 #include <folly/portability/GTest.h>
@@ -239,4 +240,24 @@ TEST(ExecutorTest, CopyExpired) {
   EXPECT_EQ(ptr, ka.get());
 }
 
+TEST(ExecutorTest, AddBatchDefault) {
+  struct Ex : Executor {
+    void add(Func f) override { funcs.push_back(std::move(f)); }
+    std::vector<Func> funcs;
+  };
+
+  Ex ex;
+  std::vector<int> ran;
+  std::vector<Func> batch;
+  for (int i = 0; i < 3; ++i) {
+    batch.push_back([&ran, i] { ran.push_back(i); });
+  }
+  ex.addBatch(batch);
+  ASSERT_EQ(3, ex.funcs.size());
+  for (auto& f : ex.funcs) {
+    f();
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), ran);
+}
+
 } // namespace folly
@@ -21,6 +21,8 @@
 #endif
 
 #include <deque>
+#include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -572,6 +574,38 @@ TEST_F(WriteFileAtomic, WriteWithCustomTempPath) {
   ASSERT_TRUE(success);
   EXPECT_EQ(output, "data_2");
 }
+
+TEST_F(WriteFileAtomic, writeFiles) {
+  writeFileAtomic(tmpPath("bar"), "old bar");
+  auto const foo = tmpPath("foo");
+  auto const bar = tmpPath("bar");
+  std::vector<std::pair<StringPiece, ByteRange>> files{
+      {foo, StringPiece("foo")}, {bar, StringPiece("bar")}};
+  writeFilesAtomic(
+      files,
+      WriteFileAtomicOptions{}
+          .setPermissions(0600)
+          .setSyncType(SyncType::WITH_SYNC));
+  EXPECT_EQ((set<string>{"bar", "foo"}), listTmpDir());
+  EXPECT_EQ("foo", readData(foo));
+  EXPECT_EQ("bar", readData(bar));
+  EXPECT_EQ(0600, getPerms(foo));
+  EXPECT_EQ(0600, getPerms(bar));
+
+  // Nothing is replaced if a file can't be written.
+  auto const missing = tmpPath("missing/baz");
+  files = {{foo, StringPiece("new foo")}, {missing, StringPiece("baz")}};
+  try {
+    writeFilesAtomic(files);
+    ADD_FAILURE();
+  } catch (const std::system_error& e) {
+    EXPECT_EQ(ENOENT, e.code().value());
+    EXPECT_NE(std::string::npos, std::string(e.what()).find(missing));
+  }
+  EXPECT_EQ(ENOENT, writeFilesAtomicNoThrow(files));
+  EXPECT_EQ((set<string>{"bar", "foo"}), listTmpDir());
+  EXPECT_EQ("foo", readData(foo));
+}
 #endif // !_WIN32
 
 } // namespace test
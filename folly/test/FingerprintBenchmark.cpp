@@ -121,6 +121,49 @@ void fastFingerprintTerms128(int num_iterations, int num_ids) {
   fingerprintTerms<Fingerprint<128>>(num_iterations, num_ids);
 }
 
+// Roll a window over the ids, as bytes.
+template <int Bits>
+void rollingFingerprint(int num_iterations, int window) {
+  auto const bytes = reinterpret_cast<const uint8_t*>(ids);
+  RollingFingerprint<Bits> fp(window);
+  for (int iter = 0; iter < num_iterations; iter++) {
+    fp.reset();
+    for (int i = 0; i < window; i++) {
+      fp.update8(bytes[i]);
+    }
+    for (size_t i = window; i < sizeof(ids); i++) {
+      fp.roll(bytes[i - window], bytes[i]);
+    }
+    uint64_t out[Fingerprint<Bits>::size()];
+    fp.write(out);
+    compiler_must_not_elide(out);
+  }
+}
+
+void rollingFingerprint64(int num_iterations, int window) {
+  rollingFingerprint<64>(num_iterations, window);
+}
+
+void rollingFingerprint128(int num_iterations, int window) {
+  rollingFingerprint<128>(num_iterations, window);
+}
+
+// Chunk the ids, as bytes.
+void fastCdc(int num_iterations, int avg_size) {
+  FastCdcChunker::Options options;
+  options.minSize = avg_size / 4;
+  options.avgSize = avg_size;
+  options.maxSize = avg_size * 8;
+  FastCdcChunker chunker(options);
+  auto const bytes =
+      ByteRange(reinterpret_cast<const uint8_t*>(ids), sizeof(ids));
+  for (int iter = 0; iter < num_iterations; iter++) {
+    size_t chunks = 0;
+    chunker.forEachChunk(bytes, [&](ByteRange) { ++chunks; });
+    compiler_must_not_elide(chunks);
+  }
+}
+
 } // namespace
 
 // Only benchmark one size of slowFingerprint; it's significantly slower
@@ -145,6 +188,9 @@ int main(int argc, char** argv) {
   BM(slowFingerprintTerms64, 1, kMaxTerms)
   BM(fastFingerprintTerms96, 1, kMaxTerms)
   BM(fastFingerprintTerms128, 1, kMaxTerms)
+  BM(rollingFingerprint64, 16, 64)
+  BM(rollingFingerprint128, 16, 64)
+  BM(fastCdc, 2048, 16384)
 #undef BM
 
   initialize();
@@ -16,6 +16,10 @@
 
 #include <folly/Fingerprint.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
 #include <glog/logging.h>
 
 #include <folly/Benchmark.h>
@@ -175,6 +179,160 @@ TEST(Fingerprint, Alignment) {
   }
 }
 
+namespace {
+
+std::string randomBytes(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::string bytes(size, '\0');
+  for (auto& c : bytes) {
+    c = char(rng());
+  }
+  return bytes;
+}
+
+template <int BITS>
+void checkRolling(size_t window) {
+  constexpr int kSize = Fingerprint<BITS>::size();
+  auto const data = randomBytes(300, window);
+  RollingFingerprint<BITS> rolling(window);
+  EXPECT_EQ(window, rolling.window());
+  for (size_t i = 0; i < data.size(); i++) {
+    if (i < window) {
+      rolling.update8(uint8_t(data[i]));
+    } else {
+      rolling.roll(uint8_t(data[i - window]), uint8_t(data[i]));
+    }
+    if (i + 1 < window) {
+      continue;
+    }
+    uint64_t expected[kSize];
+    uint64_t actual[kSize];
+    Fingerprint<BITS>()
+        .update(StringPiece(data).subpiece(i + 1 - window, window))
+        .write(expected);
+    rolling.write(actual);
+    for (int j = 0; j < kSize; j++) {
+      EXPECT_EQ(expected[j], actual[j]) << BITS << " " << window << " " << i;
+    }
+  }
+
+  rolling.reset();
+  for (size_t i = 0; i < window; i++) {
+    rolling.update8(uint8_t(data[i]));
+  }
+  uint64_t expected[kSize];
+  uint64_t actual[kSize];
+  Fingerprint<BITS>().update(StringPiece(data).subpiece(0, window)).write(
+      expected);
+  rolling.write(actual);
+  for (int j = 0; j < kSize; j++) {
+    EXPECT_EQ(expected[j], actual[j]);
+  }
+}
+
+template <int BITS>
+void checkCombine() {
+  constexpr int kSize = Fingerprint<BITS>::size();
+  auto const data = randomBytes(5000, BITS);
+  uint64_t expected[kSize];
+  Fingerprint<BITS>().update(data).write(expected);
+  for (size_t split : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(9),
+                       size_t(100), size_t(4093), size_t(5000)}) {
+    auto const prefix = StringPiece(data).subpiece(0, split);
+    auto const suffix = StringPiece(data).subpiece(split);
+    uint64_t actual[kSize];
+    Fingerprint<BITS>()
+        .update(prefix)
+        .combine(Fingerprint<BITS>().update(suffix), suffix.size())
+        .write(actual);
+    for (int j = 0; j < kSize; j++) {
+      EXPECT_EQ(expected[j], actual[j]) << BITS << " " << split;
+    }
+  }
+}
+
+} // namespace
+
+TEST(Fingerprint, Rolling) {
+  for (size_t window : {1, 2, 8, 16, 31, 48, 64, 65}) {
+    checkRolling<64>(window);
+    checkRolling<96>(window);
+    checkRolling<128>(window);
+  }
+}
+
+TEST(Fingerprint, Combine) {
+  checkCombine<64>();
+  checkCombine<96>();
+  checkCombine<128>();
+}
+
+TEST(FastCdcChunker, Sizes) {
+  FastCdcChunker::Options options;
+  options.minSize = 512;
+  options.avgSize = 2048;
+  options.maxSize = 8192;
+  FastCdcChunker chunker(options);
+  auto const data = randomBytes(1 << 20, 1);
+  std::string joined;
+  size_t chunks = 0;
+  size_t smallest = data.size();
+  chunker.forEachChunk(ByteRange(StringPiece(data)), [&](ByteRange chunk) {
+    joined.append(StringPiece(chunk).str());
+    if (joined.size() < data.size()) {
+      smallest = std::min(smallest, chunk.size());
+    }
+    EXPECT_LE(chunk.size(), options.maxSize);
+    ++chunks;
+  });
+  EXPECT_EQ(data, joined);
+  EXPECT_GT(smallest, options.minSize);
+  // Normalized chunking keeps the average close to avgSize.
+  auto const average = data.size() / chunks;
+  EXPECT_GT(average, options.avgSize / 2);
+  EXPECT_LT(average, options.avgSize * 2);
+
+  EXPECT_EQ(0, chunker.cut(ByteRange()));
+  EXPECT_EQ(100, chunker.cut(ByteRange(StringPiece(data).subpiece(0, 100))));
+}
+
+TEST(FastCdcChunker, ContentDefined) {
+  // Inserting bytes near the start only changes the chunks around them.
+  FastCdcChunker chunker;
+  auto const data = randomBytes(1 << 20, 2);
+  auto const edited = data.substr(0, 1000) + "inserted" + data.substr(1000);
+  auto const chunksOf = [&](const std::string& input) {
+    std::vector<std::string> chunks;
+    chunker.forEachChunk(ByteRange(StringPiece(input)), [&](ByteRange chunk) {
+      chunks.push_back(StringPiece(chunk).str());
+    });
+    return chunks;
+  };
+  auto const before = chunksOf(data);
+  auto const after = chunksOf(edited);
+  ASSERT_GT(before.size(), 10);
+  size_t same = 0;
+  for (size_t i = 1; i <= std::min(before.size(), after.size()); i++) {
+    if (before[before.size() - i] != after[after.size() - i]) {
+      break;
+    }
+    ++same;
+  }
+  EXPECT_GE(same, before.size() - 2);
+}
+
+TEST(FastCdcChunker, InvalidOptions) {
+  FastCdcChunker::Options options;
+  options.minSize = 0;
+  EXPECT_THROW(FastCdcChunker{options}, std::invalid_argument);
+  options.minSize = 4096;
+  options.avgSize = 1024;
+  EXPECT_THROW(FastCdcChunker{options}, std::invalid_argument);
+  options.avgSize = 8192;
+  options.maxSize = 4096;
+  EXPECT_THROW(FastCdcChunker{options}, std::invalid_argument);
+}
+
 int main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
   folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
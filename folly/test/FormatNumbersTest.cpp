@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/FormatNumbers.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <folly/container/span.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// The reference output: each value converted with folly::to, and joined.
+template <typename T>
+std::string expected(std::vector<T> const& values, StringPiece delim) {
+  std::vector<std::string> strings;
+  for (auto value : values) {
+    strings.push_back(to<std::string>(value));
+  }
+  return join(delim, strings);
+}
+
+template <typename T>
+std::string format(std::vector<T> const& values, StringPiece delim) {
+  std::vector<char> buf(formatNumbersSizeMax<T>(values.size(), delim.size()));
+  char* end = formatNumbers(buf.data(), buf.data() + buf.size(), values, delim);
+  return std::string(buf.data(), end);
+}
+
+template <typename T>
+std::vector<T> integers() {
+  using limits = std::numeric_limits<T>;
+  std::vector<T> values{0, 1, 9, 10, 99, 100, limits::max(), limits::min()};
+  for (T v = 1; v <= limits::max() / 10; v *= 10) {
+    values.push_back(v * 10 - 1);
+    values.push_back(v * 10);
+    if constexpr (std::is_signed_v<T>) {
+      values.push_back(-v);
+    }
+  }
+  return values;
+}
+
+} // namespace
+
+TEST(FormatNumbers, Empty) {
+  EXPECT_EQ(0, formatNumbersSizeMax<int>(0, 1));
+  EXPECT_EQ("", format(std::vector<int>{}, ","));
+  std::string out = "x";
+  appendNumbers(out, std::vector<double>{}, ",");
+  EXPECT_EQ("x", out);
+}
+
+TEST(FormatNumbers, Integers) {
+  EXPECT_EQ(expected(integers<int8_t>(), ","), format(integers<int8_t>(), ","));
+  EXPECT_EQ(
+      expected(integers<uint16_t>(), ","), format(integers<uint16_t>(), ","));
+  EXPECT_EQ(
+      expected(integers<int32_t>(), ", "), format(integers<int32_t>(), ", "));
+  EXPECT_EQ(
+      expected(integers<uint32_t>(), "\t"), format(integers<uint32_t>(), "\t"));
+  EXPECT_EQ(expected(integers<int64_t>(), ""), format(integers<int64_t>(), ""));
+  EXPECT_EQ(
+      expected(integers<uint64_t>(), ","), format(integers<uint64_t>(), ","));
+  EXPECT_EQ(
+      "-9223372036854775808", format(std::vector<int64_t>{INT64_MIN}, ","));
+  EXPECT_EQ("1;-2;3", format(std::vector<int>{1, -2, 3}, ";"));
+}
+
+TEST(FormatNumbers, FloatingPoint) {
+  std::vector<double> values{
+      0.0,
+      -0.0,
+      1.0,
+      0.1,
+      -2.5,
+      1.0 / 3,
+      123456.123456,
+      6.02214076e23,
+      1e21,
+      1e20,
+      1e-6,
+      1e-7,
+      -0.0000012345678901234567,
+      std::numeric_limits<double>::max(),
+      -std::numeric_limits<double>::min(),
+      std::numeric_limits<double>::denorm_min(),
+      std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::quiet_NaN(),
+  };
+  EXPECT_EQ(expected(values, ","), format(values, ","));
+  for (auto value : values) {
+    auto const str = format(std::vector<double>{value}, ",");
+    EXPECT_LE(str.size(), formatNumbersSizeMax<double>(1, 0));
+    if (!std::isnan(value)) {
+      EXPECT_EQ(value, to<double>(str));
+    }
+  }
+
+  std::vector<float> floats{0.0f, 1.5f, -0.1f, 3.4e38f};
+  EXPECT_EQ(expected(floats, ","), format(floats, ","));
+}
+
+TEST(FormatNumbers, Containers) {
+  std::array<uint32_t, 3> array{{1, 22, 333}};
+  std::vector<char> buf(formatNumbersSizeMax<uint32_t>(array.size(), 1));
+  char* end = formatNumbers(buf.data(), buf.data() + buf.size(), array, "|");
+  EXPECT_EQ("1|22|333", std::string(buf.data(), end));
+
+  double const values[] = {1.5, 2.25};
+  buf.resize(formatNumbersSizeMax<double>(2, 1));
+  end = formatNumbers(
+      buf.data(), buf.data() + buf.size(), span<double const>(values), "|");
+  EXPECT_EQ("1.5|2.25", std::string(buf.data(), end));
+}
+
+TEST(FormatNumbers, AppendString) {
+  std::string out = "values: ";
+  appendNumbers(out, std::vector<int64_t>{-1, 0, 1}, ",");
+  appendNumbers(out, std::vector<double>{0.5}, ",");
+  EXPECT_EQ("values: -1,0,10.5", out);
+}
+
+TEST(FormatNumbers, AppendAppender) {
+  auto values = integers<int64_t>();
+  auto const want = expected(values, ",");
+
+  // With small buffers, the output spans many of them.
+  auto buf = IOBuf::create(0);
+  io::Appender appender(buf.get(), 32);
+  appendNumbers(appender, values, ",");
+  EXPECT_GT(buf->countChainElements(), 1);
+  EXPECT_EQ(want, buf->to<std::string>());
+
+  IOBufQueue queue;
+  io::QueueAppender queueAppender(&queue, 64);
+  appendNumbers(queueAppender, values, ",");
+  EXPECT_EQ(want, queue.move()->to<std::string>());
+}
@@ -19,6 +19,7 @@
 #include <array>
 #include <cstdarg>
 #include <functional>
+#include <memory>
 
 #include <folly/Memory.h>
 #include <folly/lang/Keep.h>
@@ -1486,6 +1487,73 @@ TEST(Function, TrivialSmallBig) {
   EXPECT_EQ(7, h2());
 }
 
+TEST(Function, BasicFunctionInlineSize) {
+  using Large = folly::BasicFunction<int(), 16 * sizeof(void*)>;
+  static_assert(std::is_same_v<
+                Function<int()>,
+                Function<int(), folly::kFunctionInlineSize>>);
+  static_assert(sizeof(Large) > sizeof(Function<int()>));
+
+  auto tl = [x = std::array<int, 20>{{7}}] { return x[0]; };
+  static_assert(sizeof(tl) > sizeof(Function<int()>));
+  static_assert(sizeof(tl) <= 16 * sizeof(void*));
+  auto shared = std::make_shared<int>(7);
+  auto sl = [x = std::array<int, 20>{}, shared] { return x[0] + *shared; };
+  static_assert(!std::is_trivially_copyable_v<decltype(sl)>);
+
+  EXPECT_GT(Function<int()>(tl).heapAllocatedMemory(), 0);
+  EXPECT_GT(Function<int()>(sl).heapAllocatedMemory(), 0);
+  static_assert(noexcept(Large(tl)));
+
+  Large t{tl};
+  Large s{std::move(sl)};
+  EXPECT_EQ(0, t.heapAllocatedMemory());
+  EXPECT_EQ(0, s.heapAllocatedMemory());
+  EXPECT_EQ(7, t());
+  EXPECT_EQ(7, s());
+
+  auto t2 = std::move(t);
+  auto s2 = std::move(s);
+  EXPECT_FALSE(t);
+  EXPECT_FALSE(s);
+  EXPECT_EQ(7, t2());
+  EXPECT_EQ(7, s2());
+  s2 = nullptr;
+  EXPECT_EQ(1, shared.use_count());
+}
+
+TEST(Function, BasicFunctionConversion) {
+  using Large = folly::BasicFunction<int(), 16 * sizeof(void*)>;
+  auto shared = std::make_shared<int>(7);
+
+  // Widening moves the callable as is, wherever it is stored.
+  Function<int()> small{[shared] { return *shared; }};
+  EXPECT_EQ(0, small.heapAllocatedMemory());
+  static_assert(noexcept(Large(std::move(small))));
+  Large fromSmall{std::move(small)};
+  EXPECT_FALSE(small);
+  EXPECT_EQ(0, fromSmall.heapAllocatedMemory());
+  EXPECT_EQ(7, fromSmall());
+
+  auto big = [x = std::array<char, 256>{}, shared] { return x[0] + *shared; };
+  Function<int()> heap{std::move(big)};
+  auto const bytes = heap.heapAllocatedMemory();
+  EXPECT_GT(bytes, 0);
+  Large fromHeap{std::move(heap)};
+  EXPECT_EQ(bytes, fromHeap.heapAllocatedMemory());
+  EXPECT_EQ(7, fromHeap());
+
+  // Narrowing has to put the larger function on the heap.
+  Function<int()> narrowed{std::move(fromSmall)};
+  EXPECT_FALSE(fromSmall);
+  EXPECT_GT(narrowed.heapAllocatedMemory(), 0);
+  EXPECT_EQ(7, narrowed());
+
+  fromHeap = nullptr;
+  narrowed = nullptr;
+  EXPECT_EQ(1, shared.use_count());
+}
+
 TEST(Function, ConstInitEmpty) {
   static FOLLY_CONSTINIT Function<int()> func;
   EXPECT_THROW(func(), std::bad_function_call);
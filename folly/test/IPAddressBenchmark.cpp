@@ -16,11 +16,15 @@
 
 #include <folly/IPAddress.h>
 
+#include <random>
+#include <vector>
+
 #include <fmt/core.h>
 #include <glog/logging.h>
 
 #include <folly/Benchmark.h>
 #include <folly/Conv.h>
+#include <folly/IPPrefixTable.h>
 
 using namespace folly;
 using std::string;
@@ -46,6 +50,15 @@ BENCHMARK_RELATIVE(ipv4_to_fully_qualified, iters) {
   }
 }
 
+BENCHMARK_RELATIVE(ipv4_to_buffer, iters) {
+  IPAddressV4 ip("127.0.0.1");
+  char outputString[IPAddressV4::kMaxStrSize];
+  while (iters--) {
+    size_t len = ip.toBuffer(outputString);
+    folly::doNotOptimizeAway(len);
+  }
+}
+
 BENCHMARK_DRAW_LINE();
 
 BENCHMARK(ipv4_to_fully_qualified_port, iters) {
@@ -95,6 +108,38 @@ BENCHMARK_RELATIVE(ipv6_to_fully_qualified, iters) {
 
 BENCHMARK_DRAW_LINE();
 
+BENCHMARK(ipv6_compressed_to_string_inet_ntop, iters) {
+  IPAddressV6 ipv6Addr("2803:6082:18e0::9ee0:0:9800");
+  in6_addr ip = ipv6Addr.toAddr();
+  char outputString[INET6_ADDRSTRLEN] = {0};
+
+  while (iters--) {
+    const char* val =
+        inet_ntop(AF_INET6, &ip, outputString, sizeof(outputString));
+    folly::doNotOptimizeAway(val);
+  }
+}
+
+BENCHMARK_RELATIVE(ipv6_compressed_str, iters) {
+  IPAddressV6 ip("2803:6082:18e0::9ee0:0:9800");
+  while (iters--) {
+    string outputString = ip.str();
+    folly::doNotOptimizeAway(outputString);
+    folly::doNotOptimizeAway(outputString.data());
+  }
+}
+
+BENCHMARK_RELATIVE(ipv6_compressed_to_buffer, iters) {
+  IPAddressV6 ip("2803:6082:18e0::9ee0:0:9800");
+  char outputString[IPAddressV6::kMaxStrSize];
+  while (iters--) {
+    size_t len = ip.toBuffer(outputString);
+    folly::doNotOptimizeAway(len);
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK(ipv6_to_fully_qualified_port, iters) {
   IPAddressV6 ip("F1E0:0ACE:FB94:7ADF:22E8:6DE6:9672:3725");
   while (iters--) {
@@ -143,7 +188,36 @@ BENCHMARK_RELATIVE(ipv6_ctor_invalid, iters) {
 
 BENCHMARK_DRAW_LINE();
 
-BENCHMARK(ipv6_try_from_string_valid, iters) {
+BENCHMARK(ipv4_inet_pton, iters) {
+  while (iters--) {
+    in_addr ip;
+    int ret = inet_pton(AF_INET, string("192.168.100.200").c_str(), &ip);
+    CHECK_EQ(1, ret);
+  }
+}
+
+BENCHMARK_RELATIVE(ipv4_try_from_string, iters) {
+  while (iters--) {
+    auto maybeIp = IPAddressV4::tryFromString("192.168.100.200");
+    CHECK(maybeIp.hasValue());
+    doNotOptimizeAway(maybeIp.value().toLong());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ipv6_inet_pton, iters) {
+  while (iters--) {
+    in6_addr ip;
+    int ret = inet_pton(
+        AF_INET6,
+        string("2803:6082:18e0:2c49:1a23:9ee0:5c87:9800").c_str(),
+        &ip);
+    CHECK_EQ(1, ret);
+  }
+}
+
+BENCHMARK_RELATIVE(ipv6_try_from_string_valid, iters) {
   while (iters--) {
     auto maybeIp =
         IPAddressV6::tryFromString("2803:6082:18e0:2c49:1a23:9ee0:5c87:9800");
@@ -163,6 +237,55 @@ BENCHMARK_RELATIVE(ipv6_try_from_string_invalid, iters) {
   }
 }
 
+BENCHMARK_DRAW_LINE();
+
+namespace {
+
+// 100K random IPv4 networks from /8 to /32, and addresses in them or not.
+struct PrefixTableData {
+  IPPrefixTable<uint32_t> table;
+  std::vector<IPAddressV4> addrs;
+};
+
+const PrefixTableData& prefixTableData() {
+  static const auto data = [] {
+    PrefixTableData d;
+    std::mt19937 rng(42);
+    for (uint32_t i = 0; i < 100000; ++i) {
+      auto addr = IPAddressV4::fromLongHBO(rng());
+      d.table.insert(addr, uint8_t(8 + rng() % 25), i);
+      d.addrs.push_back(i % 2 ? addr : IPAddressV4::fromLongHBO(rng()));
+    }
+    std::shuffle(d.addrs.begin(), d.addrs.end(), rng);
+    return d;
+  }();
+  return data;
+}
+
+} // namespace
+
+BENCHMARK(ipv4_prefix_table_lookup, iters) {
+  BenchmarkSuspender suspender;
+  const auto& data = prefixTableData();
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    doNotOptimizeAway(data.table.lookup(data.addrs[i % data.addrs.size()]));
+  }
+}
+
+BENCHMARK_RELATIVE(ipv4_prefix_table_lookup_batch, iters) {
+  BenchmarkSuspender suspender;
+  const auto& data = prefixTableData();
+  suspender.dismiss();
+  const uint32_t* out[64];
+  for (size_t i = 0; i < iters; i += 64) {
+    auto begin = i % data.addrs.size();
+    auto n = std::min<size_t>(64, data.addrs.size() - begin);
+    data.table.lookup(range(data.addrs).subpiece(begin, n), out);
+    doNotOptimizeAway(out);
+  }
+}
+
 // Benchmark results on Intel Xeon CPU E5-2660 @ 2.20GHz
 // ============================================================================
 // folly/test/IPAddressBenchmark.cpp               relative  time/iter  iters/s
@@ -15,9 +15,11 @@
  */
 
 #include <ifaddrs.h>
+#include <net/if.h>
 #include <sys/types.h>
 #include <folly/IPAddress.h>
 
+#include <random>
 #include <string>
 
 #include <fmt/core.h>
@@ -1264,6 +1266,99 @@ TEST(IPAddress, StringFormat) {
   EXPECT_EQ("1.2.3.4", detail::fastIpv4ToString(a4));
 }
 
+TEST(IPAddress, StringFormatCompressed) {
+  std::mt19937 rng(42);
+  for (int i = 0; i < 100000; ++i) {
+    // Favor zero groups, and IPv4-mapped and IPv4-compatible addresses.
+    ByteArray16 bytes;
+    for (auto& b : bytes) {
+      b = rng() % 3 ? uint8_t(rng()) : 0;
+    }
+    if (rng() % 4 == 0) {
+      std::fill_n(bytes.begin(), 10, 0);
+      bytes[10] = bytes[11] = rng() % 2 ? 0xff : 0;
+    }
+    char expected[INET6_ADDRSTRLEN];
+    ASSERT_NE(
+        nullptr,
+        inet_ntop(AF_INET6, bytes.data(), expected, INET6_ADDRSTRLEN));
+    IPAddressV6 addr(bytes);
+    EXPECT_EQ(expected, addr.str());
+    EXPECT_EQ(addr, IPAddressV6(addr.str()));
+  }
+}
+
+TEST(IPAddress, TryFromStringMatchesInetPton) {
+  auto check = [](const std::string& str) {
+    in_addr a4;
+    auto v4 = IPAddressV4::tryFromString(str);
+    if (inet_pton(AF_INET, str.c_str(), &a4) == 1) {
+      ASSERT_TRUE(v4.hasValue()) << str;
+      EXPECT_EQ(a4.s_addr, v4->toLong()) << str;
+    } else {
+      EXPECT_TRUE(v4.hasError()) << str;
+    }
+    in6_addr a6;
+    auto v6 = IPAddressV6::tryFromString(str);
+    if (inet_pton(AF_INET6, str.c_str(), &a6) == 1) {
+      ASSERT_TRUE(v6.hasValue()) << str;
+      EXPECT_EQ(0, std::memcmp(a6.s6_addr, v6->bytes(), 16)) << str;
+    } else {
+      EXPECT_TRUE(v6.hasError()) << str;
+    }
+  };
+  for (auto str :
+       {"1.2.3.4", "0.0.0.0", "255.255.255.255", "256.1.1.1", "01.2.3.4",
+        "1.2.3", "1.2.3.4.", ".1.2.3.4", "1.2.3.4 ", "1..2.3", "1.2.3.-4", "::",
+        ":::", "::1", "1::", ":1::", "1::2::3", "1:2:3:4:5:6:7:8",
+        "1:2:3:4:5:6:7::8", "1:2:3:4:5:6:7:8:9", "12345::", "::ffff:1.2.3.4",
+        "::1.2.3.4", "1:2:3:4:5:6:1.2.3.4", "1:2:3:4:5:6:7:1.2.3.4",
+        "::1.2.3.4:5", "::01.2.3.4", "g::", "ABCD::EF", "1:2:3:4:5:6:7:",
+        ":1:2:3:4:5:6:7"}) {
+    check(str);
+  }
+
+  // Mutations of random addresses.
+  std::mt19937 rng(42);
+  const std::string alphabet = "0123456789abcdefABCDEFgx:.";
+  for (int i = 0; i < 100000; ++i) {
+    ByteArray16 bytes;
+    for (auto& b : bytes) {
+      b = rng() % 3 ? uint8_t(rng()) : 0;
+    }
+    auto str = rng() % 2 ? IPAddressV6(bytes).str()
+                         : IPAddressV4::fromLong(uint32_t(rng())).str();
+    for (size_t n = rng() % 3; n > 0; --n) {
+      auto const pos = rng() % (str.size() + 1);
+      auto const c = alphabet[rng() % alphabet.size()];
+      if (rng() % 2 || pos == str.size()) {
+        str.insert(str.begin() + pos, c);
+      } else {
+        str[pos] = c;
+      }
+    }
+    check(str);
+  }
+}
+
+TEST(IPAddress, ToBuffer) {
+  auto check = [](const auto& addr) {
+    char buffer[std::decay_t<decltype(addr)>::kMaxStrSize];
+    EXPECT_EQ(addr.str(), std::string(buffer, addr.toBuffer(buffer)));
+  };
+  check(IPAddressV4("255.255.255.255"));
+  check(IPAddressV4("1.0.10.100"));
+  check(IPAddressV6("1:0:0:2::3"));
+  check(IPAddressV6("::ffff:255.255.255.255"));
+  check(IPAddressV6("fe80::62eb:69ff:fe9b:ba60%65535"));
+  check(IPAddress("1.2.3.4"));
+  check(IPAddress("1:2::3"));
+  check(IPAddress());
+  EXPECT_EQ(
+      strlen("0000:0000:0000:0000:0000:ffff:255.255.255.255%") + IFNAMSIZ - 1,
+      IPAddressV6::kMaxStrSize);
+}
+
 TEST(IPAddress, getMacAddressFromLinkLocal) {
   IPAddressV6 ip6("fe80::f652:14ff:fec5:74d8");
   EXPECT_TRUE(ip6.getMacAddressFromLinkLocal().has_value());
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/IPPrefixTable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// Longest prefix match by scanning all the networks.
+template <typename Addr>
+const int* lookupLinear(
+    const std::vector<std::pair<CIDRNetwork, int>>& networks,
+    const Addr& addr) {
+  const int* best = nullptr;
+  int bestLen = -1;
+  for (const auto& [network, value] : networks) {
+    if (network.first.version() == addr.version() &&
+        IPAddress(addr).inSubnet(network.first, network.second) &&
+        network.second > bestLen) {
+      best = &value;
+      bestLen = network.second;
+    }
+  }
+  return best;
+}
+
+template <typename Addr>
+Addr randomAddress(std::mt19937& rng, const std::vector<Addr>& near) {
+  decltype(std::declval<Addr>().toByteArray()) bytes;
+  for (auto& b : bytes) {
+    b = uint8_t(rng());
+  }
+  if (!near.empty() && rng() % 2) {
+    // Share a random prefix with an address, so that lookups go deep.
+    auto const& other = near[rng() % near.size()].toByteArray();
+    std::copy_n(other.begin(), rng() % bytes.size(), bytes.begin());
+  }
+  return Addr(bytes);
+}
+
+template <typename Addr>
+void checkRandom(size_t count) {
+  std::mt19937 rng(42);
+  IPPrefixTable<int> table;
+  std::vector<std::pair<CIDRNetwork, int>> networks;
+  std::vector<Addr> addrs;
+  auto const bits = Addr::bitCount();
+  for (size_t i = 0; i < count; ++i) {
+    auto addr = randomAddress(rng, addrs);
+    // Favor the lengths around the level boundaries.
+    uint8_t len = rng() % 4 ? 8 + rng() % (bits - 7) : rng() % (bits + 1);
+    auto network = std::make_pair(IPAddress(addr.mask(len)), len);
+    if (table.insert(network, int(i))) {
+      networks.emplace_back(network, int(i));
+    } else {
+      for (auto& [n, value] : networks) {
+        if (n == network) {
+          value = int(i);
+        }
+      }
+    }
+    addrs.push_back(addr);
+  }
+  EXPECT_EQ(networks.size(), table.size());
+
+  auto check = [&] {
+    std::vector<Addr> queries;
+    for (size_t i = 0; i < 1000; ++i) {
+      queries.push_back(randomAddress(rng, addrs));
+    }
+    std::vector<const int*> batch(queries.size());
+    table.lookup(range(queries), batch.data());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      auto expected = lookupLinear(networks, queries[i]);
+      auto actual = table.lookup(queries[i]);
+      ASSERT_EQ(expected == nullptr, actual == nullptr) << queries[i];
+      if (expected) {
+        EXPECT_EQ(*expected, *actual) << queries[i];
+      }
+      EXPECT_EQ(actual, batch[i]);
+      EXPECT_EQ(actual, table.lookup(IPAddress(queries[i])));
+    }
+  };
+  check();
+
+  for (size_t i = 0; i < networks.size() / 4; ++i) {
+    auto const j = rng() % networks.size();
+    EXPECT_TRUE(table.erase(networks[j].first));
+    EXPECT_FALSE(table.erase(networks[j].first));
+    networks.erase(networks.begin() + j);
+  }
+  EXPECT_EQ(networks.size(), table.size());
+  check();
+}
+
+} // namespace
+
+TEST(IPPrefixTable, Basic) {
+  IPPrefixTable<std::string> table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.lookup(IPAddressV4("10.1.2.3")));
+
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("10.0.0.0/8"), "a"));
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("10.1.0.0/16"), "b"));
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("10.1.2.0/24"), "c"));
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("10.1.2.3/32"), "d"));
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("2001:db8::/32"), "e"));
+  // Host bits are ignored.
+  EXPECT_FALSE(table.insert(IPAddressV4("10.1.255.255"), 16, "f"));
+  EXPECT_EQ(5, table.size());
+
+  EXPECT_EQ("d", *table.lookup(IPAddressV4("10.1.2.3")));
+  EXPECT_EQ("c", *table.lookup(IPAddressV4("10.1.2.4")));
+  EXPECT_EQ("f", *table.lookup(IPAddressV4("10.1.3.4")));
+  EXPECT_EQ("a", *table.lookup(IPAddressV4("10.2.3.4")));
+  EXPECT_EQ(nullptr, table.lookup(IPAddressV4("11.1.2.3")));
+  EXPECT_EQ("e", *table.lookup(IPAddress("2001:db8::1")));
+  EXPECT_EQ(nullptr, table.lookup(IPAddress("2001:db9::1")));
+  // IPv4-mapped addresses are IPv6 addresses.
+  EXPECT_EQ(nullptr, table.lookup(IPAddress("::ffff:10.1.2.3")));
+  EXPECT_EQ(nullptr, table.lookup(IPAddress()));
+
+  // A shorter network doesn't override the longer ones it covers.
+  EXPECT_TRUE(table.insert(IPAddress::createNetwork("0.0.0.0/0"), "g"));
+  EXPECT_EQ("c", *table.lookup(IPAddressV4("10.1.2.4")));
+  EXPECT_EQ("g", *table.lookup(IPAddressV4("11.1.2.3")));
+
+  EXPECT_TRUE(table.erase(IPAddress::createNetwork("10.1.2.0/24")));
+  EXPECT_FALSE(table.erase(IPAddress::createNetwork("10.1.2.0/24")));
+  EXPECT_EQ("f", *table.lookup(IPAddressV4("10.1.2.4")));
+  EXPECT_EQ("d", *table.lookup(IPAddressV4("10.1.2.3")));
+  EXPECT_EQ("e", *table.lookup(IPAddress("2001:db8::1")));
+
+  EXPECT_THROW(
+      table.insert(IPAddressV4("10.0.0.0"), 33, "h"), IPAddressFormatException);
+  EXPECT_THROW(
+      table.insert(CIDRNetwork(IPAddress(), 0), "h"),
+      InvalidAddressFamilyException);
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, table.lookup(IPAddressV4("10.1.2.3")));
+}
+
+TEST(IPPrefixTable, RandomV4) {
+  checkRandom<IPAddressV4>(2000);
+}
+
+TEST(IPPrefixTable, RandomV6) {
+  checkRandom<IPAddressV6>(500);
+}
+
+TEST(ConcurrentIPPrefixTable, Update) {
+  ConcurrentIPPrefixTable<int> table;
+  EXPECT_EQ(std::nullopt, table.lookup(IPAddressV4("10.1.2.3")));
+
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    // A lookup sees either table, never a mix of them.
+    while (!done.load()) {
+      table.withTable([](const IPPrefixTable<int>& t) {
+        auto a = t.lookup(IPAddressV4("10.1.2.3"));
+        auto b = t.lookup(IPAddressV4("10.2.3.4"));
+        EXPECT_EQ(a == nullptr, b == nullptr);
+        if (a && b) {
+          EXPECT_EQ(*a + 1, *b);
+        }
+      });
+    }
+  });
+  for (int i = 0; i < 1000; i += 2) {
+    table.update([&](IPPrefixTable<int>& t) {
+      t.insert(IPAddressV4("10.1.0.0"), 16, i);
+      t.insert(IPAddressV4("10.0.0.0"), 8, i + 1);
+    });
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(998, table.lookup(IPAddressV4("10.1.2.3")));
+
+  IPPrefixTable<int> next;
+  next.insert(IPAddressV6("::"), 0, 7);
+  table.set(std::move(next));
+  EXPECT_EQ(std::nullopt, table.lookup(IPAddressV4("10.1.2.3")));
+  EXPECT_EQ(7, table.lookup(IPAddress("::1")));
+}
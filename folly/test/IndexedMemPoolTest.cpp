@@ -16,8 +16,10 @@
 
 #include <folly/IndexedMemPool.h>
 
+#include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
@@ -156,6 +158,63 @@ TEST(IndexedMemPool, locateElem) {
   EXPECT_EQ(pool.locateElem(nullptr), 0);
 }
 
+TEST(IndexedMemPool, growth) {
+  // Large enough to span many segments, of which the pool only maps the
+  // ones that are actually used.
+  IndexedMemPool<std::string> pool;
+  EXPECT_GT(pool.capacity(), uint32_t(1) << 31);
+
+  std::vector<uint32_t> indices;
+  for (auto i = 0; i < 100000; ++i) {
+    auto idx = pool.allocIndex();
+    ASSERT_NE(idx, 0);
+    pool[idx] = std::to_string(i);
+    indices.push_back(idx);
+  }
+  EXPECT_EQ(
+      std::set<uint32_t>(indices.begin(), indices.end()).size(),
+      indices.size());
+  for (auto i = 0; i < 100000; ++i) {
+    auto idx = indices[i];
+    EXPECT_EQ(pool[idx], std::to_string(i));
+    EXPECT_EQ(pool.locateElem(&pool[idx]), idx);
+  }
+
+  for (auto idx : indices) {
+    pool.recycleIndex(idx);
+  }
+  for (auto i = 0; i < 100000; ++i) {
+    EXPECT_NE(pool.allocIndex(), 0);
+  }
+  EXPECT_EQ(pool.maxAllocatedIndex(), 100000);
+}
+
+TEST(IndexedMemPool, mtGrowth) {
+  IndexedMemPool<int> pool;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<uint32_t>> indices(8);
+  for (auto t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      for (auto i = 0; i < 10000; ++i) {
+        auto idx = pool.allocIndex();
+        pool[idx] = t;
+        indices[t].push_back(idx);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::set<uint32_t> all;
+  for (auto t = 0; t < 8; ++t) {
+    for (auto idx : indices[t]) {
+      EXPECT_EQ(pool[idx], t);
+      all.insert(idx);
+    }
+  }
+  EXPECT_EQ(all.size(), 80000);
+}
+
 struct NonTrivialStruct {
   static thread_local size_t count;
 
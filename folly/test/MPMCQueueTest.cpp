@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <thread>
 #include <utility>
@@ -239,6 +240,92 @@ TEST(MPMCQueue, enqCapacityTest) {
   }
 }
 
+TEST(MPMCQueue, singleThreadBatch) {
+  // Non-dynamic version only, see singleThreadEnqdeq.
+  MPMCQueue<int> cq(10);
+  vector<int> src(15);
+  std::iota(src.begin(), src.end(), 0);
+  vector<int> dest(15, -1);
+
+  for (int pass = 0; pass < 10; ++pass) {
+    EXPECT_EQ(0, cq.writeBatch(src.begin(), src.begin()));
+    EXPECT_EQ(4, cq.writeBatch(src.begin(), src.begin() + 4));
+    EXPECT_EQ(6, cq.writeBatch(src.begin() + 4, src.end()));
+    EXPECT_EQ(0, cq.writeBatch(src.begin() + 10, src.end()));
+    EXPECT_EQ(cq.size(), 10);
+
+    EXPECT_EQ(3, cq.readBatch(dest.data(), 3));
+    cq.blockingReadBatch(dest.data() + 3, 2);
+    EXPECT_EQ(5, cq.readBatch(dest.data() + 5, 10));
+    EXPECT_EQ(0, cq.readBatch(dest.data() + 10, 5));
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ(dest[i], i);
+    }
+    EXPECT_EQ(dest[10], -1);
+
+    cq.blockingWriteBatch(src.begin(), src.begin() + 10);
+    EXPECT_EQ(cq.size(), 10);
+    cq.blockingReadBatch(dest.data(), 10);
+    EXPECT_TRUE(cq.isEmpty());
+  }
+}
+
+template <bool Dynamic = false>
+void runBatchTest() {
+  // Batches larger than the capacity block for the rest of the batch, and
+  // elements of concurrent batches may interleave but stay in order.
+  MPMCQueue<int, std::atomic, Dynamic> cq(16);
+  constexpr int kProducers = 4;
+  constexpr int kBatches = 1000;
+  constexpr int kBatchSize = 24;
+  vector<std::thread> producers;
+  for (int t = 0; t < kProducers; ++t) {
+    producers.emplace_back([&, t] {
+      vector<int> batch(kBatchSize);
+      for (int b = 0; b < kBatches; ++b) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          batch[i] = t * kBatches * kBatchSize + b * kBatchSize + i;
+        }
+        if (b % 2 == 0) {
+          cq.blockingWriteBatch(batch.begin(), batch.end());
+        } else {
+          auto it = batch.begin();
+          while (it != batch.end()) {
+            it += cq.writeBatch(it, batch.end());
+          }
+        }
+      }
+    });
+  }
+
+  vector<int> last(kProducers, -1);
+  vector<int> elems(kBatchSize);
+  int total = kProducers * kBatches * kBatchSize;
+  for (int received = 0; received < total;) {
+    size_t n = received % 2 == 0
+        ? cq.readBatch(elems.data(), kBatchSize)
+        : (cq.blockingReadBatch(elems.data(), 1), 1);
+    for (size_t i = 0; i < n; ++i) {
+      auto t = elems[i] / (kBatches * kBatchSize);
+      EXPECT_LT(last[t], elems[i]);
+      last[t] = elems[i];
+    }
+    received += n;
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  EXPECT_TRUE(cq.isEmpty());
+}
+
+TEST(MPMCQueue, mtBatch) {
+  runBatchTest();
+}
+
+TEST(MPMCQueue, mtBatchDynamic) {
+  runBatchTest</* Dynamic = */ true>();
+}
+
 template <template <typename> class Atom, bool Dynamic = false>
 void runTryEnqDeqThread(
     int numThreads,
@@ -668,6 +755,88 @@ TEST(MPMCQueue, DISABLED_MtProdConsDynamic) {
   runMtProdCons</* Dynamic = */ true>();
 }
 
+template <typename Q>
+string producerConsumerBatchBench(
+    Q&& queue,
+    string qName,
+    int numProducers,
+    int numConsumers,
+    int numOps,
+    size_t batchSize) {
+  Q& q = queue;
+  auto beginMicro = nowMicro();
+  uint64_t n = numOps;
+  std::atomic<uint64_t> sum(0);
+
+  // Every thread handles numOps / numThreads elements, in whole batches.
+  auto perThread = [&](int numThreads) {
+    return numOps / numThreads / batchSize * batchSize;
+  };
+  n = perThread(numProducers) * numProducers;
+  EXPECT_EQ(n, perThread(numConsumers) * numConsumers);
+
+  vector<std::thread> producers(numProducers);
+  for (int t = 0; t < numProducers; ++t) {
+    producers[t] = std::thread([&, t] {
+      vector<int> batch(batchSize);
+      int next = t * perThread(numProducers);
+      int end = next + perThread(numProducers);
+      while (next < end) {
+        std::iota(batch.begin(), batch.end(), next);
+        q.blockingWriteBatch(batch.begin(), batch.end());
+        next += batchSize;
+      }
+    });
+  }
+
+  vector<std::thread> consumers(numConsumers);
+  for (int t = 0; t < numConsumers; ++t) {
+    consumers[t] = std::thread([&] {
+      vector<int> batch(batchSize);
+      uint64_t localSum = 0;
+      for (int i = 0; i < perThread(numConsumers); i += batchSize) {
+        q.blockingReadBatch(batch.data(), batchSize);
+        for (auto elem : batch) {
+          localSum += elem;
+        }
+      }
+      sum += localSum;
+    });
+  }
+
+  for (auto& t : producers) {
+    t.join();
+  }
+  for (auto& t : consumers) {
+    t.join();
+  }
+  EXPECT_EQ(n * (n - 1) / 2 - sum, 0);
+
+  auto endMicro = nowMicro();
+  uint64_t nanosPer = (1000 * (endMicro - beginMicro)) / n;
+  return folly::sformat(
+      "{}, {} producers, {} consumers, batches of {} => {} nanos/handoff",
+      qName,
+      numProducers,
+      numConsumers,
+      batchSize,
+      nanosPer);
+}
+
+// This is a benchmark, not a test
+TEST(MPMCQueue, DISABLED_MtProdConsBatch) {
+  using QueueType = MPMCQueue<int>;
+
+  int n = 1 << 20;
+  setFromEnv(n, "NUM_OPS");
+  for (size_t batchSize : {1, 8, 32, 64}) {
+    for (auto [np, nc] : {std::pair{1, 1}, {4, 4}, {8, 2}, {16, 16}}) {
+      LOG(INFO) << producerConsumerBatchBench(
+          QueueType(1024), "MPMCQueue<int>(1024)", np, nc, n, batchSize);
+    }
+  }
+}
+
 template <bool Dynamic = false>
 void runMtProdConsEmulatedFutex() {
   using QueueType = MPMCQueue<int, EmulatedFutexAtomic, Dynamic>;
@@ -15,6 +15,8 @@
  */
 
 #include <array>
+#include <cstdint>
+#include <cstring>
 
 #include <folly/FollyMemcpy.h>
 #include <folly/Portability.h>
@@ -168,3 +170,45 @@ TEST(follyMemcpy, main) {
     testLen(len);
   }
 }
+
+TEST(follyMemcpy, tunables) {
+  auto const saved = folly::getMemcpyTunables();
+  EXPECT_GT(saved.nonTemporalThreshold, 256);
+
+  // Route every large copy to rep movsb, then to non-temporal stores.
+  for (auto tunables : {
+           folly::MemcpyTunables{257, SIZE_MAX},
+           folly::MemcpyTunables{SIZE_MAX, 257},
+           folly::MemcpyTunables{257, 257},
+       }) {
+    folly::setMemcpyTunables(tunables);
+    EXPECT_EQ(
+        tunables.repMovsbThreshold,
+        folly::getMemcpyTunables().repMovsbThreshold);
+    EXPECT_EQ(
+        tunables.nonTemporalThreshold,
+        folly::getMemcpyTunables().nonTemporalThreshold);
+    for (size_t dst_offset = 0; dst_offset < 64; dst_offset += 13) {
+      for (size_t src_offset = 0; src_offset < 64; src_offset += 11) {
+        for (size_t len = 257; len < 1200; len += 31) {
+          testLen(len, dst_offset, src_offset);
+        }
+        testLen(49 * 4096, dst_offset, src_offset);
+      }
+    }
+
+    // Overlapping copies don't use non-temporal stores.
+    std::array<char, 4096> buf;
+    std::array<char, 4096> check;
+    for (size_t shift : {1, 31, 32, 100, 1000}) {
+      for (size_t i = 0; i < buf.size(); ++i) {
+        buf[i] = static_cast<char>(i % 127);
+      }
+      size_t const len = buf.size() - shift;
+      memmove(check.data(), buf.data() + shift, len);
+      folly::__folly_memcpy(buf.data(), buf.data() + shift, len);
+      ASSERT_EQ(0, memcmp(buf.data(), check.data(), len)) << shift;
+    }
+  }
+  folly::setMemcpyTunables(saved);
+}
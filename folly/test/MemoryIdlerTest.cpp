@@ -16,11 +16,14 @@
 
 #include <folly/detail/MemoryIdler.h>
 
+#include <cstring>
 #include <memory>
 #include <thread>
 
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
+#include <folly/portability/SysMman.h>
+#include <folly/portability/Unistd.h>
 #include <folly/synchronization/Baton.h>
 
 using namespace folly::detail;
@@ -48,6 +51,42 @@ TEST(MemoryIdler, releaseStackLargeExtra) {
   MemoryIdler::unmapUnusedStack(30000000);
 }
 
+TEST(MemoryIdler, releaseOtherStack) {
+  if (!folly::kIsLinux || folly::kIsSanitizeAddress || folly::kIsMobile) {
+    GTEST_SKIP() << "Stacks are only released on Linux";
+  }
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  constexpr size_t kPages = 8;
+  auto p = mmap(
+      nullptr,
+      kPages * pageSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  ASSERT_NE(MAP_FAILED, p);
+  auto base = static_cast<unsigned char*>(p);
+  memset(base, 0xff, kPages * pageSize);
+
+  // The stack starts in the middle of page 0, and is in use from 100 bytes
+  // into page 6: with 1024 bytes retained below that, pages 1 to 4 are
+  // released.
+  MemoryIdler::unmapUnusedStack(base + 100, base + 6 * pageSize + 100, 1024);
+  for (size_t i = 0; i < kPages; ++i) {
+    EXPECT_EQ(i >= 1 && i <= 4 ? 0 : 0xff, base[i * pageSize + pageSize / 2])
+        << i;
+  }
+
+  // Nothing to release.
+  memset(base, 0xff, kPages * pageSize);
+  MemoryIdler::unmapUnusedStack(base, base + pageSize + 100, 1024);
+  MemoryIdler::unmapUnusedStack(base + pageSize, base, 0);
+  for (size_t i = 0; i < kPages; ++i) {
+    EXPECT_EQ(0xff, base[i * pageSize]) << i;
+  }
+  munmap(p, kPages * pageSize);
+}
+
 TEST(MemoryIdler, releaseMallocTLS) {
   auto p = new int[4];
   MemoryIdler::flushLocalMallocCaches();
@@ -16,6 +16,7 @@
 
 #include <stdlib.h>
 #include <cstddef>
+#include <cstdint>
 
 #include <folly/FollyMemset.h>
 
@@ -62,3 +63,29 @@ TEST(MemsetAsmTest, unalignedBuffer) {
   }
   free(buf);
 }
+
+TEST(MemsetAsmTest, tunables) {
+  auto const saved = folly::getMemsetTunables();
+  EXPECT_GT(saved.nonTemporalThreshold, 192);
+
+  // Route every large fill to rep stosq, then to non-temporal stores.
+  uint8_t* buf =
+      reinterpret_cast<uint8_t*>(aligned_alloc(kPageSize, 2 * kPageSize));
+  for (auto tunables : {
+           folly::MemsetTunables{193, SIZE_MAX},
+           folly::MemsetTunables{SIZE_MAX, 193},
+       }) {
+    folly::setMemsetTunables(tunables);
+    EXPECT_EQ(
+        tunables.repStosqThreshold,
+        folly::getMemsetTunables().repStosqThreshold);
+    EXPECT_EQ(
+        tunables.nonTemporalThreshold,
+        folly::getMemsetTunables().nonTemporalThreshold);
+    for (size_t alignment = 0; alignment < 64; alignment += 7) {
+      testMemsetImpl(buf + alignment, kPageSize);
+    }
+  }
+  folly::setMemsetTunables(saved);
+  free(buf);
+}
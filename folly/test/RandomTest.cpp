@@ -17,6 +17,7 @@
 #include <folly/Random.h>
 
 #include <algorithm>
+#include <array>
 #include <random>
 #include <thread>
 #include <unordered_set>
@@ -266,6 +267,73 @@ TEST(Random, randDouble01) {
   EXPECT_EQ(kSeenBoth, seenSoFar);
 }
 
+TEST(Random, fill) {
+  std::vector<uint64_t> values64(1001);
+  folly::Random::fill(values64);
+  EXPECT_EQ(
+      values64.size(),
+      std::unordered_set<uint64_t>(values64.begin(), values64.end()).size());
+
+  // Odd sizes split the outputs of the generator in halves.
+  std::vector<uint32_t> values32(1001);
+  folly::Random::fill(values32);
+  EXPECT_GT(
+      std::unordered_set<uint32_t>(values32.begin(), values32.end()).size(),
+      990);
+
+  std::mt19937 rng(42);
+  std::mt19937 expected(42);
+  folly::Random::fill(span<uint32_t>(values32.data(), 10), rng);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(expected(), values32[i]);
+  }
+}
+
+TEST(Random, fillBounded) {
+  std::vector<uint32_t> values32(10000);
+  for (uint32_t max : {1u, 3u, 10u, 1000u, 0x80000001u}) {
+    folly::Random::fill(values32, max);
+    EXPECT_LT(*std::max_element(values32.begin(), values32.end()), max);
+  }
+  folly::Random::fill(values32, 0);
+  EXPECT_EQ(0, *std::max_element(values32.begin(), values32.end()));
+
+  // Every bucket is hit about as often.
+  std::vector<uint64_t> values64(100000);
+  std::array<size_t, 10> counts{};
+  folly::Random::fill(values64, 10);
+  for (auto value : values64) {
+    ASSERT_LT(value, 10);
+    ++counts[value];
+  }
+  for (auto count : counts) {
+    EXPECT_GT(count, 9000);
+    EXPECT_LT(count, 11000);
+  }
+
+  for (uint64_t max : {uint64_t(7), uint64_t(1) << 40, ~uint64_t(0) / 3 * 2}) {
+    std::mt19937_64 rng(42);
+    folly::Random::fill(values64, max, rng);
+    EXPECT_LT(*std::max_element(values64.begin(), values64.end()), max);
+  }
+  // About a third of the draws are rejected for this bound.
+  EXPECT_GT(
+      *std::max_element(values64.begin(), values64.end()), ~uint64_t(0) / 2);
+}
+
+TEST(Random, randomMulHigh) {
+  uint64_t low;
+  EXPECT_EQ(0, folly::detail::randomMulHigh(uint64_t(1) << 63, 1, low));
+  EXPECT_EQ(uint64_t(1) << 63, low);
+  EXPECT_EQ(
+      ~uint64_t(0) - 1,
+      folly::detail::randomMulHigh(~uint64_t(0), ~uint64_t(0), low));
+  EXPECT_EQ(1, low);
+  uint32_t low32;
+  EXPECT_EQ(0xfffffffe, folly::detail::randomMulHigh(~0u, ~0u, low32));
+  EXPECT_EQ(1, low32);
+}
+
 #ifndef _WIN32
 TEST(Random, SecureFork) {
   // Random buffer size is 128, must be less than that.
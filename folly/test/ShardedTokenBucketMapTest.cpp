@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ShardedTokenBucketMap.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(ShardedTokenBucketMap, Consume) {
+  ShardedTokenBucketMap<std::string> buckets(8, 4);
+  EXPECT_EQ(0, buckets.size());
+  EXPECT_EQ(4, buckets.available("a", 100));
+
+  // New buckets start full.
+  EXPECT_TRUE(buckets.consume("a", 4, 100));
+  EXPECT_FALSE(buckets.consume("a", 1, 100));
+  EXPECT_TRUE(buckets.consume("b", 1, 100));
+  EXPECT_EQ(2, buckets.size());
+  EXPECT_EQ(0, buckets.available("a", 100));
+  EXPECT_EQ(3, buckets.available("b", 100));
+
+  // Refilled at the rate.
+  EXPECT_TRUE(buckets.consume("a", 1, 100.125));
+  EXPECT_EQ(2, buckets.consumeOrDrain("a", 3, 100.375));
+  buckets.returnTokens("a", 2, 100.375);
+  EXPECT_EQ(2, buckets.available("a", 100.375));
+}
+
+TEST(ShardedTokenBucketMap, Evict) {
+  ShardedTokenBucketMap<int>::Options options;
+  options.shards = 1;
+  options.sweepThreshold = 4;
+  ShardedTokenBucketMap<int> buckets(1, 10, options);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(buckets.consume(i, 1, 0));
+  }
+  EXPECT_EQ(4, buckets.size());
+  // The buckets 0 to 3 aren't full yet: nothing is swept.
+  EXPECT_TRUE(buckets.consume(4, 1, 0.5));
+  EXPECT_EQ(5, buckets.size());
+
+  // Tenant 4 consumed last, and isn't full yet.
+  EXPECT_EQ(4, buckets.evictIdle(1.1));
+  EXPECT_EQ(1, buckets.size());
+  EXPECT_EQ(10, buckets.available(0, 1.1));
+  EXPECT_DOUBLE_EQ(9.6, buckets.available(4, 1.1));
+
+  // The sweep happens as the shard grows.
+  for (int i = 5; i < 9; ++i) {
+    EXPECT_TRUE(buckets.consume(i, 1, 1.1));
+  }
+  EXPECT_EQ(5, buckets.size());
+  EXPECT_TRUE(buckets.consume(9, 1, 100));
+  EXPECT_EQ(1, buckets.size());
+}
+
+TEST(ShardedTokenBucketMap, Batch) {
+  ShardedTokenBucketMap<int> buckets(1, 3);
+  std::vector<std::pair<int, double>> requests;
+  for (int i = 0; i < 4; ++i) {
+    for (int tenant = 0; tenant < 100; ++tenant) {
+      requests.emplace_back(tenant, 1);
+    }
+  }
+  EXPECT_TRUE(buckets.consume(0, 2, 0));
+  auto granted = std::make_unique<bool[]>(requests.size());
+  EXPECT_EQ(
+      298,
+      buckets.consume(
+          requests, span<bool>(granted.get(), requests.size()), 0));
+  EXPECT_TRUE(granted[1]);
+  EXPECT_TRUE(granted[201]);
+  EXPECT_FALSE(granted[301]);
+  // The first request of tenant 0 took its last token.
+  EXPECT_TRUE(granted[0]);
+  EXPECT_FALSE(granted[100]);
+}
+
+TEST(ShardedTokenBucketMap, LocalCache) {
+  ShardedTokenBucketMap<int>::Options options;
+  options.localCacheTokens = 10;
+  constexpr double kTokens = 100000;
+  // Not refilled over the test.
+  ShardedTokenBucketMap<int> buckets(1e-9, kTokens, options);
+  auto const now = ShardedTokenBucketMap<int>::defaultClockNow();
+  std::atomic<size_t> consumed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      while (buckets.consume(0, 1, now)) {
+        consumed.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // The tokens cached by the cores aren't consumed, but never more than the
+  // bucket held.
+  EXPECT_LE(consumed.load(), kTokens);
+  EXPECT_GE(consumed.load(), kTokens - 10 * 64);
+  EXPECT_LT(buckets.available(0, now), 1);
+}
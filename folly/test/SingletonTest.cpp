@@ -701,6 +701,116 @@ TEST(Singleton, SingletonEagerInitParallel) {
   }
 }
 
+namespace {
+struct EagerInitDependenciesTag {};
+struct DependentTag {};
+struct DependencyTag {};
+} // namespace
+template <typename T, typename Tag = detail::DefaultTag>
+using SingletonEagerInitDependencies =
+    Singleton<T, Tag, EagerInitDependenciesTag>;
+TEST(Singleton, SingletonEagerInitDependencies) {
+  auto& vault = *SingletonVault::singleton<EagerInitDependenciesTag>();
+  std::atomic<bool> dependencyBuilt{false};
+  std::atomic<bool> builtInOrder{false};
+  // Only the dependent is eager: its dependency is built first anyway.
+  auto dependent =
+      SingletonEagerInitDependencies<std::string, DependentTag>([&] {
+        builtInOrder = dependencyBuilt.load();
+        auto dependency = SingletonEagerInitDependencies<
+            std::string,
+            DependencyTag>::try_get();
+        return new std::string(*dependency + "bar");
+      })
+          .shouldEagerInit()
+          .dependsOn<std::string, DependencyTag>();
+  auto dependency =
+      SingletonEagerInitDependencies<std::string, DependencyTag>([&] {
+        /* sleep override */
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        dependencyBuilt = true;
+        return new std::string("foo");
+      });
+  vault.registrationComplete();
+
+  {
+    TestEagerInitParallelExecutor exe(4);
+    folly::Baton<> done;
+    vault.doEagerInitVia(exe, &done);
+    done.wait();
+  }
+  EXPECT_TRUE(builtInOrder);
+  using Dependent = SingletonEagerInitDependencies<std::string, DependentTag>;
+  EXPECT_EQ("foobar", *Dependent::try_get());
+
+  auto const stats = vault.creationStats();
+  ASSERT_EQ(2, stats.size());
+  for (const auto& stat : stats) {
+    EXPECT_LE(stat.selfDuration, stat.duration);
+    EXPECT_GE(stat.selfDuration.count(), 0);
+  }
+  // The dependency, which was built on its own, was the slowest.
+  EXPECT_NE(std::string::npos, stats[0].name.find("DependencyTag"));
+  EXPECT_GE(stats[0].duration, std::chrono::milliseconds(10));
+  EXPECT_TRUE(stats[0].dependencies.empty());
+  ASSERT_EQ(1, stats[1].dependencies.size());
+  EXPECT_EQ(stats[0].name, stats[1].dependencies[0]);
+}
+
+namespace {
+struct ObservedDependenciesTag {};
+} // namespace
+template <typename T, typename Tag = detail::DefaultTag>
+using SingletonObservedDependencies =
+    Singleton<T, Tag, ObservedDependenciesTag>;
+TEST(Singleton, SingletonObservedDependencies) {
+  auto& vault = *SingletonVault::singleton<ObservedDependenciesTag>();
+  auto dependent =
+      SingletonObservedDependencies<std::string, DependentTag>([] {
+        auto dependency =
+            SingletonObservedDependencies<std::string, DependencyTag>::
+                try_get();
+        return new std::string(*dependency + "bar");
+      }).shouldEagerInit();
+  auto dependency =
+      SingletonObservedDependencies<std::string, DependencyTag>([] {
+        /* sleep override */
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return new std::string("foo");
+      });
+  vault.registrationComplete();
+  vault.doEagerInit();
+
+  auto const stats = vault.creationStats();
+  ASSERT_EQ(2, stats.size());
+  // The dependent, which built its dependency, was the slowest.
+  EXPECT_NE(std::string::npos, stats[0].name.find("DependentTag"));
+  ASSERT_EQ(1, stats[0].dependencies.size());
+  EXPECT_EQ(stats[1].name, stats[0].dependencies[0]);
+  EXPECT_GE(stats[0].duration, std::chrono::milliseconds(10));
+  EXPECT_EQ(
+      stats[0].duration - stats[1].duration, stats[0].selfDuration);
+}
+
+namespace {
+struct EagerInitCycleTag {};
+} // namespace
+template <typename T, typename Tag = detail::DefaultTag>
+using SingletonEagerInitCycle = Singleton<T, Tag, EagerInitCycleTag>;
+TEST(Singleton, SingletonEagerInitCycle) {
+  auto& vault = *SingletonVault::singleton<EagerInitCycleTag>();
+  auto dependent = SingletonEagerInitCycle<std::string, DependentTag>()
+                       .shouldEagerInit()
+                       .dependsOn<std::string, DependencyTag>();
+  auto dependency = SingletonEagerInitCycle<std::string, DependencyTag>()
+                        .dependsOn<std::string, DependentTag>();
+  vault.registrationComplete();
+  folly::EventBase eb;
+  EXPECT_THROW(vault.doEagerInitVia(eb), std::logic_error);
+  eb.loop();
+  EXPECT_EQ(0, vault.livingSingletonCount());
+}
+
 struct StateTestTag {};
 template <typename T, typename Tag = detail::DefaultTag>
 using SingletonVaultStateTest = Singleton<T, Tag, StateTestTag>;
@@ -22,6 +22,7 @@
 
 #include <folly/String.h>
 #include <folly/container/Array.h>
+#include <folly/container/F14Set.h>
 #include <folly/portability/GTest.h>
 #include <folly/portability/Sockets.h>
 #include <folly/test/SocketAddressTestHelper.h>
@@ -540,6 +541,47 @@ TEST(SocketAddress, CheckComparatorBehavior) {
   CheckFirstLessThanSecond(first, second);
 }
 
+TEST(SocketAddress, DescribeTo) {
+  auto describeTo = [](const SocketAddress& addr) {
+    char buf[SocketAddress::kMaxDescribeSize];
+    return std::string(buf, addr.describeTo(buf));
+  };
+  SocketAddress addr;
+  EXPECT_EQ("<uninitialized address>", describeTo(addr));
+  addr.setFromIpPort("1.2.3.4", 65535);
+  EXPECT_EQ("1.2.3.4:65535", describeTo(addr));
+  addr.setFromIpPort("2620:0:1c00:face:b00c:0:0:abcd", 0);
+  EXPECT_EQ("[2620:0:1c00:face:b00c::abcd]:0", describeTo(addr));
+  addr.setFromIpPort("::ffff:255.255.255.255", 443);
+  EXPECT_EQ("[::ffff:255.255.255.255]:443", describeTo(addr));
+  addr.setFromPath("/i/am/a/unix/address");
+  EXPECT_EQ("/i/am/a/unix/address", describeTo(addr));
+
+  std::ostringstream os;
+  os << SocketAddress("::1", 80);
+  EXPECT_EQ("[::1]:80", os.str());
+
+  char buf[8];
+  SocketAddress("1.2.3.4", 1234).getAddressStr(buf, sizeof(buf));
+  EXPECT_STREQ("1.2.3.4", buf);
+  SocketAddress("10.20.30.40", 1234).getAddressStr(buf, sizeof(buf));
+  EXPECT_STREQ("10.20.3", buf);
+}
+
+TEST(SocketAddress, F14Key) {
+  static_assert(folly::IsAvalanchingHasher<
+                std::hash<SocketAddress>,
+                SocketAddress>::value);
+  folly::F14FastSet<SocketAddress> set;
+  for (uint16_t port = 0; port < 1000; ++port) {
+    EXPECT_TRUE(set.emplace("10.0.0.1", port).second);
+    EXPECT_TRUE(set.emplace("2620:0:1c00:face:b00c::abcd", port).second);
+  }
+  EXPECT_EQ(2000, set.size());
+  EXPECT_EQ(1, set.count(SocketAddress("10.0.0.1", 999)));
+  EXPECT_EQ(0, set.count(SocketAddress("10.0.0.2", 999)));
+}
+
 TEST(SocketAddress, Unix) {
   SocketAddress addr;
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/StreamVByte.h>
+
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/GroupVarint.h>
+
+using namespace folly;
+
+namespace {
+
+constexpr size_t kCount = 4096;
+
+template <typename T>
+std::vector<T> makeValues() {
+  std::mt19937_64 rng(12345);
+  std::vector<T> values(kCount);
+  for (auto& value : values) {
+    value = T(rng()) >> (rng() % (8 * sizeof(T)));
+  }
+  return values;
+}
+
+const std::vector<uint32_t> values32 = makeValues<uint32_t>();
+const std::vector<uint64_t> values64 = makeValues<uint64_t>();
+
+} // namespace
+
+BENCHMARK(GroupVarint32Encode, iters) {
+  // GroupVarint decoding reads up to 16 bytes past the last group.
+  std::vector<char> buf(GroupVarint32::maxSize(kCount) + 16);
+  while (iters--) {
+    char* p = buf.data();
+    for (size_t i = 0; i < kCount; i += 4) {
+      p = GroupVarint32::encode(p, values32.data() + i);
+    }
+    doNotOptimizeAway(p);
+  }
+}
+
+BENCHMARK_RELATIVE(StreamVByte32Encode, iters) {
+  std::vector<uint8_t> buf(StreamVByte32::maxEncodedSize(kCount));
+  while (iters--) {
+    doNotOptimizeAway(
+        StreamVByte32::encode(values32.data(), kCount, buf.data()));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(GroupVarint32Decode, iters) {
+  std::vector<char> buf(GroupVarint32::maxSize(kCount) + 16);
+  std::vector<uint32_t> out(kCount);
+  BENCHMARK_SUSPEND {
+    char* p = buf.data();
+    for (size_t i = 0; i < kCount; i += 4) {
+      p = GroupVarint32::encode(p, values32.data() + i);
+    }
+  }
+  while (iters--) {
+    const char* p = buf.data();
+    for (size_t i = 0; i < kCount; i += 4) {
+      p = GroupVarint32::decode(p, out.data() + i);
+    }
+    doNotOptimizeAway(out.data());
+  }
+}
+
+BENCHMARK_RELATIVE(StreamVByte32Decode, iters) {
+  std::vector<uint8_t> buf(StreamVByte32::maxEncodedSize(kCount));
+  std::vector<uint32_t> out(kCount);
+  size_t size = 0;
+  BENCHMARK_SUSPEND {
+    size = StreamVByte32::encode(values32.data(), kCount, buf.data());
+  }
+  while (iters--) {
+    StreamVByte32::decode(ByteRange(buf.data(), size), kCount, out.data());
+    doNotOptimizeAway(out.data());
+  }
+}
+
+BENCHMARK_RELATIVE(StreamVByte32DecodeDelta, iters) {
+  std::vector<uint8_t> buf(StreamVByte32::maxEncodedSize(kCount));
+  std::vector<uint32_t> out(kCount);
+  size_t size = 0;
+  BENCHMARK_SUSPEND {
+    size = StreamVByte32::encodeDelta(values32.data(), kCount, buf.data());
+  }
+  while (iters--) {
+    StreamVByte32::decodeDelta(
+        ByteRange(buf.data(), size), kCount, out.data());
+    doNotOptimizeAway(out.data());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(GroupVarint64Decode, iters) {
+  std::vector<char> buf(GroupVarint64::maxSize(kCount) + 16);
+  std::vector<uint64_t> out(kCount + 5);
+  BENCHMARK_SUSPEND {
+    char* p = buf.data();
+    for (size_t i = 0; i + 5 <= kCount; i += 5) {
+      p = GroupVarint64::encode(p, values64.data() + i);
+    }
+  }
+  while (iters--) {
+    const char* p = buf.data();
+    for (size_t i = 0; i + 5 <= kCount; i += 5) {
+      p = GroupVarint64::decode(p, out.data() + i);
+    }
+    doNotOptimizeAway(out.data());
+  }
+}
+
+BENCHMARK_RELATIVE(StreamVByte64Decode, iters) {
+  std::vector<uint8_t> buf(StreamVByte64::maxEncodedSize(kCount));
+  std::vector<uint64_t> out(kCount);
+  size_t size = 0;
+  BENCHMARK_SUSPEND {
+    size = StreamVByte64::encode(values64.data(), kCount, buf.data());
+  }
+  while (iters--) {
+    StreamVByte64::decode(ByteRange(buf.data(), size), kCount, out.data());
+    doNotOptimizeAway(out.data());
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
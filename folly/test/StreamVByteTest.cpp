@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/StreamVByte.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+// Values of all encoded lengths, including the extremes.
+template <typename T>
+std::vector<T> randomValues(size_t count, std::mt19937_64& rng) {
+  std::vector<T> values(count);
+  for (auto& value : values) {
+    value = T(rng()) >> (rng() % (8 * sizeof(T)));
+  }
+  if (count > 2) {
+    values[0] = 0;
+    values[1] = std::numeric_limits<T>::max();
+  }
+  return values;
+}
+
+// Decodes from a buffer of exactly the encoded size, so that reading past it
+// trips ASAN.
+template <typename T, typename Encode, typename Decode>
+void checkRoundTrip(
+    const std::vector<T>& values, Encode encode, Decode decode) {
+  using SVB = StreamVByte<std::make_unsigned_t<T>>;
+  std::vector<uint8_t> buf(SVB::maxEncodedSize(values.size()));
+  auto size = encode(values.data(), values.size(), buf.data());
+  ASSERT_LE(SVB::controlSize(values.size()), size);
+  ASSERT_LE(size, buf.size());
+
+  auto exact = std::make_unique<uint8_t[]>(size);
+  std::copy(buf.begin(), buf.begin() + size, exact.get());
+  std::vector<T> decoded(values.size());
+  ByteRange in(exact.get(), size);
+  EXPECT_EQ(size, decode(in, values.size(), decoded.data()));
+  EXPECT_EQ(values, decoded);
+
+  if (!values.empty()) {
+    EXPECT_THROW(
+        decode(in.subpiece(0, size - 1), values.size(), decoded.data()),
+        std::invalid_argument);
+  }
+}
+
+template <typename T>
+void checkAll(size_t count, std::mt19937_64& rng) {
+  using SVB = StreamVByte<T>;
+  using S = typename SVB::signed_type;
+  SCOPED_TRACE(count);
+
+  auto values = randomValues<T>(count, rng);
+  checkRoundTrip(values, SVB::encode, SVB::decode);
+  std::vector<uint8_t> buf(SVB::maxEncodedSize(count));
+  EXPECT_EQ(
+      SVB::encodedSize(values.data(), count),
+      SVB::encode(values.data(), count, buf.data()));
+
+  auto sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+  checkRoundTrip(
+      sorted,
+      [](auto in, auto n, auto out) { return SVB::encodeDelta(in, n, out); },
+      [](auto in, auto n, auto out) { return SVB::decodeDelta(in, n, out); });
+  // Unsorted values wrap around.
+  checkRoundTrip(
+      values,
+      [](auto in, auto n, auto out) { return SVB::encodeDelta(in, n, out, 7); },
+      [](auto in, auto n, auto out) {
+        return SVB::decodeDelta(in, n, out, 7);
+      });
+
+  std::vector<S> signedValues(values.begin(), values.end());
+  for (size_t i = 0; i < count; i += 2) {
+    signedValues[i] = -signedValues[i];
+  }
+  checkRoundTrip(signedValues, SVB::encodeZigZag, SVB::decodeZigZag);
+  checkRoundTrip(
+      signedValues,
+      [](auto in, auto n, auto out) {
+        return SVB::encodeDeltaZigZag(in, n, out, -3);
+      },
+      [](auto in, auto n, auto out) {
+        return SVB::decodeDeltaZigZag(in, n, out, -3);
+      });
+}
+
+} // namespace
+
+TEST(StreamVByte, Layout32) {
+  const uint32_t values[] = {1, 0x100, 0x10000, 0x1000000, 0x7f};
+  uint8_t buf[StreamVByte32::maxEncodedSize(5)];
+  ASSERT_EQ(2 + 1 + 2 + 3 + 4 + 1, StreamVByte32::encode(values, 5, buf));
+  EXPECT_EQ(0b11100100, buf[0]);
+  EXPECT_EQ(0b00, buf[1]);
+  const uint8_t data[] = {1, 0, 1, 0, 0, 1, 0, 0, 0, 1, 0x7f};
+  EXPECT_TRUE(std::equal(std::begin(data), std::end(data), buf + 2));
+}
+
+TEST(StreamVByte, Layout64) {
+  const uint64_t values[] = {1, 0x100, 0x10000, 0x100000000};
+  uint8_t buf[StreamVByte64::maxEncodedSize(4)];
+  ASSERT_EQ(1 + 1 + 2 + 4 + 8, StreamVByte64::encode(values, 4, buf));
+  EXPECT_EQ(0b11100100, buf[0]);
+}
+
+TEST(StreamVByte, ZigZag) {
+  const int32_t values[] = {0, -1, 1, -64, 127, -128, 128};
+  uint8_t buf[StreamVByte32::maxEncodedSize(7)];
+  // Up to 127 in magnitude fits in a byte.
+  EXPECT_EQ(2 + 6 + 2, StreamVByte32::encodeZigZag(values, 7, buf));
+}
+
+TEST(StreamVByte, Delta) {
+  std::vector<uint32_t> values(1000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 1000000 + 3 * i;
+  }
+  std::vector<uint8_t> buf(StreamVByte32::maxEncodedSize(values.size()));
+  // All deltas but the first fit in a byte.
+  EXPECT_EQ(
+      250 + 3 + 999,
+      StreamVByte32::encodeDelta(values.data(), values.size(), buf.data()));
+  EXPECT_EQ(
+      250 + 1000,
+      StreamVByte32::encodeDelta(
+          values.data(), values.size(), buf.data(), 1000000 - 3));
+}
+
+TEST(StreamVByte, RoundTrip32) {
+  std::mt19937_64 rng(42);
+  for (size_t count = 0; count < 40; ++count) {
+    checkAll<uint32_t>(count, rng);
+  }
+  checkAll<uint32_t>(10000, rng);
+}
+
+TEST(StreamVByte, RoundTrip64) {
+  std::mt19937_64 rng(43);
+  for (size_t count = 0; count < 40; ++count) {
+    checkAll<uint64_t>(count, rng);
+  }
+  checkAll<uint64_t>(10000, rng);
+}
+
+TEST(StreamVByte, Empty) {
+  uint32_t out;
+  EXPECT_EQ(0, StreamVByte32::encode(nullptr, 0, nullptr));
+  EXPECT_EQ(0, StreamVByte32::decode(ByteRange(), 0, &out));
+  EXPECT_THROW(
+      StreamVByte32::decode(ByteRange(), 1, &out), std::invalid_argument);
+}
@@ -254,6 +254,16 @@ BENCHMARK(BM_uriUnescape, iters) {
   }
 }
 
+BENCHMARK(BM_hexlify, iters) {
+  // iters/sec = bytes input per sec
+  fbstring hexed;
+  folly::StringPiece bytes = hexlifyInput;
+  for (; iters >= bytes.size(); iters -= bytes.size()) {
+    folly::hexlify(bytes, hexed);
+  }
+  folly::hexlify(bytes.subpiece(0, iters), hexed);
+}
+
 BENCHMARK(BM_unhexlify, iters) {
   // iters/sec = bytes output per sec
   std::string unhexed;
@@ -310,6 +320,40 @@ BENCHMARK(splitStrFixed, iters) {
   }
 }
 
+// A log line, with tokens long enough for the vectorized search.
+static const std::string logLine =
+    "2024-01-31 12:00:00.123456 host1234.example.com GET "
+    "/api/v1/objects/0123456789abcdef?fields=name,size,owner "
+    "HTTP/1.1\t200\t5123\t\"Mozilla/5.0 (X11; Linux x86_64)\"";
+
+BENCHMARK(splitStrLong, iters) {
+  static const std::string line = folly::join("-*-", {logLine, logLine});
+  for (size_t i = 0; i < iters; ++i) {
+    std::vector<StringPiece> pieces;
+    folly::split("-*-", line, pieces);
+    folly::doNotOptimizeAway(pieces.size());
+  }
+}
+
+BENCHMARK(splitAnyOfWhitespace, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    std::vector<StringPiece> pieces;
+    folly::split(folly::AnyCharOf(" \t"), logLine, pieces, true);
+    folly::doNotOptimizeAway(pieces.size());
+  }
+}
+
+BENCHMARK(splitLazyAnyOfWhitespace, iters) {
+  for (size_t i = 0; i < iters; ++i) {
+    size_t count = 0;
+    auto const delim = folly::AnyCharOf(" \t");
+    for (auto token : folly::splitLazy(delim, logLine, true)) {
+      count += token.size();
+    }
+    folly::doNotOptimizeAway(count);
+  }
+}
+
 BENCHMARK(boost_splitOnSingleChar, iters) {
   static const std::string line = "one:two:three:four";
   bool (*pred)(char) = [](char c) -> bool { return c == ':'; };
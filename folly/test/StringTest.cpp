@@ -20,6 +20,7 @@
 
 #include <folly/String.h>
 
+#include <cctype>
 #include <cinttypes>
 #include <set>
 #include <tuple>
@@ -1037,6 +1038,100 @@ TEST(Split, fixedConvertCustom) {
   EXPECT_THROW(folly::split(',', "B,G", c1, c2), my::ColorError);
 }
 
+TEST(Split, multiCharDelim) {
+  // Long enough inputs for the vectorized search of the delimiter.
+  std::vector<std::string> expected;
+  for (int i = 0; i < 40; ++i) {
+    expected.push_back(std::string(size_t(i % 7), char('a' + i % 26)) + ":a");
+  }
+  auto input = folly::join("::", expected);
+
+  std::vector<std::string> pieces;
+  folly::split("::", input, pieces);
+  EXPECT_EQ(expected, pieces);
+
+  // Overlapping candidates are matched from the left, without overlap.
+  pieces.clear();
+  folly::split("aa", "aaaaa", pieces);
+  EXPECT_EQ((std::vector<std::string>{"", "", "a"}), pieces);
+
+  pieces.clear();
+  folly::split("abc", "xabcabcyabc", pieces, true);
+  EXPECT_EQ((std::vector<std::string>{"x", "y"}), pieces);
+}
+
+TEST(Split, anyOf) {
+  std::vector<folly::StringPiece> pieces;
+  folly::split(folly::AnyCharOf(" \t"), "a b\t\tc \t ", pieces);
+  EXPECT_EQ(
+      (std::vector<folly::StringPiece>{"a", "b", "", "c", "", "", ""}), pieces);
+
+  pieces.clear();
+  folly::split(folly::AnyCharOf(" \t"), "  a b\t\tc \t ", pieces, true);
+  EXPECT_EQ((std::vector<folly::StringPiece>{"a", "b", "c"}), pieces);
+
+  std::set<std::string> words;
+  folly::splitTo<std::string>(
+      folly::AnyCharOf(",;"),
+      "x;y,x;z",
+      std::inserter(words, words.begin()));
+  EXPECT_EQ((std::set<std::string>{"x", "y", "z"}), words);
+
+  pieces.clear();
+  folly::split(folly::AnyCharOf(""), "a b", pieces);
+  EXPECT_EQ((std::vector<folly::StringPiece>{"a b"}), pieces);
+
+  folly::StringPiece key, value;
+  EXPECT_TRUE(folly::split(folly::AnyCharOf("=:"), "k:v", key, value));
+  EXPECT_EQ("k", key);
+  EXPECT_EQ("v", value);
+  EXPECT_FALSE(folly::split(folly::AnyCharOf("=:"), "kv", key, value));
+}
+
+TEST(Split, lazy) {
+  auto collect = [](auto&& range) {
+    std::vector<std::string> result;
+    for (folly::StringPiece token : range) {
+      result.push_back(token.str());
+    }
+    return result;
+  };
+
+  // The lazy split finds the same tokens as split().
+  auto check = [&](auto delim, folly::StringPiece input, bool ignoreEmpty) {
+    std::vector<std::string> expected;
+    folly::split(delim, input, expected, ignoreEmpty);
+    EXPECT_EQ(expected, collect(folly::splitLazy(delim, input, ignoreEmpty)))
+        << input;
+  };
+  for (folly::StringPiece input :
+       {"", ",", "a", ",a", "a,", "a,,b", ",,a,,b,,", "abc,def,ghi"}) {
+    for (bool ignoreEmpty : {false, true}) {
+      check(',', input, ignoreEmpty);
+      check(",,", input, ignoreEmpty);
+      check(std::string(""), input, ignoreEmpty);
+    }
+  }
+
+  EXPECT_EQ(
+      (std::vector<std::string>{"GET", "/index.html", "HTTP/1.1"}),
+      collect(folly::splitLazy(
+          folly::AnyCharOf(" \t\n"), "  GET /index.html\t HTTP/1.1\n", true)));
+  EXPECT_EQ(
+      (std::vector<std::string>{"a", "b", ""}),
+      collect(folly::splitLazy(folly::AnyCharOf(" \t"), "a\tb ")));
+
+  auto range = folly::splitLazy(':', "x:y");
+  auto it = range.begin();
+  EXPECT_EQ("x", *it);
+  EXPECT_EQ(1, it->size());
+  EXPECT_EQ("x", *it++);
+  EXPECT_EQ("y", *it);
+  EXPECT_NE(range.end(), it);
+  EXPECT_EQ(range.end(), ++it);
+  EXPECT_EQ(range.begin(), range.begin());
+}
+
 TEST(String, join) {
   string output;
 
@@ -1092,6 +1187,36 @@ TEST(String, hexlify) {
   EXPECT_EQ("01020304", hexlify(ByteRange{bytes.data(), bytes.size()}));
 }
 
+TEST(String, hexlifyLong) {
+  // Longer than the vectorized blocks, with every byte value.
+  std::string input;
+  std::string expected;
+  for (int i = 0; i < 300; ++i) {
+    auto const c = static_cast<unsigned char>(i * 7);
+    input += static_cast<char>(c);
+    expected += "0123456789abcdef"[c >> 4];
+    expected += "0123456789abcdef"[c & 0xf];
+  }
+  std::string output = "prefix";
+  EXPECT_TRUE(hexlify(input, output, true));
+  EXPECT_EQ("prefix" + expected, output);
+
+  std::vector<char> vec;
+  EXPECT_TRUE(hexlify(input, vec));
+  EXPECT_EQ(expected, std::string(vec.begin(), vec.end()));
+
+  std::string upper = expected;
+  for (auto& c : upper) {
+    c = static_cast<char>(std::toupper(c));
+  }
+  std::string decoded;
+  EXPECT_TRUE(unhexlify(upper, decoded));
+  EXPECT_EQ(input, decoded);
+
+  expected[250] = 'g';
+  EXPECT_FALSE(unhexlify(expected, decoded));
+}
+
 TEST(String, unhexlify) {
   string input1 = "30313233";
   string output1;
@@ -224,6 +224,31 @@ TEST(SimpleSubprocessTest, ExecFails) {
       "/etc/passwd/not/a/file");
 }
 
+TEST(SimpleSubprocessTest, UsePath) {
+  test::TemporaryDirectory dir;
+  auto const exe = (dir.path() / "folly_subprocess_true").string();
+  writeFile(std::string("#!/bin/sh\nexit 3\n"), exe.c_str());
+  PCHECK(chmod(exe.c_str(), 0755) == 0);
+  auto const oldPath = std::string(getenv("PATH"));
+  SCOPE_EXIT {
+    setenv("PATH", oldPath.c_str(), 1);
+  };
+  setenv("PATH", (dir.path().string() + ":" + oldPath).c_str(), 1);
+
+  auto const options = Subprocess::Options().usePath();
+  for (int i = 0; i < 2; ++i) {
+    Subprocess proc(std::vector<std::string>{"folly_subprocess_true"}, options);
+    EXPECT_EQ(3, proc.wait().exitStatus());
+  }
+  // Found on the PATH again once it moved away.
+  PCHECK(unlink(exe.c_str()) == 0);
+  EXPECT_SPAWN_OPT_ERROR(
+      ENOENT,
+      "failed to execute folly_subprocess_true:",
+      options,
+      "folly_subprocess_true");
+}
+
 TEST(SimpleSubprocessTest, ShellExitsSuccesssfully) {
   Subprocess proc("true");
   EXPECT_EQ(0, proc.wait().exitStatus());
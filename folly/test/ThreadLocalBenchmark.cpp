@@ -55,6 +55,7 @@ template <typename T>
 class PThreadGetSpecific {
  public:
   PThreadGetSpecific() : key_(0) { pthread_key_create(&key_, OnThreadExit); }
+  ~PThreadGetSpecific() { pthread_key_delete(key_); }
 
   T* get() const { return static_cast<T*>(pthread_getspecific(key_)); }
 
@@ -89,6 +90,8 @@ DEFINE_int32(num_threads, 8, "Number simultaneous threads for benchmarks.");
 
 ThreadLocalPtr<int> tlp;
 REG(tlp)
+ThreadLocalPtr<int> tlp_hot(thread_local_hot);
+REG(tlp_hot)
 PThreadGetSpecific<int> pthread_get_specific;
 REG(pthread_get_specific)
 boost::thread_specific_ptr<int> boost_tsp;
@@ -124,6 +127,12 @@ void run_multi(uint32_t iters) {
 BENCHMARK(BM_mt_tlp_multi, iters) {
   run_multi<ThreadLocalPtr<foo>>(iters);
 }
+BENCHMARK(BM_mt_tlp_hot_multi, iters) {
+  struct HotThreadLocalPtr : ThreadLocalPtr<foo> {
+    HotThreadLocalPtr() : ThreadLocalPtr<foo>(thread_local_hot) {}
+  };
+  run_multi<HotThreadLocalPtr>(iters);
+}
 BENCHMARK(BM_mt_pthread_get_specific_multi, iters) {
   run_multi<PThreadGetSpecific<foo>>(iters);
 }
@@ -177,14 +186,16 @@ int main(int argc, char** argv) {
 ============================================================================
 folly/test/ThreadLocalBenchmark.cpp             relative  time/iter  iters/s
 ============================================================================
-BM_mt_tlp                                                   2.10ns   476.69M
-BM_mt_pthread_get_specific                                  1.81ns   553.11M
-BM_mt_boost_tsp                                             6.88ns   145.42M
+BM_mt_tlp                                                   1.21ns   825.30M
+BM_mt_tlp_hot                                             579.94ps     1.72G
+BM_mt_pthread_get_specific                                  2.81ns   355.39M
+BM_mt_boost_tsp                                            12.21ns    81.93M
 ----------------------------------------------------------------------------
-BM_mt_tlp_multi                                            11.91ns    83.94M
-BM_mt_pthread_get_specific_multi                           13.34ns    74.96M
-BM_mt_boost_tsp_multi                                      43.52ns    22.98M
+BM_mt_tlp_multi                                             9.87ns   101.27M
+BM_mt_tlp_hot_multi                                         6.50ns   153.92M
+BM_mt_pthread_get_specific_multi                           20.06ns    49.84M
+BM_mt_boost_tsp_multi                                      68.18ns    14.67M
 ----------------------------------------------------------------------------
-BM_tlp_access_all_threads_iterate                          22.82ns    43.82M
+BM_tlp_access_all_threads_iterate                          10.28ns    97.31M
 ----------------------------------------------------------------------------
 */
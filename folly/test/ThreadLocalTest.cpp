@@ -502,6 +502,100 @@ TEST(ThreadLocal, Movable2) {
   EXPECT_EQ(4, tls.size());
 }
 
+TEST(ThreadLocal, Hot) {
+  ThreadLocal<int> tl(thread_local_hot, [] { return 7; });
+  ASSERT_EQ(threadlocal_detail::StaticMetaBase::kUseThreadLocal, tl.hot());
+  EXPECT_EQ(7, *tl);
+  *tl = 8;
+  EXPECT_EQ(8, *tl);
+  std::thread([&] {
+    EXPECT_EQ(7, *tl);
+    tl.reset(new int(9));
+    EXPECT_EQ(9, *tl);
+  }).join();
+  EXPECT_EQ(8, *tl);
+  tl.reset(new int(10));
+  EXPECT_EQ(10, *tl);
+  tl.reset();
+  EXPECT_EQ(7, *tl);
+}
+
+TEST(ThreadLocalPtr, Hot) {
+  Widget::totalVal_ = 0;
+  {
+    ThreadLocalPtr<Widget> tlp(thread_local_hot);
+    EXPECT_EQ(nullptr, tlp.get());
+    tlp.reset(new Widget());
+    tlp->val_ = 1;
+    std::unique_ptr<Widget> released(tlp.release());
+    EXPECT_EQ(nullptr, tlp.get());
+    std::thread([&] {
+      tlp.reset(new Widget());
+      tlp->val_ = 10;
+    }).join();
+    EXPECT_EQ(10, Widget::totalVal_);
+    tlp.reset(new Widget());
+    tlp->val_ = 100;
+  }
+  EXPECT_EQ(111, Widget::totalVal_);
+
+  // The instances which take over a slot don't see the elements cached by
+  // the previous ones.
+  for (int i = 0; i < 3; ++i) {
+    ThreadLocalPtr<int> tlp(thread_local_hot);
+    EXPECT_EQ(nullptr, tlp.get());
+    tlp.reset(new int(i));
+    EXPECT_EQ(i, *tlp);
+  }
+
+  // Moves keep the slot.
+  ThreadLocalPtr<int> a(thread_local_hot);
+  a.reset(new int(1));
+  ThreadLocalPtr<int> b(std::move(a));
+  EXPECT_FALSE(a.hot());
+  EXPECT_EQ(1, *b);
+}
+
+TEST(ThreadLocalPtr, HotSlotsRunOut) {
+  std::vector<ThreadLocalPtr<size_t>> tls;
+  for (size_t i = 0; i < 2 * threadlocal_detail::HotSlots::kCount; ++i) {
+    tls.emplace_back(thread_local_hot);
+    tls.back().reset(new size_t(i));
+  }
+  EXPECT_FALSE(tls.back().hot());
+  for (size_t i = 0; i < tls.size(); ++i) {
+    EXPECT_EQ(i, *tls[i]);
+  }
+}
+
+TEST(ThreadLocalPtr, HotAccessAllThreads) {
+  struct HotTag {};
+  ThreadLocalPtr<int, HotTag> tlp(thread_local_hot);
+  std::thread([&] { tlp.reset(new int(2)); }).join();
+  tlp.reset(new int(3));
+  int sum = 0;
+  for (auto& i : tlp.accessAllThreads()) {
+    sum += i;
+  }
+  EXPECT_EQ(3, sum);
+}
+
+TEST(ThreadLocalPtr, HotOnThreadExit) {
+  Widget::totalVal_ = 0;
+  ThreadLocal<Widget> w(thread_local_hot);
+  ThreadLocalPtr<int> tl;
+  std::thread([&] {
+    ++w->val_;
+    tl.reset(new int(1), [&](int* ptr, TLPDestructionMode) {
+      delete ptr;
+      // The element may have been disposed of already, and is then created
+      // again rather than read from the slot.
+      ++w->val_;
+    });
+  }).join();
+  EXPECT_EQ(2, Widget::totalVal_);
+}
+
 namespace {
 
 constexpr size_t kFillObjectSize = 300;
@@ -645,6 +739,62 @@ TEST(ThreadLocal, StressAccessRelease) {
       [](size_t sum, size_t numThreads) { EXPECT_LE(sum, numThreads); });
 }
 
+TEST(ThreadLocal, AccessAllThreadsWhileGrowing) {
+  struct Tag {};
+  using TL = ThreadLocal<int, Tag>;
+  TL counter;
+  folly::Baton<> added;
+  folly::Baton<> grow;
+  folly::Baton<> grown;
+  std::thread owner([&] {
+    *counter = 1;
+    added.post();
+    grow.wait();
+    // Grows the array of elements of the thread, which the accessor reads.
+    std::vector<std::unique_ptr<TL>> others;
+    for (int i = 0; i < 100; ++i) {
+      others.push_back(std::make_unique<TL>());
+      *others.back()->get() = i;
+    }
+    grown.post();
+  });
+  added.wait();
+
+  {
+    auto accessor = counter.accessAllThreads();
+    auto it = accessor.begin();
+    ASSERT_NE(accessor.end(), it);
+    grow.post();
+    // Another thread starts and grows its array of the tag meanwhile.
+    std::thread([] {
+      std::vector<std::unique_ptr<TL>> others;
+      for (int i = 0; i < 100; ++i) {
+        others.push_back(std::make_unique<TL>());
+        *others.back()->get() = i;
+      }
+    }).join();
+    grown.wait();
+    EXPECT_EQ(1, *it);
+    EXPECT_EQ(accessor.end(), ++it);
+  }
+  owner.join();
+}
+
+TEST(ThreadLocal, AccessAllThreadsConcurrently) {
+  struct Tag {};
+  ThreadLocal<int, Tag> a;
+  ThreadLocal<int, Tag> b;
+  *a = 1;
+  *b = 2;
+  // The accessors of a tag which isn't strict don't exclude each other.
+  auto accessA = a.accessAllThreads();
+  std::thread([&] {
+    auto accessB = b.accessAllThreads();
+    EXPECT_EQ(2, *accessB.begin());
+  }).join();
+  EXPECT_EQ(1, *accessA.begin());
+}
+
 // Yes, threads and fork don't mix
 // (http://cppwisdom.quora.com/Why-threads-and-fork-dont-mix) but if you're
 // stupid or desperate enough to try, we shouldn't stand in your way.
@@ -84,6 +84,9 @@ TEST(Traits, containers) {
   EXPECT_FALSE(IsRelocatable<vector<F1>>::value);
   EXPECT_TRUE((IsRelocatable<pair<F1, F1>>::value));
   EXPECT_TRUE((IsRelocatable<pair<T1, T2>>::value));
+#ifndef _MSC_VER
+  EXPECT_TRUE(IsRelocatable<std::allocator<F1>>::value);
+#endif
 }
 
 TEST(Traits, original) {
@@ -17,9 +17,12 @@
 #include <folly/Unicode.h>
 
 #include <initializer_list>
+#include <random>
 #include <stdexcept>
+#include <string>
 
 #include <folly/Range.h>
+#include <folly/String.h>
 #include <folly/portability/GTest.h>
 
 using namespace folly;
@@ -85,6 +88,7 @@ void testValid(std::initializer_list<unsigned char> data, char32_t expected) {
   }
 
   EXPECT_EQ(codePointToUtf8(expected), std::string(data.begin(), data.end()));
+  EXPECT_TRUE(isValidUtf8(std::string(data.begin(), data.end())));
   {
     std::string out = "prefix";
     appendCodePointToUtf8(expected, out);
@@ -93,6 +97,7 @@ void testValid(std::initializer_list<unsigned char> data, char32_t expected) {
 }
 
 void testInvalid(std::initializer_list<unsigned char> data) {
+  EXPECT_FALSE(isValidUtf8(std::string(data.begin(), data.end())));
   {
     const unsigned char* p = data.begin();
     const unsigned char* e = data.end();
@@ -181,3 +186,211 @@ TEST(InvalidUtf8ToCodePoint, FourCloverLeafAsSurrogates) {
 TEST(ValidUtf8ToCodePoint, LastCodePoint) {
   testValid({0xF4, 0x8F, 0xBF, 0xBF}, 0x10FFFF); // u8"\U0010FFFF";
 }
+
+namespace {
+
+bool isValidUtf8Reference(const std::string& s) {
+  auto p = reinterpret_cast<const unsigned char*>(s.data());
+  auto e = p + s.size();
+  try {
+    while (p < e) {
+      utf8ToCodePoint(p, e, /* skipOnError */ false);
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(IsValidUtf8, Sequences) {
+  // All the sequences of up to 3 bytes, and 4 bytes starting with a 4 byte
+  // lead, made of bytes at the boundaries of the ranges that matter, in ASCII
+  // text so as to cross the 16 byte blocks of the vectorized implementation.
+  const unsigned char bytes[] = {
+      0x00, 0x41, 0x7f, 0x80, 0x8f, 0x90, 0x9f, 0xa0, 0xbf, 0xc0, 0xc1,
+      0xc2, 0xdf, 0xe0, 0xe1, 0xed, 0xef, 0xf0, 0xf3, 0xf4, 0xf5, 0xff,
+  };
+  std::string seq;
+  auto check = [&] {
+    for (size_t offset : {0, 13, 15, 16}) {
+      for (size_t suffix : {0, 20}) {
+        auto s = std::string(offset, 'a') + seq + std::string(suffix, 'b');
+        ASSERT_EQ(isValidUtf8Reference(s), isValidUtf8(s))
+            << offset << " " << suffix << " " << folly::hexlify(seq);
+      }
+    }
+  };
+  for (auto a : bytes) {
+    for (auto b : bytes) {
+      for (auto c : bytes) {
+        for (auto d : bytes) {
+          if (a >= 0xf0) {
+            seq = {char(a), char(b), char(c), char(d)};
+            check();
+          }
+        }
+        seq = {char(a), char(b), char(c)};
+        check();
+      }
+      seq = {char(a), char(b)};
+      check();
+    }
+    seq = {char(a)};
+    check();
+  }
+}
+
+TEST(IsValidUtf8, Random) {
+  std::mt19937 rng(42);
+  for (int i = 0; i < 2000; ++i) {
+    std::string s;
+    for (size_t n = rng() % 200; n > 0; --n) {
+      switch (rng() % 4) {
+        case 0:
+          s.push_back(char(rng() % 0x80));
+          break;
+        case 1:
+          appendCodePointToUtf8(0x80 + rng() % (0x800 - 0x80), s);
+          break;
+        case 2:
+          appendCodePointToUtf8(0xe000 + rng() % (0x10000 - 0xe000), s);
+          break;
+        default:
+          appendCodePointToUtf8(0x10000 + rng() % (0x110000 - 0x10000), s);
+      }
+    }
+    EXPECT_TRUE(isValidUtf8(s));
+    if (!s.empty()) {
+      // Corrupting a byte may or may not make the string invalid.
+      s[rng() % s.size()] = char(rng());
+      EXPECT_EQ(isValidUtf8Reference(s), isValidUtf8(s)) << folly::hexlify(s);
+      s.pop_back();
+      EXPECT_EQ(isValidUtf8Reference(s), isValidUtf8(s)) << folly::hexlify(s);
+    }
+  }
+}
+
+namespace {
+
+// A random mix of 1 to 4 byte UTF-8 sequences, with runs of ASCII of various
+// lengths so as to exercise both the block and the per code point paths.
+std::u32string randomCodePoints(std::mt19937& rng) {
+  std::u32string s;
+  for (size_t n = rng() % 300; n > 0; --n) {
+    switch (rng() % 5) {
+      case 0:
+        s.append(rng() % 40, char32_t('a' + rng() % 26));
+        break;
+      case 1:
+        s.push_back(char32_t(rng() % 0x80));
+        break;
+      case 2:
+        s.push_back(char32_t(0x80 + rng() % (0x800 - 0x80)));
+        break;
+      case 3:
+        s.push_back(char32_t(0xe000 + rng() % (0x10000 - 0xe000)));
+        break;
+      default:
+        s.push_back(char32_t(0x10000 + rng() % (0x110000 - 0x10000)));
+    }
+  }
+  return s;
+}
+
+std::string toUtf8Reference(const std::u32string& s) {
+  std::string out;
+  for (auto cp : s) {
+    appendCodePointToUtf8(cp, out);
+  }
+  return out;
+}
+
+std::u16string toUtf16Reference(const std::u32string& s) {
+  std::u16string out;
+  for (auto cp : s) {
+    if (cp > 0xffff) {
+      out.push_back(char16_t(0xd800 + ((cp - 0x10000) >> 10)));
+      out.push_back(char16_t(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+    } else {
+      out.push_back(char16_t(cp));
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+TEST(IsAscii, Basic) {
+  EXPECT_TRUE(isAscii(""));
+  EXPECT_TRUE(isAscii(std::string(100, '\x7f')));
+  for (size_t size : {1, 15, 16, 17, 40}) {
+    for (size_t i = 0; i < size; ++i) {
+      std::string s(size, 'a');
+      s[i] = '\x80';
+      EXPECT_FALSE(isAscii(s)) << size << " " << i;
+    }
+  }
+}
+
+TEST(CountUtf8CodePoints, Random) {
+  EXPECT_EQ(0, countUtf8CodePoints(""));
+  std::mt19937 rng(42);
+  for (int i = 0; i < 500; ++i) {
+    auto cps = randomCodePoints(rng);
+    EXPECT_EQ(cps.size(), countUtf8CodePoints(toUtf8Reference(cps)));
+  }
+}
+
+TEST(Utf8Transcoding, Random) {
+  std::mt19937 rng(42);
+  for (int i = 0; i < 500; ++i) {
+    auto utf32 = randomCodePoints(rng);
+    auto utf16 = toUtf16Reference(utf32);
+    auto utf8 = toUtf8Reference(utf32);
+    EXPECT_EQ(utf16, utf8ToUtf16(utf8));
+    EXPECT_EQ(utf32, utf8ToUtf32(utf8));
+    EXPECT_EQ(utf8, utf16ToUtf8(utf16));
+    EXPECT_EQ(utf8, utf32ToUtf8(utf32));
+  }
+}
+
+TEST(Utf8Transcoding, Invalid) {
+  // The Unicode Standard examples of ill-formed sequences, after a block of
+  // ASCII and in the middle of one.
+  for (std::string bad :
+       {"\x80", "\xc0\xaf", "\xe0\x9f\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80",
+        "\xf8\x88\x80\x80\x80", "\xe1\x80", "\xc2"}) {
+    for (size_t offset : {0, 5, 16, 20}) {
+      auto s = std::string(offset, 'a') + bad + std::string(20, 'b');
+      EXPECT_FALSE(isValidUtf8(s));
+      EXPECT_THROW(utf8ToUtf16(s), unicode_error) << folly::hexlify(s);
+      EXPECT_THROW(utf8ToUtf32(s), unicode_error) << folly::hexlify(s);
+    }
+  }
+  EXPECT_THROW(utf8ToUtf16(std::string(20, 'a') + "\xc3"), unicode_error);
+
+  for (std::u16string bad : {u"\xd800", u"\xdc00", u"\xdc00\xd800"}) {
+    for (size_t offset : {0, 5, 16, 20}) {
+      for (size_t suffix : {0, 20}) {
+        auto s = std::u16string(offset, u'a') + bad +
+            std::u16string(suffix, u'b');
+        EXPECT_THROW(utf16ToUtf8(s), unicode_error);
+      }
+    }
+  }
+  for (char32_t bad : {0xd800u, 0xdfffu, 0x110000u, 0xffffffffu}) {
+    for (size_t offset : {0, 5, 16, 20}) {
+      auto s = std::u32string(offset, U'a') + bad + std::u32string(20, U'b');
+      EXPECT_THROW(utf32ToUtf8(s), unicode_error);
+    }
+  }
+
+  try {
+    utf8ToUtf32(std::string(20, 'a') + "\xce\xbb\xff");
+    ADD_FAILURE();
+  } catch (const unicode_error& e) {
+    EXPECT_STREQ("folly::utf8ToUtf32: invalid UTF-8 at offset 22", e.what());
+  }
+}
@@ -17,6 +17,7 @@
 #include <folly/Uri.h>
 
 #include <map>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <glog/logging.h>
@@ -423,3 +424,96 @@ TEST(Uri, BadPortThrowsInvalidArgument) {
   constexpr folly::StringPiece s = "http://localhost:9999999999999999999/";
   EXPECT_THROW(Uri{s}, std::invalid_argument);
 }
+
+TEST(UriView, Simple) {
+  {
+    StringPiece s("HTTP://user:pass@[::1]:8080/hello/world?query#fragment");
+    UriView u(s);
+    EXPECT_EQ("HTTP", u.scheme());
+    EXPECT_EQ("user", u.username());
+    EXPECT_EQ("pass", u.password());
+    EXPECT_EQ("[::1]", u.host());
+    EXPECT_EQ("::1", u.hostname());
+    EXPECT_EQ(8080, u.port());
+    EXPECT_EQ("/hello/world", u.path());
+    EXPECT_EQ("query", u.query());
+    EXPECT_EQ("fragment", u.fragment());
+    EXPECT_TRUE(u.hasAuthority());
+    // The parts point into the parsed string.
+    EXPECT_EQ(s.begin(), u.scheme().begin());
+    EXPECT_EQ(s.end(), u.fragment().end());
+
+    Uri uri(u);
+    EXPECT_EQ("http", uri.scheme());
+    EXPECT_EQ("http://user:pass@[::1]:8080/hello/world?query#fragment", uri.str());
+  }
+
+  {
+    UriView u("this:is@another:valid:uri#with?fragment");
+    EXPECT_EQ("this", u.scheme());
+    EXPECT_FALSE(u.hasAuthority());
+    EXPECT_EQ("", u.host());
+    EXPECT_EQ("is@another:valid:uri", u.path());
+    EXPECT_EQ("", u.query());
+    EXPECT_EQ("with?fragment", u.fragment());
+  }
+
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI,
+      UriView::tryFromString("2http://www.facebook.com").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI,
+      UriView::tryFromString("http//www.facebook.com").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI_AUTHORITY,
+      UriView::tryFromString("http://www[facebook]com").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI_PORT,
+      UriView::tryFromString("http://localhost:99999/").error());
+  EXPECT_THROW(UriView("http://[::1:8080/"), std::invalid_argument);
+}
+
+TEST(UriView, Authority) {
+  struct Case {
+    StringPiece authority;
+    StringPiece username;
+    StringPiece password;
+    StringPiece host;
+    uint16_t port;
+  };
+  for (const auto& c : std::vector<Case>{
+           {"", "", "", "", 0},
+           {"host:", "", "", "host", 0},
+           {"a:b:c@host:80", "a", "b:c", "host", 80},
+           {"a@b@host", "a", "", "b@host", 0},
+           {"a@[::1]", "a", "", "[::1]", 0},
+           // The user information ends at the first '@', unless the rest
+           // isn't a host and port.
+           {"[a@b]", "[a", "", "b]", 0},
+           {"[a@b:c]", "", "", "[a@b:c]", 0},
+           {"a@b:", "a", "", "b", 0},
+       }) {
+    auto s = to<std::string>("http://", c.authority, "/path");
+    UriView u(s);
+    EXPECT_EQ(c.username, u.username()) << s;
+    EXPECT_EQ(c.password, u.password()) << s;
+    EXPECT_EQ(c.host, u.host()) << s;
+    EXPECT_EQ(c.port, u.port()) << s;
+    EXPECT_EQ("/path", u.path()) << s;
+  }
+}
+
+TEST(UriView, QueryParams) {
+  UriView u("http://localhost?&key1=foo&key2=&key3&=bar&=bar=&a=b=c&&key4=x#y");
+  std::vector<std::pair<StringPiece, StringPiece>> params(
+      u.queryParams().begin(), u.queryParams().end());
+  std::vector<std::pair<StringPiece, StringPiece>> expected{
+      {"key1", "foo"}, {"key2", ""}, {"key3", ""}, {"key4", "x"}};
+  EXPECT_EQ(expected, params);
+
+  EXPECT_EQ(
+      UriView::QueryParams("").begin(), UriView::QueryParams("").end());
+  EXPECT_EQ(
+      UriView::QueryParams("&&=a&b=c=").begin(),
+      UriView::QueryParams("&&=a&b=c=").end());
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <folly/base64.h>
+#include <folly/detail/base64_detail/Base64SWAR.h>
+#include <folly/detail/base64_detail/Base64Scalar.h>
+#include <folly/detail/base64_detail/Base64_AVX2.h>
+#include <folly/detail/base64_detail/Base64_SSE4_2.h>
+#include <folly/init/Init.h>
+
+// The runtime versions are the ones selected for the CPU, e.g. AVX2. The
+// others are the individual implementations, which may not be supported by
+// the CPU which runs the benchmarks.
+
+namespace bd = folly::detail::base64_detail;
+
+namespace {
+
+const std::string& bytes() {
+  static const std::string res = [] {
+    std::mt19937 rnd;
+    std::uniform_int_distribution<int> dis(0, 255);
+    std::string s(4096, '\0');
+    for (auto& c : s) {
+      c = static_cast<char>(dis(rnd));
+    }
+    return s;
+  }();
+  return res;
+}
+
+const std::string& encoded() {
+  static const std::string res = folly::base64Encode(bytes());
+  return res;
+}
+
+template <typename Encode>
+void encode(size_t iters, Encode fn) {
+  const auto& in = bytes();
+  std::string out(folly::base64EncodedSize(in.size()), '\0');
+  while (iters--) {
+    folly::doNotOptimizeAway(fn(in.data(), in.data() + in.size(), out.data()));
+  }
+}
+
+template <typename Decode>
+void decode(size_t iters, Decode fn) {
+  const auto& in = encoded();
+  std::string out(folly::base64DecodedSize(in), '\0');
+  while (iters--) {
+    auto r = fn(in.data(), in.data() + in.size(), out.data());
+    folly::doNotOptimizeAway(r.o);
+  }
+}
+
+} // namespace
+
+BENCHMARK(base64EncodeScalar, iters) {
+  encode(iters, bd::base64EncodeScalar);
+}
+
+#if FOLLY_SSE_PREREQ(4, 2)
+BENCHMARK_RELATIVE(base64EncodeSSE4_2, iters) {
+  encode(iters, bd::base64Encode_SSE4_2);
+}
+#endif
+
+#if FOLLY_X64
+BENCHMARK_RELATIVE(base64EncodeAVX2, iters) {
+  encode(iters, bd::base64Encode_AVX2);
+}
+#endif
+
+BENCHMARK_RELATIVE(base64EncodeRuntime, iters) {
+  encode(iters, folly::base64EncodeRuntime);
+}
+
+BENCHMARK_RELATIVE(base64URLEncodeRuntime, iters) {
+  encode(iters, folly::base64URLEncodeRuntime);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(base64DecodeScalar, iters) {
+  decode(iters, bd::base64DecodeScalar);
+}
+
+BENCHMARK_RELATIVE(base64DecodeSWAR, iters) {
+  decode(iters, bd::base64DecodeSWAR);
+}
+
+#if FOLLY_SSE_PREREQ(4, 2)
+BENCHMARK_RELATIVE(base64DecodeSSE4_2, iters) {
+  decode(iters, bd::base64Decode_SSE4_2);
+}
+#endif
+
+#if FOLLY_X64
+BENCHMARK_RELATIVE(base64DecodeAVX2, iters) {
+  decode(iters, bd::base64Decode_AVX2);
+}
+#endif
+
+BENCHMARK_RELATIVE(base64DecodeRuntime, iters) {
+  decode(iters, [](const char* f, const char* l, char* o) {
+    return folly::base64DecodeRuntime(f, l, o);
+  });
+}
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
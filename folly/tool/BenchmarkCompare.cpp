@@ -32,6 +32,13 @@
  *     $ your_benchmark_binary --benchmark --bm_json_verbose old-json
  * - compare two benchmarks & output a human-readable comparison:
  *     $ benchmark_compare old-json new-json
+ *
+ * With --bm_repetitions in both runs, the comparison gives the p-value of
+ * each change, and marks the significant regressions, for which
+ * benchmark_compare exits with 1 (see --bm_regression_alpha and
+ * --bm_regression_threshold):
+ *     $ your_benchmark_binary --benchmark --bm_repetitions 10 \
+ *         --bm_json_verbose new-json
  */
 namespace folly {
 
@@ -44,8 +51,16 @@ std::vector<detail::BenchmarkResult> resultsFromFile(
   return ret;
 }
 
-void compareBenchmarkResults(const std::string& base, const std::string& test) {
-  printResultComparison(resultsFromFile(base), resultsFromFile(test));
+// Returns whether test has no regression.
+bool compareBenchmarkResults(const std::string& base, const std::string& test) {
+  auto baseResults = resultsFromFile(base);
+  auto testResults = resultsFromFile(test);
+  printResultComparison(baseResults, testResults);
+  auto regressions = findBenchmarkRegressions(baseResults, testResults);
+  for (auto& name : regressions) {
+    LOG(ERROR) << "Regression: " << name;
+  }
+  return regressions.empty();
 }
 
 } // namespace folly
@@ -53,6 +68,5 @@ void compareBenchmarkResults(const std::string& base, const std::string& test) {
 int main(int argc, char** argv) {
   folly::Init init(&argc, &argv);
   CHECK_GT(argc, 2);
-  folly::compareBenchmarkResults(argv[1], argv[2]);
-  return 0;
+  return folly::compareBenchmarkResults(argv[1], argv[2]) ? 0 : 1;
 }
@@ -18,7 +18,9 @@
  * This macro enables FbSystrace usage in production for fb4a. When
  * FOLLY_SCOPED_TRACE_SECTION_HEADER is defined then a trace section is started
  * and later automatically terminated at the close of the scope it is called in.
- * In all other cases no action is taken.
+ * In all other cases the scope is recorded as a folly::TraceSection named arg,
+ * which costs a relaxed load and a branch unless the TraceRecorder is enabled:
+ * see folly/tracing/TraceRecorder.h. The other arguments are ignored.
  */
 
 #pragma once
@@ -26,7 +28,9 @@
 #if defined(FOLLY_SCOPED_TRACE_SECTION_HEADER)
 #include FOLLY_SCOPED_TRACE_SECTION_HEADER
 #else
+#include <folly/Preprocessor.h>
+#include <folly/tracing/TraceRecorder.h>
+
 #define FOLLY_SCOPED_TRACE_SECTION(arg, ...) \
-  do {                                       \
-  } while (0)
+  ::folly::TraceSection FB_ANONYMOUS_VARIABLE(follyScopedTraceSection)(arg)
 #endif
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/tracing/TraceRecorder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <folly/Indestructible.h>
+#include <folly/Synchronized.h>
+#include <folly/lang/Bits.h>
+#include <folly/portability/Unistd.h>
+#include <folly/system/ThreadId.h>
+#include <folly/system/ThreadName.h>
+
+namespace folly {
+
+namespace detail {
+std::atomic<bool> traceRecorderEnabled{false};
+} // namespace detail
+
+namespace {
+
+// Written as a seqlock: seq is 0 while the event is being written, and the
+// index of the event plus 1 once it is.
+struct Event {
+  std::atomic<uint64_t> seq{0};
+  std::atomic<const char*> name{nullptr};
+  std::atomic<const char*> category{nullptr};
+  std::atomic<uint64_t> begin{0};
+  std::atomic<uint64_t> end{0};
+};
+
+// The ring of a thread. Only the thread writes it, and head counts the events
+// it wrote.
+struct ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity)
+      : events(new Event[capacity]),
+        mask(capacity - 1),
+        tid(getOSThreadID()),
+        threadName(getCurrentThreadName().value_or("")) {}
+
+  void record(
+      const char* name,
+      const char* category,
+      uint64_t begin,
+      uint64_t end) noexcept {
+    auto const index = head.load(std::memory_order_relaxed);
+    auto& event = events[index & mask];
+    event.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.category.store(category, std::memory_order_relaxed);
+    event.begin.store(begin, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.seq.store(index + 1, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+  }
+
+  uint64_t capacity() const { return mask + 1; }
+
+  // The first index held by the ring, given head.
+  uint64_t first(uint64_t h) const {
+    auto const oldest = h > capacity() ? h - capacity() : 0;
+    return std::max(oldest, cleared.load(std::memory_order_relaxed));
+  }
+
+  const std::unique_ptr<Event[]> events;
+  const uint64_t mask;
+  const uint64_t tid;
+  const std::string threadName;
+  std::atomic<uint64_t> head{0};
+  // The events before are dropped: see TraceRecorder::clear().
+  std::atomic<uint64_t> cleared{0};
+  std::atomic<bool> exited{false};
+};
+
+struct ThreadBufferHolder {
+  ~ThreadBufferHolder() {
+    if (buffer) {
+      buffer->exited.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  std::shared_ptr<ThreadBuffer> buffer;
+};
+
+thread_local ThreadBufferHolder threadBuffer;
+
+std::atomic<size_t> gCapacity{TraceRecorder::kDefaultCapacity};
+
+// Leaked, as threads may record while exiting after the static destructors.
+Synchronized<std::vector<std::shared_ptr<ThreadBuffer>>>& buffers() {
+  static Indestructible<
+      Synchronized<std::vector<std::shared_ptr<ThreadBuffer>>>>
+      buffers;
+  return *buffers;
+}
+
+FOLLY_NOINLINE ThreadBuffer* makeThreadBuffer() noexcept {
+  try {
+    auto const capacity =
+        nextPowTwo(std::max<size_t>(gCapacity.load(), size_t(2)));
+    threadBuffer.buffer = std::make_shared<ThreadBuffer>(capacity);
+    buffers().wlock()->push_back(threadBuffer.buffer);
+    return threadBuffer.buffer.get();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// The ticks of hardware_timestamp() per microsecond, measured once.
+double ticksPerMicrosecond() {
+  static const double ticks = [] {
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    auto const startTicks = hardware_timestamp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto const ticks = hardware_timestamp() - startTicks;
+    auto const us = std::chrono::duration<double, std::micro>(
+                        clock::now() - start)
+                        .count();
+    return ticks > 0 && us > 0 ? double(ticks) / us : 1.0;
+  }();
+  return ticks;
+}
+
+void appendEscaped(std::string& out, const char* str) {
+  for (; str && *str; ++str) {
+    auto const c = static_cast<unsigned char>(*str);
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += char(c);
+    } else if (c < 0x20) {
+      out += fmt::format("\\u{:04x}", c);
+    } else {
+      out += char(c);
+    }
+  }
+}
+
+struct Snapshot {
+  uint64_t tid;
+  std::string threadName;
+  struct Entry {
+    const char* name;
+    const char* category;
+    uint64_t begin;
+    uint64_t end;
+  };
+  std::vector<Entry> entries;
+};
+
+Snapshot snapshot(const ThreadBuffer& buffer) {
+  Snapshot snapshot{buffer.tid, buffer.threadName, {}};
+  auto const head = buffer.head.load(std::memory_order_acquire);
+  for (auto i = buffer.first(head); i < head; ++i) {
+    auto const& event = buffer.events[i & buffer.mask];
+    if (event.seq.load(std::memory_order_acquire) != i + 1) {
+      continue; // overwritten
+    }
+    Snapshot::Entry entry{
+        event.name.load(std::memory_order_relaxed),
+        event.category.load(std::memory_order_relaxed),
+        event.begin.load(std::memory_order_relaxed),
+        event.end.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (event.seq.load(std::memory_order_relaxed) == i + 1) {
+      snapshot.entries.push_back(entry);
+    }
+  }
+  return snapshot;
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>> allBuffers() {
+  return *buffers().rlock();
+}
+
+} // namespace
+
+void TraceRecorder::enable(size_t capacity) {
+  gCapacity.store(capacity);
+  detail::traceRecorderEnabled.store(true);
+}
+
+void TraceRecorder::disable() {
+  detail::traceRecorderEnabled.store(false);
+}
+
+void TraceRecorder::record(
+    const char* name,
+    const char* category,
+    uint64_t begin,
+    uint64_t end) noexcept {
+  auto buffer = threadBuffer.buffer.get();
+  if (FOLLY_UNLIKELY(buffer == nullptr)) {
+    buffer = makeThreadBuffer();
+    if (buffer == nullptr) {
+      return;
+    }
+  }
+  buffer->record(name, category, begin, end);
+}
+
+void TraceRecorder::clear() {
+  auto locked = buffers().wlock();
+  for (auto& buffer : *locked) {
+    buffer->cleared.store(buffer->head.load(std::memory_order_acquire));
+  }
+  locked->erase(
+      std::remove_if(
+          locked->begin(),
+          locked->end(),
+          [](const auto& buffer) { return buffer->exited.load(); }),
+      locked->end());
+}
+
+size_t TraceRecorder::size() {
+  size_t size = 0;
+  for (auto const& buffer : allBuffers()) {
+    auto const head = buffer->head.load(std::memory_order_acquire);
+    size += head - buffer->first(head);
+  }
+  return size;
+}
+
+std::string TraceRecorder::exportChromeTrace() {
+  std::vector<Snapshot> snapshots;
+  uint64_t origin = std::numeric_limits<uint64_t>::max();
+  for (auto const& buffer : allBuffers()) {
+    snapshots.push_back(snapshot(*buffer));
+    for (auto const& entry : snapshots.back().entries) {
+      origin = std::min(origin, entry.begin);
+    }
+  }
+  auto const ticksPerUs = ticksPerMicrosecond();
+  auto const pid = getpid();
+
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  auto const separate = [&] {
+    if (!std::exchange(first, false)) {
+      out += ",\n";
+    }
+  };
+  for (auto const& snapshot : snapshots) {
+    if (!snapshot.threadName.empty()) {
+      separate();
+      out += fmt::format(
+          "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},"
+          "\"args\":{{\"name\":\"",
+          pid,
+          snapshot.tid);
+      appendEscaped(out, snapshot.threadName.c_str());
+      out += "\"}}";
+    }
+    for (auto const& entry : snapshot.entries) {
+      separate();
+      out += "{\"name\":\"";
+      appendEscaped(out, entry.name);
+      out += "\",\"cat\":\"";
+      appendEscaped(out, entry.category);
+      auto const end = std::max(entry.end, entry.begin);
+      out += fmt::format(
+          "\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},"
+          "\"tid\":{}}}",
+          double(entry.begin - origin) / ticksPerUs,
+          double(end - entry.begin) / ticksPerUs,
+          pid,
+          snapshot.tid);
+    }
+  }
+  out += "]}\n";
+  return out;
+}
+
+} // namespace folly
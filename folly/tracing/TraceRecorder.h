@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+#include <folly/chrono/Hardware.h>
+
+namespace folly {
+
+namespace detail {
+extern std::atomic<bool> traceRecorderEnabled;
+} // namespace detail
+
+/**
+ * An in-process tracing backend: while enabled, the trace sections record
+ * their begin and end timestamps into a ring buffer of the thread which runs
+ * them, and exportChromeTrace() gives all of them in the Chrome trace event
+ * format, which chrome://tracing and Perfetto (ui.perfetto.dev) open.
+ *
+ *   TraceRecorder::enable();
+ *   runWorkload();
+ *   TraceRecorder::disable();
+ *   writeFile(TraceRecorder::exportChromeTrace(), "trace.json");
+ *
+ * Besides FOLLY_SCOPED_TRACE_SECTION, the phases of the EventBase loops (see
+ * EventBase::LoopPhase) and the tasks of the ThreadPoolExecutors are recorded.
+ *
+ * While disabled, a trace section costs a relaxed load and a branch. While
+ * enabled, it reads the timestamp counter twice and writes an event to the
+ * buffer of its thread, without locks or atomic read-modify-writes. The
+ * buffers are fixed rings: the oldest events of a thread are overwritten once
+ * its buffer is full.
+ *
+ * The names and categories of the events aren't copied: they must outlive the
+ * export, as string literals do.
+ */
+class TraceRecorder {
+ public:
+  // The events held per thread, by default.
+  static constexpr size_t kDefaultCapacity = size_t(1) << 14;
+
+  /**
+   * Starts recording. The buffers allocated from then on, one per thread on
+   * its first event, hold capacity events.
+   */
+  static void enable(size_t capacity = kDefaultCapacity);
+
+  /**
+   * Stops recording. The events recorded so far are kept until clear().
+   */
+  static void disable();
+
+  FOLLY_ALWAYS_INLINE static bool enabled() noexcept {
+    return detail::traceRecorderEnabled.load(std::memory_order_relaxed);
+  }
+
+  // The timestamps of the events, as of folly::hardware_timestamp().
+  FOLLY_ALWAYS_INLINE static uint64_t now() noexcept {
+    return hardware_timestamp();
+  }
+
+  /**
+   * Records an event of the calling thread from begin to end, whether or not
+   * recording is enabled.
+   */
+  static void record(
+      const char* name,
+      const char* category,
+      uint64_t begin,
+      uint64_t end) noexcept;
+
+  /**
+   * Drops the events recorded so far, and the buffers of the threads which
+   * exited.
+   */
+  static void clear();
+
+  /**
+   * The events recorded so far as complete events of the Chrome trace event
+   * format, in microseconds since the first of them, with the names of their
+   * threads as metadata.
+   */
+  static std::string exportChromeTrace();
+
+  // The events held by the buffers, which exportChromeTrace() would give.
+  static size_t size();
+};
+
+/**
+ * Records the scope it lives in as an event, if the TraceRecorder was
+ * enabled when it began.
+ */
+class TraceSection {
+ public:
+  FOLLY_ALWAYS_INLINE explicit TraceSection(
+      const char* name, const char* category = "folly") noexcept
+      : name_(name), category_(category) {
+    if (FOLLY_UNLIKELY(TraceRecorder::enabled())) {
+      begin_ = TraceRecorder::now();
+    }
+  }
+
+  FOLLY_ALWAYS_INLINE ~TraceSection() {
+    if (FOLLY_UNLIKELY(begin_ != 0)) {
+      TraceRecorder::record(name_, category_, begin_, TraceRecorder::now());
+    }
+  }
+
+  TraceSection(const TraceSection&) = delete;
+  TraceSection& operator=(const TraceSection&) = delete;
+
+ private:
+  const char* const name_;
+  const char* const category_;
+  uint64_t begin_ = 0;
+};
+
+} // namespace folly
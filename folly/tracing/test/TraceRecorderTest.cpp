@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/tracing/TraceRecorder.h>
+
+#include <string>
+#include <thread>
+
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Unistd.h>
+#include <folly/system/ThreadName.h>
+#include <folly/tracing/ScopedTraceSection.h>
+
+using namespace folly;
+
+namespace {
+
+class TraceRecorderTest : public testing::Test {
+ protected:
+  void SetUp() override { TraceRecorder::clear(); }
+
+  void TearDown() override {
+    TraceRecorder::disable();
+    TraceRecorder::clear();
+  }
+
+  static size_t count(const std::string& trace, const std::string& what) {
+    size_t count = 0;
+    for (auto pos = trace.find(what); pos != std::string::npos;
+         pos = trace.find(what, pos + 1)) {
+      ++count;
+    }
+    return count;
+  }
+};
+
+} // namespace
+
+TEST_F(TraceRecorderTest, Disabled) {
+  { FOLLY_SCOPED_TRACE_SECTION("disabled"); }
+  EXPECT_EQ(0, TraceRecorder::size());
+  EXPECT_EQ(
+      "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n",
+      TraceRecorder::exportChromeTrace());
+}
+
+TEST_F(TraceRecorderTest, Sections) {
+  TraceRecorder::enable();
+  {
+    FOLLY_SCOPED_TRACE_SECTION("outer", "ignored", 42);
+    TraceSection inner("inner", "test\"category");
+  }
+  TraceRecorder::disable();
+  { FOLLY_SCOPED_TRACE_SECTION("disabled"); }
+
+  EXPECT_EQ(2, TraceRecorder::size());
+  auto const trace = TraceRecorder::exportChromeTrace();
+  // The inner section ends first.
+  auto const inner =
+      trace.find("{\"name\":\"inner\",\"cat\":\"test\\\"category\"");
+  auto const outer = trace.find("{\"name\":\"outer\",\"cat\":\"folly\"");
+  ASSERT_NE(std::string::npos, inner) << trace;
+  ASSERT_NE(std::string::npos, outer) << trace;
+  EXPECT_LT(inner, outer);
+  EXPECT_EQ(2, count(trace, "\"ph\":\"X\""));
+  // The first event begins at 0.
+  EXPECT_NE(std::string::npos, trace.find("\"ts\":0.000,", outer)) << trace;
+  EXPECT_EQ(std::string::npos, trace.find("disabled"));
+
+  TraceRecorder::clear();
+  EXPECT_EQ(0, TraceRecorder::size());
+}
+
+TEST_F(TraceRecorderTest, Ring) {
+  static const char* const kNames[] = {
+      "e0", "e1", "e2", "e3", "e4", "e5", "e6", "e7", "e8", "e9"};
+  TraceRecorder::enable(4);
+  std::thread([] {
+    setThreadName("traced");
+    for (auto name : kNames) {
+      TraceSection section(name);
+    }
+  }).join();
+  TraceRecorder::enable();
+
+  EXPECT_EQ(4, TraceRecorder::size());
+  auto const trace = TraceRecorder::exportChromeTrace();
+  EXPECT_EQ(std::string::npos, trace.find("\"e5\"")) << trace;
+  for (auto name : {"e6", "e7", "e8", "e9"}) {
+    EXPECT_NE(std::string::npos, trace.find(std::string("\"") + name + "\""))
+        << trace;
+  }
+  EXPECT_NE(
+      std::string::npos,
+      trace.find("\"ph\":\"M\",\"pid\":" + std::to_string(getpid())))
+      << trace;
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"traced\"}"));
+
+  // The buffer of the thread, which exited, is dropped.
+  TraceRecorder::clear();
+  EXPECT_EQ(
+      std::string::npos, TraceRecorder::exportChromeTrace().find("traced"));
+}
+
+TEST_F(TraceRecorderTest, EventBaseLoopPhases) {
+  EventBase evb;
+  TraceRecorder::enable();
+  evb.runInEventBaseThread([] {});
+  evb.runInLoop([] {});
+  evb.loopOnce();
+  TraceRecorder::disable();
+
+  auto const trace = TraceRecorder::exportChromeTrace();
+  EXPECT_NE(std::string::npos, trace.find("\"EventBase::Wait\"")) << trace;
+  EXPECT_NE(std::string::npos, trace.find("\"EventBase::NotificationQueue\""))
+      << trace;
+  EXPECT_NE(std::string::npos, trace.find("\"EventBase::Loop\"")) << trace;
+}